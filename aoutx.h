@@ -1691,13 +1691,27 @@ NAME (aout, translate_symbol_table) (bfd *abfd,
 				     bool dynamic)
 {
   struct external_nlist *ext_end;
+  bool host_order = _bfd_header_host_order_p (abfd);
 
   ext_end = ext + count;
   for (; ext < ext_end; ext++, in++)
     {
       bfd_vma x;
 
-      x = GET_WORD (abfd, ext->e_strx);
+      /* Symbols in the host's byte order need not go through the
+	 target vector for every field.  */
+      if (host_order)
+	{
+	  x = HOST_GET_WORD (ext->e_strx);
+	  in->symbol.value = HOST_GET_SWORD (ext->e_value);
+	  in->desc = _bfd_host_get_16 (ext->e_desc);
+	}
+      else
+	{
+	  x = GET_WORD (abfd, ext->e_strx);
+	  in->symbol.value = GET_SWORD (abfd, ext->e_value);
+	  in->desc = H_GET_16 (abfd, ext->e_desc);
+	}
       in->symbol.the_bfd = abfd;
 
       /* For the normal symbols, the zero index points at the number
@@ -1718,8 +1732,6 @@ NAME (aout, translate_symbol_table) (bfd *abfd,
 	  return false;
 	}
 
-      in->symbol.value = GET_SWORD (abfd,  ext->e_value);
-      in->desc = H_GET_16 (abfd, ext->e_desc);
       in->other = H_GET_8 (abfd, ext->e_other);
       in->type = H_GET_8 (abfd,  ext->e_type);
       in->symbol.udata.p = NULL;
@@ -1921,8 +1933,13 @@ NAME (aout, canonicalize_symtab) (bfd *abfd, asymbol **location)
 {
   unsigned int counter = 0;
   aout_symbol_type *symbase;
+  enum bfd_memory_class old_class;
+  bool ok;
 
-  if (!NAME (aout, slurp_symbol_table) (abfd))
+  old_class = _bfd_set_memory_class (bfd_memory_symbols);
+  ok = NAME (aout, slurp_symbol_table) (abfd);
+  _bfd_set_memory_class (old_class);
+  if (!ok)
     return -1;
 
   for (symbase = obj_aout_symbols (abfd);
@@ -2458,8 +2475,17 @@ NAME (aout, canonicalize_reloc) (bfd *abfd,
       return 0;
     }
 
-  if (!(tblptr || NAME (aout, slurp_reloc_table) (abfd, section, symbols)))
-    return -1;
+  if (tblptr == NULL)
+    {
+      enum bfd_memory_class old_class;
+      bool ok;
+
+      old_class = _bfd_set_memory_class (bfd_memory_relocs);
+      ok = NAME (aout, slurp_reloc_table) (abfd, section, symbols);
+      _bfd_set_memory_class (old_class);
+      if (!ok)
+	return -1;
+    }
 
   if (section->flags & SEC_CONSTRUCTOR)
     {
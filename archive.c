@@ -291,6 +291,158 @@ bfd_get_next_mapent (bfd *abfd, symindex prev, carsym **entry)
   return prev;
 }
 
+/* A hash index of an archive's symbol table.  */
+
+struct armap_index
+{
+  /* The symbol table indexed, so a changed one is noticed.  */
+  carsym *symdefs;
+  symindex count;
+
+  /* A power of two.  */
+  symindex nbuckets;
+
+  /* The first symbol of each hash chain, and the one after each
+     symbol in its chain, in symbol table order, or
+     BFD_NO_MORE_SYMBOLS.  */
+  symindex *buckets;
+  symindex *chain;
+};
+
+/* Return the index of ABFD's symbol table, making it if need be.  */
+
+static struct armap_index *
+get_armap_index (bfd *abfd)
+{
+  struct artdata *ardata = bfd_ardata (abfd);
+  struct armap_index *idx = ardata->symdef_index;
+  symindex i, nbuckets;
+  size_t amt;
+
+  if (idx != NULL
+      && idx->symdefs == ardata->symdefs
+      && idx->count == ardata->symdef_count)
+    return idx;
+
+  if (idx == NULL)
+    {
+      idx = (struct armap_index *) bfd_alloc (abfd, sizeof (*idx));
+      if (idx == NULL)
+	return NULL;
+    }
+  else
+    {
+      free (idx->buckets);
+      free (idx->chain);
+    }
+  memset (idx, 0, sizeof (*idx));
+  ardata->symdef_index = idx;
+  if (ardata->symdef_count == 0)
+    {
+      idx->symdefs = ardata->symdefs;
+      return idx;
+    }
+
+  for (nbuckets = 1; nbuckets < ardata->symdef_count; nbuckets <<= 1)
+    ;
+  if (_bfd_mul_overflow (nbuckets, sizeof (symindex), &amt))
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return NULL;
+    }
+  idx->buckets = (symindex *) bfd_malloc (amt);
+  if (idx->buckets == NULL)
+    return NULL;
+  if (_bfd_mul_overflow (ardata->symdef_count, sizeof (symindex), &amt))
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return NULL;
+    }
+  idx->chain = (symindex *) bfd_malloc (amt);
+  if (idx->chain == NULL)
+    return NULL;
+
+  for (i = 0; i < nbuckets; i++)
+    idx->buckets[i] = BFD_NO_MORE_SYMBOLS;
+  /* Go backwards so that each chain is in symbol table order.  */
+  for (i = ardata->symdef_count; i-- > 0; )
+    {
+      hashval_t hash = htab_hash_string (ardata->symdefs[i].name);
+      symindex *bucket = &idx->buckets[hash & (nbuckets - 1)];
+
+      idx->chain[i] = *bucket;
+      *bucket = i;
+    }
+
+  idx->nbuckets = nbuckets;
+  idx->symdefs = ardata->symdefs;
+  idx->count = ardata->symdef_count;
+  return idx;
+}
+
+/* Free the index of ABFD's symbol table.  */
+
+static void
+free_armap_index (bfd *abfd)
+{
+  struct armap_index *idx = bfd_ardata (abfd)->symdef_index;
+
+  if (idx != NULL)
+    {
+      free (idx->buckets);
+      free (idx->chain);
+      bfd_ardata (abfd)->symdef_index = NULL;
+    }
+}
+
+/*
+FUNCTION
+	bfd_find_armap_symbol
+
+SYNOPSIS
+	symindex bfd_find_armap_symbol
+	  (bfd *abfd, symindex previous, const char *name, carsym **sym);
+
+DESCRIPTION
+	Like <<bfd_get_next_mapent>>, but step only through the
+	symbols called @var{name} in archive @var{abfd}'s symbol table,
+	in the order they appear there.  A hash index of the symbol
+	table is made the first time it is used, so finding the member
+	that defines a symbol doesn't depend on the size of the table.
+*/
+
+symindex
+bfd_find_armap_symbol (bfd *abfd, symindex prev, const char *name,
+		       carsym **entry)
+{
+  struct armap_index *idx;
+  carsym *symdefs;
+
+  if (!bfd_has_map (abfd))
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return BFD_NO_MORE_SYMBOLS;
+    }
+
+  idx = get_armap_index (abfd);
+  if (idx == NULL || idx->count == 0)
+    return BFD_NO_MORE_SYMBOLS;
+
+  if (prev == BFD_NO_MORE_SYMBOLS)
+    prev = idx->buckets[htab_hash_string (name) & (idx->nbuckets - 1)];
+  else if (prev < idx->count)
+    prev = idx->chain[prev];
+  else
+    return BFD_NO_MORE_SYMBOLS;
+
+  symdefs = idx->symdefs;
+  while (prev != BFD_NO_MORE_SYMBOLS && strcmp (symdefs[prev].name, name) != 0)
+    prev = idx->chain[prev];
+  if (prev != BFD_NO_MORE_SYMBOLS)
+    *entry = symdefs + prev;
+  return prev;
+}
+
 /* To be called by backends only.  */
 
 bfd *
@@ -382,6 +534,7 @@ _bfd_add_bfd_to_archive_cache (bfd *arch_bfd, file_ptr filepos, bfd *new_elt)
 				      NULL, _bfd_calloc_wrapper, free);
       if (hash_table == NULL)
 	return false;
+      htab_set_incremental (hash_table, 1);
       bfd_ardata (arch_bfd)->cache = hash_table;
     }
 
@@ -413,6 +566,16 @@ open_nested_file (const char *filename, bfd *archive)
       n_bfd->lto_output = archive->lto_output;
       n_bfd->no_export = archive->no_export;
       n_bfd->my_archive = archive;
+
+      /* Members of a mapped thin archive are mapped too, falling back
+	 to reading the file if that fails.  */
+      if (archive->file_image != NULL)
+	{
+	  bfd_error_type err = bfd_get_error ();
+
+	  if (!bfd_map_file_image (n_bfd))
+	    bfd_set_error (err);
+	}
     }
   return n_bfd;
 }
@@ -853,6 +1016,181 @@ bfd_openr_next_archived_file (bfd *archive, bfd *last_file)
 		   openr_next_archived_file, (archive, last_file));
 }
 
+/* Return the BFD whose file holds the contents of ABFD.  */
+
+static bfd *
+outermost_bfd (bfd *abfd)
+{
+  while (abfd->my_archive != NULL
+	 && !bfd_is_thin_archive (abfd->my_archive))
+    abfd = abfd->my_archive;
+  return abfd;
+}
+
+/* Return TRUE if the COUNT BFDs in MEMBERS may be read on several
+   threads at once, and there are threads to do it.  */
+
+static bool
+members_parallel_p (bfd **members, size_t count)
+{
+  size_t i;
+
+  if (bfd_get_thread_count () <= 1 || count < 2)
+    return false;
+  for (i = 0; i < count; i++)
+    if (!_bfd_cache_iovec_p (outermost_bfd (members[i])))
+      return false;
+  return true;
+}
+
+/* Tidy up after the COUNT BFDs in MEMBERS have been read on several
+   threads.  Their sections are given ids in order, as if they had
+   been read one after another, and the files they are in are put
+   back where BFD thinks they are.  */
+
+static bool
+finish_parallel_members (bfd **members, size_t count)
+{
+  bfd *last = NULL;
+  bool ok = true;
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    {
+      bfd *outer = outermost_bfd (members[i]);
+      asection *sec;
+
+      for (sec = members[i]->sections; sec != NULL; sec = sec->next)
+	sec->id = _bfd_section_id++;
+      if (outer != members[i] && outer != last)
+	{
+	  if (outer->iovec->bseek (outer, outer->where, SEEK_SET) != 0)
+	    ok = false;
+	  last = outer;
+	}
+    }
+  return ok;
+}
+
+/* The members being checked by bfd_check_archive_members.  */
+
+struct member_check
+{
+  bfd **members;
+  bool (*func) (bfd *, void *);
+  void *data;
+  bool parallel;
+  unsigned int section_id;
+};
+
+/* Check members START to END of DATA, a member_check.  Worker for
+   _bfd_parallel_for.  */
+
+static bool
+check_member_range (void *data, size_t start, size_t end)
+{
+  struct member_check *check = (struct member_check *) data;
+  unsigned int section_id = check->section_id;
+  bool ok = true;
+  size_t i;
+
+  if (check->parallel)
+    {
+      _bfd_set_member_positions (true);
+      _bfd_set_thread_section_ids (&section_id);
+    }
+  for (i = start; ok && i < end; i++)
+    if (bfd_check_format (check->members[i], bfd_object)
+	&& check->func != NULL)
+      ok = check->func (check->members[i], check->data);
+  if (check->parallel)
+    {
+      _bfd_set_thread_section_ids (NULL);
+      _bfd_set_member_positions (false);
+    }
+  return ok;
+}
+
+/*
+FUNCTION
+	bfd_check_archive_members
+
+SYNOPSIS
+	bool bfd_check_archive_members
+	  (bfd *archive, bool (*func) (bfd *member, void *data),
+	   void *data);
+
+DESCRIPTION
+	Open every member of @var{archive}, as
+	<<bfd_openr_next_archived_file>> does, and check whether it is
+	an object file, as <<bfd_check_format>> does for
+	<<bfd_object>>.  Call @var{func}, if not NULL, with each
+	member that is, and @var{data}.
+
+	The members are checked on as many threads as
+	<<bfd_set_thread_count>> allows, if @var{archive} is read
+	through the file cache, so @var{func} may be called for
+	different members at once.  It may read its member, for example to get
+	its symbols, but not close it, and shouldn't depend on the ids
+	of its sections, which are only settled once every member has
+	been checked.  The members stay open in the archive's cache,
+	so a later walk with <<bfd_openr_next_archived_file>> finds
+	them already checked.
+
+	Returns <<FALSE>> if a member could not be opened, or
+	@var{func} returned <<FALSE>>.  Members that aren't object
+	files are not an error.
+*/
+
+bool
+bfd_check_archive_members (bfd *archive, bool (*func) (bfd *, void *),
+			   void *data)
+{
+  struct member_check check;
+  bfd **members = NULL;
+  size_t count = 0, max = 0;
+  bfd *member;
+  bool ok;
+
+  bfd_set_error (bfd_error_no_error);
+  for (member = bfd_openr_next_archived_file (archive, NULL);
+       member != NULL;
+       member = bfd_openr_next_archived_file (archive, member))
+    {
+      if (count == max)
+	{
+	  bfd **grown;
+
+	  max = max != 0 ? max * 2 : 64;
+	  grown = (bfd **) bfd_realloc (members, max * sizeof (*members));
+	  if (grown == NULL)
+	    {
+	      free (members);
+	      return false;
+	    }
+	  members = grown;
+	}
+      members[count++] = member;
+    }
+  if (bfd_get_error () != bfd_error_no_more_archived_files)
+    {
+      free (members);
+      return false;
+    }
+
+  check.members = members;
+  check.func = func;
+  check.data = data;
+  check.parallel = members_parallel_p (members, count);
+  check.section_id = _bfd_section_id;
+  ok = _bfd_parallel_for (count, check.parallel ? 1 : count,
+			  check_member_range, &check);
+  if (check.parallel && !finish_parallel_members (members, count))
+    ok = false;
+  free (members);
+  return ok;
+}
+
 bfd *
 bfd_generic_openr_next_archived_file (bfd *archive, bfd *last_file)
 {
@@ -1079,7 +1417,7 @@ static bool
 do_slurp_coff_armap (bfd *abfd)
 {
   struct areltdata *mapdata;
-  int *raw_armap, *rawptr;
+  uint32_t *raw_armap;
   struct artdata *ardata = bfd_ardata (abfd);
   char *stringbase;
   char *stringend;
@@ -1088,7 +1426,6 @@ do_slurp_coff_armap (bfd *abfd)
   ufile_ptr filesize;
   size_t nsymz, carsym_size, ptrsize, i;
   carsym *carsyms;
-  bfd_vma (*swap) (const void *);
   char int_buf[4];
   struct areltdata *tmp;
 
@@ -1103,7 +1440,6 @@ do_slurp_coff_armap (bfd *abfd)
 
   /* It seems that all numeric information in a coff archive is always
      in big endian format, no matter the host or target.  */
-  swap = bfd_getb32;
   nsymz = bfd_getb32 (int_buf);
 
   /* The coff armap must be read sequentially.  So we construct a
@@ -1134,7 +1470,7 @@ do_slurp_coff_armap (bfd *abfd)
     }
 
   /* Allocate and read in the raw offsets.  */
-  raw_armap = (int *) _bfd_malloc_and_read (abfd, ptrsize, ptrsize);
+  raw_armap = (uint32_t *) _bfd_malloc_and_read (abfd, ptrsize, ptrsize);
   if (raw_armap == NULL)
     return false;
 
@@ -1149,12 +1485,12 @@ do_slurp_coff_armap (bfd *abfd)
     goto release_symdefs;
 
   /* OK, build the carsyms.  */
+  _bfd_get_32_array (raw_armap, raw_armap, nsymz, true);
   stringend = stringbase + stringsize;
   *stringend = 0;
   for (i = 0; i < nsymz; i++)
     {
-      rawptr = raw_armap + i;
-      carsyms->file_offset = swap ((bfd_byte *) rawptr);
+      carsyms->file_offset = raw_armap[i];
       carsyms->name = stringbase;
       stringbase += strlen (stringbase);
       if (stringbase != stringend)
@@ -2127,6 +2463,121 @@ _bfd_noarchive_truncate_arname (bfd *abfd ATTRIBUTE_UNUSED,
 {
 }
 
+/* The members of an archive being written whose headers are made
+   from the filesystem by prepare_member_hdrs.  */
+
+struct member_hdrs
+{
+  bfd *arch;
+  bfd **members;
+  struct areltdata **hdrs;
+};
+
+/* Make the headers of members START to END of DATA, a member_hdrs.
+   Worker for _bfd_parallel_for.  */
+
+static bool
+member_hdr_range (void *data, size_t start, size_t end)
+{
+  struct member_hdrs *job = (struct member_hdrs *) data;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    if (job->members[i] != NULL)
+      job->hdrs[i] = bfd_ar_hdr_from_filesystem (job->arch,
+						 bfd_get_filename
+						 (job->members[i]),
+						 job->members[i]);
+  return true;
+}
+
+/* Members that are stat'ed in a group on several threads.  */
+#define MEMBER_HDR_GRAIN 16
+
+/* With several threads, stat the COUNT members of ARCH that live in
+   the filesystem in parallel.  Return the headers made, indexed like
+   the members, or NULL if this wasn't worth doing.  Members whose
+   header couldn't be made have a NULL entry, and are redone one at a
+   time so that the error is reported against them.  */
+
+static struct areltdata **
+prepare_member_hdrs (bfd *arch, size_t count)
+{
+  struct member_hdrs job;
+  bfd *current;
+  size_t i, needed = 0;
+
+  if (bfd_get_thread_count () <= 1 || count < 2 * MEMBER_HDR_GRAIN)
+    return NULL;
+
+  job.arch = arch;
+  job.members = (bfd **) bfd_zmalloc (count * sizeof (*job.members));
+  job.hdrs = (struct areltdata **) bfd_zmalloc (count * sizeof (*job.hdrs));
+  if (job.members == NULL || job.hdrs == NULL)
+    {
+      free (job.members);
+      free (job.hdrs);
+      return NULL;
+    }
+  for (i = 0, current = arch->archive_head;
+       current != NULL;
+       i++, current = current->archive_next)
+    if (!bfd_write_p (current) && current->arelt_data == NULL)
+      {
+	job.members[i] = current;
+	needed++;
+      }
+
+  if (needed >= 2 * MEMBER_HDR_GRAIN)
+    _bfd_parallel_for (count, MEMBER_HDR_GRAIN, member_hdr_range, &job);
+  free (job.members);
+  return job.hdrs;
+}
+
+#define AR_WRITE_BUFFERSIZE (DEFAULT_BUFFERSIZE * 1024)
+
+/* Write the contents of archive member CURRENT to ARCH.  Large
+   members, and members read from memory or from a file mapped by
+   bfd_map_file_image, are written straight from a view of their
+   file rather than being copied through BUFFER first.  */
+
+static bool
+write_member_contents (bfd *arch, bfd *current, char *buffer)
+{
+  bfd_size_type remaining = arelt_size (current);
+  const bfd_byte *view;
+  void *map_addr;
+  bfd_size_type map_len;
+
+  view = _bfd_map_region (current, 0, remaining, &map_addr, &map_len);
+  if (view != NULL)
+    {
+      bool ok = bfd_bwrite (view, remaining, arch) == remaining;
+
+      if (map_len != 0)
+	bfd_munmap (map_addr, map_len);
+      return ok;
+    }
+
+  if (bfd_seek (current, (file_ptr) 0, SEEK_SET) != 0)
+    return false;
+
+  while (remaining)
+    {
+      size_t amt = AR_WRITE_BUFFERSIZE;
+
+      if (amt > remaining)
+	amt = remaining;
+      errno = 0;
+      if (bfd_bread (buffer, amt, current) != amt)
+	return false;
+      if (bfd_bwrite (buffer, amt, arch) != amt)
+	return false;
+      remaining -= amt;
+    }
+  return true;
+}
+
 /* The BFD is open for write and has its format set to bfd_archive.  */
 
 bool
@@ -2143,13 +2594,22 @@ _bfd_write_archive_contents (bfd *arch)
   int tries;
   char *armag;
   char *buffer = NULL;
+  struct areltdata **hdrs;
+  size_t count = 0;
+  size_t i;
+
+  for (current = arch->archive_head;
+       current != NULL;
+       current = current->archive_next)
+    count++;
+  hdrs = prepare_member_hdrs (arch, count);
 
   /* Verify the viability of all entries; if any of them live in the
      filesystem (as opposed to living in an archive open for input)
      then construct a fresh ar_hdr for them.  */
-  for (current = arch->archive_head;
+  for (i = 0, current = arch->archive_head;
        current != NULL;
-       current = current->archive_next)
+       i++, current = current->archive_next)
     {
       /* This check is checking the bfds for the objects we're reading
 	 from (which are usually either an object file or archive on
@@ -2163,9 +2623,15 @@ _bfd_write_archive_contents (bfd *arch)
 	}
       if (!current->arelt_data)
 	{
-	  current->arelt_data =
-	    bfd_ar_hdr_from_filesystem (arch, bfd_get_filename (current),
-					current);
+	  if (hdrs != NULL && hdrs[i] != NULL)
+	    {
+	      current->arelt_data = hdrs[i];
+	      hdrs[i] = NULL;
+	    }
+	  else
+	    current->arelt_data =
+	      bfd_ar_hdr_from_filesystem (arch, bfd_get_filename (current),
+					  current);
 	  if (!current->arelt_data)
 	    goto input_err;
 
@@ -2181,6 +2647,8 @@ _bfd_write_archive_contents (bfd *arch)
 	    hasobjects = true;
 	}
     }
+  free (hdrs);
+  hdrs = NULL;
 
   if (!BFD_SEND (arch, _bfd_construct_extended_name_table,
 		 (arch, &etable, &elength, &ename)))
@@ -2223,8 +2691,6 @@ _bfd_write_archive_contents (bfd *arch)
 	}
     }
 
-#define AR_WRITE_BUFFERSIZE (DEFAULT_BUFFERSIZE * 1024)
-
   /* FIXME: Find a way to test link_info.reduce_memory_overheads
      and change the buffer size.  */
   buffer = bfd_malloc (AR_WRITE_BUFFERSIZE);
@@ -2235,30 +2701,14 @@ _bfd_write_archive_contents (bfd *arch)
        current != NULL;
        current = current->archive_next)
     {
-      bfd_size_type remaining = arelt_size (current);
-
       /* Write ar header.  */
       if (!_bfd_write_ar_hdr (arch, current))
 	goto input_err;
       if (bfd_is_thin_archive (arch))
 	continue;
-      if (bfd_seek (current, (file_ptr) 0, SEEK_SET) != 0)
+      if (!write_member_contents (arch, current, buffer))
 	goto input_err;
 
-      while (remaining)
-	{
-	  size_t amt = AR_WRITE_BUFFERSIZE;
-
-	  if (amt > remaining)
-	    amt = remaining;
-	  errno = 0;
-	  if (bfd_bread (buffer, amt, current) != amt)
-	    goto input_err;
-	  if (bfd_bwrite (buffer, amt, arch) != amt)
-	    goto input_err;
-	  remaining -= amt;
-	}
-
       if ((arelt_size (current) % 2) == 1)
 	{
 	  if (bfd_bwrite (&ARFMAG[1], 1, arch) != 1)
@@ -2291,10 +2741,266 @@ _bfd_write_archive_contents (bfd *arch)
 
  input_err:
   bfd_set_input_error (current, bfd_get_error ());
+  if (hdrs != NULL)
+    {
+      for (; i < count; i++)
+	free (hdrs[i]);
+      free (hdrs);
+    }
   free (buffer);
   return false;
 }
 
+/* Return TRUE if SYM belongs in the armap.  */
+
+static bool
+armap_symbol_p (const asymbol *sym)
+{
+  return (((sym->flags & (BSF_GLOBAL
+			  | BSF_WEAK
+			  | BSF_INDIRECT
+			  | BSF_GNU_UNIQUE)) != 0
+	   || bfd_is_com_section (sym->section))
+	  && ! bfd_is_und_section (sym->section));
+}
+
+/* The armap being built by _bfd_compute_and_write_armap.  */
+
+struct armap_build
+{
+  bfd *arch;
+  struct orl *map;
+  unsigned int orl_max;
+  unsigned int orl_count;
+  int stridx;
+  bool report_plugin_err;
+};
+
+/* Add NAME, defined by ABFD, to the armap in BUILD.  */
+
+static bool
+add_armap_symbol (struct armap_build *build, bfd *abfd, const char *name)
+{
+  bfd_size_type namelen;
+  struct orl *new_map;
+  size_t amt;
+
+  /* This symbol will go into the archive header.  */
+  if (build->orl_count == build->orl_max)
+    {
+      build->orl_max *= 2;
+      amt = build->orl_max * sizeof (struct orl);
+      new_map = (struct orl *) bfd_realloc (build->map, amt);
+      if (new_map == NULL)
+	return false;
+
+      build->map = new_map;
+    }
+
+  if (name != NULL
+      && name[0] == '_'
+      && name[1] == '_'
+      && strcmp (name + (name[2] == '_'), "__gnu_lto_slim") == 0
+      && build->report_plugin_err)
+    {
+      build->report_plugin_err = false;
+      _bfd_error_handler
+	(_("%pB: plugin needed to handle lto object"), abfd);
+    }
+  namelen = strlen (name);
+  amt = sizeof (char *);
+  build->map[build->orl_count].name = (char **) bfd_alloc (build->arch, amt);
+  if (build->map[build->orl_count].name == NULL)
+    return false;
+  *(build->map[build->orl_count].name) = (char *) bfd_alloc (build->arch,
+							     namelen + 1);
+  if (*(build->map[build->orl_count].name) == NULL)
+    return false;
+  strcpy (*(build->map[build->orl_count].name), name);
+  build->map[build->orl_count].u.abfd = abfd;
+  build->map[build->orl_count].namidx = build->stridx;
+
+  build->stridx += namelen + 1;
+  ++build->orl_count;
+  return true;
+}
+
+/* What armap_member_range found in one member.  */
+
+struct armap_member
+{
+  /* Whether the member is an object with symbols.  */
+  bool has_syms;
+  bool lto_slim_object;
+
+  /* Whether reading the member failed, and why.  */
+  bool failed;
+  bfd_error_type error;
+
+  /* The names of the member's symbols that belong in the armap, one
+     after another.  */
+  char *names;
+  size_t names_size;
+};
+
+struct armap_job
+{
+  bfd **members;
+  struct armap_member *found;
+  unsigned int section_id;
+};
+
+/* Append NAME to the names in FOUND.  */
+
+static bool
+armap_member_add (struct armap_member *found, const char *name,
+		  size_t *names_max)
+{
+  size_t len = strlen (name) + 1;
+
+  if (found->names_size + len > *names_max)
+    {
+      char *names;
+
+      *names_max = (*names_max + len) * 2;
+      names = (char *) bfd_realloc (found->names, *names_max);
+      if (names == NULL)
+	return false;
+      found->names = names;
+    }
+  memcpy (found->names + found->names_size, name, len);
+  found->names_size += len;
+  return true;
+}
+
+/* Read the symbols of members START to END of DATA, an armap_job.
+   Worker for _bfd_parallel_for.  */
+
+static bool
+armap_member_range (void *data, size_t start, size_t end)
+{
+  struct armap_job *job = (struct armap_job *) data;
+  unsigned int section_id = job->section_id;
+  asymbol **syms = NULL;
+  long long syms_max = 0;
+  size_t i;
+
+  _bfd_set_member_positions (true);
+  _bfd_set_thread_section_ids (&section_id);
+  for (i = start; i < end; i++)
+    {
+      bfd *current = job->members[i];
+      struct armap_member *found = &job->found[i];
+      size_t names_max = 0;
+      long long storage;
+      long long symcount;
+      long long src_count;
+
+      if (!bfd_check_format (current, bfd_object)
+	  || (bfd_get_file_flags (current) & HAS_SYMS) == 0)
+	continue;
+
+      found->has_syms = true;
+      found->lto_slim_object = current->lto_slim_object;
+      storage = bfd_get_symtab_upper_bound (current);
+      if (storage < 0)
+	goto fail;
+
+      if (storage != 0)
+	{
+	  if (storage > syms_max)
+	    {
+	      free (syms);
+	      syms_max = storage;
+	      syms = (asymbol **) bfd_malloc (syms_max);
+	      if (syms == NULL)
+		{
+		  syms_max = 0;
+		  goto fail;
+		}
+	    }
+	  symcount = bfd_canonicalize_symtab (current, syms);
+	  if (symcount < 0)
+	    goto fail;
+
+	  for (src_count = 0; src_count < symcount; src_count++)
+	    if (armap_symbol_p (syms[src_count])
+		&& !armap_member_add (found, syms[src_count]->name,
+				      &names_max))
+	      goto fail;
+	}
+
+      if (bfd_free_cached_info (current))
+	continue;
+
+    fail:
+      /* Stop here.  The members after this one won't be wanted.  */
+      found->failed = true;
+      found->error = bfd_get_error ();
+      break;
+    }
+  _bfd_set_thread_section_ids (NULL);
+  _bfd_set_member_positions (false);
+  free (syms);
+  return true;
+}
+
+/* Gather the armap entries of the COUNT members of MEMBERS into
+   BUILD, reading the members on several threads.  */
+
+static bool
+compute_armap_parallel (struct armap_build *build, bfd **members,
+			size_t count)
+{
+  struct armap_job job;
+  bool ret = false;
+  size_t i;
+
+  job.members = members;
+  job.found = (struct armap_member *) bfd_zmalloc (count
+						   * sizeof (*job.found));
+  if (job.found == NULL)
+    return false;
+  job.section_id = _bfd_section_id;
+  _bfd_parallel_for (count, 1, armap_member_range, &job);
+  if (!finish_parallel_members (members, count))
+    goto out;
+
+  /* Add the names in member order, so the armap is the same as
+     reading the members one at a time would make it.  */
+  for (i = 0; i < count; i++)
+    {
+      struct armap_member *found = &job.found[i];
+      const char *name;
+
+      if (!found->has_syms)
+	continue;
+      if (found->lto_slim_object && build->report_plugin_err)
+	{
+	  build->report_plugin_err = false;
+	  _bfd_error_handler
+	    (_("%pB: plugin needed to handle lto object"), members[i]);
+	}
+      if (found->failed)
+	{
+	  bfd_set_error (found->error);
+	  goto out;
+	}
+      for (name = found->names;
+	   name < found->names + found->names_size;
+	   name += strlen (name) + 1)
+	if (!add_armap_symbol (build, members[i], name))
+	  goto out;
+    }
+  ret = true;
+
+ out:
+  for (i = 0; i < count; i++)
+    free (job.found[i].names);
+  free (job.found);
+  return ret;
+}
+
 /* Note that the namidx for the first symbol is 0.  */
 
 bool
@@ -2303,12 +3009,11 @@ _bfd_compute_and_write_armap (bfd *arch, unsigned int elength)
   char *first_name = NULL;
   bfd *current;
   file_ptr elt_no = 0;
-  struct orl *map = NULL;
-  unsigned int orl_max = 1024;		/* Fine initial default.  */
-  unsigned int orl_count = 0;
-  int stridx = 0;
+  struct armap_build build;
   asymbol **syms = NULL;
   long long syms_max = 0;
+  bfd **members = NULL;
+  size_t count = 0;
   bool ret;
   size_t amt;
   static bool report_plugin_err = true;
@@ -2318,9 +3023,14 @@ _bfd_compute_and_write_armap (bfd *arch, unsigned int elength)
     elength += sizeof (struct ar_hdr);
   elength += elength % 2;
 
-  amt = orl_max * sizeof (struct orl);
-  map = (struct orl *) bfd_malloc (amt);
-  if (map == NULL)
+  build.arch = arch;
+  build.orl_max = 1024;		/* Fine initial default.  */
+  build.orl_count = 0;
+  build.stridx = 0;
+  build.report_plugin_err = report_plugin_err;
+  amt = build.orl_max * sizeof (struct orl);
+  build.map = (struct orl *) bfd_malloc (amt);
+  if (build.map == NULL)
     goto error_return;
 
   /* We put the symbol names on the arch objalloc, and then discard
@@ -2334,6 +3044,29 @@ _bfd_compute_and_write_armap (bfd *arch, unsigned int elength)
 	 && strcmp (bfd_get_filename (arch->archive_head), "__.SYMDEF") == 0)
     arch->archive_head = arch->archive_head->archive_next;
 
+  /* With several threads, read the members' symbols in parallel.  */
+  if (bfd_get_thread_count () > 1)
+    {
+      for (current = arch->archive_head;
+	   current != NULL;
+	   current = current->archive_next)
+	count++;
+      members = (bfd **) bfd_malloc (count * sizeof (*members));
+      if (members == NULL)
+	goto error_return;
+      count = 0;
+      for (current = arch->archive_head;
+	   current != NULL;
+	   current = current->archive_next)
+	members[count++] = current;
+      if (members_parallel_p (members, count))
+	{
+	  if (!compute_armap_parallel (&build, members, count))
+	    goto error_return;
+	  goto write_armap;
+	}
+    }
+
   /* Map over each element.  */
   for (current = arch->archive_head;
        current != NULL;
@@ -2346,9 +3079,9 @@ _bfd_compute_and_write_armap (bfd *arch, unsigned int elength)
 	  long long symcount;
 	  long long src_count;
 
-	  if (current->lto_slim_object && report_plugin_err)
+	  if (current->lto_slim_object && build.report_plugin_err)
 	    {
-	      report_plugin_err = false;
+	      build.report_plugin_err = false;
 	      _bfd_error_handler
 		(_("%pB: plugin needed to handle lto object"),
 		 current);
@@ -2375,62 +3108,10 @@ _bfd_compute_and_write_armap (bfd *arch, unsigned int elength)
 	      /* Now map over all the symbols, picking out the ones we
 		 want.  */
 	      for (src_count = 0; src_count < symcount; src_count++)
-		{
-		  flagword flags = (syms[src_count])->flags;
-		  asection *sec = syms[src_count]->section;
-
-		  if (((flags & (BSF_GLOBAL
-				 | BSF_WEAK
-				 | BSF_INDIRECT
-				 | BSF_GNU_UNIQUE)) != 0
-		       || bfd_is_com_section (sec))
-		      && ! bfd_is_und_section (sec))
-		    {
-		      bfd_size_type namelen;
-		      struct orl *new_map;
-
-		      /* This symbol will go into the archive header.  */
-		      if (orl_count == orl_max)
-			{
-			  orl_max *= 2;
-			  amt = orl_max * sizeof (struct orl);
-			  new_map = (struct orl *) bfd_realloc (map, amt);
-			  if (new_map == NULL)
-			    goto error_return;
-
-			  map = new_map;
-			}
-
-		      if (syms[src_count]->name != NULL
-			  && syms[src_count]->name[0] == '_'
-			  && syms[src_count]->name[1] == '_'
-			  && strcmp (syms[src_count]->name
-				     + (syms[src_count]->name[2] == '_'),
-				     "__gnu_lto_slim") == 0
-			  && report_plugin_err)
-			{
-			  report_plugin_err = false;
-			  _bfd_error_handler
-			    (_("%pB: plugin needed to handle lto object"),
-			     current);
-			}
-		      namelen = strlen (syms[src_count]->name);
-		      amt = sizeof (char *);
-		      map[orl_count].name = (char **) bfd_alloc (arch, amt);
-		      if (map[orl_count].name == NULL)
-			goto error_return;
-		      *(map[orl_count].name) = (char *) bfd_alloc (arch,
-								   namelen + 1);
-		      if (*(map[orl_count].name) == NULL)
-			goto error_return;
-		      strcpy (*(map[orl_count].name), syms[src_count]->name);
-		      map[orl_count].u.abfd = current;
-		      map[orl_count].namidx = stridx;
-
-		      stridx += namelen + 1;
-		      ++orl_count;
-		    }
-		}
+		if (armap_symbol_p (syms[src_count])
+		    && !add_armap_symbol (&build, current,
+					  syms[src_count]->name))
+		  goto error_return;
 	    }
 
 	  /* Now ask the BFD to free up any cached information, so we
@@ -2440,20 +3121,25 @@ _bfd_compute_and_write_armap (bfd *arch, unsigned int elength)
 	}
     }
 
+ write_armap:
   /* OK, now we have collected all the data, let's write them out.  */
   ret = BFD_SEND (arch, write_armap,
-		  (arch, elength, map, orl_count, stridx));
+		  (arch, elength, build.map, build.orl_count, build.stridx));
 
+  report_plugin_err = build.report_plugin_err;
+  free (members);
   free (syms);
-  free (map);
+  free (build.map);
   if (first_name != NULL)
     bfd_release (arch, first_name);
 
   return ret;
 
  error_return:
+  report_plugin_err = build.report_plugin_err;
+  free (members);
   free (syms);
-  free (map);
+  free (build.map);
   if (first_name != NULL)
     bfd_release (arch, first_name);
 
@@ -2892,6 +3578,8 @@ _bfd_archive_close_and_cleanup (bfd *abfd)
 	  bfd_ardata (abfd)->cache = NULL;
 	}
 
+      free_armap_index (abfd);
+
       /* Close the archive plugin file descriptor if needed.  */
       if (abfd->archive_plugin_fd > 0)
 	close (abfd->archive_plugin_fd);
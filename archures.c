@@ -25,6 +25,7 @@
 #include "bfd.h"
 #include "libbfd.h"
 #include "safe-ctype.h"
+#include "hashtab.h"
 
 /*
 
@@ -822,12 +823,45 @@ DESCRIPTION
 	structure if a machine is found, otherwise NULL.
 */
 
-const bfd_arch_info_type *
-bfd_scan_arch (const char *string)
+/* The results of bfd_scan_arch, indexed by the string scanned for.
+   The scan functions look at nothing but the string and the
+   bfd_arch_info_type, so a result never changes.  At most
+   SCAN_ARCH_CACHE_MAX strings are remembered, in case a program
+   scans for arbitrary strings from its input.  */
+
+struct scan_arch_entry
+{
+  const bfd_arch_info_type *arch;
+  char string[1];
+};
+
+#define SCAN_ARCH_CACHE_MAX 256
+
+static htab_t scan_arch_cache;
+static bfd_mutex scan_arch_lock = BFD_MUTEX_INIT;
+
+static hashval_t
+scan_arch_hash (const void *p)
+{
+  return htab_hash_string (((const struct scan_arch_entry *) p)->string);
+}
+
+/* Compare an entry with a string being looked up.  */
+
+static int
+scan_arch_eq (const void *entry, const void *string)
+{
+  return strcmp (((const struct scan_arch_entry *) entry)->string,
+		 (const char *) string) == 0;
+}
+
+/* Look through all the installed architectures.  */
+
+static const bfd_arch_info_type *
+scan_arch_1 (const char *string)
 {
   const bfd_arch_info_type * const *app, *ap;
 
-  /* Look through all the installed architectures.  */
   for (app = bfd_archures_list; *app != NULL; app++)
     {
       for (ap = *app; ap != NULL; ap = ap->next)
@@ -840,6 +874,56 @@ bfd_scan_arch (const char *string)
   return NULL;
 }
 
+const bfd_arch_info_type *
+bfd_scan_arch (const char *string)
+{
+  const bfd_arch_info_type *ap;
+  struct scan_arch_entry *ent;
+  hashval_t hash = htab_hash_string (string);
+  void **slot;
+
+  _bfd_mutex_lock (&scan_arch_lock);
+  if (scan_arch_cache == NULL)
+    scan_arch_cache = htab_create_alloc (16, scan_arch_hash, scan_arch_eq,
+					 free, calloc, free);
+  if (scan_arch_cache == NULL)
+    {
+      _bfd_mutex_unlock (&scan_arch_lock);
+      return scan_arch_1 (string);
+    }
+
+  ent = (struct scan_arch_entry *)
+    htab_find_with_hash (scan_arch_cache, string, hash);
+  if (ent != NULL)
+    {
+      ap = ent->arch;
+      _bfd_mutex_unlock (&scan_arch_lock);
+      return ap;
+    }
+
+  ap = scan_arch_1 (string);
+  if (htab_elements (scan_arch_cache) < SCAN_ARCH_CACHE_MAX)
+    {
+      size_t len = strlen (string);
+
+      ent = (struct scan_arch_entry *) bfd_malloc (sizeof (*ent) + len);
+      slot = NULL;
+      if (ent != NULL)
+	slot = htab_find_slot_with_hash (scan_arch_cache, string, hash,
+					 INSERT);
+      if (slot != NULL)
+	{
+	  ent->arch = ap;
+	  memcpy (ent->string, string, len + 1);
+	  *slot = ent;
+	}
+      else
+	free (ent);
+    }
+  _bfd_mutex_unlock (&scan_arch_lock);
+  return ap;
+}
+
 /*
 FUNCTION
 	bfd_arch_list
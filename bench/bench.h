@@ -0,0 +1,31 @@
+/* bench.h -- shared declarations of bfd-bench.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/* The time in nanoseconds from some fixed point.  */
+extern unsigned long long bench_now (void);
+
+/* The "corpus" command, given the arguments that follow it.  */
+extern int corpus_main (int, char **);
+
+#endif /* BENCH_H */
@@ -0,0 +1,932 @@
+/* bfd-bench.c -- time the hot paths of BFD.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* Each benchmark runs one kernel over the same data several times
+   and prints a line giving the operations in a run, the fastest and
+   the median time per operation, and a checksum of the results.  The
+   data comes from a fixed seed, or with --input from the symbols and
+   debug information of a file, so two builds given the same options
+   do the same work; their times are only comparable if their
+   checksums agree.  */
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libbfd.h"
+#include "elf-bfd.h"
+#include "bucomm.h"
+#include "libiberty.h"
+#include "demangle.h"
+#include "objalloc.h"
+#include "sframe-api.h"
+#include "bench.h"
+
+#if defined (_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/* The number of operations in a run of each benchmark is this many
+   thousands, times the --scale option.  */
+#define BENCH_BASE_OPS 100
+
+/* Options.  */
+static unsigned int bench_runs = 5;
+static unsigned int bench_scale = 1;
+static const char *bench_filter;
+static const char *bench_input_name;
+
+/* The file given with --input, its symbols, and their names.  */
+static bfd *input_bfd;
+static asymbol **input_syms;
+static long input_symcount;
+
+/* Names for the hash and demangler benchmarks, either synthetic or
+   those of the input's symbols.  */
+static const char **bench_names;
+static size_t bench_name_count;
+static const char *bench_names_from;
+
+/* An ELF object for the benchmarks that need a target, not tied to
+   any file.  */
+static bfd *elf_bfd;
+
+/* The time in nanoseconds from some fixed point.  */
+
+unsigned long long
+bench_now (void)
+{
+#if defined (_WIN32)
+  LARGE_INTEGER count, freq;
+
+  QueryPerformanceCounter (&count);
+  QueryPerformanceFrequency (&freq);
+  return ((unsigned long long) (count.QuadPart / freq.QuadPart) * 1000000000
+	  + (unsigned long long) (count.QuadPart % freq.QuadPart) * 1000000000
+	  / freq.QuadPart);
+#elif defined (CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (unsigned long long) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+  return (unsigned long long) clock () * (1000000000 / CLOCKS_PER_SEC);
+#endif
+}
+
+/* A small generator of pseudo-random numbers, so that the synthetic
+   data is the same on every host.  */
+
+static unsigned long long bench_seed;
+
+static void
+bench_srand (void)
+{
+  bench_seed = 0x9e3779b97f4a7c15ULL;
+}
+
+static unsigned int
+bench_rand (void)
+{
+  bench_seed ^= bench_seed << 13;
+  bench_seed ^= bench_seed >> 7;
+  bench_seed ^= bench_seed << 17;
+  return (unsigned int) (bench_seed >> 32);
+}
+
+/* The operations in one run.  */
+
+static size_t
+bench_ops (void)
+{
+  return (size_t) BENCH_BASE_OPS * 1000 * bench_scale;
+}
+
+/* Make NAMEs that look like those of a C++ program: mangled functions
+   in namespaces and classes, with a sprinkling of C names.  */
+
+static bool
+make_synthetic_names (size_t count)
+{
+  static const char *const scopes[] =
+    {
+      "3bfd", "3elf", "4coff", "5dwarf", "6linker", "7section", "6symbol",
+      "5reloc", "4hash", "6target"
+    };
+  static const char *const funcs[] =
+    {
+      "4read", "5write", "6lookup", "6insert", "4swap", "4find",
+      "8relocate", "9canonical", "5parse", "4emit"
+    };
+  static const char *const params[] =
+    {
+      "v", "i", "j", "PKc", "Ri", "Pv", "m", "PKhm", "bi", "Pcj"
+    };
+  char buf[80];
+  size_t i;
+
+  bench_names = (const char **) xmalloc (count * sizeof (*bench_names));
+  bench_srand ();
+  for (i = 0; i < count; i++)
+    {
+      unsigned int r = bench_rand ();
+
+      if (r % 8 == 0)
+	sprintf (buf, "bench_c_function_%u", r % 1000000);
+      else
+	{
+	  char id[16];
+
+	  sprintf (id, "f%u", (r >> 12) % 100000);
+	  sprintf (buf, "_ZN%s%sIiE%s%u%sE%s",
+		   scopes[r % 10], scopes[(r >> 4) % 10],
+		   funcs[(r >> 8) % 10], (unsigned int) strlen (id), id,
+		   params[(r >> 28) % 10]);
+	}
+      bench_names[i] = xstrdup (buf);
+    }
+  bench_name_count = count;
+  bench_names_from = "synthetic";
+  return true;
+}
+
+/* Open --input and read its symbols and their names.  */
+
+static bool
+open_input (const char *name)
+{
+  long storage, i;
+
+  input_bfd = bfd_openr (name, NULL);
+  if (input_bfd == NULL || !bfd_check_format (input_bfd, bfd_object))
+    {
+      bfd_nonfatal (name);
+      return false;
+    }
+  /* Use the dynamic symbols of a stripped file.  */
+  storage = bfd_get_symtab_upper_bound (input_bfd);
+  if (storage > (long) sizeof (asymbol *))
+    {
+      input_syms = (asymbol **) xmalloc (storage);
+      input_symcount = bfd_canonicalize_symtab (input_bfd, input_syms);
+    }
+  else
+    {
+      storage = bfd_get_dynamic_symtab_upper_bound (input_bfd);
+      if (storage > 0)
+	{
+	  input_syms = (asymbol **) xmalloc (storage);
+	  input_symcount = bfd_canonicalize_dynamic_symtab (input_bfd,
+							    input_syms);
+	}
+    }
+  if (input_symcount <= 0)
+    {
+      fprintf (stderr, _("%s: no symbols\n"), name);
+      return false;
+    }
+
+  bench_names = (const char **) xmalloc (input_symcount
+					 * sizeof (*bench_names));
+  bench_name_count = 0;
+  for (i = 0; i < input_symcount; i++)
+    if (input_syms[i]->name != NULL && input_syms[i]->name[0] != 0)
+      bench_names[bench_name_count++] = input_syms[i]->name;
+  bench_names_from = "input";
+  return bench_name_count != 0;
+}
+
+/* Make a BFD of the elf64-x86-64 target that has no file.  */
+
+static bfd *
+make_elf_bfd (void)
+{
+  bfd *abfd = _bfd_new_bfd ();
+
+  if (abfd == NULL)
+    return NULL;
+  if (!bfd_set_filename (abfd, "bench")
+      || bfd_find_target ("elf64-x86-64", abfd) == NULL
+      || !bfd_set_format (abfd, bfd_object))
+    {
+      bfd_close_all_done (abfd);
+      return NULL;
+    }
+  return abfd;
+}
+
+/* Hashing names, with each of the hash functions.  */
+
+static unsigned long long
+run_hash (enum bfd_hash_function func, size_t *ops)
+{
+  unsigned long long sum = 0;
+  size_t i, n = bench_ops ();
+
+  for (i = 0; i < n; i++)
+    sum += bfd_hash_string_hash (bench_names[i % bench_name_count], func);
+  *ops = n;
+  return sum;
+}
+
+static bool
+setup_hash (void **data ATTRIBUTE_UNUSED)
+{
+  return true;
+}
+
+static unsigned long long
+run_hash_classic (void *data ATTRIBUTE_UNUSED, size_t *ops)
+{
+  return run_hash (bfd_hash_classic, ops);
+}
+
+static unsigned long long
+run_hash_wide (void *data ATTRIBUTE_UNUSED, size_t *ops)
+{
+  return run_hash (bfd_hash_wide, ops);
+}
+
+/* Looking names up in a table holding them, half hitting and half
+   missing.  */
+
+struct lookup_data
+{
+  struct bfd_hash_table table;
+  const char **misses;
+};
+
+static bool
+setup_hash_lookup (void **data)
+{
+  struct lookup_data *ld;
+  size_t i;
+
+  ld = (struct lookup_data *) xmalloc (sizeof (*ld));
+  if (!bfd_hash_table_init (&ld->table, bfd_hash_newfunc,
+			    sizeof (struct bfd_hash_entry)))
+    {
+      free (ld);
+      return false;
+    }
+  ld->misses = (const char **) xmalloc (bench_name_count
+					* sizeof (*ld->misses));
+  for (i = 0; i < bench_name_count; i++)
+    {
+      if (bfd_hash_lookup (&ld->table, bench_names[i], true, false) == NULL)
+	return false;
+      ld->misses[i] = concat (bench_names[i], ".miss", NULL);
+    }
+  *data = ld;
+  return true;
+}
+
+static unsigned long long
+run_hash_lookup (void *data, size_t *ops)
+{
+  struct lookup_data *ld = (struct lookup_data *) data;
+  unsigned long long sum = 0;
+  size_t i, n = bench_ops ();
+
+  for (i = 0; i < n; i++)
+    {
+      size_t k = (i / 2) % bench_name_count;
+      const char *name = i & 1 ? ld->misses[k] : bench_names[k];
+      struct bfd_hash_entry *h;
+
+      h = bfd_hash_lookup (&ld->table, name, false, false);
+      if (h != NULL)
+	sum += h->hash;
+      else
+	sum++;
+    }
+  *ops = n;
+  return sum;
+}
+
+static void
+cleanup_hash_lookup (void *data)
+{
+  struct lookup_data *ld = (struct lookup_data *) data;
+  size_t i;
+
+  for (i = 0; i < bench_name_count; i++)
+    free ((char *) ld->misses[i]);
+  free (ld->misses);
+  bfd_hash_table_free (&ld->table);
+  free (ld);
+}
+
+/* Allocating small blocks from an objalloc, as BFD does for nearly
+   everything it reads.  */
+
+static unsigned long long
+run_objalloc (void *data ATTRIBUTE_UNUSED, size_t *ops)
+{
+  struct objalloc *o = objalloc_create ();
+  unsigned long long sum = 0;
+  size_t i, n = bench_ops ();
+
+  if (o == NULL)
+    return 0;
+  bench_srand ();
+  for (i = 0; i < n; i++)
+    {
+      unsigned int size = 8 + (bench_rand () % 32) * 8;
+      char *p = (char *) objalloc_alloc (o, size);
+
+      if (p == NULL)
+	break;
+      p[0] = (char) i;
+      sum += size;
+    }
+  objalloc_free (o);
+  *ops = n;
+  return sum;
+}
+
+/* Demangling the mangled names.  */
+
+static bool
+setup_demangle (void **data)
+{
+  const char **mangled;
+  size_t i, count = 0;
+
+  mangled = (const char **) xmalloc (bench_name_count * sizeof (*mangled));
+  for (i = 0; i < bench_name_count; i++)
+    if (bench_names[i][0] == '_' && bench_names[i][1] == 'Z')
+      mangled[count++] = bench_names[i];
+  if (count == 0)
+    {
+      free (mangled);
+      return false;
+    }
+  /* Keep the count with the names: a NULL terminates them.  */
+  mangled = (const char **) xrealloc (mangled,
+				      (count + 1) * sizeof (*mangled));
+  mangled[count] = NULL;
+  *data = mangled;
+  return true;
+}
+
+static unsigned long long
+run_demangle (void *data, size_t *ops)
+{
+  const char **mangled = (const char **) data;
+  unsigned long long sum = 0;
+  size_t i, n = bench_ops () / 10;
+  size_t count;
+
+  for (count = 0; mangled[count] != NULL; count++)
+    ;
+  for (i = 0; i < n; i++)
+    {
+      char *res = cplus_demangle_v3 (mangled[i % count],
+				     DMGL_PARAMS | DMGL_ANSI);
+
+      if (res != NULL)
+	{
+	  sum += strlen (res);
+	  free (res);
+	}
+    }
+  *ops = n;
+  return sum;
+}
+
+static void
+cleanup_free (void *data)
+{
+  free (data);
+}
+
+/* Reading LEB128 numbers of the sizes DWARF typically has.  */
+
+struct leb128_data
+{
+  bfd_byte *buf;
+  bfd_byte *end;
+};
+
+static bool
+setup_leb128 (void **data)
+{
+  struct leb128_data *ld;
+  size_t i, n = bench_ops ();
+  bfd_byte *p;
+
+  ld = (struct leb128_data *) xmalloc (sizeof (*ld));
+  ld->buf = (bfd_byte *) xmalloc (n * 10);
+  p = ld->buf;
+  bench_srand ();
+  for (i = 0; i < n; i++)
+    {
+      unsigned int r = bench_rand ();
+      bfd_vma value;
+
+      /* Mostly one or two bytes, sometimes up to five.  */
+      if (r % 16 < 10)
+	value = r >> 25;
+      else if (r % 16 < 14)
+	value = r >> 18;
+      else
+	value = r;
+      do
+	{
+	  bfd_byte byte = value & 0x7f;
+
+	  value >>= 7;
+	  if (value != 0)
+	    byte |= 0x80;
+	  *p++ = byte;
+	}
+      while (value != 0);
+    }
+  ld->end = p;
+  *data = ld;
+  return true;
+}
+
+static unsigned long long
+run_leb128 (void *data, size_t *ops)
+{
+  struct leb128_data *ld = (struct leb128_data *) data;
+  unsigned long long sum = 0;
+  bfd_byte *p = ld->buf;
+  size_t n = 0;
+
+  while (p < ld->end)
+    {
+      sum += _bfd_safe_read_leb128 (NULL, &p, false, ld->end);
+      n++;
+    }
+  *ops = n;
+  return sum;
+}
+
+static void
+cleanup_leb128 (void *data)
+{
+  struct leb128_data *ld = (struct leb128_data *) data;
+
+  free (ld->buf);
+  free (ld);
+}
+
+/* Swapping in ELF symbols.  */
+
+static bool
+setup_elf_swap_symbol (void **data)
+{
+  Elf64_External_Sym *ext;
+  size_t i, n = bench_ops ();
+
+  if (elf_bfd == NULL)
+    return false;
+  ext = (Elf64_External_Sym *) xmalloc (n * sizeof (*ext));
+  bench_srand ();
+  for (i = 0; i < n; i++)
+    {
+      Elf_Internal_Sym sym;
+
+      memset (&sym, 0, sizeof (sym));
+      sym.st_name = bench_rand () % 0x100000;
+      sym.st_value = (bfd_vma) bench_rand () << 4;
+      sym.st_size = bench_rand () % 4096;
+      sym.st_info = ELF_ST_INFO (STB_GLOBAL, STT_FUNC);
+      sym.st_shndx = 1 + bench_rand () % 32;
+      bfd_elf64_swap_symbol_out (elf_bfd, &sym, &ext[i], NULL);
+    }
+  *data = ext;
+  return true;
+}
+
+static unsigned long long
+run_elf_swap_symbol (void *data, size_t *ops)
+{
+  Elf64_External_Sym *ext = (Elf64_External_Sym *) data;
+  unsigned long long sum = 0;
+  size_t i, n = bench_ops ();
+
+  for (i = 0; i < n; i++)
+    {
+      Elf_Internal_Sym sym;
+
+      if (bfd_elf64_swap_symbol_in (elf_bfd, &ext[i], NULL, &sym))
+	sum += sym.st_name + sym.st_value + sym.st_size + sym.st_shndx;
+    }
+  *ops = n;
+  return sum;
+}
+
+/* Applying the relocations most common in x86-64 objects.  */
+
+struct reloc_data
+{
+  reloc_howto_type *howto[3];
+  bfd_byte *contents;
+};
+
+static bool
+setup_reloc (void **data)
+{
+  static const bfd_reloc_code_real_type codes[3] =
+    {
+      BFD_RELOC_32_PCREL, BFD_RELOC_64, BFD_RELOC_X86_64_PLT32
+    };
+  struct reloc_data *rd;
+  unsigned int i;
+
+  if (elf_bfd == NULL)
+    return false;
+  rd = (struct reloc_data *) xmalloc (sizeof (*rd));
+  for (i = 0; i < 3; i++)
+    {
+      rd->howto[i] = bfd_reloc_type_lookup (elf_bfd, codes[i]);
+      if (rd->howto[i] == NULL)
+	{
+	  free (rd);
+	  return false;
+	}
+    }
+  rd->contents = (bfd_byte *) xcalloc (bench_ops (), 8);
+  *data = rd;
+  return true;
+}
+
+static unsigned long long
+run_reloc (void *data, size_t *ops)
+{
+  struct reloc_data *rd = (struct reloc_data *) data;
+  unsigned long long sum = 0;
+  size_t i, n = bench_ops ();
+
+  bench_srand ();
+  for (i = 0; i < n; i++)
+    {
+      reloc_howto_type *howto = rd->howto[i % 3];
+      bfd_vma value = bench_rand () & 0x3fffffff;
+
+      if (_bfd_relocate_contents (howto, elf_bfd, value,
+				  rd->contents + i * 8) != bfd_reloc_ok)
+	sum++;
+    }
+  for (i = 0; i < n; i++)
+    sum += bfd_get_64 (elf_bfd, rd->contents + i * 8);
+  *ops = n;
+  return sum;
+}
+
+static void
+cleanup_reloc (void *data)
+{
+  struct reloc_data *rd = (struct reloc_data *) data;
+
+  free (rd->contents);
+  free (rd);
+}
+
+/* Finding the SFrame FRE for a PC, in a section of functions with
+   a few FREs each, as an unwinder would.  */
+
+#define SFRAME_FUNCS 10000
+#define SFRAME_FUNC_SIZE 256
+#define SFRAME_FRES 8
+
+static bool
+setup_sframe (void **data)
+{
+  sframe_encoder_ctx *ectx;
+  sframe_decoder_ctx *dctx;
+  unsigned char info;
+  char *buf;
+  size_t size;
+  unsigned int i, j;
+  int err = 0;
+
+  ectx = sframe_encode (SFRAME_VERSION_1, SFRAME_F_FDE_SORTED,
+			SFRAME_ABI_AMD64_ENDIAN_LITTLE,
+			SFRAME_CFA_FIXED_FP_INVALID, -8, &err);
+  if (ectx == NULL)
+    return false;
+  info = SFRAME_V1_FUNC_INFO (SFRAME_FDE_TYPE_PCINC, SFRAME_FRE_TYPE_ADDR1);
+  for (i = 0; i < SFRAME_FUNCS; i++)
+    {
+      if (sframe_encoder_add_funcdesc (ectx, i * SFRAME_FUNC_SIZE,
+				       SFRAME_FUNC_SIZE, info,
+				       SFRAME_FRES) == SFRAME_ERR)
+	break;
+      for (j = 0; j < SFRAME_FRES; j++)
+	{
+	  sframe_frame_row_entry fre;
+
+	  memset (&fre, 0, sizeof (fre));
+	  fre.fre_start_addr = j * (SFRAME_FUNC_SIZE / SFRAME_FRES);
+	  fre.fre_offsets[0] = 8 + 8 * j;
+	  fre.fre_info = SFRAME_V1_FRE_INFO (SFRAME_BASE_REG_SP, 1,
+					     SFRAME_FRE_OFFSET_1B);
+	  if (sframe_encoder_add_fre (ectx, i, &fre) == SFRAME_ERR)
+	    break;
+	}
+    }
+  buf = sframe_encoder_write (ectx, &size, &err);
+  if (buf == NULL)
+    {
+      sframe_encoder_free (&ectx);
+      return false;
+    }
+  /* The decoder keeps its own copy of the section.  */
+  dctx = sframe_decode (buf, size, &err);
+  sframe_encoder_free (&ectx);
+  if (dctx == NULL)
+    return false;
+  *data = dctx;
+  return true;
+}
+
+static bool
+setup_sframe_indexed (void **data)
+{
+  return (setup_sframe (data)
+	  && sframe_decoder_use_fre_index ((sframe_decoder_ctx *) *data) == 0);
+}
+
+static unsigned long long
+run_sframe (void *data, size_t *ops)
+{
+  sframe_decoder_ctx *dctx = (sframe_decoder_ctx *) data;
+  unsigned long long sum = 0;
+  size_t i, n = bench_ops ();
+
+  bench_srand ();
+  for (i = 0; i < n; i++)
+    {
+      int32_t pc = bench_rand () % (SFRAME_FUNCS * SFRAME_FUNC_SIZE);
+      sframe_frame_row_entry fre;
+
+      if (sframe_find_fre (dctx, pc, &fre) == 0)
+	sum += fre.fre_start_addr + fre.fre_offsets[0];
+      else
+	sum++;
+    }
+  *ops = n;
+  return sum;
+}
+
+static void
+cleanup_sframe (void *data)
+{
+  sframe_decoder_ctx *dctx = (sframe_decoder_ctx *) data;
+
+  sframe_decoder_free (&dctx);
+}
+
+/* Looking up the source lines of the input's functions.  The first
+   run also reads the DWARF, so the fastest run is the one to watch
+   for the lookups alone.  */
+
+static bool
+setup_dwarf2 (void **data ATTRIBUTE_UNUSED)
+{
+  return input_bfd != NULL;
+}
+
+static unsigned long long
+run_dwarf2 (void *data ATTRIBUTE_UNUSED, size_t *ops)
+{
+  unsigned long long sum = 0;
+  size_t n = 0;
+  long i;
+
+  for (i = 0; i < input_symcount; i++)
+    {
+      asymbol *sym = input_syms[i];
+      const char *file, *func;
+      unsigned int line;
+
+      if ((sym->flags & BSF_FUNCTION) == 0
+	  || sym->section == NULL
+	  || (sym->section->flags & SEC_CODE) == 0)
+	continue;
+      n++;
+      if (bfd_find_nearest_line (input_bfd, sym->section, input_syms,
+				 sym->value, &file, &func, &line))
+	{
+	  sum += line;
+	  if (file != NULL)
+	    sum += strlen (file);
+	}
+    }
+  *ops = n;
+  return sum;
+}
+
+struct bench
+{
+  const char *name;
+  /* What the data is: "synthetic", or "names" for the names from
+     --input if given, or "input" if --input is needed.  */
+  const char *input;
+  /* Prepare the data, returning FALSE if the benchmark can't run.  */
+  bool (*setup) (void **data);
+  /* Do one run, returning a checksum of its results and setting
+     *OPS to the operations done.  */
+  unsigned long long (*run) (void *data, size_t *ops);
+  void (*cleanup) (void *data);
+};
+
+static const struct bench benches[] =
+{
+  { "hash-hash", "names", setup_hash, run_hash_classic, NULL },
+  { "hash-hash-wide", "names", setup_hash, run_hash_wide, NULL },
+  { "hash-lookup", "names", setup_hash_lookup, run_hash_lookup,
+    cleanup_hash_lookup },
+  { "objalloc", "synthetic", setup_hash, run_objalloc, NULL },
+  { "demangle", "names", setup_demangle, run_demangle, cleanup_free },
+  { "leb128", "synthetic", setup_leb128, run_leb128, cleanup_leb128 },
+  { "elf-swap-symbol", "synthetic", setup_elf_swap_symbol,
+    run_elf_swap_symbol, cleanup_free },
+  { "reloc", "synthetic", setup_reloc, run_reloc, cleanup_reloc },
+  { "sframe-find-fre", "synthetic", setup_sframe, run_sframe,
+    cleanup_sframe },
+  { "sframe-find-fre-indexed", "synthetic", setup_sframe_indexed,
+    run_sframe, cleanup_sframe },
+  { "dwarf2-nearest-line", "input", setup_dwarf2, run_dwarf2, NULL }
+};
+
+static int
+compare_times (const void *a, const void *b)
+{
+  double ta = *(const double *) a;
+  double tb = *(const double *) b;
+
+  return ta < tb ? -1 : ta > tb;
+}
+
+/* Run B, printing its line.  Return FALSE if the checksum changed
+   between runs, which means the kernel is not doing the same work
+   each time.  */
+
+static bool
+run_bench (const struct bench *b)
+{
+  const char *input = b->input;
+  void *data = NULL;
+  double *times;
+  unsigned long long sum = 0;
+  size_t ops = 0;
+  unsigned int i;
+  bool ok = true;
+
+  if (strcmp (input, "names") == 0)
+    input = bench_names_from;
+  if (!b->setup (&data))
+    {
+      printf ("%-24s %-10s %s\n", b->name, input,
+	      strcmp (input, "input") == 0 && input_bfd == NULL
+	      ? _("skipped: needs --input") : _("skipped"));
+      return true;
+    }
+
+  times = (double *) xmalloc (bench_runs * sizeof (*times));
+  for (i = 0; i < bench_runs; i++)
+    {
+      unsigned long long start, this_sum;
+
+      start = bench_now ();
+      this_sum = b->run (data, &ops);
+      times[i] = (double) (bench_now () - start) / (ops != 0 ? ops : 1);
+      if (i == 0)
+	sum = this_sum;
+      else if (this_sum != sum)
+	ok = false;
+    }
+  if (b->cleanup != NULL)
+    b->cleanup (data);
+
+  qsort (times, bench_runs, sizeof (*times), compare_times);
+  printf ("%-24s %-10s %10lu %12.2f %12.2f  %016llx%s\n",
+	  b->name, input, (unsigned long) ops, times[0],
+	  times[bench_runs / 2], sum, ok ? "" : _("  unstable"));
+  free (times);
+  return ok;
+}
+
+static void
+usage (FILE *stream, int status)
+{
+  fprintf (stream, _("Usage: bfd-bench [option(s)]\n\
+       bfd-bench corpus [option(s)] FILE|DIRECTORY...\n"));
+  fprintf (stream, _(" Time the hot paths of BFD.\n"));
+  fprintf (stream, _(" The options are:\n\
+  --input=FILE     Take names, symbols and debug information from FILE\n\
+  --runs=N         Run each benchmark N times (default 5)\n\
+  --scale=N        Do N times the usual work in each run\n\
+  --filter=STRING  Only run the benchmarks whose name contains STRING\n\
+  --list           List the benchmarks\n\
+  --help           Display this information\n"));
+  fprintf (stream, _(" See bfd-bench corpus --help for timing whole"
+		     " workloads.\n"));
+  exit (status);
+}
+
+/* If ARG is --NAME=VALUE, return VALUE, else NULL.  */
+
+static const char *
+option_value (const char *arg, const char *name)
+{
+  size_t len = strlen (name);
+
+  if (strncmp (arg, name, len) == 0 && arg[len] == '=')
+    return arg + len + 1;
+  return NULL;
+}
+
+int
+main (int argc, char **argv)
+{
+  const char *value;
+  unsigned int i;
+  int status = 0;
+
+  program_name = *argv;
+  if (argc > 1 && strcmp (argv[1], "corpus") == 0)
+    return corpus_main (argc - 1, argv + 1);
+
+  for (i = 1; i < (unsigned int) argc; i++)
+    {
+      const char *arg = argv[i];
+
+      if ((value = option_value (arg, "--input")) != NULL)
+	bench_input_name = value;
+      else if ((value = option_value (arg, "--runs")) != NULL)
+	bench_runs = atoi (value);
+      else if ((value = option_value (arg, "--scale")) != NULL)
+	bench_scale = atoi (value);
+      else if ((value = option_value (arg, "--filter")) != NULL)
+	bench_filter = value;
+      else if (strcmp (arg, "--list") == 0)
+	{
+	  for (i = 0; i < ARRAY_SIZE (benches); i++)
+	    printf ("%s\n", benches[i].name);
+	  return 0;
+	}
+      else if (strcmp (arg, "--help") == 0)
+	usage (stdout, 0);
+      else
+	usage (stderr, 1);
+    }
+  if (bench_runs == 0 || bench_scale == 0)
+    usage (stderr, 1);
+
+  if (bfd_init () != BFD_INIT_MAGIC)
+    fatal (_("fatal error: libbfd ABI mismatch"));
+  set_default_bfd_target ();
+
+  if (bench_input_name != NULL)
+    {
+      if (!open_input (bench_input_name))
+	return 1;
+    }
+  else
+    make_synthetic_names (bench_ops () / 10);
+  elf_bfd = make_elf_bfd ();
+
+  printf ("# bfd-bench: %u runs, scale %u%s%s\n", bench_runs, bench_scale,
+	  bench_input_name != NULL ? ", input " : "",
+	  bench_input_name != NULL ? bench_input_name : "");
+  printf ("%-24s %-10s %10s %12s %12s  %s\n", "benchmark", "data",
+	  "ops/run", "min ns/op", "median ns/op", "checksum");
+  for (i = 0; i < ARRAY_SIZE (benches); i++)
+    if (bench_filter == NULL || strstr (benches[i].name, bench_filter) != NULL)
+      if (!run_bench (&benches[i]))
+	status = 1;
+
+  if (elf_bfd != NULL)
+    bfd_close_all_done (elf_bfd);
+  if (input_bfd != NULL)
+    {
+      free (input_syms);
+      bfd_close (input_bfd);
+    }
+  return status;
+}
@@ -0,0 +1,700 @@
+/* corpus.c -- time whole workloads over a corpus of binaries.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* "bfd-bench corpus" runs each workload over each file it is given,
+   in a process of its own so that every run starts cold, and prints
+   a line giving the wall time, the peak resident set of the process
+   and the I/O that BFD counted.  The objdump workloads run the
+   objdump given with --objdump, with --io-statistics; the others are
+   run by bfd-bench itself, with --run.  */
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libbfd.h"
+#include "bucomm.h"
+#include "libiberty.h"
+#include "bench.h"
+#include <dirent.h>
+
+#if defined (_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/* The kinds of file in the corpus.  */
+#define CORPUS_OBJECT 1
+#define CORPUS_ARCHIVE 2
+
+struct workload
+{
+  const char *name;
+  /* The option given to objdump, or NULL if bfd-bench runs the
+     workload itself.  */
+  const char *objdump_option;
+  /* The kinds of file it is run over.  */
+  int kinds;
+  /* For those that bfd-bench runs, do it on FILE.  */
+  int (*run) (const char *file);
+};
+
+static int run_nearest_line (const char *);
+static int run_archive_walk (const char *);
+
+static const struct workload workloads[] =
+{
+  { "objdump-d", "-d", CORPUS_OBJECT | CORPUS_ARCHIVE, NULL },
+  { "objdump-dwarf-info", "--dwarf=info", CORPUS_OBJECT | CORPUS_ARCHIVE,
+    NULL },
+  { "objdump-S", "-S", CORPUS_OBJECT | CORPUS_ARCHIVE, NULL },
+  { "objdump-t", "-t", CORPUS_OBJECT | CORPUS_ARCHIVE, NULL },
+  { "nearest-line", NULL, CORPUS_OBJECT, run_nearest_line },
+  { "archive-walk", NULL, CORPUS_ARCHIVE, run_archive_walk }
+};
+
+/* Options.  */
+static const char *corpus_objdump;
+static const char *corpus_filter;
+static unsigned int corpus_runs = 1;
+static unsigned int corpus_queries = 100000;
+
+/* What a run of a workload took.  */
+
+struct corpus_result
+{
+  /* The exit status of the process, or -1 if it could not be run.  */
+  int status;
+  unsigned long long wall_ns;
+  unsigned long long peak_kib;
+  /* Whether the process printed its I/O statistics, and what they
+     were.  */
+  bool have_io;
+  struct bfd_io_stats io;
+};
+
+/* Read the symbols of ABFD, or its dynamic symbols if it has no
+   others, setting *COUNT.  Return NULL if there are none.  */
+
+static asymbol **
+read_symbols (bfd *abfd, long *count)
+{
+  asymbol **syms;
+  long size;
+
+  *count = 0;
+  if ((bfd_get_file_flags (abfd) & HAS_SYMS) == 0)
+    return NULL;
+  size = bfd_get_symtab_upper_bound (abfd);
+  if (size > 0)
+    {
+      syms = (asymbol **) xmalloc (size);
+      *count = bfd_canonicalize_symtab (abfd, syms);
+      if (*count > 0)
+	return syms;
+      free (syms);
+    }
+  size = bfd_get_dynamic_symtab_upper_bound (abfd);
+  if (size > 0)
+    {
+      syms = (asymbol **) xmalloc (size);
+      *count = bfd_canonicalize_dynamic_symtab (abfd, syms);
+      if (*count > 0)
+	return syms;
+      free (syms);
+    }
+  *count = 0;
+  return NULL;
+}
+
+/* The nearest-line workload: open FILE and look up the source line
+   of its functions --queries times over, as a symbolizer would for
+   the addresses in a profile.  Later rounds look a little further
+   into each function, so that they are not all answered by the same
+   line table row.  */
+
+static int
+run_nearest_line (const char *file)
+{
+  bfd *abfd;
+  asymbol **syms;
+  asymbol **funcs;
+  long count, nfuncs, i;
+  unsigned int q;
+
+  abfd = bfd_openr (file, NULL);
+  if (abfd == NULL || !bfd_check_format (abfd, bfd_object))
+    {
+      bfd_nonfatal (file);
+      if (abfd != NULL)
+	bfd_close (abfd);
+      return 1;
+    }
+
+  syms = read_symbols (abfd, &count);
+  funcs = (asymbol **) xmalloc ((count + 1) * sizeof (*funcs));
+  for (i = nfuncs = 0; i < count; i++)
+    if ((syms[i]->flags & BSF_FUNCTION) != 0
+	&& syms[i]->section != NULL
+	&& (syms[i]->section->flags & SEC_CODE) != 0)
+      funcs[nfuncs++] = syms[i];
+
+  for (q = 0; nfuncs != 0 && q < corpus_queries; q++)
+    {
+      asymbol *sym = funcs[q % nfuncs];
+      bfd_vma offset = sym->value + (q / nfuncs) % 64;
+      const char *filename, *func;
+      unsigned int line;
+
+      if (offset < bfd_section_size (sym->section))
+	bfd_find_nearest_line (abfd, sym->section, syms, offset,
+			       &filename, &func, &line);
+    }
+
+  free (funcs);
+  free (syms);
+  bfd_close (abfd);
+  return 0;
+}
+
+/* The archive-walk workload: open each member of the archive FILE in
+   turn and read its symbols, as a linker or nm does.  */
+
+static int
+run_archive_walk (const char *file)
+{
+  bfd *abfd, *member;
+  int status = 0;
+
+  abfd = bfd_openr (file, NULL);
+  if (abfd == NULL || !bfd_check_format (abfd, bfd_archive))
+    {
+      bfd_nonfatal (file);
+      if (abfd != NULL)
+	bfd_close (abfd);
+      return 1;
+    }
+
+  for (member = bfd_openr_next_archived_file (abfd, NULL);
+       member != NULL;
+       member = bfd_openr_next_archived_file (abfd, member))
+    if (bfd_check_format (member, bfd_object))
+      {
+	asymbol **syms;
+	long count;
+
+	syms = read_symbols (member, &count);
+	free (syms);
+      }
+  if (bfd_get_error () != bfd_error_no_more_archived_files)
+    {
+      bfd_nonfatal (file);
+      status = 1;
+    }
+
+  bfd_close (abfd);
+  return status;
+}
+
+/* Return the kinds of file that FILE is, or 0 if it is neither an
+   object nor an archive that BFD knows.  */
+
+static int
+classify (const char *file)
+{
+  bfd *abfd;
+  int kind = 0;
+
+  abfd = bfd_openr (file, NULL);
+  if (abfd == NULL)
+    return 0;
+  if (bfd_check_format (abfd, bfd_archive))
+    kind = CORPUS_ARCHIVE;
+  else if (bfd_check_format (abfd, bfd_object))
+    kind = CORPUS_OBJECT;
+  bfd_close (abfd);
+  return kind;
+}
+
+/* The files of the corpus, sorted within each directory.  */
+static char **corpus_files;
+static size_t corpus_file_count;
+static size_t corpus_file_alloc;
+
+static void
+add_file (char *file)
+{
+  if (corpus_file_count == corpus_file_alloc)
+    {
+      corpus_file_alloc = corpus_file_alloc ? corpus_file_alloc * 2 : 64;
+      corpus_files = (char **) xrealloc (corpus_files,
+					 (corpus_file_alloc
+					  * sizeof (*corpus_files)));
+    }
+  corpus_files[corpus_file_count++] = file;
+}
+
+static int
+compare_file_names (const void *a, const void *b)
+{
+  return strcmp (*(const char **) a, *(const char **) b);
+}
+
+/* Add PATH to the corpus, or if it is a directory the files in it.  */
+
+static void
+add_path (const char *path)
+{
+  struct stat st;
+  DIR *d;
+  struct dirent *ent;
+  size_t first;
+
+  if (stat (path, &st) != 0 || !S_ISDIR (st.st_mode))
+    {
+      add_file (xstrdup (path));
+      return;
+    }
+
+  d = opendir (path);
+  if (d == NULL)
+    {
+      non_fatal (_("cannot read directory %s"), path);
+      return;
+    }
+  first = corpus_file_count;
+  while ((ent = readdir (d)) != NULL)
+    {
+      char *file = concat (path, "/", ent->d_name, NULL);
+
+      if (stat (file, &st) == 0 && S_ISREG (st.st_mode))
+	add_file (file);
+      else
+	free (file);
+    }
+  closedir (d);
+  qsort (corpus_files + first, corpus_file_count - first,
+	 sizeof (*corpus_files), compare_file_names);
+}
+
+/* Read the standard error of a run from FILE into R.  The block that
+   --io-statistics prints is parsed, and the rest passed on.  */
+
+static void
+read_child_errors (const char *file, struct corpus_result *r)
+{
+  char line[1024];
+  bool in_io = false;
+  FILE *f;
+
+  f = fopen (file, "r");
+  if (f == NULL)
+    return;
+  while (fgets (line, sizeof (line), f) != NULL)
+    {
+      unsigned long long a, b, c;
+      char ch;
+
+      if (strcmp (line, "I/O statistics:\n") == 0)
+	{
+	  in_io = true;
+	  r->have_io = true;
+	  continue;
+	}
+      if (in_io && line[0] == '\t')
+	{
+	  if (sscanf (line, "\t%llu reads, %llu bytes", &a, &b) == 2)
+	    {
+	      r->io.reads = a;
+	      r->io.read_bytes = b;
+	    }
+	  else if (sscanf (line, "\t%llu writes, %llu bytes", &a, &b) == 2)
+	    {
+	      r->io.writes = a;
+	      r->io.write_bytes = b;
+	    }
+	  else if (sscanf (line, "\t%llu seek%c", &a, &ch) == 2)
+	    r->io.seeks = a;
+	  else if (sscanf (line, "\t%llu maps, %llu bytes", &a, &b) == 2)
+	    {
+	      r->io.maps = a;
+	      r->io.mapped_bytes = b;
+	    }
+	  else if (sscanf (line, "\t%llu opens, %llu reopens, %llu evictions",
+			   &a, &b, &c) == 3)
+	    {
+	      r->io.opens = a;
+	      r->io.reopens = b;
+	      r->io.evictions = c;
+	    }
+	  continue;
+	}
+      in_io = false;
+      fputs (line, stderr);
+    }
+  fclose (f);
+}
+
+#if defined (_WIN32)
+
+/* Join ARGS into a command line that the C runtime of the child will
+   split back into the same arguments.  */
+
+static char *
+windows_command_line (char *const *args)
+{
+  char *const *a;
+  size_t size = 1;
+  char *cmd, *p;
+
+  for (a = args; *a != NULL; a++)
+    size += 2 * strlen (*a) + 3;
+  cmd = p = (char *) xmalloc (size);
+  for (a = args; *a != NULL; a++)
+    {
+      const char *s;
+      size_t backslashes = 0;
+
+      if (a != args)
+	*p++ = ' ';
+      *p++ = '"';
+      for (s = *a; *s != 0; s++)
+	{
+	  if (*s == '\\')
+	    backslashes++;
+	  else
+	    {
+	      /* Backslashes before a quote are doubled, and the quote
+		 escaped.  */
+	      if (*s == '"')
+		{
+		  memset (p, '\\', backslashes + 1);
+		  p += backslashes + 1;
+		}
+	      backslashes = 0;
+	    }
+	  *p++ = *s;
+	}
+      /* As are those before the closing quote.  */
+      memset (p, '\\', backslashes);
+      p += backslashes;
+      *p++ = '"';
+    }
+  *p = 0;
+  return cmd;
+}
+
+#endif
+
+/* Run ARGS, with its standard output discarded and its standard
+   error to the file ERRS, and fill in R.  */
+
+static void
+run_child (char *const *args, const char *errs, struct corpus_result *r)
+{
+  unsigned long long start;
+#if defined (_WIN32)
+  SECURITY_ATTRIBUTES sa;
+  STARTUPINFOA si;
+  PROCESS_INFORMATION pi;
+  PROCESS_MEMORY_COUNTERS pmc;
+  HANDLE out, err;
+  DWORD code;
+  char *cmd;
+  BOOL ok;
+
+  r->status = -1;
+  memset (&sa, 0, sizeof (sa));
+  sa.nLength = sizeof (sa);
+  sa.bInheritHandle = TRUE;
+  out = CreateFileA ("NUL", GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		     &sa, OPEN_EXISTING, 0, NULL);
+  err = CreateFileA (errs, GENERIC_WRITE, FILE_SHARE_READ, &sa,
+		     CREATE_ALWAYS, 0, NULL);
+  if (out == INVALID_HANDLE_VALUE || err == INVALID_HANDLE_VALUE)
+    {
+      if (out != INVALID_HANDLE_VALUE)
+	CloseHandle (out);
+      if (err != INVALID_HANDLE_VALUE)
+	CloseHandle (err);
+      return;
+    }
+
+  memset (&si, 0, sizeof (si));
+  si.cb = sizeof (si);
+  si.dwFlags = STARTF_USESTDHANDLES;
+  si.hStdInput = GetStdHandle (STD_INPUT_HANDLE);
+  si.hStdOutput = out;
+  si.hStdError = err;
+  cmd = windows_command_line (args);
+  start = bench_now ();
+  ok = CreateProcessA (NULL, cmd, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi);
+  free (cmd);
+  CloseHandle (out);
+  CloseHandle (err);
+  if (!ok)
+    return;
+
+  WaitForSingleObject (pi.hProcess, INFINITE);
+  r->wall_ns = bench_now () - start;
+  if (GetProcessMemoryInfo (pi.hProcess, &pmc, sizeof (pmc)))
+    r->peak_kib = pmc.PeakWorkingSetSize / 1024;
+  if (GetExitCodeProcess (pi.hProcess, &code))
+    r->status = code;
+  CloseHandle (pi.hThread);
+  CloseHandle (pi.hProcess);
+#else
+  struct rusage ru;
+  pid_t pid;
+  int status;
+
+  r->status = -1;
+  start = bench_now ();
+  pid = fork ();
+  if (pid == 0)
+    {
+      int out = open ("/dev/null", O_WRONLY);
+      int err = open (errs, O_WRONLY | O_TRUNC);
+
+      if (out >= 0)
+	dup2 (out, 1);
+      if (err >= 0)
+	dup2 (err, 2);
+      execvp (args[0], args);
+      _exit (127);
+    }
+  if (pid < 0 || wait4 (pid, &status, 0, &ru) != pid)
+    return;
+  r->wall_ns = bench_now () - start;
+  /* In kilobytes on GNU/Linux, though other hosts differ.  */
+  r->peak_kib = ru.ru_maxrss;
+  if (WIFEXITED (status))
+    r->status = WEXITSTATUS (status);
+  else if (WIFSIGNALED (status))
+    r->status = 128 + WTERMSIG (status);
+#endif
+  read_child_errors (errs, r);
+}
+
+/* Run workload W over FILE --runs times, and print its line.  Return
+   FALSE if it failed.  */
+
+static bool
+run_workload (const struct workload *w, char *file)
+{
+  struct corpus_result best, r;
+  unsigned long long peak;
+  char *args[7];
+  char *run_option = NULL, *queries_option = NULL;
+  char *errs;
+  unsigned int i;
+  int n = 0;
+
+  if (w->run != NULL)
+    {
+      run_option = concat ("--run=", w->name, NULL);
+      queries_option = (char *) xmalloc (32);
+      sprintf (queries_option, "--queries=%u", corpus_queries);
+      args[n++] = (char *) program_name;
+      args[n++] = (char *) "corpus";
+      args[n++] = run_option;
+      args[n++] = queries_option;
+    }
+  else
+    {
+      args[n++] = (char *) corpus_objdump;
+      args[n++] = (char *) "--io-statistics";
+      args[n++] = (char *) w->objdump_option;
+    }
+  args[n++] = file;
+  args[n] = NULL;
+
+  errs = make_temp_file (NULL);
+  memset (&best, 0, sizeof (best));
+  for (i = 0; i < corpus_runs; i++)
+    {
+      memset (&r, 0, sizeof (r));
+      run_child (args, errs, &r);
+      if (r.status != 0)
+	{
+	  best = r;
+	  break;
+	}
+      /* Keep the fastest time and the largest peak.  */
+      peak = best.peak_kib > r.peak_kib ? best.peak_kib : r.peak_kib;
+      if (i == 0 || r.wall_ns < best.wall_ns)
+	best = r;
+      best.peak_kib = peak;
+    }
+  unlink (errs);
+  free (errs);
+  free (run_option);
+  free (queries_option);
+
+  printf ("%-20s %10.1f %10llu", w->name, best.wall_ns / 1e6, best.peak_kib);
+  if (best.have_io)
+    printf (" %10llu %10llu %10llu %10llu %8llu",
+	    best.io.reads, best.io.read_bytes / 1024, best.io.seeks,
+	    best.io.mapped_bytes / 1024, best.io.reopens);
+  else
+    printf (" %10s %10s %10s %10s %8s", "-", "-", "-", "-", "-");
+  if (best.status < 0)
+    printf (" %6s  %s\n", _("error"), file);
+  else
+    printf (" %6d  %s\n", best.status, file);
+  fflush (stdout);
+  return best.status == 0;
+}
+
+static void
+corpus_usage (FILE *stream, int status)
+{
+  fprintf (stream,
+	   _("Usage: bfd-bench corpus [option(s)] FILE|DIRECTORY...\n"));
+  fprintf (stream, _(" Time objdump and symbolization over a corpus of"
+		     " binaries and archives.\n"));
+  fprintf (stream, _(" The options are:\n\
+  --objdump=PROGRAM  Run PROGRAM for the objdump workloads; without it\n\
+                     they are skipped\n\
+  --runs=N           Run each workload N times and keep the fastest\n\
+  --queries=N        Look up N addresses in the nearest-line workload\n\
+                     (default 100000)\n\
+  --filter=STRING    Only run the workloads whose name contains STRING\n\
+  --list             List the workloads\n\
+  --help             Display this information\n"));
+  fprintf (stream, _(" The files in a DIRECTORY are taken, but not those"
+		     " in its subdirectories.\n"));
+  exit (status);
+}
+
+/* If ARG is --NAME=VALUE, return VALUE, else NULL.  */
+
+static const char *
+option_value (const char *arg, const char *name)
+{
+  size_t len = strlen (name);
+
+  if (strncmp (arg, name, len) == 0 && arg[len] == '=')
+    return arg + len + 1;
+  return NULL;
+}
+
+int
+corpus_main (int argc, char **argv)
+{
+  const char *value;
+  const char *run = NULL;
+  size_t f;
+  unsigned int i;
+  int status = 0;
+  int argi;
+
+  for (argi = 1; argi < argc && argv[argi][0] == '-'; argi++)
+    {
+      const char *arg = argv[argi];
+
+      if ((value = option_value (arg, "--objdump")) != NULL)
+	corpus_objdump = value;
+      else if ((value = option_value (arg, "--runs")) != NULL)
+	corpus_runs = atoi (value);
+      else if ((value = option_value (arg, "--queries")) != NULL)
+	corpus_queries = atoi (value);
+      else if ((value = option_value (arg, "--filter")) != NULL)
+	corpus_filter = value;
+      else if ((value = option_value (arg, "--run")) != NULL)
+	run = value;
+      else if (strcmp (arg, "--list") == 0)
+	{
+	  for (i = 0; i < ARRAY_SIZE (workloads); i++)
+	    printf ("%s\n", workloads[i].name);
+	  return 0;
+	}
+      else if (strcmp (arg, "--help") == 0)
+	corpus_usage (stdout, 0);
+      else
+	corpus_usage (stderr, 1);
+    }
+  if (argi == argc || corpus_runs == 0)
+    corpus_usage (stderr, 1);
+
+  if (bfd_init () != BFD_INIT_MAGIC)
+    fatal (_("fatal error: libbfd ABI mismatch"));
+  set_default_bfd_target ();
+
+  /* A single run of a workload by bfd-bench itself, for a parent
+     that is timing it.  */
+  if (run != NULL)
+    {
+      if (argi != argc - 1)
+	corpus_usage (stderr, 1);
+      for (i = 0; i < ARRAY_SIZE (workloads); i++)
+	if (workloads[i].run != NULL && strcmp (workloads[i].name, run) == 0)
+	  {
+	    bfd_set_io_statistics (true);
+	    status = workloads[i].run (argv[argi]);
+	    bfd_print_io_statistics (stderr, NULL);
+	    return status;
+	  }
+      fatal (_("unknown workload %s"), run);
+    }
+
+  for (; argi < argc; argi++)
+    add_path (argv[argi]);
+
+  printf ("# bfd-bench corpus: %u file(s), %u run(s)%s%s\n",
+	  (unsigned int) corpus_file_count, corpus_runs,
+	  corpus_objdump != NULL ? ", objdump " : "",
+	  corpus_objdump != NULL ? corpus_objdump : "");
+  printf ("%-20s %10s %10s %10s %10s %10s %10s %8s %6s  %s\n",
+	  "workload", "wall ms", "peak KiB", "reads", "read KiB", "seeks",
+	  "mapped KiB", "reopens", "status", "file");
+  for (f = 0; f < corpus_file_count; f++)
+    {
+      char *file = corpus_files[f];
+      int kind = classify (file);
+
+      if (kind == 0)
+	{
+	  printf ("# %s: %s\n", file, _("not an object or archive, skipped"));
+	  continue;
+	}
+      for (i = 0; i < ARRAY_SIZE (workloads); i++)
+	{
+	  const struct workload *w = &workloads[i];
+
+	  if ((w->kinds & kind) == 0
+	      || (w->run == NULL && corpus_objdump == NULL)
+	      || (corpus_filter != NULL
+		  && strstr (w->name, corpus_filter) == NULL))
+	    continue;
+	  if (!run_workload (w, file))
+	    status = 1;
+	}
+    }
+
+  for (f = 0; f < corpus_file_count; f++)
+    free (corpus_files[f]);
+  free (corpus_files);
+  return status;
+}
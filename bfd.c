@@ -85,6 +85,11 @@ CODE_FRAGMENT
 .     least-recently-used list of BFDs.  *}
 .  struct bfd *lru_prev, *lru_next;
 .
+.  {* The number of reads of the file going on without the caching
+.     routines' lock held.  The file is not closed to make room for
+.     another while this is non-zero.  *}
+.  unsigned int cache_pins;
+.
 .  {* Track current file position (or current buffer offset for
 .     in-memory BFDs).  When a file is closed by the caching routines,
 .     BFD retains state information on the file here.  *}
@@ -259,6 +264,10 @@ CODE_FRAGMENT
 .     that BFD is not prepared to handle for objcopy/strip.  *}
 .  unsigned int read_only : 1;
 .
+.  {* Set when the section list has changed since the index used by
+.     <<bfd_get_section_by_vma>> was built.  *}
+.  unsigned int section_map_stale : 1;
+.
 .  {* Set to dummy BFD created when claimed by a compiler plug-in
 .     library.  *}
 .  bfd *plugin_dummy_bfd;
@@ -299,6 +308,12 @@ CODE_FRAGMENT
 .  {* The total size of memory from bfd_alloc.  *}
 .  bfd_size_type alloc_size;
 .
+.  {* If memory accounting is on, the memory from bfd_alloc by class.  *}
+.  struct bfd_memory_usage *memory_usage;
+.
+.  {* If I/O statistics are on, the I/O done by this BFD.  *}
+.  struct bfd_io_stats *io_stats;
+.
 .  {* Stuff only useful for object files:
 .     The start address.  *}
 .  bfd_vma start_address;
@@ -380,6 +395,43 @@ CODE_FRAGMENT
 .
 .  {* For input BFDs, the build ID, if the object has one. *}
 .  const struct bfd_build_id *build_id;
+.
+.  {* Section contents views handed out by bfd_get_section_contents_view,
+.     released when the BFD is closed.  *}
+.  struct bfd_mmapped *mmapped;
+.
+.  {* If not NULL, a read-only mapping of the whole file made by
+.     <<bfd_map_file_image>>, which reads of the file and of its
+.     archive members are served from.  *}
+.  struct bfd_mmapped *file_image;
+.
+.  {* The address index built by <<bfd_find_symbol_for_address>>, in
+.     the memory of this BFD.  *}
+.  struct bfd_symbol_index *symbol_index;
+.
+.  {* If not NULL, the pool this BFD keeps its names in.  *}
+.  struct bfd_name_pool *name_pool;
+.
+.  {* The section index built by <<bfd_get_section_by_vma>> and
+.     <<bfd_get_section_by_index>>.  *}
+.  struct bfd_section_map *section_map;
+.
+.  {* The sorted relocs kept by <<bfd_canonicalize_reloc_sorted>>,
+.     in the memory of this BFD.  *}
+.  struct bfd_sorted_relocs *sorted_relocs;
+.
+.  {* The unwind table built by <<bfd_unwind_find_row>>, in the
+.     memory of this BFD.  *}
+.  struct bfd_unwind_table *unwind_table;
+.
+.  {* The link state kept by
+.     <<bfd_simple_get_relocated_section_contents>>.  *}
+.  struct bfd_simple_link *simple_link;
+.
+.  {* The frame indexes built by
+.     <<bfd_get_decompressed_section_contents>>, in the memory of
+.     this BFD.  *}
+.  struct bfd_frame_index *frame_indexes;
 .};
 .
 
@@ -551,6 +603,7 @@ EXTERNAL
 .    next->prev = prev;
 .  else
 .    abfd->section_last = prev;
+.  abfd->section_map_stale = 1;
 .}
 .
 .static inline void
@@ -568,6 +621,7 @@ EXTERNAL
 .      abfd->sections = s;
 .    }
 .  abfd->section_last = s;
+.  abfd->section_map_stale = 1;
 .}
 .
 .static inline void
@@ -585,6 +639,7 @@ EXTERNAL
 .      abfd->section_last = s;
 .    }
 .  abfd->sections = s;
+.  abfd->section_map_stale = 1;
 .}
 .
 .static inline void
@@ -598,6 +653,7 @@ EXTERNAL
 .    next->prev = s;
 .  else
 .    abfd->section_last = s;
+.  abfd->section_map_stale = 1;
 .}
 .
 .static inline void
@@ -611,6 +667,7 @@ EXTERNAL
 .    prev->next = s;
 .  else
 .    abfd->sections = s;
+.  abfd->section_map_stale = 1;
 .}
 .
 .static inline bool
@@ -702,10 +759,13 @@ CODE_FRAGMENT
 .
 */
 
-static bfd_error_type bfd_error;
-static bfd_error_type input_error;
-static bfd *input_bfd;
-static char *input_error_msg;
+/* The error status is kept per thread, so that BFDs may be used from
+   several threads at once.  */
+
+static TLS bfd_error_type bfd_error;
+static TLS bfd_error_type input_error;
+static TLS bfd *input_bfd;
+static TLS char *input_error_msg;
 
 const char *const bfd_errmsgs[] =
 {
@@ -1427,7 +1487,7 @@ err_sprintf (void *stream, const char *fmt, ...)
 /* Communicate the bfd processed by bfd_check_format_matches to the
    error handling function error_handler_sprintf.  */
 
-static bfd *error_handler_bfd;
+static TLS bfd *error_handler_bfd;
 
 /* An error handler that prints to a string, then dups that string to
    a per-xvec cache.  */
@@ -1463,6 +1523,11 @@ error_handler_sprintf (const char *fmt, va_list ap)
 
 static bfd_error_handler_type _bfd_error_internal = error_handler_fprintf;
 
+/* If non-NULL, the handler used for messages issued by this thread in
+   place of _bfd_error_internal.  */
+
+static TLS bfd_error_handler_type _bfd_thread_error_internal;
+
 /*
 FUNCTION
 	_bfd_error_handler
@@ -1483,13 +1548,39 @@ DESCRIPTION
 	Beware: Only supports a maximum of 9 format arguments.
 */
 
+static void error_handler_buffer (const char *, va_list);
+static bool error_limit_reached (void);
+
+/* Call HANDLER with FMT and the arguments that follow.  */
+
+static void
+error_handler_call (bfd_error_handler_type handler, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start (ap, fmt);
+  handler (fmt, ap);
+  va_end (ap);
+}
+
 void
 _bfd_error_handler (const char *fmt, ...)
 {
+  bfd_error_handler_type handler = _bfd_thread_error_internal;
   va_list ap;
 
+  if (handler == NULL)
+    handler = _bfd_error_internal;
+
+  /* Messages being kept for later are counted towards the limit
+     when they are passed on.  */
+  if (handler != error_handler_buffer
+      && handler != error_handler_sprintf
+      && error_limit_reached ())
+    return;
+
   va_start (ap, fmt);
-  _bfd_error_internal (fmt, ap);
+  handler (fmt, ap);
   va_end (ap);
 }
 
@@ -1502,7 +1593,8 @@ SYNOPSIS
 
 DESCRIPTION
 	Set the BFD error handler function.  Returns the previous
-	function.
+	function.  The handler is used by all threads that have not
+	installed their own with <<bfd_set_thread_error_handler>>.
 */
 
 bfd_error_handler_type
@@ -1515,6 +1607,32 @@ bfd_set_error_handler (bfd_error_handler_type pnew)
   return pold;
 }
 
+/*
+FUNCTION
+	bfd_set_thread_error_handler
+
+SYNOPSIS
+	bfd_error_handler_type bfd_set_thread_error_handler
+	  (bfd_error_handler_type);
+
+DESCRIPTION
+	Set the BFD error handler function for the calling thread
+	only, overriding the one set by <<bfd_set_error_handler>>.
+	Passing NULL reverts the thread to the process wide handler.
+	Returns the previous thread handler, which is NULL if none
+	was set.
+*/
+
+bfd_error_handler_type
+bfd_set_thread_error_handler (bfd_error_handler_type pnew)
+{
+  bfd_error_handler_type pold;
+
+  pold = _bfd_thread_error_internal;
+  _bfd_thread_error_internal = pnew;
+  return pold;
+}
+
 /*
 INTERNAL_FUNCTION
 	_bfd_set_error_handler_caching
@@ -1523,15 +1641,227 @@ SYNOPSIS
 	bfd_error_handler_type _bfd_set_error_handler_caching (bfd *);
 
 DESCRIPTION
-	Set the BFD error handler function to one that stores messages
-	to the per_xvec_warn array.  Returns the previous function.
+	Set the calling thread's BFD error handler function to one that
+	stores messages to the per_xvec_warn array.  Returns the
+	previous thread handler, to be restored with
+	<<bfd_set_thread_error_handler>>.
 */
 
 bfd_error_handler_type
 _bfd_set_error_handler_caching (bfd *abfd)
 {
   error_handler_bfd = abfd;
-  return bfd_set_error_handler (error_handler_sprintf);
+  return bfd_set_thread_error_handler (error_handler_sprintf);
+}
+
+/* The most messages to pass on, or zero for no limit, and the number
+   passed on or dropped so far.  */
+
+static unsigned int error_limit;
+static int error_count;
+
+/*
+FUNCTION
+	bfd_set_error_limit
+
+SYNOPSIS
+	unsigned int bfd_set_error_limit (unsigned int limit);
+
+DESCRIPTION
+	Pass at most @var{limit} more messages to the BFD error
+	handler, dropping the rest without formatting them after a
+	note that they were dropped.  Zero, the default, passes all
+	messages on.  Returns the previous limit.
+*/
+
+unsigned int
+bfd_set_error_limit (unsigned int limit)
+{
+  unsigned int old = error_limit;
+
+  error_limit = limit;
+  error_count = 0;
+  return old;
+}
+
+/* Count a message towards the limit, returning true if it should be
+   dropped.  */
+
+static bool
+error_limit_reached (void)
+{
+  unsigned int count;
+
+  if (error_limit == 0)
+    return false;
+  count = _bfd_atomic_add (&error_count, 1);
+  if (count <= error_limit)
+    return false;
+  if (count == error_limit + 1)
+    {
+      bfd_error_handler_type handler = _bfd_thread_error_internal;
+
+      if (handler == NULL)
+	handler = _bfd_error_internal;
+      error_handler_call (handler, _("further messages suppressed"));
+    }
+  return true;
+}
+
+/*
+INTERNAL_DEFINITION
+	_bfd_error_buffer
+
+DESCRIPTION
+	A <<_bfd_error_buffer>> holds the messages issued by one piece
+	of work done in parallel with others, so that they can be
+	passed on in a fixed order once all the pieces are done.  One
+	that is all zero is empty.
+
+.struct _bfd_error_buffer
+.{
+.  {* The messages kept, each ending in a NUL.  *}
+.  char *text;
+.  size_t size;
+.  size_t alloc;
+.  {* The number of messages kept, and the number dropped.  *}
+.  unsigned int kept;
+.  unsigned int dropped;
+.};
+.
+*/
+
+/* The buffer that error_handler_buffer adds to.  */
+
+static TLS struct _bfd_error_buffer *error_buffer;
+
+/* An error handler that formats messages into error_buffer.  Once a
+   buffer holds as many messages as the limit allows, the rest are
+   just counted, since they would be dropped anyway.  */
+
+static void
+error_handler_buffer (const char *fmt, va_list ap)
+{
+  struct _bfd_error_buffer *buf = error_buffer;
+  union _bfd_doprnt_args args[MAX_ARGS];
+  char error_buf[1024];
+  struct buf_stream error_stream;
+  size_t len;
+
+  if (error_limit != 0 && buf->kept >= error_limit)
+    {
+      buf->dropped++;
+      return;
+    }
+
+  _bfd_doprnt_scan (fmt, ap, args);
+
+  error_stream.ptr = error_buf;
+  error_stream.left = sizeof (error_buf);
+  _bfd_doprnt (err_sprintf, &error_stream, fmt, args);
+
+  len = error_stream.ptr - error_buf;
+  if (len == sizeof (error_buf))
+    len--;
+  if (buf->size + len + 1 > buf->alloc)
+    {
+      size_t alloc = buf->alloc ? buf->alloc * 2 : 4096;
+      char *text;
+
+      while (buf->size + len + 1 > alloc)
+	alloc *= 2;
+      text = (char *) realloc (buf->text, alloc);
+      if (text == NULL)
+	{
+	  buf->dropped++;
+	  return;
+	}
+      buf->text = text;
+      buf->alloc = alloc;
+    }
+  memcpy (buf->text + buf->size, error_buf, len);
+  buf->text[buf->size + len] = 0;
+  buf->size += len + 1;
+  buf->kept++;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_error_buffer_begin
+
+SYNOPSIS
+	bfd_error_handler_type _bfd_error_buffer_begin
+	  (struct _bfd_error_buffer *buf,
+	   struct _bfd_error_buffer **old_buf);
+
+DESCRIPTION
+	Have the calling thread's messages formatted into @var{buf}
+	instead of being passed to the error handler.  Returns the
+	previous thread handler, and sets @var{old_buf} to the
+	previous buffer, to be restored with
+	<<_bfd_error_buffer_end>>.
+*/
+
+bfd_error_handler_type
+_bfd_error_buffer_begin (struct _bfd_error_buffer *buf,
+			 struct _bfd_error_buffer **old_buf)
+{
+  *old_buf = error_buffer;
+  error_buffer = buf;
+  return bfd_set_thread_error_handler (error_handler_buffer);
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_error_buffer_end
+
+SYNOPSIS
+	void _bfd_error_buffer_end
+	  (bfd_error_handler_type old, struct _bfd_error_buffer *old_buf);
+
+DESCRIPTION
+	Undo a call to <<_bfd_error_buffer_begin>> that returned
+	@var{old} and set @var{old_buf}.
+*/
+
+void
+_bfd_error_buffer_end (bfd_error_handler_type old,
+		       struct _bfd_error_buffer *old_buf)
+{
+  bfd_set_thread_error_handler (old);
+  error_buffer = old_buf;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_error_buffer_flush
+
+SYNOPSIS
+	void _bfd_error_buffer_flush (struct _bfd_error_buffer *buf);
+
+DESCRIPTION
+	Pass the messages in @var{buf} to the calling thread's error
+	handler, in the order they were issued, and empty @var{buf}.
+*/
+
+void
+_bfd_error_buffer_flush (struct _bfd_error_buffer *buf)
+{
+  const char *msg = buf->text;
+  unsigned int i;
+
+  for (i = 0; i < buf->kept; i++)
+    {
+      _bfd_error_handler ("%s", msg);
+      msg += strlen (msg) + 1;
+    }
+  for (i = 0; i < buf->dropped; i++)
+    if (_bfd_thread_error_internal == error_handler_buffer)
+      error_buffer->dropped++;
+    else
+      error_limit_reached ();
+  free (buf->text);
+  memset (buf, 0, sizeof (*buf));
 }
 
 /*
@@ -1747,6 +2077,155 @@ bfd_canonicalize_reloc (bfd *abfd,
 		   (abfd, asect, location, symbols));
 }
 
+/* The relocs of one section, or the dynamic relocs, sorted by
+   address.  */
+
+struct sorted_relocs
+{
+  /* What the relocs were read with.  */
+  asymbol **syms;
+  arelent *relocation;
+  arelent **relocs;
+  long long count;
+};
+
+struct bfd_sorted_relocs
+{
+  /* Indexed by section index, COUNT of them.  */
+  unsigned int count;
+  struct sorted_relocs *by_index;
+  struct sorted_relocs dynamic;
+};
+
+/* Sort relocs by address.  Relocs at the same address keep their
+   order, as those tied together are read in the order they apply.  */
+
+static int
+compare_sorted_relocs (const void *ap, const void *bp)
+{
+  const arelent *a = * (const arelent **) ap;
+  const arelent *b = * (const arelent **) bp;
+
+  if (a->address != b->address)
+    return a->address < b->address ? -1 : 1;
+  if (a != b)
+    return a < b ? -1 : 1;
+  return 0;
+}
+
+/*
+FUNCTION
+	bfd_canonicalize_reloc_sorted
+
+SYNOPSIS
+	long long bfd_canonicalize_reloc_sorted
+	  (bfd *abfd, asection *sec, asymbol **syms, arelent ***relocs);
+
+DESCRIPTION
+	Like <<bfd_canonicalize_reloc>>, but set *@var{relocs} to an
+	array of the relocs of @var{sec} sorted by address.  Relocs at
+	the same address stay in the order they have in the file.  If
+	@var{sec} is NULL, the dynamic relocs are given instead, as by
+	<<bfd_canonicalize_dynamic_reloc>>.  Returns the number of
+	relocs, or -1 on error.
+
+	The array is kept in the memory of @var{abfd}, and must not be
+	freed or changed.  Later calls for the same section with the
+	same @var{syms} return it again without reading or sorting the
+	relocs, for as long as the section's canonical relocs stay the
+	same.
+*/
+
+long long
+bfd_canonicalize_reloc_sorted (bfd *abfd,
+			       sec_ptr asect,
+			       asymbol **symbols,
+			       arelent ***relocs)
+{
+  struct bfd_sorted_relocs *cache = abfd->sorted_relocs;
+  struct sorted_relocs *ent;
+  arelent **rel;
+  long long size, count, i;
+
+  *relocs = NULL;
+  if (abfd->format != bfd_object)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return -1;
+    }
+
+  if (cache == NULL || (asect != NULL && asect->index >= cache->count))
+    {
+      struct bfd_sorted_relocs *nc;
+
+      nc = (struct bfd_sorted_relocs *) bfd_zalloc (abfd, sizeof (*nc));
+      if (nc == NULL)
+	return -1;
+      nc->count = abfd->section_count;
+      if (asect != NULL && asect->index >= nc->count)
+	nc->count = asect->index + 1;
+      if (nc->count != 0)
+	{
+	  nc->by_index = ((struct sorted_relocs *)
+			  bfd_zalloc (abfd,
+				      nc->count * sizeof (*nc->by_index)));
+	  if (nc->by_index == NULL)
+	    return -1;
+	}
+      if (cache != NULL)
+	{
+	  if (cache->count != 0)
+	    memcpy (nc->by_index, cache->by_index,
+		    cache->count * sizeof (*nc->by_index));
+	  nc->dynamic = cache->dynamic;
+	}
+      abfd->sorted_relocs = cache = nc;
+    }
+
+  ent = asect != NULL ? &cache->by_index[asect->index] : &cache->dynamic;
+  if (ent->relocs != NULL
+      && ent->syms == symbols
+      && (asect == NULL || ent->relocation == asect->relocation))
+    {
+      *relocs = ent->relocs;
+      return ent->count;
+    }
+
+  if (asect != NULL)
+    size = bfd_get_reloc_upper_bound (abfd, asect);
+  else
+    size = bfd_get_dynamic_reloc_upper_bound (abfd);
+  if (size < 0)
+    return -1;
+  if (size < (long long) sizeof (arelent *))
+    size = sizeof (arelent *);
+
+  rel = (arelent **) bfd_alloc (abfd, size);
+  if (rel == NULL)
+    return -1;
+  if (asect != NULL)
+    count = bfd_canonicalize_reloc (abfd, asect, rel, symbols);
+  else
+    count = bfd_canonicalize_dynamic_reloc (abfd, rel, symbols);
+  if (count < 0)
+    return -1;
+
+  /* Relocs are usually in address order already.  */
+  for (i = 1; i < count; i++)
+    if (compare_sorted_relocs (&rel[i - 1], &rel[i]) > 0)
+      {
+	qsort (rel, count, sizeof (*rel), compare_sorted_relocs);
+	break;
+      }
+
+  ent->syms = symbols;
+  ent->relocation = asect != NULL ? asect->relocation : NULL;
+  ent->relocs = rel;
+  ent->count = count;
+  *relocs = rel;
+  return count;
+}
+
 /*
 FUNCTION
 	bfd_set_reloc
@@ -2307,6 +2786,114 @@ DESCRIPTION
 .
 */
 
+/*
+FUNCTION
+	bfd_find_nearest_lines
+
+SYNOPSIS
+	bool bfd_find_nearest_lines
+	  (bfd *abfd, asymbol **symbols, asection *section,
+	   const bfd_vma *offsets, size_t count, bfd_nearest_line *lines);
+
+DESCRIPTION
+	Find the source locations of @var{count} addresses in
+	@var{section}, each given as an offset in @var{offsets}, as
+	if by calling <<bfd_find_nearest_line_discriminator>> on each
+	in turn.  The result for @var{offsets[i]} is stored in
+	@var{lines[i]}, whose <<found>> field is <<TRUE>> if anything
+	was found.  For ELF files with DWARF debugging information
+	this is quicker than looking up the addresses one by one.
+	Returns <<TRUE>> if a location was found for any address.
+
+CODE_FRAGMENT
+.typedef struct bfd_nearest_line
+.{
+.  {* The source file, function, line and discriminator found.  *}
+.  const char *filename;
+.  const char *functionname;
+.  unsigned int line;
+.  unsigned int discriminator;
+.
+.  {* Whether the fields above were found.  *}
+.  bool found;
+.
+.  {* Where the chain of functions inlined at this address starts,
+.     for use by <<bfd_nearest_line_inliner>>.  *}
+.  void *inliner;
+.}
+.bfd_nearest_line;
+.
+*/
+
+bool
+bfd_find_nearest_lines (bfd *abfd,
+			asymbol **symbols,
+			asection *section,
+			const bfd_vma *offsets,
+			size_t count,
+			bfd_nearest_line *lines)
+{
+  bool any = false;
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    memset (&lines[i], 0, sizeof (lines[i]));
+
+  /* ELF code sections go straight to the DWARF reader, which can do
+     the per-section setup once for all the addresses.  Anything it
+     misses gets the full search below.  */
+  if (bfd_get_flavour (abfd) == bfd_target_elf_flavour
+      && abfd->xvec->_bfd_find_nearest_line == _bfd_elf_find_nearest_line
+      && (section->flags & SEC_CODE) != 0)
+    _bfd_dwarf2_find_nearest_lines (abfd, symbols, section, offsets, count,
+				    lines, dwarf_debug_sections,
+				    &elf_tdata (abfd)->dwarf2_find_line_info);
+
+  for (i = 0; i < count; i++)
+    {
+      bfd_nearest_line *line = &lines[i];
+
+      if (!line->found)
+	{
+	  line->inliner = NULL;
+	  line->found = bfd_find_nearest_line_discriminator
+	    (abfd, section, symbols, offsets[i], &line->filename,
+	     &line->functionname, &line->line, &line->discriminator);
+	}
+      any |= line->found;
+    }
+
+  return any;
+}
+
+/*
+FUNCTION
+	bfd_nearest_line_inliner
+
+SYNOPSIS
+	bool bfd_nearest_line_inliner
+	  (bfd_nearest_line *line, const char **filename_ptr,
+	   const char **functionname_ptr, unsigned int *line_ptr);
+
+DESCRIPTION
+	Like <<bfd_find_inliner_info>>, but for a result of
+	<<bfd_find_nearest_lines>>.  Each call returns the caller of
+	the function last returned for @var{line}, starting with the
+	one that @var{line} itself names, and <<FALSE>> when there are
+	no more.  Results remain valid until the BFD's cached debug
+	information is freed.
+*/
+
+bool
+bfd_nearest_line_inliner (bfd_nearest_line *line,
+			  const char **filename_ptr,
+			  const char **functionname_ptr,
+			  unsigned int *line_ptr)
+{
+  return _bfd_dwarf2_nearest_line_inliner (&line->inliner, filename_ptr,
+					   functionname_ptr, line_ptr);
+}
+
 /*
 FUNCTION
 	bfd_get_relocated_section_contents
@@ -2572,32 +3159,18 @@ bfd_emul_get_commonpagesize (const char *emul)
   return 0;
 }
 
-/*
-FUNCTION
-	bfd_demangle
-
-SYNOPSIS
-	char *bfd_demangle (bfd *, const char *, int);
+/* Demangle NAME for bfd_demangle, with LEAD the symbol leading char
+   of its BFD, or zero.  */
 
-DESCRIPTION
-	Wrapper around cplus_demangle.  Strips leading underscores and
-	other such chars that would otherwise confuse the demangler.
-	If passed a g++ v3 ABI mangled name, returns a buffer allocated
-	with malloc holding the demangled name.  Returns NULL otherwise
-	and on memory alloc failure.
-*/
-
-char *
-bfd_demangle (bfd *abfd, const char *name, int options)
+static char *
+demangle_uncached (char lead, const char *name, int options)
 {
   char *res, *alloc;
   const char *pre, *suf;
   size_t pre_len;
   bool skip_lead;
 
-  skip_lead = (abfd != NULL
-	       && *name != '\0'
-	       && bfd_get_symbol_leading_char (abfd) == *name);
+  skip_lead = (lead != 0 && *name == lead);
   if (skip_lead)
     ++name;
 
@@ -2666,6 +3239,339 @@ bfd_demangle (bfd *abfd, const char *name, int options)
   return res;
 }
 
+/* The names demangled so far, whatever BFD they came from, as the same
+   name is usually printed many times over.  The cache is emptied once
+   the names in it take up more than DEMANGLE_CACHE_LIMIT bytes.  */
+
+struct demangle_cache_entry
+{
+  hashval_t hash;
+  int options;
+  char lead;
+  /* The demangled name, within the entry's allocation after NAME, or
+     NULL if NAME isn't a mangled name.  */
+  char *result;
+  char name[];
+};
+
+/* What a name is looked up by in the demangle cache.  */
+
+struct demangle_cache_key
+{
+  hashval_t hash;
+  int options;
+  char lead;
+  const char *name;
+};
+
+#define DEMANGLE_CACHE_LIMIT (16 * 1024 * 1024)
+
+static bfd_mutex demangle_cache_lock;
+static htab_t demangle_cache;
+static size_t demangle_cache_size;
+
+static hashval_t
+demangle_cache_hash (const void *p)
+{
+  return ((const struct demangle_cache_entry *) p)->hash;
+}
+
+/* Compare the entry A in the cache with the key B.  */
+
+static int
+demangle_cache_eq (const void *a, const void *b)
+{
+  const struct demangle_cache_entry *ent
+    = (const struct demangle_cache_entry *) a;
+  const struct demangle_cache_key *key
+    = (const struct demangle_cache_key *) b;
+
+  return (ent->hash == key->hash
+	  && ent->options == key->options
+	  && ent->lead == key->lead
+	  && strcmp (ent->name, key->name) == 0);
+}
+
+/* Set up KEY to look NAME up in the demangle cache.  */
+
+static void
+demangle_cache_key (struct demangle_cache_key *key, char lead,
+		    const char *name, int options)
+{
+  key->hash = htab_hash_string (name) ^ (options * 31 + lead);
+  key->options = options;
+  key->lead = lead;
+  key->name = name;
+}
+
+/* Look KEY up in the demangle cache.  The lock must be held.  On a hit
+   set *RESULT to a copy of the cached demangled name, which may be
+   NULL, and return true.  */
+
+static bool
+demangle_cache_lookup (const struct demangle_cache_key *key,
+		       char **result)
+{
+  struct demangle_cache_entry *ent;
+
+  if (demangle_cache == NULL)
+    return false;
+  ent = (struct demangle_cache_entry *)
+    htab_find_with_hash (demangle_cache, key, key->hash);
+  if (ent == NULL)
+    return false;
+  *result = ent->result != NULL ? strdup (ent->result) : NULL;
+  return ent->result == NULL || *result != NULL;
+}
+
+/* Remember RESULT as the demangled name for KEY.  The lock must be
+   held.  */
+
+static void
+demangle_cache_insert (const struct demangle_cache_key *key,
+		       const char *result)
+{
+  struct demangle_cache_entry *ent;
+  size_t name_len, result_len, size;
+  void **slot;
+
+  if (demangle_cache == NULL)
+    {
+      demangle_cache = htab_create_alloc (1024, demangle_cache_hash,
+					  demangle_cache_eq, free,
+					  xcalloc, free);
+      demangle_cache_size = 0;
+    }
+
+  name_len = strlen (key->name) + 1;
+  result_len = result != NULL ? strlen (result) + 1 : 0;
+  size = sizeof (*ent) + name_len + result_len;
+  if (demangle_cache_size + size > DEMANGLE_CACHE_LIMIT)
+    {
+      htab_empty (demangle_cache);
+      demangle_cache_size = 0;
+    }
+
+  slot = htab_find_slot_with_hash (demangle_cache, key, key->hash, INSERT);
+  if (slot == NULL || *slot != NULL)
+    return;
+  ent = (struct demangle_cache_entry *) malloc (size);
+  if (ent == NULL)
+    {
+      htab_clear_slot (demangle_cache, slot);
+      return;
+    }
+  ent->hash = key->hash;
+  ent->options = key->options;
+  ent->lead = key->lead;
+  memcpy (ent->name, key->name, name_len);
+  ent->result = NULL;
+  if (result != NULL)
+    {
+      ent->result = ent->name + name_len;
+      memcpy (ent->result, result, result_len);
+    }
+  *slot = ent;
+  demangle_cache_size += size;
+}
+
+/*
+FUNCTION
+	bfd_demangle
+
+SYNOPSIS
+	char *bfd_demangle (bfd *, const char *, int);
+
+DESCRIPTION
+	Wrapper around cplus_demangle.  Strips leading underscores and
+	other such chars that would otherwise confuse the demangler.
+	If passed a g++ v3 ABI mangled name, returns a buffer allocated
+	with malloc holding the demangled name.  Returns NULL otherwise
+	and on memory alloc failure.  Names are remembered once
+	demangled, so that demangling the same name again is cheap.
+*/
+
+char *
+bfd_demangle (bfd *abfd, const char *name, int options)
+{
+  struct demangle_cache_key key;
+  char lead = abfd != NULL ? bfd_get_symbol_leading_char (abfd) : 0;
+  char *res;
+  bool hit;
+
+  demangle_cache_key (&key, lead, name, options);
+  _bfd_mutex_lock (&demangle_cache_lock);
+  hit = demangle_cache_lookup (&key, &res);
+  _bfd_mutex_unlock (&demangle_cache_lock);
+  if (hit)
+    return res;
+
+  res = demangle_uncached (lead, name, options);
+
+  _bfd_mutex_lock (&demangle_cache_lock);
+  demangle_cache_insert (&key, res);
+  _bfd_mutex_unlock (&demangle_cache_lock);
+  return res;
+}
+
+/* The names being demangled by bfd_demangle_many.  */
+
+struct demangle_job
+{
+  char lead;
+  int options;
+  const char **names;
+  char **results;
+  /* For each name, whether it was found in the cache.  */
+  bool *hit;
+};
+
+/* Demangle the names FIRST to LAST of the job in DATA that weren't in
+   the cache.  Worker for _bfd_parallel_for.  */
+
+static bool
+demangle_names (void *data, size_t first, size_t last)
+{
+  struct demangle_job *job = (struct demangle_job *) data;
+  size_t i;
+
+  for (i = first; i < last; i++)
+    if (!job->hit[i])
+      job->results[i] = demangle_uncached (job->lead, job->names[i],
+					   job->options);
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_demangle_many
+
+SYNOPSIS
+	bool bfd_demangle_many
+	  (bfd *, const char **names, char **results, size_t count,
+	   int options);
+
+DESCRIPTION
+	Demangle the @var{count} symbol names in @var{names} as
+	<<bfd_demangle>> would, setting each element of @var{results}
+	to a buffer allocated with malloc holding the demangled name,
+	or to NULL if the name isn't mangled.  The names that haven't
+	been seen before are demangled on several threads if allowed,
+	see <<bfd_set_thread_count>>.  Returns false if no memory
+	could be had for the work, leaving @var{results} unset.
+*/
+
+bool
+bfd_demangle_many (bfd *abfd, const char **names, char **results,
+		   size_t count, int options)
+{
+  struct demangle_job job;
+  struct demangle_cache_key key;
+  size_t i, misses;
+
+  job.lead = abfd != NULL ? bfd_get_symbol_leading_char (abfd) : 0;
+  job.options = options;
+  job.names = names;
+  job.results = results;
+  job.hit = (bool *) bfd_malloc (count * sizeof (*job.hit) + 1);
+  if (job.hit == NULL)
+    return false;
+
+  misses = 0;
+  _bfd_mutex_lock (&demangle_cache_lock);
+  for (i = 0; i < count; i++)
+    {
+      demangle_cache_key (&key, job.lead, names[i], options);
+      job.hit[i] = demangle_cache_lookup (&key, &results[i]);
+      if (!job.hit[i])
+	misses++;
+    }
+  _bfd_mutex_unlock (&demangle_cache_lock);
+
+  if (misses != 0)
+    {
+      _bfd_parallel_for (count, 64, demangle_names, &job);
+
+      _bfd_mutex_lock (&demangle_cache_lock);
+      for (i = 0; i < count; i++)
+	if (!job.hit[i])
+	  {
+	    demangle_cache_key (&key, job.lead, names[i], options);
+	    demangle_cache_insert (&key, results[i]);
+	  }
+      _bfd_mutex_unlock (&demangle_cache_lock);
+    }
+
+  free (job.hit);
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_demangle_symbols
+
+SYNOPSIS
+	const char **bfd_demangle_symbols
+	  (bfd *, asymbol **syms, size_t count, int options);
+
+DESCRIPTION
+	Demangle the names of the @var{count} symbols in @var{syms} of
+	@var{abfd} with <<bfd_demangle_many>>.  Returns an array, in
+	the order of @var{syms}, of the demangled names, with NULL for
+	a name that isn't mangled or a NULL symbol.  The array and the
+	names are one buffer allocated with malloc, freed with a single
+	call of free.  Returns NULL on memory alloc failure.
+*/
+
+const char **
+bfd_demangle_symbols (bfd *abfd, asymbol **syms, size_t count, int options)
+{
+  const char **names;
+  char **results;
+  const char **demangled = NULL;
+  size_t i, size;
+  char *p;
+
+  names = (const char **) bfd_malloc (count * sizeof (*names) + 1);
+  results = (char **) bfd_malloc (count * sizeof (*results) + 1);
+  if (names == NULL || results == NULL)
+    goto out;
+
+  for (i = 0; i < count; i++)
+    names[i] = (syms[i] != NULL && syms[i]->name != NULL
+		? syms[i]->name : "");
+  if (!bfd_demangle_many (abfd, names, results, count, options))
+    goto out;
+
+  size = count * sizeof (*demangled);
+  for (i = 0; i < count; i++)
+    if (results[i] != NULL)
+      size += strlen (results[i]) + 1;
+  demangled = (const char **) bfd_malloc (size + 1);
+  if (demangled != NULL)
+    {
+      p = (char *) (demangled + count);
+      for (i = 0; i < count; i++)
+	if (results[i] != NULL)
+	  {
+	    size_t len = strlen (results[i]) + 1;
+
+	    memcpy (p, results[i], len);
+	    demangled[i] = p;
+	    p += len;
+	  }
+	else
+	  demangled[i] = NULL;
+    }
+  for (i = 0; i < count; i++)
+    free (results[i]);
+
+ out:
+  free (names);
+  free (results);
+  return demangled;
+}
+
 /* Get the linker information.  */
 
 struct bfd_link_info *
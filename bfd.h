@@ -185,6 +185,65 @@ BFD_API void *bfd_zalloc (bfd *abfd, bfd_size_type wanted);
 
 BFD_API void bfd_release (bfd *, void *);
 
+/* Memory used by the <<bfd_alloc>> arena of a BFD.  */
+struct bfd_arena_stats
+{
+  /* Bytes requested by <<bfd_alloc>> since the BFD was opened.  */
+  bfd_size_type requested;
+
+  /* Chunks shared by small objects, and their total size.  */
+  bfd_size_type small_chunks;
+  bfd_size_type small_bytes;
+
+  /* Chunks holding a single large object each, and their total size.  */
+  bfd_size_type large_chunks;
+  bfd_size_type large_bytes;
+
+  /* Space not yet used in the chunk currently being filled.  */
+  bfd_size_type free_bytes;
+};
+
+BFD_API bool bfd_get_arena_stats (bfd *abfd, struct bfd_arena_stats *stats);
+
+/* What memory that BFD allocates is used for.  */
+enum bfd_memory_class
+{
+  /* Anything not in another class.  */
+  bfd_memory_other,
+  /* Section headers and the per-BFD section hash table.  */
+  bfd_memory_sections,
+  /* Symbol tables read from files.  */
+  bfd_memory_symbols,
+  /* Relocations read from files.  */
+  bfd_memory_relocs,
+  /* String tables being built for output.  */
+  bfd_memory_strtab,
+  /* Debug information read by the DWARF line lookup.  */
+  bfd_memory_dwarf,
+  /* Tables for merging SEC_MERGE sections.  */
+  bfd_memory_merge,
+  /* Other hash tables, such as the linker's symbol table.  */
+  bfd_memory_hash,
+  bfd_memory_class_count
+};
+
+/* Memory that BFD holds, by class.  */
+struct bfd_memory_usage
+{
+  /* Bytes held now, and the most held at once.  */
+  bfd_size_type current[bfd_memory_class_count];
+  bfd_size_type peak[bfd_memory_class_count];
+};
+
+BFD_API bool bfd_set_memory_accounting (bool enable);
+
+BFD_API bool bfd_get_memory_usage
+   (const bfd *abfd, struct bfd_memory_usage *usage);
+
+BFD_API void bfd_reset_memory_peak (void);
+
+BFD_API const char *bfd_memory_class_name (enum bfd_memory_class);
+
 
 /* Byte swapping macros for user section data.  */
 
@@ -334,6 +393,8 @@ BFD_API void bfd_putl16 (bfd_vma, void *);
 BFD_API uint64_t bfd_get_bits (const void *, int, bool);
 BFD_API void bfd_put_bits (uint64_t, void *, int, bool);
 
+BFD_API bool bfd_map_file_image (bfd *abfd);
+
 /* Extracted from hash.c.  */
 /* An element in the hash table.  Most uses will actually use a larger
    structure, and an instance of this will be the first field.  */
@@ -375,6 +436,40 @@ struct bfd_hash_table
   unsigned int entsize;
   /* If non-zero, don't grow the hash table.  */
   unsigned int frozen:1;
+  /* If non-zero, strings are hashed with <<bfd_hash_wide>>.  */
+  unsigned int wide_hash:1;
+  /* If non-NULL, an open-addressed index used by lookups.  See
+     <<bfd_hash_table_set_layout>>.  */
+  struct bfd_hash_flat *flat;
+  /* If non-NULL, the locks that let several threads look up and
+     insert at once.  See <<bfd_hash_table_set_concurrent>>.  */
+  struct bfd_hash_locks *locks;
+  /* If non-NULL, counters kept for <<bfd_hash_table_statistics>>.  */
+  struct bfd_hash_stats *stats;
+  /* The class that the table's memory is counted in, and the bytes
+     counted, if memory accounting is on.  */
+  enum bfd_memory_class memory_class;
+  bfd_size_type memory_used;
+};
+
+/* The string hash functions a table may use.  */
+
+enum bfd_hash_function
+{
+  /* The original hash, one byte at a time.  */
+  bfd_hash_classic,
+  /* A hash taking eight bytes at a time.  */
+  bfd_hash_wide
+};
+
+/* The ways a table may find its entries.  */
+
+enum bfd_hash_layout
+{
+  /* Walk the chain hanging off each bucket.  */
+  bfd_hash_chained,
+  /* Probe an open-addressed index of hash codes first.  */
+  bfd_hash_open
 };
 
 BFD_API bool bfd_hash_table_init_n
@@ -391,10 +486,35 @@ BFD_API bool bfd_hash_table_init
 
 BFD_API void bfd_hash_table_free (struct bfd_hash_table *);
 
+BFD_API bool bfd_hash_table_set_function
+   (struct bfd_hash_table *, enum bfd_hash_function);
+
+BFD_API void bfd_hash_table_set_memory_class
+   (struct bfd_hash_table *, enum bfd_memory_class);
+
+BFD_API bool bfd_hash_table_set_layout
+   (struct bfd_hash_table *, enum bfd_hash_layout);
+
+BFD_API bool bfd_hash_table_set_concurrent
+   (struct bfd_hash_table *, unsigned int /*stripes*/);
+
+BFD_API bool bfd_hash_table_reserve
+   (struct bfd_hash_table *, unsigned int /*count*/);
+
 struct bfd_hash_entry *bfd_hash_lookup
    (struct bfd_hash_table *, const char *,
     bool /*create*/, bool /*copy*/);
 
+BFD_API struct bfd_hash_entry *bfd_hash_lookup_with_hash
+   (struct bfd_hash_table *, const char *,
+    unsigned long long /*hash*/, bool /*create*/, bool /*copy*/);
+
+BFD_API unsigned long long bfd_hash_string_hash
+   (const char *, enum bfd_hash_function);
+
+BFD_API enum bfd_hash_function bfd_hash_table_function
+   (const struct bfd_hash_table *);
+
 struct bfd_hash_entry *bfd_hash_insert
    (struct bfd_hash_table *,
     const char *,
@@ -421,8 +541,60 @@ BFD_API void bfd_hash_traverse
     bool (*) (struct bfd_hash_entry *, void *),
     void *);
 
+BFD_API bool bfd_hash_traverse_parallel
+   (struct bfd_hash_table *,
+    bool (* /*func*/) (struct bfd_hash_entry *, void *, void *),
+    size_t /*result_size*/,
+    bool (* /*reduce*/) (void *, void *),
+    void *);
+
 BFD_API unsigned int bfd_hash_set_default_size (unsigned int);
 
+BFD_API bool bfd_hash_table_set_statistics
+   (struct bfd_hash_table *, bool /*enable*/);
+
+/* Statistics for a hash table, see <<bfd_hash_table_statistics>>.  */
+
+struct bfd_hash_stats
+{
+  /* The table as it is now.  */
+  unsigned int size;
+  unsigned int count;
+  /* The number of buckets with no entries, and the longest chain.  */
+  unsigned int empty;
+  unsigned int longest;
+  /* CHAINS[N] is the number of buckets with N entries; the last
+     element counts all longer chains.  */
+  unsigned int chains[8];
+
+  /* Counts kept since statistics were started.  */
+  unsigned int resizes;
+  unsigned int index_rebuilds;
+  unsigned long long lookups;
+  unsigned long long hits;
+  unsigned long long inserts;
+  /* Chain entries examined by lookups.  */
+  unsigned long long probes;
+  /* Time spent in <<bfd_hash_lookup>>, including any inserts it
+     made, and in <<bfd_hash_insert>>.  */
+  unsigned long long lookup_ns;
+  unsigned long long insert_ns;
+};
+
+BFD_API void bfd_hash_table_statistics
+   (struct bfd_hash_table *, struct bfd_hash_stats *);
+
+BFD_API void bfd_hash_print_statistics
+   (void *, const char *, struct bfd_hash_table *);
+
+BFD_API void bfd_hash_set_statistics_file (void *);
+
+BFD_API struct bfd_name_pool *bfd_name_pool_create (void);
+
+BFD_API void bfd_name_pool_release (struct bfd_name_pool *);
+
+BFD_API bool bfd_set_name_pool (bfd *abfd, struct bfd_name_pool *pool);
+
 /* Extracted from section.c.  */
 /* Linenumber stuff.  */
 typedef struct lineno_cache_entry
@@ -1067,11 +1239,26 @@ BFD_API void bfd_map_over_sections
     void (*func) (bfd *abfd, asection *sect, void *obj),
     void *obj);
 
+BFD_API bool bfd_map_over_sections_parallel
+   (bfd *abfd,
+    bool (*func) (bfd *abfd, asection *sect, void *obj,
+                  void *result),
+    size_t result_size,
+    bool (*reduce) (bfd *abfd, asection *sect, void *obj,
+                    void *result),
+    void *obj);
+
 BFD_API asection *bfd_sections_find_if
    (bfd *abfd,
     bool (*operation) (bfd *abfd, asection *sect, void *obj),
     void *obj);
 
+BFD_API asection *bfd_get_section_by_index (bfd *abfd, unsigned int index);
+
+BFD_API asection *bfd_get_section_by_vma (bfd *abfd, bfd_vma vma);
+
+BFD_API void bfd_invalidate_section_map (bfd *abfd);
+
 BFD_API bool bfd_set_section_size (asection *sec, bfd_size_type val);
 
 BFD_API bool bfd_set_section_contents
@@ -1308,6 +1495,9 @@ BFD_API bool bfd_copy_private_symbol_data
        BFD_SEND (obfd, _bfd_copy_private_symbol_data, \
 		 (ibfd, isymbol, obfd, osymbol))
 
+BFD_API asymbol *bfd_find_symbol_for_address
+   (bfd *abfd, asection *section, bfd_vma addr);
+
 /* Extracted from archive.c.  */
 /* A canonical archive symbol.  */
 /* This is a type pun with struct symdef/struct ranlib on purpose!  */
@@ -1325,10 +1515,17 @@ carsym;
 symindex bfd_get_next_mapent
    (bfd *abfd, symindex previous, carsym **sym);
 
+BFD_API symindex bfd_find_armap_symbol
+   (bfd *abfd, symindex previous, const char *name, carsym **sym);
+
 BFD_API bool bfd_set_archive_head (bfd *output, bfd *new_head);
 
 bfd *bfd_openr_next_archived_file (bfd *archive, bfd *previous);
 
+BFD_API bool bfd_check_archive_members
+   (bfd *archive, bool (*func) (bfd *member, void *data),
+    void *data);
+
 /* Extracted from archures.c.  */
 enum bfd_architecture
 {
@@ -1954,6 +2151,11 @@ struct bfd
      least-recently-used list of BFDs.  */
   struct bfd *lru_prev, *lru_next;
 
+  /* The number of reads of the file going on without the caching
+     routines' lock held.  The file is not closed to make room for
+     another while this is non-zero.  */
+  unsigned int cache_pins;
+
   /* Track current file position (or current buffer offset for
      in-memory BFDs).  When a file is closed by the caching routines,
      BFD retains state information on the file here.  */
@@ -2127,6 +2329,10 @@ struct bfd
      that BFD is not prepared to handle for objcopy/strip.  */
   unsigned int read_only : 1;
 
+  /* Set when the section list has changed since the index used by
+     <<bfd_get_section_by_vma>> was built.  */
+  unsigned int section_map_stale : 1;
+
   /* Set to dummy BFD created when claimed by a compiler plug-in
      library.  */
   bfd *plugin_dummy_bfd;
@@ -2167,6 +2373,12 @@ struct bfd
   /* The total size of memory from bfd_alloc.  */
   bfd_size_type alloc_size;
 
+  /* If memory accounting is on, the memory from bfd_alloc by class.  */
+  struct bfd_memory_usage *memory_usage;
+
+  /* If I/O statistics are on, the I/O done by this BFD.  */
+  struct bfd_io_stats *io_stats;
+
   /* Stuff only useful for object files:
      The start address.  */
   bfd_vma start_address;
@@ -2248,6 +2460,43 @@ struct bfd
 
   /* For input BFDs, the build ID, if the object has one. */
   const struct bfd_build_id *build_id;
+
+  /* Section contents views handed out by bfd_get_section_contents_view,
+     released when the BFD is closed.  */
+  struct bfd_mmapped *mmapped;
+
+  /* If not NULL, a read-only mapping of the whole file made by
+     <<bfd_map_file_image>>, which reads of the file and of its
+     archive members are served from.  */
+  struct bfd_mmapped *file_image;
+
+  /* The address index built by <<bfd_find_symbol_for_address>>, in
+     the memory of this BFD.  */
+  struct bfd_symbol_index *symbol_index;
+
+  /* If not NULL, the pool this BFD keeps its names in.  */
+  struct bfd_name_pool *name_pool;
+
+  /* The section index built by <<bfd_get_section_by_vma>> and
+     <<bfd_get_section_by_index>>.  */
+  struct bfd_section_map *section_map;
+
+  /* The sorted relocs kept by <<bfd_canonicalize_reloc_sorted>>,
+     in the memory of this BFD.  */
+  struct bfd_sorted_relocs *sorted_relocs;
+
+  /* The unwind table built by <<bfd_unwind_find_row>>, in the
+     memory of this BFD.  */
+  struct bfd_unwind_table *unwind_table;
+
+  /* The link state kept by
+     <<bfd_simple_get_relocated_section_contents>>.  */
+  struct bfd_simple_link *simple_link;
+
+  /* The frame indexes built by
+     <<bfd_get_decompressed_section_contents>>, in the memory of
+     this BFD.  */
+  struct bfd_frame_index *frame_indexes;
 };
 
 static inline const char *
@@ -2417,6 +2666,7 @@ bfd_section_list_remove (bfd *abfd, asection *s)
     next->prev = prev;
   else
     abfd->section_last = prev;
+  abfd->section_map_stale = 1;
 }
 
 static inline void
@@ -2434,6 +2684,7 @@ bfd_section_list_append (bfd *abfd, asection *s)
       abfd->sections = s;
     }
   abfd->section_last = s;
+  abfd->section_map_stale = 1;
 }
 
 static inline void
@@ -2451,6 +2702,7 @@ bfd_section_list_prepend (bfd *abfd, asection *s)
       abfd->section_last = s;
     }
   abfd->sections = s;
+  abfd->section_map_stale = 1;
 }
 
 static inline void
@@ -2464,6 +2716,7 @@ bfd_section_list_insert_after (bfd *abfd, asection *a, asection *s)
     next->prev = s;
   else
     abfd->section_last = s;
+  abfd->section_map_stale = 1;
 }
 
 static inline void
@@ -2477,6 +2730,7 @@ bfd_section_list_insert_before (bfd *abfd, asection *b, asection *s)
     prev->next = s;
   else
     abfd->sections = s;
+  abfd->section_map_stale = 1;
 }
 
 static inline bool
@@ -2529,6 +2783,11 @@ BFD_API void _bfd_error_handler (const char *fmt, ...) ATTRIBUTE_PRINTF_1;
 
 BFD_API bfd_error_handler_type bfd_set_error_handler (bfd_error_handler_type);
 
+BFD_API bfd_error_handler_type bfd_set_thread_error_handler
+   (bfd_error_handler_type);
+
+BFD_API unsigned int bfd_set_error_limit (unsigned int limit);
+
 BFD_API void bfd_set_error_program_name (const char *);
 
 typedef void (*bfd_assert_handler_type) (const char *bfd_formatmsg,
@@ -2548,6 +2807,9 @@ BFD_API long long bfd_get_reloc_upper_bound (bfd *abfd, asection *sect);
 BFD_API long long bfd_canonicalize_reloc
    (bfd *abfd, asection *sec, arelent **loc, asymbol **syms);
 
+BFD_API long long bfd_canonicalize_reloc_sorted
+   (bfd *abfd, asection *sec, asymbol **syms, arelent ***relocs);
+
 BFD_API void bfd_set_reloc
    (bfd *abfd, asection *sec, arelent **rel, unsigned int count);
 
@@ -2682,6 +2944,31 @@ BFD_API bool bfd_set_private_flags (bfd *abfd, flagword flags);
 #define bfd_canonicalize_dynamic_reloc(abfd, arels, asyms) \
        BFD_SEND (abfd, _bfd_canonicalize_dynamic_reloc, (abfd, arels, asyms))
 
+typedef struct bfd_nearest_line
+{
+  /* The source file, function, line and discriminator found.  */
+  const char *filename;
+  const char *functionname;
+  unsigned int line;
+  unsigned int discriminator;
+
+  /* Whether the fields above were found.  */
+  bool found;
+
+  /* Where the chain of functions inlined at this address starts,
+     for use by <<bfd_nearest_line_inliner>>.  */
+  void *inliner;
+}
+bfd_nearest_line;
+
+BFD_API bool bfd_find_nearest_lines
+   (bfd *abfd, asymbol **symbols, asection *section,
+    const bfd_vma *offsets, size_t count, bfd_nearest_line *lines);
+
+BFD_API bool bfd_nearest_line_inliner
+   (bfd_nearest_line *line, const char **filename_ptr,
+    const char **functionname_ptr, unsigned int *line_ptr);
+
 BFD_API bfd_byte *bfd_get_relocated_section_contents
    (bfd *, struct bfd_link_info *, struct bfd_link_order *, bfd_byte *,
     bool, asymbol **);
@@ -2703,6 +2990,13 @@ BFD_API bfd_vma bfd_emul_get_commonpagesize (const char *);
 
 BFD_API char *bfd_demangle (bfd *, const char *, int);
 
+BFD_API bool bfd_demangle_many
+   (bfd *, const char **names, char **results, size_t count,
+    int options);
+
+BFD_API const char **bfd_demangle_symbols
+   (bfd *, asymbol **syms, size_t count, int options);
+
 /* Extracted from bfdio.c.  */
 BFD_API bfd_size_type bfd_bread (void *, bfd_size_type, bfd *);
 
@@ -2716,6 +3010,29 @@ BFD_API int bfd_stat (bfd *, struct stat *);
 
 BFD_API int bfd_seek (bfd *, file_ptr, int);
 
+/* One region of a file to be read by <<bfd_bread_vector>>.  */
+struct bfd_read_range
+{
+  /* File position of the region, as would be passed to <<bfd_seek>>.  */
+  file_ptr offset;
+
+  /* Number of bytes to read.  */
+  bfd_size_type size;
+
+  /* Where to store them.  */
+  void *buf;
+};
+
+BFD_API bool bfd_bread_vector (bfd *abfd, struct bfd_read_range *ranges,
+    unsigned int count);
+
+BFD_API bool bfd_pwrite (const void *ptr, bfd_size_type size,
+    file_ptr offset, bfd *abfd);
+
+BFD_API bool bfd_preallocate (bfd *abfd, ufile_ptr size);
+
+BFD_API void bfd_prefetch (bfd *abfd, file_ptr offset, bfd_size_type size);
+
 BFD_API long long bfd_get_mtime (bfd *abfd);
 
 BFD_API ufile_ptr bfd_get_size (bfd *abfd);
@@ -2726,6 +3043,41 @@ BFD_API void *bfd_mmap (bfd *abfd, void *addr, bfd_size_type len,
     int prot, int flags, file_ptr offset,
     void **map_addr, bfd_size_type *map_len);
 
+BFD_API int bfd_munmap (void *map_addr, bfd_size_type map_len);
+
+/* Counts of the I/O done, see <<bfd_get_io_statistics>>.  */
+struct bfd_io_stats
+{
+  /* Calls of <<bfd_bread>> and <<bfd_bread_vector>>, and the bytes
+     they read.  */
+  unsigned long long reads;
+  unsigned long long read_bytes;
+  /* Calls of <<bfd_bwrite>> and <<bfd_pwrite>>, and the bytes they
+     wrote.  */
+  unsigned long long writes;
+  unsigned long long write_bytes;
+  /* Calls of <<bfd_seek>>.  */
+  unsigned long long seeks;
+  /* Regions mapped by <<bfd_mmap>>, and their total length.  */
+  unsigned long long maps;
+  unsigned long long mapped_bytes;
+  /* Times the file cache opened the file, opened it again after
+     it had been closed, and closed it to stay within
+     <<bfd_cache_set_max_open>> files.  */
+  unsigned long long opens;
+  unsigned long long reopens;
+  unsigned long long evictions;
+};
+
+BFD_API bool bfd_set_io_statistics (bool enable);
+
+BFD_API void bfd_set_io_statistics_file (void *);
+
+BFD_API bool bfd_get_io_statistics
+   (const bfd *abfd, struct bfd_io_stats *stats);
+
+BFD_API void bfd_print_io_statistics (void *, const bfd *);
+
 /* Extracted from bfdwin.c.  */
 struct _bfd_window_internal;
 
@@ -2756,6 +3108,8 @@ BFD_API bool bfd_cache_close (bfd *abfd);
 
 BFD_API bool bfd_cache_close_all (void);
 
+BFD_API int bfd_cache_set_max_open (int max);
+
 /* Extracted from compress.c.  */
 /* Types of compressed DWARF debug sections.  */
 enum compressed_debug_section_type
@@ -2807,6 +3161,10 @@ bfd_zdebug_name_to_debug (bfd *abfd, const char *name)
   return new_name;
 }
 
+/* A reader of the decompressed contents of a section, made by
+   bfd_open_section_stream.  */
+struct bfd_section_stream;
+
 enum compressed_debug_section_type
 bfd_get_compression_algorithm (const char *name);
 
@@ -2826,9 +3184,36 @@ BFD_API bool bfd_convert_section_contents
    (bfd *ibfd, asection *isec, bfd *obfd,
     bfd_byte **ptr, bfd_size_type *ptr_size);
 
+BFD_API bool bfd_set_compression_level
+   (enum compressed_debug_section_type type, int level);
+
+BFD_API bfd_size_type bfd_set_section_cache_size (bfd_size_type size);
+
+BFD_API bool bfd_get_cached_section_contents
+   (bfd *abfd, asection *section, const bfd_byte **ptr);
+
+BFD_API void bfd_release_cached_section_contents
+   (bfd *abfd, asection *section);
+
 BFD_API bool bfd_get_full_section_contents
    (bfd *abfd, asection *section, bfd_byte **ptr);
 
+BFD_API bool bfd_get_section_contents_view
+   (bfd *abfd, asection *section, const bfd_byte **ptr);
+
+BFD_API bool bfd_get_decompressed_section_contents
+   (bfd *abfd, asection *section, void *location,
+    file_ptr offset, bfd_size_type count);
+
+BFD_API struct bfd_section_stream *bfd_open_section_stream
+   (bfd *abfd, asection *section);
+
+BFD_API bfd_size_type bfd_read_section_stream
+   (struct bfd_section_stream *stream, void *buf,
+    bfd_size_type size);
+
+BFD_API void bfd_close_section_stream (struct bfd_section_stream *stream);
+
 BFD_API bool bfd_is_section_compressed_info
    (bfd *abfd, asection *section,
     int *compression_header_size_p,
@@ -2867,6 +3252,8 @@ BFD_API bool bfd_check_format (bfd *abfd, bfd_format format);
 BFD_API bool bfd_check_format_matches
    (bfd *abfd, bfd_format format, char ***matching);
 
+BFD_API bool bfd_set_format_cache (const char *filename);
+
 BFD_API bool bfd_set_format (bfd *abfd, bfd_format format);
 
 BFD_API const char *bfd_format_string (bfd_format format);
@@ -2940,6 +3327,10 @@ BFD_API bool bfd_merge_private_bfd_data
 /* Set to N to open the next N BFDs using an alternate id space.  */
 extern unsigned int bfd_use_reserved_id;
 
+/* A finder of separate debug files, made by
+   bfd_create_debug_resolver.  */
+struct bfd_debug_resolver;
+
 BFD_API bfd *bfd_fopen (const char *filename, const char *target,
     const char *mode, int fd);
 
@@ -2967,6 +3358,11 @@ BFD_API bfd *bfd_openr_iovec (const char *filename, const char *target,
 	void *stream,
 	struct stat *sb));
 
+BFD_API bool bfd_set_iovec_cache (bfd *abfd, unsigned int block_size,
+    bfd_size_type budget);
+
+BFD_API bfd *bfd_openr_pread (const char *filename, const char *target);
+
 BFD_API bfd *bfd_openw (const char *filename, const char *target);
 
 BFD_API bfd *bfd_elf_bfd_from_remote_memory
@@ -2978,12 +3374,17 @@ BFD_API bool bfd_close (bfd *abfd);
 
 BFD_API bool bfd_close_all_done (bfd *);
 
+BFD_API bool bfd_set_fast_close (bool enable);
+
 BFD_API bfd *bfd_create (const char *filename, bfd *templ);
 
 BFD_API bool bfd_make_writable (bfd *abfd);
 
 BFD_API bool bfd_make_readable (bfd *abfd);
 
+BFD_API bool bfd_take_memory_contents
+   (bfd *abfd, bfd_byte **buffer, bfd_size_type *size);
+
 BFD_API uint32_t bfd_calc_gnu_debuglink_crc32
    (uint32_t crc, const bfd_byte *buf, bfd_size_type len);
 
@@ -3005,8 +3406,152 @@ BFD_API bool bfd_fill_in_gnu_debuglink_section
 
 BFD_API char *bfd_follow_build_id_debuglink (bfd *abfd, const char *dir);
 
+BFD_API struct bfd_debug_resolver *bfd_create_debug_resolver (void);
+
+BFD_API bool bfd_debug_resolver_add_dir
+   (struct bfd_debug_resolver *resolver, const char *dir);
+
+BFD_API void bfd_free_debug_resolver (struct bfd_debug_resolver *resolver);
+
+BFD_API char *bfd_debug_resolver_follow_build_id
+   (struct bfd_debug_resolver *resolver, bfd *abfd);
+
+BFD_API char *bfd_debug_resolver_follow_debuglink
+   (struct bfd_debug_resolver *resolver, bfd *abfd);
+
+BFD_API char *bfd_debug_resolver_follow_debugaltlink
+   (struct bfd_debug_resolver *resolver, bfd *abfd);
+
+BFD_API bool bfd_set_line_index_dir (const char *dir);
+
+BFD_API const char *bfd_get_line_index_dir (void);
+
+BFD_API bfd_size_type bfd_set_dwarf_memory_budget (bfd_size_type size);
+
+BFD_API bfd_size_type bfd_get_dwarf_memory_budget (void);
+
 BFD_API const char *bfd_set_filename (bfd *abfd, const char *filename);
 
+/* Extracted from pe-index.c.  */
+typedef struct bfd_pe_export
+{
+  /* The exported name, or NULL if the entry is exported by ordinal
+     only.  */
+  const char *name;
+
+  /* The ordinal, with the ordinal base of the directory added.  */
+  unsigned int ordinal;
+
+  /* The RVA the export address table gives for the entry.  */
+  bfd_vma rva;
+
+  /* For a forwarded export, the "DLL.name" or "DLL.#ordinal" it
+     forwards to, otherwise NULL.  */
+  const char *forwarder;
+}
+bfd_pe_export;
+
+typedef struct bfd_pe_import
+{
+  /* The DLL the entry is imported from.  */
+  const char *dll;
+
+  /* The imported name, or NULL if the entry is imported by
+     ordinal.  */
+  const char *name;
+
+  /* The ordinal for an import by ordinal, otherwise the hint into
+     the export name table of the DLL.  */
+  unsigned int ordinal;
+
+  /* The RVA of the entry's slot in the import address table.  */
+  bfd_vma iat_rva;
+}
+bfd_pe_import;
+
+typedef struct bfd_pe_unwind
+{
+  /* The function the entry covers, from BEGIN up to but not
+     including END, as RVAs.  */
+  bfd_vma begin;
+  bfd_vma end;
+
+  /* The RVA of the UNWIND_INFO of the function.  */
+  bfd_vma unwind_rva;
+
+  /* The fields of the UNWIND_INFO header.  FLAGS is a mask of the
+     UNW_FLAG_* values of coff/pe.h, and FRAME_OFFSET is scaled to
+     bytes.  */
+  unsigned int version;
+  unsigned int flags;
+  unsigned int prolog_size;
+  unsigned int frame_register;
+  unsigned int frame_offset;
+
+  /* The unwind codes, CODE_COUNT slots of two bytes each.  */
+  unsigned int code_count;
+  const bfd_byte *codes;
+
+  /* If FLAGS has UNW_FLAG_EHANDLER or UNW_FLAG_UHANDLER, the RVA
+     of the language handler and its data, which follows it.  */
+  bfd_vma handler_rva;
+  const bfd_byte *handler_data;
+
+  /* Whether the unwind codes of the function continue with those
+     of another function, covering PARENT_BEGIN up to PARENT_END.
+     Its own information is found by looking up PARENT_BEGIN.  */
+  bool chained;
+  bfd_vma parent_begin;
+  bfd_vma parent_end;
+}
+bfd_pe_unwind;
+
+typedef struct bfd_pe_resource_id
+{
+  /* The name to match, or NULL to match the integer ID.  */
+  const char *name;
+  unsigned int id;
+}
+bfd_pe_resource_id;
+
+typedef struct bfd_pe_resource
+{
+  /* The language of the resource found.  */
+  unsigned int language;
+
+  /* The RVA, size and code page of the data of the resource.  */
+  bfd_vma rva;
+  bfd_size_type size;
+  unsigned int codepage;
+
+  /* The data, pointing into the section contents of the BFD.  */
+  const bfd_byte *data;
+}
+bfd_pe_resource;
+
+BFD_API bool bfd_pe_get_exports
+   (bfd *abfd, const bfd_pe_export **exports, size_t *count);
+
+BFD_API const bfd_pe_export *bfd_pe_find_export
+   (bfd *abfd, const char *name);
+
+BFD_API const bfd_pe_export *bfd_pe_find_export_by_ordinal
+   (bfd *abfd, unsigned int ordinal);
+
+BFD_API bool bfd_pe_get_imports
+   (bfd *abfd, const bfd_pe_import **imports, size_t *count);
+
+BFD_API const bfd_pe_import *bfd_pe_find_import
+   (bfd *abfd, const char *dll, const char *name);
+
+BFD_API bool bfd_pe_find_unwind
+   (bfd *abfd, bfd_vma rva, bfd_pe_unwind *info);
+
+BFD_API bool bfd_pe_find_resource
+   (bfd *abfd, const bfd_pe_resource_id *type,
+    const bfd_pe_resource_id *name,
+    const bfd_pe_resource_id *language, bfd_pe_resource *res);
+
 /* Extracted from reloc.c.  */
 typedef enum bfd_reloc_status
 {
@@ -7364,6 +7909,25 @@ BFD_API reloc_howto_type *bfd_reloc_name_lookup
 
 BFD_API const char *bfd_get_reloc_code_name (bfd_reloc_code_real_type code);
 
+/* Extracted from resident.c.  */
+/* A BFD kept open by <<bfd_resident_open>>.  */
+typedef struct bfd_resident bfd_resident;
+
+BFD_API bfd_resident *bfd_resident_open
+   (const char *filename, const char *target, bfd_format format);
+
+BFD_API bfd_resident *bfd_resident_open_contents
+   (const char *filename, const char *target, bfd_format format,
+    const void *digest, size_t digest_len);
+
+BFD_API bfd *bfd_resident_bfd (bfd_resident *res);
+
+BFD_API long bfd_resident_symbols (bfd_resident *res, asymbol ***symbols);
+
+BFD_API void bfd_resident_release (bfd_resident *res);
+
+BFD_API unsigned int bfd_resident_set_limit (unsigned int count);
+
 /* Extracted from simple.c.  */
 BFD_API bfd_byte *bfd_simple_get_relocated_section_contents
    (bfd *abfd, asection *sec, bfd_byte *outbuf, asymbol **symbol_table);
@@ -7937,6 +8501,128 @@ BFD_API const bfd_target *bfd_iterate_over_targets
 
 BFD_API const char *bfd_flavour_name (enum bfd_flavour flavour);
 
+/* Extracted from threads.c.  */
+BFD_API unsigned int bfd_set_thread_count (unsigned int count);
+
+BFD_API unsigned int bfd_get_thread_count (void);
+
+typedef bool (*bfd_thread_executor_type)
+  (void (*task) (void *arg), void *arg, void *data);
+
+BFD_API bfd_thread_executor_type bfd_set_thread_executor
+   (bfd_thread_executor_type func, void *data);
+
+/* Extracted from trace.c.  */
+/* A span of time that is being traced.  */
+typedef struct bfd_trace_span
+{
+  /* What is being done, or NULL if tracing was off when the span
+     began.  */
+  const char *name;
+  /* The BFD it is being done to, if any.  */
+  const bfd *abfd;
+  /* When the span began, in microseconds.  */
+  uint64_t start;
+}
+bfd_trace_span;
+
+BFD_API bool bfd_trace_open (const char *filename);
+
+BFD_API bool bfd_trace_close (void);
+
+BFD_API void bfd_trace_begin
+   (bfd_trace_span *span, const char *name, const bfd *abfd);
+
+BFD_API void bfd_trace_end (bfd_trace_span *span);
+
+/* The places in BFD that a hook can be called from.  */
+enum bfd_hook_point
+{
+  /* <<bfd_check_format_matches>> has finished.  The name is that
+     of the target that matched, or NULL if none did; ARG1 is the
+     format asked for and ARG2 is one if the file was recognized.  */
+  bfd_hook_format_probe,
+  /* The file cache is closing the BFD to make room for another.
+     ARG1 is its position in the file, to seek back to when it is
+     reopened.  */
+  bfd_hook_cache_evict,
+  /* A DWARF compilation unit has been parsed.  The BFD is the one
+     holding the debug information; ARG1 is the offset of the unit
+     in the .debug_info section and ARG2 its length.  */
+  bfd_hook_dwarf_cu_parse,
+  /* A compressed section has been decompressed.  ARG1 is its
+     compressed size and ARG2 its size after decompression.  */
+  bfd_hook_decompress,
+  bfd_hook_max
+};
+
+/* What happened at a hook point.  */
+struct bfd_hook_event
+{
+  enum bfd_hook_point point;
+  const bfd *abfd;
+  /* The section concerned, if any.  */
+  const asection *section;
+  /* A name and two numbers, whose meanings depend on POINT.  */
+  const char *name;
+  uint64_t arg1;
+  uint64_t arg2;
+};
+
+typedef void (*bfd_hook_type) (const struct bfd_hook_event *, void *);
+
+BFD_API bool bfd_set_hook
+   (enum bfd_hook_point point, bfd_hook_type func, void *data);
+
+BFD_API bool bfd_set_hook_probes (bool enable);
+
+/* Extracted from unwind.c.  */
+enum bfd_unwind_rule
+{
+  /* The rule isn't one the table describes, such as a DWARF
+     expression.  */
+  bfd_unwind_rule_unknown,
+
+  /* The value can't be recovered.  For the return address this
+     marks the outermost frame.  */
+  bfd_unwind_rule_undefined,
+
+  /* The register still holds the value of the caller.  */
+  bfd_unwind_rule_same_value,
+
+  /* The value of the caller is saved at the CFA plus an offset.  */
+  bfd_unwind_rule_offset
+};
+
+typedef struct bfd_unwind_row
+{
+  /* The addresses the row covers, from START up to but not
+     including END.  */
+  bfd_vma start;
+  bfd_vma end;
+
+  /* If CFA_KNOWN, the CFA is the value of DWARF register CFA_REG
+     plus CFA_OFFSET.  */
+  bool cfa_known;
+  unsigned int cfa_reg;
+  bfd_signed_vma cfa_offset;
+
+  /* How to recover the return address and the frame pointer;
+     the offsets apply to <<bfd_unwind_rule_offset>> only.  */
+  enum bfd_unwind_rule ra_rule;
+  bfd_signed_vma ra_offset;
+  enum bfd_unwind_rule fp_rule;
+  bfd_signed_vma fp_offset;
+
+  /* The saved return address is signed, as with AArch64 pointer
+     authentication.  */
+  bool ra_mangled;
+}
+bfd_unwind_row;
+
+BFD_API bool bfd_unwind_find_row
+   (bfd *abfd, bfd_vma pc, bfd_unwind_row *row);
+
 #ifdef __cplusplus
 }
 #endif
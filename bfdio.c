@@ -191,7 +191,7 @@ DESCRIPTION
 	The <<struct bfd_iovec>> contains the internal file I/O class.
 	Each <<BFD>> has an instance of this class and all file I/O is
 	routed through it (it is assumed that the instance implements
-	all methods listed below).
+	all methods listed below, except where noted).
 
 .struct bfd_iovec
 .{
@@ -222,12 +222,102 @@ DESCRIPTION
 .  void *(*bmmap) (struct bfd *abfd, void *addr, bfd_size_type len,
 .		   int prot, int flags, file_ptr offset,
 .		   void **map_addr, bfd_size_type *map_len);
+.  {* Read COUNT RANGES, whose offsets are IOSTREAM file offsets in
+.     ascending order.  Return true if every range was read in full,
+.     otherwise false (setting <<bfd_error>>).  The IOSTREAM is left
+.     positioned at the end of the last range.  May be NULL, in which
+.     case <<bfd_bread_vector>> uses bseek and bread.  *}
+.  bool (*breadv) (struct bfd *abfd, const struct bfd_read_range *ranges,
+.		   unsigned int count);
+.  {* Write NBYTES from PTR at IOSTREAM offset OFFSET, without using
+.     the current IOSTREAM position.  Several threads may write
+.     different regions at once.  Return the number of bytes written,
+.     or -1 (setting <<bfd_error>>).  The IOSTREAM position afterwards
+.     is unspecified.  May be NULL, in which case <<bfd_pwrite>> uses
+.     bseek and bwrite.  *}
+.  file_ptr (*bpwrite) (struct bfd *abfd, const void *ptr,
+.			file_ptr nbytes, file_ptr offset);
+.  {* Make the IOSTREAM at least SIZE bytes long, reserving the space
+.     if the host can.  Return 0 on success, -1 (setting <<bfd_error>>)
+.     otherwise.  May be NULL.  *}
+.  int (*ballocate) (struct bfd *abfd, file_ptr size);
+.  {* Tell the host that SIZE bytes at IOSTREAM offset OFFSET will be
+.     read soon, so that it may start reading them in the background.
+.     Return 0 if the hint was given, -1 otherwise; failure is not an
+.     error.  May be NULL.  *}
+.  int (*bprefetch) (struct bfd *abfd, file_ptr offset, file_ptr size);
 .};
 
 .extern const struct bfd_iovec _bfd_memory_iovec;
 .
 */
 
+/* Set while this thread reads archive members that other threads
+   may be reading too.  */
+static TLS bool member_positions;
+
+/* Whether bfd_set_io_statistics has turned counting on, where to
+   print the counts of each BFD as it is closed, and the counts for
+   all BFDs.  io_lock protects the counts, those of each BFD too.  */
+static bool io_statistics;
+static FILE *io_statistics_file;
+static struct bfd_io_stats io_total;
+static bfd_mutex io_lock = BFD_MUTEX_INIT;
+
+/* Return TRUE if ELEMENT_BFD, contained in ABFD, keeps its own file
+   position, as set up by _bfd_set_member_positions.  */
+
+static inline bool
+own_position_p (bfd *element_bfd, bfd *abfd)
+{
+  return (member_positions
+	  && element_bfd != abfd
+	  && abfd->iovec->breadv != NULL);
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_set_member_positions
+
+SYNOPSIS
+	void _bfd_set_member_positions (bool on);
+
+DESCRIPTION
+	While @var{on}, make seeks and reads of archive members by
+	this thread use a file position kept in the member rather
+	than the one the members of an archive share, and read
+	through the archive's <<breadv>> method, which seeks and
+	reads in one step.  Several threads may then read different
+	members of the same archive at once, so long as the archive
+	is read through the file cache.  The archive's own position
+	is left unspecified.
+*/
+
+void
+_bfd_set_member_positions (bool on)
+{
+  member_positions = on;
+}
+
+/* Read SIZE bytes at WHERE of ABFD, which has been mapped by
+   bfd_map_file_image, to PTR.  */
+
+static file_ptr
+image_bread (bfd *abfd, void *ptr, bfd_size_type size, ufile_ptr where)
+{
+  bfd_size_type image_size;
+  const bfd_byte *image = _bfd_file_image (abfd, &image_size);
+
+  if (where > image_size)
+    where = image_size;
+  if (size > image_size - where)
+    {
+      size = image_size - where;
+      bfd_set_error (bfd_error_file_truncated);
+    }
+  memcpy (ptr, image + where, size);
+  return size;
+}
 
 /*
 FUNCTION
@@ -247,6 +337,7 @@ bfd_bread (void *ptr, bfd_size_type size, bfd *abfd)
   file_ptr nread;
   bfd *element_bfd = abfd;
   ufile_ptr offset = 0;
+  ufile_ptr where;
 
   while (abfd->my_archive != NULL
 	 && !bfd_is_thin_archive (abfd->my_archive))
@@ -256,6 +347,14 @@ bfd_bread (void *ptr, bfd_size_type size, bfd *abfd)
     }
   offset += abfd->origin;
 
+  if (abfd->iovec == NULL)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return -1;
+    }
+
+  where = own_position_p (element_bfd, abfd) ? element_bfd->where : abfd->where;
+
   /* If this is a non-thin archive element, don't read past the end of
      this element.  */
   if (element_bfd->arelt_data != NULL
@@ -264,25 +363,45 @@ bfd_bread (void *ptr, bfd_size_type size, bfd *abfd)
     {
       bfd_size_type maxbytes = arelt_size (element_bfd);
 
-      if (abfd->where < offset || abfd->where - offset >= maxbytes)
+      if (where < offset || where - offset >= maxbytes)
 	{
 	  bfd_set_error (bfd_error_invalid_operation);
 	  return -1;
 	}
-      if (abfd->where - offset + size > maxbytes)
-	size = maxbytes - (abfd->where - offset);
+      if (where - offset + size > maxbytes)
+	size = maxbytes - (where - offset);
     }
 
-  if (abfd->iovec == NULL)
+  if (abfd->file_image != NULL)
     {
-      bfd_set_error (bfd_error_invalid_operation);
-      return -1;
+      nread = image_bread (abfd, ptr, size, where);
+      if (own_position_p (element_bfd, abfd))
+	element_bfd->where += nread;
+      else
+	abfd->where += nread;
+    }
+  else if (own_position_p (element_bfd, abfd))
+    {
+      struct bfd_read_range range;
+
+      range.offset = where;
+      range.size = size;
+      range.buf = ptr;
+      if (size != 0 && !abfd->iovec->breadv (abfd, &range, 1))
+	return -1;
+      element_bfd->where += size;
+      nread = size;
+    }
+  else
+    {
+      nread = abfd->iovec->bread (abfd, ptr, size);
+      if (nread == -1)
+	return nread;
+      abfd->where += nread;
     }
 
-  nread = abfd->iovec->bread (abfd, ptr, size);
-  if (nread != -1)
-    abfd->where += nread;
-
+  if (io_statistics)
+    _bfd_io_count (element_bfd, bfd_io_read, nread);
   return nread;
 }
 
@@ -315,7 +434,11 @@ bfd_bwrite (const void *ptr, bfd_size_type size, bfd *abfd)
 
   nwrote = abfd->iovec->bwrite (abfd, ptr, size);
   if (nwrote != -1)
-    abfd->where += nwrote;
+    {
+      abfd->where += nwrote;
+      if (io_statistics)
+	_bfd_io_count (abfd, bfd_io_write, nwrote);
+    }
   if ((bfd_size_type) nwrote != size)
     {
 #ifdef ENOSPC
@@ -340,6 +463,7 @@ DESCRIPTION
 file_ptr
 bfd_tell (bfd *abfd)
 {
+  bfd *element_bfd = abfd;
   ufile_ptr offset = 0;
   file_ptr ptr;
 
@@ -354,6 +478,12 @@ bfd_tell (bfd *abfd)
   if (abfd->iovec == NULL)
     return 0;
 
+  if (own_position_p (element_bfd, abfd))
+    return element_bfd->where - offset;
+
+  if (abfd->file_image != NULL)
+    return abfd->where - offset;
+
   ptr = abfd->iovec->btell (abfd);
   abfd->where = ptr;
   return ptr - offset;
@@ -432,6 +562,7 @@ int
 bfd_seek (bfd *abfd, file_ptr position, int direction)
 {
   int result;
+  bfd *element_bfd = abfd;
   ufile_ptr offset = 0;
 
   while (abfd->my_archive != NULL
@@ -453,10 +584,25 @@ bfd_seek (bfd *abfd, file_ptr position, int direction)
      element in an archive.  */
   BFD_ASSERT (direction == SEEK_SET || direction == SEEK_CUR);
 
+  if (io_statistics)
+    _bfd_io_count (element_bfd, bfd_io_seek, 0);
+
   if (direction != SEEK_CUR)
     position += offset;
 
-  result = abfd->iovec->bseek (abfd, position, direction);
+  if (own_position_p (element_bfd, abfd))
+    {
+      if (direction == SEEK_CUR)
+	element_bfd->where += position;
+      else
+	element_bfd->where = position;
+      return 0;
+    }
+
+  if (abfd->file_image != NULL)
+    result = 0;
+  else
+    result = abfd->iovec->bseek (abfd, position, direction);
   if (result != 0)
     {
       /* An EINVAL error probably means that the file offset was
@@ -478,6 +624,427 @@ bfd_seek (bfd *abfd, file_ptr position, int direction)
   return result;
 }
 
+/*
+CODE_FRAGMENT
+.{* One region of a file to be read by <<bfd_bread_vector>>.  *}
+.struct bfd_read_range
+.{
+.  {* File position of the region, as would be passed to <<bfd_seek>>.  *}
+.  file_ptr offset;
+.
+.  {* Number of bytes to read.  *}
+.  bfd_size_type size;
+.
+.  {* Where to store them.  *}
+.  void *buf;
+.};
+.
+*/
+
+/* Ranges closer together than this are fetched by a single read,
+   discarding the bytes in between.  */
+#define READV_MERGE_GAP 4096
+
+/* Don't merge ranges into a single read larger than this.  */
+#define READV_MERGE_MAX (1024 * 1024)
+
+/* A group of the caller's ranges satisfied by one iostream read.  */
+
+struct readv_run
+{
+  /* Index of the first range in the sorted array, and the number of
+     ranges in the group.  */
+  unsigned int first;
+  unsigned int count;
+};
+
+static int
+readv_compare (const void *a, const void *b)
+{
+  const struct bfd_read_range *ra = *(struct bfd_read_range *const *) a;
+  const struct bfd_read_range *rb = *(struct bfd_read_range *const *) b;
+
+  if (ra->offset != rb->offset)
+    return ra->offset < rb->offset ? -1 : 1;
+  return 0;
+}
+
+/* Read RANGES with ABFD's bseek and bread methods, for iovecs without
+   a breadv method.  */
+
+static bool
+readv_fallback (bfd *abfd, const struct bfd_read_range *ranges,
+		unsigned int count)
+{
+  unsigned int i;
+
+  for (i = 0; i < count; i++)
+    {
+      file_ptr nread;
+
+      if (abfd->iovec->bseek (abfd, ranges[i].offset, SEEK_SET) != 0)
+	{
+	  if (errno == EINVAL)
+	    bfd_set_error (bfd_error_file_truncated);
+	  else
+	    bfd_set_error (bfd_error_system_call);
+	  return false;
+	}
+      nread = abfd->iovec->bread (abfd, ranges[i].buf, ranges[i].size);
+      if (nread != (file_ptr) ranges[i].size)
+	{
+	  if (nread != -1)
+	    bfd_set_error (bfd_error_file_truncated);
+	  return false;
+	}
+    }
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_bread_vector
+
+SYNOPSIS
+	bool bfd_bread_vector (bfd *abfd, struct bfd_read_range *ranges,
+			       unsigned int count);
+
+DESCRIPTION
+	Read each of the COUNT regions described by RANGES from ABFD.
+	The regions may be given in any order.  Regions lying close
+	together in the file are fetched by a single read, so reading a
+	set of scattered tables this way costs fewer requests than
+	seeking to and reading each in turn.  Return TRUE if every
+	region was read in full; otherwise return FALSE, with the
+	contents of the buffers unspecified.  The file position
+	afterwards is unspecified, so callers should seek before any
+	further <<bfd_bread>>.
+*/
+
+bool
+bfd_bread_vector (bfd *abfd, struct bfd_read_range *ranges,
+		  unsigned int count)
+{
+  bfd *element_bfd = abfd;
+  ufile_ptr offset = 0;
+  bfd_size_type maxbytes = 0;
+  struct bfd_read_range **sorted = NULL;
+  struct bfd_read_range *io = NULL;
+  struct readv_run *runs = NULL;
+  unsigned int i, j, nsorted, nruns = 0;
+  size_t amt;
+  bool ret = false;
+
+  while (abfd->my_archive != NULL
+	 && !bfd_is_thin_archive (abfd->my_archive))
+    {
+      offset += abfd->origin;
+      abfd = abfd->my_archive;
+    }
+  offset += abfd->origin;
+
+  /* If this is a non-thin archive element, don't read past the end of
+     this element.  */
+  if (element_bfd->arelt_data != NULL
+      && element_bfd->my_archive != NULL
+      && !bfd_is_thin_archive (element_bfd->my_archive))
+    maxbytes = arelt_size (element_bfd);
+
+  if (abfd->iovec == NULL)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  if (count == 0)
+    return true;
+
+  if (io_statistics)
+    {
+      bfd_size_type total = 0;
+
+      for (i = 0; i < count; i++)
+	total += ranges[i].size;
+      _bfd_io_count (element_bfd, bfd_io_read, total);
+    }
+
+  if (_bfd_mul_overflow (count, sizeof (*io) + sizeof (*runs)
+			 + sizeof (*sorted), &amt))
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return false;
+    }
+  io = (struct bfd_read_range *) bfd_zmalloc (amt);
+  if (io == NULL)
+    return false;
+  runs = (struct readv_run *) (io + count);
+  sorted = (struct bfd_read_range **) (runs + count);
+
+  nsorted = 0;
+  for (i = 0; i < count; i++)
+    {
+      ufile_ptr pos = ranges[i].offset;
+      bfd_size_type size = ranges[i].size;
+
+      if (size == 0)
+	continue;
+      if (ranges[i].offset < 0
+	  || size > (ufile_ptr) -1 - offset - pos
+	  || (maxbytes != 0 && (pos > maxbytes || size > maxbytes - pos)))
+	{
+	  bfd_set_error (bfd_error_file_truncated);
+	  goto out;
+	}
+      sorted[nsorted++] = &ranges[i];
+    }
+  if (nsorted == 0)
+    {
+      ret = true;
+      goto out;
+    }
+  qsort (sorted, nsorted, sizeof (*sorted), readv_compare);
+
+  /* A mapped file needs no merging of nearby ranges.  */
+  if (abfd->file_image != NULL)
+    {
+      ufile_ptr end = 0;
+
+      for (i = 0; i < nsorted; i++)
+	{
+	  ufile_ptr where = sorted[i]->offset + offset;
+
+	  if (image_bread (abfd, sorted[i]->buf, sorted[i]->size, where)
+	      != (file_ptr) sorted[i]->size)
+	    goto out;
+	  end = where + sorted[i]->size;
+	}
+      if (own_position_p (element_bfd, abfd))
+	element_bfd->where = end;
+      else
+	abfd->where = end;
+      ret = true;
+      goto out;
+    }
+
+  /* Group ranges that overlap or nearly touch.  A group of one range
+     is read straight into the caller's buffer, larger groups into a
+     bounce buffer.  */
+  for (i = 0; i < nsorted; i = j)
+    {
+      ufile_ptr start = sorted[i]->offset;
+      ufile_ptr end = start + sorted[i]->size;
+
+      for (j = i + 1; j < nsorted; j++)
+	{
+	  ufile_ptr next_end = sorted[j]->offset + sorted[j]->size;
+
+	  if ((ufile_ptr) sorted[j]->offset > end + READV_MERGE_GAP)
+	    break;
+	  if (next_end < end)
+	    next_end = end;
+	  if (next_end - start > READV_MERGE_MAX)
+	    break;
+	  end = next_end;
+	}
+
+      io[nruns].offset = start + offset;
+      io[nruns].size = end - start;
+      if (j == i + 1)
+	io[nruns].buf = sorted[i]->buf;
+      else
+	{
+	  io[nruns].buf = bfd_malloc (end - start);
+	  if (io[nruns].buf == NULL)
+	    goto out;
+	}
+      runs[nruns].first = i;
+      runs[nruns].count = j - i;
+      nruns++;
+    }
+
+  if (abfd->iovec->breadv != NULL)
+    ret = abfd->iovec->breadv (abfd, io, nruns);
+  else
+    ret = readv_fallback (abfd, io, nruns);
+  if (!ret)
+    goto out;
+  if (own_position_p (element_bfd, abfd))
+    element_bfd->where = io[nruns - 1].offset + io[nruns - 1].size;
+  else
+    abfd->where = io[nruns - 1].offset + io[nruns - 1].size;
+
+  for (i = 0; i < nruns; i++)
+    if (runs[i].count > 1)
+      for (j = runs[i].first; j < runs[i].first + runs[i].count; j++)
+	memcpy (sorted[j]->buf,
+		(bfd_byte *) io[i].buf + (sorted[j]->offset + offset
+					  - io[i].offset),
+		sorted[j]->size);
+
+ out:
+  for (i = 0; i < nruns; i++)
+    if (runs[i].count > 1)
+      free (io[i].buf);
+  free (io);
+  return ret;
+}
+
+/* Serializes the bseek and bwrite pairs of bfd_pwrite for iovecs
+   without a bpwrite method.  */
+static bfd_mutex pwrite_lock;
+
+/*
+FUNCTION
+	bfd_pwrite
+
+SYNOPSIS
+	bool bfd_pwrite (const void *ptr, bfd_size_type size,
+			 file_ptr offset, bfd *abfd);
+
+DESCRIPTION
+	Write SIZE bytes from PTR at file position OFFSET of ABFD.
+	Unlike <<bfd_bwrite>>, this does not go through the file
+	position, so several threads may write different regions of
+	the same BFD at once, as long as nothing else uses the BFD
+	meanwhile.  Return TRUE if everything was written.  The file
+	position afterwards is unspecified, so callers should seek
+	before any further <<bfd_bwrite>>.
+*/
+
+bool
+bfd_pwrite (const void *ptr, bfd_size_type size, file_ptr offset,
+	    bfd *abfd)
+{
+  file_ptr nwrote;
+
+  while (abfd->my_archive != NULL
+	 && !bfd_is_thin_archive (abfd->my_archive))
+    {
+      offset += abfd->origin;
+      abfd = abfd->my_archive;
+    }
+  offset += abfd->origin;
+
+  if (abfd->iovec == NULL)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  if (size == 0)
+    return true;
+
+  if (abfd->iovec->bpwrite != NULL)
+    nwrote = abfd->iovec->bpwrite (abfd, ptr, size, offset);
+  else
+    {
+      _bfd_mutex_lock (&pwrite_lock);
+      if (abfd->iovec->bseek (abfd, offset, SEEK_SET) != 0)
+	{
+	  bfd_set_error (bfd_error_system_call);
+	  nwrote = -1;
+	}
+      else
+	nwrote = abfd->iovec->bwrite (abfd, ptr, size);
+      _bfd_mutex_unlock (&pwrite_lock);
+    }
+  if (io_statistics && nwrote != -1)
+    _bfd_io_count (abfd, bfd_io_write, nwrote);
+  if ((bfd_size_type) nwrote != size)
+    {
+#ifdef ENOSPC
+      if (nwrote != -1)
+	errno = ENOSPC;
+#endif
+      bfd_set_error (bfd_error_system_call);
+      return false;
+    }
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_preallocate
+
+SYNOPSIS
+	bool bfd_preallocate (bfd *abfd, ufile_ptr size);
+
+DESCRIPTION
+	Make the file of ABFD, which must be open for writing, at least
+	SIZE bytes long, reserving the disk space where the host allows.
+	Calling this once the layout of an output file is known lets
+	later writes to it, notably by <<bfd_pwrite>>, proceed without
+	growing the file piece by piece.  Return TRUE on success, or
+	if the iostream has no way to do this.
+*/
+
+bool
+bfd_preallocate (bfd *abfd, ufile_ptr size)
+{
+  if (abfd->my_archive != NULL || abfd->iovec == NULL)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  if (abfd->iovec->ballocate == NULL)
+    return true;
+
+  return abfd->iovec->ballocate (abfd, size) == 0;
+}
+
+/*
+FUNCTION
+	bfd_prefetch
+
+SYNOPSIS
+	void bfd_prefetch (bfd *abfd, file_ptr offset, bfd_size_type size);
+
+DESCRIPTION
+	Tell the host that the SIZE bytes of ABFD at OFFSET, counted
+	from the start of ABFD as for <<bfd_seek>>, will be read soon.
+	Where the host can, it starts reading them into memory in the
+	background, so that a later <<bfd_bread>> does not wait on the
+	disk.  Nothing is read here and nothing waits.  This is only a
+	hint: on hosts with no way to give it, and for BFDs not backed
+	by a file, it does nothing.
+*/
+
+void
+bfd_prefetch (bfd *abfd, file_ptr offset, bfd_size_type size)
+{
+  bfd *element_bfd = abfd;
+
+  if (offset < 0 || size == 0)
+    return;
+
+  /* Don't reach past the end of a non-thin archive element.  */
+  if (element_bfd->arelt_data != NULL
+      && element_bfd->my_archive != NULL
+      && !bfd_is_thin_archive (element_bfd->my_archive))
+    {
+      bfd_size_type maxbytes = arelt_size (element_bfd);
+
+      if ((ufile_ptr) offset >= maxbytes)
+	return;
+      if (size > maxbytes - offset)
+	size = maxbytes - offset;
+    }
+
+  while (abfd->my_archive != NULL
+	 && !bfd_is_thin_archive (abfd->my_archive))
+    {
+      offset += abfd->origin;
+      abfd = abfd->my_archive;
+    }
+  offset += abfd->origin;
+
+  if (abfd->iovec == NULL || abfd->iovec->bprefetch == NULL)
+    return;
+
+  abfd->iovec->bprefetch (abfd, offset, size);
+}
+
 /*
 FUNCTION
 	bfd_get_mtime
@@ -629,6 +1196,9 @@ bfd_mmap (bfd *abfd, void *addr, bfd_size_type len,
 	  int prot, int flags, file_ptr offset,
 	  void **map_addr, bfd_size_type *map_len)
 {
+  bfd *element_bfd = abfd;
+  void *ret;
+
   while (abfd->my_archive != NULL
 	 && !bfd_is_thin_archive (abfd->my_archive))
     {
@@ -643,12 +1213,332 @@ bfd_mmap (bfd *abfd, void *addr, bfd_size_type len,
       return (void *) -1;
     }
 
-  return abfd->iovec->bmmap (abfd, addr, len, prot, flags, offset,
-			     map_addr, map_len);
+  ret = abfd->iovec->bmmap (abfd, addr, len, prot, flags, offset,
+			    map_addr, map_len);
+  if (io_statistics && ret != (void *) -1)
+    _bfd_io_count (element_bfd, bfd_io_map, len);
+  return ret;
+}
+
+/*
+FUNCTION
+	bfd_munmap
+
+SYNOPSIS
+	int bfd_munmap (void *map_addr, bfd_size_type map_len);
+
+DESCRIPTION
+	Release a region mapped by <<bfd_mmap>>.  @var{map_addr} and
+	@var{map_len} are the page aligned address and length that
+	<<bfd_mmap>> returned in its MAP_ADDR and MAP_LEN arguments.
+	Return 0 on success, and -1 (setting <<bfd_error>>) on failure.
+
+*/
+
+int
+bfd_munmap (void *map_addr ATTRIBUTE_UNUSED,
+	    bfd_size_type map_len ATTRIBUTE_UNUSED)
+{
+#if HAVE_MMAP
+  if (munmap (map_addr, map_len) == 0)
+    return 0;
+  bfd_set_error (bfd_error_system_call);
+#elif defined (_WIN32)
+  if (UnmapViewOfFile (map_addr))
+    return 0;
+  bfd_set_error (bfd_error_system_call);
+#else
+  bfd_set_error (bfd_error_invalid_operation);
+#endif
+  return -1;
+}
+
+/*
+CODE_FRAGMENT
+.{* Counts of the I/O done, see <<bfd_get_io_statistics>>.  *}
+.struct bfd_io_stats
+.{
+.  {* Calls of <<bfd_bread>> and <<bfd_bread_vector>>, and the bytes
+.     they read.  *}
+.  unsigned long long reads;
+.  unsigned long long read_bytes;
+.  {* Calls of <<bfd_bwrite>> and <<bfd_pwrite>>, and the bytes they
+.     wrote.  *}
+.  unsigned long long writes;
+.  unsigned long long write_bytes;
+.  {* Calls of <<bfd_seek>>.  *}
+.  unsigned long long seeks;
+.  {* Regions mapped by <<bfd_mmap>>, and their total length.  *}
+.  unsigned long long maps;
+.  unsigned long long mapped_bytes;
+.  {* Times the file cache opened the file, opened it again after
+.     it had been closed, and closed it to stay within
+.     <<bfd_cache_set_max_open>> files.  *}
+.  unsigned long long opens;
+.  unsigned long long reopens;
+.  unsigned long long evictions;
+.};
+.
+*/
+
+/*
+FUNCTION
+	bfd_set_io_statistics
+
+SYNOPSIS
+	bool bfd_set_io_statistics (bool enable);
+
+DESCRIPTION
+	Turn on or off the counting of reads, writes, seeks and maps
+	of each BFD, and of how often the file cache opens and closes
+	its file.  Counting takes a lock for every call, so is off by
+	default.  Returns the previous setting.
+*/
+
+bool
+bfd_set_io_statistics (bool enable)
+{
+  bool old = io_statistics;
+
+  io_statistics = enable;
+  return old;
+}
+
+/*
+FUNCTION
+	bfd_set_io_statistics_file
+
+SYNOPSIS
+	void bfd_set_io_statistics_file (void *);
+
+DESCRIPTION
+	Count I/O as <<bfd_set_io_statistics>> does, and print the
+	counts of each BFD that did any to @var{file}, a <<FILE *>>,
+	as it is closed.  A NULL @var{file} stops the printing but
+	not the counting.
+*/
+
+void
+bfd_set_io_statistics_file (void *file)
+{
+  io_statistics_file = (FILE *) file;
+  if (file != NULL)
+    io_statistics = true;
+}
+
+/*
+FUNCTION
+	bfd_get_io_statistics
+
+SYNOPSIS
+	bool bfd_get_io_statistics
+	  (const bfd *abfd, struct bfd_io_stats *stats);
+
+DESCRIPTION
+	Fill in @var{stats} with the I/O counted for @var{abfd}, or if
+	@var{abfd} is NULL, for all BFDs.  Reads of an archive member
+	are counted for the member, while the file cache's counts are
+	for the archive whose file it opens.  Returns <<FALSE>> if
+	counting is off.
+*/
+
+bool
+bfd_get_io_statistics (const bfd *abfd, struct bfd_io_stats *stats)
+{
+  if (!io_statistics)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  _bfd_mutex_lock (&io_lock);
+  if (abfd == NULL)
+    *stats = io_total;
+  else if (abfd->io_stats != NULL)
+    *stats = *abfd->io_stats;
+  else
+    memset (stats, 0, sizeof (*stats));
+  _bfd_mutex_unlock (&io_lock);
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_print_io_statistics
+
+SYNOPSIS
+	void bfd_print_io_statistics (void *, const bfd *);
+
+DESCRIPTION
+	Print the I/O counted for a BFD, or for all BFDs if it is
+	NULL, to a file, which is a <<FILE *>>, in the manner of
+	<<bfd_hash_print_statistics>>.
+*/
+
+void
+bfd_print_io_statistics (void *file, const bfd *abfd)
+{
+  FILE *f = (FILE *) file;
+  struct bfd_io_stats st;
+
+  if (!bfd_get_io_statistics (abfd, &st))
+    return;
+
+  if (abfd == NULL)
+    fprintf (f, "I/O statistics:\n");
+  else if (abfd->my_archive != NULL
+	   && !bfd_is_thin_archive (abfd->my_archive))
+    fprintf (f, "%s(%s) I/O statistics:\n",
+	     bfd_get_filename (abfd->my_archive), bfd_get_filename (abfd));
+  else
+    fprintf (f, "%s I/O statistics:\n", bfd_get_filename (abfd));
+  fprintf (f, "\t%llu reads, %llu bytes\n", st.reads, st.read_bytes);
+  fprintf (f, "\t%llu writes, %llu bytes\n", st.writes, st.write_bytes);
+  fprintf (f, "\t%llu seeks\n", st.seeks);
+  fprintf (f, "\t%llu maps, %llu bytes\n", st.maps, st.mapped_bytes);
+  fprintf (f, "\t%llu opens, %llu reopens, %llu evictions\n",
+	   st.opens, st.reopens, st.evictions);
+}
+
+/*
+INTERNAL_DEFINITION
+	enum bfd_io_event
+
+DESCRIPTION
+	The kinds of I/O that <<_bfd_io_count>> counts.
+
+.enum bfd_io_event
+.{
+.  bfd_io_read, bfd_io_write, bfd_io_seek, bfd_io_map,
+.  bfd_io_open, bfd_io_reopen, bfd_io_evict
+.};
+.
+*/
+
+/* Add EVENT, moving BYTES, to the counts of STATS.  */
+
+static void
+io_stats_add (struct bfd_io_stats *stats, enum bfd_io_event event,
+	      bfd_size_type bytes)
+{
+  switch (event)
+    {
+    case bfd_io_read:
+      stats->reads++;
+      stats->read_bytes += bytes;
+      break;
+    case bfd_io_write:
+      stats->writes++;
+      stats->write_bytes += bytes;
+      break;
+    case bfd_io_seek:
+      stats->seeks++;
+      break;
+    case bfd_io_map:
+      stats->maps++;
+      stats->mapped_bytes += bytes;
+      break;
+    case bfd_io_open:
+      stats->opens++;
+      break;
+    case bfd_io_reopen:
+      stats->reopens++;
+      break;
+    case bfd_io_evict:
+      stats->evictions++;
+      break;
+    }
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_io_count
+
+SYNOPSIS
+	void _bfd_io_count
+	  (bfd *abfd, enum bfd_io_event event, bfd_size_type bytes);
+
+DESCRIPTION
+	Count @var{event}, which moved @var{bytes}, for @var{abfd} and
+	for all BFDs.  Does nothing if counting is off.
+*/
+
+void
+_bfd_io_count (bfd *abfd, enum bfd_io_event event, bfd_size_type bytes)
+{
+  if (!io_statistics)
+    return;
+
+  _bfd_mutex_lock (&io_lock);
+  if (abfd->io_stats == NULL)
+    abfd->io_stats = ((struct bfd_io_stats *)
+		      calloc (1, sizeof (*abfd->io_stats)));
+  if (abfd->io_stats != NULL)
+    io_stats_add (abfd->io_stats, event, bytes);
+  io_stats_add (&io_total, event, bytes);
+  _bfd_mutex_unlock (&io_lock);
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_io_release
+
+SYNOPSIS
+	void _bfd_io_release (bfd *abfd);
+
+DESCRIPTION
+	Print the I/O counted for @var{abfd}, if there is any and
+	<<bfd_set_io_statistics_file>> asked for it, and free the
+	counts.  Called as @var{abfd} is closed.
+*/
+
+void
+_bfd_io_release (bfd *abfd)
+{
+  if (abfd->io_stats == NULL)
+    return;
+
+  if (io_statistics_file != NULL && io_statistics)
+    bfd_print_io_statistics (io_statistics_file, abfd);
+  free (abfd->io_stats);
+  abfd->io_stats = NULL;
 }
 
 /* Memory file I/O operations.  */
 
+/* Make BIM hold at least SIZE bytes, growing its size to SIZE if it
+   is smaller.  The buffer at least doubles each time it has to be
+   reallocated, so contents written a little at a time are copied a
+   bounded number of times in all.  Return FALSE, with the contents
+   gone, if there is no memory for them.  */
+
+static bool
+memory_extend (struct bfd_in_memory *bim, bfd_size_type size)
+{
+  if (size > bim->capacity)
+    {
+      bfd_size_type newcap = bim->capacity * 2;
+
+      /* Round up to cut down on memory fragmentation.  */
+      if (newcap < size)
+	newcap = (size + 127) & ~(bfd_size_type) 127;
+      if (newcap < size)
+	newcap = size;
+      bim->buffer = (bfd_byte *) bfd_realloc_or_free (bim->buffer, newcap);
+      if (bim->buffer == NULL)
+	{
+	  bim->size = 0;
+	  bim->capacity = 0;
+	  return false;
+	}
+      memset (bim->buffer + bim->capacity, 0, newcap - bim->capacity);
+      bim->capacity = newcap;
+    }
+  if (size > bim->size)
+    bim->size = size;
+  return true;
+}
+
 static file_ptr
 memory_bread (bfd *abfd, void *ptr, file_ptr size)
 {
@@ -674,26 +1564,9 @@ memory_bwrite (bfd *abfd, const void *ptr, file_ptr size)
 {
   struct bfd_in_memory *bim = (struct bfd_in_memory *) abfd->iostream;
 
-  if (abfd->where + size > bim->size)
-    {
-      bfd_size_type newsize, oldsize;
-
-      oldsize = (bim->size + 127) & ~(bfd_size_type) 127;
-      bim->size = abfd->where + size;
-      /* Round up to cut down on memory fragmentation */
-      newsize = (bim->size + 127) & ~(bfd_size_type) 127;
-      if (newsize > oldsize)
-	{
-	  bim->buffer = (bfd_byte *) bfd_realloc_or_free (bim->buffer, newsize);
-	  if (bim->buffer == NULL)
-	    {
-	      bim->size = 0;
-	      return 0;
-	    }
-	  if (newsize > bim->size)
-	    memset (bim->buffer + bim->size, 0, newsize - bim->size);
-	}
-    }
+  if (abfd->where + size > bim->size
+      && !memory_extend (bim, abfd->where + size))
+    return 0;
   memcpy (bim->buffer + abfd->where, ptr, (size_t) size);
   return size;
 }
@@ -729,22 +1602,10 @@ memory_bseek (bfd *abfd, file_ptr position, int direction)
       if (abfd->direction == write_direction
 	  || abfd->direction == both_direction)
 	{
-	  bfd_size_type newsize, oldsize;
-
-	  oldsize = (bim->size + 127) & ~(bfd_size_type) 127;
-	  bim->size = nwhere;
-	  /* Round up to cut down on memory fragmentation */
-	  newsize = (bim->size + 127) & ~(bfd_size_type) 127;
-	  if (newsize > oldsize)
+	  if (!memory_extend (bim, nwhere))
 	    {
-	      bim->buffer = (bfd_byte *) bfd_realloc_or_free (bim->buffer, newsize);
-	      if (bim->buffer == NULL)
-		{
-		  errno = EINVAL;
-		  bim->size = 0;
-		  return -1;
-		}
-	      memset (bim->buffer + oldsize, 0, newsize - oldsize);
+	      errno = EINVAL;
+	      return -1;
 	    }
 	}
       else
@@ -800,5 +1661,6 @@ memory_bmmap (bfd *abfd ATTRIBUTE_UNUSED, void *addr ATTRIBUTE_UNUSED,
 const struct bfd_iovec _bfd_memory_iovec =
 {
   &memory_bread, &memory_bwrite, &memory_btell, &memory_bseek,
-  &memory_bclose, &memory_bflush, &memory_bstat, &memory_bmmap
+  &memory_bclose, &memory_bflush, &memory_bstat, &memory_bmmap,
+  NULL, NULL, NULL, NULL
 };
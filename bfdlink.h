@@ -222,6 +222,12 @@ extern struct bfd_link_hash_entry *bfd_link_hash_lookup
   (struct bfd_link_hash_table *, const char *, bool create,
    bool copy, bool follow);
 
+/* Likewise, with the hash code of the string, as returned by
+   bfd_hash_string_hash, already known.  */
+extern struct bfd_link_hash_entry *bfd_link_hash_lookup_with_hash
+  (struct bfd_link_hash_table *, const char *, unsigned long long hash,
+   bool create, bool copy, bool follow);
+
 /* Look up an entry in the main linker hash table if the symbol might
    be wrapped.  This should only be used for references to an
    undefined symbol, not for definitions of a symbol.  */
@@ -241,6 +247,13 @@ extern void bfd_link_hash_traverse
     bool (*) (struct bfd_link_hash_entry *, void *),
     void *);
 
+/* Traverse a link hash table on several threads, combining the
+   results of each piece in order with the reduction function.  */
+extern bool bfd_link_hash_traverse_parallel
+  (struct bfd_link_hash_table *,
+   bool (*) (struct bfd_link_hash_entry *, void *, void *),
+   size_t, bool (*) (void *, void *), void *);
+
 /* Add an entry to the undefs list.  */
 extern void bfd_link_add_undef
   (struct bfd_link_hash_table *, struct bfd_link_hash_entry *);
@@ -733,6 +746,11 @@ struct bfd_link_info
   /* The maximum cache size.  Backend can use cache_size and and
      max_cache_size to decide if keep_memory should be honored.  */
   bfd_size_type max_cache_size;
+
+  /* If non-NULL, the file in which the ELF final link records the
+     layout of the output, for bfd_elf_incremental_compare to check a
+     later link of the same output against.  */
+  const char *incremental_state;
 };
 
 /* Some forward-definitions used by some callbacks.  */
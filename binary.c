@@ -41,6 +41,10 @@
    a start symbol, an end symbol, and an absolute length symbol.  */
 #define BIN_SYMS 3
 
+/* Writes of at least this many bytes go straight to the file with
+   bfd_pwrite, rather than through the stdio buffer.  */
+#define BIN_PWRITE_MIN 0x10000
+
 /* Create a binary object.  Invoked via bfd_set_format.  */
 
 static bool
@@ -93,20 +97,10 @@ binary_object_p (bfd *abfd)
 #define binary_bfd_free_cached_info  _bfd_generic_bfd_free_cached_info
 #define binary_new_section_hook      _bfd_generic_new_section_hook
 
-/* Get contents of the only section.  */
-
-static bool
-binary_get_section_contents (bfd *abfd,
-			     asection *section,
-			     void * location,
-			     file_ptr offset,
-			     bfd_size_type count)
-{
-  if (bfd_seek (abfd, section->filepos + offset, SEEK_SET) != 0
-      || bfd_bread (location, count, abfd) != count)
-    return false;
-  return true;
-}
+/* Get contents of the only section.  The section is the whole file,
+   so the generic routine serves, and using it lets
+   bfd_get_section_contents_view map the file rather than copy it.  */
+#define binary_get_section_contents  _bfd_generic_get_section_contents
 
 /* Return the amount of memory needed to read the symbol table.  */
 
@@ -290,6 +284,9 @@ binary_set_section_contents (bfd *abfd,
   if ((sec->flags & SEC_NEVER_LOAD) != 0)
     return true;
 
+  if (size >= BIN_PWRITE_MIN && sec->filepos + offset >= 0)
+    return bfd_pwrite (data, size, sec->filepos + offset, abfd);
+
   return _bfd_generic_set_section_contents (abfd, sec, data, offset, size);
 }
 
@@ -168,7 +168,7 @@
 /* #undef HAVE_WINDOWS_H */
 
 /* Define to 1 if zstd is enabled. */
-/* #undef HAVE_ZSTD */
+#define HAVE_ZSTD 1
 
 /* Define as const if the declaration of iconv() needs const. */
 #define ICONV_CONST 
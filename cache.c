@@ -36,6 +36,11 @@ SECTION
 	close, closes it and opens the one wanted, returning its file
 	handle.
 
+	The list is split into shards, each with its own lock, so that
+	different BFDs may be read from several threads at once.  The
+	limit on open files can be changed with
+	<<bfd_cache_set_max_open>>.
+
 SUBSECTION
 	Caching functions
 */
@@ -45,8 +50,18 @@ SUBSECTION
 #include "libbfd.h"
 #include "libiberty.h"
 
+#ifdef HAVE_GETRLIMIT
+#include <sys/resource.h>
+#endif
+
 #if HAVE_MMAP
 #include <sys/mman.h>
+#elif defined (_WIN32)
+#include <windows.h>
+#include <io.h>
+#endif
+#ifndef _WIN32
+#include <unistd.h>
 #endif
 
 /* In some cases we can optimize cache operation when reopening files.
@@ -91,8 +106,12 @@ bfd_cache_max_open (void)
 	 limitation will be removed soon).  64-bit Solaris libc does not have
 	 this limitation.  */
       max = 16;
+#elif defined (_WIN32)
+      /* The C runtime limits the number of open streams rather than
+	 the number of descriptors.  */
+      max = _getmaxstdio () / 8;
 #else
-#if 0
+#ifdef HAVE_GETRLIMIT
       struct rlimit rlim;
 
       if (getrlimit (RLIMIT_NOFILE, &rlim) == 0
@@ -113,55 +132,89 @@ bfd_cache_max_open (void)
   return max_open_files;
 }
 
-/* The number of BFD files we have open.  */
+/* The number of BFD files we have open, in all shards.  Only updated
+   with _bfd_atomic_add.  */
 
 static int open_files;
 
-/* Zero, or a pointer to the topmost BFD on the chain.  This is
-   used by the <<bfd_cache_lookup>> macro in @file{libbfd.h} to
-   determine when it can avoid a function call.  */
+/* The cache is split into shards, each with its own lock and least
+   recently used ring, so that threads working on different BFDs
+   rarely contend.  A BFD always belongs to the shard selected by its
+   id.  The limit on open files is shared: when it is reached, a file
+   from the shard needing a new one is closed.  */
+
+#define CACHE_SHARDS 8
+
+struct cache_shard
+{
+  /* Held while the ring, or the stream of any BFD on it, is used.  */
+  bfd_mutex lock;
+
+  /* Zero, or a pointer to the topmost BFD on the chain.  This is
+     used by the <<bfd_cache_lookup>> macro to determine when it can
+     avoid a function call.  */
+  bfd *last;
+};
 
-static bfd *bfd_last_cache = NULL;
+static struct cache_shard cache_shards[CACHE_SHARDS];
+
+/* Return the shard of ABFD, locked.  */
+
+static struct cache_shard *
+cache_lock (bfd *abfd)
+{
+  struct cache_shard *shard;
+
+  shard = &cache_shards[(unsigned int) abfd->id % CACHE_SHARDS];
+  _bfd_mutex_lock (&shard->lock);
+  return shard;
+}
+
+static inline void
+cache_unlock (struct cache_shard *shard)
+{
+  _bfd_mutex_unlock (&shard->lock);
+}
 
 /* Insert a BFD into the cache.  */
 
 static void
-insert (bfd *abfd)
+insert (struct cache_shard *shard, bfd *abfd)
 {
-  if (bfd_last_cache == NULL)
+  if (shard->last == NULL)
     {
       abfd->lru_next = abfd;
       abfd->lru_prev = abfd;
     }
   else
     {
-      abfd->lru_next = bfd_last_cache;
-      abfd->lru_prev = bfd_last_cache->lru_prev;
+      abfd->lru_next = shard->last;
+      abfd->lru_prev = shard->last->lru_prev;
       abfd->lru_prev->lru_next = abfd;
       abfd->lru_next->lru_prev = abfd;
     }
-  bfd_last_cache = abfd;
+  shard->last = abfd;
 }
 
 /* Remove a BFD from the cache.  */
 
 static void
-snip (bfd *abfd)
+snip (struct cache_shard *shard, bfd *abfd)
 {
   abfd->lru_prev->lru_next = abfd->lru_next;
   abfd->lru_next->lru_prev = abfd->lru_prev;
-  if (abfd == bfd_last_cache)
+  if (abfd == shard->last)
     {
-      bfd_last_cache = abfd->lru_next;
-      if (abfd == bfd_last_cache)
-	bfd_last_cache = NULL;
+      shard->last = abfd->lru_next;
+      if (abfd == shard->last)
+	shard->last = NULL;
     }
 }
 
 /* Close a BFD and remove it from the cache.  */
 
 static bool
-bfd_cache_delete (bfd *abfd)
+bfd_cache_delete (struct cache_shard *shard, bfd *abfd)
 {
   bool ret;
 
@@ -173,32 +226,32 @@ bfd_cache_delete (bfd *abfd)
       bfd_set_error (bfd_error_system_call);
     }
 
-  snip (abfd);
+  snip (shard, abfd);
 
   abfd->iostream = NULL;
-  --open_files;
+  _bfd_atomic_add (&open_files, -1);
   abfd->flags |= BFD_CLOSED_BY_CACHE;
 
   return ret;
 }
 
 /* We need to open a new file, and the cache is full.  Find the least
-   recently used cacheable BFD and close it.  */
+   recently used cacheable BFD in SHARD and close it.  */
 
 static bool
-close_one (void)
+close_one (struct cache_shard *shard)
 {
   register bfd *to_kill;
 
-  if (bfd_last_cache == NULL)
+  if (shard->last == NULL)
     to_kill = NULL;
   else
     {
-      for (to_kill = bfd_last_cache->lru_prev;
-	   ! to_kill->cacheable;
+      for (to_kill = shard->last->lru_prev;
+	   ! to_kill->cacheable || to_kill->cache_pins != 0;
 	   to_kill = to_kill->lru_prev)
 	{
-	  if (to_kill == bfd_last_cache)
+	  if (to_kill == shard->last)
 	    {
 	      to_kill = NULL;
 	      break;
@@ -213,19 +266,25 @@ close_one (void)
     }
 
   to_kill->where = _bfd_real_ftell ((FILE *) to_kill->iostream);
+  _bfd_io_count (to_kill, bfd_io_evict, 0);
+  _bfd_hook (bfd_hook_cache_evict, to_kill, NULL, NULL, to_kill->where, 0);
 
-  return bfd_cache_delete (to_kill);
+  return bfd_cache_delete (shard, to_kill);
 }
 
+static bool cache_init (struct cache_shard *, bfd *);
+static FILE *cache_open_file (struct cache_shard *, bfd *);
+
 /* Check to see if the required BFD is the same as the last one
    looked up. If so, then it can use the stream in the BFD with
    impunity, since it can't have changed since the last lookup;
-   otherwise, it has to perform the complicated lookup function.  */
+   otherwise, it has to perform the complicated lookup function.
+   SHARD must be locked.  */
 
-#define bfd_cache_lookup(x, flag) \
-  ((x) == bfd_last_cache			\
-   ? (FILE *) (bfd_last_cache->iostream)	\
-   : bfd_cache_lookup_worker (x, flag))
+#define bfd_cache_lookup(shard, x, flag)	\
+  ((x) == (shard)->last				\
+   ? (FILE *) ((shard)->last->iostream)		\
+   : bfd_cache_lookup_worker (shard, x, flag))
 
 /* Called when the macro <<bfd_cache_lookup>> fails to find a
    quick answer.  Find a file descriptor for @var{abfd}.  If
@@ -235,7 +294,8 @@ close_one (void)
    if it is unable to (re)open the @var{abfd}.  */
 
 static FILE *
-bfd_cache_lookup_worker (bfd *abfd, enum cache_flag flag)
+bfd_cache_lookup_worker (struct cache_shard *shard, bfd *abfd,
+			 enum cache_flag flag)
 {
   if ((abfd->flags & BFD_IN_MEMORY) != 0)
     abort ();
@@ -247,10 +307,10 @@ bfd_cache_lookup_worker (bfd *abfd, enum cache_flag flag)
   if (abfd->iostream != NULL)
     {
       /* Move the file to the start of the cache.  */
-      if (abfd != bfd_last_cache)
+      if (abfd != shard->last)
 	{
-	  snip (abfd);
-	  insert (abfd);
+	  snip (shard, abfd);
+	  insert (shard, abfd);
 	}
       return (FILE *) abfd->iostream;
     }
@@ -258,7 +318,7 @@ bfd_cache_lookup_worker (bfd *abfd, enum cache_flag flag)
   if (flag & CACHE_NO_OPEN)
     return NULL;
 
-  if (bfd_open_file (abfd) == NULL)
+  if (cache_open_file (shard, abfd) == NULL)
     ;
   else if (!(flag & CACHE_NO_SEEK)
 	   && _bfd_real_fseek ((FILE *) abfd->iostream,
@@ -277,19 +337,32 @@ bfd_cache_lookup_worker (bfd *abfd, enum cache_flag flag)
 static file_ptr
 cache_btell (struct bfd *abfd)
 {
-  FILE *f = bfd_cache_lookup (abfd, CACHE_NO_OPEN);
+  struct cache_shard *shard = cache_lock (abfd);
+  FILE *f = bfd_cache_lookup (shard, abfd, CACHE_NO_OPEN);
+  file_ptr ret;
+
   if (f == NULL)
-    return abfd->where;
-  return _bfd_real_ftell (f);
+    ret = abfd->where;
+  else
+    ret = _bfd_real_ftell (f);
+  cache_unlock (shard);
+  return ret;
 }
 
 static int
 cache_bseek (struct bfd *abfd, file_ptr offset, int whence)
 {
-  FILE *f = bfd_cache_lookup (abfd, whence != SEEK_CUR ? CACHE_NO_SEEK : CACHE_NORMAL);
+  struct cache_shard *shard = cache_lock (abfd);
+  FILE *f = bfd_cache_lookup (shard, abfd,
+			      whence != SEEK_CUR ? CACHE_NO_SEEK : CACHE_NORMAL);
+  int ret;
+
   if (f == NULL)
-    return -1;
-  return _bfd_real_fseek (f, offset, whence);
+    ret = -1;
+  else
+    ret = _bfd_real_fseek (f, offset, whence);
+  cache_unlock (shard);
+  return ret;
 }
 
 /* Note that archive entries don't have streams; they share their parent's.
@@ -334,15 +407,12 @@ cache_bread_1 (FILE *f, void *buf, file_ptr nbytes)
   return nread;
 }
 
+/* Read NBYTES from F into BUF.  */
+
 static file_ptr
-cache_bread (struct bfd *abfd, void *buf, file_ptr nbytes)
+cache_bread_chunks (FILE *f, void *buf, file_ptr nbytes)
 {
   file_ptr nread = 0;
-  FILE *f;
-
-  f = bfd_cache_lookup (abfd, CACHE_NORMAL);
-  if (f == NULL)
-    return -1;
 
   /* Some filesystems are unable to handle reads that are too large
      (for instance, NetApp shares with oplocks turned off).  To avoid
@@ -376,23 +446,333 @@ cache_bread (struct bfd *abfd, void *buf, file_ptr nbytes)
   return nread;
 }
 
+static file_ptr
+cache_bread (struct bfd *abfd, void *buf, file_ptr nbytes)
+{
+  struct cache_shard *shard;
+  file_ptr nread;
+  FILE *f;
+
+  shard = cache_lock (abfd);
+  f = bfd_cache_lookup (shard, abfd, CACHE_NORMAL);
+  if (f == NULL)
+    {
+      cache_unlock (shard);
+      return -1;
+    }
+
+  nread = cache_bread_chunks (f, buf, nbytes);
+  cache_unlock (shard);
+  return nread;
+}
+
+/* Read NBYTES at OFFSET of the file open as FD into BUF with pread,
+   or ReadFile with an OVERLAPPED offset on Windows, without using the
+   file position.  As in cache_bread_chunks, no single read is larger
+   than 8MB.  Return the number of bytes read.  */
+
+static file_ptr
+cache_pread (int fd, void *buf, file_ptr nbytes, file_ptr offset)
+{
+  file_ptr nread = 0;
+
+  while (nread < nbytes)
+    {
+      const file_ptr max_chunk_size = 0x800000;
+      file_ptr chunk_size = nbytes - nread;
+      file_ptr pos = offset + nread;
+
+      if (chunk_size > max_chunk_size)
+	chunk_size = max_chunk_size;
+
+#if defined (_WIN32)
+      OVERLAPPED ov;
+      DWORD got;
+
+      memset (&ov, 0, sizeof (ov));
+      ov.Offset = (DWORD) pos;
+      ov.OffsetHigh = (DWORD) ((uint64_t) pos >> 32);
+      if (!ReadFile ((HANDLE) _get_osfhandle (fd), (char *) buf + nread,
+		     (DWORD) chunk_size, &got, &ov))
+	{
+	  if (GetLastError () != ERROR_HANDLE_EOF)
+	    {
+	      bfd_set_error (bfd_error_system_call);
+	      return -1;
+	    }
+	  got = 0;
+	}
+#else
+      ssize_t got = pread (fd, (char *) buf + nread, chunk_size, pos);
+
+      if (got < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  bfd_set_error (bfd_error_system_call);
+	  return -1;
+	}
+#endif
+      if (got == 0)
+	break;
+      nread += got;
+    }
+  if (nread < nbytes)
+    bfd_set_error (bfd_error_file_truncated);
+  return nread;
+}
+
+/* Ranges of a file read by cache_pread_ranges.  */
+
+struct cache_readv_job
+{
+  int fd;
+  const struct bfd_read_range *ranges;
+};
+
+/* Read ranges START to END of the job in DATA, a cache_readv_job.
+   Worker for _bfd_parallel_for.  */
+
+static bool
+cache_pread_ranges (void *data, size_t start, size_t end)
+{
+  struct cache_readv_job *job = (struct cache_readv_job *) data;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    if (cache_pread (job->fd, job->ranges[i].buf, job->ranges[i].size,
+		     job->ranges[i].offset) != (file_ptr) job->ranges[i].size)
+      return false;
+  return true;
+}
+
+/* Read all of RANGES while holding the cache lock once, rather than
+   taking it for every seek and read.  */
+
+static bool
+cache_breadv (struct bfd *abfd, const struct bfd_read_range *ranges,
+	      unsigned int count)
+{
+  struct cache_shard *shard;
+  unsigned int i;
+  bool ret = true;
+  FILE *f;
+
+  shard = cache_lock (abfd);
+  f = bfd_cache_lookup (shard, abfd, CACHE_NO_SEEK);
+  if (f == NULL)
+    {
+      cache_unlock (shard);
+      return false;
+    }
+
+  /* A file only read has nothing in its stdio buffer waiting to be
+     written, so it can be read by position without the lock, leaving
+     the rest of the shard free meanwhile.  The ranges are read on
+     several threads when bfd_set_thread_count allows, so that many
+     reads are in flight at once rather than each waiting for the
+     one before.  */
+  if (abfd->direction == read_direction && count != 0)
+    {
+      struct cache_readv_job job;
+      file_ptr end = ranges[count - 1].offset + ranges[count - 1].size;
+
+      job.fd = fileno (f);
+      job.ranges = ranges;
+      abfd->cache_pins++;
+      cache_unlock (shard);
+
+      if (count > 1)
+	ret = _bfd_parallel_for (count, 1, cache_pread_ranges, &job);
+      else
+	ret = cache_pread_ranges (&job, 0, 1);
+
+      /* Leave the stream where seeking to and reading the last range
+	 would have.  */
+      shard = cache_lock (abfd);
+      abfd->cache_pins--;
+      if (ret && _bfd_real_fseek (f, end, SEEK_SET) != 0)
+	{
+	  bfd_set_error (bfd_error_system_call);
+	  ret = false;
+	}
+      cache_unlock (shard);
+      return ret;
+    }
+
+  for (i = 0; i < count; i++)
+    {
+      file_ptr size = ranges[i].size;
+
+      if (_bfd_real_fseek (f, ranges[i].offset, SEEK_SET) != 0)
+	{
+	  if (errno == EINVAL)
+	    bfd_set_error (bfd_error_file_truncated);
+	  else
+	    bfd_set_error (bfd_error_system_call);
+	  ret = false;
+	  break;
+	}
+      if (cache_bread_chunks (f, ranges[i].buf, size) != size)
+	{
+	  ret = false;
+	  break;
+	}
+    }
+
+  cache_unlock (shard);
+  return ret;
+}
+
 static file_ptr
 cache_bwrite (struct bfd *abfd, const void *from, file_ptr nbytes)
 {
+  struct cache_shard *shard = cache_lock (abfd);
   file_ptr nwrite;
-  FILE *f = bfd_cache_lookup (abfd, CACHE_NORMAL);
+  FILE *f = bfd_cache_lookup (shard, abfd, CACHE_NORMAL);
+
+  if (f == NULL)
+    nwrite = 0;
+  else
+    {
+      nwrite = fwrite (from, 1, nbytes, f);
+      if (nwrite < nbytes && ferror (f))
+	{
+	  bfd_set_error (bfd_error_system_call);
+	  nwrite = -1;
+	}
+    }
+  cache_unlock (shard);
+  return nwrite;
+}
+
+/* Write at OFFSET with pwrite, or WriteFile with an OVERLAPPED offset
+   on Windows.  Only the lookup is done under the cache lock, so that
+   several threads can write to the file at once.  */
+
+static file_ptr
+cache_bpwrite (struct bfd *abfd, const void *from, file_ptr nbytes,
+	       file_ptr offset)
+{
+  struct cache_shard *shard = cache_lock (abfd);
+  file_ptr nwrite = 0;
+  FILE *f = bfd_cache_lookup (shard, abfd, CACHE_NO_SEEK);
+  int fd;
 
   if (f == NULL)
-    return 0;
-  nwrite = fwrite (from, 1, nbytes, f);
-  if (nwrite < nbytes && ferror (f))
     {
+      cache_unlock (shard);
+      return -1;
+    }
+
+  /* Data still in the stdio buffer would otherwise land on top of
+     what is written here.  Don't let the cache close the file while
+     the write is in progress; it stays open until bfd_close.  */
+  if (fflush (f) != 0)
+    {
+      cache_unlock (shard);
       bfd_set_error (bfd_error_system_call);
       return -1;
     }
+  abfd->cacheable = false;
+  fd = fileno (f);
+  cache_unlock (shard);
+
+  while (nwrite < nbytes)
+    {
+      /* As in cache_bread, avoid single writes larger than 8MB.  */
+      const file_ptr max_chunk_size = 0x800000;
+      file_ptr chunk_size = nbytes - nwrite;
+      file_ptr pos = offset + nwrite;
+
+      if (chunk_size > max_chunk_size)
+	chunk_size = max_chunk_size;
+
+#if defined (_WIN32)
+      OVERLAPPED ov;
+      DWORD put;
+
+      memset (&ov, 0, sizeof (ov));
+      ov.Offset = (DWORD) pos;
+      ov.OffsetHigh = (DWORD) ((uint64_t) pos >> 32);
+      if (!WriteFile ((HANDLE) _get_osfhandle (fd),
+		      (const char *) from + nwrite, (DWORD) chunk_size,
+		      &put, &ov))
+	{
+	  bfd_set_error (bfd_error_system_call);
+	  return -1;
+	}
+#else
+      ssize_t put = pwrite (fd, (const char *) from + nwrite,
+			    chunk_size, pos);
+
+      if (put < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  bfd_set_error (bfd_error_system_call);
+	  return -1;
+	}
+#endif
+      if (put == 0)
+	break;
+      nwrite += put;
+    }
   return nwrite;
 }
 
+static int
+cache_ballocate (struct bfd *abfd, file_ptr size)
+{
+  struct cache_shard *shard = cache_lock (abfd);
+  int sts = -1;
+  FILE *f = bfd_cache_lookup (shard, abfd, CACHE_NO_SEEK);
+
+  if (f != NULL && fflush (f) == 0)
+    {
+#if defined (_WIN32)
+      int fd = _fileno (f);
+
+      sts = 0;
+      if (_filelengthi64 (fd) < size)
+	sts = _chsize_s (fd, size) == 0 ? 0 : -1;
+#else
+      struct stat st;
+
+      sts = fstat (fileno (f), &st);
+      if (sts == 0 && st.st_size < size)
+	sts = ftruncate (fileno (f), size);
+#endif
+    }
+  if (f != NULL && sts != 0)
+    bfd_set_error (bfd_error_system_call);
+  cache_unlock (shard);
+  return sts;
+}
+
+static int
+cache_bprefetch (struct bfd *abfd, file_ptr offset, file_ptr size)
+{
+#if defined (POSIX_FADV_WILLNEED)
+  struct cache_shard *shard = cache_lock (abfd);
+  int sts = -1;
+  FILE *f = bfd_cache_lookup (shard, abfd, CACHE_NO_SEEK);
+
+  if (f != NULL
+      && posix_fadvise (fileno (f), offset, size, POSIX_FADV_WILLNEED) == 0)
+    sts = 0;
+  cache_unlock (shard);
+  return sts;
+#else
+  (void) abfd;
+  (void) offset;
+  (void) size;
+  /* Windows has no per-range readahead hint for an open file, and the
+     cache already opens files for sequential access.  */
+  return -1;
+#endif
+}
+
 static int
 cache_bclose (struct bfd *abfd)
 {
@@ -402,28 +782,34 @@ cache_bclose (struct bfd *abfd)
 static int
 cache_bflush (struct bfd *abfd)
 {
-  int sts;
-  FILE *f = bfd_cache_lookup (abfd, CACHE_NO_OPEN);
+  struct cache_shard *shard = cache_lock (abfd);
+  int sts = 0;
+  FILE *f = bfd_cache_lookup (shard, abfd, CACHE_NO_OPEN);
 
-  if (f == NULL)
-    return 0;
-  sts = fflush (f);
-  if (sts < 0)
-    bfd_set_error (bfd_error_system_call);
+  if (f != NULL)
+    {
+      sts = fflush (f);
+      if (sts < 0)
+	bfd_set_error (bfd_error_system_call);
+    }
+  cache_unlock (shard);
   return sts;
 }
 
 static int
 cache_bstat (struct bfd *abfd, struct stat *sb)
 {
-  int sts;
-  FILE *f = bfd_cache_lookup (abfd, CACHE_NO_SEEK_ERROR);
+  struct cache_shard *shard = cache_lock (abfd);
+  int sts = -1;
+  FILE *f = bfd_cache_lookup (shard, abfd, CACHE_NO_SEEK_ERROR);
 
-  if (f == NULL)
-    return -1;
-  sts = fstat (fileno (f), sb);
-  if (sts < 0)
-    bfd_set_error (bfd_error_system_call);
+  if (f != NULL)
+    {
+      sts = fstat (fileno (f), sb);
+      if (sts < 0)
+	bfd_set_error (bfd_error_system_call);
+    }
+  cache_unlock (shard);
   return sts;
 }
 
@@ -445,13 +831,18 @@ cache_bmmap (struct bfd *abfd ATTRIBUTE_UNUSED,
   else
     {
       static uintptr_t pagesize_m1;
+      struct cache_shard *shard;
       FILE *f;
       file_ptr pg_offset;
       bfd_size_type pg_len;
 
-      f = bfd_cache_lookup (abfd, CACHE_NO_SEEK_ERROR);
+      shard = cache_lock (abfd);
+      f = bfd_cache_lookup (shard, abfd, CACHE_NO_SEEK_ERROR);
       if (f == NULL)
-	return ret;
+	{
+	  cache_unlock (shard);
+	  return ret;
+	}
 
       if (pagesize_m1 == 0)
 	pagesize_m1 = getpagesize () - 1;
@@ -461,6 +852,7 @@ cache_bmmap (struct bfd *abfd ATTRIBUTE_UNUSED,
       pg_len = (len + (offset - pg_offset) + pagesize_m1) & ~pagesize_m1;
 
       ret = mmap (addr, pg_len, prot, flags, fileno (f), pg_offset);
+      cache_unlock (shard);
       if (ret == (void *) -1)
 	bfd_set_error (bfd_error_system_call);
       else
@@ -470,6 +862,72 @@ cache_bmmap (struct bfd *abfd ATTRIBUTE_UNUSED,
 	  ret = (char *) ret + (offset & pagesize_m1);
 	}
     }
+#elif defined (_WIN32)
+  else
+    {
+      static file_ptr granularity_m1;
+      struct cache_shard *shard;
+      FILE *f;
+      HANDLE fh, mh;
+      file_ptr pg_offset;
+      bfd_size_type pg_len;
+
+      /* Views of a file mapping can't be shared writable with the
+	 underlying FILE, so provide only what MAP_PRIVATE gives.  */
+      if ((prot & PROT_WRITE) != 0 && (flags & MAP_SHARED) != 0)
+	{
+	  bfd_set_error (bfd_error_invalid_operation);
+	  return ret;
+	}
+
+      shard = cache_lock (abfd);
+      f = bfd_cache_lookup (shard, abfd, CACHE_NO_SEEK_ERROR);
+      if (f == NULL)
+	{
+	  cache_unlock (shard);
+	  return ret;
+	}
+
+      /* Views must start on an allocation granularity boundary, which
+	 is usually larger than the page size.  */
+      if (granularity_m1 == 0)
+	{
+	  SYSTEM_INFO si;
+
+	  GetSystemInfo (&si);
+	  granularity_m1 = si.dwAllocationGranularity - 1;
+	}
+
+      pg_offset = offset & ~granularity_m1;
+      pg_len = len + (offset - pg_offset);
+
+      fh = (HANDLE) _get_osfhandle (fileno (f));
+      mh = CreateFileMappingW (fh, NULL, PAGE_READONLY, 0, 0, NULL);
+      cache_unlock (shard);
+      if (mh == NULL)
+	{
+	  bfd_set_error (bfd_error_system_call);
+	  return ret;
+	}
+
+      ret = MapViewOfFile (mh,
+			   (prot & PROT_WRITE) != 0 ? FILE_MAP_COPY : FILE_MAP_READ,
+			   (DWORD) ((uint64_t) pg_offset >> 32),
+			   (DWORD) pg_offset, (SIZE_T) pg_len);
+      /* The view holds its own reference to the mapping object.  */
+      CloseHandle (mh);
+      if (ret == NULL)
+	{
+	  ret = (void *) -1;
+	  bfd_set_error (bfd_error_system_call);
+	}
+      else
+	{
+	  *map_addr = ret;
+	  *map_len = pg_len;
+	  ret = (char *) ret + (offset - pg_offset);
+	}
+    }
 #endif
 
   return ret;
@@ -478,9 +936,30 @@ cache_bmmap (struct bfd *abfd ATTRIBUTE_UNUSED,
 static const struct bfd_iovec cache_iovec =
 {
   &cache_bread, &cache_bwrite, &cache_btell, &cache_bseek,
-  &cache_bclose, &cache_bflush, &cache_bstat, &cache_bmmap
+  &cache_bclose, &cache_bflush, &cache_bstat, &cache_bmmap,
+  &cache_breadv, &cache_bpwrite, &cache_ballocate, &cache_bprefetch
 };
 
+/* Add a newly opened BFD to SHARD, which is locked.  */
+
+static bool
+cache_init (struct cache_shard *shard, bfd *abfd)
+{
+  BFD_ASSERT (abfd->iostream != NULL);
+  if (_bfd_atomic_load (&open_files) >= bfd_cache_max_open ())
+    {
+      if (! close_one (shard))
+	return false;
+    }
+  abfd->iovec = &cache_iovec;
+  insert (shard, abfd);
+  _bfd_io_count (abfd, ((abfd->flags & BFD_CLOSED_BY_CACHE) != 0
+			? bfd_io_reopen : bfd_io_open), 0);
+  abfd->flags &= ~BFD_CLOSED_BY_CACHE;
+  _bfd_atomic_add (&open_files, 1);
+  return true;
+}
+
 /*
 INTERNAL_FUNCTION
 	bfd_cache_init
@@ -495,17 +974,29 @@ DESCRIPTION
 bool
 bfd_cache_init (bfd *abfd)
 {
-  BFD_ASSERT (abfd->iostream != NULL);
-  if (open_files >= bfd_cache_max_open ())
-    {
-      if (! close_one ())
-	return false;
-    }
-  abfd->iovec = &cache_iovec;
-  insert (abfd);
-  abfd->flags &= ~BFD_CLOSED_BY_CACHE;
-  ++open_files;
-  return true;
+  struct cache_shard *shard = cache_lock (abfd);
+  bool ret = cache_init (shard, abfd);
+
+  cache_unlock (shard);
+  return ret;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_cache_iovec_p
+
+SYNOPSIS
+	bool _bfd_cache_iovec_p (bfd *abfd);
+
+DESCRIPTION
+	Return TRUE if @var{abfd} is read through the file cache,
+	whose methods may be called from several threads at once.
+*/
+
+bool
+_bfd_cache_iovec_p (bfd *abfd)
+{
+  return abfd->iovec == &cache_iovec;
 }
 
 /*
@@ -526,15 +1017,19 @@ DESCRIPTION
 bool
 bfd_cache_close (bfd *abfd)
 {
+  struct cache_shard *shard;
+  bool ret = true;
+
   /* Don't remove this test.  bfd_reinit depends on it.  */
   if (abfd->iovec != &cache_iovec)
     return true;
 
-  if (abfd->iostream == NULL)
-    /* Previously closed.  */
-    return true;
-
-  return bfd_cache_delete (abfd);
+  shard = cache_lock (abfd);
+  /* A NULL iostream means previously closed.  */
+  if (abfd->iostream != NULL)
+    ret = bfd_cache_delete (shard, abfd);
+  cache_unlock (shard);
+  return ret;
 }
 
 /*
@@ -556,13 +1051,45 @@ bool
 bfd_cache_close_all (void)
 {
   bool ret = true;
+  unsigned int i;
+
+  for (i = 0; i < CACHE_SHARDS; i++)
+    {
+      struct cache_shard *shard = &cache_shards[i];
 
-  while (bfd_last_cache != NULL)
-    ret &= bfd_cache_close (bfd_last_cache);
+      _bfd_mutex_lock (&shard->lock);
+      while (shard->last != NULL)
+	ret &= bfd_cache_delete (shard, shard->last);
+      _bfd_mutex_unlock (&shard->lock);
+    }
 
   return ret;
 }
 
+/*
+FUNCTION
+	bfd_cache_set_max_open
+
+SYNOPSIS
+	int bfd_cache_set_max_open (int max);
+
+DESCRIPTION
+	Set the number of files the cache may keep open at once to
+	@var{max}, and return the previous limit.  A @var{max} of zero
+	restores the default, which is derived from the host limit on
+	open files.  Lowering the limit does not close any files; the
+	cache shrinks as files are next opened.
+*/
+
+int
+bfd_cache_set_max_open (int max)
+{
+  int old = bfd_cache_max_open ();
+
+  max_open_files = max < 0 ? 0 : max;
+  return old;
+}
+
 /*
 INTERNAL_FUNCTION
 	bfd_open_file
@@ -580,12 +1107,24 @@ DESCRIPTION
 
 FILE *
 bfd_open_file (bfd *abfd)
+{
+  struct cache_shard *shard = cache_lock (abfd);
+  FILE *ret = cache_open_file (shard, abfd);
+
+  cache_unlock (shard);
+  return ret;
+}
+
+/* The worker for bfd_open_file.  SHARD is the locked shard of ABFD.  */
+
+static FILE *
+cache_open_file (struct cache_shard *shard, bfd *abfd)
 {
   abfd->cacheable = true;	/* Allow it to be closed later.  */
 
-  if (open_files >= bfd_cache_max_open ())
+  if (_bfd_atomic_load (&open_files) >= bfd_cache_max_open ())
     {
-      if (! close_one ())
+      if (! close_one (shard))
 	return NULL;
     }
 
@@ -644,7 +1183,7 @@ bfd_open_file (bfd *abfd)
     bfd_set_error (bfd_error_system_call);
   else
     {
-      if (! bfd_cache_init (abfd))
+      if (! cache_init (shard, abfd))
 	return NULL;
     }
 
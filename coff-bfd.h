@@ -54,6 +54,10 @@ struct coff_section_tdata
   /* Optional information about a COMDAT entry; NULL if not COMDAT. */
   struct coff_comdat_info *comdat;
   int line_base;
+  /* Address-sorted line number index built by coff_find_nearest_line,
+     with LINE_INDEX_COUNT entries.  */
+  struct coff_line_index *line_index;
+  unsigned int line_index_count;
   /* A pointer used for .stab linking optimizations.  */
   void * stab_info;
   /* Available for individual backends.  */
@@ -1484,6 +1484,16 @@ CODE_FRAGMENT
 .  bool (*_bfd_coff_print_pdata)
 .    (bfd *, void *);
 .
+.  {* Swap in the symbols of a symbol table of COUNT entries, leaving
+.     the auxiliary entries that follow each one to be swapped later.
+.     Returns false if a symbol's auxiliary entries run off the end.  *}
+.  bool (*_bfd_coff_swap_syms_in)
+.    (bfd *, void *, size_t, combined_entry_type *);
+.
+.  {* Swap in COUNT consecutive section headers.  *}
+.  void (*_bfd_coff_swap_scnhdrs_in)
+.    (bfd *, void *, unsigned int, struct internal_scnhdr *);
+.
 .} bfd_coff_backend_data;
 .
 
@@ -1628,6 +1638,11 @@ INTERNAL
 .#define bfd_coff_print_pdata(a,p) \
 .  ((coff_backend_info (a)->_bfd_coff_print_pdata) (a, p))
 .
+.#define bfd_coff_swap_syms_in(abfd, e, n, i) \
+.  ((coff_backend_info (abfd)->_bfd_coff_swap_syms_in) (abfd, e, n, i))
+.#define bfd_coff_swap_scnhdrs_in(abfd, e, n, i) \
+.  ((coff_backend_info (abfd)->_bfd_coff_swap_scnhdrs_in) (abfd, e, n, i))
+.
 .{* Macro: Returns true if the bfd is a PE executable as opposed to a
 .   PE object file.  *}
 .#define bfd_pei_p(abfd) \
@@ -3317,48 +3332,88 @@ coff_read_word (bfd *abfd, unsigned int *value, unsigned int *pelength)
   return true;
 }
 
-/* Read a two byte number from buffer B returning the result in VALUE.
-   No more than BUF_SIZE bytes will be read.
-   Returns true upobn success, false otherwise.
-   If successful, increases the value stored in PELENGTH by the number
-   of bytes read.  */
+#define COFF_CHECKSUM_BUFFER_SIZE 0x800000
+
+/* The checksum of a buffer is summed in parts of this many bytes,
+   on several threads if there are any.  It must be even.  */
+#define COFF_CHECKSUM_PART_SIZE 0x40000
 
-static bool
-coff_read_word_from_buffer (unsigned char *  b,
-			    int              buf_size,
-                            unsigned int *   value,
-			    unsigned int *   pelength)
+/* Return the sum of the SIZE bytes at P taken as little-endian 16-bit
+   words, with a trailing odd byte as a word of its own.  The sum is
+   not folded; since 0x10000 is 1 modulo 0xffff, summing 32-bit words
+   gives the same one's complement sum as summing their halves, and
+   does half the work in a loop compilers can vectorize.  The bytes
+   are put together by hand so that the loop has no calls in it.  */
+
+static uint64_t
+coff_checksum_sum (const bfd_byte *p, size_t size)
 {
-  if (buf_size < 1)
-    {
-      *value = 0;
-      return false;
-    }
+  uint64_t sum = 0;
+  size_t i;
 
-  if (buf_size == 1)
+  for (i = 0; i + 4 <= size; i += 4)
+    sum += ((uint32_t) p[i] | (uint32_t) p[i + 1] << 8
+	    | (uint32_t) p[i + 2] << 16 | (uint32_t) p[i + 3] << 24);
+  if (i + 2 <= size)
     {
-      *value = (unsigned int)b[0];
-      *pelength += 1;
+      sum += p[i] | p[i + 1] << 8;
+      i += 2;
     }
-  else
+  if (i < size)
+    sum += p[i];
+  return sum;
+}
+
+/* Fold SUM to a 16-bit one's complement sum.  */
+
+static unsigned int
+coff_checksum_fold (uint64_t sum)
+{
+  while (sum >> 16 != 0)
+    sum = (sum & 0xffff) + (sum >> 16);
+  return sum;
+}
+
+/* A buffer being summed by coff_checksum_range.  */
+
+struct coff_checksum_job
+{
+  const bfd_byte *buf;
+  size_t size;
+  unsigned int *sums;
+};
+
+/* Sum parts START to END of DATA, a coff_checksum_job.  Worker for
+   _bfd_parallel_for.  */
+
+static bool
+coff_checksum_range (void *data, size_t start, size_t end)
+{
+  struct coff_checksum_job *job = (struct coff_checksum_job *) data;
+  size_t i;
+
+  for (i = start; i < end; i++)
     {
-      *value = (unsigned int)(b[0] + (b[1] << 8));
-      *pelength += 2;
-    }
+      size_t off = i * COFF_CHECKSUM_PART_SIZE;
+      size_t len = job->size - off;
 
+      if (len > COFF_CHECKSUM_PART_SIZE)
+	len = COFF_CHECKSUM_PART_SIZE;
+      job->sums[i] = coff_checksum_fold (coff_checksum_sum (job->buf + off,
+							    len));
+    }
   return true;
 }
 
-#define COFF_CHECKSUM_BUFFER_SIZE 0x800000
-
 static unsigned int
 coff_compute_checksum (bfd *abfd, unsigned int *pelength)
 {
   file_ptr filepos;
-  unsigned int value;
-  unsigned int total;
+  uint64_t total;
   unsigned char *buf;
-  int buf_size;
+  unsigned int sums[COFF_CHECKSUM_BUFFER_SIZE / COFF_CHECKSUM_PART_SIZE];
+  struct coff_checksum_job job;
+  bfd_size_type buf_size;
 
   total = 0;
   *pelength = 0;
@@ -3366,36 +3421,38 @@ coff_compute_checksum (bfd *abfd, unsigned int *pelength)
   buf = (unsigned char *) bfd_malloc (COFF_CHECKSUM_BUFFER_SIZE);
   if (buf == NULL)
     return 0;
-  buf_size = 0;
+  job.buf = buf;
+  job.sums = sums;
 
   do
     {
-      unsigned char *cur_buf;
-      int cur_buf_size;
+      size_t nparts, i;
 
       if (bfd_seek (abfd, filepos, SEEK_SET) != 0)
-	return 0;
+	{
+	  free (buf);
+	  return 0;
+	}
 
       buf_size = bfd_bread (buf, COFF_CHECKSUM_BUFFER_SIZE, abfd);
-      cur_buf_size = buf_size;
-      cur_buf = buf;
-
-      while (cur_buf_size > 0)
-        {
-          coff_read_word_from_buffer (cur_buf, cur_buf_size, &value, pelength);
-          cur_buf += 2;
-          cur_buf_size -= 2;
-          total += value;
-          total = 0xffff & (total + (total >> 0x10));
-        }
+      if (buf_size == (bfd_size_type) -1)
+	break;
 
+      job.size = buf_size;
+      nparts = ((buf_size + COFF_CHECKSUM_PART_SIZE - 1)
+		/ COFF_CHECKSUM_PART_SIZE);
+      _bfd_parallel_for (nparts, 1, coff_checksum_range, &job);
+      for (i = 0; i < nparts; i++)
+	total += sums[i];
+
+      *pelength += buf_size;
       filepos += buf_size;
     }
   while (buf_size > 0);
 
   free (buf);
 
-  return (0xffff & (total + (total >> 0x10)));
+  return coff_checksum_fold (total);
 }
 
 static bool
@@ -5338,7 +5395,13 @@ coff_canonicalize_reloc (bfd * abfd,
     }
   else
     {
-      if (! coff_slurp_reloc_table (abfd, section, symbols))
+      enum bfd_memory_class old_class;
+      bool ok;
+
+      old_class = _bfd_set_memory_class (bfd_memory_relocs);
+      ok = coff_slurp_reloc_table (abfd, section, symbols);
+      _bfd_set_memory_class (old_class);
+      if (!ok)
 	return -1;
 
       tblptr = section->relocation;
@@ -5496,6 +5559,12 @@ coff_final_link_postscript (bfd * abfd ATTRIBUTE_UNUSED,
 #ifndef coff_SWAP_scnhdr_in
 #define coff_SWAP_scnhdr_in coff_swap_scnhdr_in
 #endif
+#ifndef coff_SWAP_syms_in
+#define coff_SWAP_syms_in coff_swap_syms_in
+#endif
+#ifndef coff_SWAP_scnhdrs_in
+#define coff_SWAP_scnhdrs_in coff_swap_scnhdrs_in
+#endif
 
 #define COFF_SWAP_TABLE (void *) &bfd_coff_std_swap_table
 
@@ -5534,7 +5603,8 @@ static const bfd_coff_backend_data bfd_coff_std_swap_table ATTRIBUTE_UNUSED =
   coff_start_final_link, coff_relocate_section, coff_rtype_to_howto,
   coff_adjust_symndx, coff_link_add_one_symbol,
   coff_link_output_has_begun, coff_final_link_postscript,
-  bfd_pe_print_pdata
+  bfd_pe_print_pdata,
+  coff_SWAP_syms_in, coff_SWAP_scnhdrs_in
 };
 
 #ifdef TICOFF
@@ -5575,7 +5645,8 @@ static const bfd_coff_backend_data ticoff0_swap_table =
   coff_start_final_link, coff_relocate_section, coff_rtype_to_howto,
   coff_adjust_symndx, coff_link_add_one_symbol,
   coff_link_output_has_begun, coff_final_link_postscript,
-  bfd_pe_print_pdata
+  bfd_pe_print_pdata,
+  coff_SWAP_syms_in, coff_SWAP_scnhdrs_in
 };
 #endif
 
@@ -5617,7 +5688,8 @@ static const bfd_coff_backend_data ticoff1_swap_table =
   coff_start_final_link, coff_relocate_section, coff_rtype_to_howto,
   coff_adjust_symndx, coff_link_add_one_symbol,
   coff_link_output_has_begun, coff_final_link_postscript,
-  bfd_pe_print_pdata	/* huh */
+  bfd_pe_print_pdata,	/* huh */
+  coff_SWAP_syms_in, coff_SWAP_scnhdrs_in
 };
 #endif
 
@@ -5684,8 +5756,13 @@ coff_bigobj_swap_filehdr_out (bfd *abfd, void * in, void * out)
   return bfd_coff_filhsz (abfd);
 }
 
-static void
-coff_bigobj_swap_sym_in (bfd * abfd, void * ext1, void * in1)
+/* Swap in the symbol at EXT1.  HOST_ORDER is true if ABFD's headers
+   are in the host's byte order, so that the fields can be read as
+   plain host words without going through the target vector.  */
+
+static inline void
+coff_bigobj_swap_sym_in_1 (bfd * abfd, void * ext1, void * in1,
+			   bool host_order)
 {
   SYMENT_BIGOBJ *ext = (SYMENT_BIGOBJ *) ext1;
   struct internal_syment *in = (struct internal_syment *) in1;
@@ -5693,7 +5770,9 @@ coff_bigobj_swap_sym_in (bfd * abfd, void * ext1, void * in1)
   if (ext->e.e_name[0] == 0)
     {
       in->_n._n_n._n_zeroes = 0;
-      in->_n._n_n._n_offset = H_GET_32 (abfd, ext->e.e.e_offset);
+      in->_n._n_n._n_offset = (host_order
+			       ? _bfd_host_get_32 (ext->e.e.e_offset)
+			       : H_GET_32 (abfd, ext->e.e.e_offset));
     }
   else
     {
@@ -5704,14 +5783,60 @@ coff_bigobj_swap_sym_in (bfd * abfd, void * ext1, void * in1)
 #endif
     }
 
-  in->n_value = H_GET_32 (abfd, ext->e_value);
   BFD_ASSERT (sizeof (in->n_scnum) >= 4);
-  in->n_scnum = H_GET_32 (abfd, ext->e_scnum);
-  in->n_type = H_GET_16 (abfd, ext->e_type);
+  if (host_order)
+    {
+      in->n_value = _bfd_host_get_32 (ext->e_value);
+      in->n_scnum = _bfd_host_get_32 (ext->e_scnum);
+      in->n_type = _bfd_host_get_16 (ext->e_type);
+    }
+  else
+    {
+      in->n_value = H_GET_32 (abfd, ext->e_value);
+      in->n_scnum = H_GET_32 (abfd, ext->e_scnum);
+      in->n_type = H_GET_16 (abfd, ext->e_type);
+    }
   in->n_sclass = H_GET_8 (abfd, ext->e_sclass);
   in->n_numaux = H_GET_8 (abfd, ext->e_numaux);
 }
 
+static void
+coff_bigobj_swap_sym_in (bfd * abfd, void * ext1, void * in1)
+{
+  coff_bigobj_swap_sym_in_1 (abfd, ext1, in1, false);
+}
+
+/* Swap in the symbols of the COUNT symbol table entries at EXT1,
+   stepping over their auxiliary entries.  */
+
+static bool
+coff_bigobj_swap_syms_in (bfd * abfd, void * ext1, size_t count,
+			  combined_entry_type * internal)
+{
+  bfd_byte *ext = (bfd_byte *) ext1;
+  bool host_order = _bfd_header_host_order_p (abfd);
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    {
+      void *esym = ext + i * SYMESZ_BIGOBJ;
+      unsigned int numaux;
+
+      if (host_order)
+	coff_bigobj_swap_sym_in_1 (abfd, esym, &internal[i].u.syment, true);
+      else
+	coff_bigobj_swap_sym_in_1 (abfd, esym, &internal[i].u.syment, false);
+      internal[i].is_sym = true;
+
+      /* PR 17512: Prevent buffer overrun.  */
+      numaux = internal[i].u.syment.n_numaux;
+      if (numaux > count - 1 - i)
+	return false;
+      i += numaux;
+    }
+  return true;
+}
+
 static unsigned int
 coff_bigobj_swap_sym_out (bfd * abfd, void * inp, void * extp)
 {
@@ -5867,7 +5992,8 @@ static const bfd_coff_backend_data bigobj_swap_table =
   coff_start_final_link, coff_relocate_section, coff_rtype_to_howto,
   coff_adjust_symndx, coff_link_add_one_symbol,
   coff_link_output_has_begun, coff_final_link_postscript,
-  bfd_pe_print_pdata	/* huh */
+  bfd_pe_print_pdata,	/* huh */
+  coff_bigobj_swap_syms_in, coff_SWAP_scnhdrs_in
 };
 
 #endif /* COFF_WITH_PE_BIGOBJ */
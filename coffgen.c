@@ -44,14 +44,13 @@
 #include "libcoff.h"
 #include "hashtab.h"
 
-/* Extract a long long section name at STRINDEX and copy it to the bfd objstack.
-   Return NULL in case of error.  */
+/* Extract a long long section name at STRINDEX and copy it to the bfd objstack,
+   or its name pool.  Return NULL in case of error.  */
 
-static char *
+static const char *
 extract_long_section_name(bfd *abfd, unsigned long long strindex)
 {
   const char *strings;
-  char *name;
 
   strings = _bfd_coff_read_string_table (abfd);
   if (strings == NULL)
@@ -59,12 +58,7 @@ extract_long_section_name(bfd *abfd, unsigned long long strindex)
   if ((bfd_size_type)(strindex + 2) >= obj_coff_strings_len (abfd))
     return NULL;
   strings += strindex;
-  name = (char *) bfd_alloc (abfd, (bfd_size_type) strlen (strings) + 1);
-  if (name == NULL)
-    return NULL;
-  strcpy (name, strings);
-
-  return name;
+  return _bfd_intern_name (abfd, strings, strlen (strings));
 }
 
 /* Decode a base 64 coded string at STR of length LEN, and write the result
@@ -116,7 +110,7 @@ make_a_section_from_file (bfd *abfd,
 			  unsigned int target_index)
 {
   asection *newsect;
-  char *name;
+  const char *name;
   bool result = true;
   flagword flags;
 
@@ -179,12 +173,10 @@ make_a_section_from_file (bfd *abfd,
   if (name == NULL)
     {
       /* Assorted wastage to null-terminate the name, thanks AT&T! */
-      name = (char *) bfd_alloc (abfd,
-				 (bfd_size_type) sizeof (hdr->s_name) + 1 + 1);
+      name = _bfd_intern_name (abfd, hdr->s_name,
+			       strnlen (hdr->s_name, sizeof (hdr->s_name)));
       if (name == NULL)
 	return false;
-      strncpy (name, (char *) &hdr->s_name[0], sizeof (hdr->s_name));
-      name[sizeof (hdr->s_name)] = 0;
     }
 
   newsect = bfd_make_section_anyway (abfd, name);
@@ -353,19 +345,26 @@ coff_real_object_p (bfd *abfd,
   if (! bfd_coff_set_arch_mach_hook (abfd, (void *) internal_f))
     goto fail;
 
-  /* Now copy data as required; construct all asections etc.  */
+  /* Now copy data as required; construct all asections etc.  The
+     headers are swapped in one pass first, so that the backend can
+     check the host byte order once rather than per field.  */
   if (nscns != 0)
     {
       unsigned int i;
+      struct internal_scnhdr *internal_s;
+
+      internal_s = (struct internal_scnhdr *)
+	bfd_malloc ((bfd_size_type) nscns * sizeof (*internal_s));
+      if (internal_s == NULL)
+	goto fail;
+      bfd_coff_swap_scnhdrs_in (abfd, external_sections, nscns, internal_s);
       for (i = 0; i < nscns; i++)
-	{
-	  struct internal_scnhdr tmp;
-	  bfd_coff_swap_scnhdr_in (abfd,
-				   (void *) (external_sections + i * scnhsz),
-				   (void *) & tmp);
-	  if (! make_a_section_from_file (abfd, &tmp, i + 1))
+	if (! make_a_section_from_file (abfd, &internal_s[i], i + 1))
+	  {
+	    free (internal_s);
 	    goto fail;
-	}
+	  }
+      free (internal_s);
     }
 
   _bfd_coff_free_symbols (abfd);
@@ -539,8 +538,13 @@ coff_canonicalize_symtab (bfd *abfd, asymbol **alocation)
   unsigned int counter;
   coff_symbol_type *symbase;
   coff_symbol_type **location = (coff_symbol_type **) alocation;
+  enum bfd_memory_class old_class;
+  bool ok;
 
-  if (!bfd_coff_slurp_symbol_table (abfd))
+  old_class = _bfd_set_memory_class (bfd_memory_symbols);
+  ok = bfd_coff_slurp_symbol_table (abfd);
+  _bfd_set_memory_class (old_class);
+  if (!ok)
     return -1;
 
   symbase = obj_symbols (abfd);
@@ -1361,6 +1365,65 @@ null_error_handler (const char *fmt ATTRIBUTE_UNUSED,
 
 /* Write out the COFF symbols.  */
 
+/* Add the symbol names which coff_fix_symbol_name will put in STRTAB
+   to it in one batch, so that they are hashed together and a name
+   which is the tail of another shares its bytes.  A name missed here
+   is simply added when the symbol is written.  */
+
+static bool
+coff_add_symbol_names (bfd *abfd, struct bfd_strtab_hash *strtab)
+{
+  unsigned int limit = bfd_get_symcount (abfd);
+  struct bfd_link_info *link_info = coff_data (abfd)->link_info;
+  const char **names;
+  size_t count;
+  unsigned int i;
+  bool ret;
+
+  if (limit == 0)
+    return true;
+  names = (const char **) bfd_malloc ((size_t) limit * sizeof (*names));
+  if (names == NULL)
+    return false;
+
+  count = 0;
+  for (i = 0; i < limit; i++)
+    {
+      asymbol *symbol = abfd->outsymbols[i];
+      coff_symbol_type *c_symbol = coff_symbol_from (symbol);
+
+      if (symbol->name == NULL
+	  || (strlen (symbol->name) <= SYMNMLEN
+	      && !bfd_coff_force_symnames_in_strings (abfd)))
+	continue;
+
+      /* The names of symbols in discarded sections are dropped.  */
+      if ((!link_info || link_info->strip_discarded)
+	  && !bfd_is_abs_section (symbol->section)
+	  && symbol->section->output_section == bfd_abs_section_ptr)
+	continue;
+
+      if (c_symbol == NULL || c_symbol->native == NULL)
+	{
+	  if ((symbol->flags & (BSF_FILE | BSF_DEBUGGING)) != 0)
+	    continue;
+	}
+      else
+	{
+	  struct internal_syment *sym = &c_symbol->native->u.syment;
+
+	  if ((sym->n_sclass == C_FILE && sym->n_numaux > 0)
+	      || bfd_coff_symname_in_debug (abfd, sym))
+	    continue;
+	}
+      names[count++] = symbol->name;
+    }
+
+  ret = _bfd_stringtab_add_batch (strtab, names, count, false, true);
+  free (names);
+  return ret;
+}
+
 bool
 coff_write_symbols (bfd *abfd)
 {
@@ -1394,6 +1457,9 @@ coff_write_symbols (bfd *abfd)
 	  return false;
     }
 
+  if (!coff_add_symbol_names (abfd, strtab))
+    return false;
+
   /* Seek to the right place.  */
   if (bfd_seek (abfd, obj_sym_filepos (abfd), SEEK_SET) != 0)
     return false;
@@ -1425,11 +1491,12 @@ coff_write_symbols (bfd *abfd)
 		 Error messages can be generated when we are processing a local
 		 symbol which has no associated section and we do not have to
 		 worry about this, all we need to know is that it is local.  */
-	      current_error_handler = bfd_set_error_handler (null_error_handler);
+	      current_error_handler
+		= bfd_set_thread_error_handler (null_error_handler);
 	      BFD_ASSERT (c_symbol->native->is_sym);
 	      sym_class = bfd_coff_classify_symbol (abfd,
 						    &c_symbol->native->u.syment);
-	      (void) bfd_set_error_handler (current_error_handler);
+	      (void) bfd_set_thread_error_handler (current_error_handler);
 
 	      n_sclass = &c_symbol->native->u.syment.n_sclass;
 
@@ -1664,29 +1731,65 @@ build_debug_section (bfd *abfd, asection ** sect_return)
    \0-terminated, but will not exceed 'maxlen' characters.  The copy *will*
    be \0-terminated.  */
 
-static char *
+static const char *
 copy_name (bfd *abfd, char *name, size_t maxlen)
 {
   size_t len;
-  char *newname;
 
   for (len = 0; len < maxlen; ++len)
     if (name[len] == '\0')
       break;
 
-  if ((newname = (char *) bfd_alloc (abfd, (bfd_size_type) len + 1)) == NULL)
-    return NULL;
+  return _bfd_intern_name (abfd, name, len);
+}
 
-  strncpy (newname, name, len);
-  newname[len] = '\0';
-  return newname;
+/* Release the external symbols of ABFD, whether read or mapped.  */
+
+static void
+coff_release_external_syms (bfd *abfd)
+{
+  struct coff_tdata *tdata = coff_data (abfd);
+
+  if (tdata->syms_mapped)
+    {
+      if (tdata->syms_map_len != 0)
+	bfd_munmap (tdata->syms_map_addr, tdata->syms_map_len);
+      tdata->syms_map_len = 0;
+      tdata->syms_mapped = false;
+    }
+  else
+    free (tdata->external_syms);
+  tdata->external_syms = NULL;
 }
 
-/* Read in the external symbols.  */
+/* Likewise for the strings.  */
+
+static void
+coff_release_strings (bfd *abfd)
+{
+  struct coff_tdata *tdata = coff_data (abfd);
+
+  if (tdata->strings_mapped)
+    {
+      if (tdata->strings_map_len != 0)
+	bfd_munmap (tdata->strings_map_addr, tdata->strings_map_len);
+      tdata->strings_map_len = 0;
+      tdata->strings_mapped = false;
+    }
+  else
+    free (tdata->strings);
+  tdata->strings = NULL;
+  tdata->strings_len = 0;
+}
+
+/* Read in the external symbols.  A large table, such as that of a
+   /bigobj object with millions of symbols, is mapped rather than
+   read when the file allows it.  */
 
 bool
 _bfd_coff_get_external_symbols (bfd *abfd)
 {
+  struct coff_tdata *tdata = coff_data (abfd);
   size_t symesz;
   size_t size;
   void * syms;
@@ -1714,6 +1817,16 @@ _bfd_coff_get_external_symbols (bfd *abfd)
       return false;
     }
 
+  syms = (void *) _bfd_map_region (abfd, obj_sym_filepos (abfd), size,
+				   &tdata->syms_map_addr,
+				   &tdata->syms_map_len);
+  if (syms != NULL)
+    {
+      tdata->syms_mapped = true;
+      obj_coff_external_syms (abfd) = syms;
+      return true;
+    }
+
   if (bfd_seek (abfd, obj_sym_filepos (abfd), SEEK_SET) != 0)
     return false;
   syms = _bfd_malloc_and_read (abfd, size, size);
@@ -1725,12 +1838,16 @@ _bfd_coff_get_external_symbols (bfd *abfd)
    they are needed.  This is because we have no simple way of
    detecting a missing string table in an archive.  If the strings
    are loaded then the STRINGS and STRINGS_LEN fields in the
-   coff_tdata structure will be set.  */
+   coff_tdata structure will be set.  Like the symbols, a large
+   string table is mapped, so that only the pages holding names that
+   are looked at are read.  */
 
 const char *
 _bfd_coff_read_string_table (bfd *abfd)
 {
+  struct coff_tdata *tdata = coff_data (abfd);
   char extstrsize[STRING_SIZE_SIZE];
+  const bfd_byte *map;
   bfd_size_type strsize;
   char *strings;
   ufile_ptr pos;
@@ -1788,6 +1905,26 @@ _bfd_coff_read_string_table (bfd *abfd)
       return NULL;
     }
 
+  /* A mapped table can't be terminated or have its size field
+     cleared as below, so it is only used if its last string ends
+     within it.  An offset into the size field then gives a junk
+     name rather than an empty one, but still one that ends.  */
+  map = _bfd_map_region (abfd, pos + size, strsize,
+			 &tdata->strings_map_addr, &tdata->strings_map_len);
+  if (map != NULL)
+    {
+      if (map[strsize - 1] == 0)
+	{
+	  tdata->strings_mapped = true;
+	  obj_coff_strings (abfd) = (char *) map;
+	  obj_coff_strings_len (abfd) = strsize;
+	  return obj_coff_strings (abfd);
+	}
+      if (tdata->strings_map_len != 0)
+	bfd_munmap (tdata->strings_map_addr, tdata->strings_map_len);
+      tdata->strings_map_len = 0;
+    }
+
   strings = (char *) bfd_malloc (strsize + 1);
   if (strings == NULL)
     return NULL;
@@ -1822,22 +1959,68 @@ _bfd_coff_free_symbols (bfd *abfd)
 
   if (obj_coff_external_syms (abfd) != NULL
       && ! obj_coff_keep_syms (abfd))
-    {
-      free (obj_coff_external_syms (abfd));
-      obj_coff_external_syms (abfd) = NULL;
-    }
+    coff_release_external_syms (abfd);
 
   if (obj_coff_strings (abfd) != NULL
       && ! obj_coff_keep_strings (abfd))
+    coff_release_strings (abfd);
+
+  return true;
+}
+
+/* The symbol table coff_get_normalized_symtab is swapping in, shared
+   by the threads that swap it.  */
+
+struct coff_aux_job
+{
+  bfd *abfd;
+  combined_entry_type *internal;
+  char *raw;
+};
+
+/* Swap in and pointerize the auxiliary entries of the symbols from
+   START to END of the coff_aux_job DATA.  Entries in that range that
+   are not symbols belong to an earlier one and are skipped.  */
+
+static bool
+coff_swap_aux_range (void *data, size_t start, size_t end)
+{
+  struct coff_aux_job *job = (struct coff_aux_job *) data;
+  bfd *abfd = job->abfd;
+  size_t symesz = bfd_coff_symesz (abfd);
+  size_t idx;
+
+  for (idx = start; idx < end; idx++)
     {
-      free (obj_coff_strings (abfd));
-      obj_coff_strings (abfd) = NULL;
-      obj_coff_strings_len (abfd) = 0;
-    }
+      combined_entry_type *symbol_ptr = job->internal + idx;
+      char *raw_src = job->raw + idx * symesz;
+      unsigned int i;
+
+      if (!symbol_ptr->is_sym)
+	continue;
 
+      for (i = 0; i < symbol_ptr->u.syment.n_numaux; i++)
+	{
+	  combined_entry_type *internal_ptr = symbol_ptr + i + 1;
+
+	  raw_src += symesz;
+	  bfd_coff_swap_aux_in (abfd, (void *) raw_src,
+				symbol_ptr->u.syment.n_type,
+				symbol_ptr->u.syment.n_sclass,
+				(int) i, symbol_ptr->u.syment.n_numaux,
+				&(internal_ptr->u.auxent));
+
+	  internal_ptr->is_sym = false;
+	  coff_pointerize_aux (abfd, job->internal, symbol_ptr, i,
+			       internal_ptr);
+	}
+    }
   return true;
 }
 
+/* The fewest symbol table entries worth handing to a thread.  */
+#define COFF_AUX_GRAIN 4096
+
 /* Read a symbol table into freshly bfd_allocated memory, swap it, and
    knit the symbol names into a normalized form.  By normalized here I
    mean that all symbols have an n_offset pointer that points to a null-
@@ -1848,11 +2031,10 @@ coff_get_normalized_symtab (bfd *abfd)
 {
   combined_entry_type *internal;
   combined_entry_type *internal_ptr;
-  combined_entry_type *symbol_ptr;
   combined_entry_type *internal_end;
+  struct coff_aux_job job;
   size_t symesz;
   char *raw_src;
-  char *raw_end;
   const char *string_table = NULL;
   asection * debug_sec = NULL;
   char *debug_sec_data = NULL;
@@ -1875,55 +2057,32 @@ coff_get_normalized_symtab (bfd *abfd)
   internal_end = internal + obj_raw_syment_count (abfd);
 
   raw_src = (char *) obj_coff_external_syms (abfd);
-
-  /* Mark the end of the symbols.  */
   symesz = bfd_coff_symesz (abfd);
-  raw_end = PTR_ADD (raw_src, obj_raw_syment_count (abfd) * symesz);
 
   /* FIXME SOMEDAY.  A string table size of zero is very weird, but
      probably possible.  If one shows up, it will probably kill us.  */
 
-  /* Swap all the raw entries.  */
-  for (internal_ptr = internal;
-       raw_src < raw_end;
-       raw_src += symesz, internal_ptr++)
-    {
-      unsigned int i;
-
-      bfd_coff_swap_sym_in (abfd, (void *) raw_src,
-			    (void *) & internal_ptr->u.syment);
-      symbol_ptr = internal_ptr;
-      internal_ptr->is_sym = true;
-
-      /* PR 17512: Prevent buffer overrun.  */
-      if (symbol_ptr->u.syment.n_numaux > ((raw_end - 1) - raw_src) / symesz)
-	return NULL;
-
-      for (i = 0;
-	   i < symbol_ptr->u.syment.n_numaux;
-	   i++)
-	{
-	  internal_ptr++;
-	  raw_src += symesz;
-
-	  bfd_coff_swap_aux_in (abfd, (void *) raw_src,
-				symbol_ptr->u.syment.n_type,
-				symbol_ptr->u.syment.n_sclass,
-				(int) i, symbol_ptr->u.syment.n_numaux,
-				&(internal_ptr->u.auxent));
+  /* Swap the symbols, stepping over their auxiliary entries.  */
+  if (!bfd_coff_swap_syms_in (abfd, raw_src, obj_raw_syment_count (abfd),
+			      internal))
+    return NULL;
 
-	  internal_ptr->is_sym = false;
-	  coff_pointerize_aux (abfd, internal, symbol_ptr, i, internal_ptr);
-	}
-    }
+  /* Now that the symbols are known, swap the auxiliary entries.
+     Each symbol's are independent of the others', so this may be
+     shared between threads.  */
+  job.abfd = abfd;
+  job.internal = internal;
+  job.raw = (char *) obj_coff_external_syms (abfd);
+  if (!_bfd_parallel_for (obj_raw_syment_count (abfd), COFF_AUX_GRAIN,
+			  coff_swap_aux_range, &job))
+    return NULL;
 
-  /* Free the raw symbols.  */
+  /* Free the raw symbols.  Mapped ones cost no memory, and are kept
+     for the linker, which reads them again.  */
   if (obj_coff_external_syms (abfd) != NULL
-      && ! obj_coff_keep_syms (abfd))
-    {
-      free (obj_coff_external_syms (abfd));
-      obj_coff_external_syms (abfd) = NULL;
-    }
+      && ! obj_coff_keep_syms (abfd)
+      && ! coff_data (abfd)->syms_mapped)
+    coff_release_external_syms (abfd);
 
   for (internal_ptr = internal; internal_ptr < internal_end;
        internal_ptr++)
@@ -2017,19 +2176,12 @@ coff_get_normalized_symtab (bfd *abfd)
 	  if (internal_ptr->u.syment._n._n_n._n_zeroes != 0)
 	    {
 	      /* This is a "short" name.  Make it long.  */
-	      size_t i;
-	      char *newstring;
-
-	      /* Find the length of this string without walking into memory
-		 that isn't ours.  */
-	      for (i = 0; i < 8; ++i)
-		if (internal_ptr->u.syment._n._n_name[i] == '\0')
-		  break;
+	      const char *newstring;
 
-	      newstring = (char *) bfd_zalloc (abfd, (bfd_size_type) (i + 1));
+	      newstring = copy_name (abfd, internal_ptr->u.syment._n._n_name,
+				     SYMNMLEN);
 	      if (newstring == NULL)
 		return NULL;
-	      strncpy (newstring, internal_ptr->u.syment._n._n_name, i);
 	      internal_ptr->u.syment._n._n_n._n_offset = (uintptr_t) newstring;
 	      internal_ptr->u.syment._n._n_n._n_zeroes = 0;
 	    }
@@ -2049,6 +2201,17 @@ coff_get_normalized_symtab (bfd *abfd)
 		  || string_table + internal_ptr->u.syment._n._n_n._n_offset < string_table)
 		internal_ptr->u.syment._n._n_n._n_offset =
 		  (uintptr_t) _("<corrupt>");
+	      else if (abfd->name_pool != NULL)
+		{
+		  const char *name;
+
+		  name = (string_table
+			  + internal_ptr->u.syment._n._n_n._n_offset);
+		  name = _bfd_intern_name (abfd, name, strlen (name));
+		  if (name == NULL)
+		    return NULL;
+		  internal_ptr->u.syment._n._n_n._n_offset = (uintptr_t) name;
+		}
 	      else
 		internal_ptr->u.syment._n._n_n._n_offset =
 		  ((uintptr_t) (string_table
@@ -2349,6 +2512,106 @@ _bfd_coff_is_local_label_name (bfd *abfd ATTRIBUTE_UNUSED,
   return name[0] == '.' && name[1] == 'L';
 }
 
+/* One entry of the sorted line number index of a section.  There is
+   an entry for each element of the section's lineno array, recording
+   what a linear walk of the array would have reported on reaching the
+   end of that element.  */
+
+struct coff_line_index
+{
+  /* The highest address of this and all preceding elements.  Because
+     this never decreases, a binary search finds where the walk would
+     have stopped even if the array is not strictly in order.  */
+  bfd_vma addr;
+  /* The value of the most recent function, or zero.  */
+  bfd_vma last_value;
+  const char *function;
+  unsigned int line;
+};
+
+/* Build the line number index for SECTION of ABFD in SEC_DATA.  */
+
+static bool
+coff_build_line_index (bfd *abfd, asection *section,
+		       struct coff_section_tdata *sec_data)
+{
+  struct coff_line_index *index;
+  const char *function = NULL;
+  bfd_vma last_value = 0;
+  bfd_vma addr = 0;
+  unsigned int line = 0;
+  int line_base = 0;
+  unsigned int i;
+  size_t amt;
+  alent *l;
+
+  if (_bfd_mul_overflow (section->lineno_count, sizeof (*index), &amt))
+    {
+      bfd_set_error (bfd_error_file_too_big);
+      return false;
+    }
+  index = (struct coff_line_index *) bfd_alloc (abfd, amt);
+  if (index == NULL)
+    return false;
+
+  l = section->lineno;
+  for (i = 0; i < section->lineno_count; i++, l++)
+    {
+      bfd_vma value;
+
+      if (l->line_number == 0)
+	{
+	  coff_symbol_type *coff = (coff_symbol_type *) (l->u.sym);
+
+	  value = coff->symbol.value;
+	  function = coff->symbol.name;
+	  last_value = coff->symbol.value;
+	  if (coff->native)
+	    {
+	      combined_entry_type *s = coff->native;
+
+	      BFD_ASSERT (s->is_sym);
+	      s = s + 1 + s->u.syment.n_numaux;
+
+	      /* In XCOFF a debugging symbol can follow the
+		 function symbol.  */
+	      if (((size_t) ((char *) s - (char *) obj_raw_syments (abfd))
+		   < obj_raw_syment_count (abfd) * sizeof (*s))
+		  && s->u.syment.n_scnum == N_DEBUG)
+		s = s + 1 + s->u.syment.n_numaux;
+
+	      /* S should now point to the .bf of the function.  */
+	      if (((size_t) ((char *) s - (char *) obj_raw_syments (abfd))
+		   < obj_raw_syment_count (abfd) * sizeof (*s))
+		  && s->u.syment.n_numaux)
+		{
+		  /* The linenumber is stored in the auxent.  */
+		  union internal_auxent *a = &((s + 1)->u.auxent);
+
+		  line_base = a->x_sym.x_misc.x_lnsz.x_lnno;
+		  line = line_base;
+		}
+	    }
+	}
+      else
+	{
+	  value = l->u.offset;
+	  line = l->line_number + line_base - 1;
+	}
+
+      if (i == 0 || value > addr)
+	addr = value;
+      index[i].addr = addr;
+      index[i].last_value = last_value;
+      index[i].function = function;
+      index[i].line = line;
+    }
+
+  sec_data->line_index = index;
+  sec_data->line_index_count = section->lineno_count;
+  return true;
+}
+
 /* Provided a BFD, a section and an offset (in bytes, not octets) into the
    section, calculate and return the name of the source file and the line
    nearest to the wanted location.  */
@@ -2527,6 +2790,55 @@ coff_find_nearest_line_with_names (bfd *abfd,
       return true;
     }
 
+  /* Use the sorted index of the section's line numbers if there is
+     one, building it on the first lookup.  */
+  if (section->lineno != NULL && section->owner == abfd)
+    {
+      if (sec_data == NULL)
+	{
+	  amt = sizeof (struct coff_section_tdata);
+	  section->used_by_bfd = bfd_zalloc (abfd, amt);
+	  sec_data = (struct coff_section_tdata *) section->used_by_bfd;
+	}
+
+      if (sec_data != NULL
+	  && (sec_data->line_index != NULL
+	      || coff_build_line_index (abfd, section, sec_data)))
+	{
+	  struct coff_line_index *index = sec_data->line_index;
+	  unsigned int lo = 0;
+	  unsigned int hi = sec_data->line_index_count;
+
+	  /* Find the first entry beyond OFFSET.  */
+	  while (lo < hi)
+	    {
+	      unsigned int mid = lo + (hi - lo) / 2;
+
+	      if (index[mid].addr > offset)
+		hi = mid;
+	      else
+		lo = mid + 1;
+	    }
+
+	  if (lo > 0)
+	    {
+	      *functionname_ptr = index[lo - 1].function;
+	      *line_ptr = index[lo - 1].line;
+
+	      /* As below, a symbol well past the last line of the last
+		 function has no line number info.  */
+	      if (lo >= sec_data->line_index_count
+		  && index[lo - 1].last_value != 0
+		  && offset - index[lo - 1].last_value > 0x100)
+		{
+		  *functionname_ptr = NULL;
+		  *line_ptr = 0;
+		}
+	    }
+	  return true;
+	}
+    }
+
   /* Now wander though the raw linenumbers of the section.
      If we have been called on this section before, and the offset
      we want is further down then we can prime the lookup loop.  */
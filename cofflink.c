@@ -35,6 +35,28 @@ static bool coff_link_check_archive_element
   (bfd *, struct bfd_link_info *, struct bfd_link_hash_entry *, const char *,
    bool *);
 static bool coff_link_add_symbols (bfd *, struct bfd_link_info *);
+static bool coff_link_parallel_p (struct bfd_link_info *);
+static bool coff_link_input_bfd_range (void *, size_t, size_t);
+
+/* The state shared by the threads relocating sections in parallel.  */
+
+struct coff_parallel_link
+{
+  /* The link whose buffer sizes and settings the workers copy.  */
+  struct coff_final_link_info *flaginfo;
+  /* Input BFDs with sections left for the workers.  */
+  bfd **bfds;
+  size_t count;
+  size_t alloc;
+  /* Sizes of the buffers in coff_final_link_info.  */
+  bfd_size_type max_sym_count;
+  bfd_size_type max_contents_size;
+  bfd_size_type max_reloc_count;
+  /* Held by a worker while it reads an input file or writes the
+     output through the file position, since archive members share a
+     file position and so do the output's sections.  */
+  bfd_mutex io_lock;
+};
 
 /* Return TRUE if SYM is a weak, external symbol.  */
 #define IS_WEAK_EXTERNAL(abfd, sym)			\
@@ -624,6 +646,7 @@ _bfd_coff_final_link (bfd *abfd,
 {
   bfd_size_type symesz;
   struct coff_final_link_info flaginfo;
+  struct coff_parallel_link plink;
   bool debug_merge_allocated;
   bool long_section_names;
   asection *o;
@@ -659,6 +682,8 @@ _bfd_coff_final_link (bfd *abfd,
   flaginfo.external_relocs = NULL;
   flaginfo.internal_relocs = NULL;
   flaginfo.global_to_static = false;
+  flaginfo.parallel = NULL;
+  flaginfo.worker = false;
   debug_merge_allocated = false;
 
   coff_data (abfd)->link_info = info;
@@ -873,6 +898,20 @@ _bfd_coff_final_link (bfd *abfd,
 	  && max_reloc_count > 0))
     goto error_return;
 
+  /* If allowed, the main thread leaves sections that aren't loaded
+     to worker threads, which relocate them once it has been through
+     all the input files.  Symbols are all output by the main thread,
+     so their order doesn't depend on the threads.  */
+  if (coff_link_parallel_p (info))
+    {
+      memset (&plink, 0, sizeof (plink));
+      plink.flaginfo = &flaginfo;
+      plink.max_sym_count = max_sym_count;
+      plink.max_contents_size = max_contents_size;
+      plink.max_reloc_count = max_reloc_count;
+      flaginfo.parallel = &plink;
+    }
+
   /* We now know the position of everything in the file, except that
      we don't know the size of the symbol table and therefore we don't
      know where the string table starts.  We just build the string
@@ -915,6 +954,29 @@ _bfd_coff_final_link (bfd *abfd,
 	}
     }
 
+  if (flaginfo.parallel != NULL)
+    {
+      if (plink.count != 0)
+	{
+	  file_ptr end = 0;
+
+	  /* The layout is fixed by now.  Size the output file up front
+	     so that the workers' writes don't each extend it.  */
+	  for (o = abfd->sections; o != NULL; o = o->next)
+	    if ((o->flags & SEC_HAS_CONTENTS) != 0
+		&& o->filepos != 0
+		&& o->filepos + (file_ptr) o->size > end)
+	      end = o->filepos + o->size;
+	  if (!bfd_preallocate (abfd, end)
+	      || !_bfd_parallel_for (plink.count, 1,
+				     coff_link_input_bfd_range, &plink))
+	    goto error_return;
+	}
+      free (plink.bfds);
+      _bfd_mutex_destroy (&plink.io_lock);
+      flaginfo.parallel = NULL;
+    }
+
   if (flaginfo.info->strip != strip_all && flaginfo.info->discard != discard_all)
     {
       /* Add local symbols from foreign inputs.  */
@@ -1169,6 +1231,11 @@ _bfd_coff_final_link (bfd *abfd,
   return true;
 
  error_return:
+  if (flaginfo.parallel != NULL)
+    {
+      free (plink.bfds);
+      _bfd_mutex_destroy (&plink.io_lock);
+    }
   if (debug_merge_allocated)
     coff_debug_merge_hash_table_free (&flaginfo.debug_merge);
   if (flaginfo.strtab != NULL)
@@ -1377,6 +1444,302 @@ mark_relocs (struct coff_final_link_info *flaginfo, bfd *input_bfd)
     }
 }
 
+/* Return TRUE if input section O, with coff_section_data SECDATA, is
+   relocated and written by a worker thread when the link is done in
+   parallel.  Relocations in sections that aren't loaded, such as
+   DWARF debug info, touch nothing but the section itself.  Stabs are
+   merged, and left to the main thread.  */
+
+static bool
+coff_link_parallel_section_p (asection *o, struct coff_section_tdata *secdata)
+{
+  return ((o->flags & (SEC_ALLOC | SEC_LINKER_CREATED | SEC_EXCLUDE)) == 0
+	  && (o->flags & SEC_HAS_CONTENTS) != 0
+	  && o->size != 0
+	  && (secdata == NULL || secdata->stab_info == NULL));
+}
+
+/* Serialise file access by worker threads.  */
+
+static void
+coff_link_io_lock (struct coff_final_link_info *flaginfo)
+{
+  if (flaginfo->worker)
+    _bfd_mutex_lock (&flaginfo->parallel->io_lock);
+}
+
+static void
+coff_link_io_unlock (struct coff_final_link_info *flaginfo)
+{
+  if (flaginfo->worker)
+    _bfd_mutex_unlock (&flaginfo->parallel->io_lock);
+}
+
+/* Write SIZE bytes of CONTENTS at OFFSET in output section OSEC.
+   Worker threads write straight to the section's place in the output
+   file, so that they can all write at once.  */
+
+static bool
+coff_link_write_output (struct coff_final_link_info *flaginfo,
+			asection *osec, const bfd_byte *contents,
+			file_ptr offset, bfd_size_type size)
+{
+  bool written;
+
+  if (flaginfo->worker
+      && osec->filepos != 0
+      && (osec->flags & SEC_HAS_CONTENTS) != 0
+      && offset >= 0
+      && (bfd_size_type) offset <= osec->size
+      && size <= osec->size - offset)
+    return bfd_pwrite (contents, size, osec->filepos + offset,
+		       flaginfo->output_bfd);
+
+  coff_link_io_lock (flaginfo);
+  written = bfd_set_section_contents (flaginfo->output_bfd, osec, contents,
+				      offset, size);
+  coff_link_io_unlock (flaginfo);
+  return written;
+}
+
+/* Relocate and write out the sections of INPUT_BFD, once its symbols
+   have been swapped into FLAGINFO.  If SPLIT, only the sections on
+   this thread's side of the split between the main thread and the
+   workers are done, and *DEFERRED is set if the main thread leaves
+   any to the workers.  */
+
+static bool
+coff_link_input_sections (struct coff_final_link_info *flaginfo,
+			  bfd *input_bfd, bool split, bool *deferred)
+{
+  bool (*adjust_symndx)
+    (bfd *, struct bfd_link_info *, bfd *, asection *,
+     struct internal_reloc *, bool *);
+  bfd *output_bfd = flaginfo->output_bfd;
+  asection *o;
+
+  adjust_symndx = coff_backend_info (input_bfd)->_bfd_coff_adjust_symndx;
+  for (o = input_bfd->sections; o != NULL; o = o->next)
+    {
+      bfd_byte *contents;
+      struct coff_section_tdata *secdata;
+
+      if (! o->linker_mark)
+	/* This section was omitted from the link.  */
+	continue;
+
+      if ((o->flags & SEC_LINKER_CREATED) != 0)
+	continue;
+
+      if ((o->flags & SEC_HAS_CONTENTS) == 0
+	  || (o->size == 0 && (o->flags & SEC_RELOC) == 0))
+	{
+	  if ((o->flags & SEC_RELOC) != 0
+	      && o->reloc_count != 0)
+	    {
+	      _bfd_error_handler
+		/* xgettext: c-format */
+		(_("%pB: relocs in section `%pA', but it has no contents"),
+		 input_bfd, o);
+	      bfd_set_error (bfd_error_no_contents);
+	      return false;
+	    }
+
+	  continue;
+	}
+
+      secdata = coff_section_data (input_bfd, o);
+      if (split
+	  && (coff_link_parallel_section_p (o, secdata)
+	      != flaginfo->worker))
+	{
+	  /* This section is done on the other side of the split.  */
+	  *deferred |= !flaginfo->worker;
+	  continue;
+	}
+
+      if (secdata != NULL && secdata->contents != NULL)
+	contents = secdata->contents;
+      else
+	{
+	  bool got;
+
+	  contents = flaginfo->contents;
+	  coff_link_io_lock (flaginfo);
+	  got = bfd_get_full_section_contents (input_bfd, o, &contents);
+	  coff_link_io_unlock (flaginfo);
+	  if (!got)
+	    return false;
+	}
+
+      if ((o->flags & SEC_RELOC) != 0)
+	{
+	  int target_index;
+	  struct internal_reloc *internal_relocs;
+	  struct internal_reloc *irel;
+
+	  /* Read in the relocs.  */
+	  target_index = o->output_section->target_index;
+	  coff_link_io_lock (flaginfo);
+	  internal_relocs = (_bfd_coff_read_internal_relocs
+			     (input_bfd, o, false, flaginfo->external_relocs,
+			      bfd_link_relocatable (flaginfo->info),
+			      (bfd_link_relocatable (flaginfo->info)
+			       ? (flaginfo->section_info[target_index].relocs
+				  + o->output_section->reloc_count)
+			       : flaginfo->internal_relocs)));
+	  coff_link_io_unlock (flaginfo);
+	  if (internal_relocs == NULL
+	      && o->reloc_count > 0)
+	    return false;
+
+	  /* Run through the relocs looking for relocs against symbols
+	     coming from discarded sections and complain about them.  */
+	  irel = internal_relocs;
+	  for (; irel < &internal_relocs[o->reloc_count]; irel++)
+	    {
+	      struct coff_link_hash_entry *h;
+	      asection *ps = NULL;
+	      long long symndx = irel->r_symndx;
+	      if (symndx < 0)
+		continue;
+	      h = obj_coff_sym_hashes (input_bfd)[symndx];
+	      if (h == NULL)
+		continue;
+	      while (h->root.type == bfd_link_hash_indirect
+		     || h->root.type == bfd_link_hash_warning)
+		h = (struct coff_link_hash_entry *) h->root.u.i.link;
+	      if (h->root.type == bfd_link_hash_defined
+		  || h->root.type == bfd_link_hash_defweak)
+		ps = h->root.u.def.section;
+	      if (ps == NULL)
+		continue;
+	      /* Complain if definition comes from an excluded section.  */
+	      if (ps->flags & SEC_EXCLUDE)
+		(*flaginfo->info->callbacks->einfo)
+		  /* xgettext: c-format */
+		  (_("%X`%s' referenced in section `%pA' of %pB: "
+		     "defined in discarded section `%pA' of %pB\n"),
+		   h->root.root.string, o, input_bfd, ps, ps->owner);
+	    }
+
+	  /* Call processor specific code to relocate the section
+	     contents.  */
+	  if (! bfd_coff_relocate_section (output_bfd, flaginfo->info,
+					   input_bfd, o,
+					   contents,
+					   internal_relocs,
+					   flaginfo->internal_syms,
+					   flaginfo->sec_ptrs))
+	    return false;
+
+	  if (bfd_link_relocatable (flaginfo->info))
+	    {
+	      bfd_vma offset;
+	      struct internal_reloc *irelend;
+	      struct coff_link_hash_entry **rel_hash;
+
+	      offset = o->output_section->vma + o->output_offset - o->vma;
+	      irel = internal_relocs;
+	      irelend = irel + o->reloc_count;
+	      rel_hash = (flaginfo->section_info[target_index].rel_hashes
+			  + o->output_section->reloc_count);
+	      for (; irel < irelend; irel++, rel_hash++)
+		{
+		  struct coff_link_hash_entry *h;
+		  bool adjusted;
+
+		  *rel_hash = NULL;
+
+		  /* Adjust the reloc address and symbol index.  */
+		  irel->r_vaddr += offset;
+
+		  if (irel->r_symndx == -1)
+		    continue;
+
+		  if (adjust_symndx)
+		    {
+		      if (! (*adjust_symndx) (output_bfd, flaginfo->info,
+					      input_bfd, o, irel,
+					      &adjusted))
+			return false;
+		      if (adjusted)
+			continue;
+		    }
+
+		  h = obj_coff_sym_hashes (input_bfd)[irel->r_symndx];
+		  if (h != NULL)
+		    {
+		      /* This is a global symbol.  */
+		      if (h->indx >= 0)
+			irel->r_symndx = h->indx;
+		      else
+			{
+			  /* This symbol is being written at the end
+			     of the file, and we do not yet know the
+			     symbol index.  We save the pointer to the
+			     hash table entry in the rel_hash list.
+			     We set the indx field to -2 to indicate
+			     that this symbol must not be stripped.  */
+			  *rel_hash = h;
+			  h->indx = -2;
+			}
+		    }
+		  else
+		    {
+		      long long indx;
+
+		      indx = flaginfo->sym_indices[irel->r_symndx];
+		      if (indx != -1)
+			irel->r_symndx = indx;
+		      else
+			{
+			  struct internal_syment *is;
+			  const char *name;
+			  char buf[SYMNMLEN + 1];
+
+			  /* This reloc is against a symbol we are
+			     stripping.  This should have been handled
+			     by the 'dont_skip_symbol' code in the while
+			     loop at the top of this function.  */
+			  is = flaginfo->internal_syms + irel->r_symndx;
+
+			  name = (_bfd_coff_internal_syment_name
+				  (input_bfd, is, buf));
+			  if (name == NULL)
+			    return false;
+
+			  (*flaginfo->info->callbacks->unattached_reloc)
+			    (flaginfo->info, name, input_bfd, o, irel->r_vaddr);
+			}
+		    }
+		}
+
+	      o->output_section->reloc_count += o->reloc_count;
+	    }
+	}
+
+      /* Write out the modified section contents.  */
+      if (secdata == NULL || secdata->stab_info == NULL)
+	{
+	  file_ptr loc = (o->output_offset
+			  * bfd_octets_per_byte (output_bfd, o));
+	  if (! coff_link_write_output (flaginfo, o->output_section,
+					contents, loc, o->size))
+	    return false;
+	}
+      else
+	{
+	  if (! (_bfd_write_section_stabs
+		 (output_bfd, &coff_hash_table (flaginfo->info)->stab_info,
+		  o, &secdata->stab_info, contents)))
+	    return false;
+	}
+    }
+
+  return true;
+}
+
 /* Link an input file into the linker output file.  This function
    handles all the sections and relocations of the input file at once.  */
 
@@ -1385,9 +1748,6 @@ _bfd_coff_link_input_bfd (struct coff_final_link_info *flaginfo, bfd *input_bfd)
 {
   unsigned int n_tmask = coff_data (input_bfd)->local_n_tmask;
   unsigned int n_btshft = coff_data (input_bfd)->local_n_btshft;
-  bool (*adjust_symndx)
-    (bfd *, struct bfd_link_info *, bfd *, asection *,
-     struct internal_reloc *, bool *);
   bfd *output_bfd;
   const char *strings;
   bfd_size_type syment_base;
@@ -1404,6 +1764,8 @@ _bfd_coff_link_input_bfd (struct coff_final_link_info *flaginfo, bfd *input_bfd)
   bfd_byte *outsym;
   struct coff_link_hash_entry **sym_hash;
   asection *o;
+  bool merged = false;
+  bool deferred = false;
 
   /* Move all the symbols to the output file.  */
 
@@ -1612,6 +1974,7 @@ _bfd_coff_link_input_bfd (struct coff_final_link_info *flaginfo, bfd *input_bfd)
 	  bfd_byte *esl, *eslend;
 	  struct internal_syment *islp;
 	  size_t amt;
+	  hashval_t hash;
 
 	  name = _bfd_coff_internal_syment_name (input_bfd, &isym, buf);
 	  if (name == NULL)
@@ -1624,11 +1987,6 @@ _bfd_coff_link_input_bfd (struct coff_final_link_info *flaginfo, bfd *input_bfd)
 		  && (name[1] == '~' || name[1] == '.' || name[1] == '$')))
 	    name = "";
 
-	  mh = coff_debug_merge_hash_lookup (&flaginfo->debug_merge, name,
-					     true, true);
-	  if (mh == NULL)
-	    return false;
-
 	  /* Allocate memory to hold type information.  If this turns
 	     out to be a duplicate, we pass this address to
 	     bfd_release.  */
@@ -1637,6 +1995,7 @@ _bfd_coff_link_input_bfd (struct coff_final_link_info *flaginfo, bfd *input_bfd)
 	  if (mt == NULL)
 	    return false;
 	  mt->type_class = isym.n_sclass;
+	  hash = iterative_hash_object (mt->type_class, 0);
 
 	  /* Pick up the aux entry, which points to the end of the tag
 	     entries.  */
@@ -1706,6 +2065,9 @@ _bfd_coff_link_input_bfd (struct coff_final_link_info *flaginfo, bfd *input_bfd)
 			(*epp)->tagndx = 0;
 		    }
 		}
+	      hash = iterative_hash (name_copy, amt, hash);
+	      hash = iterative_hash_object ((*epp)->type, hash);
+	      hash = iterative_hash_object ((*epp)->tagndx, hash);
 	      epp = &(*epp)->next;
 	      *epp = NULL;
 
@@ -1721,6 +2083,23 @@ _bfd_coff_link_input_bfd (struct coff_final_link_info *flaginfo, bfd *input_bfd)
 	  else
 	    {
 	      struct coff_debug_merge_type *mtl;
+	      char *key;
+
+	      /* Types are entered under their name followed by a hash
+		 of their class and elements, so that the one lookup
+		 finds only types that are very likely to be the same,
+		 however many others share the name.  */
+	      amt = strlen (name);
+	      key = (char *) bfd_malloc (amt + 9);
+	      if (key == NULL)
+		return false;
+	      memcpy (key, name, amt);
+	      sprintf (key + amt, "%08x", (unsigned int) hash);
+	      mh = coff_debug_merge_hash_lookup (&flaginfo->debug_merge, key,
+						 true, true);
+	      free (key);
+	      if (mh == NULL)
+		return false;
 
 	      for (mtl = mh->types; mtl != NULL; mtl = mtl->next)
 		{
@@ -1752,11 +2131,15 @@ _bfd_coff_link_input_bfd (struct coff_final_link_info *flaginfo, bfd *input_bfd)
 		}
 	      else
 		{
-		  /* This is a redefinition which can be merged.  */
+		  /* This is a redefinition which can be merged.  The
+		     symbols of the type are then left without sections,
+		     which a worker swapping them again wouldn't know,
+		     so the main thread does all of this input.  */
 		  bfd_release (input_bfd, mt);
 		  *indexp = mtl->indx;
 		  add = (eslend - esym) / isymesz;
 		  skip = true;
+		  merged = true;
 		}
 	    }
 	}
@@ -2317,214 +2700,148 @@ _bfd_coff_link_input_bfd (struct coff_final_link_info *flaginfo, bfd *input_bfd)
     }
 
   /* Relocate the contents of each section.  */
-  adjust_symndx = coff_backend_info (input_bfd)->_bfd_coff_adjust_symndx;
-  for (o = input_bfd->sections; o != NULL; o = o->next)
-    {
-      bfd_byte *contents;
-      struct coff_section_tdata *secdata;
-
-      if (! o->linker_mark)
-	/* This section was omitted from the link.  */
-	continue;
+  if (! coff_link_input_sections (flaginfo, input_bfd,
+				  flaginfo->parallel != NULL && ! merged,
+				  &deferred))
+    return false;
 
-      if ((o->flags & SEC_LINKER_CREATED) != 0)
-	continue;
+  if (deferred)
+    {
+      struct coff_parallel_link *plink = flaginfo->parallel;
 
-      if ((o->flags & SEC_HAS_CONTENTS) == 0
-	  || (o->size == 0 && (o->flags & SEC_RELOC) == 0))
+      if (plink->count == plink->alloc)
 	{
-	  if ((o->flags & SEC_RELOC) != 0
-	      && o->reloc_count != 0)
-	    {
-	      _bfd_error_handler
-		/* xgettext: c-format */
-		(_("%pB: relocs in section `%pA', but it has no contents"),
-		 input_bfd, o);
-	      bfd_set_error (bfd_error_no_contents);
-	      return false;
-	    }
+	  size_t alloc = plink->alloc * 2 + 16;
+	  bfd **bfds;
 
-	  continue;
-	}
-
-      secdata = coff_section_data (input_bfd, o);
-      if (secdata != NULL && secdata->contents != NULL)
-	contents = secdata->contents;
-      else
-	{
-	  contents = flaginfo->contents;
-	  if (! bfd_get_full_section_contents (input_bfd, o, &contents))
+	  bfds = (bfd **) bfd_realloc (plink->bfds, alloc * sizeof (bfd *));
+	  if (bfds == NULL)
 	    return false;
+	  plink->bfds = bfds;
+	  plink->alloc = alloc;
 	}
+      plink->bfds[plink->count++] = input_bfd;
+    }
 
-      if ((o->flags & SEC_RELOC) != 0)
-	{
-	  int target_index;
-	  struct internal_reloc *internal_relocs;
-	  struct internal_reloc *irel;
-
-	  /* Read in the relocs.  */
-	  target_index = o->output_section->target_index;
-	  internal_relocs = (_bfd_coff_read_internal_relocs
-			     (input_bfd, o, false, flaginfo->external_relocs,
-			      bfd_link_relocatable (flaginfo->info),
-			      (bfd_link_relocatable (flaginfo->info)
-			       ? (flaginfo->section_info[target_index].relocs
-				  + o->output_section->reloc_count)
-			       : flaginfo->internal_relocs)));
-	  if (internal_relocs == NULL
-	      && o->reloc_count > 0)
-	    return false;
-
-	  /* Run through the relocs looking for relocs against symbols
-	     coming from discarded sections and complain about them.  */
-	  irel = internal_relocs;
-	  for (; irel < &internal_relocs[o->reloc_count]; irel++)
-	    {
-	      struct coff_link_hash_entry *h;
-	      asection *ps = NULL;
-	      long long symndx = irel->r_symndx;
-	      if (symndx < 0)
-		continue;
-	      h = obj_coff_sym_hashes (input_bfd)[symndx];
-	      if (h == NULL)
-		continue;
-	      while (h->root.type == bfd_link_hash_indirect
-		     || h->root.type == bfd_link_hash_warning)
-		h = (struct coff_link_hash_entry *) h->root.u.i.link;
-	      if (h->root.type == bfd_link_hash_defined
-		  || h->root.type == bfd_link_hash_defweak)
-		ps = h->root.u.def.section;
-	      if (ps == NULL)
-		continue;
-	      /* Complain if definition comes from an excluded section.  */
-	      if (ps->flags & SEC_EXCLUDE)
-		(*flaginfo->info->callbacks->einfo)
-		  /* xgettext: c-format */
-		  (_("%X`%s' referenced in section `%pA' of %pB: "
-		     "defined in discarded section `%pA' of %pB\n"),
-		   h->root.root.string, o, input_bfd, ps, ps->owner);
-	    }
-
-	  /* Call processor specific code to relocate the section
-	     contents.  */
-	  if (! bfd_coff_relocate_section (output_bfd, flaginfo->info,
-					   input_bfd, o,
-					   contents,
-					   internal_relocs,
-					   flaginfo->internal_syms,
-					   flaginfo->sec_ptrs))
-	    return false;
-
-	  if (bfd_link_relocatable (flaginfo->info))
-	    {
-	      bfd_vma offset;
-	      struct internal_reloc *irelend;
-	      struct coff_link_hash_entry **rel_hash;
-
-	      offset = o->output_section->vma + o->output_offset - o->vma;
-	      irel = internal_relocs;
-	      irelend = irel + o->reloc_count;
-	      rel_hash = (flaginfo->section_info[target_index].rel_hashes
-			  + o->output_section->reloc_count);
-	      for (; irel < irelend; irel++, rel_hash++)
-		{
-		  struct coff_link_hash_entry *h;
-		  bool adjusted;
-
-		  *rel_hash = NULL;
-
-		  /* Adjust the reloc address and symbol index.  */
-		  irel->r_vaddr += offset;
-
-		  if (irel->r_symndx == -1)
-		    continue;
-
-		  if (adjust_symndx)
-		    {
-		      if (! (*adjust_symndx) (output_bfd, flaginfo->info,
-					      input_bfd, o, irel,
-					      &adjusted))
-			return false;
-		      if (adjusted)
-			continue;
-		    }
+  if (! flaginfo->info->keep_memory
+      && ! _bfd_coff_free_symbols (input_bfd))
+    return false;
 
-		  h = obj_coff_sym_hashes (input_bfd)[irel->r_symndx];
-		  if (h != NULL)
-		    {
-		      /* This is a global symbol.  */
-		      if (h->indx >= 0)
-			irel->r_symndx = h->indx;
-		      else
-			{
-			  /* This symbol is being written at the end
-			     of the file, and we do not yet know the
-			     symbol index.  We save the pointer to the
-			     hash table entry in the rel_hash list.
-			     We set the indx field to -2 to indicate
-			     that this symbol must not be stripped.  */
-			  *rel_hash = h;
-			  h->indx = -2;
-			}
-		    }
-		  else
-		    {
-		      long long indx;
+  return true;
+}
 
-		      indx = flaginfo->sym_indices[irel->r_symndx];
-		      if (indx != -1)
-			irel->r_symndx = indx;
-		      else
-			{
-			  struct internal_syment *is;
-			  const char *name;
-			  char buf[SYMNMLEN + 1];
+/* Swap the symbols of INPUT_BFD into the buffers of the worker
+   FLAGINFO again, as _bfd_coff_link_input_bfd did before leaving some
+   of its sections to the workers.  relocate_section only looks at the
+   section of a symbol without a hash entry, which is local and so in
+   the section it numbers; classifying the symbols again would repeat
+   their warnings.  */
 
-			  /* This reloc is against a symbol we are
-			     stripping.  This should have been handled
-			     by the 'dont_skip_symbol' code in the while
-			     loop at the top of this function.  */
-			  is = flaginfo->internal_syms + irel->r_symndx;
+static bool
+coff_link_swap_input_syms (struct coff_final_link_info *flaginfo,
+			   bfd *input_bfd)
+{
+  bfd_size_type isymesz = bfd_coff_symesz (input_bfd);
+  struct internal_syment *isymp;
+  asection **secpp;
+  bfd_byte *esym;
+  bfd_byte *esym_end;
+  bool got;
+
+  /* Read the string table now too, since relocation may want symbol
+     names.  */
+  coff_link_io_lock (flaginfo);
+  got = (_bfd_coff_get_external_symbols (input_bfd)
+	 && (obj_raw_syment_count (input_bfd) == 0
+	     || _bfd_coff_read_string_table (input_bfd) != NULL));
+  coff_link_io_unlock (flaginfo);
+  if (!got)
+    return false;
 
-			  name = (_bfd_coff_internal_syment_name
-				  (input_bfd, is, buf));
-			  if (name == NULL)
-			    return false;
+  esym = (bfd_byte *) obj_coff_external_syms (input_bfd);
+  esym_end = esym + obj_raw_syment_count (input_bfd) * isymesz;
+  isymp = flaginfo->internal_syms;
+  secpp = flaginfo->sec_ptrs;
+  while (esym < esym_end)
+    {
+      int add;
 
-			  (*flaginfo->info->callbacks->unattached_reloc)
-			    (flaginfo->info, name, input_bfd, o, irel->r_vaddr);
-			}
-		    }
-		}
+      bfd_coff_swap_sym_in (input_bfd, esym, isymp);
+      *secpp++ = coff_section_from_bfd_index (input_bfd, isymp->n_scnum);
+      add = 1 + isymp->n_numaux;
+      esym += add * isymesz;
+      isymp += add;
+      for (--add; add > 0; --add)
+	*secpp++ = NULL;
+    }
+  return true;
+}
 
-	      o->output_section->reloc_count += o->reloc_count;
-	    }
-	}
+/* Relocate the input BFDs in JOB from START to END, using buffers of
+   this thread's own.  Worker for _bfd_parallel_for.  */
 
-      /* Write out the modified section contents.  */
-      if (secdata == NULL || secdata->stab_info == NULL)
-	{
-	  file_ptr loc = (o->output_offset
-			  * bfd_octets_per_byte (output_bfd, o));
-	  if (! bfd_set_section_contents (output_bfd, o->output_section,
-					  contents, loc, o->size))
-	    return false;
-	}
-      else
-	{
-	  if (! (_bfd_write_section_stabs
-		 (output_bfd, &coff_hash_table (flaginfo->info)->stab_info,
-		  o, &secdata->stab_info, contents)))
-	    return false;
-	}
+static bool
+coff_link_input_bfd_range (void *data, size_t start, size_t end)
+{
+  struct coff_parallel_link *job = (struct coff_parallel_link *) data;
+  struct coff_final_link_info flaginfo;
+  bfd_size_type relsz;
+  bool deferred;
+  bool ret = false;
+
+  flaginfo = *job->flaginfo;
+  flaginfo.worker = true;
+  relsz = bfd_coff_relsz (flaginfo.output_bfd);
+  flaginfo.internal_syms = (struct internal_syment *)
+    bfd_malloc (job->max_sym_count * sizeof (struct internal_syment));
+  flaginfo.sec_ptrs = (asection **)
+    bfd_malloc (job->max_sym_count * sizeof (asection *));
+  flaginfo.contents = (bfd_byte *) bfd_malloc (job->max_contents_size);
+  flaginfo.external_relocs = (bfd_byte *)
+    bfd_malloc (job->max_reloc_count * relsz);
+  flaginfo.internal_relocs = (struct internal_reloc *)
+    bfd_malloc (job->max_reloc_count * sizeof (struct internal_reloc));
+  if ((flaginfo.internal_syms == NULL && job->max_sym_count > 0)
+      || (flaginfo.sec_ptrs == NULL && job->max_sym_count > 0)
+      || (flaginfo.contents == NULL && job->max_contents_size > 0)
+      || (flaginfo.external_relocs == NULL && job->max_reloc_count > 0)
+      || (flaginfo.internal_relocs == NULL && job->max_reloc_count > 0))
+    goto out;
+
+  for (; start < end; start++)
+    {
+      bfd *input_bfd = job->bfds[start];
+
+      if (! coff_link_swap_input_syms (&flaginfo, input_bfd)
+	  || ! coff_link_input_sections (&flaginfo, input_bfd, true,
+					 &deferred))
+	goto out;
+      if (! flaginfo.info->keep_memory
+	  && ! _bfd_coff_free_symbols (input_bfd))
+	goto out;
     }
+  ret = true;
 
-  if (! flaginfo->info->keep_memory
-      && ! _bfd_coff_free_symbols (input_bfd))
-    return false;
+ out:
+  free (flaginfo.internal_syms);
+  free (flaginfo.sec_ptrs);
+  free (flaginfo.contents);
+  free (flaginfo.external_relocs);
+  free (flaginfo.internal_relocs);
+  return ret;
+}
 
-  return true;
+/* Return TRUE if the sections of a link can be relocated on several
+   threads.  Only the relocation of sections that are not loaded is
+   split off, and only when no relocs are copied to the output and no
+   base file for dlltool is being written.  */
+
+static bool
+coff_link_parallel_p (struct bfd_link_info *info)
+{
+  return (bfd_get_thread_count () > 1
+	  && !bfd_link_relocatable (info)
+	  && info->base_file == NULL);
 }
 
 /* Write out a global symbol.  Called via bfd_hash_traverse.  */
@@ -355,6 +355,33 @@ coff_swap_sym_in (bfd * abfd, void * ext1, void * in1)
 #endif
 }
 
+/* Swap in the symbols of the COUNT symbol table entries at EXT1,
+   stepping over their auxiliary entries.  */
+
+static bool
+coff_swap_syms_in (bfd * abfd, void * ext1, size_t count,
+		   combined_entry_type * internal)
+{
+  bfd_byte *ext = (bfd_byte *) ext1;
+  size_t symesz = bfd_coff_symesz (abfd);
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    {
+      unsigned int numaux;
+
+      coff_swap_sym_in (abfd, ext + i * symesz, &internal[i].u.syment);
+      internal[i].is_sym = true;
+
+      /* PR 17512: Prevent buffer overrun.  */
+      numaux = internal[i].u.syment.n_numaux;
+      if (numaux > count - 1 - i)
+	return false;
+      i += numaux;
+    }
+  return true;
+}
+
 static unsigned int
 coff_swap_sym_out (bfd * abfd, void * inp, void * extp)
 {
@@ -786,6 +813,21 @@ coff_swap_scnhdr_in (bfd * abfd, void * ext, void * in)
 #endif
 }
 
+/* Swap in the COUNT section headers at EXT.  */
+
+ATTRIBUTE_UNUSED
+static void
+coff_swap_scnhdrs_in (bfd * abfd, void * ext, unsigned int count,
+		      struct internal_scnhdr * in)
+{
+  bfd_byte *scnhdr_ext = (bfd_byte *) ext;
+  size_t scnhsz = bfd_coff_scnhsz (abfd);
+  unsigned int i;
+
+  for (i = 0; i < count; i++)
+    coff_swap_scnhdr_in (abfd, scnhdr_ext + i * scnhsz, in + i);
+}
+
 ATTRIBUTE_UNUSED
 static unsigned int
 coff_swap_scnhdr_out (bfd * abfd, void * in, void * out)
@@ -83,6 +83,10 @@ EXTERNAL
 .  return new_name;
 .}
 .
+.{* A reader of the decompressed contents of a section, made by
+.   bfd_open_section_stream.  *}
+.struct bfd_section_stream;
+.
 */
 
 /* Display texts for type of compressed DWARF debug sections.  */
@@ -398,7 +402,6 @@ bfd_convert_section_contents (bfd *ibfd, sec_ptr isec, bfd *obfd,
   bfd_byte *contents;
   bfd_size_type ihdr_size, ohdr_size, size;
   Elf_Internal_Chdr chdr;
-  bool use_memmove;
 
   /* Do nothing if either input or output aren't ELF.  */
   if (bfd_get_flavour (ibfd) != bfd_target_elf_flavour
@@ -443,8 +446,6 @@ bfd_convert_section_contents (bfd *ibfd, sec_ptr isec, bfd *obfd,
       chdr.ch_addralign = bfd_get_32 (ibfd, &echdr->ch_addralign);
 
       ohdr_size = sizeof (Elf64_External_Chdr);
-
-      use_memmove = false;
     }
   else if (ihdr_size != sizeof (Elf64_External_Chdr))
     {
@@ -460,16 +461,19 @@ bfd_convert_section_contents (bfd *ibfd, sec_ptr isec, bfd *obfd,
       chdr.ch_addralign = bfd_get_64 (ibfd, &echdr->ch_addralign);
 
       ohdr_size = sizeof (Elf32_External_Chdr);
-      use_memmove = true;
     }
 
+  /* Move the compressed contents along in place, rather than copy
+     them to a new buffer, growing it when the header grows.  */
   size = bfd_section_size (isec) - ihdr_size + ohdr_size;
-  if (!use_memmove)
+  if (ohdr_size > ihdr_size)
     {
-      contents = (bfd_byte *) bfd_malloc (size);
+      contents = (bfd_byte *) bfd_realloc (contents, size);
       if (contents == NULL)
 	return false;
+      *ptr = contents;
     }
+  memmove (contents + ohdr_size, contents + ihdr_size, size - ohdr_size);
 
   /* Write out the output compression header.  */
   if (ohdr_size == sizeof (Elf32_External_Chdr))
@@ -488,19 +492,235 @@ bfd_convert_section_contents (bfd *ibfd, sec_ptr isec, bfd *obfd,
       bfd_put_64 (obfd, chdr.ch_addralign, &echdr->ch_addralign);
     }
 
-  /* Copy the compressed contents.  */
-  if (use_memmove)
-    memmove (contents + ohdr_size, *ptr + ihdr_size, size - ohdr_size);
-  else
+  *ptr_size = size;
+  return true;
+}
+
+/* Compression levels set by bfd_set_compression_level.  */
+static int zlib_compression_level = Z_DEFAULT_COMPRESSION;
+static int zstd_compression_level = 0;
+
+#ifdef HAVE_ZSTD
+/* Creating a zstd context allocates its window and tables, which
+   costs more than decompressing a small section.  Keep one context
+   of each kind around for the next section rather than creating one
+   per call.  A thread finding the cache empty makes its own.  */
+static bfd_mutex zstd_ctx_lock = BFD_MUTEX_INIT;
+static ZSTD_DCtx *zstd_dctx_cache;
+static ZSTD_CCtx *zstd_cctx_cache;
+
+static ZSTD_DCtx *
+get_zstd_dctx (void)
+{
+  ZSTD_DCtx *dctx;
+
+  _bfd_mutex_lock (&zstd_ctx_lock);
+  dctx = zstd_dctx_cache;
+  zstd_dctx_cache = NULL;
+  _bfd_mutex_unlock (&zstd_ctx_lock);
+  if (dctx == NULL)
+    dctx = ZSTD_createDCtx ();
+  return dctx;
+}
+
+static void
+put_zstd_dctx (ZSTD_DCtx *dctx)
+{
+  _bfd_mutex_lock (&zstd_ctx_lock);
+  if (zstd_dctx_cache == NULL)
     {
-      memcpy (contents + ohdr_size, *ptr + ihdr_size, size - ohdr_size);
-      free (*ptr);
-      *ptr = contents;
+      zstd_dctx_cache = dctx;
+      dctx = NULL;
+    }
+  _bfd_mutex_unlock (&zstd_ctx_lock);
+  ZSTD_freeDCtx (dctx);
+}
+
+static ZSTD_CCtx *
+get_zstd_cctx (void)
+{
+  ZSTD_CCtx *cctx;
+
+  _bfd_mutex_lock (&zstd_ctx_lock);
+  cctx = zstd_cctx_cache;
+  zstd_cctx_cache = NULL;
+  _bfd_mutex_unlock (&zstd_ctx_lock);
+  if (cctx == NULL)
+    cctx = ZSTD_createCCtx ();
+  return cctx;
+}
+
+static void
+put_zstd_cctx (ZSTD_CCtx *cctx)
+{
+  _bfd_mutex_lock (&zstd_ctx_lock);
+  if (zstd_cctx_cache == NULL)
+    {
+      zstd_cctx_cache = cctx;
+      cctx = NULL;
     }
+  _bfd_mutex_unlock (&zstd_ctx_lock);
+  ZSTD_freeCCtx (cctx);
+}
+#endif
 
-  *ptr_size = size;
-  return true;
+/*
+FUNCTION
+	bfd_set_compression_level
+
+SYNOPSIS
+	bool bfd_set_compression_level
+	  (enum compressed_debug_section_type type, int level);
+
+DESCRIPTION
+	Use @var{level} when compressing sections with the algorithm
+	@var{type} from now on.  For the zlib types the level runs from
+	0 to 9, or is -1 for zlib's default; both zlib types share one
+	level.  For <<COMPRESS_DEBUG_ZSTD>> it is any level zstd
+	accepts, with 0 meaning zstd's default.  Higher levels give
+	smaller sections and take longer.  This should be called before
+	BFDs are in use on other threads.  Returns <<FALSE>>, leaving
+	the level alone, if @var{level} is out of range or @var{type}
+	is not supported.
+*/
+
+bool
+bfd_set_compression_level (enum compressed_debug_section_type type,
+			   int level)
+{
+  switch (type)
+    {
+    case COMPRESS_DEBUG_GNU_ZLIB:
+    case COMPRESS_DEBUG_GABI_ZLIB:
+      if (level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION)
+	break;
+      zlib_compression_level = level;
+      return true;
+
+    case COMPRESS_DEBUG_ZSTD:
+#ifdef HAVE_ZSTD
+      if (level < ZSTD_minCLevel () || level > ZSTD_maxCLevel ())
+	break;
+      zstd_compression_level = level;
+      return true;
+#else
+      break;
+#endif
+
+    default:
+      break;
+    }
+  bfd_set_error (bfd_error_bad_value);
+  return false;
+}
+
+/* Where one frame of a compressed section lies in the compressed
+   data, after the compression header, and in the decompressed
+   contents.  */
+
+struct compressed_frame
+{
+  bfd_size_type in_offset;
+  bfd_size_type in_size;
+  bfd_size_type out_offset;
+  bfd_size_type out_size;
+};
+
+/* The frames of a compressed section, found by get_frame_index and
+   kept in the memory of the BFD.  COUNT is zero if the section could
+   not be split into frames.  */
+
+struct bfd_frame_index
+{
+  struct bfd_frame_index *next;
+  asection *section;
+  size_t count;
+  struct compressed_frame frames[];
+};
+
+#ifdef HAVE_ZSTD
+/* Split the SIZE bytes of zstd data at BUF into its frames, which
+   should decompress to OUT_SIZE bytes in all, and record them in
+   FRAMES if that isn't NULL.  Return the number of frames, or zero
+   if one of them doesn't give its decompressed size.  */
+
+static size_t
+zstd_scan_frames (const bfd_byte *buf, bfd_size_type size,
+		  bfd_size_type out_size, struct compressed_frame *frames)
+{
+  bfd_size_type in_offset = 0;
+  bfd_size_type out_offset = 0;
+  size_t count = 0;
+
+  while (in_offset < size)
+    {
+      size_t in_size = ZSTD_findFrameCompressedSize (buf + in_offset,
+						     size - in_offset);
+      unsigned long long frame_size;
+
+      if (ZSTD_isError (in_size))
+	return 0;
+      frame_size = ZSTD_getFrameContentSize (buf + in_offset,
+					     size - in_offset);
+      if (frame_size == ZSTD_CONTENTSIZE_UNKNOWN
+	  || frame_size == ZSTD_CONTENTSIZE_ERROR
+	  || frame_size > out_size - out_offset)
+	return 0;
+      if (frames != NULL)
+	{
+	  frames[count].in_offset = in_offset;
+	  frames[count].in_size = in_size;
+	  frames[count].out_offset = out_offset;
+	  frames[count].out_size = frame_size;
+	}
+      count++;
+      in_offset += in_size;
+      out_offset += frame_size;
+    }
+  return out_offset == out_size ? count : 0;
+}
+
+/* Frames of a zstd section decompressed in parallel by
+   zstd_decompress_range.  */
+
+struct decompress_job
+{
+  const bfd_byte *in;
+  bfd_byte *out;
+  const struct compressed_frame *frames;
+};
+
+/* Decompress frames START to END of the section in DATA, a
+   decompress_job.  Worker for _bfd_parallel_for.  */
+
+static bool
+zstd_decompress_range (void *data, size_t start, size_t end)
+{
+  struct decompress_job *job = (struct decompress_job *) data;
+  ZSTD_DCtx *dctx = get_zstd_dctx ();
+  bool ret = true;
+  size_t i;
+
+  if (dctx == NULL)
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return false;
+    }
+  for (i = start; ret && i < end; i++)
+    {
+      const struct compressed_frame *f = &job->frames[i];
+      size_t n = ZSTD_decompressDCtx (dctx, job->out + f->out_offset,
+				      f->out_size, job->in + f->in_offset,
+				      f->in_size);
+
+      ret = !ZSTD_isError (n) && n == f->out_size;
+    }
+  put_zstd_dctx (dctx);
+  if (!ret)
+    bfd_set_error (bfd_error_bad_value);
+  return ret;
 }
+#endif
 
 static bool
 decompress_contents (bool is_zstd, bfd_byte *compressed_buffer,
@@ -511,9 +731,49 @@ decompress_contents (bool is_zstd, bfd_byte *compressed_buffer,
   if (is_zstd)
     {
 #ifdef HAVE_ZSTD
-      size_t ret = ZSTD_decompress (uncompressed_buffer, uncompressed_size,
-				    compressed_buffer, compressed_size);
-      return !ZSTD_isError (ret);
+      ZSTD_DCtx *dctx;
+      size_t ret;
+
+      /* Frames that give their sizes, as written by
+	 bfd_compress_section_contents, can be done at the same
+	 time.  */
+      if (bfd_get_thread_count () > 1)
+	{
+	  size_t count = zstd_scan_frames (compressed_buffer, compressed_size,
+					   uncompressed_size, NULL);
+
+	  if (count > 1)
+	    {
+	      struct decompress_job job;
+	      struct compressed_frame *frames;
+	      bool ok;
+
+	      frames = bfd_malloc (count * sizeof (*frames));
+	      if (frames == NULL)
+		return false;
+	      zstd_scan_frames (compressed_buffer, compressed_size,
+				uncompressed_size, frames);
+	      job.in = compressed_buffer;
+	      job.out = uncompressed_buffer;
+	      job.frames = frames;
+	      ok = _bfd_parallel_for (count, 1, zstd_decompress_range, &job);
+	      free (frames);
+	      return ok;
+	    }
+	}
+
+      dctx = get_zstd_dctx ();
+      if (dctx == NULL)
+	return false;
+      /* The section may hold several frames back to back, which
+	 ZSTD_decompressDCtx handles.  Anything short of the size the
+	 header promised is corrupt.  */
+      ret = ZSTD_decompressDCtx (dctx, uncompressed_buffer, uncompressed_size,
+				 compressed_buffer, compressed_size);
+      put_zstd_dctx (dctx);
+      return !ZSTD_isError (ret) && ret == uncompressed_size;
+#else
+      return false;
 #endif
     }
 
@@ -553,6 +813,134 @@ decompress_contents (bool is_zstd, bfd_byte *compressed_buffer,
   return inflateEnd (&strm) == Z_OK && rc == Z_OK && strm.avail_out == 0;
 }
 
+/* Sections bigger than this are compressed in pieces of this size
+   on several threads, when bfd_set_thread_count allows more than
+   one.  Each piece is a zstd frame or a zlib stream of its own;
+   readers handle several in a row, as decompress_contents does.  */
+#define COMPRESS_CHUNK_SIZE (4 * 1024 * 1024)
+
+/* The most that compressing SIZE bytes can produce.  */
+
+static bfd_size_type
+compress_bound (bool is_zstd, bfd_size_type size)
+{
+#ifdef HAVE_ZSTD
+  if (is_zstd)
+    return ZSTD_compressBound (size);
+#else
+  (void) is_zstd;
+#endif
+  return compressBound (size);
+}
+
+/* Compress the IN_SIZE bytes at IN into the *OUT_SIZE bytes at OUT,
+   using zstd context CCTX if IS_ZSTD, and set *OUT_SIZE to the size
+   of the result.  */
+
+static bool
+compress_contents (bool is_zstd, void *cctx, bfd_byte *out,
+		   bfd_size_type *out_size, const bfd_byte *in,
+		   bfd_size_type in_size)
+{
+#ifdef HAVE_ZSTD
+  if (is_zstd)
+    {
+      size_t ret;
+
+      ZSTD_CCtx_reset (cctx, ZSTD_reset_session_and_parameters);
+      ret = ZSTD_CCtx_setParameter (cctx, ZSTD_c_compressionLevel,
+				    zstd_compression_level);
+      if (!ZSTD_isError (ret))
+	ret = ZSTD_compress2 (cctx, out, *out_size, in, in_size);
+      if (ZSTD_isError (ret))
+	{
+	  bfd_set_error (bfd_error_bad_value);
+	  return false;
+	}
+      *out_size = ret;
+      return true;
+    }
+#else
+  (void) is_zstd;
+  (void) cctx;
+#endif
+
+  uLong dest_len = *out_size;
+
+  if (dest_len != *out_size
+      || (uLong) in_size != in_size
+      || compress2 ((Bytef *) out, &dest_len, (const Bytef *) in, in_size,
+		    zlib_compression_level) != Z_OK)
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+  *out_size = dest_len;
+  return true;
+}
+
+/* A section being compressed in pieces by compress_chunk_range.
+   Piece I, the CHUNK bytes at IN + I * CHUNK or what is left of
+   IN_SIZE, is compressed into the SLOT bytes at OUT + I * SLOT, and
+   its compressed size is left in SIZES[I].  */
+
+struct compress_job
+{
+  bool is_zstd;
+  const bfd_byte *in;
+  bfd_size_type in_size;
+  bfd_size_type chunk;
+  bfd_byte *out;
+  bfd_size_type slot;
+  bfd_size_type *sizes;
+};
+
+/* Compress pieces START to END of the section in DATA, a
+   compress_job.  Worker for _bfd_parallel_for.  */
+
+static bool
+compress_chunk_range (void *data, size_t start, size_t end)
+{
+  struct compress_job *job = (struct compress_job *) data;
+  void *cctx = NULL;
+  bool ret = true;
+  size_t i;
+
+#ifdef HAVE_ZSTD
+  if (job->is_zstd)
+    {
+      cctx = get_zstd_cctx ();
+      if (cctx == NULL)
+	{
+	  bfd_set_error (bfd_error_no_memory);
+	  return false;
+	}
+    }
+#endif
+
+  for (i = start; ret && i < end; i++)
+    {
+      bfd_size_type offset = i * job->chunk;
+      bfd_size_type size = job->in_size - offset;
+
+      if (size > job->chunk)
+	size = job->chunk;
+      job->sizes[i] = job->slot;
+      ret = compress_contents (job->is_zstd, cctx, job->out + i * job->slot,
+			       &job->sizes[i], job->in + offset, size);
+    }
+
+#ifdef HAVE_ZSTD
+  if (cctx != NULL)
+    put_zstd_cctx (cctx);
+#endif
+  return ret;
+}
+
+static bool recompress_contents
+  (bfd *, const bfd_byte *, bfd_size_type, bool, bool, bfd_size_type,
+   unsigned int, bfd_byte **, bfd_size_type *);
+
 /* Compress section contents using zlib/zstd and store
    as the contents field.  This function assumes the contents
    field was allocated using bfd_malloc() or equivalent.
@@ -564,7 +952,7 @@ static bfd_size_type
 bfd_compress_section_contents (bfd *abfd, sec_ptr sec)
 {
   bfd_byte *input_buffer;
-  uLong compressed_size;
+  bfd_size_type compressed_size;
   bfd_byte *buffer;
   bfd_size_type buffer_size;
   int zlib_size = 0;
@@ -580,11 +968,21 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec)
 				      &uncompressed_alignment_pow,
 				      &ch_type);
   bool update = false;
+  bool is_zstd;
+  size_t nchunks = 1;
+  bfd_size_type slot = 0;
 
   /* We shouldn't be trying to decompress unsupported compressed sections.  */
   if (compressed && orig_header_size < 0)
     abort ();
 
+#ifndef HAVE_ZSTD
+  /* Without zstd the best that can be done is zlib, and the
+     headers written below must say so.  */
+  abfd->flags &= ~BFD_COMPRESS_ZSTD;
+#endif
+  is_zstd = (abfd->flags & BFD_COMPRESS_ZSTD) != 0;
+
   /* Either ELF compression header or the 12-byte, "ZLIB" + 8-byte size,
      overhead in .zdebug* section.  */
   if (!new_header_size)
@@ -607,6 +1005,25 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec)
 	 is not smaller than uncompressed.  */
       if (!update || compressed_size >= uncompressed_size)
 	{
+	  /* Rather than hold all the decompressed contents of a big
+	     section, and room for compressing them, decompress and
+	     compress it again a piece at a time.  Do it all at once
+	     if that won't make it smaller.  */
+	  if (!update && uncompressed_size > COMPRESS_CHUNK_SIZE)
+	    {
+	      if (!recompress_contents (abfd, input_buffer + orig_header_size,
+					zlib_size, ch_type == ch_compress_zstd,
+					is_zstd, uncompressed_size,
+					new_header_size, &buffer,
+					&compressed_size))
+		return 0;
+	      if (buffer != NULL)
+		{
+		  bfd_set_section_alignment (sec, uncompressed_alignment_pow);
+		  goto done;
+		}
+	    }
+
 	  buffer_size = uncompressed_size;
 	  buffer = bfd_malloc (buffer_size);
 	  if (buffer == NULL)
@@ -631,7 +1048,20 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec)
     }
 
   if (!update)
-    compressed_size = compressBound (uncompressed_size) + new_header_size;
+    {
+      /* Leave enough room for every piece to come out at its
+	 biggest, and squeeze them together once done.  */
+      if (uncompressed_size > COMPRESS_CHUNK_SIZE
+	  && bfd_get_thread_count () > 1)
+	{
+	  nchunks = ((uncompressed_size + COMPRESS_CHUNK_SIZE - 1)
+		     / COMPRESS_CHUNK_SIZE);
+	  slot = compress_bound (is_zstd, COMPRESS_CHUNK_SIZE);
+	}
+      else
+	slot = compress_bound (is_zstd, uncompressed_size);
+      compressed_size = nchunks * slot + new_header_size;
+    }
 
   buffer_size = compressed_size;
   buffer = bfd_alloc (abfd, buffer_size);
@@ -647,34 +1077,50 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec)
     }
   else
     {
-      if (abfd->flags & BFD_COMPRESS_ZSTD)
+      struct compress_job job;
+      bfd_size_type size = slot;
+      bool ok;
+      size_t i;
+
+      job.is_zstd = is_zstd;
+      job.in = input_buffer;
+      job.in_size = uncompressed_size;
+      job.chunk = nchunks > 1 ? COMPRESS_CHUNK_SIZE : uncompressed_size;
+      job.out = buffer + new_header_size;
+      job.slot = slot;
+      job.sizes = &size;
+      if (nchunks > 1)
 	{
-#if HAVE_ZSTD
-	  compressed_size = ZSTD_compress (buffer + new_header_size,
-					   compressed_size,
-					   input_buffer,
-					   uncompressed_size,
-					   ZSTD_CLEVEL_DEFAULT);
-	  if (ZSTD_isError (compressed_size))
+	  job.sizes = bfd_malloc (nchunks * sizeof (*job.sizes));
+	  if (job.sizes == NULL)
 	    {
 	      bfd_release (abfd, buffer);
-	      bfd_set_error (bfd_error_bad_value);
 	      return 0;
 	    }
-#endif
+	  ok = _bfd_parallel_for (nchunks, 1, compress_chunk_range, &job);
 	}
-      else if (compress ((Bytef *) buffer + new_header_size, &compressed_size,
-			 (const Bytef *) input_buffer, uncompressed_size)
-	       != Z_OK)
+      else
+	ok = compress_chunk_range (&job, 0, 1);
+      if (!ok)
 	{
+	  if (nchunks > 1)
+	    free (job.sizes);
 	  bfd_release (abfd, buffer);
-	  bfd_set_error (bfd_error_bad_value);
 	  return 0;
 	}
 
-      compressed_size += new_header_size;
+      compressed_size = new_header_size;
+      for (i = 0; i < nchunks; i++)
+	{
+	  memmove (buffer + compressed_size, job.out + i * slot,
+		   job.sizes[i]);
+	  compressed_size += job.sizes[i];
+	}
+      if (nchunks > 1)
+	free (job.sizes);
     }
 
+ done:
   /* If compression didn't make the section smaller, keep it uncompressed.  */
   if (compressed_size >= uncompressed_size)
     {
@@ -696,130 +1142,536 @@ bfd_compress_section_contents (bfd *abfd, sec_ptr sec)
   return uncompressed_size;
 }
 
-/*
-FUNCTION
-	bfd_get_full_section_contents
+/* Read COUNT bytes at OFFSET of the compressed contents of SEC,
+   counting its compression header, into BUF.  */
 
-SYNOPSIS
-	bool bfd_get_full_section_contents
-	  (bfd *abfd, asection *section, bfd_byte **ptr);
+static bool
+read_compressed_contents (bfd *abfd, sec_ptr sec, bfd_byte *buf,
+			  file_ptr offset, bfd_size_type count)
+{
+  const unsigned int compress_status = sec->compress_status;
+  bfd_size_type save_rawsize = sec->rawsize;
+  bfd_size_type save_size = sec->size;
+  bool ret;
 
-DESCRIPTION
-	Read all data from @var{section} in BFD @var{abfd}, decompress
-	if needed, and store in @var{*ptr}.  If @var{*ptr} is NULL,
-	return @var{*ptr} with memory malloc'd by this function.
+  /* Clear rawsize, set size to compressed size and set compress_status
+     to COMPRESS_SECTION_NONE.  If the compressed size is bigger than
+     the uncompressed size, bfd_get_section_contents will fail.  */
+  sec->rawsize = 0;
+  sec->size = sec->compressed_size;
+  sec->compress_status = COMPRESS_SECTION_NONE;
+  ret = bfd_get_section_contents (abfd, sec, buf, offset, count);
+  /* Restore rawsize and size.  */
+  sec->rawsize = save_rawsize;
+  sec->size = save_size;
+  sec->compress_status = compress_status;
+  return ret;
+}
 
-	Return @code{TRUE} if the full section contents is retrieved
-	successfully.  If the section has no contents then this function
-	returns @code{TRUE} but @var{*ptr} is set to NULL.
-*/
+/* Decompress the READSZ bytes of SEC, a compressed section of ABFD,
+   into P.  */
 
-bool
-bfd_get_full_section_contents (bfd *abfd, sec_ptr sec, bfd_byte **ptr)
+static bool
+decompress_section (bfd *abfd, sec_ptr sec, bfd_byte *p,
+		    bfd_size_type readsz)
 {
-  bfd_size_type readsz = bfd_get_section_limit_octets (abfd, sec);
-  bfd_size_type allocsz = bfd_get_section_alloc_size (abfd, sec);
-  bfd_byte *p = *ptr;
-  bool ret;
-  bfd_size_type save_size;
-  bfd_size_type save_rawsize;
   bfd_byte *compressed_buffer;
   unsigned int compression_header_size;
-  const unsigned int compress_status = sec->compress_status;
+  bool is_zstd = sec->compress_status == DECOMPRESS_SECTION_ZSTD;
 
-  if (allocsz == 0)
+  /* Read in the full compressed section contents.  */
+  compressed_buffer = (bfd_byte *) bfd_malloc (sec->compressed_size);
+  if (compressed_buffer == NULL)
+    return false;
+  if (!read_compressed_contents (abfd, sec, compressed_buffer,
+				 0, sec->compressed_size))
     {
-      *ptr = NULL;
-      return true;
+      free (compressed_buffer);
+      return false;
     }
 
-  if (p == NULL
-      && compress_status != COMPRESS_SECTION_DONE
-      && _bfd_section_size_insane (abfd, sec))
+  compression_header_size = bfd_get_compression_header_size (abfd, sec);
+  if (compression_header_size == 0)
+    /* Set header size to the zlib header size if it is a
+       SHF_COMPRESSED section.  */
+    compression_header_size = 12;
+  if (!decompress_contents (is_zstd,
+			    compressed_buffer + compression_header_size,
+			    sec->compressed_size - compression_header_size,
+			    p, readsz))
     {
-      /* PR 24708: Avoid attempts to allocate a ridiculous amount
-	 of memory.  */
-      _bfd_error_handler
-	/* xgettext:c-format */
-	(_("error: %pB(%pA) is too large (%#" PRIx64 " bytes)"),
-	 abfd, sec, (uint64_t) readsz);
+      bfd_set_error (bfd_error_bad_value);
+      free (compressed_buffer);
       return false;
     }
 
-  switch (compress_status)
-    {
-    case COMPRESS_SECTION_NONE:
-      if (p == NULL)
-	{
-	  p = (bfd_byte *) bfd_malloc (allocsz);
-	  if (p == NULL)
-	    {
-	      /* PR 20801: Provide a more helpful error message.  */
-	      if (bfd_get_error () == bfd_error_no_memory)
-		_bfd_error_handler
-		  /* xgettext:c-format */
-		  (_("error: %pB(%pA) is too large (%#" PRIx64 " bytes)"),
-		  abfd, sec, (uint64_t) allocsz);
-	      return false;
-	    }
-	}
+  free (compressed_buffer);
+  _bfd_hook (bfd_hook_decompress, abfd, sec, NULL, sec->compressed_size,
+	     readsz);
+  return true;
+}
 
-      if (!bfd_get_section_contents (abfd, sec, p, 0, readsz))
-	{
-	  if (*ptr != p)
-	    free (p);
-	  return false;
-	}
-      *ptr = p;
-      return true;
+/* Section contents kept by bfd_get_cached_section_contents, most
+   recently used first: decompressed sections, and copies of those
+   that could not be mapped from the file.  Entries no one holds are
+   freed, least recently used first, once the total size goes over
+   section_cache_limit.  */
 
-    case DECOMPRESS_SECTION_ZLIB:
-    case DECOMPRESS_SECTION_ZSTD:
-      /* Read in the full compressed section contents.  */
-      compressed_buffer = (bfd_byte *) bfd_malloc (sec->compressed_size);
-      if (compressed_buffer == NULL)
-	return false;
-      save_rawsize = sec->rawsize;
-      save_size = sec->size;
-      /* Clear rawsize, set size to compressed size and set compress_status
-	 to COMPRESS_SECTION_NONE.  If the compressed size is bigger than
-	 the uncompressed size, bfd_get_section_contents will fail.  */
-      sec->rawsize = 0;
-      sec->size = sec->compressed_size;
-      sec->compress_status = COMPRESS_SECTION_NONE;
-      ret = bfd_get_section_contents (abfd, sec, compressed_buffer,
-				      0, sec->compressed_size);
-      /* Restore rawsize and size.  */
-      sec->rawsize = save_rawsize;
-      sec->size = save_size;
-      sec->compress_status = compress_status;
-      if (!ret)
-	goto fail_compressed;
+struct section_cache_entry
+{
+  struct section_cache_entry *prev;
+  struct section_cache_entry *next;
+  bfd *abfd;
+  asection *sec;
+  bfd_byte *data;
+  bfd_size_type size;
+
+  /* How many bfd_get_cached_section_contents calls have yet to be
+     matched by a release.  */
+  unsigned int refs;
+};
 
-      if (p == NULL)
-	p = (bfd_byte *) bfd_malloc (allocsz);
-      if (p == NULL)
-	goto fail_compressed;
+static bfd_mutex section_cache_lock = BFD_MUTEX_INIT;
+static struct section_cache_entry *section_cache_head;
+static struct section_cache_entry *section_cache_tail;
+static bfd_size_type section_cache_used;
+static bfd_size_type section_cache_limit = 64 * 1024 * 1024;
 
-      compression_header_size = bfd_get_compression_header_size (abfd, sec);
-      if (compression_header_size == 0)
-	/* Set header size to the zlib header size if it is a
-	   SHF_COMPRESSED section.  */
-	compression_header_size = 12;
-      bool is_zstd = compress_status == DECOMPRESS_SECTION_ZSTD;
-      if (!decompress_contents (
-	      is_zstd, compressed_buffer + compression_header_size,
-	      sec->compressed_size - compression_header_size, p, readsz))
-	{
-	  bfd_set_error (bfd_error_bad_value);
-	  if (p != *ptr)
-	    free (p);
-	fail_compressed:
-	  free (compressed_buffer);
+/* Take ENTRY off the cache list.  */
+
+static void
+section_cache_unlink (struct section_cache_entry *entry)
+{
+  if (entry->prev != NULL)
+    entry->prev->next = entry->next;
+  else
+    section_cache_head = entry->next;
+  if (entry->next != NULL)
+    entry->next->prev = entry->prev;
+  else
+    section_cache_tail = entry->prev;
+}
+
+/* Put ENTRY at the front of the cache list.  */
+
+static void
+section_cache_push (struct section_cache_entry *entry)
+{
+  entry->prev = NULL;
+  entry->next = section_cache_head;
+  if (section_cache_head != NULL)
+    section_cache_head->prev = entry;
+  else
+    section_cache_tail = entry;
+  section_cache_head = entry;
+}
+
+/* Remove ENTRY from the cache and free it.  */
+
+static void
+section_cache_free (struct section_cache_entry *entry)
+{
+  section_cache_unlink (entry);
+  section_cache_used -= entry->size;
+  free (entry->data);
+  free (entry);
+}
+
+/* Free the least recently used entries no one holds until the cache
+   fits its limit.  Called with section_cache_lock held.  */
+
+static void
+section_cache_trim (void)
+{
+  struct section_cache_entry *entry, *prev;
+
+  for (entry = section_cache_tail;
+       entry != NULL && section_cache_used > section_cache_limit;
+       entry = prev)
+    {
+      prev = entry->prev;
+      if (entry->refs == 0)
+	section_cache_free (entry);
+    }
+}
+
+/* Return the cache entry for SEC of ABFD, or NULL.  Called with
+   section_cache_lock held.  */
+
+static struct section_cache_entry *
+section_cache_find (bfd *abfd, asection *sec)
+{
+  struct section_cache_entry *entry;
+
+  for (entry = section_cache_head; entry != NULL; entry = entry->next)
+    if (entry->abfd == abfd && entry->sec == sec)
+      return entry;
+  return NULL;
+}
+
+/* If SEC of ABFD is in the cache, take a hold on it and return its
+   contents, otherwise return NULL.  */
+
+static const bfd_byte *
+section_cache_hold (bfd *abfd, asection *sec)
+{
+  struct section_cache_entry *entry;
+  const bfd_byte *data = NULL;
+
+  _bfd_mutex_lock (&section_cache_lock);
+  entry = section_cache_find (abfd, sec);
+  if (entry != NULL)
+    {
+      entry->refs++;
+      section_cache_unlink (entry);
+      section_cache_push (entry);
+      data = entry->data;
+    }
+  _bfd_mutex_unlock (&section_cache_lock);
+  return data;
+}
+
+/* Copy COUNT bytes at OFFSET of the decompressed contents of SEC, a
+   compressed section of ABFD, to P, going through the cache unless
+   the section is too big for it.  */
+
+static bool
+section_cache_read (bfd *abfd, sec_ptr sec, bfd_byte *p,
+		    bfd_size_type offset, bfd_size_type count)
+{
+  const bfd_byte *data;
+
+  if (bfd_get_section_limit_octets (abfd, sec) > section_cache_limit)
+    {
+      bfd_byte *buf;
+
+      if (offset == 0 && count == bfd_get_section_limit_octets (abfd, sec))
+	return decompress_section (abfd, sec, p, count);
+      buf = bfd_malloc (bfd_get_section_limit_octets (abfd, sec));
+      if (buf == NULL)
+	return false;
+      if (!decompress_section (abfd, sec, buf,
+			       bfd_get_section_limit_octets (abfd, sec)))
+	{
+	  free (buf);
 	  return false;
 	}
+      memcpy (p, buf + offset, count);
+      free (buf);
+      return true;
+    }
 
-      free (compressed_buffer);
+  if (!bfd_get_cached_section_contents (abfd, sec, &data))
+    return false;
+  memcpy (p, data + offset, count);
+  bfd_release_cached_section_contents (abfd, sec);
+  return true;
+}
+
+/* Return a view of SEC of ABFD that is already owned by ABFD, or
+   else map the on-disk contents if the section can be read straight
+   from the file.  Return NULL if neither can be done.  */
+
+static const bfd_byte *
+section_view_or_map (bfd *abfd, asection *sec)
+{
+  const bfd_byte *view = _bfd_section_view (abfd, sec);
+
+  if (view == NULL
+      && sec->compress_status == COMPRESS_SECTION_NONE
+      && (sec->flags & (SEC_HAS_CONTENTS | SEC_IN_MEMORY
+			| SEC_CONSTRUCTOR)) == SEC_HAS_CONTENTS
+      && (abfd->xvec->_bfd_get_section_contents
+	  == _bfd_generic_get_section_contents))
+    view = _bfd_mmap_section_contents (abfd, sec);
+  return view;
+}
+
+/*
+FUNCTION
+	bfd_set_section_cache_size
+
+SYNOPSIS
+	bfd_size_type bfd_set_section_cache_size (bfd_size_type size);
+
+DESCRIPTION
+	Let the section contents kept by
+	<<bfd_get_cached_section_contents>>, so that reading them again
+	doesn't decompress or read them again, take up to @var{size}
+	bytes in all, counting every open BFD.  Zero stops sections
+	being kept once they are released.  The default is 64 MiB.
+	Compressed sections bigger than the limit are decompressed
+	afresh each time they are read.  Returns the previous setting.
+*/
+
+bfd_size_type
+bfd_set_section_cache_size (bfd_size_type size)
+{
+  bfd_size_type old;
+
+  _bfd_mutex_lock (&section_cache_lock);
+  old = section_cache_limit;
+  section_cache_limit = size;
+  section_cache_trim ();
+  _bfd_mutex_unlock (&section_cache_lock);
+  return old;
+}
+
+/*
+FUNCTION
+	bfd_get_cached_section_contents
+
+SYNOPSIS
+	bool bfd_get_cached_section_contents
+	  (bfd *abfd, asection *section, const bfd_byte **ptr);
+
+DESCRIPTION
+	Store in @var{*ptr} the full contents of @var{section} in BFD
+	@var{abfd}, decompressed if needed.  Contents already in
+	memory, or that can be mapped from the file, are given as they
+	are.  Otherwise the section is decompressed or read into a
+	cache shared by all BFDs, the first time it is asked for, and
+	stays there while it is held and for as long as
+	<<bfd_set_section_cache_size>> allows after that.  The memory
+	must not be modified, and stays valid until the matching
+	<<bfd_release_cached_section_contents>>, which must be called
+	however the contents were given.
+
+	Return @code{TRUE} on success.  If the section has no contents
+	then this function returns @code{TRUE} but @var{*ptr} is set to
+	NULL.
+*/
+
+bool
+bfd_get_cached_section_contents (bfd *abfd, sec_ptr sec,
+				 const bfd_byte **ptr)
+{
+  struct section_cache_entry *entry;
+  bfd_size_type size;
+  bfd_byte *data;
+  bool compressed = (sec->compress_status == DECOMPRESS_SECTION_ZLIB
+		     || sec->compress_status == DECOMPRESS_SECTION_ZSTD);
+
+  if (!compressed && sec->compress_status != COMPRESS_SECTION_NONE)
+    return bfd_get_section_contents_view (abfd, sec, ptr);
+
+  *ptr = NULL;
+  size = bfd_get_section_limit_octets (abfd, sec);
+  if (size == 0)
+    return true;
+
+  if (!compressed)
+    {
+      if ((sec->flags & (SEC_HAS_CONTENTS | SEC_IN_MEMORY))
+	  == (SEC_HAS_CONTENTS | SEC_IN_MEMORY)
+	  && sec->contents != NULL)
+	*ptr = sec->contents;
+      else
+	*ptr = section_view_or_map (abfd, sec);
+      if (*ptr != NULL)
+	return true;
+    }
+
+  *ptr = section_cache_hold (abfd, sec);
+  if (*ptr != NULL)
+    return true;
+
+  if (_bfd_section_size_insane (abfd, sec))
+    {
+      _bfd_error_handler
+	/* xgettext:c-format */
+	(_("error: %pB(%pA) is too large (%#" PRIx64 " bytes)"),
+	 abfd, sec, (uint64_t) size);
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+  data = bfd_malloc (size);
+  if (data == NULL)
+    return false;
+  if (compressed
+      ? !decompress_section (abfd, sec, data, size)
+      : !bfd_get_section_contents (abfd, sec, data, 0, size))
+    {
+      free (data);
+      return false;
+    }
+
+  /* Another thread may have put the section in the cache while this
+     one was reading it.  */
+  _bfd_mutex_lock (&section_cache_lock);
+  entry = section_cache_find (abfd, sec);
+  if (entry != NULL)
+    free (data);
+  else
+    {
+      entry = bfd_malloc (sizeof (*entry));
+      if (entry == NULL)
+	{
+	  _bfd_mutex_unlock (&section_cache_lock);
+	  free (data);
+	  return false;
+	}
+      entry->abfd = abfd;
+      entry->sec = sec;
+      entry->data = data;
+      entry->size = size;
+      entry->refs = 0;
+      section_cache_push (entry);
+      section_cache_used += size;
+    }
+  entry->refs++;
+  *ptr = entry->data;
+  section_cache_trim ();
+  _bfd_mutex_unlock (&section_cache_lock);
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_release_cached_section_contents
+
+SYNOPSIS
+	void bfd_release_cached_section_contents
+	  (bfd *abfd, asection *section);
+
+DESCRIPTION
+	Say that the contents of @var{section} in BFD @var{abfd} given
+	by a call of <<bfd_get_cached_section_contents>> are no longer
+	needed.
+*/
+
+void
+bfd_release_cached_section_contents (bfd *abfd, sec_ptr sec)
+{
+  struct section_cache_entry *entry;
+
+  if (sec->compress_status != DECOMPRESS_SECTION_ZLIB
+      && sec->compress_status != DECOMPRESS_SECTION_ZSTD
+      && sec->compress_status != COMPRESS_SECTION_NONE)
+    return;
+
+  _bfd_mutex_lock (&section_cache_lock);
+  entry = section_cache_find (abfd, sec);
+  if (entry != NULL && entry->refs != 0)
+    {
+      entry->refs--;
+      if (entry->refs == 0)
+	section_cache_trim ();
+    }
+  _bfd_mutex_unlock (&section_cache_lock);
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_section_cache_drop
+
+SYNOPSIS
+	void _bfd_section_cache_drop (bfd *abfd);
+
+DESCRIPTION
+	Free the cached decompressed contents of the sections of
+	@var{abfd}, whose sections are about to go away.
+*/
+
+void
+_bfd_section_cache_drop (bfd *abfd)
+{
+  struct section_cache_entry *entry, *next;
+
+  _bfd_mutex_lock (&section_cache_lock);
+  for (entry = section_cache_head; entry != NULL; entry = next)
+    {
+      next = entry->next;
+      if (entry->abfd == abfd)
+	section_cache_free (entry);
+    }
+  _bfd_mutex_unlock (&section_cache_lock);
+}
+
+/*
+FUNCTION
+	bfd_get_full_section_contents
+
+SYNOPSIS
+	bool bfd_get_full_section_contents
+	  (bfd *abfd, asection *section, bfd_byte **ptr);
+
+DESCRIPTION
+	Read all data from @var{section} in BFD @var{abfd}, decompress
+	if needed, and store in @var{*ptr}.  If @var{*ptr} is NULL,
+	return @var{*ptr} with memory malloc'd by this function.
+
+	Return @code{TRUE} if the full section contents is retrieved
+	successfully.  If the section has no contents then this function
+	returns @code{TRUE} but @var{*ptr} is set to NULL.
+*/
+
+bool
+bfd_get_full_section_contents (bfd *abfd, sec_ptr sec, bfd_byte **ptr)
+{
+  bfd_size_type readsz = bfd_get_section_limit_octets (abfd, sec);
+  bfd_size_type allocsz = bfd_get_section_alloc_size (abfd, sec);
+  bfd_byte *p = *ptr;
+  const unsigned int compress_status = sec->compress_status;
+
+  if (allocsz == 0)
+    {
+      *ptr = NULL;
+      return true;
+    }
+
+  if (p == NULL
+      && compress_status != COMPRESS_SECTION_DONE
+      && _bfd_section_size_insane (abfd, sec))
+    {
+      /* PR 24708: Avoid attempts to allocate a ridiculous amount
+	 of memory.  */
+      _bfd_error_handler
+	/* xgettext:c-format */
+	(_("error: %pB(%pA) is too large (%#" PRIx64 " bytes)"),
+	 abfd, sec, (uint64_t) readsz);
+      return false;
+    }
+
+  switch (compress_status)
+    {
+    case COMPRESS_SECTION_NONE:
+      if (p == NULL)
+	{
+	  p = (bfd_byte *) bfd_malloc (allocsz);
+	  if (p == NULL)
+	    {
+	      /* PR 20801: Provide a more helpful error message.  */
+	      if (bfd_get_error () == bfd_error_no_memory)
+		_bfd_error_handler
+		  /* xgettext:c-format */
+		  (_("error: %pB(%pA) is too large (%#" PRIx64 " bytes)"),
+		  abfd, sec, (uint64_t) allocsz);
+	      return false;
+	    }
+	}
+
+      if (!bfd_get_section_contents (abfd, sec, p, 0, readsz))
+	{
+	  if (*ptr != p)
+	    free (p);
+	  return false;
+	}
+      *ptr = p;
+      return true;
+
+    case DECOMPRESS_SECTION_ZLIB:
+    case DECOMPRESS_SECTION_ZSTD:
+      if (p == NULL)
+	p = (bfd_byte *) bfd_malloc (allocsz);
+      if (p == NULL)
+	return false;
+      if (!section_cache_read (abfd, sec, p, 0, readsz))
+	{
+	  if (p != *ptr)
+	    free (p);
+	  return false;
+	}
       *ptr = p;
       return true;
 
@@ -843,6 +1695,879 @@ bfd_get_full_section_contents (bfd *abfd, sec_ptr sec, bfd_byte **ptr)
     }
 }
 
+/*
+FUNCTION
+	bfd_get_section_contents_view
+
+SYNOPSIS
+	bool bfd_get_section_contents_view
+	  (bfd *abfd, asection *section, const bfd_byte **ptr);
+
+DESCRIPTION
+	Store in @var{*ptr} a read-only view of the full contents of
+	@var{section} in BFD @var{abfd}, decompressed if needed.  The
+	memory belongs to @var{abfd}: it must not be modified or freed,
+	and it stays valid until @var{abfd} is closed.  Large uncompressed
+	sections of files read through the file cache are mapped with
+	<<bfd_mmap>> rather than being copied, and those of a file
+	mapped by <<bfd_map_file_image>> point into its mapping.
+
+	Return @code{TRUE} on success.  If the section has no contents
+	then this function returns @code{TRUE} but @var{*ptr} is set to
+	NULL.
+*/
+
+bool
+bfd_get_section_contents_view (bfd *abfd, sec_ptr sec, const bfd_byte **ptr)
+{
+  const bfd_byte *view;
+  bfd_byte *p;
+
+  *ptr = NULL;
+  if (bfd_get_section_alloc_size (abfd, sec) == 0)
+    return true;
+
+  view = section_view_or_map (abfd, sec);
+  if (view == NULL)
+    {
+      p = NULL;
+      if (!bfd_get_full_section_contents (abfd, sec, &p))
+	return false;
+      if (!_bfd_add_section_view (abfd, sec, p))
+	{
+	  free (p);
+	  return false;
+	}
+      view = p;
+    }
+
+  *ptr = view;
+  return true;
+}
+
+/* Return the frame index of SEC, a compressed section of ABFD,
+   building it if this is the first time it is asked for.  Return
+   NULL on error.  */
+
+static struct bfd_frame_index *
+get_frame_index (bfd *abfd, sec_ptr sec, unsigned int header_size)
+{
+  struct bfd_frame_index *index;
+  size_t count = 0;
+  bfd_byte *buf = NULL;
+
+  for (index = abfd->frame_indexes; index != NULL; index = index->next)
+    if (index->section == sec)
+      return index;
+
+#ifdef HAVE_ZSTD
+  /* zlib streams don't say how long they are, so only zstd sections
+     can be split up without decompressing them.  */
+  if (sec->compress_status == DECOMPRESS_SECTION_ZSTD)
+    {
+      buf = bfd_malloc (sec->compressed_size);
+      if (buf == NULL)
+	return NULL;
+      if (!read_compressed_contents (abfd, sec, buf, 0, sec->compressed_size))
+	{
+	  free (buf);
+	  return NULL;
+	}
+      count = zstd_scan_frames (buf + header_size,
+				sec->compressed_size - header_size,
+				sec->size, NULL);
+    }
+#endif
+
+  index = bfd_alloc (abfd, sizeof (*index) + count * sizeof (index->frames[0]));
+  if (index == NULL)
+    {
+      free (buf);
+      return NULL;
+    }
+  index->section = sec;
+  index->count = count;
+#ifdef HAVE_ZSTD
+  if (count != 0)
+    zstd_scan_frames (buf + header_size, sec->compressed_size - header_size,
+		      sec->size, index->frames);
+#endif
+  free (buf);
+  index->next = abfd->frame_indexes;
+  abfd->frame_indexes = index;
+  return index;
+}
+
+#ifdef HAVE_ZSTD
+/* Decompress the COUNT bytes at OFFSET of SEC, a zstd section of
+   ABFD split into frames by INDEX, into LOCATION.  Only the frames
+   holding those bytes are read and decompressed.  */
+
+static bool
+get_frame_contents (bfd *abfd, sec_ptr sec, struct bfd_frame_index *index,
+		    unsigned int header_size, bfd_byte *location,
+		    bfd_size_type offset, bfd_size_type count)
+{
+  const struct compressed_frame *first, *last, *f;
+  bfd_size_type end = offset + count;
+  bfd_size_type in_size;
+  bfd_byte *in, *scratch = NULL;
+  ZSTD_DCtx *dctx;
+  size_t lo, hi;
+  bool ret = true;
+
+  /* Find the first frame ending after OFFSET, and the last starting
+     before END.  */
+  lo = 0;
+  hi = index->count;
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+
+      if (index->frames[mid].out_offset + index->frames[mid].out_size
+	  <= offset)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  first = &index->frames[lo];
+  for (last = first;
+       last + 1 < index->frames + index->count
+	 && last[1].out_offset < end;
+       last++)
+    ;
+
+  in_size = last->in_offset + last->in_size - first->in_offset;
+  in = bfd_malloc (in_size);
+  if (in == NULL)
+    return false;
+  if (!read_compressed_contents (abfd, sec, in,
+				 header_size + first->in_offset, in_size))
+    {
+      free (in);
+      return false;
+    }
+
+  dctx = get_zstd_dctx ();
+  if (dctx == NULL)
+    {
+      free (in);
+      bfd_set_error (bfd_error_no_memory);
+      return false;
+    }
+  for (f = first; ret && f <= last; f++)
+    {
+      bfd_size_type start = offset > f->out_offset ? offset : f->out_offset;
+      bfd_size_type stop = f->out_offset + f->out_size;
+      bfd_byte *out;
+      size_t n;
+
+      if (stop > end)
+	stop = end;
+      /* Frames wholly inside the range go straight to LOCATION;
+	 others are decompressed aside and the part wanted copied.  */
+      if (start == f->out_offset && stop == f->out_offset + f->out_size)
+	out = location + (start - offset);
+      else
+	{
+	  if (scratch == NULL)
+	    scratch = bfd_malloc (first->out_size > last->out_size
+				  ? first->out_size : last->out_size);
+	  if (scratch == NULL)
+	    {
+	      ret = false;
+	      break;
+	    }
+	  out = scratch;
+	}
+      n = ZSTD_decompressDCtx (dctx, out, f->out_size,
+			       in + (f->in_offset - first->in_offset),
+			       f->in_size);
+      if (ZSTD_isError (n) || n != f->out_size)
+	{
+	  bfd_set_error (bfd_error_bad_value);
+	  ret = false;
+	}
+      else if (out == scratch)
+	memcpy (location + (start - offset),
+		scratch + (start - f->out_offset), stop - start);
+    }
+  put_zstd_dctx (dctx);
+  free (scratch);
+  free (in);
+  return ret;
+}
+#endif
+
+/*
+FUNCTION
+	bfd_get_decompressed_section_contents
+
+SYNOPSIS
+	bool bfd_get_decompressed_section_contents
+	  (bfd *abfd, asection *section, void *location,
+	   file_ptr offset, bfd_size_type count);
+
+DESCRIPTION
+	Read @var{count} bytes at @var{offset} of the decompressed
+	contents of @var{section} in BFD @var{abfd} into
+	@var{location}.  For a section that isn't being decompressed
+	this is the same as <<bfd_get_section_contents>>.  A zstd
+	section made of several frames, as written by a BFD that was
+	allowed several threads, has only the frames holding the bytes
+	asked for read and decompressed; the first call builds an index
+	of the frames.  Other compressed sections are decompressed in
+	full, through the cache <<bfd_get_cached_section_contents>>
+	uses.
+
+	Return @code{TRUE} on success.
+*/
+
+bool
+bfd_get_decompressed_section_contents (bfd *abfd, sec_ptr sec,
+				       void *location, file_ptr offset,
+				       bfd_size_type count)
+{
+  struct bfd_frame_index *index;
+  unsigned int header_size;
+  const bfd_byte *view;
+
+  if (sec->compress_status != DECOMPRESS_SECTION_ZLIB
+      && sec->compress_status != DECOMPRESS_SECTION_ZSTD)
+    return bfd_get_section_contents (abfd, sec, location, offset, count);
+
+  if (offset < 0
+      || (bfd_size_type) offset + count < count
+      || (bfd_size_type) offset + count > sec->size)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+  if (count == 0)
+    return true;
+
+  view = _bfd_section_view (abfd, sec);
+  if (view != NULL)
+    {
+      memcpy (location, view + offset, count);
+      return true;
+    }
+
+  view = section_cache_hold (abfd, sec);
+  if (view != NULL)
+    {
+      memcpy (location, view + offset, count);
+      bfd_release_cached_section_contents (abfd, sec);
+      return true;
+    }
+
+  header_size = bfd_get_compression_header_size (abfd, sec);
+  if (header_size == 0)
+    header_size = 12;
+  index = get_frame_index (abfd, sec, header_size);
+  if (index == NULL)
+    return false;
+#ifdef HAVE_ZSTD
+  if (index->count != 0)
+    return get_frame_contents (abfd, sec, index, header_size, location,
+			       offset, count);
+#endif
+
+  return section_cache_read (abfd, sec, location, offset, count);
+}
+
+/* How much compressed data a bfd_section_stream reads at a time.  */
+#define SECTION_STREAM_INPUT_SIZE (64 * 1024)
+
+struct bfd_section_stream
+{
+  bfd *abfd;
+  asection *sec;
+
+  /* The size of the decompressed contents, and how much of them has
+     been returned.  */
+  bfd_size_type size;
+  bfd_size_type out_pos;
+
+  /* For a compressed section, how much of the compressed contents,
+     counting the header, has been read into INPUT, and the part of
+     INPUT not yet decompressed.  */
+  bfd_size_type in_pos;
+  bfd_byte *input;
+  const bfd_byte *next_in;
+  size_t avail_in;
+
+  bool is_zstd;
+  bool compressed;
+  bool failed;
+  /* Set if all the compressed contents were given to
+     open_memory_stream, so there is nothing more to read.  */
+  bool in_memory;
+  z_stream strm;
+#ifdef HAVE_ZSTD
+  ZSTD_DCtx *dctx;
+#endif
+};
+
+/* Read the next piece of the compressed contents of STREAM's
+   section into its buffer.  */
+
+static bool
+section_stream_fill (struct bfd_section_stream *stream)
+{
+  bfd_size_type count;
+
+  if (stream->in_memory)
+    count = 0;
+  else
+    count = stream->sec->compressed_size - stream->in_pos;
+  if (count > SECTION_STREAM_INPUT_SIZE)
+    count = SECTION_STREAM_INPUT_SIZE;
+  if (count == 0)
+    {
+      /* The section ended before its promised size.  */
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+  if (!read_compressed_contents (stream->abfd, stream->sec, stream->input,
+				 stream->in_pos, count))
+    return false;
+  stream->in_pos += count;
+  stream->next_in = stream->input;
+  stream->avail_in = count;
+  return true;
+}
+
+/* Get STREAM ready to decompress zstd data if IS_ZSTD, or else zlib
+   data.  */
+
+static bool
+section_stream_start (struct bfd_section_stream *stream, bool is_zstd)
+{
+  stream->compressed = true;
+  stream->is_zstd = is_zstd;
+  if (is_zstd)
+    {
+#ifdef HAVE_ZSTD
+      stream->dctx = get_zstd_dctx ();
+      if (stream->dctx != NULL)
+	{
+	  ZSTD_DCtx_reset (stream->dctx, ZSTD_reset_session_only);
+	  return true;
+	}
+#endif
+    }
+  else if (inflateInit (&stream->strm) == Z_OK)
+    return true;
+
+  bfd_set_error (bfd_error_no_memory);
+  return false;
+}
+
+/* Start reading the SIZE bytes that the IN_SIZE bytes of zstd data,
+   if IS_ZSTD, or else zlib data, at IN decompress to, as
+   bfd_read_section_stream does for a section.  IN must last until
+   the stream is closed.  */
+
+static struct bfd_section_stream *
+open_memory_stream (const bfd_byte *in, bfd_size_type in_size,
+		    bool is_zstd, bfd_size_type size)
+{
+  struct bfd_section_stream *stream;
+
+  stream = bfd_zmalloc (sizeof (*stream));
+  if (stream == NULL)
+    return NULL;
+  stream->size = size;
+  stream->in_memory = true;
+  stream->next_in = in;
+  stream->avail_in = in_size;
+  if (stream->avail_in != in_size
+      || !section_stream_start (stream, is_zstd))
+    {
+      free (stream);
+      return NULL;
+    }
+  return stream;
+}
+
+/*
+FUNCTION
+	bfd_open_section_stream
+
+SYNOPSIS
+	struct bfd_section_stream *bfd_open_section_stream
+	  (bfd *abfd, asection *section);
+
+DESCRIPTION
+	Start reading the contents of @var{section} in BFD @var{abfd}
+	from the beginning, decompressed if needed, with
+	<<bfd_read_section_stream>>.  A compressed section is read
+	from the file and decompressed a piece at a time, so neither
+	its compressed nor its decompressed contents are ever held in
+	full.  Returns NULL on error.
+*/
+
+struct bfd_section_stream *
+bfd_open_section_stream (bfd *abfd, sec_ptr sec)
+{
+  struct bfd_section_stream *stream;
+  unsigned int header_size;
+
+  stream = bfd_zmalloc (sizeof (*stream));
+  if (stream == NULL)
+    return NULL;
+  stream->abfd = abfd;
+  stream->sec = sec;
+  stream->size = sec->size;
+  if (sec->compress_status != DECOMPRESS_SECTION_ZLIB
+      && sec->compress_status != DECOMPRESS_SECTION_ZSTD)
+    return stream;
+
+  stream->input = bfd_malloc (SECTION_STREAM_INPUT_SIZE);
+  if (stream->input == NULL)
+    {
+      free (stream);
+      return NULL;
+    }
+  header_size = bfd_get_compression_header_size (abfd, sec);
+  if (header_size == 0)
+    header_size = 12;
+  stream->in_pos = header_size;
+
+  if (section_stream_start (stream,
+			    sec->compress_status == DECOMPRESS_SECTION_ZSTD))
+    return stream;
+
+  free (stream->input);
+  free (stream);
+  return NULL;
+}
+
+/*
+FUNCTION
+	bfd_read_section_stream
+
+SYNOPSIS
+	bfd_size_type bfd_read_section_stream
+	  (struct bfd_section_stream *stream, void *buf,
+	   bfd_size_type size);
+
+DESCRIPTION
+	Read up to @var{size} bytes of the contents of the section of
+	@var{stream} into @var{buf}, carrying on from where the last
+	read stopped.  Returns the number of bytes read, which is only
+	less than @var{size} at the end of the section, or
+	@code{(bfd_size_type) -1} on error.  Once a read has failed,
+	so does every later one.
+*/
+
+bfd_size_type
+bfd_read_section_stream (struct bfd_section_stream *stream, void *buf,
+			 bfd_size_type size)
+{
+  bfd_size_type total = stream->size;
+  bfd_byte *out = (bfd_byte *) buf;
+  bfd_size_type done = 0;
+
+  if (stream->failed)
+    return (bfd_size_type) -1;
+  if (size > total - stream->out_pos)
+    size = total - stream->out_pos;
+
+  if (!stream->compressed)
+    {
+      if (!bfd_get_section_contents (stream->abfd, stream->sec, buf,
+				     stream->out_pos, size))
+	{
+	  stream->failed = true;
+	  return (bfd_size_type) -1;
+	}
+      stream->out_pos += size;
+      return size;
+    }
+
+  while (done < size)
+    {
+      size_t want = size - done;
+      size_t got;
+
+      if (stream->avail_in == 0 && !section_stream_fill (stream))
+	goto fail;
+
+#ifdef HAVE_ZSTD
+      if (stream->is_zstd)
+	{
+	  ZSTD_inBuffer in = { stream->next_in, stream->avail_in, 0 };
+	  ZSTD_outBuffer zout = { out + done, want, 0 };
+	  size_t ret = ZSTD_decompressStream (stream->dctx, &zout, &in);
+
+	  if (ZSTD_isError (ret))
+	    {
+	      bfd_set_error (bfd_error_bad_value);
+	      goto fail;
+	    }
+	  stream->next_in += in.pos;
+	  stream->avail_in -= in.pos;
+	  got = zout.pos;
+	}
+      else
+#endif
+	{
+	  int rc;
+
+	  if (want > 0x40000000)
+	    want = 0x40000000;
+	  stream->strm.next_in = (Bytef *) stream->next_in;
+	  stream->strm.avail_in = stream->avail_in;
+	  stream->strm.next_out = (Bytef *) out + done;
+	  stream->strm.avail_out = want;
+	  rc = inflate (&stream->strm, Z_NO_FLUSH);
+	  got = want - stream->strm.avail_out;
+	  stream->next_in = stream->strm.next_in;
+	  stream->avail_in = stream->strm.avail_in;
+	  /* The section may consist of several compressed buffers
+	     concatenated together.  */
+	  if (rc == Z_STREAM_END)
+	    rc = inflateReset (&stream->strm);
+	  else if (rc == Z_BUF_ERROR && stream->avail_in == 0)
+	    rc = Z_OK;
+	  if (rc != Z_OK)
+	    {
+	      bfd_set_error (bfd_error_bad_value);
+	      goto fail;
+	    }
+	}
+      done += got;
+    }
+
+  stream->out_pos += done;
+  return done;
+
+ fail:
+  stream->failed = true;
+  return (bfd_size_type) -1;
+}
+
+/*
+FUNCTION
+	bfd_close_section_stream
+
+SYNOPSIS
+	void bfd_close_section_stream (struct bfd_section_stream *stream);
+
+DESCRIPTION
+	Free @var{stream}, which may be NULL.
+*/
+
+void
+bfd_close_section_stream (struct bfd_section_stream *stream)
+{
+  if (stream == NULL)
+    return;
+  if (stream->compressed)
+    {
+#ifdef HAVE_ZSTD
+      if (stream->is_zstd)
+	put_zstd_dctx (stream->dctx);
+      else
+#endif
+	inflateEnd (&stream->strm);
+      free (stream->input);
+    }
+  free (stream);
+}
+
+/* Where recompress_contents puts its result: SIZE bytes at BUF,
+   which has room for ALLOC and may grow to LIMIT.  FULL is set if
+   more than LIMIT would be needed.  */
+
+struct recompress_output
+{
+  bfd_byte *buf;
+  bfd_size_type size;
+  bfd_size_type alloc;
+  bfd_size_type limit;
+  bool full;
+};
+
+/* Make room for NEED more bytes in OUT.  */
+
+static bool
+recompress_reserve (struct recompress_output *out, bfd_size_type need)
+{
+  bfd_size_type alloc = out->alloc;
+  bfd_byte *buf;
+
+  if (need > out->limit - out->size)
+    {
+      out->full = true;
+      return false;
+    }
+  if (need <= alloc - out->size)
+    return true;
+  while (need > alloc - out->size)
+    alloc *= 2;
+  if (alloc > out->limit)
+    alloc = out->limit;
+  buf = bfd_realloc (out->buf, alloc);
+  if (buf == NULL)
+    return false;
+  out->buf = buf;
+  out->alloc = alloc;
+  return true;
+}
+
+#ifdef HAVE_ZSTD
+/* Compress the SIZE bytes read from STREAM into OUT as one zstd
+   frame, a COMPRESS_CHUNK_SIZE piece read into BUF at a time.  */
+
+static bool
+recompress_zstd (struct bfd_section_stream *stream, bfd_byte *buf,
+		 bfd_size_type size, struct recompress_output *out)
+{
+  ZSTD_CCtx *cctx = get_zstd_cctx ();
+  bfd_size_type done = 0;
+  bool ret = false;
+  size_t rc;
+
+  if (cctx == NULL)
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return false;
+    }
+  ZSTD_CCtx_reset (cctx, ZSTD_reset_session_and_parameters);
+  rc = ZSTD_CCtx_setParameter (cctx, ZSTD_c_compressionLevel,
+			       zstd_compression_level);
+  if (!ZSTD_isError (rc))
+    rc = ZSTD_CCtx_setPledgedSrcSize (cctx, size);
+
+  while (!ZSTD_isError (rc) && done < size)
+    {
+      bfd_size_type want = size - done;
+      ZSTD_EndDirective mode;
+      ZSTD_inBuffer in;
+
+      if (want > COMPRESS_CHUNK_SIZE)
+	want = COMPRESS_CHUNK_SIZE;
+      if (bfd_read_section_stream (stream, buf, want) != want)
+	goto out;
+      done += want;
+      mode = done == size ? ZSTD_e_end : ZSTD_e_continue;
+      in.src = buf;
+      in.size = want;
+      in.pos = 0;
+      do
+	{
+	  ZSTD_outBuffer zout;
+
+	  if (out->size == out->alloc && !recompress_reserve (out, 1))
+	    goto out;
+	  zout.dst = out->buf + out->size;
+	  zout.size = out->alloc - out->size;
+	  zout.pos = 0;
+	  rc = ZSTD_compressStream2 (cctx, &zout, &in, mode);
+	  out->size += zout.pos;
+	}
+      while (!ZSTD_isError (rc)
+	     && (mode == ZSTD_e_end ? rc != 0 : in.pos < in.size));
+    }
+
+  ret = !ZSTD_isError (rc);
+  if (!ret)
+    bfd_set_error (bfd_error_bad_value);
+ out:
+  put_zstd_cctx (cctx);
+  return ret;
+}
+#endif
+
+/* Compress the SIZE bytes read from STREAM into OUT as one zlib
+   stream, a COMPRESS_CHUNK_SIZE piece read into BUF at a time.  */
+
+static bool
+recompress_zlib (struct bfd_section_stream *stream, bfd_byte *buf,
+		 bfd_size_type size, struct recompress_output *out)
+{
+  bfd_size_type done = 0;
+  bool ret = false;
+  z_stream strm;
+  int flush;
+  int rc;
+
+  memset (&strm, 0, sizeof strm);
+  if (deflateInit (&strm, zlib_compression_level) != Z_OK)
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return false;
+    }
+
+  do
+    {
+      bfd_size_type want = size - done;
+
+      if (want > COMPRESS_CHUNK_SIZE)
+	want = COMPRESS_CHUNK_SIZE;
+      if (bfd_read_section_stream (stream, buf, want) != want)
+	goto out;
+      done += want;
+      flush = done == size ? Z_FINISH : Z_NO_FLUSH;
+      strm.next_in = (Bytef *) buf;
+      strm.avail_in = want;
+      do
+	{
+	  bfd_size_type avail;
+
+	  if (out->size == out->alloc && !recompress_reserve (out, 1))
+	    goto out;
+	  avail = out->alloc - out->size;
+	  if (avail > 0x40000000)
+	    avail = 0x40000000;
+	  strm.next_out = (Bytef *) out->buf + out->size;
+	  strm.avail_out = avail;
+	  rc = deflate (&strm, flush);
+	  out->size += avail - strm.avail_out;
+	}
+      while (rc == Z_OK && (flush == Z_FINISH || strm.avail_in != 0));
+    }
+  while (rc == Z_OK && done < size);
+
+  ret = rc == (flush == Z_FINISH ? Z_STREAM_END : Z_OK);
+  if (!ret)
+    bfd_set_error (bfd_error_bad_value);
+ out:
+  deflateEnd (&strm);
+  return ret;
+}
+
+/* Compress the SIZE bytes read from STREAM into OUT a batch of
+   COUNT pieces at a time, read into BUF and compressed on several
+   threads, each piece a zstd frame if IS_ZSTD or else a zlib stream
+   of its own, as bfd_compress_section_contents does.  */
+
+static bool
+recompress_pieces (struct bfd_section_stream *stream, bool is_zstd,
+		   bfd_byte *buf, size_t count, bfd_size_type size,
+		   struct recompress_output *out)
+{
+  struct compress_job job;
+  bfd_size_type done = 0;
+  bool ret = false;
+
+  job.is_zstd = is_zstd;
+  job.in = buf;
+  job.chunk = COMPRESS_CHUNK_SIZE;
+  job.slot = compress_bound (is_zstd, COMPRESS_CHUNK_SIZE);
+  job.out = bfd_malloc (count * job.slot);
+  job.sizes = bfd_malloc (count * sizeof (*job.sizes));
+  if (job.out == NULL || job.sizes == NULL)
+    goto out;
+
+  while (done < size)
+    {
+      bfd_size_type want = size - done;
+      size_t n, i;
+
+      if (want > count * COMPRESS_CHUNK_SIZE)
+	want = count * COMPRESS_CHUNK_SIZE;
+      if (bfd_read_section_stream (stream, buf, want) != want)
+	goto out;
+      done += want;
+      job.in_size = want;
+      n = (want + COMPRESS_CHUNK_SIZE - 1) / COMPRESS_CHUNK_SIZE;
+      if (!_bfd_parallel_for (n, 1, compress_chunk_range, &job))
+	goto out;
+      for (i = 0; i < n; i++)
+	{
+	  if (!recompress_reserve (out, job.sizes[i]))
+	    goto out;
+	  memcpy (out->buf + out->size, job.out + i * job.slot,
+		  job.sizes[i]);
+	  out->size += job.sizes[i];
+	}
+    }
+  ret = true;
+
+ out:
+  free (job.out);
+  free (job.sizes);
+  return ret;
+}
+
+/* Decompress the IN_SIZE bytes of zstd data, if IN_ZSTD, or else
+   zlib data, at IN to their UNCOMPRESSED_SIZE bytes, and compress
+   them again with zstd if IS_ZSTD, or else zlib, after HEADER_SIZE
+   bytes left for a compression header.  This goes a piece at a
+   time, so at most a piece per thread of the decompressed contents
+   is held at once rather than all of them.  On one thread the pieces
+   are fed to one compressor, which gives what compressing the whole
+   contents would.  Set *BUFFER to the result, allocated on ABFD, and
+   *SIZE to its size, or *BUFFER to NULL if that would not be smaller
+   than the decompressed contents.  */
+
+static bool
+recompress_contents (bfd *abfd, const bfd_byte *in, bfd_size_type in_size,
+		     bool in_zstd, bool is_zstd,
+		     bfd_size_type uncompressed_size,
+		     unsigned int header_size,
+		     bfd_byte **buffer, bfd_size_type *size)
+{
+  struct bfd_section_stream *stream;
+  struct recompress_output out;
+  size_t count = bfd_get_thread_count ();
+  bfd_byte *pieces;
+  bool ok = false;
+
+  *buffer = NULL;
+  if (uncompressed_size <= header_size)
+    return true;
+  stream = open_memory_stream (in, in_size, in_zstd, uncompressed_size);
+  if (stream == NULL)
+    return false;
+
+  if ((uncompressed_size + COMPRESS_CHUNK_SIZE - 1) / COMPRESS_CHUNK_SIZE
+      < count)
+    count = ((uncompressed_size + COMPRESS_CHUNK_SIZE - 1)
+	     / COMPRESS_CHUNK_SIZE);
+  out.limit = uncompressed_size;
+  out.alloc = header_size + COMPRESS_CHUNK_SIZE;
+  if (out.alloc > out.limit)
+    out.alloc = out.limit;
+  out.size = header_size;
+  out.full = false;
+  out.buf = bfd_malloc (out.alloc);
+  pieces = bfd_malloc (count * COMPRESS_CHUNK_SIZE);
+  if (out.buf != NULL && pieces != NULL)
+    {
+      if (count > 1)
+	ok = recompress_pieces (stream, is_zstd, pieces, count,
+				uncompressed_size, &out);
+#ifdef HAVE_ZSTD
+      else if (is_zstd)
+	ok = recompress_zstd (stream, pieces, uncompressed_size, &out);
+#endif
+      else
+	ok = recompress_zlib (stream, pieces, uncompressed_size, &out);
+      ok |= out.full;
+    }
+
+  if (ok && !out.full && out.size < uncompressed_size)
+    {
+      *buffer = bfd_alloc (abfd, out.size);
+      if (*buffer == NULL)
+	ok = false;
+      else
+	{
+	  memcpy (*buffer, out.buf, out.size);
+	  *size = out.size;
+	}
+    }
+  free (pieces);
+  free (out.buf);
+  bfd_close_section_stream (stream);
+  return ok;
+}
+
 /*
 FUNCTION
 	bfd_is_section_compressed_info
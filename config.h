@@ -232,12 +232,20 @@
 /* Define to 1 if you have the <sys/resource.h> header file. */
 #define HAVE_SYS_RESOURCE_H 1
 
+/* Define to 1 if you have the <sys/sdt.h> header file, to fire USDT
+   probes at BFD's hook points. */
+/* #undef HAVE_SYS_SDT_H */
+
 /* Define to 1 if you have the <sys/stat.h> header file. */
 #define HAVE_SYS_STAT_H 1
 
 /* Define to 1 if you have the <sys/types.h> header file. */
 #define HAVE_SYS_TYPES_H 1
 
+/* Define to 1 if you have the <TraceLoggingProvider.h> header file, to
+   write ETW events at BFD's hook points. */
+/* #undef HAVE_TRACELOGGINGPROVIDER_H */
+
 /* Define to 1 if you have the <unistd.h> header file. */
 /* #define HAVE_UNISTD_H */
 
@@ -248,7 +256,7 @@
 #define HAVE_WINDOWS_H 1
 
 /* Define to 1 if zstd is enabled. */
-/* #undef HAVE_ZSTD */
+#define HAVE_ZSTD 1
 
 /* Define to the sub-directory in which libtool stores uninstalled libraries.
    */
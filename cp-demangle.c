@@ -307,6 +307,25 @@ struct d_saved_scope
   struct d_print_template *templates;
 };
 
+/* Storage kept between calls of cplus_demangle_v3_context, so that
+   the arrays the demangler works in and the output are on the heap,
+   and once grown to fit are used again without allocating.  */
+
+struct demangle_context
+{
+  struct demangle_component *comps;
+  int alloc_comps;
+  struct demangle_component **subs;
+  int alloc_subs;
+  struct d_saved_scope *scopes;
+  int alloc_scopes;
+  struct d_print_template *templates;
+  int alloc_templates;
+  /* The last demangled name.  */
+  char *buf;
+  size_t alc;
+};
+
 /* Checkpoint structure to allow backtracking.  This holds copies
    of the fields of struct d_info that need to be restored
    if a trial parse needs to be backtracked over.  */
@@ -573,6 +592,9 @@ static void d_print_conversion (struct d_print_info *, int,
 
 static int d_demangle_callback (const char *, int,
                                 demangle_callbackref, void *);
+static int d_demangle_with_context (const char *, int,
+				    demangle_callbackref, void *,
+				    struct demangle_context *);
 static char *d_demangle (const char *, int, size_t *);
 
 #define FNQUAL_COMPONENT_CASE				\
@@ -4575,6 +4597,89 @@ d_last_char (struct d_print_info *dpi)
   return dpi->last_char;
 }
 
+/* Make room in PTR, an array of *ALLOC elements of SIZE bytes kept
+   in a demangle_context, for COUNT elements, and at least one.
+   Returns the array, or NULL on allocation failure.  */
+
+static void *
+d_context_reserve (void *ptr, int *alloc, int count, size_t size)
+{
+  int newalloc;
+
+  if (count <= *alloc && ptr != NULL)
+    return ptr;
+
+  newalloc = *alloc > 0 ? *alloc : 64;
+  while (newalloc < count)
+    newalloc *= 2;
+  ptr = realloc (ptr, newalloc * size);
+  if (ptr != NULL)
+    *alloc = newalloc;
+  return ptr;
+}
+
+/* As cplus_demangle_print_callback, with the scopes and templates
+   printing needs taken from CTX rather than the stack if CTX is not
+   NULL.  */
+
+static int
+d_print_with_context (int options, struct demangle_component *dc,
+		      demangle_callbackref callback, void *opaque,
+		      struct demangle_context *ctx)
+{
+  struct d_print_info dpi;
+
+  d_print_init (&dpi, callback, opaque, dc);
+
+  if (ctx != NULL)
+    {
+      struct d_saved_scope *scopes;
+      struct d_print_template *temps;
+
+      scopes = (struct d_saved_scope *)
+	d_context_reserve (ctx->scopes, &ctx->alloc_scopes,
+			   dpi.num_saved_scopes, sizeof (*scopes));
+      if (scopes == NULL)
+	return 0;
+      ctx->scopes = scopes;
+      temps = (struct d_print_template *)
+	d_context_reserve (ctx->templates, &ctx->alloc_templates,
+			   dpi.num_copy_templates, sizeof (*temps));
+      if (temps == NULL)
+	return 0;
+      ctx->templates = temps;
+
+      dpi.saved_scopes = scopes;
+      dpi.copy_templates = temps;
+      d_print_comp (&dpi, options, dc);
+    }
+  else
+    {
+#ifdef CP_DYNAMIC_ARRAYS
+      /* Avoid zero-length VLAs, which are prohibited by the C99 standard
+	 and flagged as errors by Address Sanitizer.  */
+      __extension__ struct d_saved_scope scopes[(dpi.num_saved_scopes > 0)
+						? dpi.num_saved_scopes : 1];
+      __extension__ struct d_print_template temps[(dpi.num_copy_templates > 0)
+						  ? dpi.num_copy_templates : 1];
+
+      dpi.saved_scopes = scopes;
+      dpi.copy_templates = temps;
+#else
+      dpi.saved_scopes = alloca (dpi.num_saved_scopes
+				 * sizeof (*dpi.saved_scopes));
+      dpi.copy_templates = alloca (dpi.num_copy_templates
+				   * sizeof (*dpi.copy_templates));
+#endif
+
+      d_print_comp (&dpi, options, dc);
+    }
+
+  d_print_flush (&dpi);
+
+  return ! d_print_saw_error (&dpi);
+}
+
 /* Turn components into a human readable string.  OPTIONS is the
    options bits passed to the demangler.  DC is the tree to print.
    CALLBACK is a function to call to flush demangled string segments
@@ -4590,34 +4695,7 @@ cplus_demangle_print_callback (int options,
                                struct demangle_component *dc,
                                demangle_callbackref callback, void *opaque)
 {
-  struct d_print_info dpi;
-
-  d_print_init (&dpi, callback, opaque, dc);
-
-  {
-#ifdef CP_DYNAMIC_ARRAYS
-    /* Avoid zero-length VLAs, which are prohibited by the C99 standard
-       and flagged as errors by Address Sanitizer.  */
-    __extension__ struct d_saved_scope scopes[(dpi.num_saved_scopes > 0)
-                                              ? dpi.num_saved_scopes : 1];
-    __extension__ struct d_print_template temps[(dpi.num_copy_templates > 0)
-                                                ? dpi.num_copy_templates : 1];
-
-    dpi.saved_scopes = scopes;
-    dpi.copy_templates = temps;
-#else
-    dpi.saved_scopes = alloca (dpi.num_saved_scopes
-			       * sizeof (*dpi.saved_scopes));
-    dpi.copy_templates = alloca (dpi.num_copy_templates
-				 * sizeof (*dpi.copy_templates));
-#endif
-
-    d_print_comp (&dpi, options, dc);
-  }
-
-  d_print_flush (&dpi);
-
-  return ! d_print_saw_error (&dpi);
+  return d_print_with_context (options, dc, callback, opaque, NULL);
 }
 
 /* Turn components into a human readable string.  OPTIONS is the
@@ -6728,6 +6806,18 @@ cplus_demangle_init_info (const char *mangled, int options, size_t len,
 static int
 d_demangle_callback (const char *mangled, int options,
                      demangle_callbackref callback, void *opaque)
+{
+  return d_demangle_with_context (mangled, options, callback, opaque, NULL);
+}
+
+/* As d_demangle_callback, with the arrays the demangler works in taken
+   from CTX rather than the stack if CTX is not NULL.  Names that are
+   not mangled are turned away before anything is set up.  */
+
+static int
+d_demangle_with_context (const char *mangled, int options,
+			 demangle_callbackref callback, void *opaque,
+			 struct demangle_context *ctx)
 {
   enum
     {
@@ -6776,15 +6866,33 @@ d_demangle_callback (const char *mangled, int options,
 
   {
 #ifdef CP_DYNAMIC_ARRAYS
-    __extension__ struct demangle_component comps[di.num_comps];
-    __extension__ struct demangle_component *subs[di.num_subs];
+    __extension__ struct demangle_component comps[ctx ? 1 : di.num_comps];
+    __extension__ struct demangle_component *subs[ctx ? 1 : di.num_subs];
 
     di.comps = comps;
     di.subs = subs;
 #else
-    di.comps = alloca (di.num_comps * sizeof (*di.comps));
-    di.subs = alloca (di.num_subs * sizeof (*di.subs));
+    if (ctx == NULL)
+      {
+	di.comps = alloca (di.num_comps * sizeof (*di.comps));
+	di.subs = alloca (di.num_subs * sizeof (*di.subs));
+      }
 #endif
+    if (ctx != NULL)
+      {
+	di.comps = (struct demangle_component *)
+	  d_context_reserve (ctx->comps, &ctx->alloc_comps,
+			     di.num_comps, sizeof (*di.comps));
+	if (di.comps == NULL)
+	  return 0;
+	ctx->comps = di.comps;
+	di.subs = (struct demangle_component **)
+	  d_context_reserve (ctx->subs, &ctx->alloc_subs,
+			     di.num_subs, sizeof (*di.subs));
+	if (di.subs == NULL)
+	  return 0;
+	ctx->subs = di.subs;
+      }
 
     switch (type)
       {
@@ -6828,7 +6936,7 @@ d_demangle_callback (const char *mangled, int options,
 #endif
 
     status = (dc != NULL)
-             ? cplus_demangle_print_callback (options, dc, callback, opaque)
+             ? d_print_with_context (options, dc, callback, opaque, ctx)
              : 0;
   }
 
@@ -7017,6 +7125,63 @@ cplus_demangle_v3_callback (const char *mangled, int options,
   return d_demangle_callback (mangled, options, callback, opaque);
 }
 
+/* Return a new context for cplus_demangle_v3_context, or NULL if out
+   of memory.  */
+
+struct demangle_context *
+cplus_demangle_context_new (void)
+{
+  return (struct demangle_context *)
+    calloc (1, sizeof (struct demangle_context));
+}
+
+/* Free CTX and the names demangled with it.  */
+
+void
+cplus_demangle_context_free (struct demangle_context *ctx)
+{
+  if (ctx == NULL)
+    return;
+  free (ctx->comps);
+  free (ctx->subs);
+  free (ctx->scopes);
+  free (ctx->templates);
+  free (ctx->buf);
+  free (ctx);
+}
+
+/* As cplus_demangle_v3, but working in the storage of CTX, which is
+   kept for the next call, so that demangling many names allocates
+   nothing once CTX has grown to fit them.  The demangled name is in a
+   buffer belonging to CTX, until the next call with CTX.  If PLEN is
+   not NULL, its length is stored in *PLEN.  Returns NULL if MANGLED
+   isn't a mangled name or on allocation failure.  */
+
+char *
+cplus_demangle_v3_context (struct demangle_context *ctx, const char *mangled,
+			   int options, size_t *plen)
+{
+  struct d_growable_string dgs;
+  int status;
+
+  dgs.buf = ctx->buf;
+  dgs.len = 0;
+  dgs.alc = ctx->alc;
+  dgs.allocation_failure = 0;
+
+  status = d_demangle_with_context (mangled, options,
+				    d_growable_string_callback_adapter, &dgs,
+				    ctx);
+  ctx->buf = dgs.buf;
+  ctx->alc = dgs.alc;
+  if (status == 0 || dgs.allocation_failure || dgs.buf == NULL)
+    return NULL;
+
+  if (plen != NULL)
+    *plen = dgs.len;
+  return dgs.buf;
+}
+
 /* Demangle a Java symbol.  Java uses a subset of the V3 ABI C++ mangling 
    conventions, but the output formatting is a little different.
    This instructs the C++ demangler not to emit pointer characters ("*"), to
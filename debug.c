@@ -30,6 +30,7 @@
 #include <assert.h>
 #include "bfd.h"
 #include "libiberty.h"
+#include "hashtab.h"
 #include "filenames.h"
 #include "bucomm.h"
 #include "debug.h"
@@ -65,6 +66,8 @@ struct debug_handle
   /* A list of classes which have assigned ID's during debug_write.
      This is linked through the next_id field of debug_class_type.  */
   struct debug_class_id *id_list;
+  /* The same classes, hashed by their kind, tag and structure.  */
+  htab_t id_table;
   /* A list used to avoid recursion during debug_type_samep.  */
   struct debug_type_compare_list *compare_list;
 };
@@ -441,8 +444,7 @@ struct debug_lineno
   bfd_vma addrs[DEBUG_LINENO_COUNT];
 };
 
-/* A namespace.  This is a mapping from names to objects.  FIXME: This
-   should be implemented as a hash table.  */
+/* A namespace.  This is a mapping from names to objects.  */
 
 struct debug_namespace
 {
@@ -450,8 +452,18 @@ struct debug_namespace
   struct debug_name *list;
   /* Pointer to where the next item in this namespace should go.  */
   struct debug_name **tail;
+  /* Number of items in this namespace, counted until names is built.  */
+  unsigned int count;
+  /* Hash table mapping a name to the first item with that name.  This
+     is only built once the namespace has DEBUG_NAMESPACE_INDEX_MIN
+     items, since most block namespaces are tiny.  */
+  htab_t names;
 };
 
+/* The size at which a namespace gets a hash table of its names.  */
+
+#define DEBUG_NAMESPACE_INDEX_MIN 16
+
 /* Kinds of objects that appear in a namespace.  */
 
 enum debug_object_kind
@@ -493,6 +505,9 @@ struct debug_name
 {
   /* Next name in this namespace.  */
   struct debug_name *next;
+  /* Next item with the same name in this namespace, if the namespace
+     has a hash table.  */
+  struct debug_name *name_next;
   /* Name.  */
   const char *name;
   /* Mark.  This is used by debug_write.  */
@@ -528,10 +543,14 @@ struct debug_class_id
 {
   /* Next ID number.  */
   struct debug_class_id *next;
+  /* Next ID number in the same slot of the id_table.  */
+  struct debug_class_id *hash_next;
   /* The type with the ID.  */
   struct debug_type_s *type;
   /* The tag; NULL if no tag.  */
   const char *tag;
+  /* Hash of the kind, tag and structure of type.  */
+  hashval_t hash;
 };
 
 /* During debug_type_samep, a linked list of these structures is kept
@@ -587,6 +606,8 @@ static bool debug_write_block
    struct debug_block *);
 static bool debug_write_linenos
   (struct debug_handle *, const struct debug_write_fns *, void *, bfd_vma);
+static hashval_t debug_class_id_hash (const void *);
+static int debug_class_id_eq (const void *, const void *);
 static bool debug_set_class_id
   (struct debug_handle *, const char *, struct debug_type_s *);
 static bool debug_type_samep
@@ -602,6 +623,100 @@ debug_error (const char *message)
   fprintf (stderr, "%s\n", message);
 }
 
+/* Allocate zeroed memory for a hash table on the objalloc of the bfd
+   ARG.  */
+
+static void *
+debug_htab_alloc (void *arg, size_t count, size_t size)
+{
+  bfd *abfd = (bfd *) arg;
+  void *mem = bfd_xalloc (abfd, count * size);
+  memset (mem, 0, count * size);
+  return mem;
+}
+
+/* Memory from debug_htab_alloc goes away with the bfd.  */
+
+static void
+debug_htab_free (void *arg ATTRIBUTE_UNUSED, void *ptr ATTRIBUTE_UNUSED)
+{
+}
+
+/* Hash and compare functions for the names in a namespace.  The
+   hash table holds debug_name entries and is searched by name.  */
+
+static hashval_t
+debug_name_hash (const void *p)
+{
+  const struct debug_name *n = (const struct debug_name *) p;
+
+  return htab_hash_string (n->name);
+}
+
+static int
+debug_name_eq (const void *p, const void *key)
+{
+  const struct debug_name *n = (const struct debug_name *) p;
+
+  return strcmp (n->name, (const char *) key) == 0;
+}
+
+/* Add N to the hash table of namespace NS.  Items with the same name
+   are chained in the order they were added.  */
+
+static void
+debug_index_name (struct debug_namespace *ns, struct debug_name *n)
+{
+  void **slot;
+  struct debug_name *p;
+
+  if (n->name == NULL)
+    return;
+
+  slot = htab_find_slot_with_hash (ns->names, n->name,
+				   htab_hash_string (n->name), INSERT);
+  if (*slot == NULL)
+    {
+      *slot = n;
+      return;
+    }
+
+  for (p = (struct debug_name *) *slot; p->name_next != NULL; p = p->name_next)
+    ;
+  p->name_next = n;
+}
+
+/* Find the first item called NAME of kind KIND in namespace NS.  For
+   DEBUG_OBJECT_TAG, TAG_KIND restricts the kind of the tagged type
+   unless it is DEBUG_KIND_ILLEGAL.  */
+
+static struct debug_name *
+debug_find_in_namespace (struct debug_namespace *ns, const char *name,
+			 enum debug_object_kind kind,
+			 enum debug_type_kind tag_kind)
+{
+  struct debug_name *n;
+
+  if (ns->names == NULL)
+    n = ns->list;
+  else
+    n = (struct debug_name *) htab_find_with_hash (ns->names, name,
+						   htab_hash_string (name));
+
+  for (; n != NULL; n = ns->names == NULL ? n->next : n->name_next)
+    {
+      if (n->kind == kind
+	  && (kind != DEBUG_OBJECT_TAG
+	      || tag_kind == DEBUG_KIND_ILLEGAL
+	      || n->u.tag->kind == tag_kind)
+	  && n->name[0] == name[0]
+	  && strcmp (n->name, name) == 0)
+	return n;
+    }
+
+  return NULL;
+}
+
 /* Add an object to a namespace.  */
 
 static struct debug_name *
@@ -632,6 +747,19 @@ debug_add_to_namespace (struct debug_handle *info,
   *ns->tail = n;
   ns->tail = &n->next;
 
+  if (ns->names != NULL)
+    debug_index_name (ns, n);
+  else if (++ns->count >= DEBUG_NAMESPACE_INDEX_MIN)
+    {
+      struct debug_name *p;
+
+      ns->names = htab_create_alloc_ex (ns->count * 2, debug_name_hash,
+					debug_name_eq, NULL, info->abfd,
+					debug_htab_alloc, debug_htab_free);
+      for (p = ns->list; p != NULL; p = p->next)
+	debug_index_name (ns, p);
+    }
+
   return n;
 }
 
@@ -1954,13 +2082,10 @@ debug_find_named_type (void *handle, const char *name)
 	{
 	  struct debug_name *n;
 
-	  for (n = b->locals->list; n != NULL; n = n->next)
-	    {
-	      if (n->kind == DEBUG_OBJECT_TYPE
-		  && n->name[0] == name[0]
-		  && strcmp (n->name, name) == 0)
-		return n->u.type;
-	    }
+	  n = debug_find_in_namespace (b->locals, name, DEBUG_OBJECT_TYPE,
+				       DEBUG_KIND_ILLEGAL);
+	  if (n != NULL)
+	    return n->u.type;
 	}
     }
 
@@ -1970,13 +2095,10 @@ debug_find_named_type (void *handle, const char *name)
 	{
 	  struct debug_name *n;
 
-	  for (n = f->globals->list; n != NULL; n = n->next)
-	    {
-	      if (n->kind == DEBUG_OBJECT_TYPE
-		  && n->name[0] == name[0]
-		  && strcmp (n->name, name) == 0)
-		return n->u.type;
-	    }
+	  n = debug_find_in_namespace (f->globals, name, DEBUG_OBJECT_TYPE,
+				       DEBUG_KIND_ILLEGAL);
+	  if (n != NULL)
+	    return n->u.type;
 	}
     }
 
@@ -2005,15 +2127,10 @@ debug_find_tagged_type (void *handle, const char *name,
 
 	  if (f->globals != NULL)
 	    {
-	      for (n = f->globals->list; n != NULL; n = n->next)
-		{
-		  if (n->kind == DEBUG_OBJECT_TAG
-		      && (kind == DEBUG_KIND_ILLEGAL
-			  || n->u.tag->kind == kind)
-		      && n->name[0] == name[0]
-		      && strcmp (n->name, name) == 0)
-		    return n->u.tag;
-		}
+	      n = debug_find_in_namespace (f->globals, name, DEBUG_OBJECT_TAG,
+					   kind);
+	      if (n != NULL)
+		return n->u.tag;
 	    }
 	}
     }
@@ -2325,6 +2442,9 @@ debug_write (void *handle, const struct debug_write_fns *fns, void *fhandle)
   /* We keep a linked list of classes for which was have assigned ID's
      during this call to debug_write.  */
   info->id_list = NULL;
+  info->id_table = htab_create_alloc_ex (64, debug_class_id_hash,
+					 debug_class_id_eq, NULL, info->abfd,
+					 debug_htab_alloc, debug_htab_free);
 
   for (u = info->units; u != NULL; u = u->next)
     {
@@ -2936,6 +3056,92 @@ debug_write_linenos (struct debug_handle *info,
   return true;
 }
 
+/* Hash the kind, tag and those parts of the definition of the class
+   TYPE which debug_class_type_samep compares directly.  Classes with
+   different hashes can never be the same.  */
+
+static hashval_t
+debug_class_type_hash (const char *tag, struct debug_type_s *type)
+{
+  struct debug_class_type *c = type->u.kclass;
+  hashval_t h;
+
+  h = iterative_hash_object (type->kind, 0);
+  h = iterative_hash_object (type->size, h);
+  if (tag != NULL)
+    h = iterative_hash (tag, strlen (tag), h);
+  if (c->vptrbase != NULL)
+    h = iterative_hash ("v", 1, h);
+
+  if (c->fields != NULL)
+    {
+      struct debug_field_s **pf;
+
+      for (pf = c->fields; *pf != NULL; pf++)
+	{
+	  struct debug_field_s *f = *pf;
+
+	  h = iterative_hash (f->name, strlen (f->name), h);
+	  h = iterative_hash_object (f->visibility, h);
+	  if (f->static_member)
+	    h = iterative_hash (f->u.s.physname, strlen (f->u.s.physname), h);
+	  else
+	    {
+	      h = iterative_hash_object (f->u.f.bitpos, h);
+	      h = iterative_hash_object (f->u.f.bitsize, h);
+	    }
+	}
+      h = iterative_hash ("f", 1, h);
+    }
+
+  if (c->baseclasses != NULL)
+    {
+      struct debug_baseclass_s **pb;
+
+      for (pb = c->baseclasses; *pb != NULL; pb++)
+	{
+	  h = iterative_hash_object ((*pb)->bitpos, h);
+	  h = iterative_hash_object ((*pb)->visibility, h);
+	}
+      h = iterative_hash ("b", 1, h);
+    }
+
+  if (c->methods != NULL)
+    {
+      struct debug_method_s **pm;
+
+      for (pm = c->methods; *pm != NULL; pm++)
+	h = iterative_hash ((*pm)->name, strlen ((*pm)->name), h);
+      h = iterative_hash ("m", 1, h);
+    }
+
+  return h;
+}
+
+/* Hash and compare functions for the id_table of debug_write.  Each
+   slot holds a chain of classes with the same hash, newest first, and
+   is searched with a debug_class_id holding the kind, tag and hash.  */
+
+static hashval_t
+debug_class_id_hash (const void *p)
+{
+  return ((const struct debug_class_id *) p)->hash;
+}
+
+static int
+debug_class_id_eq (const void *p1, const void *p2)
+{
+  const struct debug_class_id *l1 = (const struct debug_class_id *) p1;
+  const struct debug_class_id *l2 = (const struct debug_class_id *) p2;
+
+  if (l1->hash != l2->hash
+      || l1->type->kind != l2->type->kind)
+    return 0;
+  if (l1->tag == NULL || l2->tag == NULL)
+    return l1->tag == l2->tag;
+  return strcmp (l1->tag, l2->tag) == 0;
+}
+
 /* Get the ID number for a class.  If during the same call to
    debug_write we find a struct with the same definition with the same
    name, we use the same ID.  This type of things happens because the
@@ -2947,6 +3153,8 @@ debug_set_class_id (struct debug_handle *info, const char *tag,
 {
   struct debug_class_type *c;
   struct debug_class_id *l;
+  struct debug_class_id key;
+  void **slot;
 
   assert (type->kind == DEBUG_KIND_STRUCT
 	  || type->kind == DEBUG_KIND_UNION
@@ -2958,24 +3166,15 @@ debug_set_class_id (struct debug_handle *info, const char *tag,
   if (c->id > info->base_id)
     return true;
 
-  for (l = info->id_list; l != NULL; l = l->next)
-    {
-      if (l->type->kind != type->kind)
-	continue;
-
-      if (tag == NULL)
-	{
-	  if (l->tag != NULL)
-	    continue;
-	}
-      else
-	{
-	  if (l->tag == NULL
-	      || l->tag[0] != tag[0]
-	      || strcmp (l->tag, tag) != 0)
-	    continue;
-	}
+  /* Only a class in the same slot of the id_table can have the same
+     kind, tag and definition.  */
+  key.type = type;
+  key.tag = tag;
+  key.hash = debug_class_type_hash (tag, type);
+  slot = htab_find_slot_with_hash (info->id_table, &key, key.hash, INSERT);
 
+  for (l = (struct debug_class_id *) *slot; l != NULL; l = l->hash_next)
+    {
       if (debug_type_samep (info, l->type, type))
 	{
 	  c->id = l->type->u.kclass->id;
@@ -2992,10 +3191,14 @@ debug_set_class_id (struct debug_handle *info, const char *tag,
 
   l->type = type;
   l->tag = tag;
+  l->hash = key.hash;
 
   l->next = info->id_list;
   info->id_list = l;
 
+  l->hash_next = (struct debug_class_id *) *slot;
+  *slot = l;
+
   return true;
 }
 
@@ -23,13 +23,14 @@
 #include <errno.h>
 #include "opintl.h"
 
-/* Get LENGTH bytes from info's buffer, at target address memaddr.
-   Transfer them to myaddr.  */
-int
-buffer_read_memory (bfd_vma memaddr,
-		    bfd_byte *myaddr,
-		    unsigned int length,
-		    struct disassemble_info *info)
+/* Return a pointer to the LENGTH octets at target address MEMADDR
+   in info's buffer, or NULL if they are not all inside it or go past
+   info's stop_vma.  */
+
+static const bfd_byte *
+buffer_memory_octets (bfd_vma memaddr,
+		      unsigned int length,
+		      struct disassemble_info *info)
 {
   unsigned int opb = info->octets_per_byte;
   size_t end_addr_offset = length / opb;
@@ -41,13 +42,63 @@ buffer_read_memory (bfd_vma memaddr,
       || memaddr - info->buffer_vma + end_addr_offset > max_addr_offset
       || (info->stop_vma && (memaddr >= info->stop_vma
 			     || memaddr + end_addr_offset > info->stop_vma)))
+    return NULL;
+  return info->buffer + octets;
+}
+
+/* Get LENGTH bytes from info's buffer, at target address memaddr.
+   Transfer them to myaddr.  */
+int
+buffer_read_memory (bfd_vma memaddr,
+		    bfd_byte *myaddr,
+		    unsigned int length,
+		    struct disassemble_info *info)
+{
+  const bfd_byte *p = buffer_memory_octets (memaddr, length, info);
+
+  if (p == NULL)
     /* Out of bounds.  Use EIO because GDB uses it.  */
     return EIO;
-  memcpy (myaddr, info->buffer + octets, length);
+  memcpy (myaddr, p, length);
 
   return 0;
 }
 
+/* Point straight into info's buffer, if that is where info reads
+   target memory from.  */
+
+const bfd_byte *
+buffer_memory_pointer (bfd_vma memaddr,
+		       unsigned int length,
+		       struct disassemble_info *info)
+{
+  if (info->read_memory_func != buffer_read_memory)
+    return NULL;
+  return buffer_memory_octets (memaddr, length, info);
+}
+
+/* Get LENGTH bytes at target address MEMADDR without copying them if
+   they can be reached with buffer_memory_pointer, or else read them
+   into SCRATCH with read_memory_func.  */
+
+const bfd_byte *
+disassemble_read_pointer (bfd_vma memaddr,
+			  unsigned int length,
+			  bfd_byte *scratch,
+			  int *status,
+			  struct disassemble_info *info)
+{
+  const bfd_byte *p = buffer_memory_pointer (memaddr, length, info);
+
+  if (p != NULL)
+    {
+      *status = 0;
+      return p;
+    }
+  *status = (*info->read_memory_func) (memaddr, scratch, length, info);
+  return *status == 0 ? scratch : NULL;
+}
+
 /* Print an error message.  We can assume that this is in response to
    an error return from buffer_read_memory.  */
 
@@ -69,6 +120,84 @@ perror_memory (int status,
     }
 }
 
+/* Print functions for disassemble_decode, which throw the text of the
+   instructions away without formatting it.  */
+
+static int
+decode_print (void *stream ATTRIBUTE_UNUSED,
+	      const char *format ATTRIBUTE_UNUSED, ...)
+{
+  return 0;
+}
+
+static int
+decode_styled_print (void *stream ATTRIBUTE_UNUSED,
+		     enum disassembler_style style ATTRIBUTE_UNUSED,
+		     const char *format ATTRIBUTE_UNUSED, ...)
+{
+  return 0;
+}
+
+static void
+decode_print_address (bfd_vma addr ATTRIBUTE_UNUSED,
+		      struct disassemble_info *info ATTRIBUTE_UNUSED)
+{
+}
+
+/* Decode instructions from the buffer of INFO, recording for each its
+   length and what the decoder found out about it.  The print functions
+   of INFO are swapped for ones that do nothing while this happens, so
+   neither text nor the symbolic form of addresses is produced.  */
+
+size_t
+disassemble_decode (disassembler_ftype disassemble_fn,
+		    struct disassemble_info *info,
+		    bfd_vma vma,
+		    bfd_vma end,
+		    struct disassemble_insn *insns,
+		    size_t count)
+{
+  fprintf_ftype fprintf_func = info->fprintf_func;
+  fprintf_styled_ftype fprintf_styled_func = info->fprintf_styled_func;
+  void (*print_address_func) (bfd_vma, struct disassemble_info *)
+    = info->print_address_func;
+  unsigned int opb = info->octets_per_byte;
+  bfd_vma buffer_end = info->buffer_vma + info->buffer_length / opb;
+  size_t n;
+
+  if (end > buffer_end)
+    end = buffer_end;
+
+  info->fprintf_func = decode_print;
+  info->fprintf_styled_func = decode_styled_print;
+  info->print_address_func = decode_print_address;
+
+  for (n = 0; n < count && vma < end; n++)
+    {
+      int octets;
+
+      info->insn_info_valid = 0;
+      octets = (*disassemble_fn) (vma, info);
+      if (octets <= 0)
+	break;
+
+      insns[n].vma = vma;
+      insns[n].octets = octets;
+      insns[n].insn_info_valid = info->insn_info_valid;
+      insns[n].branch_delay_insns = info->branch_delay_insns;
+      insns[n].data_size = info->data_size;
+      insns[n].insn_type = info->insn_type;
+      insns[n].target = info->target;
+      insns[n].target2 = info->target2;
+      vma += octets / opb;
+    }
+
+  info->fprintf_func = fprintf_func;
+  info->fprintf_styled_func = fprintf_styled_func;
+  info->print_address_func = print_address_func;
+  return n;
+}
+
 /* This could be in a separate file, to save miniscule amounts of space
    in statically linked executables.  */
 
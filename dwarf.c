@@ -21,6 +21,7 @@
 #include "sysdep.h"
 #include "libiberty.h"
 #include "bfd.h"
+#include "libbfd.h"
 #include <stdint.h>
 #include "bucomm.h"
 #include "elfcomm.h"
@@ -30,6 +31,7 @@
 #include "gdb/gdb-index.h"
 #include "filenames.h"
 #include "safe-ctype.h"
+#include "leb128.h"
 #include <assert.h>
 
 #ifdef HAVE_LIBDEBUGINFOD
@@ -50,11 +52,84 @@
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
+/* Output collected from a thread displaying part of a section, see
+   process_all_units.  */
+
+struct dwarf_output
+{
+  char *buffer;
+  size_t pos;
+  size_t alloc;
+};
+
+/* Where the output of this thread goes, or NULL for stdout.  */
+static TLS struct dwarf_output *dwarf_output;
+
+static int ATTRIBUTE_PRINTF_1
+dwarf_printf (const char *format, ...)
+{
+  struct dwarf_output *out = dwarf_output;
+  va_list args;
+  int n;
+
+  if (out == NULL)
+    {
+      va_start (args, format);
+      n = vprintf (format, args);
+      va_end (args);
+      return n;
+    }
+
+  while (1)
+    {
+      size_t space = out->alloc - out->pos;
+
+      va_start (args, format);
+      n = vsnprintf (out->buffer + out->pos, space, format, args);
+      va_end (args);
+
+      if (n < 0 || space > (size_t) n)
+	break;
+
+      out->alloc = (out->alloc + n) * 2;
+      out->buffer = (char *) xrealloc (out->buffer, out->alloc);
+    }
+  if (n > 0)
+    out->pos += n;
+  return n;
+}
+
+static int
+dwarf_putchar (int c)
+{
+  struct dwarf_output *out = dwarf_output;
+
+  if (out == NULL)
+    return putchar (c);
+
+  if (out->pos + 1 >= out->alloc)
+    {
+      out->alloc = (out->alloc + 1) * 2;
+      out->buffer = (char *) xrealloc (out->buffer, out->alloc);
+    }
+  out->buffer[out->pos++] = c;
+  out->buffer[out->pos] = '\0';
+  return c;
+}
+
+/* Everything below prints through those.  */
+#undef printf
+#define printf dwarf_printf
+#undef putchar
+#define putchar dwarf_putchar
+
 static const char *regname (unsigned int regno, int row);
 static const char *regname_internal_by_table_only (unsigned int regno);
 
-static int have_frame_base;
-static int need_base_address;
+/* These and level_type_signed are per thread, as the units of a
+   .debug_info section may be displayed on several threads.  */
+static TLS int have_frame_base;
+static TLS int need_base_address;
 
 static unsigned int num_debug_info_entries = 0;
 static unsigned int alloc_num_debug_info_entries = 0;
@@ -63,6 +138,16 @@ static debug_info *debug_information = NULL;
    that the .debug_info section could not be loaded/parsed.  */
 #define DEBUG_INFO_UNAVAILABLE  (unsigned int) -1
 
+/* Set when load_debug_info has left the location lists of the units
+   out of debug_information, as nothing but display_debug_loc needs
+   them.  display_debug_loc then decodes the units one at a time again
+   with load_unit_loc_lists, and RELOADING_LOC_LISTS is set while it
+   does.  LOC_LISTS_INFO and LOC_LISTS_ABBREV are the sections that
+   load_debug_info scanned.  */
+static bool loc_lists_deferred;
+static bool reloading_loc_lists;
+static enum dwarf_section_display_enum loc_lists_info, loc_lists_abbrev;
+
 /* A .debug_info section can contain multiple links to separate
    DWO object files.  We use these structures to record these links.  */
 typedef enum dwo_type
@@ -81,7 +166,7 @@ typedef struct dwo_info
 } dwo_info;
 
 static dwo_info *first_dwo_info = NULL;
-static bool need_dwo_info;
+static TLS bool need_dwo_info;
 
 separate_info * first_separate_info = NULL;
 
@@ -152,7 +237,7 @@ static bool load_cu_tu_indexes (void *);
    the latest DW_AT_type seen for that level was a signed type or
    an unsigned type.  */
 #define MAX_CU_NESTING (1 << 8)
-static bool level_type_signed[MAX_CU_NESTING];
+static TLS bool level_type_signed[MAX_CU_NESTING];
 
 /* Values for do_debug_lines.  */
 #define FLAG_DEBUG_LINES_RAW	 1
@@ -282,6 +367,29 @@ read_leb128 (unsigned char *data,
   unsigned int num_read = 0;
   unsigned int shift = 0;
   int status = 1;
+  size_t len;
+
+  /* Eight bytes hold only 56 bits, so a number that short can neither
+     overflow nor be unterminated; leave longer ones to the loop, which
+     checks for both.  */
+  if (sign)
+    {
+      int64_t value;
+
+      len = leb128_read_signed (data, end, &value);
+      result = value;
+    }
+  else
+    len = leb128_read_unsigned (data, end, &result);
+  if (len != 0 && len <= 8)
+    {
+      if (length_return != NULL)
+	*length_return = len;
+      if (status_return != NULL)
+	*status_return = 0;
+      return result;
+    }
+  result = 0;
 
   while (data < end)
     {
@@ -324,11 +432,90 @@ read_leb128 (unsigned char *data,
   return result;
 }
 
+/* Read SIZE bytes at FIELD, as byte_get and byte_get_signed do.  The
+   common sizes are read inline for both byte orders, so that decoding
+   does not call through the byte_get pointer for every field; a
+   constant SIZE lets the compiler drop the switch altogether.  */
+
+static inline uint64_t
+dwarf_byte_get (const unsigned char *field, unsigned int size)
+{
+  if (byte_get == byte_get_little_endian)
+    switch (size)
+      {
+      case 1:
+	return *field;
+      case 2:
+	return ((uint64_t) field[0]
+		| ((uint64_t) field[1] << 8));
+      case 4:
+	return ((uint64_t) field[0]
+		| ((uint64_t) field[1] << 8)
+		| ((uint64_t) field[2] << 16)
+		| ((uint64_t) field[3] << 24));
+      case 8:
+	return ((uint64_t) field[0]
+		| ((uint64_t) field[1] << 8)
+		| ((uint64_t) field[2] << 16)
+		| ((uint64_t) field[3] << 24)
+		| ((uint64_t) field[4] << 32)
+		| ((uint64_t) field[5] << 40)
+		| ((uint64_t) field[6] << 48)
+		| ((uint64_t) field[7] << 56));
+      default:
+	break;
+      }
+  else if (byte_get == byte_get_big_endian)
+    switch (size)
+      {
+      case 1:
+	return *field;
+      case 2:
+	return ((uint64_t) field[1]
+		| ((uint64_t) field[0] << 8));
+      case 4:
+	return ((uint64_t) field[3]
+		| ((uint64_t) field[2] << 8)
+		| ((uint64_t) field[1] << 16)
+		| ((uint64_t) field[0] << 24));
+      case 8:
+	return ((uint64_t) field[7]
+		| ((uint64_t) field[6] << 8)
+		| ((uint64_t) field[5] << 16)
+		| ((uint64_t) field[4] << 24)
+		| ((uint64_t) field[3] << 32)
+		| ((uint64_t) field[2] << 40)
+		| ((uint64_t) field[1] << 48)
+		| ((uint64_t) field[0] << 56));
+      default:
+	break;
+      }
+  return byte_get (field, size);
+}
+
+static inline uint64_t
+dwarf_byte_get_signed (const unsigned char *field, unsigned int size)
+{
+  switch (size)
+    {
+    case 1:
+      return (dwarf_byte_get (field, 1) ^ 0x80) - 0x80;
+    case 2:
+      return (dwarf_byte_get (field, 2) ^ 0x8000) - 0x8000;
+    case 4:
+      return (dwarf_byte_get (field, 4) ^ 0x80000000) - 0x80000000;
+    case 8:
+      return dwarf_byte_get (field, 8);
+    default:
+      return byte_get_signed (field, size);
+    }
+}
+
 /* Read AMOUNT bytes from PTR and store them in VAL.
    Checks to make sure that the read will not reach or pass END.
    FUNC chooses whether the value read is unsigned or signed, and may
-   be either byte_get or byte_get_signed.  If INC is true, PTR is
-   incremented after reading the value.
+   be either dwarf_byte_get or dwarf_byte_get_signed.  If INC is true,
+   PTR is incremented after reading the value.
    This macro cannot protect against PTR values derived from user input.
    The C standard sections 6.5.6 and 6.5.8 say attempts to do so using
    pointers is undefined behaviour.  */
@@ -363,16 +550,16 @@ read_leb128 (unsigned char *data,
   while (0)
 
 #define SAFE_BYTE_GET(VAL, PTR, AMOUNT, END)	\
-  SAFE_BYTE_GET_INTERNAL (VAL, PTR, AMOUNT, END, byte_get, false)
+  SAFE_BYTE_GET_INTERNAL (VAL, PTR, AMOUNT, END, dwarf_byte_get, false)
 
 #define SAFE_BYTE_GET_AND_INC(VAL, PTR, AMOUNT, END)	\
-  SAFE_BYTE_GET_INTERNAL (VAL, PTR, AMOUNT, END, byte_get, true)
+  SAFE_BYTE_GET_INTERNAL (VAL, PTR, AMOUNT, END, dwarf_byte_get, true)
 
 #define SAFE_SIGNED_BYTE_GET(VAL, PTR, AMOUNT, END)	\
-  SAFE_BYTE_GET_INTERNAL (VAL, PTR, AMOUNT, END, byte_get_signed, false)
+  SAFE_BYTE_GET_INTERNAL (VAL, PTR, AMOUNT, END, dwarf_byte_get_signed, false)
 
 #define SAFE_SIGNED_BYTE_GET_AND_INC(VAL, PTR, AMOUNT, END)	\
-  SAFE_BYTE_GET_INTERNAL (VAL, PTR, AMOUNT, END, byte_get_signed, true)
+  SAFE_BYTE_GET_INTERNAL (VAL, PTR, AMOUNT, END, dwarf_byte_get_signed, true)
 
 typedef struct State_Machine_Registers
 {
@@ -1102,7 +1289,7 @@ get_TAG_name (uint64_t tag)
     name = get_DW_TAG_name ((unsigned int) tag);
   if (name == NULL)
     {
-      static char buffer[100];
+      static TLS char buffer[100];
 
       if (tag >= DW_TAG_lo_user && tag <= DW_TAG_hi_user)
 	snprintf (buffer, sizeof (buffer),
@@ -1128,7 +1315,7 @@ get_FORM_name (unsigned long long form)
     name = get_DW_FORM_name ((unsigned int) form);
   if (name == NULL)
     {
-      static char buffer[100];
+      static TLS char buffer[100];
 
       snprintf (buffer, sizeof (buffer), _("Unknown FORM value: %lx"), form);
       return buffer;
@@ -1146,7 +1333,7 @@ get_IDX_name (unsigned long long idx)
     name = get_DW_IDX_name ((unsigned int) idx);
   if (name == NULL)
     {
-      static char buffer[100];
+      static TLS char buffer[100];
 
       snprintf (buffer, sizeof (buffer), _("Unknown IDX value: %lx"), idx);
       return buffer;
@@ -1827,7 +2014,7 @@ get_AT_name (unsigned long long attribute)
 
   if (name == NULL)
     {
-      static char buffer[100];
+      static TLS char buffer[100];
 
       snprintf (buffer, sizeof (buffer), _("Unknown AT value: %lx"),
 		attribute);
@@ -2799,7 +2986,7 @@ read_and_display_attr_value (unsigned long long attribute,
     }
 
   if ((do_loc || do_debug_loc || do_debug_ranges || do_debug_info)
-      && num_debug_info_entries == 0
+      && (num_debug_info_entries == 0 || reloading_loc_lists)
       && debug_info_p != NULL)
     {
       switch (attribute)
@@ -2880,6 +3067,9 @@ read_and_display_attr_value (unsigned long long attribute,
 	      || form == DW_FORM_sec_offset
 	      || form == DW_FORM_loclistx)
 	    {
+	      if (loc_lists_deferred && !reloading_loc_lists)
+		break;
+
 	      /* Process location list.  */
 	      unsigned int lmax = debug_info_p->max_loc_offsets;
 	      unsigned int num = debug_info_p->num_loc_offsets;
@@ -3546,10 +3736,10 @@ introduce (struct dwarf_section * section, bool raw)
     }
 }
 
-/* Free memory allocated for one unit in debug_information.  */
+/* Free the location lists of one unit in debug_information.  */
 
 static void
-free_debug_information (debug_info *ent)
+free_unit_loc_lists (debug_info *ent)
 {
   if (ent->max_loc_offsets)
     {
@@ -3557,210 +3747,45 @@ free_debug_information (debug_info *ent)
       free (ent->loc_views);
       free (ent->have_frame_base);
     }
+  ent->loc_offsets = NULL;
+  ent->loc_views = NULL;
+  ent->have_frame_base = NULL;
+  ent->num_loc_offsets = 0;
+  ent->max_loc_offsets = 0;
+  ent->num_loc_views = 0;
+}
+
+/* Free memory allocated for one unit in debug_information.  */
+
+static void
+free_debug_information (debug_info *ent)
+{
+  free_unit_loc_lists (ent);
   if (ent->max_range_lists)
     free (ent->range_lists);
 }
 
-/* Process the contents of a .debug_info section.
-   If do_loc is TRUE then we are scanning for location lists and dwo tags
-   and we do not want to display anything to the user.
-   If do_types is TRUE, we are processing a .debug_types section instead of
-   a .debug_info section.
-   The information displayed is restricted by the values in DWARF_START_DIE
-   and DWARF_CUTOFF_LEVEL.
-   Returns TRUE upon success.  Otherwise an error or warning message is
-   printed and FALSE is returned.  */
+/* Display, or scan if DO_LOC, the units of SECTION from START up to
+   STOP, the first of which is number UNIT, for process_debug_info.  END
+   is the end of the section and SECTION_BEGIN its start.  *DO_TYPESP
+   is updated from the unit headers.  Sets *DONE if DWARF_START_DIE has
+   been displayed and there is nothing more to do.  */
 
 static bool
-process_debug_info (struct dwarf_section * section,
-		    void *file,
-		    enum dwarf_section_display_enum abbrev_sec,
-		    bool do_loc,
-		    bool do_types)
+process_debug_info_units (struct dwarf_section *section,
+			  enum dwarf_section_display_enum abbrev_sec,
+			  bool do_loc,
+			  bool *do_typesp,
+			  unsigned char *section_begin,
+			  unsigned char *start,
+			  unsigned char *stop,
+			  unsigned char *end,
+			  unsigned int unit,
+			  bool *done)
 {
-  unsigned char *start = section->start;
-  unsigned char *end = start + section->size;
-  unsigned char *section_begin;
-  unsigned int unit;
-  unsigned int num_units = 0;
-
-  /* First scan the section to get the number of comp units.
-     Length sanity checks are done here.  */
-  for (section_begin = start, num_units = 0; section_begin < end;
-       num_units ++)
-    {
-      uint64_t length;
-
-      /* Read the first 4 bytes.  For a 32-bit DWARF section, this
-	 will be the length.  For a 64-bit DWARF section, it'll be
-	 the escape code 0xffffffff followed by an 8 byte length.  */
-      SAFE_BYTE_GET_AND_INC (length, section_begin, 4, end);
-
-      if (length == 0xffffffff)
-	SAFE_BYTE_GET_AND_INC (length, section_begin, 8, end);
-      else if (length >= 0xfffffff0 && length < 0xffffffff)
-	{
-	  warn (_("Reserved length value (%#" PRIx64 ") found in section %s\n"),
-		length, section->name);
-	  return false;
-	}
-
-      /* Negative values are illegal, they may even cause infinite
-	 looping.  This can happen if we can't accurately apply
-	 relocations to an object file, or if the file is corrupt.  */
-      if (length > (size_t) (end - section_begin))
-	{
-	  warn (_("Corrupt unit length (got %#" PRIx64
-		  " expected at most %#tx) in section %s\n"),
-		length, end - section_begin, section->name);
-	  return false;
-	}
-      section_begin += length;
-    }
-
-  if (num_units == 0)
-    {
-      error (_("No comp units in %s section ?\n"), section->name);
-      return false;
-    }
-
-  if ((do_loc || do_debug_loc || do_debug_ranges || do_debug_info)
-      && num_debug_info_entries == 0
-      && ! do_types)
-    {
-
-      /* Then allocate an array to hold the information.  */
-      debug_information = (debug_info *) cmalloc (num_units,
-						  sizeof (* debug_information));
-      if (debug_information == NULL)
-	{
-	  error (_("Not enough memory for a debug info array of %u entries\n"),
-		 num_units);
-	  alloc_num_debug_info_entries = num_debug_info_entries = 0;
-	  return false;
-	}
-
-      /* PR 17531: file: 92ca3797.
-	 We cannot rely upon the debug_information array being initialised
-	 before it is used.  A corrupt file could easily contain references
-	 to a unit for which information has not been made available.  So
-	 we ensure that the array is zeroed here.  */
-      memset (debug_information, 0, num_units * sizeof (*debug_information));
-
-      alloc_num_debug_info_entries = num_units;
-    }
-
-  if (!do_loc)
-    {
-      load_debug_section_with_follow (str, file);
-      load_debug_section_with_follow (line_str, file);
-      load_debug_section_with_follow (str_dwo, file);
-      load_debug_section_with_follow (str_index, file);
-      load_debug_section_with_follow (str_index_dwo, file);
-      load_debug_section_with_follow (debug_addr, file);
-    }
-
-  load_debug_section_with_follow (abbrev_sec, file);
-  load_debug_section_with_follow (loclists, file);
-  load_debug_section_with_follow (rnglists, file);
-  load_debug_section_with_follow (loclists_dwo, file);
-  load_debug_section_with_follow (rnglists_dwo, file);
-
-  if (debug_displays [abbrev_sec].section.start == NULL)
-    {
-      warn (_("Unable to locate %s section!\n"),
-	    debug_displays [abbrev_sec].section.uncompressed_name);
-      return false;
-    }
-
-  if (!do_loc && dwarf_start_die == 0)
-    introduce (section, false);
-
-  free_all_abbrevs ();
-
-  /* In order to be able to resolve DW_FORM_ref_addr forms we need
-     to load *all* of the abbrevs for all CUs in this .debug_info
-     section.  This does effectively mean that we (partially) read
-     every CU header twice.  */
-  for (section_begin = start; start < end;)
-    {
-      DWARF2_Internal_CompUnit compunit;
-      unsigned char *hdrptr;
-      uint64_t abbrev_base;
-      size_t abbrev_size;
-      uint64_t cu_offset;
-      unsigned int offset_size;
-      struct cu_tu_set *this_set;
-      unsigned char *end_cu;
-
-      hdrptr = start;
-      cu_offset = start - section_begin;
-
-      SAFE_BYTE_GET_AND_INC (compunit.cu_length, hdrptr, 4, end);
-
-      if (compunit.cu_length == 0xffffffff)
-	{
-	  SAFE_BYTE_GET_AND_INC (compunit.cu_length, hdrptr, 8, end);
-	  offset_size = 8;
-	}
-      else
-	offset_size = 4;
-      end_cu = hdrptr + compunit.cu_length;
-
-      SAFE_BYTE_GET_AND_INC (compunit.cu_version, hdrptr, 2, end_cu);
-
-      this_set = find_cu_tu_set_v2 (cu_offset, do_types);
-
-      if (compunit.cu_version < 5)
-	{
-	  compunit.cu_unit_type = DW_UT_compile;
-	  /* Initialize it due to a false compiler warning.  */
-	  compunit.cu_pointer_size = -1;
-	}
-      else
-	{
-	  SAFE_BYTE_GET_AND_INC (compunit.cu_unit_type, hdrptr, 1, end_cu);
-	  do_types = (compunit.cu_unit_type == DW_UT_type);
-
-	  SAFE_BYTE_GET_AND_INC (compunit.cu_pointer_size, hdrptr, 1, end_cu);
-	}
-
-      SAFE_BYTE_GET_AND_INC (compunit.cu_abbrev_offset, hdrptr, offset_size,
-			     end_cu);
-
-      if (compunit.cu_unit_type == DW_UT_split_compile
-	  || compunit.cu_unit_type == DW_UT_skeleton)
-	{
-	  uint64_t dwo_id;
-	  SAFE_BYTE_GET_AND_INC (dwo_id, hdrptr, 8, end_cu);
-	}
-
-      if (this_set == NULL)
-	{
-	  abbrev_base = 0;
-	  abbrev_size = debug_displays [abbrev_sec].section.size;
-	}
-      else
-	{
-	  abbrev_base = this_set->section_offsets [DW_SECT_ABBREV];
-	  abbrev_size = this_set->section_sizes [DW_SECT_ABBREV];
-	}
-
-      abbrev_list *list;
-      abbrev_list *free_list;
-      list = find_and_process_abbrev_set (&debug_displays[abbrev_sec].section,
-					  abbrev_base, abbrev_size,
-					  compunit.cu_abbrev_offset,
-					  &free_list);
-      start = end_cu;
-      if (list != NULL && list->first_abbrev != NULL)
-	record_abbrev_list_for_cu (cu_offset, start - section_begin,
-				   list, free_list);
-      else if (free_list != NULL)
-	free_abbrev_list (free_list);
-    }
+  bool do_types = *do_typesp;
 
-  for (start = section_begin, unit = 0; start < end; unit++)
+  for (; start < stop; unit++)
     {
       DWARF2_Internal_CompUnit compunit;
       unsigned char *hdrptr;
@@ -3853,7 +3878,7 @@ process_debug_info (struct dwarf_section * section,
 	}
 
       if ((do_loc || do_debug_loc || do_debug_ranges || do_debug_info)
-	  && num_debug_info_entries == 0
+	  && (num_debug_info_entries == 0 || reloading_loc_lists)
 	  && alloc_num_debug_info_entries > unit
 	  && ! do_types)
 	{
@@ -3978,7 +4003,7 @@ process_debug_info (struct dwarf_section * section,
 	      --level;
 	      if (level < 0)
 		{
-		  static unsigned num_bogus_warns = 0;
+		  static TLS unsigned num_bogus_warns = 0;
 
 		  if (num_bogus_warns < 3)
 		    {
@@ -3990,7 +4015,11 @@ process_debug_info (struct dwarf_section * section,
 		    }
 		}
 	      if (dwarf_start_die != 0 && level < saved_level)
-		return true;
+		{
+		  *do_typesp = do_types;
+		  *done = true;
+		  return true;
+		}
 	      continue;
 	    }
 
@@ -4031,94 +4060,460 @@ process_debug_info (struct dwarf_section * section,
 		}
 	      warn (_("DIE at offset %#lx refers to abbreviation number %lu which does not exist\n"),
 		    die_offset, abbrev_number);
+	      *do_typesp = do_types;
 	      return false;
 	    }
 
-	  if (!do_loc && do_printing)
-	    printf (" (%s)\n", get_TAG_name (entry->tag));
+	  if (!do_loc && do_printing)
+	    printf (" (%s)\n", get_TAG_name (entry->tag));
+
+	  switch (entry->tag)
+	    {
+	    default:
+	      need_base_address = 0;
+	      break;
+	    case DW_TAG_compile_unit:
+	    case DW_TAG_skeleton_unit:
+	      need_base_address = 1;
+	      need_dwo_info = do_loc;
+	      break;
+	    case DW_TAG_entry_point:
+	    case DW_TAG_subprogram:
+	      need_base_address = 0;
+	      /* Assuming that there is no DW_AT_frame_base.  */
+	      have_frame_base = 0;
+	      break;
+	    }
+
+	  debug_info *debug_info_p =
+	    (debug_information && unit < alloc_num_debug_info_entries)
+	    ? debug_information + unit : NULL;
+
+	  assert (!debug_info_p
+		  || (debug_info_p->num_loc_offsets
+		      == debug_info_p->num_loc_views));
+
+	  for (attr = entry->first_attr;
+	       attr && attr->attribute;
+	       attr = attr->next)
+	    {
+	      if (! do_loc && do_printing)
+		/* Show the offset from where the tag was extracted.  */
+		printf ("    <%tx>", tags - section_begin);
+	      tags = read_and_display_attr (attr->attribute,
+					    attr->form,
+					    attr->implicit_const,
+					    section_begin,
+					    tags,
+					    start,
+					    cu_offset,
+					    compunit.cu_pointer_size,
+					    offset_size,
+					    compunit.cu_version,
+					    debug_info_p,
+					    do_loc || ! do_printing,
+					    section,
+					    this_set,
+					    level);
+	    }
+
+	  /* If a locview attribute appears before a location one,
+	     make sure we don't associate it with an earlier
+	     loclist. */
+	  if (debug_info_p)
+	    switch (debug_info_p->num_loc_offsets - debug_info_p->num_loc_views)
+	      {
+	      case 1:
+		debug_info_p->loc_views [debug_info_p->num_loc_views] = -1;
+		debug_info_p->num_loc_views++;
+		assert (debug_info_p->num_loc_views
+			== debug_info_p->num_loc_offsets);
+		break;
+
+	      case 0:
+		break;
+
+	      case -1:
+		warn(_("DIE has locviews without loclist\n"));
+		debug_info_p->num_loc_views--;
+		break;
+
+	      default:
+		assert (0);
+	    }
+
+	  if (entry->children)
+	    ++level;
+	}
+      if (list != NULL)
+	free_abbrev_list (list);
+    }
+
+  *do_typesp = do_types;
+  return true;
+}
+
+/* The size of the runs of units that are displayed on one thread
+   at a time with --threads.  */
+#define INFO_CHUNK_SIZE (256 * 1024)
+
+/* A run of units displayed on one thread, and its output.  */
+
+struct info_chunk
+{
+  unsigned char *start;
+  unsigned char *stop;
+  unsigned int unit;
+  bool do_types;
+  bool ok;
+  struct dwarf_output out;
+};
+
+/* The chunks being displayed in parallel.  */
+
+struct info_job
+{
+  struct dwarf_section *section;
+  enum dwarf_section_display_enum abbrev_sec;
+  unsigned char *section_begin;
+  unsigned char *end;
+  struct info_chunk *chunks;
+};
+
+/* Display chunks FIRST to LAST of the job in DATA into their own
+   output buffers.  Worker for _bfd_parallel_for.  */
+
+static bool
+display_info_chunks (void *data, size_t first, size_t last)
+{
+  struct info_job *job = (struct info_job *) data;
+  size_t i;
+
+  for (i = first; i < last; i++)
+    {
+      struct info_chunk *chunk = &job->chunks[i];
+      bool do_types = chunk->do_types;
+      bool done = false;
+
+      dwarf_output = &chunk->out;
+      chunk->ok = process_debug_info_units (job->section, job->abbrev_sec,
+					    false, &do_types,
+					    job->section_begin, chunk->start,
+					    chunk->stop, job->end, chunk->unit,
+					    &done);
+    }
+  dwarf_output = NULL;
+  return true;
+}
+
+/* Display, or scan if DO_LOC, all the units of SECTION for
+   process_debug_info, with the arguments of process_debug_info_units.
+   When several threads are allowed the units are displayed a batch of
+   chunks at a time, each chunk on its own thread into a buffer, and
+   the buffers then written out in order.  The units are gone through
+   in order on one thread when scanning, when looking for
+   DWARF_START_DIE, and when there are separate debug info files, whose
+   alternate string sections are loaded as they are needed.  */
+
+static bool
+process_all_units (struct dwarf_section *section,
+		   enum dwarf_section_display_enum abbrev_sec,
+		   bool do_loc,
+		   bool *do_typesp,
+		   unsigned char *section_begin,
+		   unsigned char *end,
+		   bool *done)
+{
+  unsigned int nthreads = bfd_get_thread_count ();
+  unsigned char *start = section_begin;
+  unsigned int unit = 0;
+  bool do_types = *do_typesp;
+  bool ret = true;
+  struct info_job job;
+  size_t alloc, count, i;
+
+  if (do_loc
+      || dwarf_start_die != 0
+      || first_separate_info != NULL
+      || nthreads <= 1)
+    return process_debug_info_units (section, abbrev_sec, do_loc, do_typesp,
+				     section_begin, section_begin, end, end,
+				     0, done);
+
+  job.section = section;
+  job.abbrev_sec = abbrev_sec;
+  job.section_begin = section_begin;
+  job.end = end;
+  alloc = nthreads * 2;
+  job.chunks = (struct info_chunk *) xcalloc (alloc, sizeof (*job.chunks));
+
+  while (ret && start < end)
+    {
+      /* Cut the next batch of chunks at unit boundaries, following how
+	 the unit headers change do_types as process_debug_info_units
+	 will.  */
+      for (count = 0; count < alloc && start < end; count++)
+	{
+	  struct info_chunk *chunk = &job.chunks[count];
+
+	  chunk->start = start;
+	  chunk->unit = unit;
+	  chunk->do_types = do_types;
+	  chunk->out.pos = 0;
+	  do
+	    {
+	      unsigned char *hdrptr = start;
+	      unsigned char *end_cu;
+	      uint64_t length;
+	      unsigned int version;
+
+	      SAFE_BYTE_GET_AND_INC (length, hdrptr, 4, end);
+	      if (length == 0xffffffff)
+		SAFE_BYTE_GET_AND_INC (length, hdrptr, 8, end);
+	      end_cu = hdrptr + length;
+	      SAFE_BYTE_GET_AND_INC (version, hdrptr, 2, end_cu);
+	      if (version >= 5)
+		{
+		  unsigned int unit_type;
+
+		  SAFE_BYTE_GET_AND_INC (unit_type, hdrptr, 1, end_cu);
+		  do_types = (unit_type == DW_UT_type);
+		}
+	      start = end_cu;
+	      unit++;
+	    }
+	  while (start < end
+		 && (size_t) (start - chunk->start) < INFO_CHUNK_SIZE);
+	  chunk->stop = start;
+	}
+
+      _bfd_parallel_for (count, 1, display_info_chunks, &job);
+
+      /* Stop after the output of a unit that failed, as a walk through
+	 the units one after another would.  */
+      for (i = 0; i < count; i++)
+	{
+	  fwrite (job.chunks[i].out.buffer, 1, job.chunks[i].out.pos, stdout);
+	  if (!job.chunks[i].ok)
+	    {
+	      ret = false;
+	      break;
+	    }
+	}
+    }
+
+  for (i = 0; i < alloc; i++)
+    free (job.chunks[i].out.buffer);
+  free (job.chunks);
+  *do_typesp = do_types;
+  return ret;
+}
+
+/* Process the contents of a .debug_info section.
+   If do_loc is TRUE then we are scanning for location lists and dwo tags
+   and we do not want to display anything to the user.
+   If do_types is TRUE, we are processing a .debug_types section instead of
+   a .debug_info section.
+   The information displayed is restricted by the values in DWARF_START_DIE
+   and DWARF_CUTOFF_LEVEL.
+   Returns TRUE upon success.  Otherwise an error or warning message is
+   printed and FALSE is returned.  */
+
+static bool
+process_debug_info (struct dwarf_section * section,
+		    void *file,
+		    enum dwarf_section_display_enum abbrev_sec,
+		    bool do_loc,
+		    bool do_types)
+{
+  unsigned char *start = section->start;
+  unsigned char *end = start + section->size;
+  unsigned char *section_begin;
+  unsigned int num_units = 0;
+  bool done = false;
+
+  /* First scan the section to get the number of comp units.
+     Length sanity checks are done here.  */
+  for (section_begin = start, num_units = 0; section_begin < end;
+       num_units ++)
+    {
+      uint64_t length;
+
+      /* Read the first 4 bytes.  For a 32-bit DWARF section, this
+	 will be the length.  For a 64-bit DWARF section, it'll be
+	 the escape code 0xffffffff followed by an 8 byte length.  */
+      SAFE_BYTE_GET_AND_INC (length, section_begin, 4, end);
+
+      if (length == 0xffffffff)
+	SAFE_BYTE_GET_AND_INC (length, section_begin, 8, end);
+      else if (length >= 0xfffffff0 && length < 0xffffffff)
+	{
+	  warn (_("Reserved length value (%#" PRIx64 ") found in section %s\n"),
+		length, section->name);
+	  return false;
+	}
+
+      /* Negative values are illegal, they may even cause infinite
+	 looping.  This can happen if we can't accurately apply
+	 relocations to an object file, or if the file is corrupt.  */
+      if (length > (size_t) (end - section_begin))
+	{
+	  warn (_("Corrupt unit length (got %#" PRIx64
+		  " expected at most %#tx) in section %s\n"),
+		length, end - section_begin, section->name);
+	  return false;
+	}
+      section_begin += length;
+    }
+
+  if (num_units == 0)
+    {
+      error (_("No comp units in %s section ?\n"), section->name);
+      return false;
+    }
+
+  if ((do_loc || do_debug_loc || do_debug_ranges || do_debug_info)
+      && num_debug_info_entries == 0
+      && ! do_types)
+    {
+
+      /* Then allocate an array to hold the information.  */
+      debug_information = (debug_info *) cmalloc (num_units,
+						  sizeof (* debug_information));
+      if (debug_information == NULL)
+	{
+	  error (_("Not enough memory for a debug info array of %u entries\n"),
+		 num_units);
+	  alloc_num_debug_info_entries = num_debug_info_entries = 0;
+	  return false;
+	}
+
+      /* PR 17531: file: 92ca3797.
+	 We cannot rely upon the debug_information array being initialised
+	 before it is used.  A corrupt file could easily contain references
+	 to a unit for which information has not been made available.  So
+	 we ensure that the array is zeroed here.  */
+      memset (debug_information, 0, num_units * sizeof (*debug_information));
+
+      alloc_num_debug_info_entries = num_units;
+    }
+
+  if (!do_loc)
+    {
+      load_debug_section_with_follow (str, file);
+      load_debug_section_with_follow (line_str, file);
+      load_debug_section_with_follow (str_dwo, file);
+      load_debug_section_with_follow (str_index, file);
+      load_debug_section_with_follow (str_index_dwo, file);
+      load_debug_section_with_follow (debug_addr, file);
+    }
+
+  load_debug_section_with_follow (abbrev_sec, file);
+  load_debug_section_with_follow (loclists, file);
+  load_debug_section_with_follow (rnglists, file);
+  load_debug_section_with_follow (loclists_dwo, file);
+  load_debug_section_with_follow (rnglists_dwo, file);
+
+  if (debug_displays [abbrev_sec].section.start == NULL)
+    {
+      warn (_("Unable to locate %s section!\n"),
+	    debug_displays [abbrev_sec].section.uncompressed_name);
+      return false;
+    }
+
+  if (!do_loc && dwarf_start_die == 0)
+    introduce (section, false);
 
-	  switch (entry->tag)
-	    {
-	    default:
-	      need_base_address = 0;
-	      break;
-	    case DW_TAG_compile_unit:
-	    case DW_TAG_skeleton_unit:
-	      need_base_address = 1;
-	      need_dwo_info = do_loc;
-	      break;
-	    case DW_TAG_entry_point:
-	    case DW_TAG_subprogram:
-	      need_base_address = 0;
-	      /* Assuming that there is no DW_AT_frame_base.  */
-	      have_frame_base = 0;
-	      break;
-	    }
+  free_all_abbrevs ();
 
-	  debug_info *debug_info_p =
-	    (debug_information && unit < alloc_num_debug_info_entries)
-	    ? debug_information + unit : NULL;
+  /* In order to be able to resolve DW_FORM_ref_addr forms we need
+     to load *all* of the abbrevs for all CUs in this .debug_info
+     section.  This does effectively mean that we (partially) read
+     every CU header twice.  */
+  for (section_begin = start; start < end;)
+    {
+      DWARF2_Internal_CompUnit compunit;
+      unsigned char *hdrptr;
+      uint64_t abbrev_base;
+      size_t abbrev_size;
+      uint64_t cu_offset;
+      unsigned int offset_size;
+      struct cu_tu_set *this_set;
+      unsigned char *end_cu;
 
-	  assert (!debug_info_p
-		  || (debug_info_p->num_loc_offsets
-		      == debug_info_p->num_loc_views));
+      hdrptr = start;
+      cu_offset = start - section_begin;
 
-	  for (attr = entry->first_attr;
-	       attr && attr->attribute;
-	       attr = attr->next)
-	    {
-	      if (! do_loc && do_printing)
-		/* Show the offset from where the tag was extracted.  */
-		printf ("    <%tx>", tags - section_begin);
-	      tags = read_and_display_attr (attr->attribute,
-					    attr->form,
-					    attr->implicit_const,
-					    section_begin,
-					    tags,
-					    start,
-					    cu_offset,
-					    compunit.cu_pointer_size,
-					    offset_size,
-					    compunit.cu_version,
-					    debug_info_p,
-					    do_loc || ! do_printing,
-					    section,
-					    this_set,
-					    level);
-	    }
+      SAFE_BYTE_GET_AND_INC (compunit.cu_length, hdrptr, 4, end);
 
-	  /* If a locview attribute appears before a location one,
-	     make sure we don't associate it with an earlier
-	     loclist. */
-	  if (debug_info_p)
-	    switch (debug_info_p->num_loc_offsets - debug_info_p->num_loc_views)
-	      {
-	      case 1:
-		debug_info_p->loc_views [debug_info_p->num_loc_views] = -1;
-		debug_info_p->num_loc_views++;
-		assert (debug_info_p->num_loc_views
-			== debug_info_p->num_loc_offsets);
-		break;
+      if (compunit.cu_length == 0xffffffff)
+	{
+	  SAFE_BYTE_GET_AND_INC (compunit.cu_length, hdrptr, 8, end);
+	  offset_size = 8;
+	}
+      else
+	offset_size = 4;
+      end_cu = hdrptr + compunit.cu_length;
 
-	      case 0:
-		break;
+      SAFE_BYTE_GET_AND_INC (compunit.cu_version, hdrptr, 2, end_cu);
 
-	      case -1:
-		warn(_("DIE has locviews without loclist\n"));
-		debug_info_p->num_loc_views--;
-		break;
+      this_set = find_cu_tu_set_v2 (cu_offset, do_types);
 
-	      default:
-		assert (0);
-	    }
+      if (compunit.cu_version < 5)
+	{
+	  compunit.cu_unit_type = DW_UT_compile;
+	  /* Initialize it due to a false compiler warning.  */
+	  compunit.cu_pointer_size = -1;
+	}
+      else
+	{
+	  SAFE_BYTE_GET_AND_INC (compunit.cu_unit_type, hdrptr, 1, end_cu);
+	  do_types = (compunit.cu_unit_type == DW_UT_type);
 
-	  if (entry->children)
-	    ++level;
+	  SAFE_BYTE_GET_AND_INC (compunit.cu_pointer_size, hdrptr, 1, end_cu);
 	}
-      if (list != NULL)
-	free_abbrev_list (list);
+
+      SAFE_BYTE_GET_AND_INC (compunit.cu_abbrev_offset, hdrptr, offset_size,
+			     end_cu);
+
+      if (compunit.cu_unit_type == DW_UT_split_compile
+	  || compunit.cu_unit_type == DW_UT_skeleton)
+	{
+	  uint64_t dwo_id;
+	  SAFE_BYTE_GET_AND_INC (dwo_id, hdrptr, 8, end_cu);
+	}
+
+      if (this_set == NULL)
+	{
+	  abbrev_base = 0;
+	  abbrev_size = debug_displays [abbrev_sec].section.size;
+	}
+      else
+	{
+	  abbrev_base = this_set->section_offsets [DW_SECT_ABBREV];
+	  abbrev_size = this_set->section_sizes [DW_SECT_ABBREV];
+	}
+
+      abbrev_list *list;
+      abbrev_list *free_list;
+      list = find_and_process_abbrev_set (&debug_displays[abbrev_sec].section,
+					  abbrev_base, abbrev_size,
+					  compunit.cu_abbrev_offset,
+					  &free_list);
+      start = end_cu;
+      if (list != NULL && list->first_abbrev != NULL)
+	record_abbrev_list_for_cu (cu_offset, start - section_begin,
+				   list, free_list);
+      else if (free_list != NULL)
+	free_abbrev_list (free_list);
     }
 
+  if (!process_all_units (section, abbrev_sec, do_loc, &do_types,
+			  section_begin, end, &done))
+    return false;
+  if (done)
+    return true;
+
   /* Set num_debug_info_entries here so that it can be used to check if
      we need to process .debug_loc and .debug_ranges sections.  */
   if ((do_loc || do_debug_loc || do_debug_ranges || do_debug_info)
@@ -4158,19 +4553,81 @@ load_debug_info (void * file)
   /* If this is a DWARF package file, load the CU and TU indexes.  */
   (void) load_cu_tu_indexes (file);
 
+  /* Unless the units are to be displayed, when the location lists are
+     wanted too, display_debug_loc finds them again a unit at a time
+     rather than all of them being held on to here.  */
+  loc_lists_deferred = !do_debug_info;
+
+  loc_lists_info = info;
+  loc_lists_abbrev = abbrev;
   if (load_debug_section_with_follow (info, file)
       && process_debug_info (&debug_displays [info].section, file, abbrev, true, false))
     return num_debug_info_entries;
 
+  loc_lists_info = info_dwo;
+  loc_lists_abbrev = abbrev_dwo;
   if (load_debug_section_with_follow (info_dwo, file)
       && process_debug_info (&debug_displays [info_dwo].section, file,
 			     abbrev_dwo, true, false))
     return num_debug_info_entries;
 
+  loc_lists_deferred = false;
   num_debug_info_entries = DEBUG_INFO_UNAVAILABLE;
   return 0;
 }
 
+/* Decode the unit at START, number UNIT, of the section scanned by
+   load_debug_info again, this time recording its location lists in
+   debug_information.  The rest of the unit's entry is left as the
+   scan found it.  Returns the start of the next unit.  */
+
+static unsigned char *
+load_unit_loc_lists (void *file, unsigned char *start, unsigned int unit)
+{
+  struct dwarf_section *section = &debug_displays [loc_lists_info].section;
+  unsigned char *section_begin = section->start;
+  unsigned char *end = section_begin + section->size;
+  unsigned char *hdrptr = start;
+  unsigned char *stop;
+  debug_info *ent = &debug_information [unit];
+  debug_info saved;
+  uint64_t length;
+  bool do_types = false;
+  bool done = false;
+
+  SAFE_BYTE_GET_AND_INC (length, hdrptr, 4, end);
+  if (length == 0xffffffff)
+    SAFE_BYTE_GET_AND_INC (length, hdrptr, 8, end);
+  stop = hdrptr + length;
+
+  load_debug_section_with_follow (loc_lists_abbrev, file);
+  load_debug_section_with_follow (loclists, file);
+  load_debug_section_with_follow (rnglists, file);
+  load_debug_section_with_follow (loclists_dwo, file);
+  load_debug_section_with_follow (rnglists_dwo, file);
+
+  /* Decode from the same empty entry as the scan did, so that the
+     location lists come out just as they would have then.  */
+  saved = *ent;
+  memset (ent, 0, sizeof (*ent));
+  reloading_loc_lists = true;
+  process_debug_info_units (section, loc_lists_abbrev, true, &do_types,
+			    section_begin, start, stop, end, unit, &done);
+  reloading_loc_lists = false;
+
+  saved.loc_offsets = ent->loc_offsets;
+  saved.loc_views = ent->loc_views;
+  saved.have_frame_base = ent->have_frame_base;
+  saved.num_loc_offsets = ent->num_loc_offsets;
+  saved.max_loc_offsets = ent->max_loc_offsets;
+  saved.num_loc_views = ent->num_loc_views;
+  if (ent->max_range_lists)
+    free (ent->range_lists);
+  *ent = saved;
+
+  return stop;
+}
+
 /* Read a DWARF .debug_line section header starting at DATA.
    Upon success returns an updated DATA pointer and the LINFO
    structure and the END_OF_SEQUENCE pointer will be filled in.
@@ -7225,6 +7682,7 @@ display_debug_loc (struct dwarf_section *section, void *file)
   int locs_sorted = 1;
   unsigned char *next = start, *vnext = vstart;
   unsigned int *array = NULL;
+  unsigned char *unit_next = NULL;
   const char *suffix = strrchr (section->name, '.');
   bool is_dwo = false;
   int is_loclists = strstr (section->name, "debug_loclists") != NULL;
@@ -7289,6 +7747,20 @@ display_debug_loc (struct dwarf_section *section, void *file)
       return 0;
     }
 
+  /* Only the first unit with location lists has them loaded by this,
+     and the others are loaded as they are displayed, below.  */
+  if (loc_lists_deferred)
+    {
+      unit_next = debug_displays [loc_lists_info].section.start;
+      for (i = 0; i < num_debug_info_entries; i++)
+	{
+	  unit_next = load_unit_loc_lists (file, unit_next, i);
+	  if (debug_information [i].num_loc_offsets != 0)
+	    break;
+	  free_unit_loc_lists (&debug_information [i]);
+	}
+    }
+
   /* Check the order of location list in .debug_info section. If
      offsets of location lists are in the ascending order, we can
      use `debug_information' directly.  */
@@ -7332,9 +7804,13 @@ display_debug_loc (struct dwarf_section *section, void *file)
     }
 
   if (!seen_first_offset)
-    error (_("No location lists in .debug_info section!\n"));
+    {
+      error (_("No location lists in .debug_info section!\n"));
+      first = num_debug_info_entries;
+    }
 
-  if (debug_information [first].num_loc_offsets > 0
+  if (seen_first_offset
+      && debug_information [first].num_loc_offsets > 0
       && debug_information [first].loc_offsets [0] != header_size
       && debug_information [first].loc_views [0] != header_size)
     warn (_("Location lists in %s section start at %#" PRIx64
@@ -7359,6 +7835,31 @@ display_debug_loc (struct dwarf_section *section, void *file)
       unsigned int k;
       int has_frame_base;
 
+      if (loc_lists_deferred && i != first)
+	{
+	  unsigned int num;
+
+	  unit_next = load_unit_loc_lists (file, unit_next, i);
+
+	  num = debug_information [i].num_loc_offsets;
+	  for (j = 0; locs_sorted && j < num; j++)
+	    {
+	      if (last_offset > debug_information [i].loc_offsets [j]
+		  || (last_offset == debug_information [i].loc_offsets [j]
+		      && last_view > debug_information [i].loc_views [j]))
+		locs_sorted = 0;
+	      last_offset = debug_information [i].loc_offsets [j];
+	      last_view = debug_information [i].loc_views [j];
+	    }
+	  if (!locs_sorted && (array == NULL || num > num_loc_list))
+	    {
+	      if (num > num_loc_list)
+		num_loc_list = num;
+	      array = (unsigned int *) xcrealloc (array, num_loc_list,
+						  sizeof (unsigned int));
+	    }
+	}
+
       if (!locs_sorted)
 	{
 	  for (k = 0; k < debug_information [i].num_loc_offsets; k++)
@@ -7484,6 +7985,9 @@ display_debug_loc (struct dwarf_section *section, void *file)
 	  if (vnext && vnext == start)
 	    display_view_pair_list (section, &start, i, vstart);
 	}
+
+      if (loc_lists_deferred)
+	free_unit_loc_lists (&debug_information [i]);
     }
 
   if (start < section->start + section->size)
@@ -8690,7 +9194,7 @@ regname_internal_riscv (unsigned int regno)
 
 	default:
 	  {
-	    static char csr_name[10];
+	    static TLS char csr_name[10];
 	    snprintf (csr_name, sizeof (csr_name), "csr%d", (regno - 4096));
 	    name = csr_name;
 	  }
@@ -8811,7 +9315,7 @@ regname_internal_by_table_only (unsigned int regno)
 static const char *
 regname (unsigned int regno, int name_only_p)
 {
-  static char reg[64];
+  static TLS char reg[64];
 
   const char *name = NULL;
 
@@ -11747,26 +12251,31 @@ load_separate_debug_info (const char *            main_filename,
   return debug_handle;
 }
 
-/* Attempt to load a separate dwarf object file.  */
+/* Return the name of the separate dwarf object file NAME in DIR.  */
 
-static void *
-load_dwo_file (const char * main_filename, const char * name, const char * dir, const char * id ATTRIBUTE_UNUSED)
+static char *
+dwo_file_name (const char * name, const char * dir)
 {
-  char * separate_filename;
-  void * separate_handle;
-
   if (IS_ABSOLUTE_PATH (name))
-    separate_filename = strdup (name);
-  else
-    /* FIXME: Skip adding / if dwo_dir ends in /.  */
-    separate_filename = concat (dir, "/", name, NULL);
+    return strdup (name);
+  /* FIXME: Skip adding / if dwo_dir ends in /.  */
+  return concat (dir, "/", name, NULL);
+}
+
+/* Add the separate dwarf object file SEPARATE_FILENAME, which has
+   been opened as SEPARATE_HANDLE or could not be if that is NULL.  */
+
+static void *
+load_dwo_file (const char * main_filename, char * separate_filename,
+	       void * separate_handle)
+{
   if (separate_filename == NULL)
     {
       warn (_("Out of memory allocating dwo filename\n"));
       return NULL;
     }
 
-  if ((separate_handle = open_debug_file (separate_filename)) == NULL)
+  if (separate_handle == NULL)
     {
       warn (_("Unable to load dwo file: %s\n"), separate_filename);
       free (separate_filename);
@@ -11782,6 +12291,82 @@ load_dwo_file (const char * main_filename, const char * name, const char * dir,
   return separate_handle;
 }
 
+/* A separate dwarf object file for load_separate_debug_files to
+   open.  */
+
+typedef struct dwo_load
+{
+  char *  filename;
+  void *  handle;
+} dwo_load;
+
+/* Open the dwo files of the dwo_load array DATA from START up to
+   END.  Worker for _bfd_parallel_for.  */
+
+static bool
+open_dwo_files (void *data, size_t start, size_t end)
+{
+  dwo_load * loads = (dwo_load *) data;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    if (loads[i].filename != NULL)
+      loads[i].handle = open_debug_file (loads[i].filename);
+  return true;
+}
+
+/* Accumulate the NAME, DIR and ID fields of the dwo links starting at
+   *DWINFOP, up to the end of a CU which has a DWO_NAME, and advance
+   *DWINFOP past them.  Returns false if the list ends first.  The
+   fields are not reset, so those of a CU without a name carry over
+   into the next.  Complain about repeated fields if WARN_P.  */
+
+static bool
+next_dwo_link (dwo_info ** dwinfop, const char ** name, const char ** dir,
+	       const char ** id, bool warn_p)
+{
+  dwo_info * dwinfo;
+
+  while ((dwinfo = *dwinfop) != NULL)
+    {
+      *dwinfop = dwinfo->next;
+
+      switch (dwinfo->type)
+	{
+	case DWO_NAME:
+	  if (*name != NULL && warn_p)
+	    warn (_("Multiple DWO_NAMEs encountered for the same CU\n"));
+	  *name = dwinfo->value;
+	  break;
+
+	case DWO_DIR:
+	  /* There can be multiple DW_AT_comp_dir entries in a CU,
+	     so do not complain.  */
+	  *dir = dwinfo->value;
+	  break;
+
+	case DWO_ID:
+	  if (*id != NULL && warn_p)
+	    warn (_("multiple DWO_IDs encountered for the same CU\n"));
+	  *id = dwinfo->value;
+	  break;
+
+	default:
+	  if (warn_p)
+	    error (_("Unexpected DWO INFO type"));
+	  break;
+	}
+
+      /* Stop at the end of our list, or when changing CUs, if there is
+	 a name to show.  */
+      if (*name != NULL
+	  && (dwinfo->next == NULL
+	      || dwinfo->next->cu_offset != dwinfo->cu_offset))
+	return true;
+    }
+  return false;
+}
+
 static void *
 try_build_id_prefix (const char * prefix, char * filename, const unsigned char * data, unsigned long long id_len)
 {
@@ -12046,66 +12631,66 @@ load_separate_debug_files (void * file, const char * filename)
 	  const char *dir = NULL;
 	  const char *id = NULL;
 	  const char *name = NULL;
+	  dwo_load *loads = NULL;
+	  size_t nloads = 0;
+	  size_t i;
 
-	  for (dwinfo = first_dwo_info; dwinfo != NULL; dwinfo = dwinfo->next)
+	  /* Open all the dwo files first, several at a time if threads
+	     are allowed, since each may have to wait for its file.  */
+	  if (do_follow_links)
 	    {
-	      /* Accumulate NAME, DIR and ID fields.  */
-	      switch (dwinfo->type)
-		{
-		case DWO_NAME:
-		  if (name != NULL)
-		    warn (_("Multiple DWO_NAMEs encountered for the same CU\n"));
-		  name = dwinfo->value;
-		  break;
-
-		case DWO_DIR:
-		  /* There can be multiple DW_AT_comp_dir entries in a CU,
-		     so do not complain.  */
-		  dir = dwinfo->value;
-		  break;
+	      size_t alloc = 0;
 
-		case DWO_ID:
-		  if (id != NULL)
-		    warn (_("multiple DWO_IDs encountered for the same CU\n"));
-		  id = dwinfo->value;
-		  break;
-
-		default:
-		  error (_("Unexpected DWO INFO type"));
-		  break;
+	      for (dwinfo = first_dwo_info;
+		   next_dwo_link (&dwinfo, &name, &dir, &id, false);
+		   name = dir = id = NULL)
+		{
+		  if (nloads == alloc)
+		    {
+		      alloc = alloc ? alloc * 2 : 16;
+		      loads = (dwo_load *) xrealloc (loads,
+						     alloc * sizeof (*loads));
+		    }
+		  loads[nloads].filename = dwo_file_name (name, dir);
+		  loads[nloads].handle = NULL;
+		  nloads++;
 		}
+	      name = dir = id = NULL;
+	      _bfd_parallel_for (nloads, 1, open_dwo_files, loads);
+	    }
 
-	      /* If we have reached the end of our list, or we are changing
-		 CUs, then display the information that we have accumulated
-		 so far.  */
-	      if (name != NULL
-		  && (dwinfo->next == NULL
-		      || dwinfo->next->cu_offset != dwinfo->cu_offset))
+	  i = 0;
+	  for (dwinfo = first_dwo_info;
+	       next_dwo_link (&dwinfo, &name, &dir, &id, true);
+	       name = dir = id = NULL)
+	    {
+	      /* Display the information that we have accumulated for
+		 this CU.  */
+	      if (do_debug_links)
 		{
-		  if (do_debug_links)
+		  if (! introduced)
 		    {
-		      if (! introduced)
-			{
-			  printf (_("The %s section contains link(s) to dwo file(s):\n\n"),
-				  debug_displays [info].section.uncompressed_name);
-			  introduced = true;
-			}
-
-		      printf (_("  Name:      %s\n"), name);
-		      printf (_("  Directory: %s\n"), dir ? dir : _("<not-found>"));
-		      if (id != NULL)
-			display_data (printf (_("  ID:       ")), (unsigned char *) id, 8);
-		      else if (debug_information[0].dwarf_version != 5)
-			printf (_("  ID:        <not specified>\n"));
-		      printf ("\n\n");
+		      printf (_("The %s section contains link(s) to dwo file(s):\n\n"),
+			      debug_displays [info].section.uncompressed_name);
+		      introduced = true;
 		    }
 
-		  if (do_follow_links)
-		    load_dwo_file (filename, name, dir, id);
+		  printf (_("  Name:      %s\n"), name);
+		  printf (_("  Directory: %s\n"), dir ? dir : _("<not-found>"));
+		  if (id != NULL)
+		    display_data (printf (_("  ID:       ")), (unsigned char *) id, 8);
+		  else if (debug_information[0].dwarf_version != 5)
+		    printf (_("  ID:        <not specified>\n"));
+		  printf ("\n\n");
+		}
 
-		  name = dir = id = NULL;
+	      if (do_follow_links && i < nloads)
+		{
+		  load_dwo_file (filename, loads[i].filename, loads[i].handle);
+		  i++;
 		}
 	    }
+	  free (loads);
 	}
     }
 
@@ -12158,6 +12743,7 @@ free_debug_memory (void)
       debug_information = NULL;
       alloc_num_debug_info_entries = num_debug_info_entries = 0;
     }
+  loc_lists_deferred = false;
 
   separate_info * d;
   separate_info * next;
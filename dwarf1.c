@@ -55,6 +55,19 @@ struct dwarf1_debug
 
   /* The current or next unread die within the .debug section.  */
   bfd_byte *currentDie;
+
+  /* How many compilation units have been parsed.  */
+  unsigned long long unit_count;
+
+  /* The address ranges of the first 'unit_indexed' parsed units,
+     sorted by address ('unit_range_count' entries).  */
+  struct dwarf1_range *unit_ranges;
+  unsigned long long unit_range_count;
+  unsigned long long unit_indexed;
+
+  /* Set if some parsed units overlap, so that they must be searched
+     in order.  */
+  bool units_overlap;
 };
 
 /* One dwarf1_unit for each parsed compilation unit die.  */
@@ -86,8 +99,23 @@ struct dwarf1_unit
   /* The decoded line number table (line_count entries).  */
   struct linenumber* linenumber_table;
 
+  /* Are the line table addresses in ascending order?  */
+  bool lines_sorted;
+
   /* The list of functions in this unit.  */
   struct dwarf1_func* func_list;
+
+  /* Have the function dies been parsed?  */
+  bool funcs_parsed;
+
+  /* The address ranges of the functions, sorted by address
+     ('func_range_count' entries), or NULL if not yet built.  */
+  struct dwarf1_range *func_ranges;
+  unsigned long long func_range_count;
+
+  /* Set if some functions overlap, so that they must be searched
+     in order.  */
+  bool funcs_overlap;
 };
 
 /* One dwarf1_func for each parsed function die.  */
@@ -121,6 +149,16 @@ struct die_info
   unsigned short tag;
 };
 
+/* An address range covered by a unit or function.  */
+struct dwarf1_range
+{
+  unsigned long long low_pc;
+  unsigned long long high_pc;
+
+  /* The unit or function.  */
+  void *data;
+};
+
 /* Parsed line number information.  */
 struct linenumber
 {
@@ -147,6 +185,7 @@ alloc_dwarf1_unit (struct dwarf1_debug* stash)
     {
       x->prev = stash->lastUnit;
       stash->lastUnit = x;
+      stash->unit_count++;
     }
 
   return x;
@@ -362,11 +401,80 @@ parse_line_table (struct dwarf1_debug* stash, struct dwarf1_unit* aUnit)
 	    = base + bfd_get_32 (stash->abfd, (bfd_byte *) xptr);
 	  xptr += 4;
 	}
+
+      aUnit->lines_sorted = true;
+      for (eachLine = 1; eachLine < aUnit->line_count; eachLine++)
+	if (aUnit->linenumber_table[eachLine].addr
+	    < aUnit->linenumber_table[eachLine - 1].addr)
+	  {
+	    aUnit->lines_sorted = false;
+	    break;
+	  }
     }
 
   return true;
 }
 
+/* Compare two dwarf1_range structures by address.  This is called
+   via qsort.  */
+
+static int
+compare_dwarf1_ranges (const void *a, const void *b)
+{
+  const struct dwarf1_range *ra = (const struct dwarf1_range *) a;
+  const struct dwarf1_range *rb = (const struct dwarf1_range *) b;
+
+  if (ra->low_pc != rb->low_pc)
+    return ra->low_pc < rb->low_pc ? -1 : 1;
+  if (ra->high_pc != rb->high_pc)
+    return ra->high_pc < rb->high_pc ? -1 : 1;
+  return 0;
+}
+
+/* Sort the COUNT non-empty RANGES by address.  Return FALSE if any
+   two of them overlap: a lookup must then take the first match in
+   the original order, which the sorted array cannot give.  */
+
+static bool
+sort_dwarf1_ranges (struct dwarf1_range *ranges, unsigned long long count)
+{
+  unsigned long long i;
+
+  qsort (ranges, count, sizeof (*ranges), compare_dwarf1_ranges);
+  for (i = 1; i < count; i++)
+    if (ranges[i].low_pc < ranges[i - 1].high_pc)
+      return false;
+
+  return true;
+}
+
+/* Return the data of the range in the COUNT sorted, disjoint RANGES
+   that contains ADDR, or NULL if there is none.  */
+
+static void *
+find_dwarf1_range (const struct dwarf1_range *ranges,
+		   unsigned long long count,
+		   unsigned long long addr)
+{
+  unsigned long long lo = 0;
+  unsigned long long hi = count;
+
+  /* Find the first range starting after ADDR.  */
+  while (lo < hi)
+    {
+      unsigned long long mid = lo + (hi - lo) / 2;
+
+      if (ranges[mid].low_pc <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  if (lo > 0 && addr < ranges[lo - 1].high_pc)
+    return ranges[lo - 1].data;
+  return NULL;
+}
+
 /* Parse each function die in a compilation unit 'aUnit'.
    The first child die of 'aUnit' should be in 'aUnit->first_child',
    the result is placed in 'aUnit->func_list'.
@@ -409,6 +517,41 @@ parse_functions_in_unit (struct dwarf1_debug* stash, struct dwarf1_unit* aUnit)
 	  break;
       }
 
+  aUnit->funcs_parsed = true;
+  return true;
+}
+
+/* Build the sorted address index of the functions in 'aUnit'.
+   Return FALSE if out of memory.  */
+
+static bool
+build_func_ranges (struct dwarf1_debug* stash, struct dwarf1_unit* aUnit)
+{
+  struct dwarf1_func* eachFunc;
+  unsigned long long count = 0;
+  size_t amt;
+
+  for (eachFunc = aUnit->func_list; eachFunc; eachFunc = eachFunc->prev)
+    if (eachFunc->low_pc < eachFunc->high_pc)
+      count++;
+
+  amt = sizeof (struct dwarf1_range) * (count ? count : 1);
+  aUnit->func_ranges = (struct dwarf1_range *) bfd_alloc (stash->abfd, amt);
+  if (!aUnit->func_ranges)
+    return false;
+
+  count = 0;
+  for (eachFunc = aUnit->func_list; eachFunc; eachFunc = eachFunc->prev)
+    if (eachFunc->low_pc < eachFunc->high_pc)
+      {
+	aUnit->func_ranges[count].low_pc = eachFunc->low_pc;
+	aUnit->func_ranges[count].high_pc = eachFunc->high_pc;
+	aUnit->func_ranges[count].data = eachFunc;
+	count++;
+      }
+  aUnit->func_range_count = count;
+  aUnit->funcs_overlap = !sort_dwarf1_ranges (aUnit->func_ranges, count);
+
   return true;
 }
 
@@ -439,35 +582,73 @@ dwarf1_unit_find_nearest_line (struct dwarf1_debug* stash,
 		return false;
 	    }
 
-	  if (! aUnit->func_list)
+	  if (! aUnit->func_list && ! aUnit->funcs_parsed)
 	    {
 	      if (! parse_functions_in_unit (stash, aUnit))
 		return false;
 	    }
 
-	  for (i = 0; i < aUnit->line_count; i++)
+	  if (! aUnit->func_ranges)
 	    {
-	      if (aUnit->linenumber_table[i].addr <= addr
-		  && addr < aUnit->linenumber_table[i+1].addr)
+	      if (! build_func_ranges (stash, aUnit))
+		return false;
+	    }
+
+	  /* Each entry covers the addresses up to the next one, so
+	     the last entry only ends the table.  */
+	  if (aUnit->lines_sorted)
+	    {
+	      unsigned long long lo = 0;
+	      unsigned long long hi = aUnit->line_count;
+
+	      while (lo < hi)
+		{
+		  unsigned long long mid = lo + (hi - lo) / 2;
+
+		  if (aUnit->linenumber_table[mid].addr <= addr)
+		    lo = mid + 1;
+		  else
+		    hi = mid;
+		}
+
+	      if (lo > 0 && lo < aUnit->line_count)
 		{
 		  *filename_ptr = aUnit->name;
-		  *linenumber_ptr = aUnit->linenumber_table[i].linenumber;
+		  *linenumber_ptr = aUnit->linenumber_table[lo - 1].linenumber;
 		  line_p = true;
-		  break;
 		}
 	    }
+	  else
+	    for (i = 0; i + 1 < aUnit->line_count; i++)
+	      {
+		if (aUnit->linenumber_table[i].addr <= addr
+		    && addr < aUnit->linenumber_table[i+1].addr)
+		  {
+		    *filename_ptr = aUnit->name;
+		    *linenumber_ptr = aUnit->linenumber_table[i].linenumber;
+		    line_p = true;
+		    break;
+		  }
+	      }
+
+	  if (! aUnit->funcs_overlap)
+	    eachFunc = ((struct dwarf1_func *)
+			find_dwarf1_range (aUnit->func_ranges,
+					   aUnit->func_range_count, addr));
+	  else
+	    for (eachFunc = aUnit->func_list;
+		 eachFunc;
+		 eachFunc = eachFunc->prev)
+	      {
+		if (eachFunc->low_pc <= addr
+		    && addr < eachFunc->high_pc)
+		  break;
+	      }
 
-	  for (eachFunc = aUnit->func_list;
-	       eachFunc;
-	       eachFunc = eachFunc->prev)
+	  if (eachFunc)
 	    {
-	      if (eachFunc->low_pc <= addr
-		  && addr < eachFunc->high_pc)
-		{
-		  *functionname_ptr = eachFunc->name;
-		  func_p = true;
-		  break;
-		}
+	      *functionname_ptr = eachFunc->name;
+	      func_p = true;
 	    }
 	}
     }
@@ -475,6 +656,61 @@ dwarf1_unit_find_nearest_line (struct dwarf1_debug* stash,
   return line_p || func_p;
 }
 
+/* Find the most recently parsed unit containing 'addr'.  Units
+   parsed since the address index was last built are searched first;
+   the index is rebuilt once they outnumber the units it covers.  */
+
+static struct dwarf1_unit*
+find_parsed_unit (struct dwarf1_debug* stash, unsigned long long addr)
+{
+  struct dwarf1_unit* eachUnit;
+  unsigned long long i;
+
+  if (! stash->units_overlap
+      && stash->unit_count - stash->unit_indexed > 8
+      && stash->unit_count - stash->unit_indexed > stash->unit_indexed)
+    {
+      unsigned long long count = 0;
+
+      free (stash->unit_ranges);
+      stash->unit_ranges = (struct dwarf1_range *)
+	bfd_malloc (sizeof (struct dwarf1_range) * stash->unit_count);
+      stash->unit_range_count = 0;
+      stash->unit_indexed = 0;
+      if (stash->unit_ranges)
+	{
+	  for (eachUnit = stash->lastUnit; eachUnit; eachUnit = eachUnit->prev)
+	    if (eachUnit->low_pc < eachUnit->high_pc)
+	      {
+		stash->unit_ranges[count].low_pc = eachUnit->low_pc;
+		stash->unit_ranges[count].high_pc = eachUnit->high_pc;
+		stash->unit_ranges[count].data = eachUnit;
+		count++;
+	      }
+	  stash->unit_range_count = count;
+	  stash->unit_indexed = stash->unit_count;
+	  if (! sort_dwarf1_ranges (stash->unit_ranges, count))
+	    {
+	      stash->units_overlap = true;
+	      free (stash->unit_ranges);
+	      stash->unit_ranges = NULL;
+	      stash->unit_range_count = 0;
+	      stash->unit_indexed = 0;
+	    }
+	}
+    }
+
+  for (eachUnit = stash->lastUnit, i = stash->unit_count;
+       i > stash->unit_indexed;
+       eachUnit = eachUnit->prev, i--)
+    if (eachUnit->low_pc <= addr && addr < eachUnit->high_pc)
+      return eachUnit;
+
+  return ((struct dwarf1_unit *)
+	  find_dwarf1_range (stash->unit_ranges, stash->unit_range_count,
+			     addr));
+}
+
 /* The DWARF 1 version of find_nearest line.
    Return TRUE if the line is found without error.  */
 
@@ -539,12 +775,12 @@ _bfd_dwarf1_find_nearest_line (bfd *abfd,
 
   /* Look at the previously parsed units to see if any contain
      the addr.  */
-  for (eachUnit = stash->lastUnit; eachUnit; eachUnit = eachUnit->prev)
-    if (eachUnit->low_pc <= addr && addr < eachUnit->high_pc)
-      return dwarf1_unit_find_nearest_line (stash, eachUnit, addr,
-					    filename_ptr,
-					    functionname_ptr,
-					    linenumber_ptr);
+  eachUnit = find_parsed_unit (stash, addr);
+  if (eachUnit)
+    return dwarf1_unit_find_nearest_line (stash, eachUnit, addr,
+					  filename_ptr,
+					  functionname_ptr,
+					  linenumber_ptr);
 
   while (stash->currentDie < stash->debug_section_end)
     {
@@ -604,4 +840,5 @@ _bfd_dwarf1_cleanup_debug_info (bfd *abfd ATTRIBUTE_UNUSED, void **pinfo)
 
   free (stash->debug_section);
   free (stash->line_section);
+  free (stash->unit_ranges);
 }
@@ -32,12 +32,14 @@
 #include "sysdep.h"
 #include "bfd.h"
 #include "libiberty.h"
+#include "safe-ctype.h"
 #include "demangle.h"
 #include "libbfd.h"
 #include "elf-bfd.h"
 #include "dwarf2.h"
 #include "hashtab.h"
-#include "splay-tree.h"
+#include "objalloc.h"
+#include "leb128.h"
 
 /* The data in the .debug_line statement prologue looks like this.  */
 
@@ -102,9 +104,11 @@ struct adjusted_section
    contain pointers to 256 other nodes, keyed by the next byte of the address.
    So for a 64-bit address like 0x1234567abcd, we would start at the root and go
    down child[0x00]->child[0x00]->child[0x01]->child[0x23]->child[0x45] etc.,
-   until we hit a leaf.  (Nodes are, in general, leaves until they exceed the
-   default allocation of 16 elements, at which point they are converted to
-   interior node if possible.) This gives us near-constant lookup times;
+   until we hit a leaf.  (Nodes are, in general, leaves until they exceed
+   16 elements, at which point they are converted to interior node if
+   possible.  Leaves start out smaller and grow until then, since most
+   leaves made by such a conversion only ever hold a range or two.) This
+   gives us near-constant lookup times;
    the only thing that can be costly is if there are lots of overlapping ranges
    within a single 256-byte segment of the binary, in which case we have to
    scan through them all to find the best match.
@@ -114,12 +118,15 @@ struct adjusted_section
    for both small and large binaries.
  */
 
-/* Experiments have shown 16 to be a memory-efficient default leaf size.
-   The only case where a leaf will hold more memory than this, is at the
-   bottomost level (covering 256 bytes in the binary), where we'll expand
-   the leaf to be able to hold more ranges if needed.
+/* Experiments have shown 16 to be a memory-efficient leaf size at which
+   to convert to an interior node.  The only case where a leaf will hold
+   more memory than this, is at the bottomost level (covering 256 bytes
+   in the binary), where we'll expand the leaf to be able to hold more
+   ranges if needed.  Leaves are first allocated with room for
+   TRIE_LEAF_MIN_SIZE ranges, and doubled as they fill.
  */
 #define TRIE_LEAF_SIZE 16
+#define TRIE_LEAF_MIN_SIZE 2
 
 /* All trie_node pointers will really be trie_leaf or trie_interior,
    but they have this common head.  */
@@ -149,53 +156,14 @@ struct trie_interior
 static struct trie_node *alloc_trie_leaf (bfd *abfd)
 {
   struct trie_leaf *leaf;
-  size_t amt = sizeof (*leaf) + TRIE_LEAF_SIZE * sizeof (leaf->ranges[0]);
+  size_t amt = sizeof (*leaf) + TRIE_LEAF_MIN_SIZE * sizeof (leaf->ranges[0]);
   leaf = bfd_zalloc (abfd, amt);
   if (leaf == NULL)
     return NULL;
-  leaf->head.num_room_in_leaf = TRIE_LEAF_SIZE;
+  leaf->head.num_room_in_leaf = TRIE_LEAF_MIN_SIZE;
   return &leaf->head;
 }
 
-struct addr_range
-{
-  bfd_byte *start;
-  bfd_byte *end;
-};
-
-/* Return true if address range do intersect.  */
-
-static bool
-addr_range_intersects (struct addr_range *r1, struct addr_range *r2)
-{
-  return (r1->start <= r2->start && r2->start < r1->end)
-    || (r1->start <= (r2->end - 1) && (r2->end - 1) < r1->end);
-}
-
-/* Compare function for splay tree of addr_ranges.  */
-
-static int
-splay_tree_compare_addr_range (splay_tree_key xa, splay_tree_key xb)
-{
-  struct addr_range *r1 = (struct addr_range *) xa;
-  struct addr_range *r2 = (struct addr_range *) xb;
-
-  if (addr_range_intersects (r1, r2) || addr_range_intersects (r2, r1))
-    return 0;
-  else if (r1->end <= r2->start)
-    return -1;
-  else
-    return 1;
-}
-
-/* Splay tree release function for keys (addr_range).  */
-
-static void
-splay_tree_free_addr_range (splay_tree_key key)
-{
-  free ((struct addr_range *)key);
-}
-
 struct dwarf2_debug_file
 {
   /* The actual bfd from which debug info was loaded.  Might be
@@ -280,8 +248,78 @@ struct dwarf2_debug_file
   /* Root of a trie to map addresses to compilation units.  */
   struct trie_node *trie_root;
 
-  /* Splay tree to map info_ptr address to compilation units.  */
-  splay_tree comp_unit_tree;
+  /* The units read so far, in order of their place in .debug_info,
+     to map an info_ptr address to its unit; how many there are, and
+     how many the array has room for.  Nothing is added once
+     UNITS_COMPLETE is set, so from then on threads look units up
+     without taking a lock.  */
+  struct comp_unit **unit_index;
+  size_t unit_index_count;
+  size_t unit_index_alloc;
+
+  /* Whether every unit in .debug_info has been read.  */
+  bool units_complete;
+
+  /* The address ranges of .debug_aranges sorted by start address,
+     and how many there are.  */
+  struct debug_arange *aranges;
+  size_t aranges_count;
+
+  /* Whether .debug_aranges has been looked at.  */
+  bool aranges_read;
+
+  /* Whether units have been read out of order because of
+     .debug_aranges or a name index, so that stash_comp_unit must skip
+     those it finds already read.  */
+  bool units_out_of_order;
+
+  /* Offsets of the unit headers in .debug_info, in increasing order,
+     and how many there are.  Used to check the unit offsets given by
+     .debug_aranges and the name indexes.  */
+  uint64_t *unit_offsets;
+  size_t unit_offsets_count;
+
+  /* Whether unit_offsets has been filled in.  */
+  bool unit_offsets_read;
+
+  /* Pointer to the .debug_names section loaded into memory.  */
+  bfd_byte *dwarf_names_buffer;
+
+  /* Length of the loaded .debug_names section.  */
+  bfd_size_type dwarf_names_size;
+
+  /* Pointer to the .gdb_index section loaded into memory.  */
+  bfd_byte *gdb_index_buffer;
+
+  /* Length of the loaded .gdb_index section.  */
+  bfd_size_type gdb_index_size;
+
+  /* Whether the name index sections have been looked for.  */
+  bool name_index_read;
+
+  /* Whether this is a DWO or DWARF package file, whose debug sections
+     have names ending in ".dwo".  */
+  bool dwo;
+
+  /* The next of the DWO files opened for split units.  */
+  struct dwarf2_debug_file *next_dwo;
+};
+
+/* The unit index of a DWARF package file, from its .debug_cu_index
+   section.  */
+
+struct dwp_index
+{
+  /* The mapped contents of the section.  */
+  const bfd_byte *data;
+
+  /* Version of the index, 2 for the GNU extension or 5.  */
+  unsigned int version;
+
+  /* Number of section columns, units and hash table slots.  */
+  uint32_t columns;
+  uint32_t units;
+  uint32_t slots;
 };
 
 struct dwarf2_debug
@@ -315,6 +353,21 @@ struct dwarf2_debug
   /* Array of sections with adjusted VMA.  */
   struct adjusted_section *adjusted_sections;
 
+  /* The entry of ADJUSTED_SECTIONS for each section of ORIG_BFD, by
+     index, or NULL for sections not adjusted.  */
+  struct adjusted_section **section_adjustments;
+  unsigned int section_adjustment_count;
+
+  /* Whether the adjusted VMAs are set just now.  A lookup only sets
+     them once it has to read relocated section contents.  */
+  bool sections_placed;
+
+  /* The bias _bfd_dwarf2_find_symbol_bias found with the symbols
+     SYMBOL_BIAS_SYMS, if it has been asked.  */
+  bool symbol_bias_known;
+  asymbol **symbol_bias_syms;
+  bfd_signed_vma symbol_bias;
+
   /* Number of times find_line is called.  This is used in
      the heuristic for enabling the info hash tables.  */
   int info_hash_count;
@@ -336,6 +389,50 @@ struct dwarf2_debug
 #define STASH_INFO_HASH_ON	   1
 #define STASH_INFO_HASH_DISABLED   2
 
+  /* Number of lookups made.  Once there have been enough, and BFD
+     may use several threads, every unit is decoded up front.  */
+  int lookup_count;
+
+#define STASH_PARALLEL_TRIGGER	   100
+
+  /* Whether every unit of the primary file has been decoded.  */
+  bool all_units_read;
+
+  /* Memory the worker threads allocated for the units they decoded.  */
+  struct dwarf_worker_memory *worker_memory;
+
+  /* The line index mapped for the file, if any, and the BFD that owns
+     the mapping.  */
+  const struct line_index_header *line_index;
+  bfd *line_index_bfd;
+
+  /* Functions of the line index, made as lookups return them.  */
+  struct funcinfo **line_index_funcs;
+
+  /* Whether the line index has been looked for.  */
+  bool line_index_tried;
+
+  /* What the DIEs referred to by DW_AT_abstract_origin and
+     DW_AT_specification attributes have been found to say, by DIE.  */
+  htab_t abstract_instances;
+
+  /* The DWARF package file holding the split units of skeleton units,
+     if there is one, and its unit index.  */
+  struct dwarf2_debug_file *dwp;
+  struct dwp_index dwp_index;
+
+  /* Whether the package file has been looked for.  */
+  bool dwp_tried;
+
+  /* The DWO files opened for split units not found in a package.  */
+  struct dwarf2_debug_file *dwo_files;
+
+  /* The units with decoded tables in memory of their own, most
+     recently used first, and the size of those tables in all, for
+     keeping within bfd_get_dwarf_memory_budget.  */
+  struct comp_unit *lru_first, *lru_last;
+  size_t decoded_size;
+
   /* True if we opened bfd_ptr.  */
   bool close_on_cleanup;
 };
@@ -347,6 +444,33 @@ struct arange
   bfd_vma high;
 };
 
+/* The entries of .debug_str_offsets, .debug_addr or .debug_rnglists
+   that the indexed forms of a unit refer to, checked against the
+   section once rather than for each attribute.  BASE, NULL until the
+   section is read, is where entry zero is, and COUNT how many whole
+   entries follow it in the section.  OFFSET is the base offset of
+   the unit they were found for.  */
+
+struct unit_index
+{
+  bfd_byte *base;
+  size_t count;
+  size_t offset;
+};
+
+/* An address range from .debug_aranges.  */
+
+struct debug_arange
+{
+  bfd_vma low;
+  bfd_vma high;
+  /* The highest HIGH of this and all earlier ranges in sort order.  */
+  bfd_vma max_high;
+  /* Offset of the header of the unit covering the range in
+     .debug_info.  */
+  uint64_t info_offset;
+};
+
 /* A minimal decoding of DWARF2 compilation units.  We only decode
    what's needed to get to the line number information.  */
 
@@ -371,11 +495,15 @@ struct comp_unit
      unit as specified in the compilation unit header.  */
   struct arange arange;
 
+  /* Ranges of the unit or its functions found while it was decoded on
+     a worker thread, still to be added to the trie.  */
+  struct arange *pending_ranges;
+
   /* The DW_AT_name attribute (for error messages).  */
   char *name;
 
-  /* The abbrev hash table.  */
-  struct abbrev_info **abbrevs;
+  /* The abbrev table.  */
+  struct abbrev_table *abbrevs;
 
   /* DW_AT_language.  */
   int lang;
@@ -405,6 +533,11 @@ struct comp_unit
   /* The decoded line number, NULL if not yet decoded.  */
   struct line_info_table *line_table;
 
+  /* Whether the DIEs have been scanned for functions and variables.
+     Line info is often wanted without them, so this may be done
+     after the line info is decoded, or never.  */
+  bool symbols_scanned;
+
   /* A list of the functions found in this comp. unit.  */
   struct funcinfo *function_table;
 
@@ -446,6 +579,44 @@ struct comp_unit
 
   /* Base address of string offset table.  */
   size_t dwarf_str_offset;
+
+  /* Base address of the range list offset table.  */
+  size_t dwarf_rnglists_offset;
+
+  /* Base that the DW_AT_ranges offsets of a pre-DWARF 5 split unit
+     are relative to, from its skeleton's DW_AT_GNU_ranges_base.  */
+  size_t dwarf_ranges_offset;
+
+  /* The tables the three bases above point into, once used.  */
+  struct unit_index addr_index;
+  struct unit_index str_index;
+  struct unit_index rnglists_index;
+
+  /* For a skeleton unit, the DW_AT_dwo_name and DWO id of the split
+     unit holding its DIEs, and that unit once it has been read.  */
+  char *dwo_name;
+  uint64_t dwo_id;
+  bool has_dwo_id;
+  bool split_unit_read;
+  struct comp_unit *split_unit;
+
+  /* For a split unit, the skeleton unit it belongs to.  */
+  struct comp_unit *skeleton;
+
+  /* When there is a DWARF memory budget, the memory the line table,
+     functions and variables of the unit were allocated from, so that
+     they can be dropped, and how much of it they use.  */
+  struct objalloc *memory;
+  size_t decoded_size;
+
+  /* Chain of the units of the stash with memory of their own.  */
+  struct comp_unit *lru_prev, *lru_next;
+
+  /* Whether the ranges of the line table, and of the functions, have
+     been added to the trie.  They stay there when the tables are
+     dropped.  */
+  bool line_ranges_known;
+  bool symbol_ranges_known;
 };
 
 /* This data structure holds the information of an abbrev.  */
@@ -480,6 +651,7 @@ const struct dwarf_debug_section dwarf_debug_sections[] =
   { ".debug_loc",		".zdebug_loc" },
   { ".debug_macinfo",		".zdebug_macinfo" },
   { ".debug_macro",		".zdebug_macro" },
+  { ".debug_names",		".zdebug_names" },
   { ".debug_pubnames",		".zdebug_pubnames" },
   { ".debug_pubtypes",		".zdebug_pubtypes" },
   { ".debug_ranges",		".zdebug_ranges" },
@@ -500,6 +672,8 @@ const struct dwarf_debug_section dwarf_debug_sections[] =
   { ".debug_typenames",		".zdebug_typenames" },
   { ".debug_varnames",		".zdebug_varnames" },
   { ".debug_weaknames",		".zdebug_weaknames" },
+  /* GDB extensions */
+  { ".gdb_index",		".gdb_index" },
   { NULL,			NULL },
 };
 
@@ -516,6 +690,7 @@ enum dwarf_debug_section_enum
   debug_loc,
   debug_macinfo,
   debug_macro,
+  debug_names,
   debug_pubnames,
   debug_pubtypes,
   debug_ranges,
@@ -534,6 +709,7 @@ enum dwarf_debug_section_enum
   debug_typenames,
   debug_varnames,
   debug_weaknames,
+  gdb_index,
   debug_max
 };
 
@@ -541,12 +717,57 @@ enum dwarf_debug_section_enum
 extern int dwarf_debug_section_assert[ARRAY_SIZE (dwarf_debug_sections)
 				      == debug_max + 1 ? 1 : -1];
 
-#ifndef ABBREV_HASH_SIZE
-#define ABBREV_HASH_SIZE 121
-#endif
-#ifndef ATTR_ALLOC_CHUNK
-#define ATTR_ALLOC_CHUNK 4
-#endif
+/* The names of the debug sections of DWO and DWARF package files,
+   indexed like dwarf_debug_sections[].  */
+
+static const struct dwarf_debug_section dwo_debug_sections[] =
+{
+  { ".debug_abbrev.dwo",	".zdebug_abbrev.dwo" },
+  { ".debug_aranges.dwo",	".zdebug_aranges.dwo" },
+  { ".debug_frame.dwo",		".zdebug_frame.dwo" },
+  { ".debug_info.dwo",		".zdebug_info.dwo" },
+  { ".debug_info.dwo",		".zdebug_info.dwo" },
+  { ".debug_line.dwo",		".zdebug_line.dwo" },
+  { ".debug_loc.dwo",		".zdebug_loc.dwo" },
+  { ".debug_macinfo.dwo",	".zdebug_macinfo.dwo" },
+  { ".debug_macro.dwo",		".zdebug_macro.dwo" },
+  { ".debug_names.dwo",		".zdebug_names.dwo" },
+  { ".debug_pubnames.dwo",	".zdebug_pubnames.dwo" },
+  { ".debug_pubtypes.dwo",	".zdebug_pubtypes.dwo" },
+  { ".debug_ranges.dwo",	".zdebug_ranges.dwo" },
+  { ".debug_rnglists.dwo",	".zdebug_rnglists.dwo" },
+  { ".debug_static_func.dwo",	".zdebug_static_func.dwo" },
+  { ".debug_static_vars.dwo",	".zdebug_static_vars.dwo" },
+  { ".debug_str.dwo",		".zdebug_str.dwo" },
+  { ".debug_str.dwo",		".zdebug_str.dwo" },
+  { ".debug_str_offsets.dwo",	".zdebug_str_offsets.dwo" },
+  { ".debug_addr.dwo",		".zdebug_addr.dwo" },
+  { ".debug_line_str.dwo",	".zdebug_line_str.dwo" },
+  { ".debug_types.dwo",		".zdebug_types.dwo" },
+  { ".debug_sfnames.dwo",	".zdebug_sfnames.dwo" },
+  { ".debug_srcinfo.dwo",	".zdebug_srcinfo.dwo" },
+  { ".debug_funcnames.dwo",	".zdebug_funcnames.dwo" },
+  { ".debug_typenames.dwo",	".zdebug_typenames.dwo" },
+  { ".debug_varnames.dwo",	".zdebug_varnames.dwo" },
+  { ".debug_weaknames.dwo",	".zdebug_weaknames.dwo" },
+  { ".gdb_index.dwo",		".gdb_index.dwo" },
+  { NULL,			NULL },
+};
+
+extern int dwo_debug_section_assert[ARRAY_SIZE (dwo_debug_sections)
+				    == debug_max + 1 ? 1 : -1];
+
+/* Return the names of debug section SEC in FILE of STASH.  */
+
+static inline const struct dwarf_debug_section *
+file_debug_section (struct dwarf2_debug *stash,
+		    struct dwarf2_debug_file *file,
+		    enum dwarf_debug_section_enum sec)
+{
+  if (file->dwo)
+    return &dwo_debug_sections[sec];
+  return &stash->debug_sections[sec];
+}
 
 /* Variable and function hash tables.  This is used to speed up look-up
    in lookup_symbol_in_var_table() and lookup_symbol_in_function_table().
@@ -671,6 +892,76 @@ lookup_info_hash_table (struct info_hash_table *hash_table, const char *key)
   return entry ? entry->head : NULL;
 }
 
+/* Memory allocated on a worker thread while decoding units, which is
+   freed with the stash.  */
+
+struct dwarf_worker_memory
+{
+  struct dwarf_worker_memory *next;
+  struct objalloc *memory;
+};
+
+/* While units are decoded on worker threads, the objalloc that this
+   thread allocates from in place of the BFD's own memory, which may
+   not be used from several threads.  */
+static TLS struct objalloc *dwarf_thread_memory;
+
+/* Serializes the worker threads' use of state shared between units.  */
+static bfd_mutex dwarf_worker_lock = BFD_MUTEX_INIT;
+
+/* The unit whose tables are being decoded into its own memory, if
+   any; see comp_unit_alloc_begin.  */
+static TLS struct comp_unit *dwarf_alloc_unit;
+
+/* The stash a lookup is being made in, if its sections have VMAs to
+   set before relocated section contents are read; see
+   stash_section_vma.  */
+static TLS struct dwarf2_debug *dwarf_place_stash;
+
+static bool place_sections (bfd *, struct dwarf2_debug *);
+
+/* Allocate SIZE bytes of memory for the DWARF info of ABFD.  */
+
+static void *
+dwarf_alloc (bfd *abfd, size_t size)
+{
+  struct objalloc *memory = dwarf_thread_memory;
+  void *ret;
+
+  if (memory == NULL && dwarf_alloc_unit != NULL)
+    memory = dwarf_alloc_unit->memory;
+  if (memory == NULL)
+    {
+      enum bfd_memory_class old_class;
+
+      old_class = _bfd_set_memory_class (bfd_memory_dwarf);
+      ret = bfd_alloc (abfd, size);
+      _bfd_set_memory_class (old_class);
+      return ret;
+    }
+  ret = objalloc_alloc (memory, size);
+  if (ret == NULL)
+    bfd_set_error (bfd_error_no_memory);
+  else if (memory != dwarf_thread_memory)
+    {
+      dwarf_alloc_unit->decoded_size += size;
+      dwarf_alloc_unit->stash->decoded_size += size;
+    }
+  return ret;
+}
+
+/* Likewise, but clear the memory.  */
+
+static void *
+dwarf_zalloc (bfd *abfd, size_t size)
+{
+  void *ret = dwarf_alloc (abfd, size);
+
+  if (ret != NULL)
+    memset (ret, 0, size);
+  return ret;
+}
+
 /* Read a section into its appropriate place in the dwarf2_debug
    struct (indicated by SECTION_BUFFER and SECTION_SIZE).  If SYMS is
    not NULL, use bfd_simple_get_relocated_section_contents to read the
@@ -737,10 +1028,19 @@ read_section (bfd *abfd,
       contents = (bfd_byte *) bfd_malloc (amt);
       if (contents == NULL)
 	return false;
+      /* Relocating the contents needs the VMAs of the sections.  */
+      if (syms != NULL
+	  && dwarf_place_stash != NULL
+	  && !place_sections (dwarf_place_stash->orig_bfd, dwarf_place_stash))
+	{
+	  free (contents);
+	  return false;
+	}
       if (syms
 	  ? !bfd_simple_get_relocated_section_contents (abfd, msec, contents,
 							syms)
-	  : !bfd_get_section_contents (abfd, msec, contents, 0, *section_size))
+	  : !bfd_get_decompressed_section_contents (abfd, msec, contents,
+						    0, *section_size))
 	{
 	  free (contents);
 	  return false;
@@ -765,6 +1065,26 @@ read_section (bfd *abfd,
   return true;
 }
 
+/* Like read_section, but quietly return FALSE if ABFD has no section
+   SEC with contents.  */
+
+static bool
+read_optional_section (bfd *abfd,
+		       const struct dwarf_debug_section *sec,
+		       asymbol **syms,
+		       bfd_byte **section_buffer,
+		       bfd_size_type *section_size)
+{
+  asection *msec;
+
+  msec = bfd_get_section_by_name (abfd, sec->uncompressed_name);
+  if (msec == NULL)
+    msec = bfd_get_section_by_name (abfd, sec->compressed_name);
+  if (msec == NULL || (msec->flags & SEC_HAS_CONTENTS) == 0)
+    return false;
+  return read_section (abfd, sec, syms, 0, section_buffer, section_size);
+}
+
 /* Read dwarf information from a buffer.  */
 
 static inline uint64_t
@@ -838,7 +1158,7 @@ read_blk (bfd *abfd, bfd_byte **ptr, bfd_byte *end, size_t size)
   bfd_byte *buf = *ptr;
   struct dwarf_block *block;
 
-  block = (struct dwarf_block *) bfd_alloc (abfd, sizeof (*block));
+  block = (struct dwarf_block *) dwarf_alloc (abfd, sizeof (*block));
   if (block == NULL)
     return NULL;
 
@@ -911,7 +1231,8 @@ read_indirect_string (struct comp_unit *unit,
   else
     offset = read_8_bytes (unit->abfd, ptr, buf_end);
 
-  if (! read_section (unit->abfd, &stash->debug_sections[debug_str],
+  if (! read_section (unit->abfd,
+		      file_debug_section (stash, file, debug_str),
 		      file->syms, offset,
 		      &file->dwarf_str_buffer, &file->dwarf_str_size))
     return NULL;
@@ -945,7 +1266,8 @@ read_indirect_line_string (struct comp_unit *unit,
   else
     offset = read_8_bytes (unit->abfd, ptr, buf_end);
 
-  if (! read_section (unit->abfd, &stash->debug_sections[debug_line_str],
+  if (! read_section (unit->abfd,
+		      file_debug_section (stash, file, debug_line_str),
 		      file->syms, offset,
 		      &file->dwarf_line_str_buffer,
 		      &file->dwarf_line_str_size))
@@ -1104,17 +1426,44 @@ read_address (struct comp_unit *unit, bfd_byte **ptr, bfd_byte *buf_end)
     }
 }
 
-/* Lookup an abbrev_info structure in the abbrev hash table.  */
+/* A decoded abbrev table.  Tables are keyed by their encoded contents
+   rather than by section offset, so units in any BFD whose abbrevs are
+   identical (as is common with LTO and dwz output) share one table.  */
+
+struct abbrev_table
+{
+  /* Hash of, size of and a copy of the encoded abbrevs.  */
+  hashval_t hash;
+  size_t size;
+  bfd_byte *data;
+
+  /* The number of abbrev_offset_entry structs using this table.  */
+  unsigned int refcount;
+
+  /* When DIRECT, SLOTS is indexed by abbrev number.  Otherwise it has
+     a power of two NUM_SLOTS chains, hashed on the abbrev number.  */
+  bool direct;
+  unsigned int num_slots;
+  struct abbrev_info **slots;
+};
+
+/* All the abbrev tables in use, by any BFD.  */
+static htab_t abbrev_tables;
+
+/* Serializes access to abbrev_tables and the table reference counts.  */
+static bfd_mutex abbrev_tables_lock = BFD_MUTEX_INIT;
+
+/* Lookup an abbrev_info structure in an abbrev table.  */
 
 static struct abbrev_info *
-lookup_abbrev (unsigned int number, struct abbrev_info **abbrevs)
+lookup_abbrev (unsigned int number, struct abbrev_table *abbrevs)
 {
-  unsigned int hash_number;
   struct abbrev_info *abbrev;
 
-  hash_number = number % ABBREV_HASH_SIZE;
-  abbrev = abbrevs[hash_number];
+  if (abbrevs->direct)
+    return number < abbrevs->num_slots ? abbrevs->slots[number] : NULL;
 
+  abbrev = abbrevs->slots[number & (abbrevs->num_slots - 1)];
   while (abbrev)
     {
       if (abbrev->number == number)
@@ -1126,14 +1475,49 @@ lookup_abbrev (unsigned int number, struct abbrev_info **abbrevs)
   return NULL;
 }
 
+static hashval_t
+hash_abbrev_table (const void *p)
+{
+  const struct abbrev_table *table = p;
+  return table->hash;
+}
+
+static int
+eq_abbrev_table (const void *pa, const void *pb)
+{
+  const struct abbrev_table *a = pa;
+  const struct abbrev_table *b = pb;
+  return (a->size == b->size
+	  && memcmp (a->data, b->data, a->size) == 0);
+}
+
+/* Drop a reference to TABLE, freeing it when no unit uses it.  */
+
+static void
+release_abbrev_table (struct abbrev_table *table)
+{
+  _bfd_mutex_lock (&abbrev_tables_lock);
+  if (--table->refcount == 0)
+    {
+      htab_remove_elt_with_hash (abbrev_tables, table, table->hash);
+      free (table);
+      if (htab_elements (abbrev_tables) == 0)
+	{
+	  htab_delete (abbrev_tables);
+	  abbrev_tables = NULL;
+	}
+    }
+  _bfd_mutex_unlock (&abbrev_tables_lock);
+}
+
 /* We keep a hash table to map .debug_abbrev section offsets to the
-   array of abbrevs, so that compilation units using the same set of
-   abbrevs do not waste memory.  */
+   abbrev table found there, so that compilation units using the same
+   set of abbrevs do not need to look it up again.  */
 
 struct abbrev_offset_entry
 {
   size_t offset;
-  struct abbrev_info **abbrevs;
+  struct abbrev_table *abbrevs;
 };
 
 static hashval_t
@@ -1155,121 +1539,178 @@ static void
 del_abbrev (void *p)
 {
   struct abbrev_offset_entry *ent = p;
-  struct abbrev_info **abbrevs = ent->abbrevs;
-  size_t i;
 
-  for (i = 0; i < ABBREV_HASH_SIZE; i++)
-    {
-      struct abbrev_info *abbrev = abbrevs[i];
+  release_abbrev_table (ent->abbrevs);
+  free (ent);
+}
+
+/* Find the end of the abbrevs starting at ABBREV_PTR, counting the
+   abbrevs and attributes on the way, and finding the largest abbrev
+   number.  This stops where read_abbrevs would, except that it does
+   not look for repeated abbrev numbers.  */
+
+static bfd_byte *
+scan_abbrevs (bfd *abfd, bfd_byte *abbrev_ptr, bfd_byte *abbrev_end,
+	      size_t *num_abbrevs, size_t *num_attrs,
+	      unsigned int *max_number)
+{
+  unsigned int abbrev_number;
 
-      while (abbrev)
+  *num_abbrevs = 0;
+  *num_attrs = 0;
+  *max_number = 0;
+  abbrev_number = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
+					 false, abbrev_end);
+  while (abbrev_number)
+    {
+      ++*num_abbrevs;
+      if (abbrev_number > *max_number)
+	*max_number = abbrev_number;
+      (void) _bfd_safe_read_leb128 (abfd, &abbrev_ptr, false, abbrev_end);
+      (void) read_1_byte (abfd, &abbrev_ptr, abbrev_end);
+      for (;;)
 	{
-	  free (abbrev->attrs);
-	  abbrev = abbrev->next;
+	  unsigned int abbrev_name, abbrev_form;
+
+	  abbrev_name = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
+					       false, abbrev_end);
+	  abbrev_form = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
+					       false, abbrev_end);
+	  if (abbrev_form == DW_FORM_implicit_const)
+	    (void) _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
+					  true, abbrev_end);
+	  if (abbrev_name == 0)
+	    break;
+	  ++*num_attrs;
 	}
+      if (abbrev_ptr >= abbrev_end)
+	break;
+      abbrev_number = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
+					     false, abbrev_end);
     }
-  free (ent);
+  return abbrev_ptr;
 }
 
-/* In DWARF version 2, the description of the debugging information is
-   stored in a separate .debug_abbrev section.  Before we read any
-   dies from a section we read in all abbreviations and install them
-   in a hash table.  */
+#define ABBREV_ALIGN(x) \
+  (((x) + sizeof (bfd_vma) - 1) & ~(size_t) (sizeof (bfd_vma) - 1))
 
-static struct abbrev_info**
-read_abbrevs (bfd *abfd, uint64_t offset, struct dwarf2_debug *stash,
-	      struct dwarf2_debug_file *file)
+/* Decode the SIZE bytes of abbrevs at ABBREV_PTR into a new table,
+   allocated in one block sized for the NUM_ABBREVS abbrevs and
+   NUM_ATTRS attributes found by scan_abbrevs.  */
+
+static struct abbrev_table *
+decode_abbrevs (bfd *abfd, bfd_byte *abbrev_ptr, size_t size,
+		hashval_t hash, size_t num_abbrevs, size_t num_attrs,
+		unsigned int max_number)
 {
-  struct abbrev_info **abbrevs;
-  bfd_byte *abbrev_ptr;
-  bfd_byte *abbrev_end;
+  struct abbrev_table *table;
   struct abbrev_info *cur_abbrev;
-  unsigned int abbrev_number, abbrev_name;
-  unsigned int abbrev_form, hash_number;
-  size_t amt;
-  void **slot;
-  struct abbrev_offset_entry ent = { offset, NULL };
-
-  if (ent.offset != offset)
-    return NULL;
-
-  slot = htab_find_slot (file->abbrev_offsets, &ent, INSERT);
-  if (slot == NULL)
-    return NULL;
-  if (*slot != NULL)
-    return ((struct abbrev_offset_entry *) (*slot))->abbrevs;
+  struct attr_abbrev *cur_attr;
+  bfd_byte *abbrev_end = abbrev_ptr + size;
+  unsigned int abbrev_number, num_slots;
+  size_t slots_size, abbrevs_size, attrs_size, amt;
+  bool direct;
+
+  /* Index the table directly by abbrev number when the numbers are
+     reasonably dense, as they nearly always are.  */
+  direct = max_number / 2 <= num_abbrevs;
+  if (direct)
+    num_slots = max_number + 1;
+  else
+    for (num_slots = 1; num_slots < num_abbrevs; num_slots <<= 1)
+      ;
 
-  if (! read_section (abfd, &stash->debug_sections[debug_abbrev],
-		      file->syms, offset,
-		      &file->dwarf_abbrev_buffer,
-		      &file->dwarf_abbrev_size))
+  if (_bfd_mul_overflow (num_slots, sizeof (struct abbrev_info *),
+			 &slots_size)
+      || _bfd_mul_overflow (num_abbrevs, sizeof (struct abbrev_info),
+			    &abbrevs_size)
+      || _bfd_mul_overflow (num_attrs, sizeof (struct attr_abbrev),
+			    &attrs_size))
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return NULL;
+    }
+  amt = (ABBREV_ALIGN (sizeof (*table)) + ABBREV_ALIGN (slots_size)
+	 + ABBREV_ALIGN (abbrevs_size) + ABBREV_ALIGN (attrs_size) + size);
+  table = (struct abbrev_table *) bfd_zmalloc (amt);
+  if (table == NULL)
     return NULL;
 
-  amt = sizeof (struct abbrev_info*) * ABBREV_HASH_SIZE;
-  abbrevs = (struct abbrev_info **) bfd_zalloc (abfd, amt);
-  if (abbrevs == NULL)
-    return NULL;
+  table->hash = hash;
+  table->size = size;
+  table->refcount = 1;
+  table->direct = direct;
+  table->num_slots = num_slots;
+  table->slots = (struct abbrev_info **) ((char *) table
+					  + ABBREV_ALIGN (sizeof (*table)));
+  cur_abbrev = (struct abbrev_info *) ((char *) table->slots
+				       + ABBREV_ALIGN (slots_size));
+  cur_attr = (struct attr_abbrev *) ((char *) cur_abbrev
+				     + ABBREV_ALIGN (abbrevs_size));
+  table->data = (bfd_byte *) cur_attr + ABBREV_ALIGN (attrs_size);
+  memcpy (table->data, abbrev_ptr, size);
 
-  abbrev_ptr = file->dwarf_abbrev_buffer + offset;
-  abbrev_end = file->dwarf_abbrev_buffer + file->dwarf_abbrev_size;
   abbrev_number = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
 					 false, abbrev_end);
 
   /* Loop until we reach an abbrev number of 0.  */
   while (abbrev_number)
     {
-      amt = sizeof (struct abbrev_info);
-      cur_abbrev = (struct abbrev_info *) bfd_zalloc (abfd, amt);
-      if (cur_abbrev == NULL)
-	goto fail;
-
       /* Read in abbrev header.  */
       cur_abbrev->number = abbrev_number;
       cur_abbrev->tag = (enum dwarf_tag)
 	_bfd_safe_read_leb128 (abfd, &abbrev_ptr,
 			       false, abbrev_end);
       cur_abbrev->has_children = read_1_byte (abfd, &abbrev_ptr, abbrev_end);
+      cur_abbrev->attrs = cur_attr;
 
       /* Now read in declarations.  */
       for (;;)
 	{
 	  /* Initialize it just to avoid a GCC false warning.  */
 	  bfd_vma implicit_const = -1;
+	  unsigned int abbrev_name, abbrev_form;
+	  uint64_t pair[2];
+	  size_t len;
 
-	  abbrev_name = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
-					       false, abbrev_end);
-	  abbrev_form = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
-					       false, abbrev_end);
+	  /* Take the name and form together.  */
+	  len = leb128_read_unsigned_array (abbrev_ptr, abbrev_end, pair, 2);
+	  if (len != 0)
+	    {
+	      abbrev_name = pair[0];
+	      abbrev_form = pair[1];
+	      abbrev_ptr += len;
+	    }
+	  else
+	    {
+	      abbrev_name = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
+						   false, abbrev_end);
+	      abbrev_form = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
+						   false, abbrev_end);
+	    }
 	  if (abbrev_form == DW_FORM_implicit_const)
 	    implicit_const = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
 						    true, abbrev_end);
 	  if (abbrev_name == 0)
 	    break;
 
-	  if ((cur_abbrev->num_attrs % ATTR_ALLOC_CHUNK) == 0)
-	    {
-	      struct attr_abbrev *tmp;
-
-	      amt = cur_abbrev->num_attrs + ATTR_ALLOC_CHUNK;
-	      amt *= sizeof (struct attr_abbrev);
-	      tmp = (struct attr_abbrev *) bfd_realloc (cur_abbrev->attrs, amt);
-	      if (tmp == NULL)
-		goto fail;
-	      cur_abbrev->attrs = tmp;
-	    }
-
-	  cur_abbrev->attrs[cur_abbrev->num_attrs].name
-	    = (enum dwarf_attribute) abbrev_name;
-	  cur_abbrev->attrs[cur_abbrev->num_attrs].form
-	    = (enum dwarf_form) abbrev_form;
-	  cur_abbrev->attrs[cur_abbrev->num_attrs].implicit_const
-	    = implicit_const;
+	  cur_attr->name = (enum dwarf_attribute) abbrev_name;
+	  cur_attr->form = (enum dwarf_form) abbrev_form;
+	  cur_attr->implicit_const = implicit_const;
+	  ++cur_attr;
 	  ++cur_abbrev->num_attrs;
 	}
 
-      hash_number = abbrev_number % ABBREV_HASH_SIZE;
-      cur_abbrev->next = abbrevs[hash_number];
-      abbrevs[hash_number] = cur_abbrev;
+      if (direct)
+	table->slots[abbrev_number] = cur_abbrev;
+      else
+	{
+	  unsigned int hash_number = abbrev_number & (num_slots - 1);
+
+	  cur_abbrev->next = table->slots[hash_number];
+	  table->slots[hash_number] = cur_abbrev;
+	}
+      ++cur_abbrev;
 
       /* Get next abbreviation.
 	 Under Irix6 the abbreviations for a compilation unit are not
@@ -1278,45 +1719,108 @@ read_abbrevs (bfd *abfd, uint64_t offset, struct dwarf2_debug *stash,
 	 already read (which means we are about to read the abbreviations
 	 for the next compile unit) or if the end of the abbreviation
 	 table is reached.  */
-      if ((size_t) (abbrev_ptr - file->dwarf_abbrev_buffer)
-	  >= file->dwarf_abbrev_size)
+      if (abbrev_ptr >= abbrev_end)
 	break;
       abbrev_number = _bfd_safe_read_leb128 (abfd, &abbrev_ptr,
 					     false, abbrev_end);
-      if (lookup_abbrev (abbrev_number, abbrevs) != NULL)
+      if (lookup_abbrev (abbrev_number, table) != NULL)
 	break;
     }
 
-  *slot = bfd_malloc (sizeof ent);
-  if (!*slot)
-    goto fail;
-  ent.abbrevs = abbrevs;
-  memcpy (*slot, &ent, sizeof ent);
-  return abbrevs;
+  return table;
+}
 
- fail:
-  if (abbrevs != NULL)
-    {
-      size_t i;
+/* In DWARF version 2, the description of the debugging information is
+   stored in a separate .debug_abbrev section.  Before we read any
+   dies from a section we read in all abbreviations and install them
+   in a hash table.  Tables are shared with any other unit, in this or
+   another BFD, that has the same abbrevs, so that each distinct set
+   is only decoded once.  */
 
-      for (i = 0; i < ABBREV_HASH_SIZE; i++)
-	{
-	  struct abbrev_info *abbrev = abbrevs[i];
+static struct abbrev_table *
+read_abbrevs (bfd *abfd, uint64_t offset, struct dwarf2_debug *stash,
+	      struct dwarf2_debug_file *file)
+{
+  struct abbrev_table *abbrevs;
+  struct abbrev_table key;
+  bfd_byte *abbrev_ptr;
+  bfd_byte *abbrev_end;
+  size_t num_abbrevs, num_attrs;
+  unsigned int max_number;
+  void **slot, **table_slot;
+  struct abbrev_offset_entry ent = { offset, NULL };
 
-	  while (abbrev)
-	    {
-	      free (abbrev->attrs);
-	      abbrev = abbrev->next;
-	    }
-	}
-      free (abbrevs);
-    }
-  return NULL;
-}
+  if (ent.offset != offset)
+    return NULL;
 
-/* Returns true if the form is one which has a string value.  */
+  slot = htab_find_slot (file->abbrev_offsets, &ent, INSERT);
+  if (slot == NULL)
+    return NULL;
+  if (*slot != NULL)
+    return ((struct abbrev_offset_entry *) (*slot))->abbrevs;
 
-static bool
+  if (! read_section (abfd,
+		      file_debug_section (stash, file, debug_abbrev),
+		      file->syms, offset,
+		      &file->dwarf_abbrev_buffer,
+		      &file->dwarf_abbrev_size))
+    return NULL;
+
+  abbrev_ptr = file->dwarf_abbrev_buffer + offset;
+  abbrev_end = file->dwarf_abbrev_buffer + file->dwarf_abbrev_size;
+  key.data = abbrev_ptr;
+  key.size = scan_abbrevs (abfd, abbrev_ptr, abbrev_end,
+			   &num_abbrevs, &num_attrs, &max_number) - abbrev_ptr;
+  key.hash = iterative_hash (key.data, key.size, 0);
+
+  _bfd_mutex_lock (&abbrev_tables_lock);
+  if (abbrev_tables == NULL)
+    {
+      abbrev_tables = htab_create_alloc (10, hash_abbrev_table,
+					 eq_abbrev_table, NULL, calloc, free);
+      if (abbrev_tables == NULL)
+	{
+	  _bfd_mutex_unlock (&abbrev_tables_lock);
+	  bfd_set_error (bfd_error_no_memory);
+	  return NULL;
+	}
+    }
+  table_slot = htab_find_slot_with_hash (abbrev_tables, &key, key.hash,
+					 INSERT);
+  if (table_slot == NULL)
+    abbrevs = NULL;
+  else if (*table_slot != NULL)
+    {
+      abbrevs = (struct abbrev_table *) *table_slot;
+      abbrevs->refcount++;
+    }
+  else
+    {
+      abbrevs = decode_abbrevs (abfd, abbrev_ptr, key.size, key.hash,
+				num_abbrevs, num_attrs, max_number);
+      if (abbrevs != NULL)
+	*table_slot = abbrevs;
+      else
+	htab_clear_slot (abbrev_tables, table_slot);
+    }
+  _bfd_mutex_unlock (&abbrev_tables_lock);
+  if (abbrevs == NULL)
+    return NULL;
+
+  *slot = bfd_malloc (sizeof ent);
+  if (!*slot)
+    {
+      release_abbrev_table (abbrevs);
+      return NULL;
+    }
+  ent.abbrevs = abbrevs;
+  memcpy (*slot, &ent, sizeof ent);
+  return abbrevs;
+}
+
+/* Returns true if the form is one which has a string value.  */
+
+static bool
 is_str_form (const struct attribute *attr)
 {
   switch (attr->form)
@@ -1330,6 +1834,7 @@ is_str_form (const struct attribute *attr)
     case DW_FORM_strx4:
     case DW_FORM_line_strp:
     case DW_FORM_GNU_strp_alt:
+    case DW_FORM_GNU_str_index:
       return true;
 
     default:
@@ -1368,6 +1873,7 @@ is_int_form (const struct attribute *attr)
     case DW_FORM_addrx3:
     case DW_FORM_addrx4:
     case DW_FORM_GNU_ref_alt:
+    case DW_FORM_GNU_addr_index:
       return true;
 
     default:
@@ -1375,7 +1881,8 @@ is_int_form (const struct attribute *attr)
     }
 }
 
-/* Returns true if the form is strx[1-4].  */
+/* Returns true if the form is strx[1-4], or its pre-DWARF 5 split
+   DWARF equivalent.  */
 
 static inline bool
 is_strx_form (enum dwarf_form form)
@@ -1384,10 +1891,12 @@ is_strx_form (enum dwarf_form form)
 	  || form == DW_FORM_strx1
 	  || form == DW_FORM_strx2
 	  || form == DW_FORM_strx3
-	  || form == DW_FORM_strx4);
+	  || form == DW_FORM_strx4
+	  || form == DW_FORM_GNU_str_index);
 }
 
-/* Return true if the form is addrx[1-4].  */
+/* Return true if the form is addrx[1-4], or its pre-DWARF 5 split
+   DWARF equivalent.  */
 
 static inline bool
 is_addrx_form (enum dwarf_form form)
@@ -1396,44 +1905,114 @@ is_addrx_form (enum dwarf_form form)
 	  || form == DW_FORM_addrx1
 	  || form == DW_FORM_addrx2
 	  || form == DW_FORM_addrx3
-	  || form == DW_FORM_addrx4);
+	  || form == DW_FORM_addrx4
+	  || form == DW_FORM_GNU_addr_index);
+}
+
+/* Return true if the DW_AT_addr_base of UNIT is known.  A zero
+   dwarf_addr_offset means the attribute is not yet read, except in a
+   split unit, which has the base of its skeleton from the start.  */
+
+static inline bool
+addr_base_known (const struct comp_unit *unit)
+{
+  return unit->dwarf_addr_offset != 0 || unit->skeleton != NULL;
+}
+
+/* Likewise for the DW_AT_str_offsets_base of UNIT.  */
+
+static inline bool
+str_base_known (const struct comp_unit *unit)
+{
+  return unit->dwarf_str_offset != 0 || unit->skeleton != NULL;
+}
+
+/* Return true if UNIT is a skeleton unit, whose DIEs are in a split
+   unit of a DWO or DWARF package file.  */
+
+static inline bool
+comp_unit_is_skeleton (const struct comp_unit *unit)
+{
+  return (unit->skeleton == NULL
+	  && (unit->dwo_name != NULL || unit->has_dwo_id));
+}
+
+/* Return true if INDEX describes the table at OFFSET already.  */
+
+static inline bool
+unit_index_ready (const struct unit_index *index, size_t offset)
+{
+  return index->base != NULL && index->offset == offset;
+}
+
+/* Make INDEX describe the table of entries ENTRY_SIZE bytes long at
+   OFFSET in section SEC of FILE, reading the section into *BUFFER and
+   *SIZE if need be.  An ENTRY_SIZE of zero means the entries can't be
+   read.  Returns FALSE if the section can't be read.  */
+
+static bool
+unit_index_init (struct unit_index *index, bfd *abfd,
+		 struct dwarf2_debug *stash, struct dwarf2_debug_file *file,
+		 enum dwarf_debug_section_enum sec,
+		 bfd_byte **buffer, bfd_size_type *size,
+		 size_t offset, unsigned int entry_size)
+{
+  if (!read_section (abfd, file_debug_section (stash, file, sec),
+		     file->syms, 0, buffer, size))
+    return false;
+
+  if (offset > *size || entry_size == 0)
+    {
+      index->base = *buffer;
+      index->count = 0;
+    }
+  else
+    {
+      index->base = *buffer + offset;
+      index->count = (*size - offset) / entry_size;
+    }
+  index->offset = offset;
+  return true;
 }
 
 /* Returns the address in .debug_addr section using DW_AT_addr_base.
-   Used to implement DW_FORM_addrx*.  */
+   Used to implement DW_FORM_addrx*.  A split unit has no .debug_addr
+   of its own, and uses that of its skeleton.  */
 static uint64_t
 read_indexed_address (uint64_t idx, struct comp_unit *unit)
 {
   struct dwarf2_debug *stash = unit->stash;
-  struct dwarf2_debug_file *file = unit->file;
+  struct comp_unit *aunit = unit->skeleton != NULL ? unit->skeleton : unit;
+  struct dwarf2_debug_file *file = aunit->file;
+  struct unit_index local, *index = &unit->addr_index;
   bfd_byte *info_ptr;
-  size_t offset;
 
   if (stash == NULL)
     return 0;
 
-  if (!read_section (unit->abfd, &stash->debug_sections[debug_addr],
-		     file->syms, 0,
-		     &file->dwarf_addr_buffer, &file->dwarf_addr_size))
-    return 0;
-
-  if (_bfd_mul_overflow (idx, unit->addr_size, &offset))
-    return 0;
+  if (!unit_index_ready (index, unit->dwarf_addr_offset))
+    {
+      /* Worker threads read the DIEs of other units too, so they
+	 don't keep tables stash_read_all_units hasn't found.  */
+      if (dwarf_thread_memory != NULL)
+	index = &local;
+      if (!unit_index_init (index, aunit->abfd, stash, file, debug_addr,
+			    &file->dwarf_addr_buffer, &file->dwarf_addr_size,
+			    unit->dwarf_addr_offset,
+			    (unit->addr_size == 4 || unit->addr_size == 8
+			     ? unit->addr_size : 0)))
+	return 0;
+    }
 
-  offset += unit->dwarf_addr_offset;
-  if (offset < unit->dwarf_addr_offset
-      || offset > file->dwarf_addr_size
-      || file->dwarf_addr_size - offset < unit->addr_size)
+  if (idx >= index->count)
     return 0;
 
-  info_ptr = file->dwarf_addr_buffer + offset;
+  info_ptr = index->base + idx * unit->addr_size;
 
   if (unit->addr_size == 4)
     return bfd_get_32 (unit->abfd, info_ptr);
-  else if (unit->addr_size == 8)
-    return bfd_get_64 (unit->abfd, info_ptr);
   else
-    return 0;
+    return bfd_get_64 (unit->abfd, info_ptr);
 }
 
 /* Returns the string using DW_AT_str_offsets_base.
@@ -1443,47 +2022,84 @@ read_indexed_string (uint64_t idx, struct comp_unit *unit)
 {
   struct dwarf2_debug *stash = unit->stash;
   struct dwarf2_debug_file *file = unit->file;
+  struct unit_index local, *index = &unit->str_index;
   bfd_byte *info_ptr;
   uint64_t str_offset;
-  size_t offset;
 
   if (stash == NULL)
     return NULL;
 
-  if (!read_section (unit->abfd, &stash->debug_sections[debug_str],
-		     file->syms, 0,
-		     &file->dwarf_str_buffer, &file->dwarf_str_size))
-    return NULL;
-
-  if (!read_section (unit->abfd, &stash->debug_sections[debug_str_offsets],
-		     file->syms, 0,
-		     &file->dwarf_str_offsets_buffer,
-		     &file->dwarf_str_offsets_size))
-    return NULL;
-
-  if (_bfd_mul_overflow (idx, unit->offset_size, &offset))
-    return NULL;
+  if (!unit_index_ready (index, unit->dwarf_str_offset))
+    {
+      if (dwarf_thread_memory != NULL)
+	index = &local;
+      if (!read_section (unit->abfd,
+			 file_debug_section (stash, file, debug_str),
+			 file->syms, 0,
+			 &file->dwarf_str_buffer, &file->dwarf_str_size)
+	  || !unit_index_init (index, unit->abfd, stash, file,
+			       debug_str_offsets,
+			       &file->dwarf_str_offsets_buffer,
+			       &file->dwarf_str_offsets_size,
+			       unit->dwarf_str_offset,
+			       (unit->offset_size == 4 || unit->offset_size == 8
+				? unit->offset_size : 0)))
+	return NULL;
+    }
 
-  offset += unit->dwarf_str_offset;
-  if (offset < unit->dwarf_str_offset
-      || offset > file->dwarf_str_offsets_size
-      || file->dwarf_str_offsets_size - offset < unit->offset_size)
+  if (idx >= index->count)
     return NULL;
 
-  info_ptr = file->dwarf_str_offsets_buffer + offset;
+  info_ptr = index->base + idx * unit->offset_size;
 
   if (unit->offset_size == 4)
     str_offset = bfd_get_32 (unit->abfd, info_ptr);
-  else if (unit->offset_size == 8)
-    str_offset = bfd_get_64 (unit->abfd, info_ptr);
   else
-    return NULL;
+    str_offset = bfd_get_64 (unit->abfd, info_ptr);
 
   if (str_offset >= file->dwarf_str_size)
     return NULL;
   return (const char *) file->dwarf_str_buffer + str_offset;
 }
 
+/* Set *OFFSETP to the offset in .debug_rnglists of range list IDX of
+   UNIT, using DW_AT_rnglists_base.  Used to implement DW_FORM_rnglistx.
+   Returns FALSE if the offset can't be read.  */
+static bool
+read_rnglist_offset (uint64_t idx, struct comp_unit *unit, uint64_t *offsetp)
+{
+  struct dwarf2_debug *stash = unit->stash;
+  struct dwarf2_debug_file *file = unit->file;
+  struct unit_index local, *index = &unit->rnglists_index;
+  bfd_byte *info_ptr;
+
+  if (stash == NULL)
+    return false;
+
+  if (!unit_index_ready (index, unit->dwarf_rnglists_offset))
+    {
+      if (dwarf_thread_memory != NULL)
+	index = &local;
+      if (!unit_index_init (index, unit->abfd, stash, file, debug_rnglists,
+			    &file->dwarf_rnglists_buffer,
+			    &file->dwarf_rnglists_size,
+			    unit->dwarf_rnglists_offset, unit->offset_size))
+	return false;
+    }
+
+  if (idx >= index->count)
+    return false;
+
+  info_ptr = index->base + idx * unit->offset_size;
+
+  if (unit->offset_size == 4)
+    *offsetp = bfd_get_32 (unit->abfd, info_ptr);
+  else
+    *offsetp = bfd_get_64 (unit->abfd, info_ptr);
+  *offsetp += unit->dwarf_rnglists_offset;
+  return true;
+}
+
 /* Read and fill in the value of attribute ATTR as described by FORM.
    Read data starting from INFO_PTR, but never at or beyond INFO_PTR_END.
    Returns an updated INFO_PTR taking into account the amount of data read.  */
@@ -1554,9 +2170,7 @@ read_attribute_value (struct attribute *  attr,
       break;
     case DW_FORM_addrx1:
       attr->u.val = read_1_byte (abfd, &info_ptr, info_ptr_end);
-      /* dwarf_addr_offset value 0 indicates the attribute DW_AT_addr_base
-	 is not yet read.  */
-      if (unit->dwarf_addr_offset != 0)
+      if (addr_base_known (unit))
 	attr->u.val = read_indexed_address (attr->u.val, unit);
       break;
     case DW_FORM_data2:
@@ -1565,12 +2179,12 @@ read_attribute_value (struct attribute *  attr,
       break;
     case DW_FORM_addrx2:
       attr->u.val = read_2_bytes (abfd, &info_ptr, info_ptr_end);
-      if (unit->dwarf_addr_offset != 0)
+      if (addr_base_known (unit))
 	attr->u.val = read_indexed_address (attr->u.val, unit);
       break;
     case DW_FORM_addrx3:
       attr->u.val = read_3_bytes (abfd, &info_ptr, info_ptr_end);
-      if (unit->dwarf_addr_offset != 0)
+      if (addr_base_known (unit))
 	attr->u.val = read_indexed_address(attr->u.val, unit);
       break;
     case DW_FORM_ref4:
@@ -1579,7 +2193,7 @@ read_attribute_value (struct attribute *  attr,
       break;
     case DW_FORM_addrx4:
       attr->u.val = read_4_bytes (abfd, &info_ptr, info_ptr_end);
-      if (unit->dwarf_addr_offset != 0)
+      if (addr_base_known (unit))
 	attr->u.val = read_indexed_address (attr->u.val, unit);
       break;
     case DW_FORM_data8:
@@ -1601,38 +2215,37 @@ read_attribute_value (struct attribute *  attr,
       break;
     case DW_FORM_strx1:
       attr->u.val = read_1_byte (abfd, &info_ptr, info_ptr_end);
-      /* dwarf_str_offset value 0 indicates the attribute DW_AT_str_offsets_base
-	 is not yet read.  */
-      if (unit->dwarf_str_offset != 0)
+      if (str_base_known (unit))
 	attr->u.str = (char *) read_indexed_string (attr->u.val, unit);
       else
 	attr->u.str = NULL;
       break;
     case DW_FORM_strx2:
       attr->u.val = read_2_bytes (abfd, &info_ptr, info_ptr_end);
-      if (unit->dwarf_str_offset != 0)
+      if (str_base_known (unit))
 	attr->u.str = (char *) read_indexed_string (attr->u.val, unit);
       else
 	attr->u.str = NULL;
       break;
     case DW_FORM_strx3:
       attr->u.val = read_3_bytes (abfd, &info_ptr, info_ptr_end);
-      if (unit->dwarf_str_offset != 0)
+      if (str_base_known (unit))
 	attr->u.str = (char *) read_indexed_string (attr->u.val, unit);
       else
 	attr->u.str = NULL;
       break;
     case DW_FORM_strx4:
       attr->u.val = read_4_bytes (abfd, &info_ptr, info_ptr_end);
-      if (unit->dwarf_str_offset != 0)
+      if (str_base_known (unit))
 	attr->u.str = (char *) read_indexed_string (attr->u.val, unit);
       else
 	attr->u.str = NULL;
       break;
     case DW_FORM_strx:
+    case DW_FORM_GNU_str_index:
       attr->u.val = _bfd_safe_read_leb128 (abfd, &info_ptr,
 					   false, info_ptr_end);
-      if (unit->dwarf_str_offset != 0)
+      if (str_base_known (unit))
 	attr->u.str = (char *) read_indexed_string (attr->u.val, unit);
       else
 	attr->u.str = NULL;
@@ -1657,8 +2270,16 @@ read_attribute_value (struct attribute *  attr,
       break;
 
     case DW_FORM_rnglistx:
+      attr->u.val = _bfd_safe_read_leb128 (abfd, &info_ptr,
+					   false, info_ptr_end);
+      /* Resolve the index to the offset of the range list if the
+	 offset table can be found yet.  */
+      if (unit->dwarf_rnglists_offset != 0
+	  && read_rnglist_offset (attr->u.val, unit, &attr->u.val))
+	attr->form = DW_FORM_sec_offset;
+      break;
     case DW_FORM_loclistx:
-      /* FIXME: Add support for these forms!  */
+      /* FIXME: Add support for this form!  */
       /* Fall through.  */
     case DW_FORM_ref_udata:
     case DW_FORM_udata:
@@ -1666,9 +2287,10 @@ read_attribute_value (struct attribute *  attr,
 					   false, info_ptr_end);
       break;
     case DW_FORM_addrx:
+    case DW_FORM_GNU_addr_index:
       attr->u.val = _bfd_safe_read_leb128 (abfd, &info_ptr,
 					   false, info_ptr_end);
-      if (unit->dwarf_addr_offset != 0)
+      if (addr_base_known (unit))
 	attr->u.val = read_indexed_address (attr->u.val, unit);
       break;
     case DW_FORM_indirect:
@@ -1770,13 +2392,16 @@ mangle_style (int lang)
 #define FILE_ALLOC_CHUNK 5
 #define DIR_ALLOC_CHUNK 5
 
+/* A row of a line number program while the program is being decoded.
+   Once it has been, the rows of each sequence are copied into the
+   columns of its line_sequence and these are freed.  */
+
 struct line_info
 {
   struct line_info *	prev_line;
   bfd_vma		address;
-  char *		filename;
+  unsigned int		file;		/* Index into file_names.  */
   unsigned int		line;
-  unsigned int		column;
   unsigned int		discriminator;
   unsigned char		op_index;
   unsigned char		end_sequence;		/* End of (sequential) code sequence.  */
@@ -1793,9 +2418,20 @@ struct fileinfo
 struct line_sequence
 {
   bfd_vma		low_pc;
+  bfd_vma		high_pc;    /* Address of the last row.  */
   struct line_sequence* prev_sequence;
-  struct line_info*	last_line;  /* Largest VMA.  */
-  struct line_info**	line_info_lookup;
+  struct line_info*	last_line;  /* Largest VMA, while decoding.  */
+
+  /* The rows of the sequence in address order, one array per column.
+     Row addresses are offsets from BASE in ADDR_OFFSETS, or if the
+     sequence spans 4GiB or more, addresses in ADDRS.  DISCRIMINATORS
+     is NULL if they are all zero.  */
+  bfd_vma		base;
+  uint32_t *		addr_offsets;
+  bfd_vma *		addrs;
+  unsigned int *	files;
+  unsigned int *	lines;
+  unsigned int *	discriminators;
   bfd_size_type		num_lines;
 };
 
@@ -1811,6 +2447,16 @@ struct line_info_table
   struct fileinfo*	files;
   struct line_sequence* sequences;
   struct line_info*	lcl_head;   /* Local head; used in 'add_line_info'.  */
+
+  /* The file names rows refer to, with entry zero for none.  */
+  char **		file_names;
+  unsigned int		num_file_names;
+
+  /* While decoding, the rows, and for each file number one more than
+     the index of its name in FILE_NAMES, or zero if not yet known.  */
+  struct objalloc *	line_pool;
+  unsigned int *	file_slots;
+  unsigned int		num_file_slots;
 };
 
 /* Remember some information about each function.  If the function is
@@ -1896,15 +2542,15 @@ static bool
 add_line_info (struct line_info_table *table,
 	       bfd_vma address,
 	       unsigned char op_index,
-	       char *filename,
+	       unsigned int file,
 	       unsigned int line,
-	       unsigned int column,
 	       unsigned int discriminator,
 	       int end_sequence)
 {
   size_t amt = sizeof (struct line_info);
   struct line_sequence* seq = table->sequences;
-  struct line_info* info = (struct line_info *) bfd_alloc (table->abfd, amt);
+  struct line_info* info = (struct line_info *) objalloc_alloc (table->line_pool,
+								 amt);
 
   if (info == NULL)
     return false;
@@ -1913,21 +2559,11 @@ add_line_info (struct line_info_table *table,
   info->prev_line = NULL;
   info->address = address;
   info->op_index = op_index;
+  info->file = file;
   info->line = line;
-  info->column = column;
   info->discriminator = discriminator;
   info->end_sequence = end_sequence;
 
-  if (filename && filename[0])
-    {
-      info->filename = (char *) bfd_alloc (table->abfd, strlen (filename) + 1);
-      if (info->filename == NULL)
-	return false;
-      strcpy (info->filename, filename);
-    }
-  else
-    info->filename = NULL;
-
   /* Find the correct location for 'info'.  Normally we will receive
      new line_info data 1) in order and 2) with increasing VMAs.
      However some compilers break the rules (cf. decode_line_info) and
@@ -2178,14 +2814,16 @@ insert_arange_in_trie (bfd *abfd,
       is_full_leaf = leaf->num_stored_in_leaf == trie->num_room_in_leaf;
     }
 
-  /* If we're a leaf with no more room and we're _not_ at the bottom,
-     convert to an interior node.  */
-  if (is_full_leaf && trie_pc_bits < VMA_BITS)
+  /* If we're a leaf grown to TRIE_LEAF_SIZE with no more room and
+     we're _not_ at the bottom, convert to an interior node.  */
+  if (is_full_leaf
+      && trie->num_room_in_leaf >= TRIE_LEAF_SIZE
+      && trie_pc_bits < VMA_BITS)
     {
       const struct trie_leaf *leaf = (struct trie_leaf *) trie;
       unsigned int i;
 
-      trie = bfd_zalloc (abfd, sizeof (struct trie_interior));
+      trie = dwarf_zalloc (abfd, sizeof (struct trie_interior));
       if (!trie)
 	return NULL;
       is_full_leaf = false;
@@ -2202,15 +2840,17 @@ insert_arange_in_trie (bfd *abfd,
 	}
     }
 
-  /* If we're a leaf with no more room and we _are_ at the bottom,
-     we have no choice but to just make it larger. */
+  /* If we're a leaf with no more room and either we _are_ at the bottom,
+     or have not yet grown to TRIE_LEAF_SIZE, just make it larger. */
   if (is_full_leaf)
     {
       const struct trie_leaf *leaf = (struct trie_leaf *) trie;
       unsigned int new_room_in_leaf = trie->num_room_in_leaf * 2;
       struct trie_leaf *new_leaf;
       size_t amt = sizeof (*leaf) + new_room_in_leaf * sizeof (leaf->ranges[0]);
-      new_leaf = bfd_zalloc (abfd, amt);
+      new_leaf = dwarf_zalloc (abfd, amt);
+      if (new_leaf == NULL)
+	return NULL;
       new_leaf->head.num_room_in_leaf = new_room_in_leaf;
       new_leaf->num_stored_in_leaf = leaf->num_stored_in_leaf;
 
@@ -2286,14 +2926,30 @@ static bool
 arange_add (struct comp_unit *unit, struct arange *first_arange,
 	    struct trie_node **trie_root, bfd_vma low_pc, bfd_vma high_pc)
 {
+  struct comp_unit *alloc_unit = dwarf_alloc_unit;
   struct arange *arange;
 
   /* Ignore empty ranges.  */
   if (low_pc == high_pc)
     return true;
 
-  if (trie_root != NULL)
+  if (trie_root != NULL && dwarf_thread_memory != NULL)
+    {
+      /* The trie is shared between units, so leave it to
+	 stash_read_all_units to add the range once the workers are
+	 done.  */
+      arange = (struct arange *) dwarf_alloc (unit->abfd, sizeof (*arange));
+      if (arange == NULL)
+	return false;
+      arange->low = low_pc;
+      arange->high = high_pc;
+      arange->next = unit->pending_ranges;
+      unit->pending_ranges = arange;
+    }
+  else if (trie_root != NULL)
     {
+      /* The trie outlives the tables of the unit being decoded.  */
+      dwarf_alloc_unit = NULL;
       *trie_root = insert_arange_in_trie (unit->file->bfd_ptr,
 					  *trie_root,
 					  0,
@@ -2301,6 +2957,7 @@ arange_add (struct comp_unit *unit, struct arange *first_arange,
 					  unit,
 					  low_pc,
 					  high_pc);
+      dwarf_alloc_unit = alloc_unit;
       if (*trie_root == NULL)
 	return false;
     }
@@ -2332,8 +2989,12 @@ arange_add (struct comp_unit *unit, struct arange *first_arange,
   while (arange);
 
   /* Need to allocate a new arange and insert it into the arange list.
-     Order isn't significant, so just insert after the first arange.  */
-  arange = (struct arange *) bfd_alloc (unit->abfd, sizeof (*arange));
+     Order isn't significant, so just insert after the first arange.
+     The ranges of the unit itself outlive its tables too.  */
+  if (first_arange == &unit->arange)
+    dwarf_alloc_unit = NULL;
+  arange = (struct arange *) dwarf_alloc (unit->abfd, sizeof (*arange));
+  dwarf_alloc_unit = alloc_unit;
   if (arange == NULL)
     return false;
   arange->low = low_pc;
@@ -2377,49 +3038,149 @@ compare_sequences (const void* a, const void* b)
   return 0;
 }
 
-/* Construct the line information table for quick lookup.  */
+/* Return the index in TABLE's file_names of the name of FILE, a file
+   number of the line program being decoded, adding the name if need
+   be.  Returns -1u if memory runs out.  */
+
+static unsigned int
+line_file_slot (struct line_info_table *table, unsigned int file)
+{
+  bool cache = file <= table->num_files;
+  unsigned int slot;
+  char *filename;
+
+  if (cache && file < table->num_file_slots && table->file_slots[file] != 0)
+    return table->file_slots[file] - 1;
+
+  slot = 0;
+  filename = concat_filename (table, file);
+  if (filename != NULL && filename[0] != 0)
+    {
+      char *name = (char *) dwarf_alloc (table->abfd, strlen (filename) + 1);
+      char **names;
+
+      names = (char **) bfd_realloc (table->file_names,
+				     ((table->num_file_names + 1)
+				      * sizeof (char *)));
+      if (name == NULL || names == NULL)
+	{
+	  free (filename);
+	  return -1u;
+	}
+      strcpy (name, filename);
+      table->file_names = names;
+      slot = table->num_file_names++;
+      names[slot] = name;
+    }
+  free (filename);
+
+  if (cache)
+    {
+      if (file >= table->num_file_slots)
+	{
+	  unsigned int *slots;
+	  unsigned int count = table->num_files + 1;
+
+	  slots = (unsigned int *) bfd_realloc (table->file_slots,
+						count * sizeof (*slots));
+	  if (slots == NULL)
+	    return -1u;
+	  memset (slots + table->num_file_slots, 0,
+		  (count - table->num_file_slots) * sizeof (*slots));
+	  table->file_slots = slots;
+	  table->num_file_slots = count;
+	}
+      table->file_slots[file] = slot + 1;
+    }
+  return slot;
+}
+
+/* Copy the rows of SEQ, a sequence of TABLE, from the list decoding
+   made into the columns used for lookup.  */
 
 static bool
 build_line_info_table (struct line_info_table *  table,
 		       struct line_sequence *    seq)
 {
-  size_t amt;
-  struct line_info **line_info_lookup;
   struct line_info *each_line;
-  unsigned int num_lines;
-  unsigned int line_index;
-
-  if (seq->line_info_lookup != NULL)
-    return true;
+  bfd_size_type num_lines;
+  bfd_size_type line_index;
+  bool any_discriminator;
 
   /* Count the number of line information entries.  We could do this while
      scanning the debug information, but some entries may be added via
      lcl_head without having a sequence handy to increment the number of
      lines.  */
   num_lines = 0;
+  any_discriminator = false;
   for (each_line = seq->last_line; each_line; each_line = each_line->prev_line)
-    num_lines++;
+    {
+      num_lines++;
+      if (each_line->discriminator != 0)
+	any_discriminator = true;
+    }
 
   seq->num_lines = num_lines;
-  if (num_lines == 0)
-    return true;
-
-  /* Allocate space for the line information lookup table.  */
-  amt = sizeof (struct line_info*) * num_lines;
-  line_info_lookup = (struct line_info**) bfd_alloc (table->abfd, amt);
-  seq->line_info_lookup = line_info_lookup;
-  if (line_info_lookup == NULL)
+  seq->high_pc = seq->last_line->address;
+  seq->addr_offsets = NULL;
+  seq->addrs = NULL;
+  seq->discriminators = NULL;
+
+  /* The lowest row comes last in the list.  */
+  seq->base = seq->last_line->address;
+  for (each_line = seq->last_line->prev_line; each_line;
+       each_line = each_line->prev_line)
+    seq->base = each_line->address;
+
+  if (seq->high_pc - seq->base <= (uint32_t) -1)
+    seq->addr_offsets = (uint32_t *) dwarf_alloc (table->abfd,
+						  num_lines * sizeof (uint32_t));
+  else
+    seq->addrs = (bfd_vma *) dwarf_alloc (table->abfd,
+					  num_lines * sizeof (bfd_vma));
+  seq->files = (unsigned int *) dwarf_alloc (table->abfd,
+					     num_lines * sizeof (unsigned int));
+  seq->lines = (unsigned int *) dwarf_alloc (table->abfd,
+					     num_lines * sizeof (unsigned int));
+  if (any_discriminator)
+    seq->discriminators
+      = (unsigned int *) dwarf_alloc (table->abfd,
+				      num_lines * sizeof (unsigned int));
+  if ((seq->addr_offsets == NULL && seq->addrs == NULL)
+      || seq->files == NULL
+      || seq->lines == NULL
+      || (any_discriminator && seq->discriminators == NULL))
     return false;
 
-  /* Create the line information lookup table.  */
   line_index = num_lines;
   for (each_line = seq->last_line; each_line; each_line = each_line->prev_line)
-    line_info_lookup[--line_index] = each_line;
+    {
+      --line_index;
+      if (seq->addr_offsets != NULL)
+	seq->addr_offsets[line_index] = each_line->address - seq->base;
+      else
+	seq->addrs[line_index] = each_line->address;
+      seq->files[line_index] = each_line->file;
+      seq->lines[line_index] = each_line->line;
+      if (seq->discriminators != NULL)
+	seq->discriminators[line_index] = each_line->discriminator;
+    }
+  seq->last_line = NULL;
 
   BFD_ASSERT (line_index == 0);
   return true;
 }
 
+/* Return the address of row I of SEQ.  */
+
+static inline bfd_vma
+line_sequence_address (const struct line_sequence *seq, bfd_size_type i)
+{
+  if (seq->addr_offsets != NULL)
+    return seq->base + seq->addr_offsets[i];
+  return seq->addrs[i];
+}
+
 /* Sort the line sequences for quick lookup.  */
 
 static bool
@@ -2437,7 +3198,7 @@ sort_line_sequences (struct line_info_table* table)
 
   /* Allocate space for an array of sequences.  */
   amt = sizeof (struct line_sequence) * num_sequences;
-  sequences = (struct line_sequence *) bfd_alloc (table->abfd, amt);
+  sequences = (struct line_sequence *) dwarf_alloc (table->abfd, amt);
   if (sequences == NULL)
     return false;
 
@@ -2451,7 +3212,6 @@ sort_line_sequences (struct line_info_table* table)
       sequences[n].low_pc = seq->low_pc;
       sequences[n].prev_sequence = NULL;
       sequences[n].last_line = seq->last_line;
-      sequences[n].line_info_lookup = NULL;
       sequences[n].num_lines = n;
       seq = seq->prev_sequence;
       free (last_seq);
@@ -2696,7 +3456,8 @@ decode_line_info (struct comp_unit *unit)
   if (unit->line_offset == 0 && file->line_table)
     return file->line_table;
 
-  if (! read_section (abfd, &stash->debug_sections[debug_line],
+  if (! read_section (abfd,
+		      file_debug_section (stash, file, debug_line),
 		      file->syms, unit->line_offset,
 		      &file->dwarf_line_buffer, &file->dwarf_line_size))
     return NULL;
@@ -2809,7 +3570,7 @@ decode_line_info (struct comp_unit *unit)
     }
 
   amt = lh.opcode_base * sizeof (unsigned char);
-  lh.standard_opcode_lengths = (unsigned char *) bfd_alloc (abfd, amt);
+  lh.standard_opcode_lengths = (unsigned char *) dwarf_alloc (abfd, amt);
 
   lh.standard_opcode_lengths[0] = 1;
 
@@ -2817,7 +3578,7 @@ decode_line_info (struct comp_unit *unit)
     lh.standard_opcode_lengths[i] = read_1_byte (abfd, &line_ptr, line_end);
 
   amt = sizeof (struct line_info_table);
-  table = (struct line_info_table *) bfd_alloc (abfd, amt);
+  table = (struct line_info_table *) dwarf_alloc (abfd, amt);
   if (table == NULL)
     return NULL;
   table->abfd = abfd;
@@ -2834,6 +3595,16 @@ decode_line_info (struct comp_unit *unit)
 
   table->lcl_head = NULL;
 
+  /* Rows without a file name use entry zero.  */
+  table->file_slots = NULL;
+  table->num_file_slots = 0;
+  table->file_names = (char **) bfd_malloc (sizeof (char *));
+  table->line_pool = objalloc_create ();
+  if (table->file_names == NULL || table->line_pool == NULL)
+    goto fail;
+  table->file_names[0] = NULL;
+  table->num_file_names = 1;
+
   if (lh.version >= 5)
     {
       /* Read directory table.  */
@@ -2877,9 +3648,8 @@ decode_line_info (struct comp_unit *unit)
       /* State machine registers.  */
       bfd_vma address = 0;
       unsigned char op_index = 0;
-      char * filename = NULL;
+      unsigned int file_slot = 0;
       unsigned int line = 1;
-      unsigned int column = 0;
       unsigned int discriminator = 0;
       int is_stmt = lh.default_is_stmt;
       int end_sequence = 0;
@@ -2895,9 +3665,11 @@ decode_line_info (struct comp_unit *unit)
       if (table->num_files)
 	{
 	  if (table->use_dir_and_file_0)
-	    filename = concat_filename (table, 0);
+	    file_slot = line_file_slot (table, 0);
 	  else
-	    filename = concat_filename (table, 1);
+	    file_slot = line_file_slot (table, 1);
+	  if (file_slot == -1u)
+	    goto fail;
 	}
 
       /* Decode the table.  */
@@ -2924,8 +3696,8 @@ decode_line_info (struct comp_unit *unit)
 		}
 	      line += lh.line_base + (adj_opcode % lh.line_range);
 	      /* Append row to matrix using current values.  */
-	      if (!add_line_info (table, address, op_index, filename,
-				  line, column, discriminator, 0))
+	      if (!add_line_info (table, address, op_index, file_slot,
+				  line, discriminator, 0))
 		goto line_fail;
 	      discriminator = 0;
 	      if (address < low_pc)
@@ -2944,16 +3716,17 @@ decode_line_info (struct comp_unit *unit)
 		{
 		case DW_LNE_end_sequence:
 		  end_sequence = 1;
-		  if (!add_line_info (table, address, op_index, filename, line,
-				      column, discriminator, end_sequence))
+		  if (!add_line_info (table, address, op_index, file_slot,
+				      line, discriminator, end_sequence))
 		    goto line_fail;
 		  discriminator = 0;
 		  if (address < low_pc)
 		    low_pc = address;
 		  if (address > high_pc)
 		    high_pc = address;
-		  if (!arange_add (unit, &unit->arange, &unit->file->trie_root,
-				   low_pc, high_pc))
+		  if (!unit->line_ranges_known
+		      && !arange_add (unit, &unit->arange,
+				      &unit->file->trie_root, low_pc, high_pc))
 		    goto line_fail;
 		  break;
 		case DW_LNE_set_address:
@@ -2984,13 +3757,12 @@ decode_line_info (struct comp_unit *unit)
 		    (_("DWARF error: mangled line number section"));
 		  bfd_set_error (bfd_error_bad_value);
 		line_fail:
-		  free (filename);
 		  goto fail;
 		}
 	      break;
 	    case DW_LNS_copy:
 	      if (!add_line_info (table, address, op_index,
-				  filename, line, column, discriminator, 0))
+				  file_slot, line, discriminator, 0))
 		goto line_fail;
 	      discriminator = 0;
 	      if (address < low_pc)
@@ -3024,13 +3796,15 @@ decode_line_info (struct comp_unit *unit)
 		   based, the references are 1 based.  */
 		filenum = _bfd_safe_read_leb128 (abfd, &line_ptr,
 						 false, line_end);
-		free (filename);
-		filename = concat_filename (table, filenum);
+		file_slot = line_file_slot (table, filenum);
+		if (file_slot == -1u)
+		  goto line_fail;
 		break;
 	      }
 	    case DW_LNS_set_column:
-	      column = _bfd_safe_read_leb128 (abfd, &line_ptr,
-					      false, line_end);
+	      /* Lookups don't report columns.  */
+	      (void) _bfd_safe_read_leb128 (abfd, &line_ptr,
+					    false, line_end);
 	      break;
 	    case DW_LNS_negate_stmt:
 	      is_stmt = (!is_stmt);
@@ -3064,14 +3838,28 @@ decode_line_info (struct comp_unit *unit)
 	      break;
 	    }
 	}
-
-      free (filename);
     }
 
   if (unit->line_offset == 0)
     file->line_table = table;
   if (sort_line_sequences (table))
-    return table;
+    {
+      unsigned int n;
+
+      for (n = 0; n < table->num_sequences; n++)
+	if (!build_line_info_table (table, &table->sequences[n]))
+	  break;
+      if (n == table->num_sequences)
+	{
+	  free (table->file_slots);
+	  table->file_slots = NULL;
+	  objalloc_free (table->line_pool);
+	  table->line_pool = NULL;
+	  return table;
+	}
+      /* The sequences are in an array now, not a list.  */
+      table->sequences = NULL;
+    }
 
  fail:
   while (table->sequences != NULL)
@@ -3080,6 +3868,10 @@ decode_line_info (struct comp_unit *unit)
       table->sequences = table->sequences->prev_sequence;
       free (seq);
     }
+  if (table->line_pool != NULL)
+    objalloc_free (table->line_pool);
+  free (table->file_slots);
+  free (table->file_names);
   free (table->files);
   free (table->dirs);
   return NULL;
@@ -3098,57 +3890,63 @@ lookup_address_in_line_info_table (struct line_info_table *table,
 				   unsigned int *discriminator_ptr)
 {
   struct line_sequence *seq = NULL;
-  struct line_info *info;
-  int low, high, mid;
+  bfd_size_type low, high, mid;
+  int slow, shigh, smid;
 
   /* Binary search the array of sequences.  */
-  low = 0;
-  high = table->num_sequences;
-  while (low < high)
+  slow = 0;
+  shigh = table->num_sequences;
+  while (slow < shigh)
     {
-      mid = (low + high) / 2;
-      seq = &table->sequences[mid];
+      smid = (slow + shigh) / 2;
+      seq = &table->sequences[smid];
       if (addr < seq->low_pc)
-	high = mid;
-      else if (addr >= seq->last_line->address)
-	low = mid + 1;
+	shigh = smid;
+      else if (addr >= seq->high_pc)
+	slow = smid + 1;
       else
 	break;
     }
 
   /* Check for a valid sequence.  */
-  if (!seq || addr < seq->low_pc || addr >= seq->last_line->address)
-    goto fail;
-
-  if (!build_line_info_table (table, seq))
+  if (!seq || addr < seq->low_pc || addr >= seq->high_pc)
     goto fail;
 
-  /* Binary search the array of line information.  */
+  /* Binary search the address column for the first row after ADDR.
+     The row before it holds ADDR, and isn't the last row since ADDR
+     is below that row's address.  */
   low = 0;
   high = seq->num_lines;
-  info = NULL;
-  while (low < high)
+  if (seq->addr_offsets != NULL)
     {
-      mid = (low + high) / 2;
-      info = seq->line_info_lookup[mid];
-      if (addr < info->address)
-	high = mid;
-      else if (addr >= seq->line_info_lookup[mid + 1]->address)
-	low = mid + 1;
-      else
-	break;
+      uint32_t offset = addr - seq->base;
+
+      while (low < high)
+	{
+	  mid = (low + high) / 2;
+	  if (offset < seq->addr_offsets[mid])
+	    high = mid;
+	  else
+	    low = mid + 1;
+	}
     }
+  else
+    while (low < high)
+      {
+	mid = (low + high) / 2;
+	if (addr < seq->addrs[mid])
+	  high = mid;
+	else
+	  low = mid + 1;
+      }
 
-  /* Check for a valid line information entry.  */
-  if (info
-      && addr >= info->address
-      && addr < seq->line_info_lookup[mid + 1]->address
-      && !(info->end_sequence || info == seq->last_line))
+  if (low != 0 && low < seq->num_lines)
     {
-      *filename_ptr = info->filename;
-      *linenumber_ptr = info->line;
+      *filename_ptr = table->file_names[seq->files[low - 1]];
+      *linenumber_ptr = seq->lines[low - 1];
       if (discriminator_ptr)
-	*discriminator_ptr = info->discriminator;
+	*discriminator_ptr = (seq->discriminators != NULL
+			      ? seq->discriminators[low - 1] : 0);
       return true;
     }
 
@@ -3165,7 +3963,8 @@ read_debug_ranges (struct comp_unit * unit)
   struct dwarf2_debug *stash = unit->stash;
   struct dwarf2_debug_file *file = unit->file;
 
-  return read_section (unit->abfd, &stash->debug_sections[debug_ranges],
+  return read_section (unit->abfd,
+		       file_debug_section (stash, file, debug_ranges),
 		       file->syms, 0,
 		       &file->dwarf_ranges_buffer, &file->dwarf_ranges_size);
 }
@@ -3178,7 +3977,8 @@ read_debug_rnglists (struct comp_unit * unit)
   struct dwarf2_debug *stash = unit->stash;
   struct dwarf2_debug_file *file = unit->file;
 
-  return read_section (unit->abfd, &stash->debug_sections[debug_rnglists],
+  return read_section (unit->abfd,
+		       file_debug_section (stash, file, debug_rnglists),
 		       file->syms, 0,
 		       &file->dwarf_rnglists_buffer, &file->dwarf_rnglists_size);
 }
@@ -3428,19 +4228,166 @@ lookup_symbol_in_variable_table (struct comp_unit *unit,
   return false;
 }
 
+/* The effect of following a DW_AT_abstract_origin or
+   DW_AT_specification reference to a DIE, starting with nothing found.
+   These are kept in the stash for each DIE resolved, so that the many
+   inlined copies of a function find their name without reading the
+   DIEs of the abstract instance again.  */
+
+struct abstract_instance
+{
+  /* The DIE, in the .debug_info buffer of its file.  */
+  bfd_byte *die;
+
+  /* The name found, whether it came from DW_AT_linkage_name (or
+     DW_AT_MIPS_linkage_name) rather than DW_AT_name, and whether it
+     is a linkage name.  */
+  const char *name;
+  bool from_linkage;
+  bool is_linkage;
+
+  /* Whether DW_AT_decl_file and DW_AT_decl_line were found, and the
+     file name and line they gave.  */
+  bool has_file;
+  bool has_line;
+  char *file;
+  int line;
+};
+
+static hashval_t
+hash_abstract_instance (const void *p)
+{
+  const struct abstract_instance *inst = p;
+  return htab_hash_pointer (inst->die);
+}
+
+static int
+eq_abstract_instance (const void *pa, const void *pb)
+{
+  const struct abstract_instance *a = pa;
+  const struct abstract_instance *b = pb;
+  return a->die == b->die;
+}
+
+static void
+del_abstract_instance (void *p)
+{
+  struct abstract_instance *inst = p;
+
+  free (inst->file);
+  free (inst);
+}
+
+/* Add what was found through a DIE that INST referred to, FROM, to
+   INST, as reading the referenced DIE's attributes would have.  */
+
+static void
+merge_abstract_instance (struct abstract_instance *inst,
+			 const struct abstract_instance *from)
+{
+  if (from->from_linkage)
+    {
+      inst->name = from->name;
+      inst->from_linkage = true;
+      inst->is_linkage = true;
+    }
+  else if (inst->name == NULL && from->name != NULL)
+    {
+      inst->name = from->name;
+      inst->is_linkage |= from->is_linkage;
+    }
+  if (from->has_file)
+    {
+      free (inst->file);
+      inst->file = from->file != NULL ? strdup (from->file) : NULL;
+      inst->has_file = true;
+    }
+  if (from->has_line)
+    {
+      inst->line = from->line;
+      inst->has_line = true;
+    }
+}
+
 static struct comp_unit *stash_comp_unit (struct dwarf2_debug *,
 					  struct dwarf2_debug_file *);
 static bool comp_unit_maybe_decode_line_info (struct comp_unit *);
+static bool comp_unit_maybe_scan_symbols (struct comp_unit *);
+static bool comp_unit_read_split_unit (struct comp_unit *);
+
+/* Return the unit read so far from FILE whose bytes in .debug_info
+   include INFO_PTR, or NULL if there is none.  This only reads the
+   index, so threads may call it at once when nothing can add to it.  */
+
+static struct comp_unit *
+find_unit_at (struct dwarf2_debug_file *file, bfd_byte *info_ptr)
+{
+  size_t lo = 0, hi = file->unit_index_count;
+
+  /* Find the first unit starting after INFO_PTR.  */
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (file->unit_index[mid]->info_ptr_unit <= info_ptr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo != 0 && info_ptr < file->unit_index[lo - 1]->end_ptr)
+    return file->unit_index[lo - 1];
+  return NULL;
+}
+
+/* Add UNIT, just read from FILE, to FILE's index of units.  Units are
+   mostly read in order, so this usually appends.  Returns false if
+   memory runs out.  */
 
 static bool
-find_abstract_instance (struct comp_unit *unit,
+index_comp_unit (struct dwarf2_debug_file *file, struct comp_unit *unit)
+{
+  size_t pos = file->unit_index_count;
+
+  if (unit->end_ptr <= unit->info_ptr_unit)
+    abort ();
+
+  if (file->unit_index_count == file->unit_index_alloc)
+    {
+      size_t alloc = file->unit_index_alloc ? 2 * file->unit_index_alloc : 16;
+      struct comp_unit **index
+	= bfd_realloc (file->unit_index, alloc * sizeof (*index));
+
+      if (index == NULL)
+	return false;
+      file->unit_index = index;
+      file->unit_index_alloc = alloc;
+    }
+
+  while (pos != 0
+	 && file->unit_index[pos - 1]->info_ptr_unit > unit->info_ptr_unit)
+    pos--;
+  if ((pos != 0 && file->unit_index[pos - 1]->end_ptr > unit->info_ptr_unit)
+      || (pos != file->unit_index_count
+	  && unit->end_ptr > file->unit_index[pos]->info_ptr_unit))
+    abort ();
+  memmove (file->unit_index + pos + 1, file->unit_index + pos,
+	   (file->unit_index_count - pos) * sizeof (*file->unit_index));
+  file->unit_index[pos] = unit;
+  file->unit_index_count++;
+  return true;
+}
+
+/* Read the DIE referred to by ATTR_PTR, an attribute of UNIT, and
+   return what it says about the abstract instance.  Returns NULL on
+   error.  The result belongs to the stash.  */
+
+static const struct abstract_instance *
+read_abstract_instance (struct comp_unit *unit,
 			struct attribute *attr_ptr,
-			unsigned int recur_count,
-			const char **pname,
-			bool *is_linkage,
-			char **filename_ptr,
-			int *linenumber_ptr)
+			unsigned int recur_count)
 {
+  static const struct abstract_instance no_instance;
+  struct dwarf2_debug *stash = unit->stash;
   bfd *abfd = unit->abfd;
   bfd_byte *info_ptr = NULL;
   bfd_byte *info_ptr_end;
@@ -3448,13 +4395,16 @@ find_abstract_instance (struct comp_unit *unit,
   struct abbrev_info *abbrev;
   uint64_t die_ref = attr_ptr->u.val;
   struct attribute attr;
+  struct abstract_instance *inst;
+  struct abstract_instance key;
+  void **slot;
 
   if (recur_count == 100)
     {
       _bfd_error_handler
 	(_("DWARF error: abstract instance recursion detected"));
       bfd_set_error (bfd_error_bad_value);
-      return false;
+      return NULL;
     }
 
   /* DW_FORM_ref_addr can reference an entry in a different CU. It
@@ -3482,13 +4432,13 @@ find_abstract_instance (struct comp_unit *unit,
       info_ptr_end = info_ptr + unit->file->dwarf_info_size;
       total = info_ptr_end - info_ptr;
       if (!die_ref)
-	return true;
+	return &no_instance;
       else if (die_ref >= total)
 	{
 	  _bfd_error_handler
 	    (_("DWARF error: invalid abstract instance DIE ref"));
 	  bfd_set_error (bfd_error_bad_value);
-	  return false;
+	  return NULL;
 	}
       info_ptr += die_ref;
     }
@@ -3505,13 +4455,41 @@ find_abstract_instance (struct comp_unit *unit,
 	    (_("DWARF error: unable to read alt ref %" PRIu64),
 	     (uint64_t) die_ref);
 	  bfd_set_error (bfd_error_bad_value);
-	  return false;
+	  return NULL;
 	}
       info_ptr_end = (unit->stash->alt.dwarf_info_buffer
 		      + unit->stash->alt.dwarf_info_size);
       if (unit->stash->alt.all_comp_units)
 	unit = unit->stash->alt.all_comp_units;
     }
+  else
+    {
+      /* DW_FORM_ref1, DW_FORM_ref2, DW_FORM_ref4, DW_FORM_ref8 or
+	 DW_FORM_ref_udata.  These are all references relative to the
+	 start of the current CU.  */
+      size_t total;
+
+      info_ptr = unit->info_ptr_unit;
+      info_ptr_end = unit->end_ptr;
+      total = info_ptr_end - info_ptr;
+      if (!die_ref || die_ref >= total)
+	{
+	  _bfd_error_handler
+	    (_("DWARF error: invalid abstract instance DIE ref"));
+	  bfd_set_error (bfd_error_bad_value);
+	  return NULL;
+	}
+      info_ptr += die_ref;
+    }
+
+  key.die = info_ptr;
+  if (dwarf_thread_memory != NULL)
+    _bfd_mutex_lock (&dwarf_worker_lock);
+  inst = htab_find (stash->abstract_instances, &key);
+  if (dwarf_thread_memory != NULL)
+    _bfd_mutex_unlock (&dwarf_worker_lock);
+  if (inst != NULL)
+    return inst;
 
   if (attr_ptr->form == DW_FORM_ref_addr
       || attr_ptr->form == DW_FORM_GNU_ref_alt)
@@ -3522,12 +4500,17 @@ find_abstract_instance (struct comp_unit *unit,
       else
 	{
 	  /* Check other CUs to see if they contain the abbrev.  */
-	  struct comp_unit *u = NULL;
-	  struct addr_range range = { info_ptr, info_ptr };
-	  splay_tree_node v = splay_tree_lookup (unit->file->comp_unit_tree,
-						 (splay_tree_key)&range);
-	  if (v != NULL)
-	    u = (struct comp_unit *)v->value;
+	  struct comp_unit *u;
+	  bool lock;
+
+	  /* Reading more units changes the index, and the stash.  Once
+	     every unit is read, workers need not lock to find one.  */
+	  lock = (dwarf_thread_memory != NULL
+		  && (!unit->file->units_complete
+		      || attr_ptr->form == DW_FORM_GNU_ref_alt));
+	  if (lock)
+	    _bfd_mutex_lock (&dwarf_worker_lock);
+	  u = find_unit_at (unit->file, info_ptr);
 
 	  if (attr_ptr->form == DW_FORM_ref_addr)
 	    while (u == NULL)
@@ -3550,6 +4533,8 @@ find_abstract_instance (struct comp_unit *unit,
 		  break;
 		u = NULL;
 	      }
+	  if (lock)
+	    _bfd_mutex_unlock (&dwarf_worker_lock);
 
 	  if (u == NULL)
 	    {
@@ -3557,31 +4542,17 @@ find_abstract_instance (struct comp_unit *unit,
 		(_("DWARF error: unable to locate abstract instance DIE ref %"
 		   PRIu64), (uint64_t) die_ref);
 	      bfd_set_error (bfd_error_bad_value);
-	      return false;
+	      return NULL;
 	    }
 	  unit = u;
 	  info_ptr_end = unit->end_ptr;
 	}
     }
-  else
-    {
-      /* DW_FORM_ref1, DW_FORM_ref2, DW_FORM_ref4, DW_FORM_ref8 or
-	 DW_FORM_ref_udata.  These are all references relative to the
-	 start of the current CU.  */
-      size_t total;
 
-      info_ptr = unit->info_ptr_unit;
-      info_ptr_end = unit->end_ptr;
-      total = info_ptr_end - info_ptr;
-      if (!die_ref || die_ref >= total)
-	{
-	  _bfd_error_handler
-	    (_("DWARF error: invalid abstract instance DIE ref"));
-	  bfd_set_error (bfd_error_bad_value);
-	  return false;
-	}
-      info_ptr += die_ref;
-    }
+  inst = (struct abstract_instance *) bfd_zmalloc (sizeof (*inst));
+  if (inst == NULL)
+    return NULL;
+  inst->die = info_ptr;
 
   abbrev_number = _bfd_safe_read_leb128 (abfd, &info_ptr,
 					 false, info_ptr_end);
@@ -3593,7 +4564,7 @@ find_abstract_instance (struct comp_unit *unit,
 	  _bfd_error_handler
 	    (_("DWARF error: could not find abbrev number %u"), abbrev_number);
 	  bfd_set_error (bfd_error_bad_value);
-	  return false;
+	  goto fail;
 	}
       else
 	{
@@ -3608,19 +4579,24 @@ find_abstract_instance (struct comp_unit *unit,
 		case DW_AT_name:
 		  /* Prefer DW_AT_MIPS_linkage_name or DW_AT_linkage_name
 		     over DW_AT_name.  */
-		  if (*pname == NULL && is_str_form (&attr))
+		  if (inst->name == NULL && is_str_form (&attr))
 		    {
-		      *pname = attr.u.str;
+		      inst->name = attr.u.str;
 		      if (mangle_style (unit->lang) == 0)
-			*is_linkage = true;
+			inst->is_linkage = true;
 		    }
 		  break;
 		case DW_AT_specification:
-		  if (is_int_form (&attr)
-		      && !find_abstract_instance (unit, &attr, recur_count + 1,
-						  pname, is_linkage,
-						  filename_ptr, linenumber_ptr))
-		    return false;
+		  if (is_int_form (&attr))
+		    {
+		      const struct abstract_instance *spec;
+
+		      spec = read_abstract_instance (unit, &attr,
+						     recur_count + 1);
+		      if (spec == NULL)
+			goto fail;
+		      merge_abstract_instance (inst, spec);
+		    }
 		  break;
 		case DW_AT_linkage_name:
 		case DW_AT_MIPS_linkage_name:
@@ -3628,23 +4604,28 @@ find_abstract_instance (struct comp_unit *unit,
 		     non-string forms into these attributes.  */
 		  if (is_str_form (&attr))
 		    {
-		      *pname = attr.u.str;
-		      *is_linkage = true;
+		      inst->name = attr.u.str;
+		      inst->from_linkage = true;
+		      inst->is_linkage = true;
 		    }
 		  break;
 		case DW_AT_decl_file:
 		  if (!comp_unit_maybe_decode_line_info (unit))
-		    return false;
+		    goto fail;
 		  if (is_int_form (&attr))
 		    {
-		      free (*filename_ptr);
-		      *filename_ptr = concat_filename (unit->line_table,
-						       attr.u.val);
+		      free (inst->file);
+		      inst->file = concat_filename (unit->line_table,
+						    attr.u.val);
+		      inst->has_file = true;
 		    }
 		  break;
 		case DW_AT_decl_line:
 		  if (is_int_form (&attr))
-		    *linenumber_ptr = attr.u.val;
+		    {
+		      inst->line = attr.u.val;
+		      inst->has_line = true;
+		    }
 		  break;
 		default:
 		  break;
@@ -3652,9 +4633,71 @@ find_abstract_instance (struct comp_unit *unit,
 	    }
 	}
     }
+
+  /* Another thread may have read the same DIE meanwhile.  */
+  if (dwarf_thread_memory != NULL)
+    _bfd_mutex_lock (&dwarf_worker_lock);
+  slot = htab_find_slot (stash->abstract_instances, inst, INSERT);
+  if (slot != NULL && *slot == NULL)
+    *slot = inst;
+  if (dwarf_thread_memory != NULL)
+    _bfd_mutex_unlock (&dwarf_worker_lock);
+  if (slot == NULL)
+    goto fail;
+  if (*slot != inst)
+    {
+      del_abstract_instance (inst);
+      inst = *slot;
+    }
+  return inst;
+
+ fail:
+  del_abstract_instance (inst);
+  return NULL;
+}
+
+/* Follow the DW_AT_abstract_origin or DW_AT_specification attribute
+   ATTR_PTR of a DIE in UNIT, setting *PNAME, *IS_LINKAGE,
+   *FILENAME_PTR and *LINENUMBER_PTR from what the referenced DIE, and
+   any it refers to in turn, say.  */
+
+static bool
+find_abstract_instance (struct comp_unit *unit,
+			struct attribute *attr_ptr,
+			unsigned int recur_count,
+			const char **pname,
+			bool *is_linkage,
+			char **filename_ptr,
+			int *linenumber_ptr)
+{
+  const struct abstract_instance *inst;
+
+  inst = read_abstract_instance (unit, attr_ptr, recur_count);
+  if (inst == NULL)
+    return false;
+
+  if (inst->from_linkage)
+    {
+      *pname = inst->name;
+      *is_linkage = true;
+    }
+  else if (*pname == NULL && inst->name != NULL)
+    {
+      *pname = inst->name;
+      if (inst->is_linkage)
+	*is_linkage = true;
+    }
+  if (inst->has_file)
+    {
+      free (*filename_ptr);
+      *filename_ptr = inst->file != NULL ? strdup (inst->file) : NULL;
+    }
+  if (inst->has_line)
+    *linenumber_ptr = inst->line;
   return true;
 }
 
+
 static bool
 read_ranges (struct comp_unit *unit, struct arange *arange,
 	     struct trie_node **trie_root, uint64_t offset)
@@ -3662,17 +4705,29 @@ read_ranges (struct comp_unit *unit, struct arange *arange,
   bfd_byte *ranges_ptr;
   bfd_byte *ranges_end;
   bfd_vma base_address = unit->base_address;
+  struct comp_unit *runit = unit;
+
+  /* A split unit's range lists are in the .debug_ranges of its
+     skeleton, after the skeleton's DW_AT_GNU_ranges_base.  */
+  if (unit->skeleton != NULL)
+    {
+      runit = unit->skeleton;
+      offset += unit->dwarf_ranges_offset;
+      if (offset < unit->dwarf_ranges_offset)
+	return false;
+    }
 
-  if (! unit->file->dwarf_ranges_buffer)
+  if (! runit->file->dwarf_ranges_buffer)
     {
-      if (! read_debug_ranges (unit))
+      if (! read_debug_ranges (runit))
 	return false;
     }
 
-  if (offset > unit->file->dwarf_ranges_size)
+  if (offset > runit->file->dwarf_ranges_size)
     return false;
-  ranges_ptr = unit->file->dwarf_ranges_buffer + offset;
-  ranges_end = unit->file->dwarf_ranges_buffer + unit->file->dwarf_ranges_size;
+  ranges_ptr = runit->file->dwarf_ranges_buffer + offset;
+  ranges_end = (runit->file->dwarf_ranges_buffer
+		+ runit->file->dwarf_ranges_size);
 
   for (;;)
     {
@@ -3709,6 +4764,7 @@ read_rnglists (struct comp_unit *unit, struct arange *arange,
   bfd_vma base_address = unit->base_address;
   bfd_vma low_pc;
   bfd_vma high_pc;
+  uint64_t idx;
   bfd *abfd = unit->abfd;
 
   if (! unit->file->dwarf_rnglists_buffer)
@@ -3768,10 +4824,32 @@ read_rnglists (struct comp_unit *unit, struct arange *arange,
 	  high_pc = read_address (unit, &rngs_ptr, rngs_end);
 	  break;
 
-	/* TODO x-variants need .debug_addr support used for split-dwarf.  */
 	case DW_RLE_base_addressx:
+	  if (!addr_base_known (unit))
+	    return false;
+	  idx = _bfd_safe_read_leb128 (abfd, &rngs_ptr, false, rngs_end);
+	  base_address = read_indexed_address (idx, unit);
+	  continue;
+
 	case DW_RLE_startx_endx:
+	  if (!addr_base_known (unit))
+	    return false;
+	  idx = _bfd_safe_read_leb128 (abfd, &rngs_ptr, false, rngs_end);
+	  low_pc = read_indexed_address (idx, unit);
+	  idx = _bfd_safe_read_leb128 (abfd, &rngs_ptr, false, rngs_end);
+	  high_pc = read_indexed_address (idx, unit);
+	  break;
+
 	case DW_RLE_startx_length:
+	  if (!addr_base_known (unit))
+	    return false;
+	  idx = _bfd_safe_read_leb128 (abfd, &rngs_ptr, false, rngs_end);
+	  low_pc = read_indexed_address (idx, unit);
+	  high_pc = low_pc;
+	  high_pc += _bfd_safe_read_leb128 (abfd, &rngs_ptr,
+					    false, rngs_end);
+	  break;
+
 	default:
 	  return false;
 	}
@@ -3863,7 +4941,15 @@ scan_unit_for_symbols (struct comp_unit *unit)
   int nested_funcs_size;
   struct funcinfo *last_func;
   struct varinfo *last_var;
-  
+  struct trie_node **trie_root = &unit->file->trie_root;
+
+  /* A unit scanned again after its tables were dropped has the
+     ranges of its functions in the trie already.  */
+  if (unit->symbol_ranges_known)
+    trie_root = NULL;
+
+  unit->symbols_scanned = true;
+
   /* Maintain a stack of in-scope functions and inlined functions, which we
      can use to set the caller_func field.  */
   nested_funcs_size = 32;
@@ -3922,7 +5008,7 @@ scan_unit_for_symbols (struct comp_unit *unit)
 	  size_t amt = sizeof (struct funcinfo);
 
 	  var = NULL;
-	  func = (struct funcinfo *) bfd_zalloc (abfd, amt);
+	  func = (struct funcinfo *) dwarf_zalloc (abfd, amt);
 	  if (func == NULL)
 	    goto fail;
 	  func->tag = abbrev->tag;
@@ -3949,7 +5035,7 @@ scan_unit_for_symbols (struct comp_unit *unit)
 	    {
 	      size_t amt = sizeof (struct varinfo);
 
-	      var = (struct varinfo *) bfd_zalloc (abfd, amt);
+	      var = (struct varinfo *) dwarf_zalloc (abfd, amt);
 	      if (var == NULL)
 		goto fail;
 	      var->tag = abbrev->tag;
@@ -4144,7 +5230,7 @@ scan_unit_for_symbols (struct comp_unit *unit)
 		case DW_AT_ranges:
 		  if (is_int_form (&attr)
 		      && !read_rangelist (unit, &func->arange,
-					  &unit->file->trie_root, attr.u.val))
+					  trie_root, attr.u.val))
 		    goto fail;
 		  break;
 
@@ -4258,8 +5344,7 @@ scan_unit_for_symbols (struct comp_unit *unit)
 
       if (func && high_pc != 0)
 	{
-	  if (!arange_add (unit, &func->arange, &unit->file->trie_root,
-			   low_pc, high_pc))
+	  if (!arange_add (unit, &func->arange, trie_root, low_pc, high_pc))
 	    goto fail;
 	}
     }
@@ -4302,6 +5387,12 @@ reread_attribute (struct comp_unit *unit,
 	unit->name = attr->u.str;
       break;
 
+    case DW_AT_dwo_name:
+    case DW_AT_GNU_dwo_name:
+      if (is_str_form (attr))
+	unit->dwo_name = attr->u.str;
+      break;
+
     case DW_AT_low_pc:
       *low_pc = attr->u.val;
       if (compunit)
@@ -4349,11 +5440,25 @@ reread_attribute (struct comp_unit *unit,
     }
 }
 
+/* Where the sections of a split unit start, in the DWO or DWARF
+   package file holding it.  All are zero in a DWO file.  */
+
+struct dwo_contribution
+{
+  uint64_t info_offset;
+  uint64_t info_size;
+  uint64_t abbrev_offset;
+  uint64_t str_offsets_offset;
+  uint64_t rnglists_offset;
+};
+
 /* Parse a DWARF2 compilation unit starting at INFO_PTR.  UNIT_LENGTH
    includes the compilation unit header that proceeds the DIE's, but
    does not include the length field that precedes each compilation
    unit header.  END_PTR points one past the end of this comp unit.
    OFFSET_SIZE is the size of DWARF2 offsets (either 4 or 8 bytes).
+   SKELETON is NULL, except for a split unit, which is the unit of
+   SKELETON and has its sections at CONTRIB in FILE.
 
    This routine does not read the whole compilation unit; only enough
    to get to the line number information for the compilation unit.  */
@@ -4364,14 +5469,16 @@ parse_comp_unit (struct dwarf2_debug *stash,
 		 bfd_byte *info_ptr,
 		 bfd_vma unit_length,
 		 bfd_byte *info_ptr_unit,
-		 unsigned int offset_size)
+		 unsigned int offset_size,
+		 struct comp_unit *skeleton,
+		 const struct dwo_contribution *contrib)
 {
   struct comp_unit* unit;
   unsigned int version;
   uint64_t abbrev_offset = 0;
   /* Initialize it just to avoid a GCC false warning.  */
   unsigned int addr_size = -1;
-  struct abbrev_info** abbrevs;
+  struct abbrev_table *abbrevs;
   unsigned int abbrev_number, i;
   struct abbrev_info *abbrev;
   struct attribute attr;
@@ -4386,6 +5493,10 @@ parse_comp_unit (struct dwarf2_debug *stash,
   size_t str_count = 0;
   size_t str_alloc = 0;
   bool compunit_flag = false;
+  uint64_t dwo_id = 0;
+  bool has_dwo_id = false;
+  struct attribute ranges_attr;
+  bool have_ranges = false;
 
   version = read_2_bytes (abfd, &info_ptr, end_ptr);
   if (version < 2 || version > 5)
@@ -4418,12 +5529,16 @@ parse_comp_unit (struct dwarf2_debug *stash,
   else
     abbrev_offset = read_8_bytes (abfd, &info_ptr, end_ptr);
 
+  if (contrib != NULL)
+    abbrev_offset += contrib->abbrev_offset;
+
   if (version < 5)
     addr_size = read_1_byte (abfd, &info_ptr, end_ptr);
 
   switch (unit_type)
     {
     case DW_UT_type:
+    case DW_UT_split_type:
       /* Skip type signature.  */
       info_ptr += 8;
 
@@ -4432,8 +5547,9 @@ parse_comp_unit (struct dwarf2_debug *stash,
       break;
 
     case DW_UT_skeleton:
-      /* Skip DWO_id field.  */
-      info_ptr += 8;
+    case DW_UT_split_compile:
+      dwo_id = read_8_bytes (abfd, &info_ptr, end_ptr);
+      has_dwo_id = true;
       break;
 
     default:
@@ -4487,7 +5603,7 @@ parse_comp_unit (struct dwarf2_debug *stash,
     }
 
   amt = sizeof (struct comp_unit);
-  unit = (struct comp_unit *) bfd_zalloc (abfd, amt);
+  unit = (struct comp_unit *) dwarf_zalloc (abfd, amt);
   if (unit == NULL)
     return NULL;
   unit->abfd = abfd;
@@ -4499,8 +5615,29 @@ parse_comp_unit (struct dwarf2_debug *stash,
   unit->stash = stash;
   unit->file = file;
   unit->info_ptr_unit = info_ptr_unit;
+  unit->dwo_id = dwo_id;
+  unit->has_dwo_id = has_dwo_id;
+
+  if (skeleton != NULL)
+    {
+      /* A split unit uses the addresses and range lists of its
+	 skeleton, and its own string offsets and range list offsets
+	 after the header of each table.  */
+      unit->skeleton = skeleton;
+      unit->base_address = skeleton->base_address;
+      unit->dwarf_addr_offset = skeleton->dwarf_addr_offset;
+      unit->dwarf_ranges_offset = skeleton->dwarf_ranges_offset;
+      unit->dwarf_str_offset = contrib->str_offsets_offset;
+      if (version >= 5)
+	{
+	  unit->dwarf_str_offset += offset_size == 4 ? 8 : 16;
+	  unit->dwarf_rnglists_offset = (contrib->rnglists_offset
+					 + (offset_size == 4 ? 12 : 20));
+	}
+    }
 
-  if (abbrev->tag == DW_TAG_compile_unit)
+  if (abbrev->tag == DW_TAG_compile_unit
+      || abbrev->tag == DW_TAG_skeleton_unit)
     compunit_flag = true;
 
   for (i = 0; i < abbrev->num_attrs; ++i)
@@ -4512,8 +5649,8 @@ parse_comp_unit (struct dwarf2_debug *stash,
       /* Identify attributes of the form strx* and addrx* which come before
 	 DW_AT_str_offsets_base and DW_AT_addr_base respectively in the CU.
 	 Store the attributes in an array and process them later.  */
-      if ((unit->dwarf_str_offset == 0 && is_strx_form (attr.form))
-	  || (unit->dwarf_addr_offset == 0 && is_addrx_form (attr.form)))
+      if ((!str_base_known (unit) && is_strx_form (attr.form))
+	  || (!addr_base_known (unit) && is_addrx_form (attr.form)))
 	{
 	  if (str_count <= str_alloc)
 	    {
@@ -4566,10 +5703,10 @@ parse_comp_unit (struct dwarf2_debug *stash,
 	  break;
 
 	case DW_AT_ranges:
-	  if (is_int_form (&attr)
-	      && !read_rangelist (unit, &unit->arange,
-				  &unit->file->trie_root, attr.u.val))
-	    goto err_exit;
+	  /* Read the ranges once DW_AT_low_pc, DW_AT_addr_base and
+	     DW_AT_rnglists_base are known, as they may come later.  */
+	  ranges_attr = attr;
+	  have_ranges = true;
 	  break;
 
 	case DW_AT_comp_dir:
@@ -4603,6 +5740,7 @@ parse_comp_unit (struct dwarf2_debug *stash,
 	  break;
 
 	case DW_AT_addr_base:
+	case DW_AT_GNU_addr_base:
 	  unit->dwarf_addr_offset = attr.u.val;
 	  break;
 
@@ -4610,6 +5748,28 @@ parse_comp_unit (struct dwarf2_debug *stash,
 	  unit->dwarf_str_offset = attr.u.val;
 	  break;
 
+	case DW_AT_rnglists_base:
+	  unit->dwarf_rnglists_offset = attr.u.val;
+	  break;
+
+	case DW_AT_GNU_ranges_base:
+	  unit->dwarf_ranges_offset = attr.u.val;
+	  break;
+
+	case DW_AT_dwo_name:
+	case DW_AT_GNU_dwo_name:
+	  if (is_str_form (&attr))
+	    unit->dwo_name = attr.u.str;
+	  break;
+
+	case DW_AT_GNU_dwo_id:
+	  if (is_int_form (&attr))
+	    {
+	      unit->dwo_id = attr.u.val;
+	      unit->has_dwo_id = true;
+	    }
+	  break;
+
 	default:
 	  break;
 	}
@@ -4619,6 +5779,19 @@ parse_comp_unit (struct dwarf2_debug *stash,
     reread_attribute (unit, &str_addrp[i], &low_pc, &high_pc,
 		      &high_pc_relative, compunit_flag);
 
+  if (have_ranges)
+    {
+      if (ranges_attr.form == DW_FORM_rnglistx
+	  && unit->dwarf_rnglists_offset != 0
+	  && read_rnglist_offset (ranges_attr.u.val, unit,
+				  &ranges_attr.u.val))
+	ranges_attr.form = DW_FORM_sec_offset;
+      if (is_int_form (&ranges_attr)
+	  && !read_rangelist (unit, &unit->arange,
+			      &unit->file->trie_root, ranges_attr.u.val))
+	goto err_exit;
+    }
+
   if (high_pc_relative)
     high_pc += low_pc;
   if (high_pc != 0)
@@ -4654,7 +5827,11 @@ comp_unit_may_contain_address (struct comp_unit *unit, bfd_vma addr)
     return false;
 
   if (unit->arange.high == 0 /* No ranges have been computed yet.  */
-      || unit->line_table == NULL) /* The line info table has not been loaded.  */
+      /* The line info table has not been loaded, nor the function
+	 ranges, unless they were and have been dropped since to keep
+	 to the DWARF memory budget.  */
+      || ((unit->line_table == NULL || !unit->symbols_scanned)
+	  && (!unit->line_ranges_known || !unit->symbol_ranges_known)))
     return true;
 
   for (arange = &unit->arange; arange != NULL; arange = arange->next)
@@ -4667,7 +5844,9 @@ comp_unit_may_contain_address (struct comp_unit *unit, bfd_vma addr)
 /* If UNIT contains ADDR, set the output parameters to the values for
    the line containing ADDR and return TRUE.  Otherwise return FALSE.
    The output parameters, FILENAME_PTR, FUNCTION_PTR, and
-   LINENUMBER_PTR, are pointers to the objects to be filled in.  */
+   LINENUMBER_PTR, are pointers to the objects to be filled in.
+   FUNCTION_PTR may be NULL when only the line is wanted, in which
+   case the unit's functions need not be read.  */
 
 static bool
 comp_unit_find_nearest_line (struct comp_unit *unit,
@@ -4677,16 +5856,24 @@ comp_unit_find_nearest_line (struct comp_unit *unit,
 			     unsigned int *linenumber_ptr,
 			     unsigned int *discriminator_ptr)
 {
-  bool line_p, func_p;
+  bool line_p, func_p = false;
 
-  if (!comp_unit_maybe_decode_line_info (unit))
-    return false;
+  if (function_ptr == NULL)
+    {
+      if (!comp_unit_maybe_decode_line_info (unit))
+	return false;
+    }
+  else
+    {
+      if (!comp_unit_maybe_scan_symbols (unit))
+	return false;
 
-  *function_ptr = NULL;
-  func_p = lookup_address_in_function_table (unit, addr, function_ptr);
+      *function_ptr = NULL;
+      func_p = lookup_address_in_function_table (unit, addr, function_ptr);
 
-  if (func_p && (*function_ptr)->tag == DW_TAG_inlined_subroutine)
-    unit->stash->inliner_chain = *function_ptr;
+      if (func_p && (*function_ptr)->tag == DW_TAG_inlined_subroutine)
+	unit->stash->inliner_chain = *function_ptr;
+    }
 
   line_p = lookup_address_in_line_info_table (unit->line_table, addr,
 					      filename_ptr,
@@ -4695,6 +5882,174 @@ comp_unit_find_nearest_line (struct comp_unit *unit,
   return line_p || func_p;
 }
 
+/* Start decoding tables of UNIT, into memory of its own if OWN and
+   there is a DWARF memory budget, so that they can be dropped when
+   the budget is reached.  Tables shared with other units, those of
+   units in the info hash tables and those decoded on worker threads
+   stay with the BFD.  Returns what to give comp_unit_alloc_end.  */
+
+static struct comp_unit *
+comp_unit_alloc_begin (struct comp_unit *unit, bool own)
+{
+  struct comp_unit *prev = dwarf_alloc_unit;
+
+  own = (own
+	 && bfd_get_dwarf_memory_budget () != 0
+	 && dwarf_thread_memory == NULL
+	 && !unit->cached
+	 && unit->skeleton == NULL
+	 && !comp_unit_is_skeleton (unit));
+  if (own && unit->memory == NULL)
+    {
+      unit->memory = objalloc_create ();
+      own = unit->memory != NULL;
+    }
+  dwarf_alloc_unit = own ? unit : NULL;
+  return prev;
+}
+
+/* Finish decoding tables of a unit, going back to allocating for
+   PREV.  */
+
+static void
+comp_unit_alloc_end (struct comp_unit *prev)
+{
+  dwarf_alloc_unit = prev;
+}
+
+/* Take UNIT off the chain of units with memory of their own.  */
+
+static void
+comp_unit_lru_unlink (struct comp_unit *unit)
+{
+  struct dwarf2_debug *stash = unit->stash;
+
+  if (unit->lru_prev != NULL)
+    unit->lru_prev->lru_next = unit->lru_next;
+  else if (stash->lru_first == unit)
+    stash->lru_first = unit->lru_next;
+  else
+    return;
+  if (unit->lru_next != NULL)
+    unit->lru_next->lru_prev = unit->lru_prev;
+  else
+    stash->lru_last = unit->lru_prev;
+  unit->lru_prev = NULL;
+  unit->lru_next = NULL;
+}
+
+/* Note that UNIT has just been used, if it has memory of its own.  */
+
+static void
+comp_unit_touch (struct comp_unit *unit)
+{
+  struct dwarf2_debug *stash = unit->stash;
+
+  if (unit->memory == NULL || stash->lru_first == unit)
+    return;
+  comp_unit_lru_unlink (unit);
+  unit->lru_next = stash->lru_first;
+  if (stash->lru_first != NULL)
+    stash->lru_first->lru_prev = unit;
+  else
+    stash->lru_last = unit;
+  stash->lru_first = unit;
+}
+
+/* Free the memory the tables of UNIT have allocated with malloc.  */
+
+static void
+comp_unit_free_tables (struct comp_unit *unit)
+{
+  struct funcinfo *function_table = unit->function_table;
+  struct varinfo *variable_table = unit->variable_table;
+
+  /* A split unit has the line table of its skeleton.  */
+  if (unit->line_table
+      && unit->line_table != unit->file->line_table
+      && unit->skeleton == NULL)
+    {
+      free (unit->line_table->file_names);
+      unit->line_table->file_names = NULL;
+      free (unit->line_table->files);
+      unit->line_table->files = NULL;
+      free (unit->line_table->dirs);
+      unit->line_table->dirs = NULL;
+    }
+
+  free (unit->lookup_funcinfo_table);
+  unit->lookup_funcinfo_table = NULL;
+
+  while (function_table)
+    {
+      free (function_table->file);
+      function_table->file = NULL;
+      free (function_table->caller_file);
+      function_table->caller_file = NULL;
+      function_table = function_table->prev_func;
+    }
+
+  while (variable_table)
+    {
+      free (variable_table->file);
+      variable_table->file = NULL;
+      variable_table = variable_table->prev_var;
+    }
+}
+
+/* Drop the line table, functions and variables of UNIT, keeping its
+   ranges, so that they are decoded again if UNIT is needed.  */
+
+static void
+comp_unit_evict (struct comp_unit *unit)
+{
+  struct dwarf2_debug *stash = unit->stash;
+
+  comp_unit_lru_unlink (unit);
+  comp_unit_free_tables (unit);
+  if (unit->line_table != unit->file->line_table)
+    unit->line_table = NULL;
+  unit->function_table = NULL;
+  unit->variable_table = NULL;
+  unit->number_of_functions = 0;
+  unit->symbols_scanned = false;
+  objalloc_free (unit->memory);
+  unit->memory = NULL;
+  stash->decoded_size -= unit->decoded_size;
+  unit->decoded_size = 0;
+}
+
+/* Drop the tables of the units of STASH used least recently until
+   those left fit the DWARF memory budget.  This is only done as a
+   lookup starts, since the names and functions an earlier lookup
+   returned may be in the tables.  Units gone into the info hash
+   tables since they were decoded are no longer counted.  */
+
+static void
+stash_trim_units (struct dwarf2_debug *stash)
+{
+  bfd_size_type budget = bfd_get_dwarf_memory_budget ();
+  struct comp_unit *unit, *prev;
+
+  if (budget == 0)
+    return;
+  for (unit = stash->lru_last;
+       unit != NULL && stash->decoded_size > budget;
+       unit = prev)
+    {
+      prev = unit->lru_prev;
+      if (unit->cached)
+	{
+	  comp_unit_lru_unlink (unit);
+	  stash->decoded_size -= unit->decoded_size;
+	  unit->decoded_size = 0;
+	}
+      else
+	comp_unit_evict (unit);
+    }
+  stash->inliner_chain = NULL;
+}
+
 /* Check to see if line info is already decoded in a comp_unit.
    If not, decode it.  Returns TRUE if no errors were encountered;
    FALSE otherwise.  */
@@ -4707,28 +6062,62 @@ comp_unit_maybe_decode_line_info (struct comp_unit *unit)
 
   if (! unit->line_table)
     {
+      struct comp_unit *prev;
+
       if (! unit->stmtlist)
 	{
 	  unit->error = 1;
 	  return false;
 	}
 
+      /* The table at offset zero is shared by the units using it.  */
+      prev = comp_unit_alloc_begin (unit, unit->line_offset != 0);
       unit->line_table = decode_line_info (unit);
+      comp_unit_alloc_end (prev);
 
       if (! unit->line_table)
 	{
 	  unit->error = 1;
 	  return false;
 	}
+      unit->line_ranges_known = true;
+    }
+
+  comp_unit_touch (unit);
+  return true;
+}
+
+/* Likewise, and also scan the unit for functions and variables if
+   that has not been done.  The functions and variables of a skeleton
+   unit are read from its split unit, and if that can't be found the
+   unit just has its line info.  */
+
+static bool
+comp_unit_maybe_scan_symbols (struct comp_unit *unit)
+{
+  if (!comp_unit_maybe_decode_line_info (unit))
+    return false;
+
+  if (!unit->symbols_scanned)
+    {
+      struct comp_unit *prev = comp_unit_alloc_begin (unit, true);
+      bool ok = (unit->first_child_die_ptr >= unit->end_ptr
+		 || scan_unit_for_symbols (unit));
 
-      if (unit->first_child_die_ptr < unit->end_ptr
-	  && ! scan_unit_for_symbols (unit))
+      comp_unit_alloc_end (prev);
+      if (!ok)
 	{
 	  unit->error = 1;
 	  return false;
 	}
+      unit->symbols_scanned = true;
+      unit->symbol_ranges_known = true;
+      comp_unit_touch (unit);
     }
 
+  if (comp_unit_is_skeleton (unit) && !unit->split_unit_read)
+    comp_unit_read_split_unit (unit);
+
   return true;
 }
 
@@ -4747,7 +6136,7 @@ comp_unit_find_line (struct comp_unit *unit,
 		     const char **filename_ptr,
 		     unsigned int *linenumber_ptr)
 {
-  if (!comp_unit_maybe_decode_line_info (unit))
+  if (!comp_unit_maybe_scan_symbols (unit))
     return false;
 
   if (sym->flags & BSF_FUNCTION)
@@ -4776,7 +6165,7 @@ comp_unit_hash_info (struct dwarf2_debug *stash,
 
   BFD_ASSERT (stash->info_hash_status != STASH_INFO_HASH_DISABLED);
 
-  if (!comp_unit_maybe_decode_line_info (unit))
+  if (!comp_unit_maybe_scan_symbols (unit))
     return false;
 
   BFD_ASSERT (!unit->cached);
@@ -4945,7 +6334,8 @@ _bfd_dwarf2_stash_syms (struct dwarf2_debug *stash, bfd *abfd,
     }
 }
 
-/* Unset vmas for adjusted sections in STASH.  */
+/* Unset vmas for adjusted sections in STASH, if they are set, at the
+   end of a lookup.  */
 
 static void
 unset_sections (struct dwarf2_debug *stash)
@@ -4953,12 +6343,49 @@ unset_sections (struct dwarf2_debug *stash)
   int i;
   struct adjusted_section *p;
 
+  dwarf_place_stash = NULL;
+  if (!stash->sections_placed)
+    return;
+  stash->sections_placed = false;
+
   i = stash->adjusted_section_count;
   p = stash->adjusted_sections;
   for (; i > 0; i--, p++)
     p->section->vma = p->orig_vma;
 }
 
+/* The VMA of SECTION that the debug info of STASH is read with: the
+   one place_sections gives it if it is a section of a relocatable
+   object, whether or not that VMA is set just now.  */
+
+static bfd_vma
+stash_section_vma (const struct dwarf2_debug *stash, const asection *section)
+{
+  const asection *s = section;
+  bfd_vma offset = 0;
+
+  if (section->output_section != NULL)
+    {
+      s = section->output_section;
+      offset = section->output_offset;
+    }
+  if (s->owner == stash->orig_bfd
+      && (unsigned int) s->index < stash->section_adjustment_count
+      && stash->section_adjustments[s->index] != NULL)
+    return stash->section_adjustments[s->index]->adj_vma + offset;
+  return s->vma + offset;
+}
+
+/* Start a lookup in STASH.  The VMAs of its sections are only set if
+   relocated section contents have to be read.  */
+
+static void
+stash_begin_lookup (struct dwarf2_debug *stash)
+{
+  if (stash->adjusted_section_count > 0)
+    dwarf_place_stash = stash;
+}
+
 /* Set VMAs for allocated and .debug_info sections in ORIG_BFD, a
    relocatable object file.  VMAs are normally all zero in relocatable
    object files, so if we want to distinguish locations in sections by
@@ -4979,10 +6406,14 @@ place_sections (bfd *orig_bfd, struct dwarf2_debug *stash)
 
   if (stash->adjusted_section_count != 0)
     {
-      i = stash->adjusted_section_count;
-      p = stash->adjusted_sections;
-      for (; i > 0; i--, p++)
-	p->section->vma = p->adj_vma;
+      if (stash->adjusted_section_count > 0 && !stash->sections_placed)
+	{
+	  i = stash->adjusted_section_count;
+	  p = stash->adjusted_sections;
+	  for (; i > 0; i--, p++)
+	    p->section->vma = p->adj_vma;
+	  stash->sections_placed = true;
+	}
       return true;
     }
 
@@ -5029,6 +6460,14 @@ place_sections (bfd *orig_bfd, struct dwarf2_debug *stash)
 
       stash->adjusted_sections = p;
       stash->adjusted_section_count = i;
+      stash->sections_placed = true;
+
+      stash->section_adjustments
+	= bfd_zmalloc (orig_bfd->section_count
+		       * sizeof (*stash->section_adjustments));
+      if (stash->section_adjustments == NULL)
+	return false;
+      stash->section_adjustment_count = orig_bfd->section_count;
 
       abfd = orig_bfd;
       while (1)
@@ -5066,6 +6505,9 @@ place_sections (bfd *orig_bfd, struct dwarf2_debug *stash)
 	      *v += sz;
 
 	      p->adj_vma = sect->vma;
+	      if (abfd == orig_bfd
+		  && (unsigned int) sect->index < orig_bfd->section_count)
+		stash->section_adjustments[sect->index] = p;
 	      p++;
 	    }
 	  if (abfd == stash->f.bfd_ptr)
@@ -5387,7 +6829,11 @@ _bfd_dwarf2_slurp_debug_info (bfd *abfd, bfd *debug_bfd,
 	     before attempting to make use of it.  */
 	  if (stash->f.dwarf_info_size != 0)
 	    {
-	      if (do_place && !place_sections (abfd, stash))
+	      /* The layout is kept, and only set when a lookup needs
+		 it.  */
+	      if (do_place
+		  && stash->adjusted_section_count == 0
+		  && !place_sections (abfd, stash))
 		return false;
 	      return true;
 	    }
@@ -5414,11 +6860,20 @@ _bfd_dwarf2_slurp_debug_info (bfd *abfd, bfd *debug_bfd,
 					       del_abbrev, calloc, free);
   if (!stash->f.abbrev_offsets)
     return false;
+  htab_set_incremental (stash->f.abbrev_offsets, 1);
 
   stash->alt.abbrev_offsets = htab_create_alloc (10, hash_abbrev, eq_abbrev,
 						 del_abbrev, calloc, free);
   if (!stash->alt.abbrev_offsets)
     return false;
+  htab_set_incremental (stash->alt.abbrev_offsets, 1);
+
+  stash->abstract_instances = htab_create_alloc (10, hash_abstract_instance,
+						 eq_abstract_instance,
+						 del_abstract_instance,
+						 calloc, free);
+  if (!stash->abstract_instances)
+    return false;
 
   stash->f.trie_root = alloc_trie_leaf (abfd);
   if (!stash->f.trie_root)
@@ -5542,34 +6997,31 @@ _bfd_dwarf2_slurp_debug_info (bfd *abfd, bfd *debug_bfd,
   return false;
 }
 
-/* Parse the next DWARF2 compilation unit at FILE->INFO_PTR.  */
+/* Read the length at the start of the unit header at *INFO_PTR in
+   ABFD, but not at or beyond INFO_PTR_END, and set *OFFSET_SIZE to the
+   size of the offsets of the unit.  */
 
-static struct comp_unit *
-stash_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
+static bfd_size_type
+read_unit_length (bfd *abfd, bfd_byte **info_ptr, bfd_byte *info_ptr_end,
+		  unsigned int *offset_size)
 {
   bfd_size_type length;
-  unsigned int offset_size;
-  bfd_byte *info_ptr_unit = file->info_ptr;
-  bfd_byte *info_ptr_end = file->dwarf_info_buffer + file->dwarf_info_size;
 
-  if (file->info_ptr >= info_ptr_end)
-    return NULL;
-
-  length = read_4_bytes (file->bfd_ptr, &file->info_ptr, info_ptr_end);
+  length = read_4_bytes (abfd, info_ptr, info_ptr_end);
   /* A 0xffffff length is the DWARF3 way of indicating
      we use 64-bit offsets, instead of 32-bit offsets.  */
   if (length == 0xffffffff)
     {
-      offset_size = 8;
-      length = read_8_bytes (file->bfd_ptr, &file->info_ptr, info_ptr_end);
+      *offset_size = 8;
+      length = read_8_bytes (abfd, info_ptr, info_ptr_end);
     }
   /* A zero length is the IRIX way of indicating 64-bit offsets,
      mostly because the 64-bit length will generally fit in 32
      bits, and the endianness helps.  */
   else if (length == 0)
     {
-      offset_size = 8;
-      length = read_4_bytes (file->bfd_ptr, &file->info_ptr, info_ptr_end);
+      *offset_size = 8;
+      length = read_4_bytes (abfd, info_ptr, info_ptr_end);
     }
   /* In the absence of the hints above, we assume 32-bit DWARF2
      offsets even for targets with 64-bit addresses, because:
@@ -5581,31 +7033,46 @@ stash_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
      the size hints that are tested for above then they are
      not conforming to the DWARF3 standard anyway.  */
   else
-    offset_size = 4;
+    *offset_size = 4;
+  return length;
+}
+
+/* Parse the DWARF2 compilation unit whose header is at INFO_PTR_UNIT
+   in FILE and add it to the units of FILE.  */
+
+static struct comp_unit *
+stash_comp_unit_at (struct dwarf2_debug *stash, struct dwarf2_debug_file *file,
+		    bfd_byte *info_ptr_unit)
+{
+  bfd_size_type length;
+  unsigned int offset_size;
+  bfd_byte *info_ptr = info_ptr_unit;
+  bfd_byte *info_ptr_end = file->dwarf_info_buffer + file->dwarf_info_size;
+
+  if (info_ptr >= info_ptr_end)
+    return NULL;
 
+  length = read_unit_length (file->bfd_ptr, &info_ptr, info_ptr_end,
+			     &offset_size);
   if (length != 0
-      && length <= (size_t) (info_ptr_end - file->info_ptr))
+      && length <= (size_t) (info_ptr_end - info_ptr))
     {
-      struct comp_unit *each = parse_comp_unit (stash, file,
-						file->info_ptr, length,
-						info_ptr_unit, offset_size);
+      /* Units are kept with the BFD, even when read while another
+	 unit's tables are being decoded.  */
+      struct comp_unit *alloc_unit = dwarf_alloc_unit;
+      struct comp_unit *each;
+
+      dwarf_alloc_unit = NULL;
+      each = parse_comp_unit (stash, file, info_ptr, length,
+			      info_ptr_unit, offset_size, NULL, NULL);
+      dwarf_alloc_unit = alloc_unit;
       if (each)
 	{
-	  if (file->comp_unit_tree == NULL)
-	    file->comp_unit_tree
-	      = splay_tree_new (splay_tree_compare_addr_range,
-				splay_tree_free_addr_range, NULL);
-
-	  struct addr_range *r
-	    = (struct addr_range *)bfd_malloc (sizeof (struct addr_range));
-	  r->start = each->info_ptr_unit;
-	  r->end = each->end_ptr;
-	  splay_tree_node v = splay_tree_lookup (file->comp_unit_tree,
-						 (splay_tree_key)r);
-	  if (v != NULL || r->end <= r->start)
-	    abort ();
-	  splay_tree_insert (file->comp_unit_tree, (splay_tree_key)r,
-			     (splay_tree_value)each);
+	  _bfd_hook (bfd_hook_dwarf_cu_parse, file->bfd_ptr, NULL, each->name,
+		     info_ptr_unit - file->dwarf_info_buffer, length);
+
+	  if (!index_comp_unit (file, each))
+	    return NULL;
 
 	  if (file->all_comp_units)
 	    file->all_comp_units->prev_unit = each;
@@ -5620,117 +7087,2211 @@ stash_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
 	      each->next_unit_without_ranges = file->all_comp_units_without_ranges;
 	      file->all_comp_units_without_ranges = each->next_unit_without_ranges;
 	    }
-
-	  file->info_ptr += length;
 	  return each;
 	}
     }
+  return NULL;
+}
+
+/* Parse the next DWARF2 compilation unit at FILE->INFO_PTR.  */
+
+static struct comp_unit *
+stash_comp_unit (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
+{
+  bfd_byte *info_ptr_end = file->dwarf_info_buffer + file->dwarf_info_size;
+  struct comp_unit *each;
+
+  while (file->info_ptr < info_ptr_end)
+    {
+      /* Step over units already read for .debug_aranges.  */
+      if (file->units_out_of_order)
+	{
+	  struct comp_unit *u = find_unit_at (file, file->info_ptr);
+
+	  if (u != NULL)
+	    {
+	      file->info_ptr = u->end_ptr;
+	      continue;
+	    }
+	}
+
+      each = stash_comp_unit_at (stash, file, file->info_ptr);
+      if (each == NULL)
+	break;
+      file->info_ptr = each->end_ptr;
+      return each;
+    }
 
   /* Don't trust any of the DWARF info after a corrupted length or
      parse error.  */
   file->info_ptr = info_ptr_end;
+  file->units_complete = true;
   return NULL;
 }
 
-/* Hash function for an asymbol.  */
+/* Open the DWO or DWARF package file NAME for the split units of
+   STASH, and read its .debug_info.dwo section.  Returns NULL if there
+   is no such file, or it can't be read.  */
 
-static hashval_t
-hash_asymbol (const void *sym)
+static struct dwarf2_debug_file *
+open_dwo_file (struct dwarf2_debug *stash, const char *name)
 {
-  const asymbol *asym = sym;
-  return htab_hash_string (asym->name);
+  bfd_error_type err = bfd_get_error ();
+  struct dwarf2_debug_file *file;
+  bfd *dwo_bfd;
+
+  dwo_bfd = bfd_openr (name, NULL);
+  if (dwo_bfd == NULL)
+    {
+      bfd_set_error (err);
+      return NULL;
+    }
+  if (!bfd_check_format (dwo_bfd, bfd_object))
+    {
+      bfd_close (dwo_bfd);
+      bfd_set_error (err);
+      return NULL;
+    }
+
+  file = (struct dwarf2_debug_file *) bfd_zmalloc (sizeof (*file));
+  if (file == NULL)
+    {
+      bfd_close (dwo_bfd);
+      return NULL;
+    }
+  file->bfd_ptr = dwo_bfd;
+  file->dwo = true;
+
+  /* Keep the file from here on, so that the cleanup closes it.  */
+  file->next_dwo = stash->dwo_files;
+  stash->dwo_files = file;
+
+  file->abbrev_offsets = htab_create_alloc (10, hash_abbrev, eq_abbrev,
+					    del_abbrev, calloc, free);
+  if (file->abbrev_offsets != NULL)
+    htab_set_incremental (file->abbrev_offsets, 1);
+  file->trie_root = alloc_trie_leaf (dwo_bfd);
+  if (file->abbrev_offsets == NULL
+      || file->trie_root == NULL
+      || !read_section (dwo_bfd, file_debug_section (stash, file, debug_info),
+			NULL, 0,
+			&file->dwarf_info_buffer, &file->dwarf_info_size))
+    return NULL;
+  return file;
 }
 
-/* Equality function for asymbols.  */
+/* Open the DWO file named by skeleton unit UNIT, looking for it in the
+   DW_AT_comp_dir of the unit, and then beside the file of the unit.  */
 
-static int
-eq_asymbol (const void *a, const void *b)
+static struct dwarf2_debug_file *
+stash_open_dwo (struct comp_unit *unit)
 {
-  const asymbol *sa = a;
-  const asymbol *sb = b;
-  return strcmp (sa->name, sb->name) == 0;
+  const char *filename = bfd_get_filename (unit->abfd);
+  size_t dirlen = lbasename (filename) - filename;
+  struct dwarf2_debug_file *file = NULL;
+  char *name;
+
+  if (IS_ABSOLUTE_PATH (unit->dwo_name))
+    return open_dwo_file (unit->stash, unit->dwo_name);
+
+  if (unit->comp_dir != NULL)
+    {
+      name = bfd_malloc (strlen (unit->comp_dir) + strlen (unit->dwo_name)
+			 + 2);
+      if (name == NULL)
+	return NULL;
+      sprintf (name, "%s/%s", unit->comp_dir, unit->dwo_name);
+      file = open_dwo_file (unit->stash, name);
+      free (name);
+    }
+
+  if (file == NULL)
+    {
+      name = bfd_malloc (dirlen + strlen (unit->dwo_name) + 1);
+      if (name == NULL)
+	return NULL;
+      memcpy (name, filename, dirlen);
+      strcpy (name + dirlen, unit->dwo_name);
+      file = open_dwo_file (unit->stash, name);
+      free (name);
+    }
+  return file;
 }
 
-/* Scan the debug information in PINFO looking for a DW_TAG_subprogram
-   abbrev with a DW_AT_low_pc attached to it.  Then lookup that same
-   symbol in SYMBOLS and return the difference between the low_pc and
-   the symbol's address.  Returns 0 if no suitable symbol could be found.  */
+/* Look for the DWARF package file of STASH, named after the file
+   holding its skeleton units with ".dwp" appended, and map the unit
+   index of the package.  */
 
-bfd_signed_vma
-_bfd_dwarf2_find_symbol_bias (asymbol ** symbols, void ** pinfo)
+static void
+stash_open_dwp (struct dwarf2_debug *stash)
 {
-  struct dwarf2_debug *stash;
-  struct comp_unit * unit;
-  htab_t sym_hash;
-  bfd_signed_vma result = 0;
-  asymbol ** psym;
+  const char *filename = bfd_get_filename (stash->f.bfd_ptr);
+  struct dwp_index *index = &stash->dwp_index;
+  struct dwarf2_debug_file *file;
+  const bfd_byte *data;
+  bfd_size_type size, rest;
+  uint32_t columns, units, slots;
+  asection *msec;
+  char *name;
+  bfd *abfd;
 
-  stash = (struct dwarf2_debug *) *pinfo;
+  stash->dwp_tried = true;
+  name = bfd_malloc (strlen (filename) + sizeof (".dwp"));
+  if (name == NULL)
+    return;
+  sprintf (name, "%s.dwp", filename);
+  file = open_dwo_file (stash, name);
+  free (name);
+  if (file == NULL)
+    return;
 
-  if (stash == NULL || symbols == NULL)
-    return 0;
+  abfd = file->bfd_ptr;
+  msec = bfd_get_section_by_name (abfd, ".debug_cu_index");
+  if (msec == NULL
+      || (msec->flags & SEC_HAS_CONTENTS) == 0
+      || msec->compress_status != COMPRESS_SECTION_NONE)
+    return;
+  size = bfd_section_size (msec);
+  if (size < 16)
+    return;
+  data = _bfd_file_view (abfd, msec->filepos, size);
+  if (data == NULL)
+    return;
 
-  sym_hash = htab_create_alloc (10, hash_asymbol, eq_asymbol,
-				NULL, xcalloc, free);
-  for (psym = symbols; * psym != NULL; psym++)
+  /* A version 5 index has a 2 byte version and 2 bytes of padding
+     where the GNU extension has a 4 byte version.  */
+  if (bfd_get_32 (abfd, data) == 2)
+    index->version = 2;
+  else if (bfd_get_16 (abfd, data) == 5)
+    index->version = 5;
+  else
+    return;
+  columns = bfd_get_32 (abfd, data + 4);
+  units = bfd_get_32 (abfd, data + 8);
+  slots = bfd_get_32 (abfd, data + 12);
+
+  /* The hash table has a signature and a row number for each slot,
+     followed by a section id for each column and an offset and size
+     for each column of each row.  */
+  if (slots == 0
+      || (slots & (slots - 1)) != 0
+      || slots > (size - 16) / 12)
+    return;
+  rest = (size - 16 - 12 * (bfd_size_type) slots) / 4;
+  if (columns == 0
+      || columns > rest
+      || units > (rest - columns) / 2 / columns)
+    return;
+
+  index->data = data;
+  index->columns = columns;
+  index->units = units;
+  index->slots = slots;
+  stash->dwp = file;
+}
+
+/* Find the split unit with DWO_ID in the DWARF package file of STASH,
+   and set *CONTRIB to where its sections start.  Returns FALSE if the
+   package has no such unit.  */
+
+static bool
+dwp_find_unit (struct dwarf2_debug *stash, uint64_t dwo_id,
+	       struct dwo_contribution *contrib)
+{
+  const struct dwp_index *index = &stash->dwp_index;
+  bfd *abfd = stash->dwp->bfd_ptr;
+  const bfd_byte *signatures = index->data + 16;
+  const bfd_byte *rows = signatures + 8 * (size_t) index->slots;
+  const bfd_byte *ids = rows + 4 * (size_t) index->slots;
+  const bfd_byte *offsets = ids + 4 * (size_t) index->columns;
+  const bfd_byte *sizes = offsets + 4 * (size_t) index->columns * index->units;
+  uint32_t mask = index->slots - 1;
+  uint32_t slot = dwo_id & mask;
+  uint32_t step = ((dwo_id >> 32) & mask) | 1;
+  uint32_t row = 0;
+  uint32_t i;
+
+  for (i = 0; i < index->slots; i++)
+    {
+      row = bfd_get_32 (abfd, rows + 4 * (size_t) slot);
+      if (row == 0)
+	return false;
+      if (bfd_get_64 (abfd, signatures + 8 * (size_t) slot) == dwo_id)
+	break;
+      slot = (slot + step) & mask;
+    }
+  if (i == index->slots || row > index->units)
+    return false;
+
+  memset (contrib, 0, sizeof (*contrib));
+  offsets += 4 * (size_t) (row - 1) * index->columns;
+  sizes += 4 * (size_t) (row - 1) * index->columns;
+  for (i = 0; i < index->columns; i++)
     {
-      asymbol * sym = * psym;
+      uint64_t offset = bfd_get_32 (abfd, offsets + 4 * i);
 
-      if (sym->flags & BSF_FUNCTION && sym->section != NULL)
+      switch (bfd_get_32 (abfd, ids + 4 * i))
 	{
-	  void **slot = htab_find_slot (sym_hash, sym, INSERT);
-	  *slot = sym;
+	case DW_SECT_INFO:
+	  contrib->info_offset = offset;
+	  contrib->info_size = bfd_get_32 (abfd, sizes + 4 * i);
+	  break;
+
+	case DW_SECT_ABBREV:
+	  contrib->abbrev_offset = offset;
+	  break;
+
+	case DW_SECT_STR_OFFSETS:
+	  contrib->str_offsets_offset = offset;
+	  break;
+
+	case DW_SECT_RNGLISTS_V5:
+	  if (index->version == 5)
+	    contrib->rnglists_offset = offset;
+	  break;
+
+	default:
+	  break;
+	}
+    }
+  return contrib->info_size != 0;
+}
+
+/* Parse the unit whose header is at *INFO_PTR in FILE, but not at or
+   beyond INFO_PTR_END, as the split unit of SKELETON with its sections
+   at CONTRIB.  Sets *INFO_PTR to the next unit, and returns the unit if
+   it is the one SKELETON refers to.  */
+
+static struct comp_unit *
+read_split_unit (struct comp_unit *skeleton, struct dwarf2_debug_file *file,
+		 bfd_byte **info_ptr, bfd_byte *info_ptr_end,
+		 const struct dwo_contribution *contrib)
+{
+  bfd_byte *info_ptr_unit = *info_ptr;
+  bfd_byte *ptr = info_ptr_unit;
+  unsigned int offset_size;
+  bfd_size_type length;
+  struct comp_unit *unit;
+
+  length = read_unit_length (file->bfd_ptr, &ptr, info_ptr_end,
+			     &offset_size);
+  if (length == 0 || length > (size_t) (info_ptr_end - ptr))
+    {
+      *info_ptr = info_ptr_end;
+      return NULL;
+    }
+  *info_ptr = ptr + length;
+
+  unit = parse_comp_unit (skeleton->stash, file, ptr, length,
+			  info_ptr_unit, offset_size, skeleton, contrib);
+  if (unit == NULL
+      || (skeleton->has_dwo_id
+	  && (!unit->has_dwo_id || unit->dwo_id != skeleton->dwo_id)))
+    return NULL;
+
+  if (file->all_comp_units)
+    file->all_comp_units->prev_unit = unit;
+  else
+    file->last_comp_unit = unit;
+  unit->next_unit = file->all_comp_units;
+  file->all_comp_units = unit;
+  return unit;
+}
+
+/* Read the split unit holding the DIEs of skeleton unit UNIT, from the
+   DWARF package file if there is one, or else from the DWO file the
+   skeleton names, and scan it for the functions and variables of
+   UNIT.  The split unit is read into the BFD of its file, so this is
+   only done on the main thread.  Returns FALSE if the split unit can't
+   be found or read.  */
+
+static bool
+comp_unit_read_split_unit (struct comp_unit *unit)
+{
+  struct dwarf2_debug *stash = unit->stash;
+  struct dwo_contribution contrib;
+  struct dwarf2_debug_file *file;
+  struct comp_unit *split = NULL;
+  bfd_byte *info_ptr;
+  bfd_byte *info_ptr_end;
+
+  unit->split_unit_read = true;
+
+  if (!stash->dwp_tried)
+    stash_open_dwp (stash);
+  if (stash->dwp != NULL
+      && unit->has_dwo_id
+      && dwp_find_unit (stash, unit->dwo_id, &contrib))
+    {
+      file = stash->dwp;
+      if (contrib.info_offset <= file->dwarf_info_size
+	  && contrib.info_size <= file->dwarf_info_size - contrib.info_offset)
+	{
+	  info_ptr = file->dwarf_info_buffer + contrib.info_offset;
+	  split = read_split_unit (unit, file, &info_ptr,
+				   info_ptr + contrib.info_size, &contrib);
 	}
     }
 
-  for (unit = stash->f.all_comp_units; unit; unit = unit->next_unit)
+  if (split == NULL && unit->dwo_name != NULL)
     {
-      struct funcinfo * func;
+      file = stash_open_dwo (unit);
+      if (file != NULL)
+	{
+	  memset (&contrib, 0, sizeof (contrib));
+	  info_ptr = file->dwarf_info_buffer;
+	  info_ptr_end = info_ptr + file->dwarf_info_size;
+	  while (split == NULL && info_ptr < info_ptr_end)
+	    split = read_split_unit (unit, file, &info_ptr, info_ptr_end,
+				     &contrib);
+	}
+    }
 
-      comp_unit_maybe_decode_line_info (unit);
+  if (split == NULL)
+    return false;
 
-      for (func = unit->function_table; func != NULL; func = func->prev_func)
-	if (func->name && func->arange.low)
-	  {
-	    asymbol search, *sym;
+  /* The DW_AT_decl_file attributes of the split unit refer to the line
+     table of its skeleton.  */
+  split->line_table = unit->line_table;
+  if (split->first_child_die_ptr < split->end_ptr
+      && !scan_unit_for_symbols (split))
+    {
+      split->error = 1;
+      return false;
+    }
 
-	    /* FIXME: Do we need to scan the aranges looking for the
-	       lowest pc value?  */
+  unit->function_table = split->function_table;
+  unit->number_of_functions = split->number_of_functions;
+  unit->variable_table = split->variable_table;
+  split->function_table = NULL;
+  split->number_of_functions = 0;
+  split->variable_table = NULL;
+  if (unit->lang == 0)
+    unit->lang = split->lang;
+  unit->split_unit = split;
+  return true;
+}
 
-	    search.name = func->name;
-	    sym = htab_find (sym_hash, &search);
-	    if (sym != NULL)
-	      {
-		result = func->arange.low - (sym->value + sym->section->vma);
-		goto done;
-	      }
-	  }
+static int
+compare_debug_aranges (const void *a, const void *b)
+{
+  const struct debug_arange *ra = (const struct debug_arange *) a;
+  const struct debug_arange *rb = (const struct debug_arange *) b;
+
+  if (ra->low != rb->low)
+    return ra->low < rb->low ? -1 : 1;
+  if (ra->high != rb->high)
+    return ra->high < rb->high ? -1 : 1;
+  return 0;
+}
+
+static int
+compare_unit_offsets (const void *a, const void *b)
+{
+  uint64_t oa = *(const uint64_t *) a;
+  uint64_t ob = *(const uint64_t *) b;
+
+  return oa < ob ? -1 : oa > ob;
+}
+
+/* Fill in FILE->unit_offsets by walking the unit lengths in
+   .debug_info.  */
+
+static void
+read_unit_offsets (struct dwarf2_debug_file *file)
+{
+  bfd *abfd = file->bfd_ptr;
+  bfd_byte *p, *end;
+  uint64_t *units = NULL;
+  size_t nunits, units_alloced;
+
+  file->unit_offsets_read = true;
+  nunits = units_alloced = 0;
+  p = file->dwarf_info_buffer;
+  end = p + file->dwarf_info_size;
+  while (p < end)
+    {
+      uint64_t offset = p - file->dwarf_info_buffer;
+      uint64_t length = read_4_bytes (abfd, &p, end);
+
+      if (length == 0xffffffff)
+	length = read_8_bytes (abfd, &p, end);
+      else if (length == 0)
+	length = read_4_bytes (abfd, &p, end);
+      if (length == 0 || length > (size_t) (end - p))
+	break;
+      if (nunits == units_alloced)
+	{
+	  uint64_t *n;
+
+	  units_alloced = units_alloced ? units_alloced * 2 : 256;
+	  n = (uint64_t *) bfd_realloc (units, units_alloced * sizeof (*n));
+	  if (n == NULL)
+	    {
+	      free (units);
+	      return;
+	    }
+	  units = n;
+	}
+      units[nunits++] = offset;
+      p += length;
     }
+  file->unit_offsets = units;
+  file->unit_offsets_count = nunits;
+}
 
- done:
-  htab_delete (sym_hash);
-  return result;
+/* Return TRUE if OFFSET is that of a unit header in FILE's
+   .debug_info.  */
+
+static bool
+valid_unit_offset (struct dwarf2_debug_file *file, uint64_t offset)
+{
+  if (!file->unit_offsets_read)
+    read_unit_offsets (file);
+  return bsearch (&offset, file->unit_offsets, file->unit_offsets_count,
+		  sizeof (*file->unit_offsets), compare_unit_offsets) != NULL;
 }
 
-/* See _bfd_dwarf2_find_nearest_line_with_alt.  */
+/* Return the header of the unit at OFFSET in FILE's .debug_info, or
+   NULL if there is no unit there or it has already been read.  */
 
-int
-_bfd_dwarf2_find_nearest_line (bfd *abfd,
-			       asymbol **symbols,
-			       asymbol *symbol,
-			       asection *section,
-			       bfd_vma offset,
-			       const char **filename_ptr,
-			       const char **functionname_ptr,
-			       unsigned int *linenumber_ptr,
-			       unsigned int *discriminator_ptr,
-			       const struct dwarf_debug_section *debug_sections,
-			       void **pinfo)
+static bfd_byte *
+unread_unit_at (struct dwarf2_debug_file *file, uint64_t offset)
 {
-  return _bfd_dwarf2_find_nearest_line_with_alt
-    (abfd, NULL, symbols, symbol, section, offset, filename_ptr,
-     functionname_ptr, linenumber_ptr, discriminator_ptr, debug_sections,
-     pinfo);
+  bfd_byte *info_ptr_unit;
+
+  if (!valid_unit_offset (file, offset))
+    return NULL;
+
+  /* Units before INFO_PTR have all been read, or failed to parse.  */
+  info_ptr_unit = file->dwarf_info_buffer + offset;
+  if (info_ptr_unit < file->info_ptr)
+    return NULL;
+  if (find_unit_at (file, info_ptr_unit) != NULL)
+    return NULL;
+  return info_ptr_unit;
+}
+
+/* Parse the unit at OFFSET in FILE's .debug_info, unless there is no
+   unit there or it has already been read.  */
+
+static struct comp_unit *
+stash_unread_unit (struct dwarf2_debug *stash,
+		   struct dwarf2_debug_file *file, uint64_t offset)
+{
+  bfd_byte *info_ptr_unit = unread_unit_at (file, offset);
+  struct comp_unit *each;
+
+  if (info_ptr_unit == NULL)
+    return NULL;
+  each = stash_comp_unit_at (stash, file, info_ptr_unit);
+  if (each != NULL)
+    file->units_out_of_order = true;
+  return each;
+}
+
+/* Read the .debug_aranges section of FILE, if there is one, into
+   FILE->aranges.  Only sets that name the start of a unit in
+   .debug_info are kept, so that a bad offset can't make us parse a
+   unit from the middle of another.  Offsets can't be trusted when a
+   relocatable object has several .debug_info sections, so then the
+   section isn't used at all.  */
+
+static void
+read_debug_aranges (struct dwarf2_debug *stash,
+		    struct dwarf2_debug_file *file)
+{
+  bfd *abfd = file->bfd_ptr;
+  asection *msec;
+  bfd_byte *buf = NULL;
+  bfd_size_type size;
+  bfd_byte *p, *end;
+  struct debug_arange *ranges = NULL;
+  size_t count, alloced;
+  bfd_vma max_high;
+  size_t i;
+
+  file->aranges_read = true;
+  msec = find_debug_info (abfd, stash->debug_sections, NULL);
+  if (msec == NULL
+      || find_debug_info (abfd, stash->debug_sections, msec) != NULL)
+    return;
+
+  if (!read_optional_section (abfd, &stash->debug_sections[debug_aranges],
+			      file->syms, &buf, &size))
+    return;
+
+  count = alloced = 0;
+  p = buf;
+  end = buf + size;
+  while (end - p >= 4)
+    {
+      bfd_byte *set = p;
+      bfd_byte *set_end;
+      uint64_t length, info_offset;
+      unsigned int offset_size = 4;
+      unsigned int version, addr_size, seg_size, tuple_size;
+
+      length = read_4_bytes (abfd, &p, end);
+      if (length == 0xffffffff)
+	{
+	  offset_size = 8;
+	  length = read_8_bytes (abfd, &p, end);
+	}
+      if (length == 0 || length > (size_t) (end - p))
+	break;
+      set_end = p + length;
+
+      version = read_2_bytes (abfd, &p, set_end);
+      info_offset = read_n_bytes (abfd, &p, set_end, offset_size);
+      addr_size = read_1_byte (abfd, &p, set_end);
+      seg_size = read_1_byte (abfd, &p, set_end);
+      if (version != 2
+	  || seg_size != 0
+	  || (addr_size != 2 && addr_size != 4 && addr_size != 8)
+	  || !valid_unit_offset (file, info_offset))
+	{
+	  p = set_end;
+	  continue;
+	}
+
+      /* The tuples are aligned to their size from the start of the
+	 set.  */
+      tuple_size = 2 * addr_size;
+      p = set + (p - set + tuple_size - 1) / tuple_size * tuple_size;
+      while (p < set_end && (size_t) (set_end - p) >= tuple_size)
+	{
+	  bfd_vma low = read_n_bytes (abfd, &p, set_end, addr_size);
+	  bfd_vma len = read_n_bytes (abfd, &p, set_end, addr_size);
+
+	  if (low == 0 && len == 0)
+	    break;
+	  if (len == 0 || low + len < low)
+	    continue;
+	  if (count == alloced)
+	    {
+	      struct debug_arange *n;
+
+	      alloced = alloced ? alloced * 2 : 256;
+	      n = ((struct debug_arange *)
+		   bfd_realloc (ranges, alloced * sizeof (*n)));
+	      if (n == NULL)
+		{
+		  free (ranges);
+		  goto out;
+		}
+	      ranges = n;
+	    }
+	  ranges[count].low = low;
+	  ranges[count].high = low + len;
+	  ranges[count].info_offset = info_offset;
+	  count++;
+	}
+      p = set_end;
+    }
+
+  qsort (ranges, count, sizeof (*ranges), compare_debug_aranges);
+  max_high = 0;
+  for (i = 0; i < count; i++)
+    {
+      if (ranges[i].high > max_high)
+	max_high = ranges[i].high;
+      ranges[i].max_high = max_high;
+    }
+  file->aranges = ranges;
+  file->aranges_count = count;
+
+ out:
+  free (buf);
+}
+
+/* Read and return a unit of FILE that .debug_aranges says covers
+   ADDR, if there is one that hasn't been read yet.  */
+
+static struct comp_unit *
+stash_comp_unit_for_addr (struct dwarf2_debug *stash,
+			  struct dwarf2_debug_file *file, bfd_vma addr)
+{
+  size_t lo, hi;
+
+  if (!file->aranges_read)
+    read_debug_aranges (stash, file);
+
+  /* Find the ranges starting no later than ADDR, then look back for
+     those that also end after it.  */
+  lo = 0;
+  hi = file->aranges_count;
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (file->aranges[mid].low <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  for (; lo > 0 && file->aranges[lo - 1].max_high > addr; lo--)
+    {
+      const struct debug_arange *r = &file->aranges[lo - 1];
+      struct comp_unit *each;
+
+      if (addr >= r->high)
+	continue;
+      each = stash_unread_unit (stash, file, r->info_offset);
+      if (each != NULL)
+	return each;
+    }
+  return NULL;
+}
+
+/* Read the .debug_names and .gdb_index sections of FILE, if it has
+   them.  As with .debug_aranges, their unit offsets are only used
+   when there is a single .debug_info section.  */
+
+static void
+read_name_index (struct dwarf2_debug *stash, struct dwarf2_debug_file *file)
+{
+  bfd *abfd = file->bfd_ptr;
+  asection *msec;
+
+  file->name_index_read = true;
+  msec = find_debug_info (abfd, stash->debug_sections, NULL);
+  if (msec == NULL
+      || find_debug_info (abfd, stash->debug_sections, msec) != NULL)
+    return;
+
+  read_optional_section (abfd, &stash->debug_sections[debug_names],
+			 file->syms, &file->dwarf_names_buffer,
+			 &file->dwarf_names_size);
+  read_optional_section (abfd, &stash->debug_sections[gdb_index],
+			 file->syms, &file->gdb_index_buffer,
+			 &file->gdb_index_size);
+}
+
+/* The hash of NAME used by .debug_names, which is the DJB hash of
+   the case folded name.  Like GDB, only ASCII is folded.  */
+
+static uint32_t
+debug_names_hash (const char *name)
+{
+  const unsigned char *p = (const unsigned char *) name;
+  uint32_t hash = 5381;
+
+  while (*p != 0)
+    hash = hash * 33 + TOLOWER (*p++);
+  return hash;
+}
+
+/* Read an attribute value of FORM from a .debug_names entry at *PTR
+   into *VALUE.  Returns FALSE if FORM is not one that we know how to
+   skip.  */
+
+static bool
+read_debug_names_value (bfd *abfd, unsigned int form,
+			unsigned int offset_size,
+			bfd_byte **ptr, bfd_byte *end, uint64_t *value)
+{
+  switch (form)
+    {
+    case DW_FORM_flag_present:
+      *value = 1;
+      return true;
+    case DW_FORM_data1:
+    case DW_FORM_ref1:
+    case DW_FORM_flag:
+      *value = read_1_byte (abfd, ptr, end);
+      return true;
+    case DW_FORM_data2:
+    case DW_FORM_ref2:
+      *value = read_2_bytes (abfd, ptr, end);
+      return true;
+    case DW_FORM_data4:
+    case DW_FORM_ref4:
+      *value = read_4_bytes (abfd, ptr, end);
+      return true;
+    case DW_FORM_data8:
+    case DW_FORM_ref8:
+    case DW_FORM_ref_sig8:
+      *value = read_8_bytes (abfd, ptr, end);
+      return true;
+    case DW_FORM_udata:
+    case DW_FORM_ref_udata:
+      *value = _bfd_safe_read_leb128 (abfd, ptr, false, end);
+      return true;
+    case DW_FORM_sdata:
+      *value = _bfd_safe_read_leb128 (abfd, ptr, true, end);
+      return true;
+    case DW_FORM_strp:
+    case DW_FORM_sec_offset:
+      *value = read_n_bytes (abfd, ptr, end, offset_size);
+      return true;
+    case DW_FORM_data16:
+      *value = 0;
+      *ptr = (size_t) (end - *ptr) < 16 ? end : *ptr + 16;
+      return true;
+    default:
+      return false;
+    }
+}
+
+/* Read and return a unit that the entries at ENTRY in a .debug_names
+   name index say define a name, if there is one that hasn't been read
+   yet.  ABBREVS is the abbrev table of the index, which ends at POOL,
+   the start of the entry pool; the index ends at INDEX_END.  CUS is
+   the index's list of CU_COUNT unit offsets.  */
+
+static struct comp_unit *
+debug_names_entry_unit (struct dwarf2_debug *stash,
+			struct dwarf2_debug_file *file,
+			unsigned int offset_size,
+			bfd_byte *cus, uint32_t cu_count,
+			bfd_byte *abbrevs, bfd_byte *pool,
+			bfd_byte *entry, bfd_byte *index_end)
+{
+  bfd *abfd = file->bfd_ptr;
+
+  while (entry < index_end)
+    {
+      uint64_t code, cu = 0;
+      bool has_cu = false, in_type_unit = false;
+      bfd_byte *abbrev = abbrevs;
+      bfd_byte *cu_ptr;
+      struct comp_unit *each;
+
+      code = _bfd_safe_read_leb128 (abfd, &entry, false, index_end);
+      if (code == 0)
+	break;
+
+      /* Find the abbrev for CODE, leaving ABBREV at its attributes.  */
+      for (;;)
+	{
+	  uint64_t this_code, idx, form;
+
+	  this_code = _bfd_safe_read_leb128 (abfd, &abbrev, false, pool);
+	  if (this_code == 0)
+	    return NULL;
+	  _bfd_safe_read_leb128 (abfd, &abbrev, false, pool);
+	  if (this_code == code)
+	    break;
+	  do
+	    {
+	      idx = _bfd_safe_read_leb128 (abfd, &abbrev, false, pool);
+	      form = _bfd_safe_read_leb128 (abfd, &abbrev, false, pool);
+	    }
+	  while ((idx != 0 || form != 0) && abbrev < pool);
+	}
+
+      for (;;)
+	{
+	  uint64_t idx, form, value;
+
+	  idx = _bfd_safe_read_leb128 (abfd, &abbrev, false, pool);
+	  form = _bfd_safe_read_leb128 (abfd, &abbrev, false, pool);
+	  if (idx == 0 && form == 0)
+	    break;
+	  if (abbrev >= pool
+	      || !read_debug_names_value (abfd, form, offset_size,
+					  &entry, index_end, &value))
+	    return NULL;
+	  if (idx == DW_IDX_compile_unit)
+	    {
+	      cu = value;
+	      has_cu = true;
+	    }
+	  else if (idx == DW_IDX_type_unit)
+	    in_type_unit = true;
+	}
+
+      /* An index of a single unit may leave the unit out.  */
+      if (in_type_unit || (!has_cu && cu_count != 1) || cu >= cu_count)
+	continue;
+      cu_ptr = cus + cu * offset_size;
+      each = stash_unread_unit (stash, file,
+				read_n_bytes (abfd, &cu_ptr, index_end,
+					      offset_size));
+      if (each != NULL)
+	return each;
+    }
+  return NULL;
+}
+
+/* Read and return a unit that FILE's .debug_names says defines NAME,
+   if there is one that hasn't been read yet.  The section may hold
+   several name indexes one after another.  */
+
+static struct comp_unit *
+debug_names_find_unit (struct dwarf2_debug *stash,
+		       struct dwarf2_debug_file *file, const char *name)
+{
+  bfd *abfd = file->bfd_ptr;
+  uint32_t hash = debug_names_hash (name);
+  bfd_byte *p = file->dwarf_names_buffer;
+  bfd_byte *end = p + file->dwarf_names_size;
+
+  while (end - p >= 4)
+    {
+      bfd_byte *index_end, *cus, *buckets, *hashes, *str_offsets;
+      bfd_byte *entry_offsets, *abbrevs, *pool;
+      uint64_t length, tables_size;
+      unsigned int offset_size = 4;
+      uint32_t cu_count, local_tu_count, foreign_tu_count;
+      uint32_t bucket_count, name_count, abbrev_size, aug_size;
+      uint32_t i;
+
+      length = read_4_bytes (abfd, &p, end);
+      if (length == 0xffffffff)
+	{
+	  offset_size = 8;
+	  length = read_8_bytes (abfd, &p, end);
+	}
+      if (length == 0 || length > (size_t) (end - p))
+	break;
+      index_end = p + length;
+
+      if (read_2_bytes (abfd, &p, index_end) != 5)
+	{
+	  p = index_end;
+	  continue;
+	}
+      read_2_bytes (abfd, &p, index_end);
+      cu_count = read_4_bytes (abfd, &p, index_end);
+      local_tu_count = read_4_bytes (abfd, &p, index_end);
+      foreign_tu_count = read_4_bytes (abfd, &p, index_end);
+      bucket_count = read_4_bytes (abfd, &p, index_end);
+      name_count = read_4_bytes (abfd, &p, index_end);
+      abbrev_size = read_4_bytes (abfd, &p, index_end);
+      aug_size = read_4_bytes (abfd, &p, index_end);
+
+      /* Indexes without a hash table would need a linear search;
+	 leave those to the sequential reader.  */
+      tables_size = (((uint64_t) aug_size + 3) & ~(uint64_t) 3)
+		     + ((uint64_t) cu_count + local_tu_count) * offset_size
+		     + (uint64_t) foreign_tu_count * 8
+		     + (uint64_t) bucket_count * 4
+		     + (uint64_t) name_count * (4 + 2 * offset_size)
+		     + abbrev_size;
+      if (bucket_count == 0 || tables_size > (size_t) (index_end - p))
+	{
+	  p = index_end;
+	  continue;
+	}
+
+      cus = p + (((uint64_t) aug_size + 3) & ~(uint64_t) 3);
+      buckets = (cus + ((uint64_t) cu_count + local_tu_count) * offset_size
+		 + (uint64_t) foreign_tu_count * 8);
+      hashes = buckets + (uint64_t) bucket_count * 4;
+      str_offsets = hashes + (uint64_t) name_count * 4;
+      entry_offsets = str_offsets + (uint64_t) name_count * offset_size;
+      abbrevs = entry_offsets + (uint64_t) name_count * offset_size;
+      pool = abbrevs + abbrev_size;
+
+      /* Names with the same bucket are next to each other, starting
+	 at the one-based index in the bucket.  */
+      for (i = bfd_get_32 (abfd, buckets + hash % bucket_count * 4);
+	   i != 0 && i <= name_count;
+	   i++)
+	{
+	  uint32_t this_hash = bfd_get_32 (abfd, hashes + (i - 1) * 4);
+	  bfd_byte *q;
+	  uint64_t str_offset, entry_offset;
+	  struct comp_unit *each;
+
+	  if (this_hash % bucket_count != hash % bucket_count)
+	    break;
+	  if (this_hash != hash)
+	    continue;
+
+	  q = str_offsets + (uint64_t) (i - 1) * offset_size;
+	  str_offset = read_n_bytes (abfd, &q, index_end, offset_size);
+	  if (!read_section (abfd,
+			     file_debug_section (stash, file, debug_str),
+			     file->syms, str_offset,
+			     &file->dwarf_str_buffer, &file->dwarf_str_size))
+	    return NULL;
+	  if (strcmp ((char *) file->dwarf_str_buffer + str_offset, name) != 0)
+	    continue;
+
+	  q = entry_offsets + (uint64_t) (i - 1) * offset_size;
+	  entry_offset = read_n_bytes (abfd, &q, index_end, offset_size);
+	  if (entry_offset >= (size_t) (index_end - pool))
+	    continue;
+	  each = debug_names_entry_unit (stash, file, offset_size,
+					 cus, cu_count, abbrevs, pool,
+					 pool + entry_offset, index_end);
+	  if (each != NULL)
+	    return each;
+	}
+      p = index_end;
+    }
+  return NULL;
+}
+
+/* The hash of NAME used by .gdb_index from version 5 on.  */
+
+static hashval_t
+gdb_index_hash (const char *name)
+{
+  const unsigned char *p = (const unsigned char *) name;
+  hashval_t hash = 0;
+
+  while (*p != 0)
+    hash = hash * 67 + TOLOWER (*p++) - 113;
+  return hash;
+}
+
+/* Read and return a unit that FILE's .gdb_index says defines NAME,
+   if there is one that hasn't been read yet.  Versions 7 to 9 of the
+   index are understood.  The index is always little endian.  */
+
+static struct comp_unit *
+gdb_index_find_unit (struct dwarf2_debug *stash,
+		     struct dwarf2_debug_file *file, const char *name)
+{
+  bfd_byte *buf = file->gdb_index_buffer;
+  bfd_size_type size = file->gdb_index_size;
+  uint32_t version, cu_list, types_list, symbols, symbols_end, pool;
+  uint32_t cu_count, slots, mask, slot, step, n;
+  hashval_t hash;
+
+  if (size < 28)
+    return NULL;
+  version = bfd_getl32 (buf);
+  if (version < 7 || version > 9)
+    return NULL;
+  cu_list = bfd_getl32 (buf + 4);
+  types_list = bfd_getl32 (buf + 8);
+  symbols = bfd_getl32 (buf + 16);
+  /* Version 9 adds the shortcut table before the constant pool.  */
+  symbols_end = bfd_getl32 (buf + 20);
+  pool = version >= 9 ? bfd_getl32 (buf + 24) : symbols_end;
+  if (cu_list > types_list
+      || types_list > size
+      || symbols > symbols_end
+      || symbols_end > size
+      || pool > size)
+    return NULL;
+  cu_count = (types_list - cu_list) / 16;
+  slots = (symbols_end - symbols) / 8;
+  if (slots == 0 || (slots & (slots - 1)) != 0)
+    return NULL;
+
+  hash = gdb_index_hash (name);
+  mask = slots - 1;
+  slot = hash & mask;
+  step = ((hash * 17) & mask) | 1;
+  for (n = 0; n < slots; n++, slot = (slot + step) & mask)
+    {
+      bfd_byte *entry = buf + symbols + slot * 8;
+      uint32_t name_offset = bfd_getl32 (entry);
+      uint32_t vec_offset = bfd_getl32 (entry + 4);
+      bfd_byte *vec;
+      uint32_t count, i;
+
+      if (name_offset == 0 && vec_offset == 0)
+	break;
+      if (name_offset >= size - pool
+	  || strcmp ((char *) buf + pool + name_offset, name) != 0)
+	continue;
+
+      /* The constant pool entry is a count followed by that many
+	 unit indexes, with attributes in the top byte.  Indexes past
+	 the CU list are type units.  */
+      if (vec_offset >= size - pool
+	  || size - pool - vec_offset < 4)
+	return NULL;
+      vec = buf + pool + vec_offset;
+      count = bfd_getl32 (vec);
+      if (count > (size - pool - vec_offset - 4) / 4)
+	return NULL;
+      for (i = 0; i < count; i++)
+	{
+	  uint32_t cu = bfd_getl32 (vec + 4 + i * 4) & 0xffffff;
+	  struct comp_unit *each;
+
+	  if (cu >= cu_count)
+	    continue;
+	  each = stash_unread_unit (stash, file,
+				    bfd_getl64 (buf + cu_list + cu * 16));
+	  if (each != NULL)
+	    return each;
+	}
+      return NULL;
+    }
+  return NULL;
+}
+
+/* Read and return a unit of FILE that .debug_names or .gdb_index says
+   defines SYM, if there is one that hasn't been read yet.  */
+
+static struct comp_unit *
+stash_comp_unit_for_name (struct dwarf2_debug *stash,
+			  struct dwarf2_debug_file *file, asymbol *sym)
+{
+  const char *name = bfd_asymbol_name (sym);
+  const char *at;
+  char *copy = NULL;
+  struct comp_unit *each = NULL;
+
+  if (!file->name_index_read)
+    read_name_index (stash, file);
+  if (file->dwarf_names_buffer == NULL && file->gdb_index_buffer == NULL)
+    return NULL;
+
+  /* The indexes hold source names, so drop any leading char and
+     symbol version.  */
+  if (*name != 0 && *name == bfd_get_symbol_leading_char (stash->orig_bfd))
+    name++;
+  at = strchr (name, '@');
+  if (at != NULL && at != name)
+    {
+      copy = (char *) bfd_malloc (at - name + 1);
+      if (copy == NULL)
+	return NULL;
+      memcpy (copy, name, at - name);
+      copy[at - name] = 0;
+      name = copy;
+    }
+
+  if (file->dwarf_names_buffer != NULL)
+    each = debug_names_find_unit (stash, file, name);
+  if (each == NULL && file->gdb_index_buffer != NULL)
+    each = gdb_index_find_unit (stash, file, name);
+  free (copy);
+  return each;
+}
+
+/* Read section SEC of FILE now if FILE has it, rather than leaving it
+   to be read when first needed, which worker threads may not do.
+   Returns FALSE if the section is there but can't be read.  */
+
+static bool
+preread_section (struct dwarf2_debug *stash, struct dwarf2_debug_file *file,
+		 enum dwarf_debug_section_enum sec,
+		 bfd_byte **section_buffer, bfd_size_type *section_size)
+{
+  const struct dwarf_debug_section *debug_sec = &stash->debug_sections[sec];
+
+  if (bfd_get_section_by_name (file->bfd_ptr,
+			       debug_sec->uncompressed_name) == NULL
+      && bfd_get_section_by_name (file->bfd_ptr,
+				  debug_sec->compressed_name) == NULL)
+    return true;
+  return read_section (file->bfd_ptr, debug_sec, file->syms, 0,
+		       section_buffer, section_size);
+}
+
+/* How far stash_read_all_units has got with a unit.  */
+
+enum dwarf_decode_state
+{
+  decode_pending,
+  decode_done,
+  decode_failed
+};
+
+/* The state shared by the threads of stash_read_all_units.  */
+
+struct dwarf_decode_job
+{
+  struct dwarf2_debug *stash;
+
+  /* The units to decode, and how far each has got.  */
+  struct comp_unit **units;
+  unsigned char *state;
+
+  /* Whether this pass decodes line info or scans for symbols.  */
+  bool scan;
+};
+
+/* Decode the line info of, or scan for symbols, the units of JOB from
+   START to END, allocating from memory of this thread's own.  Worker
+   for _bfd_parallel_for.  */
+
+static bool
+dwarf_decode_range (void *data, size_t start, size_t end)
+{
+  struct dwarf_decode_job *job = (struct dwarf_decode_job *) data;
+  struct dwarf_worker_memory *mem;
+  size_t i;
+
+  mem = (struct dwarf_worker_memory *) bfd_malloc (sizeof (*mem));
+  if (mem == NULL)
+    return false;
+  mem->memory = objalloc_create ();
+  if (mem->memory == NULL)
+    {
+      free (mem);
+      bfd_set_error (bfd_error_no_memory);
+      return false;
+    }
+  _bfd_mutex_lock (&dwarf_worker_lock);
+  mem->next = job->stash->worker_memory;
+  job->stash->worker_memory = mem;
+  _bfd_mutex_unlock (&dwarf_worker_lock);
+
+  dwarf_thread_memory = mem->memory;
+  for (i = start; i < end; i++)
+    {
+      struct comp_unit *unit = job->units[i];
+      bool ok;
+
+      if (unit->error)
+	ok = false;
+      else if (!job->scan)
+	{
+	  if (unit->line_table == NULL)
+	    unit->line_table = decode_line_info (unit);
+	  ok = unit->line_table != NULL;
+	}
+      else
+	ok = (unit->first_child_die_ptr >= unit->end_ptr
+	      || scan_unit_for_symbols (unit));
+      job->state[i] = ok ? decode_done : decode_failed;
+    }
+  dwarf_thread_memory = NULL;
+  return true;
+}
+
+/* Read every remaining unit of the primary file of STASH, and decode
+   the line info and symbols of them all on as many threads as BFD may
+   use.  Normally a unit is only decoded when a lookup first needs it,
+   but when there are many lookups to do most units will be needed
+   anyway.
+
+   Units refer to each other, so all their line info is decoded before
+   any are scanned for symbols; a scan then only reads other units.
+   Units that share the line table at offset zero, skeleton units,
+   whose split units are read into the BFDs of other files, and files
+   with a supplementary file are left to the usual path, as is every
+   unit when there is a DWARF memory budget.  */
+
+static void
+stash_read_all_units (struct dwarf2_debug *stash)
+{
+  struct dwarf2_debug_file *file = &stash->f;
+  struct dwarf_decode_job job;
+  struct comp_unit *each;
+  size_t count, i;
+  int pass;
+
+  stash->all_units_read = true;
+  while (stash_comp_unit (stash, file) != NULL)
+    ;
+
+  if (bfd_get_dwarf_memory_budget () != 0
+      || stash->alt.bfd_ptr != NULL
+      || bfd_get_section_by_name (file->bfd_ptr, ".gnu_debugaltlink") != NULL)
+    return;
+
+  /* Worker threads don't see dwarf_place_stash, so set the VMAs any
+     relocated contents they read need now.  */
+  if (dwarf_place_stash == stash
+      && !place_sections (stash->orig_bfd, stash))
+    return;
+
+  if (!preread_section (stash, file, debug_line,
+			&file->dwarf_line_buffer, &file->dwarf_line_size)
+      || !preread_section (stash, file, debug_str,
+			   &file->dwarf_str_buffer, &file->dwarf_str_size)
+      || !preread_section (stash, file, debug_line_str,
+			   &file->dwarf_line_str_buffer,
+			   &file->dwarf_line_str_size)
+      || !preread_section (stash, file, debug_str_offsets,
+			   &file->dwarf_str_offsets_buffer,
+			   &file->dwarf_str_offsets_size)
+      || !preread_section (stash, file, debug_addr,
+			   &file->dwarf_addr_buffer, &file->dwarf_addr_size)
+      || !preread_section (stash, file, debug_ranges,
+			   &file->dwarf_ranges_buffer,
+			   &file->dwarf_ranges_size)
+      || !preread_section (stash, file, debug_rnglists,
+			   &file->dwarf_rnglists_buffer,
+			   &file->dwarf_rnglists_size))
+    return;
+
+  /* A worker may read the DIEs of any unit, so find the tables of the
+     indexed forms of them all here, for the workers to share.  */
+  for (each = file->all_comp_units; each; each = each->next_unit)
+    {
+      uint64_t offset;
+
+      if (file->dwarf_addr_buffer != NULL && addr_base_known (each))
+	read_indexed_address (0, each);
+      if (file->dwarf_str_buffer != NULL
+	  && file->dwarf_str_offsets_buffer != NULL
+	  && str_base_known (each))
+	read_indexed_string (0, each);
+      if (file->dwarf_rnglists_buffer != NULL
+	  && each->dwarf_rnglists_offset != 0)
+	read_rnglist_offset (0, each, &offset);
+    }
+
+  /* Units using the line table at offset zero share it, so decode
+     those here first.  */
+  count = 0;
+  for (each = file->all_comp_units; each; each = each->next_unit)
+    if (!each->error
+	&& !each->symbols_scanned
+	&& !comp_unit_is_skeleton (each))
+      {
+	if (each->line_table == NULL
+	    && (!each->stmtlist || each->line_offset == 0))
+	  comp_unit_maybe_scan_symbols (each);
+	else
+	  count++;
+      }
+  if (count == 0)
+    return;
+
+  job.stash = stash;
+  job.units = (struct comp_unit **) bfd_malloc (count * sizeof (*job.units));
+  job.state = (unsigned char *) bfd_malloc (count);
+  if (job.units == NULL || job.state == NULL)
+    goto out;
+  count = 0;
+  for (each = file->all_comp_units; each; each = each->next_unit)
+    if (!each->error
+	&& !each->symbols_scanned
+	&& !comp_unit_is_skeleton (each))
+      job.units[count++] = each;
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      job.scan = pass != 0;
+      memset (job.state, decode_pending, count);
+      _bfd_parallel_for (count, 1, dwarf_decode_range, &job);
+
+      /* Finish on this thread any units that a worker didn't get to,
+	 so that the next pass sees every unit done.  */
+      for (i = 0; i < count; i++)
+	{
+	  each = job.units[i];
+	  if (job.state[i] == decode_pending && !each->error)
+	    {
+	      if (!job.scan)
+		{
+		  if (each->line_table == NULL)
+		    each->line_table = decode_line_info (each);
+		  if (each->line_table == NULL)
+		    job.state[i] = decode_failed;
+		}
+	      else if (each->first_child_die_ptr < each->end_ptr
+		       && !scan_unit_for_symbols (each))
+		job.state[i] = decode_failed;
+	    }
+	  if (job.state[i] == decode_failed)
+	    each->error = 1;
+	  else if (job.scan)
+	    each->symbols_scanned = true;
+	}
+    }
+
+  /* Now add the ranges the workers found to the trie.  */
+  for (i = 0; i < count; i++)
+    {
+      struct arange *r;
+
+      each = job.units[i];
+      for (r = each->pending_ranges; r != NULL; r = r->next)
+	{
+	  struct trie_node *trie;
+
+	  trie = insert_arange_in_trie (file->bfd_ptr, file->trie_root,
+					0, 0, each, r->low, r->high);
+	  if (trie == NULL)
+	    break;
+	  file->trie_root = trie;
+	}
+      each->pending_ranges = NULL;
+    }
+
+ out:
+  free (job.units);
+  free (job.state);
+}
+
+/* Hash function for an asymbol.  */
+
+static hashval_t
+hash_asymbol (const void *sym)
+{
+  const asymbol *asym = sym;
+  return htab_hash_string (asym->name);
+}
+
+/* Equality function for asymbols.  */
+
+static int
+eq_asymbol (const void *a, const void *b)
+{
+  const asymbol *sa = a;
+  const asymbol *sb = b;
+  return strcmp (sa->name, sb->name) == 0;
+}
+
+/* Scan the debug information in PINFO looking for a DW_TAG_subprogram
+   abbrev with a DW_AT_low_pc attached to it.  Then lookup that same
+   symbol in SYMBOLS and return the difference between the low_pc and
+   the symbol's address.  Returns 0 if no suitable symbol could be found.
+   The answer is kept in the stash for later calls with SYMBOLS.  */
+
+bfd_signed_vma
+_bfd_dwarf2_find_symbol_bias (asymbol ** symbols, void ** pinfo)
+{
+  struct dwarf2_debug *stash;
+  struct comp_unit * unit;
+  htab_t sym_hash;
+  bfd_signed_vma result = 0;
+  asymbol ** psym;
+
+  stash = (struct dwarf2_debug *) *pinfo;
+
+  if (stash == NULL || symbols == NULL)
+    return 0;
+
+  /* The stash is made again if the sections move.  */
+  if (stash->symbol_bias_known && stash->symbol_bias_syms == symbols)
+    return stash->symbol_bias;
+
+  sym_hash = htab_create_alloc (10, hash_asymbol, eq_asymbol,
+				NULL, xcalloc, free);
+  for (psym = symbols; * psym != NULL; psym++)
+    ;
+  htab_reserve (sym_hash, psym - symbols);
+  for (psym = symbols; * psym != NULL; psym++)
+    {
+      asymbol * sym = * psym;
+
+      if (sym->flags & BSF_FUNCTION && sym->section != NULL)
+	{
+	  void **slot = htab_find_slot (sym_hash, sym, INSERT);
+	  *slot = sym;
+	}
+    }
+
+  for (unit = stash->f.all_comp_units; unit; unit = unit->next_unit)
+    {
+      struct funcinfo * func;
+
+      comp_unit_maybe_scan_symbols (unit);
+
+      for (func = unit->function_table; func != NULL; func = func->prev_func)
+	if (func->name && func->arange.low)
+	  {
+	    asymbol search, *sym;
+
+	    /* FIXME: Do we need to scan the aranges looking for the
+	       lowest pc value?  */
+
+	    search.name = func->name;
+	    sym = htab_find (sym_hash, &search);
+	    if (sym != NULL)
+	      {
+		result = func->arange.low - (sym->value + sym->section->vma);
+		goto done;
+	      }
+	  }
+    }
+
+ done:
+  htab_delete (sym_hash);
+  stash->symbol_bias_known = true;
+  stash->symbol_bias_syms = symbols;
+  stash->symbol_bias = result;
+  return result;
+}
+
+/* See _bfd_dwarf2_find_nearest_line_with_alt.  */
+
+int
+_bfd_dwarf2_find_nearest_line (bfd *abfd,
+			       asymbol **symbols,
+			       asymbol *symbol,
+			       asection *section,
+			       bfd_vma offset,
+			       const char **filename_ptr,
+			       const char **functionname_ptr,
+			       unsigned int *linenumber_ptr,
+			       unsigned int *discriminator_ptr,
+			       const struct dwarf_debug_section *debug_sections,
+			       void **pinfo)
+{
+  return _bfd_dwarf2_find_nearest_line_with_alt
+    (abfd, NULL, symbols, symbol, section, offset, filename_ptr,
+     functionname_ptr, linenumber_ptr, discriminator_ptr, debug_sections,
+     pinfo);
+}
+
+/* Line indexes.
+
+   Once every unit of an executable has been decoded, the result of
+   looking up an address only changes at the addresses where a line
+   table row, a function range or a unit range starts or ends.  A line
+   index records the result for each run of addresses between those
+   points, along with the functions and strings the results refer to,
+   in a file named for the build-id under bfd_get_line_index_dir.
+   Later opens map the file and answer address lookups from it without
+   decoding any units.  Values are in host byte order; an index
+   written on a host of the other byte order fails the version
+   check and is rebuilt.  */
+
+static bool stash_find_nearest_line_at
+  (struct dwarf2_debug *, bfd_vma, const char **, struct funcinfo **,
+   unsigned int *, unsigned int *);
+
+#define LINE_INDEX_MAGIC	"BFDLIDX"
+#define LINE_INDEX_VERSION	1
+#define LINE_INDEX_MAX_BUILD_ID	64
+
+struct line_index_header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t build_id_size;
+  unsigned char build_id[LINE_INDEX_MAX_BUILD_ID];
+  uint64_t entry_count;
+  uint64_t func_count;
+  uint64_t strings_size;
+};
+
+/* The result for addresses from ADDR up to the next entry's.  Strings
+   are offsets into the string table, zero for none, and functions are
+   one more than their index in the function table, zero for none.  */
+
+struct line_index_entry
+{
+  uint64_t addr;
+  uint32_t file;
+  uint32_t line;
+  uint32_t discriminator;
+  uint32_t func;
+  uint32_t found;
+  uint32_t pad;
+};
+
+/* A function of a line index result, with CALLER the function it is
+   inlined into, if any.  */
+
+struct line_index_func
+{
+  uint64_t low;
+  uint32_t name;
+  uint32_t caller_file;
+  uint32_t caller_line;
+  uint32_t caller;
+  uint32_t tag;
+  uint32_t is_linkage;
+};
+
+/* Return the file name of the line index for ABFD, in malloc'd memory,
+   or NULL if it can't have one.  Only files whose addresses don't
+   depend on where their sections are placed are indexed.  */
+
+static char *
+line_index_filename (bfd *abfd)
+{
+  const char *dir = bfd_get_line_index_dir ();
+  const struct bfd_build_id *build_id = abfd->build_id;
+  char *name, *p;
+  size_t len;
+  bfd_size_type i;
+
+  if (dir == NULL
+      || build_id == NULL
+      || build_id->size == 0
+      || build_id->size > LINE_INDEX_MAX_BUILD_ID
+      || (abfd->flags & (EXEC_P | DYNAMIC)) == 0)
+    return NULL;
+
+  len = strlen (dir);
+  name = bfd_malloc (len + 1 + build_id->size * 2 + sizeof (".lidx.tmp"));
+  if (name == NULL)
+    return NULL;
+  memcpy (name, dir, len);
+  p = name + len;
+  *p++ = '/';
+  for (i = 0; i < build_id->size; i++)
+    p += sprintf (p, "%02x", build_id->data[i]);
+  strcpy (p, ".lidx");
+  return name;
+}
+
+/* Return the string at offset OFF of the string table of the line
+   index of STASH, or NULL if there is none.  */
+
+static const char *
+line_index_string (struct dwarf2_debug *stash, uint32_t off)
+{
+  const struct line_index_header *hdr = stash->line_index;
+  const char *strings;
+
+  if (off == 0 || off >= hdr->strings_size)
+    return NULL;
+  strings = ((const char *) (hdr + 1)
+	     + (hdr->entry_count * sizeof (struct line_index_entry)
+		+ hdr->func_count * sizeof (struct line_index_func)));
+  return strings + off;
+}
+
+/* Return the function numbered IDX in the line index of STASH, as a
+   struct funcinfo that lookups can return like one read from the
+   debug info.  These are made when first asked for.  */
+
+static struct funcinfo *
+line_index_function (struct dwarf2_debug *stash, uint32_t idx)
+{
+  const struct line_index_header *hdr = stash->line_index;
+  const struct line_index_func *lf;
+  struct funcinfo *func;
+
+  if (idx == 0 || idx > hdr->func_count)
+    return NULL;
+  if (stash->line_index_funcs[idx - 1] != NULL)
+    return stash->line_index_funcs[idx - 1];
+
+  func = bfd_zalloc (stash->f.bfd_ptr, sizeof (*func));
+  if (func == NULL)
+    return NULL;
+  stash->line_index_funcs[idx - 1] = func;
+
+  lf = ((const struct line_index_func *)
+	((const struct line_index_entry *) (hdr + 1) + hdr->entry_count)
+	+ (idx - 1));
+  func->name = line_index_string (stash, lf->name);
+  func->caller_file = (char *) line_index_string (stash, lf->caller_file);
+  func->caller_line = lf->caller_line;
+  func->tag = lf->tag;
+  func->is_linkage = lf->is_linkage != 0;
+  func->arange.low = lf->low;
+  /* FUNC is already recorded, so even a corrupt index with a loop of
+     callers can't recurse forever here.  */
+  func->caller_func = line_index_function (stash, lf->caller);
+  return func;
+}
+
+/* Look up ADDR in the line index of STASH, as
+   stash_find_nearest_line_at does in the debug info.  */
+
+static bool
+line_index_find (struct dwarf2_debug *stash,
+		 bfd_vma addr,
+		 const char **filename_ptr,
+		 struct funcinfo **function_ptr,
+		 unsigned int *linenumber_ptr,
+		 unsigned int *discriminator_ptr)
+{
+  const struct line_index_header *hdr = stash->line_index;
+  const struct line_index_entry *entries;
+  const struct line_index_entry *entry;
+  bfd_size_type low, high, mid;
+
+  entries = (const struct line_index_entry *) (hdr + 1);
+  low = 0;
+  high = hdr->entry_count;
+  while (low < high)
+    {
+      mid = (low + high) / 2;
+      if (addr < entries[mid].addr)
+	high = mid;
+      else
+	low = mid + 1;
+    }
+  if (low == 0)
+    return false;
+
+  entry = &entries[low - 1];
+  if (!entry->found)
+    return false;
+  *filename_ptr = line_index_string (stash, entry->file);
+  *linenumber_ptr = entry->line;
+  if (discriminator_ptr)
+    *discriminator_ptr = entry->discriminator;
+  if (function_ptr == NULL)
+    return true;
+  *function_ptr = line_index_function (stash, entry->func);
+  if (*function_ptr != NULL
+      && (*function_ptr)->tag == DW_TAG_inlined_subroutine)
+    stash->inliner_chain = *function_ptr;
+  return true;
+}
+
+/* Map the line index at NAME for STASH, if there is a valid one.  */
+
+static bool
+read_line_index (struct dwarf2_debug *stash, const char *name)
+{
+  const struct bfd_build_id *build_id = stash->orig_bfd->build_id;
+  const struct line_index_header *hdr;
+  struct line_index_header head;
+  bfd_size_type size;
+  ufile_ptr filesize;
+  bfd *ibfd;
+
+  ibfd = bfd_openr (name, NULL);
+  if (ibfd == NULL)
+    return false;
+
+  filesize = bfd_get_file_size (ibfd);
+  if (filesize < sizeof (head)
+      || bfd_bread (&head, sizeof (head), ibfd) != sizeof (head)
+      || memcmp (head.magic, LINE_INDEX_MAGIC, sizeof (head.magic)) != 0
+      || head.version != LINE_INDEX_VERSION
+      || head.build_id_size != build_id->size
+      || memcmp (head.build_id, build_id->data, build_id->size) != 0
+      || head.entry_count > filesize / sizeof (struct line_index_entry)
+      || head.func_count > filesize / sizeof (struct line_index_func)
+      || head.func_count >= (uint32_t) -1
+      || head.strings_size == 0
+      || head.strings_size > filesize)
+    goto fail;
+  size = (sizeof (head)
+	  + head.entry_count * sizeof (struct line_index_entry)
+	  + head.func_count * sizeof (struct line_index_func)
+	  + head.strings_size);
+  if (size != filesize)
+    goto fail;
+
+  hdr = (const struct line_index_header *) _bfd_file_view (ibfd, 0, size);
+  if (hdr == NULL || ((const char *) hdr)[size - 1] != 0)
+    goto fail;
+
+  stash->line_index_funcs
+    = (struct funcinfo **) bfd_zmalloc ((head.func_count + 1)
+					* sizeof (struct funcinfo *));
+  if (stash->line_index_funcs == NULL)
+    goto fail;
+  stash->line_index = hdr;
+  stash->line_index_bfd = ibfd;
+  return true;
+
+ fail:
+  bfd_close (ibfd);
+  return false;
+}
+
+/* A string or function already added to a line index, and where.  */
+
+struct line_index_slot
+{
+  const void *key;
+  uint32_t idx;
+};
+
+static hashval_t
+hash_line_index_string (const void *p)
+{
+  return htab_hash_string (((const struct line_index_slot *) p)->key);
+}
+
+static int
+eq_line_index_string (const void *a, const void *b)
+{
+  return strcmp (((const struct line_index_slot *) a)->key,
+		 ((const struct line_index_slot *) b)->key) == 0;
+}
+
+static hashval_t
+hash_line_index_func (const void *p)
+{
+  return htab_hash_pointer (((const struct line_index_slot *) p)->key);
+}
+
+static int
+eq_line_index_func (const void *a, const void *b)
+{
+  return (((const struct line_index_slot *) a)->key
+	  == ((const struct line_index_slot *) b)->key);
+}
+
+/* A line index being built.  */
+
+struct line_index_builder
+{
+  htab_t string_slots;
+  char *strings;
+  size_t strings_size;
+  size_t strings_alloc;
+
+  htab_t func_slots;
+  struct line_index_func *funcs;
+  size_t func_count;
+  size_t func_alloc;
+
+  struct line_index_entry *entries;
+  size_t entry_count;
+  size_t entry_alloc;
+};
+
+/* Grow *VEC of elements of SIZE bytes, of which *ALLOC are allocated,
+   to hold at least NEED.  */
+
+static bool
+line_index_grow (void *vec, size_t *alloc, size_t need, size_t size)
+{
+  void *p;
+  size_t amt;
+
+  if (need <= *alloc)
+    return true;
+  amt = *alloc * 2;
+  if (amt < need)
+    amt = need + 64;
+  p = bfd_realloc (*(void **) vec, amt * size);
+  if (p == NULL)
+    return false;
+  *(void **) vec = p;
+  *alloc = amt;
+  return true;
+}
+
+/* Add STR to the strings of the index B, returning its offset, zero
+   for a NULL STR or (uint32_t) -1 on error.  */
+
+static uint32_t
+line_index_add_string (struct line_index_builder *b, const char *str)
+{
+  struct line_index_slot key, **slot;
+  size_t len;
+
+  if (str == NULL)
+    return 0;
+  key.key = str;
+  slot = (struct line_index_slot **) htab_find_slot (b->string_slots, &key,
+						     INSERT);
+  if (slot == NULL)
+    return (uint32_t) -1;
+  if (*slot != NULL)
+    return (*slot)->idx;
+
+  len = strlen (str) + 1;
+  if (b->strings_size + len >= (uint32_t) -1
+      || !line_index_grow (&b->strings, &b->strings_alloc,
+			   b->strings_size + len, 1))
+    return (uint32_t) -1;
+  *slot = bfd_malloc (sizeof (**slot));
+  if (*slot == NULL)
+    return (uint32_t) -1;
+  memcpy (b->strings + b->strings_size, str, len);
+  /* B->strings moves as it grows, so the key is STR, which lives as
+     long as the stash.  */
+  (*slot)->key = str;
+  (*slot)->idx = b->strings_size;
+  b->strings_size += len;
+  return (*slot)->idx;
+}
+
+/* Add FUNC and the functions it is inlined into to the index B,
+   returning one more than its index, zero for a NULL FUNC or
+   (uint32_t) -1 on error.  */
+
+static uint32_t
+line_index_add_func (struct line_index_builder *b, struct funcinfo *func)
+{
+  struct line_index_slot key, **slot;
+  struct line_index_func *lf;
+  uint32_t idx, name, caller_file, caller;
+
+  if (func == NULL)
+    return 0;
+  key.key = func;
+  slot = (struct line_index_slot **) htab_find_slot (b->func_slots, &key,
+						     INSERT);
+  if (slot == NULL)
+    return (uint32_t) -1;
+  if (*slot != NULL)
+    return (*slot)->idx;
+
+  if (b->func_count + 1 >= (uint32_t) -1
+      || !line_index_grow (&b->funcs, &b->func_alloc, b->func_count + 1,
+			   sizeof (*b->funcs)))
+    return (uint32_t) -1;
+  *slot = bfd_malloc (sizeof (**slot));
+  if (*slot == NULL)
+    return (uint32_t) -1;
+  idx = ++b->func_count;
+  (*slot)->key = func;
+  (*slot)->idx = idx;
+
+  name = line_index_add_string (b, func->name);
+  caller_file = line_index_add_string (b, func->caller_file);
+  caller = line_index_add_func (b, func->caller_func);
+  if (name == (uint32_t) -1
+      || caller_file == (uint32_t) -1
+      || caller == (uint32_t) -1)
+    return (uint32_t) -1;
+
+  lf = &b->funcs[idx - 1];
+  lf->low = func->arange.low;
+  lf->name = name;
+  lf->caller_file = caller_file;
+  lf->caller_line = func->caller_line;
+  lf->caller = caller;
+  lf->tag = func->tag;
+  lf->is_linkage = func->is_linkage;
+  return idx;
+}
+
+static int
+compare_vma (const void *a, const void *b)
+{
+  bfd_vma va = *(const bfd_vma *) a;
+  bfd_vma vb = *(const bfd_vma *) b;
+
+  return va < vb ? -1 : va > vb ? 1 : 0;
+}
+
+/* Add ADDR to the growing array *POINTS.  */
+
+static bool
+line_index_add_point (bfd_vma **points, size_t *count, size_t *alloc,
+		      bfd_vma addr)
+{
+  if (!line_index_grow (points, alloc, *count + 1, sizeof (**points)))
+    return false;
+  (*points)[(*count)++] = addr;
+  return true;
+}
+
+/* Collect into *POINTS every address at which a lookup in the units
+   of STASH may start to give a different result.  */
+
+static bool
+line_index_points (struct dwarf2_debug *stash,
+		   bfd_vma **points, size_t *count)
+{
+  struct comp_unit *each;
+  size_t alloc = 0;
+
+  for (each = stash->f.all_comp_units; each; each = each->next_unit)
+    {
+      struct arange *r;
+      struct funcinfo *func;
+      unsigned int i;
+
+      if (!comp_unit_maybe_scan_symbols (each))
+	continue;
+
+      for (r = &each->arange; r != NULL; r = r->next)
+	if (r->high != 0
+	    && (!line_index_add_point (points, count, &alloc, r->low)
+		|| !line_index_add_point (points, count, &alloc, r->high)))
+	  return false;
+
+      for (i = 0; i < each->line_table->num_sequences; i++)
+	{
+	  struct line_sequence *seq = &each->line_table->sequences[i];
+	  bfd_size_type j;
+
+	  if (!line_index_add_point (points, count, &alloc, seq->low_pc))
+	    return false;
+	  for (j = 0; j < seq->num_lines; j++)
+	    if (!line_index_add_point (points, count, &alloc,
+				       line_sequence_address (seq, j)))
+	      return false;
+	}
+
+      for (func = each->function_table; func; func = func->prev_func)
+	for (r = &func->arange; r != NULL; r = r->next)
+	  if (r->high != 0
+	      && (!line_index_add_point (points, count, &alloc, r->low)
+		  || !line_index_add_point (points, count, &alloc, r->high)))
+	    return false;
+    }
+  return true;
+}
+
+/* Build the line index for STASH from the debug info and write it to
+   NAME.  Failing to is not an error; lookups then use the debug info
+   as usual.  */
+
+static void
+write_line_index (struct dwarf2_debug *stash, const char *name)
+{
+  const struct bfd_build_id *build_id = stash->orig_bfd->build_id;
+  struct line_index_builder b;
+  struct line_index_header hdr;
+  bfd_vma *points = NULL;
+  size_t count = 0, i;
+  char *tmpname = NULL;
+  FILE *f;
+  bool ok = false;
+
+  memset (&b, 0, sizeof (b));
+  b.string_slots = htab_create_alloc (1024, hash_line_index_string,
+				      eq_line_index_string, free,
+				      calloc, free);
+  b.func_slots = htab_create_alloc (1024, hash_line_index_func,
+				    eq_line_index_func, free,
+				    calloc, free);
+  if (b.string_slots == NULL || b.func_slots == NULL)
+    goto out;
+
+  /* Offset zero is kept for "no string".  */
+  if (!line_index_grow (&b.strings, &b.strings_alloc, 1, 1))
+    goto out;
+  b.strings[0] = 0;
+  b.strings_size = 1;
+
+  if (!stash->all_units_read)
+    stash_read_all_units (stash);
+  if (!line_index_points (stash, &points, &count))
+    goto out;
+  qsort (points, count, sizeof (*points), compare_vma);
+
+  for (i = 0; i < count; i++)
+    {
+      struct line_index_entry entry;
+      const char *filename = NULL;
+      struct funcinfo *function = NULL;
+      unsigned int line = 0, discriminator = 0;
+
+      if (i != 0 && points[i] == points[i - 1])
+	continue;
+
+      memset (&entry, 0, sizeof (entry));
+      entry.addr = points[i];
+      entry.found = stash_find_nearest_line_at (stash, points[i], &filename,
+						&function, &line,
+						&discriminator);
+      if (entry.found)
+	{
+	  entry.file = line_index_add_string (&b, filename);
+	  entry.line = line;
+	  entry.discriminator = discriminator;
+	  entry.func = line_index_add_func (&b, function);
+	  if (entry.file == (uint32_t) -1 || entry.func == (uint32_t) -1)
+	    goto out;
+	}
+
+      /* Runs with the same result need only one entry.  */
+      if (b.entry_count != 0)
+	{
+	  struct line_index_entry *last = &b.entries[b.entry_count - 1];
+
+	  if (last->found == entry.found
+	      && last->file == entry.file
+	      && last->line == entry.line
+	      && last->discriminator == entry.discriminator
+	      && last->func == entry.func)
+	    continue;
+	}
+
+      if (!line_index_grow (&b.entries, &b.entry_alloc, b.entry_count + 1,
+			    sizeof (*b.entries)))
+	goto out;
+      b.entries[b.entry_count++] = entry;
+    }
+  stash->inliner_chain = NULL;
+
+  memset (&hdr, 0, sizeof (hdr));
+  memcpy (hdr.magic, LINE_INDEX_MAGIC, sizeof (hdr.magic));
+  hdr.version = LINE_INDEX_VERSION;
+  hdr.build_id_size = build_id->size;
+  memcpy (hdr.build_id, build_id->data, build_id->size);
+  hdr.entry_count = b.entry_count;
+  hdr.func_count = b.func_count;
+  hdr.strings_size = b.strings_size;
+
+  /* Write under a temporary name, so that another process never maps
+     a partly written index.  */
+  tmpname = bfd_malloc (strlen (name) + sizeof (".tmp"));
+  if (tmpname == NULL)
+    goto out;
+  sprintf (tmpname, "%s.tmp", name);
+  f = _bfd_real_fopen (tmpname, FOPEN_WB);
+  if (f == NULL)
+    goto out;
+  ok = (fwrite (&hdr, sizeof (hdr), 1, f) == 1
+	&& fwrite (b.entries, sizeof (*b.entries), b.entry_count,
+		   f) == b.entry_count
+	&& fwrite (b.funcs, sizeof (*b.funcs), b.func_count,
+		   f) == b.func_count
+	&& fwrite (b.strings, 1, b.strings_size, f) == b.strings_size);
+  if (fclose (f) != 0)
+    ok = false;
+  if (!ok || rename (tmpname, name) != 0)
+    remove (tmpname);
+
+ out:
+  free (tmpname);
+  free (points);
+  free (b.entries);
+  free (b.funcs);
+  free (b.strings);
+  if (b.string_slots != NULL)
+    htab_delete (b.string_slots);
+  if (b.func_slots != NULL)
+    htab_delete (b.func_slots);
+}
+
+/* Map the line index of STASH if there is one, and if there isn't,
+   build one for later opens to use.  */
+
+static void
+stash_open_line_index (struct dwarf2_debug *stash)
+{
+  bfd_error_type err;
+  char *name;
+
+  stash->line_index_tried = true;
+  name = line_index_filename (stash->orig_bfd);
+  if (name == NULL)
+    return;
+  err = bfd_get_error ();
+  if (!read_line_index (stash, name))
+    write_line_index (stash, name);
+  bfd_set_error (err);
+  free (name);
+}
+
+/* Find the nearest source code location for address ADDR in the comp
+   units of STASH, reading more units if need be.  Sets *FUNCTION_PTR
+   to the function containing ADDR, if one is found.  FUNCTION_PTR is
+   NULL when only the line is wanted.  */
+
+static bool
+stash_find_nearest_line_at (struct dwarf2_debug *stash,
+			    bfd_vma addr,
+			    const char **filename_ptr,
+			    struct funcinfo **function_ptr,
+			    unsigned int *linenumber_ptr,
+			    unsigned int *discriminator_ptr)
+{
+  struct trie_node *trie;
+  unsigned int bits = VMA_BITS - 8;
+  struct comp_unit *each;
+  struct comp_unit **prev_each;
+
+  if (!stash->line_index_tried)
+    stash_open_line_index (stash);
+  if (stash->line_index != NULL)
+    return line_index_find (stash, addr, filename_ptr, function_ptr,
+			    linenumber_ptr, discriminator_ptr);
+
+  /* Traverse interior nodes until we get to a leaf.  */
+  trie = stash->f.trie_root;
+  while (trie && trie->num_room_in_leaf == 0)
+    {
+      int ch = (addr >> bits) & 0xff;
+      trie = ((struct trie_interior *) trie)->children[ch];
+      bits -= 8;
+    }
+
+  if (trie)
+    {
+      const struct trie_leaf *leaf = (struct trie_leaf *) trie;
+      unsigned int i;
+
+      for (i = 0; i < leaf->num_stored_in_leaf; ++i)
+	leaf->ranges[i].unit->mark = false;
+
+      for (i = 0; i < leaf->num_stored_in_leaf; ++i)
+	{
+	  struct comp_unit *unit = leaf->ranges[i].unit;
+	  if (unit->mark
+	      || addr < leaf->ranges[i].low_pc
+	      || addr >= leaf->ranges[i].high_pc)
+	    continue;
+	  unit->mark = true;
+
+	  if (comp_unit_find_nearest_line (unit, addr, filename_ptr,
+					   function_ptr, linenumber_ptr,
+					   discriminator_ptr))
+	    return true;
+	}
+    }
+
+  /* Also scan through all compilation units without any ranges,
+     taking them out of the list if they have acquired any since
+     last time.  */
+  prev_each = &stash->f.all_comp_units_without_ranges;
+  for (each = *prev_each; each; each = each->next_unit_without_ranges)
+    {
+      if (each->arange.high != 0)
+	{
+	  *prev_each = each->next_unit_without_ranges;
+	  continue;
+	}
+
+      if (comp_unit_find_nearest_line (each, addr, filename_ptr,
+				       function_ptr, linenumber_ptr,
+				       discriminator_ptr))
+	return true;
+      prev_each = &each->next_unit_without_ranges;
+    }
+
+  /* If .debug_aranges names the units holding ADDR, read just those
+     rather than every unit ahead of them.  */
+  while ((each = stash_comp_unit_for_addr (stash, &stash->f, addr)) != NULL)
+    if (comp_unit_may_contain_address (each, addr)
+	&& comp_unit_find_nearest_line (each, addr, filename_ptr,
+					function_ptr, linenumber_ptr,
+					discriminator_ptr))
+      return true;
+
+  /* Read each remaining comp. units checking each as they are read.  */
+  while ((each = stash_comp_unit (stash, &stash->f)) != NULL)
+    if (comp_unit_may_contain_address (each, addr)
+	&& comp_unit_find_nearest_line (each, addr, filename_ptr,
+					function_ptr, linenumber_ptr,
+					discriminator_ptr))
+      return true;
+
+  return false;
+}
+
+/* Set *FUNCTIONNAME_PTR for a lookup of SECTION + OFFSET that found
+   FUNCTION, preferring a linkage name from SYMBOLS to the name in the
+   debug info.  FOUND is what the lookup returned; the result is the
+   value to return from it instead.  */
+
+static int
+stash_function_name (struct dwarf2_debug *stash,
+		     bfd *abfd,
+		     asymbol **symbols,
+		     asection *section,
+		     bfd_vma offset,
+		     struct funcinfo *function,
+		     int found,
+		     const char **filename_ptr,
+		     const char **functionname_ptr)
+{
+  if (functionname_ptr && function && function->is_linkage)
+    {
+      *functionname_ptr = function->name;
+      if (!found)
+        found = 2;
+    }
+  else if (functionname_ptr
+	   && (!*functionname_ptr
+	       || (function && !function->is_linkage)))
+    {
+      asymbol *fun;
+      asymbol **syms = symbols;
+      asection *sec = section;
+
+      _bfd_dwarf2_stash_syms (stash, abfd, &sec, &syms);
+      fun = _bfd_elf_find_function (abfd, syms, sec, offset,
+				    *filename_ptr ? NULL : filename_ptr,
+				    functionname_ptr);
+
+      if (!found && fun != NULL)
+	found = 2;
+
+      if (function && !function->is_linkage)
+	{
+	  bfd_vma sec_vma = stash_section_vma (stash, section);
+
+	  if (fun == NULL)
+	    *functionname_ptr = function->name;
+	  else if (fun->value + sec_vma == function->arange.low)
+	    function->name = *functionname_ptr;
+	  /* Even if we didn't find a linkage name, say that we have
+	     to stop a repeated search of symbols.  */
+	  function->is_linkage = true;
+	}
+    }
+  return found;
 }
 
 /* Find the source code location of SYMBOL.  If SYMBOL is NULL
@@ -5743,6 +9304,8 @@ _bfd_dwarf2_find_nearest_line (bfd *abfd,
    returned (function and maybe file) by looking at symbols.  DWARF2
    info is present but not regarding the requested code location.
    Returns 0 otherwise.
+   If both SYMBOL and FUNCTIONNAME_PTR are NULL, only the file and
+   line are looked up, and units need not be scanned for functions.
    SYMBOLS contains the symbol table for ABFD.
    DEBUG_SECTIONS contains the name of the dwarf debug sections.
    If ALT_FILENAME is given, attempt to open the file and use it
@@ -5820,7 +9383,7 @@ _bfd_dwarf2_find_nearest_line_with_alt
     }
   else
     {
-      BFD_ASSERT (section != NULL && functionname_ptr != NULL);
+      BFD_ASSERT (section != NULL);
       addr = offset;
 
       /* If we have no SYMBOL but the section we're looking at is not a
@@ -5856,18 +9419,24 @@ _bfd_dwarf2_find_nearest_line_with_alt
 	}
     }
 
-  if (section->output_section)
-    addr += section->output_section->vma + section->output_offset;
-  else
-    addr += section->vma;
+  addr += stash_section_vma (stash, section);
 
   /* A null info_ptr indicates that there is no dwarf2 info
      (or that an error occured while setting up the stash).  */
   if (! stash->f.info_ptr)
     return false;
 
+  stash_begin_lookup (stash);
+  stash_trim_units (stash);
   stash->inliner_chain = NULL;
 
+  /* With many lookups to make and threads to spare, decode every unit
+     at once rather than each as it is first needed.  */
+  if (!stash->all_units_read
+      && bfd_get_thread_count () > 1
+      && ++stash->lookup_count >= STASH_PARALLEL_TRIGGER)
+    stash_read_all_units (stash);
+
   /* Check the previously read comp. units first.  */
   if (do_line)
     {
@@ -5900,139 +9469,127 @@ _bfd_dwarf2_find_nearest_line_with_alt
 	    if (found)
 	      goto done;
 	  }
-    }
-  else
-    {
-      struct trie_node *trie = stash->f.trie_root;
-      unsigned int bits = VMA_BITS - 8;
-      struct comp_unit **prev_each;
-
-      /* Traverse interior nodes until we get to a leaf.  */
-      while (trie && trie->num_room_in_leaf == 0)
-	{
-	  int ch = (addr >> bits) & 0xff;
-	  trie = ((struct trie_interior *) trie)->children[ch];
-	  bits -= 8;
-	}
 
-      if (trie)
+      /* If a name index says which units define SYMBOL, or for a
+	 function .debug_aranges which hold ADDR, read just those
+	 rather than every unit ahead of them.  */
+      while ((each = stash_comp_unit_for_name (stash, &stash->f,
+					       symbol)) != NULL)
 	{
-	  const struct trie_leaf *leaf = (struct trie_leaf *) trie;
-	  unsigned int i;
-
-	  for (i = 0; i < leaf->num_stored_in_leaf; ++i)
-	    leaf->ranges[i].unit->mark = false;
-
-	  for (i = 0; i < leaf->num_stored_in_leaf; ++i)
-	    {
-	      struct comp_unit *unit = leaf->ranges[i].unit;
-	      if (unit->mark
-		  || addr < leaf->ranges[i].low_pc
-		  || addr >= leaf->ranges[i].high_pc)
-	        continue;
-	      unit->mark = true;
-
-	      found = comp_unit_find_nearest_line (unit, addr,
-						   filename_ptr,
-						   &function,
-						   linenumber_ptr,
-						   discriminator_ptr);
-	      if (found)
-		goto done;
-	   }
-	}
-
-      /* Also scan through all compilation units without any ranges,
-         taking them out of the list if they have acquired any since
-	 last time.  */
-      prev_each = &stash->f.all_comp_units_without_ranges;
-      for (each = *prev_each; each; each = each->next_unit_without_ranges)
-        {
-	  if (each->arange.high != 0)
-	    {
-	      *prev_each = each->next_unit_without_ranges;
-	      continue;
-	    }
-
-	  found = comp_unit_find_nearest_line (each, addr,
-					       filename_ptr,
-					       &function,
-					       linenumber_ptr,
-					       discriminator_ptr);
+	  found = (((symbol->flags & BSF_FUNCTION) == 0
+		    || comp_unit_may_contain_address (each, addr))
+		   && comp_unit_find_line (each, symbol, addr,
+					   filename_ptr, linenumber_ptr));
 	  if (found)
 	    goto done;
-	  prev_each = &each->next_unit_without_ranges;
 	}
-    }
 
-  /* Read each remaining comp. units checking each as they are read.  */
-  while ((each = stash_comp_unit (stash, &stash->f)) != NULL)
-    {
-      /* DW_AT_low_pc and DW_AT_high_pc are optional for
+      if ((symbol->flags & BSF_FUNCTION) != 0)
+	while ((each = stash_comp_unit_for_addr (stash, &stash->f,
+						 addr)) != NULL)
+	  {
+	    found = (comp_unit_may_contain_address (each, addr)
+		     && comp_unit_find_line (each, symbol, addr,
+					     filename_ptr, linenumber_ptr));
+	    if (found)
+	      goto done;
+	  }
+
+      /* Read each remaining comp. units checking each as they are
+	 read.  DW_AT_low_pc and DW_AT_high_pc are optional for
 	 compilation units.  If we don't have them (i.e.,
 	 unit->high == 0), we need to consult the line info table
 	 to see if a compilation unit contains the given
 	 address.  */
-      if (do_line)
-	found = (((symbol->flags & BSF_FUNCTION) == 0
-		  || comp_unit_may_contain_address (each, addr))
-		 && comp_unit_find_line (each, symbol, addr,
-					 filename_ptr, linenumber_ptr));
-      else
-	found = (comp_unit_may_contain_address (each, addr)
-		 && comp_unit_find_nearest_line (each, addr,
-						 filename_ptr,
-						 &function,
-						 linenumber_ptr,
-						 discriminator_ptr));
-
-      if (found)
-	break;
+      while ((each = stash_comp_unit (stash, &stash->f)) != NULL)
+	{
+	  found = (((symbol->flags & BSF_FUNCTION) == 0
+		    || comp_unit_may_contain_address (each, addr))
+		   && comp_unit_find_line (each, symbol, addr,
+					   filename_ptr, linenumber_ptr));
+	  if (found)
+	    break;
+	}
     }
+  else
+    found = stash_find_nearest_line_at (stash, addr, filename_ptr,
+					functionname_ptr ? &function : NULL,
+					linenumber_ptr, discriminator_ptr);
 
  done:
-  if (functionname_ptr && function && function->is_linkage)
-    {
-      *functionname_ptr = function->name;
-      if (!found)
-        found = 2;
-    }
-  else if (functionname_ptr
-	   && (!*functionname_ptr
-	       || (function && !function->is_linkage)))
-    {
-      asymbol *fun;
-      asymbol **syms = symbols;
-      asection *sec = section;
+  found = stash_function_name (stash, abfd, symbols, section, offset,
+			       function, found, filename_ptr,
+			       functionname_ptr);
 
-      _bfd_dwarf2_stash_syms (stash, abfd, &sec, &syms);
-      fun = _bfd_elf_find_function (abfd, syms, sec, offset,
-				    *filename_ptr ? NULL : filename_ptr,
-				    functionname_ptr);
+  unset_sections (stash);
 
-      if (!found && fun != NULL)
-	found = 2;
+  return found;
+}
 
-      if (function && !function->is_linkage)
-	{
-	  bfd_vma sec_vma;
+/* Find the source code locations of COUNT addresses, SECTION +
+   OFFSETS[i], filling in LINES[i] for each.  This does the work of
+   COUNT calls of _bfd_dwarf2_find_nearest_line, less that which need
+   only be done once for a section.  LINES[i].found is set if the
+   location of OFFSETS[i] was found, fully or from SYMBOLS only.
+   Returns FALSE if there is no DWARF info to look in.  */
 
-	  sec_vma = section->vma;
-	  if (section->output_section != NULL)
-	    sec_vma = section->output_section->vma + section->output_offset;
-	  if (fun == NULL)
-	    *functionname_ptr = function->name;
-	  else if (fun->value + sec_vma == function->arange.low)
-	    function->name = *functionname_ptr;
-	  /* Even if we didn't find a linkage name, say that we have
-	     to stop a repeated search of symbols.  */
-	  function->is_linkage = true;
-	}
+bool
+_bfd_dwarf2_find_nearest_lines (bfd *abfd,
+				asymbol **symbols,
+				asection *section,
+				const bfd_vma *offsets,
+				size_t count,
+				bfd_nearest_line *lines,
+				const struct dwarf_debug_section *debug_sections,
+				void **pinfo)
+{
+  struct dwarf2_debug *stash;
+  bfd_vma sec_vma;
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    memset (&lines[i], 0, sizeof (lines[i]));
+
+  if (! _bfd_dwarf2_slurp_debug_info (abfd, NULL, debug_sections,
+				      symbols, pinfo,
+				      (abfd->flags & (EXEC_P | DYNAMIC)) == 0))
+    return false;
+
+  stash = (struct dwarf2_debug *) *pinfo;
+  if (! stash->f.info_ptr)
+    return false;
+
+  /* Every result of the batch must stay valid until it is done.  */
+  stash_begin_lookup (stash);
+  stash_trim_units (stash);
+
+  sec_vma = stash_section_vma (stash, section);
+
+  for (i = 0; i < count; i++)
+    {
+      bfd_nearest_line *line = &lines[i];
+      struct funcinfo *function = NULL;
+      int found;
+
+      stash->inliner_chain = NULL;
+      if (!stash->all_units_read
+	  && bfd_get_thread_count () > 1
+	  && ++stash->lookup_count >= STASH_PARALLEL_TRIGGER)
+	stash_read_all_units (stash);
+
+      found = stash_find_nearest_line_at (stash, offsets[i] + sec_vma,
+					  &line->filename, &function,
+					  &line->line, &line->discriminator);
+      found = stash_function_name (stash, abfd, symbols, section,
+				   offsets[i], function, found,
+				   &line->filename, &line->functionname);
+      line->found = found != 0;
+      line->inliner = stash->inliner_chain;
     }
 
   unset_sections (stash);
 
-  return found;
+  return true;
 }
 
 bool
@@ -6062,12 +9619,70 @@ _bfd_dwarf2_find_inliner_info (bfd *abfd ATTRIBUTE_UNUSED,
   return false;
 }
 
+/* Step *CHAIN, the inliner of a bfd_nearest_line, to the caller of
+   the function it names, as _bfd_dwarf2_find_inliner_info does for
+   the last lookup.  */
+
+bool
+_bfd_dwarf2_nearest_line_inliner (void **chain,
+				  const char **filename_ptr,
+				  const char **functionname_ptr,
+				  unsigned int *linenumber_ptr)
+{
+  struct funcinfo *func = (struct funcinfo *) *chain;
+
+  if (func && func->caller_func)
+    {
+      *filename_ptr = func->caller_file;
+      *functionname_ptr = func->caller_func->name;
+      *linenumber_ptr = func->caller_line;
+      *chain = func->caller_func;
+      return true;
+    }
+
+  return false;
+}
+
+/* Free the memory FILE of a stash has allocated with malloc.  */
+
+static void
+free_debug_file (struct dwarf2_debug_file *file)
+{
+  struct comp_unit *each;
+
+  for (each = file->all_comp_units; each; each = each->next_unit)
+    {
+      comp_unit_free_tables (each);
+      if (each->memory != NULL)
+	objalloc_free (each->memory);
+    }
+
+  if (file->line_table)
+    {
+      free (file->line_table->file_names);
+      free (file->line_table->files);
+      free (file->line_table->dirs);
+    }
+  if (file->abbrev_offsets != NULL)
+    htab_delete (file->abbrev_offsets);
+  free (file->unit_index);
+
+  free (file->aranges);
+  free (file->unit_offsets);
+  free (file->gdb_index_buffer);
+  free (file->dwarf_names_buffer);
+  free (file->dwarf_line_str_buffer);
+  free (file->dwarf_str_buffer);
+  free (file->dwarf_ranges_buffer);
+  free (file->dwarf_line_buffer);
+  free (file->dwarf_abbrev_buffer);
+  free (file->dwarf_info_buffer);
+}
+
 void
 _bfd_dwarf2_cleanup_debug_info (bfd *abfd, void **pinfo)
 {
   struct dwarf2_debug *stash = (struct dwarf2_debug *) *pinfo;
-  struct comp_unit *each;
-  struct dwarf2_debug_file *file;
 
   if (abfd == NULL || stash == NULL)
     return;
@@ -6077,74 +9692,77 @@ _bfd_dwarf2_cleanup_debug_info (bfd *abfd, void **pinfo)
   if (stash->funcinfo_hash_table)
     bfd_hash_table_free (&stash->funcinfo_hash_table->base);
 
-  file = &stash->f;
-  while (1)
-    {
-      for (each = file->all_comp_units; each; each = each->next_unit)
-	{
-	  struct funcinfo *function_table = each->function_table;
-	  struct varinfo *variable_table = each->variable_table;
-
-	  if (each->line_table && each->line_table != file->line_table)
-	    {
-	      free (each->line_table->files);
-	      free (each->line_table->dirs);
-	    }
-
-	  free (each->lookup_funcinfo_table);
-	  each->lookup_funcinfo_table = NULL;
+  free_debug_file (&stash->f);
+  free_debug_file (&stash->alt);
 
-	  while (function_table)
-	    {
-	      free (function_table->file);
-	      function_table->file = NULL;
-	      free (function_table->caller_file);
-	      function_table->caller_file = NULL;
-	      function_table = function_table->prev_func;
-	    }
+  /* The functions and variables of skeleton units are in the BFDs of
+     the DWO files, so these go after the primary file.  */
+  while (stash->dwo_files != NULL)
+    {
+      struct dwarf2_debug_file *next = stash->dwo_files->next_dwo;
 
-	  while (variable_table)
-	    {
-	      free (variable_table->file);
-	      variable_table->file = NULL;
-	      variable_table = variable_table->prev_var;
-	    }
-	}
+      free_debug_file (stash->dwo_files);
+      free (stash->dwo_files->dwarf_str_offsets_buffer);
+      free (stash->dwo_files->dwarf_rnglists_buffer);
+      bfd_close (stash->dwo_files->bfd_ptr);
+      free (stash->dwo_files);
+      stash->dwo_files = next;
+    }
+  while (stash->worker_memory != NULL)
+    {
+      struct dwarf_worker_memory *next = stash->worker_memory->next;
 
-      if (file->line_table)
-	{
-	  free (file->line_table->files);
-	  free (file->line_table->dirs);
-	}
-      htab_delete (file->abbrev_offsets);
-      if (file->comp_unit_tree != NULL)
-	splay_tree_delete (file->comp_unit_tree);
-
-      free (file->dwarf_line_str_buffer);
-      free (file->dwarf_str_buffer);
-      free (file->dwarf_ranges_buffer);
-      free (file->dwarf_line_buffer);
-      free (file->dwarf_abbrev_buffer);
-      free (file->dwarf_info_buffer);
-      if (file == &stash->alt)
-	break;
-      file = &stash->alt;
+      objalloc_free (stash->worker_memory->memory);
+      free (stash->worker_memory);
+      stash->worker_memory = next;
     }
+  if (stash->abstract_instances)
+    htab_delete (stash->abstract_instances);
+  free (stash->line_index_funcs);
+  if (stash->line_index_bfd)
+    bfd_close (stash->line_index_bfd);
   free (stash->sec_vma);
   free (stash->adjusted_sections);
+  free (stash->section_adjustments);
   if (stash->close_on_cleanup)
     bfd_close (stash->f.bfd_ptr);
   if (stash->alt.bfd_ptr)
     bfd_close (stash->alt.bfd_ptr);
 }
 
-typedef struct elf_find_function_cache
+/* A symbol that may be a function, as found by the maybe_function_sym
+   backend hook, and the file symbol that goes with it.  */
+
+struct elf_function_fit
 {
-  asection *     last_section;
   asymbol *      func;
   const char *   filename;
   bfd_size_type  code_size;
   bfd_vma        code_off;
+  /* Position of FUNC in the symbol table.  */
+  size_t         seq;
+};
+
+/* The possible function symbols of one section, sorted by code_off
+   and then by position in the symbol table.  */
+
+struct elf_function_index
+{
+  asection *                 section;
+  bool                       built;
+  size_t                     count;
+  struct elf_function_fit *  fits;
+};
+
+typedef struct elf_find_function_cache
+{
+  /* The symbol table the indices were built from.  */
+  asymbol **                 symbols;
+  /* One index for each section of the bfd, by section index, and one
+     for a section that is not among them.  */
+  unsigned int               nsections;
+  struct elf_function_index *sections;
+  struct elf_function_index  other;
 
 } elf_find_function_cache;
 
@@ -6154,11 +9772,11 @@ typedef struct elf_find_function_cache
    CACHE.  */
 
 static inline bool
-better_fit (elf_find_function_cache *  cache,
-	    asymbol *                  sym,
-	    bfd_vma                    code_off,
-	    bfd_size_type              code_size,
-	    bfd_vma                    offset)
+better_fit (struct elf_function_fit *  cache,
+	    asymbol *                 sym,
+	    bfd_vma                   code_off,
+	    bfd_size_type             code_size,
+	    bfd_vma                   offset)
 {
   /* If the symbol is beyond the desired offset, ignore it.  */
   if (code_off > offset)
@@ -6214,39 +9832,58 @@ better_fit (elf_find_function_cache *  cache,
   return code_size < cache->code_size;
 }
 
-/* Find the function to a particular section and offset,
-   for error reporting.  */
+/* Sort function fits by offset, keeping symbol table order.  */
 
-asymbol *
-_bfd_elf_find_function (bfd *abfd,
-			asymbol **symbols,
-			asection *section,
-			bfd_vma offset,
-			const char **filename_ptr,
-			const char **functionname_ptr)
+static int
+compare_function_fits (const void *a, const void *b)
 {
-  if (symbols == NULL)
-    return NULL;
+  const struct elf_function_fit *fa = (const struct elf_function_fit *) a;
+  const struct elf_function_fit *fb = (const struct elf_function_fit *) b;
 
-  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour)
-    return NULL;
+  if (fa->code_off != fb->code_off)
+    return fa->code_off < fb->code_off ? -1 : 1;
+  return fa->seq < fb->seq ? -1 : fa->seq > fb->seq;
+}
 
-  elf_find_function_cache * cache = elf_tdata (abfd)->elf_find_function_cache;
+/* Return the index for SECTION in CACHE.  */
 
-  if (cache == NULL)
+static struct elf_function_index *
+function_index_for_section (bfd *abfd, elf_find_function_cache *cache,
+			    asection *section)
+{
+  if (section->owner == abfd && section->index < cache->nsections)
+    return &cache->sections[section->index];
+  if (cache->other.section != section)
     {
-      cache = bfd_zalloc (abfd, sizeof (*cache));
-      elf_tdata (abfd)->elf_find_function_cache = cache;
-      if (cache == NULL)
-	return NULL;
+      cache->other.section = section;
+      cache->other.built = false;
+      cache->other.count = 0;
     }
+  return &cache->other;
+}
+
+/* Build the function index of SECTION from SYMBOLS.  With the generic
+   maybe_function_sym, which only accepts symbols of their own section,
+   the indices of all the sections of ABFD are built by the same walk
+   over the symbols.  */
+
+static bool
+build_function_index (bfd *abfd, elf_find_function_cache *cache,
+		      asymbol **symbols, asection *section)
+{
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  struct elf_function_index *target;
+  bool all;
+  int pass;
+  unsigned int i;
+
+  target = function_index_for_section (abfd, cache, section);
+  all = (bed->maybe_function_sym == _bfd_elf_maybe_function_sym
+	 && target != &cache->other);
 
-  if (cache->last_section != section
-      || cache->func == NULL
-      || offset < cache->func->value
-      || offset >= cache->func->value + cache->code_size)
+  for (pass = 0; pass < 2; pass++)
     {
-      asymbol *file;
+      asymbol *file = NULL;
       asymbol **p;
       /* ??? Given multiple file symbols, it is impossible to reliably
 	 choose the right file name for global symbols.  File symbols are
@@ -6257,19 +9894,14 @@ _bfd_elf_find_function (bfd *abfd,
 	 make a better choice of file name for local symbols by ignoring
 	 file symbols appearing after a given local symbol.  */
       enum { nothing_seen, symbol_seen, file_after_symbol_seen } state;
-      const struct elf_backend_data *bed = get_elf_backend_data (abfd);
 
-      file = NULL;
       state = nothing_seen;
-      cache->filename = NULL;
-      cache->func = NULL;
-      cache->code_size = 0;
-      cache->code_off = 0;
-      cache->last_section = section;
-
       for (p = symbols; *p != NULL; p++)
 	{
 	  asymbol *sym = *p;
+	  asection *sec = section;
+	  struct elf_function_index *idx = target;
+	  struct elf_function_fit *fit;
 	  bfd_vma code_off;
 	  bfd_size_type size;
 
@@ -6284,43 +9916,168 @@ _bfd_elf_find_function (bfd *abfd,
 	  if (state == nothing_seen)
 	    state = symbol_seen;
 
-	  size = bed->maybe_function_sym (sym, section, &code_off);
+	  if (all)
+	    {
+	      sec = sym->section;
+	      if (sec == NULL
+		  || sec->owner != abfd
+		  || sec->index >= cache->nsections)
+		continue;
+	      idx = &cache->sections[sec->index];
+	    }
 
+	  size = bed->maybe_function_sym (sym, sec, &code_off);
 	  if (size == 0)
 	    continue;
 
-	  if (better_fit (cache, sym, code_off, size, offset))
+	  if (pass == 0)
+	    {
+	      idx->count++;
+	      continue;
+	    }
+
+	  fit = &idx->fits[idx->count++];
+	  fit->func = sym;
+	  fit->code_size = size;
+	  fit->code_off = code_off;
+	  fit->seq = p - symbols;
+	  fit->filename = NULL;
+	  if (file != NULL
+	      && ((sym->flags & BSF_LOCAL) != 0
+		  || state != file_after_symbol_seen))
+	    fit->filename = bfd_asymbol_name (file);
+	}
+
+      for (i = 0; i <= cache->nsections; i++)
+	{
+	  struct elf_function_index *idx;
+
+	  idx = i < cache->nsections ? &cache->sections[i] : &cache->other;
+	  if (idx != target && (!all || idx == &cache->other))
+	    continue;
+
+	  if (pass == 0)
 	    {
-	      cache->func = sym;
-	      cache->code_size = size;
-	      cache->code_off = code_off;
-	      cache->filename = NULL;
-
-	      if (file != NULL
-		  && ((sym->flags & BSF_LOCAL) != 0
-		      || state != file_after_symbol_seen))
-		cache->filename = bfd_asymbol_name (file);
+	      size_t amt;
+
+	      idx->fits = NULL;
+	      if (idx->count != 0)
+		{
+		  if (_bfd_mul_overflow (idx->count, sizeof (*idx->fits),
+					 &amt))
+		    {
+		      bfd_set_error (bfd_error_no_memory);
+		      return false;
+		    }
+		  idx->fits = (struct elf_function_fit *) bfd_alloc (abfd,
+								     amt);
+		  if (idx->fits == NULL)
+		    return false;
+		}
+	      idx->count = 0;
 	    }
-	  /* Otherwise, if the symbol is beyond the desired offset but it
-	     lies within the bounds of the current best match then reduce
-	     the size of the current best match so that future searches
-	     will not not used the cached symbol by mistake.  */
-	  else if (code_off > offset 
-		   && code_off > cache->code_off
-		   && code_off < cache->code_off + cache->code_size)
+	  else
 	    {
-	      cache->code_size = code_off - cache->code_off;
+	      if (idx->count > 1)
+		qsort (idx->fits, idx->count, sizeof (*idx->fits),
+		       compare_function_fits);
+	      idx->built = true;
 	    }
 	}
     }
 
-  if (cache->func == NULL)
+  return true;
+}
+
+/* Find the function to a particular section and offset,
+   for error reporting.  */
+
+asymbol *
+_bfd_elf_find_function (bfd *abfd,
+			asymbol **symbols,
+			asection *section,
+			bfd_vma offset,
+			const char **filename_ptr,
+			const char **functionname_ptr)
+{
+  struct elf_function_index *idx;
+  struct elf_function_fit best;
+  size_t lo, hi;
+
+  if (symbols == NULL)
+    return NULL;
+
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour)
+    return NULL;
+
+  elf_find_function_cache * cache = elf_tdata (abfd)->elf_find_function_cache;
+
+  if (cache == NULL)
+    {
+      cache = bfd_zalloc (abfd, sizeof (*cache));
+      elf_tdata (abfd)->elf_find_function_cache = cache;
+      if (cache == NULL)
+	return NULL;
+    }
+
+  /* Start again if asked about a different symbol table.  */
+  if (cache->symbols != symbols)
+    {
+      size_t amt;
+
+      memset (cache, 0, sizeof (*cache));
+      if (_bfd_mul_overflow (abfd->section_count, sizeof (*cache->sections),
+			     &amt))
+	return NULL;
+      cache->sections = (struct elf_function_index *) bfd_zalloc (abfd, amt);
+      if (cache->sections == NULL && amt != 0)
+	return NULL;
+      cache->nsections = abfd->section_count;
+      cache->symbols = symbols;
+    }
+
+  idx = function_index_for_section (abfd, cache, section);
+  if (!idx->built && !build_function_index (abfd, cache, symbols, section))
+    return NULL;
+
+  /* Find the symbols with the highest code_off not beyond OFFSET, and
+     pick the best of those in symbol table order.  Any other symbol
+     would lose to them in better_fit.  */
+  lo = 0;
+  hi = idx->count;
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (idx->fits[mid].code_off <= offset)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0)
+    return NULL;
+
+  hi = lo;
+  while (lo > 0 && idx->fits[lo - 1].code_off == idx->fits[hi - 1].code_off)
+    lo--;
+
+  memset (&best, 0, sizeof (best));
+  for (; lo < hi; lo++)
+    {
+      struct elf_function_fit *fit = &idx->fits[lo];
+
+      if (better_fit (&best, fit->func, fit->code_off, fit->code_size,
+		      offset))
+	best = *fit;
+    }
+
+  if (best.func == NULL)
     return NULL;
 
   if (filename_ptr)
-    *filename_ptr = cache->filename;
+    *filename_ptr = best.filename;
   if (functionname_ptr)
-    *functionname_ptr = bfd_asymbol_name (cache->func);
+    *functionname_ptr = bfd_asymbol_name (best.func);
 
-  return cache->func;
+  return best.func;
 }
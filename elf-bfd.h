@@ -62,6 +62,27 @@ extern "C" {
 #define ElfNAME(X)	NAME(Elf,X)
 #define elfNAME(X)	NAME(elf,X)
 
+/* The parts of an ELF symbol kept with its BFD symbol.  This is an
+   Elf_Internal_Sym cut down to what is needed once the symbol has
+   been read: string table offsets and section indices fit in 32 bits,
+   and the version goes in what would otherwise be padding.  */
+
+typedef struct elf_packed_sym
+{
+  bfd_vma	st_value;		/* Value of the symbol */
+  bfd_vma	st_size;		/* Associated symbol size */
+  unsigned int	st_name;		/* Symbol name, index in string tbl */
+  unsigned int	st_shndx;		/* Associated section index */
+  unsigned char	st_info;		/* Type and binding attributes */
+  unsigned char	st_other;		/* Visibilty, and target specific */
+  unsigned char	st_target_internal;	/* Internal-only information */
+
+  /* Version information.  This is from an Elf_Internal_Versym
+     structure in a SHT_GNU_versym section.  It is zero if there is no
+     version information.  */
+  unsigned short st_version;
+} Elf_Packed_Sym;
+
 /* Information held for an ELF symbol.  The first field is the
    corresponding asymbol.  Every symbol is an ELF file is actually a
    pointer to this structure, although it is often handled as a
@@ -72,21 +93,7 @@ typedef struct
   /* The BFD symbol.  */
   asymbol symbol;
   /* ELF symbol information.  */
-  Elf_Internal_Sym internal_elf_sym;
-  /* Backend specific information.  */
-  union
-    {
-      unsigned int hppa_arg_reloc;
-      void *mips_extr;
-      void *any;
-    }
-  tc_data;
-
-  /* Version information.  This is from an Elf_Internal_Versym
-     structure in a SHT_GNU_versym section.  It is zero if there is no
-     version information.  */
-  unsigned short version;
-
+  Elf_Packed_Sym internal_elf_sym;
 } elf_symbol_type;
 
 struct elf_strtab_hash;
@@ -125,49 +132,50 @@ enum elf_symbol_version
 
 /* ELF linker hash table entries.  */
 
-struct elf_link_hash_entry
+/* The fields of an ELF linker hash entry that only versioned symbols,
+   vtables and __start/__stop symbols use, kept apart so that the
+   entries of other symbols stay small.  */
+
+struct elf_link_hash_cold
 {
-  struct bfd_link_hash_entry root;
+  /* Version information.  */
+  union
+  {
+    /* This field is used for a symbol which is not defined in a
+       regular object.  It points to the version information read in
+       from the dynamic object.  */
+    Elf_Internal_Verdef *verdef;
+    /* This field is used for a symbol which is defined in a regular
+       object.  It is set up in size_dynamic_sections.  It points to
+       the version information we should write out for this symbol.  */
+    struct bfd_elf_version_tree *vertree;
+  } verinfo;
 
-  /* Symbol index in output file.  This is initialized to -1.  It is
-     set to -2 if the symbol is used by a reloc.  It is set to -3 if
-     this symbol is defined in a discarded section.  */
-  long long indx;
+  union
+  {
+    /* For __start_SECNAME and __stop_SECNAME symbols, record the first
+       input section whose section name is SECNAME.  */
+    asection *start_stop_section;
 
-  /* Symbol index as a dynamic symbol.  Initialized to -1, and remains
-     -1 if this is not a dynamic symbol.  */
-  /* ??? Note that this is consistently used as a synonym for tests
-     against whether we can perform various simplifying transformations
-     to the code.  (E.g. changing a pc-relative jump to a PLT entry
-     into a pc-relative jump to the target function.)  That test, which
-     is often relatively complex, and someplaces wrong or incomplete,
-     should really be replaced by a predicate in elflink.c.
+    /* Vtable information. */
+    struct elf_link_virtual_table_entry *vtable;
+  } u2;
+};
 
-     End result: this field -1 does not indicate that the symbol is
-     not in the dynamic symbol table, but rather that the symbol is
-     not visible outside this DSO.  */
-  long long dynindx;
+/* The cold record of every entry that does not have its own.  It is
+   all zero and must not be written.  */
+extern const struct elf_link_hash_cold _bfd_elf_link_hash_no_cold;
 
-  /* If this symbol requires an entry in the global offset table, the
-     processor specific backend uses this field to track usage and
-     final offset.  Two schemes are supported:  The first assumes that
-     a symbol may only have one GOT entry, and uses REFCOUNT until
-     size_dynamic_sections, at which point the contents of the .got is
-     fixed.  Afterward, if OFFSET is -1, then the symbol does not
-     require a global offset table entry.  The second scheme allows
-     multiple GOT entries per symbol, managed via a linked list
-     pointed to by GLIST.  */
-  union gotplt_union got;
-
-  /* Same, but tracks a procedure linkage table entry.  */
-  union gotplt_union plt;
+/* Whether H has a cold record of its own.  */
+#define elf_link_hash_has_cold(H) \
+  ((H)->cold != &_bfd_elf_link_hash_no_cold)
 
-  /* Symbol size.  NB: All fields starting from here are cleared by
-    _bfd_elf_link_hash_newfunc.  */
-  bfd_size_type size;
+struct elf_link_hash_entry
+{
+  struct bfd_link_hash_entry root;
 
-  /* Track dynamic relocs copied for this symbol.  */
-  struct elf_dyn_relocs *dyn_relocs;
+  /* NB: All fields after ROOT are cleared by _bfd_elf_link_hash_newfunc,
+     which then sets INDX, DYNINDX, GOT, PLT and COLD.  */
 
   /* Symbol type (STT_NOTYPE, STT_OBJECT, etc.).  */
   unsigned int type : 8;
@@ -233,8 +241,52 @@ struct elf_link_hash_entry
      the definition having is_weakalias clear.  */
   unsigned int is_weakalias : 1;
 
+  /* ROOT and the flags above are what symbol lookup and resolution
+     touch for every symbol, and fit in the first 64 bytes on the usual
+     hosts.  The fields below are mostly for dynamic symbols and the
+     GOT and PLT.  */
+
+  /* Symbol index in output file.  This is initialized to -1.  It is
+     set to -2 if the symbol is used by a reloc.  It is set to -3 if
+     this symbol is defined in a discarded section.  */
+  int indx;
+
+  /* Symbol index as a dynamic symbol.  Initialized to -1, and remains
+     -1 if this is not a dynamic symbol.  */
+  /* ??? Note that this is consistently used as a synonym for tests
+     against whether we can perform various simplifying transformations
+     to the code.  (E.g. changing a pc-relative jump to a PLT entry
+     into a pc-relative jump to the target function.)  That test, which
+     is often relatively complex, and someplaces wrong or incomplete,
+     should really be replaced by a predicate in elflink.c.
+
+     End result: this field -1 does not indicate that the symbol is
+     not in the dynamic symbol table, but rather that the symbol is
+     not visible outside this DSO.  */
+  int dynindx;
+
+  /* If this symbol requires an entry in the global offset table, the
+     processor specific backend uses this field to track usage and
+     final offset.  Two schemes are supported:  The first assumes that
+     a symbol may only have one GOT entry, and uses REFCOUNT until
+     size_dynamic_sections, at which point the contents of the .got is
+     fixed.  Afterward, if OFFSET is -1, then the symbol does not
+     require a global offset table entry.  The second scheme allows
+     multiple GOT entries per symbol, managed via a linked list
+     pointed to by GLIST.  */
+  union gotplt_union got;
+
+  /* Same, but tracks a procedure linkage table entry.  */
+  union gotplt_union plt;
+
+  /* Symbol size.  */
+  bfd_size_type size;
+
+  /* Track dynamic relocs copied for this symbol.  */
+  struct elf_dyn_relocs *dyn_relocs;
+
   /* String table index in .dynstr if this is a dynamic symbol.  */
-  unsigned long long dynstr_index;
+  unsigned int dynstr_index;
 
   union
   {
@@ -247,28 +299,9 @@ struct elf_link_hash_entry
     unsigned long long elf_hash_value;
   } u;
 
-  /* Version information.  */
-  union
-  {
-    /* This field is used for a symbol which is not defined in a
-       regular object.  It points to the version information read in
-       from the dynamic object.  */
-    Elf_Internal_Verdef *verdef;
-    /* This field is used for a symbol which is defined in a regular
-       object.  It is set up in size_dynamic_sections.  It points to
-       the version information we should write out for this symbol.  */
-    struct bfd_elf_version_tree *vertree;
-  } verinfo;
-
-  union
-  {
-    /* For __start_SECNAME and __stop_SECNAME symbols, record the first
-       input section whose section name is SECNAME.  */
-    asection *start_stop_section;
-
-    /* Vtable information. */
-    struct elf_link_virtual_table_entry *vtable;
-  } u2;
+  /* The fields few symbols use.  Points to _bfd_elf_link_hash_no_cold
+     until one of them is set.  */
+  struct elf_link_hash_cold *cold;
 };
 
 /* Return the strong definition for a weak symbol with aliases.  */
@@ -522,6 +555,17 @@ struct sframe_enc_info
   struct sframe_encoder_ctx *sfe_ctx;
   /* Output section.  */
   asection *sframe_section;
+  /* The FRE sub-section, which the encoder passes on as it goes.  */
+  bfd_byte *fre_contents;
+  bfd_size_type fre_size;
+  bfd_size_type fre_alloced;
+  /* Input sections decoded by _bfd_elf_decode_sframe_sections, in the
+     order _bfd_elf_parse_sframe will see them, their decoder contexts,
+     and the next one it will want.  */
+  asection **pre_secs;
+  struct sframe_decoder_ctx **pre_ctxs;
+  unsigned int pre_count;
+  unsigned int pre_next;
 };
 
 /* Enum used to identify target specific extensions to the elf_obj_tdata
@@ -736,6 +780,14 @@ struct elf_link_hash_table
   /* Small local sym cache.  */
   struct sym_cache sym_cache;
 
+  /* Sections waiting to be looked at by _bfd_elf_gc_mark, while it is
+     marking.  */
+  struct elf_gc_work *gc_work;
+
+  /* Swapped relocs kept by _bfd_elf_link_info_read_relocs, if
+     bfd_elf_set_reloc_cache_size has given it room.  */
+  struct elf_reloc_cache *reloc_cache;
+
   /* Short-cuts to get to dynamic linker sections.  */
   asection *sgot;
   asection *sgotplt;
@@ -788,6 +840,25 @@ elf_link_hash_traverse (struct elf_link_hash_table *table,
 			  info);
 }
 
+/* Traverse an ELF linker hash table on several threads.  See
+   bfd_hash_traverse_parallel.  */
+
+static inline bool
+elf_link_hash_traverse_parallel
+  (struct elf_link_hash_table *table,
+   bool (*f) (struct elf_link_hash_entry *, void *, void *),
+   size_t result_size,
+   bool (*reduce) (void *, void *),
+   void *info)
+{
+  if (ENABLE_CHECKING && !is_elf_hash_table (&table->root))
+    abort ();
+  return bfd_link_hash_traverse_parallel
+    (&table->root,
+     (bool (*) (struct bfd_link_hash_entry *, void *, void *)) f,
+     result_size, reduce, info);
+}
+
 /* Get the ELF linker hash table from a link_info structure.  */
 
 static inline struct elf_link_hash_table *
@@ -859,6 +930,19 @@ struct elf_size_info {
   /* This function is called to swap out a RELA relocation.  */
   void (*swap_reloca_out)
     (bfd *, const Elf_Internal_Rela *, bfd_byte *);
+
+  /* This function is called to swap in an array of REL or RELA
+     relocations, of the given count and entry size, each of which
+     corresponds to one internal relocation.  NULL if not
+     available.  */
+  void (*swap_relocs_in)
+    (bfd *, const bfd_byte *, size_t, size_t, Elf_Internal_Rela *);
+
+  /* Like checksum_contents, but hash the file as a tree of pieces that
+     can be hashed in parallel.  The hash function is given the data,
+     its size and where to store a digest of the given size.  */
+  bool (*checksum_contents_tree)
+    (bfd *, void (*) (const void *, size_t, void *), size_t, void *);
 };
 
 #define elf_symbol_from(S) \
@@ -1808,13 +1892,6 @@ struct bfd_elf_section_data
      pointer may be NULL.  It is used by the backend linker.  */
   Elf_Internal_Rela *relocs;
 
-  /* A pointer to a linked list tracking dynamic relocs copied for
-     local symbols.  */
-  void *local_dynrel;
-
-  /* A pointer to the bfd section used for dynamic relocs.  */
-  asection *sreloc;
-
   union {
     /* Group name, if this section is a member of a group.  */
     const char *name;
@@ -1831,13 +1908,6 @@ struct bfd_elf_section_data
      the linker.  For the SHT_GROUP section, points at first member.  */
   asection *next_in_group;
 
-  /* The FDEs associated with this section.  The u.fde.next_in_section
-     field acts as a chain pointer.  */
-  struct eh_cie_fde *fde_list;
-
-  /* Link from a text section to its .eh_frame_entry section.  */
-  asection *eh_frame_entry;
-
   /* TRUE if the section has secondary reloc sections associated with it.
      FIXME: In the future it might be better to change this into a list
      of secondary reloc sections, making lookup easier and faster.  */
@@ -1845,8 +1915,41 @@ struct bfd_elf_section_data
 
   /* A pointer used for various section optimizations.  */
   void *sec_info;
+
+  /* The fields only the linker uses, and only for some sections.
+     NULL until one of them is set.  */
+  struct bfd_elf_section_cold *cold;
+};
+
+/* The fields of struct bfd_elf_section_data that most sections never
+   set.  Objects built with -ffunction-sections have a great many
+   sections most of which need none of them, so they are kept apart
+   and only allocated when first written.  Read them with
+   elf_section_cold and write them through _bfd_elf_section_cold.  */
+
+struct bfd_elf_section_cold
+{
+  /* A pointer to a linked list tracking dynamic relocs copied for
+     local symbols.  */
+  void *local_dynrel;
+
+  /* A pointer to the bfd section used for dynamic relocs.  */
+  asection *sreloc;
+
+  /* The FDEs associated with this section.  The u.fde.next_in_section
+     field acts as a chain pointer.  */
+  struct eh_cie_fde *fde_list;
+
+  /* Link from a text section to its .eh_frame_entry section.  */
+  asection *eh_frame_entry;
 };
 
+/* The cold record of every section that does not have its own.  It
+   is all zero and must not be written.  */
+extern const struct bfd_elf_section_cold _bfd_elf_section_no_cold;
+
+extern struct bfd_elf_section_cold *_bfd_elf_section_cold (asection *);
+
 #define elf_section_data(sec) ((struct bfd_elf_section_data*)(sec)->used_by_bfd)
 #define elf_linked_to_section(sec) (elf_section_data(sec)->linked_to)
 #define elf_section_type(sec)	(elf_section_data(sec)->this_hdr.sh_type)
@@ -1855,9 +1958,13 @@ struct bfd_elf_section_data
 #define elf_group_name(sec)	(elf_section_data(sec)->group.name)
 #define elf_group_id(sec)	(elf_section_data(sec)->group.id)
 #define elf_next_in_group(sec)	(elf_section_data(sec)->next_in_group)
-#define elf_fde_list(sec)	(elf_section_data(sec)->fde_list)
+#define elf_section_cold(sec) \
+  (elf_section_data(sec)->cold != NULL					\
+   ? (const struct bfd_elf_section_cold *) elf_section_data(sec)->cold	\
+   : &_bfd_elf_section_no_cold)
+#define elf_fde_list(sec)	(elf_section_cold(sec)->fde_list)
 #define elf_sec_group(sec)	(elf_section_data(sec)->sec_group)
-#define elf_section_eh_frame_entry(sec)	(elf_section_data(sec)->eh_frame_entry)
+#define elf_section_eh_frame_entry(sec)	(elf_section_cold(sec)->eh_frame_entry)
 
 #define xvec_get_elf_backend_data(xvec) \
   ((const struct elf_backend_data *) (xvec)->backend_data)
@@ -1939,6 +2046,17 @@ struct core_elf_obj_tdata
   int lwpid;
   char* program;
   char* command;
+
+  /* The sections made for PT_LOAD segments, sorted by address on the
+     first bfd_elf_core_find_section call.  */
+  asection **loads;
+  unsigned int load_count;
+  bool loads_indexed;
+
+  /* The files mapped into the process according to the NT_FILE note,
+     sorted by address.  */
+  struct elf_core_file_mapping *file_mappings;
+  unsigned int file_mapping_count;
 };
 
 /* Extra tdata information held for output ELF BFDs.  */
@@ -2090,12 +2208,29 @@ struct elf_obj_tdata
   /* Symbol version references to external objects.  */
   Elf_Internal_Verneed *verref;
 
+  /* The name of the version reference with each vna_other in verref,
+     to look up symbol versions directly.  Built on first use by
+     _bfd_elf_get_symbol_version_string.  */
+  const char **verref_names;
+  unsigned int verref_names_count;
+
   /* A pointer to the .eh_frame section.  */
   asection *eh_frame_section;
 
   /* Symbol buffer.  */
   void *symbuf;
 
+  /* Views of the symbol table and the dynamic symbol table, set up
+     by _bfd_elf_read_minisymbols when it reads minisymbols from them.  */
+  struct elf_symbol_view *minisym_views[2];
+
+  /* Global symbols and symbol versions read by
+     bfd_elf_link_preload_symbols, waiting for bfd_elf_link_add_symbols
+     to take them over.  */
+  Elf_Internal_Sym *link_isymbuf;
+  Elf_External_Versym *link_extversym;
+  size_t link_extversym_size;
+
   /* List of GNU properties.  Will be updated by setup_gnu_properties
      after all input GNU properties are merged for output.  */
   elf_property_list *properties;
@@ -2108,6 +2243,12 @@ struct elf_obj_tdata
      in the list.  */
   struct sdt_note *sdt_note_head;
 
+  /* Every note in the file, sorted by owner, type and position.
+     Built on the first bfd_elf_find_notes call.  */
+  struct elf_note_info *notes;
+  unsigned int note_count;
+  bool notes_indexed;
+
   Elf_Internal_Shdr **group_sect_ptr;
   unsigned int num_group;
 
@@ -2115,6 +2256,12 @@ struct elf_obj_tdata
      section's group.  Used to optimize subsequent group searches.  */
   unsigned int group_search_offset;
 
+  /* For each section header, one more than the index into
+     group_sect_ptr of the group listing it, zero if no group does,
+     or -1 if several do.  Lets setup_group start its search at the
+     right group.  */
+  unsigned int *section_group_index;
+
   unsigned int symtab_section, dynsymtab_section;
   unsigned int dynversym_section, dynverdef_section, dynverref_section;
 
@@ -2237,6 +2384,114 @@ extern Elf_Internal_Sym *bfd_elf_get_elf_syms
 extern char * bfd_elf_get_str_section (bfd *, unsigned int);
 extern const char *bfd_elf_sym_name
   (bfd *, Elf_Internal_Shdr *, Elf_Internal_Sym *, asection *);
+extern bool _bfd_elf_make_symbol
+  (bfd *, const Elf_Internal_Sym *, const char *, const Elf_External_Versym *,
+   bool, elf_symbol_type *);
+
+/* A view of the symbols of an ELF file in their external form, used
+   in place.  See bfd_elf_symbol_view_init.  */
+
+struct elf_symbol_view
+{
+  /* The BFD and the symbol table header the view is of.  */
+  bfd *abfd;
+  Elf_Internal_Shdr *hdr;
+
+  /* The external symbols, and their section index extensions and
+     versions if the file has them.  */
+  const bfd_byte *syms;
+  const bfd_byte *shndx;
+  const bfd_byte *versym;
+
+  /* The string table the symbols are named from.  */
+  const char *strtab;
+  bfd_size_type strtab_size;
+
+  /* The number of symbols, including the null symbol, and the size
+     of each.  */
+  size_t count;
+  unsigned int sizeof_sym;
+
+  /* Whether this is the dynamic symbol table.  */
+  bool dynamic;
+};
+
+extern bool bfd_elf_symbol_view_init
+  (bfd *, bool, struct elf_symbol_view *);
+extern bool bfd_elf_symbol_view_get
+  (const struct elf_symbol_view *, size_t, Elf_Internal_Sym *);
+extern const char *bfd_elf_symbol_view_name
+  (const struct elf_symbol_view *, size_t);
+extern size_t bfd_elf_symbol_view_find
+  (const struct elf_symbol_view *, const char *, size_t);
+extern asymbol *bfd_elf_symbol_view_asymbol
+  (const struct elf_symbol_view *, size_t);
+
+/* A view of the relocations of an ELF section in their external
+   form, used in place.  See bfd_elf_reloc_view_init.  */
+
+struct elf_reloc_view
+{
+  /* The BFD and section the view is of.  */
+  bfd *abfd;
+  asection *sec;
+
+  /* The external REL and RELA relocations, and how many of each.
+     REL relocations come first.  */
+  const bfd_byte *rel;
+  const bfd_byte *rela;
+  size_t rel_count;
+  size_t rela_count;
+
+  /* The number of relocations in all.  */
+  size_t count;
+};
+
+extern bool bfd_elf_reloc_view_init
+  (bfd *, asection *, bool, struct elf_reloc_view *);
+extern bool bfd_elf_reloc_view_read
+  (const struct elf_reloc_view *, size_t, size_t, bfd_vma *, unsigned int *,
+   unsigned int *, bfd_signed_vma *);
+
+/* A file mapped into the process of a core dump, from its NT_FILE
+   note.  See bfd_elf_core_find_file_mapping.  */
+
+struct elf_core_file_mapping
+{
+  /* The addresses mapped, from START up to but not including END.  */
+  bfd_vma start;
+  bfd_vma end;
+
+  /* The offset in the file of the byte mapped at START.  */
+  bfd_vma offset;
+
+  const char *filename;
+};
+
+/* A note in an ELF file.  See bfd_elf_find_notes.  */
+
+struct elf_note_info
+{
+  /* The owner of the note, such as "GNU" or "CORE".  */
+  const char *name;
+
+  /* The type of the note, whose meaning depends on its owner.  */
+  unsigned long type;
+
+  /* The file position and size of the note's descriptor.  */
+  file_ptr descpos;
+  bfd_size_type descsz;
+};
+
+extern const struct elf_note_info *bfd_elf_find_notes
+  (bfd *, const char *, unsigned long, unsigned int *);
+
+extern asection *bfd_elf_core_find_section
+  (bfd *, bfd_vma);
+extern bool bfd_elf_core_read_memory
+  (bfd *, bfd_vma, void *, bfd_size_type);
+extern const struct elf_core_file_mapping *bfd_elf_core_find_file_mapping
+  (bfd *, bfd_vma);
 
 extern bool _bfd_elf_copy_private_bfd_data
   (bfd *, bfd *);
@@ -2387,8 +2642,10 @@ extern bool _bfd_elf_find_inliner_info
   (bfd *, const char **, const char **, unsigned int *);
 extern asymbol *_bfd_elf_find_function
   (bfd *, asymbol **, asection *, bfd_vma, const char **, const char **);
-#define _bfd_elf_read_minisymbols _bfd_generic_read_minisymbols
-#define _bfd_elf_minisymbol_to_symbol _bfd_generic_minisymbol_to_symbol
+extern long long _bfd_elf_read_minisymbols
+  (bfd *, bool, void **, unsigned int *);
+extern asymbol *_bfd_elf_minisymbol_to_symbol
+  (bfd *, bool, const void *, asymbol *);
 extern int _bfd_elf_sizeof_headers
   (bfd *, struct bfd_link_info *);
 extern bool _bfd_elf_new_section_hook
@@ -2424,6 +2681,9 @@ extern void _bfd_elf_strtab_free
   (struct elf_strtab_hash *);
 extern size_t _bfd_elf_strtab_add
   (struct elf_strtab_hash *, const char *, bool);
+extern size_t _bfd_elf_strtab_add_with_hash
+  (struct elf_strtab_hash *, const char *, unsigned long long,
+   enum bfd_hash_function, bool);
 extern void _bfd_elf_strtab_addref
   (struct elf_strtab_hash *, size_t);
 extern void _bfd_elf_strtab_delref
@@ -2483,6 +2743,10 @@ extern bool _bfd_elf_maybe_strip_eh_frame_hdr
 
 extern bool _bfd_elf_sframe_present
   (struct bfd_link_info *);
+extern bool _bfd_elf_decode_sframe_sections
+  (struct bfd_link_info *, asection *);
+extern void _bfd_elf_free_decoded_sframe_sections
+  (struct bfd_link_info *);
 extern bool _bfd_elf_parse_sframe
   (bfd *, struct bfd_link_info *, asection *, struct elf_reloc_cookie *);
 extern bool _bfd_elf_discard_section_sframe
@@ -2499,6 +2763,9 @@ extern long long _bfd_elf_link_lookup_local_dynindx
   (struct bfd_link_info *, bfd *, long long);
 extern bool _bfd_elf_compute_section_file_positions
   (bfd *, struct bfd_link_info *);
+extern bool _bfd_elf_swap_syms_out
+  (bfd *, const struct elf_sym_strtab *, size_t, void *,
+   Elf_External_Sym_Shndx *);
 extern file_ptr _bfd_elf_assign_file_position_for_section
   (Elf_Internal_Shdr *, file_ptr, bool);
 extern bool _bfd_elf_modify_headers
@@ -2621,6 +2888,8 @@ extern void bfd_elf32_swap_reloca_in
   (bfd *, const bfd_byte *, Elf_Internal_Rela *);
 extern void bfd_elf32_swap_reloca_out
   (bfd *, const Elf_Internal_Rela *, bfd_byte *);
+extern void bfd_elf32_swap_relocs_in
+  (bfd *, const bfd_byte *, size_t, size_t, Elf_Internal_Rela *);
 extern void bfd_elf32_swap_phdr_in
   (bfd *, const Elf32_External_Phdr *, Elf_Internal_Phdr *);
 extern void bfd_elf32_swap_phdr_out
@@ -2637,6 +2906,8 @@ extern int bfd_elf32_write_out_phdrs
   (bfd *, const Elf_Internal_Phdr *, unsigned int);
 extern bool bfd_elf32_checksum_contents
   (bfd * , void (*) (const void *, size_t, void *), void *);
+extern bool bfd_elf32_checksum_contents_tree
+  (bfd *, void (*) (const void *, size_t, void *), size_t, void *);
 extern void bfd_elf32_write_relocs
   (bfd *, asection *, void *);
 extern bool bfd_elf32_slurp_reloc_table
@@ -2669,6 +2940,8 @@ extern void bfd_elf64_swap_reloca_in
   (bfd *, const bfd_byte *, Elf_Internal_Rela *);
 extern void bfd_elf64_swap_reloca_out
   (bfd *, const Elf_Internal_Rela *, bfd_byte *);
+extern void bfd_elf64_swap_relocs_in
+  (bfd *, const bfd_byte *, size_t, size_t, Elf_Internal_Rela *);
 extern void bfd_elf64_swap_phdr_in
   (bfd *, const Elf64_External_Phdr *, Elf_Internal_Phdr *);
 extern void bfd_elf64_swap_phdr_out
@@ -2685,6 +2958,8 @@ extern int bfd_elf64_write_out_phdrs
   (bfd *, const Elf_Internal_Phdr *, unsigned int);
 extern bool bfd_elf64_checksum_contents
   (bfd * , void (*) (const void *, size_t, void *), void *);
+extern bool bfd_elf64_checksum_contents_tree
+  (bfd *, void (*) (const void *, size_t, void *), size_t, void *);
 extern void bfd_elf64_write_relocs
   (bfd *, asection *, void *);
 extern bool bfd_elf64_slurp_reloc_table
@@ -2702,6 +2977,12 @@ extern struct bfd_link_hash_entry *_bfd_elf_archive_symbol_lookup
   (bfd *, struct bfd_link_info *, const char *);
 extern bool bfd_elf_link_add_symbols
   (bfd *, struct bfd_link_info *);
+extern bool bfd_elf_set_reloc_cache_size
+  (struct bfd_link_info *, bfd_size_type);
+extern void bfd_elf_reloc_cache_stats
+  (struct bfd_link_info *, unsigned long long *, unsigned long long *);
+extern bool bfd_elf_link_preload_symbols
+  (struct bfd_link_info *, bfd **, size_t);
 extern bool _bfd_elf_add_dynamic_entry
   (struct bfd_link_info *, bfd_vma, bfd_vma);
 extern bool _bfd_elf_strip_zero_sized_dynamic_sections
@@ -2741,6 +3022,8 @@ extern bfd_reloc_status_type _bfd_elf_rel_vtable_reloc_fn
   (bfd *, arelent *, struct bfd_symbol *, void *,
    asection *, bfd *, char **);
 
+extern bool bfd_elf_incremental_compare
+  (bfd *, struct bfd_link_info *, size_t *);
 extern bool bfd_elf_final_link
   (bfd *, struct bfd_link_info *);
 
@@ -24,6 +24,7 @@
 #include "libbfd.h"
 #include "elf-bfd.h"
 #include "dwarf2.h"
+#include "leb128.h"
 
 #define EH_FRAME_HDR_SIZE 8
 
@@ -90,11 +91,14 @@ skip_bytes (bfd_byte **iter, bfd_byte *end, bfd_size_type length)
 static bool
 skip_leb128 (bfd_byte **iter, bfd_byte *end)
 {
-  unsigned char byte;
-  do
-    if (!read_byte (iter, end, &byte))
+  size_t len = leb128_skip (*iter, end);
+
+  if (len == 0)
+    {
+      *iter = end;
       return false;
-  while (byte & 0x80);
+    }
+  *iter += len;
   return true;
 }
 
@@ -104,17 +108,16 @@ skip_leb128 (bfd_byte **iter, bfd_byte *end)
 static bool
 read_uleb128 (bfd_byte **iter, bfd_byte *end, bfd_vma *value)
 {
-  bfd_byte *start, *p;
-
-  start = *iter;
-  if (!skip_leb128 (iter, end))
-    return false;
-
-  p = *iter;
-  *value = *--p;
-  while (p > start)
-    *value = (*value << 7) | (*--p & 0x7f);
+  uint64_t result;
+  size_t len = leb128_read_unsigned (*iter, end, &result);
 
+  if (len == 0)
+    {
+      *iter = end;
+      return false;
+    }
+  *iter += len;
+  *value = result;
   return true;
 }
 
@@ -123,17 +126,16 @@ read_uleb128 (bfd_byte **iter, bfd_byte *end, bfd_vma *value)
 static bool
 read_sleb128 (bfd_byte **iter, bfd_byte *end, bfd_signed_vma *value)
 {
-  bfd_byte *start, *p;
-
-  start = *iter;
-  if (!skip_leb128 (iter, end))
-    return false;
-
-  p = *iter;
-  *value = ((*--p & 0x7f) ^ 0x40) - 0x40;
-  while (p > start)
-    *value = (*value << 7) | (*--p & 0x7f);
+  int64_t result;
+  size_t len = leb128_read_signed (*iter, end, &result);
 
+  if (len == 0)
+    {
+      *iter = end;
+      return false;
+    }
+  *iter += len;
+  *value = result;
   return true;
 }
 
@@ -471,20 +473,17 @@ make_pc_relative (unsigned char encoding, unsigned int ptr_size)
 static void
 bfd_elf_discard_eh_frame_entry (struct eh_frame_hdr_info *hdr_info)
 {
-  unsigned int i;
-  for (i = 0; i < hdr_info->array_count; i++)
-    {
-      if (hdr_info->u.compact.entries[i]->flags & SEC_EXCLUDE)
-	{
-	  unsigned int j;
-	  for (j = i + 1; j < hdr_info->array_count; j++)
-	    hdr_info->u.compact.entries[j-1] = hdr_info->u.compact.entries[j];
+  unsigned int i, j;
 
-	  hdr_info->array_count--;
-	  hdr_info->u.compact.entries[hdr_info->array_count] = NULL;
-	  i--;
-	}
-    }
+  /* Squeeze out the excluded entries in one pass, keeping the rest
+     in order.  */
+  for (i = j = 0; i < hdr_info->array_count; i++)
+    if (!(hdr_info->u.compact.entries[i]->flags & SEC_EXCLUDE))
+      hdr_info->u.compact.entries[j++] = hdr_info->u.compact.entries[i];
+
+  for (i = j; i < hdr_info->array_count; i++)
+    hdr_info->u.compact.entries[i] = NULL;
+  hdr_info->array_count = j;
 }
 
 /* Add a .eh_frame_entry section.  */
@@ -529,6 +528,7 @@ _bfd_elf_parse_eh_frame_entry (struct bfd_link_info *info,
   struct eh_frame_hdr_info *hdr_info;
   unsigned long long r_symndx;
   asection *text_sec;
+  struct bfd_elf_section_cold *cold;
 
   htab = elf_hash_table (info);
   hdr_info = &htab->eh_info;
@@ -559,7 +559,10 @@ _bfd_elf_parse_eh_frame_entry (struct bfd_link_info *info,
   if (text_sec == NULL)
     return false;
 
-  elf_section_eh_frame_entry (text_sec) = sec;
+  cold = _bfd_elf_section_cold (text_sec);
+  if (cold == NULL)
+    return false;
+  cold->eh_frame_entry = sec;
   if (text_sec->output_section
       && bfd_is_abs_section (text_sec->output_section))
     sec->flags |= SEC_EXCLUDE;
@@ -925,9 +928,13 @@ _bfd_elf_parse_eh_frame (bfd *abfd, struct bfd_link_info *info,
 		 a discarded SHT_GROUP.  */
 	      if (rsec)
 		{
+		  struct bfd_elf_section_cold *cold;
+
 		  REQUIRE (rsec->owner == abfd);
-		  this_inf->u.fde.next_for_section = elf_fde_list (rsec);
-		  elf_fde_list (rsec) = this_inf;
+		  cold = _bfd_elf_section_cold (rsec);
+		  REQUIRE (cold != NULL);
+		  this_inf->u.fde.next_for_section = cold->fde_list;
+		  cold->fde_list = this_inf;
 		}
 	    }
 
@@ -1297,6 +1304,7 @@ find_merged_cie (bfd *abfd, struct bfd_link_info *info, asection *sec,
       hdr_info->u.dwarf.cies = htab_try_create (1, cie_hash, cie_eq, free);
       if (hdr_info->u.dwarf.cies == NULL)
 	return cie_inf;
+      htab_set_incremental (hdr_info->u.dwarf.cies, 1);
     }
   loc = htab_find_slot_with_hash (hdr_info->u.dwarf.cies, cie,
 				  cie->hash, INSERT);
@@ -2277,6 +2285,87 @@ vma_compare (const void *a, const void *b)
   return 0;
 }
 
+/* Sort the COUNT entries of the .eh_frame_hdr search table ARRAY as
+   vma_compare orders them.  The FDEs are recorded in output order, so
+   the table is usually made of a few long runs that are already in
+   order, often just one.  Find those runs and merge them rather than
+   sorting from scratch, which makes the common cases linear.  */
+
+static void
+sort_eh_frame_array (struct eh_frame_array_ent *array, unsigned int count)
+{
+  struct eh_frame_array_ent *tmp, *src, *dst;
+  unsigned int *runs;
+  unsigned int nruns, i;
+
+  if (count < 2)
+    return;
+
+  /* Count the runs first, to know how much to allocate.  */
+  nruns = 1;
+  for (i = 1; i < count; i++)
+    if (vma_compare (&array[i - 1], &array[i]) > 0)
+      nruns++;
+  if (nruns == 1)
+    return;
+
+  tmp = (struct eh_frame_array_ent *) bfd_malloc (count * sizeof (*tmp));
+  runs = (unsigned int *) bfd_malloc ((nruns + 1) * sizeof (*runs));
+  if (tmp == NULL || runs == NULL)
+    {
+      free (tmp);
+      free (runs);
+      qsort (array, count, sizeof (*array), vma_compare);
+      return;
+    }
+
+  /* RUNS holds the start of each run, and COUNT at the end.  */
+  nruns = 0;
+  runs[nruns++] = 0;
+  for (i = 1; i < count; i++)
+    if (vma_compare (&array[i - 1], &array[i]) > 0)
+      runs[nruns++] = i;
+  runs[nruns] = count;
+
+  /* Merge neighbouring pairs of runs until one is left.  */
+  src = array;
+  dst = tmp;
+  while (nruns > 1)
+    {
+      unsigned int r, n;
+
+      for (r = n = 0; r < nruns; r += 2, n++)
+	{
+	  unsigned int a = runs[r];
+	  unsigned int a_end = runs[r + 1];
+	  unsigned int b = a_end;
+	  unsigned int b_end = r + 2 <= nruns ? runs[r + 2] : a_end;
+	  unsigned int out = a;
+
+	  while (a < a_end && b < b_end)
+	    if (vma_compare (&src[b], &src[a]) < 0)
+	      dst[out++] = src[b++];
+	    else
+	      dst[out++] = src[a++];
+	  while (a < a_end)
+	    dst[out++] = src[a++];
+	  while (b < b_end)
+	    dst[out++] = src[b++];
+	  runs[n] = runs[r];
+	}
+      runs[n] = count;
+      nruns = n;
+
+      src = dst;
+      dst = src == array ? tmp : array;
+    }
+
+  if (src != array)
+    memcpy (array, src, count * sizeof (*array));
+  free (runs);
+  free (tmp);
+}
+
 /* Reorder .eh_frame_entry sections to match the associated text sections.
    This routine is called during the final linking step, just before writing
    the contents.  At this stage, sections in the eh_frame_hdr_info are already
@@ -2460,8 +2549,8 @@ write_dwarf_eh_frame_hdr (bfd *abfd, struct bfd_link_info *info)
 
       bfd_put_32 (abfd, hdr_info->u.dwarf.fde_count,
 		  contents + EH_FRAME_HDR_SIZE);
-      qsort (hdr_info->u.dwarf.array, hdr_info->u.dwarf.fde_count,
-	     sizeof (*hdr_info->u.dwarf.array), vma_compare);
+      sort_eh_frame_array (hdr_info->u.dwarf.array,
+			   hdr_info->u.dwarf.fde_count);
       overlap = false;
       overflow = false;
       for (i = 0; i < hdr_info->u.dwarf.fde_count; i++)
@@ -120,6 +120,8 @@ _bfd_elf_allocate_ifunc_dyn_relocs (struct bfd_link_info *info,
   /* If AVOID_PLT is TRUE, don't use PLT if possible.  */
   bool use_plt = !avoid_plt || h->plt.refcount > 0;
   bool need_dynreloc = !use_plt || bfd_link_pic (info);
+  bfd_size_type count = 0;
+  bool pc_ref = false;
 
   /* When a PIC object references a STT_GNU_IFUNC symbol defined
      in executable or it isn't referenced via PLT, the address of
@@ -152,29 +154,31 @@ _bfd_elf_allocate_ifunc_dyn_relocs (struct bfd_link_info *info,
 
   htab = elf_hash_table (info);
 
+  /* Total the dynamic relocations against the symbol in one walk of
+     the list, for both the checks below and the space allocated.  */
+  for (p = *head; p != NULL; p = p->next)
+    if (p->count)
+      {
+	count += p->count;
+	if (p->pc_count)
+	  pc_ref = true;
+      }
+
   /* When the symbol is marked with regular reference, if PLT isn't used
      or we are building a PIC object, we must keep dynamic relocation
      if there is non-GOT reference and use PLT if there is PC-relative
      reference.  */
-  if (need_dynreloc && h->ref_regular)
+  if (need_dynreloc && h->ref_regular && count != 0)
     {
-      bool keep = false;
-      for (p = *head; p != NULL; p = p->next)
-	if (p->count)
-	  {
-	    h->non_got_ref = 1;
-	    /* Need dynamic relocations for non-GOT reference.  */
-	    keep = true;
-	    if (p->pc_count)
-	      {
-		/* Must use PLT for PC-relative reference.  */
-		use_plt = true;
-		need_dynreloc = bfd_link_pic (info);
-		break;
-	      }
-	  }
-      if (keep)
-	goto keep;
+      h->non_got_ref = 1;
+      /* Need dynamic relocations for non-GOT reference.  */
+      if (pc_ref)
+	{
+	  /* Must use PLT for PC-relative reference.  */
+	  use_plt = true;
+	  need_dynreloc = bfd_link_pic (info);
+	}
+      goto keep;
     }
 
   /* Support garbage collection against STT_GNU_IFUNC symbols.  */
@@ -254,17 +258,8 @@ _bfd_elf_allocate_ifunc_dyn_relocs (struct bfd_link_info *info,
     *head = NULL;
 
   /* Finally, allocate space.  */
-  p = *head;
-  if (p != NULL)
+  if (*head != NULL)
     {
-      bfd_size_type count = 0;
-      do
-	{
-	  count += p->count;
-	  p = p->next;
-	}
-      while (p != NULL);
-
       htab->ifunc_resolvers = count != 0;
 
       /* Dynamic relocations are stored in
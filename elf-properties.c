@@ -367,13 +367,18 @@ static void
 elf_merge_gnu_property_list (struct bfd_link_info *info, bfd *first_pbfd,
 			     bfd *abfd, elf_property_list **listp)
 {
-  elf_property_list *p, **lastp;
+  elf_property_list *p, **lastp, **restp;
   elf_property *pr;
   bool number_p;
   bfd_vma number = 0;
 
-  /* Merge each GNU property in FIRST_PBFD with the one on *LISTP.  */
+  /* Merge each GNU property in FIRST_PBFD with the one on *LISTP.
+     Both lists are sorted by type, so each search on *LISTP carries
+     on from where the last one stopped, making this a single pass
+     over the two lists rather than a search from the start of *LISTP
+     for every property.  */
   lastp = &elf_properties (first_pbfd);
+  restp = listp;
   for (p = *lastp; p; p = p->next)
     if (p->property.pr_kind != property_remove)
       {
@@ -384,7 +389,10 @@ elf_merge_gnu_property_list (struct bfd_link_info *info, bfd *first_pbfd,
 	  }
 	else
 	  number_p = false;
-	pr = elf_find_and_remove_property (listp, p->property.pr_type,
+	while (*restp != NULL
+	       && (*restp)->property.pr_type < p->property.pr_type)
+	  restp = &(*restp)->next;
+	pr = elf_find_and_remove_property (restp, p->property.pr_type,
 					   true);
 	/* Pass NULL to elf_merge_gnu_properties for the property which
 	   isn't on *LISTP.  */
@@ -183,12 +183,13 @@ _bfd_elf_sframe_present (struct bfd_link_info *info)
 
 bool
 _bfd_elf_parse_sframe (bfd *abfd,
-		       struct bfd_link_info *info ATTRIBUTE_UNUSED,
+		       struct bfd_link_info *info,
 		       asection *sec, struct elf_reloc_cookie *cookie)
 {
   bfd_byte *sfbuf = NULL;
   struct sframe_dec_info *sfd_info;
-  sframe_decoder_ctx *sfd_ctx;
+  struct sframe_enc_info *sfe_info;
+  sframe_decoder_ctx *sfd_ctx = NULL;
   bfd_size_type sf_size;
   int decerr = 0;
 
@@ -207,8 +208,18 @@ _bfd_elf_parse_sframe (bfd *abfd,
       return false;
     }
 
+  /* Use the decoder context from _bfd_elf_decode_sframe_sections, if
+     it has made one.  */
+  sfe_info = &elf_hash_table (info)->sfe_info;
+  if (sfe_info->pre_next < sfe_info->pre_count
+      && sfe_info->pre_secs[sfe_info->pre_next] == sec)
+    {
+      sfd_ctx = sfe_info->pre_ctxs[sfe_info->pre_next];
+      sfe_info->pre_ctxs[sfe_info->pre_next++] = NULL;
+    }
+
   /* Read the SFrame stack trace information from abfd.  */
-  if (!bfd_malloc_and_get_section (abfd, sec, &sfbuf))
+  if (sfd_ctx == NULL && !bfd_malloc_and_get_section (abfd, sec, &sfbuf))
     goto fail_no_free;
 
   /* Decode the buffer and keep decoded contents for later use.
@@ -217,8 +228,9 @@ _bfd_elf_parse_sframe (bfd *abfd,
   sfd_info = bfd_malloc (sizeof (struct sframe_dec_info));
   sf_size = sec->size;
 
-  sfd_info->sfd_ctx = sframe_decode ((const char*)sfbuf, sf_size, &decerr);
-  sfd_ctx = sfd_info->sfd_ctx;
+  if (sfd_ctx == NULL)
+    sfd_ctx = sframe_decode ((const char*)sfbuf, sf_size, &decerr);
+  sfd_info->sfd_ctx = sfd_ctx;
   if (!sfd_ctx)
     /* Free'ing up any memory held by decoder context is done by
        sframe_decode in case of error.  */
@@ -245,6 +257,119 @@ success:
   return true;
 }
 
+/* The state shared by the threads decoding .sframe sections.  */
+
+struct sframe_decode_job
+{
+  asection **secs;
+  struct sframe_decoder_ctx **ctxs;
+
+  /* Serialises reading the sections.  */
+  bfd_mutex io_lock;
+};
+
+/* Read and decode input .sframe sections START to END of JOB.  A section
+   that can't be read or decoded is left for _bfd_elf_parse_sframe to
+   try again and report.  Worker for _bfd_parallel_for.  */
+
+static bool
+sframe_decode_range (void *data, size_t start, size_t end)
+{
+  struct sframe_decode_job *job = (struct sframe_decode_job *) data;
+
+  for (; start < end; start++)
+    {
+      asection *sec = job->secs[start];
+      bfd_byte *sfbuf = NULL;
+      bool ok;
+      int decerr = 0;
+
+      _bfd_mutex_lock (&job->io_lock);
+      ok = bfd_malloc_and_get_section (sec->owner, sec, &sfbuf);
+      _bfd_mutex_unlock (&job->io_lock);
+      if (ok)
+	job->ctxs[start] = sframe_decode ((const char *) sfbuf, sec->size,
+					  &decerr);
+      free (sfbuf);
+    }
+  return true;
+}
+
+/* Decode the input .sframe sections of the output section OSEC ahead of
+   _bfd_elf_parse_sframe, on as many threads as bfd_set_thread_count
+   allows.  Only the reading and decoding is done here; the sections are
+   still set up one at a time, in order, when _bfd_elf_parse_sframe is
+   called for them.  Returns FALSE on failure to allocate memory.  */
+
+bool
+_bfd_elf_decode_sframe_sections (struct bfd_link_info *info, asection *osec)
+{
+  struct sframe_enc_info *sfe_info = &elf_hash_table (info)->sfe_info;
+  struct sframe_decode_job job;
+  unsigned int count;
+  asection *sec;
+
+  if (bfd_get_thread_count () <= 1)
+    return true;
+
+  count = 0;
+  for (sec = osec->map_head.s; sec != NULL; sec = sec->map_head.s)
+    count++;
+  if (count < 2)
+    return true;
+
+  job.secs = (asection **) bfd_malloc (count * sizeof (*job.secs));
+  job.ctxs = (struct sframe_decoder_ctx **)
+    bfd_zmalloc (count * sizeof (*job.ctxs));
+  if (job.secs == NULL || job.ctxs == NULL)
+    {
+      free (job.secs);
+      free (job.ctxs);
+      return false;
+    }
+
+  /* Pick out the sections that _bfd_elf_parse_sframe will decode.  */
+  count = 0;
+  for (sec = osec->map_head.s; sec != NULL; sec = sec->map_head.s)
+    if (sec->size != 0
+	&& bfd_get_flavour (sec->owner) == bfd_target_elf_flavour
+	&& (sec->flags & SEC_HAS_CONTENTS) != 0
+	&& sec->sec_info_type == SEC_INFO_TYPE_NONE
+	&& !bfd_is_abs_section (sec->output_section))
+      job.secs[count++] = sec;
+
+  memset (&job.io_lock, 0, sizeof (job.io_lock));
+  _bfd_parallel_for (count, 1, sframe_decode_range, &job);
+  _bfd_mutex_destroy (&job.io_lock);
+
+  _bfd_elf_free_decoded_sframe_sections (info);
+  sfe_info->pre_secs = job.secs;
+  sfe_info->pre_ctxs = job.ctxs;
+  sfe_info->pre_count = count;
+  sfe_info->pre_next = 0;
+  return true;
+}
+
+/* Free whatever _bfd_elf_decode_sframe_sections decoded that has not
+   been used by _bfd_elf_parse_sframe.  */
+
+void
+_bfd_elf_free_decoded_sframe_sections (struct bfd_link_info *info)
+{
+  struct sframe_enc_info *sfe_info = &elf_hash_table (info)->sfe_info;
+  unsigned int i;
+
+  for (i = 0; i < sfe_info->pre_count; i++)
+    if (sfe_info->pre_ctxs[i] != NULL)
+      sframe_decoder_free (&sfe_info->pre_ctxs[i]);
+  free (sfe_info->pre_secs);
+  free (sfe_info->pre_ctxs);
+  sfe_info->pre_secs = NULL;
+  sfe_info->pre_ctxs = NULL;
+  sfe_info->pre_count = 0;
+  sfe_info->pre_next = 0;
+}
+
 /* This function is called for each input file before the .sframe section
    is relocated.  It marks the SFrame FDE for the discarded functions for
    deletion.
@@ -312,6 +437,36 @@ _bfd_elf_set_section_sframe (bfd *abfd,
   return true;
 }
 
+/* Collect SIZE bytes of encoded FREs from BUF for the output .sframe
+   section described by DATA.  The encoder hands them over as they are
+   added, so that only their encoded form is kept.  */
+
+static int
+sframe_collect_fres (void *data, const char *buf, size_t size)
+{
+  struct sframe_enc_info *sfe_info = (struct sframe_enc_info *) data;
+
+  if (size > sfe_info->fre_alloced - sfe_info->fre_size)
+    {
+      bfd_size_type amt = sfe_info->fre_alloced;
+      bfd_byte *fres;
+
+      if (amt == 0)
+	amt = 4096;
+      while (size > amt - sfe_info->fre_size)
+	amt *= 2;
+      fres = (bfd_byte *) bfd_realloc (sfe_info->fre_contents, amt);
+      if (fres == NULL)
+	return -1;
+      sfe_info->fre_contents = fres;
+      sfe_info->fre_alloced = amt;
+    }
+
+  memcpy (sfe_info->fre_contents + sfe_info->fre_size, buf, size);
+  sfe_info->fre_size += size;
+  return 0;
+}
+
 /* Merge .sframe section SEC.  This is called with the relocated
    CONTENTS.  */
 
@@ -370,6 +525,10 @@ _bfd_elf_merge_section_sframe (bfd *abfd,
       /* Handle errors from sframe_encode.  */
       if (htab->sfe_info.sfe_ctx == NULL)
 	return false;
+      if (sframe_encoder_set_fre_sink (htab->sfe_info.sfe_ctx,
+				       sframe_collect_fres,
+				       &htab->sfe_info) != 0)
+	return false;
     }
   sfe_ctx = sfe_info->sfe_ctx;
 
@@ -400,13 +559,21 @@ _bfd_elf_merge_section_sframe (bfd *abfd,
       return false;
     }
 
-  /* Iterate over the function descriptor entries and the FREs of the
-     function from the decoder context.  Add each of them to the encoder
-     context, if suitable.  */
-  unsigned int i = 0, j = 0, cur_fidx = 0;
-
+  /* Work out the output start address of each function descriptor entry
+     from the decoder context, then add those that are kept, with their
+     FREs, to the encoder context in one go.  */
+  unsigned int i = 0;
   unsigned int num_fidx = sframe_decoder_get_num_fidx (sfd_ctx);
-  unsigned int num_enc_fidx = sframe_encoder_get_num_fidx (sfe_ctx);
+  int32_t *start_addrs = NULL;
+  unsigned char *skip = NULL;
+
+  if (num_fidx != 0)
+    {
+      start_addrs = (int32_t *) bfd_malloc (num_fidx * (sizeof (int32_t) + 1));
+      if (start_addrs == NULL)
+	return false;
+      skip = (unsigned char *) (start_addrs + num_fidx);
+    }
 
   for (i = 0; i < num_fidx; i++)
     {
@@ -419,6 +586,7 @@ _bfd_elf_merge_section_sframe (bfd *abfd,
       bool pltn_reloc_by_hand = false;
       unsigned int pltn_r_offset = 0;
 
+      skip[i] = 1;
       if (!sframe_decoder_get_funcdesc (sfd_ctx, i, &num_fres, &func_size,
 					&func_start_address, &func_info))
 	{
@@ -474,26 +642,16 @@ _bfd_elf_merge_section_sframe (bfd *abfd,
 	      func_start_address = address;
 	    }
 
-	  /* Update the encoder context with updated content.  */
-	  int err = sframe_encoder_add_funcdesc (sfe_ctx, func_start_address,
-						 func_size, func_info,
-						 num_fres);
-	  cur_fidx++;
-	  BFD_ASSERT (!err);
-	}
-
-      for (j = 0; j < num_fres; j++)
-	{
-	  sframe_frame_row_entry fre;
-	  if (!sframe_decoder_get_fre (sfd_ctx, i, j, &fre))
-	    {
-	      int err = sframe_encoder_add_fre (sfe_ctx,
-						cur_fidx-1+num_enc_fidx,
-						&fre);
-	      BFD_ASSERT (!err);
-	    }
+	  start_addrs[i] = func_start_address;
+	  skip[i] = 0;
 	}
     }
+
+  /* Update the encoder context with updated content.  */
+  int err = sframe_encoder_add_decoder (sfe_ctx, sfd_ctx, start_addrs, skip);
+  BFD_ASSERT (!err);
+  free (start_addrs);
+
   /* Free the SFrame decoder context.  */
   sframe_decoder_free (&sfd_ctx);
 
@@ -525,12 +683,21 @@ _bfd_elf_write_section_sframe (bfd *abfd, struct bfd_link_info *info)
   if (sec == NULL)
     return true;
 
+  /* This gives just the header and the FDE table.  The FREs that
+     follow were collected by sframe_collect_fres.  */
   contents = sframe_encoder_write (sfe_ctx, &sec_size, &err);
-  sec->size = (bfd_size_type) sec_size;
-
-  if (!bfd_set_section_contents (abfd, sec->output_section, contents,
-				 (file_ptr) sec->output_offset,
-				 sec->size))
+  sec->size = (bfd_size_type) sec_size + sfe_info->fre_size;
+
+  if (contents == NULL
+      || !bfd_set_section_contents (abfd, sec->output_section, contents,
+				    (file_ptr) sec->output_offset,
+				    sec_size)
+      || (sfe_info->fre_size != 0
+	  && !bfd_set_section_contents (abfd, sec->output_section,
+					sfe_info->fre_contents,
+					(file_ptr) (sec->output_offset
+						    + sec_size),
+					sfe_info->fre_size)))
     retval = false;
   else if (!bfd_link_relocatable (info))
     {
@@ -541,6 +708,11 @@ _bfd_elf_write_section_sframe (bfd *abfd, struct bfd_link_info *info)
      contents have not been relocated.  */
 
   sframe_encoder_free (&sfe_ctx);
+  sfe_info->sfe_ctx = NULL;
+  free (sfe_info->fre_contents);
+  sfe_info->fre_contents = NULL;
+  sfe_info->fre_size = 0;
+  sfe_info->fre_alloced = 0;
 
   return retval;
 }
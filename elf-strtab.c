@@ -107,6 +107,10 @@ _bfd_elf_strtab_init (void)
       free (table);
       return NULL;
     }
+  /* Dynamic string tables can get large; an index without one still
+     works, just more slowly.  */
+  bfd_hash_table_set_layout (&table->table, bfd_hash_open);
+  bfd_hash_table_set_memory_class (&table->table, bfd_memory_strtab);
 
   table->sec_size = 0;
   table->size = 1;
@@ -130,30 +134,20 @@ _bfd_elf_strtab_init (void)
 void
 _bfd_elf_strtab_free (struct elf_strtab_hash *tab)
 {
+  _bfd_hash_table_report (&tab->table, "ELF string table", NULL);
   bfd_hash_table_free (&tab->table);
   free (tab->array);
   free (tab);
 }
 
-/* Get the index of an entity in a hash table, adding it if it is not
-   already present.  */
+/* Give ENTRY, just looked up in TAB, an index if it doesn't have one,
+   and return that index.  */
 
-size_t
-_bfd_elf_strtab_add (struct elf_strtab_hash *tab,
-		     const char *str,
-		     bool copy)
+static size_t
+elf_strtab_add_entry (struct elf_strtab_hash *tab,
+		      struct elf_strtab_hash_entry *entry,
+		      const char *str)
 {
-  register struct elf_strtab_hash_entry *entry;
-
-  /* We handle this specially, since we don't want to do refcounting
-     on it.  */
-  if (*str == '\0')
-    return 0;
-
-  BFD_ASSERT (tab->sec_size == 0);
-  entry = (struct elf_strtab_hash_entry *)
-	  bfd_hash_lookup (&tab->table, str, true, copy);
-
   if (entry == NULL)
     return (size_t) -1;
 
@@ -179,6 +173,51 @@ _bfd_elf_strtab_add (struct elf_strtab_hash *tab,
   return entry->u.index;
 }
 
+/* Get the index of an entity in a hash table, adding it if it is not
+   already present.  */
+
+size_t
+_bfd_elf_strtab_add (struct elf_strtab_hash *tab,
+		     const char *str,
+		     bool copy)
+{
+  struct elf_strtab_hash_entry *entry;
+
+  /* We handle this specially, since we don't want to do refcounting
+     on it.  */
+  if (*str == '\0')
+    return 0;
+
+  BFD_ASSERT (tab->sec_size == 0);
+  entry = (struct elf_strtab_hash_entry *)
+	  bfd_hash_lookup (&tab->table, str, true, copy);
+  return elf_strtab_add_entry (tab, entry, str);
+}
+
+/* Likewise, but HASH is the hash code of STR under FUNC, as already
+   computed for some other table.  The hash is only recomputed if TAB
+   uses a different function.  */
+
+size_t
+_bfd_elf_strtab_add_with_hash (struct elf_strtab_hash *tab,
+			       const char *str,
+			       unsigned long long hash,
+			       enum bfd_hash_function func,
+			       bool copy)
+{
+  struct elf_strtab_hash_entry *entry;
+
+  if (*str == '\0')
+    return 0;
+
+  BFD_ASSERT (tab->sec_size == 0);
+  if (bfd_hash_table_function (&tab->table) != func)
+    hash = bfd_hash_string_hash (str, bfd_hash_table_function (&tab->table));
+  entry = (struct elf_strtab_hash_entry *)
+	  bfd_hash_lookup_with_hash (&tab->table, str, hash, true, copy);
+  return elf_strtab_add_entry (tab, entry, str);
+}
+
 void
 _bfd_elf_strtab_addref (struct elf_strtab_hash *tab, size_t idx)
 {
@@ -313,8 +352,38 @@ bool
 _bfd_elf_strtab_emit (register bfd *abfd, struct elf_strtab_hash *tab)
 {
   bfd_size_type off = 1;
+  bfd_byte *buf;
   size_t i;
 
+  /* Build the whole table in memory and write it in one go, rather
+     than writing each string separately, if there is room.  */
+  buf = NULL;
+  if (tab->sec_size != 0)
+    buf = (bfd_byte *) bfd_malloc (tab->sec_size);
+  if (buf != NULL)
+    {
+      bool ret;
+
+      buf[0] = 0;
+      for (i = 1; i < tab->size; ++i)
+	{
+	  int len;
+
+	  BFD_ASSERT (tab->array[i]->refcount == 0);
+	  len = tab->array[i]->len;
+	  if (len < 0)
+	    continue;
+	  if (off + len > tab->sec_size)
+	    break;
+	  memcpy (buf + off, tab->array[i]->root.string, len);
+	  off += len;
+	}
+      BFD_ASSERT (off == tab->sec_size);
+      ret = bfd_bwrite (buf, off, abfd) == off;
+      free (buf);
+      return ret;
+    }
+
   if (bfd_bwrite ("", 1, abfd) != 1)
     return false;
 
@@ -365,6 +434,136 @@ strrevcmp (const void *a, const void *b)
   return lenA - lenB;
 }
 
+/* The DEPTHth byte of E counting back from its end, or -1 past its
+   start.  Ordering by these keys in turn is the order of strrevcmp.  */
+
+static inline int
+strtab_rev_key (const struct elf_strtab_hash_entry *e, unsigned int depth)
+{
+  if (depth >= (unsigned int) e->len)
+    return -1;
+  return (unsigned char) e->root.string[e->len - 1 - depth];
+}
+
+/* A slice of the array left to sort, all of whose entries have the
+   same first DEPTH keys.  */
+
+struct strtab_sort_range
+{
+  size_t lo, n;
+  unsigned int depth;
+};
+
+/* Sort the N entries of ARRAY as qsort with strrevcmp would, by
+   three-way radix quicksort on strtab_rev_key.  Return false if out
+   of memory.  */
+
+static bool
+strtab_sort (struct elf_strtab_hash_entry **array, size_t n)
+{
+  struct strtab_sort_range *stack = NULL, *r;
+  size_t sp = 0, alloc = 0;
+
+  if (n < 2)
+    return true;
+
+  alloc = 64;
+  stack = (struct strtab_sort_range *) bfd_malloc (alloc * sizeof (*stack));
+  if (stack == NULL)
+    return false;
+  stack[sp].lo = 0;
+  stack[sp].n = n;
+  stack[sp].depth = 0;
+  sp++;
+
+  while (sp != 0)
+    {
+      struct elf_strtab_hash_entry **b, *t;
+      size_t i, j, lt, gt, lo;
+      unsigned int depth;
+      int v;
+
+      sp--;
+      lo = stack[sp].lo;
+      b = array + lo;
+      n = stack[sp].n;
+      depth = stack[sp].depth;
+
+      if (n < 16)
+	{
+	  for (i = 1; i < n; i++)
+	    for (j = i; j > 0 && strrevcmp (&b[j - 1], &b[j]) > 0; j--)
+	      {
+		t = b[j];
+		b[j] = b[j - 1];
+		b[j - 1] = t;
+	      }
+	  continue;
+	}
+
+      v = strtab_rev_key (b[n / 2], depth);
+      lt = i = 0;
+      gt = n;
+      while (i < gt)
+	{
+	  int k = strtab_rev_key (b[i], depth);
+
+	  if (k < v)
+	    {
+	      t = b[lt];
+	      b[lt++] = b[i];
+	      b[i++] = t;
+	    }
+	  else if (k > v)
+	    {
+	      t = b[--gt];
+	      b[gt] = b[i];
+	      b[i] = t;
+	    }
+	  else
+	    i++;
+	}
+
+      /* At most three new slices replace the one taken off.  */
+      if (sp + 3 > alloc)
+	{
+	  alloc *= 2;
+	  r = (struct strtab_sort_range *)
+	    bfd_realloc (stack, alloc * sizeof (*stack));
+	  if (r == NULL)
+	    {
+	      free (stack);
+	      return false;
+	    }
+	  stack = r;
+	}
+      if (lt > 1)
+	{
+	  stack[sp].lo = lo;
+	  stack[sp].n = lt;
+	  stack[sp].depth = depth;
+	  sp++;
+	}
+      if (n - gt > 1)
+	{
+	  stack[sp].lo = lo + gt;
+	  stack[sp].n = n - gt;
+	  stack[sp].depth = depth;
+	  sp++;
+	}
+      if (v != -1 && gt - lt > 1)
+	{
+	  stack[sp].lo = lo + lt;
+	  stack[sp].n = gt - lt;
+	  stack[sp].depth = depth + 1;
+	  sp++;
+	}
+    }
+
+  free (stack);
+  return true;
+}
+
 static inline int
 is_suffix (const struct elf_strtab_hash_entry *A,
 	   const struct elf_strtab_hash_entry *B)
@@ -411,7 +610,9 @@ _bfd_elf_strtab_finalize (struct elf_strtab_hash *tab)
   size = a - array;
   if (size != 0)
     {
-      qsort (array, size, sizeof (struct elf_strtab_hash_entry *), strrevcmp);
+      if (!strtab_sort (array, size))
+	qsort (array, size, sizeof (struct elf_strtab_hash_entry *),
+	       strrevcmp);
 
       /* Loop over the sorted array and merge suffixes.  Start from the
 	 end because we want eg.
@@ -50,6 +50,7 @@ SECTION
 #endif
 
 static int elf_sort_sections (const void *, const void *);
+static void elf_sort_section_array (asection **, size_t);
 static bool assign_file_positions_except_relocs (bfd *, struct bfd_link_info *);
 static bool swap_out_syms (bfd *, struct elf_strtab_hash **, int,
 			   struct bfd_link_info *);
@@ -285,6 +286,20 @@ bfd_elf_get_str_section (bfd *abfd, unsigned int shindex)
       offset = i_shdrp[shindex]->sh_offset;
       shstrtabsize = i_shdrp[shindex]->sh_size;
 
+      /* A table that ends in a NUL, as it should, is used in place,
+	 mapped when large, rather than copied.  Strings are only ever
+	 read from it.  */
+      if (shstrtabsize != 0 && abfd->direction == read_direction)
+	{
+	  const bfd_byte *view = _bfd_file_view (abfd, offset, shstrtabsize);
+
+	  if (view != NULL && view[shstrtabsize - 1] == '\0')
+	    {
+	      i_shdrp[shindex]->contents = (bfd_byte *) view;
+	      return (char *) view;
+	    }
+	}
+
       /* Allocate and clear an extra byte at the end, to prevent crashes
 	 in case the string table is not terminated.  */
       if (shstrtabsize + 1 <= 1
@@ -361,6 +376,38 @@ bfd_elf_string_from_elf_section (bfd *abfd,
   return ((char *) hdr->contents) + strindex;
 }
 
+/* Return the SHT_SYMTAB_SHNDX section header that goes with the symbol
+   table SYMTAB_HDR of ABFD, or NULL if there is none.  */
+
+static Elf_Internal_Shdr *
+elf_symtab_shndx_hdr (bfd *abfd, Elf_Internal_Shdr *symtab_hdr)
+{
+  elf_section_list *entry;
+  Elf_Internal_Shdr **sections = elf_elfsections (abfd);
+
+  if (elf_symtab_shndx_list (abfd) == NULL)
+    return NULL;
+
+  /* Find an index section that is linked to this symtab section.  */
+  for (entry = elf_symtab_shndx_list (abfd); entry != NULL; entry = entry->next)
+    {
+      /* PR 20063.  */
+      if (entry->hdr.sh_link >= elf_numsections (abfd))
+	continue;
+
+      if (sections[entry->hdr.sh_link] == symtab_hdr)
+	return &entry->hdr;
+    }
+
+  if (symtab_hdr == &elf_symtab_hdr (abfd))
+    /* Not really accurate, but this was how the old code used
+       to work.  */
+    return &elf_symtab_shndx_list (abfd)->hdr;
+  /* Otherwise we do nothing.  The assumption is that
+     the index table will not be needed.  */
+  return NULL;
+}
+
 /* Read and convert symbols to internal format.
    SYMCOUNT specifies the number of symbols to read, starting from
    symbol SYMOFFSET.  If any of INTSYM_BUF, EXTSYM_BUF or EXTSHNDX_BUF
@@ -390,6 +437,8 @@ bfd_elf_get_elf_syms (bfd *ibfd,
   size_t extsym_size;
   size_t amt;
   file_ptr pos;
+  struct bfd_read_range ranges[2];
+  unsigned int nranges;
 
   if (bfd_get_flavour (ibfd) != bfd_target_elf_flavour)
     abort ();
@@ -398,36 +447,7 @@ bfd_elf_get_elf_syms (bfd *ibfd,
     return intsym_buf;
 
   /* Normal syms might have section extension entries.  */
-  shndx_hdr = NULL;
-  if (elf_symtab_shndx_list (ibfd) != NULL)
-    {
-      elf_section_list * entry;
-      Elf_Internal_Shdr **sections = elf_elfsections (ibfd);
-
-      /* Find an index section that is linked to this symtab section.  */
-      for (entry = elf_symtab_shndx_list (ibfd); entry != NULL; entry = entry->next)
-	{
-	  /* PR 20063.  */
-	  if (entry->hdr.sh_link >= elf_numsections (ibfd))
-	    continue;
-
-	  if (sections[entry->hdr.sh_link] == symtab_hdr)
-	    {
-	      shndx_hdr = & entry->hdr;
-	      break;
-	    };
-	}
-
-      if (shndx_hdr == NULL)
-	{
-	  if (symtab_hdr == &elf_symtab_hdr (ibfd))
-	    /* Not really accurate, but this was how the old code used
-	       to work.  */
-	    shndx_hdr = &elf_symtab_shndx_list (ibfd)->hdr;
-	  /* Otherwise we do nothing.  The assumption is that
-	     the index table will not be needed.  */
-	}
-    }
+  shndx_hdr = elf_symtab_shndx_hdr (ibfd, symtab_hdr);
 
   /* Read the symbols.  */
   alloc_ext = NULL;
@@ -447,13 +467,15 @@ bfd_elf_get_elf_syms (bfd *ibfd,
       alloc_ext = bfd_malloc (amt);
       extsym_buf = alloc_ext;
     }
-  if (extsym_buf == NULL
-      || bfd_seek (ibfd, pos, SEEK_SET) != 0
-      || bfd_bread (extsym_buf, amt, ibfd) != amt)
+  if (extsym_buf == NULL)
     {
       intsym_buf = NULL;
       goto out;
     }
+  ranges[0].offset = pos;
+  ranges[0].size = amt;
+  ranges[0].buf = extsym_buf;
+  nranges = 1;
 
   if (shndx_hdr == NULL || shndx_hdr->sh_size == 0)
     extshndx_buf = NULL;
@@ -471,13 +493,23 @@ bfd_elf_get_elf_syms (bfd *ibfd,
 	  alloc_extshndx = (Elf_External_Sym_Shndx *) bfd_malloc (amt);
 	  extshndx_buf = alloc_extshndx;
 	}
-      if (extshndx_buf == NULL
-	  || bfd_seek (ibfd, pos, SEEK_SET) != 0
-	  || bfd_bread (extshndx_buf, amt, ibfd) != amt)
+      if (extshndx_buf == NULL)
 	{
 	  intsym_buf = NULL;
 	  goto out;
 	}
+      ranges[1].offset = pos;
+      ranges[1].size = amt;
+      ranges[1].buf = extshndx_buf;
+      nranges = 2;
+    }
+
+  /* Fetch the symbols and their section index extensions with one
+     request.  */
+  if (!bfd_bread_vector (ibfd, ranges, nranges))
+    {
+      intsym_buf = NULL;
+      goto out;
     }
 
   if (intsym_buf == NULL)
@@ -546,6 +578,659 @@ bfd_elf_sym_name (bfd *abfd,
   return name;
 }
 
+/* Fill in SYM, a zeroed BFD symbol of ABFD, from the ELF symbol ISYM.
+   NAME is the name of the symbol and XVER its version, or NULL.
+   DYNAMIC is true if ISYM is from the dynamic symbol table.  Return
+   FALSE on error.  */
+
+bool
+_bfd_elf_make_symbol (bfd *abfd,
+		      const Elf_Internal_Sym *isym,
+		      const char *name,
+		      const Elf_External_Versym *xver,
+		      bool dynamic,
+		      elf_symbol_type *sym)
+{
+  const struct elf_backend_data *ebd = get_elf_backend_data (abfd);
+
+  sym->internal_elf_sym.st_value = isym->st_value;
+  sym->internal_elf_sym.st_size = isym->st_size;
+  sym->internal_elf_sym.st_name = isym->st_name;
+  sym->internal_elf_sym.st_shndx = isym->st_shndx;
+  sym->internal_elf_sym.st_info = isym->st_info;
+  sym->internal_elf_sym.st_other = isym->st_other;
+  sym->internal_elf_sym.st_target_internal = isym->st_target_internal;
+
+  sym->symbol.the_bfd = abfd;
+  sym->symbol.name = name;
+  sym->symbol.value = isym->st_value;
+
+  if (isym->st_shndx == SHN_UNDEF)
+    {
+      sym->symbol.section = bfd_und_section_ptr;
+    }
+  else if (isym->st_shndx == SHN_ABS)
+    {
+      sym->symbol.section = bfd_abs_section_ptr;
+    }
+  else if (isym->st_shndx == SHN_COMMON)
+    {
+      sym->symbol.section = bfd_com_section_ptr;
+      if ((abfd->flags & BFD_PLUGIN) != 0)
+	{
+	  asection *xc = bfd_get_section_by_name (abfd, "COMMON");
+
+	  if (xc == NULL)
+	    {
+	      flagword flags = (SEC_ALLOC | SEC_IS_COMMON | SEC_KEEP
+				| SEC_EXCLUDE);
+	      xc = bfd_make_section_with_flags (abfd, "COMMON", flags);
+	      if (xc == NULL)
+		return false;
+	    }
+	  sym->symbol.section = xc;
+	}
+      /* Elf puts the alignment into the `value' field, and
+	 the size into the `size' field.  BFD wants to see the
+	 size in the value field, and doesn't care (at the
+	 moment) about the alignment.  */
+      sym->symbol.value = isym->st_size;
+    }
+  else
+    {
+      sym->symbol.section
+	= bfd_section_from_elf_index (abfd, isym->st_shndx);
+      if (sym->symbol.section == NULL)
+	{
+	  /* This symbol is in a section for which we did not
+	     create a BFD section.  Just use bfd_abs_section,
+	     although it is wrong.  FIXME.  Note - there is
+	     code in elf.c:swap_out_syms that calls
+	     symbol_section_index() in the elf backend for
+	     cases like this.  */
+	  sym->symbol.section = bfd_abs_section_ptr;
+	}
+    }
+
+  /* If this is a relocatable file, then the symbol value is
+     already section relative.  */
+  if ((abfd->flags & (EXEC_P | DYNAMIC)) != 0)
+    sym->symbol.value -= sym->symbol.section->vma;
+
+  switch (ELF_ST_BIND (isym->st_info))
+    {
+    case STB_LOCAL:
+      sym->symbol.flags |= BSF_LOCAL;
+      break;
+    case STB_GLOBAL:
+      if (isym->st_shndx != SHN_UNDEF && isym->st_shndx != SHN_COMMON)
+	sym->symbol.flags |= BSF_GLOBAL;
+      break;
+    case STB_WEAK:
+      sym->symbol.flags |= BSF_WEAK;
+      break;
+    case STB_GNU_UNIQUE:
+      sym->symbol.flags |= BSF_GNU_UNIQUE;
+      break;
+    }
+
+  switch (ELF_ST_TYPE (isym->st_info))
+    {
+    case STT_SECTION:
+      /* Mark the input section symbol as used since it may be
+	 used for relocation and section group.
+	 NB: BSF_SECTION_SYM_USED is ignored by linker and may
+	 be cleared by objcopy for non-relocatable inputs.  */
+      sym->symbol.flags |= (BSF_SECTION_SYM
+			    | BSF_DEBUGGING
+			    | BSF_SECTION_SYM_USED);
+      break;
+    case STT_FILE:
+      sym->symbol.flags |= BSF_FILE | BSF_DEBUGGING;
+      break;
+    case STT_FUNC:
+      sym->symbol.flags |= BSF_FUNCTION;
+      break;
+    case STT_COMMON:
+      /* FIXME: Do we have to put the size field into the value field
+	 as we do with symbols in SHN_COMMON sections (see above) ?  */
+      sym->symbol.flags |= BSF_ELF_COMMON;
+      /* Fall through.  */
+    case STT_OBJECT:
+      sym->symbol.flags |= BSF_OBJECT;
+      break;
+    case STT_TLS:
+      sym->symbol.flags |= BSF_THREAD_LOCAL;
+      break;
+    case STT_RELC:
+      sym->symbol.flags |= BSF_RELC;
+      break;
+    case STT_SRELC:
+      sym->symbol.flags |= BSF_SRELC;
+      break;
+    case STT_GNU_IFUNC:
+      sym->symbol.flags |= BSF_GNU_INDIRECT_FUNCTION;
+      break;
+    }
+
+  if (dynamic)
+    sym->symbol.flags |= BSF_DYNAMIC;
+
+  if (xver != NULL)
+    {
+      Elf_Internal_Versym iversym;
+
+      _bfd_elf_swap_versym_in (abfd, xver, &iversym);
+      sym->internal_elf_sym.st_version = iversym.vs_vers;
+    }
+
+  /* Do some backend-specific processing on this symbol.  */
+  if (ebd->elf_backend_symbol_processing)
+    (*ebd->elf_backend_symbol_processing) (abfd, &sym->symbol);
+  return true;
+}
+
+/* Set up VIEW to read the symbol table of ABFD, or its dynamic symbol
+   table if DYNAMIC, in place.  The raw symbols, their section index
+   extensions, versions and names are mapped or read once, and belong
+   to ABFD; nothing is converted until asked for.  Unlike
+   bfd_canonicalize_symtab this costs no memory per symbol, which
+   matters when only a few symbols of a large file are wanted.  Return
+   FALSE on error.  */
+
+bool
+bfd_elf_symbol_view_init (bfd *abfd, bool dynamic,
+			  struct elf_symbol_view *view)
+{
+  const struct elf_backend_data *bed;
+  Elf_Internal_Shdr *hdr;
+  Elf_Internal_Shdr *shndx_hdr;
+  Elf_Internal_Shdr *strhdr;
+  size_t count;
+
+  memset (view, 0, sizeof (*view));
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour)
+    {
+      bfd_set_error (bfd_error_wrong_format);
+      return false;
+    }
+
+  bed = get_elf_backend_data (abfd);
+  hdr = dynamic ? &elf_tdata (abfd)->dynsymtab_hdr : &elf_symtab_hdr (abfd);
+  view->abfd = abfd;
+  view->hdr = hdr;
+  view->dynamic = dynamic;
+  view->sizeof_sym = bed->s->sizeof_sym;
+  count = hdr->sh_size / bed->s->sizeof_sym;
+  if (count == 0)
+    return true;
+
+  view->syms = hdr->contents;
+  if (view->syms == NULL)
+    view->syms = _bfd_file_view (abfd, hdr->sh_offset,
+				 count * bed->s->sizeof_sym);
+  if (view->syms == NULL)
+    return false;
+
+  if (!dynamic)
+    {
+      shndx_hdr = elf_symtab_shndx_hdr (abfd, hdr);
+      if (shndx_hdr != NULL && shndx_hdr->sh_size != 0)
+	{
+	  if (shndx_hdr->sh_size / sizeof (Elf_External_Sym_Shndx) < count)
+	    {
+	      bfd_set_error (bfd_error_bad_value);
+	      return false;
+	    }
+	  view->shndx = _bfd_file_view (abfd, shndx_hdr->sh_offset,
+					shndx_hdr->sh_size);
+	  if (view->shndx == NULL)
+	    return false;
+	}
+    }
+  else if (elf_dynversym (abfd) != 0)
+    {
+      Elf_Internal_Shdr *verhdr = &elf_tdata (abfd)->dynversym_hdr;
+
+      /* As in elf_slurp_symbol_table, do without versions that don't
+	 match the symbols.  */
+      if (verhdr->sh_size / sizeof (Elf_External_Versym) == count)
+	{
+	  view->versym = _bfd_file_view (abfd, verhdr->sh_offset,
+					 verhdr->sh_size);
+	  if (view->versym == NULL)
+	    return false;
+	}
+    }
+
+  if (hdr->sh_link >= elf_numsections (abfd))
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+  strhdr = elf_elfsections (abfd)[hdr->sh_link];
+  if (strhdr->sh_type != SHT_STRTAB || strhdr->sh_size == 0)
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+  view->strtab = (const char *) strhdr->contents;
+  if (view->strtab == NULL)
+    {
+      view->strtab = (const char *) _bfd_file_view (abfd, strhdr->sh_offset,
+						    strhdr->sh_size);
+      /* Names are used in place, so the table must end in a NUL.
+	 If it doesn't, take the copy bfd_elf_get_str_section makes,
+	 which does.  */
+      if (view->strtab != NULL
+	  && view->strtab[strhdr->sh_size - 1] != '\0')
+	view->strtab = bfd_elf_get_str_section (abfd, hdr->sh_link);
+      if (view->strtab == NULL)
+	return false;
+    }
+  view->strtab_size = strhdr->sh_size;
+  view->count = count;
+  return true;
+}
+
+/* Swap symbol IDX of VIEW into ISYM.  Return FALSE if IDX is out of
+   range or the symbol is bad.  */
+
+bool
+bfd_elf_symbol_view_get (const struct elf_symbol_view *view, size_t idx,
+			 Elf_Internal_Sym *isym)
+{
+  const struct elf_backend_data *bed;
+  const bfd_byte *shndx = NULL;
+
+  if (idx >= view->count)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+  bed = get_elf_backend_data (view->abfd);
+  if (view->shndx != NULL)
+    shndx = view->shndx + idx * sizeof (Elf_External_Sym_Shndx);
+  if (!(*bed->s->swap_symbol_in) (view->abfd,
+				  view->syms + idx * view->sizeof_sym,
+				  shndx, isym))
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+  return true;
+}
+
+/* Return the name of the symbol whose st_name is INAME in VIEW, or
+   NULL if INAME is out of range.  */
+
+static inline const char *
+elf_symbol_view_string (const struct elf_symbol_view *view,
+			unsigned long long iname)
+{
+  if (iname >= view->strtab_size)
+    return NULL;
+  return view->strtab + iname;
+}
+
+/* Return the name of symbol IDX of VIEW, as bfd_elf_sym_name would,
+   without converting the rest of the symbol.  The name lives as long
+   as the BFD.  */
+
+const char *
+bfd_elf_symbol_view_name (const struct elf_symbol_view *view, size_t idx)
+{
+  const bfd_byte *esym;
+  unsigned long long iname;
+  const char *name;
+
+  if (idx >= view->count)
+    return "(null)";
+  /* st_name is the first field of both ELF32 and ELF64 symbols.  */
+  esym = view->syms + idx * view->sizeof_sym;
+  iname = bfd_h_get_32 (view->abfd, esym);
+  if (iname == 0)
+    {
+      Elf_Internal_Sym isym;
+
+      /* Section symbols are named after their section.  */
+      if (!bfd_elf_symbol_view_get (view, idx, &isym))
+	return "(null)";
+      if (ELF_ST_TYPE (isym.st_info) == STT_SECTION)
+	return bfd_elf_sym_name (view->abfd, view->hdr, &isym, NULL);
+    }
+  name = elf_symbol_view_string (view, iname);
+  return name != NULL ? name : "(null)";
+}
+
+/* Return the index of the first symbol of VIEW at or after START
+   called NAME, or zero if there is none.  Only the names of the
+   symbols are looked at, so this is a scan of the raw table and
+   allocates nothing.  Pass one more than the last index returned to
+   find further symbols of the same name.  */
+
+size_t
+bfd_elf_symbol_view_find (const struct elf_symbol_view *view,
+			  const char *name, size_t start)
+{
+  size_t idx;
+  const bfd_byte *esym;
+
+  /* Symbol zero is the null symbol.  */
+  if (start == 0)
+    start = 1;
+  if (*name == '\0')
+    return 0;
+  for (idx = start, esym = view->syms + start * view->sizeof_sym;
+       idx < view->count;
+       idx++, esym += view->sizeof_sym)
+    {
+      const char *sname;
+
+      sname = elf_symbol_view_string (view, bfd_h_get_32 (view->abfd, esym));
+      if (sname != NULL && strcmp (sname, name) == 0)
+	return idx;
+    }
+  return 0;
+}
+
+/* Make a BFD symbol for symbol IDX of VIEW, the same as the one
+   bfd_canonicalize_symtab would return for it.  The symbol is
+   allocated in the memory of the BFD.  Return NULL on error.  */
+
+asymbol *
+bfd_elf_symbol_view_asymbol (const struct elf_symbol_view *view, size_t idx)
+{
+  bfd *abfd = view->abfd;
+  Elf_Internal_Sym isym;
+  elf_symbol_type *sym;
+  const Elf_External_Versym *xver = NULL;
+
+  if (idx == 0 || !bfd_elf_symbol_view_get (view, idx, &isym))
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return NULL;
+    }
+
+  if (view->dynamic
+      && ((elf_dynverdef (abfd) != 0 && elf_tdata (abfd)->verdef == NULL)
+	  || (elf_dynverref (abfd) != 0 && elf_tdata (abfd)->verref == NULL))
+      && !_bfd_elf_slurp_version_tables (abfd, false))
+    return NULL;
+  if (view->versym != NULL)
+    xver = (const Elf_External_Versym *) view->versym + idx;
+
+  sym = (elf_symbol_type *) bfd_zalloc (abfd, sizeof (*sym));
+  if (sym == NULL)
+    return NULL;
+  if (!_bfd_elf_make_symbol (abfd, &isym,
+			     bfd_elf_symbol_view_name (view, idx),
+			     xver, view->dynamic, sym))
+    return NULL;
+  return &sym->symbol;
+}
+
+/* Read minisymbols.  Below this many symbols, just use the generic
+   routine and full BFD symbols.  */
+
+#define MINISYM_THRESHOLD (1000000 / sizeof (elf_symbol_type))
+
+/* For larger symbol tables, a minisymbol is the index of a symbol in
+   a view of the raw table, and symbols are only built when asked for.
+   That saves keeping an elf_symbol_type for every symbol.  */
+
+long long
+_bfd_elf_read_minisymbols (bfd *abfd, bool dynamic, void **minisymsp,
+			   unsigned int *sizep)
+{
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  struct elf_symbol_view *view;
+  unsigned int *minisyms;
+  size_t i, amt;
+
+  view = elf_tdata (abfd)->minisym_views[dynamic];
+  if (view == NULL)
+    {
+      Elf_Internal_Shdr *hdr;
+
+      /* Backends that post-process the whole table need it all.  */
+      hdr = dynamic ? &elf_tdata (abfd)->dynsymtab_hdr : &elf_symtab_hdr (abfd);
+      if (hdr->sh_size / bed->s->sizeof_sym < MINISYM_THRESHOLD
+	  || bed->elf_backend_symbol_table_processing != NULL)
+	return _bfd_generic_read_minisymbols (abfd, dynamic, minisymsp, sizep);
+
+      if (dynamic
+	  && ((elf_dynverdef (abfd) != 0 && elf_tdata (abfd)->verdef == NULL)
+	      || (elf_dynverref (abfd) != 0
+		  && elf_tdata (abfd)->verref == NULL))
+	  && !_bfd_elf_slurp_version_tables (abfd, false))
+	goto error_return;
+
+      view = (struct elf_symbol_view *) bfd_alloc (abfd, sizeof (*view));
+      if (view == NULL
+	  || !bfd_elf_symbol_view_init (abfd, dynamic, view))
+	goto error_return;
+      elf_tdata (abfd)->minisym_views[dynamic] = view;
+    }
+
+  /* Skip the null symbol.  */
+  if (_bfd_mul_overflow (view->count - 1, sizeof (*minisyms), &amt))
+    {
+      bfd_set_error (bfd_error_file_too_big);
+      goto error_return;
+    }
+  minisyms = (unsigned int *) bfd_malloc (amt);
+  if (minisyms == NULL)
+    goto error_return;
+  for (i = 1; i < view->count; i++)
+    minisyms[i - 1] = i;
+
+  *minisymsp = minisyms;
+  *sizep = sizeof (*minisyms);
+  return view->count - 1;
+
+ error_return:
+  bfd_set_error (bfd_error_no_symbols);
+  return -1;
+}
+
+/* Convert a minisymbol to a BFD asymbol.  SYM is a structure returned
+   by bfd_make_empty_symbol, which we fill in here and which is
+   overwritten by the next call.  */
+
+asymbol *
+_bfd_elf_minisymbol_to_symbol (bfd *abfd, bool dynamic,
+			       const void *minisym, asymbol *sym)
+{
+  const struct elf_symbol_view *view;
+  elf_symbol_type *elfsym = (elf_symbol_type *) sym;
+  const Elf_External_Versym *xver = NULL;
+  Elf_Internal_Sym isym;
+  unsigned int idx;
+
+  view = elf_tdata (abfd)->minisym_views[dynamic];
+  if (view == NULL)
+    return _bfd_generic_minisymbol_to_symbol (abfd, dynamic, minisym, sym);
+
+  idx = *(const unsigned int *) minisym;
+  if (!bfd_elf_symbol_view_get (view, idx, &isym))
+    return NULL;
+  if (view->versym != NULL)
+    xver = (const Elf_External_Versym *) view->versym + idx;
+
+  memset (elfsym, 0, sizeof (*elfsym));
+  if (!_bfd_elf_make_symbol (abfd, &isym,
+			     bfd_elf_symbol_view_name (view, idx),
+			     xver, dynamic, elfsym))
+    return NULL;
+  return sym;
+}
+
+/* Set up VIEW to read the relocations of SEC in ABFD in place.  If
+   DYNAMIC, SEC is itself a dynamic relocation section, as for
+   bfd_canonicalize_dynamic_reloc; otherwise the relocations are those
+   that apply to SEC, REL before RELA as bfd_canonicalize_reloc has
+   them.  The raw relocations are mapped or read once and belong to
+   ABFD.  No arelent is made and no howto looked up, so reading a
+   relocation costs nothing but its swapping.  Return FALSE on
+   error.  */
+
+bool
+bfd_elf_reloc_view_init (bfd *abfd, asection *sec, bool dynamic,
+			 struct elf_reloc_view *view)
+{
+  const struct elf_backend_data *bed;
+  struct bfd_elf_section_data *d;
+  Elf_Internal_Shdr *hdrs[2];
+  unsigned int i;
+
+  memset (view, 0, sizeof (*view));
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour)
+    {
+      bfd_set_error (bfd_error_wrong_format);
+      return false;
+    }
+
+  bed = get_elf_backend_data (abfd);
+  d = elf_section_data (sec);
+  view->abfd = abfd;
+  view->sec = sec;
+  if (!dynamic)
+    {
+      hdrs[0] = d->rel.hdr;
+      hdrs[1] = d->rela.hdr;
+    }
+  else if (d->this_hdr.sh_type == SHT_REL)
+    {
+      hdrs[0] = &d->this_hdr;
+      hdrs[1] = NULL;
+    }
+  else if (d->this_hdr.sh_type == SHT_RELA)
+    {
+      hdrs[0] = NULL;
+      hdrs[1] = &d->this_hdr;
+    }
+  else
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      Elf_Internal_Shdr *hdr = hdrs[i];
+      unsigned int entsize = i == 0 ? bed->s->sizeof_rel : bed->s->sizeof_rela;
+      const bfd_byte *relocs;
+      size_t count;
+
+      if (hdr == NULL || hdr->sh_size == 0)
+	continue;
+      /* Each external relocation must be one internal one for the
+	 relocations to be counted as they are stored.  */
+      if (hdr->sh_entsize != entsize || bed->s->int_rels_per_ext_rel != 1)
+	{
+	  bfd_set_error (bfd_error_bad_value);
+	  return false;
+	}
+      count = hdr->sh_size / entsize;
+      relocs = _bfd_file_view (abfd, hdr->sh_offset, count * entsize);
+      if (relocs == NULL)
+	return false;
+      if (i == 0)
+	{
+	  view->rel = relocs;
+	  view->rel_count = count;
+	}
+      else
+	{
+	  view->rela = relocs;
+	  view->rela_count = count;
+	}
+    }
+  view->count = view->rel_count + view->rela_count;
+  return true;
+}
+
+/* Read COUNT relocations of VIEW from START on into the arrays given,
+   any of which may be NULL if it isn't wanted: OFFSETS gets r_offset,
+   as in the file, TYPES the relocation type, SYMBOLS the index of the
+   symbol in the symbol table, as a struct elf_symbol_view counts them,
+   or zero for none, and ADDENDS the addend, zero for a REL relocation.
+   Return FALSE if the relocations asked for are out of range.  */
+
+bool
+bfd_elf_reloc_view_read (const struct elf_reloc_view *view,
+			 size_t start, size_t count,
+			 bfd_vma *offsets, unsigned int *types,
+			 unsigned int *symbols, bfd_signed_vma *addends)
+{
+  const struct elf_backend_data *bed;
+  /* Relocs are swapped in batches of this many.  */
+  Elf_Internal_Rela batch[256];
+  size_t nbatch = sizeof (batch) / sizeof (batch[0]);
+  bool elf64;
+
+  if (start > view->count || count > view->count - start)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  bed = get_elf_backend_data (view->abfd);
+  elf64 = bed->s->arch_size == 64;
+  while (count != 0)
+    {
+      const bfd_byte *src;
+      size_t entsize, n, i;
+      bool rela = start >= view->rel_count;
+
+      if (!rela)
+	{
+	  entsize = bed->s->sizeof_rel;
+	  src = view->rel + start * entsize;
+	  n = view->rel_count - start;
+	}
+      else
+	{
+	  entsize = bed->s->sizeof_rela;
+	  src = view->rela + (start - view->rel_count) * entsize;
+	  n = view->count - start;
+	}
+      if (n > count)
+	n = count;
+      if (n > nbatch)
+	n = nbatch;
+
+      if (bed->s->swap_relocs_in != NULL)
+	(*bed->s->swap_relocs_in) (view->abfd, src, n, entsize, batch);
+      else
+	for (i = 0; i < n; i++)
+	  if (rela)
+	    (*bed->s->swap_reloca_in) (view->abfd, src + i * entsize,
+				       batch + i);
+	  else
+	    (*bed->s->swap_reloc_in) (view->abfd, src + i * entsize,
+				      batch + i);
+
+      for (i = 0; i < n; i++)
+	{
+	  bfd_vma info = batch[i].r_info;
+
+	  if (offsets != NULL)
+	    *offsets++ = batch[i].r_offset;
+	  if (types != NULL)
+	    *types++ = elf64 ? ELF64_R_TYPE (info) : ELF32_R_TYPE (info);
+	  if (symbols != NULL)
+	    *symbols++ = elf64 ? ELF64_R_SYM (info) : ELF32_R_SYM (info);
+	  if (addends != NULL)
+	    *addends++ = rela ? (bfd_signed_vma) batch[i].r_addend : 0;
+	}
+      start += n;
+      count -= n;
+    }
+  return true;
+}
+
 /* Elf_Internal_Shdr->contents is an array of these for SHT_GROUP
    sections.  The first element is the flags, the rest are section
    pointers.  */
@@ -565,6 +1250,7 @@ group_signature (bfd *abfd, Elf_Internal_Shdr *ghdr)
   unsigned char esym[sizeof (Elf64_External_Sym)];
   Elf_External_Sym_Shndx eshndx;
   Elf_Internal_Sym isym;
+  const char *name;
 
   /* First we need to ensure the symbol table is available.  Make sure
      that it is a symbol table section.  */
@@ -581,7 +1267,10 @@ group_signature (bfd *abfd, Elf_Internal_Shdr *ghdr)
 			    &isym, esym, &eshndx) == NULL)
     return NULL;
 
-  return bfd_elf_sym_name (abfd, hdr, &isym, NULL);
+  name = bfd_elf_sym_name (abfd, hdr, &isym, NULL);
+  if (abfd->name_pool != NULL)
+    name = _bfd_intern_name (abfd, name, strlen (name));
+  return name;
 }
 
 /* Set next_in_group list pointer, and group name for NEWSECT.  */
@@ -634,6 +1323,11 @@ setup_group (bfd *abfd, Elf_Internal_Shdr *hdr, asection *newsect)
 	    = (Elf_Internal_Shdr **) bfd_zalloc (abfd, amt);
 	  if (elf_tdata (abfd)->group_sect_ptr == NULL)
 	    return false;
+	  amt = shnum * sizeof (unsigned int);
+	  elf_tdata (abfd)->section_group_index
+	    = (unsigned int *) bfd_zalloc (abfd, amt);
+	  if (elf_tdata (abfd)->section_group_index == NULL)
+	    return false;
 	  num_group = 0;
 
 	  for (i = 0; i < shnum; i++)
@@ -714,6 +1408,16 @@ setup_group (bfd *abfd, Elf_Internal_Shdr *hdr, asection *newsect)
 			       abfd, i);
 			  dest->shdr = NULL;
 			}
+		      else
+			{
+			  unsigned int *gidx
+			    = &elf_tdata (abfd)->section_group_index[idx];
+
+			  if (*gidx == 0)
+			    *gidx = num_group;
+			  else if (*gidx != num_group)
+			    *gidx = (unsigned int) -1;
+			}
 		    }
 		}
 	    }
@@ -739,8 +1443,19 @@ setup_group (bfd *abfd, Elf_Internal_Shdr *hdr, asection *newsect)
   if (num_group != (unsigned) -1)
     {
       unsigned int search_offset = elf_tdata (abfd)->group_search_offset;
+      unsigned int shindex = elf_section_data (newsect)->this_idx;
       unsigned int j;
 
+      /* Start at the one group that lists this section, if known.  */
+      if (shindex < elf_numsections (abfd)
+	  && elf_elfsections (abfd)[shindex] == hdr)
+	{
+	  unsigned int gidx = elf_tdata (abfd)->section_group_index[shindex];
+
+	  if (gidx != 0 && gidx <= num_group)
+	    search_offset = gidx - 1;
+	}
+
       for (j = 0; j < num_group; j++)
 	{
 	  /* Begin search from previous found group.  */
@@ -988,6 +1703,13 @@ _bfd_elf_make_section_from_shdr (bfd *abfd,
   if (hdr->bfd_section != NULL)
     return true;
 
+  if (abfd->name_pool != NULL)
+    {
+      name = _bfd_intern_name (abfd, name, strlen (name));
+      if (name == NULL)
+	return false;
+    }
+
   newsect = bfd_make_section_anyway (abfd, name);
   if (newsect == NULL)
     return false;
@@ -1639,7 +2361,7 @@ _bfd_elf_print_private_bfd_data (bfd *abfd, void *farg)
   FILE *f = (FILE *) farg;
   Elf_Internal_Phdr *p;
   asection *s;
-  bfd_byte *dynbuf = NULL;
+  const bfd_byte *dynbuf = NULL;
 
   p = elf_tdata (abfd)->phdr;
   if (p != NULL)
@@ -1684,14 +2406,14 @@ _bfd_elf_print_private_bfd_data (bfd *abfd, void *farg)
     {
       unsigned int elfsec;
       unsigned long long shlink;
-      bfd_byte *extdyn, *extdynend;
+      const bfd_byte *extdyn, *extdynend;
       size_t extdynsize;
       void (*swap_dyn_in) (bfd *, const void *, Elf_Internal_Dyn *);
 
       fprintf (f, _("\nDynamic Section:\n"));
 
-      if (!bfd_malloc_and_get_section (abfd, s, &dynbuf))
-	goto error_return;
+      if (!bfd_get_cached_section_contents (abfd, s, &dynbuf))
+	return false;
 
       elfsec = _bfd_elf_section_from_bfd_section (abfd, s);
       if (elfsec == SHN_BAD)
@@ -1812,7 +2534,7 @@ _bfd_elf_print_private_bfd_data (bfd *abfd, void *farg)
 	  fprintf (f, "\n");
 	}
 
-      free (dynbuf);
+      bfd_release_cached_section_contents (abfd, s);
       dynbuf = NULL;
     }
 
@@ -1869,13 +2591,56 @@ _bfd_elf_print_private_bfd_data (bfd *abfd, void *farg)
   return true;
 
  error_return:
-  free (dynbuf);
+  if (dynbuf != NULL)
+    bfd_release_cached_section_contents (abfd, s);
   return false;
 }
 
 /* Get version name.  If BASE_P is TRUE, return "Base" for VER_FLG_BASE
    and return symbol version for symbol version itself.   */
 
+/* Fill in verref_names for ABFD.  A version index needed from more
+   than one file takes its name from the last of them, and from the
+   first reference within that file, as a walk over verref would.
+   Return FALSE if there is no memory for it.  */
+
+static bool
+elf_build_verref_names (bfd *abfd)
+{
+  Elf_Internal_Verneed *t;
+  Elf_Internal_Vernaux *a;
+  const char **names;
+  unsigned int *owner;
+  unsigned int count = 0;
+  unsigned int n;
+
+  for (t = elf_tdata (abfd)->verref; t != NULL; t = t->vn_nextref)
+    for (a = t->vn_auxptr; a != NULL; a = a->vna_nextptr)
+      if (a->vna_other >= count)
+	count = a->vna_other + 1;
+
+  names = (const char **) bfd_zalloc (abfd, (count + 1) * sizeof (*names));
+  owner = (unsigned int *) bfd_zmalloc ((count + 1) * sizeof (*owner));
+  if (names == NULL || owner == NULL)
+    {
+      free (owner);
+      return false;
+    }
+
+  for (n = 1, t = elf_tdata (abfd)->verref; t != NULL; n++, t = t->vn_nextref)
+    for (a = t->vn_auxptr; a != NULL; a = a->vna_nextptr)
+      if (owner[a->vna_other] != n)
+	{
+	  owner[a->vna_other] = n;
+	  names[a->vna_other] = a->vna_nodename;
+	}
+
+  free (owner);
+  elf_tdata (abfd)->verref_names = names;
+  elf_tdata (abfd)->verref_names_count = count;
+  return true;
+}
+
 const char *
 _bfd_elf_get_symbol_version_string (bfd *abfd, asymbol *symbol,
 				    bool base_p,
@@ -1885,7 +2650,8 @@ _bfd_elf_get_symbol_version_string (bfd *abfd, asymbol *symbol,
   if (elf_dynversym (abfd) != 0
       && (elf_dynverdef (abfd) != 0 || elf_dynverref (abfd) != 0))
     {
-      unsigned int vernum = ((elf_symbol_type *) symbol)->version;
+      unsigned int vernum
+	= ((elf_symbol_type *) symbol)->internal_elf_sym.st_version;
 
       *hidden = (vernum & VERSYM_HIDDEN) != 0;
       vernum &= VERSYM_VERSION;
@@ -1913,22 +2679,33 @@ _bfd_elf_get_symbol_version_string (bfd *abfd, asymbol *symbol,
 	  Elf_Internal_Verneed *t;
 
 	  version_string = _("<corrupt>");
-	  for (t = elf_tdata (abfd)->verref;
-	       t != NULL;
-	       t = t->vn_nextref)
+	  if (elf_tdata (abfd)->verref_names != NULL
+	      || elf_build_verref_names (abfd))
 	    {
-	      Elf_Internal_Vernaux *a;
-
-	      for (a = t->vn_auxptr; a != NULL; a = a->vna_nextptr)
+	      if (vernum < elf_tdata (abfd)->verref_names_count
+		  && elf_tdata (abfd)->verref_names[vernum] != NULL)
 		{
-		  if (a->vna_other == vernum)
-		    {
-		      *hidden = true;
-		      version_string = a->vna_nodename;
-		      break;
-		    }
+		  *hidden = true;
+		  version_string = elf_tdata (abfd)->verref_names[vernum];
 		}
 	    }
+	  else
+	    for (t = elf_tdata (abfd)->verref;
+		 t != NULL;
+		 t = t->vn_nextref)
+	      {
+		Elf_Internal_Vernaux *a;
+
+		for (a = t->vn_auxptr; a != NULL; a = a->vna_nextptr)
+		  {
+		    if (a->vna_other == vernum)
+		      {
+			*hidden = true;
+			version_string = a->vna_nodename;
+			break;
+		      }
+		  }
+	      }
 	}
     }
   return version_string;
@@ -2340,7 +3117,7 @@ bfd_section_from_shdr (bfd *abfd, unsigned int shindex)
       /* *These* do a lot of work -- but build no sections!  */
       {
 	asection *target_sect;
-	Elf_Internal_Shdr *hdr2, **p_hdr;
+	Elf_Internal_Shdr **p_hdr;
 	unsigned int num_sec = elf_numsections (abfd);
 	struct bfd_elf_section_data *esdt;
 	bfd_size_type size;
@@ -2425,12 +3202,9 @@ bfd_section_from_shdr (bfd *abfd, unsigned int shindex)
 	    goto success;
 	  }
 
-	hdr2 = (Elf_Internal_Shdr *) bfd_alloc (abfd, sizeof (*hdr2));
-	if (hdr2 == NULL)
-	  goto fail;
-	*hdr2 = *hdr;
-	*p_hdr = hdr2;
-	elf_elfsections (abfd)[shindex] = hdr2;
+	/* HDR is the one in the table of section headers, which lives
+	   as long as ABFD, so there is no need for a copy.  */
+	*p_hdr = hdr;
 	target_sect->reloc_count += (NUM_SHDR_ENTRIES (hdr)
 				     * bed->s->int_rels_per_ext_rel);
 	target_sect->flags |= SEC_RELOC;
@@ -2840,6 +3614,22 @@ _bfd_elf_get_sec_type_attr (bfd *abfd, asection *sec)
   return _bfd_elf_get_special_section (sec->name, spec, sec->use_rela_p);
 }
 
+const struct bfd_elf_section_cold _bfd_elf_section_no_cold;
+
+/* Return the cold record of SEC, giving it one first if it has none.
+   Return NULL on error.  */
+
+struct bfd_elf_section_cold *
+_bfd_elf_section_cold (asection *sec)
+{
+  struct bfd_elf_section_data *sdata = elf_section_data (sec);
+
+  if (sdata->cold == NULL)
+    sdata->cold = ((struct bfd_elf_section_cold *)
+		   bfd_zalloc (sec->owner, sizeof (*sdata->cold)));
+  return sdata->cold;
+}
+
 bool
 _bfd_elf_new_section_hook (bfd *abfd, asection *sec)
 {
@@ -2988,6 +3778,49 @@ _bfd_elf_core_find_build_id (bfd *templ, bfd_vma offset)
   return false;
 }
 
+/* Return the NT_FILE mapping of the core file ABFD that holds ADDR,
+   or NULL.  */
+
+static const struct elf_core_file_mapping *
+elf_core_file_mapping_at (bfd *abfd, bfd_vma addr)
+{
+  struct core_elf_obj_tdata *core = elf_tdata (abfd)->core;
+  size_t lo = 0;
+  size_t hi = core->file_mapping_count;
+
+  /* Find the last mapping that starts at or below ADDR.  */
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (core->file_mappings[mid].start <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0 || addr >= core->file_mappings[lo - 1].end)
+    return NULL;
+  return &core->file_mappings[lo - 1];
+}
+
+/* Return whether the PT_LOAD segment HDR of the core file ABFD might
+   hold the ELF header of a mapped file.  Once the NT_FILE note is
+   known only segments that map the start of a file can, and checking
+   just those saves reading from each of the many other segments of a
+   large core.  */
+
+static bool
+elf_core_segment_may_be_elf (bfd *abfd, Elf_Internal_Phdr *hdr)
+{
+  const struct elf_core_file_mapping *map;
+
+  if (elf_tdata (abfd)->core == NULL
+      || elf_tdata (abfd)->core->file_mappings == NULL)
+    return true;
+  map = elf_core_file_mapping_at (abfd, hdr->p_vaddr);
+  return map != NULL && map->start == hdr->p_vaddr && map->offset == 0;
+}
+
 bool
 bfd_section_from_phdr (bfd *abfd, Elf_Internal_Phdr *hdr, int hdr_index)
 {
@@ -3001,7 +3834,9 @@ bfd_section_from_phdr (bfd *abfd, Elf_Internal_Phdr *hdr, int hdr_index)
     case PT_LOAD:
       if (! _bfd_elf_make_section_from_phdr (abfd, hdr, hdr_index, "load"))
 	return false;
-      if (bfd_get_format (abfd) == bfd_core && abfd->build_id == NULL)
+      if (bfd_get_format (abfd) == bfd_core
+	  && abfd->build_id == NULL
+	  && elf_core_segment_may_be_elf (abfd, hdr))
 	_bfd_elf_core_find_build_id (abfd, hdr->p_offset);
       return true;
 
@@ -4683,7 +5518,7 @@ _bfd_elf_map_sections_to_segments (bfd *abfd,
       BFD_ASSERT (i <= bfd_count_sections (abfd));
       count = i;
 
-      qsort (sections, (size_t) count, sizeof (asection *), elf_sort_sections);
+      elf_sort_section_array (sections, count);
 
       phdr_size = elf_program_header_size (abfd);
       if (phdr_size == (bfd_size_type) -1)
@@ -5290,6 +6125,24 @@ elf_sort_sections (const void *arg1, const void *arg2)
   return sec1->target_index - sec2->target_index;
 }
 
+/* Sort the COUNT sections in SECTIONS with elf_sort_sections.  Output
+   sections are usually laid out in address order already, and the
+   segment maps built by _bfd_elf_map_sections_to_segments always are,
+   so check for that before paying for a qsort.  */
+
+static void
+elf_sort_section_array (asection **sections, size_t count)
+{
+  size_t i;
+
+  for (i = 1; i < count; i++)
+    if (elf_sort_sections (&sections[i - 1], &sections[i]) > 0)
+      {
+	qsort (sections, count, sizeof (asection *), elf_sort_sections);
+	return;
+      }
+}
+
 /* This qsort comparison functions sorts PT_LOAD segments first and
    by p_paddr, for assign_file_positions_for_load_sections.  */
 
@@ -5491,8 +6344,7 @@ assign_file_positions_for_load_sections (bfd *abfd,
 	{
 	  for (i = 0; i < m->count; i++)
 	    m->sections[i]->target_index = i;
-	  qsort (m->sections, (size_t) m->count, sizeof (asection *),
-		 elf_sort_sections);
+	  elf_sort_section_array (m->sections, m->count);
 	}
     }
   if (alloc > 1)
@@ -8182,6 +9034,63 @@ _bfd_elf_copy_private_symbol_data (bfd *ibfd,
   return true;
 }
 
+/* The symbols _bfd_elf_swap_syms_out is writing, shared by the
+   threads that swap them.  */
+
+struct elf_swap_syms_job
+{
+  bfd *abfd;
+  const struct elf_sym_strtab *syms;
+  bfd_byte *symbuf;
+  Elf_External_Sym_Shndx *shndxbuf;
+};
+
+/* Swap out the symbols from START to END of the elf_swap_syms_job
+   DATA.  */
+
+static bool
+elf_swap_syms_range (void *data, size_t start, size_t end)
+{
+  struct elf_swap_syms_job *job = (struct elf_swap_syms_job *) data;
+  const struct elf_backend_data *bed = get_elf_backend_data (job->abfd);
+  size_t i;
+
+  for (i = start; i < end; i++)
+    {
+      const struct elf_sym_strtab *elfsym = &job->syms[i];
+
+      bed->s->swap_symbol_out (job->abfd, &elfsym->sym,
+			       (job->symbuf
+				+ elfsym->dest_index * bed->s->sizeof_sym),
+			       NPTR_ADD (job->shndxbuf, elfsym->dest_index));
+    }
+  return true;
+}
+
+/* The fewest symbols worth handing to a thread.  */
+#define ELF_SWAP_SYMS_GRAIN 16384
+
+/* Swap the COUNT symbols in SYMS out of ABFD into SYMBUF, and their
+   extended section indices into SHNDXBUF if that is not NULL.  Each
+   goes to its dest_index.  The st_name fields must already be final
+   string table offsets, since the symbols may be swapped on several
+   threads at once.  */
+
+bool
+_bfd_elf_swap_syms_out (bfd *abfd, const struct elf_sym_strtab *syms,
+			size_t count, void *symbuf,
+			Elf_External_Sym_Shndx *shndxbuf)
+{
+  struct elf_swap_syms_job job;
+
+  job.abfd = abfd;
+  job.syms = syms;
+  job.symbuf = (bfd_byte *) symbuf;
+  job.shndxbuf = shndxbuf;
+  return _bfd_parallel_for (count, ELF_SWAP_SYMS_GRAIN,
+			    elf_swap_syms_range, &job);
+}
+
 /* Swap out the symbols.  */
 
 static bool
@@ -8455,8 +9364,20 @@ Unable to handle section index %x in ELF symbol.  Using ABS instead."),
       /* Processor-specific types.  */
       if (type_ptr != NULL
 	  && bed->elf_backend_get_symbol_type)
-	type = ((*bed->elf_backend_get_symbol_type)
-		(&type_ptr->internal_elf_sym, type));
+	{
+	  Elf_Internal_Sym isym;
+
+	  memset (&isym, 0, sizeof (isym));
+	  isym.st_value = type_ptr->internal_elf_sym.st_value;
+	  isym.st_size = type_ptr->internal_elf_sym.st_size;
+	  isym.st_name = type_ptr->internal_elf_sym.st_name;
+	  isym.st_info = type_ptr->internal_elf_sym.st_info;
+	  isym.st_other = type_ptr->internal_elf_sym.st_other;
+	  isym.st_target_internal
+	    = type_ptr->internal_elf_sym.st_target_internal;
+	  isym.st_shndx = type_ptr->internal_elf_sym.st_shndx;
+	  type = (*bed->elf_backend_get_symbol_type) (&isym, type);
+	}
 
       if (flags & BSF_SECTION_SYM)
 	{
@@ -8523,7 +9444,7 @@ Unable to handle section index %x in ELF symbol.  Using ABS instead."),
   /* Finalize the .strtab section.  */
   _bfd_elf_strtab_finalize (stt);
 
-  /* Swap out the .strtab section.  */
+  /* Set the final string table offsets, then swap out the symbols.  */
   for (idx = 0; idx <= symcount; idx++)
     {
       struct elf_sym_strtab *elfsym = &symstrtab[idx];
@@ -8534,18 +9455,13 @@ Unable to handle section index %x in ELF symbol.  Using ABS instead."),
 						      elfsym->sym.st_name);
       if (info && info->callbacks->ctf_new_symbol)
 	info->callbacks->ctf_new_symbol (elfsym->dest_index,
-					 &elfsym->sym);
-
-      /* Inform the linker of the addition of this symbol.  */
-
-      bed->s->swap_symbol_out (abfd, &elfsym->sym,
-			       (outbound_syms
-				+ (elfsym->dest_index
-				   * bed->s->sizeof_sym)),
-			       NPTR_ADD (outbound_shndx,
-					 (elfsym->dest_index
-					  * sizeof (Elf_External_Sym_Shndx))));
+					 &elfsym->sym);
     }
+
+  if (!_bfd_elf_swap_syms_out (abfd, symstrtab, symcount + 1,
+			       outbound_syms,
+			       (Elf_External_Sym_Shndx *) outbound_shndx))
+    goto error_return;
   free (symstrtab);
 
   *sttp = stt;
@@ -8677,8 +9593,13 @@ _bfd_elf_canonicalize_reloc (bfd *abfd,
   arelent *tblptr;
   unsigned int i;
   const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  enum bfd_memory_class old_class;
+  bool ok;
 
-  if (! bed->s->slurp_reloc_table (abfd, section, symbols, false))
+  old_class = _bfd_set_memory_class (bfd_memory_relocs);
+  ok = bed->s->slurp_reloc_table (abfd, section, symbols, false);
+  _bfd_set_memory_class (old_class);
+  if (!ok)
     return -1;
 
   tblptr = section->relocation;
@@ -8694,8 +9615,12 @@ long long
 _bfd_elf_canonicalize_symtab (bfd *abfd, asymbol **allocation)
 {
   const struct elf_backend_data *bed = get_elf_backend_data (abfd);
-  long long symcount = bed->s->slurp_symbol_table (abfd, allocation, false);
+  enum bfd_memory_class old_class;
+  long long symcount;
 
+  old_class = _bfd_set_memory_class (bfd_memory_symbols);
+  symcount = bed->s->slurp_symbol_table (abfd, allocation, false);
+  _bfd_set_memory_class (old_class);
   if (symcount >= 0)
     abfd->symcount = symcount;
   return symcount;
@@ -8706,8 +9631,12 @@ _bfd_elf_canonicalize_dynamic_symtab (bfd *abfd,
 				      asymbol **allocation)
 {
   const struct elf_backend_data *bed = get_elf_backend_data (abfd);
-  long long symcount = bed->s->slurp_symbol_table (abfd, allocation, true);
+  enum bfd_memory_class old_class;
+  long long symcount;
 
+  old_class = _bfd_set_memory_class (bfd_memory_symbols);
+  symcount = bed->s->slurp_symbol_table (abfd, allocation, true);
+  _bfd_set_memory_class (old_class);
   if (symcount >= 0)
     abfd->dynsymcount = symcount;
   return symcount;
@@ -8798,8 +9727,13 @@ _bfd_elf_canonicalize_dynamic_reloc (bfd *abfd,
 	{
 	  arelent *p;
 	  long long count, i;
+	  enum bfd_memory_class old_class;
+	  bool ok;
 
-	  if (! (*slurp_relocs) (abfd, s, syms, true))
+	  old_class = _bfd_set_memory_class (bfd_memory_relocs);
+	  ok = (*slurp_relocs) (abfd, s, syms, true);
+	  _bfd_set_memory_class (old_class);
+	  if (!ok)
 	    return -1;
 	  count = NUM_SHDR_ENTRIES (&elf_section_data (s)->this_hdr);
 	  p = s->relocation;
@@ -9602,6 +10536,10 @@ _bfd_elf_free_cached_info (bfd *abfd)
       _bfd_dwarf2_cleanup_debug_info (abfd, &tdata->dwarf2_find_line_info);
       _bfd_dwarf1_cleanup_debug_info (abfd, &tdata->dwarf1_find_line_info);
       _bfd_stab_cleanup (abfd, &tdata->line_info);
+      free (tdata->link_isymbuf);
+      tdata->link_isymbuf = NULL;
+      free (tdata->link_extversym);
+      tdata->link_extversym = NULL;
     }
 
   return _bfd_generic_bfd_free_cached_info (abfd);
@@ -10518,6 +11456,74 @@ elfcore_grok_win32pstatus (bfd *abfd, Elf_Internal_Note *note)
   return true;
 }
 
+/* Sort core file mappings by address.  */
+
+static int
+compare_core_file_mappings (const void *ap, const void *bp)
+{
+  const struct elf_core_file_mapping *a
+    = (const struct elf_core_file_mapping *) ap;
+  const struct elf_core_file_mapping *b
+    = (const struct elf_core_file_mapping *) bp;
+
+  if (a->start != b->start)
+    return a->start < b->start ? -1 : 1;
+  return 0;
+}
+
+/* Index the NT_FILE note of a Linux core file, which lists the files
+   mapped into the process: a count and a page size, then the start,
+   end and page offset of each mapping, all target words, followed by
+   the file names.  A malformed note is left unindexed.  */
+
+static bool
+elfcore_grok_file_note (bfd *abfd, Elf_Internal_Note *note)
+{
+  struct core_elf_obj_tdata *core = elf_tdata (abfd)->core;
+  unsigned int bits = get_elf_backend_data (abfd)->s->arch_size;
+  unsigned int word = bits / 8;
+  const bfd_byte *p = (const bfd_byte *) note->descdata;
+  size_t left = note->descsz;
+  struct elf_core_file_mapping *maps;
+  bfd_vma count, page_size, i;
+  char *names, *names_end;
+
+  if (core == NULL || core->file_mappings != NULL || left < 2 * word)
+    return true;
+
+  count = bfd_get (bits, abfd, p);
+  page_size = bfd_get (bits, abfd, p + word);
+  p += 2 * word;
+  left -= 2 * word;
+  if (count == 0 || count > left / (3 * word))
+    return true;
+
+  maps = (struct elf_core_file_mapping *)
+    bfd_alloc (abfd, count * sizeof (*maps));
+  names = (char *) bfd_alloc (abfd, left - count * 3 * word + 1);
+  if (maps == NULL || names == NULL)
+    return false;
+  names_end = names + (left - count * 3 * word);
+  memcpy (names, p + count * 3 * word, names_end - names);
+  *names_end = '\0';
+
+  for (i = 0; i < count; i++, p += 3 * word)
+    {
+      if (names >= names_end)
+	return true;
+      maps[i].start = bfd_get (bits, abfd, p);
+      maps[i].end = bfd_get (bits, abfd, p + word);
+      maps[i].offset = bfd_get (bits, abfd, p + 2 * word) * page_size;
+      maps[i].filename = names;
+      names += strlen (names) + 1;
+    }
+
+  qsort (maps, count, sizeof (*maps), compare_core_file_mappings);
+  core->file_mappings = maps;
+  core->file_mapping_count = count;
+  return true;
+}
+
 static bool
 elfcore_grok_note (bfd *abfd, Elf_Internal_Note *note)
 {
@@ -10877,6 +11883,8 @@ elfcore_grok_note (bfd *abfd, Elf_Internal_Note *note)
       return elfcore_make_auxv_note_section (abfd, note, 0);
 
     case NT_FILE:
+      if (!elfcore_grok_file_note (abfd, note))
+	return false;
       return elfcore_make_note_pseudosection (abfd, ".note.linuxcore.file",
 					      note);
 
@@ -12640,9 +13648,15 @@ elfcore_write_file_note (bfd *obfd, char *note_data, int *note_size,
 			     "CORE", NT_FILE, buf, bufsiz);
 }
 
+/* Call FUNC with DATA on each note in the SIZE bytes at BUF, which
+   were read from OFFSET in ABFD and are aligned to ALIGN.  Return
+   FALSE if the notes are malformed or FUNC does.  */
+
 static bool
-elf_parse_notes (bfd *abfd, char *buf, size_t size, file_ptr offset,
-		 size_t align)
+elf_walk_notes (bfd *abfd, char *buf, size_t size, file_ptr offset,
+		size_t align,
+		bool (*func) (bfd *, Elf_Internal_Note *, void *),
+		void *data)
 {
   char *p;
 
@@ -12679,67 +13693,78 @@ elf_parse_notes (bfd *abfd, char *buf, size_t size, file_ptr offset,
 	      || in.descsz > buf - in.descdata + size))
 	return false;
 
-      switch (bfd_get_format (abfd))
-	{
-	default:
-	  return true;
+      if (!func (abfd, &in, data))
+	return false;
 
-	case bfd_core:
-	  {
+      p += ELF_NOTE_NEXT_OFFSET (in.namesz, in.descsz, align);
+    }
+
+  return true;
+}
+
+/* Pass the note IN of ABFD to the code that understands it.  */
+
+static bool
+elf_grok_note (bfd *abfd, Elf_Internal_Note *in, void *data ATTRIBUTE_UNUSED)
+{
+  switch (bfd_get_format (abfd))
+    {
+    default:
+      return true;
+
+    case bfd_core:
+      {
 #define GROKER_ELEMENT(S,F) {S, sizeof (S) - 1, F}
-	    struct
-	    {
-	      const char * string;
-	      size_t len;
-	      bool (*func) (bfd *, Elf_Internal_Note *);
-	    }
-	    grokers[] =
-	    {
-	      GROKER_ELEMENT ("", elfcore_grok_note),
-	      GROKER_ELEMENT ("FreeBSD", elfcore_grok_freebsd_note),
-	      GROKER_ELEMENT ("NetBSD-CORE", elfcore_grok_netbsd_note),
-	      GROKER_ELEMENT ("OpenBSD", elfcore_grok_openbsd_note),
-	      GROKER_ELEMENT ("QNX", elfcore_grok_nto_note),
-	      GROKER_ELEMENT ("SPU/", elfcore_grok_spu_note),
-	      GROKER_ELEMENT ("GNU", elfobj_grok_gnu_note),
-	      GROKER_ELEMENT ("CORE", elfcore_grok_solaris_note)
-	    };
+	struct
+	{
+	  const char * string;
+	  size_t len;
+	  bool (*func) (bfd *, Elf_Internal_Note *);
+	}
+	grokers[] =
+	{
+	  GROKER_ELEMENT ("", elfcore_grok_note),
+	  GROKER_ELEMENT ("FreeBSD", elfcore_grok_freebsd_note),
+	  GROKER_ELEMENT ("NetBSD-CORE", elfcore_grok_netbsd_note),
+	  GROKER_ELEMENT ("OpenBSD", elfcore_grok_openbsd_note),
+	  GROKER_ELEMENT ("QNX", elfcore_grok_nto_note),
+	  GROKER_ELEMENT ("SPU/", elfcore_grok_spu_note),
+	  GROKER_ELEMENT ("GNU", elfobj_grok_gnu_note),
+	  GROKER_ELEMENT ("CORE", elfcore_grok_solaris_note)
+	};
 #undef GROKER_ELEMENT
-	    int i;
+	int i;
 
-	    for (i = ARRAY_SIZE (grokers); i--;)
-	      {
-		if (in.namesz >= grokers[i].len
-		    && strncmp (in.namedata, grokers[i].string,
-				grokers[i].len) == 0)
-		  {
-		    if (! grokers[i].func (abfd, & in))
-		      return false;
-		    break;
-		  }
-	      }
-	    break;
+	for (i = ARRAY_SIZE (grokers); i--;)
+	  {
+	    if (in->namesz >= grokers[i].len
+		&& strncmp (in->namedata, grokers[i].string,
+			    grokers[i].len) == 0)
+	      return grokers[i].func (abfd, in);
 	  }
+	return true;
+      }
 
-	case bfd_object:
-	  if (in.namesz == sizeof "GNU" && strcmp (in.namedata, "GNU") == 0)
-	    {
-	      if (! elfobj_grok_gnu_note (abfd, &in))
-		return false;
-	    }
-	  else if (in.namesz == sizeof "stapsdt"
-		   && strcmp (in.namedata, "stapsdt") == 0)
-	    {
-	      if (! elfobj_grok_stapsdt_note (abfd, &in))
-		return false;
-	    }
-	  break;
-	}
-
-      p += ELF_NOTE_NEXT_OFFSET (in.namesz, in.descsz, align);
+    case bfd_object:
+      if (in->namesz == sizeof "GNU" && strcmp (in->namedata, "GNU") == 0)
+	return elfobj_grok_gnu_note (abfd, in);
+      else if (in->namesz == sizeof "stapsdt"
+	       && strcmp (in->namedata, "stapsdt") == 0)
+	return elfobj_grok_stapsdt_note (abfd, in);
+      return true;
     }
+}
 
-  return true;
+static bool
+elf_parse_notes (bfd *abfd, char *buf, size_t size, file_ptr offset,
+		 size_t align)
+{
+  if (bfd_get_format (abfd) != bfd_core
+      && bfd_get_format (abfd) != bfd_object)
+    return true;
+
+  return elf_walk_notes (abfd, buf, size, offset, align, elf_grok_note,
+			 NULL);
 }
 
 bool
@@ -12772,6 +13797,380 @@ elf_read_notes (bfd *abfd, file_ptr offset, bfd_size_type size,
   return true;
 }
 
+/* The notes elf_index_notes has found so far.  */
+
+struct elf_note_index
+{
+  struct elf_note_info *notes;
+  unsigned int count;
+  unsigned int alloc;
+
+  /* Set if memory ran out.  */
+  bool failed;
+};
+
+/* Add the note IN of ABFD to the elf_note_index DATA.  */
+
+static bool
+elf_index_note (bfd *abfd, Elf_Internal_Note *in, void *data)
+{
+  struct elf_note_index *idx = (struct elf_note_index *) data;
+  struct elf_note_info *note;
+  size_t len;
+  char *name;
+
+  if (idx->count == idx->alloc)
+    {
+      unsigned int alloc = idx->alloc ? idx->alloc * 2 : 16;
+      struct elf_note_info *notes;
+
+      notes = (struct elf_note_info *) bfd_realloc (idx->notes,
+						    alloc * sizeof (*notes));
+      if (notes == NULL)
+	{
+	  idx->failed = true;
+	  return false;
+	}
+      idx->notes = notes;
+      idx->alloc = alloc;
+    }
+
+  len = strnlen (in->namedata, in->namesz);
+  name = (char *) bfd_alloc (abfd, len + 1);
+  if (name == NULL)
+    {
+      idx->failed = true;
+      return false;
+    }
+  memcpy (name, in->namedata, len);
+  name[len] = 0;
+
+  note = &idx->notes[idx->count++];
+  note->name = name;
+  note->type = in->type;
+  note->descpos = in->descpos;
+  note->descsz = in->descsz;
+  return true;
+}
+
+/* Add the notes in the SIZE bytes at OFFSET in ABFD, aligned to ALIGN,
+   to IDX.  Notes that can't be read are left out.  */
+
+static bool
+elf_index_note_area (bfd *abfd, struct elf_note_index *idx,
+		     file_ptr offset, bfd_size_type size, size_t align)
+{
+  char *buf;
+
+  if (size == 0 || (size + 1) == 0)
+    return true;
+
+  if (bfd_seek (abfd, offset, SEEK_SET) != 0)
+    return true;
+
+  buf = (char *) _bfd_malloc_and_read (abfd, size + 1, size);
+  if (buf == NULL)
+    return bfd_get_error () != bfd_error_no_memory;
+
+  /* The owner names are compared as strings.  */
+  buf[size] = 0;
+
+  elf_walk_notes (abfd, buf, size, offset, align, elf_index_note, idx);
+  free (buf);
+  return !idx->failed;
+}
+
+/* Sort notes by owner, then type, then position.  */
+
+static int
+compare_notes (const void *ap, const void *bp)
+{
+  const struct elf_note_info *a = (const struct elf_note_info *) ap;
+  const struct elf_note_info *b = (const struct elf_note_info *) bp;
+  int cmp = strcmp (a->name, b->name);
+
+  if (cmp != 0)
+    return cmp;
+  if (a->type != b->type)
+    return a->type < b->type ? -1 : 1;
+  return a->descpos < b->descpos ? -1 : a->descpos > b->descpos;
+}
+
+/* Read and sort all of the notes in ABFD, if that hasn't been done.
+   The notes of an object are those in its SHT_NOTE sections, or in
+   its PT_NOTE segments if it has no SHT_NOTE sections, and those of a
+   core file are in its PT_NOTE segments.  */
+
+static bool
+elf_index_notes (bfd *abfd)
+{
+  struct elf_obj_tdata *tdata = elf_tdata (abfd);
+  struct elf_note_index idx;
+  bool found = false;
+  unsigned int i;
+
+  if (tdata->notes_indexed)
+    return true;
+
+  idx.notes = NULL;
+  idx.count = 0;
+  idx.alloc = 0;
+  idx.failed = false;
+
+  if (bfd_get_format (abfd) != bfd_core)
+    for (i = 1; i < elf_numsections (abfd); i++)
+      {
+	Elf_Internal_Shdr *hdr = elf_elfsections (abfd)[i];
+
+	if (hdr->sh_type != SHT_NOTE)
+	  continue;
+	found = true;
+	if (!elf_index_note_area (abfd, &idx, hdr->sh_offset, hdr->sh_size,
+				  hdr->sh_addralign))
+	  goto error_return;
+      }
+
+  if (!found && tdata->phdr != NULL)
+    for (i = 0; i < elf_elfheader (abfd)->e_phnum; i++)
+      {
+	Elf_Internal_Phdr *phdr = &tdata->phdr[i];
+
+	if (phdr->p_type == PT_NOTE
+	    && !elf_index_note_area (abfd, &idx, phdr->p_offset,
+				     phdr->p_filesz, phdr->p_align))
+	  goto error_return;
+      }
+
+  if (idx.count != 0)
+    {
+      size_t amt = idx.count * sizeof (*idx.notes);
+
+      qsort (idx.notes, idx.count, sizeof (*idx.notes), compare_notes);
+      tdata->notes = (struct elf_note_info *) bfd_alloc (abfd, amt);
+      if (tdata->notes == NULL)
+	goto error_return;
+      memcpy (tdata->notes, idx.notes, amt);
+    }
+  free (idx.notes);
+  tdata->note_count = idx.count;
+  tdata->notes_indexed = true;
+  return true;
+
+ error_return:
+  free (idx.notes);
+  return false;
+}
+
+/* Return the notes of ABFD with owner NAME and type TYPE, and set
+   *COUNT to how many there are.  They are in file order.  Return
+   NULL with *COUNT zero if there are none, or on error.  All of the
+   notes are read and sorted on the first call, so each lookup after
+   that is a binary search.  Their descriptors are not read; use
+   bfd_seek and bfd_bread with the descpos and descsz of a note to
+   read its descriptor.  */
+
+const struct elf_note_info *
+bfd_elf_find_notes (bfd *abfd, const char *name, unsigned long type,
+		    unsigned int *count)
+{
+  struct elf_obj_tdata *tdata;
+  size_t lo, hi, first;
+
+  *count = 0;
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour
+      || (bfd_get_format (abfd) != bfd_object
+	  && bfd_get_format (abfd) != bfd_core))
+    {
+      bfd_set_error (bfd_error_wrong_format);
+      return NULL;
+    }
+  if (!elf_index_notes (abfd))
+    return NULL;
+
+  tdata = elf_tdata (abfd);
+
+  /* Find the first note that sorts at or after NAME and TYPE.  */
+  lo = 0;
+  hi = tdata->note_count;
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      const struct elf_note_info *note = &tdata->notes[mid];
+      int cmp = strcmp (note->name, name);
+
+      if (cmp < 0 || (cmp == 0 && note->type < type))
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  first = lo;
+
+  for (hi = first; hi < tdata->note_count; hi++)
+    if (tdata->notes[hi].type != type
+	|| strcmp (tdata->notes[hi].name, name) != 0)
+      break;
+
+  if (hi == first)
+    return NULL;
+  *count = hi - first;
+  return &tdata->notes[first];
+}
+
+/* Sort core file sections by address.  */
+
+static int
+compare_core_loads (const void *ap, const void *bp)
+{
+  const asection *a = *(const asection **) ap;
+  const asection *b = *(const asection **) bp;
+
+  if (a->vma != b->vma)
+    return a->vma < b->vma ? -1 : 1;
+  return a->index < b->index ? -1 : a->index > b->index;
+}
+
+/* Check that ABFD is an ELF core file and that its PT_LOAD sections
+   are sorted by address.  Return FALSE on error.  */
+
+static bool
+elf_core_index_loads (bfd *abfd)
+{
+  struct core_elf_obj_tdata *core;
+  asection *sec;
+  unsigned int count;
+
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour
+      || bfd_get_format (abfd) != bfd_core
+      || elf_tdata (abfd)->core == NULL)
+    {
+      bfd_set_error (bfd_error_wrong_format);
+      return false;
+    }
+
+  core = elf_tdata (abfd)->core;
+  if (core->loads_indexed)
+    return true;
+
+  /* Only the sections made for PT_LOAD segments are allocated.  */
+  count = 0;
+  for (sec = abfd->sections; sec != NULL; sec = sec->next)
+    if ((sec->flags & SEC_ALLOC) != 0 && sec->size != 0)
+      count++;
+
+  if (count != 0)
+    {
+      core->loads = (asection **) bfd_alloc (abfd,
+					     count * sizeof (*core->loads));
+      if (core->loads == NULL)
+	return false;
+      count = 0;
+      for (sec = abfd->sections; sec != NULL; sec = sec->next)
+	if ((sec->flags & SEC_ALLOC) != 0 && sec->size != 0)
+	  core->loads[count++] = sec;
+      qsort (core->loads, count, sizeof (*core->loads), compare_core_loads);
+    }
+  core->load_count = count;
+  core->loads_indexed = true;
+  return true;
+}
+
+/* Return the section of the indexed core file ABFD holding ADDR, or
+   NULL.  */
+
+static asection *
+elf_core_load_at (bfd *abfd, bfd_vma addr)
+{
+  struct core_elf_obj_tdata *core = elf_tdata (abfd)->core;
+  size_t lo = 0;
+  size_t hi = core->load_count;
+  asection *sec;
+
+  /* Find the last section that starts at or below ADDR.  */
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (core->loads[mid]->vma <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0)
+    return NULL;
+  sec = core->loads[lo - 1];
+  if (addr - sec->vma >= sec->size)
+    return NULL;
+  return sec;
+}
+
+/* Return the section of the core file ABFD that holds the process's
+   memory at ADDR, or NULL if ADDR was not mapped or on error.  The
+   sections are sorted by address on the first call, so each lookup
+   is a binary search however many segments the core has.  Nothing is
+   read from the segment; bfd_get_section_contents_view maps its
+   contents from the file when they are wanted.  */
+
+asection *
+bfd_elf_core_find_section (bfd *abfd, bfd_vma addr)
+{
+  if (!elf_core_index_loads (abfd))
+    return NULL;
+  return elf_core_load_at (abfd, addr);
+}
+
+/* Copy SIZE bytes of the process's memory at ADDR from the core file
+   ABFD to BUF.  The memory may span several segments.  Parts of a
+   segment that were not dumped read as zero.  Return FALSE if some
+   of the memory was not mapped, or on error.  */
+
+bool
+bfd_elf_core_read_memory (bfd *abfd, bfd_vma addr, void *buf,
+			  bfd_size_type size)
+{
+  bfd_byte *p = (bfd_byte *) buf;
+
+  if (!elf_core_index_loads (abfd))
+    return false;
+
+  while (size != 0)
+    {
+      asection *sec = elf_core_load_at (abfd, addr);
+      bfd_size_type count;
+
+      if (sec == NULL)
+	{
+	  bfd_set_error (bfd_error_invalid_operation);
+	  return false;
+	}
+      count = sec->size - (addr - sec->vma);
+      if (count > size)
+	count = size;
+      if (!bfd_get_section_contents (abfd, sec, p, addr - sec->vma, count))
+	return false;
+      p += count;
+      addr += count;
+      size -= count;
+    }
+  return true;
+}
+
+/* Return the file mapped at ADDR in the process of the core file
+   ABFD, according to its NT_FILE note, or NULL if there is none.  The
+   note is indexed when the core file is opened.  */
+
+const struct elf_core_file_mapping *
+bfd_elf_core_find_file_mapping (bfd *abfd, bfd_vma addr)
+{
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour
+      || bfd_get_format (abfd) != bfd_core
+      || elf_tdata (abfd)->core == NULL)
+    {
+      bfd_set_error (bfd_error_wrong_format);
+      return NULL;
+    }
+  return elf_core_file_mapping_at (abfd, addr);
+}
+
 /* Providing external access to the ELF program header table.  */
 
 /* Return an upper bound on the number of bytes required to store a
@@ -1926,6 +1926,7 @@ elf_x86_64_scan_relocs (bfd *abfd, struct bfd_link_info *info,
   const Elf_Internal_Rela *rel_end;
   bfd_byte *contents;
   bool converted;
+  bool maybe_relative_reloc;
 
   if (bfd_link_relocatable (info))
     return true;
@@ -1952,6 +1953,7 @@ elf_x86_64_scan_relocs (bfd *abfd, struct bfd_link_info *info,
   sym_hashes = elf_sym_hashes (abfd);
 
   converted = false;
+  maybe_relative_reloc = false;
 
   rel_end = relocs + sec->reloc_count;
   for (rel = relocs; rel < rel_end; rel++)
@@ -2071,6 +2073,14 @@ elf_x86_64_scan_relocs (bfd *abfd, struct bfd_link_info *info,
 	    converted = true;
 	}
 
+      /* Only GOT relocations and pointer-sized relocations, as left
+	 by the load conversion above, can be packed into DT_RELR by
+	 _bfd_x86_elf_link_relax_section.  */
+      if (X86_64_GOT_TYPE_P (r_type)
+	  || r_type == R_X86_64_64
+	  || r_type == R_X86_64_32)
+	maybe_relative_reloc = true;
+
       if (!_bfd_elf_x86_valid_reloc_p (sec, info, htab, rel, h, isym,
 				       symtab_hdr, &no_dynreloc))
 	return false;
@@ -2383,6 +2393,7 @@ elf_x86_64_scan_relocs (bfd *abfd, struct bfd_link_info *info,
 		     easily.  Oh well.  */
 		  asection *s;
 		  void **vpp;
+		  struct bfd_elf_section_cold *cold;
 
 		  isym = bfd_sym_from_r_symndx (&htab->elf.sym_cache,
 						abfd, r_symndx);
@@ -2393,9 +2404,13 @@ elf_x86_64_scan_relocs (bfd *abfd, struct bfd_link_info *info,
 		  if (s == NULL)
 		    s = sec;
 
+		  cold = _bfd_elf_section_cold (s);
+		  if (cold == NULL)
+		    goto error_return;
+
 		  /* Beware of type punned pointers vs strict aliasing
 		     rules.  */
-		  vpp = &(elf_section_data (s)->local_dynrel);
+		  vpp = &cold->local_dynrel;
 		  head = (struct elf_dyn_relocs **)vpp;
 		}
 
@@ -2441,6 +2456,11 @@ elf_x86_64_scan_relocs (bfd *abfd, struct bfd_link_info *info,
 	}
     }
 
+  /* Don't let the relaxation pass read the relocations again if none
+     of them can become a relative relocation.  */
+  if (info->enable_dt_relr && !maybe_relative_reloc)
+    sec->relative_reloc_packed = 1;
+
   if (elf_section_data (sec)->this_hdr.contents != contents)
     {
       if (!converted && !_bfd_link_keep_memory (info))
@@ -2504,17 +2524,235 @@ elf_x86_64_tpoff (struct bfd_link_info *info, bfd_vma address)
   return address - static_tls_size - htab->tls_sec->vma;
 }
 
-/* Relocate an x86_64 ELF section.  */
+/* The kinds of relocation elf_x86_64_relocate_fast applies itself.  */
+
+enum elf_x86_64_fast_kind
+{
+  fast_reloc_64,
+  fast_reloc_32,
+  fast_reloc_32s,
+  fast_reloc_pc32,
+  fast_reloc_kinds
+};
+
+/* Return the fast kind of REL, or fast_reloc_kinds if it must go
+   through elf_x86_64_relocate_section_1.  Set *VALUE to the symbol
+   value plus addend.  Only plain data relocations against local,
+   non-merged, non-IFUNC symbols qualify; anything involving the GOT,
+   PLT, TLS or a dynamic relocation is left alone.  */
+
+static enum elf_x86_64_fast_kind
+elf_x86_64_fast_reloc_kind (const Elf_Internal_Rela *rel,
+			    const Elf_Internal_Shdr *symtab_hdr,
+			    const Elf_Internal_Sym *local_syms,
+			    asection **local_sections,
+			    bfd_vma *value)
+{
+  enum elf_x86_64_fast_kind kind;
+  unsigned long r_symndx;
+  const Elf_Internal_Sym *sym;
+  asection *sec;
+
+  switch (ELF64_R_TYPE (rel->r_info))
+    {
+    case R_X86_64_64:
+      kind = fast_reloc_64;
+      break;
+    case R_X86_64_32:
+      kind = fast_reloc_32;
+      break;
+    case R_X86_64_32S:
+      kind = fast_reloc_32s;
+      break;
+    case R_X86_64_PC32:
+      kind = fast_reloc_pc32;
+      break;
+    default:
+      return fast_reloc_kinds;
+    }
+
+  r_symndx = ELF64_R_SYM (rel->r_info);
+  if (r_symndx >= symtab_hdr->sh_info)
+    return fast_reloc_kinds;
+
+  sym = local_syms + r_symndx;
+  sec = local_sections[r_symndx];
+  if (sec == NULL
+      || ELF_ST_TYPE (sym->st_info) == STT_GNU_IFUNC
+      || discarded_section (sec)
+      || sec->sec_info_type == SEC_INFO_TYPE_MERGE)
+    return fast_reloc_kinds;
+
+  *value = (sec->output_section->vma
+	    + sec->output_offset
+	    + sym->st_value
+	    + rel->r_addend);
+  return kind;
+}
+
+/* Apply the simple relocations of INPUT_SECTION directly, without
+   going through the howto machinery.  This only pays off, and is
+   only safe, for sections that are not loaded: there are no dynamic
+   relocations to emit for them, and debugging sections consist of
+   little else than R_X86_64_32 and R_X86_64_64 against local section
+   symbols.  The relocations are bucketed by kind and each bucket is
+   checked for overflow as a whole; a bucket where anything overflows
+   or is out of range is left for the general code, which reports it.
+   Return a map with a nonzero byte for each relocation that has been
+   applied, or NULL if none was.  */
+
+static bfd_byte *
+elf_x86_64_relocate_fast (bfd *output_bfd,
+			  struct bfd_link_info *info,
+			  bfd *input_bfd,
+			  asection *input_section,
+			  bfd_byte *contents,
+			  Elf_Internal_Rela *relocs,
+			  Elf_Internal_Sym *local_syms,
+			  asection **local_sections)
+{
+  Elf_Internal_Shdr *symtab_hdr;
+  size_t count, map_size, i, j;
+  size_t start[fast_reloc_kinds + 1];
+  size_t next[fast_reloc_kinds + 1];
+  bool ok[fast_reloc_kinds + 1];
+  bfd_byte *map;
+  bfd_vma *values;
+  size_t *order;
+  bfd_vma limit, pc_base;
+  bool applied;
+
+  count = input_section->reloc_count;
+  if (count == 0
+      || contents == NULL
+      || bfd_link_relocatable (info)
+      || !ABI_64_P (output_bfd)
+      || input_section->check_relocs_failed
+      || (input_section->flags & SEC_ALLOC) != 0
+      || input_section->sec_info_type != SEC_INFO_TYPE_NONE
+      || bfd_get_flavour (input_bfd) != bfd_target_elf_flavour
+      || elf_object_id (input_bfd) != X86_64_ELF_DATA)
+    return NULL;
+
+  /* MAP holds the kind of each relocation until the buckets have
+     been applied, and is followed by the values and the sorted
+     order.  */
+  map_size = (count + sizeof (bfd_vma) - 1) & ~(sizeof (bfd_vma) - 1);
+  map = (bfd_byte *) bfd_malloc (map_size
+				 + count * (sizeof (bfd_vma)
+					    + sizeof (size_t)));
+  if (map == NULL)
+    return NULL;
+  values = (bfd_vma *) (map + map_size);
+  order = (size_t *) (values + count);
+
+  symtab_hdr = &elf_symtab_hdr (input_bfd);
+  memset (start, 0, sizeof (start));
+  for (i = 0; i < count; i++)
+    {
+      map[i] = elf_x86_64_fast_reloc_kind (relocs + i, symtab_hdr,
+					   local_syms, local_sections,
+					   &values[i]);
+      start[map[i] + 1]++;
+    }
+  if (start[fast_reloc_kinds] == count)
+    {
+      free (map);
+      return NULL;
+    }
+
+  /* Sort the relocations by kind, keeping their order within each
+     kind.  */
+  for (j = 1; j <= fast_reloc_kinds; j++)
+    start[j] += start[j - 1];
+  memcpy (next, start, sizeof (next));
+  for (i = 0; i < count; i++)
+    if (map[i] != fast_reloc_kinds)
+      order[next[map[i]]++] = i;
+
+  limit = bfd_get_section_limit_octets (input_bfd, input_section);
+  pc_base = (input_section->output_section->vma
+	     + input_section->output_offset);
+  applied = false;
+  for (j = 0; j < fast_reloc_kinds; j++)
+    {
+      size_t first = start[j], last = start[j + 1];
+      bfd_vma size = j == fast_reloc_64 ? 8 : 4;
+      bfd_vma bad = limit < size;
+
+      ok[j] = false;
+      if (first == last || bad)
+	continue;
+
+      /* Check the whole bucket before touching the contents.  */
+      switch (j)
+	{
+	case fast_reloc_64:
+	  for (i = first; i < last; i++)
+	    bad |= relocs[order[i]].r_offset > limit - size;
+	  break;
+	case fast_reloc_32:
+	  for (i = first; i < last; i++)
+	    bad |= ((relocs[order[i]].r_offset > limit - size)
+		    | (values[order[i]] >> 32));
+	  break;
+	case fast_reloc_32s:
+	  for (i = first; i < last; i++)
+	    bad |= ((relocs[order[i]].r_offset > limit - size)
+		    | ((values[order[i]] + 0x80000000) >> 32));
+	  break;
+	case fast_reloc_pc32:
+	  for (i = first; i < last; i++)
+	    {
+	      bfd_vma off = relocs[order[i]].r_offset;
+
+	      values[order[i]] -= pc_base + off;
+	      bad |= ((off > limit - size)
+		      | ((values[order[i]] + 0x80000000) >> 32));
+	    }
+	  break;
+	}
+      if (bad != 0)
+	continue;
+
+      if (j == fast_reloc_64)
+	for (i = first; i < last; i++)
+	  bfd_put_64 (input_bfd, values[order[i]],
+		      contents + relocs[order[i]].r_offset);
+      else
+	for (i = first; i < last; i++)
+	  bfd_put_32 (input_bfd, values[order[i]],
+		      contents + relocs[order[i]].r_offset);
+      ok[j] = true;
+      applied = true;
+    }
+
+  if (!applied)
+    {
+      free (map);
+      return NULL;
+    }
+
+  /* Turn the kinds into the map of what has been applied.  */
+  ok[fast_reloc_kinds] = false;
+  for (i = 0; i < count; i++)
+    map[i] = ok[map[i]];
+  return map;
+}
+
+/* Relocate an x86_64 ELF section.  Relocations marked in DONE have
+   already been applied by elf_x86_64_relocate_fast.  */
 
 static int
-elf_x86_64_relocate_section (bfd *output_bfd,
-			     struct bfd_link_info *info,
-			     bfd *input_bfd,
-			     asection *input_section,
-			     bfd_byte *contents,
-			     Elf_Internal_Rela *relocs,
-			     Elf_Internal_Sym *local_syms,
-			     asection **local_sections)
+elf_x86_64_relocate_section_1 (bfd *output_bfd,
+			       struct bfd_link_info *info,
+			       bfd *input_bfd,
+			       asection *input_section,
+			       bfd_byte *contents,
+			       Elf_Internal_Rela *relocs,
+			       Elf_Internal_Sym *local_syms,
+			       asection **local_sections,
+			       const bfd_byte *done)
 {
   struct elf_x86_link_hash_table *htab;
   Elf_Internal_Shdr *symtab_hdr;
@@ -2576,7 +2814,8 @@ elf_x86_64_relocate_section (bfd *output_bfd,
 
       r_type = ELF32_R_TYPE (rel->r_info);
       if (r_type == (int) R_X86_64_GNU_VTINHERIT
-	  || r_type == (int) R_X86_64_GNU_VTENTRY)
+	  || r_type == (int) R_X86_64_GNU_VTENTRY
+	  || (done != NULL && done[rel - relocs]))
 	{
 	  if (wrel != rel)
 	    *wrel = *rel;
@@ -3452,7 +3691,7 @@ elf_x86_64_relocate_section (bfd *output_bfd,
 
 	      if (generate_dynamic_reloc)
 		{
-		  sreloc = elf_section_data (input_section)->sreloc;
+		  sreloc = elf_section_cold (input_section)->sreloc;
 
 		  if (sreloc == NULL || sreloc->contents == NULL)
 		    {
@@ -4280,6 +4519,32 @@ elf_x86_64_relocate_section (bfd *output_bfd,
   return status;
 }
 
+/* Relocate an x86_64 ELF section, applying the simple relocations of
+   unloaded sections in bulk first.  */
+
+static int
+elf_x86_64_relocate_section (bfd *output_bfd,
+			     struct bfd_link_info *info,
+			     bfd *input_bfd,
+			     asection *input_section,
+			     bfd_byte *contents,
+			     Elf_Internal_Rela *relocs,
+			     Elf_Internal_Sym *local_syms,
+			     asection **local_sections)
+{
+  bfd_byte *done;
+  int ret;
+
+  done = elf_x86_64_relocate_fast (output_bfd, info, input_bfd,
+				   input_section, contents, relocs,
+				   local_syms, local_sections);
+  ret = elf_x86_64_relocate_section_1 (output_bfd, info, input_bfd,
+				       input_section, contents, relocs,
+				       local_syms, local_sections, done);
+  free (done);
+  return ret;
+}
+
 /* Finish up dynamic symbol handling.  We set the contents of various
    dynamic sections here.  */
 
@@ -96,6 +96,7 @@
 #define elf_swap_reloca_in		NAME(bfd_elf,swap_reloca_in)
 #define elf_swap_reloc_out		NAME(bfd_elf,swap_reloc_out)
 #define elf_swap_reloca_out		NAME(bfd_elf,swap_reloca_out)
+#define elf_swap_relocs_in		NAME(bfd_elf,swap_relocs_in)
 #define elf_swap_symbol_in		NAME(bfd_elf,swap_symbol_in)
 #define elf_swap_symbol_out		NAME(bfd_elf,swap_symbol_out)
 #define elf_swap_phdr_in		NAME(bfd_elf,swap_phdr_in)
@@ -123,6 +124,7 @@
 #define elf_write_shdrs_and_ehdr	NAME(bfd_elf,write_shdrs_and_ehdr)
 #define elf_write_out_phdrs		NAME(bfd_elf,write_out_phdrs)
 #define elf_checksum_contents		NAME(bfd_elf,checksum_contents)
+#define elf_checksum_contents_tree	NAME(bfd_elf,checksum_contents_tree)
 #define elf_write_relocs		NAME(bfd_elf,write_relocs)
 #define elf_slurp_reloc_table		NAME(bfd_elf,slurp_reloc_table)
 
@@ -159,12 +161,18 @@ static void elf_debug_file (Elf_Internal_Ehdr *);
 #define H_PUT_SIGNED_WORD	H_PUT_S64
 #define H_GET_WORD		H_GET_64
 #define H_GET_SIGNED_WORD	H_GET_S64
+#define HOST_GET_WORD(p)	((bfd_vma) _bfd_host_get_64 (p))
+#define HOST_GET_SIGNED_WORD(p)	((bfd_signed_vma) (int64_t) _bfd_host_get_64 (p))
+#define GET_WORD_ARRAY		_bfd_get_64_array
 #endif
 #if ARCH_SIZE == 32
 #define H_PUT_WORD		H_PUT_32
 #define H_PUT_SIGNED_WORD	H_PUT_S32
 #define H_GET_WORD		H_GET_32
 #define H_GET_SIGNED_WORD	H_GET_S32
+#define HOST_GET_WORD(p)	((bfd_vma) _bfd_host_get_32 (p))
+#define HOST_GET_SIGNED_WORD(p)	((bfd_signed_vma) (int32_t) _bfd_host_get_32 (p))
+#define GET_WORD_ARRAY		_bfd_get_32_array
 #endif
 
 /* Translate an ELF symbol in external format into an ELF symbol in internal
@@ -179,21 +187,39 @@ elf_swap_symbol_in (bfd *abfd,
   const Elf_External_Sym *src = (const Elf_External_Sym *) psrc;
   const Elf_External_Sym_Shndx *shndx = (const Elf_External_Sym_Shndx *) pshn;
   int signed_vma = get_elf_backend_data (abfd)->sign_extend_vma;
+  bool host_order = _bfd_header_host_order_p (abfd);
 
-  dst->st_name = H_GET_32 (abfd, src->st_name);
-  if (signed_vma)
-    dst->st_value = H_GET_SIGNED_WORD (abfd, src->st_value);
+  /* Symbols in the host's byte order need not go through the target
+     vector for every field.  */
+  if (host_order)
+    {
+      dst->st_name = _bfd_host_get_32 (src->st_name);
+      if (signed_vma)
+	dst->st_value = HOST_GET_SIGNED_WORD (src->st_value);
+      else
+	dst->st_value = HOST_GET_WORD (src->st_value);
+      dst->st_size = HOST_GET_WORD (src->st_size);
+      dst->st_shndx = _bfd_host_get_16 (src->st_shndx);
+    }
   else
-    dst->st_value = H_GET_WORD (abfd, src->st_value);
-  dst->st_size = H_GET_WORD (abfd, src->st_size);
+    {
+      dst->st_name = H_GET_32 (abfd, src->st_name);
+      if (signed_vma)
+	dst->st_value = H_GET_SIGNED_WORD (abfd, src->st_value);
+      else
+	dst->st_value = H_GET_WORD (abfd, src->st_value);
+      dst->st_size = H_GET_WORD (abfd, src->st_size);
+      dst->st_shndx = H_GET_16 (abfd, src->st_shndx);
+    }
   dst->st_info = H_GET_8 (abfd, src->st_info);
   dst->st_other = H_GET_8 (abfd, src->st_other);
-  dst->st_shndx = H_GET_16 (abfd, src->st_shndx);
   if (dst->st_shndx == (SHN_XINDEX & 0xffff))
     {
       if (shndx == NULL)
 	return false;
-      dst->st_shndx = H_GET_32 (abfd, shndx->est_shndx);
+      dst->st_shndx = (host_order
+		       ? _bfd_host_get_32 (shndx->est_shndx)
+		       : H_GET_32 (abfd, shndx->est_shndx));
     }
   else if (dst->st_shndx >= (SHN_LORESERVE & 0xffff))
     dst->st_shndx += SHN_LORESERVE - (SHN_LORESERVE & 0xffff);
@@ -433,6 +459,53 @@ elf_swap_reloca_in (bfd *abfd,
   dst->r_addend = H_GET_SIGNED_WORD (abfd, src->r_addend);
 }
 
+/* Translate COUNT ELF relocs, each ENTSIZE bytes long, from external
+   format at S to internal format at DST.  The 64-bit RELA case is a
+   straight copy of the words, swapped in bulk if the file does not
+   have the host's byte order, and the others just split each record
+   into its fields, in a loop that compilers can vectorize.  */
+void
+elf_swap_relocs_in (bfd *abfd,
+		    const bfd_byte *s,
+		    size_t count,
+		    size_t entsize,
+		    Elf_Internal_Rela *dst)
+{
+#if ARCH_SIZE == 64
+  typedef uint64_t reloc_word;
+  typedef int64_t signed_reloc_word;
+#else
+  typedef uint32_t reloc_word;
+  typedef int32_t signed_reloc_word;
+#endif
+  bool rela = entsize == sizeof (Elf_External_Rela);
+  bool host_order = _bfd_header_host_order_p (abfd);
+  bool big_p = bfd_header_big_endian (abfd);
+  size_t nwords = rela ? 3 : 2;
+  size_t i;
+
+  if (rela
+      && sizeof (reloc_word) == sizeof (bfd_vma)
+      && sizeof (Elf_Internal_Rela) == sizeof (Elf_External_Rela))
+    {
+      GET_WORD_ARRAY (s, (reloc_word *) dst, count * nwords, big_p);
+      return;
+    }
+
+  for (i = 0; i < count; i++, s += entsize)
+    {
+      reloc_word w[3];
+
+      if (host_order)
+	memcpy (w, s, nwords * sizeof (w[0]));
+      else
+	GET_WORD_ARRAY (s, w, nwords, big_p);
+      dst[i].r_offset = w[0];
+      dst[i].r_info = w[1];
+      dst[i].r_addend = rela ? (bfd_vma) (signed_reloc_word) w[2] : 0;
+    }
+}
+
 /* Translate an ELF reloc from internal format to external format.  */
 void
 elf_swap_reloc_out (bfd *abfd,
@@ -713,14 +786,24 @@ elf_object_p (bfd *abfd)
       for (shdrp = i_shdrp, shindex = 0; shindex < num_sec; shindex++)
 	elf_elfsections (abfd)[shindex] = shdrp++;
 
-      /* Read in the rest of the section header table and convert it
-	 to internal form.  */
-      for (shindex = 1; shindex < i_ehdrp->e_shnum; shindex++)
+      /* Read in the rest of the section header table with a single
+	 read and convert it to internal form.  The sanity check above
+	 made sure that the file holds all of it.  */
+      if (num_sec > 1)
 	{
-	  if (bfd_bread (&x_shdr, sizeof x_shdr, abfd) != sizeof (x_shdr))
+	  Elf_External_Shdr *x_shdrs;
+
+	  amt = (num_sec - 1) * sizeof (*x_shdrs);
+	  x_shdrs = (Elf_External_Shdr *) _bfd_malloc_and_read (abfd, amt, amt);
+	  if (x_shdrs == NULL)
 	    goto got_no_match;
-	  elf_swap_shdr_in (abfd, &x_shdr, i_shdrp + shindex);
+	  for (shindex = 1; shindex < num_sec; shindex++)
+	    elf_swap_shdr_in (abfd, x_shdrs + shindex - 1, i_shdrp + shindex);
+	  free (x_shdrs);
+	}
 
+      for (shindex = 1; shindex < i_ehdrp->e_shnum; shindex++)
+	{
 	  /* Sanity check sh_link and sh_info.  */
 	  if (i_shdrp[shindex].sh_link >= num_sec)
 	    {
@@ -837,6 +920,12 @@ elf_object_p (bfd *abfd)
 	 can start processing them.  Note that the first section header is
 	 a dummy placeholder entry, so we ignore it.  */
       num_sec = elf_numsections (abfd);
+
+      /* Nearly every header becomes a BFD section, so size the section
+	 hash table for all of them now rather than growing it over and
+	 over.  Failing to do so is harmless.  */
+      bfd_hash_table_reserve (&abfd->section_htab, num_sec);
+
       for (shindex = 1; shindex < num_sec; shindex++)
 	if (!bfd_section_from_shdr (abfd, shindex))
 	  goto got_no_match;
@@ -1188,6 +1277,319 @@ elf_checksum_contents (bfd *abfd,
   return true;
 }
 
+/* elf_checksum_contents_tree hashes section contents in pieces of
+   this many bytes.  It is part of the definition of the result, so
+   must not depend on the host.  */
+#define ELF_CHECKSUM_CHUNK (1024 * 1024)
+
+/* Stop reading section contents in for hashing once this many bytes
+   are waiting, and hash those first.  */
+#define ELF_CHECKSUM_BATCH (64 * 1024 * 1024)
+
+/* One piece of the file hashed by elf_checksum_contents_tree.  */
+
+struct elf_checksum_leaf
+{
+  const bfd_byte *data;
+  size_t size;
+
+  /* Index of its digest.  */
+  size_t index;
+};
+
+/* The pieces waiting to be hashed, shared by the threads hashing
+   them.  */
+
+struct elf_checksum_job
+{
+  void (*hash) (const void *, size_t, void *);
+  size_t digest_size;
+  bfd_byte *digests;
+  struct elf_checksum_leaf *leaves;
+  size_t count;
+  size_t alloc;
+
+  /* Buffers read in for the waiting pieces, and their total size.  */
+  bfd_byte **buffers;
+  size_t nbuffers;
+  bfd_size_type buffered;
+};
+
+static bool
+elf_checksum_range (void *data, size_t start, size_t end)
+{
+  struct elf_checksum_job *job = (struct elf_checksum_job *) data;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    job->hash (job->leaves[i].data, job->leaves[i].size,
+	       job->digests + job->leaves[i].index * job->digest_size);
+  return true;
+}
+
+/* Hash the waiting pieces of JOB and release their buffers.  */
+
+static bool
+elf_checksum_flush (struct elf_checksum_job *job)
+{
+  bool ret = _bfd_parallel_for (job->count, 1, elf_checksum_range, job);
+
+  while (job->nbuffers != 0)
+    free (job->buffers[--job->nbuffers]);
+  job->count = 0;
+  job->buffered = 0;
+  return ret;
+}
+
+/* Queue SIZE bytes at DATA to be hashed as ceil(SIZE/CHUNK) pieces.
+   OWNED, if not NULL, is freed once they have been.  */
+
+static bool
+elf_checksum_add (struct elf_checksum_job *job, const bfd_byte *data,
+		  bfd_size_type size, bfd_size_type chunk, bfd_byte *owned,
+		  size_t *ndigests)
+{
+  bfd_size_type done;
+
+  for (done = 0; done == 0 || done < size; done += chunk)
+    {
+      struct elf_checksum_leaf *leaf;
+
+      if (job->count == job->alloc)
+	{
+	  size_t alloc = job->alloc * 2 + 64;
+	  void *p;
+
+	  p = bfd_realloc (job->leaves, alloc * sizeof (*job->leaves));
+	  if (p == NULL)
+	    goto fail;
+	  job->leaves = (struct elf_checksum_leaf *) p;
+	  p = bfd_realloc (job->buffers, alloc * sizeof (*job->buffers));
+	  if (p == NULL)
+	    goto fail;
+	  job->buffers = (bfd_byte **) p;
+	  job->alloc = alloc;
+	}
+      if ((*ndigests & (*ndigests + 1)) == 0)
+	{
+	  /* The digest count is about to pass a power of two.  */
+	  void *p = bfd_realloc (job->digests,
+				 (*ndigests + 1) * 2 * job->digest_size);
+
+	  if (p == NULL)
+	    goto fail;
+	  job->digests = (bfd_byte *) p;
+	}
+
+      leaf = &job->leaves[job->count++];
+      leaf->data = data + done;
+      leaf->size = size - done < chunk ? size - done : chunk;
+      leaf->index = (*ndigests)++;
+    }
+
+  if (owned != NULL)
+    {
+      job->buffers[job->nbuffers++] = owned;
+      job->buffered += size;
+    }
+  return true;
+
+ fail:
+  free (owned);
+  return false;
+}
+
+/* Like elf_checksum_contents, but hash the same bytes as a two-level
+   tree: HASH is applied to the headers and to each piece of at most
+   ELF_CHECKSUM_CHUNK bytes of each section's contents, separately and
+   on as many threads as bfd_set_thread_count allows, and then once
+   more to the concatenation of those digests, each DIGEST_SIZE bytes
+   long, to give DIGEST.  HASH must be safe to call from several
+   threads at once.  The result only depends on the file contents and
+   layout, not on the number of threads.  */
+
+bool
+elf_checksum_contents_tree (bfd *abfd,
+			    void (*hash) (const void *, size_t, void *),
+			    size_t digest_size,
+			    void *digest)
+{
+  Elf_Internal_Ehdr *i_ehdrp = elf_elfheader (abfd);
+  Elf_Internal_Shdr **i_shdrp = elf_elfsections (abfd);
+  Elf_Internal_Phdr *i_phdrp = elf_tdata (abfd)->phdr;
+  struct elf_checksum_job job;
+  unsigned int count, num;
+  size_t ndigests, amt;
+  bfd_byte *headers, *p;
+  bool ret = false;
+
+  memset (&job, 0, sizeof (job));
+  job.hash = hash;
+  job.digest_size = digest_size;
+  ndigests = 0;
+
+  /* The headers, as elf_checksum_contents sees them, form the first
+     piece.  */
+  num = elf_numsections (abfd);
+  amt = (sizeof (Elf_External_Ehdr)
+	 + i_ehdrp->e_phnum * sizeof (Elf_External_Phdr)
+	 + num * sizeof (Elf_External_Shdr));
+  headers = (bfd_byte *) bfd_malloc (amt);
+  if (headers == NULL)
+    return false;
+  p = headers;
+  {
+    Elf_Internal_Ehdr i_ehdr;
+
+    i_ehdr = *i_ehdrp;
+    i_ehdr.e_phoff = i_ehdr.e_shoff = 0;
+    elf_swap_ehdr_out (abfd, &i_ehdr, (Elf_External_Ehdr *) p);
+    p += sizeof (Elf_External_Ehdr);
+  }
+  for (count = 0; count < i_ehdrp->e_phnum; count++)
+    {
+      elf_swap_phdr_out (abfd, &i_phdrp[count], (Elf_External_Phdr *) p);
+      p += sizeof (Elf_External_Phdr);
+    }
+  for (count = 0; count < num; count++)
+    {
+      Elf_Internal_Shdr i_shdr;
+
+      i_shdr = *i_shdrp[count];
+      i_shdr.sh_offset = 0;
+      elf_swap_shdr_out (abfd, &i_shdr, (Elf_External_Shdr *) p);
+      p += sizeof (Elf_External_Shdr);
+    }
+  if (!elf_checksum_add (&job, headers, amt, amt, headers, &ndigests))
+    goto out;
+
+  for (count = 0; count < num; count++)
+    {
+      Elf_Internal_Shdr *i_shdr = i_shdrp[count];
+      bfd_byte *contents, *free_contents;
+
+      if (i_shdr->sh_type == SHT_NOBITS)
+	continue;
+      free_contents = NULL;
+      contents = i_shdr->contents;
+      if (contents == NULL)
+	{
+	  asection *sec;
+
+	  sec = bfd_section_from_elf_index (abfd, count);
+	  if (sec != NULL)
+	    {
+	      contents = sec->contents;
+	      if (contents == NULL)
+		{
+		  if (job.buffered >= ELF_CHECKSUM_BATCH
+		      && !elf_checksum_flush (&job))
+		    goto out;
+
+		  /* Force rereading from file.  */
+		  sec->flags &= ~SEC_IN_MEMORY;
+		  if (!bfd_malloc_and_get_section (abfd, sec, &free_contents))
+		    continue;
+		  contents = free_contents;
+		}
+	    }
+	}
+      if (contents != NULL
+	  && !elf_checksum_add (&job, contents, i_shdr->sh_size,
+				ELF_CHECKSUM_CHUNK, free_contents,
+				&ndigests))
+	goto out;
+    }
+
+  if (!elf_checksum_flush (&job))
+    goto out;
+  hash (job.digests, ndigests * digest_size, digest);
+  ret = true;
+
+ out:
+  while (job.nbuffers != 0)
+    free (job.buffers[--job.nbuffers]);
+  free (job.buffers);
+  free (job.leaves);
+  free (job.digests);
+  return ret;
+}
+
+/* The symbols elf_slurp_symbol_table is converting, shared by the
+   threads that convert them.  */
+
+struct elf_slurp_job
+{
+  bfd *abfd;
+  Elf_Internal_Shdr *hdr;
+  Elf_Internal_Sym *isymbuf;
+  Elf_External_Versym *xverbuf;
+  elf_symbol_type *symbase;
+  bool dynamic;
+};
+
+/* Convert the symbols from START to END of the elf_slurp_job DATA,
+   not counting the null symbol.  */
+
+static bool
+elf_slurp_symbol_range (void *data, size_t start, size_t end)
+{
+  struct elf_slurp_job *job = (struct elf_slurp_job *) data;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    {
+      Elf_Internal_Sym *isym = job->isymbuf + i + 1;
+      const Elf_External_Versym *xver = NULL;
+
+      if (job->xverbuf != NULL)
+	xver = job->xverbuf + i + 1;
+      if (!_bfd_elf_make_symbol (job->abfd, isym,
+				 bfd_elf_sym_name (job->abfd, job->hdr,
+						   isym, NULL),
+				 xver, job->dynamic, job->symbase + i))
+	return false;
+    }
+  return true;
+}
+
+/* Make sure that string table SHINDEX of ABFD, if there is one, has
+   been read.  Return FALSE if it couldn't be.  */
+
+static bool
+elf_slurp_load_strtab (bfd *abfd, unsigned int shindex)
+{
+  Elf_Internal_Shdr *hdr;
+
+  if (shindex == 0 || shindex >= elf_numsections (abfd))
+    return true;
+  hdr = elf_elfsections (abfd)[shindex];
+  if (hdr->sh_type != SHT_STRTAB || hdr->contents != NULL)
+    return true;
+  return bfd_elf_get_str_section (abfd, shindex) != NULL;
+}
+
+/* Return TRUE if the symbols of HDR in ABFD may be converted on
+   several threads.  Nothing may need BFD memory once that starts, so
+   read the string tables the names come from now.  */
+
+static bool
+elf_slurp_in_parallel (bfd *abfd, Elf_Internal_Shdr *hdr)
+{
+  if (bfd_get_thread_count () <= 1)
+    return false;
+
+  /* Common symbols of plugin BFDs go in a section made on demand.  */
+  if ((abfd->flags & BFD_PLUGIN) != 0)
+    return false;
+
+  return (elf_slurp_load_strtab (abfd, hdr->sh_link)
+	  && elf_slurp_load_strtab (abfd, elf_elfheader (abfd)->e_shstrndx));
+}
+
+/* The fewest symbols worth handing to a thread.  */
+#define ELF_SLURP_GRAIN 4096
+
 long long
 elf_slurp_symbol_table (bfd *abfd, asymbol **symptrs, bool dynamic)
 {
@@ -1196,12 +1598,10 @@ elf_slurp_symbol_table (bfd *abfd, asymbol **symptrs, bool dynamic)
   unsigned long long symcount;	/* Number of external ELF symbols */
   elf_symbol_type *sym;		/* Pointer to current bfd symbol */
   elf_symbol_type *symbase;	/* Buffer for generated bfd symbols */
-  Elf_Internal_Sym *isym;
-  Elf_Internal_Sym *isymend;
   Elf_Internal_Sym *isymbuf = NULL;
-  Elf_External_Versym *xver;
   Elf_External_Versym *xverbuf = NULL;
   const struct elf_backend_data *ebd;
+  struct elf_slurp_job job;
   size_t amt;
 
   /* Read each raw ELF symbol, converting from external ELF form to
@@ -1284,142 +1684,21 @@ elf_slurp_symbol_table (bfd *abfd, asymbol **symptrs, bool dynamic)
 	}
 
       /* Skip first symbol, which is a null dummy.  */
-      xver = xverbuf;
-      if (xver != NULL)
-	++xver;
-      isymend = isymbuf + symcount;
-      for (isym = isymbuf + 1, sym = symbase; isym < isymend; isym++, sym++)
+      job.abfd = abfd;
+      job.hdr = hdr;
+      job.isymbuf = isymbuf;
+      job.xverbuf = xverbuf;
+      job.symbase = symbase;
+      job.dynamic = dynamic;
+      if (elf_slurp_in_parallel (abfd, hdr))
 	{
-	  memcpy (&sym->internal_elf_sym, isym, sizeof (Elf_Internal_Sym));
-
-	  sym->symbol.the_bfd = abfd;
-	  sym->symbol.name = bfd_elf_sym_name (abfd, hdr, isym, NULL);
-	  sym->symbol.value = isym->st_value;
-
-	  if (isym->st_shndx == SHN_UNDEF)
-	    {
-	      sym->symbol.section = bfd_und_section_ptr;
-	    }
-	  else if (isym->st_shndx == SHN_ABS)
-	    {
-	      sym->symbol.section = bfd_abs_section_ptr;
-	    }
-	  else if (isym->st_shndx == SHN_COMMON)
-	    {
-	      sym->symbol.section = bfd_com_section_ptr;
-	      if ((abfd->flags & BFD_PLUGIN) != 0)
-		{
-		  asection *xc = bfd_get_section_by_name (abfd, "COMMON");
-
-		  if (xc == NULL)
-		    {
-		      flagword flags = (SEC_ALLOC | SEC_IS_COMMON | SEC_KEEP
-					| SEC_EXCLUDE);
-		      xc = bfd_make_section_with_flags (abfd, "COMMON", flags);
-		      if (xc == NULL)
-			goto error_return;
-		    }
-		  sym->symbol.section = xc;
-		}
-	      /* Elf puts the alignment into the `value' field, and
-		 the size into the `size' field.  BFD wants to see the
-		 size in the value field, and doesn't care (at the
-		 moment) about the alignment.  */
-	      sym->symbol.value = isym->st_size;
-	    }
-	  else
-	    {
-	      sym->symbol.section
-		= bfd_section_from_elf_index (abfd, isym->st_shndx);
-	      if (sym->symbol.section == NULL)
-		{
-		  /* This symbol is in a section for which we did not
-		     create a BFD section.  Just use bfd_abs_section,
-		     although it is wrong.  FIXME.  Note - there is
-		     code in elf.c:swap_out_syms that calls
-		     symbol_section_index() in the elf backend for
-		     cases like this.  */
-		  sym->symbol.section = bfd_abs_section_ptr;
-		}
-	    }
-
-	  /* If this is a relocatable file, then the symbol value is
-	     already section relative.  */
-	  if ((abfd->flags & (EXEC_P | DYNAMIC)) != 0)
-	    sym->symbol.value -= sym->symbol.section->vma;
-
-	  switch (ELF_ST_BIND (isym->st_info))
-	    {
-	    case STB_LOCAL:
-	      sym->symbol.flags |= BSF_LOCAL;
-	      break;
-	    case STB_GLOBAL:
-	      if (isym->st_shndx != SHN_UNDEF && isym->st_shndx != SHN_COMMON)
-		sym->symbol.flags |= BSF_GLOBAL;
-	      break;
-	    case STB_WEAK:
-	      sym->symbol.flags |= BSF_WEAK;
-	      break;
-	    case STB_GNU_UNIQUE:
-	      sym->symbol.flags |= BSF_GNU_UNIQUE;
-	      break;
-	    }
-
-	  switch (ELF_ST_TYPE (isym->st_info))
-	    {
-	    case STT_SECTION:
-	      /* Mark the input section symbol as used since it may be
-	         used for relocation and section group.
-		 NB: BSF_SECTION_SYM_USED is ignored by linker and may
-		 be cleared by objcopy for non-relocatable inputs.  */
-	      sym->symbol.flags |= (BSF_SECTION_SYM
-				    | BSF_DEBUGGING
-				    | BSF_SECTION_SYM_USED);
-	      break;
-	    case STT_FILE:
-	      sym->symbol.flags |= BSF_FILE | BSF_DEBUGGING;
-	      break;
-	    case STT_FUNC:
-	      sym->symbol.flags |= BSF_FUNCTION;
-	      break;
-	    case STT_COMMON:
-	      /* FIXME: Do we have to put the size field into the value field
-		 as we do with symbols in SHN_COMMON sections (see above) ?  */
-	      sym->symbol.flags |= BSF_ELF_COMMON;
-	      /* Fall through.  */
-	    case STT_OBJECT:
-	      sym->symbol.flags |= BSF_OBJECT;
-	      break;
-	    case STT_TLS:
-	      sym->symbol.flags |= BSF_THREAD_LOCAL;
-	      break;
-	    case STT_RELC:
-	      sym->symbol.flags |= BSF_RELC;
-	      break;
-	    case STT_SRELC:
-	      sym->symbol.flags |= BSF_SRELC;
-	      break;
-	    case STT_GNU_IFUNC:
-	      sym->symbol.flags |= BSF_GNU_INDIRECT_FUNCTION;
-	      break;
-	    }
-
-	  if (dynamic)
-	    sym->symbol.flags |= BSF_DYNAMIC;
-
-	  if (xver != NULL)
-	    {
-	      Elf_Internal_Versym iversym;
-
-	      _bfd_elf_swap_versym_in (abfd, xver, &iversym);
-	      sym->version = iversym.vs_vers;
-	      xver++;
-	    }
-
-	  /* Do some backend-specific processing on this symbol.  */
-	  if (ebd->elf_backend_symbol_processing)
-	    (*ebd->elf_backend_symbol_processing) (abfd, &sym->symbol);
+	  if (!_bfd_parallel_for (symcount - 1, ELF_SLURP_GRAIN,
+				  elf_slurp_symbol_range, &job))
+	    goto error_return;
 	}
+      else if (!elf_slurp_symbol_range (&job, 0, symcount - 1))
+	goto error_return;
+      sym = symbase + symcount - 1;
     }
 
   /* Do some backend-specific processing on this symbol table.  */
@@ -1456,33 +1735,27 @@ elf_slurp_symbol_table (bfd *abfd, asymbol **symptrs, bool dynamic)
   return -1;
 }
 
-/* Read relocations for ASECT from REL_HDR.  There are RELOC_COUNT of
-   them.  */
+/* Convert the relocations for ASECT read from REL_HDR into
+   NATIVE_RELOCS.  There are RELOC_COUNT of them.  */
 
 static bool
 elf_slurp_reloc_table_from_section (bfd *abfd,
 				    asection *asect,
 				    Elf_Internal_Shdr *rel_hdr,
+				    bfd_byte *native_relocs,
 				    bfd_size_type reloc_count,
 				    arelent *relents,
 				    asymbol **symbols,
 				    bool dynamic)
 {
   const struct elf_backend_data * const ebd = get_elf_backend_data (abfd);
-  void *allocated = NULL;
-  bfd_byte *native_relocs;
   arelent *relent;
   unsigned int i;
   int entsize;
   unsigned int symcount;
-
-  if (bfd_seek (abfd, rel_hdr->sh_offset, SEEK_SET) != 0)
-    return false;
-  allocated = _bfd_malloc_and_read (abfd, rel_hdr->sh_size, rel_hdr->sh_size);
-  if (allocated == NULL)
-    return false;
-
-  native_relocs = (bfd_byte *) allocated;
+  /* Relocs are swapped in batches of this many.  */
+  Elf_Internal_Rela batch[256];
+  unsigned int nbatch = sizeof (batch) / sizeof (batch[0]);
 
   entsize = rel_hdr->sh_entsize;
   BFD_ASSERT (entsize == sizeof (Elf_External_Rel)
@@ -1495,15 +1768,19 @@ elf_slurp_reloc_table_from_section (bfd *abfd,
 
   for (i = 0, relent = relents;
        i < reloc_count;
-       i++, relent++, native_relocs += entsize)
+       i++, relent++)
     {
       bool res;
       Elf_Internal_Rela rela;
 
-      if (entsize == sizeof (Elf_External_Rela))
-	elf_swap_reloca_in (abfd, native_relocs, &rela);
-      else
-	elf_swap_reloc_in (abfd, native_relocs, &rela);
+      if (i % nbatch == 0)
+	{
+	  size_t n = reloc_count - i < nbatch ? reloc_count - i : nbatch;
+
+	  elf_swap_relocs_in (abfd, native_relocs, n, entsize, batch);
+	  native_relocs += n * entsize;
+	}
+      rela = batch[i % nbatch];
 
       /* The address of an ELF reloc is section relative for an object
 	 file, and absolute for an executable file or shared library.
@@ -1546,15 +1823,10 @@ elf_slurp_reloc_table_from_section (bfd *abfd,
 	res = ebd->elf_info_to_howto_rel (abfd, relent, &rela);
 
       if (! res || relent->howto == NULL)
-	goto error_return;
+	return false;
     }
 
-  free (allocated);
   return true;
-
- error_return:
-  free (allocated);
-  return false;
 }
 
 /* Read in and swap the external relocs.  */
@@ -1573,6 +1845,9 @@ elf_slurp_reloc_table (bfd *abfd,
   bfd_size_type reloc_count2;
   arelent *relents;
   size_t amt;
+  ufile_ptr filesize;
+  struct bfd_read_range ranges[2];
+  unsigned int i, nranges = 0;
 
   if (asect->relocation != NULL)
     return true;
@@ -1619,25 +1894,58 @@ elf_slurp_reloc_table (bfd *abfd,
   if (relents == NULL)
     return false;
 
+  /* Read the REL and RELA sections with one request.  */
+  filesize = bfd_get_file_size (abfd);
+  for (i = 0; i < 2; i++)
+    {
+      Elf_Internal_Shdr *hdr = i == 0 ? rel_hdr : rel_hdr2;
+
+      if (hdr == NULL)
+	continue;
+      if (filesize != 0 && hdr->sh_size > filesize)
+	{
+	  bfd_set_error (bfd_error_file_truncated);
+	  goto error_return;
+	}
+      ranges[nranges].offset = hdr->sh_offset;
+      ranges[nranges].size = hdr->sh_size;
+      ranges[nranges].buf = bfd_malloc (hdr->sh_size);
+      if (ranges[nranges].buf == NULL)
+	goto error_return;
+      nranges++;
+    }
+  if (!bfd_bread_vector (abfd, ranges, nranges))
+    goto error_return;
+
+  i = 0;
   if (rel_hdr
       && !elf_slurp_reloc_table_from_section (abfd, asect,
-					      rel_hdr, reloc_count,
-					      relents,
+					      rel_hdr, ranges[i++].buf,
+					      reloc_count, relents,
 					      symbols, dynamic))
-    return false;
+    goto error_return;
 
   if (rel_hdr2
       && !elf_slurp_reloc_table_from_section (abfd, asect,
-					      rel_hdr2, reloc_count2,
+					      rel_hdr2, ranges[i].buf,
+					      reloc_count2,
 					      relents + reloc_count,
 					      symbols, dynamic))
-    return false;
+    goto error_return;
+
+  for (i = 0; i < nranges; i++)
+    free (ranges[i].buf);
 
   if (!bed->slurp_secondary_relocs (abfd, asect, symbols, dynamic))
     return false;
 
   asect->relocation = relents;
   return true;
+
+ error_return:
+  for (i = 0; i < nranges; i++)
+    free (ranges[i].buf);
+  return false;
 }
 
 #if DEBUG & 2
@@ -1942,6 +2250,7 @@ NAME(_bfd_elf,bfd_from_remote_memory)
   nbfd->xvec = templ->xvec;
   bim->size = high_offset;
   bim->buffer = contents;
+  bim->capacity = high_offset;
   nbfd->iostream = bim;
   nbfd->flags = BFD_IN_MEMORY;
   nbfd->iovec = &_bfd_memory_iovec;
@@ -2000,5 +2309,7 @@ const struct elf_size_info NAME(_bfd_elf,size_info) = {
   elf_swap_reloc_in,
   elf_swap_reloc_out,
   elf_swap_reloca_in,
-  elf_swap_reloca_out
+  elf_swap_reloca_out,
+  elf_swap_relocs_in,
+  elf_checksum_contents_tree
 };
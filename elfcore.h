@@ -306,7 +306,7 @@ NAME(_bfd_elf, core_find_build_id)
 {
   Elf_External_Ehdr x_ehdr;	/* Elf file header, external form.   */
   Elf_Internal_Ehdr i_ehdr;	/* Elf file header, internal form.   */
-  Elf_Internal_Phdr *i_phdr;
+  Elf_External_Phdr *x_phdrs;
   unsigned int i;
   size_t amt;
 
@@ -357,43 +357,38 @@ NAME(_bfd_elf, core_find_build_id)
   if (i_ehdr.e_phentsize != sizeof (Elf_External_Phdr) || i_ehdr.e_phnum == 0)
     goto fail;
 
-  /* Read in program headers.  */
-  if (_bfd_mul_overflow (i_ehdr.e_phnum, sizeof (*i_phdr), &amt))
+  /* Read in the program headers in one go.  */
+  if (_bfd_mul_overflow (i_ehdr.e_phnum, sizeof (*x_phdrs), &amt))
     {
       bfd_set_error (bfd_error_file_too_big);
       goto fail;
     }
-  i_phdr = (Elf_Internal_Phdr *) bfd_alloc (abfd, amt);
-  if (i_phdr == NULL)
-    goto fail;
-
   if (bfd_seek (abfd, (file_ptr) (offset + i_ehdr.e_phoff), SEEK_SET) != 0)
     goto fail;
+  x_phdrs = (Elf_External_Phdr *) _bfd_malloc_and_read (abfd, amt, amt);
+  if (x_phdrs == NULL)
+    goto fail;
 
-  /* Read in program headers and parse notes.  */
-  for (i = 0; i < i_ehdr.e_phnum; ++i, ++i_phdr)
+  /* Parse the notes.  */
+  for (i = 0; i < i_ehdr.e_phnum; ++i)
     {
-      Elf_External_Phdr x_phdr;
+      Elf_Internal_Phdr i_phdr;
 
-      if (bfd_bread (&x_phdr, sizeof (x_phdr), abfd) != sizeof (x_phdr))
-	goto fail;
-      elf_swap_phdr_in (abfd, &x_phdr, i_phdr);
+      elf_swap_phdr_in (abfd, &x_phdrs[i], &i_phdr);
 
-      if (i_phdr->p_type == PT_NOTE && i_phdr->p_filesz > 0)
+      if (i_phdr.p_type == PT_NOTE && i_phdr.p_filesz > 0)
 	{
-	  elf_read_notes (abfd, offset + i_phdr->p_offset,
-			  i_phdr->p_filesz, i_phdr->p_align);
-
-	  /* Make sure ABFD returns to processing the program headers.  */
-	  if (bfd_seek (abfd, (file_ptr) (offset + i_ehdr.e_phoff
-					  + (i + 1) * sizeof (x_phdr)),
-			SEEK_SET) != 0)
-	    goto fail;
+	  elf_read_notes (abfd, offset + i_phdr.p_offset,
+			  i_phdr.p_filesz, i_phdr.p_align);
 
 	  if (abfd->build_id != NULL)
-	    return true;
+	    {
+	      free (x_phdrs);
+	      return true;
+	    }
 	}
     }
+  free (x_phdrs);
 
   /* Having gotten this far, we have a valid ELF section, but no
      build-id was found.  */
@@ -62,6 +62,27 @@ struct elf_find_verdep_info
 static bool _bfd_elf_fix_symbol_flags
   (struct elf_link_hash_entry *, struct elf_info_failed *);
 
+const struct elf_link_hash_cold _bfd_elf_link_hash_no_cold;
+
+/* Return the cold record of H for writing, first giving H one of its
+   own, allocated on ABFD, if it has none.  Returns NULL if memory runs
+   out.  */
+
+static struct elf_link_hash_cold *
+elf_link_hash_cold (bfd *abfd, struct elf_link_hash_entry *h)
+{
+  struct elf_link_hash_cold *cold;
+
+  if (elf_link_hash_has_cold (h))
+    return h->cold;
+
+  cold = (struct elf_link_hash_cold *) bfd_zalloc (abfd, sizeof (*cold));
+  if (cold == NULL)
+    return NULL;
+  h->cold = cold;
+  return cold;
+}
+
 asection *
 _bfd_elf_section_for_symbol (struct elf_reloc_cookie *cookie,
 			     unsigned long long r_symndx,
@@ -582,7 +603,15 @@ bfd_elf_link_record_dynamic_symbol (struct bfd_link_info *info,
 	   an ELF string table read from a file, or to objalloc memory.  */
 	*p = 0;
 
-      indx = _bfd_elf_strtab_add (dynstr, name, p != NULL);
+      if (p == NULL)
+	/* The name is the whole of the symbol string, so its hash code
+	   is already known.  */
+	indx = _bfd_elf_strtab_add_with_hash
+	  (dynstr, name, h->root.root.hash,
+	   bfd_hash_table_function (&elf_hash_table (info)->root.table),
+	   false);
+      else
+	indx = _bfd_elf_strtab_add (dynstr, name, true);
 
       if (p != NULL)
 	*p = ELF_VER_CHR;
@@ -721,8 +750,8 @@ bfd_elf_record_link_assignment (bfd *output_bfd,
      by a regular object, then clear out any version information because
      the symbol will not be associated with the dynamic object any
      more.  */
-  if (h->def_dynamic && !h->def_regular)
-    h->verinfo.verdef = NULL;
+  if (h->def_dynamic && !h->def_regular && elf_link_hash_has_cold (h))
+    h->cold->verinfo.verdef = NULL;
 
   /* Make sure this symbol is not garbage collected.  */
   h->mark = 1;
@@ -1791,11 +1820,11 @@ _bfd_elf_merge_symbol (bfd *abfd,
 
       if (hi->root.type == bfd_link_hash_indirect)
 	flip = hi;
-      else
+      else if (elf_link_hash_has_cold (h))
 	/* This union may have been set to be non-NULL when this symbol
 	   was seen in a dynamic object.  We must force the union to be
 	   NULL, so that it is correct for a regular symbol.  */
-	h->verinfo.vertree = NULL;
+	h->cold->verinfo.vertree = NULL;
     }
 
   /* Handle the special case of a new common symbol merging with an
@@ -1836,8 +1865,8 @@ _bfd_elf_merge_symbol (bfd *abfd,
 
       if (hi->root.type == bfd_link_hash_indirect)
 	flip = hi;
-      else
-	h->verinfo.vertree = NULL;
+      else if (elf_link_hash_has_cold (h))
+	h->cold->verinfo.vertree = NULL;
     }
 
   if (flip != NULL)
@@ -1959,21 +1988,30 @@ _bfd_elf_add_default_symbol (bfd *abfd,
 	 undecorated symbol.  This isn't ideal because we may not yet
 	 have seen symbol versions, if given by a script on the
 	 command line rather than via --version-script.  */
-      if (hi->verinfo.vertree == NULL && info->version_info != NULL)
+      if (hi->cold->verinfo.vertree == NULL && info->version_info != NULL)
 	{
+	  struct bfd_elf_version_tree *t;
 	  bool hide;
 
-	  hi->verinfo.vertree
-	    = bfd_find_version_for_sym (info->version_info,
+	  t = bfd_find_version_for_sym (info->version_info,
 					hi->root.root.string, &hide);
-	  if (hi->verinfo.vertree != NULL && hide)
+	  if (t != NULL)
 	    {
-	      (*bed->elf_backend_hide_symbol) (info, hi, true);
-	      goto nondefault;
+	      struct elf_link_hash_cold *cold;
+
+	      cold = elf_link_hash_cold (info->output_bfd, hi);
+	      if (cold == NULL)
+		return false;
+	      cold->verinfo.vertree = t;
+	      if (hide)
+		{
+		  (*bed->elf_backend_hide_symbol) (info, hi, true);
+		  goto nondefault;
+		}
 	    }
 	}
-      if (hi->verinfo.vertree != NULL
-	  && strcmp (p + 1 + (p[1] == '@'), hi->verinfo.vertree->name) != 0)
+      if (hi->cold->verinfo.vertree != NULL
+	  && strcmp (p + 1 + (p[1] == '@'), hi->cold->verinfo.vertree->name) != 0)
 	goto nondefault;
     }
 
@@ -2315,8 +2353,8 @@ _bfd_elf_link_find_version_dependencies (struct elf_link_hash_entry *h,
   if (!h->def_dynamic
       || h->def_regular
       || h->dynindx == -1
-      || h->verinfo.verdef == NULL
-      || (elf_dyn_lib_class (h->verinfo.verdef->vd_bfd)
+      || h->cold->verinfo.verdef == NULL
+      || (elf_dyn_lib_class (h->cold->verinfo.verdef->vd_bfd)
 	  & (DYN_AS_NEEDED | DYN_DT_NEEDED | DYN_NO_NEEDED)))
     return true;
 
@@ -2325,11 +2363,11 @@ _bfd_elf_link_find_version_dependencies (struct elf_link_hash_entry *h,
        t != NULL;
        t = t->vn_nextref)
     {
-      if (t->vn_bfd != h->verinfo.verdef->vd_bfd)
+      if (t->vn_bfd != h->cold->verinfo.verdef->vd_bfd)
 	continue;
 
       for (a = t->vn_auxptr; a != NULL; a = a->vna_nextptr)
-	if (a->vna_nodename == h->verinfo.verdef->vd_nodename)
+	if (a->vna_nodename == h->cold->verinfo.verdef->vd_nodename)
 	  return true;
 
       break;
@@ -2347,7 +2385,7 @@ _bfd_elf_link_find_version_dependencies (struct elf_link_hash_entry *h,
 	  return false;
 	}
 
-      t->vn_bfd = h->verinfo.verdef->vd_bfd;
+      t->vn_bfd = h->cold->verinfo.verdef->vd_bfd;
       t->vn_nextref = elf_tdata (rinfo->info->output_bfd)->verref;
       elf_tdata (rinfo->info->output_bfd)->verref = t;
     }
@@ -2364,15 +2402,15 @@ _bfd_elf_link_find_version_dependencies (struct elf_link_hash_entry *h,
      above.  If bfd_elf_string_from_elf_section is ever changed to
      discard the string data when low in memory, this will have to be
      fixed.  */
-  a->vna_nodename = h->verinfo.verdef->vd_nodename;
+  a->vna_nodename = h->cold->verinfo.verdef->vd_nodename;
 
-  a->vna_flags = h->verinfo.verdef->vd_flags;
+  a->vna_flags = h->cold->verinfo.verdef->vd_flags;
   a->vna_nextptr = t->vn_auxptr;
 
-  h->verinfo.verdef->vd_exp_refno = rinfo->vers;
+  h->cold->verinfo.verdef->vd_exp_refno = rinfo->vers;
   ++rinfo->vers;
 
-  a->vna_other = h->verinfo.verdef->vd_exp_refno + 1;
+  a->vna_other = h->cold->verinfo.verdef->vd_exp_refno + 1;
 
   t->vn_auxptr = a;
 
@@ -2390,6 +2428,7 @@ _bfd_elf_link_hide_versioned_symbol (struct bfd_link_info *info,
 				     bool *hide)
 {
   struct bfd_elf_version_tree *t;
+  struct elf_link_hash_cold *cold;
 
   /* Look for the version.  If we find it, it is no longer weak.  */
   for (t = info->version_info; t != NULL; t = t->next)
@@ -2409,7 +2448,10 @@ _bfd_elf_link_hide_versioned_symbol (struct bfd_link_info *info,
 	  if (alc[len - 2] == ELF_VER_CHR)
 	    alc[len - 2] = '\0';
 
-	  h->verinfo.vertree = t;
+	  cold = elf_link_hash_cold (info->output_bfd, h);
+	  if (cold == NULL)
+	    return false;
+	  cold->verinfo.vertree = t;
 	  t->used = true;
 	  d = NULL;
 
@@ -2453,7 +2495,7 @@ _bfd_elf_link_hide_sym_by_version (struct bfd_link_info *info,
     return true;
 
   p = strchr (h->root.root.string, ELF_VER_CHR);
-  if (p != NULL && h->verinfo.vertree == NULL)
+  if (p != NULL && h->cold->verinfo.vertree == NULL)
     {
       struct bfd_elf_version_tree *t;
 
@@ -2473,15 +2515,21 @@ _bfd_elf_link_hide_sym_by_version (struct bfd_link_info *info,
 
   /* If we don't have a version for this symbol, see if we can find
      something.  */
-  if (h->verinfo.vertree == NULL && info->version_info != NULL)
+  if (h->cold->verinfo.vertree == NULL && info->version_info != NULL)
     {
-      h->verinfo.vertree
-	= bfd_find_version_for_sym (info->version_info,
+      struct bfd_elf_version_tree *t;
+      struct elf_link_hash_cold *cold;
+
+      t = bfd_find_version_for_sym (info->version_info,
 				    h->root.root.string, &hide);
-      if (h->verinfo.vertree != NULL && hide)
+      if (t != NULL && (cold = elf_link_hash_cold (info->output_bfd, h)))
 	{
-	  (*bed->elf_backend_hide_symbol) (info, h, true);
-	  return true;
+	  cold->verinfo.vertree = t;
+	  if (hide)
+	    {
+	      (*bed->elf_backend_hide_symbol) (info, h, true);
+	      return true;
+	    }
 	}
     }
 
@@ -2500,6 +2548,7 @@ _bfd_elf_link_assign_sym_version (struct elf_link_hash_entry *h, void *data)
   struct bfd_link_info *info;
   const struct elf_backend_data *bed;
   struct elf_info_failed eif;
+  struct elf_link_hash_cold *cold;
   char *p;
   bool hide;
 
@@ -2532,7 +2581,7 @@ _bfd_elf_link_assign_sym_version (struct elf_link_hash_entry *h, void *data)
 
   hide = false;
   p = strchr (h->root.root.string, ELF_VER_CHR);
-  if (p != NULL && h->verinfo.vertree == NULL)
+  if (p != NULL && h->cold->verinfo.vertree == NULL)
     {
       struct bfd_elf_version_tree *t;
 
@@ -2590,7 +2639,13 @@ _bfd_elf_link_assign_sym_version (struct elf_link_hash_entry *h, void *data)
 
 	  *pp = t;
 
-	  h->verinfo.vertree = t;
+	  cold = elf_link_hash_cold (info->output_bfd, h);
+	  if (cold == NULL)
+	    {
+	      sinfo->failed = true;
+	      return false;
+	    }
+	  cold->verinfo.vertree = t;
 	}
       else if (t == NULL)
 	{
@@ -2609,14 +2664,25 @@ _bfd_elf_link_assign_sym_version (struct elf_link_hash_entry *h, void *data)
   /* If we don't have a version for this symbol, see if we can find
      something.  */
   if (!hide
-      && h->verinfo.vertree == NULL
+      && h->cold->verinfo.vertree == NULL
       && sinfo->info->version_info != NULL)
     {
-      h->verinfo.vertree
-	= bfd_find_version_for_sym (sinfo->info->version_info,
+      struct bfd_elf_version_tree *t;
+
+      t = bfd_find_version_for_sym (sinfo->info->version_info,
 				    h->root.root.string, &hide);
-      if (h->verinfo.vertree != NULL && hide)
-	(*bed->elf_backend_hide_symbol) (info, h, true);
+      if (t != NULL)
+	{
+	  cold = elf_link_hash_cold (info->output_bfd, h);
+	  if (cold == NULL)
+	    {
+	      sinfo->failed = true;
+	      return false;
+	    }
+	  cold->verinfo.vertree = t;
+	  if (hide)
+	    (*bed->elf_backend_hide_symbol) (info, h, true);
+	}
     }
 
   return true;
@@ -2671,6 +2737,16 @@ elf_link_read_relocs_from_section (bfd *abfd,
     }
 
   erela = (const bfd_byte *) external_relocs;
+
+  /* Swap the lot at once if we can, and just check them below.  */
+  if (bed->s->swap_relocs_in != NULL && bed->s->int_rels_per_ext_rel == 1)
+    {
+      (*bed->s->swap_relocs_in) (abfd, erela,
+				 shdr->sh_size / shdr->sh_entsize,
+				 shdr->sh_entsize, internal_relocs);
+      swap_in = NULL;
+    }
+
   /* Setting erelaend like this and comparing with <= handles case of
      a fuzzed object with sh_size not a multiple of sh_entsize.  */
   erelaend = erela + shdr->sh_size - shdr->sh_entsize;
@@ -2679,7 +2755,8 @@ elf_link_read_relocs_from_section (bfd *abfd,
     {
       bfd_vma r_symndx;
 
-      (*swap_in) (abfd, erela, irela);
+      if (swap_in != NULL)
+	(*swap_in) (abfd, erela, irela);
       r_symndx = ELF32_R_SYM (irela->r_info);
       if (bed->s->arch_size == 64)
 	r_symndx >>= 24;
@@ -2716,6 +2793,241 @@ elf_link_read_relocs_from_section (bfd *abfd,
   return true;
 }
 
+/* Swapped relocs, kept so that the several passes of a link that
+   look at a section's relocs need only read them once even when the
+   linker isn't keeping memory.  Callers get a copy, so they remain
+   free to edit or free what they are given, and entries can be
+   dropped at any time.  Once the cache holds BUDGET bytes, the least
+   recently used entries make way for new ones.  */
+
+struct elf_reloc_cache_entry
+{
+  asection *sec;
+  Elf_Internal_Rela *relocs;
+  bfd_size_type size;
+  /* The next entry in the same bucket.  */
+  struct elf_reloc_cache_entry *hash_next;
+  /* Neighbours in order of use, most recent first.  */
+  struct elf_reloc_cache_entry *lru_prev;
+  struct elf_reloc_cache_entry *lru_next;
+};
+
+struct elf_reloc_cache
+{
+  bfd_size_type budget;
+  bfd_size_type used;
+  struct elf_reloc_cache_entry **buckets;
+  size_t nbuckets;
+  size_t count;
+  struct elf_reloc_cache_entry *mru;
+  struct elf_reloc_cache_entry *lru;
+  unsigned long long hits;
+  unsigned long long misses;
+};
+
+static size_t
+elf_reloc_cache_bucket (struct elf_reloc_cache *cache, asection *sec)
+{
+  return (sec->id * 2654435761u) & (cache->nbuckets - 1);
+}
+
+static void
+elf_reloc_cache_unlink (struct elf_reloc_cache *cache,
+			struct elf_reloc_cache_entry *ent)
+{
+  if (ent->lru_prev != NULL)
+    ent->lru_prev->lru_next = ent->lru_next;
+  else
+    cache->mru = ent->lru_next;
+  if (ent->lru_next != NULL)
+    ent->lru_next->lru_prev = ent->lru_prev;
+  else
+    cache->lru = ent->lru_prev;
+}
+
+static void
+elf_reloc_cache_link_mru (struct elf_reloc_cache *cache,
+			  struct elf_reloc_cache_entry *ent)
+{
+  ent->lru_prev = NULL;
+  ent->lru_next = cache->mru;
+  if (cache->mru != NULL)
+    cache->mru->lru_prev = ent;
+  else
+    cache->lru = ent;
+  cache->mru = ent;
+}
+
+/* Drop the least recently used entry of CACHE.  */
+
+static void
+elf_reloc_cache_evict (struct elf_reloc_cache *cache)
+{
+  struct elf_reloc_cache_entry *ent = cache->lru;
+  struct elf_reloc_cache_entry **pp;
+
+  elf_reloc_cache_unlink (cache, ent);
+  for (pp = &cache->buckets[elf_reloc_cache_bucket (cache, ent->sec)];
+       *pp != ent;
+       pp = &(*pp)->hash_next)
+    ;
+  *pp = ent->hash_next;
+  cache->used -= ent->size;
+  cache->count--;
+  free (ent->relocs);
+  free (ent);
+}
+
+static struct elf_reloc_cache_entry *
+elf_reloc_cache_find (struct elf_reloc_cache *cache, asection *sec)
+{
+  struct elf_reloc_cache_entry *ent;
+
+  for (ent = cache->buckets[elf_reloc_cache_bucket (cache, sec)];
+       ent != NULL;
+       ent = ent->hash_next)
+    if (ent->sec == sec)
+      {
+	elf_reloc_cache_unlink (cache, ent);
+	elf_reloc_cache_link_mru (cache, ent);
+	return ent;
+      }
+  return NULL;
+}
+
+/* Keep a copy of the SIZE bytes of relocs at RELOCS for SEC, if they
+   fit.  Failure to keep them is not an error.  */
+
+static void
+elf_reloc_cache_insert (struct elf_reloc_cache *cache, asection *sec,
+			const Elf_Internal_Rela *relocs, bfd_size_type size)
+{
+  struct elf_reloc_cache_entry *ent;
+  size_t b;
+
+  if (size > cache->budget)
+    return;
+  while (cache->used + size > cache->budget)
+    elf_reloc_cache_evict (cache);
+
+  if (cache->count >= cache->nbuckets)
+    {
+      size_t nbuckets = cache->nbuckets * 2;
+      struct elf_reloc_cache_entry **buckets, *next;
+      size_t i;
+
+      buckets = (struct elf_reloc_cache_entry **)
+	bfd_zmalloc (nbuckets * sizeof (*buckets));
+      if (buckets == NULL)
+	return;
+      for (i = 0; i < cache->nbuckets; i++)
+	for (ent = cache->buckets[i]; ent != NULL; ent = next)
+	  {
+	    next = ent->hash_next;
+	    b = (ent->sec->id * 2654435761u) & (nbuckets - 1);
+	    ent->hash_next = buckets[b];
+	    buckets[b] = ent;
+	  }
+      free (cache->buckets);
+      cache->buckets = buckets;
+      cache->nbuckets = nbuckets;
+    }
+
+  ent = (struct elf_reloc_cache_entry *) bfd_malloc (sizeof (*ent));
+  if (ent == NULL)
+    return;
+  ent->relocs = (Elf_Internal_Rela *) bfd_malloc (size);
+  if (ent->relocs == NULL)
+    {
+      free (ent);
+      return;
+    }
+  memcpy (ent->relocs, relocs, size);
+  ent->sec = sec;
+  ent->size = size;
+  b = elf_reloc_cache_bucket (cache, sec);
+  ent->hash_next = cache->buckets[b];
+  cache->buckets[b] = ent;
+  elf_reloc_cache_link_mru (cache, ent);
+  cache->used += size;
+  cache->count++;
+}
+
+static void
+elf_reloc_cache_free (struct elf_reloc_cache *cache)
+{
+  if (cache == NULL)
+    return;
+  while (cache->lru != NULL)
+    elf_reloc_cache_evict (cache);
+  free (cache->buckets);
+  free (cache);
+}
+
+/* Let the ELF link described by INFO keep up to SIZE bytes of swapped
+   relocs, for reuse when a section's relocs are read again.  Zero,
+   the default, discards any relocs kept and turns the cache off.
+   Returns FALSE on memory allocation failure, or if INFO isn't for
+   an ELF link.  */
+
+bool
+bfd_elf_set_reloc_cache_size (struct bfd_link_info *info, bfd_size_type size)
+{
+  struct elf_link_hash_table *htab;
+  struct elf_reloc_cache *cache;
+
+  if (!is_elf_hash_table (info->hash))
+    {
+      bfd_set_error (bfd_error_wrong_format);
+      return false;
+    }
+  htab = elf_hash_table (info);
+  cache = htab->reloc_cache;
+  if (size == 0)
+    {
+      elf_reloc_cache_free (cache);
+      htab->reloc_cache = NULL;
+      return true;
+    }
+
+  if (cache == NULL)
+    {
+      cache = (struct elf_reloc_cache *) bfd_zmalloc (sizeof (*cache));
+      if (cache == NULL)
+	return false;
+      cache->nbuckets = 256;
+      cache->buckets = (struct elf_reloc_cache_entry **)
+	bfd_zmalloc (cache->nbuckets * sizeof (*cache->buckets));
+      if (cache->buckets == NULL)
+	{
+	  free (cache);
+	  return false;
+	}
+      htab->reloc_cache = cache;
+    }
+  cache->budget = size;
+  while (cache->used > cache->budget)
+    elf_reloc_cache_evict (cache);
+  return true;
+}
+
+/* Report how many reads of relocs the cache set up by
+   bfd_elf_set_reloc_cache_size has satisfied, in *HITS, and how many
+   it has not, in *MISSES.  */
+
+void
+bfd_elf_reloc_cache_stats (struct bfd_link_info *info,
+			   unsigned long long *hits,
+			   unsigned long long *misses)
+{
+  struct elf_reloc_cache *cache = NULL;
+
+  if (is_elf_hash_table (info->hash))
+    cache = elf_hash_table (info)->reloc_cache;
+  *hits = cache != NULL ? cache->hits : 0;
+  *misses = cache != NULL ? cache->misses : 0;
+}
+
 /* Read and swap the relocs for a section O.  They may have been
    cached.  If the EXTERNAL_RELOCS and INTERNAL_RELOCS arguments are
    not NULL, they are used as buffers to read into.  They are known to
@@ -2725,21 +3037,26 @@ elf_link_read_relocs_from_section (bfd *abfd,
    sections (both REL and RELA relocations), then the REL_HDR
    relocations will appear first in INTERNAL_RELOCS, followed by the
    RELA_HDR relocations.  If INFO isn't NULL and KEEP_MEMORY is true,
-   update cache_size.  */
+   update cache_size.  If INFO isn't NULL and KEEP_MEMORY is false, a
+   copy kept by the link's reloc cache may be used instead of reading
+   the file.  */
 
-Elf_Internal_Rela *
-_bfd_elf_link_info_read_relocs (bfd *abfd,
-				struct bfd_link_info *info,
-				asection *o,
-				void *external_relocs,
-				Elf_Internal_Rela *internal_relocs,
-				bool keep_memory)
+static Elf_Internal_Rela *
+_bfd_elf_link_info_read_relocs_1 (bfd *abfd,
+				  struct bfd_link_info *info,
+				  asection *o,
+				  void *external_relocs,
+				  Elf_Internal_Rela *internal_relocs,
+				  bool keep_memory)
 {
   void *alloc1 = NULL;
   Elf_Internal_Rela *alloc2 = NULL;
   const struct elf_backend_data *bed = get_elf_backend_data (abfd);
   struct bfd_elf_section_data *esdo = elf_section_data (o);
   Elf_Internal_Rela *internal_rela_relocs;
+  struct elf_reloc_cache *cache = NULL;
+  struct elf_reloc_cache_entry *ent = NULL;
+  bfd_size_type size;
 
   if (esdo->relocs != NULL)
     return esdo->relocs;
@@ -2747,11 +3064,20 @@ _bfd_elf_link_info_read_relocs (bfd *abfd,
   if (o->reloc_count == 0)
     return NULL;
 
-  if (internal_relocs == NULL)
+  size = (bfd_size_type) o->reloc_count * sizeof (Elf_Internal_Rela);
+  if (info != NULL && !keep_memory && is_elf_hash_table (info->hash))
+    cache = elf_hash_table (info)->reloc_cache;
+  if (cache != NULL)
     {
-      bfd_size_type size;
+      ent = elf_reloc_cache_find (cache, o);
+      if (ent != NULL)
+	cache->hits++;
+      else
+	cache->misses++;
+    }
 
-      size = (bfd_size_type) o->reloc_count * sizeof (Elf_Internal_Rela);
+  if (internal_relocs == NULL)
+    {
       if (keep_memory)
 	{
 	  internal_relocs = alloc2 = (Elf_Internal_Rela *) bfd_alloc (abfd, size);
@@ -2764,16 +3090,22 @@ _bfd_elf_link_info_read_relocs (bfd *abfd,
 	goto error_return;
     }
 
+  if (ent != NULL)
+    {
+      memcpy (internal_relocs, ent->relocs, size);
+      return internal_relocs;
+    }
+
   if (external_relocs == NULL)
     {
-      bfd_size_type size = 0;
+      bfd_size_type ext_size = 0;
 
       if (esdo->rel.hdr)
-	size += esdo->rel.hdr->sh_size;
+	ext_size += esdo->rel.hdr->sh_size;
       if (esdo->rela.hdr)
-	size += esdo->rela.hdr->sh_size;
+	ext_size += esdo->rela.hdr->sh_size;
 
-      alloc1 = bfd_malloc (size);
+      alloc1 = bfd_malloc (ext_size);
       if (alloc1 == NULL)
 	goto error_return;
       external_relocs = alloc1;
@@ -2801,6 +3133,8 @@ _bfd_elf_link_info_read_relocs (bfd *abfd,
   /* Cache the results for next time, if we can.  */
   if (keep_memory)
     esdo->relocs = internal_relocs;
+  else if (cache != NULL)
+    elf_reloc_cache_insert (cache, o, internal_relocs, size);
 
   free (alloc1);
 
@@ -2821,6 +3155,24 @@ _bfd_elf_link_info_read_relocs (bfd *abfd,
   return NULL;
 }
 
+Elf_Internal_Rela *
+_bfd_elf_link_info_read_relocs (bfd *abfd,
+				struct bfd_link_info *info,
+				asection *o,
+				void *external_relocs,
+				Elf_Internal_Rela *internal_relocs,
+				bool keep_memory)
+{
+  enum bfd_memory_class old_class;
+  Elf_Internal_Rela *ret;
+
+  old_class = _bfd_set_memory_class (bfd_memory_relocs);
+  ret = _bfd_elf_link_info_read_relocs_1 (abfd, info, o, external_relocs,
+					  internal_relocs, keep_memory);
+  _bfd_set_memory_class (old_class);
+  return ret;
+}
+
 /* This is similar to _bfd_elf_link_info_read_relocs, except for that
    NULL is passed to _bfd_elf_link_info_read_relocs for pointer to
    struct bfd_link_info.  */
@@ -4388,15 +4740,17 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
       s = bfd_get_section_by_name (abfd, ".dynamic");
       if (s != NULL && s->size != 0 && (s->flags & SEC_HAS_CONTENTS) != 0)
 	{
-	  bfd_byte *dynbuf;
-	  bfd_byte *extdyn;
+	  const bfd_byte *dynbuf;
+	  const bfd_byte *extdyn;
 	  unsigned int elfsec;
 	  unsigned long long shlink;
 
-	  if (!bfd_malloc_and_get_section (abfd, s, &dynbuf))
+	  if (!bfd_get_cached_section_contents (abfd, s, &dynbuf))
+	    goto error_return;
+	  if (dynbuf == NULL)
 	    {
 	    error_free_dyn:
-	      free (dynbuf);
+	      bfd_release_cached_section_contents (abfd, s);
 	      goto error_return;
 	    }
 
@@ -4502,7 +4856,7 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
 		elf_tdata (abfd)->is_pie = (dyn.d_un.d_val & DF_1_PIE) != 0;
 	    }
 
-	  free (dynbuf);
+	  bfd_release_cached_section_contents (abfd, s);
 	}
 
       /* DT_RUNPATH overrides DT_RPATH.  Do _NOT_ bfd_release, as that
@@ -4612,8 +4966,12 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
   sym_hash = elf_sym_hashes (abfd);
   if (extsymcount != 0)
     {
-      isymbuf = bfd_elf_get_elf_syms (abfd, hdr, extsymcount, extsymoff,
-				      NULL, NULL, NULL);
+      /* Use the symbols bfd_elf_link_preload_symbols read, if any.  */
+      isymbuf = elf_tdata (abfd)->link_isymbuf;
+      elf_tdata (abfd)->link_isymbuf = NULL;
+      if (isymbuf == NULL)
+	isymbuf = bfd_elf_get_elf_syms (abfd, hdr, extsymcount, extsymoff,
+					NULL, NULL, NULL);
       if (isymbuf == NULL)
 	goto error_return;
 
@@ -4643,12 +5001,19 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
 	  Elf_Internal_Shdr *versymhdr = &elf_tdata (abfd)->dynversym_hdr;
 	  bfd_size_type amt = versymhdr->sh_size;
 
-	  if (bfd_seek (abfd, versymhdr->sh_offset, SEEK_SET) != 0)
-	    goto error_free_sym;
-	  extversym = (Elf_External_Versym *)
-	    _bfd_malloc_and_read (abfd, amt, amt);
-	  if (extversym == NULL)
-	    goto error_free_sym;
+	  extversym = elf_tdata (abfd)->link_extversym;
+	  elf_tdata (abfd)->link_extversym = NULL;
+	  if (extversym != NULL)
+	    amt = elf_tdata (abfd)->link_extversym_size;
+	  else
+	    {
+	      if (bfd_seek (abfd, versymhdr->sh_offset, SEEK_SET) != 0)
+		goto error_free_sym;
+	      extversym = (Elf_External_Versym *)
+		_bfd_malloc_and_read (abfd, amt, amt);
+	      if (extversym == NULL)
+		goto error_free_sym;
+	    }
 	  extversym_end = extversym + amt / sizeof (*extversym);
 	}
     }
@@ -4670,10 +5035,14 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
 	    {
 	      h = (struct elf_link_hash_entry *) p;
 	      entsize += htab->root.table.entsize;
+	      if (elf_link_hash_has_cold (h))
+		entsize += sizeof (*h->cold);
 	      if (h->root.type == bfd_link_hash_warning)
 		{
 		  entsize += htab->root.table.entsize;
 		  h = (struct elf_link_hash_entry *) h->root.u.i.link;
+		  if (elf_link_hash_has_cold (h))
+		    entsize += sizeof (*h->cold);
 		}
 	      if (h->root.type == bfd_link_hash_common)
 		entsize += sizeof (*h->root.u.c.p);
@@ -4723,11 +5092,21 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
 	      h = (struct elf_link_hash_entry *) p;
 	      memcpy (old_ent, h, htab->root.table.entsize);
 	      old_ent = (char *) old_ent + htab->root.table.entsize;
+	      if (elf_link_hash_has_cold (h))
+		{
+		  memcpy (old_ent, h->cold, sizeof (*h->cold));
+		  old_ent = (char *) old_ent + sizeof (*h->cold);
+		}
 	      if (h->root.type == bfd_link_hash_warning)
 		{
 		  h = (struct elf_link_hash_entry *) h->root.u.i.link;
 		  memcpy (old_ent, h, htab->root.table.entsize);
 		  old_ent = (char *) old_ent + htab->root.table.entsize;
+		  if (elf_link_hash_has_cold (h))
+		    {
+		      memcpy (old_ent, h->cold, sizeof (*h->cold));
+		      old_ent = (char *) old_ent + sizeof (*h->cold);
+		    }
 		}
 	      if (h->root.type == bfd_link_hash_common)
 		{
@@ -5101,7 +5480,14 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
 	      && elf_tdata (abfd)->verdef != NULL
 	      && vernum > 1
 	      && definition)
-	    h->verinfo.verdef = &elf_tdata (abfd)->verdef[vernum - 1];
+	    {
+	      struct elf_link_hash_cold *cold;
+
+	      cold = elf_link_hash_cold (info->output_bfd, h);
+	      if (cold == NULL)
+		goto error_free_vers;
+	      cold->verinfo.verdef = &elf_tdata (abfd)->verdef[vernum - 1];
+	    }
 	}
 
       if (! (_bfd_generic_link_add_one_symbol
@@ -5568,6 +5954,10 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
       htab->root.table.size = old_size;
       htab->root.table.count = old_count;
       memcpy (htab->root.table.table, old_tab, tabsize);
+      /* The index still refers to entries added since, which are
+	 about to be freed, so rebuild it from the restored chains.  */
+      if (htab->root.table.flat != NULL)
+	bfd_hash_table_set_layout (&htab->root.table, bfd_hash_open);
       htab->root.undefs = old_undefs;
       htab->root.undefs_tail = old_undefs_tail;
       if (htab->dynstr != NULL)
@@ -5593,11 +5983,21 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
 	      h = (struct elf_link_hash_entry *) p;
 	      memcpy (h, old_ent, htab->root.table.entsize);
 	      old_ent = (char *) old_ent + htab->root.table.entsize;
+	      if (elf_link_hash_has_cold (h))
+		{
+		  memcpy (h->cold, old_ent, sizeof (*h->cold));
+		  old_ent = (char *) old_ent + sizeof (*h->cold);
+		}
 	      if (h->root.type == bfd_link_hash_warning)
 		{
 		  h = (struct elf_link_hash_entry *) h->root.u.i.link;
 		  memcpy (h, old_ent, htab->root.table.entsize);
 		  old_ent = (char *) old_ent + htab->root.table.entsize;
+		  if (elf_link_hash_has_cold (h))
+		    {
+		      memcpy (h->cold, old_ent, sizeof (*h->cold));
+		      old_ent = (char *) old_ent + sizeof (*h->cold);
+		    }
 		}
 	      if (h->root.type == bfd_link_hash_common)
 		{
@@ -5957,6 +6357,68 @@ _bfd_elf_archive_symbol_lookup (bfd *abfd,
   return h;
 }
 
+/* An index from symbol names to the archive map entries defining
+   them, so that passes after the first over an archive map need only
+   look at the symbols that became undefined in the previous pass.
+   Names are hashed only up to any version, since
+   _bfd_elf_archive_symbol_lookup matches "sym@@VER" in the map to
+   references to "sym@VER" and "sym".  */
+
+struct elf_archive_index
+{
+  /* The first map entry in each bucket, chained through NEXT, with
+     C, the number of map entries, marking the end of a chain.  */
+  symindex *buckets;
+  symindex *next;
+  size_t nbuckets;
+};
+
+static unsigned long long
+elf_archive_name_hash (const char *name)
+{
+  unsigned long long hash = 0;
+
+  for (; *name != '\0' && *name != ELF_VER_CHR; name++)
+    hash = hash * 31 + (unsigned char) *name;
+  return hash;
+}
+
+static bool
+elf_archive_index_init (struct elf_archive_index *idx,
+			carsym *symdefs, symindex c)
+{
+  symindex i;
+
+  idx->nbuckets = 1;
+  while (idx->nbuckets < c)
+    idx->nbuckets <<= 1;
+  idx->buckets = (symindex *) bfd_malloc (idx->nbuckets * sizeof (symindex));
+  idx->next = (symindex *) bfd_malloc (c * sizeof (symindex));
+  if (idx->buckets == NULL || idx->next == NULL)
+    return false;
+
+  for (i = 0; i < idx->nbuckets; i++)
+    idx->buckets[i] = c;
+  /* Add in reverse, so that chains are in map order.  */
+  for (i = c; i-- > 0; )
+    {
+      size_t b = elf_archive_name_hash (symdefs[i].name) & (idx->nbuckets - 1);
+
+      idx->next[i] = idx->buckets[b];
+      idx->buckets[b] = i;
+    }
+  return true;
+}
+
+static int
+elf_archive_symindex_compare (const void *a, const void *b)
+{
+  symindex x = *(const symindex *) a;
+  symindex y = *(const symindex *) b;
+
+  return x < y ? -1 : x > y;
+}
+
 /* Add symbols from an ELF archive file to the linker hash table.  We
    don't use _bfd_generic_link_add_archive_symbols because we need to
    handle versioned symbols.
@@ -5968,7 +6430,11 @@ _bfd_elf_archive_symbol_lookup (bfd *abfd,
    object file.
 
    Unfortunately, we do have to make multiple passes over the symbol
-   table until nothing further is resolved.  */
+   table until nothing further is resolved.  The first pass looks at
+   every symbol in the map.  Later passes look only at map entries
+   for symbols added to the undefined list since the previous pass
+   started, and at those that were undefweak, which are the only
+   entries that a full pass could find something new for.  */
 
 static bool
 elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
@@ -5977,10 +6443,17 @@ elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
   unsigned char *included = NULL;
   carsym *symdefs;
   bool loop;
+  bool full;
   size_t amt;
   const struct elf_backend_data *bed;
   struct bfd_link_hash_entry * (*archive_symbol_lookup)
     (bfd *, struct bfd_link_info *, const char *);
+  struct elf_archive_index idx = { NULL, NULL, 0 };
+  struct bfd_link_hash_entry *pass_tail;
+  symindex *cand = NULL;
+  symindex ncand = 0;
+  symindex *weak = NULL;
+  symindex nweak = 0;
 
   if (! bfd_has_map (abfd))
     {
@@ -6006,25 +6479,91 @@ elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
   bed = get_elf_backend_data (abfd);
   archive_symbol_lookup = bed->elf_backend_archive_symbol_lookup;
 
+  full = true;
+  pass_tail = info->hash->undefs_tail;
   do
     {
       file_ptr last;
       symindex i;
+      symindex k;
       carsym *symdef;
-      carsym *symdefend;
+      struct bfd_link_hash_entry *prev_tail = pass_tail;
 
       loop = false;
       last = -1;
+      pass_tail = info->hash->undefs_tail;
+
+      if (!full)
+	{
+	  struct bfd_link_hash_entry *u;
+
+	  if (idx.buckets == NULL)
+	    {
+	      if (!elf_archive_index_init (&idx, symdefs, c))
+		goto error_return;
+	      cand = (symindex *) bfd_malloc (c * sizeof (symindex));
+	      if (cand == NULL)
+		goto error_return;
+	    }
+
+	  /* If the entry that ended the undefined list last time has
+	     been taken off it, we can't tell what is new, so look at
+	     everything again.  */
+	  if (prev_tail != NULL
+	      && (prev_tail->type == bfd_link_hash_new
+		  || (prev_tail->u.undef.next == NULL
+		      && prev_tail != pass_tail)))
+	    full = true;
+	  else
+	    {
+	      /* Collect the map entries for new undefined symbols, and
+		 for those that were undefweak last time.  INCLUDED
+		 entries 2 marks ones already collected.  */
+	      ncand = 0;
+	      for (k = 0; k < nweak; k++)
+		if (!included[weak[k]])
+		  {
+		    included[weak[k]] = 2;
+		    cand[ncand++] = weak[k];
+		  }
+	      nweak = 0;
+
+	      u = prev_tail != NULL ? prev_tail->u.undef.next
+				    : info->hash->undefs;
+	      for (; u != NULL && prev_tail != pass_tail; u = u->u.undef.next)
+		{
+		  size_t b = (elf_archive_name_hash (u->root.string)
+			      & (idx.nbuckets - 1));
 
-      symdef = symdefs;
-      symdefend = symdef + c;
-      for (i = 0; symdef < symdefend; symdef++, i++)
+		  for (i = idx.buckets[b]; i < c; i = idx.next[i])
+		    if (!included[i])
+		      {
+			included[i] = 2;
+			cand[ncand++] = i;
+		      }
+		  if (u == pass_tail)
+		    break;
+		}
+
+	      /* Go through them in map order, as a full pass would.  */
+	      qsort (cand, ncand, sizeof (*cand),
+		     elf_archive_symindex_compare);
+	      for (k = 0; k < ncand; k++)
+		included[cand[k]] = 0;
+	    }
+	}
+
+      if (full)
+	nweak = 0;
+      for (k = 0; k < (full ? c : ncand); k++)
 	{
 	  struct bfd_link_hash_entry *h;
 	  bfd *element;
 	  struct bfd_link_hash_entry *undefs_tail;
 	  symindex mark;
 
+	  i = full ? k : cand[k];
+	  symdef = symdefs + i;
 	  if (included[i])
 	    continue;
 	  if (symdef->file_offset == last)
@@ -6071,6 +6610,19 @@ elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
 	      if (h->type != bfd_link_hash_undefweak)
 		/* Symbol must be defined.  Don't check it again.  */
 		included[i] = true;
+	      else
+		{
+		  /* A strong reference may turn up without the symbol
+		     being added to the undefined list again, so check
+		     this one on the next pass too.  */
+		  if (weak == NULL)
+		    {
+		      weak = (symindex *) bfd_malloc (c * sizeof (symindex));
+		      if (weak == NULL)
+			goto error_return;
+		    }
+		  weak[nweak++] = i;
+		}
 	      continue;
 	    }
 
@@ -6117,13 +6669,23 @@ elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
 	     on through the loop.  */
 	  last = symdef->file_offset;
 	}
+
+      full = false;
     }
   while (loop);
 
+  free (idx.buckets);
+  free (idx.next);
+  free (cand);
+  free (weak);
   free (included);
   return true;
 
  error_return:
+  free (idx.buckets);
+  free (idx.next);
+  free (cand);
+  free (weak);
   free (included);
   return false;
 }
@@ -6146,133 +6708,340 @@ bfd_elf_link_add_symbols (bfd *abfd, struct bfd_link_info *info)
     }
 }
 
-struct hash_codes_info
+/* The input files of a bfd_elf_link_preload_symbols call.  */
+
+struct elf_preload_job
 {
-  unsigned long long *hashcodes;
-  bool error;
+  bfd **abfds;
+  /* Held while reading an archive member, since members share their
+     archive's file position.  */
+  bfd_mutex io_lock;
 };
 
-/* This function will be called though elf_link_hash_traverse to store
-   all hash value of the exported symbols in an array.  */
+/* Read the global symbols of ABFD, its symbol string table and, for
+   a dynamic object, its symbol versions, the way
+   elf_link_add_object_symbols would.  */
 
 static bool
-elf_collect_hash_codes (struct elf_link_hash_entry *h, void *data)
+elf_link_preload_object (struct elf_preload_job *job, bfd *abfd)
 {
-  struct hash_codes_info *inf = (struct hash_codes_info *) data;
-  const char *name;
-  unsigned long long ha;
-  char *alc = NULL;
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  struct elf_obj_tdata *tdata = elf_tdata (abfd);
+  Elf_Internal_Shdr *hdr;
+  Elf_Internal_Sym *isymbuf;
+  size_t symcount, extsymcount, extsymoff;
+  bool dynamic = (abfd->flags & DYNAMIC) != 0;
+  bool lock = abfd->my_archive != NULL;
+  bool ret = false;
 
-  /* Ignore indirect symbols.  These are added by the versioning code.  */
-  if (h->dynindx == -1)
+  if (tdata->link_isymbuf != NULL
+      || elf_sym_hashes (abfd) != NULL)
     return true;
 
-  name = h->root.root.string;
-  if (h->versioned >= versioned)
-    {
-      char *p = strchr (name, ELF_VER_CHR);
-      if (p != NULL)
-	{
-	  alc = (char *) bfd_malloc (p - name + 1);
-	  if (alc == NULL)
-	    {
-	      inf->error = true;
-	      return false;
-	    }
-	  memcpy (alc, name, p - name);
-	  alc[p - name] = '\0';
-	  name = alc;
-	}
-    }
+  if (!dynamic || elf_dynsymtab (abfd) == 0)
+    hdr = &tdata->symtab_hdr;
+  else
+    hdr = &tdata->dynsymtab_hdr;
 
-  /* Compute the hash value.  */
-  ha = bfd_elf_hash (name);
+  symcount = hdr->sh_size / bed->s->sizeof_sym;
+  if (elf_bad_symtab (abfd))
+    {
+      extsymcount = symcount;
+      extsymoff = 0;
+    }
+  else
+    {
+      extsymcount = symcount - hdr->sh_info;
+      extsymoff = hdr->sh_info;
+    }
+  if (extsymcount == 0)
+    return true;
+
+  if (lock)
+    _bfd_mutex_lock (&job->io_lock);
+  isymbuf = bfd_elf_get_elf_syms (abfd, hdr, extsymcount, extsymoff,
+				  NULL, NULL, NULL);
+  if (isymbuf == NULL
+      || bfd_elf_string_from_elf_section (abfd, hdr->sh_link, 0) == NULL)
+    goto out;
+
+  if (dynamic && elf_dynversym (abfd) != 0)
+    {
+      Elf_Internal_Shdr *versymhdr = &tdata->dynversym_hdr;
+      bfd_size_type amt = versymhdr->sh_size;
+
+      if (bfd_seek (abfd, versymhdr->sh_offset, SEEK_SET) != 0)
+	goto out;
+      tdata->link_extversym = (Elf_External_Versym *)
+	_bfd_malloc_and_read (abfd, amt, amt);
+      if (tdata->link_extversym == NULL)
+	goto out;
+      tdata->link_extversym_size = amt;
+    }
+
+  tdata->link_isymbuf = isymbuf;
+  isymbuf = NULL;
+  ret = true;
+
+ out:
+  if (lock)
+    _bfd_mutex_unlock (&job->io_lock);
+  free (isymbuf);
+  return ret;
+}
+
+/* Tell the host that the symbol tables elf_link_preload_object is
+   going to read from ABFD will be wanted soon.  */
+
+static void
+elf_link_prefetch_symbols (bfd *abfd)
+{
+  struct elf_obj_tdata *tdata = elf_tdata (abfd);
+  Elf_Internal_Shdr *hdr;
 
-  /* Store the found hash value in the array given as the argument.  */
-  *(inf->hashcodes)++ = ha;
+  if (tdata->link_isymbuf != NULL
+      || elf_sym_hashes (abfd) != NULL)
+    return;
+
+  if ((abfd->flags & DYNAMIC) == 0 || elf_dynsymtab (abfd) == 0)
+    hdr = &tdata->symtab_hdr;
+  else
+    {
+      hdr = &tdata->dynsymtab_hdr;
+      if (elf_dynversym (abfd) != 0)
+	bfd_prefetch (abfd, tdata->dynversym_hdr.sh_offset,
+		      tdata->dynversym_hdr.sh_size);
+    }
+  bfd_prefetch (abfd, hdr->sh_offset, hdr->sh_size);
+  if (hdr->sh_link != 0 && hdr->sh_link < elf_numsections (abfd))
+    {
+      Elf_Internal_Shdr *strhdr = elf_elfsections (abfd)[hdr->sh_link];
+
+      bfd_prefetch (abfd, strhdr->sh_offset, strhdr->sh_size);
+    }
+}
 
-  /* And store it in the struct so that we can put it in the hash table
-     later.  */
-  h->u.elf_hash_value = ha;
+/* Preload the input files in JOB from START to END.  Worker for
+   _bfd_parallel_for.  */
+
+static bool
+elf_link_preload_range (void *data, size_t start, size_t end)
+{
+  struct elf_preload_job *job = (struct elf_preload_job *) data;
 
-  free (alc);
+  for (; start < end; start++)
+    if (!elf_link_preload_object (job, job->abfds[start]))
+      return false;
   return true;
 }
 
-struct collect_gnu_hash_codes
+/* Read the symbols of the COUNT input files in ABFDS ahead of
+   bfd_elf_link_add_symbols, using as many threads as
+   bfd_set_thread_count allows.  Nothing is entered in the link hash
+   table here: that is still done by bfd_elf_link_add_symbols, one
+   file at a time in the order it is called, so the result of the
+   link does not depend on the order the threads finish in.  Files
+   that are not ELF objects of the output's flavour are skipped, as
+   are archives, whose members are only read once they are known to
+   be needed.  */
+
+bool
+bfd_elf_link_preload_symbols (struct bfd_link_info *info,
+			      bfd **abfds, size_t count)
+{
+  struct elf_preload_job job;
+  size_t i, n;
+  bool ret;
+
+  job.abfds = (bfd **) bfd_malloc (count * sizeof (bfd *));
+  if (job.abfds == NULL)
+    return false;
+
+  for (i = n = 0; i < count; i++)
+    if (bfd_get_format (abfds[i]) == bfd_object
+	&& bfd_get_flavour (abfds[i]) == bfd_target_elf_flavour
+	&& (abfds[i]->flags & BFD_PLUGIN) == 0
+	&& (info->output_bfd == NULL
+	    || (get_elf_backend_data (abfds[i])->s->elfclass
+		== get_elf_backend_data (info->output_bfd)->s->elfclass)))
+      job.abfds[n++] = abfds[i];
+
+  /* Ask for all of the tables at once, so that the host can fetch
+     them while the first files are being read.  */
+  for (i = 0; i < n; i++)
+    elf_link_prefetch_symbols (job.abfds[i]);
+
+  memset (&job.io_lock, 0, sizeof (job.io_lock));
+  ret = _bfd_parallel_for (n, 1, elf_link_preload_range, &job);
+  _bfd_mutex_destroy (&job.io_lock);
+  free (job.abfds);
+  return ret;
+}
+
+/* The exported dynamic symbols whose names are to be hashed, and
+   where the hash values go.  */
+
+struct hash_names_info
 {
-  bfd *output_bfd;
   const struct elf_backend_data *bed;
+
+  /* Whether this is for .gnu.hash rather than .hash.  */
+  bool gnu_hash;
+
+  /* The symbols to hash, in hash table traversal order.  */
+  struct elf_link_hash_entry **entries;
   unsigned long long int nsyms;
-  unsigned long long int maskbits;
+  long long int min_dynindx;
+
+  /* Receives the hash value of each of ENTRIES.  */
   unsigned long long int *hashcodes;
+
+  /* For .gnu.hash, receives the hash values indexed by dynindx.  */
   unsigned long long int *hashval;
-  unsigned long long int *indx;
-  unsigned long long int *counts;
-  bfd_vma *bitmask;
-  bfd_byte *contents;
-  bfd_size_type xlat;
-  long long int min_dynindx;
-  unsigned long long int bucketcount;
-  unsigned long long int symindx;
-  long long int local_indx;
-  long long int shift1, shift2;
-  unsigned long long int mask;
-  bool error;
 };
 
-/* This function will be called though elf_link_hash_traverse to store
-   all hash value of the exported symbols in an array.  */
+/* Hashing names is the slow part, so use a few threads for it once
+   there are this many symbols per thread.  */
+#define HASH_NAMES_GRAIN 4096
+
+/* This function will be called though elf_link_hash_traverse to
+   gather the symbols whose names go in the hash table.  */
 
 static bool
-elf_collect_gnu_hash_codes (struct elf_link_hash_entry *h, void *data)
+elf_collect_hash_entries (struct elf_link_hash_entry *h, void *data)
 {
-  struct collect_gnu_hash_codes *s = (struct collect_gnu_hash_codes *) data;
-  const char *name;
-  unsigned long long ha;
-  char *alc = NULL;
+  struct hash_names_info *inf = (struct hash_names_info *) data;
 
   /* Ignore indirect symbols.  These are added by the versioning code.  */
   if (h->dynindx == -1)
     return true;
 
   /* Ignore also local symbols and undefined symbols.  */
-  if (! (*s->bed->elf_hash_symbol) (h))
+  if (inf->gnu_hash && ! (*inf->bed->elf_hash_symbol) (h))
     return true;
 
-  name = h->root.root.string;
-  if (h->versioned >= versioned)
+  inf->entries[inf->nsyms++] = h;
+  if (inf->min_dynindx < 0 || inf->min_dynindx > h->dynindx)
+    inf->min_dynindx = h->dynindx;
+  return true;
+}
+
+/* Compute the hash values of symbols START to END of the list, and
+   store them where they are wanted.  Nothing is shared between
+   symbols, so this can be done on several threads.  */
+
+static bool
+elf_hash_names_range (void *data, size_t start, size_t end)
+{
+  struct hash_names_info *inf = (struct hash_names_info *) data;
+  char buf[256];
+  size_t k;
+
+  for (k = start; k < end; k++)
     {
-      char *p = strchr (name, ELF_VER_CHR);
-      if (p != NULL)
+      struct elf_link_hash_entry *h = inf->entries[k];
+      const char *name;
+      unsigned long long ha;
+      char *alc = NULL;
+
+      name = h->root.root.string;
+      if (h->versioned >= versioned)
 	{
-	  alc = (char *) bfd_malloc (p - name + 1);
-	  if (alc == NULL)
+	  char *p = strchr (name, ELF_VER_CHR);
+	  if (p != NULL)
 	    {
-	      s->error = true;
-	      return false;
+	      if ((size_t) (p - name) < sizeof (buf))
+		alc = buf;
+	      else
+		{
+		  alc = (char *) bfd_malloc (p - name + 1);
+		  if (alc == NULL)
+		    return false;
+		}
+	      memcpy (alc, name, p - name);
+	      alc[p - name] = '\0';
+	      name = alc;
 	    }
-	  memcpy (alc, name, p - name);
-	  alc[p - name] = '\0';
-	  name = alc;
 	}
-    }
 
-  /* Compute the hash value.  */
-  ha = bfd_elf_gnu_hash (name);
+      /* Compute the hash value.  */
+      if (inf->gnu_hash)
+	{
+	  ha = bfd_elf_gnu_hash (name);
+
+	  /* Keep it for .dynsym reordering purposes.  */
+	  inf->hashval[h->dynindx] = ha;
+	}
+      else
+	{
+	  ha = bfd_elf_hash (name);
+
+	  /* And store it in the struct so that we can put it in the hash
+	     table later.  */
+	  h->u.elf_hash_value = ha;
+	}
 
-  /* Store the found hash value in the array for compute_bucket_count,
-     and also for .dynsym reordering purposes.  */
-  s->hashcodes[s->nsyms] = ha;
-  s->hashval[h->dynindx] = ha;
-  ++s->nsyms;
-  if (s->min_dynindx < 0 || s->min_dynindx > h->dynindx)
-    s->min_dynindx = h->dynindx;
+      /* Store the found hash value in the array for
+	 compute_bucket_count.  */
+      inf->hashcodes[k] = ha;
 
-  free (alc);
+      if (alc != buf)
+	free (alc);
+    }
   return true;
 }
 
+/* Compute the hash values of all the exported symbols of INFO for
+   .gnu.hash if GNU_HASH, or .hash otherwise, filling in INF.  The
+   caller sets INF->hashcodes, and INF->hashval for .gnu.hash, to
+   arrays of DYNSYMCOUNT entries.  */
+
+static bool
+elf_collect_hash_codes (struct bfd_link_info *info,
+			struct hash_names_info *inf,
+			bool gnu_hash, size_t dynsymcount)
+{
+  bool ret;
+
+  inf->bed = get_elf_backend_data (info->output_bfd);
+  inf->gnu_hash = gnu_hash;
+  inf->nsyms = 0;
+  inf->min_dynindx = -1;
+  inf->entries = (struct elf_link_hash_entry **)
+    bfd_malloc (dynsymcount * sizeof (*inf->entries));
+  if (inf->entries == NULL && dynsymcount != 0)
+    return false;
+
+  elf_link_hash_traverse (elf_hash_table (info),
+			  elf_collect_hash_entries, inf);
+  ret = _bfd_parallel_for (inf->nsyms, HASH_NAMES_GRAIN,
+			   elf_hash_names_range, inf);
+  free (inf->entries);
+  inf->entries = NULL;
+  return ret;
+}
+
+struct collect_gnu_hash_codes
+{
+  bfd *output_bfd;
+  const struct elf_backend_data *bed;
+  unsigned long long int nsyms;
+  unsigned long long int maskbits;
+  unsigned long long int *hashcodes;
+  unsigned long long int *hashval;
+  unsigned long long int *indx;
+  unsigned long long int *counts;
+  bfd_vma *bitmask;
+  bfd_byte *contents;
+  bfd_size_type xlat;
+  long long int min_dynindx;
+  unsigned long long int bucketcount;
+  unsigned long long int symindx;
+  long long int local_indx;
+  long long int shift1, shift2;
+  unsigned long long int mask;
+};
+
 /* This function will be called though elf_link_hash_traverse to do
    final dynamic symbol renumbering in case of .gnu.hash.
    If using .MIPS.xhash, invoke record_xhash_symbol to add symbol index
@@ -6354,6 +7123,70 @@ static const size_t elf_buckets[] =
   16411, 32771, 0
 };
 
+/* For the weight function we need some information about the
+   pagesize on the target.  This is information need not be 100%
+   accurate.  Since this information is not available (so far) we
+   define it here to a reasonable default value.  If it is crucial
+   to have a better value some day simply define this value.  */
+#ifndef BFD_TARGET_PAGESIZE
+# define BFD_TARGET_PAGESIZE	(4096)
+#endif
+
+/* Return the weight of a hash table of SIZE buckets holding the NSYMS
+   hash values in HASHCODES, using COUNTS, of at least SIZE entries, to
+   count the chain lengths.  BASE is the cost of the fixed part of the
+   table, and PAGE the number of hash table entries in a page.  */
+
+static uint64_t
+bucket_count_weight (const unsigned long long int *hashcodes,
+		     unsigned long long int nsyms, unsigned long long int size,
+		     unsigned long long int *counts, uint64_t base,
+		     unsigned long long int page)
+{
+  uint64_t max = base;
+  unsigned long long int j;
+  unsigned long long int fact;
+
+  memset (counts, '\0', size * sizeof (unsigned long long int));
+
+  /* Determine how often each hash bucket is used.  */
+  for (j = 0; j < nsyms; ++j)
+    ++counts[hashcodes[j] % size];
+
+#if 1
+  /* Variant 1: optimize for short chains.  We add the squares
+     of all the chain lengths (which favors many small chain
+     over a few long long chains).  */
+  for (j = 0; j < size; ++j)
+    max += counts[j] * counts[j];
+
+  /* This adds penalties for the overall size of the table.  */
+  fact = size / page + 1;
+  max *= fact * fact;
+#else
+  /* Variant 2: Optimize a lot more for small table.  Here we
+     also add squares of the size but we also add penalties for
+     empty slots (the +1 term).  */
+  for (j = 0; j < size; ++j)
+    max += (1 + counts[j]) * (1 + counts[j]);
+
+  /* The overall size of the table is considered, but not as
+     strong as in variant 1, where it is squared.  */
+  fact = size / page + 1;
+  max *= fact;
+#endif
+
+  return max;
+}
+
+/* With at least this many symbols, trying each size in turn is too
+   slow, so compute_bucket_count only weighs the sizes that a model
+   of the weight function picks out.  */
+#define BUCKET_MODEL_MIN 16384
+
+/* The number of sizes picked by the model that are then weighed.  */
+#define BUCKET_MODEL_CANDIDATES 4
+
 /* Compute bucket count for hashing table.  We do not use a static set
    of possible tables sizes anymore.  Instead we determine for all
    possible reasonable sizes of the table the outcome (i.e., the
@@ -6382,6 +7215,8 @@ compute_bucket_count (struct bfd_link_info *info ATTRIBUTE_UNUSED,
       unsigned long long int *counts;
       bfd_size_type amt;
       unsigned int no_improvement_count = 0;
+      unsigned long long int page;
+      uint64_t base;
 
       /* Possible optimization parameters: if we have NSYMS symbols we say
 	 that the hashing table must at least have NSYMS/4 and at most
@@ -6406,73 +7241,96 @@ compute_bucket_count (struct bfd_link_info *info ATTRIBUTE_UNUSED,
       if (counts == NULL)
 	return 0;
 
-      /* Compute the "optimal" size for the hash table.  The criteria is a
-	 minimal chain length.  The minor criteria is (of course) the size
-	 of the table.  */
-      for (i = minsize; i < maxsize; ++i)
+      /* We in any case need 2 + DYNSYMCOUNT entries for the size values
+	 and the chains.  */
+      base = (2 + dynsymcount) * bed->s->sizeof_hash_entry;
+      page = BFD_TARGET_PAGESIZE / bed->s->sizeof_hash_entry;
+
+      if (nsyms >= BUCKET_MODEL_MIN)
 	{
-	  /* Walk through the array of hashcodes and count the collisions.  */
-	  uint64_t max;
-	  unsigned long long int j;
-	  unsigned long long int fact;
+	  /* With well spread hash values the sum of the squared chain
+	     lengths for a table of I buckets is expected to be
+	     NSYMS + NSYMS * (NSYMS - 1) / I.  That falls as I grows,
+	     while the size penalty only changes at page boundaries,
+	     so the expected weight is least at the last size before
+	     each boundary.  Weigh only the few sizes that the model
+	     likes best.  */
+	  unsigned long long int cand[BUCKET_MODEL_CANDIDATES];
+	  double cand_est[BUCKET_MODEL_CANDIDATES];
+	  unsigned int ncand = 0;
+	  unsigned int c;
+	  unsigned long long int k;
+	  double n = nsyms;
+
+	  for (k = minsize / page; k * page < maxsize; ++k)
+	    {
+	      double est, fact;
+
+	      i = (k + 1) * page - 1;
+	      if (i >= maxsize)
+		i = maxsize - 1;
+	      if (gnu_hash && (i & 31) == 0)
+		--i;
+	      if (i < minsize)
+		continue;
 
-	  if (gnu_hash && (i & 31) == 0)
-	    continue;
+	      fact = k + 1;
+	      est = (base + n + n * (n - 1) / i) * fact * fact;
+	      if (ncand == BUCKET_MODEL_CANDIDATES)
+		{
+		  if (est >= cand_est[ncand - 1])
+		    continue;
+		  --ncand;
+		}
+	      for (c = ncand; c > 0 && cand_est[c - 1] > est; --c)
+		{
+		  cand[c] = cand[c - 1];
+		  cand_est[c] = cand_est[c - 1];
+		}
+	      cand[c] = i;
+	      cand_est[c] = est;
+	      ++ncand;
+	    }
 
-	  memset (counts, '\0', i * sizeof (unsigned long long int));
-
-	  /* Determine how often each hash bucket is used.  */
-	  for (j = 0; j < nsyms; ++j)
-	    ++counts[hashcodes[j] % i];
-
-	  /* For the weight function we need some information about the
-	     pagesize on the target.  This is information need not be 100%
-	     accurate.  Since this information is not available (so far) we
-	     define it here to a reasonable default value.  If it is crucial
-	     to have a better value some day simply define this value.  */
-# ifndef BFD_TARGET_PAGESIZE
-#  define BFD_TARGET_PAGESIZE	(4096)
-# endif
-
-	  /* We in any case need 2 + DYNSYMCOUNT entries for the size values
-	     and the chains.  */
-	  max = (2 + dynsymcount) * bed->s->sizeof_hash_entry;
-
-# if 1
-	  /* Variant 1: optimize for short chains.  We add the squares
-	     of all the chain lengths (which favors many small chain
-	     over a few long long chains).  */
-	  for (j = 0; j < i; ++j)
-	    max += counts[j] * counts[j];
-
-	  /* This adds penalties for the overall size of the table.  */
-	  fact = i / (BFD_TARGET_PAGESIZE / bed->s->sizeof_hash_entry) + 1;
-	  max *= fact * fact;
-# else
-	  /* Variant 2: Optimize a lot more for small table.  Here we
-	     also add squares of the size but we also add penalties for
-	     empty slots (the +1 term).  */
-	  for (j = 0; j < i; ++j)
-	    max += (1 + counts[j]) * (1 + counts[j]);
-
-	  /* The overall size of the table is considered, but not as
-	     strong as in variant 1, where it is squared.  */
-	  fact = i / (BFD_TARGET_PAGESIZE / bed->s->sizeof_hash_entry) + 1;
-	  max *= fact;
-# endif
-
-	  /* Compare with current best results.  */
-	  if (max < best_chlen)
-	    {
-	      best_chlen = max;
-	      best_size = i;
-	      no_improvement_count = 0;
-	    }
-	  /* PR 11843: Avoid futile long long searches for the best bucket size
-	     when there are a large number of symbols.  */
-	  else if (++no_improvement_count == 100)
-	    break;
+	  for (c = 0; c < ncand; ++c)
+	    {
+	      uint64_t max = bucket_count_weight (hashcodes, nsyms, cand[c],
+						  counts, base, page);
+
+	      if (max < best_chlen
+		  || (max == best_chlen && cand[c] < best_size))
+		{
+		  best_chlen = max;
+		  best_size = cand[c];
+		}
+	    }
 	}
+      else
+	/* Compute the "optimal" size for the hash table.  The criteria is a
+	   minimal chain length.  The minor criteria is (of course) the size
+	   of the table.  */
+	for (i = minsize; i < maxsize; ++i)
+	  {
+	    /* Walk through the array of hashcodes and count the collisions.  */
+	    uint64_t max;
+
+	    if (gnu_hash && (i & 31) == 0)
+	      continue;
+
+	    max = bucket_count_weight (hashcodes, nsyms, i, counts, base, page);
+
+	    /* Compare with current best results.  */
+	    if (max < best_chlen)
+	      {
+		best_chlen = max;
+		best_size = i;
+		no_improvement_count = 0;
+	      }
+	    /* PR 11843: Avoid futile long long searches for the best bucket size
+	       when there are a large number of symbols.  */
+	    else if (++no_improvement_count == 100)
+	      break;
+	  }
 
       free (counts);
     }
@@ -6569,7 +7427,10 @@ bfd_elf_stack_segment_size (bfd *output_bfd,
   return true;
 }
 
-/* Sweep symbols in swept sections.  Called via elf_link_hash_traverse.  */
+/* Sweep symbols in swept sections.  The symbols to sweep are found on
+   several threads via elf_link_hash_traverse_parallel, each piece of
+   the table collecting them in an elf_gc_sweep_symbol_list, and then
+   hidden in table order by elf_gc_sweep_symbol_list.  */
 
 struct elf_gc_sweep_symbol_info
 {
@@ -6578,8 +7439,16 @@ struct elf_gc_sweep_symbol_info
 		       bool);
 };
 
+struct elf_gc_sweep_symbol_list
+{
+  struct elf_link_hash_entry **syms;
+  size_t count;
+  size_t alloc;
+};
+
 static bool
-elf_gc_sweep_symbol (struct elf_link_hash_entry *h, void *data)
+elf_gc_sweep_symbol (struct elf_link_hash_entry *h,
+		     void *data ATTRIBUTE_UNUSED, void *result)
 {
   if (!h->mark
       && (((h->root.type == bfd_link_hash_defined
@@ -6589,15 +7458,46 @@ elf_gc_sweep_symbol (struct elf_link_hash_entry *h, void *data)
 	  || h->root.type == bfd_link_hash_undefined
 	  || h->root.type == bfd_link_hash_undefweak))
     {
-      struct elf_gc_sweep_symbol_info *inf;
+      struct elf_gc_sweep_symbol_list *list;
+
+      list = (struct elf_gc_sweep_symbol_list *) result;
+      if (list->count == list->alloc)
+	{
+	  size_t alloc = list->alloc == 0 ? 16 : list->alloc * 2;
+	  struct elf_link_hash_entry **syms;
+
+	  syms = (struct elf_link_hash_entry **)
+	    bfd_realloc (list->syms, alloc * sizeof (*syms));
+	  if (syms == NULL)
+	    return false;
+	  list->syms = syms;
+	  list->alloc = alloc;
+	}
+      list->syms[list->count++] = h;
+    }
+
+  return true;
+}
+
+static bool
+elf_gc_sweep_symbol_list (void *data, void *result)
+{
+  struct elf_gc_sweep_symbol_info *inf;
+  struct elf_gc_sweep_symbol_list *list;
+  size_t i;
+
+  inf = (struct elf_gc_sweep_symbol_info *) data;
+  list = (struct elf_gc_sweep_symbol_list *) result;
+  for (i = 0; i < list->count; i++)
+    {
+      struct elf_link_hash_entry *h = list->syms[i];
 
-      inf = (struct elf_gc_sweep_symbol_info *) data;
       (*inf->hide_symbol) (inf->info, h, true);
       h->def_regular = 0;
       h->ref_regular = 0;
       h->ref_regular_nonweak = 0;
     }
-
+  free (list->syms);
   return true;
 }
 
@@ -6606,16 +7506,16 @@ elf_gc_sweep_symbol (struct elf_link_hash_entry *h, void *data)
    must set the sizes of the sections before the linker sets the
    addresses of the various sections.  */
 
-bool
-bfd_elf_size_dynamic_sections (bfd *output_bfd,
-			       const char *soname,
-			       const char *rpath,
-			       const char *filter_shlib,
-			       const char *audit,
-			       const char *depaudit,
-			       const char * const *auxiliary_filters,
-			       struct bfd_link_info *info,
-			       asection **sinterpptr)
+static bool
+bfd_elf_size_dynamic_sections_1 (bfd *output_bfd,
+				 const char *soname,
+				 const char *rpath,
+				 const char *filter_shlib,
+				 const char *audit,
+				 const char *depaudit,
+				 const char * const *auxiliary_filters,
+				 struct bfd_link_info *info,
+				 asection **sinterpptr)
 {
   bfd *dynobj;
   const struct elf_backend_data *bed;
@@ -6880,7 +7780,8 @@ bfd_elf_size_dynamic_sections (bfd *output_bfd,
 	      h->non_elf = 0;
 	      h->def_regular = 1;
 	      h->type = STT_OBJECT;
-	      h->verinfo.vertree = NULL;
+	      if (elf_link_hash_has_cold (h))
+		h->cold->verinfo.vertree = NULL;
 
 	      if (! bfd_elf_link_record_dynamic_symbol (info, h))
 		return false;
@@ -6907,6 +7808,7 @@ bfd_elf_size_dynamic_sections (bfd *output_bfd,
 	    {
 	      unsigned int cdeps;
 	      struct bfd_elf_version_deps *n;
+	      struct elf_link_hash_cold *cold;
 
 	      /* Don't emit the base version twice.  */
 	      if (t->vernum == 0)
@@ -6927,7 +7829,10 @@ bfd_elf_size_dynamic_sections (bfd *output_bfd,
 	      h->non_elf = 0;
 	      h->def_regular = 1;
 	      h->type = STT_OBJECT;
-	      h->verinfo.vertree = t;
+	      cold = elf_link_hash_cold (info->output_bfd, h);
+	      if (cold == NULL)
+		return false;
+	      cold->verinfo.vertree = t;
 
 	      if (! bfd_elf_link_record_dynamic_symbol (info, h))
 		return false;
@@ -7006,8 +7911,11 @@ bfd_elf_size_dynamic_sections (bfd *output_bfd,
 	 dynamic symbol table.  */
       sweep_info.info = info;
       sweep_info.hide_symbol = bed->elf_backend_hide_symbol;
-      elf_link_hash_traverse (elf_hash_table (info), elf_gc_sweep_symbol,
-			      &sweep_info);
+      if (!elf_link_hash_traverse_parallel
+	  (elf_hash_table (info), elf_gc_sweep_symbol,
+	   sizeof (struct elf_gc_sweep_symbol_list),
+	   elf_gc_sweep_symbol_list, &sweep_info))
+	return false;
     }
 
   if (dynobj != NULL && elf_hash_table (info)->dynamic_sections_created)
@@ -7476,6 +8384,28 @@ NOTE: This behaviour is deprecated and will be removed in a future version of th
   return true;
 }
 
+bool
+bfd_elf_size_dynamic_sections (bfd *output_bfd,
+			       const char *soname,
+			       const char *rpath,
+			       const char *filter_shlib,
+			       const char *audit,
+			       const char *depaudit,
+			       const char * const *auxiliary_filters,
+			       struct bfd_link_info *info,
+			       asection **sinterpptr)
+{
+  bfd_trace_span span;
+  bool ret;
+
+  bfd_trace_begin (&span, "bfd_elf_size_dynamic_sections", output_bfd);
+  ret = bfd_elf_size_dynamic_sections_1 (output_bfd, soname, rpath,
+					 filter_shlib, audit, depaudit,
+					 auxiliary_filters, info, sinterpptr);
+  bfd_trace_end (&span);
+  return ret;
+}
+
 /* Find the first non-excluded output section.  We'll use its
    section symbol for some emitted relocs.  */
 void
@@ -7607,7 +8537,7 @@ bfd_elf_size_dynsym_hash_dynstr (bfd *output_bfd, struct bfd_link_info *info)
       if (info->emit_hash)
 	{
 	  unsigned long long int *hashcodes;
-	  struct hash_codes_info hashinf;
+	  struct hash_names_info hashinf;
 	  bfd_size_type amt;
 	  unsigned long long int nsyms;
 	  size_t bucketcount;
@@ -7621,18 +8551,16 @@ bfd_elf_size_dynsym_hash_dynstr (bfd *output_bfd, struct bfd_link_info *info)
 	  if (hashcodes == NULL)
 	    return false;
 	  hashinf.hashcodes = hashcodes;
-	  hashinf.error = false;
+	  hashinf.hashval = NULL;
 
 	  /* Put all hash values in HASHCODES.  */
-	  elf_link_hash_traverse (elf_hash_table (info),
-				  elf_collect_hash_codes, &hashinf);
-	  if (hashinf.error)
+	  if (!elf_collect_hash_codes (info, &hashinf, false, dynsymcount))
 	    {
 	      free (hashcodes);
 	      return false;
 	    }
 
-	  nsyms = hashinf.hashcodes - hashcodes;
+	  nsyms = hashinf.nsyms;
 	  bucketcount
 	    = compute_bucket_count (info, hashcodes, nsyms, 0);
 	  free (hashcodes);
@@ -7662,6 +8590,7 @@ bfd_elf_size_dynsym_hash_dynstr (bfd *output_bfd, struct bfd_link_info *info)
 	  struct collect_gnu_hash_codes cinfo;
 	  bfd_size_type amt;
 	  size_t bucketcount;
+	  struct hash_names_info hashinf;
 
 	  memset (&cinfo, 0, sizeof (cinfo));
 
@@ -7674,18 +8603,19 @@ bfd_elf_size_dynsym_hash_dynstr (bfd *output_bfd, struct bfd_link_info *info)
 	    return false;
 
 	  cinfo.hashval = cinfo.hashcodes + dynsymcount;
-	  cinfo.min_dynindx = -1;
 	  cinfo.output_bfd = output_bfd;
 	  cinfo.bed = bed;
 
 	  /* Put all hash values in HASHCODES.  */
-	  elf_link_hash_traverse (elf_hash_table (info),
-				  elf_collect_gnu_hash_codes, &cinfo);
-	  if (cinfo.error)
+	  hashinf.hashcodes = cinfo.hashcodes;
+	  hashinf.hashval = cinfo.hashval;
+	  if (!elf_collect_hash_codes (info, &hashinf, true, dynsymcount))
 	    {
 	      free (cinfo.hashcodes);
 	      return false;
 	    }
+	  cinfo.nsyms = hashinf.nsyms;
+	  cinfo.min_dynindx = hashinf.min_dynindx;
 
 	  bucketcount
 	    = compute_bucket_count (info, cinfo.hashcodes, cinfo.nsyms, 1);
@@ -7915,12 +8845,13 @@ _bfd_elf_link_hash_newfunc (struct bfd_hash_entry *entry,
       struct elf_link_hash_table *htab = (struct elf_link_hash_table *) table;
 
       /* Set local fields.  */
+      memset (&ret->root + 1, 0,
+	      sizeof (struct elf_link_hash_entry) - sizeof (ret->root));
       ret->indx = -1;
       ret->dynindx = -1;
       ret->got = htab->init_got_refcount;
       ret->plt = htab->init_plt_refcount;
-      memset (&ret->size, 0, (sizeof (struct elf_link_hash_entry)
-			      - offsetof (struct elf_link_hash_entry, size)));
+      ret->cold = (struct elf_link_hash_cold *) &_bfd_elf_link_hash_no_cold;
       /* Assume that we have been called by a non-ELF symbol reader.
 	 This flag is then reset by the code which reads an ELF input
 	 file.  This ensures that a symbol created by a non-ELF symbol
@@ -8127,6 +9058,7 @@ _bfd_elf_link_hash_table_free (bfd *obfd)
   if (htab->dynstr != NULL)
     _bfd_elf_strtab_free (htab->dynstr);
   _bfd_merge_sections_free (htab->merge_info);
+  elf_reloc_cache_free (htab->reloc_cache);
   _bfd_generic_link_hash_table_free (obfd);
 }
 
@@ -8207,10 +9139,10 @@ bfd_elf_get_bfd_needed_list (bfd *abfd,
 			     struct bfd_link_needed_list **pneeded)
 {
   asection *s;
-  bfd_byte *dynbuf = NULL;
+  const bfd_byte *dynbuf = NULL;
   unsigned int elfsec;
   unsigned long long shlink;
-  bfd_byte *extdyn, *extdynend;
+  const bfd_byte *extdyn, *extdynend;
   size_t extdynsize;
   void (*swap_dyn_in) (bfd *, const void *, Elf_Internal_Dyn *);
 
@@ -8224,8 +9156,8 @@ bfd_elf_get_bfd_needed_list (bfd *abfd,
   if (s == NULL || s->size == 0 || (s->flags & SEC_HAS_CONTENTS) == 0)
     return true;
 
-  if (!bfd_malloc_and_get_section (abfd, s, &dynbuf))
-    goto error_return;
+  if (!bfd_get_cached_section_contents (abfd, s, &dynbuf))
+    return false;
 
   elfsec = _bfd_elf_section_from_bfd_section (abfd, s);
   if (elfsec == SHN_BAD)
@@ -8270,12 +9202,12 @@ bfd_elf_get_bfd_needed_list (bfd *abfd,
 	}
     }
 
-  free (dynbuf);
+  bfd_release_cached_section_contents (abfd, s);
 
   return true;
 
  error_return:
-  free (dynbuf);
+  bfd_release_cached_section_contents (abfd, s);
   return false;
 }
 
@@ -8291,17 +9223,23 @@ struct elf_symbuf_head
   struct elf_symbuf_symbol *ssym;
   size_t count;
   unsigned int st_shndx;
+  /* Set once elf_symbuf_head_hash has filled in the rest.  */
+  bool hashed;
+  /* How many of the symbols are section symbols.  */
+  size_t sec_count;
+  /* The sums of elf_symbol_digest over the symbols, and over those
+     that are not section symbols.  */
+  unsigned long long digest;
+  unsigned long long digest_nosec;
 };
 
 struct elf_symbol
 {
-  union
-    {
-      Elf_Internal_Sym *isym;
-      struct elf_symbuf_symbol *ssym;
-      void *p;
-    } u;
   const char *name;
+  /* bfd_elf_gnu_hash of NAME.  */
+  unsigned long long hash;
+  unsigned char st_info;
+  unsigned char st_other;
 };
 
 /* Sort references to symbols by ascending section number.  */
@@ -8321,39 +9259,166 @@ elf_sort_elf_symbol (const void *arg1, const void *arg2)
   return 0;
 }
 
-static int
-elf_sym_name_compare (const void *arg1, const void *arg2)
-{
-  const struct elf_symbol *s1 = (const struct elf_symbol *) arg1;
-  const struct elf_symbol *s2 = (const struct elf_symbol *) arg2;
-  int ret = strcmp (s1->name, s2->name);
-  if (ret != 0)
-    return ret;
-  if (s1->u.p != s2->u.p)
-    return s1->u.p > s2->u.p ? 1 : -1;
-  return 0;
-}
+/* Fill in SYM for the symbol of ABFD whose name is ST_NAME in the
+   string table of symbol table HDR.  Returns FALSE if the name can't
+   be found.  */
 
-static struct elf_symbuf_head *
-elf_create_symbuf (size_t symcount, Elf_Internal_Sym *isymbuf)
+static bool
+elf_symbol_init (struct elf_symbol *sym, bfd *abfd, Elf_Internal_Shdr *hdr,
+		 unsigned long long st_name, unsigned char st_info,
+		 unsigned char st_other)
 {
-  Elf_Internal_Sym **ind, **indbufend, **indbuf;
-  struct elf_symbuf_symbol *ssym;
-  struct elf_symbuf_head *ssymbuf, *ssymhead;
-  size_t i, shndx_count, total_size, amt;
+  sym->name = bfd_elf_string_from_elf_section (abfd, hdr->sh_link, st_name);
+  if (sym->name == NULL)
+    return false;
+  sym->hash = bfd_elf_gnu_hash (sym->name);
+  sym->st_info = st_info;
+  sym->st_other = st_other;
+  return true;
+}
 
-  amt = symcount * sizeof (*indbuf);
-  indbuf = (Elf_Internal_Sym **) bfd_malloc (amt);
-  if (indbuf == NULL)
-    return NULL;
+/* A hash of the name, binding, type and visibility of SYM.  The sum
+   of these over a set of symbols does not depend on their order, so
+   two sets whose sums differ can't hold the same symbols.  */
 
-  for (ind = indbuf, i = 0; i < symcount; i++)
-    if (isymbuf[i].st_shndx != SHN_UNDEF)
-      *ind++ = &isymbuf[i];
-  indbufend = ind;
+static unsigned long long
+elf_symbol_digest (const struct elf_symbol *sym)
+{
+  unsigned long long h;
+
+  h = sym->hash ^ ((unsigned long long) (sym->st_info << 8 | sym->st_other)
+		   << 32);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
 
-  qsort (indbuf, indbufend - indbuf, sizeof (Elf_Internal_Sym *),
-	 elf_sort_elf_symbol);
+/* Fill in the digests of HEAD, one of the sections in the symbuf of
+   ABFD, whose symbol table is HDR, unless that has been done.  */
+
+static bool
+elf_symbuf_head_hash (struct elf_symbuf_head *head, bfd *abfd,
+		      Elf_Internal_Shdr *hdr)
+{
+  unsigned long long digest = 0, digest_nosec = 0;
+  size_t i, sec_count = 0;
+
+  if (head->hashed)
+    return true;
+
+  for (i = 0; i < head->count; i++)
+    {
+      struct elf_symbuf_symbol *ssym = &head->ssym[i];
+      struct elf_symbol sym;
+      unsigned long long h;
+
+      if (!elf_symbol_init (&sym, abfd, hdr, ssym->st_name, ssym->st_info,
+			    ssym->st_other))
+	return false;
+      h = elf_symbol_digest (&sym);
+      digest += h;
+      if (ELF_ST_TYPE (ssym->st_info) == STT_SECTION)
+	sec_count++;
+      else
+	digest_nosec += h;
+    }
+
+  head->sec_count = sec_count;
+  head->digest = digest;
+  head->digest_nosec = digest_nosec;
+  head->hashed = true;
+  return true;
+}
+
+/* Return TRUE if the COUNT symbols in each of SYMTABLE1 and SYMTABLE2
+   pair off: the Nth symbol of each name in one must have the same
+   binding, type and visibility as the Nth of that name in the other.
+   This is what sorting both tables by name, keeping symbols of the
+   same name in order, and comparing them one by one would find, but
+   takes time in proportion to COUNT.  */
+
+static bool
+elf_symbol_tables_match (const struct elf_symbol *symtable1,
+			 const struct elf_symbol *symtable2, size_t count)
+{
+  size_t size, mask, i, *first, *cursor, *next;
+  bool result = false;
+
+  for (size = 16; size < count * 2; size <<= 1)
+    ;
+  mask = size - 1;
+  first = (size_t *) bfd_malloc (size * sizeof (*first));
+  cursor = (size_t *) bfd_malloc (size * sizeof (*cursor));
+  next = (size_t *) bfd_malloc (count * sizeof (*next));
+  if (first == NULL || cursor == NULL || next == NULL)
+    goto done;
+
+  /* Chain the symbols of each name in SYMTABLE1 in order, from a slot
+     for the name.  */
+  memset (first, -1, size * sizeof (*first));
+  for (i = count; i-- > 0; )
+    {
+      const struct elf_symbol *sym = &symtable1[i];
+      size_t slot = sym->hash & mask;
+
+      while (first[slot] != (size_t) -1
+	     && (symtable1[first[slot]].hash != sym->hash
+		 || strcmp (symtable1[first[slot]].name, sym->name) != 0))
+	slot = (slot + 1) & mask;
+      next[i] = first[slot];
+      first[slot] = i;
+    }
+  memcpy (cursor, first, size * sizeof (*cursor));
+
+  for (i = 0; i < count; i++)
+    {
+      const struct elf_symbol *sym = &symtable2[i];
+      size_t slot = sym->hash & mask;
+      size_t j;
+
+      while (first[slot] != (size_t) -1
+	     && (symtable1[first[slot]].hash != sym->hash
+		 || strcmp (symtable1[first[slot]].name, sym->name) != 0))
+	slot = (slot + 1) & mask;
+      j = cursor[slot];
+      if (j == (size_t) -1
+	  || symtable1[j].st_info != sym->st_info
+	  || symtable1[j].st_other != sym->st_other)
+	goto done;
+      cursor[slot] = next[j];
+    }
+  result = true;
+
+ done:
+  free (first);
+  free (cursor);
+  free (next);
+  return result;
+}
+
+static struct elf_symbuf_head *
+elf_create_symbuf (size_t symcount, Elf_Internal_Sym *isymbuf)
+{
+  Elf_Internal_Sym **ind, **indbufend, **indbuf;
+  struct elf_symbuf_symbol *ssym;
+  struct elf_symbuf_head *ssymbuf, *ssymhead;
+  size_t i, shndx_count, total_size, amt;
+
+  amt = symcount * sizeof (*indbuf);
+  indbuf = (Elf_Internal_Sym **) bfd_malloc (amt);
+  if (indbuf == NULL)
+    return NULL;
+
+  for (ind = indbuf, i = 0; i < symcount; i++)
+    if (isymbuf[i].st_shndx != SHN_UNDEF)
+      *ind++ = &isymbuf[i];
+  indbufend = ind;
+
+  qsort (indbuf, indbufend - indbuf, sizeof (Elf_Internal_Sym *),
+	 elf_sort_elf_symbol);
 
   shndx_count = 0;
   if (indbufend > indbuf)
@@ -8374,6 +9439,7 @@ elf_create_symbuf (size_t symcount, Elf_Internal_Sym *isymbuf)
   ssymbuf->ssym = NULL;
   ssymbuf->count = shndx_count;
   ssymbuf->st_shndx = 0;
+  ssymbuf->hashed = false;
   for (ssymhead = ssymbuf, ind = indbuf; ind < indbufend; ssym++, ind++)
     {
       if (ind == indbuf || ssymhead->st_shndx != (*ind)->st_shndx)
@@ -8382,6 +9448,7 @@ elf_create_symbuf (size_t symcount, Elf_Internal_Sym *isymbuf)
 	  ssymhead->ssym = ssym;
 	  ssymhead->count = 0;
 	  ssymhead->st_shndx = (*ind)->st_shndx;
+	  ssymhead->hashed = false;
 	}
       ssym->st_name = (*ind)->st_name;
       ssym->st_info = (*ind)->st_info;
@@ -8410,7 +9477,7 @@ bfd_elf_match_symbols_in_sections (asection *sec1, asection *sec2,
   struct elf_symbuf_head *ssymbuf1, *ssymbuf2;
   Elf_Internal_Sym *isym, *isymend;
   struct elf_symbol *symtable1 = NULL, *symtable2 = NULL;
-  size_t count1, count2, sec_count1, sec_count2, i;
+  size_t count1, count2, sec_count1, sec_count2;
   unsigned int shndx1, shndx2;
   bool result;
   bool ignore_section_symbol_p;
@@ -8488,12 +9555,11 @@ bfd_elf_match_symbols_in_sections (asection *sec1, asection *sec2,
       size_t lo, hi, mid;
       struct elf_symbol *symp;
       struct elf_symbuf_symbol *ssym, *ssymend;
+      struct elf_symbuf_head *head1 = NULL, *head2 = NULL;
 
       lo = 0;
       hi = ssymbuf1->count;
       ssymbuf1++;
-      count1 = 0;
-      sec_count1 = 0;
       while (lo < hi)
 	{
 	  mid = (lo + hi) / 2;
@@ -8503,24 +9569,14 @@ bfd_elf_match_symbols_in_sections (asection *sec1, asection *sec2,
 	    lo = mid + 1;
 	  else
 	    {
-	      count1 = ssymbuf1[mid].count;
-	      ssymbuf1 += mid;
+	      head1 = &ssymbuf1[mid];
 	      break;
 	    }
 	}
-      if (ignore_section_symbol_p)
-	{
-	  for (i = 0; i < count1; i++)
-	    if (ELF_ST_TYPE (ssymbuf1->ssym[i].st_info) == STT_SECTION)
-	      sec_count1++;
-	  count1 -= sec_count1;
-	}
 
       lo = 0;
       hi = ssymbuf2->count;
       ssymbuf2++;
-      count2 = 0;
-      sec_count2 = 0;
       while (lo < hi)
 	{
 	  mid = (lo + hi) / 2;
@@ -8530,20 +9586,27 @@ bfd_elf_match_symbols_in_sections (asection *sec1, asection *sec2,
 	    lo = mid + 1;
 	  else
 	    {
-	      count2 = ssymbuf2[mid].count;
-	      ssymbuf2 += mid;
+	      head2 = &ssymbuf2[mid];
 	      break;
 	    }
 	}
-      if (ignore_section_symbol_p)
-	{
-	  for (i = 0; i < count2; i++)
-	    if (ELF_ST_TYPE (ssymbuf2->ssym[i].st_info) == STT_SECTION)
-	      sec_count2++;
-	  count2 -= sec_count2;
-	}
 
-      if (count1 == 0 || count2 == 0 || count1 != count2)
+      if (head1 == NULL || head2 == NULL
+	  || !elf_symbuf_head_hash (head1, bfd1, hdr1)
+	  || !elf_symbuf_head_hash (head2, bfd2, hdr2))
+	goto done;
+
+      /* The digests are kept with the symbuf, so sections that don't
+	 match are mostly told apart without looking at their symbols
+	 again.  */
+      sec_count1 = ignore_section_symbol_p ? head1->sec_count : 0;
+      sec_count2 = ignore_section_symbol_p ? head2->sec_count : 0;
+      count1 = head1->count - sec_count1;
+      count2 = head2->count - sec_count2;
+      if (count1 == 0 || count2 == 0 || count1 != count2
+	  || (ignore_section_symbol_p
+	      ? head1->digest_nosec != head2->digest_nosec
+	      : head1->digest != head2->digest))
 	goto done;
 
       symtable1
@@ -8554,45 +9617,30 @@ bfd_elf_match_symbols_in_sections (asection *sec1, asection *sec2,
 	goto done;
 
       symp = symtable1;
-      for (ssym = ssymbuf1->ssym, ssymend = ssym + count1 + sec_count1;
+      for (ssym = head1->ssym, ssymend = ssym + head1->count;
 	   ssym < ssymend; ssym++)
 	if (sec_count1 == 0
 	    || ELF_ST_TYPE (ssym->st_info) != STT_SECTION)
 	  {
-	    symp->u.ssym = ssym;
-	    symp->name = bfd_elf_string_from_elf_section (bfd1,
-							  hdr1->sh_link,
-							  ssym->st_name);
+	    if (!elf_symbol_init (symp, bfd1, hdr1, ssym->st_name,
+				  ssym->st_info, ssym->st_other))
+	      goto done;
 	    symp++;
 	  }
 
       symp = symtable2;
-      for (ssym = ssymbuf2->ssym, ssymend = ssym + count2 + sec_count2;
+      for (ssym = head2->ssym, ssymend = ssym + head2->count;
 	   ssym < ssymend; ssym++)
 	if (sec_count2 == 0
 	    || ELF_ST_TYPE (ssym->st_info) != STT_SECTION)
 	  {
-	    symp->u.ssym = ssym;
-	    symp->name = bfd_elf_string_from_elf_section (bfd2,
-							  hdr2->sh_link,
-							  ssym->st_name);
+	    if (!elf_symbol_init (symp, bfd2, hdr2, ssym->st_name,
+				  ssym->st_info, ssym->st_other))
+	      goto done;
 	    symp++;
 	  }
 
-      /* Sort symbol by name.  */
-      qsort (symtable1, count1, sizeof (struct elf_symbol),
-	     elf_sym_name_compare);
-      qsort (symtable2, count1, sizeof (struct elf_symbol),
-	     elf_sym_name_compare);
-
-      for (i = 0; i < count1; i++)
-	/* Two symbols must have the same binding, type and name.  */
-	if (symtable1 [i].u.ssym->st_info != symtable2 [i].u.ssym->st_info
-	    || symtable1 [i].u.ssym->st_other != symtable2 [i].u.ssym->st_other
-	    || strcmp (symtable1 [i].name, symtable2 [i].name) != 0)
-	  goto done;
-
-      result = true;
+      result = elf_symbol_tables_match (symtable1, symtable2, count1);
       goto done;
     }
 
@@ -8609,42 +9657,29 @@ bfd_elf_match_symbols_in_sections (asection *sec1, asection *sec2,
     if (isym->st_shndx == shndx1
 	&& (!ignore_section_symbol_p
 	    || ELF_ST_TYPE (isym->st_info) != STT_SECTION))
-      symtable1[count1++].u.isym = isym;
+      {
+	if (!elf_symbol_init (&symtable1[count1], bfd1, hdr1, isym->st_name,
+			      isym->st_info, isym->st_other))
+	  goto done;
+	count1++;
+      }
 
   count2 = 0;
   for (isym = isymbuf2, isymend = isym + symcount2; isym < isymend; isym++)
     if (isym->st_shndx == shndx2
 	&& (!ignore_section_symbol_p
 	    || ELF_ST_TYPE (isym->st_info) != STT_SECTION))
-      symtable2[count2++].u.isym = isym;
+      {
+	if (!elf_symbol_init (&symtable2[count2], bfd2, hdr2, isym->st_name,
+			      isym->st_info, isym->st_other))
+	  goto done;
+	count2++;
+      }
 
   if (count1 == 0 || count2 == 0 || count1 != count2)
     goto done;
 
-  for (i = 0; i < count1; i++)
-    symtable1[i].name
-      = bfd_elf_string_from_elf_section (bfd1, hdr1->sh_link,
-					 symtable1[i].u.isym->st_name);
-
-  for (i = 0; i < count2; i++)
-    symtable2[i].name
-      = bfd_elf_string_from_elf_section (bfd2, hdr2->sh_link,
-					 symtable2[i].u.isym->st_name);
-
-  /* Sort symbol by name.  */
-  qsort (symtable1, count1, sizeof (struct elf_symbol),
-	 elf_sym_name_compare);
-  qsort (symtable2, count1, sizeof (struct elf_symbol),
-	 elf_sym_name_compare);
-
-  for (i = 0; i < count1; i++)
-    /* Two symbols must have the same binding, type and name.  */
-    if (symtable1 [i].u.isym->st_info != symtable2 [i].u.isym->st_info
-	|| symtable1 [i].u.isym->st_other != symtable2 [i].u.isym->st_other
-	|| strcmp (symtable1 [i].name, symtable2 [i].name) != 0)
-      goto done;
-
-  result = true;
+  result = elf_symbol_tables_match (symtable1, symtable2, count1);
 
  done:
   free (symtable1);
@@ -8712,6 +9747,34 @@ struct elf_final_link_info
   size_t filesym_count;
   /* Local symbol hash table.  */
   struct bfd_hash_table local_hash_table;
+  /* Work left for other threads, if sections are being relocated in
+     parallel.  */
+  struct elf_parallel_link *parallel;
+  /* Whether this is a worker thread's copy.  Workers relocate only
+     the sections elf_link_parallel_section_p picks out.  */
+  bool worker;
+};
+
+/* The state shared by the threads relocating sections in parallel.  */
+
+struct elf_parallel_link
+{
+  /* The link whose buffer sizes and settings the workers copy.  */
+  struct elf_final_link_info *flinfo;
+  /* Input BFDs with sections left for the workers.  */
+  bfd **bfds;
+  size_t count;
+  size_t alloc;
+  /* Sizes of the buffers in elf_final_link_info.  */
+  bfd_size_type max_contents_size;
+  bfd_size_type max_external_reloc_size;
+  bfd_size_type max_internal_reloc_count;
+  bfd_size_type max_sym_count;
+  bfd_size_type max_sym_shndx_count;
+  /* Held by a worker while it reads an input file or writes the
+     output, since archive members share a file position and so do
+     the output's sections.  */
+  bfd_mutex io_lock;
 };
 
 struct local_hash_entry
@@ -9406,6 +10469,61 @@ ext64b_r_offset (const void *p)
   return aval;
 }
 
+/* Rewrite the symbol indices of relocs in ranges of this many on
+   several threads, if allowed.  */
+#define ADJUST_RELOCS_GRAIN 16384
+
+/* The output reloc section whose symbol indices
+   elf_link_adjust_relocs_range rewrites.  */
+
+struct elf_adjust_relocs_job
+{
+  bfd *abfd;
+  struct bfd_link_info *info;
+  struct bfd_elf_section_reloc_data *reldata;
+  void (*swap_in) (bfd *, const bfd_byte *, Elf_Internal_Rela *);
+  void (*swap_out) (bfd *, const Elf_Internal_Rela *, bfd_byte *);
+  bfd_vma r_type_mask;
+  int r_sym_shift;
+};
+
+/* Give relocs START to END of JOB the final indices of the global
+   symbols they refer to.  Return false, leaving the caller to report
+   it, on finding one against a symbol removed by garbage collection.
+   Worker for _bfd_parallel_for.  */
+
+static bool
+elf_link_adjust_relocs_range (void *data, size_t start, size_t end)
+{
+  struct elf_adjust_relocs_job *job = (struct elf_adjust_relocs_job *) data;
+  const struct elf_backend_data *bed = get_elf_backend_data (job->abfd);
+  struct elf_link_hash_entry **rel_hash = job->reldata->hashes + start;
+  bfd_size_type entsize = job->reldata->hdr->sh_entsize;
+  bfd_byte *erela = job->reldata->hdr->contents + start * entsize;
+
+  for (; start < end; start++, rel_hash++, erela += entsize)
+    {
+      Elf_Internal_Rela irela[MAX_INT_RELS_PER_EXT_REL];
+      unsigned int j;
+
+      if (*rel_hash == NULL)
+	continue;
+
+      if ((*rel_hash)->indx == -2
+	  && job->info->gc_sections
+	  && ! job->info->gc_keep_exported)
+	return false;
+      BFD_ASSERT ((*rel_hash)->indx >= 0);
+
+      (*job->swap_in) (job->abfd, erela, irela);
+      for (j = 0; j < bed->s->int_rels_per_ext_rel; j++)
+	irela[j].r_info = ((bfd_vma) (*rel_hash)->indx << job->r_sym_shift
+			   | (irela[j].r_info & job->r_type_mask));
+      (*job->swap_out) (job->abfd, irela, erela);
+    }
+  return true;
+}
+
 /* When performing a relocatable link, the input relocations are
    preserved.  But, if they reference global symbols, the indices
    referenced must be updated.  Update all the relocations found in
@@ -9420,23 +10538,22 @@ elf_link_adjust_relocs (bfd *abfd,
 {
   unsigned int i;
   const struct elf_backend_data *bed = get_elf_backend_data (abfd);
-  bfd_byte *erela;
-  void (*swap_in) (bfd *, const bfd_byte *, Elf_Internal_Rela *);
-  void (*swap_out) (bfd *, const Elf_Internal_Rela *, bfd_byte *);
-  bfd_vma r_type_mask;
-  int r_sym_shift;
+  struct elf_adjust_relocs_job job;
   unsigned int count = reldata->count;
   struct elf_link_hash_entry **rel_hash = reldata->hashes;
 
+  job.abfd = abfd;
+  job.info = info;
+  job.reldata = reldata;
   if (reldata->hdr->sh_entsize == bed->s->sizeof_rel)
     {
-      swap_in = bed->s->swap_reloc_in;
-      swap_out = bed->s->swap_reloc_out;
+      job.swap_in = bed->s->swap_reloc_in;
+      job.swap_out = bed->s->swap_reloc_out;
     }
   else if (reldata->hdr->sh_entsize == bed->s->sizeof_rela)
     {
-      swap_in = bed->s->swap_reloca_in;
-      swap_out = bed->s->swap_reloca_out;
+      job.swap_in = bed->s->swap_reloca_in;
+      job.swap_out = bed->s->swap_reloca_out;
     }
   else
     abort ();
@@ -9446,44 +10563,36 @@ elf_link_adjust_relocs (bfd *abfd,
 
   if (bed->s->arch_size == 32)
     {
-      r_type_mask = 0xff;
-      r_sym_shift = 8;
+      job.r_type_mask = 0xff;
+      job.r_sym_shift = 8;
     }
   else
     {
-      r_type_mask = 0xffffffff;
-      r_sym_shift = 32;
+      job.r_type_mask = 0xffffffff;
+      job.r_sym_shift = 32;
     }
 
-  erela = reldata->hdr->contents;
-  for (i = 0; i < count; i++, rel_hash++, erela += reldata->hdr->sh_entsize)
+  /* The final symbol indices are all known by now, and each reloc is
+     rewritten on its own, so big sections can be done in ranges on
+     several threads.  */
+  if (!_bfd_parallel_for (count, ADJUST_RELOCS_GRAIN,
+			  elf_link_adjust_relocs_range, &job))
     {
-      Elf_Internal_Rela irela[MAX_INT_RELS_PER_EXT_REL];
-      unsigned int j;
-
-      if (*rel_hash == NULL)
-	continue;
-
-      if ((*rel_hash)->indx == -2
-	  && info->gc_sections
-	  && ! info->gc_keep_exported)
+      for (i = 0; i < count; i++)
+	if (rel_hash[i] != NULL && rel_hash[i]->indx == -2)
+	  break;
+      BFD_ASSERT (i < count);
+      if (i < count)
 	{
 	  /* PR 21524: Let the user know if a symbol was removed by garbage collection.  */
 	  _bfd_error_handler (_("%pB:%pA: error: relocation references symbol %s which was removed by garbage collection"),
 			      abfd, sec,
-			      (*rel_hash)->root.root.string);
+			      rel_hash[i]->root.root.string);
 	  _bfd_error_handler (_("%pB:%pA: error: try relinking with --gc-keep-exported enabled"),
 			      abfd, sec);
-	  bfd_set_error (bfd_error_invalid_operation);
-	  return false;
 	}
-      BFD_ASSERT ((*rel_hash)->indx >= 0);
-
-      (*swap_in) (abfd, erela, irela);
-      for (j = 0; j < bed->s->int_rels_per_ext_rel; j++)
-	irela[j].r_info = ((bfd_vma) (*rel_hash)->indx << r_sym_shift
-			   | (irela[j].r_info & r_type_mask));
-      (*swap_out) (abfd, irela, erela);
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
     }
 
   if (bed->elf_backend_update_relocs)
@@ -9608,70 +10717,167 @@ elf_link_adjust_relocs (bfd *abfd,
   return true;
 }
 
-struct elf_link_sort_rela
+/* A dynamic reloc's place in the order elf_link_sort_relocs puts
+   them in.  Relocs are sorted on KEY, most significant word first,
+   and INDEX is where the reloc was before sorting.
+
+   The relocs are sorted twice.  First, relative relocs go before all
+   others, and within each part relocs are ordered by symbol and then
+   by offset.  Then the non-relative relocs are ordered by reloc type
+   class, then by the offset of the first reloc against the same
+   symbol, then by their own offset.  The sort is stable, so relocs
+   with equal keys keep their order in the section.  Only dynamic
+   NONE relocs, which target bugs produce, and targets that apply a
+   chain of dynamic relocs to the same address are likely to have
+   equal keys.  Such targets can't use -z combreloc as implemented
+   anyway.  */
+
+struct elf_link_sort_key
 {
-  union {
-    bfd_vma offset;
-    bfd_vma sym_mask;
-  } u;
-  enum elf_reloc_type_class type;
-  /* We use this as an array of size int_rels_per_ext_rel.  */
-  Elf_Internal_Rela rela[1];
+  uint64_t key[3];
+  size_t index;
 };
 
-/* qsort stability here and for cmp2 is only an issue if multiple
-   dynamic relocations are emitted at the same address.  But targets
-   that apply a series of dynamic relocations each operating on the
-   result of the prior relocation can't use -z combreloc as
-   implemented anyway.  Such schemes tend to be broken by sorting on
-   symbol index.  That leaves dynamic NONE relocs as the only other
-   case where ld might emit multiple relocs at the same address, and
-   those are only emitted due to target bugs.  */
+/* Sort relocs in pieces of this many on several threads, if allowed,
+   using at most ELF_LINK_SORT_MAX_PIECES pieces.  */
+#define ELF_LINK_SORT_GRAIN 65536
+#define ELF_LINK_SORT_MAX_PIECES 64
 
-static int
-elf_link_sort_cmp1 (const void *A, const void *B)
+/* Sort on this many bits of the key at a time.  */
+#define ELF_LINK_SORT_BITS 11
+#define ELF_LINK_SORT_BUCKETS (1 << ELF_LINK_SORT_BITS)
+
+/* One pass of elf_link_radix_sort, on the ELF_LINK_SORT_BITS of each
+   key from bit SHIFT of word WORD.  */
+
+struct elf_link_sort_job
 {
-  const struct elf_link_sort_rela *a = (const struct elf_link_sort_rela *) A;
-  const struct elf_link_sort_rela *b = (const struct elf_link_sort_rela *) B;
-  int relativea, relativeb;
+  const struct elf_link_sort_key *src;
+  struct elf_link_sort_key *dst;
+  size_t count;
+  size_t piece;
+  unsigned int word;
+  unsigned int shift;
+  /* For each piece, the number of keys with each value of those
+     bits, and then where the first of them goes.  */
+  size_t (*buckets)[ELF_LINK_SORT_BUCKETS];
+};
 
-  relativea = a->type == reloc_class_relative;
-  relativeb = b->type == reloc_class_relative;
+/* The bucket in JOB's pass for KEY.  */
 
-  if (relativea < relativeb)
-    return 1;
-  if (relativea > relativeb)
-    return -1;
-  if ((a->rela->r_info & a->u.sym_mask) < (b->rela->r_info & b->u.sym_mask))
-    return -1;
-  if ((a->rela->r_info & a->u.sym_mask) > (b->rela->r_info & b->u.sym_mask))
-    return 1;
-  if (a->rela->r_offset < b->rela->r_offset)
-    return -1;
-  if (a->rela->r_offset > b->rela->r_offset)
-    return 1;
-  return 0;
+static inline size_t
+elf_link_sort_bucket (const struct elf_link_sort_job *job,
+		      const struct elf_link_sort_key *key)
+{
+  return (key->key[job->word] >> job->shift) & (ELF_LINK_SORT_BUCKETS - 1);
 }
 
-static int
-elf_link_sort_cmp2 (const void *A, const void *B)
+/* Count the keys in each bucket for pieces START to END.  Worker for
+   _bfd_parallel_for.  */
+
+static bool
+elf_link_sort_count (void *data, size_t start, size_t end)
 {
-  const struct elf_link_sort_rela *a = (const struct elf_link_sort_rela *) A;
-  const struct elf_link_sort_rela *b = (const struct elf_link_sort_rela *) B;
+  struct elf_link_sort_job *job = (struct elf_link_sort_job *) data;
 
-  if (a->type < b->type)
-    return -1;
-  if (a->type > b->type)
-    return 1;
-  if (a->u.offset < b->u.offset)
-    return -1;
-  if (a->u.offset > b->u.offset)
-    return 1;
-  if (a->rela->r_offset < b->rela->r_offset)
-    return -1;
-  if (a->rela->r_offset > b->rela->r_offset)
-    return 1;
-  return 0;
+  for (; start < end; start++)
+    {
+      size_t *b = job->buckets[start];
+      size_t i = start * job->piece;
+      size_t n = i + job->piece < job->count ? i + job->piece : job->count;
+
+      memset (b, 0, sizeof (job->buckets[0]));
+      for (; i < n; i++)
+	b[elf_link_sort_bucket (job, &job->src[i])]++;
+    }
+  return true;
+}
+
+/* Move the keys of pieces START to END to their places.  Worker for
+   _bfd_parallel_for.  */
+
+static bool
+elf_link_sort_scatter (void *data, size_t start, size_t end)
+{
+  struct elf_link_sort_job *job = (struct elf_link_sort_job *) data;
+
+  for (; start < end; start++)
+    {
+      size_t *b = job->buckets[start];
+      size_t i = start * job->piece;
+      size_t n = i + job->piece < job->count ? i + job->piece : job->count;
+
+      for (; i < n; i++)
+	job->dst[b[elf_link_sort_bucket (job, &job->src[i])]++] = job->src[i];
+    }
+  return true;
+}
+
+/* Sort the COUNT keys at KEYS, using TMP, which has room for as many,
+   as scratch.  This is a least significant digit first radix sort,
+   skipping digits that are the same in every key, so is stable.  Big
+   arrays are split into pieces whose digits are counted and then
+   moved by several threads.  Return KEYS or TMP, whichever ends up
+   holding the sorted keys, or NULL if out of memory.  */
+
+static struct elf_link_sort_key *
+elf_link_radix_sort (struct elf_link_sort_key *keys,
+		     struct elf_link_sort_key *tmp, size_t count)
+{
+  struct elf_link_sort_job job;
+  uint64_t differ[3] = { 0, 0, 0 };
+  size_t npieces, i;
+  int w;
+
+  if (count < 2)
+    return keys;
+
+  for (i = 1; i < count; i++)
+    for (w = 0; w < 3; w++)
+      differ[w] |= keys[i].key[w] ^ keys[0].key[w];
+
+  npieces = 1;
+  if (bfd_get_thread_count () > 1)
+    {
+      npieces = (count + ELF_LINK_SORT_GRAIN - 1) / ELF_LINK_SORT_GRAIN;
+      if (npieces > ELF_LINK_SORT_MAX_PIECES)
+	npieces = ELF_LINK_SORT_MAX_PIECES;
+    }
+  job.buckets = ((size_t (*)[ELF_LINK_SORT_BUCKETS])
+		 bfd_malloc (npieces * sizeof (job.buckets[0])));
+  if (job.buckets == NULL)
+    return NULL;
+  job.count = count;
+  job.piece = (count + npieces - 1) / npieces;
+
+  job.src = keys;
+  job.dst = tmp;
+  for (w = 2; w >= 0; w--)
+    for (job.shift = 0; job.shift < 64; job.shift += ELF_LINK_SORT_BITS)
+      if (((differ[w] >> job.shift) & (ELF_LINK_SORT_BUCKETS - 1)) != 0)
+	{
+	  struct elf_link_sort_key *next;
+	  size_t pos = 0, d, p;
+
+	  job.word = w;
+	  _bfd_parallel_for (npieces, 1, elf_link_sort_count, &job);
+	  for (d = 0; d < ELF_LINK_SORT_BUCKETS; d++)
+	    for (p = 0; p < npieces; p++)
+	      {
+		size_t n = job.buckets[p][d];
+
+		job.buckets[p][d] = pos;
+		pos += n;
+	      }
+	  _bfd_parallel_for (npieces, 1, elf_link_sort_scatter, &job);
+
+	  next = (struct elf_link_sort_key *) job.src;
+	  job.src = job.dst;
+	  job.dst = next;
+	}
+
+  free (job.buckets);
+  return (struct elf_link_sort_key *) job.src;
 }
 
 static size_t
@@ -9681,9 +10887,10 @@ elf_link_sort_relocs (bfd *abfd, struct bfd_link_info *info, asection **psec)
   asection *rela_dyn;
   asection *rel_dyn;
   bfd_size_type count, size;
-  size_t i, ret, sort_elt, ext_size;
-  bfd_byte *sort, *s_non_relative, *p;
-  struct elf_link_sort_rela *sq;
+  size_t i, ret, ext_size, amt;
+  Elf_Internal_Rela *relas, *sq;
+  unsigned char *classes;
+  struct elf_link_sort_key *keys, *sorted, *rest;
   const struct elf_backend_data *bed = get_elf_backend_data (abfd);
   int i2e = bed->s->int_rels_per_ext_rel;
   unsigned int opb = bfd_octets_per_byte (abfd, NULL);
@@ -9855,18 +11062,26 @@ elf_link_sort_relocs (bfd *abfd, struct bfd_link_info *info, asection **psec)
   if (size != dynamic_relocs->size)
     return 0;
 
-  sort_elt = (sizeof (struct elf_link_sort_rela)
-	      + (i2e - 1) * sizeof (Elf_Internal_Rela));
-
   count = dynamic_relocs->size / ext_size;
   if (count == 0)
     return 0;
-  sort = (bfd_byte *) bfd_zmalloc (sort_elt * count);
-
-  if (sort == NULL)
-    {
+  relas = NULL;
+  classes = NULL;
+  keys = NULL;
+  if (!_bfd_mul_overflow (count * i2e, sizeof (*relas), &amt))
+    relas = (Elf_Internal_Rela *) bfd_zmalloc (amt);
+  if (!_bfd_mul_overflow (count * 2, sizeof (*keys), &amt))
+    keys = (struct elf_link_sort_key *) bfd_malloc (amt);
+  classes = (unsigned char *) bfd_zmalloc (count);
+
+  if (relas == NULL || keys == NULL || classes == NULL)
+    {
+    no_memory:
       (*info->callbacks->warning)
 	(info, _("not enough memory to sort relocations"), 0, abfd, 0, 0);
+      free (relas);
+      free (keys);
+      free (classes);
       return 0;
     }
 
@@ -9886,54 +11101,73 @@ elf_link_sort_relocs (bfd *abfd, struct bfd_link_info *info, asection **psec)
 	    /* This is a reloc section that is being handled as a normal
 	       section.  See bfd_section_from_shdr.  We can't combine
 	       relocs in this case.  */
-	    free (sort);
+	    free (relas);
+	    free (keys);
+	    free (classes);
 	    return 0;
 	  }
 	erel = o->contents;
 	erelend = o->contents + o->size;
-	p = sort + o->output_offset * opb / ext_size * sort_elt;
+	i = o->output_offset * opb / ext_size;
 
 	while (erel < erelend)
 	  {
-	    struct elf_link_sort_rela *s = (struct elf_link_sort_rela *) p;
+	    Elf_Internal_Rela *r = relas + i * i2e;
 
-	    (*swap_in) (abfd, erel, s->rela);
-	    s->type = (*bed->elf_backend_reloc_type_class) (info, o, s->rela);
-	    s->u.sym_mask = r_sym_mask;
-	    p += sort_elt;
+	    (*swap_in) (abfd, erel, r);
+	    classes[i] = (*bed->elf_backend_reloc_type_class) (info, o, r);
+	    i++;
 	    erel += ext_size;
 	  }
       }
 
-  qsort (sort, count, sort_elt, elf_link_sort_cmp1);
-
-  for (i = 0, p = sort; i < count; i++, p += sort_elt)
-    {
-      struct elf_link_sort_rela *s = (struct elf_link_sort_rela *) p;
-      if (s->type != reloc_class_relative)
-	break;
-    }
-  ret = i;
-  s_non_relative = p;
-
-  sq = (struct elf_link_sort_rela *) s_non_relative;
-  for (; i < count; i++, p += sort_elt)
-    {
-      struct elf_link_sort_rela *sp = (struct elf_link_sort_rela *) p;
-      if (((sp->rela->r_info ^ sq->rela->r_info) & r_sym_mask) != 0)
-	sq = sp;
-      sp->u.offset = sq->rela->r_offset;
-    }
-
-  qsort (s_non_relative, count - ret, sort_elt, elf_link_sort_cmp2);
+  /* First put the relative relocs first, then order by symbol and
+     offset.  */
+  ret = 0;
+  for (i = 0; i < count; i++)
+    {
+      Elf_Internal_Rela *r = relas + i * i2e;
+      bool relative = classes[i] == reloc_class_relative;
+
+      ret += relative;
+      keys[i].key[0] = ((uint64_t) !relative << 32
+			| (uint64_t) ((r->r_info & r_sym_mask)
+				      >> (bed->s->arch_size == 32 ? 8 : 32)));
+      keys[i].key[1] = r->r_offset;
+      keys[i].key[2] = 0;
+      keys[i].index = i;
+    }
+  sorted = elf_link_radix_sort (keys, keys + count, count);
+  if (sorted == NULL)
+    goto no_memory;
+
+  /* Then order the others by class and by the first offset of their
+     symbol.  */
+  sq = NULL;
+  for (i = ret; i < count; i++)
+    {
+      Elf_Internal_Rela *r = relas + sorted[i].index * i2e;
+
+      if (sq == NULL || ((r->r_info ^ sq->r_info) & r_sym_mask) != 0)
+	sq = r;
+      sorted[i].key[0] = classes[sorted[i].index];
+      sorted[i].key[1] = sq->r_offset;
+      sorted[i].key[2] = r->r_offset;
+    }
+  rest = elf_link_radix_sort (sorted + ret,
+			      (sorted == keys ? keys + count : keys) + ret,
+			      count - ret);
+  if (rest == NULL)
+    goto no_memory;
+  if (rest != sorted + ret)
+    memcpy (sorted + ret, rest, (count - ret) * sizeof (*rest));
 
   struct elf_link_hash_table *htab = elf_hash_table (info);
   if (htab->srelplt && htab->srelplt->output_section == dynamic_relocs)
     {
       /* We have plt relocs in .rela.dyn.  */
-      sq = (struct elf_link_sort_rela *) sort;
       for (i = 0; i < count; i++)
-	if (sq[count - i - 1].type != reloc_class_plt)
+	if (classes[sorted[count - i - 1].index] != reloc_class_plt)
 	  break;
       if (i != 0 && htab->srelplt->size == i * ext_size)
 	{
@@ -9955,7 +11189,8 @@ elf_link_sort_relocs (bfd *abfd, struct bfd_link_info *info, asection **psec)
 	}
     }
 
-  p = sort;
+  /* Swap the relocs out in their new order.  */
+  i = 0;
   for (lo = dynamic_relocs->map_head.link_order; lo != NULL; lo = lo->next)
     if (lo->type == bfd_indirect_link_order)
       {
@@ -9964,17 +11199,18 @@ elf_link_sort_relocs (bfd *abfd, struct bfd_link_info *info, asection **psec)
 
 	erel = o->contents;
 	erelend = o->contents + o->size;
-	o->output_offset = (p - sort) / sort_elt * ext_size / opb;
+	o->output_offset = i * ext_size / opb;
 	while (erel < erelend)
 	  {
-	    struct elf_link_sort_rela *s = (struct elf_link_sort_rela *) p;
-	    (*swap_out) (abfd, s->rela, erel);
-	    p += sort_elt;
+	    (*swap_out) (abfd, relas + sorted[i].index * i2e, erel);
+	    i++;
 	    erel += ext_size;
 	  }
       }
 
-  free (sort);
+  free (relas);
+  free (keys);
+  free (classes);
   *psec = dynamic_relocs;
   return ret;
 }
@@ -10147,7 +11383,8 @@ elf_link_swap_symbols_out (struct elf_final_link_info *flinfo)
 	}
     }
 
-  /* Now swap out the symbols.  */
+  /* Set the final string table offsets first, so that the symbols
+     can then be swapped out on several threads.  */
   for (i = 0; i < flinfo->output_bfd->symcount; i++)
     {
       struct elf_sym_strtab *elfsym = &hash_table->strtab[i];
@@ -10163,13 +11400,14 @@ elf_link_swap_symbols_out (struct elf_final_link_info *flinfo)
       if (flinfo->info->callbacks->ctf_new_symbol)
 	flinfo->info->callbacks->ctf_new_symbol (elfsym->dest_index,
 						 &elfsym->sym);
+    }
 
-      bed->s->swap_symbol_out (flinfo->output_bfd, &elfsym->sym,
-			       ((bfd_byte *) symbuf
-				+ (elfsym->dest_index
-				   * bed->s->sizeof_sym)),
-			       NPTR_ADD (flinfo->symshndxbuf,
-					 elfsym->dest_index));
+  if (!_bfd_elf_swap_syms_out (flinfo->output_bfd, hash_table->strtab,
+			       flinfo->output_bfd->symcount, symbuf,
+			       flinfo->symshndxbuf))
+    {
+      free (symbuf);
+      return false;
     }
 
   hdr = &elf_tdata (flinfo->output_bfd)->symtab_hdr;
@@ -10753,7 +11991,7 @@ elf_link_output_extsym (struct bfd_hash_entry *bh, void *data)
 	 if there is no version info in symbol version section, we will
 	 have a run-time problem if not linking executable, referenced
 	 by shared library, or not bound locally.  */
-      if (h->verinfo.verdef == NULL
+      if (h->cold->verinfo.verdef == NULL
 	  && (!bfd_link_executable (flinfo->info)
 	      || h->ref_dynamic
 	      || !h->def_regular))
@@ -10817,19 +12055,19 @@ elf_link_output_extsym (struct bfd_hash_entry *bh, void *data)
 
 	  if (!h->def_regular && !ELF_COMMON_DEF_P (h))
 	    {
-	      if (h->verinfo.verdef == NULL
-		  || (elf_dyn_lib_class (h->verinfo.verdef->vd_bfd)
+	      if (h->cold->verinfo.verdef == NULL
+		  || (elf_dyn_lib_class (h->cold->verinfo.verdef->vd_bfd)
 		      & (DYN_AS_NEEDED | DYN_DT_NEEDED | DYN_NO_NEEDED)))
 		iversym.vs_vers = 1;
 	      else
-		iversym.vs_vers = h->verinfo.verdef->vd_exp_refno + 1;
+		iversym.vs_vers = h->cold->verinfo.verdef->vd_exp_refno + 1;
 	    }
 	  else
 	    {
-	      if (h->verinfo.vertree == NULL)
+	      if (h->cold->verinfo.vertree == NULL)
 		iversym.vs_vers = 1;
 	      else
-		iversym.vs_vers = h->verinfo.vertree->vernum + 1;
+		iversym.vs_vers = h->cold->verinfo.vertree->vernum + 1;
 	      if (flinfo->info->create_default_symver)
 		iversym.vs_vers++;
 	    }
@@ -11018,13 +12256,75 @@ _bfd_elf_check_kept_section (asection *sec, struct bfd_link_info *info)
   return kept;
 }
 
+/* Return TRUE if input section O is relocated and written by a worker
+   thread when the link is done in parallel.  Relocations in sections
+   that aren't loaded, such as debug info, never need dynamic relocs,
+   GOT or PLT entries, so relocating one touches nothing but the
+   section itself.  Sections that are merged or edited, or that need
+   special handling, are left to the main thread.  */
+
+static bool
+elf_link_parallel_section_p (asection *o)
+{
+  return ((o->flags & (SEC_ALLOC | SEC_LINKER_CREATED | SEC_EXCLUDE
+		       | SEC_GROUP | SEC_ELF_REVERSE_COPY)) == 0
+	  && (o->flags & SEC_HAS_CONTENTS) != 0
+	  && o->size != 0
+	  && o->sec_info_type == SEC_INFO_TYPE_NONE);
+}
+
+/* Serialise file access by worker threads.  */
+
+static void
+elf_link_io_lock (struct elf_final_link_info *flinfo)
+{
+  if (flinfo->worker)
+    _bfd_mutex_lock (&flinfo->parallel->io_lock);
+}
+
+static void
+elf_link_io_unlock (struct elf_final_link_info *flinfo)
+{
+  if (flinfo->worker)
+    _bfd_mutex_unlock (&flinfo->parallel->io_lock);
+}
+
+/* Write SIZE bytes of CONTENTS at OFFSET in output section OSEC.
+   Worker threads write straight to the section's place in the output
+   file, so that they can all write at once; contents that are
+   buffered in memory, such as those to be compressed, are still
+   copied in under the lock.  */
+
+static bool
+elf_link_write_output (struct elf_final_link_info *flinfo, asection *osec,
+		       const bfd_byte *contents, file_ptr offset,
+		       bfd_size_type size)
+{
+  bool written;
+
+  if (flinfo->worker
+      && elf_section_data (osec)->this_hdr.sh_offset != (file_ptr) -1
+      && (osec->flags & SEC_HAS_CONTENTS) != 0
+      && offset >= 0
+      && (bfd_size_type) offset <= osec->size
+      && size <= osec->size - offset)
+    return bfd_pwrite (contents, size, osec->filepos + offset,
+		       flinfo->output_bfd);
+
+  elf_link_io_lock (flinfo);
+  written = bfd_set_section_contents (flinfo->output_bfd, osec, contents,
+				      offset, size);
+  elf_link_io_unlock (flinfo);
+  return written;
+}
+
 /* Link an input file into the linker output file.  This function
    handles all the sections and relocations of the input file at once.
    This is so that we only have to read the local symbols once, and
    don't have to keep them in memory.  */
 
 static bool
-elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
+elf_link_input_bfd_1 (struct elf_final_link_info *flinfo, bfd *input_bfd)
 {
   int (*relocate_section)
     (bfd *, struct bfd_link_info *, bfd *, asection *, bfd_byte *,
@@ -11045,6 +12345,8 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
   bfd_vma r_type_mask;
   int r_sym_shift;
   bool have_file_sym = false;
+  bool adjust_merged;
+  bool deferred = false;
 
   output_bfd = flinfo->output_bfd;
   bed = get_elf_backend_data (output_bfd);
@@ -11070,22 +12372,35 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 
   /* Enable GNU OSABI features in the output BFD that are used in the input
      BFD.  */
-  if (bed->elf_osabi == ELFOSABI_NONE
-      || bed->elf_osabi == ELFOSABI_GNU
-      || bed->elf_osabi == ELFOSABI_FREEBSD)
+  if (!flinfo->worker
+      && (bed->elf_osabi == ELFOSABI_NONE
+	  || bed->elf_osabi == ELFOSABI_GNU
+	  || bed->elf_osabi == ELFOSABI_FREEBSD))
     elf_tdata (output_bfd)->has_gnu_osabi
       |= (elf_tdata (input_bfd)->has_gnu_osabi
 	  & (bfd_link_relocatable (flinfo->info)
 	     ? -1 : ~elf_gnu_osabi_retain));
 
-  /* Read the local symbols.  */
+  /* Read the local symbols.  Cached symbols were adjusted for
+     SEC_MERGE sections when the main thread went through them, so a
+     worker must not adjust them again.  */
   isymbuf = (Elf_Internal_Sym *) symtab_hdr->contents;
+  adjust_merged = !flinfo->worker || isymbuf == NULL;
   if (isymbuf == NULL && locsymcount != 0)
     {
+      elf_link_io_lock (flinfo);
       isymbuf = bfd_elf_get_elf_syms (input_bfd, symtab_hdr, locsymcount, 0,
 				      flinfo->internal_syms,
 				      flinfo->external_syms,
 				      flinfo->locsym_shndx);
+      /* Read the string table now too, since relocation may want
+	 symbol names.  */
+      if (isymbuf != NULL
+	  && flinfo->worker
+	  && bfd_elf_string_from_elf_section (input_bfd,
+					      symtab_hdr->sh_link, 0) == NULL)
+	isymbuf = NULL;
+      elf_link_io_unlock (flinfo);
       if (isymbuf == NULL)
 	return false;
     }
@@ -11130,7 +12445,8 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 		 reserved range other than SHN_ABS and SHN_COMMON.  */
 	      isec = bfd_und_section_ptr;
 	    }
-	  else if (isec->sec_info_type == SEC_INFO_TYPE_MERGE
+	  else if (adjust_merged
+		   && isec->sec_info_type == SEC_INFO_TYPE_MERGE
 		   && ELF_ST_TYPE (isym->st_info) != STT_SECTION)
 	    isym->st_value =
 	      _bfd_merged_section_offset (output_bfd, &isec,
@@ -11140,6 +12456,10 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 
       *ppsection = isec;
 
+      /* The main thread has already output the local symbols.  */
+      if (flinfo->worker)
+	continue;
+
       /* Don't output the first, undefined, symbol.  In fact, don't
 	 output any undefined local symbol.  */
       if (isec == bfd_und_section_ptr)
@@ -11286,6 +12606,14 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	  continue;
 	}
 
+      if (flinfo->parallel != NULL
+	  && elf_link_parallel_section_p (o) != flinfo->worker)
+	{
+	  /* This section is done on the other side of the split.  */
+	  deferred |= !flinfo->worker;
+	  continue;
+	}
+
       if (!flinfo->info->resolve_section_groups
 	  && (o->flags & (SEC_LINKER_CREATED | SEC_GROUP)) == SEC_GROUP)
 	{
@@ -11387,8 +12715,13 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	contents = NULL;
       else
 	{
+	  bool got;
+
 	  contents = flinfo->contents;
-	  if (! bfd_get_full_section_contents (input_bfd, o, &contents))
+	  elf_link_io_lock (flinfo);
+	  got = bfd_get_full_section_contents (input_bfd, o, &contents);
+	  elf_link_io_unlock (flinfo);
+	  if (!got)
 	    return false;
 	}
 
@@ -11400,11 +12733,13 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	  int ret;
 
 	  /* Get the swapped relocs.  */
+	  elf_link_io_lock (flinfo);
 	  internal_relocs
 	    = _bfd_elf_link_info_read_relocs (input_bfd, flinfo->info, o,
 					      flinfo->external_relocs,
 					      flinfo->internal_relocs,
 					      false);
+	  elf_link_io_unlock (flinfo);
 	  if (internal_relocs == NULL
 	      && o->reloc_count > 0)
 	    return false;
@@ -11585,6 +12920,14 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	  if (!ret)
 	    return false;
 
+	  /* A worker has no local symbol indices to give relocs that
+	     the backend wants emitted.  */
+	  if (ret == 2 && flinfo->worker)
+	    {
+	      bfd_set_error (bfd_error_invalid_operation);
+	      return false;
+	    }
+
 	  if (ret == 2
 	      || bfd_link_relocatable (flinfo->info)
 	      || flinfo->info->emitrelocations)
@@ -11937,10 +13280,8 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 		      }
 		    while (1);
 		  }
-		else if (! bfd_set_section_contents (output_bfd,
-						     o->output_section,
-						     contents,
-						     offset, todo))
+		else if (! elf_link_write_output (flinfo, o->output_section,
+						  contents, offset, todo))
 		  return false;
 	      }
 	  }
@@ -11948,19 +13289,172 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	}
     }
 
+  if (deferred)
+    {
+      struct elf_parallel_link *plink = flinfo->parallel;
+
+      if (plink->count == plink->alloc)
+	{
+	  size_t alloc = plink->alloc * 2 + 16;
+	  bfd **bfds;
+
+	  bfds = (bfd **) bfd_realloc (plink->bfds, alloc * sizeof (bfd *));
+	  if (bfds == NULL)
+	    return false;
+	  plink->bfds = bfds;
+	  plink->alloc = alloc;
+	}
+      plink->bfds[plink->count++] = input_bfd;
+    }
+
   return true;
 }
 
-/* Generate a reloc when linking an ELF file.  This is a reloc
-   requested by the linker, and does not come from any input file.  This
-   is used to build constructor and destructor tables when linking
-   with -Ur.  */
-
 static bool
-elf_reloc_link_order (bfd *output_bfd,
-		      struct bfd_link_info *info,
-		      asection *output_section,
-		      struct bfd_link_order *link_order)
+elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
+{
+  bfd_trace_span span;
+  bool ret;
+
+  bfd_trace_begin (&span, "elf_link_input_bfd", input_bfd);
+  ret = elf_link_input_bfd_1 (flinfo, input_bfd);
+  bfd_trace_end (&span);
+  return ret;
+}
+
+/* How many input files the final link asks the host to start reading
+   ahead of the one it is relocating.  */
+#define ELF_LINK_PREFETCH_INPUTS 4
+
+/* Ask the host to start reading the input files from NEXT on, until
+   *ISSUED, the number asked for so far, is ELF_LINK_PREFETCH_INPUTS
+   more than STARTED, the number relocated or being relocated.  The
+   output sections visit the inputs in roughly the order of the
+   input list, so staying that far ahead in the list lets the reads
+   of the next few files overlap relocating this one.  Shared
+   libraries are passed over, since nothing is copied from them.
+   Return the first input not yet asked for.  */
+
+static bfd *
+elf_link_prefetch_inputs (bfd *next, size_t *issued, size_t started)
+{
+  for (; next != NULL && *issued < started + ELF_LINK_PREFETCH_INPUTS;
+       next = next->link.next, ++*issued)
+    if (bfd_get_flavour (next) == bfd_target_elf_flavour
+	&& (next->flags & (DYNAMIC | BFD_PLUGIN)) == 0)
+      bfd_prefetch (next, 0, bfd_get_file_size (next));
+  return next;
+}
+
+/* Relocate the input BFDs in JOB from START to END, using buffers of
+   this thread's own.  Worker for _bfd_parallel_for.  */
+
+static bool
+elf_link_input_bfd_range (void *data, size_t start, size_t end)
+{
+  struct elf_parallel_link *job = (struct elf_parallel_link *) data;
+  const struct elf_backend_data *bed;
+  struct elf_final_link_info flinfo;
+  bool ret = false;
+
+  flinfo = *job->flinfo;
+  flinfo.worker = true;
+  flinfo.contents = NULL;
+  flinfo.external_relocs = NULL;
+  flinfo.internal_relocs = NULL;
+  flinfo.external_syms = NULL;
+  flinfo.locsym_shndx = NULL;
+  flinfo.internal_syms = NULL;
+  flinfo.indices = NULL;
+  flinfo.sections = NULL;
+
+  bed = get_elf_backend_data (flinfo.output_bfd);
+  if (job->max_contents_size != 0)
+    {
+      flinfo.contents = (bfd_byte *) bfd_malloc (job->max_contents_size);
+      if (flinfo.contents == NULL)
+	goto out;
+    }
+  if (job->max_external_reloc_size != 0)
+    {
+      flinfo.external_relocs = bfd_malloc (job->max_external_reloc_size);
+      if (flinfo.external_relocs == NULL)
+	goto out;
+    }
+  if (job->max_internal_reloc_count != 0)
+    {
+      flinfo.internal_relocs = (Elf_Internal_Rela *)
+	bfd_malloc (job->max_internal_reloc_count * sizeof (Elf_Internal_Rela));
+      if (flinfo.internal_relocs == NULL)
+	goto out;
+    }
+  if (job->max_sym_count != 0)
+    {
+      flinfo.external_syms = (bfd_byte *)
+	bfd_malloc (job->max_sym_count * bed->s->sizeof_sym);
+      flinfo.internal_syms = (Elf_Internal_Sym *)
+	bfd_malloc (job->max_sym_count * sizeof (Elf_Internal_Sym));
+      flinfo.indices = (long long *)
+	bfd_malloc (job->max_sym_count * sizeof (long long));
+      flinfo.sections = (asection **)
+	bfd_malloc (job->max_sym_count * sizeof (asection *));
+      if (flinfo.external_syms == NULL
+	  || flinfo.internal_syms == NULL
+	  || flinfo.indices == NULL
+	  || flinfo.sections == NULL)
+	goto out;
+    }
+  if (job->max_sym_shndx_count != 0)
+    {
+      flinfo.locsym_shndx = (Elf_External_Sym_Shndx *)
+	bfd_malloc (job->max_sym_shndx_count
+		    * sizeof (Elf_External_Sym_Shndx));
+      if (flinfo.locsym_shndx == NULL)
+	goto out;
+    }
+
+  for (; start < end; start++)
+    if (!elf_link_input_bfd (&flinfo, job->bfds[start]))
+      goto out;
+  ret = true;
+
+ out:
+  free (flinfo.contents);
+  free (flinfo.external_relocs);
+  free (flinfo.internal_relocs);
+  free (flinfo.external_syms);
+  free (flinfo.locsym_shndx);
+  free (flinfo.internal_syms);
+  free (flinfo.indices);
+  free (flinfo.sections);
+  return ret;
+}
+
+/* Return TRUE if the sections of a link can be relocated on several
+   threads.  Only the relocation of sections that are not loaded is
+   split off, and only when no relocs are copied to the output.  */
+
+static bool
+elf_link_parallel_p (bfd *abfd, struct bfd_link_info *info)
+{
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+
+  return (bfd_get_thread_count () > 1
+	  && !bfd_link_relocatable (info)
+	  && !info->emitrelocations
+	  && bed->elf_backend_write_section == NULL);
+}
+
+/* Generate a reloc when linking an ELF file.  This is a reloc
+   requested by the linker, and does not come from any input file.  This
+   is used to build constructor and destructor tables when linking
+   with -Ur.  */
+
+static bool
+elf_reloc_link_order (bfd *output_bfd,
+		      struct bfd_link_info *info,
+		      asection *output_section,
+		      struct bfd_link_order *link_order)
 {
   reloc_howto_type *howto;
   long long indx;
@@ -12251,6 +13745,11 @@ elf_final_link_free (bfd *obfd, struct elf_final_link_info *flinfo)
   free (flinfo->sections);
   if (flinfo->symshndxbuf != (Elf_External_Sym_Shndx *) -1)
     free (flinfo->symshndxbuf);
+  if (flinfo->parallel != NULL)
+    {
+      free (flinfo->parallel->bfds);
+      _bfd_mutex_destroy (&flinfo->parallel->io_lock);
+    }
   for (o = obfd->sections; o != NULL; o = o->next)
     {
       struct bfd_elf_section_data *esdo = elf_section_data (o);
@@ -12259,18 +13758,227 @@ elf_final_link_free (bfd *obfd, struct elf_final_link_info *flinfo)
     }
 }
 
-/* Do the final step of an ELF link.  */
+/* State for writing or checking the layout recorded in
+   info->incremental_state.  The file is a line for each output
+   section, then for each input file a line giving its size and
+   modification time, followed by lines for each of its sections that
+   went into the output and for each global symbol it defines.  */
+
+struct elf_incremental
+{
+  FILE *file;
+  bool writing;
+  /* When checking, whether everything but the size and time of input
+     files has matched so far, and how many input files differ.  */
+  bool same;
+  size_t changed;
+};
+
+/* Write or check one line of INC.  */
+
+static void
+elf_incremental_line (struct elf_incremental *inc, const char *kind,
+		      uint64_t a, uint64_t b, const char *name,
+		      const char *name2)
+{
+  char skind[16];
+  uint64_t sa, sb;
+  const char *p;
+  int ch;
+
+  if (name2 == NULL)
+    name2 = "";
+  if (inc->writing)
+    {
+      fprintf (inc->file, "%s %" PRIx64 " %" PRIx64 " %s %s\n",
+	       kind, a, b, name, name2);
+      return;
+    }
+
+  if (!inc->same)
+    return;
+  if (fscanf (inc->file, "%15s %" SCNx64 " %" SCNx64, skind, &sa, &sb) != 3
+      || strcmp (skind, kind) != 0
+      || fgetc (inc->file) != ' ')
+    {
+      inc->same = false;
+      return;
+    }
+
+  /* Compare NAME, a space and NAME2 with the rest of the line.  */
+  for (p = name; (ch = fgetc (inc->file)) != EOF && *p != '\0'; p++)
+    if (ch != *p)
+      break;
+  if (*p == '\0' && ch == ' ')
+    for (p = name2; (ch = fgetc (inc->file)) != EOF && *p != '\0'; p++)
+      if (ch != *p)
+	break;
+  if (*p != '\0' || ch != '\n')
+    {
+      inc->same = false;
+      return;
+    }
+
+  if (sa != a || sb != b)
+    {
+      if (strcmp (kind, "input") == 0)
+	inc->changed++;
+      else
+	inc->same = false;
+    }
+}
+
+/* Write or check the layout of the link of ABFD described by INFO.  */
+
+static void
+elf_incremental_walk (bfd *abfd, struct bfd_link_info *info,
+		      struct elf_incremental *inc)
+{
+  asection *o;
+  bfd *sub;
+
+  elf_incremental_line (inc, "bfd-incremental", 1, 0,
+			bfd_get_filename (abfd), NULL);
+  for (o = abfd->sections; o != NULL; o = o->next)
+    elf_incremental_line (inc, "output", o->vma, o->size, o->name, NULL);
+
+  for (sub = info->input_bfds; sub != NULL; sub = sub->link.next)
+    {
+      const char *archive = NULL;
+
+      if (sub->my_archive != NULL)
+	archive = bfd_get_filename (sub->my_archive);
+      elf_incremental_line (inc, "input", bfd_get_size (sub),
+			    bfd_get_mtime (sub), bfd_get_filename (sub),
+			    archive);
+
+      for (o = sub->sections; o != NULL; o = o->next)
+	if (o->output_section != NULL
+	    && !discarded_section (o)
+	    && !bfd_is_abs_section (o->output_section))
+	  elf_incremental_line (inc, "section", o->output_offset, o->size,
+				o->name, o->output_section->name);
+
+      if (bfd_get_flavour (sub) == bfd_target_elf_flavour
+	  && elf_sym_hashes (sub) != NULL)
+	{
+	  const struct elf_backend_data *bed = get_elf_backend_data (sub);
+	  Elf_Internal_Shdr *hdr = &elf_tdata (sub)->symtab_hdr;
+	  size_t count;
+	  size_t i;
+
+	  if ((sub->flags & DYNAMIC) != 0 && elf_dynsymtab (sub) != 0)
+	    hdr = &elf_tdata (sub)->dynsymtab_hdr;
+	  count = hdr->sh_size / bed->s->sizeof_sym;
+	  if (!elf_bad_symtab (sub))
+	    count -= hdr->sh_info;
+
+	  for (i = 0; i < count; i++)
+	    {
+	      struct elf_link_hash_entry *h = elf_sym_hashes (sub)[i];
+
+	      if (h == NULL)
+		continue;
+	      while (h->root.type == bfd_link_hash_indirect
+		     || h->root.type == bfd_link_hash_warning)
+		h = (struct elf_link_hash_entry *) h->root.u.i.link;
+	      if ((h->root.type == bfd_link_hash_defined
+		   || h->root.type == bfd_link_hash_defweak)
+		  && h->root.u.def.section->owner == sub
+		  && h->root.u.def.section->output_section != NULL)
+		elf_incremental_line (inc, "symbol",
+				      (h->root.u.def.value
+				       + h->root.u.def.section->output_offset
+				       + h->root.u.def.section->output_section->vma),
+				      h->size, h->root.root.string, NULL);
+	    }
+	}
+    }
+
+  elf_incremental_line (inc, "end", 0, 0, "", NULL);
+}
+
+/* Record the layout of the link of ABFD in info->incremental_state.  */
+
+static bool
+elf_link_write_incremental_state (bfd *abfd, struct bfd_link_info *info)
+{
+  struct elf_incremental inc;
+  bool ret = true;
+
+  inc.file = _bfd_real_fopen (info->incremental_state, FOPEN_WT);
+  if (inc.file == NULL)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return false;
+    }
+  inc.writing = true;
+  inc.same = true;
+  inc.changed = 0;
+  elf_incremental_walk (abfd, info, &inc);
+  if (ferror (inc.file))
+    {
+      bfd_set_error (bfd_error_system_call);
+      ret = false;
+    }
+  if (fclose (inc.file) != 0 && ret)
+    {
+      bfd_set_error (bfd_error_system_call);
+      ret = false;
+    }
+  return ret;
+}
+
+/* Compare the link of ABFD described by INFO, once sections have been
+   placed, with the layout recorded in info->incremental_state by the
+   previous link.  Return TRUE if the only difference is that *CHANGED
+   input files are not the same size or age as before, while every
+   section is the same size and at the same place in the output and
+   every global symbol has the same address.  The new output then
+   differs from the previous one only in the contents of sections
+   from the changed files.  Return FALSE if anything else differs, or
+   there is no recorded layout.  */
 
 bool
-bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
+bfd_elf_incremental_compare (bfd *abfd, struct bfd_link_info *info,
+			     size_t *changed)
+{
+  struct elf_incremental inc;
+  bool ret;
+
+  *changed = 0;
+  if (info->incremental_state == NULL)
+    return false;
+  inc.file = _bfd_real_fopen (info->incremental_state, FOPEN_RT);
+  if (inc.file == NULL)
+    return false;
+
+  inc.writing = false;
+  inc.same = true;
+  inc.changed = 0;
+  elf_incremental_walk (abfd, info, &inc);
+  ret = inc.same && fgetc (inc.file) == EOF;
+  if (ret)
+    *changed = inc.changed;
+  fclose (inc.file);
+  return ret;
+}
+
+/* Do the final step of an ELF link.  */
+
+static bool
+bfd_elf_final_link_1 (bfd *abfd, struct bfd_link_info *info)
 {
   bool dynamic;
   bool emit_relocs;
   bfd *dynobj;
   struct elf_final_link_info flinfo;
+  struct elf_parallel_link plink;
   asection *o;
   struct bfd_link_order *p;
   bfd *sub;
+  bfd *prefetch;
+  size_t prefetched = 0, started = 0;
   bfd_size_type max_contents_size;
   bfd_size_type max_external_reloc_size;
   bfd_size_type max_internal_reloc_count;
@@ -12728,6 +14436,21 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	goto error_return;
     }
 
+  /* If allowed, the main thread leaves sections that aren't loaded
+     to worker threads, which relocate them once it has been through
+     all the input files.  */
+  if (elf_link_parallel_p (abfd, info))
+    {
+      memset (&plink, 0, sizeof (plink));
+      plink.flinfo = &flinfo;
+      plink.max_contents_size = max_contents_size;
+      plink.max_external_reloc_size = max_external_reloc_size;
+      plink.max_internal_reloc_count = max_internal_reloc_count;
+      plink.max_sym_count = max_sym_count;
+      plink.max_sym_shndx_count = max_sym_shndx_count;
+      flinfo.parallel = &plink;
+    }
+
   if (htab->tls_sec)
     {
       bfd_vma base, end = 0;  /* Both bytes.  */
@@ -12791,6 +14514,7 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 
   for (sub = info->input_bfds; sub != NULL; sub = sub->link.next)
     sub->output_has_begun = false;
+  prefetch = info->input_bfds;
   for (o = abfd->sections; o != NULL; o = o->next)
     {
       for (p = o->map_head.link_order; p != NULL; p = p->next)
@@ -12802,6 +14526,9 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	    {
 	      if (! sub->output_has_begun)
 		{
+		  prefetch = elf_link_prefetch_inputs (prefetch,
+						       &prefetched,
+						       ++started);
 		  if (! elf_link_input_bfd (&flinfo, sub))
 		    goto error_return;
 		  sub->output_has_begun = true;
@@ -12854,6 +14581,24 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	}
     }
 
+  if (flinfo.parallel != NULL && plink.count != 0)
+    {
+      file_ptr end = 0;
+
+      /* The layout is fixed by now.  Size the output file up front
+	 so that the workers' writes don't each extend it.  */
+      for (o = abfd->sections; o != NULL; o = o->next)
+	if ((o->flags & SEC_HAS_CONTENTS) != 0
+	    && elf_section_data (o)->this_hdr.sh_type != SHT_NOBITS
+	    && elf_section_data (o)->this_hdr.sh_offset != (file_ptr) -1
+	    && o->filepos + (file_ptr) o->size > end)
+	  end = o->filepos + o->size;
+      if (!bfd_preallocate (abfd, end)
+	  || !_bfd_parallel_for (plink.count, 1, elf_link_input_bfd_range,
+				 &plink))
+	goto error_return;
+    }
+
   /* Free symbol buffer if needed.  */
   if (!info->reduce_memory_overheads)
     {
@@ -13482,6 +15227,10 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
   if (info->callbacks->emit_ctf)
       info->callbacks->emit_ctf ();
 
+  if (info->incremental_state != NULL
+      && !elf_link_write_incremental_state (abfd, info))
+    goto error_return;
+
   elf_final_link_free (abfd, &flinfo);
 
   if (attr_section)
@@ -13508,12 +15257,24 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
   ret = false;
   goto return_local_hash_table;
 }
+
+bool
+bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
+{
+  bfd_trace_span span;
+  bool ret;
+
+  bfd_trace_begin (&span, "bfd_elf_final_link", abfd);
+  ret = bfd_elf_final_link_1 (abfd, info);
+  bfd_trace_end (&span);
+  return ret;
+}
 
-/* Initialize COOKIE for input bfd ABFD.  */
+/* Fill in COOKIE for input bfd ABFD, taking its local symbols from
+   the symbol table header if they have been read already.  */
 
-static bool
-init_reloc_cookie (struct elf_reloc_cookie *cookie,
-		   struct bfd_link_info *info, bfd *abfd)
+static void
+setup_reloc_cookie (struct elf_reloc_cookie *cookie, bfd *abfd)
 {
   Elf_Internal_Shdr *symtab_hdr;
   const struct elf_backend_data *bed;
@@ -13541,8 +15302,20 @@ init_reloc_cookie (struct elf_reloc_cookie *cookie,
     cookie->r_sym_shift = 32;
 
   cookie->locsyms = (Elf_Internal_Sym *) symtab_hdr->contents;
+}
+
+/* Initialize COOKIE for input bfd ABFD.  */
+
+static bool
+init_reloc_cookie (struct elf_reloc_cookie *cookie,
+		   struct bfd_link_info *info, bfd *abfd)
+{
+  Elf_Internal_Shdr *symtab_hdr;
+
+  setup_reloc_cookie (cookie, abfd);
   if (cookie->locsyms == NULL && cookie->locsymcount != 0)
     {
+      symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
       cookie->locsyms = bfd_elf_get_elf_syms (abfd, symtab_hdr,
 					      cookie->locsymcount, 0,
 					      NULL, NULL, NULL);
@@ -13758,7 +15531,7 @@ _bfd_elf_gc_mark_rsec (struct bfd_link_info *info, asection *sec,
 	     symbols.  */
 	  else if (start_stop != NULL)
 	    {
-	      asection *s = h->u2.start_stop_section;
+	      asection *s = h->cold->u2.start_stop_section;
 	      *start_stop = true;
 	      return s;
 	    }
@@ -13802,20 +15575,145 @@ _bfd_elf_gc_mark_reloc (struct bfd_link_info *info,
   return true;
 }
 
-/* The mark phase of garbage collection.  For a given section, mark
-   it and any sections in this section's group, and all the sections
-   which define symbols to which it refers.  */
+/* The number of input files whose local symbols and .eh_frame relocs
+   the mark phase keeps to hand.  */
+#define GC_CACHE_SIZE 16
 
-bool
-_bfd_elf_gc_mark (struct bfd_link_info *info,
-		  asection *sec,
-		  elf_gc_mark_hook_fn gc_mark_hook)
+/* Marked sections whose relocs have yet to be looked at, and what was
+   read to look at recent ones.  Reading an input file's symbols again
+   for each of its sections is costly with -ffunction-sections when
+   the linker isn't keeping memory.  */
+
+struct elf_gc_work
+{
+  asection **stack;
+  size_t count;
+  size_t alloc;
+  struct
+  {
+    bfd *abfd;
+    Elf_Internal_Sym *locsyms;
+    Elf_Internal_Rela *eh_rels;
+    asection *eh_frame;
+  } cache[GC_CACHE_SIZE];
+  unsigned int next_victim;
+};
+
+static bool
+elf_gc_push (struct elf_gc_work *work, asection *sec)
+{
+  if (work->count == work->alloc)
+    {
+      size_t alloc = work->alloc * 2 + 64;
+      asection **stack;
+
+      stack = (asection **) bfd_realloc (work->stack,
+					 alloc * sizeof (*stack));
+      if (stack == NULL)
+	return false;
+      work->stack = stack;
+      work->alloc = alloc;
+    }
+  work->stack[work->count++] = sec;
+  return true;
+}
+
+/* Free what entry I of WORK's cache holds, unless it belongs to the
+   BFD.  */
+
+static void
+elf_gc_cache_evict (struct elf_gc_work *work, unsigned int i)
+{
+  bfd *abfd = work->cache[i].abfd;
+
+  if (abfd == NULL)
+    return;
+  if (elf_tdata (abfd)->symtab_hdr.contents
+      != (unsigned char *) work->cache[i].locsyms)
+    free (work->cache[i].locsyms);
+  if (work->cache[i].eh_frame != NULL
+      && elf_section_data (work->cache[i].eh_frame)->relocs
+	 != work->cache[i].eh_rels)
+    free (work->cache[i].eh_rels);
+  work->cache[i].abfd = NULL;
+}
+
+/* Set up COOKIE for the relocs of SEC, reusing the local symbols of
+   SEC's file, and its .eh_frame relocs if SEC is .eh_frame, if WORK
+   has them.  Release with elf_gc_fini_cookie.  */
+
+static bool
+elf_gc_init_cookie (struct elf_gc_work *work, struct elf_reloc_cookie *cookie,
+		    struct bfd_link_info *info, asection *sec)
+{
+  bfd *abfd = sec->owner;
+  bool is_eh = sec == elf_eh_frame_section (abfd);
+  unsigned int i;
+
+  for (i = 0; i < GC_CACHE_SIZE; i++)
+    if (work->cache[i].abfd == abfd)
+      break;
+
+  if (i == GC_CACHE_SIZE)
+    {
+      i = work->next_victim;
+      work->next_victim = (i + 1) % GC_CACHE_SIZE;
+      elf_gc_cache_evict (work, i);
+      if (!init_reloc_cookie (cookie, info, abfd))
+	return false;
+      work->cache[i].abfd = abfd;
+      work->cache[i].locsyms = cookie->locsyms;
+      work->cache[i].eh_rels = NULL;
+      work->cache[i].eh_frame = NULL;
+    }
+  else
+    {
+      Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+      unsigned char *contents = symtab_hdr->contents;
+
+      /* Have init_reloc_cookie take the symbols we already have.  */
+      symtab_hdr->contents = (unsigned char *) work->cache[i].locsyms;
+      init_reloc_cookie (cookie, info, abfd);
+      symtab_hdr->contents = contents;
+    }
+
+  if (is_eh && work->cache[i].eh_frame == sec)
+    {
+      cookie->rels = work->cache[i].eh_rels;
+      cookie->rel = cookie->rels;
+      cookie->relend = cookie->rels + sec->reloc_count;
+      return true;
+    }
+  if (!init_reloc_cookie_rels (cookie, info, abfd, sec))
+    return false;
+  if (is_eh)
+    {
+      work->cache[i].eh_frame = sec;
+      work->cache[i].eh_rels = cookie->rels;
+    }
+  return true;
+}
+
+/* Release COOKIE, set up for SEC by elf_gc_init_cookie.  */
+
+static void
+elf_gc_fini_cookie (struct elf_reloc_cookie *cookie, asection *sec)
+{
+  if (sec != elf_eh_frame_section (sec->owner))
+    fini_reloc_cookie_rels (cookie, sec);
+}
+
+/* Look through the relocs of SEC, which has been marked, and mark the
+   sections they refer to, along with the other sections in SEC's
+   group and its .eh_frame entries.  */
+
+static bool
+elf_gc_mark_from (struct bfd_link_info *info, struct elf_gc_work *work,
+		  asection *sec, elf_gc_mark_hook_fn gc_mark_hook)
 {
   bool ret;
   asection *group_sec, *eh_frame;
 
-  sec->gc_mark = 1;
-
   /* Mark all the sections in the group.  */
   group_sec = elf_section_data (sec)->next_in_group;
   if (group_sec && !group_sec->gc_mark)
@@ -13831,7 +15729,7 @@ _bfd_elf_gc_mark (struct bfd_link_info *info,
     {
       struct elf_reloc_cookie cookie;
 
-      if (!init_reloc_cookie_for_section (&cookie, info, sec))
+      if (!elf_gc_init_cookie (work, &cookie, info, sec))
 	ret = false;
       else
 	{
@@ -13841,7 +15739,7 @@ _bfd_elf_gc_mark (struct bfd_link_info *info,
 		ret = false;
 		break;
 	      }
-	  fini_reloc_cookie_for_section (&cookie, sec);
+	  elf_gc_fini_cookie (&cookie, sec);
 	}
     }
 
@@ -13849,14 +15747,14 @@ _bfd_elf_gc_mark (struct bfd_link_info *info,
     {
       struct elf_reloc_cookie cookie;
 
-      if (!init_reloc_cookie_for_section (&cookie, info, eh_frame))
+      if (!elf_gc_init_cookie (work, &cookie, info, eh_frame))
 	ret = false;
       else
 	{
 	  if (!_bfd_elf_gc_mark_fdes (info, sec, eh_frame,
 				      gc_mark_hook, &cookie))
 	    ret = false;
-	  fini_reloc_cookie_for_section (&cookie, eh_frame);
+	  elf_gc_fini_cookie (&cookie, eh_frame);
 	}
     }
 
@@ -13868,6 +15766,49 @@ _bfd_elf_gc_mark (struct bfd_link_info *info,
   return ret;
 }
 
+/* The mark phase of garbage collection.  For a given section, mark
+   it and any sections in this section's group, and all the sections
+   which define symbols to which it refers.  Rather than recursing,
+   sections are marked as they are found and put on a work list, so
+   that callers reached from a mark in progress only add to it.  */
+
+bool
+_bfd_elf_gc_mark (struct bfd_link_info *info,
+		  asection *sec,
+		  elf_gc_mark_hook_fn gc_mark_hook)
+{
+  struct elf_link_hash_table *htab = NULL;
+  struct elf_gc_work work;
+  unsigned int i;
+  bool ret;
+
+  sec->gc_mark = 1;
+
+  if (is_elf_hash_table (info->hash))
+    {
+      htab = elf_hash_table (info);
+      if (htab->gc_work != NULL)
+	return elf_gc_push (htab->gc_work, sec);
+    }
+
+  memset (&work, 0, sizeof (work));
+  if (htab != NULL)
+    htab->gc_work = &work;
+  ret = true;
+  while (ret && sec != NULL)
+    {
+      ret = elf_gc_mark_from (info, &work, sec, gc_mark_hook);
+      sec = work.count != 0 ? work.stack[--work.count] : NULL;
+    }
+  if (htab != NULL)
+    htab->gc_work = NULL;
+
+  for (i = 0; i < GC_CACHE_SIZE; i++)
+    elf_gc_cache_evict (&work, i);
+  free (work.stack);
+  return ret;
+}
+
 /* Scan and mark sections in a special or debug section group.  */
 
 static void
@@ -14106,27 +16047,27 @@ elf_gc_propagate_vtable_entries_used (struct elf_link_hash_entry *h, void *okp)
 {
   /* Those that are not vtables.  */
   if (h->start_stop
-      || h->u2.vtable == NULL
-      || h->u2.vtable->parent == NULL)
+      || h->cold->u2.vtable == NULL
+      || h->cold->u2.vtable->parent == NULL)
     return true;
 
   /* Those vtables that do not have parents, we cannot merge.  */
-  if (h->u2.vtable->parent == (struct elf_link_hash_entry *) -1)
+  if (h->cold->u2.vtable->parent == (struct elf_link_hash_entry *) -1)
     return true;
 
   /* If we've already been done, exit.  */
-  if (h->u2.vtable->used && h->u2.vtable->used[-1])
+  if (h->cold->u2.vtable->used && h->cold->u2.vtable->used[-1])
     return true;
 
   /* Make sure the parent's table is up to date.  */
-  elf_gc_propagate_vtable_entries_used (h->u2.vtable->parent, okp);
+  elf_gc_propagate_vtable_entries_used (h->cold->u2.vtable->parent, okp);
 
-  if (h->u2.vtable->used == NULL)
+  if (h->cold->u2.vtable->used == NULL)
     {
       /* None of this table's entries were referenced.  Re-use the
 	 parent's table.  */
-      h->u2.vtable->used = h->u2.vtable->parent->u2.vtable->used;
-      h->u2.vtable->size = h->u2.vtable->parent->u2.vtable->size;
+      h->cold->u2.vtable->used = h->cold->u2.vtable->parent->cold->u2.vtable->used;
+      h->cold->u2.vtable->size = h->cold->u2.vtable->parent->cold->u2.vtable->size;
     }
   else
     {
@@ -14134,9 +16075,9 @@ elf_gc_propagate_vtable_entries_used (struct elf_link_hash_entry *h, void *okp)
       bool *cu, *pu;
 
       /* Or the parent's entries into ours.  */
-      cu = h->u2.vtable->used;
+      cu = h->cold->u2.vtable->used;
       cu[-1] = true;
-      pu = h->u2.vtable->parent->u2.vtable->used;
+      pu = h->cold->u2.vtable->parent->cold->u2.vtable->used;
       if (pu != NULL)
 	{
 	  const struct elf_backend_data *bed;
@@ -14144,7 +16085,7 @@ elf_gc_propagate_vtable_entries_used (struct elf_link_hash_entry *h, void *okp)
 
 	  bed = get_elf_backend_data (h->root.u.def.section->owner);
 	  log_file_align = bed->s->log_file_align;
-	  n = h->u2.vtable->parent->u2.vtable->size >> log_file_align;
+	  n = h->cold->u2.vtable->parent->cold->u2.vtable->size >> log_file_align;
 	  while (n--)
 	    {
 	      if (*pu)
@@ -14178,8 +16119,8 @@ elf_gc_smash_unused_vtentry_relocs (struct elf_link_hash_entry *h,
   /* Take care of both those symbols that do not describe vtables as
      well as those that are not loaded.  */
   if (h->start_stop
-      || h->u2.vtable == NULL
-      || h->u2.vtable->parent == NULL)
+      || h->cold->u2.vtable == NULL
+      || h->cold->u2.vtable->parent == NULL)
     return true;
 
   BFD_ASSERT (h->root.type == bfd_link_hash_defined
@@ -14202,11 +16143,11 @@ elf_gc_smash_unused_vtentry_relocs (struct elf_link_hash_entry *h,
     if (rel->r_offset >= hstart && rel->r_offset < hend)
       {
 	/* If the entry is in use, do nothing.  */
-	if (h->u2.vtable->used
-	    && (rel->r_offset - hstart) < h->u2.vtable->size)
+	if (h->cold->u2.vtable->used
+	    && (rel->r_offset - hstart) < h->cold->u2.vtable->size)
 	  {
 	    bfd_vma entry = (rel->r_offset - hstart) >> log_file_align;
-	    if (h->u2.vtable->used[entry])
+	    if (h->cold->u2.vtable->used[entry])
 	      continue;
 	  }
 	/* Otherwise, kill it.  */
@@ -14307,8 +16248,8 @@ bfd_elf_parse_eh_frame_entries (bfd *abfd ATTRIBUTE_UNUSED,
 
 /* Do mark and sweep of unused sections.  */
 
-bool
-bfd_elf_gc_sections (bfd *abfd, struct bfd_link_info *info)
+static bool
+bfd_elf_gc_sections_1 (bfd *abfd, struct bfd_link_info *info)
 {
   bool ok = true;
   bfd *sub;
@@ -14414,6 +16355,18 @@ bfd_elf_gc_sections (bfd *abfd, struct bfd_link_info *info)
   /* ... and mark SEC_EXCLUDE for those that go.  */
   return elf_gc_sweep (abfd, info);
 }
+
+bool
+bfd_elf_gc_sections (bfd *abfd, struct bfd_link_info *info)
+{
+  bfd_trace_span span;
+  bool ret;
+
+  bfd_trace_begin (&span, "bfd_elf_gc_sections", abfd);
+  ret = bfd_elf_gc_sections_1 (abfd, info);
+  bfd_trace_end (&span);
+  return ret;
+}
 
 /* Called from check_relocs to record the existence of a VTINHERIT reloc.  */
 
@@ -14457,11 +16410,15 @@ bfd_elf_gc_record_vtinherit (bfd *abfd,
   return false;
 
  win:
-  if (!child->u2.vtable)
+  if (!child->cold->u2.vtable)
     {
-      child->u2.vtable = ((struct elf_link_virtual_table_entry *)
-			  bfd_zalloc (abfd, sizeof (*child->u2.vtable)));
-      if (!child->u2.vtable)
+      struct elf_link_hash_cold *cold = elf_link_hash_cold (abfd, child);
+
+      if (!cold)
+	return false;
+      cold->u2.vtable = ((struct elf_link_virtual_table_entry *)
+			 bfd_zalloc (abfd, sizeof (*cold->u2.vtable)));
+      if (!cold->u2.vtable)
 	return false;
     }
   if (!h)
@@ -14471,10 +16428,10 @@ bfd_elf_gc_record_vtinherit (bfd *abfd,
 	 would be bad.  It isn't worth paging in the local symbols to be
 	 sure though; that case should simply be handled by the assembler.  */
 
-      child->u2.vtable->parent = (struct elf_link_hash_entry *) -1;
+      child->cold->u2.vtable->parent = (struct elf_link_hash_entry *) -1;
     }
   else
-    child->u2.vtable->parent = h;
+    child->cold->u2.vtable->parent = h;
 
   return true;
 }
@@ -14498,18 +16455,22 @@ bfd_elf_gc_record_vtentry (bfd *abfd, asection *sec,
       return false;
     }
 
-  if (!h->u2.vtable)
+  if (!h->cold->u2.vtable)
     {
-      h->u2.vtable = ((struct elf_link_virtual_table_entry *)
-		      bfd_zalloc (abfd, sizeof (*h->u2.vtable)));
-      if (!h->u2.vtable)
+      struct elf_link_hash_cold *cold = elf_link_hash_cold (abfd, h);
+
+      if (!cold)
+	return false;
+      cold->u2.vtable = ((struct elf_link_virtual_table_entry *)
+			 bfd_zalloc (abfd, sizeof (*cold->u2.vtable)));
+      if (!cold->u2.vtable)
 	return false;
     }
 
-  if (addend >= h->u2.vtable->size)
+  if (addend >= h->cold->u2.vtable->size)
     {
       size_t size, bytes, file_align;
-      bool *ptr = h->u2.vtable->used;
+      bool *ptr = h->cold->u2.vtable->used;
 
       /* While the symbol is undefined, we have to be prepared to handle
 	 a zero size.  */
@@ -14540,7 +16501,7 @@ bfd_elf_gc_record_vtentry (bfd *abfd, asection *sec,
 	    {
 	      size_t oldbytes;
 
-	      oldbytes = (((h->u2.vtable->size >> log_file_align) + 1)
+	      oldbytes = (((h->cold->u2.vtable->size >> log_file_align) + 1)
 			  * sizeof (bool));
 	      memset (((char *) ptr) + oldbytes, 0, bytes - oldbytes);
 	    }
@@ -14552,11 +16513,11 @@ bfd_elf_gc_record_vtentry (bfd *abfd, asection *sec,
 	return false;
 
       /* And arrange for that done flag to be at index -1.  */
-      h->u2.vtable->used = ptr + 1;
-      h->u2.vtable->size = size;
+      h->cold->u2.vtable->used = ptr + 1;
+      h->cold->u2.vtable->size = size;
     }
 
-  h->u2.vtable->used[addend >> log_file_align] = true;
+  h->cold->u2.vtable->used[addend >> log_file_align] = true;
 
   return true;
 }
@@ -14758,65 +16719,463 @@ bfd_elf_gc_common_final_link (bfd *abfd, struct bfd_link_info *info)
   return bfd_elf_final_link (abfd, info);
 }
 
-bool
-bfd_elf_reloc_symbol_deleted_p (bfd_vma offset, void *cookie)
-{
-  struct elf_reloc_cookie *rcookie = (struct elf_reloc_cookie *) cookie;
+/* Return the first reloc in RCOOKIE at OFFSET, leaving RCOOKIE->rel
+   there, or NULL if there is none.  Unless the symbol table is bad,
+   relocs are taken to be sorted by offset, so the search starts from
+   the reloc found last time.  */
 
+static const Elf_Internal_Rela *
+elf_reloc_cookie_find (struct elf_reloc_cookie *rcookie, bfd_vma offset)
+{
   if (rcookie->bad_symtab)
     rcookie->rel = rcookie->rels;
 
   for (; rcookie->rel < rcookie->relend; rcookie->rel++)
     {
-      unsigned long long r_symndx;
-
       if (! rcookie->bad_symtab)
 	if (rcookie->rel->r_offset > offset)
-	  return false;
-      if (rcookie->rel->r_offset != offset)
-	continue;
+	  return NULL;
+      if (rcookie->rel->r_offset == offset)
+	return rcookie->rel;
+    }
+  return NULL;
+}
+
+/* Return TRUE if REL, one of RCOOKIE's relocs, is against a symbol
+   that is not defined in a section kept from RCOOKIE's input file.  */
+
+static bool
+elf_reloc_symbol_deleted_p (struct elf_reloc_cookie *rcookie,
+			    const Elf_Internal_Rela *rel)
+{
+  unsigned long long r_symndx;
+
+  r_symndx = rel->r_info >> rcookie->r_sym_shift;
+  if (r_symndx == STN_UNDEF)
+    return true;
+
+  if (r_symndx >= rcookie->locsymcount
+      || ELF_ST_BIND (rcookie->locsyms[r_symndx].st_info) != STB_LOCAL)
+    {
+      struct elf_link_hash_entry *h;
+
+      h = rcookie->sym_hashes[r_symndx - rcookie->extsymoff];
+
+      while (h->root.type == bfd_link_hash_indirect
+	     || h->root.type == bfd_link_hash_warning)
+	h = (struct elf_link_hash_entry *) h->root.u.i.link;
 
-      r_symndx = rcookie->rel->r_info >> rcookie->r_sym_shift;
-      if (r_symndx == STN_UNDEF)
+      if ((h->root.type == bfd_link_hash_defined
+	   || h->root.type == bfd_link_hash_defweak)
+	  && (h->root.u.def.section->owner != rcookie->abfd
+	      || h->root.u.def.section->kept_section != NULL
+	      || discarded_section (h->root.u.def.section)))
 	return true;
+    }
+  else
+    {
+      /* It's not a relocation against a global symbol,
+	 but it could be a relocation against a local
+	 symbol for a discarded section.  */
+      asection *isec;
+      Elf_Internal_Sym *isym;
 
-      if (r_symndx >= rcookie->locsymcount
-	  || ELF_ST_BIND (rcookie->locsyms[r_symndx].st_info) != STB_LOCAL)
-	{
-	  struct elf_link_hash_entry *h;
+      /* Need to: get the symbol; get the section.  */
+      isym = &rcookie->locsyms[r_symndx];
+      isec = bfd_section_from_elf_index (rcookie->abfd, isym->st_shndx);
+      if (isec != NULL
+	  && (isec->kept_section != NULL
+	      || discarded_section (isec)))
+	return true;
+    }
+  return false;
+}
 
-	  h = rcookie->sym_hashes[r_symndx - rcookie->extsymoff];
+bool
+bfd_elf_reloc_symbol_deleted_p (bfd_vma offset, void *cookie)
+{
+  struct elf_reloc_cookie *rcookie = (struct elf_reloc_cookie *) cookie;
+  const Elf_Internal_Rela *rel;
 
-	  while (h->root.type == bfd_link_hash_indirect
-		 || h->root.type == bfd_link_hash_warning)
-	    h = (struct elf_link_hash_entry *) h->root.u.i.link;
+  rel = elf_reloc_cookie_find (rcookie, offset);
+  return rel != NULL && elf_reloc_symbol_deleted_p (rcookie, rel);
+}
 
-	  if ((h->root.type == bfd_link_hash_defined
-	       || h->root.type == bfd_link_hash_defweak)
-	      && (h->root.u.def.section->owner != rcookie->abfd
-		  || h->root.u.def.section->kept_section != NULL
-		  || discarded_section (h->root.u.def.section)))
-	    return true;
+/* An input section whose references bfd_elf_discard_info checks.  */
+
+struct elf_discard_section
+{
+  asection *sec;
+  /* The input file SEC belongs to.  */
+  struct elf_discard_input *input;
+  /* SEC's relocs and, for each of them, whether it is against a
+     deleted symbol.  */
+  Elf_Internal_Rela *rels;
+  unsigned char *deleted;
+};
+
+/* An input file with sections in an elf_discard_job.  */
+
+struct elf_discard_input
+{
+  /* The file's local symbols and its other reloc cookie fields.  */
+  struct elf_reloc_cookie cookie;
+  /* Its sections, in the job's ORDER array.  */
+  size_t first, count;
+  /* Bytes of relocs read and kept in memory for the link.  */
+  bfd_size_type kept_size;
+  /* Whether the local symbols were read here rather than found in
+     the symbol table header.  */
+  bool read_syms;
+  /* Whether everything was read.  If not, the file's sections are
+     done as though they were not in the job.  */
+  bool ok;
+};
+
+/* The sections that bfd_elf_discard_info goes through, with their
+   relocs read and checked ahead of time by several threads.  */
+
+struct elf_discard_job
+{
+  struct bfd_link_info *info;
+  /* The sections of the .stab, .eh_frame and .sframe output sections
+     that are to be done, in the order they are done in.  */
+  struct elf_discard_section *secs;
+  size_t count;
+  /* The next of SECS to be done.  */
+  size_t next;
+  /* SECS again, grouped by input file.  */
+  struct elf_discard_section **order;
+  struct elf_discard_input *inputs;
+  size_t ninputs;
+  /* Whether relocs read are to be kept in memory for the link.  */
+  bool keep_memory;
+  /* Held while reading an archive member, since members share their
+     archive's file position.  */
+  bfd_mutex io_lock;
+};
+
+/* A reloc cookie for a section of an elf_discard_job.  */
+
+struct elf_discard_cookie
+{
+  struct elf_reloc_cookie cookie;
+  /* The section's entry in the job, or NULL if its relocs and symbols
+     were read just for this cookie.  */
+  struct elf_discard_section *ds;
+};
+
+/* Order elf_discard_sections by input file, and by their place in
+   the job within a file.  */
+
+static int
+elf_discard_section_compare (const void *a, const void *b)
+{
+  const struct elf_discard_section *sa
+    = *(const struct elf_discard_section *const *) a;
+  const struct elf_discard_section *sb
+    = *(const struct elf_discard_section *const *) b;
+
+  if (sa->sec->owner->id != sb->sec->owner->id)
+    return sa->sec->owner->id < sb->sec->owner->id ? -1 : 1;
+  if (sa != sb)
+    return sa < sb ? -1 : 1;
+  return 0;
+}
+
+/* Add the sections of output section O that bfd_elf_discard_info
+   will go through to JOB.  If STABS, only those with stabs that have
+   relocs are wanted.  */
+
+static void
+elf_discard_add_sections (struct elf_discard_job *job, asection *o,
+			  bool stabs)
+{
+  asection *i;
+
+  if (o == NULL)
+    return;
+
+  for (i = o->map_head.s; i != NULL; i = i->map_head.s)
+    if (i->size != 0
+	&& (!stabs
+	    || (i->reloc_count != 0
+		&& i->sec_info_type == SEC_INFO_TYPE_STABS))
+	&& bfd_get_flavour (i->owner) == bfd_target_elf_flavour)
+      {
+	if (job->secs != NULL)
+	  {
+	    job->secs[job->count].sec = i;
+	    job->secs[job->count].rels = NULL;
+	    job->secs[job->count].deleted = NULL;
+	  }
+	job->count++;
+      }
+}
+
+/* Read the local symbols of the input file IN and the relocs of its
+   sections, and note which relocs are against deleted symbols.  */
+
+static bool
+elf_discard_prepare_input (struct elf_discard_job *job,
+			   struct elf_discard_input *in)
+{
+  bfd *abfd = job->order[in->first]->sec->owner;
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  bool lock = abfd->my_archive != NULL;
+  size_t i;
+
+  setup_reloc_cookie (&in->cookie, abfd);
+  if (lock)
+    _bfd_mutex_lock (&job->io_lock);
+  if (in->cookie.locsyms == NULL && in->cookie.locsymcount != 0)
+    {
+      in->cookie.locsyms = bfd_elf_get_elf_syms (abfd, symtab_hdr,
+						 in->cookie.locsymcount, 0,
+						 NULL, NULL, NULL);
+      if (in->cookie.locsyms == NULL)
+	goto out;
+      in->read_syms = true;
+    }
+
+  for (i = 0; i < in->count; i++)
+    {
+      struct elf_discard_section *ds = job->order[in->first + i];
+      asection *sec = ds->sec;
+      bool cached = elf_section_data (sec)->relocs != NULL;
+      size_t j;
+
+      if (sec->reloc_count == 0)
+	continue;
+
+      ds->rels = _bfd_elf_link_info_read_relocs (abfd, NULL, sec, NULL, NULL,
+						 job->keep_memory);
+      if (ds->rels == NULL)
+	goto out;
+      if (!cached && elf_section_data (sec)->relocs == ds->rels)
+	in->kept_size += sec->reloc_count * sizeof (Elf_Internal_Rela);
+
+      ds->deleted = (unsigned char *) bfd_malloc (sec->reloc_count);
+      if (ds->deleted == NULL)
+	goto out;
+      for (j = 0; j < sec->reloc_count; j++)
+	ds->deleted[j] = elf_reloc_symbol_deleted_p (&in->cookie,
+						     &ds->rels[j]);
+    }
+  in->ok = true;
+
+ out:
+  if (lock)
+    _bfd_mutex_unlock (&job->io_lock);
+  return in->ok;
+}
+
+/* Prepare the input files in JOB from START to END.  A file that
+   can't be read is left for bfd_elf_discard_info to read again, so
+   that any errors are reported there.  Each file is only looked at
+   by one thread, so its sections' relocs may be kept on its objalloc.
+   Worker for _bfd_parallel_for.  */
+
+static bool
+elf_discard_prepare_range (void *data, size_t start, size_t end)
+{
+  struct elf_discard_job *job = (struct elf_discard_job *) data;
+
+  for (; start < end; start++)
+    {
+      struct elf_discard_input *in = &job->inputs[start];
+
+      if (!elf_discard_prepare_input (job, in))
+	{
+	  size_t i;
+
+	  for (i = 0; i < in->count; i++)
+	    {
+	      struct elf_discard_section *ds = job->order[in->first + i];
+
+	      if (elf_section_data (ds->sec)->relocs != ds->rels)
+		free (ds->rels);
+	      free (ds->deleted);
+	      ds->rels = NULL;
+	      ds->deleted = NULL;
+	    }
+	  if (in->read_syms)
+	    free (in->cookie.locsyms);
+	  in->read_syms = false;
 	}
-      else
+    }
+  return true;
+}
+
+/* Fill in JOB for the link INFO that writes OUTPUT_BFD, reading and
+   checking the relocs of the sections it will go through on as many
+   threads as bfd_set_thread_count allows.  Does nothing if there is
+   only the one thread, or if memory runs out; the sections are then
+   done as they come.  */
+
+static void
+elf_discard_prepare (struct elf_discard_job *job, bfd *output_bfd,
+		     struct bfd_link_info *info)
+{
+  asection *stab, *eh_frame, *sframe;
+  size_t i;
+
+  memset (job, 0, sizeof (*job));
+  job->info = info;
+  if (bfd_get_thread_count () <= 1)
+    return;
+
+  stab = bfd_get_section_by_name (output_bfd, ".stab");
+  eh_frame = NULL;
+  if (info->eh_frame_hdr_type != COMPACT_EH_HDR)
+    eh_frame = bfd_get_section_by_name (output_bfd, ".eh_frame");
+  sframe = bfd_get_section_by_name (output_bfd, ".sframe");
+
+  elf_discard_add_sections (job, stab, true);
+  elf_discard_add_sections (job, eh_frame, false);
+  elf_discard_add_sections (job, sframe, false);
+  if (job->count == 0)
+    return;
+
+  job->secs = ((struct elf_discard_section *)
+	       bfd_malloc (job->count * sizeof (*job->secs)));
+  job->order = ((struct elf_discard_section **)
+		bfd_malloc (job->count * sizeof (*job->order)));
+  job->inputs = ((struct elf_discard_input *)
+		 bfd_zmalloc (job->count * sizeof (*job->inputs)));
+  if (job->secs == NULL || job->order == NULL || job->inputs == NULL)
+    goto fail;
+
+  job->count = 0;
+  elf_discard_add_sections (job, stab, true);
+  elf_discard_add_sections (job, eh_frame, false);
+  elf_discard_add_sections (job, sframe, false);
+
+  for (i = 0; i < job->count; i++)
+    job->order[i] = &job->secs[i];
+  qsort (job->order, job->count, sizeof (*job->order),
+	 elf_discard_section_compare);
+  for (i = 0; i < job->count; i++)
+    {
+      struct elf_discard_input *in = &job->inputs[job->ninputs];
+
+      if (i != 0 && job->order[i]->sec->owner != job->order[i - 1]->sec->owner)
+	in = &job->inputs[++job->ninputs];
+      if (in->count == 0)
+	in->first = i;
+      in->count++;
+      job->order[i]->input = in;
+    }
+  job->ninputs++;
+
+  job->keep_memory = _bfd_link_keep_memory (info);
+  memset (&job->io_lock, 0, sizeof (job->io_lock));
+  _bfd_parallel_for (job->ninputs, 1, elf_discard_prepare_range, job);
+  _bfd_mutex_destroy (&job->io_lock);
+
+  /* Account for the memory kept as init_reloc_cookie would have.  */
+  for (i = 0; i < job->ninputs; i++)
+    {
+      struct elf_discard_input *in = &job->inputs[i];
+
+      info->cache_size += in->kept_size;
+      if (in->read_syms && _bfd_link_keep_memory (info))
 	{
-	  /* It's not a relocation against a global symbol,
-	     but it could be a relocation against a local
-	     symbol for a discarded section.  */
-	  asection *isec;
-	  Elf_Internal_Sym *isym;
-
-	  /* Need to: get the symbol; get the section.  */
-	  isym = &rcookie->locsyms[r_symndx];
-	  isec = bfd_section_from_elf_index (rcookie->abfd, isym->st_shndx);
-	  if (isec != NULL
-	      && (isec->kept_section != NULL
-		  || discarded_section (isec)))
-	    return true;
+	  Elf_Internal_Shdr *symtab_hdr
+	    = &elf_tdata (in->cookie.abfd)->symtab_hdr;
+
+	  symtab_hdr->contents = (bfd_byte *) in->cookie.locsyms;
+	  info->cache_size += (in->cookie.locsymcount
+			       * sizeof (Elf_External_Sym_Shndx));
 	}
-      return false;
     }
-  return false;
+  return;
+
+ fail:
+  free (job->secs);
+  free (job->order);
+  free (job->inputs);
+  memset (job, 0, sizeof (*job));
+  job->info = info;
+}
+
+/* Free what elf_discard_prepare read for JOB and did not keep.  */
+
+static void
+elf_discard_finish (struct elf_discard_job *job)
+{
+  size_t i;
+
+  for (i = 0; i < job->count; i++)
+    {
+      struct elf_discard_section *ds = &job->secs[i];
+
+      if (!ds->input->ok)
+	continue;
+      if (elf_section_data (ds->sec)->relocs != ds->rels)
+	free (ds->rels);
+      free (ds->deleted);
+    }
+  for (i = 0; i < job->ninputs; i++)
+    if (job->inputs[i].ok)
+      fini_reloc_cookie (&job->inputs[i].cookie, job->inputs[i].cookie.abfd);
+  free (job->secs);
+  free (job->order);
+  free (job->inputs);
+}
+
+/* Set up DC for input section SEC.  If SEC is the next section in
+   JOB, what elf_discard_prepare found is used; otherwise SEC's relocs
+   and symbols are read now.  */
+
+static bool
+elf_discard_init_cookie (struct elf_discard_job *job,
+			 struct elf_discard_cookie *dc, asection *sec)
+{
+  struct elf_discard_section *ds = NULL;
+
+  if (job->next < job->count && job->secs[job->next].sec == sec)
+    ds = &job->secs[job->next++];
+  if (ds == NULL || !ds->input->ok)
+    {
+      dc->ds = NULL;
+      return init_reloc_cookie_for_section (&dc->cookie, job->info, sec);
+    }
+
+  dc->ds = ds;
+  dc->cookie = ds->input->cookie;
+  dc->cookie.rels = ds->rels;
+  dc->cookie.rel = ds->rels;
+  dc->cookie.relend = ds->rels;
+  if (ds->rels != NULL)
+    dc->cookie.relend += sec->reloc_count;
+  return true;
+}
+
+/* Free what elf_discard_init_cookie read for DC, if anything.  */
+
+static void
+elf_discard_fini_cookie (struct elf_discard_cookie *dc, asection *sec)
+{
+  if (dc->ds == NULL)
+    fini_reloc_cookie_for_section (&dc->cookie, sec);
+}
+
+/* bfd_elf_reloc_symbol_deleted_p for an elf_discard_cookie, looking
+   up what elf_discard_prepare found rather than checking again.  */
+
+static bool
+elf_discard_reloc_deleted_p (bfd_vma offset, void *cookie)
+{
+  struct elf_discard_cookie *dc = (struct elf_discard_cookie *) cookie;
+  const Elf_Internal_Rela *rel;
+
+  rel = elf_reloc_cookie_find (&dc->cookie, offset);
+  if (rel == NULL)
+    return false;
+  if (dc->ds != NULL)
+    return dc->ds->deleted[rel - dc->cookie.rels];
+  return elf_reloc_symbol_deleted_p (&dc->cookie, rel);
 }
 
 /* Discard unneeded references to discarded sections.
@@ -14824,10 +17183,12 @@ bfd_elf_reloc_symbol_deleted_p (bfd_vma offset, void *cookie)
    nothing changed.  This function assumes that the relocations are in
    sorted order, which is true for all known assemblers.  */
 
-int
-bfd_elf_discard_info (bfd *output_bfd, struct bfd_link_info *info)
+static int
+bfd_elf_discard_info_1 (bfd *output_bfd, struct bfd_link_info *info)
 {
   struct elf_reloc_cookie cookie;
+  struct elf_discard_job job;
+  struct elf_discard_cookie dc;
   asection *o;
   bfd *abfd;
   int changed = 0;
@@ -14836,6 +17197,8 @@ bfd_elf_discard_info (bfd *output_bfd, struct bfd_link_info *info)
       || !is_elf_hash_table (info->hash))
     return 0;
 
+  elf_discard_prepare (&job, output_bfd, info);
+
   o = bfd_get_section_by_name (output_bfd, ".stab");
   if (o != NULL)
     {
@@ -14852,16 +17215,16 @@ bfd_elf_discard_info (bfd *output_bfd, struct bfd_link_info *info)
 	  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour)
 	    continue;
 
-	  if (!init_reloc_cookie_for_section (&cookie, info, i))
-	    return -1;
+	  if (!elf_discard_init_cookie (&job, &dc, i))
+	    goto error_return;
 
 	  if (_bfd_discard_section_stabs (abfd, i,
 					  elf_section_data (i)->sec_info,
-					  bfd_elf_reloc_symbol_deleted_p,
-					  &cookie))
+					  elf_discard_reloc_deleted_p,
+					  &dc.cookie))
 	    changed = 1;
 
-	  fini_reloc_cookie_for_section (&cookie, i);
+	  elf_discard_fini_cookie (&dc, i);
 	}
     }
 
@@ -14883,20 +17246,20 @@ bfd_elf_discard_info (bfd *output_bfd, struct bfd_link_info *info)
 	  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour)
 	    continue;
 
-	  if (!init_reloc_cookie_for_section (&cookie, info, i))
-	    return -1;
+	  if (!elf_discard_init_cookie (&job, &dc, i))
+	    goto error_return;
 
-	  _bfd_elf_parse_eh_frame (abfd, info, i, &cookie);
+	  _bfd_elf_parse_eh_frame (abfd, info, i, &dc.cookie);
 	  if (_bfd_elf_discard_section_eh_frame (abfd, info, i,
-						 bfd_elf_reloc_symbol_deleted_p,
-						 &cookie))
+						 elf_discard_reloc_deleted_p,
+						 &dc.cookie))
 	    {
 	      eh_changed = 1;
 	      if (i->size != i->rawsize)
 		changed = 1;
 	    }
 
-	  fini_reloc_cookie_for_section (&cookie, i);
+	  elf_discard_fini_cookie (&dc, i);
 	}
 
       eh_alignment = ((1 << o->alignment_power)
@@ -14939,6 +17302,9 @@ bfd_elf_discard_info (bfd *output_bfd, struct bfd_link_info *info)
     {
       asection *i;
 
+      if (!_bfd_elf_decode_sframe_sections (info, o))
+	goto error_return;
+
       for (i = o->map_head.s; i != NULL; i = i->map_head.s)
 	{
 	  if (i->size == 0)
@@ -14948,26 +17314,32 @@ bfd_elf_discard_info (bfd *output_bfd, struct bfd_link_info *info)
 	  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour)
 	    continue;
 
-	  if (!init_reloc_cookie_for_section (&cookie, info, i))
-	    return -1;
+	  if (!elf_discard_init_cookie (&job, &dc, i))
+	    {
+	      _bfd_elf_free_decoded_sframe_sections (info);
+	      goto error_return;
+	    }
 
-	  if (_bfd_elf_parse_sframe (abfd, info, i, &cookie))
+	  if (_bfd_elf_parse_sframe (abfd, info, i, &dc.cookie))
 	    {
 	      if (_bfd_elf_discard_section_sframe (i,
-						   bfd_elf_reloc_symbol_deleted_p,
-						   &cookie))
+						   elf_discard_reloc_deleted_p,
+						   &dc.cookie))
 		{
 		  if (i->size != i->rawsize)
 		    changed = 1;
 		}
 	    }
-	  fini_reloc_cookie_for_section (&cookie, i);
+	  elf_discard_fini_cookie (&dc, i);
 	}
+      _bfd_elf_free_decoded_sframe_sections (info);
+
       /* Update the reference to the output .sframe section.  Used to
 	 determine later if PT_GNU_SFRAME segment is to be generated.  */
       if (!_bfd_elf_set_section_sframe (output_bfd, info))
-	return -1;
+	goto error_return;
     }
+  elf_discard_finish (&job);
 
   for (abfd = info->input_bfds; abfd != NULL; abfd = abfd->link.next)
     {
@@ -15003,6 +17375,22 @@ bfd_elf_discard_info (bfd *output_bfd, struct bfd_link_info *info)
     changed = 1;
 
   return changed;
+
+ error_return:
+  elf_discard_finish (&job);
+  return -1;
+}
+
+int
+bfd_elf_discard_info (bfd *output_bfd, struct bfd_link_info *info)
+{
+  bfd_trace_span span;
+  int ret;
+
+  bfd_trace_begin (&span, "bfd_elf_discard_info", output_bfd);
+  ret = bfd_elf_discard_info_1 (output_bfd, info);
+  bfd_trace_end (&span);
+  return ret;
 }
 
 bool
@@ -15061,6 +17449,7 @@ _bfd_elf_section_already_linked (bfd *abfd,
 	 type of section.  */
       if (((flags & SEC_GROUP) == (l->sec->flags & SEC_GROUP)
 	   && ((flags & SEC_GROUP) != 0
+	       || name == l->sec->name
 	       || strcmp (name, l->sec->name) == 0))
 	  || (l->sec->owner->flags & BFD_PLUGIN) != 0
 	  || (sec->owner->flags & BFD_PLUGIN) != 0)
@@ -15215,7 +17604,7 @@ _bfd_elf_get_dynamic_reloc_section (bfd *abfd,
 				    asection *sec,
 				    bool is_rela)
 {
-  asection *reloc_sec = elf_section_data (sec)->sreloc;
+  asection *reloc_sec = elf_section_cold (sec)->sreloc;
 
   if (reloc_sec == NULL)
     {
@@ -15223,10 +17612,17 @@ _bfd_elf_get_dynamic_reloc_section (bfd *abfd,
 
       if (name != NULL)
 	{
+	  struct bfd_elf_section_cold *cold;
+
 	  reloc_sec = bfd_get_linker_section (abfd, name);
 
 	  if (reloc_sec != NULL)
-	    elf_section_data (sec)->sreloc = reloc_sec;
+	    {
+	      cold = _bfd_elf_section_cold (sec);
+	      if (cold == NULL)
+		return NULL;
+	      cold->sreloc = reloc_sec;
+	    }
 	}
     }
 
@@ -15250,10 +17646,11 @@ _bfd_elf_make_dynamic_reloc_section (asection *sec,
 				     bfd *abfd,
 				     bool is_rela)
 {
-  asection * reloc_sec = elf_section_data (sec)->sreloc;
+  asection * reloc_sec = elf_section_cold (sec)->sreloc;
 
   if (reloc_sec == NULL)
     {
+      struct bfd_elf_section_cold *cold;
       const char * name = get_dynamic_reloc_section_name (abfd, sec, is_rela);
 
       if (name == NULL)
@@ -15281,7 +17678,10 @@ _bfd_elf_make_dynamic_reloc_section (asection *sec,
 	    }
 	}
 
-      elf_section_data (sec)->sreloc = reloc_sec;
+      cold = _bfd_elf_section_cold (sec);
+      if (cold == NULL)
+	return NULL;
+      cold->sreloc = reloc_sec;
     }
 
   return reloc_sec;
@@ -15349,14 +17749,19 @@ bfd_elf_define_start_stop (struct bfd_link_info *info,
 	      && h->root.type != bfd_link_hash_common)))
     {
       bool was_dynamic = h->ref_dynamic || h->def_dynamic;
-      h->verinfo.verdef = NULL;
+      struct elf_link_hash_cold *cold;
+
+      cold = elf_link_hash_cold (info->output_bfd, h);
+      if (cold == NULL)
+	return NULL;
+      cold->verinfo.verdef = NULL;
       h->root.type = bfd_link_hash_defined;
       h->root.u.def.section = sec;
       h->root.u.def.value = 0;
       h->def_regular = 1;
       h->def_dynamic = 0;
       h->start_stop = 1;
-      h->u2.start_stop_section = sec;
+      cold->u2.start_stop_section = sec;
       if (symbol[0] == '.')
 	{
 	  /* .startof. and .sizeof. symbols are local.  */
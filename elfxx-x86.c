@@ -541,7 +541,7 @@ elf_x86_allocate_dynrelocs (struct elf_link_hash_entry *h, void *inf)
 	    }
 	}
 
-      sreloc = elf_section_data (p->sec)->sreloc;
+      sreloc = elf_section_cold (p->sec)->sreloc;
 
       BFD_ASSERT (sreloc != NULL);
       sreloc->size += p->count * htab->sizeof_reloc;
@@ -605,6 +605,8 @@ _bfd_elf_x86_get_local_sym_hash (struct elf_x86_link_hash_table *htab,
       ret->elf.indx = sec->id;
       ret->elf.dynstr_index = htab->r_sym (rel->r_info);
       ret->elf.dynindx = -1;
+      ret->elf.cold
+	= (struct elf_link_hash_cold *) &_bfd_elf_link_hash_no_cold;
       ret->plt_got.offset = (bfd_vma) -1;
       *slot = ret;
     }
@@ -639,14 +641,16 @@ _bfd_x86_elf_link_hash_newfunc (struct bfd_hash_entry *entry,
       struct elf_link_hash_table *htab
 	= (struct elf_link_hash_table *) table;
 
-      memset (&eh->elf.size, 0,
+      memset (&eh->elf.root + 1, 0,
 	      (sizeof (struct elf_x86_link_hash_entry)
-	       - offsetof (struct elf_link_hash_entry, size)));
+	       - sizeof (eh->elf.root)));
       /* Set local fields.  */
       eh->elf.indx = -1;
       eh->elf.dynindx = -1;
       eh->elf.got = htab->init_got_refcount;
       eh->elf.plt = htab->init_plt_refcount;
+      eh->elf.cold
+	= (struct elf_link_hash_cold *) &_bfd_elf_link_hash_no_cold;
       /* Assume that we have been called by a non-ELF symbol reader.
 	 This flag is then reset by the code which reads an ELF input
 	 file.  This ensures that a symbol created by a non-ELF symbol
@@ -796,6 +800,7 @@ _bfd_x86_elf_link_hash_table_create (bfd *abfd)
       elf_x86_link_hash_table_free (abfd);
       return NULL;
     }
+  htab_set_incremental (ret->loc_hash_table, 1);
   ret->elf.root.hash_table_free = elf_x86_link_hash_table_free;
 
   return &ret->elf.root;
@@ -1100,7 +1105,8 @@ _bfd_x86_elf_link_relax_section (bfd *abfd ATTRIBUTE_UNUSED,
     return true;
 
   /* Nothing to do if there are no relocations or relative relocations
-     have been packed.  */
+     have been packed.  The scan_relocs backend also marks sections
+     with no relocation that can be packed as done.  */
   if (input_section == htab->elf.srelrdyn
       || input_section->relative_reloc_packed
       || ((input_section->flags & (SEC_RELOC | SEC_ALLOC))
@@ -1576,7 +1582,7 @@ elf_x86_size_or_finish_relative_reloc
       if (sec == sgot)
 	srel = srelgot;
       else
-	srel = elf_section_data (sec)->sreloc;
+	srel = elf_section_cold (sec)->sreloc;
       offset = (sec->output_section->vma + sec->output_offset
 		+ relative_reloc->data[i].offset);
       relative_reloc->data[i].address = offset;
@@ -1798,6 +1804,93 @@ elf_x86_relative_reloc_compare (const void *pa, const void *pb)
   return 0;
 }
 
+/* Sort the relative relocations in RELATIVE_RELOC by address.  The
+   records are large, so the addresses are radix sorted along with
+   their indices, a byte at a time and skipping the bytes that all the
+   addresses share, and the records are then moved into place once.
+   This is linear in the number of relocations, which matters for the
+   millions of them in a big PIE.  qsort is used if memory is short.  */
+
+static void
+elf_x86_sort_relative_relocs
+  (struct elf_x86_relative_reloc_data *relative_reloc)
+{
+  struct relative_reloc_key
+  {
+    bfd_vma address;
+    bfd_size_type index;
+  } *buf, *keys, *tmp, *swap;
+  struct elf_x86_relative_reloc_record *data = relative_reloc->data;
+  struct elf_x86_relative_reloc_record *sorted;
+  bfd_size_type count = relative_reloc->count;
+  bfd_size_type i;
+  bfd_vma all_or, all_and;
+  unsigned int shift;
+
+  /* Nothing to do if they are in order already.  */
+  for (i = 1; i < count; i++)
+    if (data[i - 1].address > data[i].address)
+      break;
+  if (i >= count)
+    return;
+
+  buf = (struct relative_reloc_key *) bfd_malloc (2 * count * sizeof (*buf));
+  sorted = ((struct elf_x86_relative_reloc_record *)
+	    bfd_malloc (count * sizeof (*sorted)));
+  if (buf == NULL || sorted == NULL)
+    {
+      free (buf);
+      free (sorted);
+      qsort (data, count, sizeof (*data), elf_x86_relative_reloc_compare);
+      return;
+    }
+
+  keys = buf;
+  tmp = buf + count;
+  all_or = 0;
+  all_and = (bfd_vma) -1;
+  for (i = 0; i < count; i++)
+    {
+      keys[i].address = data[i].address;
+      keys[i].index = i;
+      all_or |= data[i].address;
+      all_and &= data[i].address;
+    }
+
+  for (shift = 0; shift < sizeof (bfd_vma) * 8; shift += 8)
+    {
+      bfd_size_type bucket[256];
+      bfd_size_type pos, n;
+      unsigned int b;
+
+      if ((((all_or ^ all_and) >> shift) & 0xff) == 0)
+	continue;
+
+      memset (bucket, 0, sizeof (bucket));
+      for (i = 0; i < count; i++)
+	bucket[(keys[i].address >> shift) & 0xff]++;
+      for (pos = 0, b = 0; b < 256; b++)
+	{
+	  n = bucket[b];
+	  bucket[b] = pos;
+	  pos += n;
+	}
+      for (i = 0; i < count; i++)
+	tmp[bucket[(keys[i].address >> shift) & 0xff]++] = keys[i];
+
+      swap = keys;
+      keys = tmp;
+      tmp = swap;
+    }
+
+  for (i = 0; i < count; i++)
+    sorted[i] = data[keys[i].index];
+  free (buf);
+  free (data);
+  relative_reloc->data = sorted;
+  relative_reloc->size = count;
+}
+
 enum dynobj_sframe_plt_type
 {
   SFRAME_PLT = 1,
@@ -2036,7 +2129,7 @@ _bfd_elf_x86_size_relative_relocs (struct bfd_link_info *info,
       for (i = 0; i < unaligned_count; i++)
 	{
 	  sec = htab->unaligned_relative_reloc.data[i].sec;
-	  srel = elf_section_data (sec)->sreloc;
+	  srel = elf_section_cold (sec)->sreloc;
 	  srel->reloc_count = 0;
 	}
     }
@@ -2054,7 +2147,7 @@ _bfd_elf_x86_size_relative_relocs (struct bfd_link_info *info,
 	      if (sec == sgot)
 		srel = srelgot;
 	      else
-		srel = elf_section_data (sec)->sreloc;
+		srel = elf_section_cold (sec)->sreloc;
 	      srel->size -= htab->sizeof_reloc;
 	    }
 	}
@@ -2074,9 +2167,7 @@ _bfd_elf_x86_size_relative_relocs (struct bfd_link_info *info,
 	 sort them in the first pass since the relative positions
 	 won't change.  */
       if (htab->generate_relative_reloc_pass == 0)
-	qsort (htab->relative_reloc.data, count,
-	       sizeof (struct elf_x86_relative_reloc_record),
-	       elf_x86_relative_reloc_compare);
+	elf_x86_sort_relative_relocs (&htab->relative_reloc);
 
       elf_x86_compute_dl_relr_bitmap (info, htab, need_layout);
     }
@@ -2263,7 +2354,7 @@ _bfd_x86_elf_size_dynamic_sections (bfd *output_bfd,
 	  struct elf_dyn_relocs *p;
 
 	  for (p = ((struct elf_dyn_relocs *)
-		     elf_section_data (s)->local_dynrel);
+		     elf_section_cold (s)->local_dynrel);
 	       p != NULL;
 	       p = p->next)
 	    {
@@ -2284,7 +2375,7 @@ _bfd_x86_elf_size_dynamic_sections (bfd *output_bfd,
 		}
 	      else if (p->count != 0)
 		{
-		  srel = elf_section_data (p->sec)->sreloc;
+		  srel = elf_section_cold (p->sec)->sreloc;
 		  srel->size += p->count * htab->sizeof_reloc;
 		  if ((p->sec->output_section->flags & SEC_READONLY) != 0
 		      && (info->flags & DF_TEXTREL) == 0)
@@ -3558,9 +3649,42 @@ _bfd_x86_elf_get_synthetic_symtab (bfd *abfd,
   if (dynrelcount <= 0)
     goto bad_return;
 
-  /* Sort the relocs by address.  */
-  qsort (dynrelbuf, dynrelcount, sizeof (arelent *),
-	 _bfd_x86_elf_compare_relocs);
+  bed = get_elf_backend_data (abfd);
+
+  if (bed->target_id == X86_64_ELF_DATA)
+    {
+      get_plt_got_vma = elf_x86_64_get_plt_got_vma;
+      valid_plt_reloc_p = elf_x86_64_valid_plt_reloc_p;
+    }
+  else
+    {
+      get_plt_got_vma = elf_i386_get_plt_got_vma;
+      valid_plt_reloc_p = elf_i386_valid_plt_reloc_p;
+    }
+
+  /* Only the relocs a PLT entry can use are looked up below.  Drop
+     the others, in a PIE or shared library mostly R_*_RELATIVE, so
+     that they are neither sorted nor counted for names.  */
+  n = 0;
+  for (i = 0; i < dynrelcount; i++)
+    {
+      p = dynrelbuf[i];
+      if (p->howto != NULL && valid_plt_reloc_p (p->howto->type))
+	dynrelbuf[n++] = p;
+    }
+  dynrelcount = n;
+  if (dynrelcount == 0)
+    goto bad_return;
+
+  /* Sort the relocs by address, unless they already are, as the
+     relocs of .rela.plt normally are.  */
+  for (i = 1; i < dynrelcount; i++)
+    if (dynrelbuf[i - 1]->address > dynrelbuf[i]->address)
+      {
+	qsort (dynrelbuf, dynrelcount, sizeof (arelent *),
+	       _bfd_x86_elf_compare_relocs);
+	break;
+      }
 
   size = count * sizeof (asymbol);
 
@@ -3578,17 +3702,8 @@ _bfd_x86_elf_get_synthetic_symtab (bfd *abfd,
   if (s == NULL)
     goto bad_return;
 
-  bed = get_elf_backend_data (abfd);
-
-  if (bed->target_id == X86_64_ELF_DATA)
+  if (bed->target_id != X86_64_ELF_DATA)
     {
-      get_plt_got_vma = elf_x86_64_get_plt_got_vma;
-      valid_plt_reloc_p = elf_x86_64_valid_plt_reloc_p;
-    }
-  else
-    {
-      get_plt_got_vma = elf_i386_get_plt_got_vma;
-      valid_plt_reloc_p = elf_i386_valid_plt_reloc_p;
       if (got_addr)
 	{
 	  /* Check .got.plt and then .got to get the _GLOBAL_OFFSET_TABLE_
@@ -46,6 +46,8 @@ SUBSECTION
 #include "sysdep.h"
 #include "bfd.h"
 #include "libbfd.h"
+#include "libiberty.h"
+#include "hashtab.h"
 
 /* IMPORT from targets.c.  */
 extern const size_t _bfd_target_vector_entries;
@@ -112,6 +114,7 @@ struct bfd_preserve
   bool read_only;
   bfd_vma start_address;
   struct bfd_hash_table section_htab;
+  struct bfd_memory_usage memory_usage;
 };
 
 /* When testing an object for compatibility with a particular target
@@ -135,19 +138,30 @@ bfd_preserve_save (bfd *abfd, struct bfd_preserve *preserve,
   preserve->sections = abfd->sections;
   preserve->section_last = abfd->section_last;
   preserve->section_count = abfd->section_count;
-  preserve->section_id = _bfd_section_id;
+  preserve->section_id = *_bfd_section_id_counter ();
   preserve->symcount = abfd->symcount;
   preserve->read_only = abfd->read_only;
   preserve->start_address = abfd->start_address;
   preserve->section_htab = abfd->section_htab;
+  if (abfd->memory_usage != NULL)
+    preserve->memory_usage = *abfd->memory_usage;
+  else
+    memset (&preserve->memory_usage, 0, sizeof (preserve->memory_usage));
   preserve->marker = bfd_alloc (abfd, 1);
   preserve->build_id = abfd->build_id;
   preserve->cleanup = cleanup;
   if (preserve->marker == NULL)
     return false;
 
-  return bfd_hash_table_init (&abfd->section_htab, bfd_section_hash_newfunc,
-			      sizeof (struct section_hash_entry));
+  /* Start as small as _bfd_new_bfd does; the table grows as sections
+     are added.  A default sized table here would cost every archive
+     member that is checked tens of kilobytes.  */
+  if (!bfd_hash_table_init_n (&abfd->section_htab, bfd_section_hash_newfunc,
+			      sizeof (struct section_hash_entry), 13))
+    return false;
+  bfd_hash_table_set_function (&abfd->section_htab, bfd_hash_wide);
+  bfd_hash_table_set_memory_class (&abfd->section_htab, bfd_memory_sections);
+  return true;
 }
 
 /* A back-end object_p function may flip a bfd from file backed to
@@ -183,7 +197,7 @@ static void
 bfd_reinit (bfd *abfd, unsigned int section_id,
 	    struct bfd_preserve *preserve, bfd_cleanup cleanup)
 {
-  _bfd_section_id = section_id;
+  *_bfd_section_id_counter () = section_id;
   if (cleanup)
     cleanup (abfd);
   abfd->tdata.any = NULL;
@@ -210,7 +224,8 @@ bfd_preserve_restore (bfd *abfd, struct bfd_preserve *preserve)
   abfd->sections = preserve->sections;
   abfd->section_last = preserve->section_last;
   abfd->section_count = preserve->section_count;
-  _bfd_section_id = preserve->section_id;
+  abfd->section_map_stale = 1;
+  *_bfd_section_id_counter () = preserve->section_id;
   abfd->symcount = preserve->symcount;
   abfd->read_only = preserve->read_only;
   abfd->start_address = preserve->start_address;
@@ -219,6 +234,7 @@ bfd_preserve_restore (bfd *abfd, struct bfd_preserve *preserve)
   /* bfd_release frees all memory more recently bfd_alloc'd than
      its arg, as well as its arg.  */
   bfd_release (abfd, preserve->marker);
+  _bfd_memory_release (abfd, &preserve->memory_usage);
   preserve->marker = NULL;
   return preserve->cleanup;
 }
@@ -279,6 +295,323 @@ null_error_handler (const char *fmt ATTRIBUTE_UNUSED,
 {
 }
 
+/* Magic numbers that the targets of this build need at the start of
+   a file in order to recognize it.  The first four bytes of the file,
+   read as a little-endian number and masked with MASK, must equal
+   VALUE.  A target is ruled out for a format only if it has entries
+   for that format and none of them match, so that targets missing
+   from this table are always probed.  */
+
+struct target_magic
+{
+  const bfd_target *target;
+  bfd_format format;
+  uint32_t mask;
+  uint32_t value;
+};
+
+extern const bfd_target x86_64_elf64_vec;
+extern const bfd_target x86_64_pe_vec;
+extern const bfd_target x86_64_pe_big_vec;
+extern const bfd_target x86_64_pei_vec;
+extern const bfd_target srec_vec;
+extern const bfd_target symbolsrec_vec;
+extern const bfd_target tekhex_vec;
+extern const bfd_target ihex_vec;
+
+#define MAGIC_ELF	0x464c457f	/* "\177ELF".  */
+#define MAGIC_AR	0x72613c21	/* "!<ar", from "!<arch>\n".  */
+#define MAGIC_AR_THIN	0x68743c21	/* "!<th", from "!<thin>\n".  */
+#define MAGIC_MZ	0x5a4d		/* "MZ", the DOS header of a PE image.  */
+#define MAGIC_ANON	0xffff0000	/* Import library or big object.  */
+
+#define ARCHIVE_MAGICS(vec) \
+  { &vec, bfd_archive, 0xffffffff, MAGIC_AR }, \
+  { &vec, bfd_archive, 0xffffffff, MAGIC_AR_THIN }
+
+static const struct target_magic target_magics[] =
+{
+  { &x86_64_elf64_vec, bfd_object, 0xffffffff, MAGIC_ELF },
+  { &x86_64_elf64_vec, bfd_core, 0xffffffff, MAGIC_ELF },
+  ARCHIVE_MAGICS (x86_64_elf64_vec),
+
+  /* AMD64MAGIC and its per-OS variants, see coff/x86_64.h.  */
+  { &x86_64_pe_vec, bfd_object, 0xffff, 0x8664 },
+  { &x86_64_pe_vec, bfd_object, 0xffff, 0x8664 ^ 0x4644 },
+  { &x86_64_pe_vec, bfd_object, 0xffff, 0x8664 ^ 0xadc4 },
+  { &x86_64_pe_vec, bfd_object, 0xffff, 0x8664 ^ 0x7b79 },
+  { &x86_64_pe_vec, bfd_object, 0xffff, 0x8664 ^ 0x1993 },
+  ARCHIVE_MAGICS (x86_64_pe_vec),
+
+  { &x86_64_pe_big_vec, bfd_object, 0xffffffff, MAGIC_ANON },
+  ARCHIVE_MAGICS (x86_64_pe_big_vec),
+
+  { &x86_64_pei_vec, bfd_object, 0xffff, MAGIC_MZ },
+  { &x86_64_pei_vec, bfd_object, 0xffffffff, MAGIC_ANON },
+  ARCHIVE_MAGICS (x86_64_pei_vec),
+
+  { &srec_vec, bfd_object, 0xff, 'S' },
+  { &symbolsrec_vec, bfd_object, 0xffff, 0x2424 },	/* "$$".  */
+  { &tekhex_vec, bfd_object, 0xff, '%' },
+  { &ihex_vec, bfd_object, 0xff, ':' }
+};
+
+/* Read the first four bytes of ABFD into *MAGIC, returning false if
+   the file is too short.  */
+
+static bool
+read_magic (bfd *abfd, uint32_t *magic)
+{
+  bfd_byte buf[4];
+
+  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0
+      || bfd_bread (buf, sizeof (buf), abfd) != sizeof (buf))
+    return false;
+  *magic = bfd_getl32 (buf);
+  return true;
+}
+
+/* Return true if TARGET can't recognize a file starting with MAGIC as
+   FORMAT.  */
+
+static bool
+magic_rules_out (const bfd_target *target, bfd_format format,
+		 uint32_t magic)
+{
+  bool listed = false;
+  size_t i;
+
+  for (i = 0; i < ARRAY_SIZE (target_magics); i++)
+    if (target_magics[i].target == target
+	&& target_magics[i].format == format)
+      {
+	if ((magic & target_magics[i].mask) == target_magics[i].value)
+	  return false;
+	listed = true;
+      }
+  return listed;
+}
+
+/* The format cache set up by bfd_set_format_cache.  Each entry
+   records, for one file identity and format, the target that
+   recognized the file or NULL if none did.  */
+
+struct format_cache_entry
+{
+  /* The canonical file name, size and modification time.  */
+  char *path;
+  ufile_ptr size;
+  long long mtime;
+  bfd_format format;
+  const bfd_target *target;
+};
+
+static bfd_mutex format_cache_lock;
+static htab_t format_cache_table;
+static FILE *format_cache_file;
+static int format_cache_enabled;
+
+static hashval_t
+format_cache_hash (const void *p)
+{
+  const struct format_cache_entry *ent = (const struct format_cache_entry *) p;
+
+  return htab_hash_string (ent->path) * 31 + ent->format;
+}
+
+static int
+format_cache_eq (const void *a, const void *b)
+{
+  const struct format_cache_entry *ea = (const struct format_cache_entry *) a;
+  const struct format_cache_entry *eb = (const struct format_cache_entry *) b;
+
+  return ea->format == eb->format && strcmp (ea->path, eb->path) == 0;
+}
+
+static void
+format_cache_del (void *p)
+{
+  struct format_cache_entry *ent = (struct format_cache_entry *) p;
+
+  free (ent->path);
+  free (ent);
+}
+
+/* Add or replace the entry for PATH and FORMAT.  The lock must be
+   held.  */
+
+static void
+format_cache_insert (const char *path, ufile_ptr size, long long mtime,
+		     bfd_format format, const bfd_target *target)
+{
+  struct format_cache_entry key, *ent;
+  void **slot;
+
+  key.path = (char *) path;
+  key.format = format;
+  slot = htab_find_slot (format_cache_table, &key, INSERT);
+  if (slot == NULL)
+    return;
+  ent = (struct format_cache_entry *) *slot;
+  if (ent == NULL)
+    {
+      ent = (struct format_cache_entry *) bfd_malloc (sizeof (*ent));
+      if (ent != NULL)
+	ent->path = strdup (path);
+      if (ent == NULL || ent->path == NULL)
+	{
+	  free (ent);
+	  htab_clear_slot (format_cache_table, slot);
+	  return;
+	}
+      ent->format = format;
+      *slot = ent;
+    }
+  ent->size = size;
+  ent->mtime = mtime;
+  ent->target = target;
+}
+
+/* Return the target called NAME, or NULL.  */
+
+static const bfd_target *
+format_cache_find_target (const char *name)
+{
+  const bfd_target * const *target;
+
+  for (target = bfd_target_vector; *target != NULL; target++)
+    if (strcmp ((*target)->name, name) == 0)
+      return *target;
+  return NULL;
+}
+
+/* Read the entries in F, one per line as written by
+   format_cache_record.  Malformed lines and lines naming targets that
+   aren't in this build are ignored, and later lines override earlier
+   ones.  */
+
+static void
+format_cache_load (FILE *f)
+{
+  char line[4096];
+
+  while (fgets (line, sizeof (line), f) != NULL)
+    {
+      size_t len = strlen (line);
+      char name[256];
+      int format, pos;
+      long long mtime;
+      unsigned long long size;
+      const bfd_target *target;
+
+      if (len == 0 || line[len - 1] != '\n')
+	{
+	  /* Too long; discard the rest of it.  */
+	  int c;
+
+	  while ((c = getc (f)) != EOF && c != '\n')
+	    ;
+	  continue;
+	}
+      line[len - 1] = '\0';
+
+      if (sscanf (line, "%d %lld %llu %255s %n",
+		  &format, &mtime, &size, name, &pos) != 4
+	  || format <= bfd_unknown || format >= bfd_type_end
+	  || line[pos] == '\0')
+	continue;
+      if (strcmp (name, "-") == 0)
+	target = NULL;
+      else if ((target = format_cache_find_target (name)) == NULL)
+	continue;
+      format_cache_insert (line + pos, size, mtime, (bfd_format) format,
+			   target);
+    }
+}
+
+/* The identity of a file under the format cache.  */
+
+struct format_cache_key
+{
+  char *path;
+  ufile_ptr size;
+  long long mtime;
+};
+
+/* Fill in KEY for ABFD.  Return false if the cache is off or ABFD
+   isn't a regular file opened by name with its target defaulted.  */
+
+static bool
+format_cache_key (bfd *abfd, struct format_cache_key *key)
+{
+  struct stat st;
+
+  key->path = NULL;
+  if (!_bfd_atomic_load (&format_cache_enabled)
+      || !abfd->target_defaulted
+      || abfd->my_archive != NULL
+      || (abfd->flags & BFD_IN_MEMORY) != 0
+      || bfd_get_filename (abfd) == NULL
+      || bfd_stat (abfd, &st) != 0
+      || (st.st_mode & S_IFMT) != S_IFREG)
+    return false;
+
+  key->path = lrealpath (bfd_get_filename (abfd));
+  key->size = st.st_size;
+  key->mtime = st.st_mtime;
+  return key->path != NULL;
+}
+
+/* Look KEY up for FORMAT.  On a hit, set *TARGET to the target that
+   recognized the file, or NULL if the file isn't of this format, and
+   return true.  */
+
+static bool
+format_cache_lookup (const struct format_cache_key *key, bfd_format format,
+		     const bfd_target **target)
+{
+  struct format_cache_entry probe, *ent;
+  bool hit = false;
+
+  probe.path = key->path;
+  probe.format = format;
+  _bfd_mutex_lock (&format_cache_lock);
+  if (format_cache_table != NULL)
+    {
+      ent = (struct format_cache_entry *) htab_find (format_cache_table,
+						      &probe);
+      if (ent != NULL && ent->size == key->size && ent->mtime == key->mtime)
+	{
+	  *target = ent->target;
+	  hit = true;
+	}
+    }
+  _bfd_mutex_unlock (&format_cache_lock);
+  return hit;
+}
+
+/* Remember that TARGET, or no target if NULL, recognized the file
+   identified by KEY as FORMAT.  */
+
+static void
+format_cache_record (const struct format_cache_key *key, bfd_format format,
+		     const bfd_target *target)
+{
+  _bfd_mutex_lock (&format_cache_lock);
+  if (format_cache_table != NULL)
+    {
+      format_cache_insert (key->path, key->size, key->mtime, format, target);
+      if (format_cache_file != NULL)
+	{
+	  fprintf (format_cache_file, "%d %lld %llu %s %s\n", (int) format,
+		   key->mtime, (unsigned long long) key->size,
+		   target != NULL ? target->name : "-", key->path);
+	  fflush (format_cache_file);
+	}
+    }
+  _bfd_mutex_unlock (&format_cache_lock);
+}
+
 /*
 FUNCTION
 	bfd_check_format_matches
@@ -311,11 +644,16 @@ bfd_check_format_matches (bfd *abfd, bfd_format format, char ***matching)
   const bfd_target *save_targ, *right_targ, *ar_right_targ, *match_targ;
   int match_count, best_count, best_match;
   int ar_match_index;
-  unsigned int initial_section_id = _bfd_section_id;
+  unsigned int initial_section_id = *_bfd_section_id_counter ();
   struct bfd_preserve preserve, preserve_match;
   bfd_cleanup cleanup = NULL;
   bfd_error_handler_type orig_error_handler;
-  static int in_check_format;
+  static TLS int in_check_format;
+  uint32_t magic;
+  bool have_magic;
+  struct format_cache_key cache_key;
+  const bfd_target *cached_targ;
+  bool record = false;
 
   if (matching != NULL)
     *matching = NULL;
@@ -347,12 +685,13 @@ bfd_check_format_matches (bfd *abfd, bfd_format format, char ***matching)
   /* Don't report errors on recursive calls checking the first element
      of an archive.  */
   if (in_check_format)
-    orig_error_handler = bfd_set_error_handler (null_error_handler);
+    orig_error_handler = bfd_set_thread_error_handler (null_error_handler);
   else
     orig_error_handler = _bfd_set_error_handler_caching (abfd);
   ++in_check_format;
 
   preserve_match.marker = NULL;
+  cache_key.path = NULL;
   if (!bfd_preserve_save (abfd, &preserve, NULL))
     goto err_ret;
 
@@ -383,6 +722,27 @@ bfd_check_format_matches (bfd *abfd, bfd_format format, char ***matching)
 	goto err_unrecog;
     }
 
+  /* If the format cache knows the answer for this file, try just
+     that target.  A stale entry falls through to the full search.  */
+  if (format_cache_key (abfd, &cache_key))
+    {
+      if (!format_cache_lookup (&cache_key, format, &cached_targ))
+	record = true;
+      else if (cached_targ == NULL)
+	goto err_unrecog;
+      else
+	{
+	  abfd->xvec = cached_targ;
+	  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0)
+	    goto err_ret;
+	  cleanup = BFD_SEND_FMT (abfd, _bfd_check_format, (abfd));
+	  if (cleanup)
+	    goto ok_ret;
+	  abfd->xvec = save_targ;
+	  record = true;
+	}
+    }
+
   /* Since the target type was defaulted, check them all in the hope
      that one will be uniquely recognized.  */
   right_targ = NULL;
@@ -393,6 +753,11 @@ bfd_check_format_matches (bfd *abfd, bfd_format format, char ***matching)
   match_count = 0;
   ar_match_index = _bfd_target_vector_entries;
 
+  /* Read the start of the file once, so that targets whose magic
+     numbers are absent need not be probed.  If that fails, fall back
+     to probing every target.  */
+  have_magic = read_magic (abfd, &magic);
+
   for (target = bfd_target_vector; *target != NULL; target++)
     {
       void **high_water;
@@ -406,7 +771,8 @@ bfd_check_format_matches (bfd *abfd, bfd_format format, char ***matching)
 #if BFD_SUPPORTS_PLUGINS
 	  || (match_count != 0 && *target == &plugin_vec)
 #endif
-	  || (!abfd->target_defaulted && *target == save_targ))
+	  || (!abfd->target_defaulted && *target == save_targ)
+	  || (have_magic && magic_rules_out (*target, format, magic)))
 	continue;
 
       /* If we already tried a match, the bfd is modified and may
@@ -588,11 +954,14 @@ bfd_check_format_matches (bfd *abfd, bfd_format format, char ***matching)
       if (abfd->direction == both_direction)
 	abfd->output_has_begun = true;
 
+      if (record)
+	format_cache_record (&cache_key, format, abfd->xvec);
+      free (cache_key.path);
       free (matching_vector);
       if (preserve_match.marker != NULL)
 	bfd_preserve_finish (abfd, &preserve_match);
       bfd_preserve_finish (abfd, &preserve);
-      bfd_set_error_handler (orig_error_handler);
+      bfd_set_thread_error_handler (orig_error_handler);
 
       struct per_xvec_message **list = _bfd_per_xvec_warn (abfd->xvec, 0);
       if (*list)
@@ -602,12 +971,16 @@ bfd_check_format_matches (bfd *abfd, bfd_format format, char ***matching)
 	clear_warnmsg (list++);
       --in_check_format;
 
+      _bfd_hook (bfd_hook_format_probe, abfd, NULL, abfd->xvec->name,
+		 format, 1);
       /* File position has moved, BTW.  */
       return true;
     }
 
   if (match_count == 0)
     {
+      if (record)
+	format_cache_record (&cache_key, format, NULL);
     err_unrecog:
       bfd_set_error (bfd_error_file_not_recognized);
     err_ret:
@@ -641,10 +1014,11 @@ bfd_check_format_matches (bfd *abfd, bfd_format format, char ***matching)
   if (cleanup)
     cleanup (abfd);
  out:
+  free (cache_key.path);
   if (preserve_match.marker != NULL)
     bfd_preserve_finish (abfd, &preserve_match);
   bfd_preserve_restore (abfd, &preserve);
-  bfd_set_error_handler (orig_error_handler);
+  bfd_set_thread_error_handler (orig_error_handler);
   struct per_xvec_message **list = _bfd_per_xvec_warn (NULL, 0);
   struct per_xvec_message **one = NULL;
   for (size_t i = 0; i < _bfd_target_vector_entries + 1; i++)
@@ -665,9 +1039,85 @@ bfd_check_format_matches (bfd *abfd, bfd_format format, char ***matching)
   for (size_t i = 0; i < _bfd_target_vector_entries + 1; i++)
     clear_warnmsg (list++);
   --in_check_format;
+  _bfd_hook (bfd_hook_format_probe, abfd, NULL, NULL, format, 0);
   return false;
 }
 
+/*
+FUNCTION
+	bfd_set_format_cache
+
+SYNOPSIS
+	bool bfd_set_format_cache (const char *filename);
+
+DESCRIPTION
+	Use @var{filename} to remember the results of
+	<<bfd_check_format_matches>> across processes.  Files opened by
+	name with a defaulted target are identified by their canonical
+	name, size and modification time.  Once a file has been
+	recognized, or found not to be of the requested format, later
+	checks of the unchanged file skip probing the other targets.
+	Entries are appended to @var{filename}, which is created if
+	needed and may be shared by several processes or deleted at
+	any time.  Ambiguous results are not remembered, and a cached
+	target that no longer recognizes the file causes a full probe.
+
+	Pass NULL to stop using the cache.  Return <<FALSE>>, with
+	<<bfd_error_system_call>> or <<bfd_error_no_memory>>, if the
+	cache can't be set up.
+*/
+
+bool
+bfd_set_format_cache (const char *filename)
+{
+  FILE *f;
+  bool ret = true;
+
+  _bfd_mutex_lock (&format_cache_lock);
+  if (format_cache_enabled)
+    _bfd_atomic_add (&format_cache_enabled, -1);
+  if (format_cache_file != NULL)
+    fclose (format_cache_file);
+  format_cache_file = NULL;
+  if (format_cache_table != NULL)
+    htab_delete (format_cache_table);
+  format_cache_table = NULL;
+
+  if (filename != NULL)
+    {
+      format_cache_table = htab_create_alloc (64, format_cache_hash,
+					      format_cache_eq,
+					      format_cache_del,
+					      calloc, free);
+      if (format_cache_table == NULL)
+	{
+	  bfd_set_error (bfd_error_no_memory);
+	  ret = false;
+	}
+      else
+	{
+	  f = _bfd_real_fopen (filename, FOPEN_RT);
+	  if (f != NULL)
+	    {
+	      format_cache_load (f);
+	      fclose (f);
+	    }
+	  format_cache_file = _bfd_real_fopen (filename, FOPEN_AT);
+	  if (format_cache_file == NULL)
+	    {
+	      bfd_set_error (bfd_error_system_call);
+	      htab_delete (format_cache_table);
+	      format_cache_table = NULL;
+	      ret = false;
+	    }
+	  else
+	    _bfd_atomic_add (&format_cache_enabled, 1);
+	}
+    }
+  _bfd_mutex_unlock (&format_cache_lock);
+  return ret;
+}
+
 /*
 FUNCTION
 	bfd_set_format
@@ -101,6 +101,18 @@ htab_print_statistics (FILE *f, const char *name, htab_t table)
 #include "objalloc.h"
 #include "libiberty.h"
 
+#if defined (__SSE2__) || defined (_M_X64) \
+    || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2_GROUPS 1
+#endif
+
+#if defined (_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
    /*
    SECTION
 	   Hash Tables
@@ -413,6 +425,40 @@ htab_print_statistics (FILE *f, const char *name, htab_t table)
    .  unsigned int entsize;
    .  {* If non-zero, don't grow the hash table.  *}
    .  unsigned int frozen:1;
+   .  {* If non-zero, strings are hashed with <<bfd_hash_wide>>.  *}
+   .  unsigned int wide_hash:1;
+   .  {* If non-NULL, an open-addressed index used by lookups.  See
+   .     <<bfd_hash_table_set_layout>>.  *}
+   .  struct bfd_hash_flat *flat;
+   .  {* If non-NULL, the locks that let several threads look up and
+   .     insert at once.  See <<bfd_hash_table_set_concurrent>>.  *}
+   .  struct bfd_hash_locks *locks;
+   .  {* If non-NULL, counters kept for <<bfd_hash_table_statistics>>.  *}
+   .  struct bfd_hash_stats *stats;
+   .  {* The class that the table's memory is counted in, and the bytes
+   .     counted, if memory accounting is on.  *}
+   .  enum bfd_memory_class memory_class;
+   .  bfd_size_type memory_used;
+   .};
+   .
+   .{* The string hash functions a table may use.  *}
+   .
+   .enum bfd_hash_function
+   .{
+   .  {* The original hash, one byte at a time.  *}
+   .  bfd_hash_classic,
+   .  {* A hash taking eight bytes at a time.  *}
+   .  bfd_hash_wide
+   .};
+   .
+   .{* The ways a table may find its entries.  *}
+   .
+   .enum bfd_hash_layout
+   .{
+   .  {* Walk the chain hanging off each bucket.  *}
+   .  bfd_hash_chained,
+   .  {* Probe an open-addressed index of hash codes first.  *}
+   .  bfd_hash_open
    .};
    .
    */
@@ -481,6 +527,45 @@ higher_prime_number(uint32_t n)
 
 static unsigned int bfd_default_hash_table_size = DEFAULT_SIZE;
 
+/* Where to report the statistics of tables as they are freed, or NULL
+   to keep no statistics by default.  */
+static FILE* bfd_hash_stats_file;
+
+/* A clock for timing lookups, in nanoseconds.  */
+
+static unsigned long long
+bfd_hash_clock(void)
+{
+#if defined (_WIN32)
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (unsigned long long)(now.QuadPart / freq.QuadPart * 1000000000
+		+ now.QuadPart % freq.QuadPart * 1000000000 / freq.QuadPart);
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+/* Count SIZE more bytes of TABLE's objalloc, if memory accounting is
+   on.  Callers hold whatever lock guards the objalloc.  */
+
+static inline void
+bfd_hash_account(struct bfd_hash_table* table, unsigned long long size)
+{
+	if (_bfd_memory_accounting_p())
+	{
+		table->memory_used += size;
+		_bfd_memory_account(NULL, table->memory_class, size);
+	}
+}
+
 /*
 FUNCTION
 	bfd_hash_table_init_n
@@ -514,6 +599,11 @@ bfd_hash_table_init_n(struct bfd_hash_table* table,
 		return false;
 	}
 
+	table->flat = NULL;
+	table->locks = NULL;
+	table->stats = NULL;
+	table->memory_class = bfd_memory_hash;
+	table->memory_used = 0;
 	table->memory = (void*)objalloc_create();
 	if (table->memory == NULL)
 	{
@@ -528,12 +618,16 @@ bfd_hash_table_init_n(struct bfd_hash_table* table,
 		bfd_set_error(bfd_error_no_memory);
 		return false;
 	}
+	bfd_hash_account(table, alloc);
 	memset((void*)table->table, 0, alloc);
 	table->size = size;
 	table->entsize = entsize;
 	table->count = 0;
 	table->frozen = 0;
+	table->wide_hash = 0;
 	table->newfunc = newfunc;
+	if (bfd_hash_stats_file != NULL)
+		bfd_hash_table_set_statistics(table, true);
 	return true;
 }
 
@@ -577,8 +671,18 @@ DESCRIPTION
 void
 bfd_hash_table_free(struct bfd_hash_table* table)
 {
+	bfd_hash_table_set_concurrent(table, 0);
+	bfd_hash_table_set_statistics(table, false);
+	free(table->flat);
+	table->flat = NULL;
 	objalloc_free((struct objalloc*)table->memory);
 	table->memory = NULL;
+	if (table->memory_used != 0)
+	{
+		_bfd_memory_account(NULL, table->memory_class,
+			-(bfd_signed_vma)table->memory_used);
+		table->memory_used = 0;
+	}
 }
 
 static inline unsigned long long
@@ -606,299 +710,1295 @@ bfd_hash_hash(const char* string, unsigned int* lenp)
 	return hash;
 }
 
-/*
-FUNCTION
-	bfd_hash_lookup
-
-SYNOPSIS
-	struct bfd_hash_entry *bfd_hash_lookup
-	  (struct bfd_hash_table *, const char *,
-	   bool {*create*}, bool {*copy*});
-
-DESCRIPTION
-	Look up a string in a hash table.
-*/
+/* The same, but mixing in eight bytes at a time.  The length is found
+   first with strlen, which the C library vectorizes, so that the words
+   can be loaded without reading past the end of the string.  */
 
-struct bfd_hash_entry*
-	bfd_hash_lookup(struct bfd_hash_table* table,
-		const char* string,
-		bool create,
-		bool copy)
+static inline unsigned long long
+bfd_hash_hash_wide(const char* string, unsigned int* lenp)
 {
+	const unsigned char* s;
 	unsigned long long hash;
-	struct bfd_hash_entry* hashp;
-	unsigned int len;
-	unsigned int _index;
+	unsigned long long word;
+	size_t len;
+	size_t left;
 
-	hash = bfd_hash_hash(string, &len);
-	_index = hash % table->size;
-	for (hashp = table->table[_index];
-		hashp != NULL;
-		hashp = hashp->next)
+	BFD_ASSERT(string != NULL);
+	s = (const unsigned char*)string;
+	len = strlen(string);
+	hash = len * 0x9e3779b97f4a7c15ull;
+	for (left = len; left >= 8; left -= 8, s += 8)
 	{
-		if (hashp->hash == hash
-			&& strcmp(hashp->string, string) == 0)
-			return hashp;
+		memcpy(&word, s, 8);
+		hash = (hash ^ word) * 0x9fb21c651e98df25ull;
+		hash ^= hash >> 28;
 	}
-
-	if (!create)
-		return NULL;
-
-	if (copy)
+	if (left != 0)
 	{
-		char* new_string;
-
-		new_string = (char*)objalloc_alloc((struct objalloc*)table->memory,
-			len + 1);
-		if (!new_string)
-		{
-			bfd_set_error(bfd_error_no_memory);
-			return NULL;
-		}
-		memcpy(new_string, string, len + 1);
-		string = new_string;
+		word = 0;
+		memcpy(&word, s, left);
+		hash = (hash ^ word) * 0x9fb21c651e98df25ull;
+		hash ^= hash >> 28;
 	}
+	hash ^= hash >> 32;
+	hash *= 0xd6e8feb86659fd93ull;
+	hash ^= hash >> 32;
+	if (lenp != NULL)
+		*lenp = len;
+	return hash;
+}
 
-	return bfd_hash_insert(table, string, hash);
+/* Hash STRING for TABLE.  */
+
+static inline unsigned long long
+bfd_hash_table_hash(struct bfd_hash_table* table, const char* string,
+	unsigned int* lenp)
+{
+	if (table->wide_hash)
+		return bfd_hash_hash_wide(string, lenp);
+	return bfd_hash_hash(string, lenp);
 }
 
 /*
 FUNCTION
-	bfd_hash_insert
+	bfd_hash_table_set_function
 
 SYNOPSIS
-	struct bfd_hash_entry *bfd_hash_insert
-	  (struct bfd_hash_table *,
-	   const char *,
-	   unsigned long long {*hash*});
+	bool bfd_hash_table_set_function
+	  (struct bfd_hash_table *, enum bfd_hash_function);
 
 DESCRIPTION
-	Insert an entry in a hash table.
+	Choose the function used to hash strings in an empty table.
+	Tables start out with <<bfd_hash_classic>>, which keeps the
+	order that <<bfd_hash_traverse>> visits entries in unchanged.
+	Tables that are only looked up may use <<bfd_hash_wide>>
+	instead, which is much faster for long strings.  Return
+	<<FALSE>> if the table already has entries.
 */
 
-struct bfd_hash_entry*
-	bfd_hash_insert(struct bfd_hash_table* table,
-		const char* string,
-		unsigned long long hash)
+bool
+bfd_hash_table_set_function(struct bfd_hash_table* table,
+	enum bfd_hash_function func)
 {
-	struct bfd_hash_entry* hashp;
-	unsigned int _index;
-
-	hashp = (*table->newfunc) (NULL, table, string);
-	if (hashp == NULL)
-		return NULL;
-	hashp->string = string;
-	hashp->hash = hash;
-	_index = hash % table->size;
-	hashp->next = table->table[_index];
-	table->table[_index] = hashp;
-	table->count++;
-
-	if (!table->frozen && table->count > table->size * 3 / 4)
+	if (table->count != 0)
 	{
-		unsigned long long newsize = higher_prime_number(table->size);
-		struct bfd_hash_entry** newtable;
-		unsigned int hi;
-		unsigned long long alloc = newsize * sizeof(struct bfd_hash_entry*);
-
-		/* If we can't find a higher prime, or we can't possibly alloc
-	   that much memory, don't try to grow the table.  */
-		if (newsize == 0 || alloc / sizeof(struct bfd_hash_entry*) != newsize)
-		{
-			table->frozen = 1;
-			return hashp;
-		}
-
-		newtable = ((struct bfd_hash_entry**)
-			objalloc_alloc((struct objalloc*)table->memory, alloc));
-		if (newtable == NULL)
-		{
-			table->frozen = 1;
-			return hashp;
-		}
-		memset(newtable, 0, alloc);
-
-		for (hi = 0; hi < table->size; hi++)
-			while (table->table[hi])
-			{
-				struct bfd_hash_entry* chain = table->table[hi];
-				struct bfd_hash_entry* chain_end = chain;
-
-				while (chain_end->next && chain_end->next->hash == chain->hash)
-					chain_end = chain_end->next;
-
-				table->table[hi] = chain_end->next;
-				_index = chain->hash % newsize;
-				chain_end->next = newtable[_index];
-				newtable[_index] = chain;
-			}
-		table->table = newtable;
-		table->size = newsize;
+		bfd_set_error(bfd_error_invalid_operation);
+		return false;
 	}
-
-	return hashp;
+	table->wide_hash = func == bfd_hash_wide;
+	return true;
 }
 
 /*
 FUNCTION
-	bfd_hash_rename
+	bfd_hash_table_set_memory_class
 
 SYNOPSIS
-	void bfd_hash_rename (struct bfd_hash_table *,
-				  const char *,
-				  struct bfd_hash_entry *);
+	void bfd_hash_table_set_memory_class
+	  (struct bfd_hash_table *, enum bfd_memory_class);
 
 DESCRIPTION
-	Rename an entry in a hash table.
+	Count the memory of a table, including what it already holds,
+	in the given class when memory accounting is on.  Tables start
+	out in <<bfd_memory_hash>>.
 */
 
 void
-bfd_hash_rename(struct bfd_hash_table* table,
-	const char* string,
-	struct bfd_hash_entry* ent)
+bfd_hash_table_set_memory_class(struct bfd_hash_table* table,
+	enum bfd_memory_class cls)
 {
-	unsigned int _index;
-	struct bfd_hash_entry** pph;
-
-	_index = ent->hash % table->size;
-	for (pph = &table->table[_index]; *pph != NULL; pph = &(*pph)->next)
-		if (*pph == ent)
-			break;
-	if (*pph == NULL)
-		abort();
-
-	*pph = ent->next;
-	ent->string = string;
-	ent->hash = bfd_hash_hash(string, NULL);
-	_index = ent->hash % table->size;
-	ent->next = table->table[_index];
-	table->table[_index] = ent;
+	if (table->memory_used != 0)
+	{
+		_bfd_memory_account(NULL, table->memory_class,
+			-(bfd_signed_vma)table->memory_used);
+		_bfd_memory_account(NULL, cls, table->memory_used);
+	}
+	table->memory_class = cls;
 }
 
-/*
-FUNCTION
-	bfd_hash_replace
+/* The open-addressed index.  Slots come in groups of FLAT_GROUP, and
+   each slot has a control byte holding seven bits of its hash code,
+   so that a whole group can be checked with a single compare before
+   any entry is touched.  The entries themselves stay on their bucket
+   chains, which are still what bfd_hash_traverse walks, so the index
+   does not change the order entries are visited in.  */
 
-SYNOPSIS
-	void bfd_hash_replace (struct bfd_hash_table *,
-				   struct bfd_hash_entry * {*old*},
-				   struct bfd_hash_entry * {*new*});
+#define FLAT_GROUP 16
+#define FLAT_EMPTY 0x80
+#define FLAT_DELETED 0xfe
 
-DESCRIPTION
-	Replace an entry in a hash table.
-*/
+struct bfd_hash_flat_slot
+{
+	unsigned long long hash;
+	struct bfd_hash_entry* entry;
+};
 
-void
-bfd_hash_replace(struct bfd_hash_table* table,
-	struct bfd_hash_entry* old,
-	struct bfd_hash_entry* nw)
+struct bfd_hash_flat
 {
-	unsigned int _index;
-	struct bfd_hash_entry** pph;
+	/* The number of groups less one.  The number of groups is a
+	   power of two.  */
+	size_t mask;
+	/* The number of slots holding an entry.  */
+	size_t used;
+	/* The number of slots whose entry was removed.  */
+	size_t deleted;
+	struct bfd_hash_flat_slot* slots;
+	unsigned char* ctrl;
+};
 
-	_index = old->hash % table->size;
-	for (pph = &table->table[_index];
-		(*pph) != NULL;
-		pph = &(*pph)->next)
-	{
-		if (*pph == old)
-		{
-			*pph = nw;
-			return;
-		}
-	}
+/* Spread HASH, which for bfd_hash_classic is weak in its high bits,
+   over all 64 bits.  */
 
-	abort();
+static inline unsigned long long
+flat_mix(unsigned long long hash)
+{
+	hash *= 0x9e3779b97f4a7c15ull;
+	return hash ^ (hash >> 29);
 }
 
-/*
-FUNCTION
-	bfd_hash_allocate
+/* The control byte for a slot holding MIX.  */
 
-SYNOPSIS
-	void *bfd_hash_allocate (struct bfd_hash_table *,
-				 unsigned int {*size*});
+static inline unsigned char
+flat_tag(unsigned long long mix)
+{
+	return (unsigned char)(mix >> 57);
+}
 
-DESCRIPTION
-	Allocate space in a hash table.
-*/
+/* Return a mask with bit I set if byte I of the group at CTRL is
+   BYTE.  */
 
-void*
-bfd_hash_allocate(struct bfd_hash_table* table,
-	unsigned int size)
+static inline unsigned int
+flat_match(const unsigned char* ctrl, unsigned char byte)
 {
-	void* ret;
-
-	ret = objalloc_alloc((struct objalloc*)table->memory, size);
-	if (ret == NULL && size != 0)
-		bfd_set_error(bfd_error_no_memory);
-	return ret;
-}
+#ifdef HAVE_SSE2_GROUPS
+	__m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+	__m128i want = _mm_set1_epi8((char)byte);
 
-/*
-FUNCTION
-	bfd_hash_newfunc
+	return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(group, want));
+#else
+	unsigned int bits = 0;
+	unsigned int i;
 
-SYNOPSIS
-	struct bfd_hash_entry *bfd_hash_newfunc
-	  (struct bfd_hash_entry *,
-	   struct bfd_hash_table *,
-	   const char *);
+	for (i = 0; i < FLAT_GROUP; i++)
+		if (ctrl[i] == byte)
+			bits |= 1u << i;
+	return bits;
+#endif
+}
 
-DESCRIPTION
-	Base method for creating a new hash table entry.
-*/
+/* Return a mask of the free slots, empty or deleted, in the group at
+   CTRL.  */
 
-struct bfd_hash_entry*
-	bfd_hash_newfunc(struct bfd_hash_entry* entry,
-		struct bfd_hash_table* table,
-		const char* string ATTRIBUTE_UNUSED)
+static inline unsigned int
+flat_match_free(const unsigned char* ctrl)
 {
-	if (entry == NULL)
-		entry = (struct bfd_hash_entry*)bfd_hash_allocate(table,
-			sizeof(*entry));
-	return entry;
-}
+#ifdef HAVE_SSE2_GROUPS
+	__m128i group = _mm_loadu_si128((const __m128i*)ctrl);
 
-/*
-FUNCTION
-	bfd_hash_traverse
+	return (unsigned int)_mm_movemask_epi8(group);
+#else
+	unsigned int bits = 0;
+	unsigned int i;
 
-SYNOPSIS
-	void bfd_hash_traverse
-	  (struct bfd_hash_table *,
-	   bool (*) (struct bfd_hash_entry *, void *),
-	   void *);
+	for (i = 0; i < FLAT_GROUP; i++)
+		if (ctrl[i] & 0x80)
+			bits |= 1u << i;
+	return bits;
+#endif
+}
 
-DESCRIPTION
-	Traverse a hash table.
-*/
+/* Allocate an empty index with NGROUPS groups.  */
 
-void
-bfd_hash_traverse(struct bfd_hash_table* table,
-	bool (*func) (struct bfd_hash_entry*, void*),
-	void* info)
+static struct bfd_hash_flat*
+flat_alloc(size_t ngroups)
 {
-	unsigned int i;
+	struct bfd_hash_flat* flat;
+	size_t nslots = ngroups * FLAT_GROUP;
+	bfd_size_type amt;
 
-	table->frozen = 1;
-	for (i = 0; i < table->size; i++)
+	if (nslots > (((size_t)-1 - sizeof(*flat))
+		/ (sizeof(*flat->slots) + 1)))
 	{
-		struct bfd_hash_entry* p;
-
-		for (p = table->table[i]; p != NULL; p = p->next)
-			if (!(*func) (p, info))
-				goto out;
+		bfd_set_error(bfd_error_no_memory);
+		return NULL;
 	}
-out:
-	table->frozen = 0;
+	amt = sizeof(*flat) + nslots * (sizeof(*flat->slots) + 1);
+	flat = (struct bfd_hash_flat*)bfd_malloc(amt);
+	if (flat == NULL)
+		return NULL;
+	flat->mask = ngroups - 1;
+	flat->used = 0;
+	flat->deleted = 0;
+	flat->slots = (struct bfd_hash_flat_slot*)(flat + 1);
+	flat->ctrl = (unsigned char*)(flat->slots + nslots);
+	memset(flat->ctrl, FLAT_EMPTY, nslots);
+	return flat;
 }
 
-/*
-FUNCTION
-	bfd_hash_set_default_size
+/* Put ENTRY, which must not already be present, into FLAT.  FLAT must
+   have a free slot.  */
 
-SYNOPSIS
+static void
+flat_put(struct bfd_hash_flat* flat, struct bfd_hash_entry* entry)
+{
+	unsigned long long mix = flat_mix(entry->hash);
+	size_t group = (size_t)mix & flat->mask;
+	size_t step = 0;
+
+	for (;;)
+	{
+		unsigned char* ctrl = flat->ctrl + group * FLAT_GROUP;
+		unsigned int bits = flat_match_free(ctrl);
+
+		if (bits != 0)
+		{
+			size_t i = group * FLAT_GROUP + (ffs((int)bits) - 1);
+
+			if (flat->ctrl[i] == FLAT_DELETED)
+				flat->deleted--;
+			flat->ctrl[i] = flat_tag(mix);
+			flat->slots[i].hash = entry->hash;
+			flat->slots[i].entry = entry;
+			flat->used++;
+			return;
+		}
+		group = (group + ++step) & flat->mask;
+	}
+}
+
+/* Return an index for the entries of TABLE with room for at least
+   COUNT entries, or NULL if out of memory.  */
+
+static struct bfd_hash_flat*
+flat_build(struct bfd_hash_table* table, size_t count)
+{
+	struct bfd_hash_flat* flat;
+	size_t ngroups = 1;
+	unsigned int i;
+
+	/* Keep the index at most half full, so that it can take as many
+	   entries again before it is rebuilt.  */
+	while (ngroups * FLAT_GROUP < count * 2)
+		ngroups *= 2;
+
+	flat = flat_alloc(ngroups);
+	if (flat == NULL)
+		return NULL;
+	for (i = 0; i < table->size; i++)
+	{
+		struct bfd_hash_entry* p;
+
+		for (p = table->table[i]; p != NULL; p = p->next)
+			flat_put(flat, p);
+	}
+	return flat;
+}
+
+/* Find the entry for STRING, whose hash code is HASH, in FLAT.  */
+
+static inline struct bfd_hash_entry*
+flat_lookup(const struct bfd_hash_flat* flat, const char* string,
+	unsigned long long hash)
+{
+	unsigned long long mix = flat_mix(hash);
+	unsigned char tag = flat_tag(mix);
+	size_t group = (size_t)mix & flat->mask;
+	size_t step = 0;
+
+	for (;;)
+	{
+		const unsigned char* ctrl = flat->ctrl + group * FLAT_GROUP;
+		unsigned int bits = flat_match(ctrl, tag);
+
+		while (bits != 0)
+		{
+			unsigned int bit = ffs((int)bits) - 1;
+			const struct bfd_hash_flat_slot* slot;
+
+			slot = &flat->slots[group * FLAT_GROUP + bit];
+			if (slot->hash == hash
+				&& (slot->entry->string == string
+					|| strcmp(slot->entry->string, string) == 0))
+				return slot->entry;
+			bits &= bits - 1;
+		}
+		if (flat_match(ctrl, FLAT_EMPTY) != 0)
+			return NULL;
+		group = (group + ++step) & flat->mask;
+	}
+}
+
+/* Return the slot in FLAT that holds ENTRY, or -1 if it isn't there.  */
+
+static ptrdiff_t
+flat_find_entry(const struct bfd_hash_flat* flat,
+	const struct bfd_hash_entry* entry)
+{
+	unsigned long long mix = flat_mix(entry->hash);
+	unsigned char tag = flat_tag(mix);
+	size_t group = (size_t)mix & flat->mask;
+	size_t step = 0;
+
+	for (;;)
+	{
+		const unsigned char* ctrl = flat->ctrl + group * FLAT_GROUP;
+		unsigned int bits = flat_match(ctrl, tag);
+
+		while (bits != 0)
+		{
+			size_t i = group * FLAT_GROUP + (ffs((int)bits) - 1);
+
+			if (flat->slots[i].entry == entry)
+				return (ptrdiff_t)i;
+			bits &= bits - 1;
+		}
+		if (flat_match(ctrl, FLAT_EMPTY) != 0)
+			return -1;
+		group = (group + ++step) & flat->mask;
+	}
+}
+
+/* Add ENTRY, just put on its chain, to the index of TABLE.  If the
+   index cannot grow it is dropped, leaving lookups to the chains.  */
+
+static void
+flat_insert(struct bfd_hash_table* table, struct bfd_hash_entry* entry)
+{
+	struct bfd_hash_flat* flat = table->flat;
+	size_t nslots = (flat->mask + 1) * FLAT_GROUP;
+
+	/* Keep one slot in eight empty so that probes terminate quickly.
+	   TABLE->count already includes ENTRY, so rebuilding picks it up
+	   from its chain.  */
+	if (flat->used + flat->deleted + 1 > nslots - nslots / 8)
+	{
+		if (table->stats != NULL)
+			table->stats->index_rebuilds++;
+		table->flat = flat_build(table, table->count);
+		free(flat);
+		return;
+	}
+	flat_put(flat, entry);
+}
+
+/* Remove ENTRY from the index of TABLE.  */
+
+static void
+flat_remove(struct bfd_hash_table* table, struct bfd_hash_entry* entry)
+{
+	struct bfd_hash_flat* flat = table->flat;
+	ptrdiff_t i = flat_find_entry(flat, entry);
+
+	if (i < 0)
+		abort();
+	flat->ctrl[i] = FLAT_DELETED;
+	flat->used--;
+	flat->deleted++;
+}
+
+/*
+FUNCTION
+	bfd_hash_table_set_layout
+
+SYNOPSIS
+	bool bfd_hash_table_set_layout
+	  (struct bfd_hash_table *, enum bfd_hash_layout);
+
+DESCRIPTION
+	Choose how lookups in a table find their entries.  With
+	<<bfd_hash_open>>, the hash code and address of each entry are
+	also kept in an open-addressed index, so that a lookup compares
+	a group of hash codes at once and only touches entries whose
+	hash matches.  The entry structures are unchanged, so any
+	table may switch layout without its <<newfunc>> knowing.  This
+	may be called at any time; calling it with <<bfd_hash_open>>
+	on a table that already has an index rebuilds the index from
+	the bucket chains, which is needed after the caller has rolled
+	back the chains by hand.  Return <<FALSE>> if the index could
+	not be allocated, in which case the table is left chained.
+	A table in concurrent mode can only be chained.
+*/
+
+bool
+bfd_hash_table_set_layout(struct bfd_hash_table* table,
+	enum bfd_hash_layout layout)
+{
+	if (table->locks != NULL && layout != bfd_hash_chained)
+	{
+		bfd_set_error(bfd_error_invalid_operation);
+		return false;
+	}
+	free(table->flat);
+	table->flat = NULL;
+	if (layout == bfd_hash_chained)
+		return true;
+	table->flat = flat_build(table, table->count);
+	return table->flat != NULL;
+}
+
+/* The locks of a table in concurrent mode.  Bucket I of the table is
+   guarded by STRIPES[I % NSTRIPES].  ALLOC guards the table's objalloc
+   and calls of its newfunc.  Growing the table takes every stripe, in
+   order, and then ALLOC.  */
+
+struct bfd_hash_locks
+{
+	unsigned int nstripes;
+	bfd_mutex alloc;
+	bfd_mutex stripes[1];
+};
+
+/* The most stripes a table may have.  */
+#define MAX_STRIPES 4096
+
+static void
+bfd_hash_lock_all(struct bfd_hash_table* table)
+{
+	unsigned int i;
+
+	for (i = 0; i < table->locks->nstripes; i++)
+		_bfd_mutex_lock(&table->locks->stripes[i]);
+}
+
+static void
+bfd_hash_unlock_all(struct bfd_hash_table* table)
+{
+	unsigned int i;
+
+	for (i = table->locks->nstripes; i-- > 0;)
+		_bfd_mutex_unlock(&table->locks->stripes[i]);
+}
+
+/* Lock the stripe guarding the bucket for HASH, and return that
+   bucket's index.  The table may grow while we wait for the lock, so
+   check that the index is still right once we have it.  */
+
+static unsigned int
+bfd_hash_lock_bucket(struct bfd_hash_table* table, unsigned long long hash,
+	bfd_mutex** lockp)
+{
+	for (;;)
+	{
+		unsigned int size = _bfd_atomic_load((const int*)&table->size);
+		unsigned int _index = hash % size;
+		bfd_mutex* lock;
+
+		lock = &table->locks->stripes[_index % table->locks->nstripes];
+		_bfd_mutex_lock(lock);
+		if (table->size == size)
+		{
+			*lockp = lock;
+			return _index;
+		}
+		_bfd_mutex_unlock(lock);
+	}
+}
+
+/*
+FUNCTION
+	bfd_hash_table_set_concurrent
+
+SYNOPSIS
+	bool bfd_hash_table_set_concurrent
+	  (struct bfd_hash_table *, unsigned int {*stripes*});
+
+DESCRIPTION
+	With a non-zero @var{stripes}, let several threads call
+	<<bfd_hash_lookup>>, and so <<bfd_link_hash_lookup>>, on the
+	table at once, whether or not they create entries.  The
+	buckets are shared out between @var{stripes} locks so that
+	threads working on different buckets rarely wait for each
+	other.  Only the table itself is protected: threads given the
+	same entry must still agree on who changes its contents.
+	<<bfd_hash_traverse>> and the other functions that walk the
+	table must not run while lookups are in progress.  A table in
+	concurrent mode has no open-addressed index.  With zero
+	@var{stripes}, put the table back in single threaded mode.
+	Return <<FALSE>> if the locks could not be allocated.
+*/
+
+bool
+bfd_hash_table_set_concurrent(struct bfd_hash_table* table,
+	unsigned int stripes)
+{
+	struct bfd_hash_locks* locks = table->locks;
+	bfd_size_type amt;
+	unsigned int i;
+
+	if (locks != NULL)
+	{
+		_bfd_mutex_destroy(&locks->alloc);
+		for (i = 0; i < locks->nstripes; i++)
+			_bfd_mutex_destroy(&locks->stripes[i]);
+		free(locks);
+		table->locks = NULL;
+	}
+	if (stripes == 0)
+		return true;
+	if (stripes > MAX_STRIPES)
+		stripes = MAX_STRIPES;
+
+	amt = offsetof(struct bfd_hash_locks, stripes);
+	amt += stripes * sizeof(bfd_mutex);
+	locks = (struct bfd_hash_locks*)bfd_zmalloc(amt);
+	if (locks == NULL)
+		return false;
+	locks->nstripes = stripes;
+	free(table->flat);
+	table->flat = NULL;
+	table->locks = locks;
+	return true;
+}
+
+/* Move the entries of TABLE into a new hash array of NEWSIZE
+   buckets.  Return FALSE, leaving TABLE as it was, if NEWSIZE is
+   zero or the array could not be allocated.  */
+
+static bool
+bfd_hash_resize(struct bfd_hash_table* table, unsigned long long newsize)
+{
+	struct bfd_hash_entry** newtable;
+	unsigned int hi;
+	unsigned int _index;
+	unsigned long long alloc = newsize * sizeof(struct bfd_hash_entry*);
+
+	if (newsize == 0 || alloc / sizeof(struct bfd_hash_entry*) != newsize)
+		return false;
+
+	newtable = ((struct bfd_hash_entry**)
+		objalloc_alloc((struct objalloc*)table->memory, alloc));
+	if (newtable == NULL)
+		return false;
+	bfd_hash_account(table, alloc);
+	memset(newtable, 0, alloc);
+
+	for (hi = 0; hi < table->size; hi++)
+		while (table->table[hi])
+		{
+			struct bfd_hash_entry* chain = table->table[hi];
+			struct bfd_hash_entry* chain_end = chain;
+
+			while (chain_end->next && chain_end->next->hash == chain->hash)
+				chain_end = chain_end->next;
+
+			table->table[hi] = chain_end->next;
+			_index = chain->hash % newsize;
+			chain_end->next = newtable[_index];
+			newtable[_index] = chain;
+		}
+	table->table = newtable;
+	table->size = newsize;
+	if (table->stats != NULL)
+		table->stats->resizes++;
+	return true;
+}
+
+/* Grow the hash array of TABLE.  */
+
+static void
+bfd_hash_grow(struct bfd_hash_table* table)
+{
+	/* If we can't find a higher prime, or we can't possibly alloc
+	   that much memory, don't try to grow the table.  */
+	if (!bfd_hash_resize(table, higher_prime_number(table->size)))
+		table->frozen = 1;
+}
+
+/*
+FUNCTION
+	bfd_hash_table_reserve
+
+SYNOPSIS
+	bool bfd_hash_table_reserve
+	  (struct bfd_hash_table *, unsigned int {*count*});
+
+DESCRIPTION
+	Make the hash array of a table big enough to hold @var{count}
+	entries without growing, so that a caller about to insert
+	that many entries rehashes the table at most once.  Like
+	<<bfd_hash_traverse>>, this must not run while lookups are in
+	progress.  Return <<FALSE>> if the array could not be
+	allocated, in which case the table is left as it was and still
+	grows as entries are added.
+*/
+
+bool
+bfd_hash_table_reserve(struct bfd_hash_table* table, unsigned int count)
+{
+	unsigned long long newsize = table->size;
+
+	if (table->frozen)
+		return true;
+	while (count > newsize * 3 / 4)
+	{
+		newsize = higher_prime_number(newsize);
+		if (newsize == 0)
+		{
+			bfd_set_error(bfd_error_no_memory);
+			return false;
+		}
+	}
+	if (newsize == table->size)
+		return true;
+	if (!bfd_hash_resize(table, newsize))
+	{
+		bfd_set_error(bfd_error_no_memory);
+		return false;
+	}
+	return true;
+}
+
+/* The LEN passed to a lookup when the length of the string is not
+   known.  */
+#define NO_LEN ((size_t)-1)
+
+/* bfd_hash_lookup for a table in concurrent mode.  */
+
+static struct bfd_hash_entry*
+bfd_hash_lookup_locked(struct bfd_hash_table* table,
+	const char* string,
+	unsigned long long hash,
+	size_t len,
+	bool create,
+	bool copy,
+	struct bfd_hash_stats* stats)
+{
+	struct bfd_hash_locks* locks = table->locks;
+	struct bfd_hash_entry* hashp;
+	unsigned int _index;
+	unsigned int count;
+	unsigned int size;
+	bfd_mutex* lock;
+
+	_index = bfd_hash_lock_bucket(table, hash, &lock);
+	for (hashp = table->table[_index];
+		hashp != NULL;
+		hashp = hashp->next)
+	{
+		if (stats != NULL)
+			stats->probes++;
+		if (hashp->hash == hash
+			&& (hashp->string == string
+				|| strcmp(hashp->string, string) == 0))
+		{
+			if (stats != NULL)
+				stats->hits++;
+			_bfd_mutex_unlock(lock);
+			return hashp;
+		}
+	}
+
+	if (!create)
+	{
+		_bfd_mutex_unlock(lock);
+		return NULL;
+	}
+
+	_bfd_mutex_lock(&locks->alloc);
+	if (copy)
+	{
+		char* new_string;
+
+		if (len == NO_LEN)
+			len = strlen(string);
+		new_string = (char*)objalloc_alloc((struct objalloc*)table->memory,
+			len + 1);
+		if (!new_string)
+		{
+			_bfd_mutex_unlock(&locks->alloc);
+			_bfd_mutex_unlock(lock);
+			bfd_set_error(bfd_error_no_memory);
+			return NULL;
+		}
+		bfd_hash_account(table, len + 1);
+		memcpy(new_string, string, len + 1);
+		string = new_string;
+	}
+	hashp = (*table->newfunc) (NULL, table, string);
+	_bfd_mutex_unlock(&locks->alloc);
+	if (hashp == NULL)
+	{
+		_bfd_mutex_unlock(lock);
+		return NULL;
+	}
+	hashp->string = string;
+	hashp->hash = hash;
+	hashp->next = table->table[_index];
+	table->table[_index] = hashp;
+	count = _bfd_atomic_add((int*)&table->count, 1);
+	size = table->size;
+	if (stats != NULL)
+		stats->inserts++;
+	_bfd_mutex_unlock(lock);
+
+	if (!table->frozen && count > size * 3 / 4)
+	{
+		bfd_hash_lock_all(table);
+		_bfd_mutex_lock(&locks->alloc);
+		if (!table->frozen && table->count > table->size * 3 / 4)
+			bfd_hash_grow(table);
+		_bfd_mutex_unlock(&locks->alloc);
+		bfd_hash_unlock_all(table);
+	}
+
+	return hashp;
+}
+
+/* The body of bfd_hash_lookup.  HASH is the hash code of STRING, and
+   LEN its length if known or NO_LEN if not.  STATS is the table's
+   counters, or NULL if it keeps none.  */
+
+static inline struct bfd_hash_entry*
+bfd_hash_lookup_1(struct bfd_hash_table* table,
+	const char* string,
+	unsigned long long hash,
+	size_t len,
+	bool create,
+	bool copy,
+	struct bfd_hash_stats* stats)
+{
+	struct bfd_hash_entry* hashp;
+	unsigned int _index;
+
+	if (table->locks != NULL)
+		return bfd_hash_lookup_locked(table, string, hash, len,
+			create, copy, stats);
+
+	if (table->flat != NULL)
+	{
+		hashp = flat_lookup(table->flat, string, hash);
+		if (hashp != NULL)
+		{
+			if (stats != NULL)
+				stats->hits++;
+			return hashp;
+		}
+	}
+	else
+	{
+		unsigned int probes = 0;
+
+		_index = hash % table->size;
+		for (hashp = table->table[_index];
+			hashp != NULL;
+			hashp = hashp->next)
+		{
+			probes++;
+			if (hashp->hash == hash
+				&& (hashp->string == string
+					|| strcmp(hashp->string, string) == 0))
+				break;
+		}
+		if (stats != NULL)
+		{
+			stats->probes += probes;
+			if (hashp != NULL)
+				stats->hits++;
+		}
+		if (hashp != NULL)
+			return hashp;
+	}
+
+	if (!create)
+		return NULL;
+
+	if (copy)
+	{
+		char* new_string;
+
+		if (len == NO_LEN)
+			len = strlen(string);
+		new_string = (char*)objalloc_alloc((struct objalloc*)table->memory,
+			len + 1);
+		if (!new_string)
+		{
+			bfd_set_error(bfd_error_no_memory);
+			return NULL;
+		}
+		bfd_hash_account(table, len + 1);
+		memcpy(new_string, string, len + 1);
+		string = new_string;
+	}
+
+	return bfd_hash_insert(table, string, hash);
+}
+
+/*
+FUNCTION
+	bfd_hash_lookup
+
+SYNOPSIS
+	struct bfd_hash_entry *bfd_hash_lookup
+	  (struct bfd_hash_table *, const char *,
+	   bool {*create*}, bool {*copy*});
+
+DESCRIPTION
+	Look up a string in a hash table.
+*/
+
+struct bfd_hash_entry*
+	bfd_hash_lookup(struct bfd_hash_table* table,
+		const char* string,
+		bool create,
+		bool copy)
+{
+	struct bfd_hash_stats* stats = table->stats;
+	struct bfd_hash_entry* hashp;
+	unsigned long long start;
+	unsigned long long hash;
+	unsigned int len;
+
+	if (stats == NULL)
+	{
+		hash = bfd_hash_table_hash(table, string, &len);
+		return bfd_hash_lookup_1(table, string, hash, len, create, copy,
+			NULL);
+	}
+
+	start = bfd_hash_clock();
+	hash = bfd_hash_table_hash(table, string, &len);
+	hashp = bfd_hash_lookup_1(table, string, hash, len, create, copy,
+		stats);
+	stats->lookups++;
+	stats->lookup_ns += bfd_hash_clock() - start;
+	return hashp;
+}
+
+/*
+FUNCTION
+	bfd_hash_lookup_with_hash
+
+SYNOPSIS
+	struct bfd_hash_entry *bfd_hash_lookup_with_hash
+	  (struct bfd_hash_table *, const char *,
+	   unsigned long long {*hash*}, bool {*create*}, bool {*copy*});
+
+DESCRIPTION
+	Like <<bfd_hash_lookup>>, but use @var{hash} as the hash code
+	of the string instead of computing it.  @var{hash} must be
+	what <<bfd_hash_string_hash>> gives for the string and this
+	table's hash function, or the <<hash>> of an entry for the
+	same string in a table with the same function, so that a name
+	passed from one table to another is only hashed once.
+*/
+
+struct bfd_hash_entry*
+	bfd_hash_lookup_with_hash(struct bfd_hash_table* table,
+		const char* string,
+		unsigned long long hash,
+		bool create,
+		bool copy)
+{
+	struct bfd_hash_stats* stats = table->stats;
+	struct bfd_hash_entry* hashp;
+	unsigned long long start;
+
+	if (stats == NULL)
+		return bfd_hash_lookup_1(table, string, hash, NO_LEN, create, copy,
+			NULL);
+
+	start = bfd_hash_clock();
+	hashp = bfd_hash_lookup_1(table, string, hash, NO_LEN, create, copy,
+		stats);
+	stats->lookups++;
+	stats->lookup_ns += bfd_hash_clock() - start;
+	return hashp;
+}
+
+/*
+FUNCTION
+	bfd_hash_string_hash
+
+SYNOPSIS
+	unsigned long long bfd_hash_string_hash
+	  (const char *, enum bfd_hash_function);
+
+DESCRIPTION
+	Return the hash code of a string under a hash function, for
+	use with <<bfd_hash_lookup_with_hash>>.
+*/
+
+unsigned long long
+bfd_hash_string_hash(const char* string, enum bfd_hash_function func)
+{
+	if (func == bfd_hash_wide)
+		return bfd_hash_hash_wide(string, NULL);
+	return bfd_hash_hash(string, NULL);
+}
+
+/*
+FUNCTION
+	bfd_hash_table_function
+
+SYNOPSIS
+	enum bfd_hash_function bfd_hash_table_function
+	  (const struct bfd_hash_table *);
+
+DESCRIPTION
+	Return the hash function a table uses.
+*/
+
+enum bfd_hash_function
+bfd_hash_table_function(const struct bfd_hash_table* table)
+{
+	return table->wide_hash ? bfd_hash_wide : bfd_hash_classic;
+}
+
+/*
+FUNCTION
+	bfd_hash_insert
+
+SYNOPSIS
+	struct bfd_hash_entry *bfd_hash_insert
+	  (struct bfd_hash_table *,
+	   const char *,
+	   unsigned long long {*hash*});
+
+DESCRIPTION
+	Insert an entry in a hash table.
+*/
+
+struct bfd_hash_entry*
+	bfd_hash_insert(struct bfd_hash_table* table,
+		const char* string,
+		unsigned long long hash)
+{
+	struct bfd_hash_entry* hashp;
+	unsigned int _index;
+	unsigned long long start = 0;
+
+	if (table->stats != NULL)
+		start = bfd_hash_clock();
+	hashp = (*table->newfunc) (NULL, table, string);
+	if (hashp == NULL)
+		return NULL;
+	hashp->string = string;
+	hashp->hash = hash;
+	_index = hash % table->size;
+	hashp->next = table->table[_index];
+	table->table[_index] = hashp;
+	table->count++;
+	if (table->flat != NULL)
+		flat_insert(table, hashp);
+
+	if (!table->frozen && table->count > table->size * 3 / 4)
+		bfd_hash_grow(table);
+
+	if (table->stats != NULL)
+	{
+		table->stats->inserts++;
+		table->stats->insert_ns += bfd_hash_clock() - start;
+	}
+	return hashp;
+}
+
+/*
+FUNCTION
+	bfd_hash_rename
+
+SYNOPSIS
+	void bfd_hash_rename (struct bfd_hash_table *,
+				  const char *,
+				  struct bfd_hash_entry *);
+
+DESCRIPTION
+	Rename an entry in a hash table.
+*/
+
+void
+bfd_hash_rename(struct bfd_hash_table* table,
+	const char* string,
+	struct bfd_hash_entry* ent)
+{
+	unsigned int _index;
+	struct bfd_hash_entry** pph;
+
+	if (table->locks != NULL)
+		bfd_hash_lock_all(table);
+	_index = ent->hash % table->size;
+	for (pph = &table->table[_index]; *pph != NULL; pph = &(*pph)->next)
+		if (*pph == ent)
+			break;
+	if (*pph == NULL)
+		abort();
+
+	*pph = ent->next;
+	if (table->flat != NULL)
+		flat_remove(table, ent);
+	ent->string = string;
+	ent->hash = bfd_hash_table_hash(table, string, NULL);
+	_index = ent->hash % table->size;
+	ent->next = table->table[_index];
+	table->table[_index] = ent;
+	if (table->flat != NULL)
+		flat_put(table->flat, ent);
+	if (table->locks != NULL)
+		bfd_hash_unlock_all(table);
+}
+
+/*
+FUNCTION
+	bfd_hash_replace
+
+SYNOPSIS
+	void bfd_hash_replace (struct bfd_hash_table *,
+				   struct bfd_hash_entry * {*old*},
+				   struct bfd_hash_entry * {*new*});
+
+DESCRIPTION
+	Replace an entry in a hash table.
+*/
+
+void
+bfd_hash_replace(struct bfd_hash_table* table,
+	struct bfd_hash_entry* old,
+	struct bfd_hash_entry* nw)
+{
+	unsigned int _index;
+	struct bfd_hash_entry** pph;
+
+	if (table->locks != NULL)
+		bfd_hash_lock_all(table);
+	_index = old->hash % table->size;
+	for (pph = &table->table[_index];
+		(*pph) != NULL;
+		pph = &(*pph)->next)
+	{
+		if (*pph == old)
+		{
+			*pph = nw;
+			if (table->flat != NULL)
+			{
+				ptrdiff_t i = flat_find_entry(table->flat, old);
+
+				if (i < 0)
+					abort();
+				table->flat->slots[i].entry = nw;
+			}
+			if (table->locks != NULL)
+				bfd_hash_unlock_all(table);
+			return;
+		}
+	}
+
+	abort();
+}
+
+/*
+FUNCTION
+	bfd_hash_allocate
+
+SYNOPSIS
+	void *bfd_hash_allocate (struct bfd_hash_table *,
+				 unsigned int {*size*});
+
+DESCRIPTION
+	Allocate space in a hash table.
+*/
+
+void*
+bfd_hash_allocate(struct bfd_hash_table* table,
+	unsigned int size)
+{
+	void* ret;
+
+	ret = objalloc_alloc((struct objalloc*)table->memory, size);
+	if (ret == NULL && size != 0)
+		bfd_set_error(bfd_error_no_memory);
+	else
+		bfd_hash_account(table, size);
+	return ret;
+}
+
+/*
+FUNCTION
+	bfd_hash_newfunc
+
+SYNOPSIS
+	struct bfd_hash_entry *bfd_hash_newfunc
+	  (struct bfd_hash_entry *,
+	   struct bfd_hash_table *,
+	   const char *);
+
+DESCRIPTION
+	Base method for creating a new hash table entry.
+*/
+
+struct bfd_hash_entry*
+	bfd_hash_newfunc(struct bfd_hash_entry* entry,
+		struct bfd_hash_table* table,
+		const char* string ATTRIBUTE_UNUSED)
+{
+	if (entry == NULL)
+		entry = (struct bfd_hash_entry*)bfd_hash_allocate(table,
+			sizeof(*entry));
+	return entry;
+}
+
+/*
+FUNCTION
+	bfd_hash_traverse
+
+SYNOPSIS
+	void bfd_hash_traverse
+	  (struct bfd_hash_table *,
+	   bool (*) (struct bfd_hash_entry *, void *),
+	   void *);
+
+DESCRIPTION
+	Traverse a hash table.
+*/
+
+void
+bfd_hash_traverse(struct bfd_hash_table* table,
+	bool (*func) (struct bfd_hash_entry*, void*),
+	void* info)
+{
+	unsigned int i;
+
+	table->frozen = 1;
+	for (i = 0; i < table->size; i++)
+	{
+		struct bfd_hash_entry* p;
+
+		for (p = table->table[i]; p != NULL; p = p->next)
+			if (!(*func) (p, info))
+				goto out;
+	}
+out:
+	table->frozen = 0;
+}
+
+/* The number of buckets in each piece of a parallel traversal.  The
+   pieces depend only on the size of the table, so a reduction sees
+   the same pieces however many threads do the work.  */
+#define HASH_TRAVERSE_BUCKETS 4096
+
+/* A bfd_hash_traverse_parallel in progress.  */
+
+struct hash_traverse_job
+{
+	struct bfd_hash_table* table;
+	bool (*func) (struct bfd_hash_entry*, void*, void*);
+	void* info;
+	char* results;
+	size_t result_size;
+};
+
+/* Traverse the pieces of the table in DATA, a hash_traverse_job, from
+   START up to END.  Worker for _bfd_parallel_for.  */
+
+static bool
+hash_traverse_range(void* data, size_t start, size_t end)
+{
+	struct hash_traverse_job* job = (struct hash_traverse_job*)data;
+	bool ok = true;
+	size_t piece;
+
+	for (piece = start; piece < end; piece++)
+	{
+		void* result = NULL;
+		size_t i = piece * HASH_TRAVERSE_BUCKETS;
+		size_t last = i + HASH_TRAVERSE_BUCKETS;
+
+		if (last > job->table->size)
+			last = job->table->size;
+		if (job->results != NULL)
+			result = job->results + piece * job->result_size;
+		for (; i < last; i++)
+		{
+			struct bfd_hash_entry* p;
+
+			for (p = job->table->table[i]; p != NULL; p = p->next)
+				if (!(*job->func) (p, job->info, result))
+				{
+					ok = false;
+					goto next;
+				}
+		}
+	next:;
+	}
+	return ok;
+}
+
+/*
+FUNCTION
+	bfd_hash_traverse_parallel
+
+SYNOPSIS
+	bool bfd_hash_traverse_parallel
+	  (struct bfd_hash_table *,
+	   bool (* {*func*}) (struct bfd_hash_entry *, void *, void *),
+	   size_t {*result_size*},
+	   bool (* {*reduce*}) (void *, void *),
+	   void *);
+
+DESCRIPTION
+	Traverse a hash table on as many threads as
+	<<bfd_set_thread_count>> allows.  The buckets are split into
+	pieces, and each piece gets a zeroed block of @var{result_size}
+	bytes of its own, passed to @var{func} with each entry in the
+	piece and @var{info}; the block is NULL if @var{result_size} is
+	zero.  Pieces may be done in any order and at the same time, so
+	@var{func} must only change the entry it is given and the
+	block, and must not allocate BFD memory.  A call returning
+	<<FALSE>> ends its piece.  Then, unless @var{reduce} is NULL,
+	it is called on the calling thread with @var{info} and the
+	block of each piece in turn, so that it sees the entries in
+	the order <<bfd_hash_traverse>> would.  It is called for every
+	piece even if some call failed, so that it can free what
+	@var{func} left in the blocks.  Returns <<FALSE>> if any call
+	of either function did, or if memory ran out, in which case
+	neither is called.
+*/
+
+bool
+bfd_hash_traverse_parallel(struct bfd_hash_table* table,
+	bool (*func) (struct bfd_hash_entry*, void*, void*),
+	size_t result_size,
+	bool (*reduce) (void*, void*),
+	void* info)
+{
+	struct hash_traverse_job job;
+	size_t npieces;
+	size_t piece;
+	bool ok;
+
+	npieces = (table->size + HASH_TRAVERSE_BUCKETS - 1) / HASH_TRAVERSE_BUCKETS;
+	if (npieces == 0)
+		return true;
+
+	job.table = table;
+	job.func = func;
+	job.info = info;
+	job.result_size = result_size;
+	job.results = NULL;
+	if (result_size != 0)
+	{
+		job.results = (char*)bfd_zmalloc(npieces * result_size);
+		if (job.results == NULL)
+			return false;
+	}
+
+	table->frozen = 1;
+	ok = _bfd_parallel_for(npieces, 1, hash_traverse_range, &job);
+	table->frozen = 0;
+
+	if (reduce != NULL)
+		for (piece = 0; piece < npieces; piece++)
+			if (!(*reduce) (info, job.results == NULL ? NULL
+				: job.results + piece * result_size))
+				ok = false;
+
+	free(job.results);
+	return ok;
+}
+
+/*
+FUNCTION
+	bfd_hash_set_default_size
+
+SYNOPSIS
 	unsigned int bfd_hash_set_default_size (unsigned int);
 
 DESCRIPTION
@@ -923,12 +2023,242 @@ bfd_hash_set_default_size(unsigned int hash_size)
 	return bfd_default_hash_table_size;
 }
 
+/*
+FUNCTION
+	bfd_hash_table_set_statistics
+
+SYNOPSIS
+	bool bfd_hash_table_set_statistics
+	  (struct bfd_hash_table *, bool {*enable*});
+
+DESCRIPTION
+	Start or stop keeping statistics for a table.  Starting
+	clears any counts kept so far.  Counting adds a clock read to
+	every lookup, so is off by default.  The counts of a table in
+	concurrent mode are approximate.  Return <<FALSE>> if out of
+	memory.
+
+CODE_FRAGMENT
+.{* Statistics for a hash table, see <<bfd_hash_table_statistics>>.  *}
+.
+.struct bfd_hash_stats
+.{
+.  {* The table as it is now.  *}
+.  unsigned int size;
+.  unsigned int count;
+.  {* The number of buckets with no entries, and the longest chain.  *}
+.  unsigned int empty;
+.  unsigned int longest;
+.  {* CHAINS[N] is the number of buckets with N entries; the last
+.     element counts all longer chains.  *}
+.  unsigned int chains[8];
+.
+.  {* Counts kept since statistics were started.  *}
+.  unsigned int resizes;
+.  unsigned int index_rebuilds;
+.  unsigned long long lookups;
+.  unsigned long long hits;
+.  unsigned long long inserts;
+.  {* Chain entries examined by lookups.  *}
+.  unsigned long long probes;
+.  {* Time spent in <<bfd_hash_lookup>>, including any inserts it
+.     made, and in <<bfd_hash_insert>>.  *}
+.  unsigned long long lookup_ns;
+.  unsigned long long insert_ns;
+.};
+.
+*/
+
+bool
+bfd_hash_table_set_statistics(struct bfd_hash_table* table, bool enable)
+{
+	free(table->stats);
+	table->stats = NULL;
+	if (!enable)
+		return true;
+	table->stats = (struct bfd_hash_stats*)bfd_zmalloc(sizeof(*table->stats));
+	return table->stats != NULL;
+}
+
+/*
+FUNCTION
+	bfd_hash_table_statistics
+
+SYNOPSIS
+	void bfd_hash_table_statistics
+	  (struct bfd_hash_table *, struct bfd_hash_stats *);
+
+DESCRIPTION
+	Fill in @var{stats} for a table.  The shape of the chains is
+	always reported; the counts are zero unless statistics were
+	started with <<bfd_hash_table_set_statistics>>.
+*/
+
+void
+bfd_hash_table_statistics(struct bfd_hash_table* table,
+	struct bfd_hash_stats* stats)
+{
+	unsigned int i;
+	unsigned int n;
+
+	if (table->stats != NULL)
+		*stats = *table->stats;
+	else
+		memset(stats, 0, sizeof(*stats));
+	stats->size = table->size;
+	stats->count = table->count;
+	stats->empty = 0;
+	stats->longest = 0;
+	memset(stats->chains, 0, sizeof(stats->chains));
+
+	if (table->locks != NULL)
+		bfd_hash_lock_all(table);
+	for (i = 0; i < table->size; i++)
+	{
+		struct bfd_hash_entry* p;
+
+		n = 0;
+		for (p = table->table[i]; p != NULL; p = p->next)
+			n++;
+		if (n == 0)
+			stats->empty++;
+		if (n > stats->longest)
+			stats->longest = n;
+		if (n >= ARRAY_SIZE(stats->chains))
+			n = ARRAY_SIZE(stats->chains) - 1;
+		stats->chains[n]++;
+	}
+	if (table->locks != NULL)
+		bfd_hash_unlock_all(table);
+}
+
+/*
+FUNCTION
+	bfd_hash_print_statistics
+
+SYNOPSIS
+	void bfd_hash_print_statistics
+	  (void *, const char *, struct bfd_hash_table *);
+
+DESCRIPTION
+	Print the statistics of a table to a file, which is a
+	<<FILE *>>, in the manner of <<htab_print_statistics>>.
+*/
+
+void
+bfd_hash_print_statistics(void* file, const char* name,
+	struct bfd_hash_table* table)
+{
+	FILE* f = (FILE*)file;
+	struct bfd_hash_stats st;
+	unsigned int i;
+
+	bfd_hash_table_statistics(table, &st);
+	fprintf(f, "%s hash statistics:\n", name);
+	fprintf(f, "\t%u elements\n", st.count);
+	fprintf(f, "\t%u table size\n", st.size);
+	fprintf(f, "\t%.2f load factor\n",
+		st.size != 0 ? (double)st.count / st.size : 0.0);
+	fprintf(f, "\t%u empty buckets\n", st.empty);
+	fprintf(f, "\t%u longest chain\n", st.longest);
+	fprintf(f, "\tchain lengths:");
+	for (i = 0; i < ARRAY_SIZE(st.chains); i++)
+		fprintf(f, " %u%s:%u", i,
+			i == ARRAY_SIZE(st.chains) - 1 ? "+" : "", st.chains[i]);
+	fprintf(f, "\n");
+	if (table->stats == NULL)
+		return;
+	fprintf(f, "\t%u resizes\n", st.resizes);
+	fprintf(f, "\t%u index rebuilds\n", st.index_rebuilds);
+	fprintf(f, "\t%llu lookups, %llu hits\n", st.lookups, st.hits);
+	fprintf(f, "\t%llu inserts\n", st.inserts);
+	fprintf(f, "\t%llu probes\n", st.probes);
+	fprintf(f, "\t%llu ns in lookups\n", st.lookup_ns);
+	fprintf(f, "\t%llu ns in inserts\n", st.insert_ns);
+}
+
+/*
+FUNCTION
+	bfd_hash_set_statistics_file
+
+SYNOPSIS
+	void bfd_hash_set_statistics_file (void *);
+
+DESCRIPTION
+	Keep statistics for every hash table created from now on, and
+	print those of the linker, section and string tables to
+	@var{file}, a <<FILE *>>, as they are freed.  A NULL
+	@var{file} stops this for tables created afterwards.
+*/
+
+void
+bfd_hash_set_statistics_file(void* file)
+{
+	bfd_hash_stats_file = (FILE*)file;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_hash_table_account
+
+SYNOPSIS
+	void _bfd_hash_table_account
+	  (struct bfd_hash_table *, bfd_size_type {*size*});
+
+DESCRIPTION
+	Count @var{size} bytes that a caller allocated from the
+	table's objalloc itself as part of the table's memory.
+*/
+
+void
+_bfd_hash_table_account(struct bfd_hash_table* table, bfd_size_type size)
+{
+	bfd_hash_account(table, size);
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_hash_table_report
+
+SYNOPSIS
+	void _bfd_hash_table_report
+	  (struct bfd_hash_table *, const char *{*what*},
+	   const char *{*owner*});
+
+DESCRIPTION
+	If statistics are being reported, print those of a table about
+	to be freed, naming it by @var{what} and, if not NULL,
+	@var{owner}.
+*/
+
+void
+_bfd_hash_table_report(struct bfd_hash_table* table, const char* what,
+	const char* owner)
+{
+	char* name;
+
+	if (bfd_hash_stats_file == NULL || table->stats == NULL)
+		return;
+	if (owner == NULL)
+	{
+		bfd_hash_print_statistics(bfd_hash_stats_file, what, table);
+		return;
+	}
+	name = (char*)bfd_malloc(strlen(what) + strlen(owner) + 4);
+	if (name == NULL)
+		return;
+	sprintf(name, "%s (%s)", what, owner);
+	bfd_hash_print_statistics(bfd_hash_stats_file, name, table);
+	free(name);
+}
+
 /* A few different object file formats (a.out, COFF, ELF) use a string
    table.  These functions support adding strings to a string table,
    returning the byte offset, and writing out the table.
 
    Possible improvements:
    + look for strings matching trailing substrings of other strings
+     outside of a single _bfd_stringtab_add_batch
    + better data structures?  balanced trees?
    + look at reducing memory use elsewhere -- maybe if we didn't have
 	 to construct the entire symbol table at once, we could get by
@@ -1027,6 +2357,7 @@ struct bfd_strtab_hash*
 		free(table);
 		return NULL;
 	}
+	bfd_hash_table_set_memory_class(&table->table, bfd_memory_strtab);
 
 	table->size = 0;
 	table->first = NULL;
@@ -1075,10 +2406,30 @@ DESCRIPTION
 void
 _bfd_stringtab_free(struct bfd_strtab_hash* table)
 {
+	_bfd_hash_table_report(&table->table, "string table", NULL);
 	bfd_hash_table_free(&table->table);
 	free(table);
 }
 
+/* Give ENTRY, whose string is LEN bytes long, the next index in TAB
+   and put it at the end of the strings to be written.  */
+
+static void
+strtab_append(struct bfd_strtab_hash* tab,
+	struct strtab_hash_entry* entry,
+	size_t len)
+{
+	entry->index = tab->size;
+	tab->size += len + 1;
+	entry->index += tab->length_field_size;
+	tab->size += tab->length_field_size;
+	if (tab->first == NULL)
+		tab->first = entry;
+	else
+		tab->last->next = entry;
+	tab->last = entry;
+}
+
 /*
 INTERNAL_FUNCTION
 	_bfd_stringtab_add
@@ -1133,19 +2484,204 @@ _bfd_stringtab_add(struct bfd_strtab_hash* tab,
 	}
 
 	if (entry->index == (bfd_size_type)-1)
+		strtab_append(tab, entry, strlen(str));
+
+	return entry->index;
+}
+
+/* The number of strings each thread hashes at a time in
+   _bfd_stringtab_add_batch.  */
+#define STRTAB_HASH_GRAIN 4096
+
+/* The index a string has while _bfd_stringtab_add_batch is laying it
+   out, so that a repeat of it in the same batch is skipped.  */
+#define STRTAB_INDEX_PENDING ((bfd_size_type)-2)
+
+/* A batch of strings being hashed by _bfd_stringtab_add_batch.  */
+
+struct strtab_batch
+{
+	const char* const* strs;
+	unsigned long long* hashes;
+	enum bfd_hash_function func;
+};
+
+/* A string new to the table in a batch.  */
+
+struct strtab_tail
+{
+	struct strtab_hash_entry* entry;
+	const char* str;
+	size_t len;
+	/* The string whose bytes this one ends, or itself.  */
+	struct strtab_tail* owner;
+};
+
+/* Hash the strings of a batch from START up to END.  Worker for
+   _bfd_parallel_for.  */
+
+static bool
+strtab_hash_range(void* data, size_t start, size_t end)
+{
+	struct strtab_batch* batch = (struct strtab_batch*)data;
+	size_t i;
+
+	for (i = start; i < end; i++)
+		batch->hashes[i] = bfd_hash_string_hash(batch->strs[i],
+			batch->func);
+	return true;
+}
+
+/* Order strings by their characters from the last back, so that a
+   string comes just before those it is the tail of.  */
+
+static int
+strtab_tail_compare(const void* a, const void* b)
+{
+	const struct strtab_tail* ta = *(const struct strtab_tail* const*)a;
+	const struct strtab_tail* tb = *(const struct strtab_tail* const*)b;
+	const unsigned char* sa = (const unsigned char*)ta->str + ta->len;
+	const unsigned char* sb = (const unsigned char*)tb->str + tb->len;
+	size_t n = ta->len < tb->len ? ta->len : tb->len;
+
+	while (n-- != 0)
 	{
-		entry->index = tab->size;
-		tab->size += strlen(str) + 1;
-		entry->index += tab->length_field_size;
-		tab->size += tab->length_field_size;
-		if (tab->first == NULL)
-			tab->first = entry;
-		else
-			tab->last->next = entry;
-		tab->last = entry;
+		int c = *--sa - *--sb;
+
+		if (c != 0)
+			return c;
 	}
+	if (ta->len != tb->len)
+		return ta->len < tb->len ? -1 : 1;
+	return 0;
+}
 
-	return entry->index;
+/*
+INTERNAL_FUNCTION
+	_bfd_stringtab_add_batch
+
+SYNOPSIS
+	bool _bfd_stringtab_add_batch
+	  (struct bfd_strtab_hash *, const char *const *,
+	   size_t {*count*}, bool {*copy*}, bool {*tail_merge*});
+
+DESCRIPTION
+	Add @var{count} strings to a strtab at once, as though by
+	<<_bfd_stringtab_add>> with HASH true, so that a later
+	<<_bfd_stringtab_add>> of any of them returns its index.  The
+	strings are hashed together, on as many threads as
+	<<bfd_set_thread_count>> allows.  If @var{tail_merge} is true,
+	a new string which is the tail of another new string is given
+	an index within that one instead of bytes of its own.  This is
+	not done for XCOFF .debug strtabs, whose strings each have a
+	length before them.
+*/
+
+bool
+_bfd_stringtab_add_batch(struct bfd_strtab_hash* tab,
+	const char* const* strs,
+	size_t count,
+	bool copy,
+	bool tail_merge)
+{
+	struct strtab_batch batch;
+	struct strtab_tail* tails;
+	struct strtab_tail** sorted;
+	size_t ntails;
+	size_t i;
+	bool ret;
+
+	if (count == 0)
+		return true;
+	if (count > (size_t)-1 / sizeof(*tails))
+	{
+		bfd_set_error(bfd_error_no_memory);
+		return false;
+	}
+
+	ret = false;
+	sorted = NULL;
+	ntails = 0;
+	batch.strs = strs;
+	batch.func = bfd_hash_table_function(&tab->table);
+	batch.hashes = (unsigned long long*)bfd_malloc(count
+		* sizeof(*batch.hashes));
+	tails = (struct strtab_tail*)bfd_malloc(count * sizeof(*tails));
+	if (batch.hashes == NULL || tails == NULL)
+		goto out;
+
+	if (!_bfd_parallel_for(count, STRTAB_HASH_GRAIN, strtab_hash_range,
+		&batch))
+		goto out;
+
+	/* Find the strings not already in the table, in order.  */
+	for (i = 0; i < count; i++)
+	{
+		struct strtab_hash_entry* entry;
+
+		entry = (struct strtab_hash_entry*)
+			bfd_hash_lookup_with_hash(&tab->table, strs[i],
+				batch.hashes[i], true, copy);
+		if (entry == NULL)
+			goto out;
+		if (entry->index != (bfd_size_type)-1)
+			continue;
+		entry->index = STRTAB_INDEX_PENDING;
+		tails[ntails].entry = entry;
+		tails[ntails].str = entry->root.string;
+		tails[ntails].len = strlen(entry->root.string);
+		tails[ntails].owner = &tails[ntails];
+		ntails++;
+	}
+
+	/* Sorted on their reversed characters, a string which is the tail
+	   of others comes just before one of them.  Going from the last,
+	   each string that is the tail of the next takes that one's
+	   owner, which is then never itself the tail of another.  */
+	if (tail_merge && tab->length_field_size == 0 && ntails > 1)
+	{
+		sorted = (struct strtab_tail**)bfd_malloc(ntails
+			* sizeof(*sorted));
+		if (sorted == NULL)
+			goto out;
+		for (i = 0; i < ntails; i++)
+			sorted[i] = &tails[i];
+		qsort(sorted, ntails, sizeof(*sorted), strtab_tail_compare);
+		for (i = ntails - 1; i-- != 0;)
+		{
+			struct strtab_tail* t = sorted[i];
+			struct strtab_tail* next = sorted[i + 1];
+
+			if (t->len <= next->len
+				&& memcmp(next->str + next->len - t->len,
+					t->str, t->len) == 0)
+				t->owner = next->owner;
+		}
+	}
+
+	/* Lay out the strings with bytes of their own in the order they
+	   were given, then point the others into them.  */
+	for (i = 0; i < ntails; i++)
+		if (tails[i].owner == &tails[i])
+			strtab_append(tab, tails[i].entry, tails[i].len);
+	for (i = 0; i < ntails; i++)
+		if (tails[i].owner != &tails[i])
+			tails[i].entry->index = (tails[i].owner->entry->index
+				+ tails[i].owner->len - tails[i].len);
+	ret = true;
+
+out:
+	if (!ret && tails != NULL)
+	{
+		/* Leave nothing half added.  */
+		for (i = 0; i < ntails; i++)
+			if (tails[i].entry->index == STRTAB_INDEX_PENDING)
+				tails[i].entry->index = (bfd_size_type)-1;
+	}
+	free(sorted);
+	free(tails);
+	free(batch.hashes);
+	return ret;
 }
 
 /*
@@ -1181,37 +2717,234 @@ bool
 _bfd_stringtab_emit(bfd* abfd, struct bfd_strtab_hash* tab)
 {
 	struct strtab_hash_entry* entry;
+	bfd_byte* buf;
+	bfd_size_type buf_size, used;
+
+	/* Gather the strings into one buffer, so that most tables take a
+	   single write, or into chunks of STRTAB_EMIT_CHUNK bytes for the
+	   very largest.  */
+#define STRTAB_EMIT_CHUNK (16 * 1024 * 1024)
+	buf_size = tab->size < STRTAB_EMIT_CHUNK ? tab->size : STRTAB_EMIT_CHUNK;
+	buf = (bfd_byte*)bfd_malloc(buf_size != 0 ? buf_size : 1);
+	if (buf == NULL)
+		return false;
 
+	used = 0;
 	for (entry = tab->first; entry != NULL; entry = entry->next)
 	{
 		const char* str;
 		size_t len;
+		bfd_size_type need;
 
 		str = entry->root.string;
 		len = strlen(str) + 1;
+		need = len + tab->length_field_size;
 
-		if (tab->length_field_size == 4)
+		if (used + need > buf_size)
 		{
-			bfd_byte buf[4];
+			if (used != 0 && bfd_bwrite((void*)buf, used, abfd) != used)
+				goto fail;
+			used = 0;
+		}
 
-			/* The output length includes the null byte.  */
-			bfd_put_32(abfd, (bfd_vma)len, buf);
-			if (bfd_bwrite((void*)buf, (bfd_size_type)4, abfd) != 4)
-				return false;
+		if (need > buf_size)
+		{
+			/* A string too long for the buffer is written directly.  */
+			bfd_byte lbuf[4];
+
+			if (tab->length_field_size == 4)
+				bfd_put_32(abfd, (bfd_vma)len, lbuf);
+			else if (tab->length_field_size == 2)
+				bfd_put_16(abfd, (bfd_vma)len, lbuf);
+			if (bfd_bwrite((void*)lbuf, (bfd_size_type)tab->length_field_size,
+				abfd) != (bfd_size_type)tab->length_field_size
+				|| bfd_bwrite((void*)str, (bfd_size_type)len, abfd) != len)
+				goto fail;
+			continue;
 		}
+
+		/* The output length includes the null byte.  */
+		if (tab->length_field_size == 4)
+			bfd_put_32(abfd, (bfd_vma)len, buf + used);
 		else if (tab->length_field_size == 2)
-		{
-			bfd_byte buf[2];
+			bfd_put_16(abfd, (bfd_vma)len, buf + used);
+		used += tab->length_field_size;
+		memcpy(buf + used, str, len);
+		used += len;
+	}
 
-			/* The output length includes the null byte.  */
-			bfd_put_16(abfd, (bfd_vma)len, buf);
-			if (bfd_bwrite((void*)buf, (bfd_size_type)2, abfd) != 2)
-				return false;
-		}
+	if (used != 0 && bfd_bwrite((void*)buf, used, abfd) != used)
+		goto fail;
 
-		if (bfd_bwrite((void*)str, (bfd_size_type)len, abfd) != len)
-			return false;
+	free(buf);
+	return true;
+
+fail:
+	free(buf);
+	return false;
+}
+
+/*
+SUBSECTION
+	Name pools
+
+	BFDs normally keep their own copy of each section and symbol
+	name.  A group of BFDs that share many names, such as the
+	members of an archive or the inputs to a link, can instead
+	share a <<bfd_name_pool>>, which stores each distinct name
+	once.  Names from the same pool are equal exactly when they
+	are the same pointer, so comparing them is cheap.
+*/
+
+/* A name pool.  The names are the strings of the hash table.  */
+
+struct bfd_name_pool
+{
+	struct bfd_hash_table table;
+	/* The number of BFDs using the pool, plus one for its creator.  */
+	int refcount;
+};
+
+/* The number of lock stripes in a name pool, which BFDs on different
+   threads may add to at once.  */
+#define NAME_POOL_STRIPES 64
+
+/*
+FUNCTION
+	bfd_name_pool_create
+
+SYNOPSIS
+	struct bfd_name_pool *bfd_name_pool_create (void);
+
+DESCRIPTION
+	Create an empty name pool, to be given to BFDs with
+	<<bfd_set_name_pool>>.  Return NULL on error.
+*/
+
+struct bfd_name_pool*
+bfd_name_pool_create(void)
+{
+	struct bfd_name_pool* pool;
+
+	pool = (struct bfd_name_pool*)bfd_malloc(sizeof(*pool));
+	if (pool == NULL)
+		return NULL;
+	if (!bfd_hash_table_init(&pool->table, bfd_hash_newfunc,
+		sizeof(struct bfd_hash_entry)))
+	{
+		free(pool);
+		return NULL;
+	}
+	if (!bfd_hash_table_set_function(&pool->table, bfd_hash_wide)
+		|| !bfd_hash_table_set_concurrent(&pool->table, NAME_POOL_STRIPES))
+	{
+		bfd_hash_table_free(&pool->table);
+		free(pool);
+		return NULL;
 	}
+	pool->refcount = 1;
+	return pool;
+}
+
+/*
+FUNCTION
+	bfd_name_pool_release
+
+SYNOPSIS
+	void bfd_name_pool_release (struct bfd_name_pool *);
+
+DESCRIPTION
+	Give up the reference to a name pool that
+	<<bfd_name_pool_create>> returned.  The pool is freed once
+	this has been done and every BFD using it has been closed.
+*/
+
+void
+bfd_name_pool_release(struct bfd_name_pool* pool)
+{
+	if (pool == NULL || _bfd_atomic_add(&pool->refcount, -1) != 0)
+		return;
+	_bfd_hash_table_report(&pool->table, "name pool", NULL);
+	bfd_hash_table_free(&pool->table);
+	free(pool);
+}
+
+/*
+FUNCTION
+	bfd_set_name_pool
+
+SYNOPSIS
+	bool bfd_set_name_pool (bfd *abfd, struct bfd_name_pool *pool);
 
+DESCRIPTION
+	Make @var{abfd} keep the names it reads in @var{pool}.  This
+	must be done before the format of @var{abfd} is checked, and
+	is inherited by the members of an archive.  Passing NULL
+	makes @var{abfd} keep its own names again.  Return <<FALSE>>
+	if it is too late for @var{abfd} to change.
+*/
+
+bool
+bfd_set_name_pool(bfd* abfd, struct bfd_name_pool* pool)
+{
+	if (abfd->format != bfd_unknown)
+	{
+		bfd_set_error(bfd_error_invalid_operation);
+		return false;
+	}
+	if (pool != NULL)
+		_bfd_atomic_add(&pool->refcount, 1);
+	bfd_name_pool_release(abfd->name_pool);
+	abfd->name_pool = pool;
 	return true;
 }
+
+/*
+INTERNAL_FUNCTION
+	_bfd_intern_name
+
+SYNOPSIS
+	const char *_bfd_intern_name
+	  (bfd *abfd, const char *name, size_t len);
+
+DESCRIPTION
+	Return a NUL terminated copy of the first @var{len} bytes of
+	@var{name}, which need not be terminated itself, for use as
+	a name in @var{abfd}.  The copy is in the name pool of
+	@var{abfd} if it has one, and in the memory of @var{abfd}
+	otherwise.  Return NULL on error.
+*/
+
+const char*
+_bfd_intern_name(bfd* abfd, const char* name, size_t len)
+{
+	char buf[256];
+	char* key;
+	struct bfd_hash_entry* entry;
+
+	if (abfd->name_pool == NULL)
+	{
+		key = (char*)bfd_alloc(abfd, len + 1);
+		if (key == NULL)
+			return NULL;
+		memcpy(key, name, len);
+		key[len] = '\0';
+		return key;
+	}
+
+	/* The pool wants a terminated string to look up.  */
+	key = buf;
+	if (len >= sizeof(buf))
+	{
+		key = (char*)bfd_malloc(len + 1);
+		if (key == NULL)
+			return NULL;
+	}
+	memcpy(key, name, len);
+	key[len] = '\0';
+
+	entry = bfd_hash_lookup(&abfd->name_pool->table, key, true, true);
+	if (key != buf)
+		free(key);
+	return entry != NULL ? entry->string : NULL;
+}
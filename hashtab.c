@@ -75,6 +75,17 @@ static hashval_t hash_pointer (const void *);
 static int eq_pointer (const void *, const void *);
 static int htab_expand (htab_t);
 static void **find_empty_slot_for_expand (htab_t, hashval_t);
+static void htab_migrate (htab_t, size_t);
+
+/* The number of slots of the old entries that an incrementally growing
+   table moves on each insertion.  A resize leaves the table half full
+   and the next one comes when it is three quarters full, so this is
+   plenty to move everything in between.  */
+#define HTAB_MIGRATE_SLOTS 8
+
+/* Tables smaller than this are still rehashed all at once, since that
+   costs less than looking in two sets of entries for a while.  */
+#define HTAB_INCREMENTAL_MIN 256
 
 /* At some point, we could make these be NULL, and modify the
    hash-table routines to handle NULL specially; that would avoid
@@ -220,7 +231,8 @@ size_t
 
 /* Return the current number of elements in given hash table. */
 
-#define htab_elements(htab)  ((htab)->n_elements - (htab)->n_deleted)
+#define htab_elements(htab) \
+  ((htab)->n_elements - (htab)->n_deleted + (htab)->old_elements)
 
 size_t
 (htab_elements) (htab_t htab)
@@ -256,13 +268,31 @@ htab_mod_1 (hashval_t x, hashval_t y, hashval_t inv, int shift)
   return x % y;
 }
 
+/* Compute the primary hash for HASH given a table size that is the
+   prime at INDEX in the table of primes.  */
+
+static inline hashval_t
+htab_mod_index (hashval_t hash, unsigned int index)
+{
+  const struct prime_ent *p = &prime_tab[index];
+  return htab_mod_1 (hash, p->prime, p->inv, p->shift);
+}
+
+/* Likewise for the secondary hash.  */
+
+static inline hashval_t
+htab_mod_m2_index (hashval_t hash, unsigned int index)
+{
+  const struct prime_ent *p = &prime_tab[index];
+  return 1 + htab_mod_1 (hash, p->prime - 2, p->inv_m2, p->shift);
+}
+
 /* Compute the primary hash for HASH given HTAB's current size.  */
 
 static inline hashval_t
 htab_mod (hashval_t hash, htab_t htab)
 {
-  const struct prime_ent *p = &prime_tab[htab->size_prime_index];
-  return htab_mod_1 (hash, p->prime, p->inv, p->shift);
+  return htab_mod_index (hash, htab->size_prime_index);
 }
 
 /* Compute the secondary hash for HASH given HTAB's current size.  */
@@ -270,8 +300,7 @@ htab_mod (hashval_t hash, htab_t htab)
 static inline hashval_t
 htab_mod_m2 (hashval_t hash, htab_t htab)
 {
-  const struct prime_ent *p = &prime_tab[htab->size_prime_index];
-  return 1 + htab_mod_1 (hash, p->prime - 2, p->inv_m2, p->shift);
+  return htab_mod_m2_index (hash, htab->size_prime_index);
 }
 
 /* This function creates table with length slightly longer than given
@@ -406,6 +435,47 @@ htab_try_create (size_t size, htab_hash hash_f, htab_eq eq_f, htab_del del_f)
   return htab_create_alloc (size, hash_f, eq_f, del_f, calloc, free);
 }
 
+/* Make HTAB grow incrementally if INCREMENTAL is nonzero, or all at
+   once otherwise, which is the default.  Tables that answer queries
+   with a bound on their latency want the first, so that no single
+   insertion has to rehash the whole table.  */
+
+void
+htab_set_incremental (htab_t htab, int incremental)
+{
+  htab->incremental = incremental;
+  if (!incremental && htab->old_entries != NULL)
+    htab_migrate (htab, (size_t) -1);
+}
+
+/* Free the entries of HTAB left aside by an incremental resize, after
+   calling the cleanup function on any elements still there if DEL is
+   nonzero.  */
+
+static void
+htab_free_old (htab_t htab, int del)
+{
+  void **entries = htab->old_entries;
+  size_t i;
+
+  if (entries == NULL)
+    return;
+
+  if (del && htab->del_f)
+    for (i = 0; i < htab->old_size; i++)
+      if (entries[i] != HTAB_EMPTY_ENTRY && entries[i] != HTAB_DELETED_ENTRY)
+	(*htab->del_f) (entries[i]);
+
+  if (htab->free_f != NULL)
+    (*htab->free_f) (entries);
+  else if (htab->free_with_arg_f != NULL)
+    (*htab->free_with_arg_f) (htab->alloc_arg, entries);
+  htab->old_entries = NULL;
+  htab->old_size = 0;
+  htab->old_elements = 0;
+  htab->old_scan = 0;
+}
+
 /* This function frees all memory allocated for given hash table.
    Naturally the hash table must already exist. */
 
@@ -420,6 +490,7 @@ htab_delete (htab_t htab)
     for (i = size - 1; i >= 0; i--)
       if (entries[i] != HTAB_EMPTY_ENTRY && entries[i] != HTAB_DELETED_ENTRY)
 	(*htab->del_f) (entries[i]);
+  htab_free_old (htab, 1);
 
   if (htab->free_f != NULL)
     {
@@ -446,6 +517,7 @@ htab_empty (htab_t htab)
     for (i = size - 1; i >= 0; i--)
       if (entries[i] != HTAB_EMPTY_ENTRY && entries[i] != HTAB_DELETED_ENTRY)
 	(*htab->del_f) (entries[i]);
+  htab_free_old (htab, 1);
 
   /* Instead of clearing megabyte, downsize the table.  */
   if (size > 1024*1024 / sizeof (void *))
@@ -506,42 +578,126 @@ find_empty_slot_for_expand (htab_t htab, hashval_t hash)
     }
 }
 
-/* The following function changes size of memory allocated for the
-   entries and repeatedly inserts the table elements.  The occupancy
-   of the table after the call will be about 50%.  Naturally the hash
-   table must already exist.  Remember also that the place of the
-   table entries is changed.  If memory allocation failures are allowed,
-   this function will return zero, indicating that the table could not be
-   expanded.  If all goes well, it will return a non-zero value.  */
+/* Return the slot where an element with hash HASH, known not to be
+   among HTAB's current entries, is to go: the first empty or deleted
+   one along its probe sequence.  Count it as used.  */
+
+static void **
+find_free_slot (htab_t htab, hashval_t hash)
+{
+  hashval_t index = htab_mod (hash, htab);
+  size_t size = htab_size (htab);
+  void **slot = htab->entries + index;
+
+  if (*slot != HTAB_EMPTY_ENTRY && *slot != HTAB_DELETED_ENTRY)
+    {
+      hashval_t hash2 = htab_mod_m2 (hash, htab);
+
+      do
+	{
+	  index += hash2;
+	  if (index >= size)
+	    index -= size;
+	  slot = htab->entries + index;
+	}
+      while (*slot != HTAB_EMPTY_ENTRY && *slot != HTAB_DELETED_ENTRY);
+    }
+
+  if (*slot == HTAB_DELETED_ENTRY)
+    htab->n_deleted--;
+  else
+    htab->n_elements++;
+  return slot;
+}
+
+/* Move the elements in the next COUNT slots of the entries HTAB left
+   aside when it last grew into its current entries.  The slots moved
+   are marked deleted rather than empty, so that looking up elements
+   still there passes over them.  Free the old entries once nothing is
+   left in them.  */
+
+static void
+htab_migrate (htab_t htab, size_t count)
+{
+  void **entries = htab->old_entries;
+
+  while (htab->old_elements != 0 && count-- != 0)
+    {
+      void **p = entries + htab->old_scan++;
+      void *x = *p;
+
+      if (x != HTAB_EMPTY_ENTRY && x != HTAB_DELETED_ENTRY)
+	{
+	  *find_free_slot (htab, (*htab->hash_f) (x)) = x;
+	  *p = HTAB_DELETED_ENTRY;
+	  htab->old_elements--;
+	}
+    }
+
+  if (htab->old_elements == 0)
+    htab_free_old (htab, 0);
+}
+
+/* Look for ELEMENT, with hash HASH, among the entries HTAB left aside
+   when it last grew.  Return its slot, or NULL if it is not there.  */
+
+static void **
+find_old_slot (htab_t htab, const void *element, hashval_t hash)
+{
+  void **entries = htab->old_entries;
+  unsigned int prime_index = htab->old_size_prime_index;
+  size_t size = htab->old_size;
+  hashval_t index, hash2;
+  void *entry;
+
+  index = htab_mod_index (hash, prime_index);
+  entry = entries[index];
+  if (entry == HTAB_EMPTY_ENTRY)
+    return NULL;
+  if (entry != HTAB_DELETED_ENTRY && (*htab->eq_f) (entry, element))
+    return &entries[index];
+
+  hash2 = htab_mod_m2_index (hash, prime_index);
+  for (;;)
+    {
+      htab->collisions++;
+      index += hash2;
+      if (index >= size)
+	index -= size;
+
+      entry = entries[index];
+      if (entry == HTAB_EMPTY_ENTRY)
+	return NULL;
+      if (entry != HTAB_DELETED_ENTRY && (*htab->eq_f) (entry, element))
+	return &entries[index];
+    }
+}
+
+/* Give HTAB new entries, of the size at NINDEX in the table of primes,
+   and move its elements into them.  An incrementally growing table
+   keeps the old entries aside and moves their elements later, unless
+   it is small.  Return zero if memory cannot be allocated.  */
 
 static int
-htab_expand (htab_t htab)
+htab_resize (htab_t htab, unsigned int nindex)
 {
   void **oentries;
   void **olimit;
   void **p;
   void **nentries;
   size_t nsize, osize, elts;
-  unsigned int oindex, nindex;
+  unsigned int oindex;
+
+  /* Finish any earlier resize first.  */
+  if (htab->old_entries != NULL)
+    htab_migrate (htab, (size_t) -1);
 
   oentries = htab->entries;
   oindex = htab->size_prime_index;
   osize = htab->size;
   olimit = oentries + osize;
   elts = htab_elements (htab);
-
-  /* Resize only when table after removal of unused elements is either
-     too full or too empty.  */
-  if (elts * 2 > osize || (elts * 8 < osize && osize > 32))
-    {
-      nindex = higher_prime_index (elts * 2);
-      nsize = prime_tab[nindex].prime;
-    }
-  else
-    {
-      nindex = oindex;
-      nsize = osize;
-    }
+  nsize = prime_tab[nindex].prime;
 
   if (htab->alloc_with_arg_f != NULL)
     nentries = (void **) (*htab->alloc_with_arg_f) (htab->alloc_arg, nsize,
@@ -556,6 +712,17 @@ htab_expand (htab_t htab)
   htab->n_elements -= htab->n_deleted;
   htab->n_deleted = 0;
 
+  if (htab->incremental && osize >= HTAB_INCREMENTAL_MIN && elts != 0)
+    {
+      htab->old_entries = oentries;
+      htab->old_size = osize;
+      htab->old_size_prime_index = oindex;
+      htab->old_elements = elts;
+      htab->old_scan = 0;
+      htab->n_elements = 0;
+      return 1;
+    }
+
   p = oentries;
   do
     {
@@ -579,6 +746,39 @@ htab_expand (htab_t htab)
   return 1;
 }
 
+/* The following function changes size of memory allocated for the
+   entries and repeatedly inserts the table elements.  The occupancy
+   of the table after the call will be about 50%.  Naturally the hash
+   table must already exist.  Remember also that the place of the
+   table entries is changed.  If memory allocation failures are allowed,
+   this function will return zero, indicating that the table could not be
+   expanded.  If all goes well, it will return a non-zero value.  */
+
+static int
+htab_expand (htab_t htab)
+{
+  size_t osize = htab->size;
+  size_t elts = htab_elements (htab);
+
+  /* Resize only when table after removal of unused elements is either
+     too full or too empty.  */
+  if (elts * 2 > osize || (elts * 8 < osize && osize > 32))
+    return htab_resize (htab, higher_prime_index (elts * 2));
+  return htab_resize (htab, htab->size_prime_index);
+}
+
+/* Make HTAB big enough to hold COUNT elements without growing again,
+   for a caller that knows roughly how many it will insert.  Return
+   zero if memory cannot be allocated.  */
+
+int
+htab_reserve (htab_t htab, size_t count)
+{
+  if (count * 4 < htab_size (htab) * 3)
+    return 1;
+  return htab_resize (htab, higher_prime_index (count + count / 3 + 1));
+}
+
 /* This function searches for a hash table entry equal to the given
    element.  It cannot be used to insert or delete an element.  */
 
@@ -594,8 +794,9 @@ htab_find_with_hash (htab_t htab, const void *element, hashval_t hash)
   index = htab_mod (hash, htab);
 
   entry = htab->entries[index];
-  if (entry == HTAB_EMPTY_ENTRY
-      || (entry != HTAB_DELETED_ENTRY && (*htab->eq_f) (entry, element)))
+  if (entry == HTAB_EMPTY_ENTRY)
+    goto not_found;
+  if (entry != HTAB_DELETED_ENTRY && (*htab->eq_f) (entry, element))
     return entry;
 
   hash2 = htab_mod_m2 (hash, htab);
@@ -607,10 +808,21 @@ htab_find_with_hash (htab_t htab, const void *element, hashval_t hash)
 	index -= size;
 
       entry = htab->entries[index];
-      if (entry == HTAB_EMPTY_ENTRY
-	  || (entry != HTAB_DELETED_ENTRY && (*htab->eq_f) (entry, element)))
+      if (entry == HTAB_EMPTY_ENTRY)
+	goto not_found;
+      if (entry != HTAB_DELETED_ENTRY && (*htab->eq_f) (entry, element))
 	return entry;
     }
+
+ not_found:
+  if (htab->old_entries != NULL)
+    {
+      void **slot = find_old_slot (htab, element, hash);
+
+      if (slot != NULL)
+	return *slot;
+    }
+  return HTAB_EMPTY_ENTRY;
 }
 
 /* Like htab_find_slot_with_hash, but compute the hash value from the
@@ -639,8 +851,12 @@ htab_find_slot_with_hash (htab_t htab, const void *element,
   size_t size;
   void *entry;
 
+  if (insert == INSERT && htab->old_entries != NULL)
+    htab_migrate (htab, HTAB_MIGRATE_SLOTS);
+
   size = htab_size (htab);
-  if (insert == INSERT && size * 3 <= htab->n_elements * 4)
+  if (insert == INSERT
+      && size * 3 <= (htab->n_elements + htab->old_elements) * 4)
     {
       if (htab_expand (htab) == 0)
 	return NULL;
@@ -681,6 +897,36 @@ htab_find_slot_with_hash (htab_t htab, const void *element,
     }
 
  empty_entry:
+  if (htab->old_entries != NULL)
+    {
+      void **old_slot = find_old_slot (htab, element, hash);
+
+      if (old_slot != NULL)
+	{
+	  void **slot;
+
+	  if (insert == NO_INSERT)
+	    return old_slot;
+
+	  /* Move the element now, so that the slot returned is among
+	     the current entries.  */
+	  if (first_deleted_slot)
+	    {
+	      htab->n_deleted--;
+	      slot = first_deleted_slot;
+	    }
+	  else
+	    {
+	      htab->n_elements++;
+	      slot = &htab->entries[index];
+	    }
+	  *slot = *old_slot;
+	  *old_slot = HTAB_DELETED_ENTRY;
+	  htab->old_elements--;
+	  return slot;
+	}
+    }
+
   if (insert == NO_INSERT)
     return NULL;
 
@@ -729,11 +975,7 @@ htab_remove_elt_with_hash (htab_t htab, const void *element, hashval_t hash)
   if (slot == NULL)
     return;
 
-  if (htab->del_f)
-    (*htab->del_f) (*slot);
-
-  *slot = HTAB_DELETED_ENTRY;
-  htab->n_deleted++;
+  htab_clear_slot (htab, slot);
 }
 
 /* This function clears a specified slot in a hash table.  It is
@@ -743,7 +985,12 @@ htab_remove_elt_with_hash (htab_t htab, const void *element, hashval_t hash)
 void
 htab_clear_slot (htab_t htab, void **slot)
 {
-  if (slot < htab->entries || slot >= htab->entries + htab_size (htab)
+  int old = (htab->old_entries != NULL
+	     && slot >= htab->old_entries
+	     && slot < htab->old_entries + htab->old_size);
+
+  if ((!old
+       && (slot < htab->entries || slot >= htab->entries + htab_size (htab)))
       || *slot == HTAB_EMPTY_ENTRY || *slot == HTAB_DELETED_ENTRY)
     abort ();
 
@@ -751,7 +998,10 @@ htab_clear_slot (htab_t htab, void **slot)
     (*htab->del_f) (*slot);
 
   *slot = HTAB_DELETED_ENTRY;
-  htab->n_deleted++;
+  if (old)
+    htab->old_elements--;
+  else
+    htab->n_deleted++;
 }
 
 /* This function scans over the entire hash table calling
@@ -774,9 +1024,25 @@ htab_traverse_noresize (htab_t htab, htab_trav callback, void *info)
 
       if (x != HTAB_EMPTY_ENTRY && x != HTAB_DELETED_ENTRY)
 	if (!(*callback) (slot, info))
-	  break;
+	  return;
     }
   while (++slot < limit);
+
+  /* Then the elements not yet moved by an incremental resize.  */
+  if (htab->old_entries != NULL)
+    {
+      slot = htab->old_entries;
+      limit = slot + htab->old_size;
+      do
+	{
+	  void *x = *slot;
+
+	  if (x != HTAB_EMPTY_ENTRY && x != HTAB_DELETED_ENTRY)
+	    if (!(*callback) (slot, info))
+	      return;
+	}
+      while (++slot < limit);
+    }
 }
 
 /* Like htab_traverse_noresize, but does resize the table when it is
@@ -785,7 +1051,11 @@ htab_traverse_noresize (htab_t htab, htab_trav callback, void *info)
 void
 htab_traverse (htab_t htab, htab_trav callback, void *info)
 {
-  size_t size = htab_size (htab);
+  size_t size;
+
+  if (htab->old_entries != NULL)
+    htab_migrate (htab, (size_t) -1);
+  size = htab_size (htab);
   if (htab_elements (htab) * 8 < size && size > 32)
     htab_expand (htab);
 
@@ -129,6 +129,10 @@ The MRI compiler uses this, which is a repeat of type 5:
 
 #define CHUNK 16
 
+/* The size of the buffer records are formatted into when writing.  */
+
+#define OUTBUF_SIZE 65536
+
 /* Macros for converting between hex and binary.  */
 
 #define NIBBLE(x)    (hex_value (x))
@@ -153,6 +157,9 @@ struct ihex_data_struct
 {
   struct ihex_data_list *head;
   struct ihex_data_list *tail;
+  /* Records not yet written out, while writing.  */
+  char *outbuf;
+  size_t outlen;
 };
 
 /* Initialize by filling in the hex conversion array.  */
@@ -183,37 +190,78 @@ ihex_mkobject (bfd *abfd)
   abfd->tdata.ihex_data = tdata;
   tdata->head = NULL;
   tdata->tail = NULL;
+  tdata->outbuf = NULL;
+  tdata->outlen = 0;
   return true;
 }
 
-/* Read a byte from a BFD.  Set *ERRORPTR if an error occurred.
-   Return EOF on error or end of file.  */
+/* Intel Hex files are scanned and read from a view of the whole file,
+   rather than a byte at a time.  This is a position in that view.  */
 
-static inline int
-ihex_get_byte (bfd *abfd, bool *errorptr)
+struct ihex_cursor
+{
+  /* The start of the file.  */
+  const bfd_byte *start;
+  /* The next byte to read.  */
+  const bfd_byte *p;
+  /* The end of the file.  */
+  const bfd_byte *end;
+};
+
+/* Point CUR at file position POS of ABFD.  Return FALSE on error.  */
+
+static bool
+ihex_init_cursor (bfd *abfd, file_ptr pos, struct ihex_cursor *cur)
 {
-  bfd_byte c;
+  bfd_size_type size = bfd_get_file_size (abfd);
 
-  if (bfd_bread (&c, (bfd_size_type) 1, abfd) != 1)
+  cur->start = _bfd_file_view (abfd, 0, size);
+  if (cur->start == NULL)
+    return false;
+  if ((bfd_size_type) pos > size)
     {
-      if (bfd_get_error () != bfd_error_file_truncated)
-	*errorptr = true;
-      return EOF;
+      bfd_set_error (bfd_error_file_truncated);
+      return false;
     }
+  cur->p = cur->start + pos;
+  cur->end = cur->start + size;
+  return true;
+}
+
+/* Read a byte from an Intel Hex file.  Return EOF at end of file.  */
+
+static inline int
+ihex_get_byte (struct ihex_cursor *cur)
+{
+  if (cur->p >= cur->end)
+    return EOF;
+  return *cur->p++;
+}
+
+/* Return a pointer to the next COUNT bytes of an Intel Hex file, or
+   NULL if the file ends first.  */
+
+static inline const bfd_byte *
+ihex_get_bytes (struct ihex_cursor *cur, size_t count)
+{
+  const bfd_byte *p = cur->p;
 
-  return (int) (c & 0xff);
+  if ((size_t) (cur->end - p) < count)
+    {
+      bfd_set_error (bfd_error_file_truncated);
+      return NULL;
+    }
+  cur->p += count;
+  return p;
 }
 
 /* Report a problem in an Intel Hex file.  */
 
 static void
-ihex_bad_byte (bfd *abfd, unsigned int lineno, int c, bool error)
+ihex_bad_byte (bfd *abfd, unsigned int lineno, int c)
 {
   if (c == EOF)
-    {
-      if (! error)
-	bfd_set_error (bfd_error_file_truncated);
-    }
+    bfd_set_error (bfd_error_file_truncated);
   else
     {
       char buf[10];
@@ -243,13 +291,12 @@ ihex_scan (bfd *abfd)
   bfd_vma extbase;
   asection *sec;
   unsigned int lineno;
-  bool error;
-  bfd_byte *buf = NULL;
-  size_t bufsize;
+  struct ihex_cursor cur;
+  bfd_byte buf[255 + 1];
   int c;
 
-  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0)
-    goto error_return;
+  if (! ihex_init_cursor (abfd, 0, &cur))
+    return false;
 
   abfd->start_address = 0;
 
@@ -257,10 +304,8 @@ ihex_scan (bfd *abfd)
   extbase = 0;
   sec = NULL;
   lineno = 1;
-  error = false;
-  bufsize = 0;
 
-  while ((c = ihex_get_byte (abfd, &error)) != EOF)
+  while ((c = ihex_get_byte (&cur)) != EOF)
     {
       if (c == '\r')
 	continue;
@@ -271,33 +316,34 @@ ihex_scan (bfd *abfd)
 	}
       else if (c != ':')
 	{
-	  ihex_bad_byte (abfd, lineno, c, error);
-	  goto error_return;
+	  ihex_bad_byte (abfd, lineno, c);
+	  return false;
 	}
       else
 	{
 	  file_ptr pos;
-	  unsigned char hdr[8];
+	  const bfd_byte *hdr;
+	  const bfd_byte *chars;
 	  unsigned int i;
 	  unsigned int len;
 	  bfd_vma addr;
 	  unsigned int type;
-	  unsigned int chars;
 	  unsigned int chksum;
 
 	  /* This is a data record.  */
-	  pos = bfd_tell (abfd) - 1;
+	  pos = cur.p - 1 - cur.start;
 
 	  /* Read the header bytes.  */
-	  if (bfd_bread (hdr, (bfd_size_type) 8, abfd) != 8)
-	    goto error_return;
+	  hdr = ihex_get_bytes (&cur, 8);
+	  if (hdr == NULL)
+	    return false;
 
 	  for (i = 0; i < 8; i++)
 	    {
 	      if (! ISHEX (hdr[i]))
 		{
-		  ihex_bad_byte (abfd, lineno, hdr[i], error);
-		  goto error_return;
+		  ihex_bad_byte (abfd, lineno, hdr[i]);
+		  return false;
 		}
 	    }
 
@@ -305,41 +351,32 @@ ihex_scan (bfd *abfd)
 	  addr = HEX4 (hdr + 2);
 	  type = HEX2 (hdr + 6);
 
-	  /* Read the data bytes.  */
-	  chars = len * 2 + 2;
-	  if (chars >= bufsize)
-	    {
-	      buf = (bfd_byte *) bfd_realloc (buf, (bfd_size_type) chars);
-	      if (buf == NULL)
-		goto error_return;
-	      bufsize = chars;
-	    }
-
-	  if (bfd_bread (buf, (bfd_size_type) chars, abfd) != chars)
-	    goto error_return;
+	  /* Decode the data bytes and the checksum.  */
+	  chars = ihex_get_bytes (&cur, (size_t) len * 2 + 2);
+	  if (chars == NULL)
+	    return false;
 
-	  for (i = 0; i < chars; i++)
+	  if (! _bfd_hex_decode (buf, chars, len + 1))
 	    {
-	      if (! ISHEX (buf[i]))
-		{
-		  ihex_bad_byte (abfd, lineno, buf[i], error);
-		  goto error_return;
-		}
+	      for (i = 0; ISHEX (chars[i]); i++)
+		;
+	      ihex_bad_byte (abfd, lineno, chars[i]);
+	      return false;
 	    }
 
 	  /* Check the checksum.  */
 	  chksum = len + addr + (addr >> 8) + type;
 	  for (i = 0; i < len; i++)
-	    chksum += HEX2 (buf + 2 * i);
-	  if (((- chksum) & 0xff) != (unsigned int) HEX2 (buf + 2 * i))
+	    chksum += buf[i];
+	  if (((- chksum) & 0xff) != buf[len])
 	    {
 	      _bfd_error_handler
 		/* xgettext:c-format */
 		(_("%pB:%u: bad checksum in Intel Hex file (expected %u, found %u)"),
 		 abfd, lineno,
-		 (- chksum) & 0xff, (unsigned int) HEX2 (buf + 2 * i));
+		 (- chksum) & 0xff, (unsigned int) buf[len]);
 	      bfd_set_error (bfd_error_bad_value);
-	      goto error_return;
+	      return false;
 	    }
 
 	  switch (type)
@@ -364,12 +401,12 @@ ihex_scan (bfd *abfd)
 		  amt = strlen (secbuf) + 1;
 		  secname = (char *) bfd_alloc (abfd, amt);
 		  if (secname == NULL)
-		    goto error_return;
+		    return false;
 		  strcpy (secname, secbuf);
 		  flags = SEC_HAS_CONTENTS | SEC_LOAD | SEC_ALLOC;
 		  sec = bfd_make_section_with_flags (abfd, secname, flags);
 		  if (sec == NULL)
-		    goto error_return;
+		    return false;
 		  sec->vma = extbase + segbase + addr;
 		  sec->lma = extbase + segbase + addr;
 		  sec->size = len;
@@ -381,7 +418,6 @@ ihex_scan (bfd *abfd)
 	      /* An end record.  */
 	      if (abfd->start_address == 0)
 		abfd->start_address = addr;
-	      free (buf);
 	      return true;
 
 	    case 2:
@@ -393,10 +429,10 @@ ihex_scan (bfd *abfd)
 		    (_("%pB:%u: bad extended address record length in Intel Hex file"),
 		     abfd, lineno);
 		  bfd_set_error (bfd_error_bad_value);
-		  goto error_return;
+		  return false;
 		}
 
-	      segbase = HEX4 (buf) << 4;
+	      segbase = (((bfd_vma) buf[0] << 8) | buf[1]) << 4;
 
 	      sec = NULL;
 
@@ -411,10 +447,10 @@ ihex_scan (bfd *abfd)
 		    (_("%pB:%u: bad extended start address length in Intel Hex file"),
 		     abfd, lineno);
 		  bfd_set_error (bfd_error_bad_value);
-		  goto error_return;
+		  return false;
 		}
 
-	      abfd->start_address += (HEX4 (buf) << 4) + HEX4 (buf + 4);
+	      abfd->start_address += ((((bfd_vma) buf[0] << 8) | buf[1]) << 4) + (((bfd_vma) buf[2] << 8) | buf[3]);
 
 	      sec = NULL;
 
@@ -429,10 +465,10 @@ ihex_scan (bfd *abfd)
 		    (_("%pB:%u: bad extended linear address record length in Intel Hex file"),
 		     abfd, lineno);
 		  bfd_set_error (bfd_error_bad_value);
-		  goto error_return;
+		  return false;
 		}
 
-	      extbase = HEX4 (buf) << 16;
+	      extbase = (((bfd_vma) buf[0] << 8) | buf[1]) << 16;
 
 	      sec = NULL;
 
@@ -447,13 +483,13 @@ ihex_scan (bfd *abfd)
 		    (_("%pB:%u: bad extended linear start address length in Intel Hex file"),
 		     abfd, lineno);
 		  bfd_set_error (bfd_error_bad_value);
-		  goto error_return;
+		  return false;
 		}
 
 	      if (len == 2)
-		abfd->start_address += HEX4 (buf) << 16;
+		abfd->start_address += (((bfd_vma) buf[0] << 8) | buf[1]) << 16;
 	      else
-		abfd->start_address = (HEX4 (buf) << 16) + HEX4 (buf + 4);
+		abfd->start_address = ((((bfd_vma) buf[0] << 8) | buf[1]) << 16) + (((bfd_vma) buf[2] << 8) | buf[3]);
 
 	      sec = NULL;
 
@@ -465,20 +501,12 @@ ihex_scan (bfd *abfd)
 		(_("%pB:%u: unrecognized ihex type %u in Intel Hex file"),
 		 abfd, lineno, type);
 	      bfd_set_error (bfd_error_bad_value);
-	      goto error_return;
+	      return false;
 	    }
 	}
     }
 
-  if (error)
-    goto error_return;
-
-  free (buf);
   return true;
-
- error_return:
-  free (buf);
-  return false;
 }
 
 /* Try to recognize an Intel Hex file.  */
@@ -544,22 +572,18 @@ ihex_read_section (bfd *abfd, asection *section, bfd_byte *contents)
 {
   int c;
   bfd_byte *p;
-  bfd_byte *buf = NULL;
-  size_t bufsize;
-  bool error;
+  struct ihex_cursor cur;
 
-  if (bfd_seek (abfd, section->filepos, SEEK_SET) != 0)
-    goto error_return;
+  if (! ihex_init_cursor (abfd, section->filepos, &cur))
+    return false;
 
   p = contents;
-  bufsize = 0;
-  error = false;
-  while ((c = ihex_get_byte (abfd, &error)) != EOF)
+  while ((c = ihex_get_byte (&cur)) != EOF)
     {
-      unsigned char hdr[8];
+      const bfd_byte *hdr;
+      const bfd_byte *data;
       unsigned int len;
       unsigned int type;
-      unsigned int i;
 
       if (c == '\r' || c == '\n')
 	continue;
@@ -568,8 +592,9 @@ ihex_read_section (bfd *abfd, asection *section, bfd_byte *contents)
 	 know the exact format.  */
       BFD_ASSERT (c == ':');
 
-      if (bfd_bread (hdr, (bfd_size_type) 8, abfd) != 8)
-	goto error_return;
+      hdr = ihex_get_bytes (&cur, 8);
+      if (hdr == NULL)
+	return false;
 
       len = HEX2 (hdr);
       type = HEX2 (hdr + 6);
@@ -580,32 +605,26 @@ ihex_read_section (bfd *abfd, asection *section, bfd_byte *contents)
 	  _bfd_error_handler
 	    (_("%pB: internal error in ihex_read_section"), abfd);
 	  bfd_set_error (bfd_error_bad_value);
-	  goto error_return;
-	}
-
-      if (len * 2 > bufsize)
-	{
-	  buf = (bfd_byte *) bfd_realloc (buf, (bfd_size_type) len * 2);
-	  if (buf == NULL)
-	    goto error_return;
-	  bufsize = len * 2;
+	  return false;
 	}
 
-      if (bfd_bread (buf, (bfd_size_type) len * 2, abfd) != len * 2)
-	goto error_return;
+      data = ihex_get_bytes (&cur, (size_t) len * 2);
+      if (data == NULL)
+	return false;
 
-      for (i = 0; i < len; i++)
-	*p++ = HEX2 (buf + 2 * i);
+      if (len > section->size - (bfd_size_type) (p - contents))
+	len = section->size - (p - contents);
+      _bfd_hex_decode (p, data, len);
+      p += len;
       if ((bfd_size_type) (p - contents) >= section->size)
 	{
 	  /* We've read everything in the section.  */
-	  free (buf);
 	  return true;
 	}
 
       /* Skip the checksum.  */
-      if (bfd_bread (buf, (bfd_size_type) 2, abfd) != 2)
-	goto error_return;
+      if (ihex_get_bytes (&cur, 2) == NULL)
+	return false;
     }
 
   if ((bfd_size_type) (p - contents) < section->size)
@@ -613,15 +632,10 @@ ihex_read_section (bfd *abfd, asection *section, bfd_byte *contents)
       _bfd_error_handler
 	(_("%pB: bad section length in ihex_read_section"), abfd);
       bfd_set_error (bfd_error_bad_value);
-      goto error_return;
+      return false;
     }
 
-  free (buf);
   return true;
-
- error_return:
-  free (buf);
-  return false;
 }
 
 /* Get the contents of a section in an Intel Hex file.  */
@@ -707,6 +721,18 @@ ihex_set_section_contents (bfd *abfd,
   return true;
 }
 
+/* Write out the records collected by ihex_write_record.  */
+
+static bool
+ihex_flush_records (bfd *abfd)
+{
+  struct ihex_data_struct *tdata = abfd->tdata.ihex_data;
+  size_t len = tdata->outlen;
+
+  tdata->outlen = 0;
+  return bfd_bwrite (tdata->outbuf, len, abfd) == len;
+}
+
 /* Write a record out to an Intel Hex file.  */
 
 static bool
@@ -717,12 +743,19 @@ ihex_write_record (bfd *abfd,
 		   bfd_byte *data)
 {
   static const char digs[] = "0123456789ABCDEF";
-  char buf[9 + CHUNK * 2 + 4];
+  struct ihex_data_struct *tdata = abfd->tdata.ihex_data;
+  char *buf;
   char *p;
   unsigned int chksum;
-  unsigned int i;
   size_t total;
 
+  /* Records are collected in OUTBUF and written out when it fills.  */
+  total = 9 + count * 2 + 4;
+  if (tdata->outlen + total > OUTBUF_SIZE
+      && ! ihex_flush_records (abfd))
+    return false;
+  buf = tdata->outbuf + tdata->outlen;
+
 #define TOHEX(buf, v) \
   ((buf)[0] = digs[((v) >> 4) & 0xf], (buf)[1] = digs[(v) & 0xf])
 
@@ -734,27 +767,22 @@ ihex_write_record (bfd *abfd,
 
   chksum = count + addr + (addr >> 8) + type;
 
-  for (i = 0, p = buf + 9; i < count; i++, p += 2, data++)
-    {
-      TOHEX (p, *data);
-      chksum += *data;
-    }
+  p = buf + 9;
+  chksum += _bfd_hex_encode (p, data, count);
+  p += count * 2;
 
   TOHEX (p, (- chksum) & 0xff);
   p[2] = '\r';
   p[3] = '\n';
 
-  total = 9 + count * 2 + 4;
-  if (bfd_bwrite (buf, (bfd_size_type) total, abfd) != total)
-    return false;
-
+  tdata->outlen += total;
   return true;
 }
 
-/* Write out an Intel Hex file.  */
+/* Write out the records of an Intel Hex file.  */
 
 static bool
-ihex_write_object_contents (bfd *abfd)
+ihex_write_records (bfd *abfd)
 {
   bfd_vma segbase;
   bfd_vma extbase;
@@ -901,6 +929,26 @@ ihex_write_object_contents (bfd *abfd)
   return true;
 }
 
+/* Write out an Intel Hex file.  */
+
+static bool
+ihex_write_object_contents (bfd *abfd)
+{
+  struct ihex_data_struct *tdata = abfd->tdata.ihex_data;
+  bool ret;
+
+  tdata->outbuf = (char *) bfd_malloc (OUTBUF_SIZE);
+  if (tdata->outbuf == NULL)
+    return false;
+  tdata->outlen = 0;
+
+  ret = ihex_write_records (abfd) && ihex_flush_records (abfd);
+
+  free (tdata->outbuf);
+  tdata->outbuf = NULL;
+  return ret;
+}
+
 /* Set the architecture for the output file.  The architecture is
    irrelevant, so we ignore errors about unknown architectures.  */
 
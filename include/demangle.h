@@ -146,6 +146,24 @@ cplus_demangle_v3_callback (const char *mangled, int options,
 extern char*
 cplus_demangle_v3 (const char *mangled, int options);
 
+/* Storage for cplus_demangle_v3_context, kept between calls so that
+   demangling many names doesn't allocate for each one.  A context may
+   only be used by one thread at a time.  */
+struct demangle_context;
+
+extern struct demangle_context *
+cplus_demangle_context_new (void);
+
+extern void
+cplus_demangle_context_free (struct demangle_context *ctx);
+
+/* Demangle MANGLED as cplus_demangle_v3 does into a buffer belonging
+   to CTX, valid until the next call with CTX, storing its length in
+   *PLEN if PLEN isn't NULL.  Returns NULL on error.  */
+extern char *
+cplus_demangle_v3_context (struct demangle_context *ctx, const char *mangled,
+			   int options, size_t *plen);
+
 extern int
 java_demangle_v3_callback (const char *mangled,
                            demangle_callbackref callback, void *opaque);
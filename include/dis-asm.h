@@ -460,6 +460,48 @@ extern int buffer_read_memory
    It prints a message using info->fprintf_func and info->stream.  */
 extern void perror_memory (int, bfd_vma, struct disassemble_info *);
 
+/* If read_memory_func is buffer_read_memory, return a pointer to the
+   LENGTH octets at the given address inside the buffer, so that they
+   need not be copied.  Returns NULL if read_memory_func is something
+   else, or if the octets are not all inside the buffer and before
+   stop_vma; read_memory_func then gives the bytes or the error.  */
+extern const bfd_byte *buffer_memory_pointer
+  (bfd_vma, unsigned int, struct disassemble_info *);
+
+/* For decoders: return a pointer to LENGTH bytes at the given address,
+   from buffer_memory_pointer where possible and otherwise read with
+   read_memory_func into the LENGTH byte SCRATCH buffer.  Returns NULL
+   and sets *STATUS to what read_memory_func returned if the bytes
+   cannot be read.  */
+extern const bfd_byte *disassemble_read_pointer
+  (bfd_vma, unsigned int, bfd_byte * /*scratch*/, int * /*status*/,
+   struct disassemble_info *);
+
+/* One instruction found by disassemble_decode.  The fields other than
+   VMA and OCTETS are those the decoder left in the disassemble_info,
+   and mean something only if INSN_INFO_VALID is set.  */
+struct disassemble_insn
+{
+  bfd_vma vma;			/* Address of the instruction.  */
+  unsigned int octets;		/* Its length in octets.  */
+  char insn_info_valid;		/* The decoder set the fields below.  */
+  char branch_delay_insns;	/* As in disassemble_info.  */
+  char data_size;		/* Size of the memory operand, in bytes.  */
+  enum dis_insn_type insn_type;	/* Class of the instruction.  */
+  bfd_vma target;		/* Branch, call or data target, or zero.  */
+  bfd_vma target2;		/* Second target for dis_dref2.  */
+};
+
+/* Decode instructions from the buffer of INFO with DISASSEMBLE_FN,
+   starting at VMA and not starting any at or past END, into at most
+   COUNT records of INSNS, without formatting any text.  Returns the
+   number of instructions decoded, which is less than COUNT if END, the
+   end of the buffer or an instruction that could not be decoded was
+   reached.  */
+extern size_t disassemble_decode
+  (disassembler_ftype, struct disassemble_info *, bfd_vma, bfd_vma,
+   struct disassemble_insn *, size_t);
+
 
 /* Just print the address in hex.  This is included for completeness even
    though both GDB and objdump provide their own (to print symbolic
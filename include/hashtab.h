@@ -134,6 +134,24 @@ struct htab {
   /* Current size (in entries) of the hash table, as an index into the
      table of primes.  */
   unsigned int size_prime_index;
+
+  /* Nonzero if the table grows incrementally: rather than rehashing
+     every element at once, a resize keeps the old entries aside and
+     moves a few of them into the new table on each later insertion.  */
+  int incremental;
+
+  /* The entries of the table before a resize that are still to be
+     moved, or NULL.  */
+  void **old_entries;
+
+  /* The size of OLD_ENTRIES, and its index into the table of primes.  */
+  size_t old_size;
+  unsigned int old_size_prime_index;
+
+  /* The number of live elements left in OLD_ENTRIES, and the index of
+     the next slot there to move.  */
+  size_t old_elements;
+  size_t old_scan;
 };
 
 typedef struct htab *htab_t;
@@ -164,6 +182,9 @@ extern void	htab_set_functions_ex (htab_t, htab_hash,
                                        void *, htab_alloc_with_arg,
                                        htab_free_with_arg);
 
+extern void	htab_set_incremental (htab_t, int);
+extern int	htab_reserve (htab_t, size_t);
+
 extern void	htab_delete (htab_t);
 extern void	htab_empty (htab_t);
 
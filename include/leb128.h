@@ -0,0 +1,195 @@
+/* Inline LEB128 decoding.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+This file is part of the libiberty library.
+Libiberty is free software; you can redistribute it and/or
+modify it under the terms of the GNU Library General Public
+License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+Libiberty is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Library General Public License for more details.
+
+You should have received a copy of the GNU Library General Public
+License along with libiberty; see the file COPYING.LIB.  If
+not, write to the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+Boston, MA 02110-1301, USA.  */
+
+/* A LEB128 number is a run of bytes with the high bit set, ended by
+   one with it clear; the low seven bits of each byte are the value,
+   least significant group first.  Almost every number in DWARF and
+   in unwind tables fits in one or two bytes, so the decoders here
+   take a single byte without touching anything else, and otherwise
+   decode up to eight bytes at once from a 64-bit word: the first
+   clear high bit gives the length, and three shift-and-mask steps
+   squeeze out the continuation bits.  Only numbers longer than eight
+   bytes, or ones that run into the end of the buffer, go byte by
+   byte.
+
+   Each decoder is given the first byte and the end of the buffer,
+   and reads nothing at or past the end.  It returns the number of
+   bytes in the encoding, or zero if the buffer ends before the
+   encoding does.  Bits beyond the sixty-fourth are dropped, as the
+   byte-at-a-time loops elsewhere in binutils do.  */
+
+#ifndef LEB128_H
+#define LEB128_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LEB128_HIGH_BITS 0x8080808080808080ULL
+#define LEB128_LOW_BITS  0x7f7f7f7f7f7f7f7fULL
+#define LEB128_BYTE_ONES 0x0101010101010101ULL
+
+/* The eight bytes at BUF as a little-endian number, whatever the
+   host's byte order.  Compilers turn this into a single load on
+   hosts that allow unaligned ones.  */
+
+static inline uint64_t
+leb128_load64 (const unsigned char *buf)
+{
+  return ((uint64_t) buf[0]
+	  | (uint64_t) buf[1] << 8
+	  | (uint64_t) buf[2] << 16
+	  | (uint64_t) buf[3] << 24
+	  | (uint64_t) buf[4] << 32
+	  | (uint64_t) buf[5] << 40
+	  | (uint64_t) buf[6] << 48
+	  | (uint64_t) buf[7] << 56);
+}
+
+/* Decode the unsigned number at BUF byte by byte.  */
+
+static inline size_t
+leb128_read_unsigned_slow (const unsigned char *buf,
+			   const unsigned char *buf_end, uint64_t *r)
+{
+  const unsigned char *p = buf;
+  unsigned int shift = 0;
+  uint64_t result = 0;
+
+  while (p < buf_end)
+    {
+      unsigned char byte = *p++;
+
+      if (shift < 64)
+	{
+	  result |= (uint64_t) (byte & 0x7f) << shift;
+	  shift += 7;
+	}
+      if ((byte & 0x80) == 0)
+	{
+	  *r = result;
+	  return p - buf;
+	}
+    }
+  return 0;
+}
+
+/* Decode the unsigned number at BUF into *R.  */
+
+static inline size_t
+leb128_read_unsigned (const unsigned char *buf,
+		      const unsigned char *buf_end, uint64_t *r)
+{
+  if (buf < buf_end && buf[0] < 0x80)
+    {
+      *r = buf[0];
+      return 1;
+    }
+
+  if (buf < buf_end && buf_end - buf >= 8)
+    {
+      uint64_t w = leb128_load64 (buf);
+      uint64_t stop = ~w & LEB128_HIGH_BITS;
+
+      if (stop != 0)
+	{
+	  /* KEEP covers the bytes up to and including the last one;
+	     its low bit in each byte adds up to the length.  */
+	  uint64_t keep = stop ^ (stop - 1);
+	  size_t len = ((keep & LEB128_BYTE_ONES) * LEB128_BYTE_ONES) >> 56;
+
+	  w &= keep & LEB128_LOW_BITS;
+	  w = (((w & 0x7f007f007f007f00ULL) >> 1)
+	       | (w & 0x007f007f007f007fULL));
+	  w = (((w & 0x3fff00003fff0000ULL) >> 2)
+	       | (w & 0x00003fff00003fffULL));
+	  w = (((w & 0x0fffffff00000000ULL) >> 4)
+	       | (w & 0x000000000fffffffULL));
+	  *r = w;
+	  return len;
+	}
+    }
+
+  return leb128_read_unsigned_slow (buf, buf_end, r);
+}
+
+/* Decode the signed number at BUF into *R.  */
+
+static inline size_t
+leb128_read_signed (const unsigned char *buf,
+		    const unsigned char *buf_end, int64_t *r)
+{
+  uint64_t result;
+  size_t len = leb128_read_unsigned (buf, buf_end, &result);
+
+  if (len != 0 && len * 7 < 64 && (buf[len - 1] & 0x40) != 0)
+    result |= -((uint64_t) 1 << (len * 7));
+  *r = (int64_t) result;
+  return len;
+}
+
+/* Decode COUNT unsigned numbers one after another at BUF into R[0]
+   to R[COUNT - 1].  Return the number of bytes in all of them, or
+   zero if the buffer ends first.  */
+
+static inline size_t
+leb128_read_unsigned_array (const unsigned char *buf,
+			    const unsigned char *buf_end,
+			    uint64_t *r, size_t count)
+{
+  const unsigned char *p = buf;
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    {
+      size_t len = leb128_read_unsigned (p, buf_end, &r[i]);
+
+      if (len == 0)
+	return 0;
+      p += len;
+    }
+  return p - buf;
+}
+
+/* Return the length of the number at BUF without decoding it.  */
+
+static inline size_t
+leb128_skip (const unsigned char *buf, const unsigned char *buf_end)
+{
+  const unsigned char *p = buf;
+
+  if (buf < buf_end && buf_end - buf >= 8)
+    {
+      uint64_t stop = ~leb128_load64 (buf) & LEB128_HIGH_BITS;
+
+      if (stop != 0)
+	{
+	  uint64_t keep = stop ^ (stop - 1);
+
+	  return ((keep & LEB128_BYTE_ONES) * LEB128_BYTE_ONES) >> 56;
+	}
+    }
+
+  while (p < buf_end)
+    if ((*p++ & 0x80) == 0)
+      return p - buf;
+  return 0;
+}
+
+#endif /* LEB128_H */
@@ -46,6 +46,7 @@ struct objalloc
   char *current_ptr;
   unsigned int current_space;
   void *chunks;
+  unsigned int chunk_size;
 };
 
 /* Work out the required alignment.  */
@@ -112,4 +113,23 @@ extern void objalloc_free (struct objalloc *);
 
 extern void objalloc_free_block (struct objalloc *, void *);
 
+/* Memory held by an objalloc structure, as reported by
+   objalloc_stats.  */
+
+struct objalloc_stats
+{
+  /* Chunks shared by small objects, and their total size.  */
+  unsigned long long small_chunks;
+  unsigned long long small_bytes;
+  /* Chunks holding a single large object each, and their total size.  */
+  unsigned long long large_chunks;
+  unsigned long long large_bytes;
+  /* Space not yet used in the chunk currently being filled.  */
+  unsigned long long free_bytes;
+};
+
+/* Fill in STATS for an objalloc structure.  */
+
+extern void objalloc_stats (struct objalloc *, struct objalloc_stats *);
+
 #endif /* OBJALLOC_H */
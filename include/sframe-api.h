@@ -145,6 +145,14 @@ extern int
 sframe_find_fre (sframe_decoder_ctx *ctx, int32_t pc,
 		 sframe_frame_row_entry *frep);
 
+/* Ask that sframe_find_fre on the decoder CTX use an index of the FREs,
+   built on the first lookup, so that finding the FRE within a function
+   is a binary search rather than a walk through its FREs.  Returns
+   SFRAME_ERR if failure.  */
+
+extern int
+sframe_decoder_use_fre_index (sframe_decoder_ctx *ctx);
+
 /* Get the FRE_IDX'th FRE of the function at FUNC_IDX'th function
    index entry in the SFrame decoder CTX.  Returns error code as
    applicable.  */
@@ -235,6 +243,31 @@ sframe_encoder_add_funcdesc (sframe_encoder_ctx *encoder,
 			     unsigned char func_info,
 			     uint32_t num_fres);
 
+/* Add the function descriptor entries of the decoder DCTX, with all of
+   their FREs, to ENCODER.  START_ADDRS, if not NULL, gives the start
+   address to use for each function, and functions for which SKIP, if not
+   NULL, is nonzero are left out.  With an FRE sink, the FREs are passed
+   on without being decoded.  Returns SFRAME_ERR if failure.  */
+extern int
+sframe_encoder_add_decoder (sframe_encoder_ctx *encoder,
+			    sframe_decoder_ctx *dctx,
+			    const int32_t *start_addrs,
+			    const unsigned char *skip);
+
+/* Make ENCODER encode each FRE as it is added and pass its bytes to SINK
+   with DATA, rather than keeping it until sframe_encoder_write.  The FRE
+   sub-section is then the bytes passed to SINK, in order, and the
+   buffer from sframe_encoder_write holds only the header and the FDE
+   table that precede it.  FREs must be added to the last function
+   descriptor entry added.  SINK returns zero on success.  This must be
+   called before anything is added to ENCODER.  Returns SFRAME_ERR if
+   failure.  */
+extern int
+sframe_encoder_set_fre_sink (sframe_encoder_ctx *encoder,
+			     int (*sink) (void *data, const char *buf,
+					  size_t size),
+			     void *data);
+
 /* Serialize the contents of the encoder and return the buffer.  ENCODED_SIZE
    is updated to the size of the buffer.  Sets ERRP if failure.  */
 extern char  *
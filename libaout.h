@@ -55,6 +55,8 @@
 #if ARCH_SIZE==64
 #define GET_WORD  H_GET_64
 #define GET_SWORD H_GET_S64
+#define HOST_GET_WORD(p)  ((bfd_vma) _bfd_host_get_64 (p))
+#define HOST_GET_SWORD(p) ((bfd_signed_vma) (int64_t) _bfd_host_get_64 (p))
 #define GET_MAGIC H_GET_32
 #define PUT_WORD  H_PUT_64
 #define PUT_MAGIC H_PUT_32
@@ -67,6 +69,8 @@
 #if ARCH_SIZE==16
 #define GET_WORD  H_GET_16
 #define GET_SWORD H_GET_S16
+#define HOST_GET_WORD(p)  ((bfd_vma) _bfd_host_get_16 (p))
+#define HOST_GET_SWORD(p) ((bfd_signed_vma) (int16_t) _bfd_host_get_16 (p))
 #define GET_MAGIC H_GET_16
 #define PUT_WORD  H_PUT_16
 #define PUT_MAGIC H_PUT_16
@@ -78,6 +82,8 @@
 #else /* ARCH_SIZE == 32 */
 #define GET_WORD  H_GET_32
 #define GET_SWORD H_GET_S32
+#define HOST_GET_WORD(p)  ((bfd_vma) _bfd_host_get_32 (p))
+#define HOST_GET_SWORD(p) ((bfd_signed_vma) (int32_t) _bfd_host_get_32 (p))
 #define GET_MAGIC H_GET_32
 #define PUT_WORD  H_PUT_32
 #define PUT_MAGIC H_PUT_32
@@ -23,6 +23,7 @@
 #include "bfd.h"
 #include "libbfd.h"
 #include "objalloc.h"
+#include "leb128.h"
 
 #ifndef HAVE_GETPAGESIZE
 #define getpagesize() 2048
@@ -417,6 +418,11 @@ bfd_zmalloc (bfd_size_type size)
   return ptr;
 }
 
+/* Whether bfd_set_memory_accounting has turned accounting on, and the
+   class that the calling thread's bfd_alloc calls are counted in.  */
+static bool memory_accounting;
+static TLS enum bfd_memory_class memory_class;
+
 /*
 FUNCTION
 	bfd_alloc
@@ -453,7 +459,11 @@ bfd_alloc (bfd *abfd, bfd_size_type size)
   if (ret == NULL)
     bfd_set_error (bfd_error_no_memory);
   else
-    abfd->alloc_size += size;
+    {
+      abfd->alloc_size += size;
+      if (memory_accounting)
+	_bfd_memory_account (abfd, memory_class, size);
+    }
   return ret;
 }
 
@@ -498,6 +508,346 @@ bfd_release (bfd *abfd, void *block)
   objalloc_free_block ((struct objalloc *) abfd->memory, block);
 }
 
+/*
+CODE_FRAGMENT
+.{* Memory used by the <<bfd_alloc>> arena of a BFD.  *}
+.struct bfd_arena_stats
+.{
+.  {* Bytes requested by <<bfd_alloc>> since the BFD was opened.  *}
+.  bfd_size_type requested;
+.
+.  {* Chunks shared by small objects, and their total size.  *}
+.  bfd_size_type small_chunks;
+.  bfd_size_type small_bytes;
+.
+.  {* Chunks holding a single large object each, and their total size.  *}
+.  bfd_size_type large_chunks;
+.  bfd_size_type large_bytes;
+.
+.  {* Space not yet used in the chunk currently being filled.  *}
+.  bfd_size_type free_bytes;
+.};
+.
+*/
+
+/*
+FUNCTION
+	bfd_get_arena_stats
+
+SYNOPSIS
+	bool bfd_get_arena_stats (bfd *abfd, struct bfd_arena_stats *stats);
+
+DESCRIPTION
+	Fill in @var{stats} with the memory held by the arena that
+	<<bfd_alloc>> uses for @var{abfd}.  The arena hands out small
+	objects from chunks that double in size as it grows, and gives
+	objects of at least an eighth of the next chunk size a chunk of
+	their own.  Return <<FALSE>> if @var{abfd} has no arena.
+*/
+
+bool
+bfd_get_arena_stats (bfd *abfd, struct bfd_arena_stats *stats)
+{
+  struct objalloc_stats ostats;
+
+  if (abfd->memory == NULL)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  objalloc_stats ((struct objalloc *) abfd->memory, &ostats);
+  stats->requested = abfd->alloc_size;
+  stats->small_chunks = ostats.small_chunks;
+  stats->small_bytes = ostats.small_bytes;
+  stats->large_chunks = ostats.large_chunks;
+  stats->large_bytes = ostats.large_bytes;
+  stats->free_bytes = ostats.free_bytes;
+  return true;
+}
+
+/*
+CODE_FRAGMENT
+.{* What memory that BFD allocates is used for.  *}
+.enum bfd_memory_class
+.{
+.  {* Anything not in another class.  *}
+.  bfd_memory_other,
+.  {* Section headers and the per-BFD section hash table.  *}
+.  bfd_memory_sections,
+.  {* Symbol tables read from files.  *}
+.  bfd_memory_symbols,
+.  {* Relocations read from files.  *}
+.  bfd_memory_relocs,
+.  {* String tables being built for output.  *}
+.  bfd_memory_strtab,
+.  {* Debug information read by the DWARF line lookup.  *}
+.  bfd_memory_dwarf,
+.  {* Tables for merging SEC_MERGE sections.  *}
+.  bfd_memory_merge,
+.  {* Other hash tables, such as the linker's symbol table.  *}
+.  bfd_memory_hash,
+.  bfd_memory_class_count
+.};
+.
+.{* Memory that BFD holds, by class.  *}
+.struct bfd_memory_usage
+.{
+.  {* Bytes held now, and the most held at once.  *}
+.  bfd_size_type current[bfd_memory_class_count];
+.  bfd_size_type peak[bfd_memory_class_count];
+.};
+.
+*/
+
+/* The memory held across all BFDs and hash tables, and the lock that
+   protects it.  */
+static struct bfd_memory_usage memory_total;
+static bfd_mutex memory_lock = BFD_MUTEX_INIT;
+
+/*
+FUNCTION
+	bfd_set_memory_accounting
+
+SYNOPSIS
+	bool bfd_set_memory_accounting (bool enable);
+
+DESCRIPTION
+	Turn on or off the counting, by class, of the memory that
+	<<bfd_alloc>> and BFD hash tables hold.  Only memory allocated
+	while accounting is on is counted, so it should be turned on
+	before any BFD is opened.  Memory from <<bfd_malloc>> is not
+	counted, since it is freed without BFD seeing its size.
+	Returns the previous setting.
+*/
+
+bool
+bfd_set_memory_accounting (bool enable)
+{
+  bool old = memory_accounting;
+
+  memory_accounting = enable;
+  return old;
+}
+
+/*
+FUNCTION
+	bfd_get_memory_usage
+
+SYNOPSIS
+	bool bfd_get_memory_usage
+	  (const bfd *abfd, struct bfd_memory_usage *usage);
+
+DESCRIPTION
+	Fill in @var{usage} with the memory that <<bfd_alloc>> holds
+	for @var{abfd}, or if @var{abfd} is NULL, with the memory held
+	for all BFDs and hash tables, such as those of a link.
+	Returns <<FALSE>> if accounting is off.
+*/
+
+bool
+bfd_get_memory_usage (const bfd *abfd, struct bfd_memory_usage *usage)
+{
+  if (!memory_accounting)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  if (abfd != NULL)
+    {
+      if (abfd->memory_usage != NULL)
+	*usage = *abfd->memory_usage;
+      else
+	memset (usage, 0, sizeof (*usage));
+      return true;
+    }
+
+  _bfd_mutex_lock (&memory_lock);
+  *usage = memory_total;
+  _bfd_mutex_unlock (&memory_lock);
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_reset_memory_peak
+
+SYNOPSIS
+	void bfd_reset_memory_peak (void);
+
+DESCRIPTION
+	Start the peaks that <<bfd_get_memory_usage>> reports for all
+	BFDs again from what is held now, so that the peaks of one
+	link can be told from those of the last.
+*/
+
+void
+bfd_reset_memory_peak (void)
+{
+  _bfd_mutex_lock (&memory_lock);
+  memcpy (memory_total.peak, memory_total.current,
+	  sizeof (memory_total.peak));
+  _bfd_mutex_unlock (&memory_lock);
+}
+
+/*
+FUNCTION
+	bfd_memory_class_name
+
+SYNOPSIS
+	const char *bfd_memory_class_name (enum bfd_memory_class);
+
+DESCRIPTION
+	Return a short name for a memory class, for reports.
+*/
+
+const char *
+bfd_memory_class_name (enum bfd_memory_class cls)
+{
+  static const char *const names[bfd_memory_class_count] =
+    {
+      "other", "sections", "symbols", "relocs", "strtab", "dwarf",
+      "merge", "hash"
+    };
+
+  if ((unsigned int) cls >= bfd_memory_class_count)
+    return "unknown";
+  return names[cls];
+}
+
+/* Add DELTA bytes to CLS in USAGE, updating its peak.  */
+
+static void
+memory_usage_add (struct bfd_memory_usage *usage,
+		  enum bfd_memory_class cls, bfd_signed_vma delta)
+{
+  usage->current[cls] += delta;
+  if (usage->current[cls] > usage->peak[cls])
+    usage->peak[cls] = usage->current[cls];
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_memory_accounting_p
+
+SYNOPSIS
+	bool _bfd_memory_accounting_p (void);
+
+DESCRIPTION
+	Return whether memory is being accounted for.
+*/
+
+bool
+_bfd_memory_accounting_p (void)
+{
+  return memory_accounting;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_memory_account
+
+SYNOPSIS
+	void _bfd_memory_account
+	  (bfd *abfd, enum bfd_memory_class cls, bfd_signed_vma delta);
+
+DESCRIPTION
+	Count @var{delta} more bytes, which may be negative, as held in
+	class @var{cls}, for @var{abfd} if it is not NULL and for all
+	BFDs.  Does nothing if accounting is off.
+*/
+
+void
+_bfd_memory_account (bfd *abfd, enum bfd_memory_class cls,
+		     bfd_signed_vma delta)
+{
+  if (!memory_accounting)
+    return;
+
+  if (abfd != NULL)
+    {
+      if (abfd->memory_usage == NULL)
+	{
+	  abfd->memory_usage = ((struct bfd_memory_usage *)
+				calloc (1, sizeof (*abfd->memory_usage)));
+	  if (abfd->memory_usage == NULL)
+	    return;
+	}
+      memory_usage_add (abfd->memory_usage, cls, delta);
+    }
+
+  _bfd_mutex_lock (&memory_lock);
+  memory_usage_add (&memory_total, cls, delta);
+  _bfd_mutex_unlock (&memory_lock);
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_memory_release
+
+SYNOPSIS
+	void _bfd_memory_release
+	  (bfd *abfd, const struct bfd_memory_usage *keep);
+
+DESCRIPTION
+	Account for @var{abfd} freeing <<bfd_alloc>> memory, so that
+	it now holds what @var{keep} says, or nothing if @var{keep}
+	is NULL.
+*/
+
+void
+_bfd_memory_release (bfd *abfd, const struct bfd_memory_usage *keep)
+{
+  struct bfd_memory_usage *usage = abfd->memory_usage;
+  unsigned int i;
+
+  if (usage == NULL)
+    return;
+
+  _bfd_mutex_lock (&memory_lock);
+  for (i = 0; i < bfd_memory_class_count; i++)
+    {
+      bfd_size_type now = keep != NULL ? keep->current[i] : 0;
+
+      if (usage->current[i] > now)
+	{
+	  memory_total.current[i] -= usage->current[i] - now;
+	  usage->current[i] = now;
+	}
+    }
+  _bfd_mutex_unlock (&memory_lock);
+
+  if (keep == NULL)
+    {
+      free (usage);
+      abfd->memory_usage = NULL;
+    }
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_set_memory_class
+
+SYNOPSIS
+	enum bfd_memory_class _bfd_set_memory_class
+	  (enum bfd_memory_class cls);
+
+DESCRIPTION
+	Count the calling thread's <<bfd_alloc>> memory as class
+	@var{cls} from now on.  Returns the previous class, to be
+	restored when the work that uses @var{cls} is done.
+*/
+
+enum bfd_memory_class
+_bfd_set_memory_class (enum bfd_memory_class cls)
+{
+  enum bfd_memory_class old = memory_class;
+
+  memory_class = cls;
+  return old;
+}
+
 /*
 INTERNAL_FUNCTION
 	bfd_write_bigendian_4byte_int
@@ -819,173 +1169,73 @@ bfd_getl24 (const void *p)
 bfd_vma
 bfd_getb32 (const void *p)
 {
-  const bfd_byte *addr = (const bfd_byte *) p;
-  uint32_t v;
-
-  v = (uint32_t) addr[0] << 24;
-  v |= (uint32_t) addr[1] << 16;
-  v |= (uint32_t) addr[2] << 8;
-  v |= (uint32_t) addr[3];
-  return v;
+  return _bfd_getb32 (p);
 }
 
 bfd_vma
 bfd_getl32 (const void *p)
 {
-  const bfd_byte *addr = (const bfd_byte *) p;
-  uint32_t v;
-
-  v = (uint32_t) addr[0];
-  v |= (uint32_t) addr[1] << 8;
-  v |= (uint32_t) addr[2] << 16;
-  v |= (uint32_t) addr[3] << 24;
-  return v;
+  return _bfd_getl32 (p);
 }
 
 bfd_signed_vma
 bfd_getb_signed_32 (const void *p)
 {
-  const bfd_byte *addr = (const bfd_byte *) p;
-  uint32_t v;
-
-  v = (uint32_t) addr[0] << 24;
-  v |= (uint32_t) addr[1] << 16;
-  v |= (uint32_t) addr[2] << 8;
-  v |= (uint32_t) addr[3];
-  return COERCE32 (v);
+  return COERCE32 (_bfd_getb32 (p));
 }
 
 bfd_signed_vma
 bfd_getl_signed_32 (const void *p)
 {
-  const bfd_byte *addr = (const bfd_byte *) p;
-  uint32_t v;
-
-  v = (uint32_t) addr[0];
-  v |= (uint32_t) addr[1] << 8;
-  v |= (uint32_t) addr[2] << 16;
-  v |= (uint32_t) addr[3] << 24;
-  return COERCE32 (v);
+  return COERCE32 (_bfd_getl32 (p));
 }
 
 uint64_t
 bfd_getb64 (const void *p)
 {
-  const bfd_byte *addr = (const bfd_byte *) p;
-  uint64_t v;
-
-  v  = addr[0]; v <<= 8;
-  v |= addr[1]; v <<= 8;
-  v |= addr[2]; v <<= 8;
-  v |= addr[3]; v <<= 8;
-  v |= addr[4]; v <<= 8;
-  v |= addr[5]; v <<= 8;
-  v |= addr[6]; v <<= 8;
-  v |= addr[7];
-
-  return v;
+  return _bfd_getb64 (p);
 }
 
 uint64_t
 bfd_getl64 (const void *p)
 {
-  const bfd_byte *addr = (const bfd_byte *) p;
-  uint64_t v;
-
-  v  = addr[7]; v <<= 8;
-  v |= addr[6]; v <<= 8;
-  v |= addr[5]; v <<= 8;
-  v |= addr[4]; v <<= 8;
-  v |= addr[3]; v <<= 8;
-  v |= addr[2]; v <<= 8;
-  v |= addr[1]; v <<= 8;
-  v |= addr[0];
-
-  return v;
+  return _bfd_getl64 (p);
 }
 
 int64_t
 bfd_getb_signed_64 (const void *p)
 {
-  const bfd_byte *addr = (const bfd_byte *) p;
-  uint64_t v;
-
-  v  = addr[0]; v <<= 8;
-  v |= addr[1]; v <<= 8;
-  v |= addr[2]; v <<= 8;
-  v |= addr[3]; v <<= 8;
-  v |= addr[4]; v <<= 8;
-  v |= addr[5]; v <<= 8;
-  v |= addr[6]; v <<= 8;
-  v |= addr[7];
-
-  return COERCE64 (v);
+  return COERCE64 (_bfd_getb64 (p));
 }
 
 int64_t
 bfd_getl_signed_64 (const void *p)
 {
-  const bfd_byte *addr = (const bfd_byte *) p;
-  uint64_t v;
-
-  v  = addr[7]; v <<= 8;
-  v |= addr[6]; v <<= 8;
-  v |= addr[5]; v <<= 8;
-  v |= addr[4]; v <<= 8;
-  v |= addr[3]; v <<= 8;
-  v |= addr[2]; v <<= 8;
-  v |= addr[1]; v <<= 8;
-  v |= addr[0];
-
-  return COERCE64 (v);
+  return COERCE64 (_bfd_getl64 (p));
 }
 
 void
 bfd_putb32 (bfd_vma data, void *p)
 {
-  bfd_byte *addr = (bfd_byte *) p;
-  addr[0] = (data >> 24) & 0xff;
-  addr[1] = (data >> 16) & 0xff;
-  addr[2] = (data >>  8) & 0xff;
-  addr[3] = data & 0xff;
+  _bfd_putb32 (data, p);
 }
 
 void
 bfd_putl32 (bfd_vma data, void *p)
 {
-  bfd_byte *addr = (bfd_byte *) p;
-  addr[0] = data & 0xff;
-  addr[1] = (data >>  8) & 0xff;
-  addr[2] = (data >> 16) & 0xff;
-  addr[3] = (data >> 24) & 0xff;
+  _bfd_putl32 (data, p);
 }
 
 void
 bfd_putb64 (uint64_t data, void *p)
 {
-  bfd_byte *addr = (bfd_byte *) p;
-  addr[0] = (data >> (7*8)) & 0xff;
-  addr[1] = (data >> (6*8)) & 0xff;
-  addr[2] = (data >> (5*8)) & 0xff;
-  addr[3] = (data >> (4*8)) & 0xff;
-  addr[4] = (data >> (3*8)) & 0xff;
-  addr[5] = (data >> (2*8)) & 0xff;
-  addr[6] = (data >> (1*8)) & 0xff;
-  addr[7] = (data >> (0*8)) & 0xff;
+  _bfd_putb64 (data, p);
 }
 
 void
 bfd_putl64 (uint64_t data, void *p)
 {
-  bfd_byte *addr = (bfd_byte *) p;
-  addr[7] = (data >> (7*8)) & 0xff;
-  addr[6] = (data >> (6*8)) & 0xff;
-  addr[5] = (data >> (5*8)) & 0xff;
-  addr[4] = (data >> (4*8)) & 0xff;
-  addr[3] = (data >> (3*8)) & 0xff;
-  addr[2] = (data >> (2*8)) & 0xff;
-  addr[1] = (data >> (1*8)) & 0xff;
-  addr[0] = (data >> (0*8)) & 0xff;
+  _bfd_putl64 (data, p);
 }
 
 void
@@ -995,6 +1245,22 @@ bfd_put_bits (uint64_t data, void *p, int bits, bool big_p)
   int i;
   int bytes;
 
+  switch (bits)
+    {
+    case 32:
+      if (big_p)
+	_bfd_putb32 (data, p);
+      else
+	_bfd_putl32 (data, p);
+      return;
+    case 64:
+      if (big_p)
+	_bfd_putb64 (data, p);
+      else
+	_bfd_putl64 (data, p);
+      return;
+    }
+
   if (bits % 8 != 0)
     abort ();
 
@@ -1016,6 +1282,14 @@ bfd_get_bits (const void *p, int bits, bool big_p)
   int i;
   int bytes;
 
+  switch (bits)
+    {
+    case 32:
+      return big_p ? _bfd_getb32 (p) : _bfd_getl32 (p);
+    case 64:
+      return big_p ? _bfd_getb64 (p) : _bfd_getl64 (p);
+    }
+
   if (bits % 8 != 0)
     abort ();
 
@@ -1030,7 +1304,541 @@ bfd_get_bits (const void *p, int bits, bool big_p)
 
   return data;
 }
+
+/*
+INTERNAL_FUNCTION
+	_bfd_get_32_array
+
+SYNOPSIS
+	void _bfd_get_16_array (const void *src, uint16_t *dst,
+				size_t count, bool big_p);
+	void _bfd_get_32_array (const void *src, uint32_t *dst,
+				size_t count, bool big_p);
+	void _bfd_get_64_array (const void *src, uint64_t *dst,
+				size_t count, bool big_p);
+
+DESCRIPTION
+	Read COUNT consecutive 16, 32 or 64 bit words at SRC, big endian
+	if BIG_P and little endian otherwise, into the host words at DST.
+	DST may be SRC, converting the words in place, but the two must
+	not otherwise overlap.  Words already in the host's order are
+	just copied.
+*/
+
+#ifdef WORDS_BIGENDIAN
+#define HOST_BIG_P true
+#else
+#define HOST_BIG_P false
+#endif
+
+void
+_bfd_get_16_array (const void *src, uint16_t *dst, size_t count, bool big_p)
+{
+  const bfd_byte *p = (const bfd_byte *) src;
+  size_t i;
+
+  if (big_p == HOST_BIG_P)
+    {
+      if ((const void *) dst != src)
+	memcpy (dst, src, count * sizeof (*dst));
+      return;
+    }
+  for (i = 0; i < count; i++)
+    dst[i] = _bfd_bswap_16 (_bfd_host_get_16 (p + i * sizeof (*dst)));
+}
+
+void
+_bfd_get_32_array (const void *src, uint32_t *dst, size_t count, bool big_p)
+{
+  const bfd_byte *p = (const bfd_byte *) src;
+  size_t i;
+
+  if (big_p == HOST_BIG_P)
+    {
+      if ((const void *) dst != src)
+	memcpy (dst, src, count * sizeof (*dst));
+      return;
+    }
+  for (i = 0; i < count; i++)
+    dst[i] = _bfd_bswap_32 (_bfd_host_get_32 (p + i * sizeof (*dst)));
+}
+
+void
+_bfd_get_64_array (const void *src, uint64_t *dst, size_t count, bool big_p)
+{
+  const bfd_byte *p = (const bfd_byte *) src;
+  size_t i;
+
+  if (big_p == HOST_BIG_P)
+    {
+      if ((const void *) dst != src)
+	memcpy (dst, src, count * sizeof (*dst));
+      return;
+    }
+  for (i = 0; i < count; i++)
+    dst[i] = _bfd_bswap_64 (_bfd_host_get_64 (p + i * sizeof (*dst)));
+}
 
+/* A region of section contents owned by a BFD on behalf of callers of
+   bfd_get_section_contents_view.  MAP_LEN is zero when DATA was
+   malloc'd rather than mapped, or when it points into the file image
+   of the BFD or of an archive containing it, which MAP_ADDR is then
+   set to.  Views of file regions that aren't sections, made by
+   _bfd_file_view, have a NULL SECTION and record the FILEPOS and
+   SIZE they cover, as does the file image.  */
+
+struct bfd_mmapped
+{
+  struct bfd_mmapped *next;
+  asection *section;
+  bfd_byte *data;
+  void *map_addr;
+  bfd_size_type map_len;
+  file_ptr filepos;
+  bfd_size_type size;
+};
+
+/* Regions smaller than this are read rather than mapped; for small
+   sections setting up a view costs more than copying the bytes.  */
+#define MMAP_MIN_SIZE (64 * 1024)
+
+static bool
+add_mmapped (bfd *abfd, asection *sec, bfd_byte *data,
+	     void *map_addr, bfd_size_type map_len)
+{
+  struct bfd_mmapped *m = bfd_malloc (sizeof (*m));
+
+  if (m == NULL)
+    return false;
+  m->next = abfd->mmapped;
+  m->section = sec;
+  m->data = data;
+  m->map_addr = map_addr;
+  m->map_len = map_len;
+  m->filepos = -1;
+  m->size = 0;
+  abfd->mmapped = m;
+  return true;
+}
+
+/* If the file ABFD is read from has been mapped by bfd_map_file_image,
+   return the SIZE bytes at OFFSET of ABFD in the mapping.  Return
+   NULL if not, or if the region lies outside the file.  */
+
+static bfd_byte *
+file_image_view (bfd *abfd, file_ptr offset, bfd_size_type size)
+{
+  ufile_ptr origin = 0;
+  struct bfd_mmapped *image;
+
+  while (abfd->my_archive != NULL
+	 && !bfd_is_thin_archive (abfd->my_archive))
+    {
+      origin += abfd->origin;
+      abfd = abfd->my_archive;
+    }
+  origin += abfd->origin;
+
+  image = abfd->file_image;
+  if (image == NULL
+      || offset < 0
+      || origin > image->size
+      || (ufile_ptr) offset > image->size - origin
+      || size > image->size - origin - offset)
+    return NULL;
+  return image->data + origin + offset;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_mmap_section_contents
+
+SYNOPSIS
+	bfd_byte *_bfd_mmap_section_contents (bfd *abfd, asection *sec);
+
+DESCRIPTION
+	Map the on-disk contents of @var{sec} read-only and record the
+	mapping with @var{abfd} so that it is released by <<bfd_close>>.
+	Returns NULL, leaving <<bfd_error>> unchanged, if the section is
+	too small to be worth mapping or the file can't be mapped.
+	Sections of a file mapped by <<bfd_map_file_image>> are
+	returned from that mapping whatever their size.
+*/
+
+bfd_byte *
+_bfd_mmap_section_contents (bfd *abfd, asection *sec)
+{
+  bfd_size_type size = bfd_get_section_limit_octets (abfd, sec);
+  ufile_ptr filesize;
+  bfd_error_type err;
+  void *map_addr;
+  bfd_size_type map_len;
+  void *ret;
+
+  if (size != (size_t) size
+      || abfd->direction != read_direction
+      || (abfd->flags & BFD_IN_MEMORY) != 0)
+    return NULL;
+
+  /* Mapping beyond the end of file either fails or faults later.  */
+  filesize = bfd_get_file_size (abfd);
+  if (filesize == 0
+      || (ufile_ptr) sec->filepos > filesize
+      || size > filesize - sec->filepos)
+    return NULL;
+
+  err = bfd_get_error ();
+  ret = file_image_view (abfd, sec->filepos, size);
+  if (ret != NULL)
+    {
+      if (!add_mmapped (abfd, sec, ret, ret, 0))
+	{
+	  bfd_set_error (err);
+	  return NULL;
+	}
+      return ret;
+    }
+
+  if (size < MMAP_MIN_SIZE)
+    return NULL;
+
+  ret = bfd_mmap (abfd, NULL, size, PROT_READ, MAP_PRIVATE, sec->filepos,
+		  &map_addr, &map_len);
+  if (ret == (void *) -1)
+    {
+      bfd_set_error (err);
+      return NULL;
+    }
+
+  if (!add_mmapped (abfd, sec, ret, map_addr, map_len))
+    {
+      bfd_munmap (map_addr, map_len);
+      bfd_set_error (err);
+      return NULL;
+    }
+  return ret;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_add_section_view
+
+SYNOPSIS
+	bool _bfd_add_section_view (bfd *abfd, asection *sec, bfd_byte *buf);
+
+DESCRIPTION
+	Give @var{abfd} ownership of the malloc'd full contents @var{buf}
+	of @var{sec}, to be returned by later <<_bfd_section_view>> calls
+	and freed by <<bfd_close>>.
+*/
+
+bool
+_bfd_add_section_view (bfd *abfd, asection *sec, bfd_byte *buf)
+{
+  return add_mmapped (abfd, sec, buf, NULL, 0);
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_section_view
+
+SYNOPSIS
+	const bfd_byte *_bfd_section_view (bfd *abfd, asection *sec);
+
+DESCRIPTION
+	Return the full contents of @var{sec} if a view of them is
+	already owned by @var{abfd}, or NULL.
+*/
+
+const bfd_byte *
+_bfd_section_view (bfd *abfd, asection *sec)
+{
+  struct bfd_mmapped *m;
+
+  for (m = abfd->mmapped; m != NULL; m = m->next)
+    if (m->section == sec)
+      return m->data;
+  return NULL;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_file_view
+
+SYNOPSIS
+	const bfd_byte *_bfd_file_view
+	  (bfd *abfd, file_ptr offset, bfd_size_type size);
+
+DESCRIPTION
+	Return a read-only view of the @var{size} bytes of @var{abfd}
+	at @var{offset}, for file contents that are not a section,
+	such as an ELF symbol table.  The view belongs to @var{abfd}
+	and is released by <<bfd_close>>; asking for the same region
+	again returns the same view.  Regions of a file mapped by
+	<<bfd_map_file_image>> point into that mapping.  Otherwise large
+	regions are mapped with <<bfd_mmap>>, others read into memory.
+	Returns NULL on error.
+*/
+
+const bfd_byte *
+_bfd_file_view (bfd *abfd, file_ptr offset, bfd_size_type size)
+{
+  struct bfd_mmapped *m;
+  ufile_ptr filesize;
+  bfd_byte *data;
+
+  for (m = abfd->mmapped; m != NULL; m = m->next)
+    if (m->section == NULL && m->filepos == offset && m->size >= size)
+      return m->data;
+
+  filesize = bfd_get_file_size (abfd);
+  if (filesize != 0
+      && ((ufile_ptr) offset > filesize || size > filesize - offset))
+    {
+      bfd_set_error (bfd_error_file_truncated);
+      return NULL;
+    }
+
+  data = file_image_view (abfd, offset, size);
+  if (data != NULL)
+    return data;
+
+  if (size >= MMAP_MIN_SIZE
+      && size == (size_t) size
+      && filesize != 0
+      && abfd->direction == read_direction
+      && (abfd->flags & BFD_IN_MEMORY) == 0)
+    {
+      bfd_error_type err = bfd_get_error ();
+      void *map_addr;
+      bfd_size_type map_len;
+
+      data = bfd_mmap (abfd, NULL, size, PROT_READ, MAP_PRIVATE, offset,
+		       &map_addr, &map_len);
+      if (data != (void *) -1)
+	{
+	  if (add_mmapped (abfd, NULL, data, map_addr, map_len))
+	    {
+	      abfd->mmapped->filepos = offset;
+	      abfd->mmapped->size = size;
+	      return data;
+	    }
+	  bfd_munmap (map_addr, map_len);
+	}
+      bfd_set_error (err);
+    }
+
+  if (bfd_seek (abfd, offset, SEEK_SET) != 0)
+    return NULL;
+  data = (bfd_byte *) _bfd_malloc_and_read (abfd, size ? size : 1, size);
+  if (data == NULL)
+    return NULL;
+  if (!add_mmapped (abfd, NULL, data, NULL, 0))
+    {
+      free (data);
+      return NULL;
+    }
+  abfd->mmapped->filepos = offset;
+  abfd->mmapped->size = size;
+  return data;
+}
+
+/*
+FUNCTION
+	bfd_map_file_image
+
+SYNOPSIS
+	bool bfd_map_file_image (bfd *abfd);
+
+DESCRIPTION
+	Map the whole of the file @var{abfd} is read from read-only
+	into memory, or if @var{abfd} is a member of an archive, the
+	whole of the archive.  Reads of the file and of all its
+	archive members then copy from the mapping rather than going
+	to the file, and section contents views and other views of
+	the file point straight into it, so that walking the symbols
+	of every member of a large archive costs page faults rather
+	than reads and allocations.  Members of a mapped thin archive,
+	and nested archives, are mapped in turn as they are opened.
+	The mapping is released when the BFD is closed, so it must
+	outlive all members of an archive.
+
+	Return TRUE on success or if the file is already mapped.
+	Return FALSE if the BFD isn't open for reading or the host
+	can't map the file, leaving reads of the file as they were.
+*/
+
+bool
+bfd_map_file_image (bfd *abfd)
+{
+  ufile_ptr filesize;
+  bfd_error_type err;
+  void *map_addr;
+  bfd_size_type map_len;
+  void *data;
+
+  while (abfd->my_archive != NULL
+	 && !bfd_is_thin_archive (abfd->my_archive))
+    abfd = abfd->my_archive;
+
+  if (abfd->file_image != NULL)
+    return true;
+
+  if (abfd->direction != read_direction
+      || (abfd->flags & BFD_IN_MEMORY) != 0)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  err = bfd_get_error ();
+  filesize = bfd_get_size (abfd);
+  if (filesize == 0 || filesize != (size_t) filesize)
+    {
+      bfd_set_error (err == bfd_error_no_error
+		     ? bfd_error_invalid_operation : err);
+      return false;
+    }
+
+  bfd_set_error (bfd_error_no_error);
+  data = bfd_mmap (abfd, NULL, filesize, PROT_READ, MAP_PRIVATE, 0,
+		   &map_addr, &map_len);
+  if (data == (void *) -1)
+    {
+      /* Hosts without mmap fail without saying why.  */
+      if (bfd_get_error () == bfd_error_no_error)
+	bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+  if (!add_mmapped (abfd, NULL, data, map_addr, map_len))
+    {
+      bfd_munmap (map_addr, map_len);
+      return false;
+    }
+  abfd->mmapped->filepos = 0;
+  abfd->mmapped->size = filesize;
+  abfd->file_image = abfd->mmapped;
+  return true;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_file_image
+
+SYNOPSIS
+	const bfd_byte *_bfd_file_image (bfd *abfd, bfd_size_type *size);
+
+DESCRIPTION
+	Return the mapping of the whole file made for @var{abfd} by
+	<<bfd_map_file_image>>, setting @var{*size} to its length, or
+	NULL if there is none.  @var{abfd} is not followed to the
+	archive containing it.
+*/
+
+const bfd_byte *
+_bfd_file_image (bfd *abfd, bfd_size_type *size)
+{
+  if (abfd->file_image == NULL)
+    return NULL;
+  *size = abfd->file_image->size;
+  return abfd->file_image->data;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_map_region
+
+SYNOPSIS
+	const bfd_byte *_bfd_map_region
+	  (bfd *abfd, file_ptr offset, bfd_size_type size,
+	   void **map_addr, bfd_size_type *map_len);
+
+DESCRIPTION
+	Return a read-only view of the @var{size} bytes of @var{abfd}
+	at @var{offset} without copying them, for a caller that wants
+	them only briefly.  The view is the file's in-memory buffer or
+	<<bfd_map_file_image>> mapping if it has one, setting
+	@var{*map_len} to zero, and otherwise a new mapping, which the
+	caller releases with <<bfd_munmap>> of @var{*map_addr} and
+	@var{*map_len}.  Returns NULL, leaving <<bfd_error>> unchanged,
+	if the region is too small to be worth mapping or can't be
+	mapped; the caller should then read it.
+*/
+
+const bfd_byte *
+_bfd_map_region (bfd *abfd, file_ptr offset, bfd_size_type size,
+		 void **map_addr, bfd_size_type *map_len)
+{
+  ufile_ptr filesize;
+  bfd_error_type err;
+  bfd_byte *data;
+
+  if (abfd->direction != read_direction
+      || size != (size_t) size
+      || offset < 0)
+    return NULL;
+
+  filesize = bfd_get_file_size (abfd);
+  if (filesize == 0
+      || (ufile_ptr) offset > filesize
+      || size > filesize - offset)
+    return NULL;
+
+  *map_len = 0;
+  if ((abfd->flags & BFD_IN_MEMORY) != 0)
+    {
+      struct bfd_in_memory *bim = (struct bfd_in_memory *) abfd->iostream;
+
+      if ((ufile_ptr) offset > bim->size || size > bim->size - offset)
+	return NULL;
+      return bim->buffer + offset;
+    }
+
+  data = file_image_view (abfd, offset, size);
+  if (data != NULL || size < MMAP_MIN_SIZE)
+    return data;
+
+  err = bfd_get_error ();
+  data = bfd_mmap (abfd, NULL, size, PROT_READ, MAP_PRIVATE, offset,
+		   map_addr, map_len);
+  if (data == (void *) -1)
+    {
+      *map_len = 0;
+      bfd_set_error (err);
+      return NULL;
+    }
+  return data;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_munmap_all
+
+SYNOPSIS
+	void _bfd_munmap_all (bfd *abfd);
+
+DESCRIPTION
+	Release all section views owned by @var{abfd}.
+*/
+
+void
+_bfd_munmap_all (bfd *abfd)
+{
+  struct bfd_mmapped *m, *next;
+
+  for (m = abfd->mmapped; m != NULL; m = next)
+    {
+      next = m->next;
+      if (m->map_len != 0)
+	bfd_munmap (m->map_addr, m->map_len);
+      else if (m->map_addr == NULL)
+	free (m->data);
+      free (m);
+    }
+  abfd->mmapped = NULL;
+  abfd->file_image = NULL;
+}
+
 /* Default implementation */
 
 bool
@@ -1066,6 +1874,19 @@ _bfd_generic_get_section_contents (bfd *abfd,
       return false;
     }
 
+  /* Serve reads of sections that have been viewed from the view
+     rather than going back to the file.  */
+  if (abfd->mmapped != NULL)
+    {
+      const bfd_byte *view = _bfd_section_view (abfd, section);
+
+      if (view != NULL)
+	{
+	  memcpy (location, view + offset, count);
+	  return true;
+	}
+    }
+
   if (bfd_seek (abfd, section->filepos + offset, SEEK_SET) != 0
       || bfd_bread (location, count, abfd) != count)
     return false;
@@ -1177,6 +1998,80 @@ bfd_log2 (bfd_vma x)
   return result;
 }
 
+/* Return the value of the hex digit C, or set *BAD if C is not a hex
+   digit.  Written without table lookups or branches so that a loop
+   calling it can be vectorized.  */
+
+static inline unsigned int
+hex_digit_value (unsigned int c, unsigned int *bad)
+{
+  unsigned int digit = c - '0';
+  unsigned int alpha = (c | 0x20) - 'a';
+
+  *bad |= (digit > 9) & (alpha > 5);
+  return digit <= 9 ? digit : alpha + 10;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_hex_decode
+
+SYNOPSIS
+	bool _bfd_hex_decode
+	  (bfd_byte *dst, const bfd_byte *src, bfd_size_type count);
+
+DESCRIPTION
+	Convert the @var{count} pairs of hex digits at @var{src}, high
+	digit first, to the @var{count} bytes at @var{dst}.  Return
+	FALSE if any of the characters is not a hex digit, in which
+	case the bytes stored at @var{dst} are unspecified.
+*/
+
+bool
+_bfd_hex_decode (bfd_byte *dst, const bfd_byte *src, bfd_size_type count)
+{
+  unsigned int bad = 0;
+  bfd_size_type i;
+
+  for (i = 0; i < count; i++)
+    dst[i] = ((hex_digit_value (src[2 * i], &bad) << 4)
+	      | hex_digit_value (src[2 * i + 1], &bad));
+  return bad == 0;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_hex_encode
+
+SYNOPSIS
+	unsigned int _bfd_hex_encode
+	  (char *dst, const bfd_byte *src, bfd_size_type count);
+
+DESCRIPTION
+	Write the @var{count} bytes at @var{src} to @var{dst} as pairs
+	of upper case hex digits, high digit first, without a
+	terminating NUL.  Return the sum of the bytes, for use in a
+	checksum.
+*/
+
+unsigned int
+_bfd_hex_encode (char *dst, const bfd_byte *src, bfd_size_type count)
+{
+  unsigned int sum = 0;
+  bfd_size_type i;
+
+  for (i = 0; i < count; i++)
+    {
+      unsigned int hi = src[i] >> 4;
+      unsigned int lo = src[i] & 0xf;
+
+      dst[2 * i] = hi + (hi > 9 ? 'A' - 10 : '0');
+      dst[2 * i + 1] = lo + (lo > 9 ? 'A' - 10 : '0');
+      sum += src[i];
+    }
+  return sum;
+}
+
 bool
 bfd_generic_is_local_label_name (bfd *abfd, const char *name)
 {
@@ -1231,6 +2126,29 @@ _bfd_safe_read_leb128 (bfd *abfd ATTRIBUTE_UNUSED,
   unsigned int shift = 0;
   bfd_byte byte = 0;
   bfd_byte *data = *ptr;
+  size_t len;
+
+  /* A complete number is decoded by leb128.h; only one that runs into
+     END needs the loop below.  */
+  if (sign)
+    {
+      int64_t value;
+
+      len = leb128_read_signed (data, end, &value);
+      result = value;
+    }
+  else
+    {
+      uint64_t value;
+
+      len = leb128_read_unsigned (data, end, &value);
+      result = value;
+    }
+  if (len != 0)
+    {
+      *ptr = data + len;
+      return result;
+    }
 
   while (data < end)
     {
@@ -62,6 +62,9 @@ struct bfd_in_memory
   bfd_size_type size;
   /* Buffer holding contents of BFD.  */
   bfd_byte *buffer;
+  /* Bytes allocated for buffer, at least SIZE.  Those past SIZE are
+     zero.  */
+  bfd_size_type capacity;
 };
 
 struct section_hash_entry
@@ -83,6 +86,7 @@ struct artdata
   htab_t cache;
   carsym *symdefs;		/* The symdef entries.  */
   symindex symdef_count;	/* How many there are.  */
+  struct armap_index *symdef_index; /* Hash index of the symdefs.  */
   char *extended_names;		/* Clever intel extension.  */
   bfd_size_type extended_names_size; /* Size of extended names.  */
   /* When more compilers are standard C, this can be a time_t.  */
@@ -596,6 +600,18 @@ extern int _bfd_dwarf2_find_nearest_line_with_alt
    const char **, const char **, unsigned int *, unsigned int *,
    const struct dwarf_debug_section *, void **) ATTRIBUTE_HIDDEN;
 
+/* Find the nearest lines of several addresses in one section using
+   DWARF 2 debugging information.  */
+extern bool _bfd_dwarf2_find_nearest_lines
+  (bfd *, asymbol **, asection *, const bfd_vma *, size_t,
+   bfd_nearest_line *, const struct dwarf_debug_section *,
+   void **) ATTRIBUTE_HIDDEN;
+
+/* Step to the caller of a function found by
+   _bfd_dwarf2_find_nearest_lines.  */
+extern bool _bfd_dwarf2_nearest_line_inliner
+  (void **, const char **, const char **, unsigned int *) ATTRIBUTE_HIDDEN;
+
 /* Find the bias between DWARF addresses and real addresses.  */
 extern bfd_signed_vma _bfd_dwarf2_find_symbol_bias
   (asymbol **, void **) ATTRIBUTE_HIDDEN;
@@ -855,6 +871,13 @@ extern bfd_vma _bfd_safe_read_leb128
 extern bfd_byte * _bfd_write_unsigned_leb128
   (bfd_byte *, bfd_byte *, bfd_vma) ATTRIBUTE_HIDDEN;
 
+extern void _bfd_get_16_array
+  (const void *, uint16_t *, size_t, bool) ATTRIBUTE_HIDDEN;
+extern void _bfd_get_32_array
+  (const void *, uint32_t *, size_t, bool) ATTRIBUTE_HIDDEN;
+extern void _bfd_get_64_array
+  (const void *, uint64_t *, size_t, bool) ATTRIBUTE_HIDDEN;
+
 extern struct bfd_link_info *_bfd_get_link_info (bfd *);
 
 extern bool _bfd_link_keep_memory (struct bfd_link_info *)
@@ -874,6 +897,161 @@ extern bool _bfd_link_keep_memory (struct bfd_link_info *)
 #define _bfd_constant_p(v) 0
 #endif
 
+/* True if the headers of ABFD are stored in the host's byte order, in
+   which case bulk swap routines may read their fields as host words
+   with _bfd_host_get_16, _bfd_host_get_32 and _bfd_host_get_64.  */
+
+static inline bool
+_bfd_header_host_order_p (bfd *abfd)
+{
+#ifdef WORDS_BIGENDIAN
+  return bfd_header_big_endian (abfd);
+#else
+  return bfd_header_little_endian (abfd);
+#endif
+}
+
+static inline unsigned int
+_bfd_host_get_16 (const void *p)
+{
+  uint16_t v;
+
+  memcpy (&v, p, sizeof (v));
+  return v;
+}
+
+static inline unsigned int
+_bfd_host_get_32 (const void *p)
+{
+  uint32_t v;
+
+  memcpy (&v, p, sizeof (v));
+  return v;
+}
+
+static inline uint64_t
+_bfd_host_get_64 (const void *p)
+{
+  uint64_t v;
+
+  memcpy (&v, p, sizeof (v));
+  return v;
+}
+
+static inline void
+_bfd_host_put_32 (uint32_t v, void *p)
+{
+  memcpy (p, &v, sizeof (v));
+}
+
+static inline void
+_bfd_host_put_64 (uint64_t v, void *p)
+{
+  memcpy (p, &v, sizeof (v));
+}
+
+/* Reverse the bytes of a word.  The compilers we build with have a
+   single instruction for it; the shifts are for any others.  */
+
+static inline uint16_t
+_bfd_bswap_16 (uint16_t v)
+{
+  return (uint16_t) ((v >> 8) | (v << 8));
+}
+
+static inline uint32_t
+_bfd_bswap_32 (uint32_t v)
+{
+#if defined (__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+  return __builtin_bswap32 (v);
+#elif defined (_MSC_VER)
+  return _byteswap_ulong (v);
+#else
+  return ((v >> 24)
+	  | ((v >> 8) & 0xff00)
+	  | ((v << 8) & 0xff0000)
+	  | (v << 24));
+#endif
+}
+
+static inline uint64_t
+_bfd_bswap_64 (uint64_t v)
+{
+#if defined (__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+  return __builtin_bswap64 (v);
+#elif defined (_MSC_VER)
+  return _byteswap_uint64 (v);
+#else
+  return ((uint64_t) _bfd_bswap_32 ((uint32_t) v) << 32
+	  | _bfd_bswap_32 ((uint32_t) (v >> 32)));
+#endif
+}
+
+/* Inline forms of bfd_getl32, bfd_getb64, bfd_putl32 and the rest,
+   for code that knows the byte order it wants and would otherwise
+   call out of line for every field.  Each is one load or store,
+   plus a byte swap when the order is not the host's.  */
+
+#ifdef WORDS_BIGENDIAN
+#define _BFD_LITTLE_32(v) _bfd_bswap_32 (v)
+#define _BFD_LITTLE_64(v) _bfd_bswap_64 (v)
+#define _BFD_BIG_32(v) (v)
+#define _BFD_BIG_64(v) (v)
+#else
+#define _BFD_LITTLE_32(v) (v)
+#define _BFD_LITTLE_64(v) (v)
+#define _BFD_BIG_32(v) _bfd_bswap_32 (v)
+#define _BFD_BIG_64(v) _bfd_bswap_64 (v)
+#endif
+
+static inline uint32_t
+_bfd_getl32 (const void *p)
+{
+  return _BFD_LITTLE_32 ((uint32_t) _bfd_host_get_32 (p));
+}
+
+static inline uint32_t
+_bfd_getb32 (const void *p)
+{
+  return _BFD_BIG_32 ((uint32_t) _bfd_host_get_32 (p));
+}
+
+static inline uint64_t
+_bfd_getl64 (const void *p)
+{
+  return _BFD_LITTLE_64 (_bfd_host_get_64 (p));
+}
+
+static inline uint64_t
+_bfd_getb64 (const void *p)
+{
+  return _BFD_BIG_64 (_bfd_host_get_64 (p));
+}
+
+static inline void
+_bfd_putl32 (uint32_t v, void *p)
+{
+  _bfd_host_put_32 (_BFD_LITTLE_32 (v), p);
+}
+
+static inline void
+_bfd_putb32 (uint32_t v, void *p)
+{
+  _bfd_host_put_32 (_BFD_BIG_32 (v), p);
+}
+
+static inline void
+_bfd_putl64 (uint64_t v, void *p)
+{
+  _bfd_host_put_64 (_BFD_LITTLE_64 (v), p);
+}
+
+static inline void
+_bfd_putb64 (uint64_t v, void *p)
+{
+  _bfd_host_put_64 (_BFD_BIG_64 (v), p);
+}
+
 static inline void *
 _bfd_alloc_and_read (bfd *abfd, bfd_size_type asize, bfd_size_type rsize)
 {
@@ -928,13 +1106,68 @@ void *bfd_realloc_or_free (void */*mem*/, bfd_size_type /*size*/) ATTRIBUTE_HIDD
 
 void *bfd_zmalloc (bfd_size_type /*size*/) ATTRIBUTE_HIDDEN;
 
+bool _bfd_memory_accounting_p (void) ATTRIBUTE_HIDDEN;
+
+void _bfd_memory_account
+   (bfd *abfd, enum bfd_memory_class cls, bfd_signed_vma delta) ATTRIBUTE_HIDDEN;
+
+void _bfd_memory_release
+   (bfd *abfd, const struct bfd_memory_usage *keep) ATTRIBUTE_HIDDEN;
+
+enum bfd_memory_class _bfd_set_memory_class
+   (enum bfd_memory_class cls) ATTRIBUTE_HIDDEN;
+
 bool bfd_write_bigendian_4byte_int (bfd *, unsigned int) ATTRIBUTE_HIDDEN;
 
+bfd_byte *_bfd_mmap_section_contents (bfd *abfd, asection *sec) ATTRIBUTE_HIDDEN;
+
+bool _bfd_add_section_view (bfd *abfd, asection *sec, bfd_byte *buf) ATTRIBUTE_HIDDEN;
+
+const bfd_byte *_bfd_section_view (bfd *abfd, asection *sec) ATTRIBUTE_HIDDEN;
+
+const bfd_byte *_bfd_file_view
+   (bfd *abfd, file_ptr offset, bfd_size_type size) ATTRIBUTE_HIDDEN;
+
+const bfd_byte *_bfd_file_image (bfd *abfd, bfd_size_type *size)
+   ATTRIBUTE_HIDDEN;
+
+const bfd_byte *_bfd_map_region
+   (bfd *abfd, file_ptr offset, bfd_size_type size,
+   void **map_addr, bfd_size_type *map_len) ATTRIBUTE_HIDDEN;
+
+void _bfd_munmap_all (bfd *abfd) ATTRIBUTE_HIDDEN;
+
 unsigned int bfd_log2 (bfd_vma x) ATTRIBUTE_HIDDEN;
 
+bool _bfd_hex_decode
+   (bfd_byte *dst, const bfd_byte *src, bfd_size_type count) ATTRIBUTE_HIDDEN;
+
+unsigned int _bfd_hex_encode
+   (char *dst, const bfd_byte *src, bfd_size_type count) ATTRIBUTE_HIDDEN;
+
 /* Extracted from bfd.c.  */
 bfd_error_handler_type _bfd_set_error_handler_caching (bfd *) ATTRIBUTE_HIDDEN;
 
+struct _bfd_error_buffer
+{
+  /* The messages kept, each ending in a NUL.  */
+  char *text;
+  size_t size;
+  size_t alloc;
+  /* The number of messages kept, and the number dropped.  */
+  unsigned int kept;
+  unsigned int dropped;
+};
+
+bfd_error_handler_type _bfd_error_buffer_begin
+   (struct _bfd_error_buffer *buf,
+    struct _bfd_error_buffer **old_buf) ATTRIBUTE_HIDDEN;
+
+void _bfd_error_buffer_end
+   (bfd_error_handler_type old, struct _bfd_error_buffer *old_buf) ATTRIBUTE_HIDDEN;
+
+void _bfd_error_buffer_flush (struct _bfd_error_buffer *buf) ATTRIBUTE_HIDDEN;
+
 const char *_bfd_get_error_program_name (void) ATTRIBUTE_HIDDEN;
 
 /* Extracted from bfdio.c.  */
@@ -967,9 +1200,46 @@ struct bfd_iovec
   void *(*bmmap) (struct bfd *abfd, void *addr, bfd_size_type len,
 		  int prot, int flags, file_ptr offset,
 		  void **map_addr, bfd_size_type *map_len);
+  /* Read COUNT RANGES, whose offsets are IOSTREAM file offsets in
+     ascending order.  Return true if every range was read in full,
+     otherwise false (setting <<bfd_error>>).  The IOSTREAM is left
+     positioned at the end of the last range.  May be NULL, in which
+     case <<bfd_bread_vector>> uses bseek and bread.  */
+  bool (*breadv) (struct bfd *abfd, const struct bfd_read_range *ranges,
+		  unsigned int count);
+  /* Write NBYTES from PTR at IOSTREAM offset OFFSET, without using
+     the current IOSTREAM position.  Several threads may write
+     different regions at once.  Return the number of bytes written,
+     or -1 (setting <<bfd_error>>).  The IOSTREAM position afterwards
+     is unspecified.  May be NULL, in which case <<bfd_pwrite>> uses
+     bseek and bwrite.  */
+  file_ptr (*bpwrite) (struct bfd *abfd, const void *ptr,
+		       file_ptr nbytes, file_ptr offset);
+  /* Make the IOSTREAM at least SIZE bytes long, reserving the space
+     if the host can.  Return 0 on success, -1 (setting <<bfd_error>>)
+     otherwise.  May be NULL.  */
+  int (*ballocate) (struct bfd *abfd, file_ptr size);
+  /* Tell the host that SIZE bytes at IOSTREAM offset OFFSET will be
+     read soon, so that it may start reading them in the background.
+     Return 0 if the hint was given, -1 otherwise; failure is not an
+     error.  May be NULL.  */
+  int (*bprefetch) (struct bfd *abfd, file_ptr offset, file_ptr size);
 };
 extern const struct bfd_iovec _bfd_memory_iovec;
 
+void _bfd_set_member_positions (bool on) ATTRIBUTE_HIDDEN;
+
+enum bfd_io_event
+{
+  bfd_io_read, bfd_io_write, bfd_io_seek, bfd_io_map,
+  bfd_io_open, bfd_io_reopen, bfd_io_evict
+};
+
+void _bfd_io_count
+   (bfd *abfd, enum bfd_io_event event, bfd_size_type bytes) ATTRIBUTE_HIDDEN;
+
+void _bfd_io_release (bfd *abfd) ATTRIBUTE_HIDDEN;
+
 /* Extracted from archive.c.  */
 /* Used in generating armaps (archive tables of contents).  */
 struct orl             /* Output ranlib.  */
@@ -1010,9 +1280,21 @@ bfd_window_internal;
 /* Extracted from cache.c.  */
 bool bfd_cache_init (bfd *abfd) ATTRIBUTE_HIDDEN;
 
+bool _bfd_cache_iovec_p (bfd *abfd) ATTRIBUTE_HIDDEN;
+
 FILE* bfd_open_file (bfd *abfd) ATTRIBUTE_HIDDEN;
 
+/* Extracted from compress.c.  */
+void _bfd_section_cache_drop (bfd *abfd) ATTRIBUTE_HIDDEN;
+
 /* Extracted from hash.c.  */
+void _bfd_hash_table_account
+   (struct bfd_hash_table *, bfd_size_type /*size*/) ATTRIBUTE_HIDDEN;
+
+void _bfd_hash_table_report
+   (struct bfd_hash_table *, const char */*what*/,
+    const char */*owner*/) ATTRIBUTE_HIDDEN;
+
 struct bfd_strtab_hash *_bfd_stringtab_init (void) ATTRIBUTE_HIDDEN;
 
 struct bfd_strtab_hash *_bfd_xcoff_stringtab_init
@@ -1024,10 +1306,17 @@ bfd_size_type _bfd_stringtab_add
    (struct bfd_strtab_hash *, const char *,
     bool /*hash*/, bool /*copy*/) ATTRIBUTE_HIDDEN;
 
+bool _bfd_stringtab_add_batch
+   (struct bfd_strtab_hash *, const char *const *,
+    size_t /*count*/, bool /*copy*/, bool /*tail_merge*/) ATTRIBUTE_HIDDEN;
+
 bfd_size_type _bfd_stringtab_size (struct bfd_strtab_hash *) ATTRIBUTE_HIDDEN;
 
 bool _bfd_stringtab_emit (bfd *, struct bfd_strtab_hash *) ATTRIBUTE_HIDDEN;
 
+const char *_bfd_intern_name
+   (bfd *abfd, const char *name, size_t len) ATTRIBUTE_HIDDEN;
+
 /* Extracted from linker.c.  */
 bool _bfd_generic_verify_endian_match
    (bfd *ibfd, struct bfd_link_info *info) ATTRIBUTE_HIDDEN;
@@ -3561,8 +3850,17 @@ bool _bfd_unrecognized_reloc
     unsigned int r_type) ATTRIBUTE_HIDDEN;
 
 /* Extracted from section.c.  */
+unsigned int *_bfd_section_id_counter (void) ATTRIBUTE_HIDDEN;
+
+void _bfd_set_thread_section_ids (unsigned int *counter) ATTRIBUTE_HIDDEN;
+
+void _bfd_section_map_free (bfd *) ATTRIBUTE_HIDDEN;
+
 bool _bfd_section_size_insane (bfd *abfd, asection *sec) ATTRIBUTE_HIDDEN;
 
+/* Extracted from simple.c.  */
+void _bfd_simple_link_free (bfd *) ATTRIBUTE_HIDDEN;
+
 /* Extracted from stabs.c.  */
 bool _bfd_link_section_stabs
    (bfd *, struct stab_info *, asection *, asection *, void **,
@@ -3588,6 +3886,45 @@ struct per_xvec_message
 
 struct per_xvec_message **_bfd_per_xvec_warn (const bfd_target *, size_t) ATTRIBUTE_HIDDEN;
 
+/* Extracted from threads.c.  */
+typedef struct bfd_mutex
+{
+  /* Host lock, or a pointer to it.  */
+  void *impl;
+}
+bfd_mutex;
+
+#define BFD_MUTEX_INIT { NULL }
+
+void _bfd_mutex_lock (bfd_mutex *) ATTRIBUTE_HIDDEN;
+
+void _bfd_mutex_unlock (bfd_mutex *) ATTRIBUTE_HIDDEN;
+
+void _bfd_mutex_destroy (bfd_mutex *) ATTRIBUTE_HIDDEN;
+
+int _bfd_atomic_add (int *ptr, int val) ATTRIBUTE_HIDDEN;
+
+int _bfd_atomic_load (const int *ptr) ATTRIBUTE_HIDDEN;
+
+bool _bfd_parallel_for
+   (size_t count, size_t grain,
+    bool (*func) (void *data, size_t start, size_t end),
+    void *data) ATTRIBUTE_HIDDEN;
+
+/* Extracted from trace.c.  */
+void _bfd_hook_fire
+   (enum bfd_hook_point point, const bfd *abfd,
+    const asection *section, const char *name,
+    uint64_t arg1, uint64_t arg2) ATTRIBUTE_HIDDEN;
+
+#define _bfd_hook(point, abfd, section, name, arg1, arg2)		\
+  do									\
+    if ((_bfd_hook_mask & (1u << (point))) != 0)			\
+      _bfd_hook_fire (point, abfd, section, name, arg1, arg2);	\
+  while (0)
+
+extern unsigned int _bfd_hook_mask ATTRIBUTE_HIDDEN;
+
 #ifdef __cplusplus
 }
 #endif
@@ -99,6 +99,16 @@ typedef struct coff_tdata
   bool keep_syms;
   /* If this is TRUE, the strings may not be freed.  */
   bool keep_strings;
+  /* If this is TRUE, the external_syms point into the file, as mapped
+     by _bfd_map_region, rather than into malloc'd memory.  A nonzero
+     SYMS_MAP_LEN is then a mapping of their own, at SYMS_MAP_ADDR.  */
+  bool syms_mapped;
+  void *syms_map_addr;
+  bfd_size_type syms_map_len;
+  /* Likewise for the strings.  */
+  bool strings_mapped;
+  void *strings_map_addr;
+  bfd_size_type strings_map_len;
   /* If this is TRUE, the strings have been written out already.  */
   bool strings_written;
 
@@ -165,6 +175,10 @@ typedef struct pe_tdata
     const char *style;
     asection *sec;
   } build_id;
+
+  /* The import and export index built by bfd_pe_get_exports and
+     bfd_pe_get_imports.  */
+  struct bfd_pe_index *pe_index;
 } pe_data_type;
 
 #define pe_data(bfd)		((bfd)->tdata.pe_obj_data)
@@ -548,6 +562,12 @@ struct coff_final_link_info
   bfd_byte *external_relocs;
   /* Buffer large enough to hold swapped relocs of any input section.  */
   struct internal_reloc *internal_relocs;
+  /* Work left for other threads, if sections are being relocated in
+     parallel.  */
+  struct coff_parallel_link *parallel;
+  /* Whether this is a worker thread's copy.  Workers relocate only
+     the sections that aren't loaded.  */
+  bool worker;
 };
 
 /* Most COFF variants have no way to record the alignment of a
@@ -866,6 +886,16 @@ typedef struct
   bool (*_bfd_coff_print_pdata)
     (bfd *, void *);
 
+  /* Swap in the symbols of a symbol table of COUNT entries, leaving
+     the auxiliary entries that follow each one to be swapped later.
+     Returns false if a symbol's auxiliary entries run off the end.  */
+  bool (*_bfd_coff_swap_syms_in)
+    (bfd *, void *, size_t, combined_entry_type *);
+
+  /* Swap in COUNT consecutive section headers.  */
+  void (*_bfd_coff_swap_scnhdrs_in)
+    (bfd *, void *, unsigned int, struct internal_scnhdr *);
+
 } bfd_coff_backend_data;
 
 #define coff_backend_info(abfd) \
@@ -1008,6 +1038,11 @@ typedef struct
 #define bfd_coff_print_pdata(a,p) \
   ((coff_backend_info (a)->_bfd_coff_print_pdata) (a, p))
 
+#define bfd_coff_swap_syms_in(abfd, e, n, i) \
+  ((coff_backend_info (abfd)->_bfd_coff_swap_syms_in) (abfd, e, n, i))
+#define bfd_coff_swap_scnhdrs_in(abfd, e, n, i) \
+  ((coff_backend_info (abfd)->_bfd_coff_swap_scnhdrs_in) (abfd, e, n, i))
+
 /* Macro: Returns true if the bfd is a PE executable as opposed to a
    PE object file.  */
 #define bfd_pei_p(abfd) \
@@ -234,6 +234,7 @@
 #define _bfd_XXi_swap_lineno_out			_bfd_pex64i_swap_lineno_out
 #define _bfd_XXi_swap_scnhdr_out			_bfd_pex64i_swap_scnhdr_out
 #define _bfd_XXi_swap_sym_in				_bfd_pex64i_swap_sym_in
+#define _bfd_XXi_swap_syms_in				_bfd_pex64i_swap_syms_in
 #define _bfd_XXi_swap_sym_out				_bfd_pex64i_swap_sym_out
 #define _bfd_XXi_swap_debugdir_in			_bfd_pex64i_swap_debugdir_in
 #define _bfd_XXi_swap_debugdir_out			_bfd_pex64i_swap_debugdir_out
@@ -269,6 +270,7 @@
 #define _bfd_XXi_swap_lineno_out			_bfd_pepi_swap_lineno_out
 #define _bfd_XXi_swap_scnhdr_out			_bfd_pepi_swap_scnhdr_out
 #define _bfd_XXi_swap_sym_in				_bfd_pepi_swap_sym_in
+#define _bfd_XXi_swap_syms_in				_bfd_pepi_swap_syms_in
 #define _bfd_XXi_swap_sym_out				_bfd_pepi_swap_sym_out
 #define _bfd_XXi_swap_debugdir_in			_bfd_pepi_swap_debugdir_in
 #define _bfd_XXi_swap_debugdir_out			_bfd_pepi_swap_debugdir_out
@@ -304,6 +306,7 @@
 #define _bfd_XXi_swap_lineno_out			_bfd_peAArch64i_swap_lineno_out
 #define _bfd_XXi_swap_scnhdr_out			_bfd_peAArch64i_swap_scnhdr_out
 #define _bfd_XXi_swap_sym_in				_bfd_peAArch64i_swap_sym_in
+#define _bfd_XXi_swap_syms_in				_bfd_peAArch64i_swap_syms_in
 #define _bfd_XXi_swap_sym_out				_bfd_peAArch64i_swap_sym_out
 #define _bfd_XXi_swap_debugdir_in			_bfd_peAArch64i_swap_debugdir_in
 #define _bfd_XXi_swap_debugdir_out			_bfd_peAArch64i_swap_debugdir_out
@@ -339,6 +342,7 @@
 #define _bfd_XXi_swap_lineno_out			_bfd_peLoongArch64i_swap_lineno_out
 #define _bfd_XXi_swap_scnhdr_out			_bfd_peLoongArch64i_swap_scnhdr_out
 #define _bfd_XXi_swap_sym_in				_bfd_peLoongArch64i_swap_sym_in
+#define _bfd_XXi_swap_syms_in				_bfd_peLoongArch64i_swap_syms_in
 #define _bfd_XXi_swap_sym_out				_bfd_peLoongArch64i_swap_sym_out
 #define _bfd_XXi_swap_debugdir_in			_bfd_peLoongArch64i_swap_debugdir_in
 #define _bfd_XXi_swap_debugdir_out			_bfd_peLoongArch64i_swap_debugdir_out
@@ -374,6 +378,7 @@
 #define _bfd_XXi_swap_lineno_out			_bfd_pei_swap_lineno_out
 #define _bfd_XXi_swap_scnhdr_out			_bfd_pei_swap_scnhdr_out
 #define _bfd_XXi_swap_sym_in				_bfd_pei_swap_sym_in
+#define _bfd_XXi_swap_syms_in				_bfd_pei_swap_syms_in
 #define _bfd_XXi_swap_sym_out				_bfd_pei_swap_sym_out
 #define _bfd_XXi_swap_debugdir_in			_bfd_pei_swap_debugdir_in
 #define _bfd_XXi_swap_debugdir_out			_bfd_pei_swap_debugdir_out
@@ -395,6 +400,7 @@
    peigen.c.  */
 
 #define coff_swap_sym_in      _bfd_XXi_swap_sym_in
+#define coff_swap_syms_in     _bfd_XXi_swap_syms_in
 #define coff_swap_sym_out     _bfd_XXi_swap_sym_out
 #define coff_swap_aux_in      _bfd_XXi_swap_aux_in
 #define coff_swap_aux_out     _bfd_XXi_swap_aux_out
@@ -409,6 +415,7 @@
 #endif
 
 void _bfd_XXi_swap_sym_in (bfd *, void *, void *);
+bool _bfd_XXi_swap_syms_in (bfd *, void *, size_t, combined_entry_type *);
 unsigned _bfd_XXi_swap_sym_out (bfd *, void *, void *);
 void _bfd_XXi_swap_aux_in (bfd *, void *, int, int, int, int, void *);
 unsigned _bfd_XXi_swap_aux_out (bfd *, void *, int, int, int, int, void *);
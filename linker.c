@@ -474,6 +474,10 @@ _bfd_link_hash_table_init
   ret = bfd_hash_table_init (&table->table, newfunc, entsize);
   if (ret)
     {
+      /* Symbol resolution is dominated by lookups in this table, so
+	 give it the open-addressed index.  If that can't be had the
+	 chains still work.  */
+      bfd_hash_table_set_layout (&table->table, bfd_hash_open);
       /* Arrange for destruction of this hash table on closing ABFD.  */
       table->hash_table_free = _bfd_generic_link_hash_table_free;
       abfd->link.hash = table;
@@ -524,6 +528,36 @@ bfd_link_hash_lookup (struct bfd_link_hash_table *table,
   return ret;
 }
 
+/* Likewise, but HASH is the hash code of STRING for TABLE, as given
+   by bfd_hash_string_hash.  */
+
+struct bfd_link_hash_entry *
+bfd_link_hash_lookup_with_hash (struct bfd_link_hash_table *table,
+				const char *string,
+				unsigned long long hash,
+				bool create,
+				bool copy,
+				bool follow)
+{
+  struct bfd_link_hash_entry *ret;
+
+  if (table == NULL || string == NULL)
+    return NULL;
+
+  ret = ((struct bfd_link_hash_entry *)
+	 bfd_hash_lookup_with_hash (&table->table, string, hash, create,
+				    copy));
+
+  if (follow && ret != NULL)
+    {
+      while (ret->type == bfd_link_hash_indirect
+	     || ret->type == bfd_link_hash_warning)
+	ret = ret->u.i.link;
+    }
+
+  return ret;
+}
+
 /* Look up a symbol in the main linker hash table if the symbol might
    be wrapped.  This should only be used for references to an
    undefined symbol, not for definitions of a symbol.  */
@@ -542,6 +576,8 @@ bfd_wrapped_link_hash_lookup (bfd *abfd,
     {
       const char *l;
       char prefix = '\0';
+      unsigned long long hash;
+      enum bfd_hash_function func;
 
       l = string;
       if (*l == bfd_get_symbol_leading_char (abfd) || *l == info->wrap_char)
@@ -553,7 +589,10 @@ bfd_wrapped_link_hash_lookup (bfd *abfd,
 #undef WRAP
 #define WRAP "__wrap_"
 
-      if (bfd_hash_lookup (info->wrap_hash, l, false, false) != NULL)
+      func = bfd_hash_table_function (info->wrap_hash);
+      hash = bfd_hash_string_hash (l, func);
+      if (bfd_hash_lookup_with_hash (info->wrap_hash, l, hash,
+				     false, false) != NULL)
 	{
 	  char *n;
 	  struct bfd_link_hash_entry *h;
@@ -606,6 +645,12 @@ bfd_wrapped_link_hash_lookup (bfd *abfd,
 	}
 
 #undef REAL
+
+      /* The unwrapped name has already been hashed once for
+	 WRAP_HASH; don't do it again for the symbol table.  */
+      if (l == string && func == bfd_hash_table_function (&info->hash->table))
+	return bfd_link_hash_lookup_with_hash (info->hash, string, hash,
+					       create, copy, follow);
     }
 
   return bfd_link_hash_lookup (info->hash, string, create, copy, follow);
@@ -675,6 +720,61 @@ bfd_link_hash_traverse
   htab->table.frozen = 0;
 }
 
+/* The function and reduction of a bfd_link_hash_traverse_parallel,
+   and their argument.  */
+
+struct link_hash_traverse_info
+{
+  bool (*func) (struct bfd_link_hash_entry *, void *, void *);
+  bool (*reduce) (void *, void *);
+  void *info;
+};
+
+static bool
+link_hash_traverse_func (struct bfd_hash_entry *ent, void *data,
+			 void *result)
+{
+  struct link_hash_traverse_info *inf
+    = (struct link_hash_traverse_info *) data;
+  struct bfd_link_hash_entry *p = (struct bfd_link_hash_entry *) ent;
+
+  return (*inf->func) (p->type == bfd_link_hash_warning ? p->u.i.link : p,
+		       inf->info, result);
+}
+
+static bool
+link_hash_traverse_reduce (void *data, void *result)
+{
+  struct link_hash_traverse_info *inf
+    = (struct link_hash_traverse_info *) data;
+
+  return (*inf->reduce) (inf->info, result);
+}
+
+/* Traverse a generic link hash table on several threads, as
+   bfd_hash_traverse_parallel does, calling FUNC with the real symbol
+   in place of a warning symbol as bfd_link_hash_traverse does.  */
+
+bool
+bfd_link_hash_traverse_parallel
+  (struct bfd_link_hash_table *htab,
+   bool (*func) (struct bfd_link_hash_entry *, void *, void *),
+   size_t result_size,
+   bool (*reduce) (void *, void *),
+   void *info)
+{
+  struct link_hash_traverse_info inf;
+
+  inf.func = func;
+  inf.reduce = reduce;
+  inf.info = info;
+  return bfd_hash_traverse_parallel (&htab->table, link_hash_traverse_func,
+				     result_size,
+				     (reduce != NULL
+				      ? link_hash_traverse_reduce : NULL),
+				     &inf);
+}
+
 /* Add a symbol to the linker hash table undefs list.  */
 
 void
@@ -788,6 +888,8 @@ _bfd_generic_link_hash_table_free (bfd *obfd)
 
   BFD_ASSERT (obfd->is_linker_output && obfd->link.hash);
   ret = (struct generic_link_hash_table *) obfd->link.hash;
+  _bfd_hash_table_report (&ret->root.table, "linker symbol",
+			  bfd_get_filename (obfd));
   bfd_hash_table_free (&ret->root.table);
   free (ret);
   obfd->link.hash = NULL;
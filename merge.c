@@ -109,6 +109,11 @@ struct sec_merge_info
   struct sec_merge_sec_info **last;
   /* A hash table used to hold section content.  */
   struct sec_merge_hash *htab;
+  /* When the content was recorded by several threads, the tables the
+     entries really live in, each holding those with some range of
+     hash values.  HTAB then only chains them together.  */
+  struct sec_merge_hash **shards;
+  unsigned int nshards;
 };
 
 /* Offset into input mergable sections are represented by this type.
@@ -188,6 +193,7 @@ sec_merge_maybe_resize (struct sec_merge_hash *table, unsigned added)
       newl = objalloc_alloc ((struct objalloc *) table->table.memory, alloc);
       if (newl == NULL)
 	return false;
+      _bfd_hash_table_account (&table->table, alloc);
       memset (newl, 0, alloc);
       alloc = newnb * sizeof (newv[0]);
       if (alloc / sizeof (newv[0]) != newnb)
@@ -195,6 +201,7 @@ sec_merge_maybe_resize (struct sec_merge_hash *table, unsigned added)
       newv = objalloc_alloc ((struct objalloc *) table->table.memory, alloc);
       if (newv == NULL)
 	return false;
+      _bfd_hash_table_account (&table->table, alloc);
       memset (newv, 0, alloc);
 
       for (i = 0; i < table->nbuckets; i++)
@@ -430,6 +437,7 @@ sec_merge_init (unsigned int entsize, bool strings)
       free (table);
       return NULL;
     }
+  bfd_hash_table_set_memory_class (&table->table, bfd_memory_merge);
 
   table->size = 0;
   table->first = NULL;
@@ -444,6 +452,9 @@ sec_merge_init (unsigned int entsize, bool strings)
   table->values = objalloc_alloc ((struct objalloc *) table->table.memory,
 				table->nbuckets * sizeof (table->values[0]));
   memset (table->values, 0, table->nbuckets * sizeof (table->values[0]));
+  _bfd_hash_table_account (&table->table,
+			   table->nbuckets * (sizeof (table->key_lens[0])
+					      + sizeof (table->values[0])));
 
   return table;
 }
@@ -674,6 +685,8 @@ _bfd_add_merge_section (bfd *abfd, void **psinfo, asection *sec,
       sinfo->next = (struct sec_merge_info *) *psinfo;
       sinfo->chain = NULL;
       sinfo->last = &sinfo->chain;
+      sinfo->shards = NULL;
+      sinfo->nshards = 0;
       *psinfo = sinfo;
       sinfo->htab = sec_merge_init (sec->entsize, (sec->flags & SEC_STRINGS));
       if (sinfo->htab == NULL)
@@ -780,6 +793,335 @@ record_section (struct sec_merge_info *sinfo,
   return false;
 }
 
+/* When several threads may be used, record_sections_parallel reads
+   input sections in batches of about this many bytes.  */
+#define MERGE_BATCH (64 * 1024 * 1024)
+
+/* The most hash table shards record_sections_parallel uses.  */
+#define MERGE_MAX_SHARDS 64
+
+/* A blob found in an input section, waiting to be entered into the
+   hash table.  */
+
+struct sec_merge_blob
+{
+  const char *str;
+  unsigned int len;
+  uint32_t hash;
+  unsigned int alignment;
+  mapofs_type ofs;
+  /* Set once entered: the entry, and whether this blob created it.  */
+  struct sec_merge_hash_entry *entry;
+  bool is_new;
+};
+
+/* One input section of a batch.  */
+
+struct sec_merge_scan
+{
+  struct sec_merge_sec_info *secinfo;
+  bfd_byte *contents;
+  struct sec_merge_blob *blobs;
+  size_t nblobs;
+};
+
+/* A batch of input sections being recorded by several threads.  */
+
+struct sec_merge_job
+{
+  struct sec_merge_info *sinfo;
+  struct sec_merge_scan *scans;
+  size_t nscans;
+
+  /* The blobs of the batch grouped by shard, in the order in which
+     they appear in the input; those of shard I start at
+     ROUTED[ROUTE_START[I]].  */
+  struct sec_merge_blob **routed;
+  size_t route_start[MERGE_MAX_SHARDS + 1];
+  unsigned int shard_shift;
+
+  /* Serializes reading the input sections.  */
+  bfd_mutex io_lock;
+};
+
+/* Read in the sections from START to END of JOB and find their blobs,
+   as record_section does.  */
+
+static bool
+merge_scan_range (void *data, size_t start, size_t end)
+{
+  struct sec_merge_job *job = (struct sec_merge_job *) data;
+  struct sec_merge_hash *htab = job->sinfo->htab;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    {
+      struct sec_merge_scan *scan = &job->scans[i];
+      asection *sec = scan->secinfo->sec;
+      unsigned char *p, *cend;
+      bfd_vma mask, eltalign;
+      size_t alloc = 0;
+      bfd_size_type amt;
+      bool got;
+
+      amt = sec->size;
+      if (sec->flags & SEC_STRINGS)
+	amt += sec->entsize;
+      scan->contents = bfd_malloc (amt);
+      if (scan->contents == NULL)
+	return false;
+      sec->rawsize = sec->size;
+      if (sec->flags & SEC_STRINGS)
+	memset (scan->contents + sec->size, 0, sec->entsize);
+      _bfd_mutex_lock (&job->io_lock);
+      got = bfd_get_full_section_contents (sec->owner, sec, &scan->contents);
+      _bfd_mutex_unlock (&job->io_lock);
+      if (!got)
+	return false;
+
+      mask = ((bfd_vma) 1 << sec->alignment_power) - 1;
+      cend = scan->contents + sec->size;
+      for (p = scan->contents; p < cend;)
+	{
+	  struct sec_merge_blob *blob;
+
+	  if (scan->nblobs == alloc)
+	    {
+	      void *n;
+
+	      alloc = alloc * 2 + 256;
+	      n = bfd_realloc (scan->blobs, alloc * sizeof (*scan->blobs));
+	      if (n == NULL)
+		return false;
+	      scan->blobs = (struct sec_merge_blob *) n;
+	    }
+	  blob = &scan->blobs[scan->nblobs++];
+	  blob->str = (const char *) p;
+	  blob->hash = hashit (htab, (char *) p, &blob->len);
+	  blob->ofs = p - scan->contents;
+	  eltalign = blob->ofs;
+	  eltalign = ((eltalign ^ (eltalign - 1)) + 1) >> 1;
+	  if (!eltalign || eltalign > mask)
+	    eltalign = mask + 1;
+	  blob->alignment = eltalign;
+	  p += blob->len;
+	}
+    }
+  return true;
+}
+
+/* Enter the blobs of shards START to END of JOB into their tables.  */
+
+static bool
+merge_insert_range (void *data, size_t start, size_t end)
+{
+  struct sec_merge_job *job = (struct sec_merge_job *) data;
+  size_t i, j;
+
+  for (i = start; i < end; i++)
+    {
+      struct sec_merge_hash *shard = job->sinfo->shards[i];
+
+      for (j = job->route_start[i]; j < job->route_start[i + 1]; j++)
+	{
+	  struct sec_merge_blob *blob = job->routed[j];
+	  bfd_size_type size = shard->size;
+
+	  if (!sec_merge_maybe_resize (shard, 1))
+	    {
+	      bfd_set_error (bfd_error_no_memory);
+	      return false;
+	    }
+	  blob->entry = sec_merge_hash_lookup (shard, blob->str, blob->len,
+					       blob->hash, blob->alignment);
+	  if (blob->entry == NULL)
+	    return false;
+	  blob->is_new = shard->size != size;
+	}
+
+      /* The entries are chained in input order by the caller, so
+	 don't let the next batch append to this shard's chain.  */
+      shard->first = NULL;
+      shard->last = NULL;
+    }
+  return true;
+}
+
+/* Enter the batch described by JOB into the hash tables of its
+   sec_merge_info.  */
+
+static bool
+merge_record_batch (struct sec_merge_job *job, unsigned int nshards)
+{
+  struct sec_merge_hash *htab = job->sinfo->htab;
+  size_t i, j, nblobs;
+  size_t next[MERGE_MAX_SHARDS];
+
+  if (!_bfd_parallel_for (job->nscans, 1, merge_scan_range, job))
+    return false;
+
+  /* Group the blobs by shard, keeping them in input order.  */
+  memset (job->route_start, 0, sizeof (job->route_start));
+  for (i = 0; i < job->nscans; i++)
+    for (j = 0; j < job->scans[i].nblobs; j++)
+      job->route_start[(job->scans[i].blobs[j].hash >> job->shard_shift)
+		       + 1]++;
+  for (i = 1; i <= nshards; i++)
+    job->route_start[i] += job->route_start[i - 1];
+  nblobs = job->route_start[nshards];
+  job->routed = bfd_malloc (nblobs * sizeof (*job->routed) + 1);
+  if (job->routed == NULL)
+    return false;
+  memcpy (next, job->route_start, sizeof (next));
+  for (i = 0; i < job->nscans; i++)
+    for (j = 0; j < job->scans[i].nblobs; j++)
+      {
+	struct sec_merge_blob *blob = &job->scans[i].blobs[j];
+
+	job->routed[next[blob->hash >> job->shard_shift]++] = blob;
+      }
+
+  if (!_bfd_parallel_for (nshards, 1, merge_insert_range, job))
+    return false;
+
+  /* Chain the new entries in input order, so that the merged section
+     comes out just as if they had been entered one by one, and build
+     the offset maps.  */
+  for (i = 0; i < job->nscans; i++)
+    {
+      struct sec_merge_scan *scan = &job->scans[i];
+      struct sec_merge_sec_info *secinfo = scan->secinfo;
+
+      for (j = 0; j < scan->nblobs; j++)
+	{
+	  struct sec_merge_hash_entry *entry = scan->blobs[j].entry;
+
+	  if (scan->blobs[j].is_new)
+	    {
+	      entry->next = NULL;
+	      if (htab->first == NULL)
+		htab->first = entry;
+	      else
+		htab->last->next = entry;
+	      htab->last = entry;
+	      htab->size++;
+	    }
+	  if (! append_offsetmap (secinfo, scan->blobs[j].ofs, entry))
+	    return false;
+	}
+      if (! append_offsetmap (secinfo, secinfo->sec->size, NULL))
+	return false;
+      secinfo->noffsetmap--;
+    }
+  return true;
+}
+
+/* Free the buffers of the batch described by JOB.  */
+
+static void
+merge_free_batch (struct sec_merge_job *job)
+{
+  size_t i;
+
+  for (i = 0; i < job->nscans; i++)
+    {
+      free (job->scans[i].contents);
+      free (job->scans[i].blobs);
+    }
+  memset (job->scans, 0, job->nscans * sizeof (*job->scans));
+  job->nscans = 0;
+  free (job->routed);
+  job->routed = NULL;
+}
+
+/* Like calling record_section for each input section of SINFO that is
+   still to be merged, but on as many threads as bfd_set_thread_count
+   allows.  The blobs of a batch of sections are found in parallel,
+   then entered into one of several hash tables chosen by their hash,
+   again in parallel.  The new entries are finally chained in the
+   order record_section would have created them, so the result does
+   not depend on the number of threads.  */
+
+static bool
+record_sections_parallel (struct sec_merge_info *sinfo)
+{
+  struct sec_merge_sec_info *secinfo;
+  struct sec_merge_job job;
+  unsigned int nshards, log;
+  size_t count;
+  bfd_size_type batch;
+  bool ret = false;
+
+  memset (&job, 0, sizeof (job));
+  if (sinfo->shards == NULL)
+    {
+      unsigned int i;
+
+      for (nshards = 2;
+	   nshards < bfd_get_thread_count () && nshards < MERGE_MAX_SHARDS;
+	   nshards *= 2)
+	;
+      sinfo->shards = bfd_zmalloc (nshards * sizeof (*sinfo->shards));
+      if (sinfo->shards == NULL)
+	goto out;
+      sinfo->nshards = nshards;
+      for (i = 0; i < nshards; i++)
+	{
+	  sinfo->shards[i] = sec_merge_init (sinfo->htab->entsize,
+					     sinfo->htab->strings);
+	  if (sinfo->shards[i] == NULL)
+	    goto out;
+	}
+    }
+  nshards = sinfo->nshards;
+  for (log = 1; (1u << log) < nshards; log++)
+    ;
+
+  job.sinfo = sinfo;
+  job.shard_shift = 32 - log;
+  for (count = 0, secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
+    if (*secinfo->psecinfo != NULL)
+      count++;
+  job.scans = bfd_zmalloc (count * sizeof (*job.scans) + 1);
+  if (job.scans == NULL)
+    goto out;
+
+  batch = 0;
+  for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
+    {
+      if (*secinfo->psecinfo == NULL)
+	continue;
+      job.scans[job.nscans++].secinfo = secinfo;
+      batch += secinfo->sec->size;
+      if (batch >= MERGE_BATCH)
+	{
+	  bool ok = merge_record_batch (&job, nshards);
+
+	  merge_free_batch (&job);
+	  if (!ok)
+	    goto out;
+	  batch = 0;
+	}
+    }
+  if (job.nscans != 0)
+    {
+      bool ok = merge_record_batch (&job, nshards);
+
+      merge_free_batch (&job);
+      if (!ok)
+	goto out;
+    }
+  ret = true;
+
+ out:
+  free (job.scans);
+  _bfd_mutex_destroy (&job.io_lock);
+  if (!ret)
+    for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
+      *secinfo->psecinfo = NULL;
+  return ret;
+}
+
 /* qsort comparison function.  Won't ever return zero as all entries
    differ, so there is no issue with qsort stability here.  */
 
@@ -834,6 +1176,239 @@ strrevcmp_align (const void *a, const void *b)
   return lenA - lenB;
 }
 
+/* Sort key of E at DEPTH for merge_sort_strings, giving the same order
+   as strrevcmp, or as strrevcmp_align if TAIL_MASK is nonzero.  The
+   keys are the low bits of the length under TAIL_MASK, if any, then
+   the bytes of the string from the end, then -1 once those run out,
+   so that a string sorts before the longer ones ending in it.  */
+
+static inline int
+strrev_key (const struct sec_merge_hash_entry *e, unsigned int depth,
+	    unsigned int tail_mask)
+{
+  if (tail_mask != 0)
+    {
+      if (depth == 0)
+	return e->len & tail_mask;
+      depth--;
+    }
+  if (depth >= e->len)
+    return -1;
+  return (unsigned char) e->str[e->len - 1 - depth];
+}
+
+/* Compare A and B, whose keys before DEPTH are known to be equal.  */
+
+static int
+strrev_compare_from (const struct sec_merge_hash_entry *a,
+		     const struct sec_merge_hash_entry *b,
+		     unsigned int depth, unsigned int tail_mask)
+{
+  for (;; depth++)
+    {
+      int ka = strrev_key (a, depth, tail_mask);
+      int kb = strrev_key (b, depth, tail_mask);
+
+      if (ka != kb)
+	return ka - kb;
+      if (ka == -1)
+	return 0;
+    }
+}
+
+/* A part of the array still to be sorted by merge_sort_strings_1.  */
+
+struct strrev_range
+{
+  size_t lo, n;
+  unsigned int depth;
+};
+
+/* Sort the N entries at A, whose keys before DEPTH are all equal, with
+   a multikey quicksort: partition on the key at DEPTH into less,
+   equal and greater, and only move on to the next key within the
+   equal part.  Each byte is looked at O(log N) times rather than in
+   every comparison.  Return false if memory ran out, leaving A in
+   some order.  */
+
+static bool
+merge_sort_strings_1 (struct sec_merge_hash_entry **a, size_t n,
+		      unsigned int depth, unsigned int tail_mask)
+{
+  struct strrev_range *stack = NULL;
+  size_t sp = 0, alloc = 0;
+
+#define STRREV_PUSH(LO, N, DEPTH)					\
+  do									\
+    {									\
+      if ((N) > 1)							\
+	{								\
+	  if (sp == alloc)						\
+	    {								\
+	      void *p_;							\
+	      alloc = alloc * 2 + 64;					\
+	      p_ = bfd_realloc (stack, alloc * sizeof (*stack));	\
+	      if (p_ == NULL)						\
+		{							\
+		  free (stack);						\
+		  return false;						\
+		}							\
+	      stack = (struct strrev_range *) p_;			\
+	    }								\
+	  stack[sp].lo = (LO);						\
+	  stack[sp].n = (N);						\
+	  stack[sp].depth = (DEPTH);					\
+	  sp++;								\
+	}								\
+    }									\
+  while (0)
+
+  STRREV_PUSH (0, n, depth);
+  while (sp != 0)
+    {
+      struct sec_merge_hash_entry **b, *t;
+      size_t lo, hi, i, lt, gt;
+      int k0, k1, k2, v;
+
+      sp--;
+      b = a + stack[sp].lo;
+      n = stack[sp].n;
+      depth = stack[sp].depth;
+
+      if (n < 16)
+	{
+	  /* Insertion sort small parts.  */
+	  for (i = 1; i < n; i++)
+	    for (lo = i;
+		 lo > 0 && strrev_compare_from (b[lo - 1], b[lo],
+						depth, tail_mask) > 0;
+		 lo--)
+	      {
+		t = b[lo];
+		b[lo] = b[lo - 1];
+		b[lo - 1] = t;
+	      }
+	  continue;
+	}
+
+      /* Use the median of three keys as the pivot.  */
+      k0 = strrev_key (b[0], depth, tail_mask);
+      k1 = strrev_key (b[n / 2], depth, tail_mask);
+      k2 = strrev_key (b[n - 1], depth, tail_mask);
+      if ((k0 <= k1 && k1 <= k2) || (k2 <= k1 && k1 <= k0))
+	v = k1;
+      else if ((k1 <= k0 && k0 <= k2) || (k2 <= k0 && k0 <= k1))
+	v = k0;
+      else
+	v = k2;
+
+      lt = i = 0;
+      gt = hi = n;
+      while (i < gt)
+	{
+	  int k = strrev_key (b[i], depth, tail_mask);
+
+	  if (k < v)
+	    {
+	      t = b[lt];
+	      b[lt++] = b[i];
+	      b[i++] = t;
+	    }
+	  else if (k > v)
+	    {
+	      t = b[--gt];
+	      b[gt] = b[i];
+	      b[i] = t;
+	    }
+	  else
+	    i++;
+	}
+
+      lo = b - a;
+      STRREV_PUSH (lo, lt, depth);
+      STRREV_PUSH (lo + gt, hi - gt, depth);
+      if (v != -1)
+	STRREV_PUSH (lo + lt, gt - lt, depth + 1);
+    }
+#undef STRREV_PUSH
+
+  free (stack);
+  return true;
+}
+
+/* Sort more than this many strings on several threads, if allowed.  */
+#define STRREV_PARALLEL_MIN 65536
+
+/* The buckets of a parallel merge_sort_strings.  Bucket K holds the
+   strings whose last byte is K - 1, or that are empty if K is 0.  */
+
+struct strrev_job
+{
+  struct sec_merge_hash_entry **array;
+  size_t start[258];
+};
+
+static bool
+strrev_sort_range (void *data, size_t start, size_t end)
+{
+  struct strrev_job *job = (struct strrev_job *) data;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    if (!merge_sort_strings_1 (job->array + job->start[i],
+			       job->start[i + 1] - job->start[i], 1, 0))
+      {
+	bfd_set_error (bfd_error_no_memory);
+	return false;
+      }
+  return true;
+}
+
+/* Sort the N entries of ARRAY into the order qsort with strrevcmp, or
+   strrevcmp_align if ALIGNED, would put them in.  Big arrays are split
+   by last byte and the parts sorted by several threads.  The entries
+   are all different, so any correct sort gives the same result.  */
+
+static void
+merge_sort_strings (struct sec_merge_hash_entry **array, size_t n,
+		    bool aligned)
+{
+  unsigned int tail_mask = aligned ? array[0]->alignment - 1 : 0;
+
+  if (!aligned
+      && n > STRREV_PARALLEL_MIN
+      && bfd_get_thread_count () > 1)
+    {
+      struct strrev_job job;
+      struct sec_merge_hash_entry **tmp;
+      size_t next[257], i;
+
+      tmp = (struct sec_merge_hash_entry **) bfd_malloc (n * sizeof (*tmp));
+      if (tmp != NULL)
+	{
+	  memset (job.start, 0, sizeof (job.start));
+	  for (i = 0; i < n; i++)
+	    job.start[strrev_key (array[i], 0, 0) + 2]++;
+	  for (i = 1; i < 258; i++)
+	    job.start[i] += job.start[i - 1];
+	  memcpy (next, job.start, sizeof (next));
+	  for (i = 0; i < n; i++)
+	    tmp[next[strrev_key (array[i], 0, 0) + 1]++] = array[i];
+	  memcpy (array, tmp, n * sizeof (*tmp));
+	  free (tmp);
+	  job.array = array;
+	  if (_bfd_parallel_for (257, 1, strrev_sort_range, &job))
+	    return;
+	}
+    }
+  else if (merge_sort_strings_1 (array, n, 0, tail_mask))
+    return;
+
+  /* Out of memory; fall back to a plain sort.  */
+  qsort (array, n, sizeof (*array),
+	 aligned ? strrevcmp_align : strrevcmp);
+}
+
 static inline int
 is_suffix (const struct sec_merge_hash_entry *A,
 	   const struct sec_merge_hash_entry *B)
@@ -881,10 +1456,9 @@ merge_strings (struct sec_merge_info *sinfo)
   sinfo->htab->size = a - array;
   if (sinfo->htab->size != 0)
     {
-      qsort (array, (size_t) sinfo->htab->size,
-	     sizeof (struct sec_merge_hash_entry *),
-	     (alignment != (unsigned) -1 && alignment > sinfo->htab->entsize
-	      ? strrevcmp_align : strrevcmp));
+      merge_sort_strings (array, (size_t) sinfo->htab->size,
+			  (alignment != (unsigned) -1
+			   && alignment > sinfo->htab->entsize));
 
       /* Loop over the sorted array and merge suffixes */
       e = *--a;
@@ -946,11 +1520,10 @@ merge_strings (struct sec_merge_info *sinfo)
 /* This function is called once after all SEC_MERGE sections are registered
    with _bfd_merge_section.  */
 
-bool
-_bfd_merge_sections (bfd *abfd,
-		     struct bfd_link_info *info ATTRIBUTE_UNUSED,
-		     void *xsinfo,
-		     void (*remove_hook) (bfd *, asection *))
+static bool
+_bfd_merge_sections_1 (bfd *abfd,
+		       void *xsinfo,
+		       void (*remove_hook) (bfd *, asection *))
 {
   struct sec_merge_info *sinfo;
 
@@ -958,11 +1531,14 @@ _bfd_merge_sections (bfd *abfd,
     {
       struct sec_merge_sec_info *secinfo;
       bfd_size_type align;  /* Bytes.  */
+      bool parallel;
 
       if (! sinfo->chain)
 	continue;
 
-      /* Record the sections into the hash table.  */
+      /* Record the sections into the hash table, on several threads
+	 if allowed.  */
+      parallel = bfd_get_thread_count () > 1 && sinfo->chain->next != NULL;
       align = 1;
       for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
 	if (secinfo->sec->flags & SEC_EXCLUDE)
@@ -973,7 +1549,7 @@ _bfd_merge_sections (bfd *abfd,
 	  }
 	else
 	  {
-	    if (!record_section (sinfo, secinfo))
+	    if (!parallel && !record_section (sinfo, secinfo))
 	      return false;
 	    if (align)
 	      {
@@ -984,6 +1560,8 @@ _bfd_merge_sections (bfd *abfd,
 		  align = 0;
 	      }
 	  }
+      if (parallel && !record_sections_parallel (sinfo))
+	return false;
 
       if (sinfo->htab->first == NULL)
 	continue;
@@ -1032,6 +1610,21 @@ _bfd_merge_sections (bfd *abfd,
   return true;
 }
 
+bool
+_bfd_merge_sections (bfd *abfd,
+		     struct bfd_link_info *info ATTRIBUTE_UNUSED,
+		     void *xsinfo,
+		     void (*remove_hook) (bfd *, asection *))
+{
+  bfd_trace_span span;
+  bool ret;
+
+  bfd_trace_begin (&span, "_bfd_merge_sections", abfd);
+  ret = _bfd_merge_sections_1 (abfd, xsinfo, remove_hook);
+  bfd_trace_end (&span);
+  return ret;
+}
+
 /* Write out the merged section.  */
 
 bool
@@ -1141,6 +1734,18 @@ _bfd_merge_sections_free (void *xsinfo)
 	  free (secinfo->map);
 	  free (secinfo->map_ofs);
 	}
+      if (sinfo->shards != NULL)
+	{
+	  unsigned int i;
+
+	  for (i = 0; i < sinfo->nshards; i++)
+	    if (sinfo->shards[i] != NULL)
+	      {
+		bfd_hash_table_free (&sinfo->shards[i]->table);
+		free (sinfo->shards[i]);
+	      }
+	  free (sinfo->shards);
+	}
       bfd_hash_table_free (&sinfo->htab->table);
       free (sinfo->htab);
     }
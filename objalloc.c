@@ -48,8 +48,11 @@ extern void free (void *);
 
    We handle large and small allocation requests differently.  If we
    don't have enough space in the current block, and the allocation
-   request is for more than 512 bytes, we simply pass it through to
-   malloc.  */
+   request is at least an eighth of the size of the next chunk, we
+   simply pass it through to malloc.  Each new chunk for small objects
+   is twice the size of the last, up to MAX_CHUNK_SIZE, so the
+   threshold for passing requests to malloc grows with the amount
+   allocated.  */
 
 /* The objalloc structure is defined in objalloc.h.  */
 
@@ -63,6 +66,8 @@ struct objalloc_chunk
      current_ptr when this chunk was allocated.  If this chunk
      contains small objects, this is NULL.  */
   char *current_ptr;
+  /* The size of this chunk, including this header.  */
+  unsigned long long size;
 };
 
 /* The aligned size of objalloc_chunk.  */
@@ -71,14 +76,27 @@ struct objalloc_chunk
   ((sizeof (struct objalloc_chunk) + OBJALLOC_ALIGN - 1)	\
    &~ (OBJALLOC_ALIGN - 1))
 
-/* We ask for this much memory each time we create a chunk which is to
-   hold small objects.  */
+/* We ask for this much memory for the first chunk which is to hold
+   small objects, and double the size (less the leeway left for malloc
+   overhead) for each chunk after that, up to MAX_CHUNK_SIZE.  */
 
 #define CHUNK_SIZE (4096 - 32)
+#define MAX_CHUNK_SIZE ((1024 * 1024) - 32)
 
-/* A request for this amount or more is just passed through to malloc.  */
+/* A request for this fraction of the next chunk size or more is just
+   passed through to malloc.  */
 
-#define BIG_REQUEST (512)
+#define BIG_REQUEST(o) ((o)->chunk_size / 8)
+
+/* Return the size of the chunk to allocate after one of SIZE.  */
+
+static unsigned int
+next_chunk_size (unsigned int size)
+{
+  if (size >= MAX_CHUNK_SIZE / 2)
+    return MAX_CHUNK_SIZE;
+  return (size + 32) * 2 - 32;
+}
 
 /* Create an objalloc structure.  */
 
@@ -102,9 +120,11 @@ objalloc_create (void)
   chunk = (struct objalloc_chunk *) ret->chunks;
   chunk->next = NULL;
   chunk->current_ptr = NULL;
+  chunk->size = CHUNK_SIZE;
 
   ret->current_ptr = (char *) chunk + CHUNK_HEADER_SIZE;
   ret->current_space = CHUNK_SIZE - CHUNK_HEADER_SIZE;
+  ret->chunk_size = next_chunk_size (CHUNK_SIZE);
 
   return ret;
 }
@@ -135,7 +155,7 @@ _objalloc_alloc (struct objalloc *o, unsigned long long original_len)
       return (void *) (o->current_ptr - len);
     }
 
-  if (len >= BIG_REQUEST)
+  if (len >= BIG_REQUEST (o))
     {
       char *ret;
       struct objalloc_chunk *chunk;
@@ -147,6 +167,7 @@ _objalloc_alloc (struct objalloc *o, unsigned long long original_len)
       chunk = (struct objalloc_chunk *) ret;
       chunk->next = (struct objalloc_chunk *) o->chunks;
       chunk->current_ptr = o->current_ptr;
+      chunk->size = CHUNK_HEADER_SIZE + len;
 
       o->chunks = (void *) chunk;
 
@@ -155,15 +176,18 @@ _objalloc_alloc (struct objalloc *o, unsigned long long original_len)
   else
     {
       struct objalloc_chunk *chunk;
+      unsigned int size = o->chunk_size;
 
-      chunk = (struct objalloc_chunk *) malloc (CHUNK_SIZE);
+      chunk = (struct objalloc_chunk *) malloc (size);
       if (chunk == NULL)
 	return NULL;
       chunk->next = (struct objalloc_chunk *) o->chunks;
       chunk->current_ptr = NULL;
+      chunk->size = size;
 
       o->current_ptr = (char *) chunk + CHUNK_HEADER_SIZE;
-      o->current_space = CHUNK_SIZE - CHUNK_HEADER_SIZE;
+      o->current_space = size - CHUNK_HEADER_SIZE;
+      o->chunk_size = next_chunk_size (size);
 
       o->chunks = (void *) chunk;
 
@@ -207,7 +231,7 @@ objalloc_free_block (struct objalloc *o, void *block)
     {
       if (p->current_ptr == NULL)
 	{
-	  if (b > (char *) p && b < (char *) p + CHUNK_SIZE)
+	  if (b > (char *) p && b < (char *) p + p->size)
 	    break;
 	  small = p;
 	}
@@ -261,7 +285,7 @@ objalloc_free_block (struct objalloc *o, void *block)
 
       /* Now start allocating from this small block again.  */
       o->current_ptr = b;
-      o->current_space = ((char *) p + CHUNK_SIZE) - b;
+      o->current_space = ((char *) p + p->size) - b;
     }
   else
     {
@@ -293,6 +317,32 @@ objalloc_free_block (struct objalloc *o, void *block)
 	p = p->next;
 
       o->current_ptr = current_ptr;
-      o->current_space = ((char *) p + CHUNK_SIZE) - current_ptr;
+      o->current_space = ((char *) p + p->size) - current_ptr;
     }
 }
+
+/* Report how much memory an objalloc structure holds.  */
+
+void
+objalloc_stats (struct objalloc *o, struct objalloc_stats *stats)
+{
+  struct objalloc_chunk *p;
+
+  stats->small_chunks = 0;
+  stats->small_bytes = 0;
+  stats->large_chunks = 0;
+  stats->large_bytes = 0;
+  stats->free_bytes = o->current_space;
+
+  for (p = (struct objalloc_chunk *) o->chunks; p != NULL; p = p->next)
+    if (p->current_ptr == NULL)
+      {
+	stats->small_chunks++;
+	stats->small_bytes += p->size;
+      }
+    else
+      {
+	stats->large_chunks++;
+	stats->large_bytes += p->size;
+      }
+}
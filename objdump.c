@@ -50,6 +50,7 @@
 
 #include "sysdep.h"
 #include "bfd.h"
+#include "libbfd.h"
 #include "elf-bfd.h"
 #include "coff-bfd.h"
 #include "bucomm.h"
@@ -64,6 +65,8 @@
 #include "libiberty.h"
 #include "demangle.h"
 #include "filenames.h"
+#include "splay-tree.h"
+#include "hashtab.h"
 #include "debug.h"
 #include "budbg.h"
 #include "objdump.h"
@@ -117,6 +120,9 @@ static int disassemble_zeroes;		/* --disassemble-zeroes */
 static bool formats_info;		/* -i */
 int wide_output;			/* -w */
 static int insn_width;			/* --insn-width */
+static bool json_output;		/* --json */
+static bool session_mode;		/* --session */
+static bool io_statistics;		/* --io-statistics */
 static bfd_vma start_address = (bfd_vma) -1; /* --start-address */
 static bfd_vma stop_address = (bfd_vma) -1;  /* --stop-address */
 static int dump_debugging;		/* --debugging */
@@ -158,8 +164,9 @@ static int demangle_flags = DMGL_ANSI | DMGL_PARAMS;
    when the disassembler emits something in the dis_style_comment_start
    style.  Once this is true, all further output on that line is done in
    the comment style.  This only has an effect when disassembler coloring
-   is turned on.  */
-static bool disassembler_in_comment = false;
+   is turned on.  It is per thread, as --threads may disassemble several
+   pieces at once.  */
+static TLS bool disassembler_in_comment = false;
 
 /* A structure to record the sections mentioned in -j switches.  */
 struct only
@@ -230,8 +237,8 @@ static const struct objdump_private_desc * const objdump_private_vectors[] =
     NULL
   };
 
-/* The list of detected jumps inside a function.  */
-static struct jump_info *detected_jumps = NULL;
+/* The jumps detected inside a function.  */
+static struct jump_table *detected_jumps = NULL;
 
 typedef enum unicode_display_type
 {
@@ -396,6 +403,21 @@ usage (FILE *stream, int status)
       fprintf (stream, _("\
       --insn-width=WIDTH         Display WIDTH bytes on a single line for -d\n"));
       fprintf (stream, _("\
+      --threads=N                Use up to N threads, 0 for one per processor,\n\
+                                  to disassemble large sections\n"));
+      fprintf (stream, _("\
+      --trace=FILE               Write the time each phase took to FILE, in\n\
+                                  Chrome's trace event format\n"));
+      fprintf (stream, _("\
+      --io-statistics            Count the reads, seeks and maps of the input\n\
+                                  files and print the totals at exit\n"));
+      fprintf (stream, _("\
+      --json                     Print the disassembly as JSON lines, one\n\
+                                  record per instruction\n"));
+      fprintf (stream, _("\
+      --session                  Keep files open and answer requests read\n\
+                                  from standard input, one per line\n"));
+      fprintf (stream, _("\
       --adjust-vma=OFFSET        Add OFFSET to all displayed section addresses\n"));
       fprintf (stream, _("\
       --show-all-symbols         When disassembling, display all symbols at a given address\n"));
@@ -484,7 +506,12 @@ enum option_values
 #endif
     OPTION_SFRAME,
     OPTION_VISUALIZE_JUMPS,
-    OPTION_DISASSEMBLER_COLOR
+    OPTION_DISASSEMBLER_COLOR,
+    OPTION_THREADS,
+    OPTION_TRACE,
+    OPTION_IO_STATISTICS,
+    OPTION_JSON,
+    OPTION_SESSION
   };
 
 static struct option long_options[]=
@@ -521,6 +548,7 @@ static struct option long_options[]=
   {"info", no_argument, NULL, 'i'},
   {"inlines", no_argument, 0, OPTION_INLINES},
   {"insn-width", required_argument, NULL, OPTION_INSN_WIDTH},
+  {"json", no_argument, NULL, OPTION_JSON},
   {"line-numbers", no_argument, NULL, 'l'},
   {"no-addresses", no_argument, &no_addresses, 1},
   {"no-recurse-limit", no_argument, NULL, OPTION_NO_RECURSE_LIMIT},
@@ -537,6 +565,7 @@ static struct option long_options[]=
   {"reloc", no_argument, NULL, 'r'},
   {"section", required_argument, NULL, 'j'},
   {"section-headers", no_argument, NULL, 'h'},
+  {"session", no_argument, NULL, OPTION_SESSION},
   {"sframe", optional_argument, NULL, OPTION_SFRAME},
   {"show-all-symbols", no_argument, &show_all_symbols, 1},
   {"show-raw-insn", no_argument, &show_raw_insn, 1},
@@ -548,6 +577,9 @@ static struct option long_options[]=
   {"stop-address", required_argument, NULL, OPTION_STOP_ADDRESS},
   {"syms", no_argument, NULL, 't'},
   {"target", required_argument, NULL, 'b'},
+  {"threads", required_argument, NULL, OPTION_THREADS},
+  {"trace", required_argument, NULL, OPTION_TRACE},
+  {"io-statistics", no_argument, NULL, OPTION_IO_STATISTICS},
   {"unicode", required_argument, NULL, 'U'},
   {"version", no_argument, NULL, 'V'},
   {"visualize-jumps", optional_argument, 0, OPTION_VISUALIZE_JUMPS},
@@ -673,8 +705,8 @@ display_utf8 (const unsigned char * in, char * out, unsigned int * consumed)
 }
 
 /* Returns a version of IN with any control characters
-   replaced by escape sequences.  Uses a static buffer
-   if necessary.
+   replaced by escape sequences.  Uses a static, per
+   thread buffer if necessary.
 
    If unicode display is enabled, then also handles the
    conversion of unicode characters.  */
@@ -682,8 +714,8 @@ display_utf8 (const unsigned char * in, char * out, unsigned int * consumed)
 static const char *
 sanitize_string (const char * in)
 {
-  static char *  buffer = NULL;
-  static size_t  buffer_len = 0;
+  static TLS char *  buffer = NULL;
+  static TLS size_t  buffer_len = 0;
   const char *   original = in;
   char *         out;
 
@@ -1233,27 +1265,116 @@ compare_symbols (const void *ap, const void *bp)
   return strcmp (an, bn);
 }
 
-/* Sort relocs into address order.  */
+/* Pseudo FILE object for strings.  */
+typedef struct
+{
+  char *buffer;
+  size_t pos;
+  size_t alloc;
+} SFILE;
+
+/* Append the LEN bytes at S to F, keeping F NUL terminated.  */
 
-static int
-compare_relocs (const void *ap, const void *bp)
+static void
+sfile_write (SFILE *f, const char *s, size_t len)
+{
+  if (f->alloc - f->pos <= len)
+    {
+      f->alloc = (f->alloc + len + 1) * 2;
+      f->buffer = (char *) xrealloc (f->buffer, f->alloc);
+    }
+  memcpy (f->buffer + f->pos, s, len);
+  f->pos += len;
+  f->buffer[f->pos] = '\0';
+}
+
+/* The listing buffer of dump_symbols and dump_reloc_set.  Their lines
+   are built up here and written out LIST_FLUSH_SIZE bytes at a time,
+   rather than going through printf field by field.  */
+
+static SFILE list_out;
+
+#define LIST_FLUSH_SIZE (256 * 1024)
+
+/* Write out whatever is in the listing buffer.  This must be done
+   before printing to stdout any other way.  */
+
+static void
+list_flush (void)
 {
-  const arelent *a = * (const arelent **) ap;
-  const arelent *b = * (const arelent **) bp;
+  if (list_out.pos != 0)
+    fwrite (list_out.buffer, 1, list_out.pos, stdout);
+  list_out.pos = 0;
+}
 
-  if (a->address > b->address)
-    return 1;
-  else if (a->address < b->address)
-    return -1;
+/* Finish a line of the listing, writing the buffer out if it is
+   full enough.  */
 
-  /* So that associated relocations tied to the same address show up
-     in the correct order, we don't do any further sorting.  */
-  if (a > b)
-    return 1;
-  else if (a < b)
-    return -1;
+static void
+list_end_line (void)
+{
+  sfile_write (&list_out, "\n", 1);
+  if (list_out.pos >= LIST_FLUSH_SIZE)
+    list_flush ();
+}
+
+static void
+list_puts (const char *s)
+{
+  sfile_write (&list_out, s, strlen (s));
+}
+
+/* Append VMA to the listing buffer as bfd_printf_vma would print it
+   for ABFD.  The number of digits that uses depends only on the target
+   and the architecture, so it is only asked for when they change.  */
+
+static void
+list_vma (bfd *abfd, bfd_vma vma)
+{
+  static const char hex[] = "0123456789abcdef";
+  static const bfd_target *digits_xvec;
+  static const bfd_arch_info_type *digits_arch;
+  static int digits;
+  char buf[64];
+  int i;
+
+  if (abfd->xvec != digits_xvec || abfd->arch_info != digits_arch)
+    {
+      bfd_sprintf_vma (abfd, buf, 0);
+      digits = strlen (buf);
+      digits_xvec = abfd->xvec;
+      digits_arch = abfd->arch_info;
+    }
+  for (i = digits - 1; i >= 0; i--)
+    {
+      buf[i] = hex[vma & 0xf];
+      vma >>= 4;
+    }
+  sfile_write (&list_out, buf, digits);
+}
+
+static int objdump_unstyled_sprintf (SFILE *, enum disassembler_style,
+				     const char *, ...) ATTRIBUTE_PRINTF_3;
+static int objdump_styled_sprintf (SFILE *, enum disassembler_style,
+				   const char *, ...) ATTRIBUTE_PRINTF_3;
+
+/* Print the string S to the output stream in INFO, in STYLE.  When
+   the stream is one of our own buffers and no color is wanted, S is
+   appended directly rather than being formatted through the
+   printer.  */
+
+static void
+objdump_print_text (struct disassemble_info *inf,
+		    enum disassembler_style style, const char *s)
+{
+  if (inf->fprintf_styled_func
+      == (fprintf_styled_ftype) objdump_unstyled_sprintf
+      || (inf->fprintf_styled_func
+	  == (fprintf_styled_ftype) objdump_styled_sprintf
+	  && disassembler_color == off))
+    sfile_write ((SFILE *) inf->stream, s, strlen (s));
   else
-    return 0;
+    (*inf->fprintf_styled_func) (inf->stream, style, "%s", s);
 }
 
 /* Print an address (VMA) to the output stream in INFO.
@@ -1278,10 +1399,11 @@ objdump_print_value (bfd_vma vma, struct disassemble_info *inf,
       if (*p == '\0')
 	--p;
     }
-  (*inf->fprintf_styled_func) (inf->stream, dis_style_address, "%s", p);
+  objdump_print_text (inf, dis_style_address, p);
 }
 
-/* Print the name of a symbol.  */
+/* Print the name of a symbol, to INF or if that is NULL to the listing
+   buffer.  */
 
 static void
 objdump_print_symname (bfd *abfd, struct disassemble_info *inf,
@@ -1312,7 +1434,7 @@ objdump_print_symname (bfd *abfd, struct disassemble_info *inf,
 
   if (inf != NULL)
     {
-      (*inf->fprintf_styled_func) (inf->stream, dis_style_symbol, "%s", name);
+      objdump_print_text (inf, dis_style_symbol, name);
       if (version_string && *version_string != '\0')
 	(*inf->fprintf_styled_func) (inf->stream, dis_style_symbol,
 				     hidden ? "@%s" : "@@%s",
@@ -1320,9 +1442,12 @@ objdump_print_symname (bfd *abfd, struct disassemble_info *inf,
     }
   else
     {
-      printf ("%s", name);
+      list_puts (name);
       if (version_string && *version_string != '\0')
-	printf (hidden ? "@%s" : "@@%s", version_string);
+	{
+	  list_puts (hidden ? "@" : "@@");
+	  list_puts (version_string);
+	}
     }
 
   if (alloc != NULL)
@@ -1360,6 +1485,165 @@ sym_ok (bool want_section,
   return inf->symbol_is_valid (sorted_syms[place], inf);
 }
 
+/* The symbols find_symbol_for_address picks for the section being
+   disassembled, worked out once per section by build_sym_ranges.
+   There is one range for each run of symbols in sorted_syms with the
+   same value, covering the addresses from that value up to the next.
+   PLACE is indexed by whether the symbol must be in the section, and
+   is -1 if no symbol is suitable.  IN_SECTION is set if PLACE is a
+   symbol in the section at START, which is used as is rather than
+   being refined from the dynamic relocs.  */
+
+struct sym_range
+{
+  bfd_vma start;
+  long long place[2];
+  bool in_section;
+};
+
+static struct sym_range *sym_ranges;
+static long long sym_range_count;
+
+/* What to pick for addresses below the first symbol.  */
+static long long sym_range_below[2];
+static bool sym_range_below_in_section;
+
+/* The section and file the ranges were built for.  */
+static asection *sym_range_section;
+static bfd *sym_range_bfd;
+
+/* Build sym_ranges for the section in INF, once sorted_syms has been
+   sorted for it.  The choices are those the searches in
+   find_symbol_for_address would make, with the linear scans over
+   unsuitable symbols done once for the whole section rather than for
+   every address looked up.  */
+
+static void
+build_sym_ranges (struct disassemble_info *inf)
+{
+  struct objdump_disasm_info *aux
+    = (struct objdump_disasm_info *) inf->application_data;
+  asection *sec = inf->section;
+  bool *ok[2];
+  long long *low[2];
+  long long i, g, ngroups;
+  int w;
+
+  sym_range_section = NULL;
+  sym_range_count = 0;
+  if (sorted_symcount < 1)
+    return;
+
+  /* Whether each symbol is suitable, with and without a symbol in the
+     section being required.  */
+  ok[0] = (bool *) xmalloc (2 * sorted_symcount * sizeof (bool));
+  ok[1] = ok[0] + sorted_symcount;
+  for (i = 0; i < sorted_symcount; i++)
+    {
+      ok[0][i] = sym_ok (false, aux->abfd, i, sec, inf);
+      ok[1][i] = ok[0][i] && sym_ok (true, aux->abfd, i, sec, inf);
+    }
+
+  ngroups = 0;
+  for (i = 0; i < sorted_symcount; i++)
+    if (i == 0
+	|| (bfd_asymbol_value (sorted_syms[i])
+	    != bfd_asymbol_value (sorted_syms[i - 1])))
+      ngroups++;
+
+  sym_ranges = (struct sym_range *) xrealloc (sym_ranges,
+					      ngroups * sizeof (*sym_ranges));
+  low[0] = (long long *) xmalloc (2 * ngroups * sizeof (long long));
+  low[1] = low[0] + ngroups;
+
+  /* The first suitable symbol of each run, if any.  A symbol in the
+     section is taken first whatever is required.  */
+  g = -1;
+  for (i = 0; i < sorted_symcount; i++)
+    {
+      if (i == 0
+	  || (bfd_asymbol_value (sorted_syms[i])
+	      != bfd_asymbol_value (sorted_syms[i - 1])))
+	{
+	  g++;
+	  sym_ranges[g].start = bfd_asymbol_value (sorted_syms[i]);
+	  low[0][g] = low[1][g] = -1;
+	}
+      for (w = 0; w < 2; w++)
+	if (low[w][g] < 0 && ok[w][i])
+	  low[w][g] = i;
+    }
+
+  for (w = 0; w < 2; w++)
+    {
+      long long prev = -1;
+      long long next = -1;
+
+      /* The nearest run at or below, failing which the first suitable
+	 symbol above.  */
+      for (g = 0; g < ngroups; g++)
+	{
+	  if (low[w][g] >= 0)
+	    prev = low[w][g];
+	  sym_ranges[g].place[w] = low[1][g] >= 0 ? low[1][g] : prev;
+	  sym_ranges[g].in_section = low[1][g] >= 0;
+	}
+      for (g = ngroups; g-- > 0; )
+	{
+	  if (sym_ranges[g].place[w] < 0)
+	    sym_ranges[g].place[w] = next;
+	  if (low[w][g] >= 0)
+	    next = low[w][g];
+	}
+
+      /* Below the first symbol, symbols in the section are not
+	 preferred over the rest of the first run.  */
+      sym_range_below[w] = -1;
+      for (i = 0; i < sorted_symcount; i++)
+	if (ok[w][i])
+	  {
+	    sym_range_below[w] = i;
+	    break;
+	  }
+    }
+  sym_range_below_in_section = ok[1][0];
+
+  free (low[0]);
+  free (ok[0]);
+  sym_range_count = ngroups;
+  sym_range_section = sec;
+  sym_range_bfd = aux->abfd;
+}
+
+/* Return the index in sorted_syms of the symbol to use for VMA, or -1,
+   from sym_ranges.  Set *IN_SECTION as for struct sym_range.  */
+
+static long long
+find_sym_range (bfd_vma vma, bool want_section, bool *in_section)
+{
+  long long min = 0;
+  long long max = sym_range_count;
+
+  if (vma < sym_ranges[0].start)
+    {
+      *in_section = sym_range_below_in_section;
+      return sym_range_below[want_section];
+    }
+
+  /* Find the last range starting at or below VMA.  */
+  while (min + 1 < max)
+    {
+      long long mid = (min + max) / 2;
+
+      if (sym_ranges[mid].start <= vma)
+	min = mid;
+      else
+	max = mid;
+    }
+  *in_section = sym_ranges[min].in_section;
+  return sym_ranges[min].place[want_section];
+}
+
 /* Locate a symbol given a bfd and a section (from INFO->application_data),
    and a VMA.  If INFO->application_data->require_sec is TRUE, then always
    require the symbol to be in the section.  Returns NULL if there is no
@@ -1395,6 +1679,37 @@ find_symbol_for_address (bfd_vma vma,
   sec = inf->section;
   opb = inf->octets_per_byte;
 
+  /* If the file is relocatable, and the symbol could be from this
+     section, prefer a symbol from this section over symbols from
+     others, even if the other symbol's value might be closer.
+
+     Note that this may be wrong for some symbol references if the
+     sections have overlapping memory ranges, but in that case there's
+     no way to tell what's desired without looking at the relocation
+     table.
+
+     Also give the target a chance to reject symbols.  */
+  want_section = (aux->require_sec
+		  || ((abfd->flags & HAS_RELOC) != 0
+		      && vma >= bfd_section_vma (sec)
+		      && vma < (bfd_section_vma (sec)
+				+ bfd_section_size (sec) / opb)));
+
+  if (sec == sym_range_section && abfd == sym_range_bfd)
+    {
+      bool in_section;
+
+      thisplace = find_sym_range (vma, want_section, &in_section);
+      if (thisplace < 0)
+	return NULL;
+      if (!in_section)
+	goto found;
+
+      if (place != NULL)
+	*place = thisplace;
+      return sorted_syms[thisplace];
+    }
+
   /* Perform a binary search looking for the closest symbol to the
      required value.  We are searching the range (min, max_count].  */
   while (min + 1 < max_count)
@@ -1444,22 +1759,6 @@ find_symbol_for_address (bfd_vma vma,
       ++min;
     }
 
-  /* If the file is relocatable, and the symbol could be from this
-     section, prefer a symbol from this section over symbols from
-     others, even if the other symbol's value might be closer.
-
-     Note that this may be wrong for some symbol references if the
-     sections have overlapping memory ranges, but in that case there's
-     no way to tell what's desired without looking at the relocation
-     table.
-
-     Also give the target a chance to reject symbols.  */
-  want_section = (aux->require_sec
-		  || ((abfd->flags & HAS_RELOC) != 0
-		      && vma >= bfd_section_vma (sec)
-		      && vma < (bfd_section_vma (sec)
-				+ bfd_section_size (sec) / opb)));
-
   if (! sym_ok (want_section, abfd, thisplace, sec, inf))
     {
       long long i;
@@ -1503,6 +1802,7 @@ find_symbol_for_address (bfd_vma vma,
 	return NULL;
     }
 
+ found:
   /* If we have not found an exact match for the specified address
      and we have dynamic relocations available, then we can produce
      a better result by matching a relocation to the address and
@@ -1578,33 +1878,32 @@ objdump_print_addr_with_sym (bfd *abfd, asection *sec, asymbol *sym,
   if (!no_addresses)
     {
       objdump_print_value (vma, inf, skip_zeroes);
-      (*inf->fprintf_styled_func) (inf->stream, dis_style_text, " ");
+      objdump_print_text (inf, dis_style_text, " ");
     }
 
   if (sym == NULL)
     {
       bfd_vma secaddr;
 
-      (*inf->fprintf_styled_func) (inf->stream, dis_style_text,"<");
-      (*inf->fprintf_styled_func) (inf->stream, dis_style_symbol, "%s",
-				   sanitize_string (bfd_section_name (sec)));
+      objdump_print_text (inf, dis_style_text, "<");
+      objdump_print_text (inf, dis_style_symbol,
+			  sanitize_string (bfd_section_name (sec)));
       secaddr = bfd_section_vma (sec);
       if (vma < secaddr)
 	{
-	  (*inf->fprintf_styled_func) (inf->stream, dis_style_immediate,
-				       "-0x");
+	  objdump_print_text (inf, dis_style_immediate, "-0x");
 	  objdump_print_value (secaddr - vma, inf, true);
 	}
       else if (vma > secaddr)
 	{
-	  (*inf->fprintf_styled_func) (inf->stream, dis_style_immediate, "+0x");
+	  objdump_print_text (inf, dis_style_immediate, "+0x");
 	  objdump_print_value (vma - secaddr, inf, true);
 	}
-      (*inf->fprintf_styled_func) (inf->stream, dis_style_text, ">");
+      objdump_print_text (inf, dis_style_text, ">");
     }
   else
     {
-      (*inf->fprintf_styled_func) (inf->stream, dis_style_text, "<");
+      objdump_print_text (inf, dis_style_text, "<");
 
       objdump_print_symname (abfd, inf, sym);
 
@@ -1621,16 +1920,16 @@ objdump_print_addr_with_sym (bfd *abfd, asection *sec, asymbol *sym,
 	;
       else if (bfd_asymbol_value (sym) > vma)
 	{
-	  (*inf->fprintf_styled_func) (inf->stream, dis_style_immediate,"-0x");
+	  objdump_print_text (inf, dis_style_immediate, "-0x");
 	  objdump_print_value (bfd_asymbol_value (sym) - vma, inf, true);
 	}
       else if (vma > bfd_asymbol_value (sym))
 	{
-	  (*inf->fprintf_styled_func) (inf->stream, dis_style_immediate, "+0x");
+	  objdump_print_text (inf, dis_style_immediate, "+0x");
 	  objdump_print_value (vma - bfd_asymbol_value (sym), inf, true);
 	}
 
-      (*inf->fprintf_styled_func) (inf->stream, dis_style_text, ">");
+      objdump_print_text (inf, dis_style_text, ">");
     }
 
   if (display_file_offsets)
@@ -1719,17 +2018,23 @@ static char *prev_functionname;
 static unsigned int prev_line;
 static unsigned int prev_discriminator;
 
-/* We keep a list of all files that we have seen when doing a
+/* We keep a table of all files that we have seen when doing a
    disassembly with source, so that we know how much of the file to
-   display.  This can be important for inlined functions.  */
+   display.  This can be important for inlined functions.  The table
+   is hashed on the file name as given in the debug info.  */
 
 struct print_file_list
 {
-  struct print_file_list *next;
+  /* Neighbours on the list of files whose contents are loaded, most
+     recently used first.  */
+  struct print_file_list *lru_prev;
+  struct print_file_list *lru_next;
   const char *filename;
   const char *modname;
   const char *map;
   size_t mapsize;
+  /* True if MAP was mapped rather than read into the heap.  */
+  bool mapped;
   const char **linemap;
   unsigned maxline;
   unsigned last_line;
@@ -1737,7 +2042,22 @@ struct print_file_list
   int first;
 };
 
-static struct print_file_list *print_files;
+static htab_t print_files;
+
+/* The BFD whose source files are in print_files.  --session keeps
+   them from one request to the next on the same BFD.  */
+static bfd *print_files_bfd;
+
+/* The files on the LRU list, and the memory their contents and line
+   maps take up.  When that goes over SOURCE_CACHE_LIMIT the least
+   recently used files are released, to be loaded again if they are
+   needed.  */
+
+static struct print_file_list *print_files_lru_head;
+static struct print_file_list *print_files_lru_tail;
+static size_t print_files_loaded;
+
+#define SOURCE_CACHE_LIMIT (64 * 1024 * 1024)
 
 /* The number of preceding context lines to show when we start
    displaying a file for the first time.  */
@@ -1859,12 +2179,14 @@ find_alt_debug (const bfd * abfd)
 #endif /* HAVE_LIBDEBUGINFOD */
 
 /* Reads the contents of file FN into memory.  Returns a pointer to the buffer.
-   Also returns the size of the buffer in SIZE_RETURN and a filled out
-   stat structure in FST_RETURN.  Returns NULL upon failure.  */
+   Also returns the size of the buffer in SIZE_RETURN, whether it was
+   mapped in MAPPED_RETURN and a filled out stat structure in
+   FST_RETURN.  Returns NULL upon failure.  */
 
 static const char *
 slurp_file (const char *   fn,
 	    size_t *       size_return,
+	    bool *         mapped_return,
 	    struct stat *  fst_return,
 	    bfd *          abfd ATTRIBUTE_UNUSED)
 {
@@ -1910,6 +2232,7 @@ slurp_file (const char *   fn,
     }
 
   *size_return = fst_return->st_size;
+  *mapped_return = false;
 
 #ifdef HAVE_MMAP
   ps = getpagesize ();
@@ -1918,6 +2241,7 @@ slurp_file (const char *   fn,
   if (map != (char *) -1L)
     {
       close (fd);
+      *mapped_return = true;
       return map;
     }
 #endif
@@ -1932,65 +2256,221 @@ slurp_file (const char *   fn,
   return map;
 }
 
-#define line_map_decrease 5
+/* Return the first C in [P, END), or END if there is none.  PREV is
+   the result of the last search for C, which is still good if it is
+   at or after P.  */
+
+static inline const char *
+find_next_char (const char *p, const char *end, int c, const char *prev)
+{
+  if (prev != NULL && prev >= p)
+    return prev;
+  prev = (const char *) memchr (p, c, end - p);
+  return prev != NULL ? prev : end;
+}
+
+/* Count the lines in the SIZE bytes at MAP, storing the start of each
+   in LINEMAP if that is not NULL.  A line ends at "\n", "\r", "\n\r"
+   or "\r\n", and the line ends are found with memchr rather than
+   byte by byte.  */
+
+static unsigned int
+scan_lines (const char *map, size_t size, const char **linemap)
+{
+  const char *p = map;
+  const char *end = map + size;
+  const char *nl = NULL;
+  const char *cr = NULL;
+  unsigned int lineno = 0;
+
+  while (p < end)
+    {
+      const char *eol;
+
+      nl = find_next_char (p, end, '\n', nl);
+      cr = find_next_char (p, end, '\r', cr);
+      eol = nl < cr ? nl : cr;
+      if (eol == end)
+	break;
+      if (eol + 1 < end && eol[1] == (*eol == '\n' ? '\r' : '\n'))
+	eol++;
+
+      if (linemap != NULL)
+	linemap[lineno] = p;
+      lineno++;
+      p = eol + 1;
+    }
+
+  return lineno;
+}
 
-/* Precompute array of lines for a mapped file. */
+/* Precompute array of lines for a mapped file.  The lines are counted
+   first so that the array is allocated at its final size.  */
 
 static const char **
 index_file (const char *map, size_t size, unsigned int *maxline)
 {
-  const char *p, *lstart, *end;
-  int chars_per_line = 45; /* First iteration will use 40.  */
-  unsigned int lineno;
   const char **linemap = NULL;
-  unsigned long long line_map_size = 0;
+  unsigned int lineno;
+
+  lineno = scan_lines (map, size, NULL);
+  if (lineno != 0)
+    {
+      linemap = (const char **) xmalloc (lineno * sizeof (char *));
+      scan_lines (map, size, linemap);
+    }
+
+  *maxline = lineno;
+  return linemap;
+}
+
+/* The memory taken up by the contents and line map of P.  */
+
+static size_t
+print_file_size (const struct print_file_list *p)
+{
+  return p->mapsize + p->maxline * sizeof (char *);
+}
+
+/* Release the contents and line map of P, and take it off the LRU
+   list.  */
+
+static void
+print_file_release (struct print_file_list *p)
+{
+  if (p->map == NULL)
+    return;
+
+  print_files_loaded -= print_file_size (p);
+#ifdef HAVE_MMAP
+  if (p->mapped)
+    munmap ((void *) p->map, p->mapsize);
+  else
+#endif
+    free ((void *) p->map);
+  free (p->linemap);
+  p->map = NULL;
+  p->linemap = NULL;
+  p->maxline = 0;
+
+  if (p->lru_prev != NULL)
+    p->lru_prev->lru_next = p->lru_next;
+  else
+    print_files_lru_head = p->lru_next;
+  if (p->lru_next != NULL)
+    p->lru_next->lru_prev = p->lru_prev;
+  else
+    print_files_lru_tail = p->lru_prev;
+  p->lru_prev = p->lru_next = NULL;
+}
 
-  lineno = 0;
-  lstart = map;
-  end = map + size;
+/* Record the use of P, which is loaded, by moving it to the head of
+   the LRU list.  Then release the least recently used files until
+   the cache is back under its limit, keeping P itself.  */
 
-  for (p = map; p < end; p++)
+static void
+print_file_touch (struct print_file_list *p)
+{
+  if (print_files_lru_head != p)
     {
-      if (*p == '\n')
-	{
-	  if (p + 1 < end && p[1] == '\r')
-	    p++;
-	}
-      else if (*p == '\r')
+      if (p->lru_prev != NULL)
 	{
-	  if (p + 1 < end && p[1] == '\n')
-	    p++;
+	  p->lru_prev->lru_next = p->lru_next;
+	  if (p->lru_next != NULL)
+	    p->lru_next->lru_prev = p->lru_prev;
+	  else
+	    print_files_lru_tail = p->lru_prev;
 	}
+      p->lru_prev = NULL;
+      p->lru_next = print_files_lru_head;
+      if (print_files_lru_head != NULL)
+	print_files_lru_head->lru_prev = p;
       else
-	continue;
+	print_files_lru_tail = p;
+      print_files_lru_head = p;
+    }
 
-      /* End of line found.  */
+  while (print_files_loaded > SOURCE_CACHE_LIMIT
+	 && print_files_lru_tail != p)
+    print_file_release (print_files_lru_tail);
+}
 
-      if (linemap == NULL || line_map_size < lineno + 1)
-	{
-	  unsigned long long newsize;
-
-	  chars_per_line -= line_map_decrease;
-	  if (chars_per_line <= 1)
-	    chars_per_line = 1;
-	  line_map_size = size / chars_per_line + 1;
-	  if (line_map_size < lineno + 1)
-	    line_map_size = lineno + 1;
-	  newsize = line_map_size * sizeof (char *);
-	  linemap = (const char **) xrealloc (linemap, newsize);
-	}
+/* Read the contents of P from MODNAME and index its lines.  Returns
+   false on failure.  */
 
-      linemap[lineno++] = lstart;
-      lstart = p + 1;
-    }
+static bool
+print_file_load (struct print_file_list *p, struct stat *fst_return,
+		 bfd *abfd)
+{
+  p->map = slurp_file (p->modname, &p->mapsize, &p->mapped, fst_return,
+		       abfd);
+  if (p->map == NULL)
+    return false;
 
-  *maxline = lineno;
-  return linemap;
+  p->linemap = index_file (p->map, p->mapsize, &p->maxline);
+  print_files_loaded += print_file_size (p);
+  print_file_touch (p);
+  return true;
+}
+
+/* Hash table functions for print_files, which is searched by file
+   name.  */
+
+static hashval_t
+hash_print_file (const void *entry)
+{
+  const struct print_file_list *p = (const struct print_file_list *) entry;
+
+  return filename_hash (p->filename);
+}
+
+static int
+eq_print_file (const void *entry, const void *filename)
+{
+  const struct print_file_list *p = (const struct print_file_list *) entry;
+
+  return filename_cmp (p->filename, (const char *) filename) == 0;
+}
+
+static void
+del_print_file (void *entry)
+{
+  struct print_file_list *p = (struct print_file_list *) entry;
+
+  print_file_release (p);
+  free (p);
+}
+
+/* Forget how much of a file has been printed, for the next request of
+   a session.  Called through htab_traverse.  */
+
+static int
+reset_print_file (void **slot, void *arg ATTRIBUTE_UNUSED)
+{
+  struct print_file_list *p = (struct print_file_list *) *slot;
+
+  p->last_line = 0;
+  p->max_printed = 0;
+  p->first = 1;
+  return 1;
+}
+
+/* Free the print_files table.  */
+
+static void
+free_print_files (void)
+{
+  if (print_files != NULL)
+    {
+      htab_delete (print_files);
+      print_files = NULL;
+    }
+  print_files_bfd = NULL;
 }
 
-/* Tries to open MODNAME, and if successful adds a node to print_files
-   linked list and returns that node.  Also fills in the stat structure
-   pointed to by FST_RETURN.  Returns NULL on failure.  */
+/* Tries to open MODNAME, and if successful adds a node to the
+   print_files table and returns that node.  Also fills in the stat
+   structure pointed to by FST_RETURN.  Returns NULL on failure.  */
 
 static struct print_file_list *
 try_print_file_open (const char *   origname,
@@ -1999,30 +2479,36 @@ try_print_file_open (const char *   origname,
 		     bfd *          abfd)
 {
   struct print_file_list *p;
+  void **slot;
 
   p = (struct print_file_list *) xmalloc (sizeof (struct print_file_list));
 
-  p->map = slurp_file (modname, &p->mapsize, fst_return, abfd);
-  if (p->map == NULL)
+  p->lru_prev = NULL;
+  p->lru_next = NULL;
+  p->modname = modname;
+  if (!print_file_load (p, fst_return, abfd))
     {
       free (p);
       return NULL;
     }
 
-  p->linemap = index_file (p->map, p->mapsize, &p->maxline);
   p->last_line = 0;
   p->max_printed = 0;
   p->filename = origname;
-  p->modname = modname;
-  p->next = print_files;
   p->first = 1;
-  print_files = p;
+
+  if (print_files == NULL)
+    print_files = htab_create_alloc (16, hash_print_file, eq_print_file,
+				     del_print_file, xcalloc, free);
+  slot = htab_find_slot_with_hash (print_files, origname,
+				   filename_hash (origname), INSERT);
+  *slot = p;
   return p;
 }
 
 /* If the source file, as described in the symtab, is not found
    try to locate it in one of the paths specified with -I
-   If found, add location to print_files linked list.  */
+   If found, add location to the print_files table.  */
 
 static struct print_file_list *
 update_source_path (const char *filename, bfd *abfd)
@@ -2070,6 +2556,10 @@ update_source_path (const char *filename, bfd *abfd)
 
 /* Print a source file line.  */
 
+static int disasm_printf (const char *, ...) ATTRIBUTE_PRINTF_1;
+static void disasm_putchar (int);
+static void disasm_write (const char *, size_t);
+
 static void
 print_line (struct print_file_list *p, unsigned int linenum)
 {
@@ -2080,11 +2570,10 @@ print_line (struct print_file_list *p, unsigned int linenum)
     return;
   l = p->linemap [linenum];
   if (source_comment != NULL && strlen (l) > 0)
-    printf ("%s", source_comment);
+    disasm_printf ("%s", source_comment);
   len = strcspn (l, "\n\r");
-  /* Test fwrite return value to quiet glibc warning.  */
-  if (len == 0 || fwrite (l, len, 1, stdout) == 1)
-    putchar ('\n');
+  disasm_write (l, len);
+  disasm_putchar ('\n');
 }
 
 /* Print a range of source code lines. */
@@ -2225,9 +2714,9 @@ show_line (bfd *abfd, asection *section, bfd_vma addr_offset)
 
 	  /* Demangling adds trailing parens, so don't print those.  */
 	  if (demangle_alloc != NULL)
-	    printf ("%s:\n", sanitize_string (demangle_alloc));
+	    disasm_printf ("%s:\n", sanitize_string (demangle_alloc));
 	  else
-	    printf ("%s():\n", sanitize_string (functionname));
+	    disasm_printf ("%s():\n", sanitize_string (functionname));
 
 	  prev_line = -1;
 	  free (demangle_alloc);
@@ -2237,13 +2726,13 @@ show_line (bfd *abfd, asection *section, bfd_vma addr_offset)
 	      || discriminator != prev_discriminator))
 	{
 	  if (discriminator > 0)
-	    printf ("%s:%u (discriminator %u)\n",
-		    filename == NULL ? "???" : sanitize_string (filename),
-		    linenumber, discriminator);
+	    disasm_printf ("%s:%u (discriminator %u)\n",
+			   filename == NULL ? "???" : sanitize_string (filename),
+			   linenumber, discriminator);
 	  else
-	    printf ("%s:%u\n", filename == NULL
-		    ? "???" : sanitize_string (filename),
-		    linenumber);
+	    disasm_printf ("%s:%u\n", filename == NULL
+			   ? "???" : sanitize_string (filename),
+			   linenumber);
 	}
       if (unwind_inlines)
 	{
@@ -2254,9 +2743,9 @@ show_line (bfd *abfd, asection *section, bfd_vma addr_offset)
 	  while (bfd_find_inliner_info (abfd, &filename2, &functionname2,
 					&line2))
 	    {
-	      printf ("inlined by %s:%u",
-		      sanitize_string (filename2), line2);
-	      printf (" (%s)\n", sanitize_string (functionname2));
+	      disasm_printf ("inlined by %s:%u",
+			     sanitize_string (filename2), line2);
+	      disasm_printf (" (%s)\n", sanitize_string (functionname2));
 	    }
 	}
     }
@@ -2265,13 +2754,13 @@ show_line (bfd *abfd, asection *section, bfd_vma addr_offset)
       && filename != NULL
       && linenumber > 0)
     {
-      struct print_file_list **pp, *p;
+      struct print_file_list *p = NULL;
       unsigned l;
 
-      for (pp = &print_files; *pp != NULL; pp = &(*pp)->next)
-	if (filename_cmp ((*pp)->filename, filename) == 0)
-	  break;
-      p = *pp;
+      if (print_files != NULL)
+	p = (struct print_file_list *)
+	  htab_find_with_hash (print_files, filename,
+			       filename_hash (filename));
 
       if (p == NULL)
 	{
@@ -2279,6 +2768,15 @@ show_line (bfd *abfd, asection *section, bfd_vma addr_offset)
 	    filename = xstrdup (filename);
 	  p = update_source_path (filename, abfd);
 	}
+      else if (p->map == NULL)
+	{
+	  struct stat fst;
+
+	  /* Released to keep within SOURCE_CACHE_LIMIT; load it again.  */
+	  print_file_load (p, &fst, abfd);
+	}
+      else
+	print_file_touch (p);
 
       if (p != NULL && linenumber != p->last_line)
 	{
@@ -2325,14 +2823,6 @@ show_line (bfd *abfd, asection *section, bfd_vma addr_offset)
     free (path);
 }
 
-/* Pseudo FILE object for strings.  */
-typedef struct
-{
-  char *buffer;
-  size_t pos;
-  size_t alloc;
-} SFILE;
-
 /* sprintf to a "stream".  */
 
 static int ATTRIBUTE_PRINTF_2
@@ -2360,6 +2850,494 @@ objdump_sprintf (SFILE *f, const char *format, ...)
   return n;
 }
 
+/* Like objdump_sprintf, but for the styled interface.  The style is
+   dropped, as fprintf_styled does, for text outside instructions.  */
+
+static int ATTRIBUTE_PRINTF_3
+objdump_unstyled_sprintf (SFILE *f,
+			  enum disassembler_style style ATTRIBUTE_UNUSED,
+			  const char *format, ...)
+{
+  size_t n;
+  va_list args;
+
+  while (1)
+    {
+      size_t space = f->alloc - f->pos;
+
+      va_start (args, format);
+      n = vsnprintf (f->buffer + f->pos, space, format, args);
+      va_end (args);
+
+      if (space > n)
+	break;
+
+      f->alloc = (f->alloc + n) * 2;
+      f->buffer = (char *) xrealloc (f->buffer, f->alloc);
+    }
+  f->pos += n;
+
+  return n;
+}
+
+/* If non-NULL, where disassemble_bytes and the functions it calls
+   put what they would otherwise print to stdout.  Points at
+   DISASM_ARENA while disassemble_data runs, or at the buffer of a
+   piece of a section disassembled on a worker thread for --threads.  */
+static TLS SFILE *disasm_output;
+
+/* The buffer disassembly output collects in before being written to
+   stdout in large blocks, sparing a locked stdio call for each field
+   of each line.  It is reused from one file to the next.  */
+static SFILE disasm_arena;
+
+/* Write out DISASM_ARENA once it holds this many bytes.  */
+#define DISASM_FLUSH_SIZE (64 * 1024)
+
+/* Write what DISASM_ARENA holds to stdout, and empty it.  */
+
+static void
+flush_disasm_output (void)
+{
+  if (disasm_arena.pos != 0)
+    fwrite (disasm_arena.buffer, 1, disasm_arena.pos, stdout);
+  disasm_arena.pos = 0;
+}
+
+/* printf to stdout, or to DISASM_OUTPUT if that is set.  */
+
+static int ATTRIBUTE_PRINTF_1
+disasm_printf (const char *format, ...)
+{
+  size_t n;
+  va_list args;
+  SFILE *f = disasm_output;
+
+  if (f == NULL)
+    {
+      int res;
+
+      va_start (args, format);
+      res = vprintf (format, args);
+      va_end (args);
+      return res;
+    }
+
+  while (1)
+    {
+      size_t space = f->alloc - f->pos;
+
+      va_start (args, format);
+      n = vsnprintf (f->buffer + f->pos, space, format, args);
+      va_end (args);
+
+      if (space > n)
+	break;
+
+      f->alloc = (f->alloc + n) * 2;
+      f->buffer = (char *) xrealloc (f->buffer, f->alloc);
+    }
+  f->pos += n;
+
+  return n;
+}
+
+/* putchar to stdout, or to DISASM_OUTPUT if that is set.  */
+
+static void
+disasm_putchar (int c)
+{
+  SFILE *f = disasm_output;
+
+  if (f == NULL)
+    {
+      putchar (c);
+      return;
+    }
+
+  if (f->alloc - f->pos < 2)
+    {
+      f->alloc = (f->alloc + 2) * 2;
+      f->buffer = (char *) xrealloc (f->buffer, f->alloc);
+    }
+  f->buffer[f->pos++] = c;
+  f->buffer[f->pos] = '\0';
+}
+
+/* fwrite LEN bytes at S to stdout, or to DISASM_OUTPUT if that is set.  */
+
+static void
+disasm_write (const char *s, size_t len)
+{
+  SFILE *f = disasm_output;
+
+  if (f == NULL)
+    fwrite (s, 1, len, stdout);
+  else
+    sfile_write (f, s, len);
+}
+
+/* Print the LEN bytes at S as a JSON string, with quotes.  */
+
+static void
+json_print_chars (const char *s, size_t len)
+{
+  size_t i = 0;
+
+  disasm_putchar ('"');
+  while (i < len)
+    {
+      size_t run;
+      unsigned char c;
+
+      /* Copy characters that need no escape in one go.  */
+      for (run = i; run < len; run++)
+	{
+	  c = s[run];
+	  if (c == '"' || c == '\\' || c < 0x20)
+	    break;
+	}
+      disasm_write (s + i, run - i);
+      if (run == len)
+	break;
+
+      if (c == '"' || c == '\\')
+	{
+	  disasm_putchar ('\\');
+	  disasm_putchar (c);
+	}
+      else if (c == '\n')
+	disasm_printf ("\\n");
+      else if (c == '\t')
+	disasm_printf ("\\t");
+      else
+	disasm_printf ("\\u%04x", c);
+      i = run + 1;
+    }
+  disasm_putchar ('"');
+}
+
+/* Print S as a JSON string.  */
+
+static void
+json_print_string (const char *s)
+{
+  json_print_chars (s, strlen (s));
+}
+
+/* Print the key and value of a JSON member holding address VMA, as a
+   hex string since it may not fit in a double.  Leading zeroes are
+   omitted, as objdump_print_value does.  */
+
+static void
+json_print_vma (bfd *abfd, const char *key, bfd_vma vma)
+{
+  char buf[30];
+  char *p;
+
+  bfd_sprintf_vma (abfd, buf, vma);
+  for (p = buf; *p == '0'; ++p)
+    ;
+  if (*p == '\0')
+    --p;
+  disasm_printf (",\"%s\":\"0x%s\"", key, p);
+}
+
+/* For --json, what the styled printer has seen of the instruction
+   being disassembled.  Positions are offsets into the instruction's
+   text, or -1 if not seen.  */
+
+struct json_insn
+{
+  size_t mnemonic_start;
+  size_t mnemonic_end;
+  size_t operands_start;
+  size_t comment_start;
+  /* The first address passed to print_address_func.  */
+  bool have_target;
+  bfd_vma target;
+};
+
+static TLS struct json_insn *json_insn;
+
+/* Like objdump_unstyled_sprintf, but note where the mnemonic, the
+   operands and any comment start in the text, for --json.  */
+
+static int ATTRIBUTE_PRINTF_3
+objdump_json_sprintf (SFILE *f, enum disassembler_style style,
+		      const char *format, ...)
+{
+  size_t n;
+  size_t start = f->pos;
+  va_list args;
+  struct json_insn *ji = json_insn;
+
+  while (1)
+    {
+      size_t space = f->alloc - f->pos;
+
+      va_start (args, format);
+      n = vsnprintf (f->buffer + f->pos, space, format, args);
+      va_end (args);
+
+      if (space > n)
+	break;
+
+      f->alloc = (f->alloc + n) * 2;
+      f->buffer = (char *) xrealloc (f->buffer, f->alloc);
+    }
+  f->pos += n;
+
+  if (ji == NULL || ji->comment_start != (size_t) -1)
+    return n;
+
+  if (style == dis_style_comment_start)
+    ji->comment_start = start;
+  else if (ji->operands_start != (size_t) -1)
+    ;
+  else if (style == dis_style_mnemonic
+	   || style == dis_style_sub_mnemonic
+	   || style == dis_style_assembler_directive)
+    {
+      /* Prefixes are printed as mnemonics too, so keep going until
+	 something else follows.  */
+      if (ji->mnemonic_start == (size_t) -1)
+	ji->mnemonic_start = start;
+      ji->mnemonic_end = f->pos;
+    }
+  else if (ji->mnemonic_start != (size_t) -1)
+    {
+      size_t i;
+
+      for (i = start; i < f->pos; i++)
+	if (!ISSPACE (f->buffer[i]))
+	  {
+	    ji->operands_start = i;
+	    break;
+	  }
+    }
+
+  return n;
+}
+
+/* print_address_func for --json.  Note the first address an
+   instruction refers to, then print it as usual.  */
+
+static void
+objdump_json_print_address (bfd_vma vma, struct disassemble_info *inf)
+{
+  if (json_insn != NULL && !json_insn->have_target)
+    {
+      json_insn->have_target = true;
+      json_insn->target = vma;
+    }
+  objdump_print_address (vma, inf);
+}
+
+/* Strip spaces from both ends of the LEN bytes at *S.  */
+
+static size_t
+json_trim (const char **s, size_t len)
+{
+  while (len > 0 && ISSPACE (**s))
+    {
+      ++*s;
+      --len;
+    }
+  while (len > 0 && ISSPACE ((*s)[len - 1]))
+    --len;
+  return len;
+}
+
+/* Start the --json record for the OCTETS octets at ADDR_OFFSET in
+   INF's section, which DATA holds.  TEXT is what the disassembler
+   printed and JI what objdump_json_sprintf made of it, or both are
+   NULL if the octets are shown as data.  The record is left open, so
+   that relocs can be added to it.  *LAST_SYM and LAST_NAME hold the
+   symbol of the previous record and its printed name, which most
+   records share.  */
+
+static void
+print_json_insn (struct disassemble_info *inf, bfd_byte *data,
+		 bfd_vma addr_offset, size_t octets,
+		 SFILE *text, struct json_insn *ji,
+		 asymbol **last_sym, SFILE *last_name)
+{
+  struct objdump_disasm_info *aux;
+  asection *section = inf->section;
+  bfd_vma vma = section->vma + addr_offset;
+  unsigned int opb = inf->octets_per_byte;
+  asymbol *sym;
+  size_t j;
+
+  aux = (struct objdump_disasm_info *) inf->application_data;
+
+  disasm_printf ("{\"type\":\"%s\",\"section\":", text ? "insn" : "data");
+  json_print_string (bfd_section_name (section));
+  json_print_vma (aux->abfd, "address", vma);
+
+  aux->require_sec = true;
+  sym = find_symbol_for_address (vma, inf, NULL);
+  aux->require_sec = false;
+  if (sym != NULL)
+    {
+      if (sym != *last_sym)
+	{
+	  void *stream = inf->stream;
+	  fprintf_ftype fprintf_func = inf->fprintf_func;
+	  fprintf_styled_ftype fprintf_styled_func = inf->fprintf_styled_func;
+
+	  last_name->pos = 0;
+	  disassemble_set_printf
+	    (inf, last_name, (fprintf_ftype) objdump_sprintf,
+	     (fprintf_styled_ftype) objdump_unstyled_sprintf);
+	  objdump_print_symname (aux->abfd, inf, sym);
+	  disassemble_set_printf (inf, stream, fprintf_func,
+				  fprintf_styled_func);
+	  *last_sym = sym;
+	}
+
+      disasm_printf (",\"symbol\":");
+      json_print_chars (last_name->buffer, last_name->pos);
+      disasm_printf (",\"offset\":%" PRId64,
+		     (int64_t) (vma - bfd_asymbol_value (sym)));
+    }
+
+  disasm_printf (",\"bytes\":\"");
+  for (j = addr_offset * opb; j < addr_offset * opb + octets; j++)
+    {
+      static const char hex[] = "0123456789abcdef";
+      char pair[2];
+
+      pair[0] = hex[data[j] >> 4];
+      pair[1] = hex[data[j] & 0xf];
+      disasm_write (pair, 2);
+    }
+  disasm_putchar ('"');
+
+  if (text != NULL)
+    {
+      const char *p;
+      size_t len, end = text->pos;
+
+      if (ji->comment_start != (size_t) -1)
+	end = ji->comment_start;
+      if (ji->mnemonic_start != (size_t) -1)
+	{
+	  p = text->buffer + ji->mnemonic_start;
+	  len = json_trim (&p, ji->mnemonic_end - ji->mnemonic_start);
+	  disasm_printf (",\"mnemonic\":");
+	  json_print_chars (p, len);
+	  if (ji->operands_start != (size_t) -1 && ji->operands_start < end)
+	    {
+	      p = text->buffer + ji->operands_start;
+	      len = json_trim (&p, end - ji->operands_start);
+	      disasm_printf (",\"operands\":");
+	      json_print_chars (p, len);
+	    }
+	}
+      else
+	{
+	  /* The disassembler doesn't style its output, so take the
+	     first word as the mnemonic.  */
+	  p = text->buffer;
+	  len = json_trim (&p, end);
+	  for (j = 0; j < len && !ISSPACE (p[j]); j++)
+	    ;
+	  disasm_printf (",\"mnemonic\":");
+	  json_print_chars (p, j);
+	  p += j;
+	  len = json_trim (&p, len - j);
+	  if (len != 0)
+	    {
+	      disasm_printf (",\"operands\":");
+	      json_print_chars (p, len);
+	    }
+	}
+      if (ji->comment_start != (size_t) -1)
+	{
+	  p = text->buffer + ji->comment_start;
+	  len = json_trim (&p, text->pos - ji->comment_start);
+	  disasm_printf (",\"comment\":");
+	  json_print_chars (p, len);
+	}
+      if (ji->have_target)
+	json_print_vma (aux->abfd, "target", ji->target);
+    }
+
+  if (with_line_numbers)
+    {
+      const char *filename;
+      const char *functionname;
+      unsigned int linenumber;
+
+      if (bfd_find_nearest_line (aux->abfd, section, syms, addr_offset,
+				 &filename, &functionname, &linenumber)
+	  && filename != NULL)
+	{
+	  disasm_printf (",\"file\":");
+	  json_print_string (filename);
+	  if (linenumber != 0)
+	    disasm_printf (",\"line\":%u", linenumber);
+	}
+    }
+}
+
+/* Print reloc Q for --json.  If a record is open, add Q to its relocs,
+   counting them in *NRELOCS; otherwise print a record for Q alone.  */
+
+static void
+print_json_reloc (struct disassemble_info *inf, arelent *q,
+		  bfd_vma rel_offset, bool open, unsigned int *nrelocs)
+{
+  struct objdump_disasm_info *aux;
+  asection *section = inf->section;
+  char buf[30];
+  char *p;
+
+  aux = (struct objdump_disasm_info *) inf->application_data;
+
+  if (!open)
+    {
+      disasm_printf ("{\"type\":\"reloc\",\"section\":");
+      json_print_string (bfd_section_name (section));
+      disasm_printf (",\"relocs\":[{");
+    }
+  else if ((*nrelocs)++ == 0)
+    disasm_printf (",\"relocs\":[{");
+  else
+    disasm_printf (",{");
+
+  bfd_sprintf_vma (aux->abfd, buf, section->vma - rel_offset + q->address);
+  for (p = buf; *p == '0'; ++p)
+    ;
+  if (*p == '\0')
+    --p;
+  disasm_printf ("\"address\":\"0x%s\",\"type\":", p);
+  if (q->howto == NULL)
+    disasm_printf ("null");
+  else if (q->howto->name)
+    json_print_string (q->howto->name);
+  else
+    disasm_printf ("%d", q->howto->type);
+
+  disasm_printf (",\"symbol\":");
+  if (q->sym_ptr_ptr == NULL || *q->sym_ptr_ptr == NULL)
+    disasm_printf ("null");
+  else
+    {
+      const char *sym_name = bfd_asymbol_name (*q->sym_ptr_ptr);
+
+      if (sym_name == NULL || *sym_name == '\0')
+	sym_name = bfd_section_name (bfd_asymbol_section (*q->sym_ptr_ptr));
+      json_print_string (sym_name);
+    }
+  disasm_printf (",\"addend\":%" PRId64 "}", (int64_t) q->addend);
+
+  if (!open)
+    disasm_printf ("]}\n");
+}
+
 /* Return an integer greater than, or equal to zero, representing the color
    for STYLE, or -1 if no color should be used.  */
 
@@ -2528,91 +3506,75 @@ fprintf_styled (FILE *f, enum disassembler_style style ATTRIBUTE_UNUSED,
 
 struct jump_info
 {
-  /* The next jump, or NULL if this is the last object.  */
-  struct jump_info *next;
-  /* The previous jump, or NULL if this is the first object.  */
-  struct jump_info *prev;
   /* The start addresses of the jump.  */
   struct
     {
-      /* The list of start addresses.  */
+      /* The list of start addresses, in ascending order.  */
       bfd_vma *addresses;
       /* The number of elements.  */
       size_t count;
-      /* The maximum number of elements that fit into the array.  */
-      size_t max_count;
     } start;
   /* The end address of the jump.  */
   bfd_vma end;
+  /* The smallest and largest value of all start and end addresses.  */
+  bfd_vma min_address;
+  bfd_vma max_address;
   /* The drawing level of the jump.  */
   int level;
+  /* Where the jump comes when sorting, to keep the sorts stable.  */
+  size_t order;
 };
 
-/* Construct a jump object for a jump from start
-   to end with the corresponding level.  */
+/* The jumps detected inside a function.  */
 
-static struct jump_info *
-jump_info_new (bfd_vma start, bfd_vma end, int level)
+struct jump_table
 {
-  struct jump_info *result = xmalloc (sizeof (struct jump_info));
-
-  result->next = NULL;
-  result->prev = NULL;
-  result->start.addresses = xmalloc (sizeof (bfd_vma *) * 2);
-  result->start.addresses[0] = start;
-  result->start.count = 1;
-  result->start.max_count = 2;
-  result->end = end;
-  result->level = level;
-
-  return result;
-}
+  /* The jumps in the order they are drawn: by level, and within a
+     level from the smallest jump.  */
+  struct jump_info *jumps;
+  size_t count;
+  /* Storage for the start addresses of all the jumps.  */
+  bfd_vma *addresses;
+  /* The highest drawing level.  */
+  int max_level;
+  /* The jumps sorted by their smallest address, and the number of
+     those that jump_info_visualize_address has reached.  */
+  struct jump_info **by_min;
+  size_t reached;
+  /* The jumps reached and not yet finished with, in drawing order.  */
+  struct jump_info **active;
+  size_t active_count;
+};
 
-/* Free a jump object and return the next object
-   or NULL if this was the last one.  */
+/* Free a jump table.  */
 
-static struct jump_info *
-jump_info_free (struct jump_info *ji)
+static void
+jump_table_free (struct jump_table *jt)
 {
-  struct jump_info *result = NULL;
-
-  if (ji)
+  if (jt)
     {
-      result = ji->next;
-      if (ji->start.addresses)
-	free (ji->start.addresses);
-      free (ji);
+      free (jt->jumps);
+      free (jt->addresses);
+      free (jt->by_min);
+      free (jt->active);
+      free (jt);
     }
-
-  return result;
 }
 
 /* Get the smallest value of all start and end addresses.  */
 
-static bfd_vma
+static inline bfd_vma
 jump_info_min_address (const struct jump_info *ji)
 {
-  bfd_vma min_address = ji->end;
-  size_t i;
-
-  for (i = ji->start.count; i-- > 0;)
-    if (ji->start.addresses[i] < min_address)
-      min_address = ji->start.addresses[i];
-  return min_address;
+  return ji->min_address;
 }
 
 /* Get the largest value of all start and end addresses.  */
 
-static bfd_vma
+static inline bfd_vma
 jump_info_max_address (const struct jump_info *ji)
 {
-  bfd_vma max_address = ji->end;
-  size_t i;
-
-  for (i = ji->start.count; i-- > 0;)
-    if (ji->start.addresses[i] > max_address)
-      max_address = ji->start.addresses[i];
-  return max_address;
+  return ji->max_address;
 }
 
 /* Get the target address of a jump.  */
@@ -2628,17 +3590,22 @@ jump_info_end_address (const struct jump_info *ji)
 static bool
 jump_info_is_start_address (const struct jump_info *ji, bfd_vma address)
 {
-  bool result = false;
-  size_t i;
+  size_t lo = 0;
+  size_t hi = ji->start.count;
 
-  for (i = ji->start.count; i-- > 0;)
-    if (address == ji->start.addresses[i])
-      {
-	result = true;
-	break;
-      }
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
 
-  return result;
+      if (ji->start.addresses[mid] < address)
+	lo = mid + 1;
+      else if (ji->start.addresses[mid] > address)
+	hi = mid;
+      else
+	return true;
+    }
+
+  return false;
 }
 
 /* Test if an address is the target address of a jump.  */
@@ -2657,156 +3624,211 @@ jump_info_size (const struct jump_info *ji)
   return jump_info_max_address (ji) - jump_info_min_address (ji);
 }
 
-/* Unlink a jump object from a list.  */
+/* Test if two jumps intersect.  */
 
-static void
-jump_info_unlink (struct jump_info *node,
-		  struct jump_info **base)
+static bool
+jump_info_intersect (const struct jump_info *a,
+		     const struct jump_info *b)
 {
-  if (node->next)
-    node->next->prev = node->prev;
-  if (node->prev)
-    node->prev->next = node->next;
-  else
-    *base = node->next;
-  node->next = NULL;
-  node->prev = NULL;
+  return ((jump_info_max_address (a) >= jump_info_min_address (b))
+	  && (jump_info_min_address (a) <= jump_info_max_address (b)));
 }
 
-/* Insert unlinked jump info node into a list.  */
+/* A jump found by disassemble_jumps, before jumps to the same target
+   are merged.  */
 
-static void
-jump_info_insert (struct jump_info *node,
-		  struct jump_info *target,
-		  struct jump_info **base)
-{
-  node->next = target;
-  node->prev = target->prev;
-  target->prev = node;
-  if (node->prev)
-    node->prev->next = node;
-  else
-    *base = node;
-}
+struct jump_source
+{
+  bfd_vma start;
+  bfd_vma end;
+  size_t index;
+};
 
-/* Add unlinked node to the front of a list.  */
+/* Sort jump sources by target, then by address.  */
 
-static void
-jump_info_add_front (struct jump_info *node,
-		     struct jump_info **base)
+static int
+compare_jump_sources (const void *ap, const void *bp)
 {
-  node->next = *base;
-  if (node->next)
-    node->next->prev = node;
-  node->prev = NULL;
-  *base = node;
+  const struct jump_source *a = (const struct jump_source *) ap;
+  const struct jump_source *b = (const struct jump_source *) bp;
+
+  if (a->end != b->end)
+    return a->end < b->end ? -1 : 1;
+  if (a->start != b->start)
+    return a->start < b->start ? -1 : 1;
+  return a->index < b->index ? -1 : a->index > b->index;
 }
 
-/* Move linked node to target position.  */
+/* Sort jumps by their size and starting point.  Jumps that tie keep
+   the order of the last jump to their target, latest first.  */
 
-static void
-jump_info_move_linked (struct jump_info *node,
-		       struct jump_info *target,
-		       struct jump_info **base)
+static int
+compare_jump_sizes (const void *ap, const void *bp)
 {
-  /* Unlink node.  */
-  jump_info_unlink (node, base);
-  /* Insert node at target position.  */
-  jump_info_insert (node, target, base);
+  const struct jump_info *a = (const struct jump_info *) ap;
+  const struct jump_info *b = (const struct jump_info *) bp;
+  bfd_vma a_size = jump_info_size (a);
+  bfd_vma b_size = jump_info_size (b);
+
+  if (a_size != b_size)
+    return a_size < b_size ? -1 : 1;
+  if (jump_info_min_address (a) != jump_info_min_address (b))
+    return jump_info_min_address (a) < jump_info_min_address (b) ? -1 : 1;
+  return a->order > b->order ? -1 : a->order < b->order;
 }
 
-/* Test if two jumps intersect.  */
+/* Sort jumps into drawing order, by level and then as they were.  */
 
-static bool
-jump_info_intersect (const struct jump_info *a,
-		     const struct jump_info *b)
+static int
+compare_jump_levels (const void *ap, const void *bp)
 {
-  return ((jump_info_max_address (a) >= jump_info_min_address (b))
-	  && (jump_info_min_address (a) <= jump_info_max_address (b)));
+  const struct jump_info *a = (const struct jump_info *) ap;
+  const struct jump_info *b = (const struct jump_info *) bp;
+
+  if (a->level != b->level)
+    return a->level - b->level;
+  return a->order < b->order ? -1 : a->order > b->order;
 }
 
-/* Merge two compatible jump info objects.  */
+/* Sort pointers to jumps by their smallest address.  */
 
-static void
-jump_info_merge (struct jump_info **base)
+static int
+compare_jump_min_addresses (const void *ap, const void *bp)
 {
-  struct jump_info *a;
+  const struct jump_info *a = *(const struct jump_info **) ap;
+  const struct jump_info *b = *(const struct jump_info **) bp;
 
-  for (a = *base; a; a = a->next)
-    {
-      struct jump_info *b;
+  if (jump_info_min_address (a) != jump_info_min_address (b))
+    return jump_info_min_address (a) < jump_info_min_address (b) ? -1 : 1;
+  return a < b ? -1 : a > b;
+}
 
-      for (b = a->next; b; b = b->next)
-	{
-	  /* Merge both jumps into one.  */
-	  if (a->end == b->end)
-	    {
-	      /* Reallocate addresses.  */
-	      size_t needed_size = a->start.count + b->start.count;
-	      size_t i;
+/* Splay tree comparison function for the jumps on one level, which
+   never intersect.  A jump that intersects one in the tree compares
+   equal to it.  */
 
-	      if (needed_size > a->start.max_count)
-		{
-		  a->start.max_count += b->start.max_count;
-		  a->start.addresses =
-		    xrealloc (a->start.addresses,
-			      a->start.max_count * sizeof (bfd_vma *));
-		}
-
-	      /* Append start addresses.  */
-	      for (i = 0; i < b->start.count; ++i)
-		a->start.addresses[a->start.count++] =
-		  b->start.addresses[i];
+static int
+splay_tree_compare_jumps (splay_tree_key xa, splay_tree_key xb)
+{
+  const struct jump_info *a = (const struct jump_info *) xa;
+  const struct jump_info *b = (const struct jump_info *) xb;
 
-	      /* Remove and delete jump.  */
-	      struct jump_info *tmp = b->prev;
-	      jump_info_unlink (b, base);
-	      jump_info_free (b);
-	      b = tmp;
-	    }
-	}
-    }
+  if (jump_info_intersect (a, b))
+    return 0;
+  else if (jump_info_max_address (a) < jump_info_min_address (b))
+    return -1;
+  else
+    return 1;
 }
 
-/* Sort jumps by their size and starting point using a stable
-   minsort. This could be improved if sorting performance is
-   an issue, for example by using mergesort.  */
+/* Build the jump table for the COUNT jumps in SOURCES, which are in
+   address order.  Jumps to the same target are merged into one.  The
+   merged jumps are sorted by size and each in turn put on the lowest
+   level where it intersects no jump already there, so that large
+   jumps are on higher levels and do not cross small jumps.  Return
+   NULL if there are no jumps.  */
 
-static void
-jump_info_sort (struct jump_info **base)
+static struct jump_table *
+jump_table_build (struct jump_source *sources, size_t count)
 {
-  struct jump_info *current_element = *base;
+  struct jump_table *jt;
+  splay_tree *levels = NULL;
+  size_t nlevels = 0;
+  size_t alloc_levels = 0;
+  size_t i, n;
+
+  if (count == 0)
+    return NULL;
+
+  qsort (sources, count, sizeof (*sources), compare_jump_sources);
+
+  jt = (struct jump_table *) xmalloc (sizeof (*jt));
+  jt->addresses = (bfd_vma *) xmalloc (count * sizeof (bfd_vma));
+  jt->jumps = (struct jump_info *) xmalloc (count * sizeof (*jt->jumps));
 
-  while (current_element)
+  /* Merge jumps to the same target.  */
+  n = 0;
+  for (i = 0; i < count; i++)
     {
-      struct jump_info *best_match = current_element;
-      struct jump_info *runner = current_element->next;
-      bfd_vma best_size = jump_info_size (best_match);
+      struct jump_info *ji;
 
-      while (runner)
+      if (i == 0 || sources[i].end != sources[i - 1].end)
 	{
-	  bfd_vma runner_size = jump_info_size (runner);
+	  ji = &jt->jumps[n++];
+	  ji->start.addresses = &jt->addresses[i];
+	  ji->start.count = 0;
+	  ji->end = sources[i].end;
+	  ji->min_address = ji->end;
+	  ji->max_address = ji->end;
+	  ji->level = -1;
+	  ji->order = 0;
+	}
+      else
+	ji = &jt->jumps[n - 1];
+
+      jt->addresses[i] = sources[i].start;
+      ji->start.count++;
+      if (sources[i].start < ji->min_address)
+	ji->min_address = sources[i].start;
+      if (sources[i].start > ji->max_address)
+	ji->max_address = sources[i].start;
+      if (sources[i].index > ji->order)
+	ji->order = sources[i].index;
+    }
+  jt->count = n;
 
-	  if ((runner_size < best_size)
-	      || ((runner_size == best_size)
-		  && (jump_info_min_address (runner)
-		      < jump_info_min_address (best_match))))
+  qsort (jt->jumps, n, sizeof (*jt->jumps), compare_jump_sizes);
+
+  /* Group jumps by level.  */
+  jt->max_level = -1;
+  for (i = 0; i < n; i++)
+    {
+      struct jump_info *ji = &jt->jumps[i];
+      size_t level;
+
+      ji->order = i;
+      for (level = 0; level < nlevels; level++)
+	if (splay_tree_lookup (levels[level], (splay_tree_key) ji) == NULL)
+	  break;
+
+      if (level == nlevels)
+	{
+	  if (nlevels == alloc_levels)
 	    {
-	      best_match = runner;
-	      best_size = runner_size;
+	      alloc_levels = alloc_levels ? alloc_levels * 2 : 16;
+	      levels = (splay_tree *) xrealloc (levels, (alloc_levels
+							 * sizeof (*levels)));
 	    }
-
-	  runner = runner->next;
+	  levels[nlevels++] = splay_tree_new (splay_tree_compare_jumps,
+					      NULL, NULL);
 	}
 
-      if (best_match == current_element)
-	current_element = current_element->next;
-      else
-	jump_info_move_linked (best_match, current_element, base);
+      splay_tree_insert (levels[level], (splay_tree_key) ji,
+			 (splay_tree_value) ji);
+      ji->level = level;
+      if (ji->level > jt->max_level)
+	jt->max_level = ji->level;
     }
+
+  for (i = 0; i < nlevels; i++)
+    splay_tree_delete (levels[i]);
+  free (levels);
+
+  qsort (jt->jumps, n, sizeof (*jt->jumps), compare_jump_levels);
+
+  jt->by_min = (struct jump_info **) xmalloc (n * sizeof (*jt->by_min));
+  for (i = 0; i < n; i++)
+    jt->by_min[i] = &jt->jumps[i];
+  qsort (jt->by_min, n, sizeof (*jt->by_min), compare_jump_min_addresses);
+  jt->reached = 0;
+  jt->active = (struct jump_info **) xmalloc (n * sizeof (*jt->active));
+  jt->active_count = 0;
+
+  return jt;
 }
 
-/* Visualize all jumps at a given address.  */
+/* Visualize all jumps at a given address.  Addresses must be given in
+   ascending order.  */
 
 static void
 jump_info_visualize_address (bfd_vma address,
@@ -2814,120 +3836,131 @@ jump_info_visualize_address (bfd_vma address,
 			     char *line_buffer,
 			     uint8_t *color_buffer)
 {
-  struct jump_info *ji = detected_jumps;
+  struct jump_table *jt = detected_jumps;
   size_t len = (max_level + 1) * 3;
+  size_t k, n;
 
   /* Clear line buffer.  */
   memset (line_buffer, ' ', len);
   memset (color_buffer, 0, len);
 
+  if (jt == NULL)
+    return;
+
+  /* Add the jumps that start at or before this address to those
+     that are active, keeping them in drawing order.  */
+  while (jt->reached < jt->count
+	 && jump_info_min_address (jt->by_min[jt->reached]) <= address)
+    {
+      struct jump_info *ji = jt->by_min[jt->reached++];
+
+      for (k = jt->active_count++; k > 0 && jt->active[k - 1] > ji; k--)
+	jt->active[k] = jt->active[k - 1];
+      jt->active[k] = ji;
+    }
+
   /* Iterate over jumps and add their ASCII art.  */
-  while (ji)
+  for (k = n = 0; k < jt->active_count; k++)
     {
+      struct jump_info *ji = jt->active[k];
+
       /* Discard jumps that are never needed again.  */
       if (jump_info_max_address (ji) < address)
-	{
-	  struct jump_info *tmp = ji;
+	continue;
+      jt->active[n++] = ji;
 
-	  ji = ji->next;
-	  jump_info_unlink (tmp, &detected_jumps);
-	  jump_info_free (tmp);
-	  continue;
-	}
+      /* Hash target address to get an even
+	 distribution between all values.  */
+      bfd_vma hash_address = jump_info_end_address (ji);
+      uint8_t color = iterative_hash_object (hash_address, 0);
+      /* Fetch line offset.  */
+      int offset = (max_level - ji->level) * 3;
 
-      /* This jump intersects with the current address.  */
-      if (jump_info_min_address (ji) <= address)
+      /* Draw start line.  */
+      if (jump_info_is_start_address (ji, address))
 	{
-	  /* Hash target address to get an even
-	     distribution between all values.  */
-	  bfd_vma hash_address = jump_info_end_address (ji);
-	  uint8_t color = iterative_hash_object (hash_address, 0);
-	  /* Fetch line offset.  */
-	  int offset = (max_level - ji->level) * 3;
-
-	  /* Draw start line.  */
-	  if (jump_info_is_start_address (ji, address))
-	    {
-	      size_t i = offset + 1;
+	  size_t i = offset + 1;
 
-	      for (; i < len - 1; ++i)
-		if (line_buffer[i] == ' ')
-		  {
-		    line_buffer[i] = '-';
-		    color_buffer[i] = color;
-		  }
-
-	      if (line_buffer[i] == ' ')
-		{
-		  line_buffer[i] = '-';
-		  color_buffer[i] = color;
-		}
-	      else if (line_buffer[i] == '>')
-		{
-		  line_buffer[i] = 'X';
-		  color_buffer[i] = color;
-		}
+	  for (; i < len - 1; ++i)
+	    if (line_buffer[i] == ' ')
+	      {
+		line_buffer[i] = '-';
+		color_buffer[i] = color;
+	      }
 
-	      if (line_buffer[offset] == ' ')
-		{
-		  if (address <= ji->end)
-		    line_buffer[offset] =
-		      (jump_info_min_address (ji) == address) ? '/': '+';
-		  else
-		    line_buffer[offset] =
-		      (jump_info_max_address (ji) == address) ? '\\': '+';
-		  color_buffer[offset] = color;
-		}
+	  if (line_buffer[i] == ' ')
+	    {
+	      line_buffer[i] = '-';
+	      color_buffer[i] = color;
 	    }
-	  /* Draw jump target.  */
-	  else if (jump_info_is_end_address (ji, address))
+	  else if (line_buffer[i] == '>')
 	    {
-	      size_t i = offset + 1;
+	      line_buffer[i] = 'X';
+	      color_buffer[i] = color;
+	    }
 
-	      for (; i < len - 1; ++i)
-		if (line_buffer[i] == ' ')
-		  {
-		    line_buffer[i] = '-';
-		    color_buffer[i] = color;
-		  }
+	  if (line_buffer[offset] == ' ')
+	    {
+	      if (address <= ji->end)
+		line_buffer[offset] =
+		  (jump_info_min_address (ji) == address) ? '/': '+';
+	      else
+		line_buffer[offset] =
+		  (jump_info_max_address (ji) == address) ? '\\': '+';
+	      color_buffer[offset] = color;
+	    }
+	}
+      /* Draw jump target.  */
+      else if (jump_info_is_end_address (ji, address))
+	{
+	  size_t i = offset + 1;
 
-	      if (line_buffer[i] == ' ')
-		{
-		  line_buffer[i] = '>';
-		  color_buffer[i] = color;
-		}
-	      else if (line_buffer[i] == '-')
-		{
-		  line_buffer[i] = 'X';
-		  color_buffer[i] = color;
-		}
+	  for (; i < len - 1; ++i)
+	    if (line_buffer[i] == ' ')
+	      {
+		line_buffer[i] = '-';
+		color_buffer[i] = color;
+	      }
 
-	      if (line_buffer[offset] == ' ')
-		{
-		  if (jump_info_min_address (ji) < address)
-		    line_buffer[offset] =
-		      (jump_info_max_address (ji) > address) ? '>' : '\\';
-		  else
-		    line_buffer[offset] = '/';
-		  color_buffer[offset] = color;
-		}
+	  if (line_buffer[i] == ' ')
+	    {
+	      line_buffer[i] = '>';
+	      color_buffer[i] = color;
 	    }
-	  /* Draw intermediate line segment.  */
-	  else if (line_buffer[offset] == ' ')
+	  else if (line_buffer[i] == '-')
 	    {
-	      line_buffer[offset] = '|';
+	      line_buffer[i] = 'X';
+	      color_buffer[i] = color;
+	    }
+
+	  if (line_buffer[offset] == ' ')
+	    {
+	      if (jump_info_min_address (ji) < address)
+		line_buffer[offset] =
+		  (jump_info_max_address (ji) > address) ? '>' : '\\';
+	      else
+		line_buffer[offset] = '/';
 	      color_buffer[offset] = color;
 	    }
 	}
-
-      ji = ji->next;
+      /* Draw intermediate line segment.  */
+      else if (line_buffer[offset] == ' ')
+	{
+	  line_buffer[offset] = '|';
+	  color_buffer[offset] = color;
+	}
     }
+  jt->active_count = n;
 }
 
-/* Clone of disassemble_bytes to detect jumps inside a function.  */
-/* FIXME: is this correct? Can we strip it down even further?  */
+/* The number of instructions disassemble_jumps decodes at a time.  */
+
+#define JUMP_DECODE_BATCH 256
 
-static struct jump_info *
+/* Find the jumps inside a function.  The instructions are only decoded,
+   with disassemble_decode, not printed.  */
+
+static struct jump_table *
 disassemble_jumps (struct disassemble_info * inf,
 		   disassembler_ftype        disassemble_fn,
 		   bfd_vma                   start_offset,
@@ -2937,41 +3970,49 @@ disassemble_jumps (struct disassemble_info * inf,
 		   arelent **                relppend)
 {
   struct objdump_disasm_info *aux;
-  struct jump_info *jumps = NULL;
+  struct jump_source *jumps = NULL;
+  size_t count = 0;
+  size_t alloc = 0;
+  struct jump_table *jt;
   asection *section;
   bfd_vma addr_offset;
   unsigned int opb = inf->octets_per_byte;
   int octets = opb;
-  SFILE sfile;
+  struct disassemble_insn *insns;
+  flagword flags;
 
   aux = (struct objdump_disasm_info *) inf->application_data;
   section = inf->section;
 
-  sfile.alloc = 120;
-  sfile.buffer = (char *) xmalloc (sfile.alloc);
-  sfile.pos = 0;
+  insns = (struct disassemble_insn *)
+    xmalloc (JUMP_DECODE_BATCH * sizeof (*insns));
 
-  inf->insn_info_valid = 0;
-  disassemble_set_printf (inf, &sfile, (fprintf_ftype) objdump_sprintf,
-			  (fprintf_styled_ftype) objdump_styled_sprintf);
+  inf->bytes_per_line = 0;
+  inf->bytes_per_chunk = 0;
+  flags = ((disassemble_all ? DISASSEMBLE_DATA : 0)
+	   | (wide_output ? WIDE_OUTPUT : 0));
+  if (machine)
+    flags |= USER_SPECIFIED_MACHINE_TYPE;
+
+  if (! disassemble_all
+      && (section->flags & (SEC_CODE | SEC_HAS_CONTENTS))
+      == (SEC_CODE | SEC_HAS_CONTENTS))
+    /* Set a stop_vma so that the disassembler will not read
+       beyond the next symbol.  We assume that symbols appear on
+       the boundaries between instructions.  We only do this when
+       disassembling code of course, and when -D is in effect.  */
+    inf->stop_vma = section->vma + stop_offset;
+
+  inf->stop_offset = stop_offset;
+  disassembler_in_comment = false;
 
   addr_offset = start_offset;
   while (addr_offset < stop_offset)
     {
-      int previous_octets;
-
-      /* Remember the length of the previous instruction.  */
-      previous_octets = octets;
-      octets = 0;
-
-      sfile.pos = 0;
-      inf->bytes_per_line = 0;
-      inf->bytes_per_chunk = 0;
-      inf->flags = ((disassemble_all ? DISASSEMBLE_DATA : 0)
-		    | (wide_output ? WIDE_OUTPUT : 0));
-      if (machine)
-	inf->flags |= USER_SPECIFIED_MACHINE_TYPE;
+      size_t batch = JUMP_DECODE_BATCH;
+      size_t n, i;
 
+      inf->flags = flags;
       if (inf->disassembler_needs_relocs
 	  && (bfd_get_file_flags (aux->abfd) & EXEC_P) == 0
 	  && (bfd_get_file_flags (aux->abfd) & DYNAMIC) == 0
@@ -2996,118 +4037,58 @@ disassemble_jumps (struct disassemble_info * inf,
 		 of an instruction at a given address without trying
 		 to display its disassembly. */
 	      || (distance_to_rel > 0
-		&& distance_to_rel < (bfd_signed_vma) (previous_octets/ opb)))
+		&& distance_to_rel < (bfd_signed_vma) (octets / opb)))
 	    {
 	      inf->flags |= INSN_HAS_RELOC;
 	    }
-	}
 
-      if (! disassemble_all
-	  && (section->flags & (SEC_CODE | SEC_HAS_CONTENTS))
-	  == (SEC_CODE | SEC_HAS_CONTENTS))
-	/* Set a stop_vma so that the disassembler will not read
-	   beyond the next symbol.  We assume that symbols appear on
-	   the boundaries between instructions.  We only do this when
-	   disassembling code of course, and when -D is in effect.  */
-	inf->stop_vma = section->vma + stop_offset;
-
-      inf->stop_offset = stop_offset;
-
-      /* Extract jump information.  */
-      inf->insn_info_valid = 0;
-      disassembler_in_comment = false;
-      octets = (*disassemble_fn) (section->vma + addr_offset, inf);
-      /* Test if a jump was detected.  */
-      if (inf->insn_info_valid
-	  && ((inf->insn_type == dis_branch)
-	      || (inf->insn_type == dis_condbranch)
-	      || (inf->insn_type == dis_jsr)
-	      || (inf->insn_type == dis_condjsr))
-	  && (inf->target >= section->vma + start_offset)
-	  && (inf->target < section->vma + stop_offset))
-	{
-	  struct jump_info *ji =
-	    jump_info_new (section->vma + addr_offset, inf->target, -1);
-	  jump_info_add_front (ji, &jumps);
+	  /* The flags may differ from one instruction to the next.  */
+	  batch = 1;
 	}
 
-      inf->stop_vma = 0;
-
-      addr_offset += octets / opb;
-    }
-
-  disassemble_set_printf (inf, (void *) stdout, (fprintf_ftype) fprintf,
-			  (fprintf_styled_ftype) fprintf_styled);
-  free (sfile.buffer);
-
-  /* Merge jumps.  */
-  jump_info_merge (&jumps);
-  /* Process jumps.  */
-  jump_info_sort (&jumps);
-
-  /* Group jumps by level.  */
-  struct jump_info *last_jump = jumps;
-  int max_level = -1;
-
-  while (last_jump)
-    {
-      /* The last jump is part of the next group.  */
-      struct jump_info *base = last_jump;
-      /* Increment level.  */
-      base->level = ++max_level;
-
-      /* Find jumps that can be combined on the same
-	 level, with the largest jumps tested first.
-	 This has the advantage that large jumps are on
-	 lower levels and do not intersect with small
-	 jumps that get grouped on higher levels.  */
-      struct jump_info *exchange_item = last_jump->next;
-      struct jump_info *it = exchange_item;
+      n = disassemble_decode (disassemble_fn, inf,
+			      section->vma + addr_offset,
+			      section->vma + stop_offset, insns, batch);
+      if (n == 0)
+	break;
 
-      for (; it; it = it->next)
+      for (i = 0; i < n; i++)
 	{
-	  /* Test if the jump intersects with any
-	     jump from current group.  */
-	  bool ok = true;
-	  struct jump_info *it_collision;
-
-	  for (it_collision = base;
-	       it_collision != exchange_item;
-	       it_collision = it_collision->next)
+	  struct disassemble_insn *insn = &insns[i];
+
+	  /* Test if a jump was detected.  */
+	  if (insn->insn_info_valid
+	      && ((insn->insn_type == dis_branch)
+		  || (insn->insn_type == dis_condbranch)
+		  || (insn->insn_type == dis_jsr)
+		  || (insn->insn_type == dis_condjsr))
+	      && (insn->target >= section->vma + start_offset)
+	      && (insn->target < section->vma + stop_offset))
 	    {
-	      /* This jump intersects so we leave it out.  */
-	      if (jump_info_intersect (it_collision, it))
+	      if (count == alloc)
 		{
-		  ok = false;
-		  break;
+		  alloc = alloc ? alloc * 2 : 64;
+		  jumps = (struct jump_source *)
+		    xrealloc (jumps, alloc * sizeof (*jumps));
 		}
+	      jumps[count].start = insn->vma;
+	      jumps[count].end = insn->target;
+	      jumps[count].index = count;
+	      count++;
 	    }
 
-	  /* Add jump to group.  */
-	  if (ok)
-	    {
-	      /* Move current element to the front.  */
-	      if (it != exchange_item)
-		{
-		  struct jump_info *save = it->prev;
-		  jump_info_move_linked (it, exchange_item, &jumps);
-		  last_jump = it;
-		  it = save;
-		}
-	      else
-		{
-		  last_jump = exchange_item;
-		  exchange_item = exchange_item->next;
-		}
-	      last_jump->level = max_level;
-	    }
+	  octets = insn->octets;
+	  addr_offset += octets / opb;
 	}
-
-      /* Move to next group.  */
-      last_jump = exchange_item;
     }
 
-  return jumps;
+  inf->stop_vma = 0;
+  free (insns);
+
+  jt = jump_table_build (jumps, count);
+  free (jumps);
+
+  return jt;
 }
 
 /* The number of zeroes we want to see before we start skipping them.
@@ -3168,18 +4149,44 @@ print_jump_visualisation (bfd_vma addr, int max_level, char *line_buffer,
 		if (extended_color_output)
 		  /* Use extended 8bit color, but
 		     do not choose dark colors.  */
-		  printf ("\033[38;5;%dm", 124 + (color % 108));
+		  disasm_printf ("\033[38;5;%dm", 124 + (color % 108));
 		else
 		  /* Use simple terminal colors.  */
-		  printf ("\033[%dm", 31 + (color % 7));
+		  disasm_printf ("\033[%dm", 31 + (color % 7));
 	      else
 		/* Clear color.  */
-		printf ("\033[0m");
+		disasm_printf ("\033[0m");
 	      last_color = color;
 	    }
 	}
-      putchar ((i < line_buffer_size) ? line_buffer[i]: ' ');
+      disasm_putchar ((i < line_buffer_size) ? line_buffer[i]: ' ');
+    }
+}
+
+/* Print the BPC octets at DATA in hex as one chunk, the last octet
+   first if LITTLE.  */
+
+static void
+print_hex_chunk (const bfd_byte *data, unsigned int bpc, bool little)
+{
+  static const char digits[] = "0123456789abcdef";
+  char hex[64];
+  size_t n = 0;
+  unsigned int k;
+
+  for (k = 0; k < bpc; k++)
+    {
+      unsigned int c = data[little ? bpc - 1 - k : k];
+
+      if (n == sizeof hex)
+	{
+	  disasm_write (hex, n);
+	  n = 0;
+	}
+      hex[n++] = digits[c >> 4];
+      hex[n++] = digits[c & 0xf];
     }
+  disasm_write (hex, n);
 }
 
 /* Disassemble some data in memory between given values.  */
@@ -3205,6 +4212,13 @@ disassemble_bytes (struct disassemble_info *inf,
   unsigned int skip_zeroes_at_end = inf->skip_zeroes_at_end;
   size_t octets;
   SFILE sfile;
+  void *stream = inf->stream;
+  fprintf_ftype fprintf_func = inf->fprintf_func;
+  fprintf_styled_ftype fprintf_styled_func = inf->fprintf_styled_func;
+  fprintf_styled_ftype insn_styled_func;
+  struct json_insn ji;
+  asymbol *json_sym = NULL;
+  SFILE json_sym_name;
 
   aux = (struct objdump_disasm_info *) inf->application_data;
   section = inf->section;
@@ -3213,6 +4227,18 @@ disassemble_bytes (struct disassemble_info *inf,
   sfile.buffer = (char *) xmalloc (sfile.alloc);
   sfile.pos = 0;
 
+  /* For --json, the styled printer picks the instruction apart rather
+     than coloring it.  */
+  if (json_output)
+    insn_styled_func = (fprintf_styled_ftype) objdump_json_sprintf;
+  else
+    insn_styled_func = (fprintf_styled_ftype) objdump_styled_sprintf;
+  json_sym_name.alloc = 64;
+  json_sym_name.buffer = NULL;
+  json_sym_name.pos = 0;
+  if (json_output)
+    json_sym_name.buffer = (char *) xmalloc (json_sym_name.alloc);
+
   if (insn_width)
     octets_per_line = insn_width;
   else if (insns)
@@ -3250,16 +4276,9 @@ disassemble_bytes (struct disassemble_info *inf,
   int max_level = -1;
 
   /* Some jumps were detected.  */
-  if (detected_jumps)
+  if (detected_jumps && !json_output)
     {
-      struct jump_info *ji;
-
-      /* Find maximum jump level.  */
-      for (ji = detected_jumps; ji; ji = ji->next)
-	{
-	  if (ji->level > max_level)
-	    max_level = ji->level;
-	}
+      max_level = detected_jumps->max_level;
 
       /* Allocate buffers.  */
       size_t len = (max_level + 1) * 3 + 1;
@@ -3273,9 +4292,15 @@ disassemble_bytes (struct disassemble_info *inf,
   while (addr_offset < stop_offset)
     {
       bool need_nl = false;
+      bool json_open = false;
+      unsigned int json_nrelocs = 0;
 
       octets = 0;
 
+      if (disasm_output == &disasm_arena
+	  && disasm_arena.pos >= DISASM_FLUSH_SIZE)
+	flush_disasm_output ();
+
       /* Make sure we don't use relocs from previous instructions.  */
       aux->reloc = NULL;
 
@@ -3302,15 +4327,23 @@ disassemble_bytes (struct disassemble_info *inf,
 	  /* If we are going to display more data, and we are displaying
 	     file offsets, then tell the user how many zeroes we skip
 	     and the file offset from where we resume dumping.  */
-	  if (display_file_offsets
-	      && addr_offset + octets / opb < stop_offset)
-	    printf (_("\t... (skipping %lu zeroes, "
-		      "resuming at file offset: 0x%lx)\n"),
-		    (unsigned long long) (octets / opb),
-		    (unsigned long long) (section->filepos
-				     + addr_offset + octets / opb));
+	  if (json_output)
+	    {
+	      disasm_printf ("{\"type\":\"skip\",\"section\":");
+	      json_print_string (bfd_section_name (section));
+	      json_print_vma (aux->abfd, "address", section->vma + addr_offset);
+	      disasm_printf (",\"size\":%" PRIu64 "}\n",
+			     (uint64_t) (octets / opb));
+	    }
+	  else if (display_file_offsets
+		   && addr_offset + octets / opb < stop_offset)
+	    disasm_printf (_("\t... (skipping %lu zeroes, "
+			     "resuming at file offset: 0x%lx)\n"),
+			   (unsigned long long) (octets / opb),
+			   (unsigned long long) (section->filepos
+					    + addr_offset + octets / opb));
 	  else
-	    printf ("\t...\n");
+	    disasm_printf ("\t...\n");
 	}
       else
 	{
@@ -3318,11 +4351,14 @@ disassemble_bytes (struct disassemble_info *inf,
 	  unsigned int bpc = 0;
 	  unsigned int pb = 0;
 
-	  if (with_line_numbers || with_source_code)
+	  if ((with_line_numbers || with_source_code) && !json_output)
 	    show_line (aux->abfd, section, addr_offset);
 
-	  if (no_addresses)
-	    printf ("\t");
+	  if (json_output)
+	    /* The address is part of the record.  */
+	    ;
+	  else if (no_addresses)
+	    disasm_printf ("\t");
 	  else if (!prefix_addresses)
 	    {
 	      char *s;
@@ -3332,14 +4368,16 @@ disassemble_bytes (struct disassemble_info *inf,
 		*s = ' ';
 	      if (*s == '\0')
 		*--s = '0';
-	      printf ("%s:\t", buf + skip_addr_chars);
+	      disasm_write (buf + skip_addr_chars,
+			    strlen (buf + skip_addr_chars));
+	      disasm_write (":\t", 2);
 	    }
 	  else
 	    {
 	      aux->require_sec = true;
 	      objdump_print_address (section->vma + addr_offset, inf);
 	      aux->require_sec = false;
-	      putchar (' ');
+	      disasm_putchar (' ');
 	    }
 
 	  print_jump_visualisation (section->vma + addr_offset,
@@ -3352,8 +4390,7 @@ disassemble_bytes (struct disassemble_info *inf,
 
 	      sfile.pos = 0;
 	      disassemble_set_printf
-		(inf, &sfile, (fprintf_ftype) objdump_sprintf,
-		 (fprintf_styled_ftype) objdump_styled_sprintf);
+		(inf, &sfile, (fprintf_ftype) objdump_sprintf, insn_styled_func);
 	      inf->bytes_per_line = 0;
 	      inf->bytes_per_chunk = 0;
 	      inf->flags = ((disassemble_all ? DISASSEMBLE_DATA : 0)
@@ -3402,8 +4439,7 @@ disassemble_bytes (struct disassemble_info *inf,
 						      + addr_offset, inf);
 			  disassemble_set_printf
 			    (inf, inf->stream,
-			     (fprintf_ftype) objdump_sprintf,
-			     (fprintf_styled_ftype) objdump_styled_sprintf);
+			     (fprintf_ftype) objdump_sprintf, insn_styled_func);
 			}
 		    }
 
@@ -3429,18 +4465,28 @@ disassemble_bytes (struct disassemble_info *inf,
 
 	      inf->stop_offset = stop_offset;
 	      disassembler_in_comment = false;
+	      if (json_output)
+		{
+		  ji.mnemonic_start = (size_t) -1;
+		  ji.mnemonic_end = (size_t) -1;
+		  ji.operands_start = (size_t) -1;
+		  ji.comment_start = (size_t) -1;
+		  ji.have_target = false;
+		  json_insn = &ji;
+		}
 	      insn_size = (*disassemble_fn) (section->vma + addr_offset, inf);
+	      json_insn = NULL;
 	      octets = insn_size;
 
 	      inf->stop_vma = 0;
-	      disassemble_set_printf (inf, stdout, (fprintf_ftype) fprintf,
-				      (fprintf_styled_ftype) fprintf_styled);
+	      disassemble_set_printf (inf, stream, fprintf_func,
+				      fprintf_styled_func);
 	      if (insn_width == 0 && inf->bytes_per_line != 0)
 		octets_per_line = inf->bytes_per_line;
 	      if (insn_size < (int) opb)
 		{
-		  if (sfile.pos)
-		    printf ("%s\n", sfile.buffer);
+		  if (sfile.pos && !json_output)
+		    disasm_printf ("%s\n", sfile.buffer);
 		  if (insn_size >= 0)
 		    {
 		      non_fatal (_("disassemble_fn returned length %d"),
@@ -3468,9 +4514,21 @@ disassemble_bytes (struct disassemble_info *inf,
 	      buf[j - addr_offset * opb] = '\0';
 	    }
 
-	  if (prefix_addresses
-	      ? show_raw_insn > 0
-	      : show_raw_insn >= 0)
+	  if (json_output)
+	    {
+	      size_t len = octets;
+
+	      /* PR 21580: Check for a buffer ending early.  */
+	      if (addr_offset * opb + len > stop_offset * opb)
+		len = stop_offset * opb - addr_offset * opb;
+	      print_json_insn (inf, data, addr_offset, len,
+			       insns ? &sfile : NULL, insns ? &ji : NULL,
+			       &json_sym, &json_sym_name);
+	      json_open = true;
+	    }
+	  else if (prefix_addresses
+		   ? show_raw_insn > 0
+		   : show_raw_insn >= 0)
 	    {
 	      bfd_vma j;
 
@@ -3490,20 +4548,10 @@ disassemble_bytes (struct disassemble_info *inf,
 		  /* PR 21580: Check for a buffer ending early.  */
 		  if (j + bpc <= stop_offset * opb)
 		    {
-		      unsigned int k;
-
-		      if (inf->display_endian == BFD_ENDIAN_LITTLE)
-			{
-			  for (k = bpc; k-- != 0; )
-			    printf ("%02x", (unsigned) data[j + k]);
-			}
-		      else
-			{
-			  for (k = 0; k < bpc; k++)
-			    printf ("%02x", (unsigned) data[j + k]);
-			}
+		      print_hex_chunk (data + j, bpc,
+				       inf->display_endian == BFD_ENDIAN_LITTLE);
 		    }
-		  putchar (' ');
+		  disasm_putchar (' ');
 		}
 
 	      for (; pb < octets_per_line; pb += bpc)
@@ -3511,36 +4559,39 @@ disassemble_bytes (struct disassemble_info *inf,
 		  unsigned int k;
 
 		  for (k = 0; k < bpc; k++)
-		    printf ("  ");
-		  putchar (' ');
+		    disasm_write ("  ", 2);
+		  disasm_putchar (' ');
 		}
 
 	      /* Separate raw data from instruction by extra space.  */
 	      if (insns)
-		putchar ('\t');
+		disasm_putchar ('\t');
 	      else
-		printf ("    ");
+		disasm_write ("    ", 4);
 	    }
 
-	  if (! insns)
-	    printf ("%s", buf);
-	  else if (sfile.pos)
-	    printf ("%s", sfile.buffer);
+	  if (json_output)
+	    ;
+	  else if (! insns)
+	    disasm_write (buf, strlen (buf));
+	  else
+	    disasm_write (sfile.buffer, sfile.pos);
 
-	  if (prefix_addresses
-	      ? show_raw_insn > 0
-	      : show_raw_insn >= 0)
+	  if (!json_output
+	      && (prefix_addresses
+		  ? show_raw_insn > 0
+		  : show_raw_insn >= 0))
 	    {
 	      while (pb < octets)
 		{
 		  bfd_vma j;
 		  char *s;
 
-		  putchar ('\n');
+		  disasm_putchar ('\n');
 		  j = addr_offset * opb + pb;
 
 		  if (no_addresses)
-		    printf ("\t");
+		    disasm_printf ("\t");
 		  else
 		    {
 		      bfd_sprintf_vma (aux->abfd, buf, section->vma + j / opb);
@@ -3548,7 +4599,9 @@ disassemble_bytes (struct disassemble_info *inf,
 			*s = ' ';
 		      if (*s == '\0')
 			*--s = '0';
-		      printf ("%s:\t", buf + skip_addr_chars);
+		      disasm_write (buf + skip_addr_chars,
+				    strlen (buf + skip_addr_chars));
+		      disasm_write (":\t", 2);
 		    }
 
 		  print_jump_visualisation (section->vma + j / opb,
@@ -3563,26 +4616,19 @@ disassemble_bytes (struct disassemble_info *inf,
 		      /* PR 21619: Check for a buffer ending early.  */
 		      if (j + bpc <= stop_offset * opb)
 			{
-			  unsigned int k;
-
-			  if (inf->display_endian == BFD_ENDIAN_LITTLE)
-			    {
-			      for (k = bpc; k-- != 0; )
-				printf ("%02x", (unsigned) data[j + k]);
-			    }
-			  else
-			    {
-			      for (k = 0; k < bpc; k++)
-				printf ("%02x", (unsigned) data[j + k]);
-			    }
+			  print_hex_chunk (data + j, bpc,
+					   (inf->display_endian
+					    == BFD_ENDIAN_LITTLE));
 			}
-		      putchar (' ');
+		      disasm_putchar (' ');
 		    }
 		}
 	    }
 
-	  if (!wide_output)
-	    putchar ('\n');
+	  if (json_output)
+	    ;
+	  else if (!wide_output)
+	    disasm_putchar ('\n');
 	  else
 	    need_nl = true;
 	}
@@ -3590,33 +4636,36 @@ disassemble_bytes (struct disassemble_info *inf,
       while ((*relppp) < relppend
 	     && (**relppp)->address < rel_offset + addr_offset + octets / opb)
 	{
-	  if (dump_reloc_info || dump_dynamic_reloc_info)
+	  if (json_output && (dump_reloc_info || dump_dynamic_reloc_info))
+	    print_json_reloc (inf, **relppp, rel_offset, json_open,
+			      &json_nrelocs);
+	  else if (dump_reloc_info || dump_dynamic_reloc_info)
 	    {
 	      arelent *q;
 
 	      q = **relppp;
 
 	      if (wide_output)
-		putchar ('\t');
+		disasm_putchar ('\t');
 	      else
-		printf ("\t\t\t");
+		disasm_printf ("\t\t\t");
 
 	      if (!no_addresses)
 		{
 		  objdump_print_value (section->vma - rel_offset + q->address,
 				       inf, true);
-		  printf (": ");
+		  disasm_printf (": ");
 		}
 
 	      if (q->howto == NULL)
-		printf ("*unknown*\t");
+		disasm_printf ("*unknown*\t");
 	      else if (q->howto->name)
-		printf ("%s\t", q->howto->name);
+		disasm_printf ("%s\t", q->howto->name);
 	      else
-		printf ("%d\t", q->howto->type);
+		disasm_printf ("%d\t", q->howto->type);
 
 	      if (q->sym_ptr_ptr == NULL || *q->sym_ptr_ptr == NULL)
-		printf ("*unknown*");
+		disasm_printf ("*unknown*");
 	      else
 		{
 		  const char *sym_name;
@@ -3632,7 +4681,7 @@ disassemble_bytes (struct disassemble_info *inf,
 		      sym_name = bfd_section_name (sym_sec);
 		      if (sym_name == NULL || *sym_name == '\0')
 			sym_name = "*unknown*";
-		      printf ("%s", sanitize_string (sym_name));
+		      disasm_printf ("%s", sanitize_string (sym_name));
 		    }
 		}
 
@@ -3641,31 +4690,163 @@ disassemble_bytes (struct disassemble_info *inf,
 		  bfd_vma addend = q->addend;
 		  if ((bfd_signed_vma) addend < 0)
 		    {
-		      printf ("-0x");
+		      disasm_printf ("-0x");
 		      addend = -addend;
 		    }
 		  else
-		    printf ("+0x");
+		    disasm_printf ("+0x");
 		  objdump_print_value (addend, inf, true);
 		}
 
-	      printf ("\n");
+	      disasm_printf ("\n");
 	      need_nl = false;
 	    }
 	  ++(*relppp);
 	}
 
+      if (json_open)
+	disasm_printf ("%s}\n", json_nrelocs != 0 ? "]" : "");
       if (need_nl)
-	printf ("\n");
+	disasm_printf ("\n");
 
       addr_offset += octets / opb;
     }
 
   free (sfile.buffer);
+  free (json_sym_name.buffer);
   free (line_buffer);
   free (color_buffer);
 }
 
+/* A piece of a section, from one symbol to the next, that is
+   disassembled on a worker thread for --threads.  */
+
+struct disasm_piece
+{
+  bfd_vma start_offset;
+  bfd_vma stop_offset;
+  bool insns;
+  /* The first reloc that may apply to the piece.  */
+  arelent **relpp;
+  /* What disassemble_section would have set in the disassemble_info.  */
+  asymbol **symbols;
+  int num_symbols;
+  int symtab_pos;
+  /* The symbol header and the disassembly, to be written in order.  */
+  SFILE out;
+};
+
+/* The pieces of a section waiting to be disassembled.  */
+
+struct disasm_batch
+{
+  struct disassemble_info *inf;
+  bfd_byte *data;
+  bfd_vma rel_offset;
+  arelent **relppend;
+  struct disasm_piece *pieces;
+  size_t count;
+  size_t alloc;
+  /* The number of octets the pieces cover.  */
+  bfd_size_type octets;
+};
+
+/* Flush a batch once it covers this many octets per thread, so that
+   the buffered output stays bounded.  */
+#define DISASM_BATCH_OCTETS (256 * 1024)
+
+/* Disassemble the pieces of BATCH from START up to END, each into its
+   own buffer.  Worker for _bfd_parallel_for.  The disassemble_info and
+   objdump_disasm_info are copied, since disassemble_bytes changes
+   them as it goes.  */
+
+static bool
+disassemble_pieces (void *data, size_t start, size_t end)
+{
+  struct disasm_batch *batch = (struct disasm_batch *) data;
+  SFILE *output = disasm_output;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    {
+      struct disasm_piece *piece = &batch->pieces[i];
+      struct disassemble_info di = *batch->inf;
+      struct objdump_disasm_info aux
+	= *(struct objdump_disasm_info *) di.application_data;
+
+      di.application_data = &aux;
+      di.symbols = piece->symbols;
+      di.num_symbols = piece->num_symbols;
+      di.symtab_pos = piece->symtab_pos;
+      disassemble_set_printf (&di, &piece->out,
+			      (fprintf_ftype) objdump_sprintf,
+			      (fprintf_styled_ftype) objdump_unstyled_sprintf);
+
+      disasm_output = &piece->out;
+      disassemble_bytes (&di, aux.disassemble_fn, piece->insns, batch->data,
+			 piece->start_offset, piece->stop_offset,
+			 batch->rel_offset, &piece->relpp, batch->relppend);
+    }
+  disasm_output = output;
+  return true;
+}
+
+/* Disassemble the pieces in BATCH on several threads, then write
+   their output to stdout in address order.  */
+
+static void
+flush_disasm_batch (struct disasm_batch *batch)
+{
+  size_t i;
+
+  if (batch->count == 0)
+    return;
+
+  _bfd_parallel_for (batch->count, 1, disassemble_pieces, batch);
+
+  flush_disasm_output ();
+  for (i = 0; i < batch->count; i++)
+    {
+      struct disasm_piece *piece = &batch->pieces[i];
+
+      fwrite (piece->out.buffer, 1, piece->out.pos, stdout);
+      free (piece->out.buffer);
+    }
+  batch->count = 0;
+  batch->octets = 0;
+}
+
+/* Read the OCTETS octets at OFFSET in SECTION into a buffer from
+   malloc, returned in *DATA.  When that is less than the whole
+   section only the range asked for is read, and of a compressed
+   section only as much as the frame index allows is decompressed.  */
+
+static bool
+get_section_window (bfd *abfd, asection *section, bfd_size_type offset,
+		    bfd_size_type octets, bfd_byte **data)
+{
+  if (offset == 0 && octets == bfd_section_size (section))
+    return bfd_malloc_and_get_section (abfd, section, data);
+
+  *data = (bfd_byte *) bfd_malloc (octets);
+  if (*data == NULL)
+    return false;
+  if (!bfd_get_decompressed_section_contents (abfd, section, *data,
+					      offset, octets))
+    {
+      free (*data);
+      *data = NULL;
+      return false;
+    }
+  return true;
+}
+
+/* How many octets either side of the range being disassembled to read
+   as well, for disassemblers that look at neighbouring instructions
+   or read past the end of the last one.  */
+
+#define DISASM_WINDOW_SLACK 256
+
 static void
 disassemble_section (bfd *abfd, asection *section, void *inf)
 {
@@ -3675,9 +4856,11 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
   struct objdump_disasm_info *paux;
   unsigned int opb = pinfo->octets_per_byte;
   bfd_byte *data = NULL;
+  bfd_byte *window = NULL;
   bfd_size_type datasize = 0;
+  bfd_size_type window_start;
+  bfd_size_type window_end;
   arelent **rel_pp = NULL;
-  arelent **rel_ppstart = NULL;
   arelent **rel_ppend;
   bfd_vma stop_offset;
   asymbol *sym = NULL;
@@ -3686,6 +4869,11 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
   bfd_vma rel_offset;
   unsigned long long addr_offset;
   bool do_print;
+  bool threaded;
+  struct disasm_batch batch;
+  void *stream = pinfo->stream;
+  fprintf_ftype fprintf_func = pinfo->fprintf_func;
+  fprintf_styled_ftype fprintf_styled_func = pinfo->fprintf_styled_func;
   enum loop_control
   {
    stop_offset_reached,
@@ -3760,40 +4948,74 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
 
 	  if (relsize > 0)
 	    {
-	      rel_pp = (arelent **) xmalloc (relsize);
-	      rel_count = bfd_canonicalize_reloc (abfd, section, rel_pp, syms);
+	      /* The relocs sorted by address, kept by the library.  */
+	      rel_count = bfd_canonicalize_reloc_sorted (abfd, section, syms,
+							 &rel_pp);
 	      if (rel_count < 0)
 		{
 		  my_bfd_nonfatal (bfd_get_filename (abfd));
-		  free (rel_pp);
 		  rel_pp = NULL;
 		  rel_count = 0;
 		}
-	      else if (rel_count > 1)
-		/* Sort the relocs by address.  */
-		qsort (rel_pp, rel_count, sizeof (arelent *), compare_relocs);
-	      rel_ppstart = rel_pp;
 	    }
 	}
     }
   rel_ppend = PTR_ADD (rel_pp, rel_count);
+  batch.rel_offset = rel_offset;
+  batch.relppend = rel_ppend;
+
+  /* Unless disassembling from a symbol, whose extent is not known
+     yet, only read the part of the section that will be disassembled.
+     DATA is indexed by the octet offset in the section all the same.  */
+  window_start = 0;
+  window_end = datasize;
+  if (paux->symbol == NULL)
+    {
+      if (addr_offset * opb > DISASM_WINDOW_SLACK)
+	{
+	  window_start = addr_offset * opb - DISASM_WINDOW_SLACK;
+	  window_start -= window_start % opb;
+	}
+      if (datasize - stop_offset * opb > DISASM_WINDOW_SLACK)
+	window_end = stop_offset * opb + DISASM_WINDOW_SLACK;
+    }
 
-  if (!bfd_malloc_and_get_section (abfd, section, &data))
+  if (!get_section_window (abfd, section, window_start,
+			   window_end - window_start, &window))
     {
       non_fatal (_("Reading section %s failed because: %s"),
 		 section->name, bfd_errmsg (bfd_get_error ()));
       return;
     }
+  data = window - window_start;
 
-  pinfo->buffer = data;
-  pinfo->buffer_vma = section->vma;
-  pinfo->buffer_length = datasize;
+  pinfo->buffer = window;
+  pinfo->buffer_vma = section->vma + window_start / opb;
+  pinfo->buffer_length = window_end - window_start;
   pinfo->section = section;
 
+  /* With --threads, cut the section into pieces at symbols and
+     disassemble those on several threads.  Source lines, jump
+     visualisation and disassemblers that keep state of their own
+     between instructions depend on the order the pieces are done in,
+     so they keep to one thread.  */
+  threaded = (bfd_get_thread_count () > 1
+	      && !with_line_numbers
+	      && !with_source_code
+	      && !visualize_jumps
+	      && pinfo->private_data == NULL);
+  batch.inf = pinfo;
+  batch.data = data;
+  batch.pieces = NULL;
+  batch.count = 0;
+  batch.alloc = 0;
+  batch.octets = 0;
+
   /* Sort the symbols into value and section order.  */
   compare_section = section;
   if (sorted_symcount > 1)
     qsort (sorted_syms, sorted_symcount, sizeof (asymbol *), compare_symbols);
+  build_sym_ranges (pinfo);
 
   /* Skip over the relocs belonging to addresses below the
      start address.  */
@@ -3801,7 +5023,16 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
 	 && (*rel_pp)->address < rel_offset + addr_offset)
     ++rel_pp;
 
-  printf (_("\nDisassembly of section %s:\n"), sanitize_string (section->name));
+  if (json_output)
+    {
+      disasm_printf ("{\"type\":\"section\",\"name\":");
+      json_print_string (section->name);
+      json_print_vma (abfd, "address", section->vma);
+      disasm_printf (",\"size\":%" PRIu64 "}\n", (uint64_t) datasize);
+    }
+  else
+    disasm_printf (_("\nDisassembly of section %s:\n"),
+		   sanitize_string (section->name));
 
   /* Find the nearest symbol forwards from our current position.  */
   paux->require_sec = true;
@@ -3831,6 +5062,7 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
       asymbol *nextsym;
       bfd_vma nextstop_offset;
       bool insns;
+      struct disasm_piece *piece = NULL;
 
       addr = section->vma + addr_offset;
       addr = ((addr & ((sign_adjust << 1) - 1)) ^ sign_adjust) - sign_adjust;
@@ -3939,7 +5171,27 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
 	    }
 	}
 
-      if (! prefix_addresses && do_print)
+      if (threaded && do_print)
+	{
+	  /* Start a piece, and collect its symbol header in the
+	     piece's buffer along with the disassembly.  */
+	  if (batch.count == batch.alloc)
+	    {
+	      batch.alloc = batch.alloc ? batch.alloc * 2 : 64;
+	      batch.pieces = (struct disasm_piece *)
+		xrealloc (batch.pieces, batch.alloc * sizeof (*batch.pieces));
+	    }
+	  piece = &batch.pieces[batch.count++];
+	  piece->out.alloc = 120;
+	  piece->out.buffer = (char *) xmalloc (piece->out.alloc);
+	  piece->out.buffer[0] = '\0';
+	  piece->out.pos = 0;
+	  disassemble_set_printf
+	    (pinfo, &piece->out, (fprintf_ftype) objdump_sprintf,
+	     (fprintf_styled_ftype) objdump_unstyled_sprintf);
+	}
+
+      if (! prefix_addresses && ! json_output && do_print)
 	{
 	  pinfo->fprintf_func (pinfo->stream, "\n");
 	  objdump_print_addr_with_sym (abfd, section, sym, addr,
@@ -3965,6 +5217,10 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
 	    }	   
 	}
 
+      if (piece != NULL)
+	disassemble_set_printf (pinfo, stream, fprintf_func,
+				fprintf_styled_func);
+
       if (sym != NULL && bfd_asymbol_value (sym) > addr)
 	nextsym = sym;
       else if (sym == NULL)
@@ -4018,7 +5274,28 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
       else
 	insns = false;
 
-      if (do_print)
+      if (piece != NULL)
+	{
+	  piece->start_offset = addr_offset;
+	  piece->stop_offset = nextstop_offset;
+	  piece->insns = insns;
+	  piece->relpp = rel_pp;
+	  piece->symbols = pinfo->symbols;
+	  piece->num_symbols = pinfo->num_symbols;
+	  piece->symtab_pos = pinfo->symtab_pos;
+
+	  /* Step over the relocs that the piece will print, as
+	     disassemble_bytes would have done.  */
+	  while (rel_pp < rel_ppend
+		 && (*rel_pp)->address < rel_offset + nextstop_offset)
+	    ++rel_pp;
+
+	  batch.octets += (nextstop_offset - addr_offset) * opb;
+	  if (batch.octets >= ((bfd_size_type) DISASM_BATCH_OCTETS
+			       * bfd_get_thread_count ()))
+	    flush_disasm_batch (&batch);
+	}
+      else if (do_print)
 	{
 	  /* Resolve symbol name.  */
 	  if (visualize_jumps && abfd && sym && sym->name)
@@ -4051,20 +5328,19 @@ disassemble_section (bfd *abfd, asection *section, void *inf)
 			     rel_offset, &rel_pp, rel_ppend);
 
 	  /* Free jumps.  */
-	  while (detected_jumps)
-	    {
-	      detected_jumps = jump_info_free (detected_jumps);
-	    }
+	  jump_table_free (detected_jumps);
+	  detected_jumps = NULL;
 	}
 
       addr_offset = nextstop_offset;
       sym = nextsym;
     }
 
-  free (data);
+  flush_disasm_batch (&batch);
+  free (batch.pieces);
+  free (window);
+  sym_range_section = NULL;
 
-  if (rel_ppstart != NULL)
-    free (rel_ppstart);
 }
 
 /* Disassemble the contents of an object file.  */
@@ -4074,34 +5350,59 @@ disassemble_data (bfd *abfd)
 {
   struct disassemble_info disasm_info;
   struct objdump_disasm_info aux;
+  bfd_trace_span span;
   long long i;
 
-  print_files = NULL;
+  if (print_files != NULL && print_files_bfd == abfd)
+    htab_traverse (print_files, reset_print_file, NULL);
+  else
+    free_print_files ();
+  print_files_bfd = abfd;
   prev_functionname = NULL;
   prev_line = -1;
   prev_discriminator = 0;
 
-  /* We make a copy of syms to sort.  We don't want to sort syms
-     because that will screw up the relocs.  */
-  sorted_symcount = symcount ? symcount : dynsymcount;
-  sorted_syms = (asymbol **) xmalloc ((sorted_symcount + synthcount)
-				      * sizeof (asymbol *));
-  if (sorted_symcount != 0)
+  if (json_output)
     {
-      memcpy (sorted_syms, symcount ? syms : dynsyms,
-	      sorted_symcount * sizeof (asymbol *));
-
-      sorted_symcount = remove_useless_symbols (sorted_syms, sorted_symcount);
+      disasm_printf ("{\"type\":\"file\",\"name\":");
+      json_print_string (bfd_get_filename (abfd));
+      if (abfd->my_archive != NULL)
+	{
+	  disasm_printf (",\"archive\":");
+	  json_print_string (bfd_get_filename (abfd->my_archive));
+	}
+      disasm_printf (",\"format\":");
+      json_print_string (abfd->xvec->name);
+      disasm_printf ("}\n");
     }
 
-  for (i = 0; i < synthcount; ++i)
-    {
-      sorted_syms[sorted_symcount] = synthsyms + i;
-      ++sorted_symcount;
+  /* We make a copy of syms to sort.  We don't want to sort syms
+     because that will screw up the relocs.  A session keeps the copy
+     from one request to the next.  */
+  if (sorted_syms == NULL)
+    {
+      sorted_symcount = symcount ? symcount : dynsymcount;
+      sorted_syms = (asymbol **) xmalloc ((sorted_symcount + synthcount)
+					  * sizeof (asymbol *));
+      if (sorted_symcount != 0)
+	{
+	  memcpy (sorted_syms, symcount ? syms : dynsyms,
+		  sorted_symcount * sizeof (asymbol *));
+
+	  sorted_symcount = remove_useless_symbols (sorted_syms,
+						    sorted_symcount);
+	}
+
+      for (i = 0; i < synthcount; ++i)
+	{
+	  sorted_syms[sorted_symcount] = synthsyms + i;
+	  ++sorted_symcount;
+	}
     }
 
-  init_disassemble_info (&disasm_info, stdout, (fprintf_ftype) fprintf,
-			 (fprintf_styled_ftype) fprintf_styled);
+  init_disassemble_info (&disasm_info, &disasm_arena,
+			 (fprintf_ftype) objdump_sprintf,
+			 (fprintf_styled_ftype) objdump_unstyled_sprintf);
   disasm_info.application_data = (void *) &aux;
   aux.abfd = abfd;
   aux.require_sec = false;
@@ -4111,6 +5412,8 @@ disassemble_data (bfd *abfd)
   aux.symbol = disasm_sym;
 
   disasm_info.print_address_func = objdump_print_address;
+  if (json_output)
+    disasm_info.print_address_func = objdump_json_print_address;
   disasm_info.symbol_at_address_func = objdump_symbol_at_address;
 
   if (machine != NULL)
@@ -4145,6 +5448,11 @@ disassemble_data (bfd *abfd)
       non_fatal (_("can't disassemble for architecture %s\n"),
 		 bfd_printable_arch_mach (bfd_get_arch (abfd), 0));
       exit_status = 1;
+      if (!session_mode)
+	{
+	  free (sorted_syms);
+	  sorted_syms = NULL;
+	}
       return;
     }
 
@@ -4176,30 +5484,43 @@ disassemble_data (bfd *abfd)
 
   if (relsize > 0)
     {
-      disasm_info.dynrelbuf = (arelent **) xmalloc (relsize);
       disasm_info.dynrelcount
-	= bfd_canonicalize_dynamic_reloc (abfd, disasm_info.dynrelbuf, dynsyms);
+	= bfd_canonicalize_reloc_sorted (abfd, NULL, dynsyms,
+					 &disasm_info.dynrelbuf);
       if (disasm_info.dynrelcount < 0)
 	{
 	  my_bfd_nonfatal (bfd_get_filename (abfd));
-	  free (disasm_info.dynrelbuf);
 	  disasm_info.dynrelbuf = NULL;
 	  disasm_info.dynrelcount = 0;
 	}
-      else if (disasm_info.dynrelcount > 1)
-	/* Sort the relocs by address.  */
-	qsort (disasm_info.dynrelbuf, disasm_info.dynrelcount,
-	       sizeof (arelent *), compare_relocs);
     }
 
   disasm_info.symtab = sorted_syms;
   disasm_info.symtab_size = sorted_symcount;
 
+  if (disasm_arena.buffer == NULL)
+    {
+      disasm_arena.alloc = 2 * DISASM_FLUSH_SIZE;
+      disasm_arena.buffer = (char *) xmalloc (disasm_arena.alloc);
+    }
+  disasm_arena.pos = 0;
+  disasm_output = &disasm_arena;
+
+  bfd_trace_begin (&span, "disassemble_data", abfd);
   bfd_map_over_sections (abfd, disassemble_section, & disasm_info);
 
-  free (disasm_info.dynrelbuf);
+  flush_disasm_output ();
+  bfd_trace_end (&span);
+  disasm_output = NULL;
+
   disasm_info.dynrelbuf = NULL;
-  free (sorted_syms);
+  if (!session_mode)
+    {
+      free (sorted_syms);
+      sorted_syms = NULL;
+    }
+  free (sym_ranges);
+  sym_ranges = NULL;
   disassemble_free_target (&disasm_info);
 }
 
@@ -4435,6 +5756,8 @@ dump_dwarf_section (bfd *abfd, asection *section,
 static void
 dump_dwarf (bfd *abfd, bool is_mainfile)
 {
+  bfd_trace_span span;
+
   /* The byte_get pointer should have been set at the start of dump_bfd().  */
   if (byte_get == NULL)
     {
@@ -4459,7 +5782,9 @@ dump_dwarf (bfd *abfd, bool is_mainfile)
   init_dwarf_regnames_by_bfd_arch_and_mach (bfd_get_arch (abfd),
 					    bfd_get_mach (abfd));
 
+  bfd_trace_begin (&span, "dump_dwarf", abfd);
   bfd_map_over_sections (abfd, dump_dwarf_section, (void *) &is_mainfile);
+  bfd_trace_end (&span);
 }
 
 /* Read ABFD's section SECT_NAME into *CONTENTS, and return a pointer to
@@ -4947,18 +6272,160 @@ dump_target_specific (bfd *abfd)
       if (opt->name == NULL)
 	non_fatal (_("target specific dump '%s' not supported"), b);
 
-      if (e)
-	{
-	  *e = ',';
-	  b = e + 1;
+      if (e)
+	{
+	  *e = ',';
+	  b = e + 1;
+	}
+    }
+  while (e != NULL);
+
+  /* Dump.  */
+  (*desc)->dump (abfd);
+}
+
+/* A run of lines of a section's hex dump, formatted into a buffer of
+   its own so that several runs can be done at once.  */
+
+struct dump_piece
+{
+  bfd_vma start_offset;
+  bfd_vma stop_offset;
+  SFILE out;
+};
+
+/* The pieces of a section waiting to be formatted.  */
+
+struct dump_job
+{
+  bfd *abfd;
+  asection *section;
+  bfd_byte *data;
+  bfd_vma stop_offset;
+  unsigned int opb;
+  int width;
+  struct dump_piece *pieces;
+  size_t count;
+};
+
+/* The number of lines in each piece, and the number of pieces per
+   thread that are formatted before they are written out.  */
+#define DUMP_PIECE_LINES 1024
+#define DUMP_BATCH_PIECES 4
+
+/* The two hex digits of each byte value, and the character dump_section
+   shows for it, so that a line is filled from tables rather than by
+   deciding for each byte.  Set up by dump_tables_init.  */
+
+static char dump_hex_pairs[256][2];
+static char dump_chars[256];
+
+static void
+dump_tables_init (void)
+{
+  static const char hex[] = "0123456789abcdef";
+  int c;
+
+  if (dump_chars[0] != 0)
+    return;
+  for (c = 0; c < 256; c++)
+    {
+      dump_hex_pairs[c][0] = hex[c >> 4];
+      dump_hex_pairs[c][1] = hex[c & 0xf];
+      dump_chars[c] = ISPRINT (c) ? c : '.';
+    }
+}
+
+/* Format the lines of the pieces of DATA, a dump_job, from START up
+   to END.  Worker for _bfd_parallel_for.  */
+
+static bool
+dump_pieces (void *data, size_t start, size_t end)
+{
+  struct dump_job *job = (struct dump_job *) data;
+  /* Bytes per line.  */
+  const int onaline = 16;
+  unsigned int opb = job->opb;
+  bfd_size_type stop = job->stop_offset * opb;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    {
+      struct dump_piece *piece = &job->pieces[i];
+      bfd_vma addr_offset;
+
+      for (addr_offset = piece->start_offset;
+	   addr_offset < piece->stop_offset; addr_offset += onaline / opb)
+	{
+	  static const char hex[] = "0123456789abcdef";
+	  char line[64 + 4 * onaline];
+	  char *p = line;
+	  bfd_vma vma = addr_offset + job->section->vma;
+	  bfd_size_type j, first, last;
+	  int k;
+
+	  /* The address is the low WIDTH digits of what bfd_sprintf_vma
+	     would print, WIDTH being at most as many as it prints.  */
+	  *p++ = ' ';
+	  for (k = job->width - 1; k >= 0; k--)
+	    {
+	      p[k] = hex[vma & 0xf];
+	      vma >>= 4;
+	    }
+	  p += job->width;
+	  *p++ = ' ';
+
+	  first = addr_offset * opb;
+	  last = first + onaline;
+	  if (last > stop)
+	    last = stop;
+	  for (j = first; j < last; j++)
+	    {
+	      memcpy (p, dump_hex_pairs[job->data[j]], 2);
+	      p += 2;
+	      if ((j & 3) == 3)
+		*p++ = ' ';
+	    }
+	  for (; j < first + onaline; j++)
+	    {
+	      *p++ = ' ';
+	      *p++ = ' ';
+	      if ((j & 3) == 3)
+		*p++ = ' ';
+	    }
+
+	  *p++ = ' ';
+	  for (j = first; j < last; j++)
+	    *p++ = dump_chars[job->data[j]];
+	  for (; j < first + onaline; j++)
+	    *p++ = ' ';
+	  *p++ = '\n';
+	  sfile_write (&piece->out, line, p - line);
 	}
     }
-  while (e != NULL);
+  return true;
+}
 
-  /* Dump.  */
-  (*desc)->dump (abfd);
+/* Format the pieces of JOB, on several threads if allowed, and write
+   them out in order.  */
+
+static void
+flush_dump_pieces (struct dump_job *job)
+{
+  size_t i;
+
+  _bfd_parallel_for (job->count, 1, dump_pieces, job);
+
+  for (i = 0; i < job->count; i++)
+    {
+      struct dump_piece *piece = &job->pieces[i];
+
+      fwrite (piece->out.buffer, 1, piece->out.pos, stdout);
+      piece->out.pos = 0;
+    }
+  job->count = 0;
 }
-
+
 /* Display a section in hexadecimal format with associated characters.
    Each line prefixed by the zero padded address.  */
 
@@ -4976,6 +6443,10 @@ dump_section (bfd *abfd, asection *section, void *dummy ATTRIBUTE_UNUSED)
   char buf[64];
   int count;
   int width;
+  struct dump_job job;
+  struct dump_piece *pieces;
+  size_t npieces;
+  size_t i;
 
   if (only_list == NULL)
     {
@@ -5017,12 +6488,15 @@ dump_section (bfd *abfd, asection *section, void *dummy ATTRIBUTE_UNUSED)
 	    (unsigned long long) (section->filepos + start_offset));
   printf ("\n");
 
-  if (!bfd_get_full_section_contents (abfd, section, &data))
+  /* Only read the range being displayed.  */
+  if (!get_section_window (abfd, section, start_offset * opb,
+			   (stop_offset - start_offset) * opb, &data))
     {
       non_fatal (_("Reading section %s failed because: %s"),
 		 section->name, bfd_errmsg (bfd_get_error ()));
       return;
     }
+  data -= start_offset * opb;
 
   width = 4;
 
@@ -5048,66 +6522,142 @@ dump_section (bfd *abfd, asection *section, void *dummy ATTRIBUTE_UNUSED)
   if (count > width)
     width = count;
 
+  dump_tables_init ();
+  npieces = DUMP_BATCH_PIECES * bfd_get_thread_count ();
+  pieces = (struct dump_piece *) xcalloc (npieces, sizeof (*pieces));
+
+  job.abfd = abfd;
+  job.section = section;
+  job.data = data;
+  job.stop_offset = stop_offset;
+  job.opb = opb;
+  job.width = width;
+  job.pieces = pieces;
+  job.count = 0;
   for (addr_offset = start_offset;
-       addr_offset < stop_offset; addr_offset += onaline / opb)
-    {
-      bfd_size_type j;
+       addr_offset < stop_offset;
+       addr_offset += DUMP_PIECE_LINES * (onaline / opb))
+    {
+      struct dump_piece *piece = &pieces[job.count++];
+
+      piece->start_offset = addr_offset;
+      piece->stop_offset = addr_offset + DUMP_PIECE_LINES * (onaline / opb);
+      if (piece->stop_offset > stop_offset)
+	piece->stop_offset = stop_offset;
+      if (job.count == npieces
+	  || piece->stop_offset == stop_offset)
+	flush_dump_pieces (&job);
+    }
+  for (i = 0; i < npieces; i++)
+    free (pieces[i].out.buffer);
+  free (pieces);
+  free (data + start_offset * opb);
+}
 
-      bfd_sprintf_vma (abfd, buf, (addr_offset + section->vma));
-      count = strlen (buf);
-      if ((size_t) count >= sizeof (buf))
-	abort ();
+/* Actually display the various requested regions.  */
 
-      putchar (' ');
-      while (count < width)
-	{
-	  putchar ('0');
-	  count++;
-	}
-      fputs (buf + count - width, stdout);
-      putchar (' ');
+static void
+dump_data (bfd *abfd)
+{
+  bfd_map_over_sections (abfd, dump_section, NULL);
+}
+
+/* Append SYM of ABFD, shown as NAME, to the listing buffer just as
+   bfd_elf_print_symbol prints it with bfd_print_symbol_all.  Returns
+   false without appending anything unless that is how ABFD prints its
+   symbols.  */
+
+static bool
+list_elf_symbol (bfd *abfd, asymbol *sym, const char *name)
+{
+  elf_symbol_type *esym = (elf_symbol_type *) sym;
+  flagword type = sym->flags;
+  const char *version_string;
+  char flags[8];
+  bool hidden;
+
+  if (bfd_get_flavour (abfd) != bfd_target_elf_flavour
+      || abfd->xvec->_bfd_print_symbol != bfd_elf_print_symbol
+      || get_elf_backend_data (abfd)->elf_backend_print_symbol_all != NULL)
+    return false;
+
+  /* As bfd_print_symbol_vandf prints them.  */
+  if (sym->section != NULL)
+    list_vma (abfd, sym->value + sym->section->vma);
+  else
+    list_vma (abfd, sym->value);
+  flags[0] = ' ';
+  flags[1] = ((type & BSF_LOCAL)
+	      ? (type & BSF_GLOBAL) ? '!' : 'l'
+	      : (type & BSF_GLOBAL) ? 'g'
+	      : (type & BSF_GNU_UNIQUE) ? 'u' : ' ');
+  flags[2] = (type & BSF_WEAK) ? 'w' : ' ';
+  flags[3] = (type & BSF_CONSTRUCTOR) ? 'C' : ' ';
+  flags[4] = (type & BSF_WARNING) ? 'W' : ' ';
+  flags[5] = ((type & BSF_INDIRECT) ? 'I'
+	      : (type & BSF_GNU_INDIRECT_FUNCTION) ? 'i' : ' ');
+  flags[6] = (type & BSF_DEBUGGING) ? 'd' : (type & BSF_DYNAMIC) ? 'D' : ' ';
+  flags[7] = ((type & BSF_FUNCTION) ? 'F'
+	      : (type & BSF_FILE) ? 'f'
+	      : (type & BSF_OBJECT) ? 'O' : ' ');
+  sfile_write (&list_out, flags, sizeof (flags));
+
+  list_puts (" ");
+  list_puts (sym->section ? sym->section->name : "(*none*)");
+  list_puts ("\t");
+  if (sym->section && bfd_is_com_section (sym->section))
+    list_vma (abfd, esym->internal_elf_sym.st_value);
+  else
+    list_vma (abfd, esym->internal_elf_sym.st_size);
+
+  version_string = _bfd_elf_get_symbol_version_string (abfd, sym, true,
+						       &hidden);
+  if (version_string)
+    {
+      int pad;
 
-      for (j = addr_offset * opb;
-	   j < addr_offset * opb + onaline; j++)
+      if (!hidden)
 	{
-	  if (j < stop_offset * opb)
-	    printf ("%02x", (unsigned) (data[j]));
-	  else
-	    printf ("  ");
-	  if ((j & 3) == 3)
-	    printf (" ");
+	  list_puts ("  ");
+	  list_puts (version_string);
+	  pad = 11 - strlen (version_string);
 	}
-
-      printf (" ");
-      for (j = addr_offset * opb;
-	   j < addr_offset * opb + onaline; j++)
+      else
 	{
-	  if (j >= stop_offset * opb)
-	    printf (" ");
-	  else
-	    printf ("%c", ISPRINT (data[j]) ? data[j] : '.');
+	  list_puts (" (");
+	  list_puts (version_string);
+	  list_puts (")");
+	  pad = 10 - strlen (version_string);
 	}
-      putchar ('\n');
+      for (; pad > 0; --pad)
+	sfile_write (&list_out, " ", 1);
     }
-  free (data);
-}
 
-/* Actually display the various requested regions.  */
+  switch (esym->internal_elf_sym.st_other)
+    {
+    case 0: break;
+    case STV_INTERNAL:  list_puts (" .internal");  break;
+    case STV_HIDDEN:    list_puts (" .hidden");    break;
+    case STV_PROTECTED: list_puts (" .protected"); break;
+    default:
+      objdump_sprintf (&list_out, " 0x%02x",
+		       (unsigned int) esym->internal_elf_sym.st_other);
+    }
 
-static void
-dump_data (bfd *abfd)
-{
-  bfd_map_over_sections (abfd, dump_section, NULL);
+  list_puts (" ");
+  list_puts (name);
+  return true;
 }
 
 /* Should perhaps share code and display with nm?  */
 
 static void
-dump_symbols (bfd *abfd ATTRIBUTE_UNUSED, bool dynamic)
+dump_symbols (bfd *abfd, bool dynamic)
 {
   asymbol **current;
   long long max_count;
   long long count;
+  const char **demangled = NULL;
 
   if (dynamic)
     {
@@ -5124,71 +6674,74 @@ dump_symbols (bfd *abfd ATTRIBUTE_UNUSED, bool dynamic)
 
   if (max_count == 0)
     printf (_("no symbols\n"));
+  else if (do_demangle)
+    demangled = bfd_demangle_symbols (abfd, current, max_count,
+				      demangle_flags);
 
+  /* The lines are gathered in the listing buffer.  ELF symbols are
+     formatted there directly; others are printed by their target.  */
   for (count = 0; count < max_count; count++)
     {
       bfd *cur_bfd;
 
       if (*current == NULL)
-	printf (_("no information for symbol number %ld\n"), count);
+	{
+	  objdump_sprintf (&list_out,
+			   _("no information for symbol number %ld\n"),
+			   (long) count);
+	}
 
       else if ((cur_bfd = bfd_asymbol_bfd (*current)) == NULL)
-	printf (_("could not determine the type of symbol number %ld\n"),
-		count);
+	{
+	  objdump_sprintf (&list_out,
+			   _("could not determine the type of symbol "
+			     "number %ld\n"),
+			   (long) count);
+	}
 
       else if (process_section_p ((* current)->section)
 	       && (dump_special_syms
 		   || !bfd_is_target_special_symbol (cur_bfd, *current)))
 	{
 	  const char *name = (*current)->name;
+	  const char *shown = name;
+	  char *alloc = NULL;
 
 	  if (do_demangle && name != NULL && *name != '\0')
 	    {
-	      char *alloc;
-
-	      /* If we want to demangle the name, we demangle it
-		 here, and temporarily clobber it while calling
-		 bfd_print_symbol.  FIXME: This is a gross hack.  */
-	      alloc = bfd_demangle (cur_bfd, name, demangle_flags);
-	      if (alloc != NULL)
-		(*current)->name = alloc;
-	      bfd_print_symbol (cur_bfd, stdout, *current,
-				bfd_print_symbol_all);
-	      if (alloc != NULL)
-		{
-		  (*current)->name = name;
-		  free (alloc);
-		}
+	      if (demangled != NULL && cur_bfd == abfd)
+		shown = demangled[count];
+	      else
+		shown = alloc = bfd_demangle (cur_bfd, name, demangle_flags);
+	      if (shown == NULL)
+		shown = name;
 	    }
 	  else if (unicode_display != unicode_default
 		   && name != NULL && *name != '\0')
+	    shown = sanitize_string (name);
+
+	  if (shown == NULL || !list_elf_symbol (cur_bfd, *current, shown))
 	    {
-	      const char * sanitized_name;
-
-	      /* If we want to sanitize the name, we do it here, and
-		 temporarily clobber it while calling bfd_print_symbol.
-		 FIXME: This is a gross hack.  */
-	      sanitized_name = sanitize_string (name);
-	      if (sanitized_name != name)
-		(*current)->name = sanitized_name;
-	      else
-		sanitized_name = NULL;
+	      /* Have the target print the symbol, temporarily clobbering
+		 its name with the one to show.  FIXME: This is a gross
+		 hack.  */
+	      list_flush ();
+	      (*current)->name = shown;
 	      bfd_print_symbol (cur_bfd, stdout, *current,
 				bfd_print_symbol_all);
-	      if (sanitized_name != NULL)
-		(*current)->name = name;
+	      (*current)->name = name;
 	    }
-	  else
-	    bfd_print_symbol (cur_bfd, stdout, *current,
-			      bfd_print_symbol_all);
-	  printf ("\n");
+	  free (alloc);
+	  list_end_line ();
 	}
 
       current++;
     }
+  list_flush ();
   printf ("\n\n");
+  free (demangled);
 }
-
+
 static void
 dump_reloc_set (bfd *abfd, asection *sec, arelent **relpp, long long relcount)
 {
@@ -5243,7 +6796,8 @@ dump_reloc_set (bfd *abfd, asection *sec, arelent **relpp, long long relcount)
 	      && (last_functionname == NULL
 		  || strcmp (functionname, last_functionname) != 0))
 	    {
-	      printf ("%s():\n", sanitize_string (functionname));
+	      objdump_sprintf (&list_out, "%s():\n",
+			       sanitize_string (functionname));
 	      if (last_functionname != NULL)
 		free (last_functionname);
 	      last_functionname = xstrdup (functionname);
@@ -5257,12 +6811,14 @@ dump_reloc_set (bfd *abfd, asection *sec, arelent **relpp, long long relcount)
 		  || (discriminator != last_discriminator)))
 	    {
 	      if (discriminator > 0)
-		printf ("%s:%u\n", filename == NULL ? "???" :
-			sanitize_string (filename), linenumber);
+		objdump_sprintf (&list_out, "%s:%u\n",
+				 filename == NULL ? "???" :
+				 sanitize_string (filename), linenumber);
 	      else
-		printf ("%s:%u (discriminator %u)\n",
-			filename == NULL ? "???" : sanitize_string (filename),
-			linenumber, discriminator);
+		objdump_sprintf (&list_out, "%s:%u (discriminator %u)\n",
+				 filename == NULL ? "???"
+				 : sanitize_string (filename),
+				 linenumber, discriminator);
 	      last_line = linenumber;
 	      last_discriminator = discriminator;
 	      if (last_filename != NULL)
@@ -5285,9 +6841,9 @@ dump_reloc_set (bfd *abfd, asection *sec, arelent **relpp, long long relcount)
 	  section_name = NULL;
 	}
 
-      bfd_printf_vma (abfd, q->address);
+      list_vma (abfd, q->address);
       if (q->howto == NULL)
-	printf (" *unknown*         ");
+	list_puts (" *unknown*         ");
       else if (q->howto->name)
 	{
 	  const char *name = q->howto->name;
@@ -5318,10 +6874,10 @@ dump_reloc_set (bfd *abfd, asection *sec, arelent **relpp, long long relcount)
 		  p++;
 		}
 	    }
-	  printf (" %-16s  ", name);
+	  objdump_sprintf (&list_out, " %-16s  ", name);
 	}
       else
-	printf (" %-16d  ", q->howto->type);
+	objdump_sprintf (&list_out, " %-16d  ", q->howto->type);
 
       if (sym_name)
 	{
@@ -5331,7 +6887,9 @@ dump_reloc_set (bfd *abfd, asection *sec, arelent **relpp, long long relcount)
 	{
 	  if (section_name == NULL)
 	    section_name = "*unknown*";
-	  printf ("[%s]", sanitize_string (section_name));
+	  list_puts ("[");
+	  list_puts (sanitize_string (section_name));
+	  list_puts ("]");
 	}
 
       if (q->addend)
@@ -5339,21 +6897,22 @@ dump_reloc_set (bfd *abfd, asection *sec, arelent **relpp, long long relcount)
 	  bfd_signed_vma addend = q->addend;
 	  if (addend < 0)
 	    {
-	      printf ("-0x");
+	      list_puts ("-0x");
 	      addend = -addend;
 	    }
 	  else
-	    printf ("+0x");
-	  bfd_printf_vma (abfd, addend);
+	    list_puts ("+0x");
+	  list_vma (abfd, addend);
 	}
       if (addend2)
 	{
-	  printf ("+0x");
-	  bfd_printf_vma (abfd, addend2);
+	  list_puts ("+0x");
+	  list_vma (abfd, addend2);
 	}
 
-      printf ("\n");
+      list_end_line ();
     }
+  list_flush ();
 
   if (last_filename != NULL)
     free (last_filename);
@@ -5536,7 +7095,9 @@ static void
 dump_bfd (bfd *abfd, bool is_mainfile)
 {
   const struct elf_backend_data * bed;
+  bfd_trace_span span;
 
+  bfd_trace_begin (&span, "dump_bfd", abfd);
   if (bfd_big_endian (abfd))
     byte_get = byte_get_big_endian;
   else if (bfd_little_endian (abfd))
@@ -5731,6 +7292,7 @@ dump_bfd (bfd *abfd, bool is_mainfile)
 
   if (is_mainfile)
     free_debug_memory ();
+  bfd_trace_end (&span);
 }
 
 static void
@@ -5783,7 +7345,11 @@ display_any_bfd (bfd *file, int level)
       bfd *last_arfile = NULL;
 
       if (level == 0)
-	printf (_("In archive %s:\n"), sanitize_string (bfd_get_filename (file)));
+	{
+	  if (!json_output)
+	    printf (_("In archive %s:\n"),
+		    sanitize_string (bfd_get_filename (file)));
+	}
       else if (level > 100)
 	{
 	  /* Prevent corrupted files from spinning us into an
@@ -5792,7 +7358,7 @@ display_any_bfd (bfd *file, int level)
 	  exit_status = 1;
 	  return;
 	}
-      else
+      else if (!json_output)
 	printf (_("In nested archive %s:\n"),
 		sanitize_string (bfd_get_filename (file)));
 
@@ -5861,9 +7427,464 @@ display_file (char *filename, char *target, bool last_file)
   if (! last_file)
     bfd_close (file);
   else
-    bfd_close_all_done (file);
+    {
+      bfd_set_fast_close (true);
+      bfd_close_all_done (file);
+    }
 }
 
+/* --session keeps the files it is asked about open, with their symbol
+   tables, debug info and source files, and answers requests read from
+   standard input one line at a time:
+
+     disassemble FILE [START [STOP]]
+     symbolize FILE ADDRESS...
+     headers FILE
+     symbols FILE
+     close FILE
+     quit
+
+   The options given on the command line apply to every request.  The
+   reply to each request ends with a line of "%end", or of "%error" if
+   it failed.  A file is opened again if it has changed since the last
+   request about it.  */
+
+struct session_file
+{
+  struct session_file *next;
+  char *filename;
+  time_t mtime;
+  long long size;
+  bfd *abfd;
+  asymbol **syms;
+  long long symcount;
+  asymbol **dynsyms;
+  long long dynsymcount;
+  asymbol *synthsyms;
+  long long synthcount;
+  /* The sorted symbols built by disassemble_data, or NULL if there
+     has been no disassembly yet.  */
+  asymbol **sorted_syms;
+  long long sorted_symcount;
+};
+
+static struct session_file *session_files;
+static char *session_target;
+
+/* Close SF and free everything kept for it.  */
+
+static void
+session_close_file (struct session_file *sf)
+{
+  if (print_files_bfd == sf->abfd)
+    free_print_files ();
+  free (sf->syms);
+  free (sf->dynsyms);
+  free (sf->synthsyms);
+  free (sf->sorted_syms);
+  bfd_close (sf->abfd);
+  free (sf->filename);
+  free (sf);
+}
+
+/* Return the session's entry for FILENAME, opening the file if it is
+   not open yet or has changed since it was.  Returns NULL, having
+   reported why, if the file can't be read.  */
+
+static struct session_file *
+session_get_file (const char *filename)
+{
+  struct session_file **pp, *sf;
+  struct stat st;
+  char **matching;
+  bfd *abfd;
+
+  if (stat (filename, &st) != 0)
+    {
+      non_fatal (_("'%s': No such file"), filename);
+      return NULL;
+    }
+
+  for (pp = &session_files; (sf = *pp) != NULL; pp = &sf->next)
+    if (strcmp (sf->filename, filename) == 0)
+      {
+	if (sf->mtime == st.st_mtime && sf->size == st.st_size)
+	  return sf;
+	*pp = sf->next;
+	session_close_file (sf);
+	break;
+      }
+
+  abfd = bfd_openr (filename, session_target);
+  if (abfd == NULL)
+    {
+      my_bfd_nonfatal (filename);
+      return NULL;
+    }
+  if (!dump_section_contents)
+    abfd->flags |= BFD_DECOMPRESS;
+
+  if (!bfd_check_format_matches (abfd, bfd_object, &matching)
+      && (bfd_get_error () != bfd_error_file_not_recognized
+	  || !bfd_check_format_matches (abfd, bfd_core, &matching)))
+    {
+      my_bfd_nonfatal (filename);
+      if (bfd_get_error () == bfd_error_file_ambiguously_recognized)
+	list_matching_formats (matching);
+      bfd_close (abfd);
+      return NULL;
+    }
+
+  if (adjust_section_vma != 0)
+    {
+      bool has_reloc = (abfd->flags & HAS_RELOC);
+      bfd_map_over_sections (abfd, adjust_addresses, &has_reloc);
+    }
+
+  sf = (struct session_file *) xmalloc (sizeof (*sf));
+  sf->filename = xstrdup (filename);
+  sf->mtime = st.st_mtime;
+  sf->size = st.st_size;
+  sf->abfd = abfd;
+  sf->syms = slurp_symtab (abfd);
+  sf->symcount = symcount;
+  sf->dynsyms = NULL;
+  sf->dynsymcount = 0;
+  if (bfd_get_dynamic_symtab_upper_bound (abfd) > 0)
+    {
+      sf->dynsyms = slurp_dynamic_symtab (abfd);
+      sf->dynsymcount = dynsymcount;
+    }
+  sf->synthsyms = NULL;
+  sf->synthcount = bfd_get_synthetic_symtab (abfd, sf->symcount, sf->syms,
+					     sf->dynsymcount, sf->dynsyms,
+					     &sf->synthsyms);
+  if (sf->synthcount < 0)
+    sf->synthcount = 0;
+  sf->sorted_syms = NULL;
+  sf->sorted_symcount = 0;
+  symcount = 0;
+  dynsymcount = 0;
+
+  sf->next = session_files;
+  session_files = sf;
+  return sf;
+}
+
+/* Make the symbol tables of SF the ones the dumping functions use.  */
+
+static void
+session_select (struct session_file *sf)
+{
+  syms = sf->syms;
+  symcount = sf->symcount;
+  dynsyms = sf->dynsyms;
+  dynsymcount = sf->dynsymcount;
+  synthsyms = sf->synthsyms;
+  synthcount = sf->synthcount;
+  sorted_syms = sf->sorted_syms;
+  sorted_symcount = sf->sorted_symcount;
+}
+
+/* Undo session_select, keeping whatever disassemble_data built.  */
+
+static void
+session_deselect (struct session_file *sf)
+{
+  sf->sorted_syms = sorted_syms;
+  sf->sorted_symcount = sorted_symcount;
+  syms = NULL;
+  symcount = 0;
+  dynsyms = NULL;
+  dynsymcount = 0;
+  synthsyms = NULL;
+  synthcount = 0;
+  sorted_syms = NULL;
+  sorted_symcount = 0;
+}
+
+/* Parse the address S of a request into *VMA, sign extending it as
+   dump_bfd does for targets with signed addresses.  */
+
+static bool
+session_parse_vma (bfd *abfd, const char *s, bfd_vma *vma)
+{
+  const struct elf_backend_data *bed;
+  const char *end;
+
+  *vma = bfd_scan_vma (s, &end, 0);
+  if (*end != '\0')
+    {
+      non_fatal (_("bad address: %s"), s);
+      return false;
+    }
+  if (bfd_get_flavour (abfd) == bfd_target_elf_flavour
+      && (bed = get_elf_backend_data (abfd)) != NULL
+      && bed->sign_extend_vma)
+    *vma = sign_extend_address (abfd, *vma, bed->s->arch_size);
+  return true;
+}
+
+/* disassemble FILE [START [STOP]]  */
+
+static bool
+session_disassemble (struct session_file *sf, int argc, char **argv)
+{
+  bfd_vma save_start = start_address;
+  bfd_vma save_stop = stop_address;
+  bool ret = false;
+
+  if (argc > 4)
+    non_fatal (_("usage: disassemble FILE [START [STOP]]"));
+  else if (argc > 2 && !session_parse_vma (sf->abfd, argv[2], &start_address))
+    ;
+  else if (argc > 3 && !session_parse_vma (sf->abfd, argv[3], &stop_address))
+    ;
+  else if (start_address != (bfd_vma) -1
+	   && stop_address != (bfd_vma) -1
+	   && stop_address <= start_address)
+    non_fatal (_("error: the start address should be before the end address"));
+  else
+    {
+      session_select (sf);
+      disassemble_data (sf->abfd);
+      session_deselect (sf);
+      ret = true;
+    }
+
+  start_address = save_start;
+  stop_address = save_stop;
+  return ret;
+}
+
+/* Print the function and source line of VMA in SF, and those it was
+   inlined into if --inlines was given.  */
+
+static void
+session_symbolize_vma (struct session_file *sf, bfd_vma vma)
+{
+  bfd *abfd = sf->abfd;
+  const char *filename = NULL;
+  const char *functionname = NULL;
+  unsigned int line = 0;
+  unsigned int discriminator = 0;
+  asection *sec;
+  char buf[64];
+  bool found = false;
+
+  for (sec = abfd->sections; sec != NULL; sec = sec->next)
+    if ((sec->flags & SEC_ALLOC) != 0
+	&& vma >= bfd_section_vma (sec)
+	&& (vma - bfd_section_vma (sec)
+	    < bfd_section_size (sec) / bfd_octets_per_byte (abfd, sec)))
+      {
+	found = bfd_find_nearest_line_discriminator (abfd, sec, syms,
+						     vma - bfd_section_vma (sec),
+						     &filename, &functionname,
+						     &line, &discriminator);
+	break;
+      }
+
+  bfd_sprintf_vma (abfd, buf, vma);
+  printf ("%s", buf);
+
+  for (;;)
+    {
+      char *alloc = NULL;
+
+      if (found && functionname != NULL && *functionname != '\0')
+	{
+	  if (do_demangle)
+	    alloc = bfd_demangle (abfd, functionname, demangle_flags);
+	  printf (" %s", sanitize_string (alloc != NULL
+					  ? alloc : functionname));
+	  free (alloc);
+	}
+      else
+	printf (" ??");
+      if (found && filename != NULL && *filename != '\0')
+	printf (" %s:%u", sanitize_string (filename), line);
+      else
+	printf (" ??:0");
+      if (discriminator > 0)
+	printf (" (discriminator %u)", discriminator);
+      putchar ('\n');
+
+      if (!found || !unwind_inlines
+	  || !bfd_find_inliner_info (abfd, &filename, &functionname, &line))
+	break;
+      discriminator = 0;
+      printf (" (inlined by)");
+    }
+}
+
+/* symbolize FILE ADDRESS...  */
+
+static bool
+session_symbolize (struct session_file *sf, int argc, char **argv)
+{
+  bfd_vma *vmas;
+  int i;
+
+  if (argc < 3)
+    {
+      non_fatal (_("usage: symbolize FILE ADDRESS..."));
+      return false;
+    }
+
+  /* Check all the addresses before printing anything.  */
+  vmas = (bfd_vma *) xmalloc ((argc - 2) * sizeof (*vmas));
+  for (i = 2; i < argc; i++)
+    if (!session_parse_vma (sf->abfd, argv[i], &vmas[i - 2]))
+      {
+	free (vmas);
+	return false;
+      }
+
+  /* Stripped files have only their dynamic symbols to name functions
+     with.  */
+  syms = sf->symcount != 0 ? sf->syms : sf->dynsyms;
+  for (i = 2; i < argc; i++)
+    session_symbolize_vma (sf, vmas[i - 2]);
+  syms = NULL;
+  free (vmas);
+  return true;
+}
+
+/* Answer the request in LINE.  Returns false if the session should
+   end.  */
+
+static bool
+session_request (char *line)
+{
+  char **argv;
+  int argc;
+  struct session_file *sf = NULL;
+  struct session_file **pp;
+  bool ok = false;
+  bool more = true;
+
+  argv = buildargv (line);
+  argc = countargv (argv);
+  if (argc == 0)
+    {
+      freeargv (argv);
+      return true;
+    }
+
+  if (streq (argv[0], "quit"))
+    more = false;
+  else if (argc < 2)
+    non_fatal (_("unknown request: %s"), argv[0]);
+  else if (streq (argv[0], "close"))
+    {
+      for (pp = &session_files; (sf = *pp) != NULL; pp = &sf->next)
+	if (strcmp (sf->filename, argv[1]) == 0)
+	  {
+	    *pp = sf->next;
+	    session_close_file (sf);
+	    ok = true;
+	    break;
+	  }
+      if (!ok)
+	non_fatal (_("'%s' is not open"), argv[1]);
+    }
+  else if (!streq (argv[0], "disassemble")
+	   && !streq (argv[0], "symbolize")
+	   && !streq (argv[0], "headers")
+	   && !streq (argv[0], "symbols"))
+    non_fatal (_("unknown request: %s"), argv[0]);
+  else if ((sf = session_get_file (argv[1])) == NULL)
+    ;
+  else if (streq (argv[0], "disassemble"))
+    ok = session_disassemble (sf, argc, argv);
+  else if (streq (argv[0], "symbolize"))
+    ok = session_symbolize (sf, argc, argv);
+  else if (streq (argv[0], "headers"))
+    {
+      printf (_("\n%s:     file format %s\n"),
+	      sanitize_string (bfd_get_filename (sf->abfd)),
+	      sf->abfd->xvec->name);
+      dump_bfd_header (sf->abfd);
+      putchar ('\n');
+      dump_headers (sf->abfd);
+      ok = true;
+    }
+  else
+    {
+      session_select (sf);
+      dump_symbols (sf->abfd, false);
+      session_deselect (sf);
+      ok = true;
+    }
+
+  freeargv (argv);
+  if (more)
+    {
+      fflush (stderr);
+      printf (ok ? "%%end\n" : "%%error\n");
+      fflush (stdout);
+    }
+  return more;
+}
+
+/* Read a line from standard input into a buffer that is reused from
+   one call to the next.  Returns NULL at the end of the input.  */
+
+static char *
+session_read_line (void)
+{
+  static char *buf;
+  static size_t alloc;
+  size_t len = 0;
+
+  if (buf == NULL)
+    {
+      alloc = 256;
+      buf = (char *) xmalloc (alloc);
+    }
+
+  while (fgets (buf + len, alloc - len, stdin) != NULL)
+    {
+      len += strlen (buf + len);
+      if (len > 0 && buf[len - 1] == '\n')
+	return buf;
+      if (len + 1 >= alloc)
+	{
+	  alloc *= 2;
+	  buf = (char *) xrealloc (buf, alloc);
+	}
+    }
+
+  return len != 0 ? buf : NULL;
+}
+
+/* Run a session for --session, first opening the COUNT files in
+   FILES.  */
+
+static void
+run_session (int count, char **files, char *target)
+{
+  struct session_file *sf;
+  char *line;
+  int i;
+
+  session_target = target;
+  for (i = 0; i < count; i++)
+    session_get_file (files[i]);
+
+  while ((line = session_read_line ()) != NULL)
+    if (!session_request (line))
+      break;
+
+  while ((sf = session_files) != NULL)
+    {
+      session_files = sf->next;
+      session_close_file (sf);
+    }
+  free_print_files ();
+}
+
 int
 main (int argc, char **argv)
 {
@@ -5981,6 +8002,26 @@ main (int argc, char **argv)
 	case OPTION_INLINES:
 	  unwind_inlines = true;
 	  break;
+	case OPTION_THREADS:
+	  bfd_set_thread_count (strtoul (optarg, NULL, 0));
+	  break;
+	case OPTION_TRACE:
+	  if (!bfd_trace_open (optarg))
+	    fatal (_("cannot create trace file %s: %s"), optarg,
+		   bfd_errmsg (bfd_get_error ()));
+	  break;
+	case OPTION_IO_STATISTICS:
+	  io_statistics = true;
+	  bfd_set_io_statistics (true);
+	  break;
+	case OPTION_JSON:
+	  json_output = true;
+	  suppress_bfd_header = 1;
+	  break;
+	case OPTION_SESSION:
+	  session_mode = true;
+	  seenflag = true;
+	  break;
 	case OPTION_VISUALIZE_JUMPS:
 	  visualize_jumps = true;
 	  color_output = false;
@@ -6252,6 +8293,8 @@ main (int argc, char **argv)
 
   if (formats_info)
     exit_status = display_info ();
+  else if (session_mode)
+    run_session (argc - optind, argv + optind, target);
   else
     {
       if (optind == argc)
@@ -6269,5 +8312,14 @@ main (int argc, char **argv)
   free (dump_ctf_parent_name);
   free ((void *) source_comment);
 
+  if (!bfd_trace_close ())
+    {
+      non_fatal (_("error writing trace file"));
+      exit_status = 1;
+    }
+
+  if (io_statistics)
+    bfd_print_io_statistics (stderr, NULL);
+
   return exit_status;
 }
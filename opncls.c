@@ -26,6 +26,30 @@
 #include "libbfd.h"
 #include "libiberty.h"
 #include "elf-bfd.h"
+#include "hashtab.h"
+#include <zlib.h>
+#include <dirent.h>
+#if defined (_WIN32)
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/* x86 processors with PCLMULQDQ can fold 64 bytes of a CRC at a
+   time.  Whether this one has it is checked when first needed.  */
+#if defined (_M_X64) \
+    || (defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__)))
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PCLMUL_TARGET
+#else
+#define PCLMUL_TARGET __attribute__ ((target ("sse2,pclmul")))
+#endif
+#define HAVE_PCLMUL_CRC 1
+#endif
 
 #ifndef S_IXUSR
 #define S_IXUSR 0100	/* Execute by owner.  */
@@ -55,6 +79,10 @@ EXTERNAL
 .{* Set to N to open the next N BFDs using an alternate id space.  *}
 .extern unsigned int bfd_use_reserved_id;
 .
+.{* A finder of separate debug files, made by
+.   bfd_create_debug_resolver.  *}
+.struct bfd_debug_resolver;
+.
 */
 unsigned int bfd_use_reserved_id = 0;
 
@@ -106,6 +134,10 @@ _bfd_new_bfd (void)
       free (nbfd);
       return NULL;
     }
+  /* The section table is only ever looked up, never traversed, so
+     it can use the faster hash.  */
+  bfd_hash_table_set_function (&nbfd->section_htab, bfd_hash_wide);
+  bfd_hash_table_set_memory_class (&nbfd->section_htab, bfd_memory_sections);
 
   nbfd->archive_plugin_fd = -1;
 
@@ -148,6 +180,8 @@ _bfd_new_bfd_contained_in (bfd *obfd)
   nbfd->target_defaulted = obfd->target_defaulted;
   nbfd->lto_output = obfd->lto_output;
   nbfd->no_export = obfd->no_export;
+  if (obfd->name_pool != NULL)
+    bfd_set_name_pool (nbfd, obfd->name_pool);
   return nbfd;
 }
 
@@ -156,19 +190,31 @@ _bfd_new_bfd_contained_in (bfd *obfd)
 static void
 _bfd_delete_bfd (bfd *abfd)
 {
+  /* Report the I/O done while the filename is still to hand.  */
+  _bfd_io_release (abfd);
+
   /* Give the target _bfd_free_cached_info a chance to free memory.  */
   if (abfd->memory && abfd->xvec)
     bfd_free_cached_info (abfd);
 
+  _bfd_munmap_all (abfd);
+  _bfd_section_cache_drop (abfd);
+  _bfd_section_map_free (abfd);
+  _bfd_simple_link_free (abfd);
+
   /* The target _bfd_free_cached_info may not have done anything..  */
   if (abfd->memory)
     {
+      _bfd_hash_table_report (&abfd->section_htab, "section",
+			      bfd_get_filename (abfd));
       bfd_hash_table_free (&abfd->section_htab);
       objalloc_free ((struct objalloc *) abfd->memory);
     }
   else
     free ((char *) bfd_get_filename (abfd));
+  _bfd_memory_release (abfd, NULL);
 
+  bfd_name_pool_release (abfd->name_pool);
   free (abfd->arelt_data);
   free (abfd);
 }
@@ -212,15 +258,25 @@ _bfd_free_cached_info (bfd *abfd)
 	  memcpy (copy, filename, len);
 	  abfd->filename = copy;
 	}
+      _bfd_hash_table_report (&abfd->section_htab, "section",
+			      bfd_get_filename (abfd));
       bfd_hash_table_free (&abfd->section_htab);
       objalloc_free ((struct objalloc *) abfd->memory);
+      _bfd_memory_release (abfd, NULL);
 
       abfd->sections = NULL;
       abfd->section_last = NULL;
       abfd->outsymbols = NULL;
       abfd->tdata.any = NULL;
       abfd->usrdata = NULL;
+      abfd->symbol_index = NULL;
+      abfd->sorted_relocs = NULL;
+      abfd->unwind_table = NULL;
+      abfd->frame_indexes = NULL;
       abfd->memory = NULL;
+      _bfd_section_cache_drop (abfd);
+      _bfd_section_map_free (abfd);
+      _bfd_simple_link_free (abfd);
     }
 
   return true;
@@ -576,6 +632,20 @@ DESCRIPTION
 	BFD.  It can be accessed via the bfd_get_filename() macro.
 */
 
+/* One block of the optional read cache of an iovec BFD.  */
+
+struct opncls_block
+{
+  /* File offset of the block, a multiple of the block size, or -1 if
+     the block holds nothing.  */
+  file_ptr offset;
+  /* Number of valid bytes, fewer than the block size at end of file.  */
+  file_ptr len;
+  /* Value of the cache clock when the block was last used.  */
+  unsigned int used;
+  bfd_byte *data;
+};
+
 struct opncls
 {
   void *stream;
@@ -584,8 +654,180 @@ struct opncls
   int (*close) (struct bfd *abfd, void *stream);
   int (*stat) (struct bfd *abfd, void *stream, struct stat *sb);
   file_ptr where;
+  /* The block cache set up by bfd_set_iovec_cache.  BLOCKS is NULL
+     when there is none.  */
+  struct opncls_block *blocks;
+  unsigned int nblocks;
+  file_ptr block_size;
+  unsigned int clock;
+  /* Read-ahead state: the window in blocks, its upper limit, a buffer
+     big enough for the largest window, and the block a sequential
+     reader would miss on next.  */
+  unsigned int ra_blocks;
+  unsigned int ra_max;
+  bfd_byte *ra_buf;
+  file_ptr ra_next;
 };
 
+/* Release the block cache of VEC.  */
+
+static void
+opncls_cache_free (struct opncls *vec)
+{
+  if (vec->blocks != NULL)
+    free (vec->blocks[0].data);
+  free (vec->blocks);
+  free (vec->ra_buf);
+  vec->blocks = NULL;
+  vec->nblocks = 0;
+  vec->ra_buf = NULL;
+}
+
+/* Return the cached block starting at OFFSET, or NULL.  */
+
+static struct opncls_block *
+opncls_cache_find (struct opncls *vec, file_ptr offset)
+{
+  unsigned int i;
+
+  for (i = 0; i < vec->nblocks; i++)
+    if (vec->blocks[i].offset == offset)
+      return &vec->blocks[i];
+  return NULL;
+}
+
+/* Return the least recently used block of VEC.  */
+
+static struct opncls_block *
+opncls_cache_victim (struct opncls *vec)
+{
+  struct opncls_block *victim = &vec->blocks[0];
+  unsigned int i;
+
+  for (i = 1; i < vec->nblocks; i++)
+    if (vec->blocks[i].used < victim->used)
+      victim = &vec->blocks[i];
+  return victim;
+}
+
+/* Read the block at OFFSET into the cache, together with the blocks
+   following it when the reader appears to be sequential.  Return the
+   block for OFFSET, or NULL if the read fails.  */
+
+static struct opncls_block *
+opncls_cache_fill (bfd *abfd, struct opncls *vec, file_ptr offset)
+{
+  struct opncls_block *first = NULL;
+  file_ptr nread;
+  bfd_byte *buf;
+  unsigned int i;
+
+  /* Grow the window while blocks are missed in ascending order, and
+     start again from a single block on any other access.  */
+  if (offset == vec->ra_next && vec->ra_blocks < vec->ra_max)
+    vec->ra_blocks *= 2;
+  else if (offset != vec->ra_next)
+    vec->ra_blocks = 1;
+  if (vec->ra_blocks > vec->ra_max)
+    vec->ra_blocks = vec->ra_max;
+
+  if (vec->ra_blocks <= 1)
+    {
+      first = opncls_cache_victim (vec);
+      buf = first->data;
+    }
+  else
+    buf = vec->ra_buf;
+
+  nread = (vec->pread) (abfd, vec->stream, buf,
+			vec->block_size * vec->ra_blocks, offset);
+  if (nread < 0)
+    {
+      if (first != NULL)
+	first->offset = -1;
+      return NULL;
+    }
+
+  if (first != NULL)
+    {
+      first->offset = offset;
+      first->len = nread;
+      first->used = ++vec->clock;
+      vec->ra_next = offset + vec->block_size;
+      return first;
+    }
+
+  for (i = 0; i < vec->ra_blocks; i++)
+    {
+      file_ptr pos = (file_ptr) i * vec->block_size;
+      struct opncls_block *b;
+
+      if (i != 0 && pos >= nread)
+	break;
+      b = opncls_cache_find (vec, offset + pos);
+      if (b == NULL)
+	b = opncls_cache_victim (vec);
+      b->offset = offset + pos;
+      b->len = nread - pos < vec->block_size ? nread - pos : vec->block_size;
+      if (b->len < 0)
+	b->len = 0;
+      memcpy (b->data, buf + pos, b->len);
+      b->used = ++vec->clock;
+      if (i == 0)
+	first = b;
+    }
+  vec->ra_next = offset + (file_ptr) i * vec->block_size;
+  return first;
+}
+
+/* Read NBYTES at OFFSET from the stream of VEC into BUF, going through
+   the block cache if there is one.  Return the number of bytes read,
+   or -1 on error.  */
+
+static file_ptr
+opncls_read (bfd *abfd, struct opncls *vec, void *buf, file_ptr nbytes,
+	     file_ptr offset)
+{
+  file_ptr done = 0;
+
+  /* Large reads gain nothing from the cache.  */
+  if (vec->blocks == NULL || nbytes >= vec->block_size)
+    return (vec->pread) (abfd, vec->stream, buf, nbytes, offset);
+
+  while (done < nbytes)
+    {
+      file_ptr pos = offset + done;
+      file_ptr block = pos & ~(vec->block_size - 1);
+      struct opncls_block *b;
+      file_ptr skip;
+      file_ptr n;
+
+      b = opncls_cache_find (vec, block);
+      if (b == NULL)
+	{
+	  b = opncls_cache_fill (abfd, vec, block);
+	  if (b == NULL)
+	    return -1;
+	}
+      else
+	b->used = ++vec->clock;
+
+      skip = pos - block;
+      if (skip >= b->len)
+	break;
+      n = b->len - skip;
+      if (n > nbytes - done)
+	n = nbytes - done;
+      memcpy ((bfd_byte *) buf + done, b->data + skip, n);
+      done += n;
+
+      /* A short block is the end of the file.  */
+      if (b->len < vec->block_size)
+	break;
+    }
+  return done;
+}
+
 static file_ptr
 opncls_btell (struct bfd *abfd)
 {
@@ -610,7 +852,7 @@ static file_ptr
 opncls_bread (struct bfd *abfd, void *buf, file_ptr nbytes)
 {
   struct opncls *vec = (struct opncls *) abfd->iostream;
-  file_ptr nread = (vec->pread) (abfd, vec->stream, buf, nbytes, vec->where);
+  file_ptr nread = opncls_read (abfd, vec, buf, nbytes, vec->where);
 
   if (nread < 0)
     return nread;
@@ -634,6 +876,7 @@ opncls_bclose (struct bfd *abfd)
      free it.  */
   int status = 0;
 
+  opncls_cache_free (vec);
   if (vec->close != NULL)
     status = (vec->close) (abfd, vec->stream);
   abfd->iostream = NULL;
@@ -671,10 +914,39 @@ opncls_bmmap (struct bfd *abfd ATTRIBUTE_UNUSED,
   return (void *) -1;
 }
 
+/* The stream is positioned by offset, so pass each range straight to
+   the pread method without a separate seek.  */
+
+static bool
+opncls_breadv (struct bfd *abfd, const struct bfd_read_range *ranges,
+	       unsigned int count)
+{
+  struct opncls *vec = (struct opncls *) abfd->iostream;
+  unsigned int i;
+
+  for (i = 0; i < count; i++)
+    {
+      file_ptr size = ranges[i].size;
+      file_ptr nread = opncls_read (abfd, vec, ranges[i].buf,
+				    size, ranges[i].offset);
+
+      if (nread < 0)
+	return false;
+      vec->where = ranges[i].offset + nread;
+      if (nread != size)
+	{
+	  bfd_set_error (bfd_error_file_truncated);
+	  return false;
+	}
+    }
+  return true;
+}
+
 static const struct bfd_iovec opncls_iovec =
 {
   &opncls_bread, &opncls_bwrite, &opncls_btell, &opncls_bseek,
-  &opncls_bclose, &opncls_bflush, &opncls_bstat, &opncls_bmmap
+  &opncls_bclose, &opncls_bflush, &opncls_bstat, &opncls_bmmap,
+  &opncls_breadv, NULL, NULL, NULL
 };
 
 bfd *
@@ -730,7 +1002,221 @@ bfd_openr_iovec (const char *filename, const char *target,
 
   return nbfd;
 }
+
+/* The most blocks read ahead at once.  */
+#define OPNCLS_MAX_READAHEAD 16
+
+/*
+FUNCTION
+	bfd_set_iovec_cache
+
+SYNOPSIS
+	bool bfd_set_iovec_cache (bfd *abfd, unsigned int block_size,
+				  bfd_size_type budget);
+
+DESCRIPTION
+	Cache reads from @var{abfd}, which must have been opened by
+	<<bfd_openr_iovec>> or be an element of an archive that was, in
+	blocks of @var{block_size} bytes aligned to multiples of
+	@var{block_size}.  @var{block_size} must be a power of two.  At
+	most @var{budget} bytes are used for the blocks and for reading
+	ahead.  Small reads are then served from the cache, so the
+	@var{pread_func} is called once per missing block rather than
+	once per read.  While blocks are missed in ascending order,
+	ever more following blocks are fetched by each call.  Reads of
+	@var{block_size} bytes or more bypass the cache.
+
+	The cache is shared by the archive and all its elements.  A
+	@var{budget} of zero removes any existing cache.  Return
+	<<TRUE>> on success, otherwise <<FALSE>> with <<bfd_error>>
+	set to <<bfd_error_invalid_operation>> or
+	<<bfd_error_no_memory>>.
+*/
+
+bool
+bfd_set_iovec_cache (bfd *abfd, unsigned int block_size,
+		     bfd_size_type budget)
+{
+  struct opncls *vec;
+  bfd_size_type nblocks;
+  unsigned int ra_max;
+  bfd_byte *data;
+  unsigned int i;
+
+  if (abfd->iovec != &opncls_iovec
+      || abfd->iostream == NULL
+      || block_size == 0
+      || (block_size & (block_size - 1)) != 0)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  vec = (struct opncls *) abfd->iostream;
+  opncls_cache_free (vec);
+  if (budget == 0)
+    return true;
+
+  /* Reserve up to a third of the budget for the read-ahead buffer.  */
+  nblocks = budget / block_size;
+  ra_max = nblocks / 3;
+  if (ra_max > OPNCLS_MAX_READAHEAD)
+    ra_max = OPNCLS_MAX_READAHEAD;
+  if (ra_max < 2)
+    ra_max = 1;
+  else
+    nblocks -= ra_max;
+  if (nblocks == 0 || nblocks != (unsigned int) nblocks)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  vec->blocks = (struct opncls_block *) bfd_malloc (nblocks
+						    * sizeof (*vec->blocks));
+  data = (bfd_byte *) bfd_malloc (nblocks * block_size);
+  if (ra_max > 1)
+    vec->ra_buf = (bfd_byte *) bfd_malloc ((bfd_size_type) ra_max
+					   * block_size);
+  if (vec->blocks == NULL || data == NULL
+      || (ra_max > 1 && vec->ra_buf == NULL))
+    {
+      free (vec->blocks);
+      free (data);
+      free (vec->ra_buf);
+      vec->blocks = NULL;
+      vec->ra_buf = NULL;
+      return false;
+    }
+
+  for (i = 0; i < nblocks; i++)
+    {
+      vec->blocks[i].offset = -1;
+      vec->blocks[i].len = 0;
+      vec->blocks[i].used = 0;
+      vec->blocks[i].data = data + (bfd_size_type) i * block_size;
+    }
+  vec->nblocks = nblocks;
+  vec->block_size = block_size;
+  vec->clock = 0;
+  vec->ra_blocks = 1;
+  vec->ra_max = ra_max;
+  vec->ra_next = -1;
+  return true;
+}
 
+/*
+FUNCTION
+	bfd_openr_pread
+
+SYNOPSIS
+	bfd *bfd_openr_pread (const char *filename, const char *target);
+
+DESCRIPTION
+	Open the file @var{filename} for reading, as <<bfd_openr>> does,
+	but read it with positional reads (<<pread>>, or <<ReadFile>>
+	with an <<OVERLAPPED>> offset on Windows) rather than through the
+	file cache.  Reads need no separate seek, and no file position
+	is shared with any other BFD, so different BFDs opened this way
+	may be read from several threads at the same time.  The file
+	stays open until the BFD is closed and does not count against
+	the cache limit.
+
+	Possible errors are as for <<bfd_openr>>.
+*/
+
+static void *
+pread_file_open (bfd *abfd, void *open_closure ATTRIBUTE_UNUSED)
+{
+  FILE *f = _bfd_real_fopen (bfd_get_filename (abfd), FOPEN_RB);
+
+  if (f == NULL)
+    bfd_set_error (bfd_error_system_call);
+  return f;
+}
+
+static file_ptr
+pread_file_pread (bfd *abfd ATTRIBUTE_UNUSED, void *stream, void *buf,
+		  file_ptr nbytes, file_ptr offset)
+{
+  FILE *f = (FILE *) stream;
+  file_ptr nread = 0;
+
+  while (nread < nbytes)
+    {
+      /* As in cache_bread, avoid single reads larger than 8MB.  */
+      const file_ptr max_chunk_size = 0x800000;
+      file_ptr chunk_size = nbytes - nread;
+      file_ptr pos = offset + nread;
+
+      if (chunk_size > max_chunk_size)
+	chunk_size = max_chunk_size;
+
+#if defined (_WIN32)
+      OVERLAPPED ov;
+      DWORD got;
+
+      memset (&ov, 0, sizeof (ov));
+      ov.Offset = (DWORD) pos;
+      ov.OffsetHigh = (DWORD) ((uint64_t) pos >> 32);
+      if (!ReadFile ((HANDLE) _get_osfhandle (fileno (f)),
+		     (char *) buf + nread, (DWORD) chunk_size, &got, &ov))
+	{
+	  if (GetLastError () != ERROR_HANDLE_EOF)
+	    {
+	      bfd_set_error (bfd_error_system_call);
+	      return nread == 0 ? -1 : nread;
+	    }
+	  got = 0;
+	}
+#else
+      ssize_t got = pread (fileno (f), (char *) buf + nread, chunk_size, pos);
+
+      if (got < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  bfd_set_error (bfd_error_system_call);
+	  return nread == 0 ? -1 : nread;
+	}
+#endif
+      if (got == 0)
+	break;
+      nread += got;
+    }
+
+  if (nread < nbytes)
+    /* As for cache_bread, this may or may not be an error.  */
+    bfd_set_error (bfd_error_file_truncated);
+  return nread;
+}
+
+static int
+pread_file_close (bfd *abfd ATTRIBUTE_UNUSED, void *stream)
+{
+  if (fclose ((FILE *) stream) == 0)
+    return 0;
+  bfd_set_error (bfd_error_system_call);
+  return -1;
+}
+
+static int
+pread_file_stat (bfd *abfd ATTRIBUTE_UNUSED, void *stream, struct stat *sb)
+{
+  if (fstat (fileno ((FILE *) stream), sb) == 0)
+    return 0;
+  bfd_set_error (bfd_error_system_call);
+  return -1;
+}
+
+bfd *
+bfd_openr_pread (const char *filename, const char *target)
+{
+  return bfd_openr_iovec (filename, target, pread_file_open, NULL,
+			  pread_file_pread, pread_file_close,
+			  pread_file_stat);
+}
+
 /* bfd_openw -- open for writing.
    Returns a pointer to a freshly-allocated BFD on success, or NULL.
 
@@ -913,15 +1399,31 @@ DESCRIPTION
 	If the created file is executable, then <<chmod>> is called
 	to mark it as such.
 
-	All memory attached to the BFD is released.
+	All memory attached to the BFD is released, unless
+	<<bfd_set_fast_close>> says otherwise.
 
 	<<TRUE>> is returned if all is ok, otherwise <<FALSE>>.
 */
 
+/* Whether bfd_set_fast_close has asked for BFDs open for reading to
+   be closed without releasing what they hold.  */
+static bool fast_close;
+
 bool
 bfd_close_all_done (bfd *abfd)
 {
-  bool ret = BFD_SEND (abfd, _close_and_cleanup, (abfd));
+  bool ret;
+
+  if (fast_close && !bfd_write_p (abfd))
+    {
+      /* Only the file is closed; the BFD, its memory and mappings,
+	 the members of an archive and the caches of the target are
+	 all left for the process to drop when it exits.  */
+      _bfd_io_release (abfd);
+      return abfd->iovec == NULL || abfd->iovec->bclose (abfd) == 0;
+    }
+
+  ret = BFD_SEND (abfd, _close_and_cleanup, (abfd));
 
   if (ret && abfd->iovec != NULL)
     {
@@ -936,6 +1438,35 @@ bfd_close_all_done (bfd *abfd)
   return ret;
 }
 
+/*
+FUNCTION
+	bfd_set_fast_close
+
+SYNOPSIS
+	bool bfd_set_fast_close (bool enable);
+
+DESCRIPTION
+	Turn on or off fast closing, for a process that is about to
+	exit.  While it is on, <<bfd_close>> and <<bfd_close_all_done>>
+	of a BFD open only for reading just close its file.  None of
+	the memory or mappings attached to the BFD, nor the BFDs of
+	the members of an archive, are released, and the target does
+	none of the freeing it would otherwise do piece by piece, so
+	closing a BFD costs the same however much it has read.  The
+	process gets the memory back in one go when it exits.  BFDs
+	open for writing are closed as usual.  Returns the previous
+	setting.
+*/
+
+bool
+bfd_set_fast_close (bool enable)
+{
+  bool old = fast_close;
+
+  fast_close = enable;
+  return old;
+}
+
 /*
 FUNCTION
 	bfd_create
@@ -1009,6 +1540,7 @@ bfd_make_writable (bfd *abfd)
   /* bfd_bwrite will grow these as needed.  */
   bim->size = 0;
   bim->buffer = 0;
+  bim->capacity = 0;
 
   abfd->flags |= BFD_IN_MEMORY;
   abfd->iovec = &_bfd_memory_iovec;
@@ -1067,6 +1599,11 @@ bfd_make_readable (bfd *abfd)
   abfd->target_defaulted = true;
   abfd->direction = read_direction;
   abfd->sections = 0;
+  abfd->frame_indexes = NULL;
+  abfd->sorted_relocs = NULL;
+  _bfd_section_cache_drop (abfd);
+  _bfd_section_map_free (abfd);
+  _bfd_simple_link_free (abfd);
   abfd->symcount = 0;
   abfd->outsymbols = 0;
   abfd->tdata.any = 0;
@@ -1078,6 +1615,52 @@ bfd_make_readable (bfd *abfd)
   return true;
 }
 
+/*
+FUNCTION
+	bfd_take_memory_contents
+
+SYNOPSIS
+	bool bfd_take_memory_contents
+	  (bfd *abfd, bfd_byte **buffer, bfd_size_type *size);
+
+DESCRIPTION
+	Takes a BFD held in memory, such as one made by
+	<<bfd_create>> and <<bfd_make_writable>>, and hands over the
+	buffer holding its contents without copying them.  A BFD open
+	for writing has its contents written out first, as
+	<<bfd_close>> would.  @var{*buffer} is set to the buffer,
+	which then belongs to the caller and is freed with <<free>>,
+	and @var{*size} to the size of the contents.  The BFD is left
+	empty, and should be closed with <<bfd_close_all_done>>.
+
+	<<TRUE>> is returned if all is ok, otherwise <<FALSE>>.
+*/
+
+bool
+bfd_take_memory_contents (bfd *abfd, bfd_byte **buffer, bfd_size_type *size)
+{
+  struct bfd_in_memory *bim;
+
+  if (!(abfd->flags & BFD_IN_MEMORY) || abfd->iovec != &_bfd_memory_iovec)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  if (bfd_write_p (abfd)
+      && ! BFD_SEND_FMT (abfd, _bfd_write_contents, (abfd)))
+    return false;
+
+  bim = (struct bfd_in_memory *) abfd->iostream;
+  *buffer = bim->buffer;
+  *size = bim->size;
+  bim->buffer = NULL;
+  bim->size = 0;
+  bim->capacity = 0;
+  abfd->where = 0;
+  return true;
+}
+
 /*
    GNU Extension: separate debug-info files
 
@@ -1094,6 +1677,90 @@ bfd_make_readable (bfd *abfd)
 #define GNU_DEBUGLINK		".gnu_debuglink"
 #define GNU_DEBUGALTLINK	".gnu_debugaltlink"
 
+#ifdef HAVE_PCLMUL_CRC
+/* Return the CRC-32 register CRC, bit-reflected and not inverted,
+   advanced over the LEN bytes at BUF, where LEN is a multiple of 16
+   and at least 64.  The data is folded 512 and then 128 bits at a
+   time with carry-less multiplies by powers of x modulo the CRC
+   polynomial, and the last 64 bits reduced with Barrett's method;
+   see Intel's "Fast CRC Computation for Generic Polynomials Using
+   PCLMULQDQ Instruction".  */
+
+static PCLMUL_TARGET uint32_t
+crc32_pclmul (uint32_t crc, const bfd_byte *buf, size_t len)
+{
+  const __m128i k1k2 = _mm_set_epi64x (0x1c6e41596LL, 0x154442bd4LL);
+  const __m128i k3k4 = _mm_set_epi64x (0xccaa009eLL, 0x1751997d0LL);
+  const __m128i k5 = _mm_set_epi64x (0, 0x163cd6124LL);
+  const __m128i poly = _mm_set_epi64x (0x1f7011641LL, 0x1db710641LL);
+  const __m128i mask32 = _mm_set_epi32 (0, 0, 0, -1);
+  __m128i x1, x2, x3, x4, t;
+
+#define CRC_LOAD(p) _mm_loadu_si128 ((const __m128i *) (p))
+#define CRC_FOLD(x, k, d)						\
+  _mm_xor_si128 (_mm_xor_si128 (_mm_clmulepi64_si128 (x, k, 0x00),	\
+				_mm_clmulepi64_si128 (x, k, 0x11)),	\
+		 d)
+
+  x1 = _mm_xor_si128 (CRC_LOAD (buf), _mm_cvtsi32_si128 (crc));
+  x2 = CRC_LOAD (buf + 16);
+  x3 = CRC_LOAD (buf + 32);
+  x4 = CRC_LOAD (buf + 48);
+  for (buf += 64, len -= 64; len >= 64; buf += 64, len -= 64)
+    {
+      x1 = CRC_FOLD (x1, k1k2, CRC_LOAD (buf));
+      x2 = CRC_FOLD (x2, k1k2, CRC_LOAD (buf + 16));
+      x3 = CRC_FOLD (x3, k1k2, CRC_LOAD (buf + 32));
+      x4 = CRC_FOLD (x4, k1k2, CRC_LOAD (buf + 48));
+    }
+
+  x1 = CRC_FOLD (x1, k3k4, x2);
+  x1 = CRC_FOLD (x1, k3k4, x3);
+  x1 = CRC_FOLD (x1, k3k4, x4);
+  for (; len >= 16; buf += 16, len -= 16)
+    x1 = CRC_FOLD (x1, k3k4, CRC_LOAD (buf));
+#undef CRC_FOLD
+#undef CRC_LOAD
+
+  /* 128 bits to 64, then to 32 plus the 32 zero bits the CRC
+     implies.  */
+  t = _mm_clmulepi64_si128 (k3k4, x1, 0x01);
+  x1 = _mm_xor_si128 (_mm_srli_si128 (x1, 8), t);
+  x2 = _mm_srli_si128 (x1, 4);
+  x1 = _mm_and_si128 (x1, mask32);
+  x1 = _mm_xor_si128 (_mm_clmulepi64_si128 (x1, k5, 0x00), x2);
+
+  /* Barrett reduction to the 32-bit remainder.  */
+  x2 = x1;
+  x1 = _mm_and_si128 (x1, mask32);
+  x1 = _mm_clmulepi64_si128 (x1, poly, 0x10);
+  x1 = _mm_and_si128 (x1, mask32);
+  x1 = _mm_clmulepi64_si128 (x1, poly, 0x00);
+  x1 = _mm_xor_si128 (x1, x2);
+  return _mm_cvtsi128_si32 (_mm_srli_si128 (x1, 4));
+}
+
+/* Nonzero if crc32_pclmul can be used, or -1 if not yet known.  */
+static int pclmul_usable = -1;
+
+static bool
+have_pclmul (void)
+{
+  if (pclmul_usable < 0)
+    {
+#ifdef _MSC_VER
+      int info[4];
+
+      __cpuid (info, 1);
+      pclmul_usable = (info[2] & (1 << 1)) != 0;
+#else
+      pclmul_usable = __builtin_cpu_supports ("pclmul");
+#endif
+    }
+  return pclmul_usable;
+}
+#endif
+
 /*
 FUNCTION
 	bfd_calc_gnu_debuglink_crc32
@@ -1115,108 +1782,227 @@ bfd_calc_gnu_debuglink_crc32 (uint32_t crc,
 			      const bfd_byte *buf,
 			      bfd_size_type len)
 {
-  static const uint32_t crc32_table[256] =
-    {
-      0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419,
-      0x706af48f, 0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4,
-      0xe0d5e91e, 0x97d2d988, 0x09b64c2b, 0x7eb17cbd, 0xe7b82d07,
-      0x90bf1d91, 0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de,
-      0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7, 0x136c9856,
-      0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
-      0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4,
-      0xa2677172, 0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b,
-      0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940, 0x32d86ce3,
-      0x45df5c75, 0xdcd60dcf, 0xabd13d59, 0x26d930ac, 0x51de003a,
-      0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423, 0xcfba9599,
-      0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
-      0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190,
-      0x01db7106, 0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f,
-      0x9fbfe4a5, 0xe8b8d433, 0x7807c9a2, 0x0f00f934, 0x9609a88e,
-      0xe10e9818, 0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01,
-      0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e, 0x6c0695ed,
-      0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
-      0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3,
-      0xfbd44c65, 0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2,
-      0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a,
-      0x346ed9fc, 0xad678846, 0xda60b8d0, 0x44042d73, 0x33031de5,
-      0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa, 0xbe0b1010,
-      0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
-      0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17,
-      0x2eb40d81, 0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6,
-      0x03b6e20c, 0x74b1d29a, 0xead54739, 0x9dd277af, 0x04db2615,
-      0x73dc1683, 0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8,
-      0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1, 0xf00f9344,
-      0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
-      0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a,
-      0x67dd4acc, 0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5,
-      0xd6d6a3e8, 0xa1d1937e, 0x38d8c2c4, 0x4fdff252, 0xd1bb67f1,
-      0xa6bc5767, 0x3fb506dd, 0x48b2364b, 0xd80d2bda, 0xaf0a1b4c,
-      0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55, 0x316e8eef,
-      0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
-      0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe,
-      0xb2bd0b28, 0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31,
-      0x2cd99e8b, 0x5bdeae1d, 0x9b64c2b0, 0xec63f226, 0x756aa39c,
-      0x026d930a, 0x9c0906a9, 0xeb0e363f, 0x72076785, 0x05005713,
-      0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38, 0x92d28e9b,
-      0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
-      0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1,
-      0x18b74777, 0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c,
-      0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45, 0xa00ae278,
-      0xd70dd2ee, 0x4e048354, 0x3903b3c2, 0xa7672661, 0xd06016f7,
-      0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc, 0x40df0b66,
-      0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
-      0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605,
-      0xcdd70693, 0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8,
-      0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b,
-      0x2d02ef8d
-    };
-  const bfd_byte *end;
-
-  crc = ~crc & 0xffffffff;
-  for (end = buf + len; buf < end; ++ buf)
-    crc = crc32_table[(crc ^ *buf) & 0xff] ^ (crc >> 8);
-  return ~crc & 0xffffffff;
-}
+  /* This is the CRC-32 of zlib, which is used when the processor
+     can't do better.  */
+#ifdef HAVE_PCLMUL_CRC
+  if (len >= 64 && have_pclmul ())
+    {
+      size_t n = len & ~(bfd_size_type) 15;
 
+      crc = ~crc32_pclmul (~crc, buf, n);
+      buf += n;
+      len -= n;
+    }
+#endif
+  while (len > 0)
+    {
+      uInt n = len > 0x40000000 ? 0x40000000 : (uInt) len;
 
-/* Extracts the filename and CRC32 value for any separate debug
-   information file associated with @var{abfd}.
+      crc = crc32 (crc, buf, n);
+      buf += n;
+      len -= n;
+    }
+  return crc;
+}
 
-   The @var{crc32_out} parameter is an untyped pointer because
-   this routine is used as a @code{get_func_type} function, but it
-   is expected to be a uint32_t pointer.
+/* Pieces of a buffer whose CRCs are found by crc_piece_range, to be
+   combined by crc_buffer.  */
+#define CRC_PIECE_SIZE (1024 * 1024)
 
-   Returns the filename of the associated debug information file,
-   or NULL if there is no such file.  If the filename was found
-   then the contents of @var{crc32_out} are updated to hold the
-   corresponding CRC32 value for the file.
+struct crc_job
+{
+  const bfd_byte *buf;
+  size_t len;
+  uint32_t *crcs;
+};
 
-   The returned filename is allocated with @code{malloc}; freeing
-   it is the responsibility of the caller.  */
+/* Find the CRCs of pieces START to END of the buffer of DATA, a
+   crc_job.  Worker for _bfd_parallel_for.  */
 
-static char *
-bfd_get_debug_link_info_1 (bfd *abfd, void *crc32_out)
+static bool
+crc_piece_range (void *data, size_t start, size_t end)
 {
-  asection *sect;
-  uint32_t *crc32 = crc32_out;
-  bfd_byte *contents;
-  unsigned int crc_offset;
-  char *name;
-  bfd_size_type size;
+  struct crc_job *job = (struct crc_job *) data;
+  size_t i;
 
-  BFD_ASSERT (abfd);
-  BFD_ASSERT (crc32_out);
+  for (i = start; i < end; i++)
+    {
+      size_t offset = i * CRC_PIECE_SIZE;
+      size_t len = job->len - offset;
 
-  sect = bfd_get_section_by_name (abfd, GNU_DEBUGLINK);
+      if (len > CRC_PIECE_SIZE)
+	len = CRC_PIECE_SIZE;
+      job->crcs[i] = bfd_calc_gnu_debuglink_crc32 (0, job->buf + offset, len);
+    }
+  return true;
+}
 
-  if (sect == NULL || (sect->flags & SEC_HAS_CONTENTS) == 0)
-    return NULL;
+/* Advance CRC over the LEN bytes at BUF, on several threads if
+   bfd_set_thread_count allows.  The pieces' CRCs are put together
+   with crc32_combine.  */
 
-  size = bfd_section_size (sect);
+static uint32_t
+crc_buffer (uint32_t crc, const bfd_byte *buf, size_t len)
+{
+  size_t npieces = (len + CRC_PIECE_SIZE - 1) / CRC_PIECE_SIZE;
+  struct crc_job job;
+  size_t i;
+
+  if (npieces < 2 || bfd_get_thread_count () < 2)
+    return bfd_calc_gnu_debuglink_crc32 (crc, buf, len);
+
+  job.buf = buf;
+  job.len = len;
+  job.crcs = bfd_malloc (npieces * sizeof (*job.crcs));
+  if (job.crcs == NULL)
+    return bfd_calc_gnu_debuglink_crc32 (crc, buf, len);
+  _bfd_parallel_for (npieces, 1, crc_piece_range, &job);
+  for (i = 0; i < npieces; i++)
+    {
+      size_t plen = len - i * CRC_PIECE_SIZE;
 
-  /* PR 22794: Make sure that the section has a reasonable size.  */
-  if (size < 8)
-    return NULL;
+      if (plen > CRC_PIECE_SIZE)
+	plen = CRC_PIECE_SIZE;
+      crc = crc32_combine (crc, job.crcs[i], plen);
+    }
+  free (job.crcs);
+  return crc;
+}
+
+/* Set *CRC to the .gnu_debuglink CRC of the rest of file F.  Return
+   FALSE on a read error.  */
+
+static bool
+file_debuglink_crc (FILE *f, uint32_t *crc)
+{
+  size_t size = (bfd_get_thread_count () > 1
+		 ? 16 * CRC_PIECE_SIZE : 256 * 1024);
+  bfd_byte *buffer = bfd_malloc (size);
+  size_t count;
+  bool ret;
+
+  if (buffer == NULL)
+    return false;
+  *crc = 0;
+  while ((count = fread (buffer, 1, size, f)) > 0)
+    *crc = crc_buffer (*crc, buffer, count);
+  ret = !ferror (f);
+  free (buffer);
+  return ret;
+}
+
+/* CRCs of separate debug files worked out for
+   separate_debug_file_exists, with what says the file hasn't changed
+   since.  */
+
+struct debuglink_crc
+{
+  struct debuglink_crc *next;
+  char *name;
+  uint64_t size;
+  int64_t mtime;
+  uint64_t ino;
+  uint64_t dev;
+  uint32_t crc;
+};
+
+static bfd_mutex debuglink_crc_lock = BFD_MUTEX_INIT;
+static struct debuglink_crc *debuglink_crcs;
+
+/* Set *CRC to the .gnu_debuglink CRC of file F, called NAME, from
+   the cache if the file is unchanged since it was last worked out.
+   Return FALSE on error.  */
+
+static bool
+cached_debuglink_crc (const char *name, FILE *f, uint32_t *crc)
+{
+  struct stat st;
+  struct debuglink_crc *entry;
+  bool have_stat = fstat (fileno (f), &st) == 0;
+
+  if (have_stat)
+    {
+      _bfd_mutex_lock (&debuglink_crc_lock);
+      for (entry = debuglink_crcs; entry != NULL; entry = entry->next)
+	if (strcmp (entry->name, name) == 0
+	    && entry->size == (uint64_t) st.st_size
+	    && entry->mtime == (int64_t) st.st_mtime
+	    && entry->ino == (uint64_t) st.st_ino
+	    && entry->dev == (uint64_t) st.st_dev)
+	  {
+	    *crc = entry->crc;
+	    break;
+	  }
+      _bfd_mutex_unlock (&debuglink_crc_lock);
+      if (entry != NULL)
+	return true;
+    }
+
+  if (!file_debuglink_crc (f, crc))
+    return false;
+
+  if (have_stat)
+    {
+      size_t len = strlen (name) + 1;
+
+      entry = bfd_malloc (sizeof (*entry) + len);
+      if (entry != NULL)
+	{
+	  entry->name = (char *) (entry + 1);
+	  memcpy (entry->name, name, len);
+	  entry->size = st.st_size;
+	  entry->mtime = st.st_mtime;
+	  entry->ino = st.st_ino;
+	  entry->dev = st.st_dev;
+	  entry->crc = *crc;
+	  _bfd_mutex_lock (&debuglink_crc_lock);
+	  entry->next = debuglink_crcs;
+	  debuglink_crcs = entry;
+	  _bfd_mutex_unlock (&debuglink_crc_lock);
+	}
+    }
+  return true;
+}
+
+
+/* Extracts the filename and CRC32 value for any separate debug
+   information file associated with @var{abfd}.
+
+   The @var{crc32_out} parameter is an untyped pointer because
+   this routine is used as a @code{get_func_type} function, but it
+   is expected to be a uint32_t pointer.
+
+   Returns the filename of the associated debug information file,
+   or NULL if there is no such file.  If the filename was found
+   then the contents of @var{crc32_out} are updated to hold the
+   corresponding CRC32 value for the file.
+
+   The returned filename is allocated with @code{malloc}; freeing
+   it is the responsibility of the caller.  */
+
+static char *
+bfd_get_debug_link_info_1 (bfd *abfd, void *crc32_out)
+{
+  asection *sect;
+  uint32_t *crc32 = crc32_out;
+  bfd_byte *contents;
+  unsigned int crc_offset;
+  char *name;
+  bfd_size_type size;
+
+  BFD_ASSERT (abfd);
+  BFD_ASSERT (crc32_out);
+
+  sect = bfd_get_section_by_name (abfd, GNU_DEBUGLINK);
+
+  if (sect == NULL || (sect->flags & SEC_HAS_CONTENTS) == 0)
+    return NULL;
+
+  size = bfd_section_size (sect);
+
+  /* PR 22794: Make sure that the section has a reasonable size.  */
+  if (size < 8)
+    return NULL;
 
   if (!bfd_malloc_and_get_section (abfd, sect, &contents))
     return NULL;
@@ -1330,10 +2116,9 @@ bfd_get_alt_debug_link_info (bfd * abfd, bfd_size_type *buildid_len,
 static bool
 separate_debug_file_exists (const char *name, void *crc32_p)
 {
-  unsigned char buffer[8 * 1024];
   uint32_t file_crc = 0;
   FILE *f;
-  bfd_size_type count;
+  bool ok;
   uint32_t crc;
 
   BFD_ASSERT (name);
@@ -1345,12 +2130,11 @@ separate_debug_file_exists (const char *name, void *crc32_p)
   if (f == NULL)
     return false;
 
-  while ((count = fread (buffer, 1, sizeof (buffer), f)) > 0)
-    file_crc = bfd_calc_gnu_debuglink_crc32 (file_crc, buffer, count);
+  ok = cached_debuglink_crc (name, f, &file_crc);
 
   fclose (f);
 
-  return crc == file_crc;
+  return ok && crc == file_crc;
 }
 
 /* Checks to see if @var{name} is a file.  */
@@ -1724,8 +2508,6 @@ bfd_fill_in_gnu_debuglink_section (bfd *abfd,
   char * contents;
   bfd_size_type crc_offset;
   FILE * handle;
-  unsigned char buffer[8 * 1024];
-  size_t count;
   size_t filelen;
 
   if (abfd == NULL || sect == NULL || filename == NULL)
@@ -1742,9 +2524,12 @@ bfd_fill_in_gnu_debuglink_section (bfd *abfd,
       return false;
     }
 
-  crc32 = 0;
-  while ((count = fread (buffer, 1, sizeof buffer, handle)) > 0)
-    crc32 = bfd_calc_gnu_debuglink_crc32 (crc32, buffer, count);
+  if (!file_debuglink_crc (handle, &crc32))
+    {
+      fclose (handle);
+      bfd_set_error (bfd_error_system_call);
+      return false;
+    }
   fclose (handle);
 
   /* Strip off any path components in filename,
@@ -2006,6 +2791,581 @@ bfd_follow_build_id_debuglink (bfd *abfd, const char *dir)
 				   check_build_id_file, &build_id);
 }
 
+/* A directory read by a bfd_debug_resolver, and the names in it.
+   NAMES is NULL if the directory couldn't be read.  */
+
+struct resolver_dir
+{
+  char *path;
+  htab_t names;
+};
+
+/* What a bfd_debug_resolver found for a lookup, NULL for nothing.  */
+
+struct resolver_result
+{
+  char *key;
+  char *path;
+};
+
+struct bfd_debug_resolver
+{
+  /* Serializes lookups.  */
+  bfd_mutex lock;
+
+  /* The global debug directories, tried in turn.  */
+  char **dirs;
+  unsigned int ndirs;
+
+  /* struct resolver_dir, by path.  */
+  htab_t listings;
+
+  /* struct resolver_result, by key.  */
+  htab_t results;
+};
+
+static hashval_t
+hash_resolver_dir (const void *p)
+{
+  return htab_hash_string (((const struct resolver_dir *) p)->path);
+}
+
+static int
+eq_resolver_dir (const void *a, const void *b)
+{
+  return strcmp (((const struct resolver_dir *) a)->path,
+		 ((const struct resolver_dir *) b)->path) == 0;
+}
+
+static void
+del_resolver_dir (void *p)
+{
+  struct resolver_dir *dir = (struct resolver_dir *) p;
+
+  if (dir->names != NULL)
+    htab_delete (dir->names);
+  free (dir->path);
+  free (dir);
+}
+
+static hashval_t
+hash_resolver_result (const void *p)
+{
+  return htab_hash_string (((const struct resolver_result *) p)->key);
+}
+
+static int
+eq_resolver_result (const void *a, const void *b)
+{
+  return strcmp (((const struct resolver_result *) a)->key,
+		 ((const struct resolver_result *) b)->key) == 0;
+}
+
+static void
+del_resolver_result (void *p)
+{
+  struct resolver_result *result = (struct resolver_result *) p;
+
+  free (result->key);
+  free (result->path);
+  free (result);
+}
+
+static int
+eq_string (const void *a, const void *b)
+{
+  return strcmp ((const char *) a, (const char *) b) == 0;
+}
+
+/*
+FUNCTION
+	bfd_create_debug_resolver
+
+SYNOPSIS
+	struct bfd_debug_resolver *bfd_create_debug_resolver (void);
+
+DESCRIPTION
+	Make an object that finds the separate debug files of BFDs as
+	<<bfd_follow_build_id_debuglink>>, <<bfd_follow_gnu_debuglink>>
+	and <<bfd_follow_gnu_debugaltlink>> do, but remembers what it
+	has seen.  Each directory it looks in is read once, and a
+	candidate file that isn't in the listing is never opened.  The
+	answer for each build-id or debug link, found or not, is kept
+	and given again without looking.  It may be used for any number
+	of BFDs and from several threads.  It doesn't notice files that
+	appear or go away after it has looked.  Returns NULL if memory
+	could not be allocated.
+*/
+
+struct bfd_debug_resolver *
+bfd_create_debug_resolver (void)
+{
+  struct bfd_debug_resolver *resolver;
+
+  resolver = bfd_zmalloc (sizeof (*resolver));
+  if (resolver == NULL)
+    return NULL;
+  resolver->listings = htab_create_alloc (16, hash_resolver_dir,
+					  eq_resolver_dir, del_resolver_dir,
+					  xcalloc, free);
+  resolver->results = htab_create_alloc (16, hash_resolver_result,
+					 eq_resolver_result,
+					 del_resolver_result, xcalloc, free);
+  if (resolver->listings == NULL || resolver->results == NULL)
+    {
+      bfd_free_debug_resolver (resolver);
+      bfd_set_error (bfd_error_no_memory);
+      return NULL;
+    }
+  return resolver;
+}
+
+/*
+FUNCTION
+	bfd_debug_resolver_add_dir
+
+SYNOPSIS
+	bool bfd_debug_resolver_add_dir
+	  (struct bfd_debug_resolver *resolver, const char *dir);
+
+DESCRIPTION
+	Search @var{dir} as well as any directories already added, as
+	the @var{dir} argument of <<bfd_follow_gnu_debuglink>> is
+	searched.  With no directories added the current directory is
+	used.  Answers already given are forgotten.  Returns
+	<<FALSE>> if memory could not be allocated.
+*/
+
+bool
+bfd_debug_resolver_add_dir (struct bfd_debug_resolver *resolver,
+			    const char *dir)
+{
+  char **dirs;
+  char *copy;
+
+  copy = bfd_malloc (strlen (dir) + 1);
+  if (copy == NULL)
+    return false;
+  strcpy (copy, dir);
+  _bfd_mutex_lock (&resolver->lock);
+  dirs = bfd_realloc (resolver->dirs,
+		      (resolver->ndirs + 1) * sizeof (*dirs));
+  if (dirs == NULL)
+    {
+      _bfd_mutex_unlock (&resolver->lock);
+      free (copy);
+      return false;
+    }
+  dirs[resolver->ndirs++] = copy;
+  resolver->dirs = dirs;
+  htab_empty (resolver->results);
+  _bfd_mutex_unlock (&resolver->lock);
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_free_debug_resolver
+
+SYNOPSIS
+	void bfd_free_debug_resolver (struct bfd_debug_resolver *resolver);
+
+DESCRIPTION
+	Free @var{resolver}, which may be NULL.
+*/
+
+void
+bfd_free_debug_resolver (struct bfd_debug_resolver *resolver)
+{
+  unsigned int i;
+
+  if (resolver == NULL)
+    return;
+  if (resolver->listings != NULL)
+    htab_delete (resolver->listings);
+  if (resolver->results != NULL)
+    htab_delete (resolver->results);
+  for (i = 0; i < resolver->ndirs; i++)
+    free (resolver->dirs[i]);
+  free (resolver->dirs);
+  _bfd_mutex_destroy (&resolver->lock);
+  free (resolver);
+}
+
+/* Return the names in directory PATH, reading it if RESOLVER hasn't
+   yet, or NULL if it can't be read.  */
+
+static htab_t
+resolver_listing (struct bfd_debug_resolver *resolver, const char *path)
+{
+  struct resolver_dir key, *dir;
+  void **slot;
+  DIR *d;
+  struct dirent *ent;
+
+  key.path = (char *) path;
+  slot = htab_find_slot (resolver->listings, &key, INSERT);
+  if (slot == NULL)
+    return NULL;
+  if (*slot != NULL)
+    return ((struct resolver_dir *) *slot)->names;
+
+  dir = bfd_zmalloc (sizeof (*dir));
+  if (dir == NULL)
+    {
+      htab_clear_slot (resolver->listings, slot);
+      return NULL;
+    }
+  dir->path = xstrdup (path);
+  *slot = dir;
+
+  d = opendir (path[0] != '\0' ? path : ".");
+  if (d == NULL)
+    return NULL;
+  dir->names = htab_create_alloc (16, htab_hash_string, eq_string, free,
+				  xcalloc, free);
+  while ((ent = readdir (d)) != NULL)
+    {
+      slot = htab_find_slot (dir->names, ent->d_name, INSERT);
+      if (slot != NULL && *slot == NULL)
+	*slot = xstrdup (ent->d_name);
+    }
+  closedir (d);
+  return dir->names;
+}
+
+/* Say whether NAME is in the listing of its directory.  */
+
+static bool
+resolver_file_listed (struct bfd_debug_resolver *resolver, const char *name)
+{
+  size_t len;
+  char *dir;
+  htab_t names;
+
+  for (len = strlen (name); len > 0; len--)
+    if (IS_DIR_SEPARATOR (name[len - 1]))
+      break;
+  dir = bfd_malloc (len + 1);
+  if (dir == NULL)
+    return true;
+  memcpy (dir, name, len);
+  dir[len] = '\0';
+  names = resolver_listing (resolver, dir);
+  free (dir);
+  return (names != NULL
+	  && htab_find (names, name + len) != NULL);
+}
+
+/* The check function of a lookup by a bfd_debug_resolver, wrapped by
+   resolver_check.  */
+
+struct resolver_check_data
+{
+  struct bfd_debug_resolver *resolver;
+  check_func_type check;
+  void *data;
+};
+
+/* Check NAME with the check function in DATA, a
+   resolver_check_data, if it is in its directory.  */
+
+static bool
+resolver_check (const char *name, void *data)
+{
+  struct resolver_check_data *d = (struct resolver_check_data *) data;
+
+  return (resolver_file_listed (d->resolver, name)
+	  && d->check (name, d->data));
+}
+
+/* Find the debug file of ABFD through RESOLVER, keeping the answer
+   under KEY, which is freed.  The other arguments are as for
+   find_separate_debug_file.  */
+
+static char *
+resolver_find (struct bfd_debug_resolver *resolver, bfd *abfd, char *key,
+	       bool include_dirs, get_func_type get_func,
+	       check_func_type check_func, void *func_data)
+{
+  struct resolver_result look, *result;
+  struct resolver_check_data data;
+  char *path = NULL;
+  unsigned int i;
+  void **slot;
+
+  if (key == NULL)
+    return NULL;
+
+  _bfd_mutex_lock (&resolver->lock);
+  look.key = key;
+  result = htab_find (resolver->results, &look);
+  if (result != NULL)
+    {
+      if (result->path != NULL)
+	path = xstrdup (result->path);
+      _bfd_mutex_unlock (&resolver->lock);
+      free (key);
+      return path;
+    }
+
+  data.resolver = resolver;
+  data.check = check_func;
+  data.data = func_data;
+  i = 0;
+  do
+    path = find_separate_debug_file (abfd,
+				     i < resolver->ndirs
+				     ? resolver->dirs[i] : NULL,
+				     include_dirs, get_func,
+				     resolver_check, &data);
+  while (path == NULL && ++i < resolver->ndirs);
+
+  slot = htab_find_slot (resolver->results, &look, INSERT);
+  result = slot != NULL ? bfd_malloc (sizeof (*result)) : NULL;
+  if (result != NULL)
+    {
+      result->key = key;
+      result->path = path != NULL ? xstrdup (path) : NULL;
+      *slot = result;
+      key = NULL;
+    }
+  else if (slot != NULL)
+    htab_clear_slot (resolver->results, slot);
+  _bfd_mutex_unlock (&resolver->lock);
+  free (key);
+  return path;
+}
+
+/* Return a key for a lookup of KIND in ABFD, made of ABFD's name and
+   NAME, which the function returning it should have malloc'd and is
+   freed, and CRC.  */
+
+static char *
+resolver_link_key (char kind, bfd *abfd, char *name, uint32_t crc)
+{
+  const char *filename = bfd_get_filename (abfd);
+  char *key;
+
+  if (name == NULL || filename == NULL)
+    {
+      free (name);
+      return NULL;
+    }
+  key = bfd_malloc (strlen (filename) + strlen (name) + 13);
+  if (key != NULL)
+    sprintf (key, "%c%08x%s\n%s", kind, (unsigned int) crc, filename, name);
+  free (name);
+  return key;
+}
+
+/*
+FUNCTION
+	bfd_debug_resolver_follow_build_id
+
+SYNOPSIS
+	char *bfd_debug_resolver_follow_build_id
+	  (struct bfd_debug_resolver *resolver, bfd *abfd);
+
+DESCRIPTION
+	Like <<bfd_follow_build_id_debuglink>>, but search the
+	directories of @var{resolver}, and remember the answer for
+	the build-id of @var{abfd}.
+*/
+
+char *
+bfd_debug_resolver_follow_build_id (struct bfd_debug_resolver *resolver,
+				    bfd *abfd)
+{
+  struct bfd_build_id *build_id;
+  char *key;
+  bfd_size_type i;
+
+  if (bfd_get_filename (abfd) == NULL)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return NULL;
+    }
+  build_id = get_build_id (abfd);
+  if (build_id == NULL)
+    return NULL;
+  key = bfd_malloc (build_id->size * 2 + 2);
+  if (key == NULL)
+    return NULL;
+  key[0] = 'B';
+  for (i = 0; i < build_id->size; i++)
+    sprintf (key + 1 + i * 2, "%02x", (unsigned) build_id->data[i]);
+  return resolver_find (resolver, abfd, key, false, get_build_id_name,
+			check_build_id_file, &build_id);
+}
+
+/*
+FUNCTION
+	bfd_debug_resolver_follow_debuglink
+
+SYNOPSIS
+	char *bfd_debug_resolver_follow_debuglink
+	  (struct bfd_debug_resolver *resolver, bfd *abfd);
+
+DESCRIPTION
+	Like <<bfd_follow_gnu_debuglink>>, but search the directories
+	of @var{resolver}, and remember the answer for the file name
+	of @var{abfd} and the name and CRC in its .gnu_debuglink.
+*/
+
+char *
+bfd_debug_resolver_follow_debuglink (struct bfd_debug_resolver *resolver,
+				     bfd *abfd)
+{
+  uint32_t crc32 = 0;
+  char *name = bfd_get_debug_link_info_1 (abfd, &crc32);
+
+  return resolver_find (resolver, abfd,
+			resolver_link_key ('L', abfd, name, crc32),
+			true, bfd_get_debug_link_info_1,
+			separate_debug_file_exists, &crc32);
+}
+
+/*
+FUNCTION
+	bfd_debug_resolver_follow_debugaltlink
+
+SYNOPSIS
+	char *bfd_debug_resolver_follow_debugaltlink
+	  (struct bfd_debug_resolver *resolver, bfd *abfd);
+
+DESCRIPTION
+	Like <<bfd_follow_gnu_debugaltlink>>, but search the
+	directories of @var{resolver}, and remember the answer for the
+	file name of @var{abfd} and the name in its .gnu_debugaltlink.
+*/
+
+char *
+bfd_debug_resolver_follow_debugaltlink (struct bfd_debug_resolver *resolver,
+					bfd *abfd)
+{
+  char *name = get_alt_debug_link_info_shim (abfd, NULL);
+
+  return resolver_find (resolver, abfd,
+			resolver_link_key ('A', abfd, name, 0),
+			true, get_alt_debug_link_info_shim,
+			separate_alt_debug_file_exists, NULL);
+}
+
+/* The directory line indexes are kept in, or NULL if they aren't
+   used.  */
+static char *line_index_dir;
+
+/*
+FUNCTION
+	bfd_set_line_index_dir
+
+SYNOPSIS
+	bool bfd_set_line_index_dir (const char *dir);
+
+DESCRIPTION
+	Keep line indexes in the directory @var{dir}, or stop using
+	them if @var{dir} is NULL, the default.  A line index records
+	what the DWARF debugging information of an executable or
+	shared library says about each address, so that
+	<<bfd_find_nearest_line>> can answer from it without decoding
+	the information again.  The first address lookup in a file
+	with a build-id and no index builds and writes one, named for
+	the build-id; later opens of that file, in any process, map it.
+	The directory must already exist.  This should be called before
+	BFDs are in use on other threads.  Returns <<FALSE>> if memory
+	for the name could not be allocated.
+*/
+
+bool
+bfd_set_line_index_dir (const char *dir)
+{
+  char *copy = NULL;
+
+  if (dir != NULL)
+    {
+      copy = bfd_malloc (strlen (dir) + 1);
+      if (copy == NULL)
+	return false;
+      strcpy (copy, dir);
+    }
+  free (line_index_dir);
+  line_index_dir = copy;
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_get_line_index_dir
+
+SYNOPSIS
+	const char *bfd_get_line_index_dir (void);
+
+DESCRIPTION
+	Return the directory set by <<bfd_set_line_index_dir>>, or NULL
+	if line indexes are not in use.
+*/
+
+const char *
+bfd_get_line_index_dir (void)
+{
+  return line_index_dir;
+}
+
+/* The most memory, in bytes, the decoded tables of DWARF compilation
+   units may use in each file before some are dropped.  Zero means
+   there is no limit.  */
+static bfd_size_type dwarf_memory_budget;
+
+/*
+FUNCTION
+	bfd_set_dwarf_memory_budget
+
+SYNOPSIS
+	bfd_size_type bfd_set_dwarf_memory_budget (bfd_size_type size);
+
+DESCRIPTION
+	Limit the memory the line tables, functions and variables
+	decoded from the DWARF compilation units of a file may use to
+	about @var{size} bytes, or lift the limit if @var{size} is
+	zero, the default.  When a lookup by
+	<<bfd_find_nearest_line>> would go over the limit, the units
+	used least recently drop their tables, keeping only their
+	address ranges, and decode them again if they are needed.
+	With a limit, the file and function names returned by one
+	lookup may be freed by a later lookup in the same file, so
+	callers must copy them if they are wanted for longer.  This
+	should be called before BFDs are in use on other threads.
+	Returns the previous limit.
+*/
+
+bfd_size_type
+bfd_set_dwarf_memory_budget (bfd_size_type size)
+{
+  bfd_size_type old = dwarf_memory_budget;
+
+  dwarf_memory_budget = size;
+  return old;
+}
+
+/*
+FUNCTION
+	bfd_get_dwarf_memory_budget
+
+SYNOPSIS
+	bfd_size_type bfd_get_dwarf_memory_budget (void);
+
+DESCRIPTION
+	Return the limit set by <<bfd_set_dwarf_memory_budget>>, or
+	zero if there is none.
+*/
+
+bfd_size_type
+bfd_get_dwarf_memory_budget (void)
+{
+  return dwarf_memory_budget;
+}
+
 /*
 FUNCTION
 	bfd_set_filename
@@ -0,0 +1,1223 @@
+/* Indexed access to the import, export, exception and resource
+   tables of PE images.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/*
+SECTION
+	PE import, export, exception and resource tables
+
+	Tools that resolve the imports of Windows executables and DLLs
+	against the exports of other DLLs need the export directory
+	and the import directories of each image in a form they can
+	search, rather than as the symbols of the COFF symbol table.
+	BFD decodes them from a PE image the first time they are asked
+	for, reading the tables through section contents views so that
+	a mapped image is not copied, and keeps an index of them in the
+	memory of the BFD.
+
+	Exports are sorted by name, with those exported only by ordinal
+	after them in ordinal order, and can be looked up by name
+	through a hash table or by ordinal directly.  Imports are kept
+	in the order of the import directory, so that those from each
+	DLL are together, and can be looked up by DLL and name.  DLL
+	names are compared without regard to case, as Windows does.
+	Names point into the section contents of the BFD and last as
+	long as it does.
+
+	The function table of the exception directory of an x86-64
+	image, the <<.pdata>> section, is checked and kept sorted by
+	address, so that a profiler or debugger can find the unwind
+	information for an address with a binary search.  The
+	UNWIND_INFO structure found is decoded into a
+	<<bfd_pe_unwind>>, whose unwind codes point into the section
+	contents of the BFD.
+
+	Resources are looked up by type, name and language in the
+	resource directory itself, the <<.rsrc>> section, without
+	building a tree of it.  Integer IDs are found by a binary
+	search, since Windows requires them to be sorted, and names
+	by comparing each name of the directory.
+
+.typedef struct bfd_pe_export
+.{
+.  {* The exported name, or NULL if the entry is exported by ordinal
+.     only.  *}
+.  const char *name;
+.
+.  {* The ordinal, with the ordinal base of the directory added.  *}
+.  unsigned int ordinal;
+.
+.  {* The RVA the export address table gives for the entry.  *}
+.  bfd_vma rva;
+.
+.  {* For a forwarded export, the "DLL.name" or "DLL.#ordinal" it
+.     forwards to, otherwise NULL.  *}
+.  const char *forwarder;
+.}
+.bfd_pe_export;
+.
+.typedef struct bfd_pe_import
+.{
+.  {* The DLL the entry is imported from.  *}
+.  const char *dll;
+.
+.  {* The imported name, or NULL if the entry is imported by
+.     ordinal.  *}
+.  const char *name;
+.
+.  {* The ordinal for an import by ordinal, otherwise the hint into
+.     the export name table of the DLL.  *}
+.  unsigned int ordinal;
+.
+.  {* The RVA of the entry's slot in the import address table.  *}
+.  bfd_vma iat_rva;
+.}
+.bfd_pe_import;
+.
+.typedef struct bfd_pe_unwind
+.{
+.  {* The function the entry covers, from BEGIN up to but not
+.     including END, as RVAs.  *}
+.  bfd_vma begin;
+.  bfd_vma end;
+.
+.  {* The RVA of the UNWIND_INFO of the function.  *}
+.  bfd_vma unwind_rva;
+.
+.  {* The fields of the UNWIND_INFO header.  FLAGS is a mask of the
+.     UNW_FLAG_* values of coff/pe.h, and FRAME_OFFSET is scaled to
+.     bytes.  *}
+.  unsigned int version;
+.  unsigned int flags;
+.  unsigned int prolog_size;
+.  unsigned int frame_register;
+.  unsigned int frame_offset;
+.
+.  {* The unwind codes, CODE_COUNT slots of two bytes each.  *}
+.  unsigned int code_count;
+.  const bfd_byte *codes;
+.
+.  {* If FLAGS has UNW_FLAG_EHANDLER or UNW_FLAG_UHANDLER, the RVA
+.     of the language handler and its data, which follows it.  *}
+.  bfd_vma handler_rva;
+.  const bfd_byte *handler_data;
+.
+.  {* Whether the unwind codes of the function continue with those
+.     of another function, covering PARENT_BEGIN up to PARENT_END.
+.     Its own information is found by looking up PARENT_BEGIN.  *}
+.  bool chained;
+.  bfd_vma parent_begin;
+.  bfd_vma parent_end;
+.}
+.bfd_pe_unwind;
+.
+.typedef struct bfd_pe_resource_id
+.{
+.  {* The name to match, or NULL to match the integer ID.  *}
+.  const char *name;
+.  unsigned int id;
+.}
+.bfd_pe_resource_id;
+.
+.typedef struct bfd_pe_resource
+.{
+.  {* The language of the resource found.  *}
+.  unsigned int language;
+.
+.  {* The RVA, size and code page of the data of the resource.  *}
+.  bfd_vma rva;
+.  bfd_size_type size;
+.  unsigned int codepage;
+.
+.  {* The data, pointing into the section contents of the BFD.  *}
+.  const bfd_byte *data;
+.}
+.bfd_pe_resource;
+.
+*/
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libbfd.h"
+#include "coff/internal.h"
+#include "libcoff.h"
+#include "coff/x86_64.h"
+#include "coff/pe.h"
+#include "hashtab.h"
+#include "safe-ctype.h"
+
+/* The optional header magic of PE32+ images, whose import lookup
+   tables have 64-bit entries.  */
+#define PE_PE32PLUS_MAGIC 0x20b
+
+/* An entry of the function table, with its UNWIND_INFO checked to
+   lie within its section.  */
+
+struct pe_function
+{
+  bfd_vma begin;
+  bfd_vma end;
+  bfd_vma unwind_rva;
+  const bfd_byte *unwind;
+};
+
+/* The import, export and function index of a BFD, in its memory.
+   Each hash table has a power of two number of slots, holding one
+   more than the index of an entry, or zero for an empty slot.  */
+
+struct bfd_pe_index
+{
+  bool exports_done;
+  bfd_pe_export *exports;
+  size_t nexports;
+  size_t nnamed;
+  unsigned int *export_hash;
+  size_t export_hash_mask;
+  unsigned int ordinal_base;
+  unsigned int nordinals;
+  unsigned int *by_ordinal;
+
+  bool imports_done;
+  bfd_pe_import *imports;
+  size_t nimports;
+  unsigned int *import_hash;
+  size_t import_hash_mask;
+
+  bool functions_done;
+  struct pe_function *functions;
+  size_t nfunctions;
+
+  bool resources_done;
+  const bfd_byte *resources;
+  bfd_size_type resources_size;
+};
+
+/* The image being read, with the section the last RVA was found in.  */
+
+struct pe_image
+{
+  bfd *abfd;
+  bfd_vma image_base;
+  asection *sec;
+  const bfd_byte *contents;
+};
+
+/* Return a pointer to the SIZE bytes at RVA in IMG, or NULL if they
+   aren't all in one section with contents.  */
+
+static const bfd_byte *
+pe_rva_ptr (struct pe_image *img, bfd_vma rva, bfd_size_type size)
+{
+  bfd_vma vma = img->image_base + rva;
+  asection *sec = img->sec;
+
+  if (sec == NULL || vma < sec->vma || vma - sec->vma >= sec->size)
+    {
+      for (sec = img->abfd->sections; sec != NULL; sec = sec->next)
+	if ((sec->flags & SEC_HAS_CONTENTS) != 0
+	    && vma >= sec->vma
+	    && vma - sec->vma < sec->size)
+	  break;
+      if (sec == NULL
+	  || !bfd_get_section_contents_view (img->abfd, sec, &img->contents)
+	  || img->contents == NULL)
+	{
+	  img->sec = NULL;
+	  return NULL;
+	}
+      img->sec = sec;
+    }
+  if (size > sec->size - (vma - sec->vma))
+    return NULL;
+  return img->contents + (vma - sec->vma);
+}
+
+/* Return the NUL-terminated string at RVA in IMG, or NULL if it
+   isn't terminated within its section.  */
+
+static const char *
+pe_rva_string (struct pe_image *img, bfd_vma rva)
+{
+  const bfd_byte *p = pe_rva_ptr (img, rva, 1);
+  asection *sec = img->sec;
+
+  if (p == NULL
+      || memchr (p, 0, sec->size - (img->image_base + rva - sec->vma)) == NULL)
+    return NULL;
+  return (const char *) p;
+}
+
+/* Hash the DLL name NAME without regard to case.  */
+
+static hashval_t
+pe_dll_hash (const char *name)
+{
+  hashval_t h = 0;
+
+  while (*name != 0)
+    h = h * 67 + TOLOWER (*name++) - 113;
+  return h;
+}
+
+static hashval_t
+pe_import_hash (const char *dll, const char *name)
+{
+  return htab_hash_string (name) ^ (pe_dll_hash (dll) * 31);
+}
+
+/* Return TRUE if ABFD is a PE image whose tables can be read.  */
+
+static bool
+pe_index_p (bfd *abfd)
+{
+  if (bfd_get_flavour (abfd) != bfd_target_coff_flavour
+      || abfd->format != bfd_object
+      || !bfd_pei_p (abfd)
+      || pe_data (abfd) == NULL)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+  return true;
+}
+
+/* Return the index of ABFD, allocating it if this is the first time
+   it is asked for.  */
+
+static struct bfd_pe_index *
+pe_get_index (bfd *abfd)
+{
+  struct bfd_pe_index *idx;
+
+  if (!pe_index_p (abfd))
+    return NULL;
+  idx = pe_data (abfd)->pe_index;
+  if (idx == NULL)
+    {
+      idx = (struct bfd_pe_index *) bfd_zalloc (abfd, sizeof (*idx));
+      pe_data (abfd)->pe_index = idx;
+    }
+  return idx;
+}
+
+/* Return the number of hash slots for COUNT entries, less one.  */
+
+static size_t
+pe_hash_mask (size_t count)
+{
+  size_t n = 16;
+
+  while (n < count * 2)
+    n *= 2;
+  return n - 1;
+}
+
+static int
+pe_export_compare (const void *a, const void *b)
+{
+  const bfd_pe_export *ea = (const bfd_pe_export *) a;
+  const bfd_pe_export *eb = (const bfd_pe_export *) b;
+  int cmp;
+
+  if (ea->name != NULL && eb->name != NULL)
+    {
+      cmp = strcmp (ea->name, eb->name);
+      if (cmp != 0)
+	return cmp;
+    }
+  else if (ea->name != NULL || eb->name != NULL)
+    return ea->name != NULL ? -1 : 1;
+  if (ea->ordinal != eb->ordinal)
+    return ea->ordinal < eb->ordinal ? -1 : 1;
+  return 0;
+}
+
+/* Decode the export directory of ABFD into IDX.  */
+
+static bool
+pe_build_exports (bfd *abfd, struct bfd_pe_index *idx)
+{
+  struct internal_extra_pe_aouthdr *extra = &pe_data (abfd)->pe_opthdr;
+  bfd_vma dir_rva = extra->DataDirectory[PE_EXPORT_TABLE].VirtualAddress;
+  bfd_vma dir_size = extra->DataDirectory[PE_EXPORT_TABLE].Size;
+  struct pe_image img;
+  const bfd_byte *dir, *eat, *npt, *ot;
+  unsigned int nfuncs, nnames, i;
+  bfd_vma eat_rva, npt_rva, ot_rva;
+  bfd_pe_export *exports;
+  unsigned char *named = NULL;
+  size_t n = 0, k, amt;
+
+  if (dir_rva == 0 && dir_size == 0)
+    return true;
+
+  img.abfd = abfd;
+  img.image_base = extra->ImageBase;
+  img.sec = NULL;
+  img.contents = NULL;
+  dir = pe_rva_ptr (&img, dir_rva, 40);
+  if (dir == NULL)
+    goto bad;
+
+  idx->ordinal_base = bfd_get_32 (abfd, dir + 16);
+  nfuncs = bfd_get_32 (abfd, dir + 20);
+  nnames = bfd_get_32 (abfd, dir + 24);
+  eat_rva = bfd_get_32 (abfd, dir + 28);
+  npt_rva = bfd_get_32 (abfd, dir + 32);
+  ot_rva = bfd_get_32 (abfd, dir + 36);
+
+  /* The tables must lie within their sections, which bounds the
+     counts by the size of the file.  */
+  eat = pe_rva_ptr (&img, eat_rva, (bfd_size_type) nfuncs * 4);
+  if (eat == NULL && nfuncs != 0)
+    goto bad;
+  npt = pe_rva_ptr (&img, npt_rva, (bfd_size_type) nnames * 4);
+  if (npt == NULL && nnames != 0)
+    goto bad;
+  ot = pe_rva_ptr (&img, ot_rva, (bfd_size_type) nnames * 2);
+  if (ot == NULL && nnames != 0)
+    goto bad;
+
+  /* The pointers above may be to separate views, but the views stay
+     put, so they remain valid as others are taken.  */
+  if (_bfd_mul_overflow ((size_t) nfuncs + nnames, sizeof (*exports), &amt))
+    goto bad;
+  exports = (bfd_pe_export *) bfd_alloc (abfd, amt);
+  named = (unsigned char *) bfd_zmalloc (nfuncs + 1);
+  if (exports == NULL || named == NULL)
+    {
+      free (named);
+      return false;
+    }
+
+  for (i = 0; i < nnames; i++)
+    {
+      unsigned int ord = bfd_get_16 (abfd, ot + i * 2);
+      const char *name = pe_rva_string (&img, bfd_get_32 (abfd, npt + i * 4));
+
+      if (name == NULL || ord >= nfuncs)
+	continue;
+      exports[n].name = name;
+      exports[n].ordinal = idx->ordinal_base + ord;
+      exports[n].rva = bfd_get_32 (abfd, eat + ord * 4);
+      named[ord] = 1;
+      n++;
+    }
+  idx->nnamed = n;
+  for (i = 0; i < nfuncs; i++)
+    {
+      bfd_vma rva = bfd_get_32 (abfd, eat + i * 4);
+
+      if (rva == 0 || named[i])
+	continue;
+      exports[n].name = NULL;
+      exports[n].ordinal = idx->ordinal_base + i;
+      exports[n].rva = rva;
+      n++;
+    }
+  free (named);
+
+  /* An address inside the export directory is a forwarder string.  */
+  for (k = 0; k < n; k++)
+    exports[k].forwarder = (exports[k].rva >= dir_rva
+			    && exports[k].rva - dir_rva < dir_size
+			    ? pe_rva_string (&img, exports[k].rva) : NULL);
+
+  qsort (exports, n, sizeof (*exports), pe_export_compare);
+
+  idx->export_hash_mask = pe_hash_mask (idx->nnamed);
+  idx->export_hash = (unsigned int *) bfd_zalloc (abfd,
+						  (idx->export_hash_mask + 1)
+						  * sizeof (unsigned int));
+  idx->by_ordinal = (unsigned int *) bfd_zalloc (abfd, ((size_t) nfuncs + 1)
+						 * sizeof (unsigned int));
+  if (idx->export_hash == NULL || idx->by_ordinal == NULL)
+    return false;
+
+  for (k = 0; k < idx->nnamed; k++)
+    {
+      size_t h = htab_hash_string (exports[k].name) & idx->export_hash_mask;
+
+      while (idx->export_hash[h] != 0)
+	h = (h + 1) & idx->export_hash_mask;
+      idx->export_hash[h] = k + 1;
+    }
+  for (k = 0; k < n; k++)
+    {
+      unsigned int ord = exports[k].ordinal - idx->ordinal_base;
+
+      if (idx->by_ordinal[ord] == 0)
+	idx->by_ordinal[ord] = k + 1;
+    }
+  idx->nordinals = nfuncs;
+  idx->exports = exports;
+  idx->nexports = n;
+  return true;
+
+ bad:
+  bfd_set_error (bfd_error_bad_value);
+  return false;
+}
+
+/* Decode the import directories of ABFD into IDX.  */
+
+static bool
+pe_build_imports (bfd *abfd, struct bfd_pe_index *idx)
+{
+  struct internal_extra_pe_aouthdr *extra = &pe_data (abfd)->pe_opthdr;
+  bfd_vma dir_rva = extra->DataDirectory[PE_IMPORT_TABLE].VirtualAddress;
+  unsigned int thunk_size = extra->Magic == PE_PE32PLUS_MAGIC ? 8 : 4;
+  struct pe_image img;
+  bfd_pe_import *imports = NULL;
+  size_t n = 0, alloced = 0, k;
+  bfd_vma desc_rva;
+
+  if (dir_rva == 0)
+    return true;
+
+  img.abfd = abfd;
+  img.image_base = extra->ImageBase;
+  img.sec = NULL;
+  img.contents = NULL;
+
+  for (desc_rva = dir_rva; ; desc_rva += 20)
+    {
+      const bfd_byte *desc = pe_rva_ptr (&img, desc_rva, 20);
+      bfd_vma lookup_rva, iat_rva, thunk_rva;
+      const char *dll;
+
+      if (desc == NULL)
+	break;
+      lookup_rva = bfd_get_32 (abfd, desc);
+      iat_rva = bfd_get_32 (abfd, desc + 16);
+      if (lookup_rva == 0 && iat_rva == 0)
+	break;
+      dll = pe_rva_string (&img, bfd_get_32 (abfd, desc + 12));
+      if (dll == NULL)
+	continue;
+
+      /* Without a lookup table the names are read from the import
+	 address table, which is only right if it isn't bound.  */
+      if (lookup_rva == 0)
+	lookup_rva = iat_rva;
+
+      for (thunk_rva = lookup_rva; ; thunk_rva += thunk_size)
+	{
+	  const bfd_byte *thunk = pe_rva_ptr (&img, thunk_rva, thunk_size);
+	  uint64_t entry;
+	  bfd_pe_import *imp;
+
+	  if (thunk == NULL)
+	    break;
+	  entry = (thunk_size == 8
+		   ? bfd_get_64 (abfd, thunk) : bfd_get_32 (abfd, thunk));
+	  if (entry == 0)
+	    break;
+
+	  if (n == alloced)
+	    {
+	      alloced = alloced != 0 ? alloced * 2 : 64;
+	      imp = (bfd_pe_import *) bfd_realloc (imports,
+						   alloced * sizeof (*imp));
+	      if (imp == NULL)
+		{
+		  free (imports);
+		  return false;
+		}
+	      imports = imp;
+	    }
+	  imp = &imports[n];
+	  imp->dll = dll;
+	  imp->iat_rva = iat_rva + (thunk_rva - lookup_rva);
+	  if ((entry >> (thunk_size * 8 - 1)) != 0)
+	    {
+	      imp->name = NULL;
+	      imp->ordinal = entry & 0xffff;
+	    }
+	  else
+	    {
+	      const bfd_byte *hint = pe_rva_ptr (&img, entry & 0x7fffffff, 2);
+
+	      if (hint == NULL)
+		continue;
+	      imp->ordinal = bfd_get_16 (abfd, hint);
+	      imp->name = pe_rva_string (&img, (entry & 0x7fffffff) + 2);
+	      if (imp->name == NULL)
+		continue;
+	    }
+	  n++;
+	}
+    }
+
+  idx->import_hash_mask = pe_hash_mask (n);
+  idx->import_hash = (unsigned int *) bfd_zalloc (abfd,
+						  (idx->import_hash_mask + 1)
+						  * sizeof (unsigned int));
+  idx->imports = (bfd_pe_import *) bfd_alloc (abfd, n * sizeof (*imports));
+  if (idx->import_hash == NULL || (idx->imports == NULL && n != 0))
+    {
+      free (imports);
+      return false;
+    }
+  if (n != 0)
+    memcpy (idx->imports, imports, n * sizeof (*imports));
+  free (imports);
+
+  for (k = 0; k < n; k++)
+    if (idx->imports[k].name != NULL)
+      {
+	size_t h = (pe_import_hash (idx->imports[k].dll, idx->imports[k].name)
+		    & idx->import_hash_mask);
+
+	while (idx->import_hash[h] != 0)
+	  h = (h + 1) & idx->import_hash_mask;
+	idx->import_hash[h] = k + 1;
+      }
+  idx->nimports = n;
+  return true;
+}
+
+/* Return the UNWIND_INFO at RVA in IMG, or NULL if it has a version
+   we don't know or doesn't fit in its section.  */
+
+static const bfd_byte *
+pe_unwind_ptr (struct pe_image *img, bfd_vma rva)
+{
+  const bfd_byte *ui = pe_rva_ptr (img, rva, 4);
+  unsigned int version, flags;
+  bfd_size_type size;
+
+  if (ui == NULL)
+    return NULL;
+  version = PEX64_UWI_VERSION (ui[0]);
+  flags = PEX64_UWI_FLAGS (ui[0]);
+  if (version != 1 && version != 2)
+    return NULL;
+  size = 4 + PEX64_UWI_SIZEOF_UWCODE_ARRAY (ui[2]);
+  if ((flags & (UNW_FLAG_EHANDLER | UNW_FLAG_UHANDLER)) != 0)
+    size += 4;
+  else if ((flags & UNW_FLAG_CHAININFO) != 0)
+    size += 12;
+  return pe_rva_ptr (img, rva, size);
+}
+
+static int
+pe_function_compare (const void *a, const void *b)
+{
+  const struct pe_function *fa = (const struct pe_function *) a;
+  const struct pe_function *fb = (const struct pe_function *) b;
+
+  if (fa->begin != fb->begin)
+    return fa->begin < fb->begin ? -1 : 1;
+  if (fa->end != fb->end)
+    return fa->end < fb->end ? -1 : 1;
+  return 0;
+}
+
+/* Decode the function table of ABFD into IDX, leaving out entries
+   that are empty, overlap an earlier one, or whose unwind information
+   can't be read.  */
+
+static bool
+pe_build_functions (bfd *abfd, struct bfd_pe_index *idx)
+{
+  struct internal_extra_pe_aouthdr *extra = &pe_data (abfd)->pe_opthdr;
+  bfd_vma dir_rva = extra->DataDirectory[PE_EXCEPTION_TABLE].VirtualAddress;
+  bfd_vma dir_size = extra->DataDirectory[PE_EXCEPTION_TABLE].Size;
+  struct pe_image img;
+  const bfd_byte *pdata;
+  struct pe_function *funcs;
+  size_t count, n = 0, k, amt;
+  bool sorted = true;
+
+  /* Other machines lay out the table differently.  */
+  if (bfd_get_arch (abfd) != bfd_arch_i386
+      || (bfd_get_mach (abfd) & bfd_mach_x86_64) == 0)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+  if (dir_rva == 0 || dir_size == 0)
+    return true;
+
+  img.abfd = abfd;
+  img.image_base = extra->ImageBase;
+  img.sec = NULL;
+  img.contents = NULL;
+  count = dir_size / 12;
+  pdata = pe_rva_ptr (&img, dir_rva, (bfd_size_type) count * 12);
+  if (pdata == NULL)
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+  if (_bfd_mul_overflow (count, sizeof (*funcs), &amt))
+    {
+      bfd_set_error (bfd_error_file_too_big);
+      return false;
+    }
+  funcs = (struct pe_function *) bfd_alloc (abfd, amt);
+  if (funcs == NULL && count != 0)
+    return false;
+
+  for (k = 0; k < count; k++)
+    {
+      const bfd_byte *rf = pdata + k * 12;
+      bfd_vma begin = bfd_get_32 (abfd, rf);
+      bfd_vma end = bfd_get_32 (abfd, rf + 4);
+      bfd_vma unwind_rva = bfd_get_32 (abfd, rf + 8);
+      const bfd_byte *unwind;
+
+      if (begin == 0 && end == 0 && unwind_rva == 0)
+	/* The padding at the end of the section.  */
+	break;
+      if (begin >= end)
+	continue;
+
+      /* With the low bit set, the unwind RVA is that of another entry
+	 of the table, whose unwind information this one shares.  */
+      if ((unwind_rva & 1) != 0)
+	{
+	  const bfd_byte *shared = pe_rva_ptr (&img, unwind_rva & ~1, 12);
+
+	  if (shared == NULL)
+	    continue;
+	  unwind_rva = bfd_get_32 (abfd, shared + 8);
+	}
+      unwind = pe_unwind_ptr (&img, unwind_rva);
+      if (unwind == NULL)
+	continue;
+
+      if (n != 0 && begin < funcs[n - 1].begin)
+	sorted = false;
+      funcs[n].begin = begin;
+      funcs[n].end = end;
+      funcs[n].unwind_rva = unwind_rva;
+      funcs[n].unwind = unwind;
+      n++;
+    }
+
+  /* The table ought to be sorted already, but a lookup can't rely on
+     that, nor on the entries not overlapping.  */
+  if (!sorted)
+    qsort (funcs, n, sizeof (*funcs), pe_function_compare);
+  count = n;
+  n = 0;
+  for (k = 0; k < count; k++)
+    if (n == 0 || funcs[k].begin >= funcs[n - 1].end)
+      funcs[n++] = funcs[k];
+
+  idx->functions = funcs;
+  idx->nfunctions = n;
+  return true;
+}
+
+/* Find the resource directory of ABFD for IDX.  */
+
+static bool
+pe_build_resources (bfd *abfd, struct bfd_pe_index *idx)
+{
+  struct internal_extra_pe_aouthdr *extra = &pe_data (abfd)->pe_opthdr;
+  bfd_vma dir_rva = extra->DataDirectory[PE_RESOURCE_TABLE].VirtualAddress;
+  bfd_vma dir_size = extra->DataDirectory[PE_RESOURCE_TABLE].Size;
+  struct pe_image img;
+
+  if (dir_rva == 0 || dir_size == 0)
+    return true;
+
+  img.abfd = abfd;
+  img.image_base = extra->ImageBase;
+  img.sec = NULL;
+  img.contents = NULL;
+  idx->resources = pe_rva_ptr (&img, dir_rva, dir_size);
+  if (idx->resources == NULL)
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+  idx->resources_size = dir_size;
+  return true;
+}
+
+/* Return whether the resource name of LEN UTF-16 characters at S is
+   NAME, ignoring case.  */
+
+static bool
+pe_resource_name_eq (bfd *abfd, const bfd_byte *s, unsigned int len,
+		     const char *name)
+{
+  unsigned int i;
+
+  for (i = 0; i < len; i++, s += 2, name++)
+    {
+      unsigned int c = bfd_get_16 (abfd, s);
+
+      if (*name == 0 || c > 0x7f || TOLOWER (c) != TOLOWER (*name))
+	return false;
+    }
+  return *name == 0;
+}
+
+/* Find the entry matching KEY in the resource directory at offset
+   DIR of IDX, or its first entry if KEY is NULL.  Set *ID to the name
+   or ID field of the entry and *VALUE to its offset field, and return
+   TRUE, or return FALSE if there is no such entry.  */
+
+static bool
+pe_resource_lookup (bfd *abfd, struct bfd_pe_index *idx, bfd_vma dir,
+		    const bfd_pe_resource_id *key, unsigned int *id,
+		    unsigned int *value)
+{
+  const bfd_byte *base = idx->resources;
+  bfd_size_type size = idx->resources_size;
+  const bfd_byte *entries;
+  const bfd_byte *e = NULL;
+  unsigned int nnames, nids, i;
+
+  if (dir > size || size - dir < 16)
+    return false;
+  nnames = bfd_get_16 (abfd, base + dir + 12);
+  nids = bfd_get_16 (abfd, base + dir + 14);
+  if ((size - dir - 16) / 8 < nnames + nids)
+    return false;
+  entries = base + dir + 16;
+
+  if (key == NULL)
+    {
+      if (nnames + nids != 0)
+	e = entries;
+    }
+  else if (key->name != NULL)
+    {
+      for (i = 0; i < nnames; i++)
+	{
+	  bfd_vma off = bfd_get_32 (abfd, entries + i * 8) & 0x7fffffff;
+	  unsigned int len;
+
+	  if (off > size || size - off < 2)
+	    continue;
+	  len = bfd_get_16 (abfd, base + off);
+	  if ((size - off - 2) / 2 >= len
+	      && pe_resource_name_eq (abfd, base + off + 2, len, key->name))
+	    {
+	      e = entries + i * 8;
+	      break;
+	    }
+	}
+    }
+  else
+    {
+      size_t lo = 0, hi = nids;
+
+      entries += nnames * 8;
+      while (lo < hi)
+	{
+	  size_t mid = lo + (hi - lo) / 2;
+	  unsigned int mid_id = bfd_get_32 (abfd, entries + mid * 8);
+
+	  if (mid_id == key->id)
+	    {
+	      e = entries + mid * 8;
+	      break;
+	    }
+	  if (mid_id < key->id)
+	    lo = mid + 1;
+	  else
+	    hi = mid;
+	}
+    }
+
+  if (e == NULL)
+    return false;
+  *id = bfd_get_32 (abfd, e);
+  *value = bfd_get_32 (abfd, e + 4);
+  return true;
+}
+
+/* Return the index of ABFD with its exports decoded.  */
+
+static struct bfd_pe_index *
+pe_get_exports (bfd *abfd)
+{
+  struct bfd_pe_index *idx = pe_get_index (abfd);
+
+  if (idx != NULL && !idx->exports_done)
+    {
+      if (!pe_build_exports (abfd, idx))
+	return NULL;
+      idx->exports_done = true;
+    }
+  return idx;
+}
+
+/* Return the index of ABFD with its imports decoded.  */
+
+static struct bfd_pe_index *
+pe_get_imports (bfd *abfd)
+{
+  struct bfd_pe_index *idx = pe_get_index (abfd);
+
+  if (idx != NULL && !idx->imports_done)
+    {
+      if (!pe_build_imports (abfd, idx))
+	return NULL;
+      idx->imports_done = true;
+    }
+  return idx;
+}
+
+/* Return the index of ABFD with its function table decoded.  */
+
+static struct bfd_pe_index *
+pe_get_functions (bfd *abfd)
+{
+  struct bfd_pe_index *idx = pe_get_index (abfd);
+
+  if (idx != NULL && !idx->functions_done)
+    {
+      if (!pe_build_functions (abfd, idx))
+	return NULL;
+      idx->functions_done = true;
+    }
+  return idx;
+}
+
+/* Return the index of ABFD with its resource directory found.  */
+
+static struct bfd_pe_index *
+pe_get_resources (bfd *abfd)
+{
+  struct bfd_pe_index *idx = pe_get_index (abfd);
+
+  if (idx != NULL && !idx->resources_done)
+    {
+      if (!pe_build_resources (abfd, idx))
+	return NULL;
+      idx->resources_done = true;
+    }
+  return idx;
+}
+
+/*
+FUNCTION
+	bfd_pe_get_exports
+
+SYNOPSIS
+	bool bfd_pe_get_exports
+	  (bfd *abfd, const bfd_pe_export **exports, size_t *count);
+
+DESCRIPTION
+	Set @var{*exports} to the exports of the PE image @var{abfd},
+	and @var{*count} to their number.  Named exports come first,
+	sorted by name, then those exported only by ordinal, in
+	ordinal order.  An ordinal exported under several names has
+	an entry for each.  The first call of this or
+	<<bfd_pe_find_export>> decodes the export directory.  Return
+	<<FALSE>>, setting the BFD error, if @var{abfd} isn't a PE
+	image or its export directory is corrupt.  An image without
+	one has no exports.
+*/
+
+bool
+bfd_pe_get_exports (bfd *abfd, const bfd_pe_export **exports,
+		    size_t *count)
+{
+  struct bfd_pe_index *idx = pe_get_exports (abfd);
+
+  if (idx == NULL)
+    return false;
+  *exports = idx->exports;
+  *count = idx->nexports;
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_pe_find_export
+
+SYNOPSIS
+	const bfd_pe_export *bfd_pe_find_export
+	  (bfd *abfd, const char *name);
+
+DESCRIPTION
+	Return the export of the PE image @var{abfd} called @var{name},
+	or NULL if there is none or on error.
+*/
+
+const bfd_pe_export *
+bfd_pe_find_export (bfd *abfd, const char *name)
+{
+  struct bfd_pe_index *idx = pe_get_exports (abfd);
+  size_t h;
+
+  if (idx == NULL || idx->nnamed == 0)
+    return NULL;
+  h = htab_hash_string (name) & idx->export_hash_mask;
+  for (; idx->export_hash[h] != 0; h = (h + 1) & idx->export_hash_mask)
+    {
+      const bfd_pe_export *e = &idx->exports[idx->export_hash[h] - 1];
+
+      if (strcmp (e->name, name) == 0)
+	return e;
+    }
+  return NULL;
+}
+
+/*
+FUNCTION
+	bfd_pe_find_export_by_ordinal
+
+SYNOPSIS
+	const bfd_pe_export *bfd_pe_find_export_by_ordinal
+	  (bfd *abfd, unsigned int ordinal);
+
+DESCRIPTION
+	Return the export of the PE image @var{abfd} with ordinal
+	@var{ordinal}, ordinal base included, or NULL if there is
+	none or on error.  For an ordinal with several names, the
+	first by name is returned.
+*/
+
+const bfd_pe_export *
+bfd_pe_find_export_by_ordinal (bfd *abfd, unsigned int ordinal)
+{
+  struct bfd_pe_index *idx = pe_get_exports (abfd);
+  unsigned int i;
+
+  if (idx == NULL
+      || ordinal < idx->ordinal_base
+      || ordinal - idx->ordinal_base >= idx->nordinals)
+    return NULL;
+  i = idx->by_ordinal[ordinal - idx->ordinal_base];
+  return i != 0 ? &idx->exports[i - 1] : NULL;
+}
+
+/*
+FUNCTION
+	bfd_pe_get_imports
+
+SYNOPSIS
+	bool bfd_pe_get_imports
+	  (bfd *abfd, const bfd_pe_import **imports, size_t *count);
+
+DESCRIPTION
+	Set @var{*imports} to the imports of the PE image @var{abfd},
+	and @var{*count} to their number, in the order of the import
+	directories, so that the imports from each DLL are together.
+	The first call of this or <<bfd_pe_find_import>> decodes the
+	import directories.  Return <<FALSE>>, setting the BFD error,
+	if @var{abfd} isn't a PE image.  Entries that can't be read
+	are left out.
+*/
+
+bool
+bfd_pe_get_imports (bfd *abfd, const bfd_pe_import **imports,
+		    size_t *count)
+{
+  struct bfd_pe_index *idx = pe_get_imports (abfd);
+
+  if (idx == NULL)
+    return false;
+  *imports = idx->imports;
+  *count = idx->nimports;
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_pe_find_import
+
+SYNOPSIS
+	const bfd_pe_import *bfd_pe_find_import
+	  (bfd *abfd, const char *dll, const char *name);
+
+DESCRIPTION
+	Return the import by name of @var{name} from the DLL @var{dll}
+	by the PE image @var{abfd}, or NULL if there is none or on
+	error.  @var{dll} is compared without regard to case.
+*/
+
+const bfd_pe_import *
+bfd_pe_find_import (bfd *abfd, const char *dll, const char *name)
+{
+  struct bfd_pe_index *idx = pe_get_imports (abfd);
+  size_t h;
+
+  if (idx == NULL || idx->nimports == 0)
+    return NULL;
+  h = pe_import_hash (dll, name) & idx->import_hash_mask;
+  for (; idx->import_hash[h] != 0; h = (h + 1) & idx->import_hash_mask)
+    {
+      const bfd_pe_import *imp = &idx->imports[idx->import_hash[h] - 1];
+
+      if (strcmp (imp->name, name) == 0 && strcasecmp (imp->dll, dll) == 0)
+	return imp;
+    }
+  return NULL;
+}
+
+/*
+FUNCTION
+	bfd_pe_find_unwind
+
+SYNOPSIS
+	bool bfd_pe_find_unwind
+	  (bfd *abfd, bfd_vma rva, bfd_pe_unwind *info);
+
+DESCRIPTION
+	Fill in @var{info} with the unwind information of the function
+	covering @var{rva} in the x86-64 PE image @var{abfd}, from its
+	exception directory.  If @var{info->chained} is set on return,
+	the unwind codes continue with those found by looking up
+	@var{info->parent_begin}.
+
+	The first call checks the function table and keeps a sorted
+	copy of it, so that later calls do a binary search.  Return
+	<<FALSE>> if no function covers @var{rva}, or on error, in
+	which case the BFD error is set.  An image without an
+	exception directory has no functions.
+*/
+
+bool
+bfd_pe_find_unwind (bfd *abfd, bfd_vma rva, bfd_pe_unwind *info)
+{
+  struct bfd_pe_index *idx = pe_get_functions (abfd);
+  const struct pe_function *f;
+  const bfd_byte *ui;
+  size_t lo, hi;
+  unsigned int flags;
+
+  if (idx == NULL)
+    return false;
+
+  /* Find the last function beginning at or before RVA.  */
+  lo = 0;
+  hi = idx->nfunctions;
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (idx->functions[mid].begin <= rva)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0 || rva >= idx->functions[lo - 1].end)
+    return false;
+  f = &idx->functions[lo - 1];
+
+  /* pe_unwind_ptr has checked that all of this is there.  */
+  ui = f->unwind;
+  flags = PEX64_UWI_FLAGS (ui[0]);
+  memset (info, 0, sizeof (*info));
+  info->begin = f->begin;
+  info->end = f->end;
+  info->unwind_rva = f->unwind_rva;
+  info->version = PEX64_UWI_VERSION (ui[0]);
+  info->flags = flags;
+  info->prolog_size = ui[1];
+  info->code_count = ui[2];
+  info->frame_register = PEX64_UWI_FRAMEREG (ui[3]);
+  info->frame_offset = PEX64_UWI_FRAMEOFF (ui[3]) * 16;
+  info->codes = ui + 4;
+  ui += 4 + PEX64_UWI_SIZEOF_UWCODE_ARRAY (info->code_count);
+  if ((flags & (UNW_FLAG_EHANDLER | UNW_FLAG_UHANDLER)) != 0)
+    {
+      info->handler_rva = bfd_get_32 (abfd, ui);
+      info->handler_data = ui + 4;
+    }
+  else if ((flags & UNW_FLAG_CHAININFO) != 0)
+    {
+      info->chained = true;
+      info->parent_begin = bfd_get_32 (abfd, ui);
+      info->parent_end = bfd_get_32 (abfd, ui + 4);
+    }
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_pe_find_resource
+
+SYNOPSIS
+	bool bfd_pe_find_resource
+	  (bfd *abfd, const bfd_pe_resource_id *type,
+	   const bfd_pe_resource_id *name,
+	   const bfd_pe_resource_id *language, bfd_pe_resource *res);
+
+DESCRIPTION
+	Fill in @var{res} with the resource of the PE image @var{abfd}
+	with type @var{type}, name @var{name} and language
+	@var{language}, or its first language if @var{language} is
+	NULL.  Names are compared without regard to case, and only
+	match resource names of ASCII characters.  Return <<FALSE>>
+	if there is no such resource, or on error, in which case the
+	BFD error is set.  An image without a resource directory has
+	no resources.
+*/
+
+bool
+bfd_pe_find_resource (bfd *abfd, const bfd_pe_resource_id *type,
+		      const bfd_pe_resource_id *name,
+		      const bfd_pe_resource_id *language,
+		      bfd_pe_resource *res)
+{
+  struct bfd_pe_index *idx = pe_get_resources (abfd);
+  struct pe_image img;
+  const bfd_byte *leaf;
+  unsigned int id, value;
+
+  if (idx == NULL || idx->resources == NULL)
+    return false;
+
+  /* The type and name entries lead to directories, with the high bit
+     of their offsets set, and the language entry to a data entry.  */
+  if (!pe_resource_lookup (abfd, idx, 0, type, &id, &value)
+      || (value & 0x80000000) == 0
+      || !pe_resource_lookup (abfd, idx, value & 0x7fffffff, name,
+			      &id, &value)
+      || (value & 0x80000000) == 0
+      || !pe_resource_lookup (abfd, idx, value & 0x7fffffff, language,
+			      &id, &value)
+      || (value & 0x80000000) != 0
+      || value > idx->resources_size
+      || idx->resources_size - value < 16)
+    return false;
+
+  leaf = idx->resources + value;
+  memset (res, 0, sizeof (*res));
+  res->language = id;
+  res->rva = bfd_get_32 (abfd, leaf);
+  res->size = bfd_get_32 (abfd, leaf + 4);
+  res->codepage = bfd_get_32 (abfd, leaf + 8);
+
+  img.abfd = abfd;
+  img.image_base = pe_data (abfd)->pe_opthdr.ImageBase;
+  img.sec = NULL;
+  img.contents = NULL;
+  res->data = pe_rva_ptr (&img, res->rva, res->size);
+  if (res->data == NULL)
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+  return true;
+}
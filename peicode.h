@@ -201,32 +201,54 @@ coff_swap_filehdr_in (bfd * abfd, void * src, void * dst)
 # define coff_swap_filehdr_out _bfd_pe_only_swap_filehdr_out
 #endif
 
-static void
-coff_swap_scnhdr_in (bfd * abfd, void * ext, void * in)
+/* Swap in the section header at EXT.  HOST_ORDER is true if ABFD's
+   headers are in the host's byte order, so that the fields can be read
+   as plain host words without going through the target vector.  */
+
+static inline void
+pe_swap_scnhdr_in_1 (bfd * abfd, void * ext, void * in, bool host_order)
 {
   SCNHDR *scnhdr_ext = (SCNHDR *) ext;
   struct internal_scnhdr *scnhdr_int = (struct internal_scnhdr *) in;
+  unsigned int nreloc;
+  unsigned int nlnno;
 
   memcpy (scnhdr_int->s_name, scnhdr_ext->s_name, sizeof (scnhdr_int->s_name));
 
-  scnhdr_int->s_vaddr   = GET_SCNHDR_VADDR (abfd, scnhdr_ext->s_vaddr);
-  scnhdr_int->s_paddr   = GET_SCNHDR_PADDR (abfd, scnhdr_ext->s_paddr);
-  scnhdr_int->s_size    = GET_SCNHDR_SIZE (abfd, scnhdr_ext->s_size);
-  scnhdr_int->s_scnptr  = GET_SCNHDR_SCNPTR (abfd, scnhdr_ext->s_scnptr);
-  scnhdr_int->s_relptr  = GET_SCNHDR_RELPTR (abfd, scnhdr_ext->s_relptr);
-  scnhdr_int->s_lnnoptr = GET_SCNHDR_LNNOPTR (abfd, scnhdr_ext->s_lnnoptr);
-  scnhdr_int->s_flags   = H_GET_32 (abfd, scnhdr_ext->s_flags);
+  if (host_order)
+    {
+      scnhdr_int->s_vaddr   = _bfd_host_get_32 (scnhdr_ext->s_vaddr);
+      scnhdr_int->s_paddr   = _bfd_host_get_32 (scnhdr_ext->s_paddr);
+      scnhdr_int->s_size    = _bfd_host_get_32 (scnhdr_ext->s_size);
+      scnhdr_int->s_scnptr  = _bfd_host_get_32 (scnhdr_ext->s_scnptr);
+      scnhdr_int->s_relptr  = _bfd_host_get_32 (scnhdr_ext->s_relptr);
+      scnhdr_int->s_lnnoptr = _bfd_host_get_32 (scnhdr_ext->s_lnnoptr);
+      scnhdr_int->s_flags   = _bfd_host_get_32 (scnhdr_ext->s_flags);
+      nreloc = _bfd_host_get_16 (scnhdr_ext->s_nreloc);
+      nlnno = _bfd_host_get_16 (scnhdr_ext->s_nlnno);
+    }
+  else
+    {
+      scnhdr_int->s_vaddr   = GET_SCNHDR_VADDR (abfd, scnhdr_ext->s_vaddr);
+      scnhdr_int->s_paddr   = GET_SCNHDR_PADDR (abfd, scnhdr_ext->s_paddr);
+      scnhdr_int->s_size    = GET_SCNHDR_SIZE (abfd, scnhdr_ext->s_size);
+      scnhdr_int->s_scnptr  = GET_SCNHDR_SCNPTR (abfd, scnhdr_ext->s_scnptr);
+      scnhdr_int->s_relptr  = GET_SCNHDR_RELPTR (abfd, scnhdr_ext->s_relptr);
+      scnhdr_int->s_lnnoptr = GET_SCNHDR_LNNOPTR (abfd, scnhdr_ext->s_lnnoptr);
+      scnhdr_int->s_flags   = H_GET_32 (abfd, scnhdr_ext->s_flags);
+      nreloc = H_GET_16 (abfd, scnhdr_ext->s_nreloc);
+      nlnno = H_GET_16 (abfd, scnhdr_ext->s_nlnno);
+    }
 
   /* MS handles overflow of line numbers by carrying into the reloc
      field (it appears).  Since it's supposed to be zero for PE
      *IMAGE* format, that's safe.  This is still a bit iffy.  */
 #ifdef COFF_IMAGE_WITH_PE
-  scnhdr_int->s_nlnno = (H_GET_16 (abfd, scnhdr_ext->s_nlnno)
-			 + (H_GET_16 (abfd, scnhdr_ext->s_nreloc) << 16));
+  scnhdr_int->s_nlnno = nlnno + (nreloc << 16);
   scnhdr_int->s_nreloc = 0;
 #else
-  scnhdr_int->s_nreloc = H_GET_16 (abfd, scnhdr_ext->s_nreloc);
-  scnhdr_int->s_nlnno = H_GET_16 (abfd, scnhdr_ext->s_nlnno);
+  scnhdr_int->s_nreloc = nreloc;
+  scnhdr_int->s_nlnno = nlnno;
 #endif
 
   if (scnhdr_int->s_vaddr != 0)
@@ -255,6 +277,29 @@ coff_swap_scnhdr_in (bfd * abfd, void * ext, void * in)
 #endif
 }
 
+static void
+coff_swap_scnhdr_in (bfd * abfd, void * ext, void * in)
+{
+  pe_swap_scnhdr_in_1 (abfd, ext, in, false);
+}
+
+/* Swap in the COUNT section headers at EXT.  */
+
+static void
+coff_swap_scnhdrs_in (bfd * abfd, void * ext, unsigned int count,
+		      struct internal_scnhdr * in)
+{
+  SCNHDR *scnhdr_ext = (SCNHDR *) ext;
+  unsigned int i;
+
+  if (_bfd_header_host_order_p (abfd))
+    for (i = 0; i < count; i++)
+      pe_swap_scnhdr_in_1 (abfd, scnhdr_ext + i, in + i, true);
+  else
+    for (i = 0; i < count; i++)
+      pe_swap_scnhdr_in_1 (abfd, scnhdr_ext + i, in + i, false);
+}
+
 static bool
 pe_mkobject (bfd * abfd)
 {
@@ -786,65 +831,42 @@ static const jump_table jtab[] =
 #define NUM_ENTRIES(a) (sizeof (a) / sizeof (a)[0])
 #endif
 
+/* The fixed part of an Import Library Format header, decoded.  */
+
+struct pe_ILF_header
+{
+  /* The COFF magic number for the header's machine type.  */
+  unsigned int magic;
+  /* The size of the strings following the header.  */
+  bfd_size_type size;
+  unsigned int ordinal;
+  unsigned int import_type;
+  unsigned int import_name_type;
+};
+
+/* The size of an ILF header, including its six byte signature.  */
+#define SIZEOF_ILF_HEADER	20
+
 /* Build a full BFD from the information supplied in a ILF object.  */
 
 static bool
-pe_ILF_build_a_bfd (bfd *	    abfd,
-		    unsigned int    magic,
-		    char *	    symbol_name,
-		    char *	    source_dll,
-		    unsigned int    ordinal,
-		    unsigned int    types)
+pe_ILF_build_a_bfd (bfd *			 abfd,
+		    const struct pe_ILF_header * hdr,
+		    char *			 symbol_name,
+		    char *			 source_dll)
 {
   bfd_byte *		   ptr;
   pe_ILF_vars		   vars;
   struct internal_filehdr  internal_f;
-  unsigned int		   import_type;
-  unsigned int		   import_name_type;
+  unsigned int		   magic = hdr->magic;
+  unsigned int		   ordinal = hdr->ordinal;
+  unsigned int		   import_type = hdr->import_type;
+  unsigned int		   import_name_type = hdr->import_name_type;
   asection_ptr		   id4, id5, id6 = NULL, text = NULL;
   coff_symbol_type **	   imp_sym;
   unsigned int		   imp_index;
   intptr_t alignment;
 
-  /* Decode and verify the types field of the ILF structure.  */
-  import_type = types & 0x3;
-  import_name_type = (types & 0x1c) >> 2;
-
-  switch (import_type)
-    {
-    case IMPORT_CODE:
-    case IMPORT_DATA:
-      break;
-
-    case IMPORT_CONST:
-      /* XXX code yet to be written.  */
-      /* xgettext:c-format */
-      _bfd_error_handler (_("%pB: unhandled import type; %x"),
-			  abfd, import_type);
-      return false;
-
-    default:
-      /* xgettext:c-format */
-      _bfd_error_handler (_("%pB: unrecognized import type; %x"),
-			  abfd, import_type);
-      return false;
-    }
-
-  switch (import_name_type)
-    {
-    case IMPORT_ORDINAL:
-    case IMPORT_NAME:
-    case IMPORT_NAME_NOPREFIX:
-    case IMPORT_NAME_UNDECORATE:
-      break;
-
-    default:
-      /* xgettext:c-format */
-      _bfd_error_handler (_("%pB: unrecognized import name type; %x"),
-			  abfd, import_name_type);
-      return false;
-    }
-
   /* Initialise local variables.
 
      Note these are kept in a structure rather than being
@@ -860,6 +882,7 @@ pe_ILF_build_a_bfd (bfd *	    abfd,
   ptr = (bfd_byte *) bfd_zmalloc ((bfd_size_type) ILF_DATA_SIZE);
   vars.bim->buffer = ptr;
   vars.bim->size   = ILF_DATA_SIZE;
+  vars.bim->capacity = ILF_DATA_SIZE;
   if (ptr == NULL)
     goto error_return;
 
@@ -932,10 +955,6 @@ pe_ILF_build_a_bfd (bfd *	    abfd,
   /* Fill in the contents of these sections.  */
   if (import_name_type == IMPORT_ORDINAL)
     {
-      if (ordinal == 0)
-	/* See PR 20907 for a reproducer.  */
-	goto error_return;
-
 #if defined(COFF_WITH_pex64) || defined(COFF_WITH_peAArch64) || defined(COFF_WITH_peLoongArch64)
       ((unsigned int *) id4->contents)[0] = ordinal;
       ((unsigned int *) id4->contents)[1] = 0x80000000;
@@ -1169,28 +1188,21 @@ pe_ILF_cleanup (bfd *abfd)
   abfd->iostream = NULL;
 }
 
-/* We have detected an Import Library Format archive element.
-   Decode the element and return the appropriate target.  */
+/* Decode and check the ILF header at BUF into HDR.  Everything that
+   would make pe_ILF_build_a_bfd fail is rejected here, before any
+   memory is allocated for the element.  */
 
-static bfd_cleanup
-pe_ILF_object_p (bfd * abfd)
+static bool
+pe_ILF_decode_header (bfd *abfd, const bfd_byte *buf,
+		      struct pe_ILF_header *hdr)
 {
-  bfd_byte	  buffer[14];
-  bfd_byte *	  ptr;
-  char *	  symbol_name;
-  char *	  source_dll;
+  const bfd_byte *ptr;
   unsigned int	  machine;
-  bfd_size_type	  size;
-  unsigned int	  ordinal;
-  unsigned int	  types;
   unsigned int	  magic;
+  unsigned int	  types;
 
-  /* Upon entry the first six bytes of the ILF header have
-     already been read.  Now read the rest of the header.  */
-  if (bfd_bread (buffer, (bfd_size_type) 14, abfd) != 14)
-    return NULL;
-
-  ptr = buffer;
+  /* Skip the signature and version, which the caller has checked.  */
+  ptr = buf + 6;
 
   machine = H_GET_16 (abfd, ptr);
   ptr += 2;
@@ -1276,7 +1288,7 @@ pe_ILF_object_p (bfd * abfd)
 	 abfd, machine);
       bfd_set_error (bfd_error_malformed_archive);
 
-      return NULL;
+      return false;
       break;
     }
 
@@ -1289,36 +1301,131 @@ pe_ILF_object_p (bfd * abfd)
 	 abfd, machine);
       bfd_set_error (bfd_error_wrong_format);
 
-      return NULL;
+      return false;
     }
 
   /* We do not bother to check the date.
      date = H_GET_32 (abfd, ptr);  */
   ptr += 4;
 
-  size = H_GET_32 (abfd, ptr);
+  hdr->magic = magic;
+  hdr->size = H_GET_32 (abfd, ptr);
   ptr += 4;
 
-  if (size == 0)
+  if (hdr->size == 0)
     {
       _bfd_error_handler
 	(_("%pB: size field is zero in Import Library Format header"), abfd);
       bfd_set_error (bfd_error_malformed_archive);
 
-      return NULL;
+      return false;
     }
 
-  ordinal = H_GET_16 (abfd, ptr);
+  hdr->ordinal = H_GET_16 (abfd, ptr);
   ptr += 2;
 
   types = H_GET_16 (abfd, ptr);
-  /* ptr += 2; */
 
-  /* Now read in the two strings that follow.  */
-  ptr = (bfd_byte *) _bfd_alloc_and_read (abfd, size, size);
+  /* Decode and verify the types field of the ILF structure.  */
+  hdr->import_type = types & 0x3;
+  hdr->import_name_type = (types & 0x1c) >> 2;
+
+  switch (hdr->import_type)
+    {
+    case IMPORT_CODE:
+    case IMPORT_DATA:
+      break;
+
+    case IMPORT_CONST:
+      /* XXX code yet to be written.  */
+      /* xgettext:c-format */
+      _bfd_error_handler (_("%pB: unhandled import type; %x"),
+			  abfd, hdr->import_type);
+      return false;
+
+    default:
+      /* xgettext:c-format */
+      _bfd_error_handler (_("%pB: unrecognized import type; %x"),
+			  abfd, hdr->import_type);
+      return false;
+    }
+
+  switch (hdr->import_name_type)
+    {
+    case IMPORT_ORDINAL:
+      if (hdr->ordinal == 0)
+	/* See PR 20907 for a reproducer.  */
+	return false;
+      break;
+
+    case IMPORT_NAME:
+    case IMPORT_NAME_NOPREFIX:
+    case IMPORT_NAME_UNDECORATE:
+      break;
+
+    default:
+      /* xgettext:c-format */
+      _bfd_error_handler (_("%pB: unrecognized import name type; %x"),
+			  abfd, hdr->import_name_type);
+      return false;
+    }
+
+  return true;
+}
+
+/* We have detected an Import Library Format archive element.
+   Decode the element and return the appropriate target.  BUF holds
+   the first AVAIL bytes of the element, which the caller has read;
+   when the element is short, as most are, that is all of it and no
+   further reads are needed.  */
+
+static bfd_cleanup
+pe_ILF_object_p (bfd * abfd, const bfd_byte * buf, bfd_size_type avail)
+{
+  struct pe_ILF_header hdr;
+  bfd_byte *	  ptr;
+  char *	  symbol_name;
+  char *	  source_dll;
+  bfd_size_type	  size;
+  bfd_size_type	  have;
+  ufile_ptr	  filesize;
+
+  if (avail < SIZEOF_ILF_HEADER)
+    {
+      bfd_set_error (bfd_error_file_truncated);
+      return NULL;
+    }
+
+  if (! pe_ILF_decode_header (abfd, buf, &hdr))
+    return NULL;
+  size = hdr.size;
+
+  filesize = bfd_get_file_size (abfd);
+  if (filesize != 0 && size > filesize)
+    {
+      bfd_set_error (bfd_error_file_truncated);
+      return NULL;
+    }
+
+  /* Now collect the two strings that follow, taking what the caller
+     has already read and reading the rest from where it stopped.  */
+  ptr = (bfd_byte *) bfd_alloc (abfd, size);
   if (ptr == NULL)
     return NULL;
 
+  have = avail - SIZEOF_ILF_HEADER;
+  if (have > size)
+    have = size;
+  memcpy (ptr, buf + SIZEOF_ILF_HEADER, have);
+  if (have < size
+      && bfd_bread (ptr + have, size - have, abfd) != size - have)
+    {
+      if (bfd_get_error () != bfd_error_system_call)
+	bfd_set_error (bfd_error_file_truncated);
+      bfd_release (abfd, ptr);
+      return NULL;
+    }
+
   symbol_name = (char *) ptr;
   /* See PR 20905 for an example of where the strnlen is necessary.  */
   source_dll  = symbol_name + strnlen (symbol_name, size - 1) + 1;
@@ -1335,8 +1442,7 @@ pe_ILF_object_p (bfd * abfd)
     }
 
   /* Now construct the bfd.  */
-  if (! pe_ILF_build_a_bfd (abfd, magic, symbol_name,
-			    source_dll, ordinal, types))
+  if (! pe_ILF_build_a_bfd (abfd, &hdr, symbol_name, source_dll))
     {
       bfd_release (abfd, ptr);
       return NULL;
@@ -1438,33 +1544,37 @@ pe_bfd_read_buildid (bfd *abfd)
 static bfd_cleanup
 pe_bfd_object_p (bfd * abfd)
 {
-  bfd_byte buffer[6];
   struct external_DOS_hdr dos_hdr;
   struct external_PEI_IMAGE_hdr image_hdr;
   struct internal_filehdr internal_f;
   struct internal_aouthdr internal_a;
   bfd_size_type opt_hdr_size;
+  bfd_size_type amt;
   file_ptr offset;
   bfd_cleanup result;
 
-  /* Detect if this a Microsoft Import Library Format element.  */
-  /* First read the beginning of the header.  */
-  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0
-      || bfd_bread (buffer, (bfd_size_type) 6, abfd) != 6)
+  /* Read the DOS header.  A Microsoft Import Library Format element
+     may be shorter than that, so accept a short read until we know
+     which of the two this is.  */
+  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0)
     {
       if (bfd_get_error () != bfd_error_system_call)
 	bfd_set_error (bfd_error_wrong_format);
       return NULL;
     }
-
-  /* Then check the magic and the version (only 0 is supported).  */
-  if (H_GET_32 (abfd, buffer) == 0xffff0000
-      && H_GET_16 (abfd, buffer + 4) == 0)
-    return pe_ILF_object_p (abfd);
-
-  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0
-      || bfd_bread (&dos_hdr, (bfd_size_type) sizeof (dos_hdr), abfd)
-	 != sizeof (dos_hdr))
+  amt = bfd_bread (&dos_hdr, (bfd_size_type) sizeof (dos_hdr), abfd);
+  if (amt == (bfd_size_type) -1)
+    amt = 0;
+
+  /* Detect if this a Microsoft Import Library Format element: check
+     the magic and the version (only 0 is supported).  Its header, and
+     usually its strings, are now in DOS_HDR.  */
+  if (amt >= 6
+      && H_GET_32 (abfd, &dos_hdr) == 0xffff0000
+      && H_GET_16 (abfd, (bfd_byte *) &dos_hdr + 4) == 0)
+    return pe_ILF_object_p (abfd, (bfd_byte *) &dos_hdr, amt);
+
+  if (amt != sizeof (dos_hdr))
     {
       if (bfd_get_error () != bfd_error_system_call)
 	bfd_set_error (bfd_error_wrong_format);
@@ -107,8 +107,12 @@
 #define SetHighBit(val)      ((val) | 0x80000000)
 #define WithoutHighBit(val)  ((val) & 0x7fffffff)
 
-void
-_bfd_pex64i_swap_sym_in (bfd * abfd, void * ext1, void * in1)
+/* Swap in the symbol at EXT1.  HOST_ORDER is true if ABFD's headers
+   are in the host's byte order, so that the fields can be read as
+   plain host words without going through the target vector.  */
+
+static inline void
+pe_swap_sym_in_1 (bfd * abfd, void * ext1, void * in1, bool host_order)
 {
   SYMENT *ext = (SYMENT *) ext1;
   struct internal_syment *in = (struct internal_syment *) in1;
@@ -116,18 +120,33 @@ _bfd_pex64i_swap_sym_in (bfd * abfd, void * ext1, void * in1)
   if (ext->e.e_name[0] == 0)
     {
       in->_n._n_n._n_zeroes = 0;
-      in->_n._n_n._n_offset = H_GET_32 (abfd, ext->e.e.e_offset);
+      in->_n._n_n._n_offset = (host_order
+			       ? _bfd_host_get_32 (ext->e.e.e_offset)
+			       : H_GET_32 (abfd, ext->e.e.e_offset));
     }
   else
     memcpy (in->_n._n_name, ext->e.e_name, SYMNMLEN);
 
-  in->n_value = H_GET_32 (abfd, ext->e_value);
-  in->n_scnum = (short) H_GET_16 (abfd, ext->e_scnum);
+  if (host_order)
+    {
+      in->n_value = _bfd_host_get_32 (ext->e_value);
+      in->n_scnum = (short) _bfd_host_get_16 (ext->e_scnum);
 
-  if (sizeof (ext->e_type) == 2)
-    in->n_type = H_GET_16 (abfd, ext->e_type);
+      if (sizeof (ext->e_type) == 2)
+	in->n_type = _bfd_host_get_16 (ext->e_type);
+      else
+	in->n_type = _bfd_host_get_32 (ext->e_type);
+    }
   else
-    in->n_type = H_GET_32 (abfd, ext->e_type);
+    {
+      in->n_value = H_GET_32 (abfd, ext->e_value);
+      in->n_scnum = (short) H_GET_16 (abfd, ext->e_scnum);
+
+      if (sizeof (ext->e_type) == 2)
+	in->n_type = H_GET_16 (abfd, ext->e_type);
+      else
+	in->n_type = H_GET_32 (abfd, ext->e_type);
+    }
 
   in->n_sclass = H_GET_8 (abfd, ext->e_sclass);
   in->n_numaux = H_GET_8 (abfd, ext->e_numaux);
@@ -209,6 +228,42 @@ _bfd_pex64i_swap_sym_in (bfd * abfd, void * ext1, void * in1)
 #endif
 }
 
+void
+_bfd_pex64i_swap_sym_in (bfd * abfd, void * ext1, void * in1)
+{
+  pe_swap_sym_in_1 (abfd, ext1, in1, false);
+}
+
+/* Swap in the symbols of the COUNT symbol table entries at EXT1,
+   stepping over their auxiliary entries.  */
+
+bool
+_bfd_pex64i_swap_syms_in (bfd * abfd, void * ext1, size_t count,
+		       combined_entry_type * internal)
+{
+  SYMENT *ext = (SYMENT *) ext1;
+  bool host_order = _bfd_header_host_order_p (abfd);
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    {
+      unsigned int numaux;
+
+      if (host_order)
+	pe_swap_sym_in_1 (abfd, ext + i, &internal[i].u.syment, true);
+      else
+	pe_swap_sym_in_1 (abfd, ext + i, &internal[i].u.syment, false);
+      internal[i].is_sym = true;
+
+      /* PR 17512: Prevent buffer overrun.  */
+      numaux = internal[i].u.syment.n_numaux;
+      if (numaux > count - 1 - i)
+	return false;
+      i += numaux;
+    }
+  return true;
+}
+
 static bool
 abs_finder (bfd * abfd ATTRIBUTE_UNUSED, asection * sec, void * data)
 {
@@ -3260,6 +3315,10 @@ typedef struct rsrc_directory
   rsrc_dir_chain ids;
 
   struct rsrc_entry * entry;
+
+  /* Set when another directory's entries have been attached to this
+     one, so that they need sorting and merging.  */
+  bool needs_sort;
 } rsrc_directory;
 
 typedef struct rsrc_string
@@ -3273,6 +3332,9 @@ typedef struct rsrc_leaf
   unsigned int	size;
   unsigned int	codepage;
   bfd_byte *	data;
+  /* Whether DATA was allocated when merging string tables, rather
+     than pointing into the contents of the section.  */
+  bool		owned;
 } rsrc_leaf;
 
 typedef struct rsrc_entry
@@ -3359,6 +3421,7 @@ rsrc_parse_entry (bfd *abfd,
   entry->value.leaf = bfd_malloc (sizeof (*entry->value.leaf));
   if (entry->value.leaf == NULL)
     return dataend;
+  entry->value.leaf->owned = false;
 
   data = datastart + val;
   if (data < datastart || data + 12 > dataend)
@@ -3371,11 +3434,9 @@ rsrc_parse_entry (bfd *abfd,
 
   if (size > dataend - datastart - (addr - rva_bias))
     return dataend;
-  entry->value.leaf->data = bfd_malloc (size);
-  if (entry->value.leaf->data == NULL)
-    return dataend;
-
-  memcpy (entry->value.leaf->data, datastart + addr - rva_bias, size);
+  /* The contents of the section outlive the tree, so the leaf can
+     point into them rather than having a copy.  */
+  entry->value.leaf->data = datastart + addr - rva_bias;
   return datastart + (addr - rva_bias) + size;
 }
 
@@ -3391,7 +3452,7 @@ rsrc_parse_entries (bfd *abfd,
 		    rsrc_directory *parent)
 {
   unsigned int i;
-  rsrc_entry * entry;
+  rsrc_entry * entries;
 
   if (chain->num_entries == 0)
     {
@@ -3399,36 +3460,32 @@ rsrc_parse_entries (bfd *abfd,
       return highest_data;
     }
 
-  entry = bfd_malloc (sizeof (*entry));
-  if (entry == NULL)
-    return dataend;
+  /* Allocate the entries of the chain together, linked in order.  */
+  entries = bfd_zmalloc (chain->num_entries * sizeof (*entries));
+  if (entries == NULL)
+    {
+      chain->num_entries = 0;
+      chain->first_entry = chain->last_entry = NULL;
+      return dataend;
+    }
 
-  chain->first_entry = entry;
+  for (i = 1; i < chain->num_entries; i++)
+    entries[i - 1].next_entry = entries + i;
+  chain->first_entry = entries;
+  chain->last_entry = entries + chain->num_entries - 1;
 
-  for (i = chain->num_entries; i--;)
+  for (i = 0; i < chain->num_entries; i++)
     {
       bfd_byte * entry_end;
 
-      entry_end = rsrc_parse_entry (abfd, is_name, entry, datastart,
+      entry_end = rsrc_parse_entry (abfd, is_name, entries + i, datastart,
 				    data, dataend, rva_bias, parent);
       data += 8;
       highest_data = max (entry_end, highest_data);
       if (entry_end > dataend)
 	return dataend;
-
-      if (i)
-	{
-	  entry->next_entry = bfd_malloc (sizeof (*entry));
-	  entry = entry->next_entry;
-	  if (entry == NULL)
-	    return dataend;
-	}
-      else
-	entry->next_entry = NULL;
     }
 
-  chain->last_entry = entry;
-
   return highest_data;
 }
 
@@ -3453,6 +3510,7 @@ rsrc_parse_directory (bfd *	       abfd,
   table->names.num_entries = bfd_get_16 (abfd, data + 12);
   table->ids.num_entries = bfd_get_16 (abfd, data + 14);
   table->entry = entry;
+  table->needs_sort = false;
 
   data += 16;
 
@@ -3672,7 +3730,7 @@ rsrc_cmp (bool is_name, rsrc_entry * a, rsrc_entry * b)
   unsigned int  blen;
 
   if (! is_name)
-    return a->name_id.id - b->name_id.id;
+    return (a->name_id.id > b->name_id.id) - (a->name_id.id < b->name_id.id);
 
   /* We have to perform a case insenstive, unicode string comparison...  */
   astring = a->name_id.name.string;
@@ -3924,186 +3982,293 @@ rsrc_merge_string_entries (rsrc_entry * a ATTRIBUTE_UNUSED,
 
   BFD_ASSERT (nstring - new_data == (int) (a->value.leaf->size + copy_needed));
 
-  free (a->value.leaf->data);
+  if (a->value.leaf->owned)
+    free (a->value.leaf->data);
   a->value.leaf->data = new_data;
   a->value.leaf->size += copy_needed;
+  a->value.leaf->owned = true;
 
   return true;
 }
 
 static void rsrc_merge (rsrc_entry *, rsrc_entry *);
+static void rsrc_sort_directory (rsrc_directory *);
+
+/* Merge sort the list of entries starting at LIST, keeping entries
+   that compare equal in their original order, and return the new
+   head of the list.  */
 
-/* Sort the entries in given part of the directory.
-   We use an old fashioned bubble sort because we are dealing
-   with lists and we want to handle matches specially.  */
+static rsrc_entry *
+rsrc_sort_list (rsrc_entry *list, bool is_name)
+{
+  rsrc_entry * slow;
+  rsrc_entry * fast;
+  rsrc_entry * a;
+  rsrc_entry * b;
+  rsrc_entry * head;
+  rsrc_entry ** tail;
+
+  if (list == NULL || list->next_entry == NULL)
+    return list;
+
+  /* Split the list in half and sort each half.  */
+  slow = list;
+  for (fast = list->next_entry;
+       fast != NULL && fast->next_entry != NULL;
+       fast = fast->next_entry->next_entry)
+    slow = slow->next_entry;
+  b = slow->next_entry;
+  slow->next_entry = NULL;
+  a = rsrc_sort_list (list, is_name);
+  b = rsrc_sort_list (b, is_name);
+
+  /* Merge the halves, taking from the first among equal entries.  */
+  tail = & head;
+  while (a != NULL && b != NULL)
+    {
+      if (rsrc_cmp (is_name, a, b) <= 0)
+	{
+	  * tail = a;
+	  a = a->next_entry;
+	}
+      else
+	{
+	  * tail = b;
+	  b = b->next_entry;
+	}
+      tail = & (* tail)->next_entry;
+    }
+  * tail = a != NULL ? a : b;
+
+  return head;
+}
+
+/* Sort the entries in given part of the directory, then handle the
+   matches.  The sort is stable, so matching entries end up next to
+   each other in their original order, and the first of them is the
+   one that is kept.  Directories that have entries merged into them
+   are left for rsrc_sort_directory.  */
 
 static void
-rsrc_sort_entries (rsrc_dir_chain *chain,
-		   bool is_name,
-		   rsrc_directory *dir)
+rsrc_combine_entries (rsrc_dir_chain *chain,
+		      bool is_name,
+		      rsrc_directory *dir)
 {
   rsrc_entry * entry;
   rsrc_entry * next;
   rsrc_entry ** points_to_entry;
-  bool swapped;
 
   if (chain->num_entries < 2)
     return;
 
-  do
-    {
-      swapped = false;
-      points_to_entry = & chain->first_entry;
-      entry = * points_to_entry;
-      next  = entry->next_entry;
+  chain->first_entry = rsrc_sort_list (chain->first_entry, is_name);
 
-      do
+  points_to_entry = & chain->first_entry;
+  entry = * points_to_entry;
+  while ((next = entry->next_entry) != NULL)
+    {
+      if (rsrc_cmp (is_name, entry, next) != 0)
 	{
-	  signed int cmp = rsrc_cmp (is_name, entry, next);
+	  points_to_entry = & entry->next_entry;
+	  entry = next;
+	  continue;
+	}
 
-	  if (cmp > 0)
-	    {
-	      entry->next_entry = next->next_entry;
-	      next->next_entry = entry;
-	      * points_to_entry = next;
-	      points_to_entry = & next->next_entry;
-	      next = entry->next_entry;
-	      swapped = true;
-	    }
-	  else if (cmp == 0)
+      if (entry->is_dir && next->is_dir)
+	{
+	  /* When we encounter identical directory entries we have to
+	     merge them together.  The exception to this rule is for
+	     resource manifests - there can only be one of these,
+	     even if they differ in language.  Zero-language manifests
+	     are assumed to be default manifests (provided by the
+	     Cygwin/MinGW build system) and these can be silently dropped,
+	     unless that would reduce the number of manifests to zero.
+	     There should only ever be one non-zero lang manifest -
+	     if there are more it is an error.  A non-zero lang
+	     manifest takes precedence over a default manifest.  */
+	  if (!entry->is_name
+	      && entry->name_id.id == 1
+	      && dir != NULL
+	      && dir->entry != NULL
+	      && !dir->entry->is_name
+	      && dir->entry->name_id.id == 0x18)
 	    {
-	      if (entry->is_dir && next->is_dir)
+	      if (next->value.directory->names.num_entries == 0
+		  && next->value.directory->ids.num_entries == 1
+		  && !next->value.directory->ids.first_entry->is_name
+		  && next->value.directory->ids.first_entry->name_id.id == 0)
+		/* Fall through so that NEXT is dropped.  */
+		;
+	      else if (entry->value.directory->names.num_entries == 0
+		       && entry->value.directory->ids.num_entries == 1
+		       && !entry->value.directory->ids.first_entry->is_name
+		       && entry->value.directory->ids.first_entry->name_id.id == 0)
 		{
-		  /* When we encounter identical directory entries we have to
-		     merge them together.  The exception to this rule is for
-		     resource manifests - there can only be one of these,
-		     even if they differ in language.  Zero-language manifests
-		     are assumed to be default manifests (provided by the
-		     Cygwin/MinGW build system) and these can be silently dropped,
-		     unless that would reduce the number of manifests to zero.
-		     There should only ever be one non-zero lang manifest -
-		     if there are more it is an error.  A non-zero lang
-		     manifest takes precedence over a default manifest.  */
-		  if (!entry->is_name
-		      && entry->name_id.id == 1
-		      && dir != NULL
-		      && dir->entry != NULL
-		      && !dir->entry->is_name
-		      && dir->entry->name_id.id == 0x18)
-		    {
-		      if (next->value.directory->names.num_entries == 0
-			  && next->value.directory->ids.num_entries == 1
-			  && !next->value.directory->ids.first_entry->is_name
-			  && next->value.directory->ids.first_entry->name_id.id == 0)
-			/* Fall through so that NEXT is dropped.  */
-			;
-		      else if (entry->value.directory->names.num_entries == 0
-			       && entry->value.directory->ids.num_entries == 1
-			       && !entry->value.directory->ids.first_entry->is_name
-			       && entry->value.directory->ids.first_entry->name_id.id == 0)
-			{
-			  /* Swap ENTRY and NEXT.  Then fall through so that the old ENTRY is dropped.  */
-			  entry->next_entry = next->next_entry;
-			  next->next_entry = entry;
-			  * points_to_entry = next;
-			  points_to_entry = & next->next_entry;
-			  next = entry->next_entry;
-			  swapped = true;
-			}
-		      else
-			{
-			  _bfd_error_handler (_(".rsrc merge failure: multiple non-default manifests"));
-			  bfd_set_error (bfd_error_file_truncated);
-			  return;
-			}
-
-		      /* Unhook NEXT from the chain.  */
-		      /* FIXME: memory loss here.  */
-		      entry->next_entry = next->next_entry;
-		      chain->num_entries --;
-		      if (chain->num_entries < 2)
-			return;
-		      next = next->next_entry;
-		    }
-		  else
-		    rsrc_merge (entry, next);
+		  /* Unhook ENTRY from the chain, so that NEXT takes
+		     its place.  */
+		  * points_to_entry = next;
+		  chain->num_entries --;
+		  entry = next;
+		  continue;
 		}
-	      else if (entry->is_dir != next->is_dir)
+	      else
 		{
-		  _bfd_error_handler (_(".rsrc merge failure: a directory matches a leaf"));
+		  _bfd_error_handler (_(".rsrc merge failure: multiple non-default manifests"));
 		  bfd_set_error (bfd_error_file_truncated);
-		  return;
+		  break;
 		}
-	      else
+	    }
+	  else
+	    rsrc_merge (entry, next);
+	}
+      else if (entry->is_dir != next->is_dir)
+	{
+	  _bfd_error_handler (_(".rsrc merge failure: a directory matches a leaf"));
+	  bfd_set_error (bfd_error_file_truncated);
+	  break;
+	}
+      else
+	{
+	  /* Otherwise with identical leaves we issue an error
+	     message - because there should never be duplicates.
+	     The exception is Type 18/Name 1/Lang 0 which is the
+	     defaul manifest - this can just be dropped.  */
+	  if (!entry->is_name
+	      && entry->name_id.id == 0
+	      && dir != NULL
+	      && dir->entry != NULL
+	      && !dir->entry->is_name
+	      && dir->entry->name_id.id == 1
+	      && dir->entry->parent != NULL
+	      && dir->entry->parent->entry != NULL
+	      && !dir->entry->parent->entry->is_name
+	      && dir->entry->parent->entry->name_id.id == 0x18 /* RT_MANIFEST */)
+	    ;
+	  else if (dir != NULL
+		   && dir->entry != NULL
+		   && dir->entry->parent != NULL
+		   && dir->entry->parent->entry != NULL
+		   && !dir->entry->parent->entry->is_name
+		   && dir->entry->parent->entry->name_id.id == 0x6 /* RT_STRING */)
+	    {
+	      /* Strings need special handling.  */
+	      if (! rsrc_merge_string_entries (entry, next))
 		{
-		  /* Otherwise with identical leaves we issue an error
-		     message - because there should never be duplicates.
-		     The exception is Type 18/Name 1/Lang 0 which is the
-		     defaul manifest - this can just be dropped.  */
-		  if (!entry->is_name
-		      && entry->name_id.id == 0
-		      && dir != NULL
-		      && dir->entry != NULL
-		      && !dir->entry->is_name
-		      && dir->entry->name_id.id == 1
-		      && dir->entry->parent != NULL
-		      && dir->entry->parent->entry != NULL
-		      && !dir->entry->parent->entry->is_name
-		      && dir->entry->parent->entry->name_id.id == 0x18 /* RT_MANIFEST */)
-		    ;
-		  else if (dir != NULL
-			   && dir->entry != NULL
-			   && dir->entry->parent != NULL
-			   && dir->entry->parent->entry != NULL
-			   && !dir->entry->parent->entry->is_name
-			   && dir->entry->parent->entry->name_id.id == 0x6 /* RT_STRING */)
-		    {
-		      /* Strings need special handling.  */
-		      if (! rsrc_merge_string_entries (entry, next))
-			{
-			  /* _bfd_error_handler should have been called inside merge_strings.  */
-			  bfd_set_error (bfd_error_file_truncated);
-			  return;
-			}
-		    }
-		  else
-		    {
-		      if (dir == NULL
-			  || dir->entry == NULL
-			  || dir->entry->parent == NULL
-			  || dir->entry->parent->entry == NULL)
-			_bfd_error_handler (_(".rsrc merge failure: duplicate leaf"));
-		      else
-			{
-			  char buff[256];
-
-			  _bfd_error_handler (_(".rsrc merge failure: duplicate leaf: %s"),
-					      rsrc_resource_name (entry, dir, buff));
-			}
-		      bfd_set_error (bfd_error_file_truncated);
-		      return;
-		    }
+		  /* _bfd_error_handler should have been called inside merge_strings.  */
+		  bfd_set_error (bfd_error_file_truncated);
+		  break;
 		}
-
-	      /* Unhook NEXT from the chain.  */
-	      entry->next_entry = next->next_entry;
-	      chain->num_entries --;
-	      if (chain->num_entries < 2)
-		return;
-	      next = next->next_entry;
 	    }
 	  else
 	    {
-	      points_to_entry = & entry->next_entry;
-	      entry = next;
-	      next = next->next_entry;
+	      if (dir == NULL
+		  || dir->entry == NULL
+		  || dir->entry->parent == NULL
+		  || dir->entry->parent->entry == NULL)
+		_bfd_error_handler (_(".rsrc merge failure: duplicate leaf"));
+	      else
+		{
+		  char buff[256];
+
+		  _bfd_error_handler (_(".rsrc merge failure: duplicate leaf: %s"),
+				      rsrc_resource_name (entry, dir, buff));
+		}
+	      bfd_set_error (bfd_error_file_truncated);
+	      break;
 	    }
 	}
-      while (next);
 
-      chain->last_entry = entry;
+      /* Unhook NEXT from the chain.  */
+      /* FIXME: memory loss here.  */
+      entry->next_entry = next->next_entry;
+      chain->num_entries --;
     }
-  while (swapped);
+
+  while (entry->next_entry != NULL)
+    entry = entry->next_entry;
+  chain->last_entry = entry;
+}
+
+/* Sort the entries in given part of the directory, and then those
+   of the directories in it that had others merged into them.  */
+
+static void
+rsrc_sort_entries (rsrc_dir_chain *chain,
+		   bool is_name,
+		   rsrc_directory *dir)
+{
+  rsrc_entry * entry;
+
+  rsrc_combine_entries (chain, is_name, dir);
+
+  for (entry = chain->first_entry; entry != NULL; entry = entry->next_entry)
+    if (entry->is_dir)
+      rsrc_sort_directory (entry->value.directory);
+}
+
+/* Sort the entries of DIR if another directory has been merged into
+   it since they were last sorted.  */
+
+static void
+rsrc_sort_directory (rsrc_directory *dir)
+{
+  if (dir == NULL || ! dir->needs_sort)
+    return;
+
+  dir->needs_sort = false;
+  rsrc_sort_entries (& dir->names, true, dir);
+  rsrc_sort_entries (& dir->ids, false, dir);
+}
+
+/* Sort the directories of entries START to END of the array DATA on
+   one thread.  */
+
+static bool
+rsrc_sort_directory_range (void *data, size_t start, size_t end)
+{
+  rsrc_entry **entries = (rsrc_entry **) data;
+
+  for (; start < end; start++)
+    rsrc_sort_directory (entries[start]->value.directory);
+  return true;
+}
+
+/* Sort the type directories of TABLE that had others merged into
+   them.  Each is a separate tree, so they are sorted on as many
+   threads as are configured.  */
+
+static bool
+rsrc_sort_types (rsrc_directory *table)
+{
+  rsrc_dir_chain *chains[2] = { & table->names, & table->ids };
+  rsrc_entry **entries;
+  rsrc_entry *entry;
+  size_t count = 0;
+  unsigned int i;
+  bool ret;
+
+  for (i = 0; i < 2; i++)
+    for (entry = chains[i]->first_entry; entry != NULL;
+	 entry = entry->next_entry)
+      if (entry->is_dir && entry->value.directory->needs_sort)
+	count++;
+  if (count == 0)
+    return true;
+
+  entries = bfd_malloc (count * sizeof (*entries));
+  if (entries == NULL)
+    return false;
+
+  count = 0;
+  for (i = 0; i < 2; i++)
+    for (entry = chains[i]->first_entry; entry != NULL;
+	 entry = entry->next_entry)
+      if (entry->is_dir && entry->value.directory->needs_sort)
+	entries[count++] = entry;
+
+  ret = _bfd_parallel_for (count, 1, rsrc_sort_directory_range, entries);
+  free (entries);
+  return ret;
 }
 
 /* Attach B's chain onto A.  */
@@ -4162,9 +4327,9 @@ rsrc_merge (struct rsrc_entry * a, struct rsrc_entry * b)
   /* Attach B's ID chain to A.  */
   rsrc_attach_chain (& adir->ids, & bdir->ids);
 
-  /* Now sort A's entries.  */
-  rsrc_sort_entries (& adir->names, true, adir);
-  rsrc_sort_entries (& adir->ids, false, adir);
+  /* A's entries are sorted once all the matching directories have
+     been attached.  */
+  adir->needs_sort = true;
 }
 
 /* Check the .rsrc section.  If it contains multiple concatenated
@@ -4195,6 +4360,8 @@ rsrc_process_section (bfd * abfd,
 
   new_table.names.num_entries = 0;
   new_table.ids.num_entries = 0;
+  new_table.entry = NULL;
+  new_table.needs_sort = false;
 
   sec = bfd_get_section_by_name (abfd, ".rsrc");
   if (sec == NULL || (size = sec->rawsize) == 0)
@@ -4326,7 +4493,7 @@ rsrc_process_section (bfd * abfd,
   for (indx = 0; indx < num_resource_sets; indx++)
     rsrc_attach_chain (& new_table.names, & type_tables[indx].names);
 
-  rsrc_sort_entries (& new_table.names, true, & new_table);
+  rsrc_combine_entries (& new_table.names, true, & new_table);
 
   /* Chain the ID entries onto the table.  */
   new_table.ids.first_entry = NULL;
@@ -4335,7 +4502,11 @@ rsrc_process_section (bfd * abfd,
   for (indx = 0; indx < num_resource_sets; indx++)
     rsrc_attach_chain (& new_table.ids, & type_tables[indx].ids);
 
-  rsrc_sort_entries (& new_table.ids, false, & new_table);
+  rsrc_combine_entries (& new_table.ids, false, & new_table);
+
+  /* Then sort the type directories that had others merged into them.  */
+  if (! rsrc_sort_types (& new_table))
+    goto end;
 
   /* Step four: Create new contents for the .rsrc section.  */
   /* Step four point one: Compute the size of each region of the .rsrc section.
@@ -127,17 +127,21 @@ message (int level ATTRIBUTE_UNUSED,
 
 struct plugin_list_entry
 {
-  /* These must be initialized for each IR object with LTO wrapper.  */
+  /* These are set up by the plugin's onload function.  */
   ld_plugin_claim_file_handler claim_file;
   ld_plugin_claim_file_handler_v2 claim_file_v2;
   ld_plugin_all_symbols_read_handler all_symbols_read;
   ld_plugin_all_symbols_read_handler cleanup_handler;
-  bool has_symbol_type;
 
   struct plugin_list_entry *next;
 
   /* These can be reused for all IR objects.  */
   const char *plugin_name;
+  /* The plugin library, kept loaded once it has been opened.  */
+  void *handle;
+  /* Whether onload has been called, and whether it succeeded.  */
+  bool onload_called;
+  bool onload_ok;
 };
 
 static const char *plugin_program_name;
@@ -184,6 +188,7 @@ add_symbols (void * handle,
 
   plugin_data->nsyms = nsyms;
   plugin_data->syms = syms;
+  plugin_data->has_symbol_type = false;
 
   if (nsyms != 0)
     abfd->flags |= HAS_SYMS;
@@ -196,8 +201,12 @@ static enum ld_plugin_status
 add_symbols_v2 (void *handle, int nsyms,
 		const struct ld_plugin_symbol *syms)
 {
-  current_plugin->has_symbol_type = true;
-  return add_symbols (handle, nsyms, syms);
+  bfd *abfd = handle;
+
+  if (add_symbols (handle, nsyms, syms) != LDPS_OK)
+    return LDPS_ERR;
+  abfd->tdata.plugin_data->has_symbol_type = true;
+  return LDPS_OK;
 }
 
 int
@@ -347,32 +356,33 @@ try_load_plugin (const char *pname,
 		 bfd *abfd,
 		 bool build_list_p)
 {
-  void *plugin_handle;
+  void *plugin_handle = NULL;
   struct ld_plugin_tv tv[6];
   int i;
   ld_plugin_onload onload;
   enum ld_plugin_status status;
-  bool result = false;
-
-  /* NB: Each object is independent.  Reuse the previous plugin from
-     the last run will lead to wrong result.  */
-  if (current_plugin)
-    memset (current_plugin, 0,
-	    offsetof (struct plugin_list_entry, next));
 
   if (plugin_list_iter)
-    pname = plugin_list_iter->plugin_name;
+    {
+      pname = plugin_list_iter->plugin_name;
+      plugin_handle = plugin_list_iter->handle;
+    }
 
-  plugin_handle = dlopen (pname, RTLD_NOW);
-  if (!plugin_handle)
+  /* Plugins are opened once and stay loaded, so that checking many
+     objects does not load and relocate the library for each one.  */
+  if (plugin_handle == NULL)
     {
-      /* If we are building a list of viable plugins, then
-	 we do not bother the user with the details of any
-	 plugins that cannot be loaded.  */
-      if (! build_list_p)
-	_bfd_error_handler ("Failed to load plugin '%s', reason: %s\n",
-			    pname, dlerror ());
-      return false;
+      plugin_handle = dlopen (pname, RTLD_NOW);
+      if (!plugin_handle)
+	{
+	  /* If we are building a list of viable plugins, then
+	     we do not bother the user with the details of any
+	     plugins that cannot be loaded.  */
+	  if (! build_list_p)
+	    _bfd_error_handler ("Failed to load plugin '%s', reason: %s\n",
+				pname, dlerror ());
+	  return false;
+	}
     }
 
   if (plugin_list_iter == NULL)
@@ -381,12 +391,16 @@ try_load_plugin (const char *pname,
       char *plugin_name = bfd_malloc (length_plugin_name);
 
       if (plugin_name == NULL)
-	goto short_circuit;
+	{
+	  dlclose (plugin_handle);
+	  return false;
+	}
       plugin_list_iter = bfd_malloc (sizeof *plugin_list_iter);
       if (plugin_list_iter == NULL)
 	{
 	  free (plugin_name);
-	  goto short_circuit;
+	  dlclose (plugin_handle);
+	  return false;
 	}
       /* Make a copy of PNAME since PNAME from load_plugin () will be
 	 freed.  */
@@ -396,59 +410,67 @@ try_load_plugin (const char *pname,
       plugin_list_iter->next = plugin_list;
       plugin_list = plugin_list_iter;
     }
+  plugin_list_iter->handle = plugin_handle;
 
   current_plugin = plugin_list_iter;
   if (build_list_p)
-    goto short_circuit;
+    return false;
 
-  onload = dlsym (plugin_handle, "onload");
-  if (!onload)
-    goto short_circuit;
+  /* Like the linker, set the plugin up once and then ask it about
+     each object in turn.  */
+  if (!current_plugin->onload_called)
+    {
+      current_plugin->onload_called = true;
+
+      onload = dlsym (plugin_handle, "onload");
+      if (!onload)
+	return false;
+
+      i = 0;
+      tv[i].tv_tag = LDPT_MESSAGE;
+      tv[i].tv_u.tv_message = message;
 
-  i = 0;
-  tv[i].tv_tag = LDPT_MESSAGE;
-  tv[i].tv_u.tv_message = message;
+      ++i;
+      tv[i].tv_tag = LDPT_REGISTER_CLAIM_FILE_HOOK;
+      tv[i].tv_u.tv_register_claim_file = register_claim_file;
 
-  ++i;
-  tv[i].tv_tag = LDPT_REGISTER_CLAIM_FILE_HOOK;
-  tv[i].tv_u.tv_register_claim_file = register_claim_file;
+      ++i;
+      tv[i].tv_tag = LDPT_REGISTER_CLAIM_FILE_HOOK_V2;
+      tv[i].tv_u.tv_register_claim_file_v2 = register_claim_file_v2;
 
-  ++i;
-  tv[i].tv_tag = LDPT_REGISTER_CLAIM_FILE_HOOK_V2;
-  tv[i].tv_u.tv_register_claim_file_v2 = register_claim_file_v2;
+      ++i;
+      tv[i].tv_tag = LDPT_ADD_SYMBOLS;
+      tv[i].tv_u.tv_add_symbols = add_symbols;
 
-  ++i;
-  tv[i].tv_tag = LDPT_ADD_SYMBOLS;
-  tv[i].tv_u.tv_add_symbols = add_symbols;
+      ++i;
+      tv[i].tv_tag = LDPT_ADD_SYMBOLS_V2;
+      tv[i].tv_u.tv_add_symbols = add_symbols_v2;
 
-  ++i;
-  tv[i].tv_tag = LDPT_ADD_SYMBOLS_V2;
-  tv[i].tv_u.tv_add_symbols = add_symbols_v2;
+      ++i;
+      tv[i].tv_tag = LDPT_NULL;
+      tv[i].tv_u.tv_val = 0;
 
-  ++i;
-  tv[i].tv_tag = LDPT_NULL;
-  tv[i].tv_u.tv_val = 0;
+      /* LTO plugin will call handler hooks to set up plugin handlers.  */
+      status = (*onload)(tv);
 
-  /* LTO plugin will call handler hooks to set up plugin handlers.  */
-  status = (*onload)(tv);
+      if (status != LDPS_OK)
+	return false;
+      current_plugin->onload_ok = true;
+    }
 
-  if (status != LDPS_OK)
-    goto short_circuit;
+  if (!current_plugin->onload_ok)
+    return false;
 
   abfd->plugin_format = bfd_plugin_no;
 
   if (!current_plugin->claim_file)
-    goto short_circuit;
+    return false;
 
   if (!try_claim (abfd))
-    goto short_circuit;
+    return false;
 
   abfd->plugin_format = bfd_plugin_yes;
-  result = true;
-
- short_circuit:
-  dlclose (plugin_handle);
-  return result;
+  return true;
 }
 
 /* There may be plugin libraries in lib/bfd-plugins.  */
@@ -458,10 +480,184 @@ static bfd_cleanup (*ld_plugin_object_p) (bfd *, bool);
 
 static const char *plugin_name;
 
+/* The result of asking the plugins about one file or archive member.
+   Tools such as nm and ar open the same inputs many times, and the
+   claim handler is by far the most expensive part of a check, so the
+   answer is remembered for as long as the file is unchanged.  */
+
+struct claim_cache_entry
+{
+  hashval_t hash;
+  /* The file, the member's offset within it, and the size and
+     modification time of the file when it was claimed.  */
+  char *name;
+  file_ptr origin;
+  off_t size;
+  time_t mtime;
+  /* Whether a plugin claimed it, and the symbols it added.  */
+  bool claimed;
+  int nsyms;
+  const struct ld_plugin_symbol *syms;
+  bool has_symbol_type;
+};
+
+static htab_t claim_cache;
+
+/* Hash function for the claim cache.  */
+
+static hashval_t
+claim_cache_hash (const void *p)
+{
+  return ((const struct claim_cache_entry *) p)->hash;
+}
+
+/* Compare two claim cache entries.  */
+
+static int
+claim_cache_eq (const void *a, const void *b)
+{
+  const struct claim_cache_entry *x = (const struct claim_cache_entry *) a;
+  const struct claim_cache_entry *y = (const struct claim_cache_entry *) b;
+
+  return (x->hash == y->hash
+	  && x->origin == y->origin
+	  && x->size == y->size
+	  && x->mtime == y->mtime
+	  && strcmp (x->name, y->name) == 0);
+}
+
+/* Free a claim cache entry.  */
+
+static void
+claim_cache_del (void *p)
+{
+  struct claim_cache_entry *ent = (struct claim_cache_entry *) p;
+
+  free (ent->name);
+  free (ent);
+}
+
+/* Set up KEY to look ABFD up in the claim cache.  Return false if
+   ABFD's file cannot be identified.  */
+
+static bool
+claim_cache_key (bfd *abfd, struct claim_cache_entry *key)
+{
+  bfd *iobfd = abfd;
+  struct stat st;
+
+  /* Identify archive members the way bfd_plugin_open_input finds
+     the file it hands to the plugin.  */
+  while (iobfd->my_archive
+	 && !bfd_is_thin_archive (iobfd->my_archive))
+    iobfd = iobfd->my_archive;
+  if ((iobfd->flags & BFD_IN_MEMORY) != 0
+      || stat (bfd_get_filename (iobfd), &st) != 0)
+    return false;
+
+  key->name = (char *) bfd_get_filename (iobfd);
+  key->origin = iobfd != abfd ? abfd->origin : 0;
+  key->size = st.st_size;
+  key->mtime = st.st_mtime;
+  key->hash = (htab_hash_string (key->name)
+	       ^ (hashval_t) (key->origin * 31));
+  return true;
+}
+
+/* Look ABFD up in the claim cache, and if it is there set ABFD up as
+   the plugins left it and return true.  The plugin lock must be
+   held.  */
+
+static bool
+claim_cache_lookup (bfd *abfd)
+{
+  struct claim_cache_entry key, *ent;
+  struct plugin_data_struct *plugin_data;
+
+  if (claim_cache == NULL || !claim_cache_key (abfd, &key))
+    return false;
+  ent = (struct claim_cache_entry *) htab_find (claim_cache, &key);
+  if (ent == NULL)
+    return false;
+
+  if (!ent->claimed)
+    {
+      abfd->plugin_format = bfd_plugin_no;
+      return true;
+    }
+
+  plugin_data = bfd_alloc (abfd, sizeof (*plugin_data));
+  if (plugin_data == NULL)
+    return false;
+  plugin_data->nsyms = ent->nsyms;
+  plugin_data->syms = ent->syms;
+  plugin_data->has_symbol_type = ent->has_symbol_type;
+  if (ent->nsyms != 0)
+    abfd->flags |= HAS_SYMS;
+  abfd->tdata.plugin_data = plugin_data;
+  abfd->plugin_format = bfd_plugin_yes;
+  return true;
+}
+
+/* Remember what the plugins made of ABFD.  The symbols stay valid
+   since the plugins are never unloaded or cleaned up.  The plugin
+   lock must be held.  */
+
+static void
+claim_cache_insert (bfd *abfd)
+{
+  struct claim_cache_entry key, *ent;
+  void **slot;
+
+  if (abfd->plugin_format == bfd_plugin_unknown
+      || !claim_cache_key (abfd, &key))
+    return;
+
+  if (claim_cache == NULL)
+    {
+      claim_cache = htab_create_alloc (64, claim_cache_hash, claim_cache_eq,
+				       claim_cache_del, xcalloc, free);
+      if (claim_cache == NULL)
+	return;
+    }
+
+  slot = htab_find_slot (claim_cache, &key, INSERT);
+  if (slot == NULL || *slot != NULL)
+    return;
+  ent = (struct claim_cache_entry *) malloc (sizeof (*ent));
+  if (ent != NULL)
+    {
+      *ent = key;
+      ent->name = strdup (key.name);
+    }
+  if (ent == NULL || ent->name == NULL)
+    {
+      free (ent);
+      htab_clear_slot (claim_cache, slot);
+      return;
+    }
+
+  ent->claimed = abfd->plugin_format == bfd_plugin_yes;
+  ent->nsyms = 0;
+  ent->syms = NULL;
+  ent->has_symbol_type = false;
+  if (ent->claimed && abfd->tdata.plugin_data != NULL)
+    {
+      ent->nsyms = abfd->tdata.plugin_data->nsyms;
+      ent->syms = abfd->tdata.plugin_data->syms;
+      ent->has_symbol_type = abfd->tdata.plugin_data->has_symbol_type;
+    }
+  *slot = ent;
+}
+
 void
 bfd_plugin_set_plugin (const char *p)
 {
   plugin_name = p;
+
+  /* Answers from other plugins no longer apply.  */
+  if (claim_cache != NULL)
+    htab_empty (claim_cache);
 }
 
 /* Return TRUE if a plugin library is used.  */
@@ -586,13 +782,32 @@ load_plugin (bfd *abfd)
 }
 
 
+/* Serializes plugin loading and claiming, which use the plugin list,
+   the claim cache and the archive's plugin file descriptor, when the
+   members of an archive are checked on several threads.  */
+static bfd_mutex plugin_lock = BFD_MUTEX_INIT;
+
 static bfd_cleanup
 bfd_plugin_object_p (bfd *abfd)
 {
+  bool loaded;
+
   if (ld_plugin_object_p)
     return ld_plugin_object_p (abfd, false);
 
-  if (abfd->plugin_format == bfd_plugin_unknown && !load_plugin (abfd))
+  _bfd_mutex_lock (&plugin_lock);
+  loaded = abfd->plugin_format != bfd_plugin_unknown;
+  if (!loaded)
+    {
+      loaded = claim_cache_lookup (abfd);
+      if (!loaded)
+	{
+	  loaded = load_plugin (abfd);
+	  claim_cache_insert (abfd);
+	}
+    }
+  _bfd_mutex_unlock (&plugin_lock);
+  if (!loaded)
     return NULL;
 
   return abfd->plugin_format == bfd_plugin_yes ? _bfd_no_cleanup : NULL;
@@ -736,7 +951,7 @@ bfd_plugin_canonicalize_symtab (bfd *abfd,
 	  break;
 	case LDPK_DEF:
 	case LDPK_WEAKDEF:
-	  if (current_plugin->has_symbol_type)
+	  if (plugin_data->has_symbol_type)
 	    switch (syms[i].symbol_type)
 	      {
 	      default:
@@ -34,6 +34,9 @@ typedef struct plugin_data_struct
 {
   int nsyms;
   const struct ld_plugin_symbol *syms;
+  /* Whether the symbols came through add_symbols_v2 and so have
+     symbol_type and section_kind set.  */
+  bool has_symbol_type;
 }
 plugin_data_struct;
 
@@ -62,6 +62,9 @@ struct pr_stack
   struct pr_stack *next;
   /* This element.  */
   char *type;
+  /* Length of TYPE and size of the buffer holding it.  */
+  size_t len;
+  size_t alloc;
   /* Current visibility of fields if this is a class.  */
   enum debug_visibility visibility;
   /* Name of the current method we are handling.  */
@@ -332,6 +335,8 @@ push_type (struct pr_handle *info, const char *type)
   memset (n, 0, sizeof *n);
 
   n->type = xstrdup (type);
+  n->len = strlen (type);
+  n->alloc = n->len + 1;
   n->visibility = DEBUG_VISIBILITY_IGNORE;
   n->method = NULL;
   n->next = info->stack;
@@ -340,19 +345,41 @@ push_type (struct pr_handle *info, const char *type)
   return true;
 }
 
+/* Replace COUNT characters at POS in the type on the top of the type
+   stack with S.  The buffer holding the type grows geometrically, so
+   that building up a type a piece at a time takes linear time.  */
+
+static void
+splice_type (struct pr_handle *info, size_t pos, size_t count, const char *s)
+{
+  struct pr_stack *top = info->stack;
+  size_t slen = strlen (s);
+  size_t len = top->len - count + slen;
+
+  if (len + 1 > top->alloc)
+    {
+      size_t alloc = top->alloc < 64 ? 64 : top->alloc;
+
+      while (alloc < len + 1)
+	alloc *= 2;
+      top->type = xrealloc (top->type, alloc);
+      top->alloc = alloc;
+    }
+
+  memmove (top->type + pos + slen, top->type + pos + count,
+	   top->len - pos - count + 1);
+  memcpy (top->type + pos, s, slen);
+  top->len = len;
+}
+
 /* Prepend a string onto the type on the top of the type stack.  */
 
 static bool
 prepend_type (struct pr_handle *info, const char *s)
 {
-  char *n;
-
   assert (info->stack != NULL);
 
-  n = xmalloc (strlen (s) + strlen (info->stack->type) + 1);
-  sprintf (n, "%s%s", s, info->stack->type);
-  free (info->stack->type);
-  info->stack->type = n;
+  splice_type (info, 0, 0, s);
 
   return true;
 }
@@ -362,16 +389,12 @@ prepend_type (struct pr_handle *info, const char *s)
 static bool
 append_type (struct pr_handle *info, const char *s)
 {
-  unsigned int len;
-
   if (s == NULL)
     return false;
 
   assert (info->stack != NULL);
 
-  len = strlen (info->stack->type);
-  info->stack->type = xrealloc (info->stack->type, len + strlen (s) + 1);
-  strcpy (info->stack->type + len, s);
+  splice_type (info, info->stack->len, 0, s);
 
   return true;
 }
@@ -409,16 +432,7 @@ substitute_type (struct pr_handle *info, const char *s)
   u = strchr (info->stack->type, '|');
   if (u != NULL)
     {
-      char *n;
-
-      n = xmalloc (strlen (info->stack->type) + strlen (s));
-
-      memcpy (n, info->stack->type, u - info->stack->type);
-      strcpy (n + (u - info->stack->type), s);
-      strcat (n, u + 1);
-
-      free (info->stack->type);
-      info->stack->type = n;
+      splice_type (info, u - info->stack->type, 1, s);
 
       return true;
     }
@@ -1085,9 +1099,10 @@ pr_fix_visibility (struct pr_handle *info, enum debug_visibility visibility)
      output look a bit better, then stick on the visibility string.  */
 
   t = info->stack->type;
-  len = strlen (t);
+  len = info->stack->len;
   assert (t[len - 1] == ' ');
   t[len - 1] = '\0';
+  info->stack->len = len - 1;
 
   if (! append_type (info, s)
       || ! append_type (info, ":\n")
@@ -1154,11 +1169,12 @@ pr_end_struct_type (void *p)
   info->indent -= 2;
 
   /* Change the trailing indentation to have a close brace.  */
-  s = info->stack->type + strlen (info->stack->type) - 2;
+  s = info->stack->type + info->stack->len - 2;
   assert (s[0] == ' ' && s[1] == ' ' && s[2] == '\0');
 
   *s++ = '}';
   *s = '\0';
+  --info->stack->len;
 
   return true;
 }
@@ -1292,7 +1308,7 @@ pr_class_baseclass (void *p, bfd_vma bitpos, bool is_virtual,
   char *t;
   const char *prefix;
   char ab[22];
-  char *s, *l, *n;
+  char *s, *l;
 
   assert (info->stack != NULL && info->stack->next != NULL);
 
@@ -1367,13 +1383,7 @@ pr_class_baseclass (void *p, bfd_vma bitpos, bool is_virtual,
   if (t == NULL)
     return false;
 
-  n = xmalloc (strlen (info->stack->type) + strlen (t) + 1);
-  memcpy (n, info->stack->type, s - info->stack->type);
-  strcpy (n + (s - info->stack->type), t);
-  strcat (n, s);
-
-  free (info->stack->type);
-  info->stack->type = n;
+  splice_type (info, s - info->stack->type, 0, t);
 
   free (t);
 
@@ -0,0 +1,658 @@
+/* Keeping BFDs open between requests.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/*
+SECTION
+	Resident BFDs
+
+	A program that answers many requests about the same files,
+	such as a server that symbolizes addresses for its clients,
+	can keep the BFDs it opens between requests with
+	<<bfd_resident_open>>.  What a BFD has read from its file
+	stays with it: an archive's map and the members opened so
+	far, the symbol table once asked for with
+	<<bfd_resident_symbols>>, and the DWARF tables built by
+	<<bfd_find_nearest_line>>.  Only the first request about a
+	file pays for reading them.
+
+	Each open checks that the file is still the one that was
+	read, by its size, modification time and, where the host has
+	them, its device and inode numbers.  A file that has changed
+	is opened afresh, and the old BFD is closed once nobody is
+	using it.  Up to <<bfd_resident_set_limit>> BFDs that nobody
+	is using are kept, the least recently used being closed
+	first.
+
+	Any number of threads may open resident BFDs at once, but
+	each resident BFD has one user at a time: a second caller
+	opening the same file waits until the first releases it,
+	since a BFD's file position and caches are its own.
+
+	Build systems often hand over the same object under many
+	names.  <<bfd_resident_open_contents>> finds a resident BFD by
+	a digest of the file's contents instead of its name, so that
+	all the copies share one BFD and what it has read.  The caller
+	can pass a digest it already has, such as the key of a remote
+	build cache, or have one worked out.
+
+	A link writes to the BFDs it reads, giving each input section
+	an output section and each symbol a link hash table entry, so
+	a BFD that has been through a link must not be made resident,
+	nor a resident BFD linked.
+*/
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libbfd.h"
+#include "libiberty.h"
+#include "hashtab.h"
+
+/*
+CODE_FRAGMENT
+.{* A BFD kept open by <<bfd_resident_open>>.  *}
+.typedef struct bfd_resident bfd_resident;
+.
+*/
+
+struct bfd_resident
+{
+  /* The canonical file name, and the target and format asked for.
+     TARGET is NULL for the default.  */
+  char *path;
+  char *target;
+  bfd_format format;
+
+  /* For an entry found by the contents of its file rather than its
+     name, the digest of the contents.  */
+  bfd_byte *digest;
+  size_t digest_len;
+
+  /* What says the file hasn't changed since it was opened.  */
+  uint64_t size;
+  int64_t mtime;
+  uint64_t ino;
+  uint64_t dev;
+
+  /* The open BFD, or NULL if opening it failed, in which case ERROR
+     says why.  */
+  bfd *abfd;
+  bfd_error_type error;
+
+  /* The canonical symbol table, once read.  */
+  asymbol **syms;
+  long symcount;
+  bool have_syms;
+
+  /* The number of callers using the BFD or waiting to.  */
+  unsigned int users;
+
+  /* Set once the entry has been taken out of resident_table, so is
+     freed when the last user releases it.  */
+  bool stale;
+
+  /* Held by the caller using the BFD.  */
+  bfd_mutex lock;
+
+  /* The list of entries nobody is using, least recently released
+     first.  */
+  struct bfd_resident *idle_prev;
+  struct bfd_resident *idle_next;
+};
+
+/* Guards everything below, and the USERS, STALE and idle list fields
+   of each entry.  */
+static bfd_mutex resident_lock = BFD_MUTEX_INIT;
+
+/* The entries of files not known to have changed, keyed by path or
+   digest, target and format.  */
+static htab_t resident_table;
+
+/* The entries nobody is using, how many there are, and how many to
+   keep.  */
+static struct bfd_resident *resident_idle_head;
+static struct bfd_resident *resident_idle_tail;
+static unsigned int resident_idle_count;
+static unsigned int resident_limit = 64;
+
+static hashval_t
+resident_hash (const void *p)
+{
+  const struct bfd_resident *ent = (const struct bfd_resident *) p;
+  hashval_t h;
+
+  if (ent->digest_len != 0)
+    h = iterative_hash (ent->digest, ent->digest_len, ent->format);
+  else
+    h = htab_hash_string (ent->path) * 31 + ent->format;
+
+  if (ent->target != NULL)
+    h = h * 31 + htab_hash_string (ent->target);
+  return h;
+}
+
+static int
+resident_eq (const void *p1, const void *p2)
+{
+  const struct bfd_resident *a = (const struct bfd_resident *) p1;
+  const struct bfd_resident *b = (const struct bfd_resident *) p2;
+
+  return (a->format == b->format
+	  && a->digest_len == b->digest_len
+	  && (a->digest_len != 0
+	      ? memcmp (a->digest, b->digest, a->digest_len) == 0
+	      : strcmp (a->path, b->path) == 0)
+	  && (a->target == NULL
+	      ? b->target == NULL
+	      : b->target != NULL && strcmp (a->target, b->target) == 0));
+}
+
+/* Whether ENT was opened from the file described by ST.  */
+
+static bool
+resident_same_file (const struct bfd_resident *ent, const struct stat *st)
+{
+  return (ent->size == (uint64_t) st->st_size
+	  && ent->mtime == (int64_t) st->st_mtime
+	  && ent->ino == (uint64_t) st->st_ino
+	  && ent->dev == (uint64_t) st->st_dev);
+}
+
+/* Close the BFD of ENT, which nobody uses, and free ENT.  */
+
+static void
+resident_free (struct bfd_resident *ent)
+{
+  if (ent->abfd != NULL)
+    bfd_close_all_done (ent->abfd);
+  _bfd_mutex_destroy (&ent->lock);
+  free (ent->path);
+  free (ent);
+}
+
+/* Take ENT off the idle list.  The lock must be held.  */
+
+static void
+resident_idle_remove (struct bfd_resident *ent)
+{
+  if (ent->idle_prev != NULL)
+    ent->idle_prev->idle_next = ent->idle_next;
+  else
+    resident_idle_head = ent->idle_next;
+  if (ent->idle_next != NULL)
+    ent->idle_next->idle_prev = ent->idle_prev;
+  else
+    resident_idle_tail = ent->idle_prev;
+  ent->idle_prev = ent->idle_next = NULL;
+  resident_idle_count--;
+}
+
+/* Take idle entries out of the table, least recently used first,
+   until no more than LIMIT are left.  Return them chained through
+   IDLE_NEXT, for the caller to free once it has dropped the lock.
+   The lock must be held.  */
+
+static struct bfd_resident *
+resident_trim (unsigned int limit)
+{
+  struct bfd_resident *doomed = NULL;
+
+  while (resident_idle_count > limit)
+    {
+      struct bfd_resident *ent = resident_idle_head;
+
+      resident_idle_remove (ent);
+      htab_remove_elt (resident_table, ent);
+      ent->idle_next = doomed;
+      doomed = ent;
+    }
+  return doomed;
+}
+
+static void
+resident_free_list (struct bfd_resident *doomed)
+{
+  while (doomed != NULL)
+    {
+      struct bfd_resident *next = doomed->idle_next;
+
+      resident_free (doomed);
+      doomed = next;
+    }
+}
+
+/* Open the BFD of ENT, whose lock the caller holds.  */
+
+static void
+resident_open_bfd (struct bfd_resident *ent)
+{
+  bfd *abfd = bfd_openr (ent->path, ent->target);
+
+  if (abfd != NULL && !bfd_check_format (abfd, ent->format))
+    {
+      ent->error = bfd_get_error ();
+      bfd_close_all_done (abfd);
+      abfd = NULL;
+    }
+  else if (abfd == NULL)
+    ent->error = bfd_get_error ();
+  ent->abfd = abfd;
+}
+
+/* Worker for bfd_resident_open and bfd_resident_open_contents.
+   Look the entry up by DIGEST if DIGEST_LEN is nonzero, otherwise by
+   the name of FILENAME.  */
+
+static bfd_resident *
+resident_open (const char *filename, const char *target, bfd_format format,
+	       const bfd_byte *digest, size_t digest_len)
+{
+  struct stat st;
+  struct bfd_resident key, *ent, *doomed = NULL;
+  void **slot;
+  bool opener = false;
+
+  if (stat (filename, &st) != 0)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return NULL;
+    }
+
+  key.path = lrealpath (filename);
+  key.target = (char *) target;
+  key.format = format;
+  key.digest = (bfd_byte *) digest;
+  key.digest_len = digest_len;
+  if (key.path == NULL)
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return NULL;
+    }
+
+  _bfd_mutex_lock (&resident_lock);
+  if (resident_table == NULL)
+    resident_table = htab_create_alloc (16, resident_hash, resident_eq,
+					NULL, calloc, free);
+  slot = NULL;
+  if (resident_table != NULL)
+    slot = htab_find_slot (resident_table, &key, INSERT);
+  if (slot == NULL)
+    {
+      _bfd_mutex_unlock (&resident_lock);
+      free (key.path);
+      bfd_set_error (bfd_error_no_memory);
+      return NULL;
+    }
+
+  ent = (struct bfd_resident *) *slot;
+  if (ent != NULL && ent->digest_len != 0)
+    {
+      /* The BFD reads from the file it was opened on, which need not
+	 be FILENAME.  */
+      struct stat est;
+
+      if (stat (ent->path, &est) != 0)
+	memset (&est, 0, sizeof (est));
+      st = est;
+    }
+  if (ent != NULL && !resident_same_file (ent, &st))
+    {
+      /* The file has changed.  Whoever is using the old BFD may go
+	 on doing so; it is closed when they release it.  */
+      htab_clear_slot (resident_table, slot);
+      ent->stale = true;
+      if (ent->users == 0)
+	{
+	  resident_idle_remove (ent);
+	  doomed = ent;
+	}
+      ent = NULL;
+      slot = htab_find_slot (resident_table, &key, INSERT);
+      if (digest_len != 0 && stat (filename, &st) != 0)
+	memset (&st, 0, sizeof (st));
+    }
+
+  if (ent == NULL)
+    {
+      size_t len = target != NULL ? strlen (target) + 1 : 0;
+
+      if (slot != NULL)
+	ent = (struct bfd_resident *) bfd_zmalloc (sizeof (*ent) + digest_len
+						   + len);
+      if (ent == NULL)
+	{
+	  if (slot != NULL)
+	    htab_clear_slot (resident_table, slot);
+	  _bfd_mutex_unlock (&resident_lock);
+	  resident_free_list (doomed);
+	  free (key.path);
+	  bfd_set_error (bfd_error_no_memory);
+	  return NULL;
+	}
+      ent->path = key.path;
+      key.path = NULL;
+      if (digest_len != 0)
+	{
+	  ent->digest = (bfd_byte *) (ent + 1);
+	  ent->digest_len = digest_len;
+	  memcpy (ent->digest, digest, digest_len);
+	}
+      if (target != NULL)
+	{
+	  ent->target = (char *) (ent + 1) + digest_len;
+	  memcpy (ent->target, target, len);
+	}
+      ent->format = format;
+      ent->size = st.st_size;
+      ent->mtime = st.st_mtime;
+      ent->ino = st.st_ino;
+      ent->dev = st.st_dev;
+      *slot = ent;
+      opener = true;
+    }
+  else if (ent->users == 0)
+    resident_idle_remove (ent);
+  ent->users++;
+  _bfd_mutex_unlock (&resident_lock);
+  resident_free_list (doomed);
+  free (key.path);
+
+  _bfd_mutex_lock (&ent->lock);
+  if (opener)
+    {
+      resident_open_bfd (ent);
+      if (ent->abfd == NULL)
+	{
+	  /* Don't keep the failure; the file may be fixed by the next
+	     open.  */
+	  _bfd_mutex_lock (&resident_lock);
+	  if (!ent->stale)
+	    {
+	      htab_remove_elt (resident_table, ent);
+	      ent->stale = true;
+	    }
+	  _bfd_mutex_unlock (&resident_lock);
+	}
+    }
+  if (ent->abfd == NULL)
+    {
+      bfd_error_type error = ent->error;
+
+      bfd_resident_release (ent);
+      bfd_set_error (error);
+      return NULL;
+    }
+  return ent;
+}
+
+/*
+FUNCTION
+	bfd_resident_open
+
+SYNOPSIS
+	bfd_resident *bfd_resident_open
+	  (const char *filename, const char *target, bfd_format format);
+
+DESCRIPTION
+	Return the resident BFD for @var{filename}, opened for reading
+	with @var{target} as by <<bfd_openr>> and checked to be of
+	@var{format}.  If it is already resident and the file has not
+	changed, its BFD is reused, waiting for any other caller using
+	it to release it.  The BFD is the caller's until it calls
+	<<bfd_resident_release>>, and must not be closed.  Return NULL,
+	setting the BFD error, if the file cannot be opened or is not
+	of @var{format}.
+*/
+
+bfd_resident *
+bfd_resident_open (const char *filename, const char *target,
+		   bfd_format format)
+{
+  return resident_open (filename, target, format, NULL, 0);
+}
+
+/* The length of the digest resident_digest_file works out.  */
+#define RESIDENT_DIGEST_SIZE 16
+
+/* Set DIGEST to the size of FILENAME and two hashes of its contents:
+   the CRC used by .gnu_debuglink, and libiberty's iterative_hash.
+   Return false, setting the BFD error, if it cannot be read.  */
+
+static bool
+resident_digest_file (const char *filename,
+		      bfd_byte digest[RESIDENT_DIGEST_SIZE])
+{
+  FILE *f = _bfd_real_fopen (filename, FOPEN_RB);
+  bfd_byte *buffer;
+  uint64_t size = 0;
+  uint32_t crc = 0;
+  hashval_t hash = 0;
+  size_t count;
+  bool ret;
+
+  if (f == NULL)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return false;
+    }
+  buffer = (bfd_byte *) bfd_malloc (256 * 1024);
+  if (buffer == NULL)
+    {
+      fclose (f);
+      return false;
+    }
+  while ((count = fread (buffer, 1, 256 * 1024, f)) > 0)
+    {
+      crc = bfd_calc_gnu_debuglink_crc32 (crc, buffer, count);
+      hash = iterative_hash (buffer, count, hash);
+      size += count;
+    }
+  ret = !ferror (f);
+  if (!ret)
+    bfd_set_error (bfd_error_system_call);
+  free (buffer);
+  fclose (f);
+
+  bfd_putl64 (size, digest);
+  bfd_putl32 (crc, digest + 8);
+  bfd_putl32 (hash, digest + 12);
+  return ret;
+}
+
+/*
+FUNCTION
+	bfd_resident_open_contents
+
+SYNOPSIS
+	bfd_resident *bfd_resident_open_contents
+	  (const char *filename, const char *target, bfd_format format,
+	   const void *digest, size_t digest_len);
+
+DESCRIPTION
+	Like <<bfd_resident_open>>, but find the resident BFD by the
+	contents of @var{filename}, as given by the @var{digest_len}
+	bytes at @var{digest}, rather than by its name.  A BFD opened
+	on another file with the same digest, target and format is
+	reused.  Any digest will do as long as files with different
+	contents have different digests; a build system may already
+	have one.  If @var{digest} is NULL, the file is read through
+	to work out its size and two 32-bit hashes of its contents,
+	which is much cheaper than parsing it but not proof against
+	files crafted to collide, so callers reading untrusted input
+	should supply a cryptographic digest.  A worked out digest is
+	16 bytes long, and digests of different lengths never match,
+	so both kinds can be used in one program.
+*/
+
+bfd_resident *
+bfd_resident_open_contents (const char *filename, const char *target,
+			    bfd_format format, const void *digest,
+			    size_t digest_len)
+{
+  bfd_byte buf[RESIDENT_DIGEST_SIZE];
+
+  if (digest == NULL || digest_len == 0)
+    {
+      if (!resident_digest_file (filename, buf))
+	return NULL;
+      digest = buf;
+      digest_len = sizeof (buf);
+    }
+  return resident_open (filename, target, format,
+			(const bfd_byte *) digest, digest_len);
+}
+
+/*
+FUNCTION
+	bfd_resident_bfd
+
+SYNOPSIS
+	bfd *bfd_resident_bfd (bfd_resident *res);
+
+DESCRIPTION
+	Return the BFD of @var{res}.
+*/
+
+bfd *
+bfd_resident_bfd (bfd_resident *res)
+{
+  return res->abfd;
+}
+
+/*
+FUNCTION
+	bfd_resident_symbols
+
+SYNOPSIS
+	long bfd_resident_symbols (bfd_resident *res, asymbol ***symbols);
+
+DESCRIPTION
+	Set @var{*symbols} to the canonical symbol table of the BFD of
+	@var{res}, as from <<bfd_canonicalize_symtab>>, and return the
+	number of symbols.  The table is read on the first call and
+	kept for as long as the BFD is resident; it must not be freed.
+	Return -1, setting the BFD error, if it cannot be read.
+*/
+
+long
+bfd_resident_symbols (bfd_resident *res, asymbol ***symbols)
+{
+  if (!res->have_syms)
+    {
+      bfd *abfd = res->abfd;
+      long size = 0;
+
+      res->syms = NULL;
+      res->symcount = 0;
+      if ((bfd_get_file_flags (abfd) & HAS_SYMS) != 0)
+	size = bfd_get_symtab_upper_bound (abfd);
+      if (size < 0)
+	return -1;
+      if (size > 0)
+	{
+	  res->syms = (asymbol **) bfd_alloc (abfd, size);
+	  if (res->syms == NULL)
+	    return -1;
+	  res->symcount = bfd_canonicalize_symtab (abfd, res->syms);
+	  if (res->symcount < 0)
+	    {
+	      bfd_release (abfd, res->syms);
+	      res->syms = NULL;
+	      return -1;
+	    }
+	}
+      res->have_syms = true;
+    }
+  *symbols = res->syms;
+  return res->symcount;
+}
+
+/*
+FUNCTION
+	bfd_resident_release
+
+SYNOPSIS
+	void bfd_resident_release (bfd_resident *res);
+
+DESCRIPTION
+	Stop using @var{res}, which came from <<bfd_resident_open>>.
+	Its BFD stays open for the next caller unless the file has
+	changed or too many resident BFDs are idle.
+*/
+
+void
+bfd_resident_release (bfd_resident *res)
+{
+  struct bfd_resident *doomed = NULL;
+
+  _bfd_mutex_unlock (&res->lock);
+  _bfd_mutex_lock (&resident_lock);
+  if (--res->users == 0)
+    {
+      if (res->stale)
+	{
+	  res->idle_next = NULL;
+	  doomed = res;
+	}
+      else
+	{
+	  res->idle_prev = resident_idle_tail;
+	  res->idle_next = NULL;
+	  if (resident_idle_tail != NULL)
+	    resident_idle_tail->idle_next = res;
+	  else
+	    resident_idle_head = res;
+	  resident_idle_tail = res;
+	  resident_idle_count++;
+	  doomed = resident_trim (resident_limit);
+	}
+    }
+  _bfd_mutex_unlock (&resident_lock);
+  resident_free_list (doomed);
+}
+
+/*
+FUNCTION
+	bfd_resident_set_limit
+
+SYNOPSIS
+	unsigned int bfd_resident_set_limit (unsigned int count);
+
+DESCRIPTION
+	Keep at most @var{count} resident BFDs that nobody is using,
+	closing the least recently used beyond that.  Zero closes each
+	as soon as it is released, and so with any idle now.  Return
+	the previous limit.  The default is 64.
+*/
+
+unsigned int
+bfd_resident_set_limit (unsigned int count)
+{
+  struct bfd_resident *doomed;
+  unsigned int old;
+
+  _bfd_mutex_lock (&resident_lock);
+  old = resident_limit;
+  resident_limit = count;
+  doomed = resident_table != NULL ? resident_trim (count) : NULL;
+  _bfd_mutex_unlock (&resident_lock);
+  resident_free_list (doomed);
+  return old;
+}
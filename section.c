@@ -828,24 +828,75 @@ _bfd_generic_new_section_hook (bfd *abfd, asection *newsect)
 
 unsigned int _bfd_section_id = 0x10;  /* id 0 to 3 used by STD_SECTION.  */
 
+/* Where sections made by this thread take their ids from, if not
+   _bfd_section_id.  */
+static TLS unsigned int *thread_section_id;
+
 /* Initializes a new section.  NEWSECT->NAME is already set.  */
 
 static asection *
 bfd_section_init (bfd *abfd, asection *newsect)
 {
-  newsect->id = _bfd_section_id;
+  unsigned int *id = _bfd_section_id_counter ();
+  enum bfd_memory_class old_class;
+  bool ok;
+
+  newsect->id = *id;
   newsect->index = abfd->section_count;
   newsect->owner = abfd;
 
-  if (! BFD_SEND (abfd, _new_section_hook, (abfd, newsect)))
+  old_class = _bfd_set_memory_class (bfd_memory_sections);
+  ok = BFD_SEND (abfd, _new_section_hook, (abfd, newsect));
+  _bfd_set_memory_class (old_class);
+  if (!ok)
     return NULL;
 
-  _bfd_section_id++;
+  ++*id;
   abfd->section_count++;
   bfd_section_list_append (abfd, newsect);
   return newsect;
 }
 
+/*
+INTERNAL_FUNCTION
+	_bfd_section_id_counter
+
+SYNOPSIS
+	unsigned int *_bfd_section_id_counter (void);
+
+DESCRIPTION
+	Return the counter that sections made by this thread take
+	their ids from.  This is <<_bfd_section_id>> unless
+	<<_bfd_set_thread_section_ids>> says otherwise.
+*/
+
+unsigned int *
+_bfd_section_id_counter (void)
+{
+  return thread_section_id != NULL ? thread_section_id : &_bfd_section_id;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_set_thread_section_ids
+
+SYNOPSIS
+	void _bfd_set_thread_section_ids (unsigned int *counter);
+
+DESCRIPTION
+	Make sections made by this thread take their ids from
+	@var{counter}, or from <<_bfd_section_id>> again if
+	@var{counter} is NULL.  This is for worker threads opening
+	BFDs of their own, whose sections are given proper ids once
+	the workers are done.
+*/
+
+void
+_bfd_set_thread_section_ids (unsigned int *counter)
+{
+  thread_section_id = counter;
+}
+
 /*
 DOCDD
 INODE
@@ -874,6 +925,7 @@ bfd_section_list_clear (bfd *abfd)
   abfd->sections = NULL;
   abfd->section_last = NULL;
   abfd->section_count = 0;
+  abfd->section_map_stale = 1;
   memset (abfd->section_htab.table, 0,
 	  abfd->section_htab.size * sizeof (struct bfd_hash_entry *));
   abfd->section_htab.count = 0;
@@ -937,7 +989,7 @@ bfd_get_next_section_by_name (bfd *ibfd, asection *sec)
        sh != NULL;
        sh = (struct section_hash_entry *) sh->root.next)
     if (sh->root.hash == hash
-       && strcmp (sh->root.string, name) == 0)
+       && (sh->root.string == name || strcmp (sh->root.string, name) == 0))
       return &sh->section;
 
   if (ibfd != NULL)
@@ -1384,6 +1436,129 @@ bfd_map_over_sections (bfd *abfd,
     abort ();
 }
 
+/* A bfd_map_over_sections_parallel in progress.  */
+
+struct map_sections_job
+{
+  bfd *abfd;
+  asection **sections;
+  bool (*func) (bfd *, asection *, void *, void *);
+  void *obj;
+  char *results;
+  size_t result_size;
+};
+
+/* Call the function of DATA, a map_sections_job, on the sections
+   from START up to END.  Worker for _bfd_parallel_for.  */
+
+static bool
+map_sections_range (void *data, size_t start, size_t end)
+{
+  struct map_sections_job *job = (struct map_sections_job *) data;
+  bool ok = true;
+  size_t i;
+
+  for (i = start; i < end; i++)
+    {
+      void *result = NULL;
+
+      if (job->results != NULL)
+	result = job->results + i * job->result_size;
+      if (!(*job->func) (job->abfd, job->sections[i], job->obj, result))
+	ok = false;
+    }
+  return ok;
+}
+
+/*
+FUNCTION
+	bfd_map_over_sections_parallel
+
+SYNOPSIS
+	bool bfd_map_over_sections_parallel
+	  (bfd *abfd,
+	   bool (*func) (bfd *abfd, asection *sect, void *obj,
+			 void *result),
+	   size_t result_size,
+	   bool (*reduce) (bfd *abfd, asection *sect, void *obj,
+			   void *result),
+	   void *obj);
+
+DESCRIPTION
+	Like <<bfd_map_over_sections>>, but call @var{func} for the
+	sections of @var{abfd} on as many threads as
+	<<bfd_set_thread_count>> allows.  Each call gets a block of
+	@var{result_size} bytes of its own, zeroed, to leave its
+	result in; @var{result} is NULL if @var{result_size} is zero.
+	Since the calls may happen in any order and at the same time,
+	@var{func} must not read or write @var{abfd}'s file, allocate
+	BFD memory or change anything shared between sections.
+	Then, unless @var{reduce} is NULL, it is called on the calling
+	thread for each section in turn, in the order
+	<<bfd_map_over_sections>> would use, with the result that
+	@var{func} left for it.  This is the place to combine results,
+	output them or free what @var{func} allocated, and it is
+	called for every section even if some call failed.  Messages
+	for the BFD error handler from @var{func} come out in section
+	order too.  Returns <<FALSE>> if any call of either function
+	did, or if memory ran out, in which case neither is called.
+*/
+
+bool
+bfd_map_over_sections_parallel
+  (bfd *abfd,
+   bool (*func) (bfd *, asection *, void *, void *),
+   size_t result_size,
+   bool (*reduce) (bfd *, asection *, void *, void *),
+   void *obj)
+{
+  struct map_sections_job job;
+  size_t count = abfd->section_count;
+  asection *sect;
+  size_t i;
+  bool ok;
+
+  if (count == 0)
+    return true;
+
+  job.abfd = abfd;
+  job.func = func;
+  job.obj = obj;
+  job.result_size = result_size;
+  job.sections = (asection **) bfd_malloc (count * sizeof (*job.sections));
+  job.results = NULL;
+  if (result_size != 0)
+    job.results = (char *) bfd_zmalloc (count * result_size);
+  if (job.sections == NULL || (result_size != 0 && job.results == NULL))
+    {
+      free (job.sections);
+      free (job.results);
+      return false;
+    }
+
+  for (i = 0, sect = abfd->sections; sect != NULL; i++, sect = sect->next)
+    job.sections[i] = sect;
+  if (i != count)	/* Debugging */
+    abort ();
+
+  ok = _bfd_parallel_for (count, 1, map_sections_range, &job);
+
+  if (reduce != NULL)
+    for (i = 0; i < count; i++)
+      {
+	void *result = NULL;
+
+	if (job.results != NULL)
+	  result = job.results + i * result_size;
+	if (!(*reduce) (abfd, job.sections[i], obj, result))
+	  ok = false;
+      }
+
+  free (job.sections);
+  free (job.results);
+  return ok;
+}
+
 /*
 FUNCTION
 	bfd_sections_find_if
@@ -1419,6 +1594,279 @@ bfd_sections_find_if (bfd *abfd,
   return sect;
 }
 
+/* An extra index of the sections of a BFD, by index and by address,
+   built on demand by bfd_get_section_by_index and
+   bfd_get_section_by_vma.  */
+
+struct section_map_range
+{
+  /* The addresses the section covered when the map was built.  */
+  bfd_vma start;
+  bfd_vma end;
+  /* The highest END of this and all the earlier ranges.  */
+  bfd_vma max_end;
+  asection *sec;
+};
+
+struct bfd_section_map
+{
+  /* The sections by index, COUNT of them.  */
+  unsigned int count;
+  asection **by_index;
+  /* The allocated sections with contents, sorted by address.  */
+  unsigned int nranges;
+  struct section_map_range *ranges;
+};
+
+/* Sort section_map_range entries by address, then by index.  */
+
+static int
+section_map_compare (const void *a, const void *b)
+{
+  const struct section_map_range *ra = (const struct section_map_range *) a;
+  const struct section_map_range *rb = (const struct section_map_range *) b;
+
+  if (ra->start != rb->start)
+    return ra->start < rb->start ? -1 : 1;
+  if (ra->sec->index != rb->sec->index)
+    return ra->sec->index < rb->sec->index ? -1 : 1;
+  return 0;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_section_map_free
+
+SYNOPSIS
+	void _bfd_section_map_free (bfd *);
+
+DESCRIPTION
+	Free the section index built by <<bfd_get_section_by_index>>
+	and <<bfd_get_section_by_vma>>.
+*/
+
+void
+_bfd_section_map_free (bfd *abfd)
+{
+  struct bfd_section_map *map = abfd->section_map;
+
+  if (map == NULL)
+    return;
+  free (map->by_index);
+  free (map->ranges);
+  free (map);
+  abfd->section_map = NULL;
+}
+
+/* Return the section index of ABFD, building it if need be.  */
+
+static struct bfd_section_map *
+section_map (bfd *abfd)
+{
+  struct bfd_section_map *map;
+  asection *sec;
+  unsigned int i;
+  size_t amt;
+
+  if (abfd->section_map != NULL && !abfd->section_map_stale)
+    return abfd->section_map;
+
+  _bfd_section_map_free (abfd);
+  map = (struct bfd_section_map *) bfd_zmalloc (sizeof (*map));
+  if (map == NULL)
+    return NULL;
+
+  if (abfd->section_count != 0)
+    {
+      if (_bfd_mul_overflow (abfd->section_count, sizeof (*map->ranges),
+			     &amt))
+	{
+	  bfd_set_error (bfd_error_no_memory);
+	  free (map);
+	  return NULL;
+	}
+      map->ranges = (struct section_map_range *) bfd_malloc (amt);
+      map->by_index = ((asection **)
+		       bfd_zmalloc (abfd->section_count
+				    * sizeof (*map->by_index)));
+      if (map->by_index == NULL || map->ranges == NULL)
+	{
+	  free (map->by_index);
+	  free (map->ranges);
+	  free (map);
+	  return NULL;
+	}
+    }
+  map->count = abfd->section_count;
+
+  for (sec = abfd->sections; sec != NULL; sec = sec->next)
+    {
+      struct section_map_range *r;
+      bfd_size_type size;
+
+      if (sec->index < map->count)
+	map->by_index[sec->index] = sec;
+
+      /* Leave out sections that take no space in memory, such as
+	 .tbss, which overlaps whatever follows it.  */
+      if ((sec->flags & SEC_ALLOC) == 0
+	  || ((sec->flags & SEC_THREAD_LOCAL) != 0
+	      && (sec->flags & SEC_LOAD) == 0))
+	continue;
+      size = bfd_section_size (sec) / bfd_octets_per_byte (abfd, sec);
+      if (size == 0 || map->nranges == map->count)
+	continue;
+
+      r = &map->ranges[map->nranges++];
+      r->start = bfd_section_vma (sec);
+      r->end = r->start + size;
+      if (r->end < r->start)
+	r->end = (bfd_vma) -1;
+      r->sec = sec;
+    }
+
+  if (map->nranges != 0)
+    {
+      qsort (map->ranges, map->nranges, sizeof (*map->ranges),
+	     section_map_compare);
+      map->ranges[0].max_end = map->ranges[0].end;
+      for (i = 1; i < map->nranges; i++)
+	{
+	  map->ranges[i].max_end = map->ranges[i - 1].max_end;
+	  if (map->ranges[i].end > map->ranges[i].max_end)
+	    map->ranges[i].max_end = map->ranges[i].end;
+	}
+    }
+
+  abfd->section_map = map;
+  abfd->section_map_stale = 0;
+  return map;
+}
+
+/*
+FUNCTION
+	bfd_get_section_by_index
+
+SYNOPSIS
+	asection *bfd_get_section_by_index (bfd *abfd, unsigned int index);
+
+DESCRIPTION
+	Return the section of @var{abfd} whose <<index>> is
+	@var{index}, or NULL if there is none.  The first call builds
+	an index of the sections, so that later ones take constant
+	time.
+*/
+
+asection *
+bfd_get_section_by_index (bfd *abfd, unsigned int index)
+{
+  struct bfd_section_map *map = section_map (abfd);
+
+  if (map == NULL || index >= map->count)
+    return NULL;
+
+  /* Section indices may have been renumbered behind our back.  */
+  if (map->by_index[index] != NULL && map->by_index[index]->index != index)
+    {
+      abfd->section_map_stale = 1;
+      map = section_map (abfd);
+      if (map == NULL || index >= map->count)
+	return NULL;
+    }
+  return map->by_index[index];
+}
+
+/* Return the last range of MAP that contains VMA, or NULL.  */
+
+static struct section_map_range *
+section_map_find (struct bfd_section_map *map, bfd_vma vma)
+{
+  unsigned int lo = 0, hi = map->nranges;
+
+  /* Find the first range that starts after VMA.  */
+  while (lo < hi)
+    {
+      unsigned int mid = lo + (hi - lo) / 2;
+
+      if (map->ranges[mid].start <= vma)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  /* Then step back over the ranges that start at or before VMA,
+     stopping once none of them reach it.  Without overlapping
+     sections, this looks at just one.  */
+  while (lo-- > 0 && map->ranges[lo].max_end > vma)
+    if (map->ranges[lo].end > vma)
+      return &map->ranges[lo];
+  return NULL;
+}
+
+/*
+FUNCTION
+	bfd_get_section_by_vma
+
+SYNOPSIS
+	asection *bfd_get_section_by_vma (bfd *abfd, bfd_vma vma);
+
+DESCRIPTION
+	Return the allocated section of @var{abfd} that contains the
+	address @var{vma}, or NULL if there is none.  If sections
+	overlap, the one that starts last is returned.  The first call
+	builds an index of the sections by address, after which
+	lookups take logarithmic time.  Sections that are added or
+	removed are noticed, but if section addresses or sizes are
+	changed directly, call <<bfd_invalidate_section_map>>
+	before looking up addresses again.
+*/
+
+asection *
+bfd_get_section_by_vma (bfd *abfd, bfd_vma vma)
+{
+  struct bfd_section_map *map = section_map (abfd);
+  struct section_map_range *r;
+
+  if (map == NULL)
+    return NULL;
+  r = section_map_find (map, vma);
+
+  /* As a safeguard, rebuild the map if the section found has moved.  */
+  if (r != NULL
+      && (r->start != bfd_section_vma (r->sec)
+	  || (r->end - r->start
+	      != (bfd_section_size (r->sec)
+		  / bfd_octets_per_byte (abfd, r->sec)))))
+    {
+      abfd->section_map_stale = 1;
+      map = section_map (abfd);
+      if (map == NULL)
+	return NULL;
+      r = section_map_find (map, vma);
+    }
+  return r != NULL ? r->sec : NULL;
+}
+
+/*
+FUNCTION
+	bfd_invalidate_section_map
+
+SYNOPSIS
+	void bfd_invalidate_section_map (bfd *abfd);
+
+DESCRIPTION
+	Tell BFD that the addresses, sizes or indices of sections of
+	@var{abfd} have changed, so that the index used by
+	<<bfd_get_section_by_vma>> and <<bfd_get_section_by_index>>
+	is rebuilt on next use.
+*/
+
+void
+bfd_invalidate_section_map (bfd *abfd)
+{
+  abfd->section_map_stale = 1;
+}
+
 /*
 FUNCTION
 	bfd_set_section_size
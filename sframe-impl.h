@@ -43,6 +43,17 @@ struct sframe_decoder_ctx
   /* Reference to the internally malloc'd buffer, if any, for endian flipping
      the original input buffer before decoding.  */
   void *sfd_buf;
+  /* Nonzero if sframe_find_fre should build and use the FRE index.  */
+  int sfd_fre_index_wanted;
+  /* The malloc'd block holding the FRE index, if it has been built.  */
+  void *sfd_fre_index_buf;
+  /* Start address of each FRE, grouped by function.  */
+  uint32_t *sfd_fre_starts;
+  /* Offset of each FRE in SFD_FRES.  */
+  uint32_t *sfd_fre_offs;
+  /* Index in the two arrays above of the first FRE of each function, and
+     the total number of FREs at the end.  */
+  uint32_t *sfd_fre_first;
 };
 
 typedef struct sf_fde_tbl sf_fde_tbl;
@@ -62,6 +73,10 @@ struct sframe_encoder_ctx
   char *sfe_data;
   /* Size of the SFrame output data buffer.  */
   size_t sfe_data_size;
+  /* If set, FREs are encoded as they are added and passed to this
+     function instead of being kept; see sframe_encoder_set_fre_sink.  */
+  int (*sfe_fre_sink) (void *data, const char *buf, size_t size);
+  void *sfe_fre_sink_data;
 };
 
 #ifdef  __cplusplus
@@ -575,6 +575,11 @@ sframe_decoder_free (sframe_decoder_ctx **dctxp)
 	  free (dctx->sfd_buf);
 	  dctx->sfd_buf = NULL;
 	}
+      if (dctx->sfd_fre_index_buf != NULL)
+	{
+	  free (dctx->sfd_fre_index_buf);
+	  dctx->sfd_fre_index_buf = NULL;
+	}
 
       free (*dctxp);
       *dctxp = NULL;
@@ -1026,6 +1031,166 @@ sframe_fre_get_end_ip_offset (sframe_func_desc_entry *fdep, unsigned int i,
   return end_ip_offset;
 }
 
+/* The FRE index arrays are aligned to this, so that a search through
+   one function's start addresses touches as few cache lines as
+   possible.  */
+#define SFRAME_FRE_INDEX_ALIGN 64
+
+/* Build the FRE index of the decoder CTX: a table of the start address
+   of every FRE, with a parallel table of where each FRE is in the FRE
+   sub-section, both grouped by function.  Returns 0 on success,
+   SFRAME_ERR otherwise, in which case CTX has no index.  */
+
+static int
+sframe_build_fre_index (sframe_decoder_ctx *ctx)
+{
+  sframe_func_desc_entry *fdep;
+  unsigned int num_fdes, i;
+  size_t total = 0;
+  size_t amt;
+  uintptr_t aligned;
+  uint32_t *starts, *offs, *first;
+  char *buf;
+  int err = 0;
+
+  num_fdes = sframe_decoder_get_num_fidx (ctx);
+  if (num_fdes == 0 || ctx->sfd_funcdesc == NULL || ctx->sfd_fres == NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_DCTX_INVAL);
+
+  for (i = 0; i < num_fdes; i++)
+    total += ctx->sfd_funcdesc[i].sfde_func_num_fres;
+
+  amt = (2 * total + num_fdes + 1) * sizeof (uint32_t);
+  buf = malloc (amt + SFRAME_FRE_INDEX_ALIGN - 1);
+  if (buf == NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_NOMEM);
+
+  aligned = ((uintptr_t) buf + SFRAME_FRE_INDEX_ALIGN - 1)
+	    & ~(uintptr_t) (SFRAME_FRE_INDEX_ALIGN - 1);
+  starts = (uint32_t *) aligned;
+  offs = starts + total;
+  first = offs + total;
+
+  total = 0;
+  for (i = 0; i < num_fdes; i++)
+    {
+      unsigned int fre_type, j;
+      size_t addr_size;
+      uint32_t off;
+
+      fdep = &ctx->sfd_funcdesc[i];
+      fre_type = sframe_get_fre_type (fdep);
+      if (fre_type != SFRAME_FRE_TYPE_ADDR1
+	  && fre_type != SFRAME_FRE_TYPE_ADDR2
+	  && fre_type != SFRAME_FRE_TYPE_ADDR4)
+	goto fail;
+      addr_size = sframe_fre_start_addr_size (fre_type);
+
+      first[i] = total;
+      off = fdep->sfde_func_start_fre_off;
+      for (j = 0; j < fdep->sfde_func_num_fres; j++)
+	{
+	  uint8_t fre_info;
+
+	  /* Each FRE has to fit in the FRE sub-section, and the start
+	     addresses of a regular FDE's FREs have to increase for the
+	     search to work.  */
+	  if ((size_t) off + addr_size + 1 > (size_t) ctx->sfd_fre_nbytes)
+	    goto fail;
+	  sframe_decode_fre_start_address (ctx->sfd_fres + off,
+					   &starts[total], fre_type);
+	  if (j != 0 && starts[total] <= starts[total - 1]
+	      && sframe_get_fde_type (fdep) == SFRAME_FDE_TYPE_PCINC)
+	    goto fail;
+	  fre_info = *(uint8_t *) (ctx->sfd_fres + off + addr_size);
+	  offs[total++] = off;
+	  off += addr_size + 1 + sframe_fre_offset_bytes_size (fre_info);
+	  if (off > (uint32_t) ctx->sfd_fre_nbytes)
+	    goto fail;
+	}
+    }
+  first[num_fdes] = total;
+
+  ctx->sfd_fre_index_buf = buf;
+  ctx->sfd_fre_starts = starts;
+  ctx->sfd_fre_offs = offs;
+  ctx->sfd_fre_first = first;
+  return 0;
+
+ fail:
+  free (buf);
+  return sframe_set_errno (&err, SFRAME_ERR_FRE_INVAL);
+}
+
+/* Ask that sframe_find_fre on the decoder CTX use an index of the FREs,
+   built on the first lookup, rather than decoding each FRE of the
+   function in turn.  The index takes eight bytes per FRE.  Returns
+   SFRAME_ERR if CTX is not valid.  */
+
+int
+sframe_decoder_use_fre_index (sframe_decoder_ctx *ctx)
+{
+  int err = 0;
+
+  if (ctx == NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_INVAL);
+
+  ctx->sfd_fre_index_wanted = 1;
+  return 0;
+}
+
+/* Find the FRE of the function FDEP, a regular FDE of the decoder CTX,
+   which contains the PC, using the FRE index.  */
+
+static int
+sframe_find_fre_indexed (sframe_decoder_ctx *ctx,
+			 sframe_func_desc_entry *fdep, int32_t pc,
+			 sframe_frame_row_entry *frep)
+{
+  const uint32_t *starts;
+  uint32_t pc_offset, end_ip_offset;
+  uint32_t fidx, num_fres, low, high;
+  size_t size = 0;
+  int err = 0;
+
+  fidx = fdep - ctx->sfd_funcdesc;
+  starts = ctx->sfd_fre_starts + ctx->sfd_fre_first[fidx];
+  num_fres = fdep->sfde_func_num_fres;
+  pc_offset = (uint32_t) pc - (uint32_t) fdep->sfde_func_start_address;
+
+  if (num_fres == 0)
+    return sframe_set_errno (&err, SFRAME_ERR_FDE_INVAL);
+  if (starts[0] > pc_offset)
+    return sframe_set_errno (&err, SFRAME_ERR_FRE_INVAL);
+
+  /* Find the last FRE that starts at or before the PC.  */
+  low = 0;
+  high = num_fres;
+  while (high - low > 1)
+    {
+      uint32_t mid = low + (high - low) / 2;
+
+      if (starts[mid] <= pc_offset)
+	low = mid;
+      else
+	high = mid;
+    }
+
+  if (low < num_fres - 1)
+    end_ip_offset = starts[low + 1] - 1;
+  else
+    end_ip_offset = fdep->sfde_func_size - 1;
+  if (end_ip_offset < pc_offset)
+    return sframe_set_errno (&err, SFRAME_ERR_FDE_INVAL);
+
+  err = sframe_decode_fre (ctx->sfd_fres
+			   + ctx->sfd_fre_offs[ctx->sfd_fre_first[fidx] + low],
+			   frep, sframe_get_fre_type (fdep), &size);
+  if (err)
+    return sframe_set_errno (&err, SFRAME_ERR_FRE_INVAL);
+  return 0;
+}
+
 /* Find the SFrame Row Entry which contains the PC.  Returns
    SFRAME_ERR if failure.  */
 
@@ -1060,6 +1225,15 @@ sframe_find_fre (sframe_decoder_ctx *ctx, int32_t pc,
   fre_type = sframe_get_fre_type (fdep);
   fde_type = sframe_get_fde_type (fdep);
 
+  /* Use the FRE index if asked for one, building it first if need be.
+     FDEs for repetitive patterns of insns have only a few FREs and
+     match on masked addresses, so they are always scanned.  */
+  if (ctx->sfd_fre_index_wanted && ctx->sfd_fre_starts == NULL
+      && sframe_build_fre_index (ctx) != 0)
+    ctx->sfd_fre_index_wanted = 0;
+  if (ctx->sfd_fre_starts != NULL && fde_type == SFRAME_FDE_TYPE_PCINC)
+    return sframe_find_fre_indexed (ctx, fdep, pc, frep);
+
   /* For FDEs for repetitive pattern of insns, we need to return the FRE
      such that (PC & FRE_START_ADDR_AS_MASK >= FRE_START_ADDR_AS_MASK).
      so, update the bitmask to the start address.  */
@@ -1326,6 +1500,61 @@ sframe_encoder_get_num_fidx (sframe_encoder_ctx *encoder)
   return num_fdes;
 }
 
+static int
+sframe_encoder_write_fre (char *contents, sframe_frame_row_entry *frep,
+			  unsigned int fre_type, size_t *esz);
+
+/* Make ENCODER pass each FRE, encoded, to SINK with DATA as it is added,
+   rather than keeping it.  This bounds the memory the encoder needs to
+   about the size of the FDE table.  */
+
+int
+sframe_encoder_set_fre_sink (sframe_encoder_ctx *encoder,
+			     int (*sink) (void *data, const char *buf,
+					  size_t size),
+			     void *data)
+{
+  int err = 0;
+
+  if (encoder == NULL || sink == NULL
+      || encoder->sfe_funcdesc != NULL || encoder->sfe_fres != NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_INVAL);
+
+  encoder->sfe_fre_sink = sink;
+  encoder->sfe_fre_sink_data = data;
+  return 0;
+}
+
+/* Encode FREP, an FRE of function FDEP, and pass it to the FRE sink of
+   ENCODER.  */
+
+static int
+sframe_encoder_sink_fre (sframe_encoder_ctx *encoder,
+			 sframe_func_desc_entry *fdep,
+			 sframe_frame_row_entry *frep)
+{
+  char buf[sizeof (uint32_t) + sizeof (frep->fre_info) + MAX_OFFSET_BYTES];
+  unsigned int fre_type;
+  sframe_header *ehp;
+  size_t esz = 0;
+  int err = 0;
+
+  fre_type = sframe_get_fre_type (fdep);
+  if (sframe_encoder_write_fre (buf, frep, fre_type, &esz))
+    return sframe_set_errno (&err, SFRAME_ERR_FRE_INVAL);
+  if (need_swapping (encoder->sfe_header.sfh_abi_arch)
+      && flip_fre (buf, fre_type, &esz))
+    return sframe_set_errno (&err, SFRAME_ERR_FRE_INVAL);
+  if (encoder->sfe_fre_sink (encoder->sfe_fre_sink_data, buf, esz) != 0)
+    return sframe_set_errno (&err, SFRAME_ERR_NOMEM);
+
+  encoder->sfe_fre_nbytes += esz;
+  ehp = sframe_encoder_get_header (encoder);
+  ehp->sfh_num_fres++;
+  fdep->sfde_func_num_fres++;
+  return 0;
+}
+
 /* Add an FRE to function at FUNC_IDX'th function descriptor entry in
    the encoder context.  */
 
@@ -1353,6 +1582,19 @@ sframe_encoder_add_fre (sframe_encoder_ctx *encoder,
   if (fdep == NULL)
     return sframe_set_errno (&err, SFRAME_ERR_FDE_NOTFOUND);
 
+  if (encoder->sfe_fre_sink != NULL)
+    {
+      /* The FREs are written out in the order they are added, so they
+	 have to follow the FDE they belong to.  */
+      if (func_idx + 1 != sframe_encoder_get_num_fidx (encoder))
+	return sframe_set_errno (&err, SFRAME_ERR_FDE_INVAL);
+      if (fdep->sfde_func_size)
+	sframe_assert (frep->fre_start_addr < fdep->sfde_func_size);
+      else
+	sframe_assert (frep->fre_start_addr == fdep->sfde_func_size);
+      return sframe_encoder_sink_fre (encoder, fdep, frep);
+    }
+
   fre_type = sframe_get_fre_type (fdep);
   sf_fre_tbl *fre_tbl = encoder->sfe_fres;
 
@@ -1503,6 +1745,239 @@ bad:
   return -1;
 }
 
+/* Make room in the FDE table of ENCODER for COUNT more entries.  Returns
+   SFRAME_ERR if failure, leaving the table as it was.  */
+
+static int
+sframe_encoder_reserve_funcdesc (sframe_encoder_ctx *encoder,
+				 unsigned int count)
+{
+  sf_fde_tbl *fd_info = encoder->sfe_funcdesc;
+  unsigned int used = fd_info != NULL ? fd_info->count : 0;
+  unsigned int alloced = fd_info != NULL ? fd_info->alloced : 0;
+  unsigned int want;
+  int err = 0;
+
+  if (count <= alloced - used)
+    return 0;
+
+  want = alloced + number_of_entries;
+  if (want < alloced * 2)
+    want = alloced * 2;
+  if (want < used + count)
+    want = used + count;
+
+  fd_info = realloc (fd_info, (sizeof (sf_fde_tbl)
+			       + want * sizeof (sframe_func_desc_entry)));
+  if (fd_info == NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_NOMEM);
+
+  memset (&fd_info->entry[alloced], 0,
+	  (want - alloced) * sizeof (sframe_func_desc_entry));
+  fd_info->count = used;
+  fd_info->alloced = want;
+  encoder->sfe_funcdesc = fd_info;
+  return 0;
+}
+
+/* Encoded FREs that need flipping are gathered in a buffer of about
+   this size before being passed to the sink.  */
+#define SFRAME_SINK_CHUNK 65536
+
+/* Pass the LEN bytes of encoded FREs at FRES to the FRE sink of
+   ENCODER.  */
+
+static int
+sframe_encoder_sink_fres (sframe_encoder_ctx *encoder, const char *fres,
+			  size_t len)
+{
+  int err = 0;
+
+  if (len != 0
+      && encoder->sfe_fre_sink (encoder->sfe_fre_sink_data, fres, len) != 0)
+    return sframe_set_errno (&err, SFRAME_ERR_NOMEM);
+  return 0;
+}
+
+/* Add the function descriptor entries of the decoder DCTX, with all of
+   their FREs, to ENCODER.  If START_ADDRS is not NULL, it gives the start
+   address to use for each function.  If SKIP is not NULL, functions for
+   which it is nonzero are left out.
+
+   With an FRE sink, the FREs are passed on in their encoded form, in as
+   few pieces as possible, without being decoded.  Returns SFRAME_ERR if
+   failure.  */
+
+int
+sframe_encoder_add_decoder (sframe_encoder_ctx *encoder,
+			    sframe_decoder_ctx *dctx,
+			    const int32_t *start_addrs,
+			    const unsigned char *skip)
+{
+  sframe_header *ehp;
+  sf_fde_tbl *fd_info;
+  unsigned int num_fdes, count, i, j;
+  size_t run_start = 0, run_end = 0;
+  char *buf = NULL;
+  size_t buf_size = 0, buf_len = 0;
+  int foreign_endian;
+  int err = 0;
+
+  if (encoder == NULL || dctx == NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_INVAL);
+
+  num_fdes = sframe_decoder_get_num_fidx (dctx);
+  if (num_fdes == 0)
+    return 0;
+  if (dctx->sfd_funcdesc == NULL || dctx->sfd_fres == NULL)
+    return sframe_set_errno (&err, SFRAME_ERR_DCTX_INVAL);
+
+  count = 0;
+  for (i = 0; i < num_fdes; i++)
+    if (skip == NULL || !skip[i])
+      count++;
+  if (sframe_encoder_reserve_funcdesc (encoder, count))
+    return SFRAME_ERR;
+
+  ehp = sframe_encoder_get_header (encoder);
+  foreign_endian = need_swapping (ehp->sfh_abi_arch);
+  for (i = 0; i < num_fdes; i++)
+    {
+      const sframe_func_desc_entry *in = &dctx->sfd_funcdesc[i];
+      sframe_func_desc_entry *out;
+      int32_t start_addr;
+      size_t start, end, addr_size;
+      unsigned int fre_type;
+
+      if (skip != NULL && skip[i])
+	continue;
+
+      start_addr = (start_addrs != NULL
+		    ? start_addrs[i] : in->sfde_func_start_address);
+
+      if (encoder->sfe_fre_sink == NULL)
+	{
+	  /* The FREs have to be kept, so decode and add them one at a
+	     time.  */
+	  if (sframe_encoder_add_funcdesc (encoder, start_addr,
+					   in->sfde_func_size,
+					   in->sfde_func_info,
+					   in->sfde_func_num_fres))
+	    return SFRAME_ERR;
+	  for (j = 0; j < in->sfde_func_num_fres; j++)
+	    {
+	      sframe_frame_row_entry fre;
+
+	      if (sframe_decoder_get_fre (dctx, i, j, &fre)
+		  || sframe_encoder_add_fre (encoder,
+					     encoder->sfe_funcdesc->count - 1,
+					     &fre))
+		return SFRAME_ERR;
+	    }
+	  continue;
+	}
+
+      /* Find out where this function's FREs end.  */
+      start = in->sfde_func_start_fre_off;
+      end = start;
+      fre_type = sframe_get_fre_type ((sframe_func_desc_entry *) in);
+      if (fre_type != SFRAME_FRE_TYPE_ADDR1
+	  && fre_type != SFRAME_FRE_TYPE_ADDR2
+	  && fre_type != SFRAME_FRE_TYPE_ADDR4)
+	goto bad_fre;
+      addr_size = sframe_fre_start_addr_size (fre_type);
+      for (j = 0; j < in->sfde_func_num_fres; j++)
+	{
+	  if (end + addr_size + 1 > (size_t) dctx->sfd_fre_nbytes)
+	    goto bad_fre;
+	  end += (addr_size + 1
+		  + sframe_fre_offset_bytes_size (*(uint8_t *)
+						  (dctx->sfd_fres
+						   + end + addr_size)));
+	}
+      if (end > (size_t) dctx->sfd_fre_nbytes)
+	goto bad_fre;
+
+      if (foreign_endian)
+	{
+	  /* Copy the FREs to the buffer and flip them there.  */
+	  char *fp;
+
+	  if (buf_size - buf_len < end - start)
+	    {
+	      size_t want = buf_len + (end - start);
+	      char *nbuf;
+
+	      if (want < SFRAME_SINK_CHUNK)
+		want = SFRAME_SINK_CHUNK;
+	      nbuf = realloc (buf, want);
+	      if (nbuf == NULL)
+		{
+		  sframe_set_errno (&err, SFRAME_ERR_NOMEM);
+		  goto fail;
+		}
+	      buf = nbuf;
+	      buf_size = want;
+	    }
+	  fp = buf + buf_len;
+	  memcpy (fp, dctx->sfd_fres + start, end - start);
+	  for (j = 0; j < in->sfde_func_num_fres; j++)
+	    {
+	      size_t esz = 0;
+
+	      if (flip_fre (fp, fre_type, &esz))
+		goto bad_fre;
+	      fp += esz;
+	    }
+	  buf_len += end - start;
+	  if (buf_len >= SFRAME_SINK_CHUNK)
+	    {
+	      if (sframe_encoder_sink_fres (encoder, buf, buf_len))
+		goto fail;
+	      buf_len = 0;
+	    }
+	}
+      else
+	{
+	  /* Pass on the FREs gathered so far unless this function's
+	     follow straight on from them.  */
+	  if (start != run_end)
+	    {
+	      if (sframe_encoder_sink_fres (encoder,
+					    dctx->sfd_fres + run_start,
+					    run_end - run_start))
+		goto fail;
+	      run_start = start;
+	    }
+	  run_end = end;
+	}
+
+      fd_info = encoder->sfe_funcdesc;
+      out = &fd_info->entry[fd_info->count++];
+      *out = *in;
+      out->sfde_func_start_address = start_addr;
+      out->sfde_func_start_fre_off = encoder->sfe_fre_nbytes;
+      encoder->sfe_fre_nbytes += end - start;
+      ehp->sfh_num_fdes++;
+      ehp->sfh_num_fres += in->sfde_func_num_fres;
+    }
+
+  if (foreign_endian
+      ? sframe_encoder_sink_fres (encoder, buf, buf_len)
+      : sframe_encoder_sink_fres (encoder, dctx->sfd_fres + run_start,
+				  run_end - run_start))
+    goto fail;
+
+  free (buf);
+  return 0;
+
+ bad_fre:
+  sframe_set_errno (&err, SFRAME_ERR_FRE_INVAL);
+ fail:
+  free (buf);
+  return SFRAME_ERR;
+}
+
 static int
 sframe_sort_funcdesc (sframe_encoder_ctx *encoder)
 {
@@ -1513,8 +1988,16 @@ sframe_sort_funcdesc (sframe_encoder_ctx *encoder)
   sf_fde_tbl *fd_info = encoder->sfe_funcdesc;
   if (fd_info)
     {
-      qsort (fd_info->entry, fd_info->count,
-	     sizeof (sframe_func_desc_entry), fde_func);
+      unsigned int i;
+
+      /* Functions are usually added in address order already.  */
+      for (i = 1; i < fd_info->count; i++)
+	if (fde_func (&fd_info->entry[i - 1], &fd_info->entry[i]) > 0)
+	  {
+	    qsort (fd_info->entry, fd_info->count,
+		   sizeof (sframe_func_desc_entry), fde_func);
+	    break;
+	  }
       /* Update preamble's flags.  */
       ehp->sfh_preamble.sfp_flags |= SFRAME_F_FDE_SORTED;
     }
@@ -1703,6 +2186,54 @@ sframe_encoder_write_sframe (sframe_encoder_ctx *encoder)
   return 0;
 }
 
+/* Write the SFrame header and the sorted FDE table of ENCODER, whose FREs
+   have already gone to its FRE sink, to the output buffer held in the
+   ENCODER.  Return SFRAME_ERR if failure.  */
+
+static int
+sframe_encoder_write_sframe_hdr (sframe_encoder_ctx *encoder)
+{
+  char *contents;
+  size_t hdr_size;
+  size_t all_fdes_size;
+  sframe_header *ehp;
+  sf_fde_tbl *fd_info;
+  uint32_t i, num_fdes;
+  int err = 0;
+
+  contents = encoder->sfe_data;
+  num_fdes = sframe_encoder_get_num_fidx (encoder);
+  all_fdes_size = num_fdes * sizeof (sframe_func_desc_entry);
+  ehp = sframe_encoder_get_header (encoder);
+  hdr_size = sframe_get_hdr_size (ehp);
+  fd_info = encoder->sfe_funcdesc;
+
+  if (contents == NULL
+      || encoder->sfe_data_size != hdr_size + all_fdes_size)
+    return sframe_set_errno (&err, SFRAME_ERR_BUF_INVAL);
+
+  /* An encoder without functions still gets a valid, empty, sorted FDE
+     table.  */
+  sframe_sort_funcdesc (encoder);
+  if (fd_info == NULL)
+    ehp->sfh_preamble.sfp_flags |= SFRAME_F_FDE_SORTED;
+
+  memcpy (contents, ehp, hdr_size);
+  if (all_fdes_size != 0)
+    memcpy (contents + hdr_size, fd_info->entry, all_fdes_size);
+
+  if (need_swapping (ehp->sfh_abi_arch))
+    {
+      sframe_func_desc_entry *fdep;
+
+      fdep = (sframe_func_desc_entry *) (contents + hdr_size);
+      for (i = 0; i < num_fdes; i++)
+	flip_fde (fdep + i);
+      flip_header ((sframe_header *) contents);
+    }
+  return 0;
+}
+
 /* Serialize the contents of the encoder and return the buffer.  ENCODED_SIZE
    is updated to the size of the buffer.  */
 
@@ -1729,8 +2260,11 @@ sframe_encoder_write (sframe_encoder_ctx *encoder,
   fresz = encoder->sfe_fre_nbytes;
 
   /* The total size of buffer is the sum of header, SFrame Function Descriptor
-     Entries section and the FRE section.  */
-  bufsize = hdrsize + fsz + fresz;
+     Entries section and the FRE section.  FREs that went to a sink are
+     not part of it.  */
+  bufsize = hdrsize + fsz;
+  if (encoder->sfe_fre_sink == NULL)
+    bufsize += fresz;
   encoder->sfe_data = (char *) malloc (bufsize);
   if (encoder->sfe_data == NULL)
     return sframe_ret_set_errno (errp, SFRAME_ERR_NOMEM);
@@ -1743,6 +2277,14 @@ sframe_encoder_write (sframe_encoder_ctx *encoder,
   ehp->sfh_freoff = fsz;
   ehp->sfh_fre_len = fresz;
 
+  if (encoder->sfe_fre_sink != NULL)
+    {
+      if (sframe_encoder_write_sframe_hdr (encoder))
+	return sframe_ret_set_errno (errp, SFRAME_ERR_BUF_INVAL);
+      *encoded_size = bufsize;
+      return encoder->sfe_data;
+    }
+
   foreign_endian = need_swapping (ehp->sfh_abi_arch);
 
   /* Write out the FDE Index and the FRE table in the sfe_data. */
@@ -130,6 +130,21 @@ struct saved_offsets
   struct saved_output_info *sections;
 };
 
+/* The parts of the pretend link made by
+   bfd_simple_get_relocated_section_contents that are worth keeping
+   between calls for the same BFD.  */
+
+struct bfd_simple_link
+{
+  /* The link hash table.  It is only attached to the BFD, as its
+     link.hash, during a call.  */
+  struct bfd_link_hash_table *hash;
+  struct bfd_link_callbacks callbacks;
+  /* Room for the output info of this many sections.  */
+  unsigned int saved_size;
+  struct saved_output_info *saved;
+};
+
 /* The sections in ABFD may already have output sections and offsets
    set if we are here during linking.
 
@@ -181,6 +196,73 @@ simple_restore_output_info (bfd *abfd ATTRIBUTE_UNUSED,
   section->output_section = output_info->section;
 }
 
+/* Return the pretend link of ABFD, making it if need be.  */
+
+static struct bfd_simple_link *
+simple_link (bfd *abfd)
+{
+  struct bfd_simple_link *sl = abfd->simple_link;
+  struct bfd_link_callbacks *callbacks;
+
+  if (sl != NULL)
+    return sl;
+
+  sl = (struct bfd_simple_link *) bfd_zmalloc (sizeof (*sl));
+  if (sl == NULL)
+    return NULL;
+  sl->hash = _bfd_generic_link_hash_table_create (abfd);
+  if (sl->hash == NULL)
+    {
+      free (sl);
+      return NULL;
+    }
+  /* Creating the table attached it to ABFD.  */
+  abfd->link.hash = NULL;
+  abfd->is_linker_output = false;
+
+  callbacks = &sl->callbacks;
+  callbacks->warning = simple_dummy_warning;
+  callbacks->undefined_symbol = simple_dummy_undefined_symbol;
+  callbacks->reloc_overflow = simple_dummy_reloc_overflow;
+  callbacks->reloc_dangerous = simple_dummy_reloc_dangerous;
+  callbacks->unattached_reloc = simple_dummy_unattached_reloc;
+  callbacks->multiple_definition = simple_dummy_multiple_definition;
+  callbacks->einfo = simple_dummy_einfo;
+  callbacks->multiple_common = simple_dummy_multiple_common;
+  callbacks->constructor = simple_dummy_constructor;
+  callbacks->add_to_set = simple_dummy_add_to_set;
+
+  abfd->simple_link = sl;
+  return sl;
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_simple_link_free
+
+SYNOPSIS
+	void _bfd_simple_link_free (bfd *);
+
+DESCRIPTION
+	Free the link state kept by
+	<<bfd_simple_get_relocated_section_contents>>.
+*/
+
+void
+_bfd_simple_link_free (bfd *abfd)
+{
+  struct bfd_simple_link *sl = abfd->simple_link;
+
+  if (sl == NULL)
+    return;
+  /* The root is the first member of the generic link hash table.  */
+  bfd_hash_table_free (&sl->hash->table);
+  free (sl->hash);
+  free (sl->saved);
+  free (sl);
+  abfd->simple_link = NULL;
+}
+
 /*
 FUNCTION
 	bfd_simple_relocate_secton
@@ -196,6 +278,11 @@ DESCRIPTION
 	be temporarily reset to 0.  The result will be stored at @var{outbuf}
 	or allocated with @code{bfd_malloc} if @var{outbuf} is @code{NULL}.
 
+	The pretend link used to apply the relocations is made on the
+	first call for @var{abfd} and kept, so that reading several
+	sections of one object only sets it up once.  It is freed when
+	the BFD is closed or its cached information freed.
+
 	Returns @code{NULL} on a fatal error; ignores errors applying
 	particular relocations.
 */
@@ -208,7 +295,7 @@ bfd_simple_get_relocated_section_contents (bfd *abfd,
 {
   struct bfd_link_info link_info;
   struct bfd_link_order link_order;
-  struct bfd_link_callbacks callbacks;
+  struct bfd_simple_link *sl;
   bfd_byte *contents;
   struct saved_offsets saved_offsets;
   bfd *link_next;
@@ -224,31 +311,26 @@ bfd_simple_get_relocated_section_contents (bfd *abfd,
     }
 
   /* In order to use bfd_get_relocated_section_contents, we need
-     to forge some data structures that it expects.  */
+     to forge some data structures that it expects.  The costly
+     ones are kept with ABFD.  */
+  link_next = abfd->link.next;
+  abfd->link.next = NULL;
+  sl = simple_link (abfd);
+  if (sl == NULL)
+    {
+      abfd->link.next = link_next;
+      return NULL;
+    }
+  abfd->link.hash = sl->hash;
+  abfd->is_linker_output = true;
 
   /* Fill in the bare minimum number of fields for our purposes.  */
   memset (&link_info, 0, sizeof (link_info));
   link_info.output_bfd = abfd;
   link_info.input_bfds = abfd;
   link_info.input_bfds_tail = &abfd->link.next;
-
-  link_next = abfd->link.next;
-  abfd->link.next = NULL;
-  link_info.hash = _bfd_generic_link_hash_table_create (abfd);
-  link_info.callbacks = &callbacks;
-  /* Make sure that any fields not initialised below do not
-     result in a potential indirection via a random address.  */
-  memset (&callbacks, 0, sizeof callbacks);
-  callbacks.warning = simple_dummy_warning;
-  callbacks.undefined_symbol = simple_dummy_undefined_symbol;
-  callbacks.reloc_overflow = simple_dummy_reloc_overflow;
-  callbacks.reloc_dangerous = simple_dummy_reloc_dangerous;
-  callbacks.unattached_reloc = simple_dummy_unattached_reloc;
-  callbacks.multiple_definition = simple_dummy_multiple_definition;
-  callbacks.einfo = simple_dummy_einfo;
-  callbacks.multiple_common = simple_dummy_multiple_common;
-  callbacks.constructor = simple_dummy_constructor;
-  callbacks.add_to_set = simple_dummy_add_to_set;
+  link_info.hash = sl->hash;
+  link_info.callbacks = &sl->callbacks;
 
   memset (&link_order, 0, sizeof (link_order));
   link_order.next = NULL;
@@ -259,11 +341,19 @@ bfd_simple_get_relocated_section_contents (bfd *abfd,
 
   contents = NULL;
 
+  if (sl->saved_size < abfd->section_count)
+    {
+      struct saved_output_info *saved;
+
+      saved = bfd_realloc (sl->saved,
+			   sizeof (*saved) * abfd->section_count);
+      if (saved == NULL)
+	goto out1;
+      sl->saved = saved;
+      sl->saved_size = abfd->section_count;
+    }
   saved_offsets.section_count = abfd->section_count;
-  saved_offsets.sections = malloc (sizeof (*saved_offsets.sections)
-				   * saved_offsets.section_count);
-  if (saved_offsets.sections == NULL)
-    goto out1;
+  saved_offsets.sections = sl->saved;
   bfd_map_over_sections (abfd, simple_save_output_info, &saved_offsets);
 
   if (symbol_table == NULL)
@@ -281,9 +371,9 @@ bfd_simple_get_relocated_section_contents (bfd *abfd,
 						 symbol_table);
  out2:
   bfd_map_over_sections (abfd, simple_restore_output_info, &saved_offsets);
-  free (saved_offsets.sections);
  out1:
-  _bfd_generic_link_hash_table_free (abfd);
+  abfd->link.hash = NULL;
+  abfd->is_linker_output = false;
   abfd->link.next = link_next;
   return contents;
 }
@@ -126,6 +126,9 @@ static const char digs[] = "0123456789ABCDEF";
 /* Default size for a CHUNK.  */
 #define DEFAULT_CHUNK 16
 
+/* The size of the buffer records are formatted into when writing.  */
+#define OUTBUF_SIZE 65536
+
 /* The number of data bytes we actually fit onto a line on output.
    This variable can be modified by objcopy's --srec-len parameter.
    For a 0x75 byte record you should set --srec-len=0x70.  */
@@ -170,6 +173,9 @@ typedef struct srec_data_struct
     struct srec_symbol *symbols;
     struct srec_symbol *symtail;
     asymbol *csymbols;
+    /* Records not yet written out, while writing.  */
+    char *outbuf;
+    size_t outlen;
   }
 tdata_type;
 
@@ -207,26 +213,70 @@ srec_mkobject (bfd *abfd)
   tdata->symbols = NULL;
   tdata->symtail = NULL;
   tdata->csymbols = NULL;
+  tdata->outbuf = NULL;
+  tdata->outlen = 0;
 
   return true;
 }
 
-/* Read a byte from an S record file.  Set *ERRORPTR if an error
-   occurred.  Return EOF on error or end of file.  */
+/* S record files are scanned and read from a view of the whole file,
+   rather than a byte at a time.  This is a position in that view.  */
 
-static int
-srec_get_byte (bfd *abfd, bool *errorptr)
+struct srec_cursor
+{
+  /* The start of the file.  */
+  const bfd_byte *start;
+  /* The next byte to read.  */
+  const bfd_byte *p;
+  /* The end of the file.  */
+  const bfd_byte *end;
+};
+
+/* Point CUR at file position POS of ABFD.  Return FALSE on error.  */
+
+static bool
+srec_init_cursor (bfd *abfd, file_ptr pos, struct srec_cursor *cur)
 {
-  bfd_byte c;
+  bfd_size_type size = bfd_get_file_size (abfd);
 
-  if (bfd_bread (&c, (bfd_size_type) 1, abfd) != 1)
+  cur->start = _bfd_file_view (abfd, 0, size);
+  if (cur->start == NULL)
+    return false;
+  if ((bfd_size_type) pos > size)
     {
-      if (bfd_get_error () != bfd_error_file_truncated)
-	*errorptr = true;
-      return EOF;
+      bfd_set_error (bfd_error_file_truncated);
+      return false;
     }
+  cur->p = cur->start + pos;
+  cur->end = cur->start + size;
+  return true;
+}
+
+/* Read a byte from an S record file.  Return EOF at end of file.  */
+
+static inline int
+srec_get_byte (struct srec_cursor *cur)
+{
+  if (cur->p >= cur->end)
+    return EOF;
+  return *cur->p++;
+}
+
+/* Return a pointer to the next COUNT bytes of an S record file, or
+   NULL if the file ends first.  */
+
+static inline const bfd_byte *
+srec_get_bytes (struct srec_cursor *cur, size_t count)
+{
+  const bfd_byte *p = cur->p;
 
-  return (int) (c & 0xff);
+  if ((size_t) (cur->end - p) < count)
+    {
+      bfd_set_error (bfd_error_file_truncated);
+      return NULL;
+    }
+  cur->p += count;
+  return p;
 }
 
 /* Report a problem in an S record file.  FIXME: This probably should
@@ -234,16 +284,10 @@ srec_get_byte (bfd *abfd, bool *errorptr)
    error messages.  */
 
 static void
-srec_bad_byte (bfd *abfd,
-	       unsigned int lineno,
-	       int c,
-	       bool error)
+srec_bad_byte (bfd *abfd, unsigned int lineno, int c)
 {
   if (c == EOF)
-    {
-      if (! error)
-	bfd_set_error (bfd_error_file_truncated);
-    }
+    bfd_set_error (bfd_error_file_truncated);
   else
     {
       char buf[40];
@@ -289,6 +333,45 @@ srec_new_symbol (bfd *abfd, const char *name, bfd_vma val)
   return true;
 }
 
+/* Decode the COUNT address and data bytes of the S record at DATA
+   into REC, and check them against the checksum that follows them.
+   COUNT_BYTE is the byte count of the record.  Return FALSE and
+   report an error if the record is bad.  */
+
+static bool
+srec_decode_record (bfd *abfd,
+		    unsigned int lineno,
+		    const bfd_byte *data,
+		    unsigned int count,
+		    unsigned int count_byte,
+		    bfd_byte *rec)
+{
+  unsigned int check_sum = count_byte;
+  unsigned int i;
+
+  if (! _bfd_hex_decode (rec, data, count + 1))
+    {
+      for (i = 0; ISHEX (data[i]); i++)
+	;
+      srec_bad_byte (abfd, lineno, data[i]);
+      return false;
+    }
+
+  for (i = 0; i < count; i++)
+    check_sum += rec[i];
+  if (((255 - check_sum) & 0xff) != rec[count])
+    {
+      _bfd_error_handler
+	/* xgettext:c-format */
+	(_("%pB:%d: bad checksum in S-record file"),
+	 abfd, lineno);
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+
+  return true;
+}
+
 /* Read the S record file and turn it into sections.  We create a new
    section for each contiguous set of bytes.  */
 
@@ -297,16 +380,14 @@ srec_scan (bfd *abfd)
 {
   int c;
   unsigned int lineno = 1;
-  bool error = false;
-  bfd_byte *buf = NULL;
-  size_t bufsize = 0;
+  struct srec_cursor cur;
   asection *sec = NULL;
   char *symbuf = NULL;
 
-  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0)
+  if (! srec_init_cursor (abfd, 0, &cur))
     goto error_return;
 
-  while ((c = srec_get_byte (abfd, &error)) != EOF)
+  while ((c = srec_get_byte (&cur)) != EOF)
     {
       /* We only build sections from contiguous S-records, so if this
 	 is not an S-record, then stop building a section.  */
@@ -316,7 +397,7 @@ srec_scan (bfd *abfd)
       switch (c)
 	{
 	default:
-	  srec_bad_byte (abfd, lineno, c, error);
+	  srec_bad_byte (abfd, lineno, c);
 	  goto error_return;
 
 	case '\n':
@@ -328,12 +409,12 @@ srec_scan (bfd *abfd)
 
 	case '$':
 	  /* Starting a module name, which we ignore.  */
-	  while ((c = srec_get_byte (abfd, &error)) != '\n'
+	  while ((c = srec_get_byte (&cur)) != '\n'
 		 && c != EOF)
 	    ;
 	  if (c == EOF)
 	    {
-	      srec_bad_byte (abfd, lineno, c, error);
+	      srec_bad_byte (abfd, lineno, c);
 	      goto error_return;
 	    }
 
@@ -348,7 +429,7 @@ srec_scan (bfd *abfd)
 	      bfd_vma symval;
 
 	      /* Starting a symbol definition.  */
-	      while ((c = srec_get_byte (abfd, &error)) != EOF
+	      while ((c = srec_get_byte (&cur)) != EOF
 		     && (c == ' ' || c == '\t'))
 		;
 
@@ -357,7 +438,7 @@ srec_scan (bfd *abfd)
 
 	      if (c == EOF)
 		{
-		  srec_bad_byte (abfd, lineno, c, error);
+		  srec_bad_byte (abfd, lineno, c);
 		  goto error_return;
 		}
 
@@ -369,7 +450,7 @@ srec_scan (bfd *abfd)
 	      p = symbuf;
 
 	      *p++ = c;
-	      while ((c = srec_get_byte (abfd, &error)) != EOF
+	      while ((c = srec_get_byte (&cur)) != EOF
 		     && ! ISSPACE (c))
 		{
 		  if ((bfd_size_type) (p - symbuf) >= alc)
@@ -389,7 +470,7 @@ srec_scan (bfd *abfd)
 
 	      if (c == EOF)
 		{
-		  srec_bad_byte (abfd, lineno, c, error);
+		  srec_bad_byte (abfd, lineno, c);
 		  goto error_return;
 		}
 
@@ -401,22 +482,22 @@ srec_scan (bfd *abfd)
 	      free (symbuf);
 	      symbuf = NULL;
 
-	      while ((c = srec_get_byte (abfd, &error)) != EOF
+	      while ((c = srec_get_byte (&cur)) != EOF
 		     && (c == ' ' || c == '\t'))
 		;
 	      if (c == EOF)
 		{
-		  srec_bad_byte (abfd, lineno, c, error);
+		  srec_bad_byte (abfd, lineno, c);
 		  goto error_return;
 		}
 
 	      /* Skip a dollar sign before the hex value.  */
 	      if (c == '$')
 		{
-		  c = srec_get_byte (abfd, &error);
+		  c = srec_get_byte (&cur);
 		  if (c == EOF)
 		    {
-		      srec_bad_byte (abfd, lineno, c, error);
+		      srec_bad_byte (abfd, lineno, c);
 		      goto error_return;
 		    }
 		}
@@ -426,10 +507,10 @@ srec_scan (bfd *abfd)
 		{
 		  symval <<= 4;
 		  symval += NIBBLE (c);
-		  c = srec_get_byte (abfd, &error);
+		  c = srec_get_byte (&cur);
 		  if (c == EOF)
 		    {
-		      srec_bad_byte (abfd, lineno, c, error);
+		      srec_bad_byte (abfd, lineno, c);
 		      goto error_return;
 		    }
 		}
@@ -444,7 +525,7 @@ srec_scan (bfd *abfd)
 	    ++lineno;
 	  else if (c != '\r')
 	    {
-	      srec_bad_byte (abfd, lineno, c, error);
+	      srec_bad_byte (abfd, lineno, c);
 	      goto error_return;
 	    }
 
@@ -453,17 +534,18 @@ srec_scan (bfd *abfd)
 	case 'S':
 	  {
 	    file_ptr pos;
-	    unsigned char hdr[3];
-	    unsigned int bytes, min_bytes;
+	    const bfd_byte *hdr;
+	    unsigned int bytes, min_bytes, count_byte, addr_bytes, i;
 	    bfd_vma address;
-	    bfd_byte *data;
-	    unsigned char check_sum;
+	    const bfd_byte *data;
+	    bfd_byte rec[MAXCHUNK];
 
 	    /* Starting an S-record.  */
 
-	    pos = bfd_tell (abfd) - 1;
+	    pos = cur.p - 1 - cur.start;
 
-	    if (bfd_bread (hdr, (bfd_size_type) 3, abfd) != 3)
+	    hdr = srec_get_bytes (&cur, 3);
+	    if (hdr == NULL)
 	      goto error_return;
 
 	    if (! ISHEX (hdr[1]) || ! ISHEX (hdr[2]))
@@ -472,11 +554,11 @@ srec_scan (bfd *abfd)
 		  c = hdr[1];
 		else
 		  c = hdr[2];
-		srec_bad_byte (abfd, lineno, c, error);
+		srec_bad_byte (abfd, lineno, c);
 		goto error_return;
 	      }
 
-	    check_sum = bytes = HEX (hdr + 1);
+	    count_byte = bytes = HEX (hdr + 1);
 	    min_bytes = 3;
 	    if (hdr[0] == '2' || hdr[0] == '8')
 	      min_bytes = 4;
@@ -491,23 +573,14 @@ srec_scan (bfd *abfd)
 		goto error_return;
 	      }
 
-	    if (bytes * 2 > bufsize)
-	      {
-		free (buf);
-		buf = (bfd_byte *) bfd_malloc ((bfd_size_type) bytes * 2);
-		if (buf == NULL)
-		  goto error_return;
-		bufsize = bytes * 2;
-	      }
-
-	    if (bfd_bread (buf, (bfd_size_type) bytes * 2, abfd) != bytes * 2)
+	    data = srec_get_bytes (&cur, (size_t) bytes * 2);
+	    if (data == NULL)
 	      goto error_return;
 
 	    /* Ignore the checksum byte.  */
 	    --bytes;
 
 	    address = 0;
-	    data = buf;
 	    switch (hdr[0])
 	      {
 	      case '0':
@@ -517,26 +590,18 @@ srec_scan (bfd *abfd)
 		sec = NULL;
 		break;
 
-	      case '3':
-		check_sum += HEX (data);
-		address = HEX (data);
-		data += 2;
-		--bytes;
-		/* Fall through.  */
-	      case '2':
-		check_sum += HEX (data);
-		address = (address << 8) | HEX (data);
-		data += 2;
-		--bytes;
-		/* Fall through.  */
 	      case '1':
-		check_sum += HEX (data);
-		address = (address << 8) | HEX (data);
-		data += 2;
-		check_sum += HEX (data);
-		address = (address << 8) | HEX (data);
-		data += 2;
-		bytes -= 2;
+	      case '2':
+	      case '3':
+		if (! srec_decode_record (abfd, lineno, data, bytes,
+					  count_byte, rec))
+		  goto error_return;
+
+		/* S1 has a 2 byte address, S2 3 bytes and S3 4 bytes.  */
+		addr_bytes = hdr[0] - '0' + 1;
+		for (i = 0; i < addr_bytes; i++)
+		  address = (address << 8) | rec[i];
+		bytes -= addr_bytes;
 
 		if (sec != NULL
 		    && sec->vma + sec->size == address)
@@ -565,59 +630,23 @@ srec_scan (bfd *abfd)
 		    sec->size = bytes;
 		    sec->filepos = pos;
 		  }
-
-		while (bytes > 0)
-		  {
-		    check_sum += HEX (data);
-		    data += 2;
-		    bytes--;
-		  }
-		check_sum = 255 - (check_sum & 0xff);
-		if (check_sum != HEX (data))
-		  {
-		    _bfd_error_handler
-		      /* xgettext:c-format */
-		      (_("%pB:%d: bad checksum in S-record file"),
-		       abfd, lineno);
-		    bfd_set_error (bfd_error_bad_value);
-		    goto error_return;
-		  }
-
 		break;
 
 	      case '7':
-		check_sum += HEX (data);
-		address = HEX (data);
-		data += 2;
-		/* Fall through.  */
 	      case '8':
-		check_sum += HEX (data);
-		address = (address << 8) | HEX (data);
-		data += 2;
-		/* Fall through.  */
 	      case '9':
-		check_sum += HEX (data);
-		address = (address << 8) | HEX (data);
-		data += 2;
-		check_sum += HEX (data);
-		address = (address << 8) | HEX (data);
-		data += 2;
+		/* S7 has a 4 byte address, S8 3 bytes and S9 2 bytes.
+		   The checksum follows the address.  */
+		addr_bytes = '9' - hdr[0] + 2;
+		if (! srec_decode_record (abfd, lineno, data, addr_bytes,
+					  count_byte, rec))
+		  goto error_return;
+
+		for (i = 0; i < addr_bytes; i++)
+		  address = (address << 8) | rec[i];
 
 		/* This is a termination record.  */
 		abfd->start_address = address;
-
-		check_sum = 255 - (check_sum & 0xff);
-		if (check_sum != HEX (data))
-		  {
-		    _bfd_error_handler
-		      /* xgettext:c-format */
-		      (_("%pB:%d: bad checksum in S-record file"),
-		       abfd, lineno);
-		    bfd_set_error (bfd_error_bad_value);
-		    goto error_return;
-		  }
-
-		free (buf);
 		return true;
 	      }
 	  }
@@ -625,15 +654,10 @@ srec_scan (bfd *abfd)
 	}
     }
 
-  if (error)
-    goto error_return;
-
-  free (buf);
   return true;
 
  error_return:
   free (symbuf);
-  free (buf);
   return false;
 }
 
@@ -714,19 +738,18 @@ srec_read_section (bfd *abfd, asection *section, bfd_byte *contents)
 {
   int c;
   bfd_size_type sofar = 0;
-  bool error = false;
-  bfd_byte *buf = NULL;
-  size_t bufsize = 0;
+  struct srec_cursor cur;
 
-  if (bfd_seek (abfd, section->filepos, SEEK_SET) != 0)
-    goto error_return;
+  if (! srec_init_cursor (abfd, section->filepos, &cur))
+    return false;
 
-  while ((c = srec_get_byte (abfd, &error)) != EOF)
+  while ((c = srec_get_byte (&cur)) != EOF)
     {
-      bfd_byte hdr[3];
-      unsigned int bytes;
+      const bfd_byte *hdr;
+      unsigned int bytes, addr_bytes, i;
       bfd_vma address;
-      bfd_byte *data;
+      const bfd_byte *data;
+      bfd_byte rec[4];
 
       if (c == '\r' || c == '\n')
 	continue;
@@ -734,89 +757,52 @@ srec_read_section (bfd *abfd, asection *section, bfd_byte *contents)
       /* This is called after srec_scan has already been called, so we
 	 ought to know the exact format.  */
       if (c != 'S')
-	goto error_return;
+	return false;
 
-      if (bfd_bread (hdr, (bfd_size_type) 3, abfd) != 3)
-	goto error_return;
+      hdr = srec_get_bytes (&cur, 3);
+      if (hdr == NULL)
+	return false;
 
       BFD_ASSERT (ISHEX (hdr[1]) && ISHEX (hdr[2]));
 
       bytes = HEX (hdr + 1);
 
-      if (bytes * 2 > bufsize)
-	{
-	  free (buf);
-	  buf = (bfd_byte *) bfd_malloc ((bfd_size_type) bytes * 2);
-	  if (buf == NULL)
-	    goto error_return;
-	  bufsize = bytes * 2;
-	}
-
-      if (bfd_bread (buf, (bfd_size_type) bytes * 2, abfd) != bytes * 2)
-	goto error_return;
+      data = srec_get_bytes (&cur, (size_t) bytes * 2);
+      if (data == NULL)
+	return false;
 
-      address = 0;
-      data = buf;
       switch (hdr[0])
 	{
 	default:
-	  if (sofar != section->size)
-	    goto error_return;
-	  free (buf);
-	  return true;
+	  return sofar == section->size;
 
-	case '3':
-	  address = HEX (data);
-	  data += 2;
-	  --bytes;
-	  /* Fall through.  */
-	case '2':
-	  address = (address << 8) | HEX (data);
-	  data += 2;
-	  --bytes;
-	  /* Fall through.  */
 	case '1':
-	  address = (address << 8) | HEX (data);
-	  data += 2;
-	  address = (address << 8) | HEX (data);
-	  data += 2;
-	  bytes -= 2;
+	case '2':
+	case '3':
+	  addr_bytes = hdr[0] - '0' + 1;
+	  _bfd_hex_decode (rec, data, addr_bytes);
+	  address = 0;
+	  for (i = 0; i < addr_bytes; i++)
+	    address = (address << 8) | rec[i];
 
 	  if (address != section->vma + sofar)
 	    {
 	      /* We've come to the end of this section.  */
-	      if (sofar != section->size)
-		goto error_return;
-	      free (buf);
-	      return true;
+	      return sofar == section->size;
 	    }
 
 	  /* Don't consider checksum.  */
-	  --bytes;
-
-	  while (bytes-- != 0)
-	    {
-	      contents[sofar] = HEX (data);
-	      data += 2;
-	      ++sofar;
-	    }
+	  bytes -= addr_bytes + 1;
+	  if (bytes > section->size - sofar)
+	    return false;
 
+	  _bfd_hex_decode (contents + sofar, data + addr_bytes * 2, bytes);
+	  sofar += bytes;
 	  break;
 	}
     }
 
-  if (error)
-    goto error_return;
-
-  if (sofar != section->size)
-    goto error_return;
-
-  free (buf);
-  return true;
-
- error_return:
-  free (buf);
-  return false;
+  return sofar == section->size;
 }
 
 /* Get the contents of a section in an S-record file.  */
@@ -937,6 +923,18 @@ srec_set_section_contents (bfd *abfd,
   return true;
 }
 
+/* Write out the records collected by srec_write_record.  */
+
+static bool
+srec_flush_records (bfd *abfd)
+{
+  tdata_type *tdata = abfd->tdata.srec_data;
+  size_t len = tdata->outlen;
+
+  tdata->outlen = 0;
+  return bfd_bwrite (tdata->outbuf, len, abfd) == len;
+}
+
 /* Write a record of type, of the supplied number of bytes. The
    supplied bytes and length don't have a checksum. That's worked out
    here.  */
@@ -948,12 +946,17 @@ srec_write_record (bfd *abfd,
 		   const bfd_byte *data,
 		   const bfd_byte *end)
 {
-  char buffer[2 * MAXCHUNK + 6];
+  tdata_type *tdata = abfd->tdata.srec_data;
   unsigned int check_sum = 0;
-  const bfd_byte *src = data;
-  char *dst = buffer;
+  char *buffer;
+  char *dst;
   char *length;
-  bfd_size_type wrlen;
+
+  /* Records are collected in OUTBUF and written out when it fills.  */
+  if (tdata->outlen + 2 * MAXCHUNK + 6 > OUTBUF_SIZE
+      && ! srec_flush_records (abfd))
+    return false;
+  buffer = dst = tdata->outbuf + tdata->outlen;
 
   *dst++ = 'S';
   *dst++ = '0' + type;
@@ -983,11 +986,8 @@ srec_write_record (bfd *abfd,
       break;
 
     }
-  for (src = data; src < end; src++)
-    {
-      TOHEX (dst, *src, check_sum);
-      dst += 2;
-    }
+  check_sum += _bfd_hex_encode (dst, data, end - data);
+  dst += (end - data) * 2;
 
   /* Fill in the length.  */
   TOHEX (length, (dst - length) / 2, check_sum);
@@ -998,9 +998,9 @@ srec_write_record (bfd *abfd,
 
   *dst++ = '\r';
   *dst++ = '\n';
-  wrlen = dst - buffer;
+  tdata->outlen += dst - buffer;
 
-  return bfd_bwrite ((void *) buffer, wrlen, abfd) == wrlen;
+  return true;
 }
 
 static bool
@@ -1124,6 +1124,7 @@ internal_srec_write_object_contents (bfd *abfd, int symbols)
 {
   tdata_type *tdata = abfd->tdata.srec_data;
   srec_data_list_type *list;
+  bool ret = false;
 
   if (symbols)
     {
@@ -1131,8 +1132,13 @@ internal_srec_write_object_contents (bfd *abfd, int symbols)
 	return false;
     }
 
-  if (! srec_write_header (abfd))
+  tdata->outbuf = (char *) bfd_malloc (OUTBUF_SIZE);
+  if (tdata->outbuf == NULL)
     return false;
+  tdata->outlen = 0;
+
+  if (! srec_write_header (abfd))
+    goto out;
 
   /* Now wander though all the sections provided and output them.  */
   list = tdata->head;
@@ -1140,10 +1146,15 @@ internal_srec_write_object_contents (bfd *abfd, int symbols)
   while (list != (srec_data_list_type *) NULL)
     {
       if (! srec_write_section (abfd, tdata, list))
-	return false;
+	goto out;
       list = list->next;
     }
-  return srec_write_terminator (abfd, tdata);
+  ret = srec_write_terminator (abfd, tdata) && srec_flush_records (abfd);
+
+ out:
+  free (tdata->outbuf);
+  tdata->outbuf = NULL;
+  return ret;
 }
 
 static bool
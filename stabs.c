@@ -157,6 +157,77 @@ stab_link_includes_newfunc (struct bfd_hash_entry *entry,
   return (struct bfd_hash_entry *) ret;
 }
 
+/* Collect the characters of the stabs strings of the N_BINCL...N_EINCL
+   sequence starting after SYM into *PBUF, which has *PBUF_LEN bytes
+   and is grown as needed.  Nested sequences and N_EXCL symbols are
+   ignored, as are the file numbers in types (the first number after
+   an open parenthesis).  Store the sum of the characters in *PSUM and
+   return their number, or -1 on error.  */
+
+static bfd_size_type
+stab_link_include_chars (bfd *abfd, const bfd_byte *sym,
+			 const bfd_byte *symend, const char *strings,
+			 char **pbuf, bfd_size_type *pbuf_len, bfd_vma *psum)
+{
+  bfd_vma sum_chars = 0;
+  bfd_size_type num_chars = 0;
+  int nest = 0;
+  const bfd_byte *incl_sym;
+
+  for (incl_sym = sym + STABSIZE;
+       incl_sym < symend;
+       incl_sym += STABSIZE)
+    {
+      int incl_type;
+      const char *str;
+
+      incl_type = incl_sym[TYPEOFF];
+      if (incl_type == 0)
+	break;
+      else if (incl_type == (int) N_EXCL)
+	continue;
+      else if (incl_type == (int) N_EINCL)
+	{
+	  if (nest == 0)
+	    break;
+	  --nest;
+	  continue;
+	}
+      else if (incl_type == (int) N_BINCL)
+	{
+	  ++nest;
+	  continue;
+	}
+      else if (nest != 0)
+	continue;
+
+      str = strings + bfd_get_32 (abfd, incl_sym + STRDXOFF);
+      for (; *str != '\0'; str++)
+	{
+	  if (num_chars >= *pbuf_len)
+	    {
+	      *pbuf_len = *pbuf_len < 32 * 1024 ? 32 * 1024 : *pbuf_len * 2;
+	      *pbuf = (char *) bfd_realloc_or_free (*pbuf, *pbuf_len);
+	      if (*pbuf == NULL)
+		return (bfd_size_type) -1;
+	    }
+	  (*pbuf)[num_chars++] = *str;
+	  sum_chars += *str;
+	  if (*str == '(')
+	    {
+	      /* Skip the file number.  */
+	      ++str;
+	      while (ISDIGIT (*str))
+		++str;
+	      --str;
+	    }
+	}
+    }
+
+  *psum = sum_chars;
+  return num_chars;
+}
+
 /*
 INTERNAL_FUNCTION
 	_bfd_link_section_stabs
@@ -187,6 +258,8 @@ _bfd_link_section_stabs (bfd *abfd,
   bfd_byte *sym, *symend;
   bfd_size_type stroff, next_stroff, skip;
   bfd_size_type *pstridx;
+  char *symb = NULL;
+  bfd_size_type symb_len = 0;
 
   if (stabsec->size == 0
       || stabstrsec->size == 0
@@ -317,76 +390,24 @@ _bfd_link_section_stabs (bfd *abfd,
 	 for a header file.  We need to scan ahead to the next N_EINCL
 	 symbol, ignoring nesting, adding up all the characters in the
 	 symbol names, not including the file numbers in types (the
-	 first number after an open parenthesis).  */
+	 first number after an open parenthesis).  The characters are
+	 collected in SYMB, which is reused for every N_BINCL and only
+	 copied when the header has not been seen before.  */
       if (type == (int) N_BINCL)
 	{
 	  bfd_vma sum_chars;
-	  bfd_vma num_chars;
-	  bfd_vma buf_len = 0;
-	  char * symb;
-	  char * symb_rover;
+	  bfd_size_type num_chars;
 	  int nest;
 	  bfd_byte * incl_sym;
 	  struct stab_link_includes_entry * incl_entry;
 	  struct stab_link_includes_totals * t;
 	  struct stab_excl_list * ne;
 
-	  symb = symb_rover = NULL;
-	  sum_chars = num_chars = 0;
-	  nest = 0;
-
-	  for (incl_sym = sym + STABSIZE;
-	       incl_sym < symend;
-	       incl_sym += STABSIZE)
-	    {
-	      int incl_type;
-
-	      incl_type = incl_sym[TYPEOFF];
-	      if (incl_type == 0)
-		break;
-	      else if (incl_type == (int) N_EXCL)
-		continue;
-	      else if (incl_type == (int) N_EINCL)
-		{
-		  if (nest == 0)
-		    break;
-		  --nest;
-		}
-	      else if (incl_type == (int) N_BINCL)
-		++nest;
-	      else if (nest == 0)
-		{
-		  const char *str;
-
-		  str = ((char *) stabstrbuf
-			 + stroff
-			 + bfd_get_32 (abfd, incl_sym + STRDXOFF));
-		  for (; *str != '\0'; str++)
-		    {
-		      if (num_chars >= buf_len)
-			{
-			  buf_len += 32 * 1024;
-			  symb = (char *) bfd_realloc_or_free (symb, buf_len);
-			  if (symb == NULL)
-			    goto error_return;
-			  symb_rover = symb + num_chars;
-			}
-		      * symb_rover ++ = * str;
-		      sum_chars += *str;
-		      num_chars ++;
-		      if (*str == '(')
-			{
-			  /* Skip the file number.  */
-			  ++str;
-			  while (ISDIGIT (*str))
-			    ++str;
-			  --str;
-			}
-		    }
-		}
-	    }
-
-	  BFD_ASSERT (num_chars == (bfd_vma) (symb_rover - symb));
+	  num_chars = stab_link_include_chars (abfd, sym, symend,
+					       (char *) stabstrbuf + stroff,
+					       &symb, &symb_len, &sum_chars);
+	  if (num_chars == (bfd_size_type) -1)
+	    goto error_return;
 
 	  /* If we have already included a header file with the same
 	     value, then replaced this one with an N_EXCL symbol.  */
@@ -423,8 +444,11 @@ _bfd_link_section_stabs (bfd *abfd,
 		goto error_return;
 	      t->sum_chars = sum_chars;
 	      t->num_chars = num_chars;
-	      /* Trim data down.  */
-	      t->symb = symb = (char *) bfd_realloc_or_free (symb, num_chars);
+	      t->symb = (char *) bfd_hash_allocate (&sinfo->includes,
+						    num_chars + 1);
+	      if (t->symb == NULL)
+		goto error_return;
+	      memcpy ((char *) t->symb, symb, num_chars);
 	      t->next = incl_entry->totals;
 	      incl_entry->totals = t;
 	    }
@@ -436,9 +460,6 @@ _bfd_link_section_stabs (bfd *abfd,
 		 pass to change the type to N_EXCL.  */
 	      ne->type = (int) N_EXCL;
 
-	      /* Free off superfluous symbols.  */
-	      free (symb);
-
 	      /* Mark the skipped symbols.  */
 
 	      nest = 0;
@@ -475,6 +496,7 @@ _bfd_link_section_stabs (bfd *abfd,
 	}
     }
 
+  free (symb);
   free (stabbuf);
   stabbuf = NULL;
   free (stabstrbuf);
@@ -523,6 +545,7 @@ _bfd_link_section_stabs (bfd *abfd,
   return true;
 
  error_return:
+  free (symb);
   free (stabbuf);
   free (stabstrbuf);
   return false;
@@ -967,20 +990,24 @@ struct stab_pending_var
 	bfd_vma val;
 };
 
-/* A list of these structures is used to hold the types for a single
-   file.  */
+/* This structure holds the types for a single file.  The types are
+   kept in blocks of STAB_TYPES_SLOTS, indexed directly by type number
+   divided by STAB_TYPES_SLOTS.  A block never moves once allocated,
+   since debug_make_indirect_type keeps pointers to its slots.  */
 
 struct stab_types
 {
-	/* Next set of slots for this file.  */
-	struct stab_types* next;
-	/* Where the TYPES array starts.  */
-	unsigned int base_index;
-	/* Types indexed by type number.  */
+	/* Number of entries in BLOCKS.  */
+	unsigned int count;
+	/* Blocks of types indexed by type number, or NULL if no type in
+	   the block has been seen yet.  */
 #define STAB_TYPES_SLOTS (16)
-	debug_type types[STAB_TYPES_SLOTS];
+	debug_type** blocks;
 };
 
+/* The largest type number we accept.  */
+#define STAB_TYPES_MAX (0x1000000)
+
 /* We keep a list of undefined tags that we encounter, so that we can
    fill them in if the tag is later defined.  */
 
@@ -1313,7 +1340,7 @@ parse_stab(void* dhandle, void* handle, int type, int desc, bfd_vma value,
 
 		/* We need to reset the mapping from type numbers to types.  We
 	   can only free the file_types array, not the stab_types
-	   list entries due to the use of debug_make_indirect_type.  */
+	   entries due to the use of debug_make_indirect_type.  */
 		info->files = 1;
 		info->file_types = xrealloc(info->file_types, sizeof(*info->file_types));
 		info->file_types[0] = NULL;
@@ -2525,6 +2552,37 @@ parse_stab_type(void* dhandle,
 	return dtype;
 }
 
+/* Read one of the numbers of a type number.  Type numbers are almost
+   always short decimal numbers, which we read here without going
+   through strtoul; anything else is left to parse_number.  */
+
+static int
+parse_stab_type_index(const char** pp, const char* p_end)
+{
+	const char* p = *pp;
+	int v = 0;
+	int digits = 0;
+
+	if (p < p_end && *p == '0')
+	{
+		/* A leading zero means octal or hex to strtoul.  */
+		if (p + 1 < p_end && (ISDIGIT(p[1]) || p[1] == 'x' || p[1] == 'X'))
+			return (int)parse_number(pp, (bool*)NULL, p_end);
+	}
+
+	while (p < p_end && ISDIGIT(*p) && digits < 9)
+	{
+		v = v * 10 + (*p++ - '0');
+		++digits;
+	}
+
+	if (digits == 0 || (p < p_end && ISDIGIT(*p)))
+		return (int)parse_number(pp, (bool*)NULL, p_end);
+
+	*pp = p;
+	return v;
+}
+
 /* Read a number by which a type is referred to in dbx data, or
    perhaps read a pair (FILENUM, TYPENUM) in parentheses.  Just a
    single number N is equivalent to (0,N).  Return the two numbers by
@@ -2540,12 +2598,12 @@ parse_stab_type_number(const char** pp, int* typenums, const char* p_end)
 	if (**pp != '(')
 	{
 		typenums[0] = 0;
-		typenums[1] = (int)parse_number(pp, (bool*)NULL, p_end);
+		typenums[1] = parse_stab_type_index(pp, p_end);
 		return true;
 	}
 
 	++* pp;
-	typenums[0] = (int)parse_number(pp, (bool*)NULL, p_end);
+	typenums[0] = parse_stab_type_index(pp, p_end);
 	if (**pp != ',')
 	{
 		bad_stab(orig);
@@ -2553,7 +2611,7 @@ parse_stab_type_number(const char** pp, int* typenums, const char* p_end)
 	}
 
 	++* pp;
-	typenums[1] = (int)parse_number(pp, (bool*)NULL, p_end);
+	typenums[1] = parse_stab_type_index(pp, p_end);
 	if (**pp != ')')
 	{
 		bad_stab(orig);
@@ -4151,7 +4209,7 @@ struct bincl_file
 	bfd_vma hash;
 	/* The file index.  */
 	unsigned int file;
-	/* The list of types defined in this file.  */
+	/* The types defined in this file.  */
 	struct stab_types* file_types;
 };
 
@@ -4286,8 +4344,8 @@ stab_find_slot(void* dhandle, struct stab_handle* info, const int* typenums)
 {
 	unsigned int filenum;
 	unsigned int tindex;
-	unsigned int base_index;
-	struct stab_types** ps;
+	unsigned int block;
+	struct stab_types* t;
 
 	filenum = typenums[0];
 	tindex = typenums[1];
@@ -4298,21 +4356,42 @@ stab_find_slot(void* dhandle, struct stab_handle* info, const int* typenums)
 		return NULL;
 	}
 
-	ps = info->file_types + filenum;
-	base_index = tindex / STAB_TYPES_SLOTS * STAB_TYPES_SLOTS;
-	tindex -= base_index;
-	while (*ps && (*ps)->base_index < base_index)
-		ps = &(*ps)->next;
+	if (tindex >= STAB_TYPES_MAX)
+	{
+		fprintf(stderr, _("Type number %d out of range\n"), typenums[1]);
+		return NULL;
+	}
+
+	t = info->file_types[filenum];
+	if (t == NULL)
+	{
+		t = debug_xzalloc(dhandle, sizeof(*t));
+		info->file_types[filenum] = t;
+	}
 
-	if (*ps == NULL || (*ps)->base_index != base_index)
+	block = tindex / STAB_TYPES_SLOTS;
+	if (block >= t->count)
 	{
-		struct stab_types* n = debug_xzalloc(dhandle, sizeof(*n));
-		n->next = *ps;
-		n->base_index = base_index;
-		*ps = n;
+		unsigned int count;
+		debug_type** blocks;
+
+		/* The old array stays on the debug handle's objalloc, which
+		   at most doubles the memory used.  */
+		count = t->count < 16 ? 16 : t->count * 2;
+		if (count <= block)
+			count = block + 1;
+		blocks = debug_xzalloc(dhandle, count * sizeof(*blocks));
+		if (t->count != 0)
+			memcpy(blocks, t->blocks, t->count * sizeof(*blocks));
+		t->blocks = blocks;
+		t->count = count;
 	}
 
-	return (*ps)->types + tindex;
+	if (t->blocks[block] == NULL)
+		t->blocks[block] = debug_xzalloc(dhandle,
+			STAB_TYPES_SLOTS * sizeof(debug_type));
+
+	return t->blocks[block] + tindex % STAB_TYPES_SLOTS;
 }
 
 /* Find a type given a type number.  If the type has not been
@@ -803,6 +803,261 @@ DESCRIPTION
 .
 */
 
+/* The address index of a BFD, built by bfd_find_symbol_for_address.
+   Symbols are ordered by section index and then address, with only
+   the preferred symbol kept for each address.  The keys are stored in
+   Eytzinger order, the implicit layout of a complete binary search
+   tree in which node K has children 2K and 2K+1, so that the first
+   few levels of the search share cache lines.  */
+
+struct symbol_index_key
+{
+  unsigned int secidx;
+  /* Position of this key in SORTED.  */
+  unsigned int rank;
+  bfd_vma value;
+};
+
+struct bfd_symbol_index
+{
+  unsigned int count;
+  asymbol **sorted;
+  /* COUNT + 1 keys; element 0 is unused.  */
+  struct symbol_index_key *tree;
+};
+
+/* A symbol while the index is being sorted.  */
+
+struct symbol_index_sort
+{
+  unsigned int secidx;
+  bfd_vma value;
+  asymbol *sym;
+};
+
+/* Rank symbols at the same address, lowest first.  */
+
+static int
+symbol_index_class (const asymbol *sym)
+{
+  int c = 0;
+
+  if ((sym->flags & (BSF_GLOBAL | BSF_WEAK | BSF_GNU_UNIQUE)) == 0)
+    c += 1;
+  if ((sym->flags & (BSF_FUNCTION | BSF_OBJECT)) == 0)
+    c += 2;
+  if ((sym->flags & BSF_SECTION_SYM) != 0)
+    c += 4;
+  return c;
+}
+
+static int
+symbol_index_compare (const void *ap, const void *bp)
+{
+  const struct symbol_index_sort *a = (const struct symbol_index_sort *) ap;
+  const struct symbol_index_sort *b = (const struct symbol_index_sort *) bp;
+  int ac, bc;
+
+  if (a->secidx != b->secidx)
+    return a->secidx < b->secidx ? -1 : 1;
+  if (a->value != b->value)
+    return a->value < b->value ? -1 : 1;
+  ac = symbol_index_class (a->sym);
+  bc = symbol_index_class (b->sym);
+  if (ac != bc)
+    return ac - bc;
+  return strcmp (a->sym->name, b->sym->name);
+}
+
+/* Lay out the sorted keys in KEYS into INDEX->tree, doing an in-order
+   walk of the subtree at node K.  I is the next key to place.  */
+
+static unsigned int
+symbol_index_layout (struct bfd_symbol_index *sindex,
+		     const struct symbol_index_sort *keys,
+		     unsigned int i, size_t k)
+{
+  if (k <= sindex->count)
+    {
+      i = symbol_index_layout (sindex, keys, i, 2 * k);
+      sindex->tree[k].secidx = keys[i].secidx;
+      sindex->tree[k].value = keys[i].value;
+      sindex->tree[k].rank = i;
+      i++;
+      i = symbol_index_layout (sindex, keys, i, 2 * k + 1);
+    }
+  return i;
+}
+
+/* Read the symbols of ABFD, falling back on its dynamic symbols, and
+   build its address index.  */
+
+static struct bfd_symbol_index *
+symbol_index_build (bfd *abfd)
+{
+  struct bfd_symbol_index *sindex;
+  struct symbol_index_sort *keys;
+  asymbol **syms;
+  long long storage;
+  long long symcount;
+  long long i;
+  unsigned int n;
+  bool dynamic = false;
+
+  storage = bfd_get_symtab_upper_bound (abfd);
+  if (storage == 0 && (abfd->flags & DYNAMIC) != 0)
+    {
+      storage = bfd_get_dynamic_symtab_upper_bound (abfd);
+      dynamic = true;
+    }
+  if (storage < 0)
+    return NULL;
+
+  sindex = (struct bfd_symbol_index *) bfd_zalloc (abfd, sizeof (*sindex));
+  if (sindex == NULL)
+    return NULL;
+  if (storage == 0)
+    return sindex;
+
+  syms = (asymbol **) bfd_alloc (abfd, storage);
+  if (syms == NULL)
+    return NULL;
+  if (dynamic)
+    symcount = bfd_canonicalize_dynamic_symtab (abfd, syms);
+  else
+    symcount = bfd_canonicalize_symtab (abfd, syms);
+  if (symcount < 0)
+    return NULL;
+  if (symcount == 0 || symcount >= (unsigned int) -1)
+    return sindex;
+
+  keys = (struct symbol_index_sort *) bfd_malloc (symcount * sizeof (*keys));
+  if (keys == NULL)
+    return NULL;
+  n = 0;
+  for (i = 0; i < symcount; i++)
+    {
+      asymbol *sym = syms[i];
+
+      if (sym->name == NULL || sym->name[0] == '\0'
+	  || (sym->flags & (BSF_DEBUGGING | BSF_FILE)) != 0
+	  || sym->section->owner != abfd)
+	continue;
+      keys[n].secidx = sym->section->index;
+      keys[n].value = bfd_asymbol_value (sym);
+      keys[n].sym = sym;
+      n++;
+    }
+  qsort (keys, n, sizeof (*keys), symbol_index_compare);
+
+  /* Keep only the first, preferred, symbol at each address.  */
+  if (n != 0)
+    {
+      unsigned int j = 0;
+
+      for (i = 1; i < n; i++)
+	if (keys[i].secidx != keys[j].secidx || keys[i].value != keys[j].value)
+	  keys[++j] = keys[i];
+      n = j + 1;
+    }
+
+  sindex->count = n;
+  sindex->sorted = (asymbol **) bfd_alloc (abfd, n * sizeof (asymbol *));
+  sindex->tree = ((struct symbol_index_key *)
+		 bfd_alloc (abfd, (n + 1) * sizeof (*sindex->tree)));
+  if (sindex->sorted == NULL || sindex->tree == NULL)
+    {
+      free (keys);
+      return NULL;
+    }
+  for (i = 0; i < n; i++)
+    sindex->sorted[i] = keys[i].sym;
+  symbol_index_layout (sindex, keys, 0, 1);
+  free (keys);
+  return sindex;
+}
+
+/*
+FUNCTION
+	bfd_find_symbol_for_address
+
+SYNOPSIS
+	asymbol *bfd_find_symbol_for_address
+	  (bfd *abfd, asection *section, bfd_vma addr);
+
+DESCRIPTION
+	Return the symbol of @var{abfd} that @var{addr}, a virtual
+	address in @var{section}, belongs to: the symbol in that section
+	with the highest value not above @var{addr}.  If @var{section}
+	is NULL, the allocated section holding @var{addr} is used.
+	When several symbols share an address, global symbols are
+	preferred to local ones, function and object symbols to
+	others, and section symbols come last.  Debugging, file and
+	undefined symbols are ignored.
+
+	The first call reads the symbol table, or the dynamic symbol
+	table if there is no other, and builds a sorted index of it;
+	later calls search that index in O(log n) time.  The index is
+	kept until the BFD is closed or its cached information freed.
+	Return NULL if no symbol precedes @var{addr} in its section, or
+	on error.
+*/
+
+asymbol *
+bfd_find_symbol_for_address (bfd *abfd, asection *section, bfd_vma addr)
+{
+  struct bfd_symbol_index *sindex;
+  size_t k;
+  unsigned int rank;
+
+  if (section == NULL)
+    {
+      for (section = abfd->sections; section != NULL; section = section->next)
+	if ((section->flags & SEC_ALLOC) != 0
+	    && addr >= section->vma
+	    && addr - section->vma < bfd_section_size (section))
+	  break;
+      if (section == NULL)
+	return NULL;
+    }
+  else if (section->owner != abfd)
+    return NULL;
+
+  sindex = abfd->symbol_index;
+  if (sindex == NULL)
+    {
+      sindex = symbol_index_build (abfd);
+      if (sindex == NULL)
+	return NULL;
+      abfd->symbol_index = sindex;
+    }
+  if (sindex->count == 0)
+    return NULL;
+
+  /* Find the first key above (SECTION, ADDR).  */
+  k = 1;
+  while (k <= sindex->count)
+    {
+      const struct symbol_index_key *key = &sindex->tree[k];
+      bool above = (key->secidx > section->index
+		    || (key->secidx == section->index && key->value > addr));
+
+      k = 2 * k + !above;
+    }
+  /* Undo the final run of right turns, and the left turn before them,
+     to get back to that key.  */
+  while ((k & 1) != 0)
+    k >>= 1;
+  k >>= 1;
+
+  rank = k == 0 ? sindex->count : sindex->tree[k].rank;
+  if (rank == 0)
+    return NULL;
+  if (sindex->sorted[rank - 1]->section->index != section->index)
+    return NULL;
+  return sindex->sorted[rank - 1];
+}
+
 /* The generic version of the function which returns mini symbols.
    This is used when the backend does not provide a more efficient
    version.  It just uses BFD asymbol structures as mini symbols.  */
@@ -86,6 +86,24 @@
 #define SEEK_CUR 1
 #endif
 
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
+/* bfd_mmap takes mmap style protection and flag arguments on all hosts,
+   including those that map files through some other interface.  */
+#ifndef PROT_READ
+#define PROT_READ 0x1
+#endif
+#ifndef PROT_WRITE
+#define PROT_WRITE 0x2
+#endif
+#ifndef MAP_SHARED
+#define MAP_SHARED 0x1
+#endif
+#ifndef MAP_PRIVATE
+#define MAP_PRIVATE 0x2
+#endif
+
 #include "filenames.h"
 
 #if !HAVE_DECL_FFS
@@ -120,6 +138,19 @@ extern int fseeko64 (FILE *stream, off64_t offset, int whence);
 #endif
 #endif
 
+/* Storage class for per-thread state such as the BFD error status.  */
+#ifndef TLS
+#if defined (_MSC_VER)
+#define TLS __declspec(thread)
+#elif defined (__GNUC__)
+#define TLS __thread
+#elif defined (__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define TLS _Thread_local
+#else
+#define TLS
+#endif
+#endif
+
 /* Define offsetof for those systems which lack it */
 
 #ifndef offsetof
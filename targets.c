@@ -24,6 +24,7 @@
 #include "bfd.h"
 #include "libbfd.h"
 #include "fnmatch.h"
+#include "hashtab.h"
 
 /*
    It's okay to see some:
@@ -1451,7 +1452,7 @@ const bfd_target *const *const bfd_associated_vector = _bfd_associated_vector;
 const size_t _bfd_target_vector_entries = ARRAY_SIZE (_bfd_target_vector);
 
 /* A place to stash a warning from _bfd_check_format.  */
-static struct per_xvec_message *per_xvec_warn[ARRAY_SIZE (_bfd_target_vector)
+static TLS struct per_xvec_message *per_xvec_warn[ARRAY_SIZE (_bfd_target_vector)
 					      + 1];
 
 /* This array maps configuration triplets onto BFD vectors.  */
@@ -1527,6 +1528,72 @@ _bfd_per_xvec_warn (const bfd_target *targ, size_t alloc)
   return m;
 }
 
+/* An index of bfd_target_vector by target name, built the first time
+   find_target is called.  TARGET_INDEX_READY is set once it has been
+   built; if it could not be, TARGET_INDEX is NULL and the vector is
+   searched instead.  */
+
+static htab_t target_index;
+static int target_index_ready;
+static bfd_mutex target_index_lock = BFD_MUTEX_INIT;
+
+static hashval_t
+target_index_hash (const void *p)
+{
+  return htab_hash_string (((const bfd_target *) p)->name);
+}
+
+/* Compare an entry with a name being looked up.  */
+
+static int
+target_index_eq (const void *entry, const void *name)
+{
+  return strcmp (((const bfd_target *) entry)->name,
+		 (const char *) name) == 0;
+}
+
+/* Build target_index, unless another thread got there first.  The
+   first target of a name in bfd_target_vector is the one entered,
+   which is the one a scan of the vector would have found.  */
+
+static void
+target_index_build (void)
+{
+  const bfd_target * const *target;
+  htab_t tab;
+
+  _bfd_mutex_lock (&target_index_lock);
+  if (target_index_ready)
+    {
+      _bfd_mutex_unlock (&target_index_lock);
+      return;
+    }
+
+  tab = htab_create_alloc (_bfd_target_vector_entries * 2, target_index_hash,
+			   target_index_eq, NULL, calloc, free);
+  for (target = &bfd_target_vector[0];
+       tab != NULL && *target != NULL;
+       target++)
+    {
+      const char *name = (*target)->name;
+      void **slot;
+
+      slot = htab_find_slot_with_hash (tab, name, htab_hash_string (name),
+				       INSERT);
+      if (slot == NULL)
+	{
+	  htab_delete (tab);
+	  tab = NULL;
+	}
+      else if (*slot == NULL)
+	*slot = (void *) *target;
+    }
+
+  target_index = tab;
+  _bfd_atomic_add (&target_index_ready, 1);
+  _bfd_mutex_unlock (&target_index_lock);
+}
+
 /* Find a target vector, given a name or configuration triplet.  */
 
 static const bfd_target *
@@ -1535,9 +1602,21 @@ find_target (const char *name)
   const bfd_target * const *target;
   const struct targmatch *match;
 
-  for (target = &bfd_target_vector[0]; *target != NULL; target++)
-    if (strcmp (name, (*target)->name) == 0)
-      return *target;
+  if (_bfd_atomic_load (&target_index_ready) == 0)
+    target_index_build ();
+  if (target_index != NULL)
+    {
+      const bfd_target *found;
+
+      found = (const bfd_target *)
+	htab_find_with_hash (target_index, name, htab_hash_string (name));
+      if (found != NULL)
+	return found;
+    }
+  else
+    for (target = &bfd_target_vector[0]; *target != NULL; target++)
+      if (strcmp (name, (*target)->name) == 0)
+	return *target;
 
   /* If we couldn't match on the exact name, try matching on the
      configuration triplet.  FIXME: We should run the triplet through
@@ -262,6 +262,13 @@ typedef struct tekhex_data_struct
   unsigned int type;
   struct tekhex_symbol_struct *symbols;
   struct data_struct *data;
+  /* An open addressed hash table of the chunks in DATA, indexed by
+     address, with 1 << CHUNK_TABLE_BITS entries.  */
+  struct data_struct **chunk_table;
+  unsigned int chunk_table_bits;
+  unsigned int chunk_count;
+  /* The chunk last found by find_chunk.  */
+  struct data_struct *last_chunk;
 } tdata_type;
 
 #define enda(x) (x->vma + x->size)
@@ -315,32 +322,89 @@ getsym (char *dstp, char **srcp, unsigned int *lenp, char * endp)
   return i == len;
 }
 
+/* Return the slot in the chunk table of TDATA where the chunk for
+   VMA is, or where it would go.  */
+
+static struct data_struct **
+chunk_slot (tdata_type *tdata, bfd_vma vma)
+{
+  size_t mask = ((size_t) 1 << tdata->chunk_table_bits) - 1;
+  size_t i;
+
+  i = (size_t) (((uint64_t) (vma / (CHUNK_MASK + 1))
+		 * 0x9e3779b97f4a7c15ull) >> (64 - tdata->chunk_table_bits));
+  while (tdata->chunk_table[i] != NULL && tdata->chunk_table[i]->vma != vma)
+    i = (i + 1) & mask;
+  return &tdata->chunk_table[i];
+}
+
+/* Double the size of the chunk table of ABFD.  */
+
+static bool
+grow_chunk_table (bfd *abfd)
+{
+  tdata_type *tdata = abfd->tdata.tekhex_data;
+  unsigned int bits = tdata->chunk_table_bits ? tdata->chunk_table_bits + 1 : 6;
+  struct data_struct *d;
+
+  tdata->chunk_table = (struct data_struct **)
+    bfd_zalloc (abfd, sizeof (struct data_struct *) << bits);
+  if (tdata->chunk_table == NULL)
+    {
+      tdata->chunk_table_bits = 0;
+      return false;
+    }
+  tdata->chunk_table_bits = bits;
+  for (d = tdata->data; d != NULL; d = d->next)
+    *chunk_slot (tdata, d->vma) = d;
+  return true;
+}
+
 static struct data_struct *
 find_chunk (bfd *abfd, bfd_vma vma, bool create)
 {
-  struct data_struct *d = abfd->tdata.tekhex_data->data;
+  tdata_type *tdata = abfd->tdata.tekhex_data;
+  struct data_struct *d = tdata->last_chunk;
 
   vma &= ~CHUNK_MASK;
-  while (d && (d->vma) != vma)
-    d = d->next;
+  if (d != NULL && d->vma == vma)
+    return d;
 
-  if (!d && create)
+  if (tdata->chunk_table_bits != 0)
     {
-      /* No chunk for this address, so make one up.  */
-      d = (struct data_struct *)
-	  bfd_zalloc (abfd, (bfd_size_type) sizeof (struct data_struct));
+      d = *chunk_slot (tdata, vma);
+      if (d != NULL)
+	{
+	  tdata->last_chunk = d;
+	  return d;
+	}
+    }
 
-      if (!d)
-	return NULL;
+  if (!create)
+    return NULL;
 
-      d->next = abfd->tdata.tekhex_data->data;
-      d->vma = vma;
-      abfd->tdata.tekhex_data->data = d;
-    }
+  /* Keep the table at most half full.  */
+  if (2 * (tdata->chunk_count + 1) > (1u << tdata->chunk_table_bits)
+      && !grow_chunk_table (abfd))
+    return NULL;
+
+  /* No chunk for this address, so make one up.  */
+  d = (struct data_struct *)
+      bfd_zalloc (abfd, (bfd_size_type) sizeof (struct data_struct));
+
+  if (!d)
+    return NULL;
+
+  d->next = tdata->data;
+  d->vma = vma;
+  tdata->data = d;
+  *chunk_slot (tdata, vma) = d;
+  tdata->chunk_count++;
+  tdata->last_chunk = d;
   return d;
 }
 
-static void
+static bool
 insert_byte (bfd *abfd, int value, bfd_vma addr)
 {
   if (value != 0)
@@ -348,9 +412,12 @@ insert_byte (bfd *abfd, int value, bfd_vma addr)
       /* Find the chunk that this byte needs and put it in.  */
       struct data_struct *d = find_chunk (abfd, addr, true);
 
+      if (d == NULL)
+	return false;
       d->chunk_data[addr & CHUNK_MASK] = value;
       d->chunk_init[(addr & CHUNK_MASK) / CHUNK_SPAN] = 1;
     }
+  return true;
 }
 
 /* The first pass is to find the names of all the sections, and see
@@ -376,7 +443,8 @@ first_phase (bfd *abfd, int type, char *src, char * src_end)
 
 	while (*src && src < src_end - 1)
 	  {
-	    insert_byte (abfd, HEX (src), addr);
+	    if (!insert_byte (abfd, HEX (src), addr))
+	      return false;
 	    src += 2;
 	    addr++;
 	  }
@@ -594,6 +662,10 @@ tekhex_mkobject (bfd *abfd)
   tdata->head =  NULL;
   tdata->symbols = NULL;
   tdata->data = NULL;
+  tdata->chunk_table = NULL;
+  tdata->chunk_table_bits = 0;
+  tdata->chunk_count = 0;
+  tdata->last_chunk = NULL;
   return true;
 }
 
@@ -0,0 +1,713 @@
+/* Threading support for BFD.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/*
+SECTION
+	Threads
+
+	BFD may be used from several threads at once, provided that
+	each BFD is only used by one thread at a time.  State shared
+	between BFDs, such as the file descriptor cache, is protected
+	by the locks described here.
+
+SUBSECTION
+	Mutexes
+*/
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libbfd.h"
+
+#if defined (_WIN32)
+#include <windows.h>
+#elif defined (HAVE_PTHREAD_H)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/*
+INTERNAL_DEFINITION
+	bfd_mutex
+
+DESCRIPTION
+	A <<bfd_mutex>> is a non-recursive lock.  A mutex that is all
+	zero, such as one with static storage duration or one
+	initialized with <<BFD_MUTEX_INIT>>, is ready to use.
+
+.typedef struct bfd_mutex
+.{
+.  {* Host lock, or a pointer to it.  *}
+.  void *impl;
+.}
+.bfd_mutex;
+.
+.#define BFD_MUTEX_INIT { NULL }
+.
+*/
+
+#if !defined (_WIN32) && defined (HAVE_PTHREAD_H)
+/* POSIX mutexes can't be assumed to be all zero when unlocked, so
+   create the host mutex on first use.  */
+
+static pthread_mutex_t *
+host_mutex (bfd_mutex *m)
+{
+  pthread_mutex_t *pm, *expected;
+
+  pm = __atomic_load_n ((pthread_mutex_t **) &m->impl, __ATOMIC_ACQUIRE);
+  if (pm != NULL)
+    return pm;
+
+  pm = (pthread_mutex_t *) malloc (sizeof (*pm));
+  if (pm == NULL)
+    abort ();
+  pthread_mutex_init (pm, NULL);
+  expected = NULL;
+  if (!__atomic_compare_exchange_n ((pthread_mutex_t **) &m->impl,
+				    &expected, pm, false,
+				    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+      /* Another thread got there first.  */
+      pthread_mutex_destroy (pm);
+      free (pm);
+      pm = expected;
+    }
+  return pm;
+}
+#endif
+
+/*
+INTERNAL_FUNCTION
+	_bfd_mutex_lock
+
+SYNOPSIS
+	void _bfd_mutex_lock (bfd_mutex *);
+
+DESCRIPTION
+	Acquire a mutex, waiting until it is available.
+*/
+
+void
+_bfd_mutex_lock (bfd_mutex *m ATTRIBUTE_UNUSED)
+{
+#if defined (_WIN32)
+  AcquireSRWLockExclusive ((PSRWLOCK) &m->impl);
+#elif defined (HAVE_PTHREAD_H)
+  pthread_mutex_lock (host_mutex (m));
+#endif
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_mutex_unlock
+
+SYNOPSIS
+	void _bfd_mutex_unlock (bfd_mutex *);
+
+DESCRIPTION
+	Release a mutex acquired by <<_bfd_mutex_lock>>.
+*/
+
+void
+_bfd_mutex_unlock (bfd_mutex *m ATTRIBUTE_UNUSED)
+{
+#if defined (_WIN32)
+  ReleaseSRWLockExclusive ((PSRWLOCK) &m->impl);
+#elif defined (HAVE_PTHREAD_H)
+  pthread_mutex_unlock ((pthread_mutex_t *) m->impl);
+#endif
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_mutex_destroy
+
+SYNOPSIS
+	void _bfd_mutex_destroy (bfd_mutex *);
+
+DESCRIPTION
+	Release any resources held by an unlocked mutex.  The mutex
+	may be used again afterwards.
+*/
+
+void
+_bfd_mutex_destroy (bfd_mutex *m ATTRIBUTE_UNUSED)
+{
+#if !defined (_WIN32) && defined (HAVE_PTHREAD_H)
+  pthread_mutex_t *pm = (pthread_mutex_t *) m->impl;
+
+  if (pm != NULL)
+    {
+      pthread_mutex_destroy (pm);
+      free (pm);
+      m->impl = NULL;
+    }
+#endif
+}
+
+/*
+SUBSECTION
+	Atomic operations
+*/
+
+/*
+INTERNAL_FUNCTION
+	_bfd_atomic_add
+
+SYNOPSIS
+	int _bfd_atomic_add (int *ptr, int val);
+
+DESCRIPTION
+	Atomically add @var{val} to @var{*ptr}, returning the new value.
+*/
+
+int
+_bfd_atomic_add (int *ptr, int val)
+{
+#if defined (_WIN32)
+  return InterlockedExchangeAdd ((volatile LONG *) ptr, val) + val;
+#elif defined (__GNUC__)
+  return __atomic_add_fetch (ptr, val, __ATOMIC_ACQ_REL);
+#else
+  return *ptr += val;
+#endif
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_atomic_load
+
+SYNOPSIS
+	int _bfd_atomic_load (const int *ptr);
+
+DESCRIPTION
+	Atomically read @var{*ptr}.
+*/
+
+int
+_bfd_atomic_load (const int *ptr)
+{
+#if defined (_WIN32)
+  return InterlockedOr ((volatile LONG *) ptr, 0);
+#elif defined (__GNUC__)
+  return __atomic_load_n (ptr, __ATOMIC_ACQUIRE);
+#else
+  return *ptr;
+#endif
+}
+
+/*
+SUBSECTION
+	Worker threads
+
+	BFD can split some expensive operations, such as converting
+	a large symbol table, into pieces that are done on several
+	threads at once.  This is off by default.  All such work goes
+	through one pool of threads that BFD starts when first needed
+	and keeps for later, or through an executor supplied by the
+	application.
+*/
+
+/* The most threads _bfd_parallel_for will use.  */
+#define MAX_THREADS 64
+
+/* The number of threads, including the caller, that the pool may
+   use.  */
+static unsigned int thread_count = 1;
+
+/*
+FUNCTION
+	bfd_set_thread_count
+
+SYNOPSIS
+	unsigned int bfd_set_thread_count (unsigned int count);
+
+DESCRIPTION
+	Allow BFD to use up to @var{count} threads, counting the
+	calling thread, for work that it can split up.  One, the
+	default, does everything on the calling thread.  Zero uses one
+	thread per processor.  Returns the previous setting.  This
+	should be called before BFDs are in use on other threads.
+*/
+
+unsigned int
+bfd_set_thread_count (unsigned int count)
+{
+  unsigned int old = thread_count;
+
+  if (count == 0)
+    {
+#if defined (_WIN32)
+      SYSTEM_INFO info;
+
+      GetSystemInfo (&info);
+      count = info.dwNumberOfProcessors;
+#elif defined (_SC_NPROCESSORS_ONLN)
+      long long n = sysconf (_SC_NPROCESSORS_ONLN);
+
+      count = n > 0 ? n : 1;
+#else
+      count = 1;
+#endif
+    }
+  if (count > MAX_THREADS)
+    count = MAX_THREADS;
+  thread_count = count;
+  return old;
+}
+
+/*
+FUNCTION
+	bfd_get_thread_count
+
+SYNOPSIS
+	unsigned int bfd_get_thread_count (void);
+
+DESCRIPTION
+	Return the number of threads BFD may use, as set by
+	<<bfd_set_thread_count>>.
+*/
+
+unsigned int
+bfd_get_thread_count (void)
+{
+  return thread_count;
+}
+
+/*
+	An executor runs tasks for BFD on threads that the application
+	owns.
+
+CODE_FRAGMENT
+.typedef bool (*bfd_thread_executor_type)
+.  (void (*task) (void *arg), void *arg, void *data);
+.
+*/
+
+/* The application's executor, if any, and its data.  */
+static bfd_thread_executor_type executor;
+static void *executor_data;
+
+/*
+FUNCTION
+	bfd_set_thread_executor
+
+SYNOPSIS
+	bfd_thread_executor_type bfd_set_thread_executor
+	  (bfd_thread_executor_type func, void *data);
+
+DESCRIPTION
+	Have BFD hand its work to @var{func} instead of starting
+	threads of its own.  BFD calls @var{func} with a task, an
+	argument for it and @var{data}, up to one fewer times than
+	<<bfd_set_thread_count>> allows per piece of work, and @var{func}
+	should arrange for @var{task} to be called with @var{arg} on
+	some thread, or return <<FALSE>> if it cannot.  BFD does its
+	share of the work on the calling thread and never waits for
+	a task to start, so @var{func} may queue tasks behind others
+	or run them straight away.  A task accepted must be run
+	eventually, though it may find nothing left to do.  NULL, the
+	default, uses BFD's own threads.  Returns the previous
+	executor.  This should be called before BFDs are in use on
+	other threads.
+*/
+
+bfd_thread_executor_type
+bfd_set_thread_executor (bfd_thread_executor_type func, void *data)
+{
+  bfd_thread_executor_type old = executor;
+
+  executor = func;
+  executor_data = data;
+  return old;
+}
+
+#if defined (_WIN32) || defined (HAVE_PTHREAD_H)
+
+/* One _bfd_parallel_for.  All but FUNC, DATA, COUNT, CHUNK and
+   NCHUNKS, which are fixed, are protected by pool_lock.  */
+
+struct parallel_job
+{
+  bool (*func) (void *, size_t, size_t);
+  void *data;
+  size_t count;
+  size_t chunk;
+  int nchunks;
+
+  /* The next chunk to hand out, and the number being done.  */
+  int next;
+  int running;
+
+  /* The threads other than the caller helping with the job, and the
+     most there may be.  */
+  int helpers;
+  int max_helpers;
+
+  /* The caller and helpers that may still look at the job.  The
+     last to finish with it frees it.  */
+  int refs;
+
+  /* Whether a chunk has failed, and the error it set.  */
+  bool failed;
+  bfd_error_type error;
+
+  /* The messages issued by each chunk, which are passed on in chunk
+     order once all are done.  Only the thread doing a chunk touches
+     its buffer.  */
+  struct _bfd_error_buffer *messages;
+
+  /* The next job in pool_jobs, and whether the job is on it.  */
+  struct parallel_job *next_job;
+  bool queued;
+};
+
+/* Protects the pool and every parallel_job.  */
+static bfd_mutex pool_lock = BFD_MUTEX_INIT;
+
+/* Jobs with chunks left for BFD's own threads to pick up, oldest
+   first, and the number of those threads started.  */
+static struct parallel_job *pool_jobs;
+static unsigned int pool_threads;
+
+/* Signalled when a job is queued, and when a job's last chunk is
+   done.  */
+#if defined (_WIN32)
+static CONDITION_VARIABLE work_cond = CONDITION_VARIABLE_INIT;
+static CONDITION_VARIABLE done_cond = CONDITION_VARIABLE_INIT;
+#define POOL_WAIT(cond) \
+  SleepConditionVariableSRW (&(cond), (PSRWLOCK) &pool_lock.impl, \
+			     INFINITE, 0)
+#define POOL_SIGNAL(cond) WakeAllConditionVariable (&(cond))
+#else
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+#define POOL_WAIT(cond) pthread_cond_wait (&(cond), host_mutex (&pool_lock))
+#define POOL_SIGNAL(cond) pthread_cond_broadcast (&(cond))
+#endif
+
+/* Whether JOB has chunks left to hand out.  */
+
+static inline bool
+job_has_work (const struct parallel_job *job)
+{
+  return !job->failed && job->next < job->nchunks;
+}
+
+/* Take JOB off pool_jobs, if it is there.  */
+
+static void
+job_unqueue (struct parallel_job *job)
+{
+  struct parallel_job **pp;
+
+  if (!job->queued)
+    return;
+  for (pp = &pool_jobs; *pp != job; pp = &(*pp)->next_job)
+    ;
+  *pp = job->next_job;
+  job->queued = false;
+}
+
+/* Drop a reference to JOB, freeing it if it was the last.  Called
+   with pool_lock held.  */
+
+static void
+job_release (struct parallel_job *job)
+{
+  if (--job->refs == 0)
+    free (job);
+}
+
+/* Do chunks of JOB until there are none left or one fails.  */
+
+static void
+parallel_work (struct parallel_job *job)
+{
+  _bfd_mutex_lock (&pool_lock);
+  while (job_has_work (job))
+    {
+      int idx = job->next++;
+      size_t start, end;
+      bool ok;
+      bfd_error_type error = bfd_error_no_error;
+      bfd_error_handler_type old_handler;
+      struct _bfd_error_buffer *old_buf;
+
+      job->running++;
+      if (!job_has_work (job))
+	job_unqueue (job);
+      _bfd_mutex_unlock (&pool_lock);
+
+      start = idx * job->chunk;
+      end = start + job->chunk;
+      if (end > job->count)
+	end = job->count;
+      old_handler = _bfd_error_buffer_begin (&job->messages[idx], &old_buf);
+      ok = job->func (job->data, start, end);
+      if (!ok)
+	error = bfd_get_error ();
+      _bfd_error_buffer_end (old_handler, old_buf);
+
+      _bfd_mutex_lock (&pool_lock);
+      job->running--;
+      if (!ok && !job->failed)
+	{
+	  job->failed = true;
+	  job->error = error;
+	  job_unqueue (job);
+	}
+      if (job->running == 0 && !job_has_work (job))
+	POOL_SIGNAL (done_cond);
+    }
+  _bfd_mutex_unlock (&pool_lock);
+}
+
+/* Help with JOB, on a pool thread or one of the executor's, then
+   let it go.  */
+
+static void
+parallel_help (void *arg)
+{
+  struct parallel_job *job = (struct parallel_job *) arg;
+
+  parallel_work (job);
+
+  _bfd_mutex_lock (&pool_lock);
+  job->helpers--;
+  job_release (job);
+  _bfd_mutex_unlock (&pool_lock);
+}
+
+/* The body of one of BFD's own threads, which helps with queued
+   jobs for as long as the process lasts.  */
+
+static void
+pool_loop (void)
+{
+  _bfd_mutex_lock (&pool_lock);
+  for (;;)
+    {
+      struct parallel_job *job;
+
+      for (job = pool_jobs; job != NULL; job = job->next_job)
+	if (job->helpers < job->max_helpers)
+	  break;
+      if (job == NULL)
+	{
+	  POOL_WAIT (work_cond);
+	  continue;
+	}
+
+      job->helpers++;
+      job->refs++;
+      _bfd_mutex_unlock (&pool_lock);
+      parallel_help (job);
+      _bfd_mutex_lock (&pool_lock);
+    }
+}
+
+#if defined (_WIN32)
+static DWORD WINAPI
+pool_thread (LPVOID arg ATTRIBUTE_UNUSED)
+{
+  pool_loop ();
+  return 0;
+}
+#else
+static void *
+pool_thread (void *arg ATTRIBUTE_UNUSED)
+{
+  pool_loop ();
+  return NULL;
+}
+#endif
+
+/* Start pool threads until there are COUNT, or as many as the host
+   allows.  Called with pool_lock held.  */
+
+static void
+pool_grow (unsigned int count)
+{
+  while (pool_threads < count)
+    {
+#if defined (_WIN32)
+      HANDLE thread = CreateThread (NULL, 0, pool_thread, NULL, 0, NULL);
+
+      if (thread == NULL)
+	break;
+      CloseHandle (thread);
+#else
+      pthread_t thread;
+
+      if (pthread_create (&thread, NULL, pool_thread, NULL) != 0)
+	break;
+      pthread_detach (thread);
+#endif
+      pool_threads++;
+    }
+}
+
+#endif /* _WIN32 || HAVE_PTHREAD_H */
+
+/*
+INTERNAL_FUNCTION
+	_bfd_parallel_for
+
+SYNOPSIS
+	bool _bfd_parallel_for
+	  (size_t count, size_t grain,
+	   bool (*func) (void *data, size_t start, size_t end),
+	   void *data);
+
+DESCRIPTION
+	Call @var{func} on ranges that together cover zero to
+	@var{count}, using as many threads as <<bfd_set_thread_count>>
+	allows, from BFD's pool or the executor set by
+	<<bfd_set_thread_executor>>.  Ranges are at least @var{grain}
+	long, bar the last, and may be done in any order and at the
+	same time, so @var{func} must not allocate BFD memory or
+	otherwise touch state shared between ranges.  Messages for
+	the BFD error handler are held back until all ranges are done
+	and then passed on in range order, so they come out the same
+	as if the ranges had been done one after another.  Returns
+	<<FALSE>> if any call did, after setting the BFD error to the
+	one the first failing call left.  The calling thread does
+	ranges too, so all get done even if no other thread can help,
+	and calls from inside @var{func} are safe.
+*/
+
+bool
+_bfd_parallel_for (size_t count, size_t grain,
+		   bool (*func) (void *, size_t, size_t), void *data)
+{
+  unsigned int nthreads = thread_count;
+
+  if (grain == 0)
+    grain = 1;
+  if (nthreads > (count + grain - 1) / grain)
+    nthreads = (count + grain - 1) / grain;
+  if (nthreads <= 1)
+    return func (data, 0, count);
+
+#if defined (_WIN32) || defined (HAVE_PTHREAD_H)
+  struct parallel_job *job;
+  bfd_thread_executor_type exec = executor;
+  void *exec_data = executor_data;
+  struct _bfd_error_buffer *messages;
+  size_t chunk;
+  int nchunks;
+  unsigned int i;
+  bool failed;
+  bfd_error_type error;
+
+  /* Hand out a few chunks per thread, so that a slow one doesn't
+     hold up the rest.  */
+  chunk = count / (nthreads * 4);
+  if (chunk < grain)
+    chunk = grain;
+  nchunks = (count + chunk - 1) / chunk;
+
+  job = (struct parallel_job *) malloc (sizeof (*job));
+  messages = ((struct _bfd_error_buffer *)
+	      calloc (nchunks, sizeof (*messages)));
+  if (job == NULL || messages == NULL)
+    {
+      free (job);
+      free (messages);
+      return func (data, 0, count);
+    }
+
+  job->func = func;
+  job->data = data;
+  job->count = count;
+  job->chunk = chunk;
+  job->nchunks = nchunks;
+  job->next = 0;
+  job->running = 0;
+  job->helpers = 0;
+  job->max_helpers = nthreads - 1;
+  job->refs = 1;
+  job->failed = false;
+  job->error = bfd_error_no_error;
+  job->messages = messages;
+  job->next_job = NULL;
+  job->queued = false;
+
+  _bfd_mutex_lock (&pool_lock);
+  if (exec != NULL)
+    {
+      /* Take the helpers' references now, since the executor may
+	 run a task before returning.  */
+      job->helpers = job->max_helpers;
+      job->refs += job->max_helpers;
+    }
+  else
+    {
+      struct parallel_job **pp;
+
+      pool_grow (nthreads - 1);
+      for (pp = &pool_jobs; *pp != NULL; pp = &(*pp)->next_job)
+	;
+      *pp = job;
+      job->queued = true;
+      POOL_SIGNAL (work_cond);
+    }
+  _bfd_mutex_unlock (&pool_lock);
+
+  if (exec != NULL)
+    for (i = 0; i < nthreads - 1; i++)
+      if (!exec (parallel_help, job, exec_data))
+	{
+	  _bfd_mutex_lock (&pool_lock);
+	  job->helpers--;
+	  job_release (job);
+	  _bfd_mutex_unlock (&pool_lock);
+	}
+
+  parallel_work (job);
+
+  /* Wait for the chunks that other threads took.  */
+  _bfd_mutex_lock (&pool_lock);
+  while (job->running != 0)
+    POOL_WAIT (done_cond);
+  job_unqueue (job);
+  failed = job->failed;
+  error = job->error;
+  job_release (job);
+  _bfd_mutex_unlock (&pool_lock);
+
+  /* Pass on the chunks' messages in the order they would have come
+     had the chunks been done one after another.  */
+  for (i = 0; i < (unsigned int) nchunks; i++)
+    _bfd_error_buffer_flush (&messages[i]);
+  free (messages);
+
+  if (failed)
+    {
+      bfd_set_error (error);
+      return false;
+    }
+  return true;
+#else
+  return func (data, 0, count);
+#endif
+}
@@ -0,0 +1,525 @@
+/* Tracing support for BFD.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/*
+SECTION
+	Tracing
+
+	BFD can record how long the phases of a link or a dump take,
+	such as garbage collecting sections or linking each input
+	file, as a trace that Chrome's about:tracing or Perfetto can
+	show.  Tracing is off unless <<bfd_trace_open>> is called, and
+	then a span costs little more than a test of a pointer.
+
+	BFD also has hook points on some of its hot paths, such as
+	probing the format of a file or evicting one from the file
+	cache.  A program can have a function called at each with
+	<<bfd_set_hook>>, and a build with USDT or ETW support can
+	fire a probe there, so that a tracer can tie a slow request
+	to the files and phases it spent its time on.  A hook point
+	that is off costs one test of a global.
+*/
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libbfd.h"
+
+#if defined (_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#elif defined (HAVE_TRACELOGGINGPROVIDER_H)
+#include <TraceLoggingProvider.h>
+#endif
+
+/* The trace file, or NULL if tracing is off.  */
+static FILE *trace_file;
+
+/* Serializes writes to trace_file.  */
+static bfd_mutex trace_lock = BFD_MUTEX_INIT;
+
+/* Whether an event has been written, so needs a comma before the
+   next, and the time that bfd_trace_open was called.  */
+static bool trace_started;
+static uint64_t trace_epoch;
+
+/* The number of threads that have written an event, and the calling
+   thread's number, counting from one.  */
+static int trace_threads;
+static TLS int trace_tid;
+
+/*
+CODE_FRAGMENT
+.{* A span of time that is being traced.  *}
+.typedef struct bfd_trace_span
+.{
+.  {* What is being done, or NULL if tracing was off when the span
+.     began.  *}
+.  const char *name;
+.  {* The BFD it is being done to, if any.  *}
+.  const bfd *abfd;
+.  {* When the span began, in microseconds.  *}
+.  uint64_t start;
+.}
+.bfd_trace_span;
+.
+*/
+
+/* The time in microseconds from some fixed point.  */
+
+static uint64_t
+trace_now (void)
+{
+#if defined (_WIN32)
+  LARGE_INTEGER count, freq;
+
+  QueryPerformanceCounter (&count);
+  QueryPerformanceFrequency (&freq);
+  return (uint64_t) count.QuadPart * 1000000 / freq.QuadPart;
+#elif defined (CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+  return (uint64_t) clock () * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Write STR to the trace as the contents of a JSON string.  */
+
+static void
+trace_put_string (const char *str)
+{
+  for (; *str != 0; str++)
+    {
+      unsigned char c = *str;
+
+      if (c == '"' || c == '\\')
+	fprintf (trace_file, "\\%c", c);
+      else if (c < 0x20)
+	fprintf (trace_file, "\\u%04x", c);
+      else
+	fputc (c, trace_file);
+    }
+}
+
+/*
+FUNCTION
+	bfd_trace_open
+
+SYNOPSIS
+	bool bfd_trace_open (const char *filename);
+
+DESCRIPTION
+	Start writing a trace to @var{filename}, in the Chrome trace
+	event format.  Spans are recorded from every thread until
+	<<bfd_trace_close>> is called.  Returns <<FALSE>>, setting the
+	BFD error, if the file cannot be created or a trace is
+	already being written.
+*/
+
+bool
+bfd_trace_open (const char *filename)
+{
+  FILE *f;
+
+  if (trace_file != NULL)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+  f = _bfd_real_fopen (filename, FOPEN_WT);
+  if (f == NULL)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return false;
+    }
+  fputs ("{\"traceEvents\":[\n", f);
+  trace_started = false;
+  trace_epoch = trace_now ();
+  trace_file = f;
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_trace_close
+
+SYNOPSIS
+	bool bfd_trace_close (void);
+
+DESCRIPTION
+	Finish the trace started by <<bfd_trace_open>>.  Spans still
+	open are not recorded.  Returns <<FALSE>>, setting the BFD
+	error, if the trace could not be written.
+*/
+
+bool
+bfd_trace_close (void)
+{
+  FILE *f;
+  bool ok;
+
+  _bfd_mutex_lock (&trace_lock);
+  f = trace_file;
+  trace_file = NULL;
+  _bfd_mutex_unlock (&trace_lock);
+  if (f == NULL)
+    return true;
+
+  fputs ("\n]}\n", f);
+  ok = !ferror (f);
+  if (fclose (f) != 0)
+    ok = false;
+  if (!ok)
+    bfd_set_error (bfd_error_system_call);
+  return ok;
+}
+
+/*
+FUNCTION
+	bfd_trace_begin
+
+SYNOPSIS
+	void bfd_trace_begin
+	  (bfd_trace_span *span, const char *name, const bfd *abfd);
+
+DESCRIPTION
+	Begin a span called @var{name}, which must be a string that
+	lives at least until <<bfd_trace_close>>, doing something to
+	@var{abfd}, or to nothing in particular if @var{abfd} is NULL.
+	Spans on one thread must end in the reverse of the order they
+	began.
+*/
+
+void
+bfd_trace_begin (bfd_trace_span *span, const char *name, const bfd *abfd)
+{
+  if (trace_file == NULL)
+    {
+      span->name = NULL;
+      return;
+    }
+  span->name = name;
+  span->abfd = abfd;
+  span->start = trace_now ();
+}
+
+/*
+FUNCTION
+	bfd_trace_end
+
+SYNOPSIS
+	void bfd_trace_end (bfd_trace_span *span);
+
+DESCRIPTION
+	End a span begun by <<bfd_trace_begin>>, and write it to the
+	trace.
+*/
+
+void
+bfd_trace_end (bfd_trace_span *span)
+{
+  uint64_t end;
+
+  if (span->name == NULL || trace_file == NULL)
+    return;
+
+  end = trace_now ();
+  if (trace_tid == 0)
+    trace_tid = _bfd_atomic_add (&trace_threads, 1);
+
+  _bfd_mutex_lock (&trace_lock);
+  if (trace_file != NULL)
+    {
+      fprintf (trace_file,
+	       "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+	       "\"ts\":%" PRIu64 ",\"dur\":%" PRIu64,
+	       trace_started ? ",\n" : "", span->name, trace_tid,
+	       span->start - trace_epoch, end - span->start);
+      if (span->abfd != NULL)
+	{
+	  fputs (",\"args\":{\"file\":\"", trace_file);
+	  if (span->abfd->my_archive != NULL
+	      && !bfd_is_thin_archive (span->abfd->my_archive))
+	    {
+	      trace_put_string (bfd_get_filename (span->abfd->my_archive));
+	      fputc ('(', trace_file);
+	      trace_put_string (bfd_get_filename (span->abfd));
+	      fputc (')', trace_file);
+	    }
+	  else
+	    trace_put_string (bfd_get_filename (span->abfd));
+	  fputs ("\"}", trace_file);
+	}
+      fputc ('}', trace_file);
+      trace_started = true;
+    }
+  _bfd_mutex_unlock (&trace_lock);
+}
+
+/*
+CODE_FRAGMENT
+.{* The places in BFD that a hook can be called from.  *}
+.enum bfd_hook_point
+.{
+.  {* <<bfd_check_format_matches>> has finished.  The name is that
+.     of the target that matched, or NULL if none did; ARG1 is the
+.     format asked for and ARG2 is one if the file was recognized.  *}
+.  bfd_hook_format_probe,
+.  {* The file cache is closing the BFD to make room for another.
+.     ARG1 is its position in the file, to seek back to when it is
+.     reopened.  *}
+.  bfd_hook_cache_evict,
+.  {* A DWARF compilation unit has been parsed.  The BFD is the one
+.     holding the debug information; ARG1 is the offset of the unit
+.     in the .debug_info section and ARG2 its length.  *}
+.  bfd_hook_dwarf_cu_parse,
+.  {* A compressed section has been decompressed.  ARG1 is its
+.     compressed size and ARG2 its size after decompression.  *}
+.  bfd_hook_decompress,
+.  bfd_hook_max
+.};
+.
+.{* What happened at a hook point.  *}
+.struct bfd_hook_event
+.{
+.  enum bfd_hook_point point;
+.  const bfd *abfd;
+.  {* The section concerned, if any.  *}
+.  const asection *section;
+.  {* A name and two numbers, whose meanings depend on POINT.  *}
+.  const char *name;
+.  uint64_t arg1;
+.  uint64_t arg2;
+.};
+.
+.typedef void (*bfd_hook_type) (const struct bfd_hook_event *, void *);
+.
+*/
+
+/* The hook for each point, and the data to pass it.  */
+static struct
+{
+  bfd_hook_type func;
+  void *data;
+} hooks[bfd_hook_max];
+
+/* Whether probes are to be fired.  */
+static bool hook_probes;
+
+/* A bit for each point that has a hook or a probe.  */
+unsigned int _bfd_hook_mask;
+
+#ifdef HAVE_TRACELOGGINGPROVIDER_H
+/* The ETW provider that the probes are written to.  */
+TRACELOGGING_DEFINE_PROVIDER (hook_provider, "GNU-BFD",
+  (0x6c4f3e19, 0x8b2d, 0x4a57, 0x93, 0x1e, 0x0d, 0x7a, 0xc2, 0x58, 0xf4, 0x61));
+static bool hook_provider_registered;
+#endif
+
+/* Recompute _bfd_hook_mask.  trace_lock must be held.  */
+
+static void
+hook_update_mask (void)
+{
+  unsigned int mask = 0;
+  int i;
+
+  for (i = 0; i < bfd_hook_max; i++)
+    if (hooks[i].func != NULL || hook_probes)
+      mask |= 1u << i;
+  _bfd_hook_mask = mask;
+}
+
+/*
+FUNCTION
+	bfd_set_hook
+
+SYNOPSIS
+	bool bfd_set_hook
+	  (enum bfd_hook_point point, bfd_hook_type func, void *data);
+
+DESCRIPTION
+	Call @var{func} with @var{data} each time BFD reaches
+	@var{point}, or stop calling the previous hook if @var{func}
+	is NULL.  The hook may be called from any thread that uses
+	BFD, and with BFD's locks held, so it must not call back into
+	BFD and should be quick; it should be set before other threads
+	start using BFD.  Returns <<FALSE>>, setting the BFD error, if
+	@var{point} is not a hook point.
+*/
+
+bool
+bfd_set_hook (enum bfd_hook_point point, bfd_hook_type func, void *data)
+{
+  if ((unsigned int) point >= (unsigned int) bfd_hook_max)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+
+  _bfd_mutex_lock (&trace_lock);
+  hooks[point].func = func;
+  hooks[point].data = data;
+  hook_update_mask ();
+  _bfd_mutex_unlock (&trace_lock);
+  return true;
+}
+
+/*
+FUNCTION
+	bfd_set_hook_probes
+
+SYNOPSIS
+	bool bfd_set_hook_probes (bool enable);
+
+DESCRIPTION
+	Fire a probe at every hook point if @var{enable}, or stop
+	firing them.  On GNU/Linux the probes are USDT probes of the
+	provider <<bfd>>, named after the hook points less their
+	<<bfd_hook_>> prefix, and on Windows they are ETW events of the
+	TraceLogging provider <<GNU-BFD>>; either way their arguments
+	are the file name, the name, and the two numbers of the event.
+	Returns <<FALSE>>, setting the BFD error, if BFD was built
+	without support for either.
+*/
+
+bool
+bfd_set_hook_probes (bool enable)
+{
+#if defined (HAVE_SYS_SDT_H) || defined (HAVE_TRACELOGGINGPROVIDER_H)
+  _bfd_mutex_lock (&trace_lock);
+#ifdef HAVE_TRACELOGGINGPROVIDER_H
+  if (enable && !hook_provider_registered)
+    hook_provider_registered = TraceLoggingRegister (hook_provider) == 0;
+#endif
+  hook_probes = enable;
+  hook_update_mask ();
+  _bfd_mutex_unlock (&trace_lock);
+  return true;
+#else
+  if (enable)
+    {
+      bfd_set_error (bfd_error_invalid_operation);
+      return false;
+    }
+  return true;
+#endif
+}
+
+#if defined (HAVE_SYS_SDT_H) || defined (HAVE_TRACELOGGINGPROVIDER_H)
+
+/* Fire the probe for EVENT.  */
+
+static void
+hook_probe (const struct bfd_hook_event *event)
+{
+  const char *file = (event->abfd != NULL
+		      ? bfd_get_filename (event->abfd) : "");
+  const char *name = event->name != NULL ? event->name : "";
+  uint64_t arg1 = event->arg1;
+  uint64_t arg2 = event->arg2;
+
+#ifdef HAVE_SYS_SDT_H
+#define HOOK_PROBE(probe, etw_name) \
+  DTRACE_PROBE4 (bfd, probe, file, name, arg1, arg2)
+#else
+#define HOOK_PROBE(probe, etw_name) \
+  TraceLoggingWrite (hook_provider, etw_name,			\
+		     TraceLoggingString (file, "File"),		\
+		     TraceLoggingString (name, "Name"),		\
+		     TraceLoggingUInt64 (arg1, "Arg1"),		\
+		     TraceLoggingUInt64 (arg2, "Arg2"))
+#endif
+
+  switch (event->point)
+    {
+    case bfd_hook_format_probe:
+      HOOK_PROBE (format_probe, "FormatProbe");
+      break;
+    case bfd_hook_cache_evict:
+      HOOK_PROBE (cache_evict, "CacheEvict");
+      break;
+    case bfd_hook_dwarf_cu_parse:
+      HOOK_PROBE (dwarf_cu_parse, "DwarfCuParse");
+      break;
+    case bfd_hook_decompress:
+      HOOK_PROBE (decompress, "Decompress");
+      break;
+    default:
+      break;
+    }
+#undef HOOK_PROBE
+}
+
+#endif
+
+/*
+INTERNAL_FUNCTION
+	_bfd_hook_fire
+
+SYNOPSIS
+	void _bfd_hook_fire
+	  (enum bfd_hook_point point, const bfd *abfd,
+	   const asection *section, const char *name,
+	   uint64_t arg1, uint64_t arg2);
+
+DESCRIPTION
+	Call the hook for @var{point} and fire its probe, as they are
+	set.  Hook points use the <<_bfd_hook>> macro, which only
+	calls this when one of those is.
+
+.#define _bfd_hook(point, abfd, section, name, arg1, arg2)		\
+.  do									\
+.    if ((_bfd_hook_mask & (1u << (point))) != 0)			\
+.      _bfd_hook_fire (point, abfd, section, name, arg1, arg2);	\
+.  while (0)
+.
+.extern unsigned int _bfd_hook_mask ATTRIBUTE_HIDDEN;
+.
+*/
+
+void
+_bfd_hook_fire (enum bfd_hook_point point, const bfd *abfd,
+		const asection *section, const char *name,
+		uint64_t arg1, uint64_t arg2)
+{
+  struct bfd_hook_event event;
+  bfd_hook_type func = hooks[point].func;
+
+  event.point = point;
+  event.abfd = abfd;
+  event.section = section;
+  event.name = name;
+  event.arg1 = arg1;
+  event.arg2 = arg2;
+  if (func != NULL)
+    func (&event, hooks[point].data);
+#if defined (HAVE_SYS_SDT_H) || defined (HAVE_TRACELOGGINGPROVIDER_H)
+  if (hook_probes)
+    hook_probe (&event);
+#endif
+}
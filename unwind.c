@@ -0,0 +1,1231 @@
+/* Unwind table lookup for BFD.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/*
+SECTION
+	Unwind tables
+
+	Profilers and other tools that walk the stacks of running
+	programs need to know, for a code address, how to find the
+	frame of its caller.  BFD can answer that for an executable or
+	shared library from its <<.sframe>> section when it has one,
+	and from its <<.eh_frame>> section otherwise.  The answer is a
+	row giving the rules that recover the canonical frame address
+	(CFA), the return address and the frame pointer at that
+	address.
+
+	The first lookup reads the section and builds a sorted table of
+	rows for the whole BFD, with a bucket index over it, so that
+	later lookups touch only a few cache lines.  Addresses are
+	virtual addresses in the linked image; the unrelocated unwind
+	information of relocatable objects is not supported.
+
+.enum bfd_unwind_rule
+.{
+.  {* The rule isn't one the table describes, such as a DWARF
+.     expression.  *}
+.  bfd_unwind_rule_unknown,
+.
+.  {* The value can't be recovered.  For the return address this
+.     marks the outermost frame.  *}
+.  bfd_unwind_rule_undefined,
+.
+.  {* The register still holds the value of the caller.  *}
+.  bfd_unwind_rule_same_value,
+.
+.  {* The value of the caller is saved at the CFA plus an offset.  *}
+.  bfd_unwind_rule_offset
+.};
+.
+.typedef struct bfd_unwind_row
+.{
+.  {* The addresses the row covers, from START up to but not
+.     including END.  *}
+.  bfd_vma start;
+.  bfd_vma end;
+.
+.  {* If CFA_KNOWN, the CFA is the value of DWARF register CFA_REG
+.     plus CFA_OFFSET.  *}
+.  bool cfa_known;
+.  unsigned int cfa_reg;
+.  bfd_signed_vma cfa_offset;
+.
+.  {* How to recover the return address and the frame pointer;
+.     the offsets apply to <<bfd_unwind_rule_offset>> only.  *}
+.  enum bfd_unwind_rule ra_rule;
+.  bfd_signed_vma ra_offset;
+.  enum bfd_unwind_rule fp_rule;
+.  bfd_signed_vma fp_offset;
+.
+.  {* The saved return address is signed, as with AArch64 pointer
+.     authentication.  *}
+.  bool ra_mangled;
+.}
+.bfd_unwind_row;
+.
+*/
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libbfd.h"
+#include "dwarf2.h"
+#include "sframe-api.h"
+
+/* A row of the table, less its start address.  */
+
+struct unwind_entry
+{
+  bfd_vma end;
+  int32_t cfa_offset;
+  int32_t ra_offset;
+  int32_t fp_offset;
+  unsigned short cfa_reg;
+  unsigned char ra_rule;
+  unsigned char fp_rule;
+  unsigned char flags;
+};
+
+#define UNWIND_CFA_KNOWN	1
+#define UNWIND_RA_MANGLED	2
+
+/* The unwind table of a BFD, built by bfd_unwind_find_row.  STARTS
+   holds the start addresses of the COUNT rows in increasing order,
+   and ENTRIES the rest of each row.  Rows don't overlap, and
+   addresses between them have none.
+
+   BUCKETS splits BASE to LIMIT into NBUCKETS pieces of 1 << SHIFT
+   bytes, about one per row.  Element K is the index of the last row
+   starting no later than BASE + (K << SHIFT), so the row for an
+   address in piece K is between elements K and K + 1.  */
+
+struct bfd_unwind_table
+{
+  size_t count;
+  bfd_vma *starts;
+  struct unwind_entry *entries;
+  bfd_vma base;
+  bfd_vma limit;
+  unsigned int shift;
+  size_t nbuckets;
+  unsigned int *buckets;
+};
+
+/* Rows while the table is being built.  */
+
+struct unwind_build_row
+{
+  bfd_vma start;
+  struct unwind_entry e;
+};
+
+struct unwind_build
+{
+  struct unwind_build_row *rows;
+  size_t count;
+  size_t alloced;
+};
+
+/* Add a row for START to E->end to B, unless it is empty.  */
+
+static bool
+unwind_add_row (struct unwind_build *b, bfd_vma start,
+		const struct unwind_entry *e)
+{
+  if (start >= e->end)
+    return true;
+  if (b->count == b->alloced)
+    {
+      size_t n = b->alloced != 0 ? b->alloced * 2 : 256;
+      struct unwind_build_row *rows;
+
+      rows = (struct unwind_build_row *) bfd_realloc (b->rows,
+						      n * sizeof (*rows));
+      if (rows == NULL)
+	return false;
+      b->rows = rows;
+      b->alloced = n;
+    }
+  b->rows[b->count].start = start;
+  b->rows[b->count].e = *e;
+  b->count++;
+  return true;
+}
+
+static bool
+unwind_offset_fits (bfd_signed_vma off)
+{
+  return off >= -0x7fffffff - 1 && off <= 0x7fffffff;
+}
+
+static bool
+unwind_entry_same (const struct unwind_entry *a, const struct unwind_entry *b)
+{
+  return (a->flags == b->flags
+	  && a->cfa_reg == b->cfa_reg
+	  && a->cfa_offset == b->cfa_offset
+	  && a->ra_rule == b->ra_rule
+	  && a->ra_offset == b->ra_offset
+	  && a->fp_rule == b->fp_rule
+	  && a->fp_offset == b->fp_offset);
+}
+
+/* SFrame.  */
+
+/* FDEs for repeated code, such as PLT entries, describe a block of
+   this many bytes.  */
+#define SFRAME_PCMASK_SIZE 16
+
+/* Add the rows of the .sframe section SEC of ABFD to B.  */
+
+static bool
+unwind_from_sframe (bfd *abfd, asection *sec, struct unwind_build *b)
+{
+  bfd_byte *contents = NULL;
+  sframe_decoder_ctx *dctx;
+  unsigned int sp_reg, fp_reg;
+  unsigned int i, nfdes;
+  int8_t fixed_ra, fixed_fp;
+  int err = 0;
+  bool ret = false;
+
+  if (!bfd_malloc_and_get_section (abfd, sec, &contents))
+    return false;
+  dctx = sframe_decode ((const char *) contents, bfd_section_size (sec),
+			&err);
+  free (contents);
+  if (dctx == NULL)
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return false;
+    }
+
+  switch (sframe_decoder_get_abi_arch (dctx))
+    {
+    case SFRAME_ABI_AMD64_ENDIAN_LITTLE:
+      sp_reg = 7;
+      fp_reg = 6;
+      break;
+    case SFRAME_ABI_AARCH64_ENDIAN_BIG:
+    case SFRAME_ABI_AARCH64_ENDIAN_LITTLE:
+      sp_reg = 31;
+      fp_reg = 29;
+      break;
+    default:
+      bfd_set_error (bfd_error_wrong_format);
+      goto out;
+    }
+  fixed_ra = sframe_decoder_get_fixed_ra_offset (dctx);
+  fixed_fp = sframe_decoder_get_fixed_fp_offset (dctx);
+
+  nfdes = sframe_decoder_get_num_fidx (dctx);
+  for (i = 0; i < nfdes; i++)
+    {
+      sframe_frame_row_entry fre, next;
+      uint32_t num_fres, func_size, j;
+      int32_t func_start;
+      unsigned char func_info;
+      bfd_vma func_vma;
+      bool pcmask;
+
+      if (sframe_decoder_get_funcdesc (dctx, i, &num_fres, &func_size,
+				       &func_start, &func_info) != 0)
+	goto bad;
+      if (num_fres == 0)
+	continue;
+      func_vma = sec->vma + func_start;
+      pcmask = SFRAME_V1_FUNC_FDE_TYPE (func_info) == SFRAME_FDE_TYPE_PCMASK;
+
+      if (sframe_decoder_get_fre (dctx, i, 0, &next) != 0)
+	goto bad;
+      for (j = 0; j < num_fres; j++)
+	{
+	  struct unwind_entry e;
+	  uint32_t fre_end;
+	  int32_t off;
+
+	  fre = next;
+	  if (j + 1 < num_fres)
+	    {
+	      if (sframe_decoder_get_fre (dctx, i, j + 1, &next) != 0)
+		goto bad;
+	      fre_end = next.fre_start_addr;
+	    }
+	  else
+	    fre_end = pcmask ? SFRAME_PCMASK_SIZE : func_size;
+
+	  memset (&e, 0, sizeof (e));
+	  err = 0;
+	  e.cfa_reg = (sframe_fre_get_base_reg_id (&fre, &err)
+		       == SFRAME_BASE_REG_SP ? sp_reg : fp_reg);
+	  e.cfa_offset = sframe_fre_get_cfa_offset (dctx, &fre, &err);
+	  if (err == 0)
+	    e.flags |= UNWIND_CFA_KNOWN;
+
+	  err = 0;
+	  off = sframe_fre_get_ra_offset (dctx, &fre, &err);
+	  if (err == 0)
+	    e.ra_offset = off;
+	  else if (fixed_ra != SFRAME_CFA_FIXED_RA_INVALID)
+	    e.ra_offset = fixed_ra;
+	  e.ra_rule = (err == 0 || fixed_ra != SFRAME_CFA_FIXED_RA_INVALID
+		       ? bfd_unwind_rule_offset : bfd_unwind_rule_same_value);
+
+	  err = 0;
+	  off = sframe_fre_get_fp_offset (dctx, &fre, &err);
+	  if (err == 0)
+	    e.fp_offset = off;
+	  else if (fixed_fp != SFRAME_CFA_FIXED_FP_INVALID)
+	    e.fp_offset = fixed_fp;
+	  e.fp_rule = (err == 0 || fixed_fp != SFRAME_CFA_FIXED_FP_INVALID
+		       ? bfd_unwind_rule_offset : bfd_unwind_rule_same_value);
+
+	  err = 0;
+	  if (sframe_fre_get_ra_mangled_p (dctx, &fre, &err))
+	    e.flags |= UNWIND_RA_MANGLED;
+
+	  if (!pcmask)
+	    {
+	      e.end = func_vma + fre_end;
+	      if (!unwind_add_row (b, func_vma + fre.fre_start_addr, &e))
+		goto out;
+	    }
+	  else
+	    {
+	      uint32_t block;
+
+	      /* The FRE applies at the same offset in every block.  */
+	      if (fre_end > SFRAME_PCMASK_SIZE)
+		fre_end = SFRAME_PCMASK_SIZE;
+	      for (block = 0; block < func_size; block += SFRAME_PCMASK_SIZE)
+		{
+		  e.end = func_vma + block + fre_end;
+		  if (e.end > func_vma + func_size)
+		    e.end = func_vma + func_size;
+		  if (!unwind_add_row (b, func_vma + block + fre.fre_start_addr,
+				       &e))
+		    goto out;
+		}
+	    }
+	}
+    }
+  ret = true;
+  goto out;
+
+ bad:
+  bfd_set_error (bfd_error_bad_value);
+ out:
+  sframe_decoder_free (&dctx);
+  return ret;
+}
+
+/* DWARF call frame information.  */
+
+/* The rule for one register while call frame instructions are being
+   run.  */
+
+struct cfi_reg
+{
+  enum bfd_unwind_rule rule;
+  bfd_signed_vma offset;
+};
+
+struct cfi_state
+{
+  bool cfa_known;
+  bool ra_mangled;
+  bfd_vma cfa_reg;
+  bfd_signed_vma cfa_offset;
+  struct cfi_reg ra;
+  struct cfi_reg fp;
+};
+
+/* How deep DW_CFA_remember_state may nest.  */
+#define CFI_STACK_DEPTH 8
+
+/* A cursor over part of an .eh_frame section whose contents start at
+   BUF, at address VMA.  */
+
+struct cfi_reader
+{
+  bfd *abfd;
+  bfd_byte *buf;
+  bfd_byte *p;
+  bfd_byte *end;
+  bfd_vma vma;
+  unsigned int ptr_size;
+};
+
+/* The parts of a CIE that its FDEs need.  */
+
+struct cfi_cie
+{
+  bfd_byte *insns;
+  bfd_byte *insns_end;
+  bfd_vma code_align;
+  bfd_signed_vma data_align;
+  bfd_vma ra_reg;
+  unsigned char fde_encoding;
+  bool has_z;
+  bool signal_frame;
+  struct cfi_state initial;
+};
+
+/* What the instructions of one CIE or FDE run against.  INITIAL is
+   NULL while those of the CIE are run.  */
+
+struct cfi_frame
+{
+  const struct cfi_cie *cie;
+  const struct cfi_state *initial;
+  bfd_vma fp_reg;
+  bool has_fp;
+  bool aarch64;
+};
+
+static bool
+cfi_read (struct cfi_reader *r, unsigned int size, bfd_vma *val)
+{
+  if ((size_t) (r->end - r->p) < size)
+    return false;
+  switch (size)
+    {
+    case 1:
+      *val = bfd_get_8 (r->abfd, r->p);
+      break;
+    case 2:
+      *val = bfd_get_16 (r->abfd, r->p);
+      break;
+    case 4:
+      *val = bfd_get_32 (r->abfd, r->p);
+      break;
+    case 8:
+      *val = bfd_get_64 (r->abfd, r->p);
+      break;
+    default:
+      return false;
+    }
+  r->p += size;
+  return true;
+}
+
+static bool
+cfi_read_leb (struct cfi_reader *r, bool sign, bfd_vma *val)
+{
+  if (r->p >= r->end)
+    return false;
+  *val = _bfd_safe_read_leb128 (r->abfd, &r->p, sign, r->end);
+  return true;
+}
+
+/* Read a pointer encoded as ENC, a DW_EH_PE_* value.  */
+
+static bool
+cfi_read_encoded (struct cfi_reader *r, unsigned int enc, bfd_vma *val)
+{
+  bfd_vma pc = r->vma + (r->p - r->buf);
+  bfd_vma v;
+  bool ok;
+
+  switch (enc & 0x0f)
+    {
+    case DW_EH_PE_absptr:
+      ok = cfi_read (r, r->ptr_size, &v);
+      break;
+    case DW_EH_PE_uleb128:
+      ok = cfi_read_leb (r, false, &v);
+      break;
+    case DW_EH_PE_udata2:
+      ok = cfi_read (r, 2, &v);
+      break;
+    case DW_EH_PE_udata4:
+      ok = cfi_read (r, 4, &v);
+      break;
+    case DW_EH_PE_udata8:
+      ok = cfi_read (r, 8, &v);
+      break;
+    case DW_EH_PE_sleb128:
+      ok = cfi_read_leb (r, true, &v);
+      break;
+    case DW_EH_PE_sdata2:
+      ok = cfi_read (r, 2, &v);
+      v = (v ^ 0x8000) - 0x8000;
+      break;
+    case DW_EH_PE_sdata4:
+      ok = cfi_read (r, 4, &v);
+      v = (v ^ 0x80000000) - 0x80000000;
+      break;
+    case DW_EH_PE_sdata8:
+      ok = cfi_read (r, 8, &v);
+      break;
+    default:
+      return false;
+    }
+  if (!ok)
+    return false;
+
+  switch (enc & 0x70)
+    {
+    case DW_EH_PE_absptr:
+      break;
+    case DW_EH_PE_pcrel:
+      v += pc;
+      break;
+    default:
+      /* The other bases need more than the section to resolve.  */
+      return false;
+    }
+  if ((enc & DW_EH_PE_indirect) != 0)
+    return false;
+
+  if (r->ptr_size < sizeof (bfd_vma))
+    v &= ((bfd_vma) 1 << (r->ptr_size * 8)) - 1;
+  *val = v;
+  return true;
+}
+
+/* Return the rule for register REG in S, or NULL if the table
+   doesn't track it.  */
+
+static struct cfi_reg *
+cfi_reg_rule (const struct cfi_frame *f, struct cfi_state *s, bfd_vma reg)
+{
+  if (reg == f->cie->ra_reg)
+    return &s->ra;
+  if (f->has_fp && reg == f->fp_reg)
+    return &s->fp;
+  return NULL;
+}
+
+static void
+cfi_set_rule (const struct cfi_frame *f, struct cfi_state *s, bfd_vma reg,
+	      enum bfd_unwind_rule rule, bfd_signed_vma offset)
+{
+  struct cfi_reg *r = cfi_reg_rule (f, s, reg);
+
+  if (r != NULL)
+    {
+      r->rule = rule;
+      r->offset = offset;
+    }
+}
+
+/* Return register REG of S to its rule after the CIE instructions.  */
+
+static void
+cfi_restore_rule (const struct cfi_frame *f, struct cfi_state *s, bfd_vma reg)
+{
+  struct cfi_reg *r = cfi_reg_rule (f, s, reg);
+
+  if (r != NULL)
+    {
+      if (f->initial == NULL)
+	r->rule = bfd_unwind_rule_same_value;
+      else
+	*r = *cfi_reg_rule (f, (struct cfi_state *) f->initial, reg);
+    }
+}
+
+static void
+cfi_entry_rule (unsigned char *rule, int32_t *offset, const struct cfi_reg *r)
+{
+  *rule = r->rule;
+  *offset = 0;
+  if (r->rule == bfd_unwind_rule_offset)
+    {
+      if (unwind_offset_fits (r->offset))
+	*offset = r->offset;
+      else
+	*rule = bfd_unwind_rule_unknown;
+    }
+}
+
+/* Add a row for START to END with the rules of S to B.  */
+
+static bool
+cfi_emit (struct unwind_build *b, const struct cfi_state *s,
+	  bfd_vma start, bfd_vma end)
+{
+  struct unwind_entry e;
+
+  memset (&e, 0, sizeof (e));
+  e.end = end;
+  if (s->cfa_known
+      && s->cfa_reg <= 0xffff
+      && unwind_offset_fits (s->cfa_offset))
+    {
+      e.flags |= UNWIND_CFA_KNOWN;
+      e.cfa_reg = s->cfa_reg;
+      e.cfa_offset = s->cfa_offset;
+    }
+  if (s->ra_mangled)
+    e.flags |= UNWIND_RA_MANGLED;
+  cfi_entry_rule (&e.ra_rule, &e.ra_offset, &s->ra);
+  cfi_entry_rule (&e.fp_rule, &e.fp_offset, &s->fp);
+  return unwind_add_row (b, start, &e);
+}
+
+/* Run the call frame instructions in R on S, for F.  If B is not NULL,
+   these are the instructions of an FDE for LOC to END; add the rows
+   they describe to B.  Return FALSE on bad or unsupported
+   instructions, leaving the rows added so far.  */
+
+static bool
+cfi_execute (const struct cfi_frame *f, struct cfi_reader *r,
+	     struct cfi_state *s, bfd_vma loc, bfd_vma end,
+	     struct unwind_build *b)
+{
+  const struct cfi_cie *cie = f->cie;
+  struct cfi_state stack[CFI_STACK_DEPTH];
+  unsigned int depth = 0;
+
+  while (r->p < r->end)
+    {
+      unsigned char op = *r->p++;
+      bfd_vma next = loc;
+      bfd_vma reg, val;
+
+      switch (op & 0xc0)
+	{
+	case DW_CFA_advance_loc:
+	  next = loc + (op & 0x3f) * cie->code_align;
+	  break;
+
+	case DW_CFA_offset:
+	  if (!cfi_read_leb (r, false, &val))
+	    return false;
+	  cfi_set_rule (f, s, op & 0x3f, bfd_unwind_rule_offset,
+			(bfd_signed_vma) val * cie->data_align);
+	  break;
+
+	case DW_CFA_restore:
+	  cfi_restore_rule (f, s, op & 0x3f);
+	  break;
+
+	default:
+	  switch (op)
+	    {
+	    case DW_CFA_nop:
+	      break;
+
+	    case DW_CFA_GNU_args_size:
+	      if (!cfi_read_leb (r, false, &val))
+		return false;
+	      break;
+
+	    case DW_CFA_set_loc:
+	      if (!cfi_read_encoded (r, cie->fde_encoding, &next)
+		  || next < loc)
+		return false;
+	      break;
+
+	    case DW_CFA_advance_loc1:
+	    case DW_CFA_advance_loc2:
+	    case DW_CFA_advance_loc4:
+	    case DW_CFA_MIPS_advance_loc8:
+	      if (!cfi_read (r, (op == DW_CFA_advance_loc1 ? 1
+				 : op == DW_CFA_advance_loc2 ? 2
+				 : op == DW_CFA_advance_loc4 ? 4 : 8), &val))
+		return false;
+	      next = loc + val * cie->code_align;
+	      break;
+
+	    case DW_CFA_offset_extended:
+	    case DW_CFA_offset_extended_sf:
+	    case DW_CFA_GNU_negative_offset_extended:
+	      if (!cfi_read_leb (r, false, &reg)
+		  || !cfi_read_leb (r, op == DW_CFA_offset_extended_sf, &val))
+		return false;
+	      val *= cie->data_align;
+	      if (op == DW_CFA_GNU_negative_offset_extended)
+		val = -val;
+	      cfi_set_rule (f, s, reg, bfd_unwind_rule_offset, val);
+	      break;
+
+	    case DW_CFA_restore_extended:
+	      if (!cfi_read_leb (r, false, &reg))
+		return false;
+	      cfi_restore_rule (f, s, reg);
+	      break;
+
+	    case DW_CFA_undefined:
+	    case DW_CFA_same_value:
+	      if (!cfi_read_leb (r, false, &reg))
+		return false;
+	      cfi_set_rule (f, s, reg,
+			    (op == DW_CFA_undefined ? bfd_unwind_rule_undefined
+			     : bfd_unwind_rule_same_value), 0);
+	      break;
+
+	    case DW_CFA_register:
+	    case DW_CFA_val_offset:
+	    case DW_CFA_val_offset_sf:
+	      if (!cfi_read_leb (r, false, &reg)
+		  || !cfi_read_leb (r, op == DW_CFA_val_offset_sf, &val))
+		return false;
+	      cfi_set_rule (f, s, reg, bfd_unwind_rule_unknown, 0);
+	      break;
+
+	    case DW_CFA_expression:
+	    case DW_CFA_val_expression:
+	      if (!cfi_read_leb (r, false, &reg)
+		  || !cfi_read_leb (r, false, &val)
+		  || val > (bfd_vma) (r->end - r->p))
+		return false;
+	      r->p += val;
+	      cfi_set_rule (f, s, reg, bfd_unwind_rule_unknown, 0);
+	      break;
+
+	    case DW_CFA_remember_state:
+	      if (depth == CFI_STACK_DEPTH)
+		return false;
+	      stack[depth++] = *s;
+	      break;
+
+	    case DW_CFA_restore_state:
+	      if (depth == 0)
+		return false;
+	      *s = stack[--depth];
+	      break;
+
+	    case DW_CFA_def_cfa:
+	    case DW_CFA_def_cfa_sf:
+	      if (!cfi_read_leb (r, false, &reg)
+		  || !cfi_read_leb (r, op == DW_CFA_def_cfa_sf, &val))
+		return false;
+	      if (op == DW_CFA_def_cfa_sf)
+		val *= cie->data_align;
+	      s->cfa_known = true;
+	      s->cfa_reg = reg;
+	      s->cfa_offset = val;
+	      break;
+
+	    case DW_CFA_def_cfa_register:
+	      if (!cfi_read_leb (r, false, &reg))
+		return false;
+	      s->cfa_reg = reg;
+	      break;
+
+	    case DW_CFA_def_cfa_offset:
+	    case DW_CFA_def_cfa_offset_sf:
+	      if (!cfi_read_leb (r, op == DW_CFA_def_cfa_offset_sf, &val))
+		return false;
+	      if (op == DW_CFA_def_cfa_offset_sf)
+		val *= cie->data_align;
+	      s->cfa_offset = val;
+	      break;
+
+	    case DW_CFA_def_cfa_expression:
+	      if (!cfi_read_leb (r, false, &val)
+		  || val > (bfd_vma) (r->end - r->p))
+		return false;
+	      r->p += val;
+	      s->cfa_known = false;
+	      break;
+
+	    case DW_CFA_GNU_window_save:
+	      /* DW_CFA_AARCH64_negate_ra_state on AArch64.  */
+	      if (!f->aarch64)
+		return false;
+	      s->ra_mangled = !s->ra_mangled;
+	      break;
+
+	    default:
+	      return false;
+	    }
+	  break;
+	}
+
+      if (next != loc)
+	{
+	  if (b == NULL || next > end)
+	    return false;
+	  if (!cfi_emit (b, s, loc, next))
+	    return false;
+	  loc = next;
+	}
+    }
+
+  if (b != NULL && loc < end)
+    return cfi_emit (b, s, loc, end);
+  return true;
+}
+
+/* Parse the CIE whose length field is at CIE in the section read by
+   SEC into C, running its initial instructions for F.  */
+
+static bool
+cfi_parse_cie (struct cfi_reader *sec, bfd_byte *cie, struct cfi_cie *c,
+	       struct cfi_frame *f)
+{
+  struct cfi_reader r = *sec;
+  bfd_vma length, id, val;
+  unsigned int offset_size = 4;
+  unsigned int version;
+  const char *aug;
+
+  r.p = cie;
+  if (!cfi_read (&r, 4, &length))
+    return false;
+  if (length == 0xffffffff)
+    {
+      offset_size = 8;
+      if (!cfi_read (&r, 8, &length))
+	return false;
+    }
+  if (length > (bfd_vma) (r.end - r.p))
+    return false;
+  r.end = r.p + length;
+  if (!cfi_read (&r, offset_size, &id) || id != 0
+      || !cfi_read (&r, 1, &val))
+    return false;
+  version = val;
+  if (version != 1 && version != 3 && version != 4)
+    return false;
+
+  aug = (const char *) r.p;
+  while (r.p < r.end && *r.p != 0)
+    r.p++;
+  if (r.p++ == r.end)
+    return false;
+  if (version == 4)
+    {
+      /* The address and segment selector sizes.  */
+      if (!cfi_read (&r, 1, &val) || !cfi_read (&r, 1, &val))
+	return false;
+    }
+
+  memset (c, 0, sizeof (*c));
+  if (!cfi_read_leb (&r, false, &c->code_align)
+      || !cfi_read_leb (&r, true, &val))
+    return false;
+  c->data_align = val;
+  if (version == 1)
+    {
+      if (!cfi_read (&r, 1, &c->ra_reg))
+	return false;
+    }
+  else if (!cfi_read_leb (&r, false, &c->ra_reg))
+    return false;
+
+  c->fde_encoding = DW_EH_PE_absptr;
+  if (*aug == 'z')
+    {
+      bfd_byte *aug_end;
+
+      if (!cfi_read_leb (&r, false, &val)
+	  || val > (bfd_vma) (r.end - r.p))
+	return false;
+      aug_end = r.p + val;
+      c->has_z = true;
+      for (aug++; *aug != 0; aug++)
+	{
+	  if (*aug == 'R')
+	    {
+	      if (!cfi_read (&r, 1, &val))
+		return false;
+	      c->fde_encoding = val;
+	    }
+	  else if (*aug == 'L')
+	    {
+	      if (!cfi_read (&r, 1, &val))
+		return false;
+	    }
+	  else if (*aug == 'P')
+	    {
+	      bfd_vma personality;
+
+	      /* Only the size of the pointer matters here.  */
+	      if (!cfi_read (&r, 1, &val)
+		  || !cfi_read_encoded (&r, val & 0x0f, &personality))
+		return false;
+	    }
+	  else if (*aug == 'S')
+	    c->signal_frame = true;
+	  else
+	    break;
+	}
+      r.p = aug_end;
+    }
+  else if (*aug != 0)
+    return false;
+
+  c->insns = r.p;
+  c->insns_end = r.end;
+
+  c->initial.ra.rule = bfd_unwind_rule_same_value;
+  c->initial.fp.rule = bfd_unwind_rule_same_value;
+  f->cie = c;
+  f->initial = NULL;
+  return cfi_execute (f, &r, &c->initial, 0, 0, NULL);
+}
+
+/* The DWARF register number of the frame pointer of ABFD.  */
+
+static bool
+unwind_fp_regno (bfd *abfd, bfd_vma *reg)
+{
+  switch (bfd_get_arch (abfd))
+    {
+    case bfd_arch_i386:
+      *reg = ((bfd_get_mach (abfd) & (bfd_mach_x86_64 | bfd_mach_x64_32)) != 0
+	      ? 6 : 5);
+      return true;
+    case bfd_arch_aarch64:
+      *reg = 29;
+      return true;
+    case bfd_arch_arm:
+      *reg = 11;
+      return true;
+    case bfd_arch_riscv:
+      *reg = 8;
+      return true;
+    case bfd_arch_s390:
+      *reg = 11;
+      return true;
+    default:
+      return false;
+    }
+}
+
+/* Add the rows of the .eh_frame section SEC of ABFD to B.  FDEs that
+   can't be read are left out.  */
+
+static bool
+unwind_from_eh_frame (bfd *abfd, asection *sec, struct unwind_build *b)
+{
+  struct cfi_reader r;
+  struct cfi_frame f;
+  struct cfi_cie cie;
+  bfd_byte *contents = NULL;
+  bfd_byte *cie_ptr = NULL;
+  bool cie_ok = false;
+
+  if (!bfd_malloc_and_get_section (abfd, sec, &contents))
+    return false;
+
+  r.abfd = abfd;
+  r.buf = contents;
+  r.p = contents;
+  r.end = contents + bfd_section_size (sec);
+  r.vma = sec->vma;
+  r.ptr_size = bfd_arch_bits_per_address (abfd) / 8;
+  if (r.ptr_size != 2 && r.ptr_size != 4 && r.ptr_size != 8)
+    r.ptr_size = 4;
+
+  memset (&f, 0, sizeof (f));
+  f.has_fp = unwind_fp_regno (abfd, &f.fp_reg);
+  f.aarch64 = bfd_get_arch (abfd) == bfd_arch_aarch64;
+
+  while (r.p < r.end)
+    {
+      struct cfi_reader fde;
+      struct cfi_state s;
+      bfd_byte *id_ptr, *entry_end;
+      bfd_vma length, id, pc_begin, pc_range, val;
+      unsigned int offset_size = 4;
+
+      if (!cfi_read (&r, 4, &length))
+	break;
+      if (length == 0)
+	continue;
+      if (length == 0xffffffff)
+	{
+	  offset_size = 8;
+	  if (!cfi_read (&r, 8, &length))
+	    break;
+	}
+      if (length > (bfd_vma) (r.end - r.p))
+	break;
+      entry_end = r.p + length;
+      id_ptr = r.p;
+      if (!cfi_read (&r, offset_size, &id))
+	break;
+      if (id == 0)
+	{
+	  /* A CIE; it is read when an FDE uses it.  */
+	  r.p = entry_end;
+	  continue;
+	}
+
+      if (id > (bfd_vma) (id_ptr - contents))
+	{
+	  r.p = entry_end;
+	  continue;
+	}
+      if (id_ptr - id != cie_ptr)
+	{
+	  cie_ptr = id_ptr - id;
+	  cie_ok = cfi_parse_cie (&r, cie_ptr, &cie, &f);
+	}
+      if (!cie_ok)
+	{
+	  r.p = entry_end;
+	  continue;
+	}
+
+      fde = r;
+      fde.end = entry_end;
+      if (!cfi_read_encoded (&fde, cie.fde_encoding, &pc_begin)
+	  || !cfi_read_encoded (&fde, cie.fde_encoding & 0x0f, &pc_range)
+	  || (cie.has_z
+	      && (!cfi_read_leb (&fde, false, &val)
+		  || val > (bfd_vma) (fde.end - fde.p))))
+	{
+	  r.p = entry_end;
+	  continue;
+	}
+      if (cie.has_z)
+	fde.p += val;
+
+      /* Discarded functions are left with an empty range or one at
+	 address zero.  */
+      if (pc_range != 0 && pc_begin != 0)
+	{
+	  s = cie.initial;
+	  f.cie = &cie;
+	  f.initial = &cie.initial;
+	  bfd_set_error (bfd_error_no_error);
+	  if (!cfi_execute (&f, &fde, &s, pc_begin, pc_begin + pc_range, b)
+	      && bfd_get_error () == bfd_error_no_memory)
+	    {
+	      free (contents);
+	      return false;
+	    }
+	}
+      r.p = entry_end;
+    }
+
+  free (contents);
+  return true;
+}
+
+/* Sort the rows of B, resolve any overlaps, join neighbours with the
+   same rules, and lay the result out as the unwind table of ABFD.  */
+
+static int
+unwind_row_compare (const void *ap, const void *bp)
+{
+  const struct unwind_build_row *a = (const struct unwind_build_row *) ap;
+  const struct unwind_build_row *b = (const struct unwind_build_row *) bp;
+
+  if (a->start != b->start)
+    return a->start < b->start ? -1 : 1;
+  if (a->e.end != b->e.end)
+    return a->e.end < b->e.end ? -1 : 1;
+  return 0;
+}
+
+static struct bfd_unwind_table *
+unwind_table_finish (bfd *abfd, struct unwind_build *b)
+{
+  struct bfd_unwind_table *table;
+  bfd_vma span;
+  size_t i, j, n;
+
+  table = (struct bfd_unwind_table *) bfd_zalloc (abfd, sizeof (*table));
+  if (table == NULL || b->count == 0)
+    return table;
+
+  for (i = 1; i < b->count; i++)
+    if (unwind_row_compare (&b->rows[i - 1], &b->rows[i]) > 0)
+      {
+	qsort (b->rows, b->count, sizeof (*b->rows), unwind_row_compare);
+	break;
+      }
+
+  n = 0;
+  for (i = 1; i < b->count; i++)
+    {
+      struct unwind_build_row *prev = &b->rows[n];
+      struct unwind_build_row *row = &b->rows[i];
+
+      if (row->start < prev->e.end)
+	{
+	  /* Overlapping descriptions; the later one wins.  */
+	  prev->e.end = row->start;
+	  if (prev->start == prev->e.end)
+	    {
+	      *prev = *row;
+	      continue;
+	    }
+	}
+      if (row->start == prev->e.end && unwind_entry_same (&prev->e, &row->e))
+	prev->e.end = row->e.end;
+      else
+	b->rows[++n] = *row;
+    }
+  n++;
+  if (n >= (unsigned int) -1)
+    {
+      bfd_set_error (bfd_error_file_too_big);
+      return NULL;
+    }
+
+  table->count = n;
+  table->starts = (bfd_vma *) bfd_alloc (abfd, n * sizeof (bfd_vma));
+  table->entries = ((struct unwind_entry *)
+		    bfd_alloc (abfd, n * sizeof (struct unwind_entry)));
+  if (table->starts == NULL || table->entries == NULL)
+    return NULL;
+  for (i = 0; i < n; i++)
+    {
+      table->starts[i] = b->rows[i].start;
+      table->entries[i] = b->rows[i].e;
+    }
+
+  /* Pick buckets no bigger than they need be to average at most one
+     row each.  */
+  table->base = table->starts[0];
+  table->limit = table->entries[n - 1].end;
+  span = table->limit - table->base;
+  while (table->shift < 63 && (span >> table->shift) >= n)
+    table->shift++;
+  table->nbuckets = (span >> table->shift) + 1;
+  table->buckets = ((unsigned int *)
+		    bfd_alloc (abfd, ((table->nbuckets + 1)
+				      * sizeof (unsigned int))));
+  if (table->buckets == NULL)
+    return NULL;
+  j = 0;
+  for (i = 0; i <= table->nbuckets; i++)
+    {
+      bfd_vma off = (bfd_vma) i << table->shift;
+
+      while (j + 1 < n && table->starts[j + 1] - table->base <= off)
+	j++;
+      table->buckets[i] = j;
+    }
+  return table;
+}
+
+/* Read the unwind information of ABFD and build its table.  */
+
+static struct bfd_unwind_table *
+unwind_table_build (bfd *abfd)
+{
+  struct bfd_unwind_table *table;
+  struct unwind_build b;
+  asection *sec;
+  bool ok = false;
+
+  memset (&b, 0, sizeof (b));
+  sec = bfd_get_section_by_name (abfd, ".sframe");
+  if (sec != NULL && (sec->flags & SEC_HAS_CONTENTS) != 0)
+    {
+      ok = unwind_from_sframe (abfd, sec, &b);
+      if (!ok && bfd_get_error () == bfd_error_no_memory)
+	{
+	  free (b.rows);
+	  return NULL;
+	}
+    }
+  if (!ok)
+    {
+      /* Fall back on .eh_frame if .sframe is missing or unusable.  */
+      b.count = 0;
+      sec = bfd_get_section_by_name (abfd, ".eh_frame");
+      if (sec != NULL && (sec->flags & SEC_HAS_CONTENTS) != 0
+	  && !unwind_from_eh_frame (abfd, sec, &b))
+	{
+	  free (b.rows);
+	  return NULL;
+	}
+    }
+
+  table = unwind_table_finish (abfd, &b);
+  free (b.rows);
+  return table;
+}
+
+/*
+FUNCTION
+	bfd_unwind_find_row
+
+SYNOPSIS
+	bool bfd_unwind_find_row
+	  (bfd *abfd, bfd_vma pc, bfd_unwind_row *row);
+
+DESCRIPTION
+	Fill in @var{row} with the unwind rules that apply at @var{pc},
+	a virtual address in the executable or shared library
+	@var{abfd}.  The rules come from the <<.sframe>> section of
+	@var{abfd} if it has one BFD can read, and from its
+	<<.eh_frame>> section otherwise.  Register numbers are DWARF
+	register numbers.
+
+	The first call reads that section and builds a sorted table of
+	rows, with an index that lets later calls find a row in close
+	to constant time.  The table is kept until the BFD is closed or
+	its cached information freed.  Return <<FALSE>> if no row
+	covers @var{pc}, or on error, in which case the BFD error is
+	set and the next call tries again.
+*/
+
+bool
+bfd_unwind_find_row (bfd *abfd, bfd_vma pc, bfd_unwind_row *row)
+{
+  struct bfd_unwind_table *table;
+  const struct unwind_entry *e;
+  size_t k, lo, hi;
+
+  table = abfd->unwind_table;
+  if (table == NULL)
+    {
+      table = unwind_table_build (abfd);
+      if (table == NULL)
+	return false;
+      abfd->unwind_table = table;
+    }
+  if (table->count == 0
+      || pc < table->base
+      || pc - table->base >= table->limit - table->base)
+    return false;
+
+  /* Find the last row in the bucket's range starting no later than
+     PC.  */
+  k = (pc - table->base) >> table->shift;
+  lo = table->buckets[k];
+  hi = table->buckets[k + 1];
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo + 1) / 2;
+
+      if (table->starts[mid] <= pc)
+	lo = mid;
+      else
+	hi = mid - 1;
+    }
+  e = &table->entries[lo];
+  if (pc >= e->end)
+    return false;
+
+  row->start = table->starts[lo];
+  row->end = e->end;
+  row->cfa_known = (e->flags & UNWIND_CFA_KNOWN) != 0;
+  row->cfa_reg = e->cfa_reg;
+  row->cfa_offset = e->cfa_offset;
+  row->ra_rule = (enum bfd_unwind_rule) e->ra_rule;
+  row->ra_offset = e->ra_offset;
+  row->fp_rule = (enum bfd_unwind_rule) e->fp_rule;
+  row->fp_offset = e->fp_offset;
+  row->ra_mangled = (e->flags & UNWIND_RA_MANGLED) != 0;
+  return true;
+}
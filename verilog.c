@@ -76,6 +76,12 @@ static const char digs[] = "0123456789ABCDEF";
 	d[1] = digs[(x) & 0xf]; \
 	d[0] = digs[((x) >> 4) & 0xf];
 
+/* The size of the buffer lines are formatted into when writing.  */
+#define OUTBUF_SIZE 65536
+
+/* The longest line written: an address line, or a data record.  */
+#define MAX_LINE 52
+
 /* When writing a verilog memory dump file, we write them in the order
    in which they appear in memory. This structure is used to hold them
    in memory.  */
@@ -96,6 +102,9 @@ typedef struct verilog_data_struct
 {
   verilog_data_list_type *head;
   verilog_data_list_type *tail;
+  /* Lines not yet written out, while writing.  */
+  char *outbuf;
+  size_t outlen;
 }
 tdata_type;
 
@@ -166,12 +175,41 @@ verilog_set_section_contents (bfd *abfd,
   return true;
 }
 
+/* Write out the lines collected by verilog_write_address and
+   verilog_write_record.  */
+
+static bool
+verilog_flush_lines (bfd *abfd)
+{
+  tdata_type *tdata = abfd->tdata.verilog_data;
+  size_t len = tdata->outlen;
+
+  tdata->outlen = 0;
+  return bfd_bwrite (tdata->outbuf, len, abfd) == len;
+}
+
+/* Return space for a line of at most MAX_LINE characters at the end
+   of the lines collected for writing, or NULL on error.  */
+
+static char *
+verilog_line_buffer (bfd *abfd)
+{
+  tdata_type *tdata = abfd->tdata.verilog_data;
+
+  if (tdata->outlen + MAX_LINE > OUTBUF_SIZE
+      && ! verilog_flush_lines (abfd))
+    return NULL;
+  return tdata->outbuf + tdata->outlen;
+}
+
 static bool
 verilog_write_address (bfd *abfd, bfd_vma address)
 {
-  char buffer[20];
+  char *buffer = verilog_line_buffer (abfd);
   char *dst = buffer;
-  bfd_size_type wrlen;
+
+  if (buffer == NULL)
+    return false;
 
   /* Write the address.  */
   *dst++ = '@';
@@ -198,9 +236,9 @@ verilog_write_address (bfd *abfd, bfd_vma address)
   dst += 2;
   *dst++ = '\r';
   *dst++ = '\n';
-  wrlen = dst - buffer;
+  abfd->tdata.verilog_data->outlen += dst - buffer;
 
-  return bfd_bwrite ((void *) buffer, wrlen, abfd) == wrlen;
+  return true;
 }
 
 /* Write a record of type, of the supplied number of bytes. The
@@ -212,21 +250,24 @@ verilog_write_record (bfd *abfd,
 		      const bfd_byte *data,
 		      const bfd_byte *end)
 {
-  char buffer[52];
+  char *buffer;
   const bfd_byte *src = data;
-  char *dst = buffer;
-  bfd_size_type wrlen;
+  char *dst;
 
   /* Paranoia - check that we will not overflow "buffer".  */
   if (((end - data) * 2) /* Number of hex characters we want to emit.  */
       + ((end - data) / VerilogDataWidth) /* Number of spaces we want to emit.  */
       + 2 /* The carriage return & line feed characters.  */
-      > (long long) sizeof (buffer))
+      > MAX_LINE)
     {
       /* FIXME: Should we generate an error message ?  */
       return false;
     }
 
+  buffer = dst = verilog_line_buffer (abfd);
+  if (buffer == NULL)
+    return false;
+
   /* Write the data.
      FIXME: Under some circumstances we can emit a space at the end of
      the line.  This is not really necessary, but catching these cases
@@ -286,9 +327,9 @@ verilog_write_record (bfd *abfd,
 
   *dst++ = '\r';
   *dst++ = '\n';
-  wrlen = dst - buffer;
+  abfd->tdata.verilog_data->outlen += dst - buffer;
 
-  return bfd_bwrite ((void *) buffer, wrlen, abfd) == wrlen;
+  return true;
 }
 
 static bool
@@ -331,6 +372,12 @@ verilog_write_object_contents (bfd *abfd)
 {
   tdata_type *tdata = abfd->tdata.verilog_data;
   verilog_data_list_type *list;
+  bool ret = true;
+
+  tdata->outbuf = (char *) bfd_malloc (OUTBUF_SIZE);
+  if (tdata->outbuf == NULL)
+    return false;
+  tdata->outlen = 0;
 
   /* Now wander though all the sections provided and output them.  */
   list = tdata->head;
@@ -338,10 +385,18 @@ verilog_write_object_contents (bfd *abfd)
   while (list != (verilog_data_list_type *) NULL)
     {
       if (! verilog_write_section (abfd, tdata, list))
-	return false;
+	{
+	  ret = false;
+	  break;
+	}
       list = list->next;
     }
-  return true;
+  if (ret)
+    ret = verilog_flush_lines (abfd);
+
+  free (tdata->outbuf);
+  tdata->outbuf = NULL;
+  return ret;
 }
 
 /* Initialize by filling in the hex conversion array.  */
@@ -374,6 +429,8 @@ verilog_mkobject (bfd *abfd)
   abfd->tdata.verilog_data = tdata;
   tdata->head = NULL;
   tdata->tail = NULL;
+  tdata->outbuf = NULL;
+  tdata->outlen = 0;
 
   return true;
 }
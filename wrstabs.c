@@ -72,13 +72,19 @@ struct stab_type_stack
   unsigned int size;
   /* Whether type string defines a new type.  */
   bool definition;
-  /* String defining struct fields.  */
+  /* String defining struct fields, its length and the size of its
+     buffer.  */
   char *fields;
+  size_t fields_len;
+  size_t fields_alloc;
   /* NULL terminated array of strings defining base classes for a
      class.  */
   char **baseclasses;
-  /* String defining class methods.  */
+  /* String defining class methods, its length and the size of its
+     buffer.  */
   char *methods;
+  size_t methods_len;
+  size_t methods_alloc;
   /* String defining vtable pointer for a class.  */
   char *vtable;
 };
@@ -381,6 +387,64 @@ stab_write_symbol_and_free (struct stab_write_handle *info, int type, int desc,
   return ret;
 }
 
+/* Append STR to the string *PS, which holds *PLEN characters in a
+   buffer of *PALLOC bytes.  The buffer grows geometrically, so that
+   building up the fields or methods of a large struct one at a time
+   takes linear time.  A NULL *PS is allocated.  */
+
+static void
+stab_string_append (char **ps, size_t *plen, size_t *palloc,
+		    const char *str)
+{
+  size_t len = strlen (str);
+
+  if (*ps == NULL || *plen + len + 1 > *palloc)
+    {
+      size_t alloc = *palloc < 64 ? 64 : *palloc;
+
+      while (alloc < *plen + len + 1)
+	alloc *= 2;
+      *ps = xrealloc (*ps, alloc);
+      *palloc = alloc;
+      if (*plen == 0)
+	**ps = '\0';
+    }
+
+  memcpy (*ps + *plen, str, len + 1);
+  *plen += len;
+}
+
+/* Copy STR to P and return a pointer to the terminating null
+   character.  */
+
+static char *
+stab_string_copy (char *p, const char *str)
+{
+  size_t len = strlen (str);
+
+  memcpy (p, str, len + 1);
+  return p + len;
+}
+
+/* Append STR to the fields or methods of the top of the type
+   stack.  */
+
+static void
+stab_append_fields (struct stab_write_handle *info, const char *str)
+{
+  struct stab_type_stack *s = info->type_stack;
+
+  stab_string_append (&s->fields, &s->fields_len, &s->fields_alloc, str);
+}
+
+static void
+stab_append_methods (struct stab_write_handle *info, const char *str)
+{
+  struct stab_type_stack *s = info->type_stack;
+
+  stab_string_append (&s->methods, &s->methods_len, &s->methods_alloc, str);
+}
+
 /* Push a string on to the type stack.  */
 
 static bool
@@ -396,8 +460,12 @@ stab_push_string (struct stab_write_handle *info, char *string,
   s->size = size;
 
   s->fields = NULL;
+  s->fields_len = 0;
+  s->fields_alloc = 0;
   s->baseclasses = NULL;
   s->methods = NULL;
+  s->methods_len = 0;
+  s->methods_alloc = 0;
   s->vtable = NULL;
 
   s->next = info->type_stack;
@@ -1324,8 +1392,7 @@ stab_start_struct_type (void *p, const char *tag, unsigned int id,
   if (!stab_push_string_dup (info, buf, tindex, definition, size))
     return false;
 
-  info->type_stack->fields = xmalloc (1);
-  info->type_stack->fields[0] = '\0';
+  stab_append_fields (info, "");
 
   return true;
 }
@@ -1339,8 +1406,9 @@ stab_struct_field (void *p, const char *name, bfd_vma bitpos,
   struct stab_write_handle *info = (struct stab_write_handle *) p;
   bool definition;
   unsigned int size;
-  char *s, *n;
+  char *s;
   const char *vis;
+  char buf[50];
 
   definition = info->type_stack->definition;
   size = info->type_stack->size;
@@ -1354,9 +1422,6 @@ stab_struct_field (void *p, const char *name, bfd_vma bitpos,
       return false;
     }
 
-  n = xmalloc (strlen (info->type_stack->fields)
-	       + strlen (name) + strlen (s) + 50);
-
   switch (visibility)
     {
     default:
@@ -1383,12 +1448,14 @@ stab_struct_field (void *p, const char *name, bfd_vma bitpos,
 		   bfd_get_filename (info->abfd), name);
     }
 
-  sprintf (n, "%s%s:%s%s,%ld,%ld;", info->type_stack->fields, name, vis, s,
-	   (long long) bitpos, (long long) bitsize);
+  stab_append_fields (info, name);
+  stab_append_fields (info, ":");
+  stab_append_fields (info, vis);
+  stab_append_fields (info, s);
+  sprintf (buf, ",%lld,%lld;", (long long) bitpos, (long long) bitsize);
+  stab_append_fields (info, buf);
 
-  free (info->type_stack->fields);
   free (s);
-  info->type_stack->fields = n;
 
   if (definition)
     info->type_stack->definition = true;
@@ -1482,7 +1549,7 @@ stab_class_static_member (void *p, const char *name, const char *physname,
 {
   struct stab_write_handle *info = (struct stab_write_handle *) p;
   bool definition;
-  char *s, *n;
+  char *s;
   const char *vis;
 
   definition = info->type_stack->definition;
@@ -1493,8 +1560,6 @@ stab_class_static_member (void *p, const char *name, const char *physname,
 
   if (info->type_stack->fields == NULL)
     return false;
-  n = xmalloc (strlen (info->type_stack->fields) + strlen (name)
-	       + strlen (s) + strlen (physname) + 10);
 
   switch (visibility)
     {
@@ -1514,12 +1579,15 @@ stab_class_static_member (void *p, const char *name, const char *physname,
       break;
     }
 
-  sprintf (n, "%s%s:%s%s:%s;", info->type_stack->fields, name, vis, s,
-	   physname);
+  stab_append_fields (info, name);
+  stab_append_fields (info, ":");
+  stab_append_fields (info, vis);
+  stab_append_fields (info, s);
+  stab_append_fields (info, ":");
+  stab_append_fields (info, physname);
+  stab_append_fields (info, ";");
 
   free (s);
-  free (info->type_stack->fields);
-  info->type_stack->fields = n;
 
   if (definition)
     info->type_stack->definition = true;
@@ -1604,23 +1672,12 @@ static bool
 stab_class_start_method (void *p, const char *name)
 {
   struct stab_write_handle *info = (struct stab_write_handle *) p;
-  char *m;
 
   if (info->type_stack == NULL || info->type_stack->fields == NULL)
     return false;
 
-  if (info->type_stack->methods == NULL)
-    {
-      m = xmalloc (strlen (name) + 3);
-      *m = '\0';
-    }
-  else
-    m = xrealloc (info->type_stack->methods,
-		  strlen (info->type_stack->methods) + strlen (name) + 3);
-
-  sprintf (m + strlen (m), "%s::", name);
-
-  info->type_stack->methods = m;
+  stab_append_methods (info, name);
+  stab_append_methods (info, "::");
 
   return true;
 }
@@ -1638,6 +1695,7 @@ stab_class_method_var (struct stab_write_handle *info, const char *physname,
   char *type;
   char *context = NULL;
   char visc, qualc, typec;
+  char buf[50];
 
   definition = info->type_stack->definition;
   type = stab_pop_type (info);
@@ -1695,19 +1753,19 @@ stab_class_method_var (struct stab_write_handle *info, const char *physname,
   else
     typec = '*';
 
-  info->type_stack->methods =
-    xrealloc (info->type_stack->methods,
-	      (strlen (info->type_stack->methods) + strlen (type)
-	       + strlen (physname) + (contextp ? strlen (context) : 0) + 40));
-
-  sprintf (info->type_stack->methods + strlen (info->type_stack->methods),
-	   "%s:%s;%c%c%c", type, physname, visc, qualc, typec);
+  stab_append_methods (info, type);
+  stab_append_methods (info, ":");
+  stab_append_methods (info, physname);
+  sprintf (buf, ";%c%c%c", visc, qualc, typec);
+  stab_append_methods (info, buf);
   free (type);
 
   if (contextp)
     {
-      sprintf (info->type_stack->methods + strlen (info->type_stack->methods),
-	       "%ld;%s;", (long long) voffset, context);
+      sprintf (buf, "%lld;", (long long) voffset);
+      stab_append_methods (info, buf);
+      stab_append_methods (info, context);
+      stab_append_methods (info, ";");
       free (context);
     }
 
@@ -1754,9 +1812,7 @@ stab_class_end_method (void *p)
   if (info->type_stack == NULL || info->type_stack->methods == NULL)
     return false;
 
-  /* We allocated enough room on info->type_stack->methods to add the
-     trailing semicolon.  */
-  strcat (info->type_stack->methods, ";");
+  stab_append_methods (info, ";");
 
   return true;
 }
@@ -1767,67 +1823,69 @@ static bool
 stab_end_class_type (void *p)
 {
   struct stab_write_handle *info = (struct stab_write_handle *) p;
+  struct stab_type_stack *s;
   size_t len;
   unsigned int i = 0;
-  char *buf;
+  char *buf, *end;
 
   if (info->type_stack == NULL
       || info->type_stack->string == NULL
       || info->type_stack->fields == NULL)
     return false;
 
+  s = info->type_stack;
+
   /* Work out the size we need to allocate for the class definition.  */
 
-  len = (strlen (info->type_stack->string)
-	 + strlen (info->type_stack->fields)
-	 + 10);
-  if (info->type_stack->baseclasses != NULL)
+  len = strlen (s->string) + s->fields_len + 10;
+  if (s->baseclasses != NULL)
     {
       len += 20;
-      for (i = 0; info->type_stack->baseclasses[i] != NULL; i++)
-	len += strlen (info->type_stack->baseclasses[i]);
+      for (i = 0; s->baseclasses[i] != NULL; i++)
+	len += strlen (s->baseclasses[i]);
     }
-  if (info->type_stack->methods != NULL)
-    len += strlen (info->type_stack->methods);
-  if (info->type_stack->vtable != NULL)
-    len += strlen (info->type_stack->vtable);
+  if (s->methods != NULL)
+    len += s->methods_len;
+  if (s->vtable != NULL)
+    len += strlen (s->vtable);
 
-  /* Build the class definition.  */
+  /* Build the class definition.  END always points at the end of the
+     string built so far.  */
 
   buf = xmalloc (len);
 
-  strcpy (buf, info->type_stack->string);
+  end = stab_string_copy (buf, s->string);
 
-  if (info->type_stack->baseclasses != NULL)
+  if (s->baseclasses != NULL)
     {
-      sprintf (buf + strlen (buf), "!%u,", i);
-      for (i = 0; info->type_stack->baseclasses[i] != NULL; i++)
+      end += sprintf (end, "!%u,", i);
+      for (i = 0; s->baseclasses[i] != NULL; i++)
 	{
-	  strcat (buf, info->type_stack->baseclasses[i]);
-	  free (info->type_stack->baseclasses[i]);
+	  end = stab_string_copy (end, s->baseclasses[i]);
+	  free (s->baseclasses[i]);
 	}
-      free (info->type_stack->baseclasses);
-      info->type_stack->baseclasses = NULL;
+      free (s->baseclasses);
+      s->baseclasses = NULL;
     }
 
-  strcat (buf, info->type_stack->fields);
-  free (info->type_stack->fields);
-  info->type_stack->fields = NULL;
+  end = stab_string_copy (end, s->fields);
+  free (s->fields);
+  s->fields = NULL;
 
-  if (info->type_stack->methods != NULL)
+  if (s->methods != NULL)
     {
-      strcat (buf, info->type_stack->methods);
-      free (info->type_stack->methods);
-      info->type_stack->methods = NULL;
+      end = stab_string_copy (end, s->methods);
+      free (s->methods);
+      s->methods = NULL;
     }
 
-  strcat (buf, ";");
+  end = stab_string_copy (end, ";");
 
-  if (info->type_stack->vtable != NULL)
+  if (s->vtable != NULL)
     {
-      strcat (buf, info->type_stack->vtable);
-      free (info->type_stack->vtable);
-      info->type_stack->vtable = NULL;
+      end = stab_string_copy (end, s->vtable);
+      free (s->vtable);
+      s->vtable = NULL;
     }
 
   /* Replace the string on the top of the stack with the complete